@@ -0,0 +1,232 @@
+/**
+ * @file    Actuator.hpp
+ * @author  Jeremy ROULLAND
+ * @date    15 oct. 2026
+ * @brief   Common actuator interface (queued commands, completion handles)
+ */
+
+#ifndef INC_ACTUATOR_HPP_
+#define INC_ACTUATOR_HPP_
+
+#include "common.h"
+#include "Event.hpp"
+
+#include "FreeRTOS.h"
+#include "queue.h"
+
+/*----------------------------------------------------------------------------*/
+/* Definitions                                                                */
+/*----------------------------------------------------------------------------*/
+
+/**
+ * @brief Command channels by actuator (commands of a channel run one after the other)
+ */
+#define ACT_CHANNEL_MAX         (2u)
+
+/**
+ * @brief Completion callbacks kept by channel (above queued plus running commands)
+ */
+#define ACT_CALLBACKS_MAX       (16u)
+
+/**
+ * @brief Errors (queue full : actuators specific errors are above)
+ */
+#define ACT_ERROR_FULL          (-3)
+
+/**
+ * @brief Actuator command
+ */
+typedef struct
+{
+    uint8_t     order;      /**< Actuator order (Cylinder::Order, Mandible::Position) */
+    int8_t      arg;        /**< Order argument (Cylinder::GOTO index) */
+}ACT_COMMAND;
+
+/**
+ * @brief Command completion callback (actuators task context)
+ */
+typedef void (*ACT_CALLBACK)(void* obj);
+
+class Actuator;
+
+/*----------------------------------------------------------------------------*/
+/* Class declaration                                                          */
+/*----------------------------------------------------------------------------*/
+
+/**
+ * @class ActuatorHandle
+ * @brief Queued command handle (copied by value, no allocation)
+ *
+ * A command is identified by its channel and sequence number : it is
+ * completed once the channel has completed as many commands.
+ */
+class ActuatorHandle
+{
+public:
+
+    ActuatorHandle(int8_t error = 0) : actuator(NULL), channel(0u), seq(0u), error(error)
+    {
+    }
+
+    ActuatorHandle(Actuator* actuator, uint8_t channel, uint32_t seq) : actuator(actuator), channel(channel), seq(seq), error(0)
+    {
+    }
+
+    /**
+     * @brief Return true if the command was queued
+     */
+    bool IsValid() const
+    {
+        return (this->actuator != NULL);
+    }
+
+    /**
+     * @brief Return queuing error (0 if queued)
+     */
+    int8_t GetError() const
+    {
+        return this->error;
+    }
+
+    /**
+     * @brief Return true once the command is completed (or was not queued)
+     */
+    bool Poll() const;
+
+    /**
+     * @brief Wait for command completion
+     * @param timeout : Maximum wait (tick)
+     * @return true if completed
+     */
+    bool Wait(TickType_t timeout = portMAX_DELAY) const;
+
+    /**
+     * @brief Call back on command completion (actuators task context)
+     * @return false if already completed (not called)
+     */
+    bool OnComplete(ACT_CALLBACK callback, void* obj) const;
+
+private:
+
+    Actuator*   actuator;
+    uint8_t     channel;
+    uint32_t    seq;
+    int8_t      error;
+};
+
+/**
+ * @class Actuator
+ * @brief Common actuator interface
+ *
+ * HOWTO :
+ * - Start() a command : it is queued on its channel and returns at once a
+ *   handle, Poll() / Wait() it or register a callback with OnComplete()
+ * - The actuators task (ActuatorControl) runs Process() of every actuator,
+ *   so actuators and channels of an actuator move in parallel
+ * - OrderQueued and OrderDone events are raised for every command,
+ *   whichever API queued it
+ *
+ * Implementations queue their commands with enqueue() and report each
+ * completed command with complete().
+ */
+class Actuator
+{
+public:
+
+    /**
+     * @brief Queue a command
+     * @return Handle, invalid with the error if refused
+     */
+    virtual ActuatorHandle Start(const ACT_COMMAND& cmd) = 0;
+
+    /**
+     * @brief Return channel running a command
+     */
+    virtual uint8_t GetChannel(const ACT_COMMAND& cmd) = 0;
+
+    /**
+     * @brief Return true if no command is queued or running on channel
+     */
+    virtual bool IsIdle(uint8_t ch) = 0;
+
+    /**
+     * @brief Return channel progress in percent (0 : command queued, 100 : idle)
+     */
+    virtual uint8_t GetProgress(uint8_t ch) = 0;
+
+    /**
+     * @brief Start queued commands and check running ones (non blocking)
+     */
+    virtual void Process() = 0;
+
+    /**
+     * @brief Return true if no command is queued or running
+     */
+    bool IsIdle();
+
+    /**
+     * @brief Return true if the command of sequence seq is completed on channel
+     */
+    bool IsCompleted(uint8_t ch, uint32_t seq)
+    {
+        return (static_cast<int32_t>(this->completed[ch] - seq) >= 0);
+    }
+
+    /**
+     * @brief Register a completion callback
+     * @return false if already completed (not registered)
+     */
+    bool Subscribe(uint8_t ch, uint32_t seq, ACT_CALLBACK callback, void* obj);
+
+    /**
+     * @brief Order completed event
+     */
+    Utils::Event<> OrderDone;
+
+    /**
+     * @brief Order queued event
+     */
+    Utils::Event<> OrderQueued;
+
+protected:
+
+    Actuator(uint8_t channels);
+
+    /**
+     * @protected
+     * @brief Channels used
+     */
+    uint8_t channels;
+
+    /**
+     * @protected
+     * @brief Commands queued and completed by channel
+     */
+    uint32_t issued[ACT_CHANNEL_MAX];
+    volatile uint32_t completed[ACT_CHANNEL_MAX];
+
+    /**
+     * @protected
+     * @brief Completion callbacks by channel, indexed by sequence
+     */
+    struct
+    {
+        ACT_CALLBACK    callback;
+        void*           obj;
+    }callbacks[ACT_CHANNEL_MAX][ACT_CALLBACKS_MAX];
+
+    /**
+     * @protected
+     * @brief Queue a command item on channel queue
+     * @return Handle, invalid with ACT_ERROR_FULL if queue is full
+     */
+    ActuatorHandle enqueue(uint8_t ch, QueueHandle_t queue, const void* item);
+
+    /**
+     * @protected
+     * @brief Report the oldest running command of channel completed
+     */
+    void complete(uint8_t ch);
+};
+
+#endif /* INC_ACTUATOR_HPP_ */
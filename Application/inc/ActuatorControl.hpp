@@ -0,0 +1,267 @@
+/**
+ * @file    ActuatorControl.hpp
+ * @author  Jeremy ROULLAND
+ * @date    14 oct. 2017
+ * @brief   Actuators orders engine (cylinders, mandibles)
+ */
+
+#ifndef INC_ACTUATORCONTROL_HPP_
+#define INC_ACTUATORCONTROL_HPP_
+
+
+#include "common.h"
+
+// Actuators
+#include "Mandible.hpp"
+#include "Cylinder.hpp"
+
+#include "Coroutine.hpp"
+
+// FreeRTOS
+#include "FreeRTOS.h"
+#include "task.h"
+
+/*----------------------------------------------------------------------------*/
+/* Definitions                                                                */
+/*----------------------------------------------------------------------------*/
+
+/**
+ * @brief Steps per sequence
+ */
+#define AC_SEQUENCE_MAX             (16u)
+
+/**
+ * @brief Sequence actuators (cylinders first, AC_MANDIBLE follows)
+ */
+#define AC_MANDIBLE                 (Cylinder::CYLINDER_MAX)
+#define AC_ACTUATOR_MAX             (AC_MANDIBLE + 1u)
+
+/**
+ * @brief Coroutines run by the task
+ */
+#define AC_COROUTINES_MAX           (32u)
+
+/**
+ * @brief Coroutine slot
+ */
+typedef struct
+{
+    Utils::Coroutine::Function  function;   /**< NULL : free slot */
+    void*                       obj;
+    Utils::Coroutine            co;
+}AC_COROUTINE;
+
+/**
+ * @brief Sequence step
+ *
+ * The step order is sent once the step it depends on has reached percent
+ * (100 : finished) and its actuator channel is free.
+ */
+typedef struct __attribute__((packed))
+{
+    uint8_t     actuator;   /**< Cylinder::ID or AC_MANDIBLE */
+    uint8_t     order;      /**< Cylinder::Order or Mandible::Position */
+    int8_t      index;      /**< Cylinder::GOTO index */
+    int8_t      after;      /**< Previous step it depends on, -1 : none */
+    uint8_t     percent;    /**< Dependency progress to start (%) */
+}AC_STEP;
+
+/*----------------------------------------------------------------------------*/
+/* Class declaration                                                          */
+/*----------------------------------------------------------------------------*/
+
+    /**
+    * @class ActuatorControl
+    * @brief Actuators orders engine
+    *
+    * HOWTO :
+    * - Get instance with GetInstance()
+    * - Send orders to actuators (Cylinder, Mandible), they are queued and
+    *   return at once. Through the common Actuator interface, Start() returns
+    *   a handle to poll, wait or call back on completion
+    * - The task runs every actuator state machine, so independent actuators
+    *   move at the same time. Wait for OrderDone events or poll
+    *   IsPositioningFinished() / IsIdle() / the handle
+    * - The task sleeps while actuators are idle. It is woken by queued
+    *   orders and, on stepper orders, by Drv8813 MoveFinished interrupt
+    * - Or Play() a table of AC_STEP : steps start on their dependency
+    *   progress, so a step can overlap the end of the previous one.
+    *   SequenceDone is raised when every step is finished
+    * - Or Spawn() a coroutine (see Utils::Coroutine) : sequences with
+    *   waits and branches written as straight code, all run by the task
+    *   before the actuators state machines
+    */
+    class ActuatorControl
+    {
+    public:
+        /**
+         * @brief Get instance method
+         * @return ActuatorControl instance
+         */
+        static ActuatorControl* GetInstance();
+
+        /**
+         * @brief ActuatorControl instance name
+         */
+        const char* Name()
+        {
+            return this->name;
+        }
+
+        /**
+         * @brief Return actuator
+         * @param id : Cylinder::ID or AC_MANDIBLE
+         */
+        Actuator* Get(uint8_t id)
+        {
+            return (id < AC_ACTUATOR_MAX) ? this->actuator[id] : NULL;
+        }
+
+        /**
+         * @brief Queue a command on an actuator
+         * @param id : Cylinder::ID or AC_MANDIBLE
+         * @return Handle, invalid if refused
+         */
+        ActuatorHandle Start(uint8_t id, const ACT_COMMAND& cmd);
+
+        /**
+         * @brief Play a sequence (steps are copied)
+         * @param steps : Steps, dependencies on previous steps only
+         * @param n : Number of steps (<= AC_SEQUENCE_MAX)
+         * @return 0 if started, -1 if a sequence is playing, -2 if steps are invalid
+         */
+        int8_t Play(const AC_STEP* steps, uint32_t n);
+
+        /**
+         * @brief Return true while a sequence is playing
+         */
+        bool IsPlaying()
+        {
+            return this->pending || (this->count != 0u);
+        }
+
+        /**
+         * @brief Run a coroutine until it returns CO_DONE
+         * @param function : Coroutine function
+         * @param obj : Coroutine data (must outlive the coroutine)
+         * @return Coroutine ID, -1 if every slot is used
+         */
+        int8_t Spawn(Utils::Coroutine::Function function, void* obj);
+
+        /**
+         * @brief Return true while coroutine runs
+         * @param id : Coroutine ID given by Spawn()
+         */
+        bool IsRunning(int8_t id)
+        {
+            return (id >= 0) && (id < static_cast<int8_t>(AC_COROUTINES_MAX)) && (this->coroutines[id].function != NULL);
+        }
+
+        /**
+         * @brief Sequence finished event
+         */
+        Utils::Event<> SequenceDone;
+
+        /**
+         * @private
+         * @brief Wake up task (order queued). DO NOT CALL !!
+         */
+        void INTERNAL_Wake();
+
+        /**
+         * @private
+         * @brief Wake up task from interrupt (motion finished). DO NOT CALL !!
+         */
+        void INTERNAL_WakeFromISR();
+
+    protected:
+        /**
+         * @brief ActuatorControl default constructor
+         */
+        ActuatorControl();
+
+        /**
+         * @protected
+         * @brief Instance name
+         */
+        const char* name;
+
+        /**
+         * @protected
+         * @brief Actuators, indexed by AC_STEP actuator
+         */
+        Actuator* actuator[AC_ACTUATOR_MAX];
+
+        /**
+         * @protected
+         * @brief Playing sequence and steps state
+         */
+        AC_STEP sequence[AC_SEQUENCE_MAX];
+        uint8_t state[AC_SEQUENCE_MAX];
+        uint32_t count;
+
+        /**
+         * @protected
+         * @brief Sequence given by Play(), taken by the task
+         */
+        AC_STEP next[AC_SEQUENCE_MAX];
+        uint32_t nextCount;
+        volatile bool pending;
+
+        /**
+         * @protected
+         * @brief Coroutines slots
+         */
+        AC_COROUTINE coroutines[AC_COROUTINES_MAX];
+
+        /**
+         * @brief Resume coroutines
+         */
+        void resume();
+
+        /**
+         * @brief Start and follow sequence steps
+         */
+        void play();
+
+        /**
+         * @brief Return step actuator channel progress (%)
+         */
+        uint8_t progress(const AC_STEP* step);
+
+        /**
+         * @brief Return true if step actuator channel is free
+         */
+        bool isFree(const AC_STEP* step);
+
+        /**
+         * @brief Send step order
+         */
+        void send(const AC_STEP* step);
+
+        /**
+         * @brief Run actuators state machines
+         */
+        void Compute();
+
+        /**
+         * @brief Return true if an order or a sequence is running
+         */
+        bool isActive();
+
+        /**
+         * @protected
+         * @brief OS Task handle
+         */
+        TaskHandle_t taskHandle;
+
+        /**
+         * @protected
+         * @brief loop task handler
+         * @param obj : Always NULL
+         */
+        void taskHandler (void* obj);
+
+    };
+
+#endif /* INC_ACTUATORCONTROL_HPP_ */
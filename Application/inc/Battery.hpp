@@ -0,0 +1,129 @@
+/**
+ * @file    Battery.hpp
+ * @author  Jeremy ROULLAND
+ * @date    15 oct. 2026
+ * @brief   Battery voltage monitor and motion limits scale
+ */
+
+#ifndef INC_BATTERY_HPP_
+#define INC_BATTERY_HPP_
+
+#include "common.h"
+
+#include "ADConverter.hpp"
+#include "Filter.hpp"
+
+/*----------------------------------------------------------------------------*/
+/* Definitions                                                                */
+/*----------------------------------------------------------------------------*/
+
+/**
+ * @brief Battery input : PC3 (ADC123_IN13), 100k / 10k divider
+ */
+#define BATTERY_ADC_CHANNEL     (HAL::ADConverter::ADC_Channel0)
+#define BATTERY_DIVIDER         (11.0f)
+#define BATTERY_ADC_VREF        (3.3f)
+#define BATTERY_ADC_FULL_SCALE  (4095.0f)
+
+/**
+ * @brief Updates averaged (320 ms at motion control rate), steps drawn by a
+ * move don't change the limits
+ */
+#define BATTERY_FILTER_SIZE     (64u)
+
+/**
+ * @brief Voltage the configured motion limits are tuned for (worst case)
+ */
+#define BATTERY_V_WORST         (12.0f)
+
+/**
+ * @brief Below : no battery measured (bench supply, input not wired), worst case limits
+ */
+#define BATTERY_V_ABSENT        (6.0f)
+
+/**
+ * @brief Largest limits scale (fresh battery), and scale resolution
+ */
+#define BATTERY_SCALE_MAX       (1.3f)
+#define BATTERY_SCALE_STEP      (0.05f)
+
+/*----------------------------------------------------------------------------*/
+/* Class declaration                                                          */
+/*----------------------------------------------------------------------------*/
+
+/**
+ * @class Battery
+ * @brief Battery voltage from the A/D converter scan, motion limits scale
+ *
+ * HOWTO :
+ * - Get instance with GetInstance()
+ * - Update() periodically (motion control loop)
+ * - Scale worst case velocity and acceleration limits by GetScale()
+ *
+ * Stepper torque at speed and top speed grow with supply voltage : the
+ * scale is voltage / BATTERY_V_WORST, rounded down to BATTERY_SCALE_STEP and
+ * bounded to [1; BATTERY_SCALE_MAX]. A sagging battery brings limits back to
+ * the configured ones, never below.
+ */
+class Battery
+{
+public:
+
+    /**
+     * @brief Get instance method
+     */
+    static Battery* GetInstance ();
+
+    /**
+     * @brief Sample battery voltage, update scale
+     */
+    void Update ();
+
+    /**
+     * @brief Return filtered battery voltage (V)
+     */
+    float32_t GetVoltage ()
+    {
+        return this->voltage;
+    }
+
+    /**
+     * @brief Return motion limits scale (1 : worst case limits)
+     */
+    float32_t GetScale ()
+    {
+        return this->scale;
+    }
+
+    /**
+     * @brief Return false if no battery is measured
+     */
+    bool IsPresent ()
+    {
+        return (this->voltage >= BATTERY_V_ABSENT);
+    }
+
+protected:
+
+    /**
+     * @protected
+     * @brief Constructor
+     */
+    Battery ();
+
+    /**
+     * @protected
+     * @brief Input
+     */
+    HAL::ADConverter* adc;
+    Utils::MovingAverage<BATTERY_FILTER_SIZE> filter;
+
+    /**
+     * @protected
+     * @brief Filtered voltage (V) and limits scale
+     */
+    volatile float32_t voltage;
+    volatile float32_t scale;
+};
+
+#endif /* INC_BATTERY_HPP_ */
@@ -0,0 +1,53 @@
+/**
+ * @file    Bench.hpp
+ * @author  Jeremy ROULLAND
+ * @date    15 oct. 2026
+ * @brief   On-target kernels micro-benchmark
+ */
+
+#ifndef INC_BENCH_HPP_
+#define INC_BENCH_HPP_
+
+#include "common.h"
+
+/*----------------------------------------------------------------------------*/
+/* Definitions                                                                */
+/*----------------------------------------------------------------------------*/
+
+/**
+ * @brief Benchmark firmware (build configuration defines BENCH=1) :
+ * main() only starts the console and Bench::Task()
+ */
+#ifndef BENCH
+#define BENCH                   (0u)
+#endif
+
+/**
+ * @brief Runs per kernel (odd : median is a sample)
+ */
+#define BENCH_RUNS              (101u)
+
+/*----------------------------------------------------------------------------*/
+/* Class declaration                                                          */
+/*----------------------------------------------------------------------------*/
+
+/**
+ * @class Bench
+ * @brief Motion stack kernels cost, in CPU cycles (DWT CYCCNT)
+ *
+ * Each kernel runs BENCH_RUNS times with interrupts masked, on inputs spread
+ * over its range. Min / median / max cycles, minus the measurement overhead,
+ * are printed on the console. Single and double precision variants of the
+ * same math are listed side by side (FPU vs software double).
+ */
+class Bench
+{
+public:
+
+    /**
+     * @brief Benchmark task handler (TaskFunction_t), deletes itself when done
+     */
+    static void Task (void* param);
+};
+
+#endif /* INC_BENCH_HPP_ */
@@ -0,0 +1,132 @@
+/**
+ * @file    Boot.hpp
+ * @author  Jeremy ROULLAND
+ * @date    15 oct. 2026
+ * @brief   Staged initialization (dependency order, deferred stages, boot timing)
+ */
+
+#ifndef INC_BOOT_HPP_
+#define INC_BOOT_HPP_
+
+#include "common.h"
+
+/*----------------------------------------------------------------------------*/
+/* Definitions                                                                */
+/*----------------------------------------------------------------------------*/
+
+/**
+ * @brief Stages by table (timing storage)
+ */
+#define BOOT_STAGES_MAX         (16u)
+
+/**
+ * @brief Ready line to the main board (OUT8) : low while booting, high once
+ * orders are accepted
+ */
+#define BOOT_READY_GPIO         (HAL::GPIO::GPIO39)
+
+/**
+ * @brief Stage dependency mask of stage i
+ */
+#define BOOT_AFTER(i)           (static_cast<uint16_t>(1u << (i)))
+
+/**
+ * @brief Initialization stage
+ *
+ * A stage only depends on earlier ones. A stage needed to accept orders
+ * runs in main() and may not depend on a deferred one.
+ */
+typedef struct
+{
+    const char* NAME;
+    void        (*INIT)(void);
+    uint16_t    AFTER;          /**< Stages it depends on (BOOT_AFTER() mask), 0 : none */
+    bool        DEFERRED;       /**< Run by the boot task, once the scheduler started */
+}BOOT_STAGE;
+
+/*----------------------------------------------------------------------------*/
+/* Class declaration                                                          */
+/*----------------------------------------------------------------------------*/
+
+/**
+ * @class Boot
+ * @brief Stages runner and boot time (microseconds from main())
+ *
+ * HOWTO :
+ * - main() calls Start() with the stages table, then starts the scheduler
+ * - Stages needed to accept orders run at once, in table order
+ * - Deferred stages (console, diagnostics, ...) run in table order from
+ *   the lowest priority task, control loops already running
+ *
+ * The board is ready when a stage calls SetReady() (or once every stage is
+ * done) : ready line is set, status bit is reported to the main board.
+ */
+class Boot
+{
+public:
+
+    /**
+     * @brief Run stages needed to accept orders, create boot task for the others
+     * @param stages : Stages table (linked in flash)
+     * @param count : Number of stages (<= BOOT_STAGES_MAX)
+     */
+    static void Start (const BOOT_STAGE* stages, uint32_t count);
+
+    /**
+     * @brief Board accepts orders : keep ready time, set ready line (stage function)
+     */
+    static void SetReady ();
+
+    /**
+     * @brief Return true once SetReady() was called
+     */
+    static bool IsReady ();
+
+    /**
+     * @brief Return number of stages
+     */
+    static uint32_t Count ();
+
+    /**
+     * @brief Return a stage
+     * @param i : Stage index (< Count())
+     * @return Stage or NULL
+     */
+    static const BOOT_STAGE* GetStage (uint32_t i);
+
+    /**
+     * @brief Return stage duration (us), 0 if not run yet
+     */
+    static uint32_t GetStageTime (uint32_t i);
+
+    /**
+     * @brief Return stage end (us from main()), 0 if not run yet
+     */
+    static uint32_t GetStageEnd (uint32_t i);
+
+    /**
+     * @brief Return time the board was ready to accept orders (us from main()), 0 while booting
+     */
+    static uint32_t GetReadyTime ();
+
+    /**
+     * @brief Return time every stage was done (us from main()), 0 while booting
+     */
+    static uint32_t GetDoneTime ();
+
+protected:
+
+    /**
+     * @protected
+     * @brief Run a stage, keep its timing
+     */
+    static void run (uint32_t i);
+
+    /**
+     * @protected
+     * @brief Boot task handler (TaskFunction_t), deletes itself when done
+     */
+    static void task (void* param);
+};
+
+#endif /* INC_BOOT_HPP_ */
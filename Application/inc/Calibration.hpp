@@ -0,0 +1,183 @@
+/**
+ * @file    Calibration.hpp
+ * @author  Jeremy ROULLAND
+ * @date    15 oct. 2026
+ * @brief   Odometry calibration runner (UMBmark squares, turns against borders)
+ */
+
+#ifndef INC_CALIBRATION_HPP_
+#define INC_CALIBRATION_HPP_
+
+#include "common.h"
+
+#include "MotionControl.hpp"
+#include "TrajectoryPlanning.hpp"
+
+// FreeRTOS
+#include "FreeRTOS.h"
+#include "task.h"
+
+/*----------------------------------------------------------------------------*/
+/* Definitions                                                                */
+/*----------------------------------------------------------------------------*/
+
+#define CALIB_SIDE_MM               (1000)      // Default square side
+#define CALIB_RUNS                  (2u)        // Default squares by direction
+#define CALIB_TURNS                 (5u)        // Default turns
+
+/*----------------------------------------------------------------------------*/
+/* Class declaration                                                          */
+/*----------------------------------------------------------------------------*/
+
+/**
+ * @class Calibration
+ * @brief Measure odometry geometry errors against the table borders, store corrections
+ *
+ * HOWTO :
+ * - Put the robot in a table corner, heading 0 (rear towards the X border),
+ *   less than 150 mm from both borders, motion control enabled
+ * - Get instance with GetInstance(), Start() the calibration, Abort() it
+ *
+ * Borders are the reference : a stall against the X border (MotionControl
+ * StallX()) gives odometry X and heading errors, against the Y border the
+ * Y error. The runner :
+ * 1. Turns N times in place between two X stalls : heading error gives the
+ *    wheels axial distance (adwTick)
+ * 2. Runs UMBmark squares, alternately counterclockwise and clockwise, each
+ *    followed by X and Y stalls : the mean return errors of both directions
+ *    split the wheels axial distance (alpha) and wheels diameter ratio (beta)
+ *    errors, beta gives the diameter ratio (wheelRatio)
+ * 3. Edits the corrected parameters in Config and commits them (motion
+ *    control disabled first), applied at next reset
+ *
+ * Wheel diameter (tickByMm) is not observable without a known distance : kept.
+ */
+class Calibration
+{
+public:
+
+    /**
+     * @brief Get instance method
+     */
+    static Calibration* GetInstance ();
+
+    /**
+     * @brief Start a calibration
+     * @param side : Square side (mm)
+     * @param runs : Squares by direction
+     * @param turns : Turns in place
+     * @return false if a calibration is running or parameters are invalid
+     */
+    bool Start (int32_t side, uint32_t runs, uint32_t turns);
+
+    /**
+     * @brief Abort running calibration (after current order, nothing saved)
+     */
+    void Abort ()
+    {
+        this->abort = true;
+    }
+
+    /**
+     * @brief Return true while a calibration runs
+     */
+    bool IsRunning ()
+    {
+        return this->running;
+    }
+
+protected:
+
+    Calibration ();
+
+    /**
+     * @protected
+     * @brief Instance name
+     */
+    const char* name;
+
+    MotionControl::FBMotionControl*     mc;
+    MotionControl::TrajectoryPlanning*  tp;
+    Location::Odometry*                 odometry;
+
+    /**
+     * @protected
+     * @brief Run parameters, state
+     */
+    int32_t side;
+    uint32_t runs;
+    uint32_t turns;
+    volatile bool running;
+    volatile bool abort;
+
+    /**
+     * @protected
+     * @brief Tag of the last pushed order
+     */
+    uint16_t tag;
+
+    /**
+     * @protected
+     * @brief Return next order tag
+     */
+    uint16_t nextTag ();
+
+    /**
+     * @protected
+     * @brief Wait for the last pushed order
+     * @param pushed : Order push result
+     * @return false on refused order, abort or timeout
+     */
+    bool wait (bool pushed);
+
+    /**
+     * @protected
+     * @brief Stall against X or Y border
+     * @param y : Y border, else X border
+     * @param contact : Odometry at contact (before reset)
+     * @return false if no border was found
+     */
+    bool stall (bool y, robot_t* contact);
+
+    /**
+     * @protected
+     * @brief Reset odometry on both borders, robot left at (margin, margin), heading PI/2
+     */
+    bool reference ();
+
+    /**
+     * @protected
+     * @brief Turn in place, measure heading error
+     * @param error : Odometry heading error after the turns (rad)
+     */
+    bool rotate (float32_t* error);
+
+    /**
+     * @protected
+     * @brief Run a square from (margin, margin), measure return error
+     * @param cw : Clockwise, else counterclockwise
+     * @param ex, ey : Odometry return error (mm)
+     */
+    bool square (bool cw, float32_t* ex, float32_t* ey);
+
+    /**
+     * @protected
+     * @brief Run the calibration, print report, save
+     */
+    void run ();
+
+    /**
+     * @protected
+     * @brief OS Task handle
+     */
+    TaskHandle_t taskHandle;
+
+    /**
+     * @protected
+     * @brief Calibration task handler
+     * @param obj : Always NULL
+     */
+    void taskHandler (void* obj);
+};
+
+#endif /* INC_CALIBRATION_HPP_ */
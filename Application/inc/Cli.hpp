@@ -11,9 +11,6 @@
 
 #include "common.h"
 
-// For std::string
-#include <algorithm>
-
 // MotionControl
 #include "Odometry.hpp"
 #include "MotionControl.hpp"
@@ -23,6 +20,9 @@
 #include "Mandible.hpp"
 
 #include "Diag.hpp"
+#include "SerialProtocol.hpp"
+#include "Scripts.hpp"
+#include "Calibration.hpp"
 
 // FreeRTOS
 #include "FreeRTOS.h"
@@ -39,6 +39,21 @@ using namespace MotionControl;
 
 typedef void (*FunctionFunc)();
 
+/**
+ * @brief Command line buffer size (NULL included)
+ */
+#define CLI_LINE_MAX                 (128u)
+
+/**
+ * @brief Batch separator (commands of one line run in a single pass)
+ */
+#define CLI_BATCH_SEPARATOR          (';')
+
+/**
+ * @brief Recall previous line (Ctrl-P)
+ */
+#define CLI_HISTORY_KEY              ('\x10')
+
 
 /*----------------------------------------------------------------------------*/
 /* Class declaration                                                          */
@@ -68,7 +83,7 @@ typedef void (*FunctionFunc)();
         /**
          * @brief Diag instance name
          */
-        std::string Name()
+        const char* Name()
         {
             return this->name;
         }
@@ -83,7 +98,7 @@ typedef void (*FunctionFunc)();
          * @protected
          * @brief Instance name
          */
-        std::string name;
+        const char* name;
 
         Odometry           *odometry;
         PositionControl    *pc;
@@ -94,13 +109,211 @@ typedef void (*FunctionFunc)();
 
         Mandible* man;
 
+        /**
+         * @protected
+         * @brief Serial link used for commands input
+         */
+        HAL::Serial* serial;
+
+        /**
+         * @protected
+         * @brief Binary frames on the same link
+         */
+        SerialProtocol* rpc;
+
+        /**
+         * @protected
+         * @brief Stored orders scripts runner
+         */
+        Scripts* scripts;
+
+        /**
+         * @protected
+         * @brief Odometry calibration runner
+         */
+        Calibration* calibration;
+
+        /**
+         * @protected
+         * @brief Command line buffer (tokenized in place)
+         */
+        Utils::StaticString<CLI_LINE_MAX - 1u> line;
+
+        /**
+         * @protected
+         * @brief Last executed line (recalled by CLI_HISTORY_KEY)
+         */
+        Utils::StaticString<CLI_LINE_MAX - 1u> history;
+
+        /**
+         * @protected
+         * @brief Characters were dropped from current line
+         */
+        bool overflow;
+
+        /**
+         * @protected
+         * @brief Previous received character
+         */
+        char lastChar;
+
+        /**
+         * @brief Command handler
+         * @param argc : Number of arguments (command name included)
+         * @param argv : Arguments (argv[0] is the command name)
+         */
+        typedef void (CLI::*CommandHandler)(uint32_t argc, char* argv[]);
+
+        /**
+         * @brief Command table entry
+         */
+        typedef struct
+        {
+            const char*    name;
+            CommandHandler handler;
+        }command_t;
+
+        /**
+         * @protected
+         * @brief Commands table, sorted by strcmp() order
+         */
+        static const command_t commands[];
+
+        /**
+         * @protected
+         * @brief Number of commands in table
+         */
+        static const uint32_t commandsCount;
+
         void Start();
 
         /**
-         * @brief Compute traces spreading
+         * @brief Process every received character
          */
         void Compute(float32_t period);
 
+        /**
+         * @brief Process one received character (shortcut, edition, end of line)
+         */
+        void input(char c);
+
+        /**
+         * @brief Execute current line, clear it and print prompt
+         */
+        void endOfLine();
+
+        /**
+         * @brief Replace current line by a preset batch and execute it
+         */
+        void preset(const char* batch);
+
+        /**
+         * @brief Split current line on CLI_BATCH_SEPARATOR and dispatch each command
+         */
+        void execute();
+
+        /**
+         * @brief Tokenize and dispatch one command
+         * @param cmd : Command (tokenized in place)
+         * @param batch : Print a "> name" header before the command output
+         * @return false if the command is unknown
+         */
+        bool dispatch(char* cmd, bool batch);
+
+        /**
+         * @brief Split a string on spaces in place
+         * @param str : String to split (separators are replaced by NULL)
+         * @param argv : Tokens
+         * @param max : Maximum number of tokens
+         * @return Number of tokens
+         */
+        static uint32_t tokenize(char* str, char* argv[], uint32_t max);
+
+        /**
+         * @brief Commands handlers
+         */
+        void cmdHelp(uint32_t argc, char* argv[]);
+        void cmdEnable(uint32_t argc, char* argv[]);
+        void cmdDisable(uint32_t argc, char* argv[]);
+        void cmdEstop(uint32_t argc, char* argv[]);
+        void cmdGoLin(uint32_t argc, char* argv[]);
+        void cmdMcGoLin(uint32_t argc, char* argv[]);
+        void cmdGoAng(uint32_t argc, char* argv[]);
+        void cmdMcGoAng(uint32_t argc, char* argv[]);
+        void cmdGoto(uint32_t argc, char* argv[]);
+        void cmdGoArc(uint32_t argc, char* argv[]);
+        void cmdMcArc(uint32_t argc, char* argv[]);
+        void cmdMcGoto(uint32_t argc, char* argv[]);
+        void cmdGetOdo(uint32_t argc, char* argv[]);
+        void cmdSetOdo(uint32_t argc, char* argv[]);
+        void cmdFree(uint32_t argc, char* argv[]);
+        void cmdStop(uint32_t argc, char* argv[]);
+        void cmdMcStop(uint32_t argc, char* argv[]);
+        void cmdCheckup(uint32_t argc, char* argv[]);
+        void cmdSafeguard(uint32_t argc, char* argv[]);
+        void cmdStatus(uint32_t argc, char* argv[]);
+        void cmdMc(uint32_t argc, char* argv[]);
+        void cmdSetVelLin(uint32_t argc, char* argv[]);
+        void cmdSetVelAng(uint32_t argc, char* argv[]);
+        void cmdSetAccLin(uint32_t argc, char* argv[]);
+        void cmdSetAccAng(uint32_t argc, char* argv[]);
+        void cmdRise(uint32_t argc, char* argv[]);
+        void cmdLower(uint32_t argc, char* argv[]);
+        void cmdCpu(uint32_t argc, char* argv[]);
+        void cmdMcTest(uint32_t argc, char* argv[]);
+        void cmdKi(uint32_t argc, char* argv[]);
+        void cmdSched(uint32_t argc, char* argv[]);
+        void cmdPerf(uint32_t argc, char* argv[]);
+        void cmdTpStat(uint32_t argc, char* argv[]);
+        void cmdEncStat(uint32_t argc, char* argv[]);
+        void cmdMem(uint32_t argc, char* argv[]);
+        void cmdRamFunc(uint32_t argc, char* argv[]);
+        void cmdPower(uint32_t argc, char* argv[]);
+        void cmdTrace(uint32_t argc, char* argv[]);
+        void cmdScope(uint32_t argc, char* argv[]);
+        void cmdScript(uint32_t argc, char* argv[]);
+        void cmdDiag(uint32_t argc, char* argv[]);
+        void cmdPeek(uint32_t argc, char* argv[]);
+        void cmdPoke(uint32_t argc, char* argv[]);
+        void cmdWatch(uint32_t argc, char* argv[]);
+        void cmdSwo(uint32_t argc, char* argv[]);
+        void cmdSync(uint32_t argc, char* argv[]);
+        void cmdConfig(uint32_t argc, char* argv[]);
+        void cmdParam(uint32_t argc, char* argv[]);
+        void cmdTune(uint32_t argc, char* argv[]);
+        void cmdPcMode(uint32_t argc, char* argv[]);
+        void cmdPreset(uint32_t argc, char* argv[]);
+        void cmdRoute(uint32_t argc, char* argv[]);
+        void cmdCurve(uint32_t argc, char* argv[]);
+        void cmdLatency(uint32_t argc, char* argv[]);
+        void cmdBoot(uint32_t argc, char* argv[]);
+        void cmdBattery(uint32_t argc, char* argv[]);
+        void cmdCrash(uint32_t argc, char* argv[]);
+        void cmdWdog(uint32_t argc, char* argv[]);
+        void cmdCalib(uint32_t argc, char* argv[]);
+
+        /**
+         * @brief Print tasks CPU load and loops execution time
+         */
+        void CpuStats();
+
+        /**
+         * @brief Print execution time histogram of a profiler
+         * @param index : Profiler index (see CpuStats())
+         */
+        void CpuHistogram(uint32_t index);
+
+        /**
+         * @brief Print periodic loops scheduling statistics
+         */
+        void SchedStats();
+
+        /**
+         * @brief Print jitter histogram of a periodic loop
+         * @param index : Loop index (see SchedStats())
+         */
+        void SchedHistogram(uint32_t index);
+
 
         /**
          * @protected
@@ -0,0 +1,162 @@
+/**
+ * @file    CmdSchema.hpp
+ * @author  Jeremy ROULLAND
+ * @date    15 oct. 2026
+ * @brief   Motion orders message schema (identifiers, payloads, fixed size slot)
+ */
+
+#ifndef INC_CMDSCHEMA_HPP_
+#define INC_CMDSCHEMA_HPP_
+
+#include "common.h"
+
+#include <stddef.h>
+
+/*----------------------------------------------------------------------------*/
+/* Definitions                                                                */
+/*----------------------------------------------------------------------------*/
+
+/**
+ * @brief Schema version : increment on any change of an identifier or a payload
+ */
+#define CMD_SCHEMA_VERSION          (3u)
+
+/**
+ * @brief Message slot (header + payload), queued by copy
+ */
+#define CMD_SLOT_SIZE               (16u)
+#define CMD_PAYLOAD_SIZE            (8u)
+
+/**
+ * @brief Payload types
+ */
+typedef struct
+{
+    float32_t x;
+    float32_t y;
+}cmd_xy_t;
+
+typedef struct
+{
+    float32_t radius;
+    float32_t length;
+}cmd_arc_t;
+
+/**
+ * @brief Payloads : X(type, member)
+ */
+#define CMD_PAYLOADS(X)                                             \
+    X(uint8_t,      none)       /**< No payload */                  \
+    X(float32_t,    d)          /**< Distance (m) */                \
+    X(float32_t,    a)          /**< Angle (rad) */                 \
+    X(cmd_xy_t,     xy)         /**< Target (m) */                  \
+    X(cmd_arc_t,    arc)        /**< Radius, length (m) */          \
+    X(uint32_t,     route)      /**< Route identifier (see Routes) */
+
+/**
+ * @brief Orders : X(name, identifier, payload member)
+ *
+ * Single definition of the orders : identifiers, names and payload checks
+ * are generated from it. To add an order, add a line (and a payload if
+ * none fits), increment CMD_SCHEMA_VERSION, handle it in
+ * FBMotionControl::dispatch().
+ */
+#define CMD_ORDERS(X)                                               \
+    X(GOTO,         0x40,   xy)                                     \
+    X(GOLIN,        0x41,   d)                                      \
+    X(GOANG,        0x42,   a)                                      \
+    X(ROUTE,        0x43,   route)                                  \
+    X(STALLX,       0x44,   none)                                   \
+    X(STALLY,       0x45,   none)                                   \
+    X(ARC,          0x46,   arc)                                    \
+    X(ARCTO,        0x47,   xy)                                     \
+    X(STREAM,       0x48,   none)
+
+typedef enum : int8_t
+{
+    CMD_ID_UNKNOWN              =   -1,
+    CMD_ID_GET_ANGLE            =   0x21,
+#define CMD_ENUM(name, id, payload)     CMD_ID_##name = id,
+    CMD_ORDERS(CMD_ENUM)
+#undef CMD_ENUM
+    CMD_ID_SET_POSITION         =   0x50,
+    CMD_ID_SET_ANGLE            =   0x51,
+}CMD_TYPE;
+
+/**
+ * @brief Order submission mode
+ */
+typedef enum
+{
+    CMD_MODE_APPEND             =    0,     /**< Queued after pending orders */
+    CMD_MODE_PREEMPT            =    1,     /**< Aborts current order, pending orders resume after it */
+    CMD_MODE_REPLACE            =    2,     /**< Aborts current order and flushes pending ones */
+    CMD_MODE_MAX
+}CMD_MODE;
+
+/**
+ * @brief Order payload
+ */
+typedef union
+{
+#define CMD_MEMBER(type, member)        type member;
+    CMD_PAYLOADS(CMD_MEMBER)
+#undef CMD_MEMBER
+    uint8_t raw[CMD_PAYLOAD_SIZE];
+}cmd_data_t;
+
+/**
+ * @brief Order message
+ */
+struct cmd_t
+{
+    CMD_TYPE id;
+    uint8_t mode;               /**< CMD_MODE */
+    uint16_t tag;               /**< Order identifier for acknowledgement (0 : none) */
+    uint32_t stamp;             /**< Submission time (Utils::Clock microseconds, set by Push()) */
+    cmd_data_t data;
+};
+
+// Layout is fixed : a payload growing past its slot must not compile
+#define CMD_CHECK(type, member)         static_assert(sizeof(type) <= CMD_PAYLOAD_SIZE, "cmd_t payload " #member " too large");
+CMD_PAYLOADS(CMD_CHECK)
+#undef CMD_CHECK
+#define CMD_CHECK(name, id, payload)    static_assert(sizeof(cmd_data_t::payload) > 0u, "order " #name " payload unknown");
+CMD_ORDERS(CMD_CHECK)
+#undef CMD_CHECK
+static_assert(sizeof(cmd_data_t) == CMD_PAYLOAD_SIZE, "cmd_t payload size changed");
+static_assert(offsetof(struct cmd_t, data) == (CMD_SLOT_SIZE - CMD_PAYLOAD_SIZE), "cmd_t header layout changed");
+static_assert(sizeof(struct cmd_t) == CMD_SLOT_SIZE, "cmd_t slot size changed");
+
+/**
+ * @brief Return true if id is an order of the schema
+ */
+static inline bool CmdIsOrder (CMD_TYPE id)
+{
+    switch(id)
+    {
+#define CMD_CASE(name, id, payload)     case CMD_ID_##name:
+    CMD_ORDERS(CMD_CASE)
+#undef CMD_CASE
+        return true;
+    default:
+        return false;
+    }
+}
+
+/**
+ * @brief Get order name (traces, CLI)
+ */
+static inline const char* CmdName (CMD_TYPE id)
+{
+    switch(id)
+    {
+#define CMD_CASE(name, id, payload)     case CMD_ID_##name: return #name;
+    CMD_ORDERS(CMD_CASE)
+#undef CMD_CASE
+    default:
+        return "UNKNOWN";
+    }
+}
+
+#endif /* INC_CMDSCHEMA_HPP_ */
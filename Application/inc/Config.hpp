@@ -0,0 +1,163 @@
+/**
+ * @file    Config.hpp
+ * @author  Jeremy ROULLAND
+ * @date    22 oct. 2017
+ * @brief   Non volatile configuration
+ */
+
+#ifndef INC_CONFIG_HPP_
+#define INC_CONFIG_HPP_
+
+#include "common.h"
+
+/*----------------------------------------------------------------------------*/
+/* Definitions                                                                */
+/*----------------------------------------------------------------------------*/
+
+/**
+ * @brief Configuration layout version
+ *
+ * Increment on any CONFIG_DATA change : records of another version are
+ * ignored (defaults are used until the next commit)
+ */
+#define CONFIG_VERSION                  (5u)
+
+/**
+ * @brief Configuration data (read in place from flash)
+ */
+typedef struct
+{
+    // PositionControl
+    float32_t   angularVelMax;          /**< rad/s */
+    float32_t   angularAccMax;          /**< rad/s^2 */
+    float32_t   linearVelMax;           /**< m/s */
+    float32_t   linearAccMax;           /**< m/s^2 */
+    float32_t   angularKp;
+    float32_t   angularKi;
+    float32_t   angularKd;
+    float32_t   linearKp;
+    float32_t   linearKi;
+    float32_t   linearKd;
+
+    // PositionControl fast preset (see PositionControl::SelectPreset())
+    float32_t   fastAngularVelMax;      /**< rad/s */
+    float32_t   fastAngularAccMax;      /**< rad/s^2 */
+    float32_t   fastLinearVelMax;       /**< m/s */
+    float32_t   fastLinearAccMax;       /**< m/s^2 */
+    float32_t   fastAngularKp;
+    float32_t   fastAngularKi;
+    float32_t   fastAngularKd;
+    float32_t   fastLinearKp;
+    float32_t   fastLinearKi;
+    float32_t   fastLinearKd;
+
+    // Odometry
+    float64_t   tickByMm;               /**< Encoder ticks by wheel mm */
+    float64_t   adwTick;                /**< Axial distance between wheels (ticks) */
+    float64_t   wheelRatio;             /**< Right / left wheel diameter (UMBmark Ed) */
+
+    // Cylinder
+    float32_t   cylinder0Ratio;         /**< Steps by index */
+
+    // Link
+    float32_t   boardAddress;           /**< Board on the shared I2C / CAN bus (0 to I2CP_BOARD_MAX - 1) */
+
+    // Wheel steppers
+    float32_t   wheelBandLow;           /**< Resonance band lower edge (RPS, see Drv8813::SetResonanceBand()) */
+    float32_t   wheelBandHigh;          /**< Resonance band upper edge (RPS), not above low : none */
+}CONFIG_DATA;
+
+/*----------------------------------------------------------------------------*/
+/* Class declaration                                                          */
+/*----------------------------------------------------------------------------*/
+
+/**
+ * @class Config
+ * @brief Non volatile configuration store
+ *
+ * HOWTO :
+ * - Read parameters with Config::Get()->xxx (no copy, no parsing)
+ * - Edit with Set() (by index, see Count() / GetName() / Find()), then
+ *   Commit() to flash, Default() restores default values before a commit
+ * - Capture() edits parameters with live values (Utils::Param of the same name)
+ *
+ * Records (header, CONFIG_DATA, CRC) are appended in one of two flash banks
+ * (HAL::Flash CONFIG0 / CONFIG1), the valid record with the highest
+ * sequence wins. A full bank is left untouched until the record is written
+ * in the other (erased) one : a reset during a commit keeps the previous
+ * configuration. Get() points to defaults if no valid record exists.
+ *
+ * Modules read their parameters at init : committed values apply at next reset.
+ * Commit() stalls the CPU (flash erase up to 2 s) : do not commit while moving.
+ */
+class Config
+{
+public:
+
+    /**
+     * @brief Return current configuration, loaded on first call
+     */
+    static const CONFIG_DATA* Get ();
+
+    /**
+     * @brief Return number of editable parameters
+     */
+    static uint32_t Count ();
+
+    /**
+     * @brief Return parameter name
+     * @param index : Parameter index (< Count())
+     * @return Name or NULL
+     */
+    static const char* GetName (uint32_t index);
+
+    /**
+     * @brief Return parameter index from name
+     * @param name : Parameter name
+     * @return Index or -1 if not found
+     */
+    static int32_t Find (const char* name);
+
+    /**
+     * @brief Return edited parameter value (current value if not edited)
+     * @param index : Parameter index (< Count())
+     */
+    static float64_t GetValue (uint32_t index);
+
+    /**
+     * @brief Edit a parameter (not committed)
+     * @param index : Parameter index (< Count())
+     * @param value : New value
+     * @return false if index is invalid
+     */
+    static bool Set (uint32_t index, float64_t value);
+
+    /**
+     * @brief Restore default values in the edit copy (not committed)
+     */
+    static void Default ();
+
+    /**
+     * @brief Copy registered live parameters (Utils::Param of the same name) in the edit copy
+     * @return Number of parameters copied
+     */
+    static uint32_t Capture ();
+
+    /**
+     * @brief Return true if the edit copy differs from current configuration
+     */
+    static bool IsModified ();
+
+    /**
+     * @brief Write the edit copy to flash, it becomes the current configuration
+     * @return true on success
+     */
+    static bool Commit ();
+
+    /**
+     * @brief Return current record sequence (0 if defaults)
+     */
+    static uint32_t GetSequence ();
+};
+
+#endif /* INC_CONFIG_HPP_ */
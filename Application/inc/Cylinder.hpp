@@ -12,6 +12,11 @@
 #include "common.h"
 
 #include "DRV8813.hpp"
+#include "Event.hpp"
+#include "Actuator.hpp"
+
+#include "FreeRTOS.h"
+#include "queue.h"
 
 /*----------------------------------------------------------------------------*/
 /* Definitions                                                                */
@@ -28,8 +33,37 @@ typedef struct
     bool                canRise;
     float32_t           ratio;
     uint16_t            speed;
+    uint32_t            accel;
 }CYL_DEF;
 
+/**
+ * @brief Orders queued per channel
+ */
+#define CYL_ORDERS_MAX  (8u)
+
+/**
+ * @brief Cylinder order
+ */
+typedef struct
+{
+    uint8_t             order;
+    int8_t              index;
+}CYL_ORDER;
+
+/**
+ * @brief Cylinder channel (orders executed one after the other)
+ */
+typedef struct
+{
+    QueueHandle_t       orders;
+    StaticQueue_t       ordersBuffer;
+    uint8_t             ordersStorage[CYL_ORDERS_MAX * sizeof(CYL_ORDER)];
+    CYL_ORDER           current;
+    bool                busy;
+    TickType_t          deadline;
+    uint32_t            total;
+}CYL_CHANNEL;
+
 /*----------------------------------------------------------------------------*/
 /* Class declaration                                                          */
 /*----------------------------------------------------------------------------*/
@@ -41,8 +75,26 @@ typedef struct
  * HOWTO :
  * -
  *
+ * Orders are queued and executed by Process() (ActuatorControl task) :
+ * rotation orders (Goto, SearchRefPoint) and lift orders (Open, Close,
+ * Raise, Lower) run on two channels, so rotation and lift can overlap.
+ * OrderDone is raised when an order completes.
+ *
+ * Shift() moves by an index offset from the previous target (queued or
+ * reached), resolved when the order starts : a broadcast "index + 1" keeps
+ * every cylinder in step whatever its position.
+ *
+ * Consecutive queued Goto() orders turning the same way are merged into a
+ * single ramped move : each hop takes the shortest path from the previous
+ * target (not from the current position) and OrderDone is raised as the
+ * cylinder passes each intermediate index, without stopping.
+ *
+ * Position is tracked from the steps delivered by the motor driver. The topz
+ * edge is latched by interrupt each time the cylinder passes index 0, so the
+ * origin is resynchronized continuously and SearchRefPoint() only sweeps
+ * while no edge was seen since boot.
  */
-class Cylinder
+class Cylinder : public Actuator
 {
 public:
 
@@ -56,11 +108,49 @@ public:
         CYLINDER_MAX
     };
 
+    /**
+     * @brief Cylinder channels
+     */
+    enum Channel
+    {
+        ROTATION = 0,
+        LIFT,
+        CHANNEL_MAX
+    };
+
+    /**
+     * @brief Cylinder orders
+     */
+    enum Order
+    {
+        OPEN = 0,
+        CLOSE,
+        RAISE,
+        LOWER,
+        GOTO,
+        SEARCH,
+        SHIFT       //!< GOTO relative to the previous target (index is an offset)
+    };
+
     /**
      * @brief Get instance method
      */
     static Cylinder* GetInstance(Cylinder::ID id);
 
+    /**
+     * @brief Queue an order (Actuator interface : order is a Cylinder::Order, arg the GOTO index)
+     */
+    ActuatorHandle Start(const ACT_COMMAND& cmd);
+
+    /**
+     * @brief Return channel running an order
+     */
+    uint8_t GetChannel(const ACT_COMMAND& cmd);
+
+    /**
+     * @brief Orders below are queued, they return 0 or a negative error
+     * (-1 / -2 : index out of range or no lift motor, -3 : queue full)
+     */
     int8_t Open();
 
     int8_t Close();
@@ -71,10 +161,75 @@ public:
 
     int8_t Goto(int8_t index);
 
+    /**
+     * @brief Queue a sequence of rotation targets (all or none, -3 if they do not fit)
+     */
+    int8_t Goto(const int8_t* indexes, uint8_t count);
+
     int8_t SearchRefPoint();
 
+    /**
+     * @brief Queue a rotation by offset indexes from the previous target (wrapped)
+     */
+    int8_t Shift(int8_t offset);
+
     bool IsPositioningFinished();
 
+    using Actuator::IsIdle;
+
+    /**
+     * @brief Return true if no order is queued or running on channel (Cylinder::Channel)
+     */
+    bool IsIdle(uint8_t ch);
+
+    /**
+     * @brief Return channel progress in percent (0 : order queued, 100 : idle)
+     */
+    uint8_t GetProgress(uint8_t ch);
+
+    /**
+     * @brief Start queued orders and check running ones (non blocking)
+     */
+    void Process();
+
+    /**
+     * @brief Motor move finished or origin latched (interrupt context)
+     */
+    Utils::Event<> MotionFinished;
+
+    /**
+     * @brief Return index measured from delivered steps
+     */
+    int8_t GetIndex();
+
+    /**
+     * @brief Return true once topz edge is latched
+     */
+    bool IsHomed()
+    {
+        return this->homed;
+    }
+
+    /**
+     * @brief Return true if last rotation stopped on a motor stall
+     */
+    bool IsStalled()
+    {
+        return this->motor->IsStalled();
+    }
+
+    /**
+     * @private
+     * @brief Internal rotation motor stall callback. DO NOT CALL !!
+     */
+    void INTERNAL_MotorStalled();
+
+    /**
+     * @private
+     * @brief Internal topz interrupt callback. DO NOT CALL !!
+     */
+    void INTERNAL_TopzChanged();
+
 protected:
     /**
      * @protected
@@ -123,6 +278,88 @@ protected:
       * @brief private definitions
       */
      HAL::GPIO* topz;
+
+     /**
+      * @protected
+      * @brief Motor steps at index 0 (latched on topz edge)
+      */
+     volatile int32_t origin;
+
+     /**
+      * @protected
+      * @brief topz edge latched since boot
+      */
+     volatile bool homed;
+
+     /**
+      * @protected
+      * @brief Motor steps for one cylinder turn
+      */
+     int32_t stepsPerTurn;
+
+     /**
+      * @protected
+      * @brief Return motor steps from index 0, wrapped in [0, stepsPerTurn[
+      */
+     int32_t currentSteps();
+
+     /**
+      * @protected
+      * @brief Order channels
+      */
+     CYL_CHANNEL channel[CHANNEL_MAX];
+
+     /**
+      * @protected
+      * @brief Queue order on channel
+      */
+     ActuatorHandle push(Cylinder::Channel ch, Cylinder::Order order, int8_t index = 0);
+
+     /**
+      * @protected
+      * @brief Return target index offset indexes from index, wrapped in [0, indexMax]
+      */
+     int8_t shifted(int8_t index, int8_t offset);
+
+     /**
+      * @protected
+      * @brief Start order, return true if already completed
+      */
+     bool start(const CYL_ORDER* order, TickType_t* deadline, uint32_t* total);
+
+     /**
+      * @protected
+      * @brief Check running order, return true when completed
+      */
+     bool check(const CYL_ORDER* order, TickType_t deadline);
+
+     /**
+      * @protected
+      * @brief Merged rotation : steps from move start to each target (absolute),
+      * targets count, targets passed
+      */
+     int32_t passSteps[CYL_ORDERS_MAX + 1u];
+     uint8_t passCount;
+     uint8_t passDone;
+     int32_t passStart;
+
+     /**
+      * @protected
+      * @brief Steps of the path between two positions (shortest one if enabled)
+      */
+     int32_t path(int32_t from, int32_t to);
+
+     /**
+      * @protected
+      * @brief Start rotation to index, merged with the following queued ones
+      */
+     void move(int8_t index);
+
+     /**
+      * @protected
+      * @brief Raise OrderDone for the merged targets passed (all if finished)
+      */
+     void pass(bool finished);
 };
 
 
@@ -11,18 +11,28 @@
 
 #include "common.h"
 
-// For std::string
-#include <algorithm>
-
 // MotionControl
 #include "Odometry.hpp"
 #include "MotionControl.hpp"
 #include "TrajectoryPlanning.hpp"
 #include "PositionControlStepper.hpp"
 
+// Profiler
+#include "Utils.hpp"
+
 // LED
 #include "GPIO.hpp"
 
+// Telemetry
+#include "Serial.hpp"
+#include "SWO.hpp"
+
+// Tasks stacks
+#include "TaskTable.hpp"
+
+// Performance counters
+#include "Perf.hpp"
+
 // FreeRTOS
 #include "FreeRTOS.h"
 #include "semphr.h"
@@ -39,6 +49,200 @@ using namespace HAL;
 
 typedef void (*FunctionFunc)();
 
+/**
+ * @brief Telemetry frame type
+ */
+#define DIAG_TELEMETRY_MC             (0x01u)
+#define DIAG_TELEMETRY_SCHED          (0x02u)
+#define DIAG_TELEMETRY_MEM            (0x03u)
+#define DIAG_TELEMETRY_TRACE          (0x04u)
+#define DIAG_TELEMETRY_LOG            (0x05u)
+#define DIAG_TELEMETRY_SCOPE          (0x06u)
+#define DIAG_TELEMETRY_TP             (0x07u)
+#define DIAG_TELEMETRY_ENC            (0x08u)
+#define DIAG_TELEMETRY_PERF           (0x09u)
+
+/**
+ * @brief Trace records per trace frame
+ */
+#define DIAG_TRACE_RECORDS            (6u)
+
+/**
+ * @brief Scope samples per scope frame (SCOPE_CHANNELS values each)
+ */
+#define DIAG_SCOPE_SAMPLES            (3u)
+
+/**
+ * @brief Log words per log frame (whole records, see Utils::Log)
+ */
+#define DIAG_LOG_WORDS                (14u)
+
+/**
+ * @brief Largest telemetry frame (before CRC and COBS)
+ */
+#define DIAG_FRAME_MAX                (64u)
+
+/**
+ * @brief Variables printed by the watch channel
+ */
+#define DIAG_WATCH_MAX                (4u)
+
+/**
+ * @brief Largest channel output (text traces or telemetry frame)
+ */
+#define DIAG_CHANNEL_SIZE             (160u)
+
+/**
+ * @brief Motion control telemetry frame
+ *
+ * Sent little endian, followed by a CRC-32 (hardware unit, see HAL::Crc) and COBS encoded
+ * (0x00 delimited) on the Diag serial port.
+ */
+typedef struct __attribute__((packed))
+{
+    uint8_t   type;
+    uint16_t  seq;
+    uint32_t  tick;
+    int32_t   step;
+    float32_t linearPositionProfiled;
+    float32_t angularPositionProfiled;
+    float32_t linearPosition;
+    float32_t linearVelocity;
+    float32_t angularPosition;
+    float32_t angularVelocity;
+}diag_telemetry_mc_t;
+
+/**
+ * @brief Scheduling telemetry frame (one periodic loop per frame, see Utils::PeriodicTask)
+ */
+typedef struct __attribute__((packed))
+{
+    uint8_t   type;
+    uint16_t  seq;
+    uint32_t  tick;
+    uint8_t   index;
+    uint16_t  period;       // Nominal period (ms)
+    uint32_t  periodMax;    // us
+    uint32_t  jitterMax;    // us
+    uint32_t  latencyMax;   // us
+    uint32_t  missed;
+    uint32_t  count;
+}diag_telemetry_sched_t;
+
+/**
+ * @brief Motion states telemetry frame (one state per frame, see TrajectoryPlanning::GetStateStats())
+ */
+typedef struct __attribute__((packed))
+{
+    uint8_t   type;
+    uint16_t  seq;
+    uint32_t  tick;
+    uint8_t   state;        // TrajectoryPlanning state index
+    uint32_t  orders;
+    uint32_t  replaced;
+    uint32_t  cycles;
+    uint32_t  cyclesMax;
+    uint32_t  time;         // ms
+    uint32_t  timeMax;      // ms
+    uint32_t  settled;
+    uint32_t  settle;       // ms
+    uint32_t  settleMax;    // ms
+}diag_telemetry_tp_t;
+
+/**
+ * @brief Encoder health telemetry frame (one wheel per frame, see Odometry::GetEncoderStats())
+ */
+typedef struct __attribute__((packed))
+{
+    uint8_t   type;
+    uint16_t  seq;
+    uint32_t  tick;
+    uint8_t   wheel;        // ODO_LEFT, ODO_RIGHT
+    uint32_t  samples;
+    uint32_t  moving;
+    uint32_t  ticks;
+    uint32_t  peak;         // ticks by sample
+    uint32_t  rejected;
+    uint32_t  jumps;
+    uint32_t  flips;
+}diag_telemetry_enc_t;
+
+/**
+ * @brief Performance telemetry frame (see Perf::GetSummary()), loads in 1/1000
+ */
+typedef struct __attribute__((packed))
+{
+    uint8_t   type;
+    uint16_t  seq;
+    uint32_t  tick;
+    uint32_t  window;       // ms
+    uint16_t  cpu;
+    uint8_t   busiest;      // Utils::Profiler index
+    uint16_t  busiestLoad;
+    uint32_t  loopMax;      // us
+    uint32_t  latencyMax;   // us
+    uint32_t  missed;
+    uint32_t  traceLost;
+    uint32_t  logLost;
+    uint32_t  txDropped;    // bytes
+    uint32_t  deferredDropped;
+    uint16_t  ordersPeak;
+    uint16_t  bus[PERF_BUS_MAX];    // PERF_BUS_* order
+}diag_telemetry_perf_t;
+
+/**
+ * @brief Memory telemetry frame
+ */
+typedef struct __attribute__((packed))
+{
+    uint8_t   type;
+    uint16_t  seq;
+    uint32_t  tick;
+    uint32_t  heapFree;                             // bytes
+    uint32_t  heapMinFree;                          // bytes, minimum ever
+    uint32_t  heapLargest;                          // bytes, largest free block
+    uint16_t  stackFree[TaskTable::TASK_MAX];       // words, high water mark (TaskTable order)
+}diag_telemetry_mem_t;
+
+/**
+ * @brief Trace dump frame (see Utils::Trace), records oldest first
+ */
+typedef struct __attribute__((packed))
+{
+    uint8_t      type;
+    uint16_t     seq;
+    uint16_t     index;                             // First record index
+    uint16_t     total;                             // Records in the dump
+    uint32_t     lost;                              // Records overwritten before the dump
+    uint8_t      count;                             // Records in this frame
+    TRACE_RECORD records[DIAG_TRACE_RECORDS];
+}diag_telemetry_trace_t;
+
+/**
+ * @brief Deferred log frame, records : header (token, arguments count), cycles, arguments
+ */
+typedef struct __attribute__((packed))
+{
+    uint8_t      type;
+    uint16_t     seq;
+    uint16_t     lost;                              // Records dropped since boot (buffer full)
+    uint32_t     words[DIAG_LOG_WORDS];
+}diag_telemetry_log_t;
+
+/**
+ * @brief Scope dump frame (see Utils::Scope), samples oldest first
+ */
+typedef struct __attribute__((packed))
+{
+    uint8_t      type;
+    uint16_t     seq;
+    uint16_t     index;                             // First sample index
+    uint16_t     total;                             // Samples in the dump
+    uint16_t     trigger;                           // Trigger sample index
+    uint8_t      count;                             // Samples in this frame
+    float32_t    samples[DIAG_SCOPE_SAMPLES][SCOPE_CHANNELS];
+}diag_telemetry_scope_t;
+
 
 /*----------------------------------------------------------------------------*/
 /* Class declaration                                                          */
@@ -59,6 +263,58 @@ typedef void (*FunctionFunc)();
     class Diag
     {
     public:
+        /**
+         * @brief Periodic channels (Toggle() index)
+         */
+        enum CHANNEL
+        {
+            TRACES_MC,              //!< Text : step, profiled and measured positions, velocities
+            TRACES_OD,              //!< Text : odometry X, Y, O
+            TELEMETRY_MC,           //!< Motion control frame
+            TELEMETRY_SCHED,        //!< Scheduling frame (one loop per frame)
+            TELEMETRY_MEM,          //!< Memory frame
+            TRACES_WATCH,           //!< Text : watched variables (see Utils::Watch)
+            TELEMETRY_TP,           //!< Motion states frame (one state per frame)
+            TELEMETRY_ENC,          //!< Encoder health frame (one wheel per frame)
+            TELEMETRY_PERF,         //!< Performance counters frame
+            CHANNEL_MAX
+        };
+
+        /**
+         * @brief Channel output builder
+         * @param buffer : Output (DIAG_CHANNEL_SIZE bytes)
+         * @return Output length
+         */
+        typedef uint32_t (Diag::*ChannelBuilder)(uint8_t* buffer);
+
+        /**
+         * @brief Channel definition
+         */
+        typedef struct
+        {
+            const char*    name;
+            ChannelBuilder build;
+            uint16_t       period;      // Default period (ms)
+            uint16_t       heartbeat;   // Sent on change only, at least every heartbeat (ms), 0 : every period
+            uint8_t        priority;    // 0 is the highest, lowest priorities are dropped first
+            uint8_t        header;      // Bytes ignored by change detection (type, seq, tick)
+            bool           binary;      // Telemetry frame (seq set when sent) or text
+        }channel_t;
+
+        /**
+         * @brief Channel state
+         */
+        typedef struct
+        {
+            bool      enable;
+            uint16_t  period;           // ms
+            uint32_t  last;             // Last output time (ms)
+            uint32_t  signature;        // Last output CRC
+            uint32_t  sent;
+            uint32_t  unchanged;        // Not sent : same output, heartbeat not elapsed
+            uint32_t  dropped;          // Not sent : link budget exceeded
+        }channel_state_t;
+
         /**
          * @brief Get instance method
          * @return Diag instance
@@ -68,16 +324,137 @@ typedef void (*FunctionFunc)();
         /**
          * @brief Diag instance name
          */
-        std::string Name()
+        const char* Name()
         {
             return this->name;
         }
 
+        /**
+         * @brief Get Compute() execution time profiler
+         */
+        Utils::Profiler* GetProfiler()
+        {
+            return &this->profiler;
+        }
+
         void Toggle(uint16_t i = 0)
         {
-        	this->enable[i] = ! this->enable[i];
+        	this->channelState[i].enable = ! this->channelState[i].enable;
         }
 
+        /**
+         * @brief Get channel definition, NULL past the last channel
+         */
+        static const channel_t* GetChannel(uint32_t c)
+        {
+            return (c < CHANNEL_MAX) ? &channels[c] : NULL;
+        }
+
+        /**
+         * @brief Get channel state, NULL past the last channel
+         */
+        const channel_state_t* GetChannelState(uint32_t c)
+        {
+            return (c < CHANNEL_MAX) ? &this->channelState[c] : NULL;
+        }
+
+        /**
+         * @brief Find a channel by name
+         * @return Channel index, -1 if unknown
+         */
+        static int32_t FindChannel(const char* name);
+
+        /**
+         * @brief Set channel rate
+         * @param c : Channel
+         * @param enable : Channel enabled
+         * @param period : Period (ms, multiple of the task period), 0 keeps the current period
+         */
+        void SetChannel(uint32_t c, bool enable, uint16_t period = 0u);
+
+        /**
+         * @brief Add a variable to the watch channel
+         * @param index : Variable index (see Utils::Watch)
+         * @return false if index is invalid or DIAG_WATCH_MAX variables are watched
+         */
+        bool AddWatch(uint32_t index);
+
+        /**
+         * @brief Remove every variable from the watch channel
+         */
+        void ClearWatch();
+
+        /**
+         * @brief Get watched variable index, -1 if unused
+         * @param slot : Watch slot (< DIAG_WATCH_MAX)
+         */
+        int32_t GetWatch(uint32_t slot)
+        {
+            return (slot < DIAG_WATCH_MAX) ? this->watchList[slot] : -1;
+        }
+
+        /**
+         * @brief Get link budget left (bytes), unlimited on USB
+         */
+        int32_t GetBudget()
+        {
+            return this->budget / 1000;
+        }
+
+        /**
+         * @brief Stop the tracer and send its records as trace frames
+         */
+        void DumpTrace()
+        {
+            Utils::Trace::Stop();
+            this->traceIndex = 0;
+            this->traceDump = true;
+        }
+
+        /**
+         * @brief Return true while a trace dump is running
+         */
+        bool IsDumpingTrace()
+        {
+            return this->traceDump;
+        }
+
+        /**
+         * @brief Stop the scope and send its samples as scope frames
+         */
+        void DumpScope()
+        {
+            Utils::Scope::Stop();
+            this->scopeIndex = 0;
+            this->scopeDump = true;
+        }
+
+        /**
+         * @brief Return true while a scope dump is running
+         */
+        bool IsDumpingScope()
+        {
+            return this->scopeDump;
+        }
+
+        /**
+         * @brief Select a scope channel variable by name
+         * @param channel : Scope channel
+         * @param probe : Variable name (see GetScopeProbeName()), "off" clears the channel
+         * @return true if set (unknown name or capture running : false)
+         */
+        bool SetScopeChannel(uint32_t channel, const char* probe);
+
+        /**
+         * @brief Return name of variable captured by a scope channel, "off" if unused
+         */
+        const char* GetScopeChannelName(uint32_t channel);
+
+        /**
+         * @brief Return scope variable name, NULL past the last one
+         */
+        static const char* GetScopeProbeName(uint32_t index);
+
     protected:
         /**
          * @brief DIAG default constructor
@@ -88,9 +465,86 @@ typedef void (*FunctionFunc)();
          * @protected
          * @brief Instance name
          */
-        std::string name;
+        const char* name;
+
+        /**
+         * @protected
+         * @brief Periodic channels definitions and states
+         */
+        static const channel_t channels[CHANNEL_MAX];
+        channel_state_t channelState[CHANNEL_MAX];
+
+        /**
+         * @protected
+         * @brief Task time (ms)
+         */
+        uint32_t time;
+
+        /**
+         * @protected
+         * @brief Serial link budget (1/1000 bytes), refilled at DIAG_LINK_RATE
+         */
+        int32_t budget;
+
+        /**
+         * @protected
+         * @brief Watched variables (Utils::Watch index, -1 : unused)
+         */
+        int16_t watchList[DIAG_WATCH_MAX];
 
-        bool enable[5];
+        /**
+         * @protected
+         * @brief Telemetry serial port
+         */
+        Serial *serial;
+
+        /**
+         * @protected
+         * @brief Telemetry sequence number (to detect lost frames)
+         */
+        uint16_t seq;
+
+        /**
+         * @protected
+         * @brief Next periodic loop sent by scheduling telemetry
+         */
+        uint8_t schedIndex;
+
+        /**
+         * @protected
+         * @brief Next motion state sent by motion states telemetry
+         */
+        uint8_t tpIndex;
+
+        /**
+         * @protected
+         * @brief Next wheel sent by encoder health telemetry
+         */
+        uint8_t encIndex;
+
+        /**
+         * @protected
+         * @brief Memory monitor : last high water marks (words), heap and low stack warnings sent
+         */
+        uint16_t stackFree[TaskTable::TASK_MAX];
+        uint32_t heapFree;
+        uint32_t heapMinFree;
+        uint32_t heapLargest;
+        uint32_t stackWarned;
+
+        /**
+         * @protected
+         * @brief Trace dump : running and next record
+         */
+        volatile bool traceDump;
+        uint16_t traceIndex;
+
+        /**
+         * @protected
+         * @brief Scope dump : running and next sample
+         */
+        volatile bool scopeDump;
+        uint16_t scopeIndex;
 
         Odometry           *odometry;
         PositionControl    *pc;
@@ -103,8 +557,35 @@ typedef void (*FunctionFunc)();
         GPIO *led4;
 
 
-        void TracesMC();
-        void TracesOD();
+        uint32_t TracesMC(uint8_t* buffer);
+        uint32_t TracesOD(uint8_t* buffer);
+        uint32_t TracesWatch(uint8_t* buffer);
+        uint32_t TelemetryMC(uint8_t* buffer);
+        uint32_t TelemetrySched(uint8_t* buffer);
+        uint32_t TelemetryMem(uint8_t* buffer);
+        uint32_t TelemetryTP(uint8_t* buffer);
+        uint32_t TelemetryEnc(uint8_t* buffer);
+        uint32_t TelemetryPerf(uint8_t* buffer);
+        void TelemetryTrace();
+        void TelemetryScope();
+        void TelemetryLog();
+        void Memory();
+        void send(const void* frame, uint32_t size, enum SWO::PORT port = SWO::TELEMETRY);
+
+        /**
+         * @protected
+         * @brief Publish due channels, highest priority first
+         */
+        void publish();
+
+        /**
+         * @protected
+         * @brief Return true if the link budget allows an output
+         * @param size : Output length (bytes)
+         * @param priority : Output priority, lower priorities leave a reserve to higher ones
+         * @param port : SWO port the output can be routed to
+         */
+        bool admit(uint32_t size, uint8_t priority, enum SWO::PORT port);
         void Led();
 
         /**
@@ -119,6 +600,18 @@ typedef void (*FunctionFunc)();
          */
         TaskHandle_t taskHandle;
 
+        /**
+         * @protected
+         * @brief Compute() execution time profiler
+         */
+        Utils::Profiler profiler;
+
+        /**
+         * @protected
+         * @brief Task loop scheduling statistics
+         */
+        Utils::PeriodicTask periodic;
+
         /**
          * @protected
          * @brief loop task handler
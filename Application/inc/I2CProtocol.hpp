@@ -0,0 +1,578 @@
+/**
+ * @file    I2CProtocol.hpp
+ * @author  Jeremy ROULLAND
+ * @date    14 oct. 2017
+ * @brief   Main board command channel (I2C slave register map, CAN messages)
+ */
+
+#ifndef INC_I2CPROTOCOL_HPP_
+#define INC_I2CPROTOCOL_HPP_
+
+
+#include "common.h"
+
+// MotionControl
+#include "Odometry.hpp"
+#include "MotionControl.hpp"
+#include "TrajectoryPlanning.hpp"
+#include "PositionControlStepper.hpp"
+
+// Actuators
+#include "Mandible.hpp"
+#include "Cylinder.hpp"
+#include "ActuatorControl.hpp"
+
+// Link
+#include "I2CSlave.hpp"
+#include "CAN.hpp"
+#include "ClockSync.hpp"
+
+// FreeRTOS
+#include "FreeRTOS.h"
+#include "task.h"
+
+using namespace Location;
+using namespace MotionControl;
+
+/*----------------------------------------------------------------------------*/
+/* Definitions                                                                */
+/*----------------------------------------------------------------------------*/
+
+/**
+ * @brief Registers (little endian payloads)
+ *
+ * Write : [reg][payload][crc8]
+ * Read  : write [reg][crc8], then read [payload][crc8] (repeated start allowed)
+ *
+ * Motion orders (GOLIN, GOANG, GOTO, ROUTE, ARC, ARCTO, PATH) accept an optional trailer
+ * [uint8 CMD_MODE][uint16 tag] : append, preempt or replace, tag reported
+ * by status (running, finished) once started / finished.
+ *
+ * Time triggered orders : the main board sends its clock (SYNC) periodically,
+ * once synchronized (see CLOCK) any write frame may be wrapped in AT to be
+ * executed at a main board time, within the protocol task period.
+ *
+ * Streamed path : the main board appends points (STREAM) while the PATH
+ * order runs, as long as the snapshot reports free slots. The robot keeps
+ * its speed through the points loaded ahead, stops and waits when starved,
+ * the path ends on the point flagged I2CP_STREAM_LAST.
+ *
+ * Progress triggered orders : any write frame (typically an actuator order)
+ * may be wrapped in NEAR or WAYPOINT to be executed while a motion order
+ * runs : actuators get ready during the travel. Executed at the latest when
+ * the motion order finishes, dropped by STOP.
+ *
+ * Several boards share the bus : each one answers its own address (base
+ * + 2 * Config boardAddress on I2C, identifiers offset by board on CAN).
+ * Write frames sent to every board (I2C general call, CAN broadcast range)
+ * are executed by each one, e.g. STOP, ESTOP, or CYLINDERS "index + 1".
+ */
+// Status registers (read)
+#define I2CP_REG_STATUS             (0x00u)     /**< i2cp_status_t */
+#define I2CP_REG_POSITION           (0x01u)     /**< i2cp_position_t */
+#define I2CP_REG_VELOCITY           (0x02u)     /**< i2cp_velocity_t */
+#define I2CP_REG_ERRORS             (0x03u)     /**< i2cp_errors_t */
+#define I2CP_REG_CLOCK              (0x04u)     /**< i2cp_clock_t (answered from interrupt, time is current) */
+#define I2CP_REG_SNAPSHOT           (0x05u)     /**< i2cp_snapshot_t (whole status in one read) */
+#define I2CP_REG_PREPARED_MAX       (0x06u)     /**< Status registers below are prepared by the task (but CLOCK) */
+
+// Motion orders (write)
+#define I2CP_REG_GOLIN              (0x10u)     /**< int32 distance (mm) */
+#define I2CP_REG_GOANG              (0x11u)     /**< int32 angle (1/10 deg) */
+#define I2CP_REG_GOTO               (0x12u)     /**< int32 X, int32 Y (mm) */
+#define I2CP_REG_STOP               (0x13u)     /**< No payload but a dummy byte */
+#define I2CP_REG_ENABLE             (0x14u)     /**< uint8 (0 : disable, else enable) */
+#define I2CP_REG_SETODO             (0x15u)     /**< int32 X, int32 Y (mm), int16 O (1/10 deg) */
+#define I2CP_REG_ROUTE              (0x16u)     /**< uint8 route identifier (see Routes) */
+#define I2CP_REG_ESTOP              (0x17u)     /**< No payload but a dummy byte : emergency stop, from interrupt */
+#define I2CP_REG_RELEASE            (0x18u)     /**< No payload but a dummy byte : release emergency stop */
+#define I2CP_REG_SYNC               (0x19u)     /**< uint32 main board time (us) : clock sample, stamped from interrupt */
+#define I2CP_REG_AT                 (0x1Au)     /**< uint32 main board time (us), write frame [reg][payload] to execute then */
+#define I2CP_REG_CORRECT            (0x1Bu)     /**< int32 X, int32 Y (mm), int16 O (1/10 deg) : pose estimate blended in (see Odometry::Correct()) */
+#define I2CP_REG_ARC                (0x1Cu)     /**< int32 radius, int32 length (mm) : radius > 0 turns left */
+#define I2CP_REG_ARCTO              (0x1Du)     /**< int32 X, int32 Y (mm) : arc tangent to robot heading */
+#define I2CP_REG_NEAR               (0x1Eu)     /**< uint16 order tag, uint16 distance (mm), write frame [reg][payload] to execute when less is left */
+#define I2CP_REG_WAYPOINT           (0x1Fu)     /**< uint16 order tag, uint8 point, write frame [reg][payload] to execute when path point is reached */
+
+// Actuator orders (write)
+#define I2CP_REG_MANDIBLE           (0x20u)     /**< uint8 Mandible::Position */
+#define I2CP_REG_CYLINDER           (0x21u)     /**< uint8 id, uint8 I2CP_CYLINDER_*, int8 index */
+#define I2CP_REG_SEQUENCE           (0x22u)     /**< AC_STEP[] (as many as the frame holds) */
+#define I2CP_REG_CYLINDERS          (0x23u)     /**< uint8 cylinders mask, uint8 I2CP_CYLINDER_*, int8 index : all queued at once */
+
+// Configuration (write, see Config)
+#define I2CP_REG_CONFIG             (0x30u)     /**< uint8 index, float32 value : edit, or uint8 I2CP_CONFIG_* */
+#define I2CP_REG_PARAM              (0x31u)     /**< uint8 index, float32 value : live parameter (Utils::Param) */
+#define I2CP_REG_PRESET             (0x32u)     /**< uint8 PC_PRESET_* : limits and gains from next move */
+
+// Streamed path (write)
+#define I2CP_REG_STREAM             (0x38u)     /**< uint8 I2CP_STREAM_*, int16 X, int16 Y (mm) pairs : points appended (all or none) */
+#define I2CP_REG_PATH               (0x39u)     /**< No payload but a dummy byte : follow streamed points */
+
+#define I2CP_ORDER_TRAILER          (3u)        /**< uint8 CMD_MODE, uint16 tag */
+
+#define I2CP_TIMED_MAX              (8u)        /**< Pending time triggered orders */
+#define I2CP_TIMED_HORIZON_US       (60000000u) /**< Farthest time triggered order (us) */
+#define I2CP_PROGRESS_MAX           (8u)        /**< Pending progress triggered orders */
+#define I2CP_SYNC_LATENCY_US        (0u)        /**< Main board time to frame end delay (us), stamped at frame end */
+
+#define I2CP_BOARD_MAX              (4u)        /**< Boards sharing the bus (Config boardAddress) */
+
+/**
+ * @brief CAN message map (standard identifiers, lower is higher priority)
+ *
+ * ESTOP            : broadcast emergency stop (any payload), from interrupt
+ * ORDER + register : write frame payload, same as I2C ([reg] is the identifier),
+ *                    orders longer than 8 bytes (SETODO, GOTO with trailer...) are I2C only
+ * BROADCAST + register : same, executed by every board
+ * STATUS + I2CP_CAN_* : sent by this board every I2CP_CAN_PERIOD_MS
+ *
+ * ORDER and STATUS identifiers of board n are offset by n * I2CP_CAN_BOARD_STRIDE.
+ */
+#define I2CP_CAN                    (1u)        /**< Main board link on CAN too */
+#define I2CP_CAN_ESTOP_ID           (0x000u)
+#define I2CP_CAN_BROADCAST_ID       (0x1C0u)    /**< Orders to all boards : 0x1C0 to 0x1FF */
+#define I2CP_CAN_ORDER_ID           (0x200u)    /**< Orders to board 0 : 0x200 to 0x23F */
+#define I2CP_CAN_ORDER_MASK         (0x7C0u)
+#define I2CP_CAN_STATUS_ID          (0x280u)
+#define I2CP_CAN_BOARD_STRIDE       (0x100u)
+#define I2CP_CAN_PERIOD_MS          (10u)
+
+#define I2CP_CAN_STATUS             (0u)        /**< i2cp_can_status_t */
+#define I2CP_CAN_POSITION           (1u)        /**< i2cp_can_position_t */
+#define I2CP_CAN_VELOCITY           (2u)        /**< i2cp_velocity_t */
+#define I2CP_CAN_FAULTS             (3u)        /**< i2cp_can_faults_t */
+
+/**
+ * @brief Fault flags (snapshot)
+ */
+#define I2CP_FAULT_EMERGENCY        (1u << 0)   /**< Emergency stop latched */
+#define I2CP_FAULT_WHEEL_STALL      (1u << 1)   /**< Both wheel motors stalled */
+#define I2CP_FAULT_ACTUATOR_STALL   (1u << 2)   /**< A cylinder motor is stalled */
+#define I2CP_FAULT_LINK             (1u << 3)   /**< Link errors counted within I2CP_FAULT_LINK_MS */
+#define I2CP_FAULT_CAN_BUS_OFF      (1u << 4)   /**< CAN node off the bus */
+#define I2CP_FAULT_LINK_MS          (100u)
+
+/**
+ * @brief Actuators status bit : boot done, orders accepted (see Boot)
+ */
+#define I2CP_STATUS_READY           (1u << 7)
+
+#define I2CP_BANKS                  (3u)        /**< Prepared images : published, being sent, being written */
+
+#define I2CP_CONFIG_SAVE            (0xFFu)     /**< Commit edited values (refused while motion control is enabled) */
+#define I2CP_CONFIG_LIVE            (0xFEu)     /**< Edit with live parameters values */
+
+#define I2CP_CYLINDER_OPEN          (0u)
+#define I2CP_CYLINDER_CLOSE         (1u)
+#define I2CP_CYLINDER_RAISE         (2u)
+#define I2CP_CYLINDER_LOWER         (3u)
+#define I2CP_CYLINDER_GOTO          (4u)
+#define I2CP_CYLINDER_SEARCH        (5u)
+#define I2CP_CYLINDER_SHIFT         (6u)        /**< index : offset from the previous target */
+
+#define I2CP_STREAM_LAST            (1u << 0)   /**< Path ends on the last point of the frame */
+
+/**
+ * @brief Modules status
+ */
+typedef struct __attribute__((packed))
+{
+    uint16_t  mc;           /**< FBMotionControl status */
+    uint16_t  tp;           /**< TrajectoryPlanning status */
+    uint16_t  pc;           /**< PositionControl status */
+    uint16_t  od;           /**< Odometry status */
+    uint8_t   actuators;    /**< Bit n : cylinder n positioning finished, bit CYLINDER_MAX : mandible, next bit : sequence, I2CP_STATUS_READY */
+    uint8_t   orders;       /**< Accepted orders counter */
+    uint16_t  running;      /**< Running order tag (0 : none or untagged) */
+    uint16_t  finished;     /**< Last finished order tag */
+}i2cp_status_t;
+
+/**
+ * @brief Robot location
+ */
+typedef struct __attribute__((packed))
+{
+    int32_t   x;            /**< mm */
+    int32_t   y;            /**< mm */
+    int16_t   o;            /**< 1/10 deg */
+}i2cp_position_t;
+
+/**
+ * @brief Robot velocity (Odometry units)
+ */
+typedef struct __attribute__((packed))
+{
+    float32_t linear;
+    float32_t angular;
+}i2cp_velocity_t;
+
+/**
+ * @brief Link errors
+ */
+typedef struct __attribute__((packed))
+{
+    uint32_t  crc;          /**< Frames dropped on CRC error */
+    uint32_t  overrun;      /**< Frames dropped on full ring */
+    uint32_t  command;      /**< Unknown or malformed orders */
+}i2cp_errors_t;
+
+/**
+ * @brief CAN status message
+ */
+typedef struct __attribute__((packed))
+{
+    uint16_t  mc;           /**< FBMotionControl status */
+    uint8_t   actuators;    /**< See i2cp_status_t */
+    uint8_t   orders;       /**< Accepted orders counter */
+    uint16_t  running;      /**< Running order tag */
+    uint16_t  finished;     /**< Last finished order tag */
+}i2cp_can_status_t;
+
+/**
+ * @brief CAN robot location message
+ */
+typedef struct __attribute__((packed))
+{
+    int16_t   x;            /**< mm */
+    int16_t   y;            /**< mm */
+    int16_t   o;            /**< 1/10 deg */
+}i2cp_can_position_t;
+
+/**
+ * @brief CAN faults message
+ */
+typedef struct __attribute__((packed))
+{
+    uint16_t  faults;       /**< I2CP_FAULT_* */
+    uint16_t  sequence;     /**< Snapshot refresh counter */
+}i2cp_can_faults_t;
+
+/**
+ * @brief Status snapshot (status, location, velocity and faults of the same refresh)
+ */
+typedef struct __attribute__((packed))
+{
+    uint16_t  sequence;     /**< Refresh counter, unchanged if the task is late */
+    uint16_t  faults;       /**< I2CP_FAULT_* */
+    uint16_t  mc;           /**< FBMotionControl status */
+    uint8_t   actuators;    /**< See i2cp_status_t */
+    uint8_t   orders;       /**< Accepted orders counter */
+    uint16_t  running;      /**< Running order tag */
+    uint16_t  finished;     /**< Last finished order tag */
+    int32_t   x;            /**< mm */
+    int32_t   y;            /**< mm */
+    int16_t   o;            /**< 1/10 deg */
+    float32_t linear;       /**< Odometry units */
+    float32_t angular;      /**< Odometry units */
+    uint8_t   stream;       /**< Free streamed path slots (see I2CP_REG_STREAM) */
+}i2cp_snapshot_t;
+
+/**
+ * @brief Clock synchronization
+ */
+typedef struct __attribute__((packed))
+{
+    uint32_t  time;         /**< Main board time estimate (us), 0 if not synchronized */
+    int32_t   error;        /**< Last sample error (us) */
+    uint8_t   synchronized; /**< 1 once locked, time triggered orders accepted */
+    uint8_t   timed;        /**< Pending time triggered orders */
+}i2cp_clock_t;
+
+/**
+ * @brief Time triggered order
+ */
+typedef struct
+{
+    uint32_t  at;           /**< Local time (us) */
+    I2C_FRAME frame;        /**< Wrapped write frame */
+}i2cp_timed_t;
+
+/**
+ * @brief Progress triggered order
+ */
+typedef struct
+{
+    uint16_t  tag;          /**< Motion order tag */
+    uint16_t  distance;     /**< Distance left (mm), NEAR */
+    int16_t   waypoint;     /**< Path point, WAYPOINT (-1 : NEAR) */
+    I2C_FRAME frame;        /**< Wrapped write frame */
+}i2cp_progress_t;
+
+/**
+ * @brief Read registers image
+ */
+typedef struct
+{
+    i2cp_status_t   status;
+    i2cp_position_t position;
+    i2cp_velocity_t velocity;
+    i2cp_errors_t   errors;
+    i2cp_snapshot_t snapshot;
+}i2cp_registers_t;
+
+/*----------------------------------------------------------------------------*/
+/* Class declaration                                                          */
+/*----------------------------------------------------------------------------*/
+
+    /**
+    * @class I2CProtocol
+    * @brief Main board command channel
+    *
+    * HOWTO :
+    * - Get instance with GetInstance()
+    * - Orders written by the main board are executed by the protocol task
+    * - Status registers are refreshed by the task, responses (CRC included) are
+    *   prepared at the same time and sent by DMA as is on address match, so the
+    *   main board can poll them at any rate with a constant turnaround
+    * - The snapshot gathers the status of one refresh, CAN status messages and
+    *   GetSnapshot() (console) read the same image
+    * - With I2CP_CAN, orders are also received as CAN messages (same register
+    *   map) and status is broadcast periodically
+    * - Other links (SerialProtocol) Post() write frames and ReadRegister()
+    */
+    class I2CProtocol
+    {
+    public:
+        /**
+         * @brief Get instance method
+         * @return I2CProtocol instance
+         */
+        static I2CProtocol* GetInstance();
+
+        /**
+         * @brief I2CProtocol instance name
+         */
+        const char* Name()
+        {
+            return this->name;
+        }
+
+        /**
+         * @brief Copy the last status snapshot (any task)
+         */
+        void GetSnapshot(i2cp_snapshot_t* snapshot);
+
+        /**
+         * @brief Queue a write frame from another link (one task)
+         * @param frame : Write frame [reg][payload] (CRC unused)
+         * @return false if malformed, SYNC (stamped by interrupt only) or queue is full
+         */
+        bool Post(const I2C_FRAME* frame);
+
+        /**
+         * @brief Copy a read register payload (any task)
+         * @param reg : Register
+         * @param buffer : Payload
+         * @param size : Buffer size
+         * @return Payload length, 0 if unknown
+         */
+        uint32_t ReadRegister(uint8_t reg, uint8_t* buffer, uint32_t size);
+
+        /**
+         * @private
+         * @brief Build a read register response (interrupt context). DO NOT CALL !!
+         */
+        uint32_t INTERNAL_ReadRegister(uint8_t reg, uint8_t* buffer, uint32_t size);
+
+        /**
+         * @private
+         * @brief Return a prepared read register response (interrupt context). DO NOT CALL !!
+         */
+        const uint8_t* INTERNAL_PreparedResponse(uint8_t reg);
+
+        /**
+         * @private
+         * @brief Wake up protocol task on written frame. DO NOT CALL !!
+         */
+        void INTERNAL_DataReceived();
+
+        /**
+         * @private
+         * @brief Wake up protocol task on received message. DO NOT CALL !!
+         */
+        void INTERNAL_MessageReceived();
+
+    protected:
+        /**
+         * @brief I2CProtocol default constructor
+         */
+        I2CProtocol();
+
+        /**
+         * @protected
+         * @brief Instance name
+         */
+        const char* name;
+
+        /**
+         * @protected
+         * @brief Main board link
+         */
+        HAL::I2CSlave* i2c;
+
+        /**
+         * @protected
+         * @brief Main board link on CAN, time since last status messages (ms)
+         */
+        HAL::CAN* can;
+        float32_t canElapsed;
+
+        Odometry           *odometry;
+        TrajectoryPlanning *tp;
+        PositionControl    *pc;
+        FBMotionControl    *mc;
+
+        Mandible* man;
+        Cylinder* cylinder[Cylinder::CYLINDER_MAX];
+        ActuatorControl* ac;
+
+        /**
+         * @protected
+         * @brief Read registers images and prepared responses (by register), one is
+         * published, one may still be sent by DMA, the task writes the last one
+         */
+        i2cp_registers_t registers[I2CP_BANKS];
+        uint8_t responses[I2CP_BANKS][I2CP_REG_PREPARED_MAX][I2C_MAX_FRAME_SIZE];
+
+        /**
+         * @protected
+         * @brief Image answered by the interrupt, image of the last response sent
+         */
+        volatile uint32_t bank;
+        volatile uint32_t sending;
+
+        /**
+         * @protected
+         * @brief Snapshot refresh counter
+         */
+        uint16_t sequence;
+
+        /**
+         * @protected
+         * @brief Link errors total at last change, time since (ms)
+         */
+        uint32_t linkErrors;
+        float32_t linkElapsed;
+
+        /**
+         * @protected
+         * @brief Accepted orders counter
+         */
+        uint8_t orders;
+
+        /**
+         * @protected
+         * @brief Unknown or malformed orders
+         */
+        uint32_t badCommands;
+
+        /**
+         * @protected
+         * @brief Frames posted by other links (any task or interrupt)
+         */
+        Utils::MpscRing<I2C_FRAME, I2C_MAX_BUFFER_SIZE> posted;
+
+        /**
+         * @protected
+         * @brief Time triggered orders (sorted by time) and count
+         */
+        i2cp_timed_t timed[I2CP_TIMED_MAX];
+        volatile uint32_t timedCount;
+
+        /**
+         * @protected
+         * @brief Progress triggered orders (reception order) and count
+         */
+        i2cp_progress_t progress[I2CP_PROGRESS_MAX];
+        uint32_t progressCount;
+
+        /**
+         * @protected
+         * @brief Local time of the last SYNC frame (interrupt)
+         */
+        volatile uint32_t syncStamp;
+
+        /**
+         * @protected
+         * @brief Board address, CAN orders and status identifiers of this board
+         */
+        uint32_t board;
+        uint32_t orderId;
+        uint32_t statusId;
+
+        /**
+         * @protected
+         * @brief Return true if a CAN identifier is an order to this board (or to all)
+         */
+        bool isOrder(uint32_t id)
+        {
+            id &= I2CP_CAN_ORDER_MASK;
+
+            return (id == this->orderId) || (id == I2CP_CAN_BROADCAST_ID);
+        }
+
+        /**
+         * @brief Execute a written frame
+         */
+        void execute(const I2C_FRAME* frame);
+
+        /**
+         * @brief Queue a time triggered order (AT payload)
+         * @return false if not synchronized, malformed, too far or queue is full
+         */
+        bool schedule(const uint8_t* payload, uint32_t length);
+
+        /**
+         * @brief Execute due time triggered orders
+         */
+        void trigger();
+
+        /**
+         * @brief Queue a progress triggered order (NEAR or WAYPOINT payload)
+         * @return false if malformed or queue is full
+         */
+        bool follow(uint8_t reg, const uint8_t* payload, uint32_t length);
+
+        /**
+         * @brief Execute progress triggered orders due on the published state
+         */
+        void triggerProgress();
+
+        /**
+         * @brief Execute received CAN orders
+         */
+        void receive();
+
+        /**
+         * @brief Send CAN status messages
+         */
+        void publish();
+
+        /**
+         * @brief Refresh read registers image and prepared responses
+         * @param period : Time since last refresh (ms)
+         */
+        void update(float32_t period);
+
+        /**
+         * @brief Execute orders and refresh registers
+         */
+        void Compute(float32_t period);
+
+        /**
+         * @protected
+         * @brief OS Task handle
+         */
+        TaskHandle_t taskHandle;
+
+        /**
+         * @protected
+         * @brief loop task handler
+         * @param obj : Always NULL
+         */
+        void taskHandler (void* obj);
+
+    };
+
+#endif /* INC_I2CPROTOCOL_HPP_ */
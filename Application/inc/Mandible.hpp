@@ -19,6 +19,12 @@
 
  #include "GPIO.hpp"
  #include "PWM.hpp"
+ #include "ADConverter.hpp"
+ #include "Event.hpp"
+ #include "Actuator.hpp"
+
+ #include "FreeRTOS.h"
+ #include "queue.h"
 
  /*----------------------------------------------------------------------------*/
  /* Definitions                                                                */
@@ -32,8 +38,14 @@ typedef struct
     HAL::GPIO::ID   highSideGpioId;
     HAL::GPIO::ID   lowSideGpioId;
     HAL::PWM::ID    PowerPwmId;
+    HAL::ADConverter::Channel SenseAdcId;
 }MAN_DEF;
 
+/**
+ * @brief Positions queued
+ */
+#define MAN_ORDERS_MAX      (4u)
+
 
  /*----------------------------------------------------------------------------*/
  /* Class declaration	                                                      */
@@ -46,8 +58,16 @@ typedef struct
 * HOWTO :
 * -
 *
+* SetPosition() queues the position, Process() (ActuatorControl task)
+* drives it without blocking and raises OrderDone once reached.
+*
+* Position is in percent of the travel (0 : Bottom, 100 : Top). The drive
+* duty cycle ramps up from a low start. Moves to an end stop complete as soon
+* as the H-bridge current rises (jaw arrived), a timeout being the fallback.
+* Other moves are driven for their share of the full travel time, measured
+* on each end to end move.
 */
-class Mandible
+class Mandible : public Actuator
 {
 public:
     enum ID
@@ -66,21 +86,125 @@ public:
 
     static Mandible* GetInstance (enum ID id);
 
-    void SetPosition(enum Position pos);
+    /**
+     * @brief Queue an order (Actuator interface : order is a Mandible::Position)
+     */
+    ActuatorHandle Start(const ACT_COMMAND& cmd);
+
+    /**
+     * @brief Return channel running an order (single channel)
+     */
+    uint8_t GetChannel(const ACT_COMMAND& cmd)
+    {
+        return 0u;
+    }
+
+    /**
+     * @brief Queue position order
+     * @return 0 if queued, -1 if queue is full
+     */
+    int8_t SetPosition(enum Position pos);
+
+    /**
+     * @brief Queue proportional position order
+     * @param percent : Position (0 : Bottom, 100 : Top), clamped
+     * @return 0 if queued, -1 if queue is full
+     */
+    int8_t SetPosition(float32_t percent);
+
+    /**
+     * @brief Return estimated position (percent)
+     */
+    float32_t GetPosition()
+    {
+        return this->percent;
+    }
+
+    /**
+     * @brief Return true if no order is queued or running
+     */
+    bool IsPositioningFinished();
+
+    /**
+     * @brief Return progress in percent (0 : order queued, 100 : idle)
+     */
+    uint8_t GetProgress();
+
+    using Actuator::IsIdle;
+
+    /**
+     * @brief Actuator interface (single channel)
+     */
+    bool IsIdle(uint8_t ch)
+    {
+        return this->IsPositioningFinished();
+    }
+
+    uint8_t GetProgress(uint8_t ch)
+    {
+        return this->GetProgress();
+    }
+
+    /**
+     * @brief Start queued orders and check running ones (non blocking)
+     */
+    void Process();
 
 private:
     Mandible (enum ID id);
 
-    void SetPosition(float32_t percent); // 0.0=Low 1.0=High
+    /**
+     * @brief Drive side toward position, return true if nothing to do
+     */
+    bool start(float32_t goal);
+
+    /**
+     * @brief Ramp drive, return true once position is reached
+     */
+    bool check();
+
+    /**
+     * @brief Release drive
+     */
+    void stop();
+
+    /**
+     * @brief Return move expected duration (tick)
+     */
+    TickType_t expected();
 
 
     enum ID id;
 
-    enum Position pos;
+    /**
+     * @brief Estimated position, running order goal (percent)
+     */
+    float32_t percent;
+    float32_t target;
+
+    QueueHandle_t orders;
+    StaticQueue_t ordersBuffer;
+    uint8_t ordersStorage[MAN_ORDERS_MAX * sizeof(float32_t)];
+    bool busy;
+
+    /**
+     * @brief Running move : start time, timed duration or end stop, current above threshold count
+     */
+    TickType_t started;
+    TickType_t duration;
+    bool endStop;
+    uint32_t sensed;
+
+    /**
+     * @brief Full travel time (tick, measured), end stops missed (timeout)
+     */
+    TickType_t travel;
+    uint32_t timeouts;
 
     HAL::GPIO* highSide;
     HAL::GPIO* lowSide;
     HAL::PWM*  power;
+    HAL::ADConverter* sense;
 
     MAN_DEF def;
 };
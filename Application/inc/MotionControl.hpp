@@ -17,52 +17,59 @@
 
 #include "common.h"
 
-// For std::string
-#include <algorithm>
-
-
 #include "Odometry.hpp"
 #include "PositionControlStepper.hpp"
-#include "ProfileGenerator.hpp"
 #include "TrajectoryPlanning.hpp"
 
 #include "Telemeter.hpp"
+#include "Battery.hpp"
+#include "SoftTimer.hpp"
+#include "Deferred.hpp"
+#include "CmdSchema.hpp"
 
 // FreeRTOS
 #include "FreeRTOS.h"
 #include "semphr.h"
 #include "task.h"
 #include "timers.h"
+#include "event_groups.h"
 
 using namespace Location;
 
-typedef enum
-{
-    CMD_ID_UNKNOWN                =    -1,
-//    CMD_TYPE_CHECKUP            =    0x10,
-//    CMD_ID_GET_POSITION            =    0x20,
-    CMD_ID_GET_ANGLE            =    0x21,
-    CMD_ID_GOTO                    =    0x40,
-    CMD_ID_GOLIN                =    0x41,
-    CMD_ID_GOANG                =    0x42,
-    CMD_ID_SET_POSITION            =    0x50,
-    CMD_ID_SET_ANGLE            =    0x51,
-//    CMD_ID_STOP                    =    0x60,
-}CMD_TYPE;
-
-struct cmd_t
-{
-    CMD_TYPE id;
-    union
-    {
-        float32_t d;
-        float32_t a;
-        struct {
-        	float32_t x;
-        	float32_t y;
-        }xy;
-    }data;
-};
+/*----------------------------------------------------------------------------*/
+/* Definitions                                                                */
+/*----------------------------------------------------------------------------*/
+
+/**
+ * @brief Orders queue size (path buffer)
+ */
+#define MC_ORDERS_MAX               (32u)
+#define MC_URGENT_MAX               (4u)        // Preempt / replace orders, one started by period
+#define MC_ORDERS_TRACE_ID          (1u)        // Utils::Trace queue number
+
+/**
+ * @brief Status event group bits (see FBMotionControl::GetEvents())
+ *
+ * Levels mirror status bits, updated each period. Pulses are set on the
+ * event and cleared by the waiter (WaitEvents()) : check tags or counters
+ * after waking up.
+ */
+#define MC_EVENT_ENABLED            (1u << 0)   // Level : motion control enabled (config)
+#define MC_EVENT_SAFEGUARD          (1u << 1)   // Level : safeguard enabled (config)
+#define MC_EVENT_EMERGENCY          (1u << 2)   // Level : emergency stop latched (fault)
+#define MC_EVENT_READY              (1u << 8)   // Level : no order running
+#define MC_EVENT_STATUS             (MC_EVENT_ENABLED | MC_EVENT_SAFEGUARD | MC_EVENT_EMERGENCY | MC_EVENT_READY)
+#define MC_EVENT_ORDER_DONE         (1u << 10)  // Pulse : an order finished (see GetFinishedOrder())
+#define MC_EVENT_ORDER_ABORTED      (1u << 11)  // Pulse : an order was aborted (see GetAbortedOrders())
+#define MC_EVENT_OBSTACLE           (1u << 12)  // Pulse : obstacle detected on the sensed telemeter
+
+/**
+ * @brief Order latency histogram bins (power of 2 microseconds, see Utils::Profiler)
+ *
+ * Bin 0 : < 1us, bin n : [2^(n-1), 2^n[ us, last bin : everything above
+ */
+#define MC_LATENCY_HISTOGRAM_SIZE   (20u)
+#define MC_LATENCY_TIMEOUT_US       (1000000u)  // Order without step : not measured
 
 namespace MotionControl
 {
@@ -87,20 +94,52 @@ namespace MotionControl
         /**
          * @brief Return instance name
          */
-        std::string Name()
+        const char* Name()
         {
             return this->name;
         }
 
+        /**
+         * @brief Get Compute() execution time profiler
+         */
+        Utils::Profiler* GetProfiler()
+        {
+            return &this->profiler;
+        }
+
         uint16_t GetStatus()
         {
             return this->status;
         }
 
+        /**
+         * @brief Get status event group (MC_EVENT_* bits) : block on it instead of polling GetStatus()
+         */
+        EventGroupHandle_t GetEvents()
+        {
+            return this->events;
+        }
+
+        /**
+         * @brief Wait for any of MC_EVENT_* bits (task context), bits are cleared on exit
+         * @param bits : Awaited bits
+         * @param timeout : Ticks
+         * @return Awaited bits set (0 on timeout)
+         */
+        EventBits_t WaitEvents(EventBits_t bits, TickType_t timeout)
+        {
+            return xEventGroupWaitBits(this->events, bits, pdTRUE, pdFALSE, timeout) & bits;
+        }
+
         void Enable();
 
         void Disable();
 
+        bool IsEnabled()
+        {
+            return this->enable;
+        }
+
         void DisableSafeguard()
         {
             this->safeguard = true;
@@ -118,44 +157,301 @@ namespace MotionControl
             return this->safeguard;
         }
 
-        // MotionControl Commands
-        void GoLin(int32_t d)
+        // MotionControl Commands (see Push() for mode and tag)
+        bool GoLin(int32_t d, CMD_MODE mode = CMD_MODE_APPEND, uint16_t tag = 0u)
         {
             struct cmd_t cmd;
 
             cmd.id = CMD_ID_GOLIN;
-            cmd.data.d = ((float32_t)d)/1000.0;
+            cmd.mode = mode;
+            cmd.tag = tag;
+            cmd.data.d = ((float32_t)d)/1000.0f;
 
-            xQueueSend(this->Qorders, (void*) &cmd, 0);
+            return this->Push(&cmd);
         }
 
-        void GoAng(int32_t a)
+        bool GoAng(int32_t a, CMD_MODE mode = CMD_MODE_APPEND, uint16_t tag = 0u)
         {
         	struct cmd_t cmd;
 
             cmd.id = CMD_ID_GOANG;
-            cmd.data.a = ((float32_t)a)/10.0/180.0*_PI_;
+            cmd.mode = mode;
+            cmd.tag = tag;
+            cmd.data.a = ((float32_t)a)*(_PI_/1800.0f);
 
-            xQueueSend(this->Qorders, (void*) &cmd, 0);
+            return this->Push(&cmd);
         }
 
-        void Goto(int32_t X, int32_t Y)
+        bool Goto(int32_t X, int32_t Y, CMD_MODE mode = CMD_MODE_APPEND, uint16_t tag = 0u)
         {
         	struct cmd_t cmd;
 
             cmd.id = CMD_ID_GOTO;
-            cmd.data.xy.x = ((float32_t)X)/1000.0;
-            cmd.data.xy.y = ((float32_t)Y)/1000.0;
+            cmd.mode = mode;
+            cmd.tag = tag;
+            cmd.data.xy.x = ((float32_t)X)/1000.0f;
+            cmd.data.xy.y = ((float32_t)Y)/1000.0f;
+
+            return this->Push(&cmd);
+        }
+
+        /**
+         * @brief Queue an arc (mm) : linear and angular profiles run together, no stop to rotate
+         * @param radius : Turn radius (> 0 turns left, 0 : straight)
+         * @param length : Arc length (< 0 backwards)
+         */
+        bool Arc(int32_t radius, int32_t length, CMD_MODE mode = CMD_MODE_APPEND, uint16_t tag = 0u)
+        {
+            struct cmd_t cmd;
+
+            cmd.id = CMD_ID_ARC;
+            cmd.mode = mode;
+            cmd.tag = tag;
+            cmd.data.arc.radius = ((float32_t)radius)/1000.0f;
+            cmd.data.arc.length = ((float32_t)length)/1000.0f;
+
+            return this->Push(&cmd);
+        }
+
+        /**
+         * @brief Queue an arc to X, Y (mm), tangent to robot heading when the order starts
+         */
+        bool ArcTo(int32_t X, int32_t Y, CMD_MODE mode = CMD_MODE_APPEND, uint16_t tag = 0u)
+        {
+            struct cmd_t cmd;
+
+            cmd.id = CMD_ID_ARCTO;
+            cmd.mode = mode;
+            cmd.tag = tag;
+            cmd.data.xy.x = ((float32_t)X)/1000.0f;
+            cmd.data.xy.y = ((float32_t)Y)/1000.0f;
+
+            return this->Push(&cmd);
+        }
+
+        /**
+         * @brief Queue a precomputed route (see Routes), ignored if robot isn't near its start
+         */
+        bool Route(uint32_t id, CMD_MODE mode = CMD_MODE_APPEND, uint16_t tag = 0u)
+        {
+            struct cmd_t cmd;
+
+            cmd.id = CMD_ID_ROUTE;
+            cmd.mode = mode;
+            cmd.tag = tag;
+            cmd.data.route = id;
+
+            return this->Push(&cmd);
+        }
+
+        /**
+         * @brief Queue a stall against the X (heading 0) or Y (heading PI/2) border, backwards
+         *
+         * Odometry X (or Y) and heading are reset on contact, see
+         * TrajectoryPlanning::GetStallContact() for the location before reset
+         */
+        bool StallX(CMD_MODE mode = CMD_MODE_APPEND, uint16_t tag = 0u)
+        {
+            struct cmd_t cmd;
+
+            cmd.id = CMD_ID_STALLX;
+            cmd.mode = mode;
+            cmd.tag = tag;
+
+            return this->Push(&cmd);
+        }
+
+        bool StallY(CMD_MODE mode = CMD_MODE_APPEND, uint16_t tag = 0u)
+        {
+            struct cmd_t cmd;
+
+            cmd.id = CMD_ID_STALLY;
+            cmd.mode = mode;
+            cmd.tag = tag;
+
+            return this->Push(&cmd);
+        }
+
+        /**
+         * @brief Queue a streamed path : follows points pushed by TrajectoryPlanning::StreamPush()
+         * until the last one
+         */
+        bool Stream(CMD_MODE mode = CMD_MODE_APPEND, uint16_t tag = 0u)
+        {
+            struct cmd_t cmd;
+
+            cmd.id = CMD_ID_STREAM;
+            cmd.mode = mode;
+            cmd.tag = tag;
+
+            return this->Push(&cmd);
+        }
+
+        /**
+         * @brief Submit an order
+         *
+         * APPEND orders wait in the FIFO. PREEMPT and REPLACE orders start on
+         * the next period, replanned from current motion (no stop) : the
+         * running order is aborted, REPLACE also flushes pending orders.
+         * @param cmd : Order (mode and tag set)
+         * @return false if the queue is full or the order unknown (see CmdSchema.hpp)
+         */
+        bool Push(const struct cmd_t* cmd);
+
+        /**
+         * @brief Return tag of the running order (0 if none or untagged)
+         */
+        uint16_t GetRunningOrder()
+        {
+            return this->runningTag;
+        }
+
+        /**
+         * @brief Return tag of the last finished order (aborted ones are never finished)
+         */
+        uint16_t GetFinishedOrder()
+        {
+            return this->finishedTag;
+        }
 
-            xQueueSend(this->Qorders, (void*) &cmd, 0);
+        /**
+         * @brief Return number of orders aborted by PREEMPT / REPLACE (or Stop())
+         */
+        uint32_t GetAbortedOrders()
+        {
+            return this->aborted;
         }
 
+        /**
+         * @brief Queue a whole path (all orders or none)
+         * @param cmds : Orders
+         * @param n : Orders count
+         * @return Orders queued
+         */
+        uint32_t PushPath(const struct cmd_t cmds[], uint32_t n);
+
         void Stop()
         {
             xQueueReset(this->Qorders);
+            xQueueReset(this->Qurgent);
+            this->prefetched = false;
+            this->abort();
             this->tp->stop();
         }
 
+        /**
+         * @brief Emergency stop (any context, any interrupt priority)
+         *
+         * Every Drv8813 output is disabled at once, the fault is latched
+         * (status bit 2) : the task flushes orders and disables motion control,
+         * Enable() is refused until ClearEmergency().
+         */
+        void EmergencyStop();
+
+        /**
+         * @brief Release emergency stop (task context)
+         * @return false if the emergency stop input is still active
+         */
+        bool ClearEmergency();
+
+        /**
+         * @brief Return true if an emergency stop is latched
+         */
+        bool IsEmergency()
+        {
+            return this->emergency;
+        }
+
+        /**
+         * @private
+         * @brief Wake up motion control on new odometry sample. DO NOT CALL !!
+         */
+        void INTERNAL_OdometrySample();
+
+        /**
+         * @private
+         * @brief Positioning settled, schedule TrajectoryPlanning now. DO NOT CALL !!
+         */
+        void INTERNAL_Settled();
+
+        /**
+         * @private
+         * @brief Obstacle detected on the sensed telemeter (ADC interrupt). DO NOT CALL !!
+         */
+        void INTERNAL_Obstacle();
+
+        /**
+         * @private
+         * @brief Cyclic executive frame start (software timer interrupt). DO NOT CALL !!
+         */
+        void INTERNAL_Frame();
+
+        /**
+         * @brief Order latency : submission (Push()) to the first step played once started
+         *
+         * Covers the orders queue, TrajectoryPlanning, PositionControl and the
+         * Drv8813 step timer. Queued orders include the wait for previous ones.
+         */
+        uint32_t GetLatencyCount()
+        {
+            return this->latencyCount;
+        }
+
+        uint32_t GetLatencyMin()
+        {
+            return (this->latencyCount > 0u) ? this->latencyMin : 0u;
+        }
+
+        uint32_t GetLatencyMax()
+        {
+            return this->latencyMax;
+        }
+
+        uint32_t GetLatencyAverage()
+        {
+            return (this->latencyCount > 0u) ? static_cast<uint32_t>(this->latencySum / this->latencyCount) : 0u;
+        }
+
+        /**
+         * @brief Get order latency histogram bin count
+         * @param bin : Bin index (< MC_LATENCY_HISTOGRAM_SIZE)
+         */
+        uint32_t GetLatencyHistogram(uint32_t bin)
+        {
+            return (bin < MC_LATENCY_HISTOGRAM_SIZE) ? this->latencyHistogram[bin] : 0u;
+        }
+
+        void ResetLatency();
+
+        /**
+         * @brief Return frames which ran longer than one frame (cyclic executive)
+         */
+        uint32_t GetOverruns()
+        {
+            return this->overruns;
+        }
+
+        /**
+         * @brief Return frames skipped after an overrun (cyclic executive)
+         */
+        uint32_t GetMissedFrames()
+        {
+            return this->missed;
+        }
+
+        /**
+         * @brief Return pending orders high-water mark (Qorders, since last reset)
+         */
+        uint32_t GetOrdersPeak()
+        {
+            return this->ordersPeak;
+        }
+
+        void ResetOrdersPeak()
+        {
+            this->ordersPeak = 0u;
+        }
+
     protected:
         FBMotionControl();
 
@@ -166,16 +462,24 @@ namespace MotionControl
          * @protected
          * @brief Instance name
          */
-        std::string name;
+        const char* name;
 
         Odometry           *odometry;
         PositionControl    *pc;
-        ProfileGenerator   *pg;
         TrajectoryPlanning *tp;
 
         HAL::Telemeter* telAv;
         HAL::Telemeter* telAr;
 
+        Battery*        battery;
+
+        /**
+         * @protected
+         * @brief Emergency stop input and latch
+         */
+        HAL::GPIO* estop;
+        volatile bool emergency;
+
 
         bool enable;
 
@@ -200,14 +504,171 @@ namespace MotionControl
 
         /**
          * @protected
-         * @brief Semaphore order
+         * @brief Orders queue
          *
-         * Used to set order
+         * Orders are the only way other tasks change TrajectoryPlanning : it
+         * is written by this task only (no lock, see PositionControl)
          */
-        SemaphoreHandle_t mutex;
-
         QueueHandle_t Qorders;
 
+        /**
+         * @protected
+         * @brief Preempt / replace orders, served before Qorders
+         */
+        QueueHandle_t Qurgent;
+
+        /**
+         * @protected
+         * @brief Orders queues static storage
+         */
+        StaticQueue_t QordersBuffer;
+        uint8_t QordersStorage[MC_ORDERS_MAX * sizeof(struct cmd_t)];
+        StaticQueue_t QurgentBuffer;
+        uint8_t QurgentStorage[MC_URGENT_MAX * sizeof(struct cmd_t)];
+
+        /**
+         * @protected
+         * @brief Pending orders high-water mark (Qorders)
+         */
+        volatile uint32_t ordersPeak;
+
+        /**
+         * @protected
+         * @brief Update pending orders high-water mark
+         */
+        void notePending();
+
+        /**
+         * @protected
+         * @brief Acknowledgement : running order (valid if running), last finished, aborted count
+         */
+        volatile uint16_t runningTag;
+        volatile uint16_t finishedTag;
+        volatile uint32_t aborted;
+        bool running;
+
+        /**
+         * @protected
+         * @brief Status event group, static storage, aborted orders count already published
+         */
+        EventGroupHandle_t events;
+        StaticEventGroup_t eventsBuffer;
+        uint32_t abortedPublished;
+
+        /**
+         * @protected
+         * @brief Mirror status levels and aborted orders into the event group
+         */
+        void publishEvents();
+
+        /**
+         * @protected
+         * @brief Drop the running order (not acknowledged as finished)
+         */
+        void abort()
+        {
+            if(this->running)
+                this->aborted++;
+            this->running = false;
+            this->runningTag = 0u;
+        }
+
+        /**
+         * @protected
+         * @brief Start an order now and track it for acknowledgement
+         */
+        void start(const struct cmd_t* cmd);
+
+        /**
+         * @protected
+         * @brief Order latency : started order waiting for its first step, statistics (us)
+         */
+        uint32_t latencyStart;
+        bool latencyPending;
+        uint32_t latencyMin;
+        uint32_t latencyMax;
+        uint64_t latencySum;
+        uint32_t latencyCount;
+        uint32_t latencyHistogram[MC_LATENCY_HISTOGRAM_SIZE];
+
+        /**
+         * @protected
+         * @brief Record the latency of the started order once its first step is played
+         */
+        void measureLatency();
+
+        /**
+         * @protected
+         * @brief Acknowledge running order once TrajectoryPlanning finished it
+         */
+        void acknowledge();
+
+        /**
+         * @protected
+         * @brief Compute TrajectoryPlanning (profiled)
+         */
+        void plan(float32_t period);
+
+        /**
+         * @protected
+         * @brief Next order, pulled while current one decelerates
+         */
+        struct cmd_t next;
+
+        /**
+         * @protected
+         * @brief Next order is valid
+         */
+        volatile bool prefetched;
+
+        /**
+         * @protected
+         * @brief Obstacle latched by interrupt, orders are flushed (or held, MC_OBSTACLE_SLOWDOWN) by the task
+         */
+        volatile bool obstacle;
+
+        /**
+         * @protected
+         * @brief Positioning settled since last TrajectoryPlanning computation
+         */
+        bool settled;
+
+        /**
+         * @protected
+         * @brief Obstacle halt, posted by the ADC interrupt to the deferred worker
+         */
+        Utils::Deferred::Work obstacleWork;
+
+        /**
+         * @protected
+         * @brief Hold or halt motion on obstacle (deferred worker)
+         */
+        void obstacleHalt();
+
+        /**
+         * @protected
+         * @brief Telemeter watched by obstacle detection, NULL if none
+         */
+        HAL::Telemeter* sensed;
+
+        /**
+         * @protected
+         * @brief Select sensed telemeter from commanded linear velocity sign
+         */
+        void sense();
+
+        /**
+         * @protected
+         * @brief Velocity override for a telemeter (1 if clear or NULL, 0 inside detection threshold)
+         */
+        float32_t obstacleOverride(HAL::Telemeter* tel);
+
+        /**
+         * @protected
+         * @brief Start an order on TrajectoryPlanning
+         */
+        void dispatch(const struct cmd_t* cmd);
+
         /**
          * @protected
          * @brief OS Task handle
@@ -216,12 +677,63 @@ namespace MotionControl
          */
         TaskHandle_t taskHandle;
 
+        /**
+         * @protected
+         * @brief Compute() execution time profiler
+         */
+        Utils::Profiler profiler;
+
+        /**
+         * @protected
+         * @brief Task loop scheduling statistics
+         */
+        Utils::PeriodicTask periodic;
+
+        /**
+         * @protected
+         * @brief Watchdog client (see Utils::Watchdog)
+         */
+        int32_t health;
+
         /**
          * @protected
          * @brief Speed control loop task handler
          * @param obj : Always NULL
          */
         void taskHandler (void* obj);
+
+        /**
+         * @protected
+         * @brief Cyclic executive frame timer and frames started (TASK_CYCLIC_EXECUTIVE)
+         */
+        HAL::SoftTimer frameTimer;
+        volatile uint32_t frames;
+
+        /**
+         * @protected
+         * @brief Cyclic executive overruns and missed frames
+         */
+        uint32_t overruns;
+        uint32_t missed;
+
+        /**
+         * @protected
+         * @brief Odometry slot of the cyclic executive
+         */
+        void odometrySlot(float32_t period);
+
+        /**
+         * @protected
+         * @brief Publish the period state for status readers (see SystemState)
+         */
+        void stateSlot(float32_t period);
+
+        /**
+         * @protected
+         * @brief Cyclic executive task handler : runs the slot table on each frame
+         * @param obj : Always NULL
+         */
+        void executiveHandler (void* obj);
     };
 
 }
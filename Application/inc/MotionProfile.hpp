@@ -14,6 +14,41 @@
 /* Definitions                                                                */
 /*----------------------------------------------------------------------------*/
 
+/**
+ * @brief Maximum polynomial profile degree
+ */
+#define MPROFILE_POLY_DEGREE    (5u)
+
+/**
+ * @brief Use normalized shape tables (flash) instead of Horner for polynomial profiles
+ */
+#define MPROFILE_LUT            (0u)
+
+/**
+ * @brief Normalized shape tables intervals
+ */
+#define MPROFILE_LUT_SIZE       (64u)
+
+/**
+ * @brief Normalized shape table (position, velocity, acceleration on t = i / MPROFILE_LUT_SIZE)
+ */
+typedef struct
+{
+    float32_t s[MPROFILE_LUT_SIZE + 1u];
+    float32_t v[MPROFILE_LUT_SIZE + 1u];
+    float32_t a[MPROFILE_LUT_SIZE + 1u];
+}mprofile_lut_t;
+
+/**
+ * @brief Maximum S-curve parts (brake, then move to setpoint)
+ */
+#define MPROFILE_SCURVE_PARTS   (2u)
+
+/**
+ * @brief Setpoint closer than this to the stop point is the stop point (no second part)
+ */
+#define MPROFILE_STOP_EPSILON   (1e-6f)
+
 /*----------------------------------------------------------------------------*/
 /* Class declaration                                                          */
 /*----------------------------------------------------------------------------*/
@@ -30,6 +65,10 @@ namespace MotionControl
      * HOWTO :
      * -
      *
+     * Duration and polynomial coefficients are cached : they are computed
+     * again only when setpoint, limits or profile change, then Get() is a
+     * pure Horner evaluation.
+     *
      */
     class MotionProfile
     {
@@ -66,7 +105,7 @@ namespace MotionControl
         /**
          * @brief Constructor
          */
-        MotionProfile(float32_t maxVel = 1.0, float32_t maxAcc = 1.0, enum MotionProfile::PROFILE profile = POLY5);
+        MotionProfile(float32_t maxVel = 1.0f, float32_t maxAcc = 1.0f, enum MotionProfile::PROFILE profile = POLY5, float32_t maxJerk = 10.0f);
 
         /**
          * @brief Destructor
@@ -83,12 +122,40 @@ namespace MotionControl
          */
          void SetSetPoint(float32_t point, float32_t currentPoint, float32_t currentTime);
 
+        /**
+         * @brief Change setpoint while in motion
+         *
+         * New profile starts from current profiled position and velocity
+         * (SCURVE), other profiles restart from current profiled position
+         */
+         void Replan(float32_t point, float32_t currentTime);
+
+        /**
+         * @brief Brake to rest at maximum deceleration (shortest stop)
+         *
+         * Setpoint becomes the stop point of the current profiled state
+         * (SCURVE), other profiles stop on current profiled position
+         */
+         void Brake(float32_t currentTime);
+
+        /**
+         * @brief Brake to rest at maximum deceleration from an external state
+         * @param currentPoint : Position when not profiled (tracking)
+         * @param velocity : Velocity (unit by second of profile time)
+         * @param currentTime : Profile time
+         */
+         void Brake(float32_t currentPoint, float32_t velocity, float32_t currentTime);
+
         /**
          * @brief set maximum velocity
          */
         void SetVelMax(float32_t maxVel)
         {
-            this->maxVel = maxVel;
+            if(maxVel != this->maxVel)
+            {
+                this->maxVel = maxVel;
+                this->dirty = true;
+            }
         }
 
         /**
@@ -96,7 +163,23 @@ namespace MotionControl
          */
         void SetAccMax(float32_t maxAcc)
         {
-            this->maxAcc = maxAcc;
+            if(maxAcc != this->maxAcc)
+            {
+                this->maxAcc = maxAcc;
+                this->dirty = true;
+            }
+        }
+
+        /**
+         * @brief set maximum jerk (SCURVE)
+         */
+        void SetJerkMax(float32_t maxJerk)
+        {
+            if(maxJerk != this->maxJerk)
+            {
+                this->maxJerk = maxJerk;
+                this->dirty = true;
+            }
         }
 
         /**
@@ -104,7 +187,11 @@ namespace MotionControl
          */
          void SetProfile(enum MotionProfile::PROFILE profile)
         {
-            this->profile = profile;
+            if(profile != this->profile)
+            {
+                this->profile = profile;
+                this->dirty = true;
+            }
         }
 
          /**
@@ -115,6 +202,43 @@ namespace MotionControl
              this->mode = mode;
          }
 
+        /**
+         * @brief stretch profile duration (manual mode until next setpoint)
+         *
+         * Velocity and acceleration are scaled down, duration below the minimum
+         * time is ignored. Profiles replanned in motion are not stretched (their
+         * start velocity would be scaled too)
+         */
+        void SetDuration(float32_t duration)
+        {
+            if(this->startVelocity != 0.0f)
+                return;
+
+            this->tf = duration;
+            this->mode = MODE_MANUAL;
+        }
+
+        /**
+         * @brief get profile duration
+         */
+        float32_t GetDuration();
+
+        /**
+         * @brief get profile start time
+         */
+        float32_t GetStartTime()
+        {
+            return this->startTime;
+        }
+
+        /**
+         * @brief get profile final point (absolute setpoint)
+         */
+        float32_t GetTarget()
+        {
+            return this->startPoint + this->setPoint;
+        }
+
         /**
         * @brief get tf used
         */
@@ -133,6 +257,16 @@ namespace MotionControl
          */
         float32_t Get(float32_t time, float32_t tf);
 
+        /**
+         * @brief get profiled velocity (analytic, 0 for NONE and TRAPEZ)
+         */
+        float32_t GetVelocity(float32_t time);
+
+        /**
+         * @brief get profiled acceleration (analytic, 0 for NONE and TRAPEZ)
+         */
+        float32_t GetAcceleration(float32_t time);
+
         /**
          * @brief get min time
          */
@@ -154,6 +288,11 @@ namespace MotionControl
          */
         bool isFinished();
 
+        /**
+         * @brief is profile in its deceleration phase (or finished)
+         */
+        bool isDecelerating();
+
     protected:
         /**
          * @protected
@@ -161,6 +300,12 @@ namespace MotionControl
          */
         bool finished;
 
+        /**
+         * @protected
+         * @brief last normalized time evaluated (t / tf)
+         */
+        float32_t progress;
+
         /**
          * @protected
          * @brief start time
@@ -173,6 +318,134 @@ namespace MotionControl
          */
         float32_t startPoint;
 
+        /**
+         * @protected
+         * @brief cache invalidated (setpoint, limits or profile changed)
+         */
+        bool dirty;
+
+        /**
+         * @protected
+         * @brief cached minimum time
+         */
+        float32_t minTime;
+
+        /**
+         * @protected
+         * @brief cached polynomial coefficients (scaled by setpoint)
+         */
+        float32_t coef[MPROFILE_POLY_DEGREE + 1u];
+
+        /**
+         * @protected
+         * @brief normalized shape table of the profile (NULL if none)
+         */
+        const mprofile_lut_t * lut;
+
+        /**
+         * @protected
+         * @brief interpolate a normalized shape table column
+         */
+        float32_t interpolate(const float32_t * table, float32_t t);
+
+        /**
+         * @protected
+         * @brief S-curve part : from v0 to rest on h (jerk, acceleration, constant velocity, deceleration phases)
+         */
+        struct scurve_t
+        {
+            float32_t sign;
+            float32_t v0;
+            float32_t h;
+            float32_t tj1;
+            float32_t ta;
+            float32_t tv;
+            float32_t tj2;
+            float32_t td;
+            float32_t vlim;
+            float32_t T;
+        };
+
+        /**
+         * @protected
+         * @brief start velocity (SCURVE)
+         */
+        float32_t startVelocity;
+
+        /**
+         * @protected
+         * @brief last profiled point
+         */
+        float32_t lastPoint;
+
+        /**
+         * @protected
+         * @brief cached S-curve parts
+         */
+        struct scurve_t scurve[MPROFILE_SCURVE_PARTS];
+        uint32_t scurveParts;
+
+        /**
+         * @protected
+         * @brief compute S-curve parts for distance from velocity
+         * @return Total duration
+         */
+        float32_t calculateSCurvePlan(float32_t distance, float32_t velocity, struct scurve_t part[], uint32_t* n);
+
+        /**
+         * @protected
+         * @brief compute S-curve stop phase from velocity
+         */
+        void calculateSCurveStop(float32_t v, float32_t* tj, float32_t* td);
+
+        /**
+         * @protected
+         * @brief compute S-curve part from v0 (>= 0) to rest on h
+         */
+        void calculateSCurvePart(struct scurve_t* p, float32_t h, float32_t v0);
+
+        /**
+         * @protected
+         * @brief S-curve part displacement at t
+         */
+        float32_t calculateSCurvePart(const struct scurve_t* p, float32_t t);
+
+        /**
+         * @protected
+         * @brief S-curve part velocity and acceleration at t
+         */
+        void calculateSCurvePart(const struct scurve_t* p, float32_t t, float32_t* v, float32_t* a);
+
+        /**
+         * @protected
+         * @brief S-curve displacement at t (from start time)
+         */
+        float32_t calculateSCurvePosition(float32_t t);
+
+        /**
+         * @protected
+         * @brief compute cached duration and coefficients if needed
+         */
+        void update();
+
+        /**
+         * @protected
+         * @brief evaluate cached polynomial (Horner)
+         */
+        float32_t horner(float32_t t);
+
+        /**
+         * @protected
+         * @brief evaluate cached polynomial first and second derivatives (Horner)
+         */
+        void hornerDerivatives(float32_t t, float32_t* d1, float32_t* d2);
+
+        /**
+         * @protected
+         * @brief calculate profiled velocity and acceleration
+         */
+        void calculateDerivatives(float32_t time, float32_t* v, float32_t* a);
+
         /**
          * @protected
          * @brief calculate the minimum time
@@ -223,7 +496,7 @@ namespace MotionControl
 
         /**
          * @protected
-         * @brief calculate a standard trapezoidal profile
+         * @brief calculate a jerk limited 7 segments profile
          */
         float32_t calculateSCurveProfile(float32_t t);
 
@@ -293,12 +566,98 @@ namespace MotionControl
          */
         float32_t maxAcc;
 
+        /**
+         * @protected
+         * @brief maximum jerk
+         */
+        float32_t maxJerk;
+
         /**
          * @protected
          * @brief tf used by manual mode
          */
         float32_t tf;
     };
+
+    /**
+     * @class StaticMotionProfile
+     * @brief Motion profile with profile type fixed at compile time
+     *
+     * Get() calls the profile calculation directly (no dispatch on profile),
+     * use MotionProfile when profile has to be changed at runtime.
+     */
+    template<enum MotionProfile::PROFILE P>
+    class StaticMotionProfile : public MotionProfile
+    {
+    public:
+        /**
+         * @brief Constructor
+         */
+        StaticMotionProfile(float32_t maxVel = 1.0f, float32_t maxAcc = 1.0f, float32_t maxJerk = 10.0f)
+            : MotionProfile(maxVel, maxAcc, P, maxJerk)
+        {
+        }
+
+        /**
+         * @brief Profile is fixed
+         */
+        void SetProfile(enum MotionProfile::PROFILE profile) = delete;
+
+        /**
+         * @brief get setpoint profiled
+         */
+        float32_t Get(float32_t time)
+        {
+            float32_t tf = this->GetDuration();
+            float32_t t = time - this->startTime;
+
+            assert(t >= 0.0f);
+
+            this->tf = tf;
+            t /= tf;
+            this->progress = t;
+
+            this->lastPoint = this->startPoint + this->calculate(t);
+
+            return this->lastPoint;
+        }
+
+    protected:
+        /**
+         * @protected
+         * @brief calculate profile (specialized per profile type)
+         */
+        float32_t calculate(float32_t t)
+        {
+            // Runtime dispatch for profiles without specialization
+            return this->calculateProfile(t) - this->startPoint;
+        }
+    };
+
+    template<> inline float32_t StaticMotionProfile<MotionProfile::LINEAR>::calculate(float32_t t)
+    {
+        return this->calculateLinearProfile(t);
+    }
+
+    template<> inline float32_t StaticMotionProfile<MotionProfile::TRIANGLE>::calculate(float32_t t)
+    {
+        return this->calculateTriangleProfile(t);
+    }
+
+    template<> inline float32_t StaticMotionProfile<MotionProfile::SCURVE>::calculate(float32_t t)
+    {
+        return this->calculateSCurveProfile(t);
+    }
+
+    template<> inline float32_t StaticMotionProfile<MotionProfile::POLY3>::calculate(float32_t t)
+    {
+        return this->calculatePolynomial3Profile(t);
+    }
+
+    template<> inline float32_t StaticMotionProfile<MotionProfile::POLY5>::calculate(float32_t t)
+    {
+        return this->calculatePolynomial5Profile(t);
+    }
 }
 
 #endif /* INC_MOTIONPROFILE_HPP_ */
@@ -10,6 +10,7 @@
 #define INC_ODOMETRY_HPP_
 
 #include "HAL.hpp"
+#include "Utils.hpp"
 
 #include <math.h>
 
@@ -50,12 +51,89 @@ typedef struct robot
     float32_t LeftVelocity;
     float32_t RightVelocity;
 
+    // Observer estimates (by ODO_LOOP_PERIOD_MS)
+    float32_t LinearVelocityFiltered;
+    float32_t AngularVelocityFiltered;
+    float32_t LinearAcceleration;
+    float32_t AngularAcceleration;
+
     int32_t Xmm;
     int32_t Ymm;
     float32_t Odeg;
     int32_t Lmm;
 } robot_t;
 
+/**
+ * @brief Encoders sample latched by the sampling timer
+ */
+typedef struct
+{
+    uint32_t timestamp;     /* CPU cycles */
+    int32_t  dl;            /* Left delta (tick) */
+    int32_t  dr;            /* Right delta (tick) */
+} odo_sample_t;
+
+/**
+ * @brief Encoder edge tracking for the 1/T velocity estimation
+ */
+typedef struct
+{
+    uint32_t  seq;          /* Edge sequence number */
+    uint32_t  count;        /* Counter at edge (tick) */
+    uint32_t  timestamp;    /* CPU cycles at edge */
+    bool      valid;        /* Previous edge is recent enough */
+    float32_t velocity;     /* Estimate (tick by ODO_LOOP_PERIOD_MS) */
+} odo_edge_t;
+
+/**
+ * @brief Alpha-beta-gamma observer state
+ */
+typedef struct
+{
+    float32_t e;            /* Position estimate minus measurement */
+    float32_t v;            /* Velocity estimate (unit by loop) */
+    float32_t a;            /* Acceleration estimate (unit by loop^2) */
+} odo_observer_t;
+
+/**
+ * @brief Encoders samples FIFO size
+ */
+#define ODO_SAMPLES_MAX     (32u)
+
+/**
+ * @brief Utils::Trace markers of recorded encoders deltas (ARG is the int16 delta)
+ */
+#define ODO_TRACE_LEFT_ID   (1u)
+#define ODO_TRACE_RIGHT_ID  (2u)
+
+/**
+ * @brief Status bits
+ */
+#define ODO_STATUS_RUNNING  (1u<<0)     /* Task started */
+#define ODO_STATUS_RESTORED (1u<<1)     /* Pose restored after a warm reset, cleared when set again */
+#define ODO_STATUS_ENCODER  (1u<<2)     /* Encoder delta rejected since last ResetEncoderStats() */
+
+/**
+ * @brief Encoders (see Odometry::GetEncoderStats())
+ */
+#define ODO_LEFT            (0u)
+#define ODO_RIGHT           (1u)
+#define ODO_WHEELS          (2u)
+
+/**
+ * @brief Encoder health statistics (ticks)
+ */
+typedef struct
+{
+    uint32_t    samples;        /**< Deltas read (loops, or timer samples) */
+    uint32_t    moving;         /**< Non zero accepted deltas */
+    uint32_t    ticks;          /**< Accepted ticks, both directions */
+    uint32_t    peak;           /**< Largest accepted delta */
+    uint32_t    rejected;       /**< Deltas above the glitch filter, zeroed */
+    uint32_t    jumps;          /**< Rejected deltas far above it : counter corrupted or reloaded */
+    uint32_t    flips;          /**< Small deltas reversing the previous one : edge chatter */
+}ODO_ENCODER_STATS;
+
 
 /*----------------------------------------------------------------------------*/
 /* Class declaration	                                                      */
@@ -75,6 +153,11 @@ namespace Location
      * - On init, Call Init() to init values
      * - Call periodically Compute() to compute the robot location
      * - Call GetRobot() to get current location
+     *
+     * Location is published to readers through a sequence lock : writers
+     * (Compute and Set*) update a working copy within a critical section and
+     * publish it, readers copy the snapshot without blocking and retry if
+     * an update occurred meanwhile.
      */
     class Odometry
     {
@@ -90,11 +173,22 @@ namespace Location
         /**
          * @brief Return instance name
          */
-        std::string Name()
+        const char* Name()
         {
             return this->name;
         }
 
+        /**
+         * @brief Get Compute() execution time profiler
+         */
+        Utils::Profiler* GetProfiler()
+        {
+            return &this->profiler;
+        }
+
+        /**
+         * @brief Get status (ODO_STATUS_* bits)
+         */
         uint16_t GetStatus()
         {
         	return this->status;
@@ -110,7 +204,7 @@ namespace Location
          void Init(float32_t X, float32_t Y, float32_t O, float32_t L);
 
         /**
-         * @brief Get current location
+         * @brief Get current location (consistent snapshot, non blocking)
          * @param r : robot struct
          */
          void GetRobot(robot_t * r);
@@ -129,25 +223,49 @@ namespace Location
          * @brief Get Angular Velocity
          * @param period : Velocity period required
          */
-         float32_t GetAngularVelocity(float32_t period = 1000.0);
+         float32_t GetAngularVelocity(float32_t period = 1000.0f);
 
         /**
          * @brief Get Linear Velocity
          * @param period : Velocity period required
          */
-         float32_t GetLinearVelocity(float32_t period = 1000.0);
+         float32_t GetLinearVelocity(float32_t period = 1000.0f);
 
         /**
          * @brief Get Left Velocity
          * @param period : Velocity period required
          */
-         float32_t GetLeftVelocity(float32_t period = 1000.0);
+         float32_t GetLeftVelocity(float32_t period = 1000.0f);
 
         /**
          * @brief Get Right Velocity
          * @param period : Velocity period required
          */
-         float32_t GetRightVelocity(float32_t period = 1000.0);
+         float32_t GetRightVelocity(float32_t period = 1000.0f);
+
+        /**
+         * @brief Get observer filtered Angular Velocity
+         * @param period : Velocity period required
+         */
+         float32_t GetAngularVelocityFiltered(float32_t period = 1000.0f);
+
+        /**
+         * @brief Get observer filtered Linear Velocity
+         * @param period : Velocity period required
+         */
+         float32_t GetLinearVelocityFiltered(float32_t period = 1000.0f);
+
+        /**
+         * @brief Get observer Angular Acceleration
+         * @param period : Acceleration period required
+         */
+         float32_t GetAngularAcceleration(float32_t period = 1000.0f);
+
+        /**
+         * @brief Get observer Linear Acceleration
+         * @param period : Acceleration period required
+         */
+         float32_t GetLinearAcceleration(float32_t period = 1000.0f);
 
          /**
           * @brief Set coordinate X, Y and O (force XYO)
@@ -171,6 +289,28 @@ namespace Location
          */
          void SetYO(float32_t Y, float32_t O);
 
+        /**
+         * @brief Correct pose toward an external estimate (beacons, vision), any task
+         *
+         * The difference with the current pose is blended in by the odometry
+         * loop at a bounded rate (ODO_CORRECT_MM_BY_S, ODO_CORRECT_RAD_BY_S).
+         * L is kept : the linear setpoint and running profiles do not jump,
+         * the position loop follows the heading offset as a disturbance.
+         * A new estimate replaces the remaining correction, Set*() cancel it.
+         * @param X : X cartesian coordinate (X plane)
+         * @param Y : Y cartesian coordinate (Y plane)
+         * @param O : O polar coordinate (pole)
+         */
+         void Correct(float32_t X, float32_t Y, float32_t O);
+
+        /**
+         * @brief Return true while a correction is being blended in
+         */
+         bool IsCorrecting()
+         {
+             return (this->correctX != 0.0f) || (this->correctY != 0.0f) || (this->correctO != 0.0f);
+         }
+
          /**
           * @brief Reset all value of odometry
           */
@@ -193,11 +333,108 @@ namespace Location
           }
 
 
+         /**
+          * @brief Get encoder health statistics
+          * @param wheel : ODO_LEFT or ODO_RIGHT
+          * @param stats : Statistics
+          * @return false if wheel is invalid
+          *
+          * A healthy wheel has no rejected delta and few flips (chatter
+          * on an edge at standstill). Rejected deltas are zeroed : the
+          * pose loses these ticks.
+          */
+         bool GetEncoderStats(uint32_t wheel, ODO_ENCODER_STATS* stats);
+
+         /**
+          * @brief Clear encoder health statistics and ODO_STATUS_ENCODER
+          */
+         void ResetEncoderStats();
+
+          /**
+         * @brief Get number of encoders samples lost (sampling mode only)
+         */
+          uint32_t GetSamplesLost()
+          {
+              return this->samplesLost;
+          }
+
+          /**
+           * @brief New sample event
+           * Raised by the odometry task each time a new robot state is published
+           */
+          Utils::Event<> SampleAvailable;
+
           /**
          * @brief Compute robot location (Should be called periodically)
          */
          void Compute(float32_t period);
 
+        /**
+         * @brief Record raw encoders deltas as Utils::Trace markers (while tracing)
+         */
+         void SetRecording(bool enable)
+         {
+             this->recording = enable;
+         }
+
+         bool IsRecording()
+         {
+             return this->recording;
+         }
+
+        /**
+         * @brief Compute one step from recorded deltas instead of encoders
+         * @param dl : Left delta (tick, as GetRelativeValue())
+         * @param dr : Right delta (tick, sign of the right encoder already applied)
+         *
+         * Same path as Compute() (glitch filter, integration, observers) but
+         * for the 1/T low speed velocity : edges are not recorded. Location
+         * is bit exact with the recorded run.
+         */
+         void Replay(int32_t dl, int32_t dr);
+
+        /**
+         * @brief Replay the deltas recorded in the stopped Utils::Trace buffer
+         * @return Number of replayed samples
+         */
+         uint32_t ReplayTrace();
+
+        /**
+         * @brief Register drive motors, their steps refine the heading
+         * @param left : Left drive motor
+         * @param right : Right drive motor
+         * @param leftRadByTurn : Heading by left motor turn (rad, sign of the mounting applied)
+         * @param rightRadByTurn : Heading by right motor turn (rad, sign of the mounting applied)
+         */
+         void SetDriveMotors(HAL::Drv8813* left, HAL::Drv8813* right, float32_t leftRadByTurn, float32_t rightRadByTurn);
+
+        /**
+         * @brief Enable heading fusion (encoder wheels, drive steps, gyro)
+         */
+         void SetFusion(bool enable)
+         {
+             this->fusion = enable;
+         }
+
+         bool IsFusionEnabled()
+         {
+             return this->fusion;
+         }
+
+        /**
+         * @brief Get heading correction accumulated by the fusion (rad)
+         */
+         float32_t GetFusionCorrection()
+         {
+             return this->fusionCorrection;
+         }
+
+        /**
+         * @private
+         * @brief Latch encoders deltas from sampling timer interrupt. DO NOT CALL !!
+         */
+         void INTERNAL_SampleEncoders();
+
     protected:
         /**
          * @brief Odometry default constructor
@@ -222,7 +459,7 @@ namespace Location
          * @protected
          * @brief Instance name
          */
-        std::string name;
+        const char* name;
 
         /**
          * @protected
@@ -232,10 +469,224 @@ namespace Location
 
         /**
          * @protected
-         * @brief data of robot
+         * @brief data of robot (working copy, writers only)
          */
         robot_t robot;
 
+        /**
+         * @protected
+         * @brief data of robot (published copy, readers only)
+         */
+        robot_t snapshot;
+
+        /**
+         * @protected
+         * @brief Snapshot sequence number (odd while publishing)
+         */
+        volatile uint32_t seq;
+
+        /**
+         * @protected
+         * @brief Fixed-point working state
+         *
+         * heading : 2^-48 turn, X/Y : Q16 ticks, L : half ticks
+         */
+        int64_t heading;
+        int64_t xQ16;
+        int64_t yQ16;
+        int64_t lHalf;
+
+        /**
+         * @protected
+         * @brief Wheels geometry (non volatile configuration) and derived constants
+         *
+         * tickByMm, adwTick : see CONFIG_DATA, ticks : tick / length conversions,
+         * radByTick : inverse of adwTick, wheelScaleL/R : wheelRatio correction
+         * by wheel (Q16, fraction of tick carried in wheelRemL/R),
+         * headingByTick : heading by (right - left) tick, deltaMax : glitch
+         * filter bound by loop and by sample (tick)
+         */
+        float64_t tickByMm;
+        float64_t adwTick;
+        Utils::Units::TickScale ticks;
+        float32_t radByTick;
+        int64_t headingByTick;
+        int32_t loopDeltaMax;
+        int32_t sampleDeltaMax;
+        int32_t wheelScaleL;
+        int32_t wheelScaleR;
+        int32_t wheelRemL;
+        int32_t wheelRemR;
+
+        /**
+         * @protected
+         * @brief Load wheels geometry from configuration
+         */
+        void loadGeometry();
+
+        /**
+         * @protected
+         * @brief Apply a wheel scale to an encoder delta
+         * @param d : Delta (tick)
+         * @param scale : Wheel scale (Q16)
+         * @param rem : Fraction of tick carried between calls
+         */
+        int32_t wheelScale(int32_t d, int32_t scale, int32_t* rem);
+
+        /**
+         * @protected
+         * @brief Encoder health statistics, last non zero delta by wheel
+         */
+        ODO_ENCODER_STATS encoderStats[ODO_WHEELS];
+        int32_t encoderLast[ODO_WHEELS];
+
+        /**
+         * @protected
+         * @brief Glitch filter an encoder delta, update its wheel statistics
+         * @param wheel : ODO_LEFT or ODO_RIGHT
+         * @param d : Delta (tick)
+         * @param max : Glitch filter bound (tick)
+         * @return Delta, 0 if rejected
+         */
+        int32_t screen(uint32_t wheel, int32_t d, int32_t max);
+
+        /**
+         * @protected
+         * @brief Encoders sampling timer (NULL if sampled by the task)
+         */
+        HAL::Timer* samplingTimer;
+
+        /**
+         * @protected
+         * @brief Encoders samples FIFO (written by interrupt, read by task)
+         */
+        Utils::SpscRing<odo_sample_t, ODO_SAMPLES_MAX> samples;
+        uint32_t samplesLost;
+
+        /**
+         * @protected
+         * @brief Encoders deltas recording, replayed sample (NULL : encoders are read)
+         */
+        volatile bool recording;
+        const odo_sample_t* replay;
+
+        /**
+         * @protected
+         * @brief Record encoders deltas (if recording and tracing)
+         */
+        void record(int32_t dl, int32_t dr);
+
+        /**
+         * @protected
+         * @brief Timestamp of the last consumed sample (CPU cycles)
+         */
+        uint32_t lastSampleTime;
+
+        /**
+         * @protected
+         * @brief Left and right encoders edges (1/T velocity)
+         */
+        odo_edge_t leftEdge;
+        odo_edge_t rightEdge;
+
+        /**
+         * @protected
+         * @brief Low speed wheel velocity from encoder edges period (1/T method)
+         * @param encoder : Wheel encoder
+         * @param edge : Wheel edge tracking
+         * @param sign : Wheel direction (+1 or -1)
+         * @param now : Current CPU cycles
+         * @return Velocity (tick by ODO_LOOP_PERIOD_MS)
+         */
+        float32_t edgeVelocity(HAL::Encoder* encoder, odo_edge_t* edge, int32_t sign, uint32_t now);
+
+        /**
+         * @protected
+         * @brief Linear (tick) and angular (rad) observers
+         */
+        odo_observer_t linearObserver;
+        odo_observer_t angularObserver;
+
+        /**
+         * @protected
+         * @brief Update an observer with a new position delta
+         * @param obs : Observer
+         * @param d : Measured position delta
+         * @param dt : Time since last update (loop period unit)
+         */
+        void observe(odo_observer_t* obs, float32_t d, float32_t dt);
+
+        /**
+         * @protected
+         * @brief Heading fusion : drive motors, steps at last loop, heading by motor turn
+         */
+        HAL::Drv8813* leftDrive;
+        HAL::Drv8813* rightDrive;
+        int32_t leftDriveSteps;
+        int32_t rightDriveSteps;
+        float32_t leftDriveRadByTurn;
+        float32_t rightDriveRadByTurn;
+
+        /**
+         * @protected
+         * @brief Heading fusion : optional gyro (NULL if absent), last rate and bias (rad/s)
+         */
+        HAL::Gyro* gyro;
+        float32_t gyroRate;
+        float32_t gyroBias;
+        bool gyroValid;
+
+        /**
+         * @protected
+         * @brief Heading fusion enable, accumulated correction (rad)
+         */
+        volatile bool fusion;
+        float32_t fusionCorrection;
+
+        /**
+         * @protected
+         * @brief Blend encoder wheels heading delta with drive steps and gyro ones
+         * @param start : Heading before this loop integration (2^-48 turn)
+         * @param dt : Time since last loop (loop period unit)
+         * @param still : Encoder wheels did not move (gyro bias estimation)
+         */
+        void fuse(int64_t start, float32_t dt, bool still);
+
+        /**
+         * @protected
+         * @brief External pose correction left to blend in (tick, tick, rad)
+         */
+        float32_t correctX;
+        float32_t correctY;
+        float32_t correctO;
+
+        /**
+         * @protected
+         * @brief Blend a bounded part of the pose correction into the working copy
+         * @param dt : Time since last loop (loop period unit)
+         */
+        void blend(float32_t dt);
+
+        /**
+         * @protected
+         * @brief Integrate wheels deltas into the working copy
+         * @param dl : Left delta (tick)
+         * @param dr : Right delta (tick)
+         */
+        void integrate(int32_t dl, int32_t dr);
+
+        /**
+         * @protected
+         * @brief Load fixed-point state from the float working copy
+         */
+        void loadFixedPoint();
+
+        /**
+         * @protected
+         * @brief Publish working copy to readers (must be called within a critical section)
+         */
+        void publish();
+
         /**
          * @protected
          * @brief Left wheel encoder
@@ -272,6 +723,24 @@ namespace Location
          */
         TaskHandle_t taskHandle;
 
+        /**
+         * @protected
+         * @brief Compute() execution time profiler
+         */
+        Utils::Profiler profiler;
+
+        /**
+         * @protected
+         * @brief Task loop scheduling statistics
+         */
+        Utils::PeriodicTask periodic;
+
+        /**
+         * @protected
+         * @brief Watchdog client (see Utils::Watchdog)
+         */
+        int32_t health;
+
         /**
          * @protected
          * @brief Odometry loop task handler
@@ -0,0 +1,122 @@
+/**
+ * @file    Perf.hpp
+ * @author  Jeremy ROULLAND
+ * @date    15 oct. 2026
+ * @brief   Performance counters over a measurement window (CPU, loops, buses, losses)
+ */
+
+#ifndef INC_PERF_HPP_
+#define INC_PERF_HPP_
+
+#include "common.h"
+
+// FreeRTOS
+#include "FreeRTOS.h"
+#include "task.h"
+
+/*----------------------------------------------------------------------------*/
+/* Definitions                                                                */
+/*----------------------------------------------------------------------------*/
+
+#define PERF_TASKS_MAX          (24u)       // OS task numbers with a run time baseline
+
+/**
+ * @brief Buses (see Perf::GetBusLoad())
+ */
+#define PERF_BUS_CONSOLE        (0u)        /**< Console USART, transmitted bytes */
+#define PERF_BUS_I2C            (1u)        /**< Main board I2C slave, both directions */
+#define PERF_BUS_SPI            (2u)        /**< SPI master */
+#define PERF_BUS_MAX            (3u)
+
+/**
+ * @brief Performance summary, loads in 1/1000
+ */
+typedef struct
+{
+    uint32_t    window;                 /**< Measurement window (ms) */
+    uint16_t    cpu;                    /**< CPU load (idle task excluded) */
+    uint16_t    busiestLoad;            /**< Load of the busiest profiled loop or IRQ */
+    uint8_t     busiest;                /**< Its Utils::Profiler index */
+    uint32_t    loopMax;                /**< Longest profiled loop or IRQ (us) */
+    uint32_t    latencyMax;             /**< Worst periodic task wake up latency (us) */
+    uint32_t    missed;                 /**< Periodic task deadlines missed */
+    uint32_t    traceLost;              /**< Trace records overwritten */
+    uint32_t    logLost;                /**< Log records dropped */
+    uint32_t    txDropped;              /**< Console bytes dropped */
+    uint32_t    deferredDropped;        /**< Deferred calls dropped */
+    uint16_t    ordersPeak;             /**< Pending motion orders high-water mark */
+    uint16_t    bus[PERF_BUS_MAX];      /**< Buses utilization */
+}PERF_SUMMARY;
+
+/*----------------------------------------------------------------------------*/
+/* Class declaration                                                          */
+/*----------------------------------------------------------------------------*/
+
+/**
+ * @class Perf
+ * @brief Performance dashboard : one place for the counters spread over modules
+ *
+ * HOWTO :
+ * - Call Reset() to start a measurement window : counters that never reset
+ *   (task run time, bus bytes, lost records) get a baseline, statistics that
+ *   do (profilers, periodic tasks, orders peak) are reset
+ * - Read the window with GetSummary(), GetTasks(), GetProfilerLoad(),
+ *   GetBusLoad()
+ *
+ * Before the first Reset(), the window starts at boot. OS run time counters
+ * are 32 bits microseconds : keep windows under ~71 min.
+ */
+class Perf
+{
+public:
+
+    /**
+     * @brief Start a new measurement window
+     */
+    static void Reset ();
+
+    /**
+     * @brief Get window length (ms)
+     */
+    static uint32_t GetWindow ();
+
+    /**
+     * @brief Get tasks state and load over the window
+     * @param tasks : Tasks state (see uxTaskGetSystemState())
+     * @param loads : Tasks load (1/1000)
+     * @param max : Array sizes (at least uxTaskGetNumberOfTasks())
+     * @return Number of tasks, 0 if max is too small
+     */
+    static uint32_t GetTasks (TaskStatus_t* tasks, uint16_t* loads, uint32_t max);
+
+    /**
+     * @brief Get profiled loop or IRQ load over the window (1/1000)
+     * @param index : Utils::Profiler index
+     */
+    static uint16_t GetProfilerLoad (uint32_t index);
+
+    /**
+     * @brief Get bus bytes over the window
+     * @param bus : PERF_BUS_*
+     */
+    static uint32_t GetBusBytes (uint32_t bus);
+
+    /**
+     * @brief Get bus utilization over the window (1/1000 of the line rate)
+     * @param bus : PERF_BUS_*
+     */
+    static uint16_t GetBusLoad (uint32_t bus);
+
+    /**
+     * @brief Get bus name
+     * @param bus : PERF_BUS_*
+     */
+    static const char* GetBusName (uint32_t bus);
+
+    /**
+     * @brief Fill the window summary (does not reset)
+     */
+    static void GetSummary (PERF_SUMMARY* summary);
+};
+
+#endif /* INC_PERF_HPP_ */
@@ -13,6 +13,7 @@
 #include "Odometry.hpp"
 #include "DRV8813.hpp"
 #include "MotionProfile.hpp"
+#include "TaskTable.hpp"
 
 // FreeRTOS
 #include "FreeRTOS.h"
@@ -23,6 +24,30 @@
 /*----------------------------------------------------------------------------*/
 /* Definitions                                                                */
 /*----------------------------------------------------------------------------*/
+
+/**
+ * @brief Position loop period (multiple of the MotionControl period)
+ */
+#define PC_TASK_PERIOD_MS           (TASK_PC_PERIOD_MS)
+
+/**
+ * @brief Cascaded velocity loop : position loop output is a velocity setpoint,
+ * regulated against encoders velocity by ComputeVelocity() at odometry rate
+ */
+#define PC_VELOCITY_CASCADE         (1u)
+#define PC_VC_PERIOD_MS             (TASK_ODOMETRY_PERIOD_MS)
+
+/**
+ * @brief Cascade output streamed to the motors in velocity mode (Drv8813::SetVelocityRPS()),
+ * else played as one period of steps
+ */
+#define PC_VELOCITY_STREAM          (1u)
+
+/**
+ * @brief Linear profile type (fixed at compile time)
+ */
+#define LINEAR_PROFILE              (MotionControl::MotionProfile::PROFILE::SCURVE)
+
 typedef struct
 {
     // Motors
@@ -42,8 +67,86 @@ typedef struct
 
     struct pc_pid PID_Linear;
 
+    // Velocity loop PI (cascade)
+    struct pc_pid PID_AngularVelocity;
+    struct pc_pid PID_LinearVelocity;
+
+    // Profiles limits
+    struct pc_limits
+    {
+        float32_t    velMax;
+        float32_t    accMax;
+        float32_t    jerkMax;
+    }Limits_Angular;
+
+    struct pc_limits Limits_Linear;
+
 }PC_DEF;
 
+/**
+ * @brief Limits and gains presets (see PositionControl::SelectPreset())
+ */
+#define PC_PRESET_NORMAL            (0u)
+#define PC_PRESET_FAST              (1u)
+#define PC_PRESETS                  (2u)
+
+typedef struct
+{
+    PC_DEF::pc_pid      PID_Angular;
+    PC_DEF::pc_pid      PID_Linear;
+    PC_DEF::pc_limits   Limits_Angular;
+    PC_DEF::pc_limits   Limits_Linear;
+}PC_PRESET;
+
+/**
+ * @brief Setpoint mailbox entry (see PositionControl::Post())
+ */
+#define PC_SETPOINT_ANGULAR         (1u << 0)
+#define PC_SETPOINT_LINEAR          (1u << 1)
+
+typedef struct
+{
+    uint8_t     axes;           /**< PC_SETPOINT_* axes set */
+    bool        resetPid;       /**< Reset position PIDs before applying */
+    float32_t   angular;        /**< Angular position (rad) */
+    float32_t   linear;         /**< Linear position (m) */
+}PC_SETPOINT;
+
+/**
+ * @brief Command mailbox entry (see PositionControl::postCommand())
+ */
+#define PC_COMMANDS_MAX             (16u)
+
+typedef enum
+{
+    PC_COMMAND_ENABLE = 0,
+    PC_COMMAND_DISABLE,
+    PC_COMMAND_TUNE_START,      /**< arg : tuned axis */
+    PC_COMMAND_TUNE_STOP,
+    PC_COMMAND_STEP_MODE,       /**< arg : step mode */
+    PC_COMMAND_SYNCHRONIZED,    /**< arg : synchronized */
+    PC_COMMAND_PRESET,          /**< arg : preset */
+}PC_COMMAND_ID;
+
+typedef struct
+{
+    uint8_t     id;             /**< PC_COMMAND_ID */
+    uint8_t     arg;            /**< Command argument */
+}PC_COMMAND;
+
+/**
+ * @brief Positioning completion window (see PositionControl::isPositioningSettled())
+ */
+typedef struct
+{
+    float32_t   linear;         /**< Linear position error (m) */
+    float32_t   angular;        /**< Angular position error (rad) */
+    float32_t   linearVel;      /**< Linear velocity (m/s) */
+    float32_t   angularVel;     /**< Angular velocity (rad/s) */
+    uint32_t    samples;        /**< Consecutive periods inside the window */
+    float32_t   timeout;        /**< Completion forced after the profiles end (s) */
+}PC_SETTLE;
+
 /*----------------------------------------------------------------------------*/
 /* Class declaration                                                          */
 /*----------------------------------------------------------------------------*/
@@ -60,6 +163,10 @@ namespace MotionControl
      * HOWTO :
      * -
      *
+     * Single writer : the position loop state is only written by Compute().
+     * Other tasks post their changes (setpoints to Post(), commands to a
+     * queue, tuning to def and Utils::Param), applied at the start of the
+     * next period. No lock is taken by the position loop.
      */
     class PositionControl
     {
@@ -84,38 +191,87 @@ namespace MotionControl
         /**
          * @brief Return instance name
          */
-        std::string Name()
+        const char* Name()
         {
             return this->name;
         }
 
+        /**
+         * @brief Get Compute() execution time profiler
+         */
+        Utils::Profiler* GetProfiler()
+        {
+            return &this->profiler;
+        }
+
         uint16_t GetStatus()
         {
         	return this->status;
         }
 
         /**
-         * @brief Set angular position setpoint
+         * @brief Set angular position setpoint (see Post())
+         * @param resetPid : Reset position PIDs when applied (else integrators are kept)
          */
-        void SetAngularPosition(float32_t position)
+        void SetAngularPosition(float32_t position, bool resetPid = false)
         {
-            float32_t currentAngularPosition  = 0.0;
-            float32_t time = 0.0;
+            PC_SETPOINT setpoint = {PC_SETPOINT_ANGULAR, resetPid, position, 0.0f};
+
+            this->Post(setpoint);
+        }
+
+        /**
+         * @brief Set both position setpoints, applied in the same period (see Post())
+         * @param resetPid : Reset position PIDs when applied (else integrators are kept)
+         */
+        void SetPosition(float32_t angular, float32_t linear, bool resetPid = false)
+        {
+            PC_SETPOINT setpoint = {PC_SETPOINT_ANGULAR | PC_SETPOINT_LINEAR, resetPid, angular, linear};
+
+            this->Post(setpoint);
+        }
 
-            // Get current and time
-            currentAngularPosition = odometry->GetAngularPosition();
-            time = getTime();
+        /**
+         * @brief Publish a setpoint to the position loop (one task, TrajectoryPlanning)
+         *
+         * Written in the back buffer of a double buffered mailbox, then published
+         * by swapping the buffers : the position loop takes it at the start of its
+         * next period, axes of a setpoint not taken yet are kept if not overwritten.
+         * Positioning is not finished while a setpoint is pending.
+         */
+        void Post(const PC_SETPOINT& setpoint);
 
-            // Reset PID
-            this->pid_angular.Reset();
-            this->pid_linear.Reset();
+        /**
+         * @brief Track angular position setpoint without profile (path following)
+         *
+         * Setpoint may be updated on each period, angular profile is restored by
+         * next SetAngularPosition()
+         */
+        void TrackAngularPosition(float32_t position)
+        {
+            if(!this->angularTracking)
+            {
+                this->setAngularTracking(true);
+                this->angularProfile.SetSetPoint(position, odometry->GetAngularPosition(), getTime());
+            }
 
-            // Set angular position order
             this->angularPosition = position;
+        }
 
-            // Start profile
-             this->angularProfile.SetSetPoint(this->angularPosition, currentAngularPosition, time);
-          }
+        /**
+         * @brief Track linear position setpoint without profile (velocity planned by caller)
+         *
+         * Position, velocity and acceleration (feed forward) may be updated on
+         * each period, linear profile is restored by next SetLinearPosition()
+         * (from tracked position, at rest)
+         */
+        void TrackLinearPosition(float32_t position, float32_t velocity, float32_t acceleration)
+        {
+            this->linearTracking = true;
+            this->linearPosition = position;
+            this->linearTrackedVelocity = velocity;
+            this->linearTrackedAcceleration = acceleration;
+        }
 
         /**
          * @brief Get angular position setpoint
@@ -126,28 +282,25 @@ namespace MotionControl
         }
 
         /**
-         * @brief Set linear position setpoint
+         * @brief Set linear position setpoint (see Post())
+         * @param resetPid : Reset position PIDs when applied (else integrators are kept)
          */
-        void SetLinearPosition(float32_t position)
+        void SetLinearPosition(float32_t position, bool resetPid = false)
         {
-            float32_t currentLinearPosition  = 0.0;
-            float32_t time = 0.0;
-
-            // Get current and time
-            currentLinearPosition = odometry->GetLinearPosition();
-            time = getTime();
-
-            // Reset PID
-            this->pid_angular.Reset();
-            this->pid_linear.Reset();
-
-            // Set linear position order
-            this->linearPosition = position;
+            PC_SETPOINT setpoint = {PC_SETPOINT_LINEAR, resetPid, 0.0f, position};
 
-            // Start profile
-             this->linearProfile.SetSetPoint(this->linearPosition, currentLinearPosition, time);
+            this->Post(setpoint);
         }
 
+        /**
+         * @brief Brake both axes to rest at maximum deceleration (shortest stop keeping steps)
+         *
+         * Profiles are replanned from current profiled state (or tracked state)
+         * to their stop point, setpoints become the stop points. A posted
+         * setpoint not taken yet is dropped.
+         */
+        void Brake();
+
         /**
          * @brief Get linear position setpoint
          */
@@ -204,13 +357,67 @@ namespace MotionControl
             return this->linearVelocity;
         }
 
+        /**
+         * @brief Enable/disable coordinated motion (profiles started together end together)
+         *
+         * Applied at the start of next period, before a setpoint posted after it.
+         */
+        void SetSynchronized(bool synchronized)
+        {
+            this->postCommand(PC_COMMAND_SYNCHRONIZED, synchronized ? 1u : 0u);
+        }
+
+        /**
+         * @brief Get coordinated motion state
+         */
+        bool GetSynchronized()
+        {
+            return this->synchronized;
+        }
+
+        /**
+         * @brief Select a limits and gains preset (PC_PRESET_*, from Config)
+         *
+         * Copied at once at the start of next period : profiles limits apply
+         * from the next setpoint, live parameters show the preset values.
+         * @return false if preset is unknown
+         */
+        bool SelectPreset(uint32_t preset);
+
+        /**
+         * @brief Get selected preset
+         */
+        uint32_t GetPreset()
+        {
+            return this->preset;
+        }
+
+        /**
+         * @brief Get angular profiled velocity (feed forward)
+         */
+        float32_t GetAngularVelocityProfiled()
+        {
+            return this->angularVelocityProfiled;
+        }
+
+        /**
+         * @brief Get linear profiled velocity (feed forward)
+         */
+        float32_t GetLinearVelocityProfiled()
+        {
+            return this->linearVelocityProfiled;
+        }
+
         /**
          * @brief Set Angular Kp
+         *
+         * Gains and limits setters write the definition, applied at the start
+         * of next period (as Utils::Param writes)
          */
         void SetAngularKp(float32_t Kp)
         {
             this->def.PID_Angular.kp = Kp;
-            this->pid_angular.SetKp(Kp);
+            this->tuningChanged = true;
         }
 
         /**
@@ -219,7 +426,7 @@ namespace MotionControl
         void SetAngularKi(float32_t Ki)
         {
             this->def.PID_Angular.ki = Ki;
-            this->pid_angular.SetKi(Ki);
+            this->tuningChanged = true;
         }
 
         /**
@@ -228,7 +435,7 @@ namespace MotionControl
         void SetAngularKd(float32_t Kd)
         {
             this->def.PID_Angular.kd = Kd;
-            this->pid_angular.SetKd(Kd);
+            this->tuningChanged = true;
         }
 
         /**
@@ -237,7 +444,7 @@ namespace MotionControl
         void SetLinearKp(float32_t Kp)
         {
             this->def.PID_Linear.kp = Kp;
-            this->pid_linear.SetKp(Kp);
+            this->tuningChanged = true;
         }
 
         /**
@@ -246,7 +453,7 @@ namespace MotionControl
         void SetLinearKi(float32_t Ki)
         {
             this->def.PID_Linear.ki = Ki;
-            this->pid_linear.SetKi(Ki);
+            this->tuningChanged = true;
         }
 
         /**
@@ -255,31 +462,142 @@ namespace MotionControl
         void SetLinearKd(float32_t Kd)
         {
             this->def.PID_Linear.kd = Kd;
-            this->pid_linear.SetKd(Kd);
+            this->tuningChanged = true;
+        }
+
+        /**
+         * @brief Set Angular profile limits
+         */
+        void SetAngularVelMax(float32_t velMax)
+        {
+            this->def.Limits_Angular.velMax = velMax;
+            this->tuningChanged = true;
+        }
+
+        void SetAngularAccMax(float32_t accMax)
+        {
+            this->def.Limits_Angular.accMax = accMax;
+            this->tuningChanged = true;
+        }
+
+        void SetAngularJerkMax(float32_t jerkMax)
+        {
+            this->def.Limits_Angular.jerkMax = jerkMax;
+            this->tuningChanged = true;
+        }
+
+        /**
+         * @brief Get Angular profile limits
+         */
+        float32_t GetAngularVelMax()
+        {
+            return this->def.Limits_Angular.velMax;
+        }
+
+        float32_t GetAngularAccMax()
+        {
+            return this->def.Limits_Angular.accMax;
+        }
+
+        /**
+         * @brief Set Linear profile limits
+         */
+        void SetLinearVelMax(float32_t velMax)
+        {
+            this->def.Limits_Linear.velMax = velMax;
+            this->tuningChanged = true;
+        }
+
+        void SetLinearAccMax(float32_t accMax)
+        {
+            this->def.Limits_Linear.accMax = accMax;
+            this->tuningChanged = true;
+        }
+
+        void SetLinearJerkMax(float32_t jerkMax)
+        {
+            this->def.Limits_Linear.jerkMax = jerkMax;
+            this->tuningChanged = true;
+        }
+
+        /**
+         * @brief Get Linear profile limits
+         */
+        float32_t GetLinearVelMax()
+        {
+            return this->def.Limits_Linear.velMax;
+        }
+
+        float32_t GetLinearAccMax()
+        {
+            return this->def.Limits_Linear.accMax;
         }
 
         /**
-         * @brief Enable
+         * @brief Enable (applied at the start of next period)
+         *
+         * Nothing posted if already in this state with no command pending
+         * (TrajectoryPlanning calls it on each period).
          */
         void Enable()
         {
-            if(this->enable == false)
-            {
-                this->pid_angular.Reset();
-                this->pid_linear.Reset();
-                this->enable = true;
-            }
+            if(!this->enable || (uxQueueMessagesWaiting(this->commands) != 0u))
+                this->postCommand(PC_COMMAND_ENABLE);
         }
 
         /**
-         * @brief Disable
+         * @brief Disable (applied at the start of next period, see Enable())
          */
         void Disable()
         {
-            if(this->enable == true)
-            {
-                this->enable = false;
-            }
+            if(this->enable || (uxQueueMessagesWaiting(this->commands) != 0u))
+                this->postCommand(PC_COMMAND_DISABLE);
+        }
+
+        /**
+         * @brief Return true if enabled
+         */
+        bool IsEnabled()
+        {
+            return this->enable;
+        }
+
+        /**
+         * @brief Start PID auto-tuning (relay feedback) of one axis
+         *
+         * The axis holds its position with a relay instead of its PID, the
+         * other axis stays regulated. Aborted by Disable(), StopTuning() or a
+         * new setpoint. Started at the start of next period if still allowed.
+         * @param axis : ANGULAR or LINEAR
+         * @return false if disabled or positioning
+         */
+        bool StartTuning(enum ID axis);
+
+        /**
+         * @brief Abort PID auto-tuning (at the start of next period)
+         */
+        void StopTuning()
+        {
+            this->postCommand(PC_COMMAND_TUNE_STOP);
+        }
+
+        /**
+         * @brief Apply auto-tuning proposed gains to the tuned axis (see Utils::Param)
+         * @param rule : Tuning rule
+         * @return false if tuning is not DONE or gains are out of bounds
+         */
+        bool ApplyTuning(enum Utils::RelayTuner::RULE rule);
+
+        /**
+         * @brief Get auto-tuner and tuned axis
+         */
+        Utils::RelayTuner* GetTuner()
+        {
+            return &this->tuner;
+        }
+        enum ID GetTuningAxis()
+        {
+            return this->tuningAxis;
         }
 
         /**
@@ -289,11 +607,123 @@ namespace MotionControl
         {
             bool Finished = false;
 
-            Finished = this->angularProfile.isFinished() && this->linearProfile.isFinished();
+            Finished = this->angularProfile.isFinished() && this->linearProfile.isFinished() && !this->linearTracking &&
+                       !this->pending;
+
+            // Step mode : motors play the move on their own clock
+            if(this->stepMode)
+                Finished = Finished && (this->leftMotor->GetRemainingSteps() == 0u) &&
+                                       (this->rightMotor->GetRemainingSteps() == 0u);
 
             return Finished;
         }
 
+        /**
+         * @brief are both wheel motors stalled (robot against a border)
+         */
+        bool isStalled()
+        {
+            return this->leftMotor->IsStalled() && this->rightMotor->IsStalled();
+        }
+
+        /**
+         * @brief Clear wheel motors stall
+         */
+        void ClearStall()
+        {
+            this->leftMotor->ClearStall();
+            this->rightMotor->ClearStall();
+        }
+
+        /**
+         * @brief is a wheel slipping or missing steps
+         *
+         * Commanded steps are compared every period with the travel measured
+         * by the encoder wheels (brought back to motor wheels), the difference
+         * is accumulated with a forgetting factor.
+         */
+        bool isSlipping()
+        {
+            return this->slipping;
+        }
+
+        /**
+         * @brief Return left wheel slip (commanded minus measured, m)
+         */
+        float32_t GetLeftSlip()
+        {
+            return this->leftSlip;
+        }
+
+        /**
+         * @brief Return right wheel slip (commanded minus measured, m)
+         */
+        float32_t GetRightSlip()
+        {
+            return this->rightSlip;
+        }
+
+        /**
+         * @brief Clear wheels slip
+         */
+        void ClearSlip()
+        {
+            this->leftSlip  = 0.0f;
+            this->rightSlip = 0.0f;
+            this->slipping  = false;
+        }
+
+        /**
+         * @brief Slip detected event
+         * Raised by the position control task when a wheel starts slipping
+         */
+        Utils::Event<> SlipDetected;
+
+        /**
+         * @private
+         * @brief Tuning parameter changed. DO NOT CALL !!
+         */
+        void INTERNAL_TuningChanged()
+        {
+            this->tuningChanged = true;
+        }
+
+        /**
+         * @brief is positioning finished and the robot settled on the setpoints
+         *
+         * Profiles are finished (isPositioningFinished()), then position errors
+         * and measured velocities stayed inside the completion window
+         * (PC_SETTLE, live parameters win*) for its samples count, or its
+         * timeout elapsed since the profiles end. Disabled position control
+         * settles with the profiles.
+         */
+        bool isPositioningSettled()
+        {
+            return this->settled && this->isPositioningFinished();
+        }
+
+        /**
+         * @brief Last completion was forced by the window timeout
+         */
+        bool isSettleTimedOut()
+        {
+            return this->settleTimedOut;
+        }
+
+        /**
+         * @brief Positioning settled event
+         * Raised by the position control task once by setpoint (see isPositioningSettled())
+         */
+        Utils::Event<> PositioningSettled;
+
+        /**
+         * @brief is angular and linear positioning in deceleration phase
+         */
+        bool isPositioningDecelerating()
+        {
+            return this->angularProfile.isDecelerating() && this->linearProfile.isDecelerating() && !this->linearTracking;
+        }
+
         /**
          * @brief Compute robot velocity
          */
@@ -304,6 +734,91 @@ namespace MotionControl
          */
         void ToMotors();
 
+        /**
+         * @brief Set velocity override on running profiles (feed override)
+         *
+         * Profiles are evaluated on a clock running at ratio times real time :
+         * same path, velocity scaled by ratio (0 holds position). The ratio
+         * applied is ramped toward the requested one (PC_OVERRIDE_RATE).
+         * Single word mailbox : last written ratio wins, any task.
+         * @param ratio : 0 to 1
+         */
+        void SetVelocityOverride(float32_t ratio)
+        {
+            if(ratio < 0.0f)
+                ratio = 0.0f;
+            if(ratio > 1.0f)
+                ratio = 1.0f;
+
+            this->overrideTarget = ratio;
+        }
+
+        /**
+         * @brief Get applied velocity override (0 to 1)
+         */
+        float32_t GetVelocityOverride()
+        {
+            return this->override;
+        }
+
+        /**
+         * @brief Scale velocity and acceleration limits (supply voltage, see Battery)
+         *
+         * Limits set by configuration, parameters and Set*Max() are the
+         * worst case ones, profiles and step moves use them times scale
+         * (accelerations also times wheel motors thermal derating).
+         * Applied from next setpoint, a running profile keeps its limits.
+         * @param scale : 1 (worst case) or more
+         */
+        void SetLimitScale(float32_t scale)
+        {
+            if(scale < 1.0f)
+                scale = 1.0f;
+
+            if(scale == this->limitScale)
+                return;
+
+            this->limitScale = scale;
+            this->applyLimits();
+        }
+
+        /**
+         * @brief Get limits scale (1 : worst case limits)
+         */
+        float32_t GetLimitScale()
+        {
+            return this->limitScale;
+        }
+
+        /**
+         * @brief Select step position mode (open loop) or velocity mode (closed loop, default)
+         *
+         * In step mode, each setpoint is converted once to left/right step counts
+         * played by Drv8813 ramps (Move()), limited by the profiles limits. Once
+         * motors are idle, the residual error measured by encoders is corrected by
+         * a few short moves. Point to point only : path tracking is refused.
+         * Selected at the start of next period if still allowed.
+         * @param stepMode : true for step mode
+         * @return false if positioning or tracking
+         */
+        bool SetStepMode(bool stepMode);
+
+        /**
+         * @brief Return true in step position mode
+         */
+        bool IsStepMode()
+        {
+            return this->stepMode;
+        }
+
+        /**
+         * @brief Regulate velocity setpoints with encoders velocity, drive motors
+         * @param period : Elapsed time since last call (ms), PC_VC_PERIOD_MS nominal
+         *
+         * Inner loop of the cascade (PC_VELOCITY_CASCADE), nothing otherwise
+         */
+        void ComputeVelocity(float32_t period);
+
     protected:
 
         /**
@@ -314,10 +829,116 @@ namespace MotionControl
 
         /**
          * @protected
-         * @brief get time in seconds
+         * @brief get profiles time in seconds (velocity override clock)
          */
         float32_t getTime();
 
+        /**
+         * @protected
+         * @brief Advance profiles clock by elapsed time scaled by velocity override
+         */
+        void updateTime();
+
+        /**
+         * @protected
+         * @brief Velocity override applied and requested, profiles clock and last real time
+         */
+        float32_t override;
+        volatile float32_t overrideTarget;
+
+        /**
+         * @protected
+         * @brief Velocity and acceleration limits scale (see SetLimitScale())
+         */
+        float32_t limitScale;
+
+        /**
+         * @protected
+         * @brief Accelerations factor from wheel motors heat (see Drv8813::GetDerate())
+         */
+        float32_t accDerate;
+
+        /**
+         * @protected
+         * @brief Profiles velocity and acceleration limits from definitions, scale and derating
+         */
+        void applyLimits();
+
+        /**
+         * @protected
+         * @brief Follow wheel motors thermal derating (after Supervise())
+         */
+        void superviseThermal();
+        float32_t profileTime;
+        float32_t clockLast;
+
+        /**
+         * @protected
+         * @brief Setpoint mailbox : buffers, published one, not taken yet (see Post())
+         */
+        PC_SETPOINT setpoints[2];
+        uint32_t published;
+        volatile bool pending;
+
+        /**
+         * @protected
+         * @brief Take the published setpoint, start profiles (start of period)
+         */
+        void swap();
+
+        /**
+         * @protected
+         * @brief Command mailbox (see postCommand()), commands lost on full queue
+         */
+        QueueHandle_t commands;
+        StaticQueue_t commandsBuffer;
+        uint8_t commandsStorage[PC_COMMANDS_MAX * sizeof(PC_COMMAND)];
+        volatile uint32_t commandsLost;
+
+        /**
+         * @protected
+         * @brief Post a command to the position loop (any task)
+         *
+         * Commands are applied in order by receive(), at the start of next
+         * period and before the setpoint published with them.
+         * @return false if the queue is full (command lost)
+         */
+        bool postCommand(PC_COMMAND_ID id, uint8_t arg = 0u);
+
+        /**
+         * @protected
+         * @brief Apply posted commands (start of period)
+         */
+        void receive();
+
+        /**
+         * @protected
+         * @brief Commands applied by receive()
+         */
+        void applyEnable(bool enable);
+        void applyStartTuning(enum ID axis);
+        void applyStepMode(bool stepMode);
+        void applyPreset(uint32_t preset);
+
+        /**
+         * @protected
+         * @brief Start or replan axis profile toward position
+         */
+        void applyAngularPosition(float32_t position);
+        void applyLinearPosition(float32_t position);
+
+        /**
+         * @protected
+         * @brief stretch the faster profile to end with the slower one
+         */
+        void synchronize();
+
+        /**
+         * @protected
+         * @brief enter/leave angular path tracking
+         */
+        void setAngularTracking(bool tracking);
+
         /**
          * @protected
          * @brief get absolute value
@@ -328,7 +949,7 @@ namespace MotionControl
          * @protected
          * @brief Instance name
          */
-        std::string name;
+        const char* name;
 
         /**
          * @protected
@@ -348,6 +969,20 @@ namespace MotionControl
          */
         Utils::PID    pid_linear;
 
+        /**
+         * @protected
+         * @brief angular/linear velocity PI controllers (cascade inner loop)
+         */
+        Utils::PID    pid_angularVelocity;
+        Utils::PID    pid_linearVelocity;
+
+        /**
+         * @protected
+         * @brief angular/linear velocity setpoints (position loop output)
+         */
+        float32_t angularVelocitySetpoint;
+        float32_t linearVelocitySetpoint;
+
         /**
          * @protected
          * @brief Coef definitions
@@ -364,7 +999,7 @@ namespace MotionControl
          * @protected
          * @brief MotionProfile asserts
          */
-        MotionProfile linearProfile;
+        StaticMotionProfile<LINEAR_PROFILE> linearProfile;
 
         /**
          * @protected
@@ -444,12 +1079,46 @@ namespace MotionControl
          */
         float32_t linearVelocity;
 
+        /**
+         * @protected
+         * @brief angular profiled velocity and acceleration (feed forward)
+         */
+        float32_t angularVelocityProfiled;
+        float32_t angularAccelerationProfiled;
+
+        /**
+         * @protected
+         * @brief linear profiled velocity and acceleration (feed forward)
+         */
+        float32_t linearVelocityProfiled;
+        float32_t linearAccelerationProfiled;
+
         /**
          * @protected
          * @brief enable/disable
          */
         bool enable;
 
+        /**
+         * @protected
+         * @brief angular setpoint tracked without profile
+         */
+        bool angularTracking;
+
+        /**
+         * @protected
+         * @brief linear setpoint tracked without profile, with its feed forward
+         */
+        bool linearTracking;
+        float32_t linearTrackedVelocity;
+        float32_t linearTrackedAcceleration;
+
+        /**
+         * @protected
+         * @brief coordinated motion
+         */
+        bool synchronized;
+
         /**
          * @protected
          * @brief OS Task handle
@@ -458,12 +1127,138 @@ namespace MotionControl
          */
         TaskHandle_t taskHandle;
 
+        /**
+         * @protected
+         * @brief Compute() execution time profiler
+         */
+        Utils::Profiler profiler;
+
+        /**
+         * @protected
+         * @brief Task loop scheduling statistics
+         */
+        Utils::PeriodicTask periodic;
+
+        /**
+         * @protected
+         * @brief Watchdog client (see Utils::Watchdog)
+         */
+        int32_t health;
+
         /**
          * @protected
          * @brief Position control loop task handler
          * @param obj : Always NULL
          */
         void taskHandler (void* obj);
+
+        /**
+         * @protected
+         * @brief Wheels slip accumulated (m) and detection state
+         */
+        float32_t leftSlip;
+        float32_t rightSlip;
+        bool slipping;
+
+        /**
+         * @protected
+         * @brief Motors steps and odometry positions at last slip supervision
+         */
+        int32_t slipLeftSteps;
+        int32_t slipRightSteps;
+        float32_t slipLinear;
+        float32_t slipAngular;
+
+        /**
+         * @protected
+         * @brief Compare commanded steps with encoders travel (each period)
+         */
+        void superviseSlip();
+
+        /**
+         * @protected
+         * @brief Completion window, consecutive periods inside, profiles end time (s) and state
+         */
+        PC_SETTLE settle;
+        uint32_t settleCount;
+        float32_t settleStart;
+        bool settled;
+        bool settleTimedOut;
+
+        /**
+         * @protected
+         * @brief Check the completion window once profiles are finished (each period)
+         * @param angular : Measured angular position (rad)
+         * @param linear : Measured linear position (m)
+         */
+        void superviseSettle(float32_t angular, float32_t linear);
+
+        /**
+         * @protected
+         * @brief Convert robot motion of one period to motors rotation and speed
+         * @param angularStep : Angular advance (rad)
+         * @param linearStep : Linear advance (m)
+         * @param angularVelocity : Angular velocity (rad/s)
+         * @param linearVelocity : Linear velocity (m/s)
+         */
+        void driveMotors(float32_t angularStep, float32_t linearStep, float32_t angularVelocity, float32_t linearVelocity);
+
+        /**
+         * @protected
+         * @brief Stream robot velocities to the motors (velocity mode)
+         * @param angularVelocity : Angular velocity (rad/s)
+         * @param linearVelocity : Linear velocity (m/s)
+         */
+        void streamMotors(float32_t angularVelocity, float32_t linearVelocity);
+
+        /**
+         * @protected
+         * @brief Step position mode, setpoints of the last planned move and corrections done
+         */
+        bool stepMode;
+        float32_t stepAngularTarget;
+        float32_t stepLinearTarget;
+        uint32_t stepCorrections;
+
+        /**
+         * @protected
+         * @brief Step mode period : start a move toward setpoints once motors are idle
+         */
+        void computeSteps(float32_t currentAngularPosition, float32_t currentLinearPosition);
+
+        /**
+         * @protected
+         * @brief Start motors ramps for a robot relative move
+         * @param angular : Angular move (rad)
+         * @param linear : Linear move (m)
+         */
+        void stepMove(float32_t angular, float32_t linear);
+
+        /**
+         * @protected
+         * @brief Tuning parameters changed (set by another task, see Utils::Param)
+         */
+        volatile bool tuningChanged;
+
+        /**
+         * @protected
+         * @brief Apply tuning parameters (def) to PIDs and profiles
+         */
+        void applyTuning();
+
+        /**
+         * @protected
+         * @brief Limits and gains presets, selected one
+         */
+        PC_PRESET presets[PC_PRESETS];
+        volatile uint32_t preset;
+
+        /**
+         * @protected
+         * @brief PID auto-tuner and tuned axis
+         */
+        Utils::RelayTuner tuner;
+        enum ID tuningAxis;
     };
 }
 
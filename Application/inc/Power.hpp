@@ -0,0 +1,97 @@
+/**
+ * @file    Power.hpp
+ * @author  Jeremy ROULLAND
+ * @date    15 oct. 2026
+ * @brief   Low power idle (sleep on idle, tickless while motion is idle)
+ */
+
+#ifndef INC_POWER_HPP_
+#define INC_POWER_HPP_
+
+#include "common.h"
+
+/*----------------------------------------------------------------------------*/
+/* Class declaration                                                          */
+/*----------------------------------------------------------------------------*/
+
+/**
+ * @class Power
+ * @brief Sleep mode from the idle task
+ *
+ * HOWTO :
+ * - HardwareInit() calls Init()
+ * - Idle hook calls Idle() : core sleeps (WFI) until next interrupt
+ * - The kernel suppresses the tick when every task is blocked for 2 ticks
+ *   or more (configUSE_TICKLESS_IDLE), while no stepper driver is moving
+ *
+ * Wakeups are interrupts : tick, control loop timers, steps, UART, I2C,
+ * CAN, USB and EXTI. Peripherals keep their clock in sleep mode, except the
+ * ones only the core uses (see Init()). Cycle counter keeps counting while
+ * asleep (debug sleep bit), Clock and Profiler times stay valid.
+ */
+class Power
+{
+public:
+
+    /**
+     * @brief Keep cycle counter in sleep mode, gate core-only peripherals clock while asleep
+     */
+    static void Init ();
+
+    /**
+     * @brief Sleep until next interrupt (idle hook, interrupts enabled)
+     */
+    static void Idle ();
+
+    /**
+     * @brief Enable or disable sleep (disabled : idle task spins, as before)
+     */
+    static void SetEnable (bool enable);
+
+    /**
+     * @brief Return true if sleep is enabled
+     */
+    static bool IsEnabled ();
+
+    /**
+     * @brief Tickless pre-sleep (configPRE_SLEEP_PROCESSING, interrupts disabled)
+     * @param ticks : Expected idle ticks
+     * @return ticks to sleep, 0 to return at once (tick restarts, Idle() sleeps)
+     */
+    static uint32_t PreSleep (uint32_t ticks);
+
+    /**
+     * @brief Tickless post-sleep (configPOST_SLEEP_PROCESSING, interrupts disabled)
+     */
+    static void PostSleep ();
+
+    /**
+     * @brief Return time spent asleep (us)
+     */
+    static uint64_t GetSleepTime ();
+
+    /**
+     * @brief Return number of sleeps (idle hook and tickless)
+     */
+    static uint32_t GetSleepCount ();
+
+    /**
+     * @brief Return number of tickless sleeps
+     */
+    static uint32_t GetTicklessCount ();
+
+    /**
+     * @brief Return number of tickless sleeps refused (a driver was moving)
+     */
+    static uint32_t GetTicklessVetoed ();
+
+protected:
+
+    /**
+     * @protected
+     * @brief Add a sleep duration (cycles)
+     */
+    static void account (uint32_t cycles);
+};
+
+#endif /* INC_POWER_HPP_ */
@@ -0,0 +1,104 @@
+/**
+ * @file    Retain.hpp
+ * @author  Jeremy ROULLAND
+ * @date    15 oct. 2026
+ * @brief   Warm restart state (pose, orders, actuators) kept in no-init RAM
+ */
+
+#ifndef INC_RETAIN_HPP_
+#define INC_RETAIN_HPP_
+
+#include "common.h"
+
+/*----------------------------------------------------------------------------*/
+/* Definitions                                                                */
+/*----------------------------------------------------------------------------*/
+
+/**
+ * @brief Cylinders kept (>= Cylinder::CYLINDER_MAX)
+ */
+#define RETAIN_CYLINDERS_MAX    (2u)
+
+/**
+ * @brief Warm restart state
+ */
+typedef struct
+{
+    // Odometry pose
+    float32_t   x;                                  /**< X (encoder ticks) */
+    float32_t   y;                                  /**< Y (encoder ticks) */
+    float32_t   o;                                  /**< Heading (rad) */
+
+    // Orders acknowledgement (main board view)
+    uint16_t    runningTag;                         /**< Running order, aborted by the reset */
+    uint16_t    finishedTag;                        /**< Last finished order */
+
+    // Cylinders position
+    int32_t     cylinderSteps[RETAIN_CYLINDERS_MAX];  /**< Motor steps from index 0 */
+    int8_t      cylinderIndex[RETAIN_CYLINDERS_MAX];  /**< Last target index */
+    bool        cylinderHomed[RETAIN_CYLINDERS_MAX];  /**< Origin latched */
+}RETAIN_STATE;
+
+/*----------------------------------------------------------------------------*/
+/* Class declaration                                                          */
+/*----------------------------------------------------------------------------*/
+
+/**
+ * @class Retain
+ * @brief Checkpoint the state needed to resume after a reset, restore it on warm start
+ *
+ * HOWTO :
+ * - main() calls Init() first : takes the checkpoint of the previous run,
+ *   unless it was a power on (RAM content is random)
+ * - Owners write their part with Set*() (their own task), the motion
+ *   control task seals it each period with Commit()
+ * - Owners restore their part from GetRestored() in their constructor
+ *
+ * Two checkpoint slots in .noinit RAM, alternately written then sealed
+ * (sequence, checksum) : a reset while writing leaves the other slot valid.
+ * A fault, a watchdog or a reset button no longer costs the pose and the
+ * cylinders homing.
+ */
+class Retain
+{
+public:
+
+    /**
+     * @brief Take previous run checkpoint (before any owner is constructed)
+     */
+    static void Init ();
+
+    /**
+     * @brief Get previous run state
+     * @return State or NULL (power on, no valid checkpoint)
+     */
+    static const RETAIN_STATE* GetRestored ();
+
+    /**
+     * @brief Write odometry pose (ticks, rad)
+     */
+    static void SetPose (float32_t x, float32_t y, float32_t o);
+
+    /**
+     * @brief Write orders acknowledgement tags
+     */
+    static void SetOrders (uint16_t runningTag, uint16_t finishedTag);
+
+    /**
+     * @brief Write cylinder position
+     * @param id : Cylinder (< RETAIN_CYLINDERS_MAX)
+     */
+    static void SetCylinder (uint32_t id, int32_t steps, int8_t index, bool homed);
+
+    /**
+     * @brief Seal written state into the next checkpoint slot
+     */
+    static void Commit ();
+
+    /**
+     * @brief Get number of checkpoints sealed since boot
+     */
+    static uint32_t GetCommits ();
+};
+
+#endif /* INC_RETAIN_HPP_ */
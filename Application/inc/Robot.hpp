@@ -0,0 +1,110 @@
+/**
+ * @file    Robot.hpp
+ * @author  Jeremy ROULLAND
+ * @date    15 oct. 2026
+ * @brief   Robot variants : wiring, geometry and modules selected at build time
+ */
+
+#ifndef INC_ROBOT_HPP_
+#define INC_ROBOT_HPP_
+
+#include "common.h"
+
+#include "DRV8813.hpp"
+
+/*----------------------------------------------------------------------------*/
+/* Definitions                                                                */
+/*----------------------------------------------------------------------------*/
+
+#define ROBOT_CBOT              (0u)        /**< CBOT actuators board (CBOT_Actionneurs.cfg) */
+#define ROBOT_ACTIO             (1u)        /**< Actio board (Actio.cfg) */
+
+/**
+ * @brief Robot built for (build configuration defines ROBOT=ROBOT_ACTIO)
+ */
+#ifndef ROBOT
+#define ROBOT                   ROBOT_CBOT
+#endif
+
+/*----------------------------------------------------------------------------*/
+/* Class declaration                                                          */
+/*----------------------------------------------------------------------------*/
+
+/**
+ * @namespace Robot
+ * @brief Per robot constants, Robot::Config is the one built for
+ *
+ * HOWTO :
+ * - Read constants from Robot::Config (no runtime test : they fold at
+ *   compile time)
+ * - Optional modules are boolean constants : select a template
+ *   specialization with them (see main.cpp boot stages), the other one is
+ *   never referenced and the module is not linked in
+ *
+ * A new robot is a new structure with all the members, and its ROBOT value.
+ */
+namespace Robot
+{
+    /**
+     * @brief CBOT actuators board
+     */
+    struct Cbot
+    {
+        static constexpr const char* NAME = "Sirius[B]";
+
+        // Wheels stepper drivers
+        static constexpr HAL::Drv8813::ID WHEEL_LEFT = HAL::Drv8813::DRV8813_4;
+        static constexpr HAL::Drv8813::ID WHEEL_RIGHT = HAL::Drv8813::DRV8813_1;
+
+        // Barrels stepper drivers
+        static constexpr HAL::Drv8813::ID CYL0_MOTOR = HAL::Drv8813::DRV8813_2;
+        static constexpr HAL::Drv8813::ID CYL1_MOTOR = HAL::Drv8813::DRV8813_3;
+
+        // Odometry defaults (Config)
+        static constexpr float64_t TICK_BY_MM = 31.722561893;     // (ER/(_PI_*WD))
+        static constexpr float64_t ADW_TICK = 2515.599158127;     // (ADW * TICK_BY_MM)
+        static constexpr float64_t WHEEL_RATIO = 1.0;             // (WC)
+
+        // Optional modules
+        static constexpr bool SPARE_ADC = true;                 // Spare analog input
+        static constexpr bool TEST_TASK = true;                 // Bring-up test task
+    };
+
+    /**
+     * @brief Actio board
+     */
+    struct Actio
+    {
+        static constexpr const char* NAME = "Actio";
+
+        // Same power board wiring
+        static constexpr HAL::Drv8813::ID WHEEL_LEFT = HAL::Drv8813::DRV8813_4;
+        static constexpr HAL::Drv8813::ID WHEEL_RIGHT = HAL::Drv8813::DRV8813_1;
+        static constexpr HAL::Drv8813::ID CYL0_MOTOR = HAL::Drv8813::DRV8813_2;
+        static constexpr HAL::Drv8813::ID CYL1_MOTOR = HAL::Drv8813::DRV8813_3;
+
+        // Odometry defaults, until calibrated (see Calibration)
+        static constexpr float64_t TICK_BY_MM = 31.722561893;
+        static constexpr float64_t ADW_TICK = 2515.599158127;
+        static constexpr float64_t WHEEL_RATIO = 1.0;
+
+        // Optional modules
+        static constexpr bool SPARE_ADC = false;
+        static constexpr bool TEST_TASK = false;
+    };
+
+#if (ROBOT == ROBOT_CBOT)
+    typedef Cbot Config;
+#elif (ROBOT == ROBOT_ACTIO)
+    typedef Actio Config;
+#else
+    #error "Robot : unknown ROBOT value"
+#endif
+
+    static_assert((Config::CYL0_MOTOR != Config::CYL1_MOTOR) &&
+                  (Config::CYL0_MOTOR != Config::WHEEL_LEFT) && (Config::CYL0_MOTOR != Config::WHEEL_RIGHT) &&
+                  (Config::CYL1_MOTOR != Config::WHEEL_LEFT) && (Config::CYL1_MOTOR != Config::WHEEL_RIGHT),
+                  "Robot : stepper driver used twice");
+}
+
+#endif /* INC_ROBOT_HPP_ */
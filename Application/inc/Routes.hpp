@@ -0,0 +1,69 @@
+/**
+ * @file    Routes.hpp
+ * @author  Jeremy ROULLAND
+ * @date    24 oct. 2017
+ * @brief   Precomputed routes library
+ */
+
+#ifndef INC_ROUTES_HPP_
+#define INC_ROUTES_HPP_
+
+#include "common.h"
+
+/*----------------------------------------------------------------------------*/
+/* Definitions                                                                */
+/*----------------------------------------------------------------------------*/
+
+/**
+ * @brief Route sample, evenly spaced along arc length
+ */
+typedef struct
+{
+    float32_t   s;                      /**< Arc length from route start (m) */
+    float32_t   x;                      /**< Table position (m) */
+    float32_t   y;                      /**< Table position (m) */
+    float32_t   heading;                /**< Path heading, unwrapped (rad) */
+    float32_t   velocity;               /**< Planned velocity (m/s), 0 at both ends */
+}ROUTE_SAMPLE;
+
+/**
+ * @brief Route definition (linked in flash)
+ */
+typedef struct
+{
+    const char*         NAME;
+    const ROUTE_SAMPLE* SAMPLES;
+    uint32_t            COUNT;          /**< Samples (>= 2) */
+}ROUTE_DEF;
+
+/*----------------------------------------------------------------------------*/
+/* Class declaration                                                          */
+/*----------------------------------------------------------------------------*/
+
+/**
+ * @class Routes
+ * @brief Precomputed routes, started by identifier (see TrajectoryPlanning::route())
+ *
+ * Routes are cubic Hermite splines through match waypoints, sampled offline
+ * along arc length with their velocity profile (curvature limits, forward and
+ * backward acceleration passes at the default limits). The robot only
+ * interpolates samples : no planning on board.
+ */
+class Routes
+{
+public:
+
+    /**
+     * @brief Return number of routes
+     */
+    static uint32_t Count ();
+
+    /**
+     * @brief Return a route
+     * @param id : Route identifier (< Count())
+     * @return Route or NULL
+     */
+    static const ROUTE_DEF* Get (uint32_t id);
+};
+
+#endif /* INC_ROUTES_HPP_ */
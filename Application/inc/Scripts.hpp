@@ -0,0 +1,193 @@
+/**
+ * @file    Scripts.hpp
+ * @author  Jeremy ROULLAND
+ * @date    15 oct. 2026
+ * @brief   Stored orders scripts and timing runner (motion regression)
+ */
+
+#ifndef INC_SCRIPTS_HPP_
+#define INC_SCRIPTS_HPP_
+
+#include "common.h"
+
+#include "MotionControl.hpp"
+#include "TrajectoryPlanning.hpp"
+#include "PositionControlStepper.hpp"
+#include "ActuatorControl.hpp"
+
+// FreeRTOS
+#include "FreeRTOS.h"
+#include "task.h"
+
+/*----------------------------------------------------------------------------*/
+/* Definitions                                                                */
+/*----------------------------------------------------------------------------*/
+
+/**
+ * @brief Script step operation
+ */
+typedef enum
+{
+    SCRIPT_SETODO,                      /**< Set odometry : A, B (mm), C (0.1 deg) */
+    SCRIPT_GOTO,                        /**< Go to A, B (mm) */
+    SCRIPT_GOLIN,                       /**< Go linear A (mm) */
+    SCRIPT_GOANG,                       /**< Go to heading A (0.1 deg) */
+    SCRIPT_ROUTE,                       /**< Precomputed route A (see Routes) */
+    SCRIPT_ACTUATOR,                    /**< Actuator A (AC_STEP actuator), order B, index C */
+    SCRIPT_WAIT,                        /**< Wait A (ms) */
+}SCRIPT_OP;
+
+/**
+ * @brief Script step
+ */
+typedef struct
+{
+    SCRIPT_OP   OP;
+    int32_t     A;
+    int32_t     B;
+    int32_t     C;
+}SCRIPT_STEP;
+
+/**
+ * @brief Script definition (linked in flash)
+ */
+typedef struct
+{
+    const char*         NAME;
+    const SCRIPT_STEP*  STEPS;
+    uint32_t            COUNT;
+}SCRIPT_DEF;
+
+/*----------------------------------------------------------------------------*/
+/* Class declaration                                                          */
+/*----------------------------------------------------------------------------*/
+
+/**
+ * @class Scripts
+ * @brief Stored orders scripts, run one step after the other with a timing report
+ *
+ * HOWTO :
+ * - Get instance with GetInstance()
+ * - Start() a script by identifier, Abort() it
+ *
+ * Each step is pushed to FBMotionControl (tagged order) or ActuatorControl
+ * and waited for. The report (console) gives each step duration and pose
+ * error from Odometry against the scripted pose, then the total time and
+ * the peak execution time of the control loops during the run.
+ */
+class Scripts
+{
+public:
+
+    /**
+     * @brief Get instance method
+     */
+    static Scripts* GetInstance ();
+
+    /**
+     * @brief Return number of scripts
+     */
+    static uint32_t Count ();
+
+    /**
+     * @brief Return a script
+     * @param id : Script identifier (< Count())
+     * @return Script or NULL
+     */
+    static const SCRIPT_DEF* Get (uint32_t id);
+
+    /**
+     * @brief Start a script
+     * @param id : Script identifier
+     * @return false if unknown or a script is running
+     */
+    bool Start (uint32_t id);
+
+    /**
+     * @brief Abort running script (after current step)
+     */
+    void Abort ()
+    {
+        this->abort = true;
+    }
+
+    /**
+     * @brief Return true while a script runs
+     */
+    bool IsRunning ()
+    {
+        return this->running;
+    }
+
+protected:
+
+    Scripts ();
+
+    /**
+     * @protected
+     * @brief Instance name
+     */
+    const char* name;
+
+    MotionControl::FBMotionControl*     mc;
+    MotionControl::TrajectoryPlanning*  tp;
+    MotionControl::PositionControl*     pc;
+    ActuatorControl*                    ac;
+    Location::Odometry*                 odometry;
+
+    /**
+     * @protected
+     * @brief Script to run, state
+     */
+    const SCRIPT_DEF* script;
+    volatile bool running;
+    volatile bool abort;
+
+    /**
+     * @protected
+     * @brief Tag of the last pushed order
+     */
+    uint16_t tag;
+
+    /**
+     * @protected
+     * @brief Scripted pose (mm, rad)
+     */
+    float32_t x;
+    float32_t y;
+    float32_t o;
+
+    /**
+     * @protected
+     * @brief Run a step and wait for its end
+     * @return false on refused order, abort or timeout
+     */
+    bool step (const SCRIPT_STEP* step);
+
+    /**
+     * @protected
+     * @brief Wait for the last pushed order
+     */
+    bool waitOrder ();
+
+    /**
+     * @protected
+     * @brief Run the script, print report
+     */
+    void run ();
+
+    /**
+     * @protected
+     * @brief OS Task handle
+     */
+    TaskHandle_t taskHandle;
+
+    /**
+     * @protected
+     * @brief Script task handler
+     * @param obj : Always NULL
+     */
+    void taskHandler (void* obj);
+};
+
+#endif /* INC_SCRIPTS_HPP_ */
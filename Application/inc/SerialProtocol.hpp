@@ -0,0 +1,212 @@
+/**
+ * @file    SerialProtocol.hpp
+ * @author  Jeremy ROULLAND
+ * @date    24 oct. 2017
+ * @brief   Binary command channel on the console serial link
+ */
+
+#ifndef INC_SERIALPROTOCOL_HPP_
+#define INC_SERIALPROTOCOL_HPP_
+
+
+#include "common.h"
+
+// Link
+#include "Serial.hpp"
+#include "I2CCommon.h"
+
+/*----------------------------------------------------------------------------*/
+/* Definitions                                                                */
+/*----------------------------------------------------------------------------*/
+
+/**
+ * @brief Frame : [type][seq][length][payload][crc32] (little endian)
+ *
+ * CRC is the hardware CRC-32 (see HAL::Crc) of type, seq, length and payload.
+ *
+ * Requests (host to board) are byte stuffed and 0x00 delimited on both ends :
+ * 0x00, SP_ESCAPE and the CLI break character SP_BREAK_CHAR are sent as
+ * [SP_ESCAPE][byte ^ SP_ESCAPE_XOR], so text commands and the emergency
+ * stop character keep working between and during frames.
+ *
+ * Responses (board to host) are COBS encoded and 0x00 delimited, like Diag
+ * telemetry frames (types 0x80 and above).
+ *
+ * Go-back-N window : the host sends up to SP_WINDOW requests before waiting
+ * for their responses (each one is answered, seq echoed). A request before
+ * the expected seq is a retransmission : its response is sent again without
+ * executing it twice. A request after it (previous lost or corrupted) is
+ * answered with NAK [expected seq], once, the host resends from there.
+ */
+#define SP_PAYLOAD_MAX              (I2C_MAX_FRAME_SIZE)    /**< Largest payload, a whole register frame */
+#define SP_HEADER_SIZE              (3u)
+#define SP_CRC_SIZE                 (4u)
+#define SP_FRAME_MAX                (SP_HEADER_SIZE + SP_PAYLOAD_MAX + SP_CRC_SIZE)
+#define SP_WINDOW                   (4u)                    /**< Requests in flight (serial RX buffer is 256 bytes) */
+
+#define SP_DELIMITER                (0x00u)
+#define SP_ESCAPE                   (0x7Du)
+#define SP_ESCAPE_XOR               (0x20u)
+#define SP_BREAK_CHAR               ('&')       /**< Emergency stop, latched by the serial RX interrupt */
+
+// Requests
+#define SP_TYPE_RESET               (0x10u)     /**< No payload : next expected seq is seq + 1, ACK */
+#define SP_TYPE_PING                (0x11u)     /**< Any payload : ACK */
+#define SP_TYPE_WRITE               (0x12u)     /**< [reg][payload] : I2CProtocol write frame, ACK once queued */
+#define SP_TYPE_READ                (0x13u)     /**< [reg] : DATA with the register payload (see I2CProtocol) */
+
+// Responses
+#define SP_TYPE_ACK                 (0x80u)     /**< int8 status (0 or SP_ERROR_*) */
+#define SP_TYPE_NAK                 (0x81u)     /**< uint8 expected seq */
+#define SP_TYPE_DATA                (0x82u)     /**< Register payload */
+
+#define SP_ERROR_TYPE               (-1)        /**< Unknown request type */
+#define SP_ERROR_REFUSED            (-2)        /**< Malformed, refused (SYNC) or queue full */
+
+/**
+ * @brief Frame (header and payload, CRC excluded)
+ */
+typedef struct __attribute__((packed))
+{
+    uint8_t   type;
+    uint8_t   seq;
+    uint8_t   length;
+    uint8_t   payload[SP_PAYLOAD_MAX];
+}sp_frame_t;
+
+/*----------------------------------------------------------------------------*/
+/* Class declaration                                                          */
+/*----------------------------------------------------------------------------*/
+
+    /**
+    * @class SerialProtocol
+    * @brief Binary command channel for scripts and the main board
+    *
+    * HOWTO :
+    * - Get instance with GetInstance()
+    * - Feed every received byte with Input() (CLI task), bytes out of a
+    *   frame are left to the text command line
+    * - Orders are the I2CProtocol register map (WRITE / READ requests)
+    */
+    class SerialProtocol
+    {
+    public:
+        /**
+         * @brief Get instance method
+         * @return SerialProtocol instance
+         */
+        static SerialProtocol* GetInstance();
+
+        /**
+         * @brief SerialProtocol instance name
+         */
+        const char* Name()
+        {
+            return this->name;
+        }
+
+        /**
+         * @brief Process a received byte
+         * @param c : Received byte
+         * @return true if the byte belongs to a binary frame
+         */
+        bool Input(uint8_t c);
+
+        /**
+         * @brief Return number of requests dropped on CRC error
+         */
+        uint32_t GetCRCErrors()
+        {
+            return this->crcErrors;
+        }
+
+        /**
+         * @brief Return number of requests dropped on framing error (length, overflow)
+         */
+        uint32_t GetFramingErrors()
+        {
+            return this->framingErrors;
+        }
+
+        /**
+         * @brief Return number of retransmitted requests (answered again)
+         */
+        uint32_t GetRetransmissions()
+        {
+            return this->retransmissions;
+        }
+
+    protected:
+        /**
+         * @brief SerialProtocol default constructor
+         */
+        SerialProtocol();
+
+        /**
+         * @protected
+         * @brief Instance name
+         */
+        const char* name;
+
+        /**
+         * @protected
+         * @brief Console serial link
+         */
+        HAL::Serial* serial;
+
+        /**
+         * @protected
+         * @brief Request being received (unstuffed), length, state
+         */
+        uint8_t rx[SP_FRAME_MAX];
+        uint32_t length;
+        bool receiving;
+        bool escaped;
+        bool overflow;
+
+        /**
+         * @protected
+         * @brief Window : next expected seq, NAK sent for the current gap
+         */
+        bool open;
+        uint8_t expected;
+        bool nakSent;
+
+        /**
+         * @protected
+         * @brief Responses of the last requests (by seq % SP_WINDOW), for retransmissions
+         */
+        sp_frame_t responses[SP_WINDOW];
+
+        /**
+         * @protected
+         * @brief Errors counters
+         */
+        uint32_t crcErrors;
+        uint32_t framingErrors;
+        uint32_t retransmissions;
+
+        /**
+         * @brief Check a received request and apply window rules
+         */
+        void receive();
+
+        /**
+         * @brief Execute an in sequence request
+         * @param request : Request
+         * @param response : Response (type, payload and length)
+         */
+        void execute(const sp_frame_t* request, sp_frame_t* response);
+
+        /**
+         * @brief Send a response
+         */
+        void send(const sp_frame_t* response);
+
+        /**
+         * @brief Send a NAK with the expected seq
+         */
+        void nak();
+    };
+
+#endif /* INC_SERIALPROTOCOL_HPP_ */
@@ -0,0 +1,144 @@
+/**
+ * @file    Spline.hpp
+ * @author  Jeremy ROULLAND
+ * @date    25 oct. 2017
+ * @brief   Arc length parameterized cubic spline
+ */
+
+#ifndef INC_SPLINE_HPP_
+#define INC_SPLINE_HPP_
+
+#include "common.h"
+
+/*----------------------------------------------------------------------------*/
+/* Definitions                                                                */
+/*----------------------------------------------------------------------------*/
+
+/**
+ * @brief Maximum segments (points - 1)
+ */
+#define SPLINE_SEGMENTS_MAX     (32u)
+
+/**
+ * @brief Arc length table steps by segment (chord approximation)
+ */
+#define SPLINE_LUT_STEPS        (8u)
+
+/*----------------------------------------------------------------------------*/
+/* Class declaration                                                          */
+/*----------------------------------------------------------------------------*/
+
+/**
+ * @namespace MotionControl
+ */
+namespace MotionControl
+{
+    /**
+     * @class Spline
+     * @brief Cubic Hermite spline through points, evaluated by arc length
+     *
+     * HOWTO :
+     * - Load() points : Catmull-Rom tangents, first tangent along start heading
+     * - Evaluate() position and heading at distance s from the first point
+     *
+     * Load() builds the arc length table (SPLINE_LUT_STEPS chords by segment),
+     * Evaluate() is a bisection in the table and one cubic evaluation : no
+     * iterative distance to parameter conversion in the control loop.
+     */
+    class Spline
+    {
+    public:
+
+        /**
+         * @brief Constructor (empty spline)
+         */
+        Spline();
+
+        /**
+         * @brief Load points
+         * @param X : Points X (m)
+         * @param Y : Points Y (m)
+         * @param n : Points count (2 to SPLINE_SEGMENTS_MAX + 1)
+         * @param heading : Heading at first point (rad), headings are unwrapped from it
+         * @return false if points count is out of range or a segment is null
+         */
+        bool Load(const float32_t X[], const float32_t Y[], uint32_t n, float32_t heading);
+
+        /**
+         * @brief Get total arc length (m)
+         */
+        float32_t GetLength()
+        {
+            return this->lut[this->segments * SPLINE_LUT_STEPS];
+        }
+
+        /**
+         * @brief Get segments count
+         */
+        uint32_t GetSegments()
+        {
+            return this->segments;
+        }
+
+        /**
+         * @brief Get arc length at the end of segment i (m)
+         */
+        float32_t GetSegmentEnd(uint32_t i)
+        {
+            return this->lut[(i + 1u) * SPLINE_LUT_STEPS];
+        }
+
+        /**
+         * @brief Get maximum curvature on segment i (1/m, table nodes)
+         */
+        float32_t GetCurvatureMax(uint32_t i)
+        {
+            return this->curvature[i];
+        }
+
+        /**
+         * @brief Evaluate spline
+         * @param s : Arc length from first point (m), clamped to spline
+         * @param x : Position X (m)
+         * @param y : Position Y (m)
+         * @param heading : Tangent heading, unwrapped (rad)
+         */
+        void Evaluate(float32_t s, float32_t* x, float32_t* y, float32_t* heading);
+
+    protected:
+
+        /**
+         * @protected
+         * @brief Segments count
+         */
+        uint32_t segments;
+
+        /**
+         * @protected
+         * @brief Segments polynomials : p(u) = c0 + c1 u + c2 u^2 + c3 u^3, u in [0, 1]
+         */
+        float32_t cx[SPLINE_SEGMENTS_MAX][4];
+        float32_t cy[SPLINE_SEGMENTS_MAX][4];
+
+        /**
+         * @protected
+         * @brief Arc length and unwrapped heading at table nodes
+         */
+        float32_t lut[SPLINE_SEGMENTS_MAX * SPLINE_LUT_STEPS + 1u];
+        float32_t lutHeading[SPLINE_SEGMENTS_MAX * SPLINE_LUT_STEPS + 1u];
+
+        /**
+         * @protected
+         * @brief Maximum curvature by segment
+         */
+        float32_t curvature[SPLINE_SEGMENTS_MAX];
+
+        /**
+         * @protected
+         * @brief Evaluate segment i at u : position and first, second derivatives
+         */
+        void evaluate(uint32_t i, float32_t u, float32_t p[2], float32_t d1[2], float32_t d2[2]);
+    };
+}
+
+#endif /* INC_SPLINE_HPP_ */
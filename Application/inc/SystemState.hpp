@@ -0,0 +1,102 @@
+/**
+ * @file    SystemState.hpp
+ * @author  Jeremy ROULLAND
+ * @date    15 oct. 2026
+ * @brief   System state published once per control period for status readers
+ */
+
+#ifndef INC_SYSTEMSTATE_HPP_
+#define INC_SYSTEMSTATE_HPP_
+
+#include "common.h"
+
+/*----------------------------------------------------------------------------*/
+/* Definitions                                                                */
+/*----------------------------------------------------------------------------*/
+
+/**
+ * @brief State alignment (bytes) : copied in whole bursts, shares no line with other data
+ */
+#define SYSTEM_STATE_ALIGN      (32u)
+
+/**
+ * @brief System state
+ */
+typedef struct __attribute__((aligned(SYSTEM_STATE_ALIGN)))
+{
+    uint32_t    cycle;                  /**< Control periods published */
+    uint32_t    tick;                   /**< OS tick of the publication */
+
+    // Odometry
+    int32_t     xmm;                    /**< X (mm) */
+    int32_t     ymm;                    /**< Y (mm) */
+    float32_t   odeg;                   /**< Heading (deg) */
+    float32_t   linearPosition;         /**< Linear position (m) */
+    float32_t   angularPosition;        /**< Angular position (rad) */
+    float32_t   linearVelocity;         /**< Linear velocity (m/s) */
+    float32_t   angularVelocity;        /**< Angular velocity (rad/s) */
+
+    // Setpoints
+    float32_t   linearPositionProfiled; /**< Profiled linear position (m) */
+    float32_t   angularPositionProfiled;/**< Profiled angular position (rad) */
+    uint32_t    step;                   /**< TrajectoryPlanning step */
+    float32_t   remaining;              /**< Distance left by running order (m) */
+    uint32_t    waypoint;               /**< Path points reached by running order */
+
+    // Status words
+    uint16_t    mc;
+    uint16_t    tp;
+    uint16_t    pc;
+    uint16_t    od;
+
+    // Orders acknowledgement
+    uint16_t    runningTag;
+    uint16_t    finishedTag;
+
+    // Faults
+    bool        emergency;              /**< Emergency stop latched */
+    bool        wheelStall;             /**< Both wheel motors stalled */
+}SYSTEM_STATE;
+
+/*----------------------------------------------------------------------------*/
+/* Class declaration                                                          */
+/*----------------------------------------------------------------------------*/
+
+/**
+ * @class SystemState
+ * @brief Single writer, many readers view of the motion control state
+ *
+ * HOWTO :
+ * - The motion control task fills a SYSTEM_STATE at the end of each period
+ *   and calls Publish()
+ * - Readers (Diag, CLI, I2CProtocol) take a consistent copy with Read()
+ *   instead of calling each module getter
+ *
+ * Sequence lock : odd while publishing, readers retry on a change. A reader
+ * never blocks the control task and all fields of a copy belong to the same
+ * period.
+ */
+class SystemState
+{
+public:
+
+    /**
+     * @brief Publish state (motion control task only)
+     * @param state : New state (cycle is set here)
+     */
+    static void Publish (const SYSTEM_STATE* state);
+
+    /**
+     * @brief Copy last published state
+     * @param state : Copy
+     * @return false if nothing was published yet (copy is zeroed)
+     */
+    static bool Read (SYSTEM_STATE* state);
+
+    /**
+     * @brief Get number of publications (changes on each period)
+     */
+    static uint32_t GetCycle ();
+};
+
+#endif /* INC_SYSTEMSTATE_HPP_ */
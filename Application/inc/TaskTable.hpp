@@ -0,0 +1,185 @@
+/**
+ * @file    TaskTable.hpp
+ * @author  Jeremy ROULLAND
+ * @date    22 oct. 2017
+ * @brief   Static task table
+ */
+
+#ifndef INC_TASKTABLE_HPP_
+#define INC_TASKTABLE_HPP_
+
+#include "common.h"
+
+// FreeRTOS
+#include "FreeRTOS.h"
+#include "task.h"
+
+/*----------------------------------------------------------------------------*/
+/* Definitions                                                                */
+/*----------------------------------------------------------------------------*/
+
+/**
+ * @brief Run the motion chain (Odometry, MotionControl, TrajectoryPlanning,
+ * PositionControl) as one cyclic executive in the MotionControl task
+ */
+#define TASK_CYCLIC_EXECUTIVE           (0u)
+
+// Stack size (words, 0 if not created), priority and period (ms, 0 if event driven) of each task
+
+#if TASK_CYCLIC_EXECUTIVE
+#define TASK_ODOMETRY_STACK_SIZE        (0u)        // Slot of the executive
+#define TASK_ODOMETRY_PRIORITY          (configMAX_PRIORITIES-2)
+#define TASK_ODOMETRY_PERIOD_MS         (5u)
+
+#define TASK_MC_STACK_SIZE              (384u)      // Executive : one frame runs the whole chain
+#define TASK_MC_PRIORITY                (configMAX_PRIORITIES-2)
+#define TASK_MC_PERIOD_MS               (5u)
+#else
+#define TASK_ODOMETRY_STACK_SIZE        (256u)
+#define TASK_ODOMETRY_PRIORITY          (configMAX_PRIORITIES-2)
+#define TASK_ODOMETRY_PERIOD_MS         (5u)
+
+#define TASK_MC_STACK_SIZE              (256u)
+#define TASK_MC_PRIORITY                (configMAX_PRIORITIES-3)
+#define TASK_MC_PERIOD_MS               (5u)
+#endif
+
+#define TASK_PC_STACK_SIZE              (512u)
+#define TASK_PC_PRIORITY                (configMAX_PRIORITIES-4)
+#define TASK_PC_PERIOD_MS               (10u)
+
+#define TASK_TP_STACK_SIZE              (512u)
+#define TASK_TP_PRIORITY                (configMAX_PRIORITIES-6)
+#define TASK_TP_PERIOD_MS               (100u)
+
+#define TASK_AC_STACK_SIZE              (256u)
+#define TASK_AC_PRIORITY                (3u)
+#define TASK_AC_PERIOD_MS               (5u)
+
+#define TASK_I2CP_STACK_SIZE            (256u)
+#define TASK_I2CP_PRIORITY              (3u)
+#define TASK_I2CP_PERIOD_MS             (1u)
+
+#define TASK_DIAG_STACK_SIZE            (256u)
+#define TASK_DIAG_PRIORITY              (2u)
+#define TASK_DIAG_PERIOD_MS             (1u)
+
+#define TASK_CLI_STACK_SIZE             (256u)
+#define TASK_CLI_PRIORITY               (1u)
+#define TASK_CLI_PERIOD_MS              (0u)
+
+#define TASK_TEST_STACK_SIZE            (256u)
+#define TASK_TEST_PRIORITY              (3u)
+#define TASK_TEST_PERIOD_MS             (100u)
+
+#define TASK_DEFERRED_STACK_SIZE        (256u)
+#define TASK_DEFERRED_PRIORITY          (configMAX_PRIORITIES-1)    // Interrupt work : above every loop
+#define TASK_DEFERRED_PERIOD_MS         (0u)
+
+#define TASK_SCRIPT_STACK_SIZE          (384u)                      // Report lines (Print buffer)
+#define TASK_SCRIPT_PRIORITY            (1u)
+#define TASK_SCRIPT_PERIOD_MS           (10u)                       // Step end polling
+
+#define TASK_CALIB_STACK_SIZE           (384u)                      // Report lines (Print buffer)
+#define TASK_CALIB_PRIORITY             (1u)
+#define TASK_CALIB_PERIOD_MS            (10u)                       // Order end polling
+
+#define TASK_BOOT_STACK_SIZE            (384u)                      // Deferred stages constructors
+#define TASK_BOOT_PRIORITY              (1u)                        // Below every loop
+#define TASK_BOOT_PERIOD_MS             (0u)
+
+/**
+ * @brief Supervised loops deadline (periods without check in, see Utils::Watchdog)
+ */
+#define TASK_WATCHDOG_PERIODS           (10u)
+
+/**
+ * @brief All task stacks (words)
+ */
+#define TASK_STACK_TOTAL                (TASK_ODOMETRY_STACK_SIZE + TASK_MC_STACK_SIZE + TASK_PC_STACK_SIZE + \
+                                         TASK_TP_STACK_SIZE + TASK_AC_STACK_SIZE + TASK_I2CP_STACK_SIZE + \
+                                         TASK_DIAG_STACK_SIZE + TASK_CLI_STACK_SIZE + TASK_TEST_STACK_SIZE + \
+                                         TASK_DEFERRED_STACK_SIZE + TASK_SCRIPT_STACK_SIZE + \
+                                         TASK_CALIB_STACK_SIZE + TASK_BOOT_STACK_SIZE)
+
+/**
+ * @brief Task definition structure
+ */
+typedef struct
+{
+    uint16_t    STACK_SIZE;     /**< Stack size (words) */
+    UBaseType_t PRIORITY;       /**< FreeRTOS priority */
+    uint32_t    PERIOD_MS;      /**< Period (ms), 0 if event driven */
+}TASK_DEF;
+
+/*----------------------------------------------------------------------------*/
+/* Class declaration                                                          */
+/*----------------------------------------------------------------------------*/
+
+/**
+ * @class TaskTable
+ * @brief Static task allocation
+ *
+ * HOWTO :
+ * - Each task has an entry in TaskTable::ID and its TASK_xxx definitions above
+ * - Create the task with TaskTable::Create() instead of xTaskCreate()
+ *
+ * Stacks and control blocks are reserved at link time (.bss), task creation
+ * never uses the FreeRTOS heap. A task can only be created once.
+ */
+class TaskTable
+{
+public:
+
+    /**
+     * @brief Task identifier list
+     */
+    enum ID
+    {
+        ODOMETRY,               //!< Odometry
+        MOTION_CONTROL,         //!< FBMotionControl
+        POSITION_CONTROL,       //!< PositionControl (standalone)
+        TRAJECTORY_PLANNING,    //!< TrajectoryPlanning (standalone)
+        ACTUATOR_CONTROL,       //!< ActuatorControl
+        I2C_PROTOCOL,           //!< I2CProtocol
+        DIAG,                   //!< Diag
+        CLI,                    //!< CLI
+        TEST,                   //!< main.cpp test task
+        DEFERRED,               //!< Utils::Deferred worker
+        SCRIPT,                 //!< Scripts runner
+        CALIBRATION,            //!< Odometry calibration runner
+        BOOT,                   //!< Deferred initialization stages
+        TASK_MAX
+    };
+
+    /**
+     * @brief Create a task with its static stack
+     * @param id : Task identifier
+     * @param handler : Task function
+     * @param name : Task name
+     * @param param : Task function parameter
+     * @return Task handle
+     */
+    static TaskHandle_t Create (enum ID id, TaskFunction_t handler, const char* name, void* param = NULL);
+
+    /**
+     * @brief Return task definition
+     * @param id : Task identifier
+     */
+    static const TASK_DEF* GetDef (enum ID id);
+
+    /**
+     * @brief Return task handle, NULL if not created
+     * @param id : Task identifier
+     */
+    static TaskHandle_t GetHandle (enum ID id);
+
+    /**
+     * @brief Return stack never used since task creation (words, high water mark)
+     * @param id : Task identifier
+     * @return Free words, 0 if not created
+     */
+    static uint32_t GetStackFree (enum ID id);
+};
+
+#endif /* INC_TASKTABLE_HPP_ */
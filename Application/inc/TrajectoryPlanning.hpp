@@ -13,11 +13,12 @@
 
 #include "common.h"
 
-// For std::string
-#include <algorithm>
-
 #include "Odometry.hpp"
+#include "GPIO.hpp"
 #include "PositionControlStepper.hpp"
+#include "Routes.hpp"
+#include "Spline.hpp"
+#include "Utils.hpp"
 
 // FreeRTOS
 #include "FreeRTOS.h"
@@ -31,8 +32,86 @@ using namespace Location;
 /* Definitions                                                                */
 /*----------------------------------------------------------------------------*/
 
-#define _PI_        3.14159265358979323846
-#define _2_PI_      6.28318530717958647692  // 2*PI
+#define _PI_        (FASTMATH_PI)
+#define _2_PI_      (FASTMATH_2_PI)         // 2*PI
+
+/**
+ * @brief Path buffer size (pushXY points)
+ */
+#define TP_PATH_MAX             (32u)
+
+/**
+ * @brief Corner blending radius (m)
+ *
+ * Arcs velocity is limited by the lookahead planner (angular velocity and
+ * lateral acceleration), a smaller radius slows the robot down on corners
+ */
+#define TP_BLEND_RADIUS         (0.10f)
+
+/**
+ * @brief Lookahead planner : lateral acceleration on arcs (m/s^2), minimum
+ * velocity until the end of a run (m/s)
+ */
+#define TP_LATERAL_ACC_MAX      (1.0f)
+#define TP_PLAN_VEL_MIN         (0.01f)
+
+/**
+ * @brief Pure pursuit : heading toward the path point this distance ahead (m),
+ * path heading is kept closer to the run end
+ */
+#define TP_PURSUIT_LOOKAHEAD    (0.08f)
+#define TP_PURSUIT_END          (0.02f)
+
+/**
+ * @brief Precomputed route refused if robot is farther from its start (m)
+ */
+#define TP_ROUTE_START_MAX      (0.05f)
+
+/**
+ * @brief Lookahead planner intervals (straight part and arc of each segment)
+ */
+#define TP_PLAN_MAX             (2u * TP_PATH_MAX)
+
+/**
+ * @brief Sharper corners (rad) stop the robot and rotate in place
+ */
+#define TP_BLEND_ANGLE_MAX      (1.75f)
+
+/**
+ * @brief Streamed path points ring size (power of 2, see streamXY())
+ */
+#define TP_STREAM_MAX           (128u)
+
+/**
+ * @brief Motion states count (see GetStateStats())
+ */
+#define TP_STATES               (13u)
+
+/**
+ * @brief Motion state statistics, times in ms (see TrajectoryPlanning::GetStateStats())
+ */
+typedef struct
+{
+    uint32_t    orders;         /**< Orders run in this state (finished or replaced) */
+    uint32_t    replaced;       /**< Orders replaced by a new one before finishing */
+    uint32_t    cycles;         /**< Planning cycles, all orders */
+    uint32_t    cyclesMax;      /**< Planning cycles of the longest order */
+    uint32_t    time;           /**< Time in state, all orders */
+    uint32_t    timeMax;        /**< Time of the longest order */
+    uint32_t    settled;        /**< Finished orders settled in the position bands */
+    uint32_t    settle;         /**< Settling time after the profile end, all settled orders */
+    uint32_t    settleMax;      /**< Longest settling time */
+}TP_STATE_STATS;
+
+/**
+ * @brief Streamed path point (see TrajectoryPlanning::StreamPush())
+ */
+typedef struct
+{
+    float32_t   x;              /**< m */
+    float32_t   y;              /**< m */
+    bool        last;           /**< Path ends on this point */
+}TP_STREAM_POINT;
 
 
 /*----------------------------------------------------------------------------*/
@@ -64,11 +143,19 @@ namespace MotionControl
         /**
          * @brief Return instance name
          */
-        std::string Name()
+        const char* Name()
         {
             return this->name;
         }
 
+        /**
+         * @brief Get Compute() execution time profiler
+         */
+        Utils::Profiler* GetProfiler()
+        {
+            return &this->profiler;
+        }
+
         uint16_t GetStatus()
         {
         	return this->status;
@@ -84,11 +171,17 @@ namespace MotionControl
         void goLinear(float32_t linear);     // linear in meters
         void goAngular(float32_t angular);   // angular in radian
         void freewheel();
-        void stop();
+        void stop();                        // brake to rest at maximum deceleration
+        void halt();                        // release position control now (emergency)
         void gotoXY(float32_t X, float32_t Y);   // X,Y in meters
-        void pushXY(float32_t X[], float32_t Y[], uint32_t n);   // X,Y in meters
+        void pushXY(float32_t X[], float32_t Y[], uint32_t n);   // X,Y in meters, n <= TP_PATH_MAX, corners blended
         int32_t stallX(int32_t stallMode);       // stallMode allow to choose side to side contact (upTable to backBot, upTable to frontBot, downTable to backBot, downTable to frontBot)
         int32_t stallY(int32_t stallMode);       // stallMode allow to choose side to side contact (leftTable to backBot, leftTable to frontBot, rightTable to backBot, rightTable to frontBot)
+        bool route(uint32_t id);                 // precomputed route (see Routes), robot near its start
+        void curveXY(float32_t X[], float32_t Y[], uint32_t n);  // X,Y in meters, n <= TP_PATH_MAX, spline from robot pose
+        void goArc(float32_t radius, float32_t length);          // radius, length in meters (radius > 0 turns left, 0 : straight)
+        void arcXY(float32_t X, float32_t Y);                    // X,Y in meters, arc tangent to robot heading
+        void streamXY();                                         // streamed points (see StreamPush()), corners blended
         // others orders...
 
         float32_t update();
@@ -100,13 +193,95 @@ namespace MotionControl
         	return this->finished;
         }
 
+        /**
+         * @brief is current order on its last deceleration (next order may be prepared)
+         */
+        bool isDecelerating();
+
+        /**
+         * @brief Get distance left to travel by current order (m, blended corners approximated)
+         * @return 0 if finished or order without translation
+         */
+        float32_t GetRemaining();
+
+        /**
+         * @brief Get path points (pushXY()) reached by current order, first one is 1
+         * @return 0 for an order without path points
+         *
+         * Streamed points are counted from the stream order start.
+         */
+        uint32_t GetWaypoint();
+
+        /**
+         * @brief Append points to the path stream (one producer task)
+         * @param points : Points, the last one may end the path
+         * @param n : Points count
+         * @return false if the stream can't hold them all (none appended)
+         *
+         * Points may be pushed before and while a stream order runs. The
+         * order loads them TP_PATH_MAX at most ahead of the robot, in place
+         * of the segments travelled : the run is replanned without stopping
+         * as long as points keep coming. Starved, the robot stops on the last
+         * point and waits for the next ones. Points left by a replaced stream
+         * order are dropped.
+         */
+        bool StreamPush(const TP_STREAM_POINT points[], uint32_t n);
+
+        /**
+         * @brief Get free path stream slots (any task)
+         */
+        uint32_t GetStreamFree()
+        {
+            return TP_STREAM_MAX - this->stream.Count();
+        }
+
         uint32_t GetStep()
         {
         	return (uint32_t)this->step;
         }
 
+        /**
+         * @brief Get location of the last stall contact, before the border reset it
+         * @param r : Location (odometry at contact)
+         * @return false if the last stall found no border
+         */
+        bool GetStallContact(robot_t* r)
+        {
+            *r = this->stallContact;
+            return this->stallContacted;
+        }
+
+        /**
+         * @brief Get motion state statistics
+         * @param state : State index (< TP_STATES)
+         * @param stats : Statistics copy
+         * @return false if state is out of range
+         *
+         * An order is timed from its first planning cycle to its return to
+         * FREE, or until a new order replaces it. A finished order then
+         * settles when the robot is within TP_SETTLE_* bands of the last
+         * position setpoint (planning period resolution).
+         */
+        bool GetStateStats(uint32_t state, TP_STATE_STATS* stats);
+
+        /**
+         * @brief Clear motion state statistics
+         */
+        void ResetStateStats();
+
+        /**
+         * @brief Get state name
+         */
+        static const char* GetStateName(uint32_t state);
+
+        /**
+         * @private
+         * @brief Rear bumper edge. DO NOT CALL !!
+         */
+        void INTERNAL_Bumper();
+
     protected:
-        enum state_t {FREE=0, LINEAR, ANGULAR, STOP, KEEP, LINEARPLAN, CURVEPLAN, STALLX, STALLY, DRAWPLAN};
+        enum state_t {FREE=0, LINEAR, ANGULAR, STOP, KEEP, LINEARPLAN, CURVEPLAN, STALLX, STALLY, DRAWPLAN, ROUTE, BRAKE, ARC};
 
         TrajectoryPlanning(bool standalone);
 
@@ -114,15 +289,122 @@ namespace MotionControl
         void calculateMove();
         void calculateGoLinear();
         void calculateGoAngular();
+        void calculateArc();
         void calculateStop();
         void calculateKeepPosition();
+        void calculateBrake();
         void calculateDrawPlan();
         void calculateLinearPlan();
         void calculateCurvePlan();
         void calculateStallX(int32_t mode);
         void calculateStallY(int32_t mode);
+        void calculateRoute();
+
+        /**
+         * @brief Compute path segments and corners from current location
+         */
+        void preparePath();
+
+        /**
+         * @brief Compute path segments from point first, corners from first (not point 0)
+         * @param previous : Heading before segment first (unwrapping reference)
+         */
+        void prepareSegments(uint32_t first, float32_t previous);
+
+        /**
+         * @brief Load streamed points after the last path point (TP_PATH_MAX at most)
+         * @return Points loaded
+         */
+        uint32_t streamLoad();
+
+        /**
+         * @brief Drop travelled segments, load streamed points, replan moving run
+         */
+        void streamShift();
+
+        /**
+         * @brief Get last point of the blended run starting at start
+         */
+        uint32_t findRunEnd(uint32_t start);
+
+        /**
+         * @brief Get blended arc length at corner k (computed by preparePath())
+         */
+        float32_t arcLength(uint32_t k);
+
+        /**
+         * @brief Get current run length
+         */
+        float32_t runLength();
+
+        /**
+         * @brief Get path heading at distance s from current run start
+         */
+        float32_t pathHeading(float32_t s);
+
+        /**
+         * @brief Get path point at distance s from current run start
+         */
+        void pathPoint(float32_t s, float32_t* x, float32_t* y);
+
+        /**
+         * @brief Get heading correcting lateral drift (pure pursuit), s is measured progress on current run
+         */
+        float32_t pursuitHeading(float32_t s);
+
+        /**
+         * @brief Get heading toward goal point (x, y), unwrapped around path heading h
+         */
+        float32_t pursuit(float32_t h, float32_t x, float32_t y);
+
+        /**
+         * @brief Interpolate current route at distance s from its start (table frame)
+         */
+        void routeSample(float32_t s, ROUTE_SAMPLE* sample);
 
-        void updateXYtoLA(uint32_t n);
+        /**
+         * @brief Get route heading correcting lateral drift (pure pursuit)
+         */
+        float32_t routeHeading(float32_t s);
+
+        /**
+         * @brief Plan current run velocity : curvature limits, forward and backward acceleration passes
+         * @param start : Velocity at run start (0 : at rest)
+         */
+        void planRun(float32_t start);
+
+        /**
+         * @brief Plan current spline velocity (segments curvature limits)
+         */
+        void planCurve();
+
+        /**
+         * @brief Forward and backward acceleration passes on planned intervals (planS, planVmax)
+         * @param start : Velocity at first bound (0 : at rest)
+         */
+        void planPasses(float32_t start);
+
+        /**
+         * @brief Get velocity limit on a curvature (angular velocity, lateral acceleration)
+         */
+        float32_t curvatureVelocity(float32_t curvature);
+
+        /**
+         * @brief Get spline heading correcting lateral drift (pure pursuit)
+         */
+        float32_t curveHeading(float32_t s);
+
+        /**
+         * @brief Get planned velocity limit at distance s from current run start
+         */
+        float32_t plannedVelocity(float32_t s);
+
+        /**
+         * @brief Advance planned position by one period toward end, return true at end
+         * @param velocity : Planned velocity at current planned position
+         * @param end : Run length
+         */
+        bool advancePlan(float32_t velocity, float32_t end);
 
         // 16 Flags Status
         uint16_t status;
@@ -132,12 +414,53 @@ namespace MotionControl
         int32_t state;
         int32_t step;
 
+        /**
+         * @brief Motion state statistics, running order (state, step after last cycle, start time in us, cycles) and settling
+         */
+        TP_STATE_STATS stateStats[TP_STATES];
+        int32_t statsState;
+        int32_t statsStep;
+        uint32_t statsStart;
+        uint32_t statsCycles;
+        int32_t settleState;
+        uint32_t settleStart;
+
+        /**
+         * @brief Update motion state statistics, before (order start) and after the planning cycle
+         */
+        void statsBegin();
+        void statsEnd();
+        void statsRecord(uint32_t now, bool replaced);
+
         float32_t linearSetPoint;
-        float32_t linearNextSetPoint;
         float32_t angularSetPoint;
 
         int32_t stallMode;
 
+        // Odometry at last stall contact
+        robot_t stallContact;
+        bool stallContacted;
+
+        /**
+         * @brief Border contact detection
+         *
+         * Contact is any of : both rear bumpers pressed (edges latched by
+         * interrupt), both wheel drivers stalled, encoders velocity collapse
+         * or both wheels commanded steps ahead of encoders travel (the last
+         * two held TP_STALL_CONFIRM periods, after a few mm of backing).
+         * stallSource : sources of the last contact (TP_STALL_xxx bits).
+         */
+        HAL::GPIO* bumperL;
+        HAL::GPIO* bumperR;
+        volatile bool bumped;
+        uint32_t stallConfirm;
+        uint32_t stallSource;
+
+        /**
+         * @brief Return contact sources (0 : no contact yet)
+         */
+        uint32_t detectContact();
+
         float32_t startTime;
         float32_t startLinearPosition;  //
         float32_t startAngularPosition; //
@@ -145,10 +468,75 @@ namespace MotionControl
         float32_t endLinearPosition;     // Linear Position Target
         float32_t endAngularPosition;    // Linear Angular Target
 
-        float32_t X[10];
-        float32_t Y[10];
+        /**
+         * @brief Path points (0 is robot location when path starts)
+         */
+        float32_t X[TP_PATH_MAX + 1u];
+        float32_t Y[TP_PATH_MAX + 1u];
         uint32_t  XYn;
 
+        /**
+         * @brief Segments (i : from point i to i+1) heading (unwrapped) and length
+         */
+        float32_t heading[TP_PATH_MAX];
+        float32_t length[TP_PATH_MAX];
+
+        /**
+         * @brief Segments unit direction (cosine, sine of heading)
+         */
+        float32_t dirX[TP_PATH_MAX];
+        float32_t dirY[TP_PATH_MAX];
+
+        /**
+         * @brief Corners (point k) tangent distance, blending arc radius and length, 0 if not blended
+         */
+        float32_t tangent[TP_PATH_MAX + 1u];
+        float32_t radius[TP_PATH_MAX + 1u];
+        float32_t arc[TP_PATH_MAX + 1u];
+
+        /**
+         * @brief Path stream : points ring, stream order running, last point
+         * loaded, points dropped with travelled segments (waypoints offset)
+         */
+        Utils::SpscRing<TP_STREAM_POINT, TP_STREAM_MAX> stream;
+        bool      streaming;
+        bool      streamEnded;
+        uint32_t  streamPassed;
+
+        /**
+         * @brief Current blended run (points runStart to runEnd)
+         */
+        uint32_t  runStart;
+        uint32_t  runEnd;
+        float32_t runOrigin;
+
+        /**
+         * @brief Run plan : interval bounds (distance from run start), velocity at
+         * bounds after passes, interval velocity limit, acceleration used
+         */
+        float32_t planS[TP_PLAN_MAX + 1u];
+        float32_t planV[TP_PLAN_MAX + 1u];
+        float32_t planVmax[TP_PLAN_MAX];
+        uint32_t  planN;
+        float32_t planAcc;
+
+        /**
+         * @brief Planned position (distance from run start) and velocity
+         */
+        float32_t planPosition;
+        float32_t planSpeed;
+
+        /**
+         * @brief Current precomputed route and its heading offset (turns from table frame)
+         */
+        const ROUTE_DEF* routeDef;
+        float32_t routeOffset;
+
+        /**
+         * @brief Curve plan spline (loaded from path points)
+         */
+        Spline spline;
+
         Odometry *odometry;
         PositionControl *position;
 
@@ -156,7 +544,7 @@ namespace MotionControl
          * @protected
          * @brief Instance name
          */
-        std::string name;
+        const char* name;
 
         /**
          * @protected
@@ -166,6 +554,18 @@ namespace MotionControl
          */
         TaskHandle_t taskHandle;
 
+        /**
+         * @protected
+         * @brief Compute() execution time profiler
+         */
+        Utils::Profiler profiler;
+
+        /**
+         * @protected
+         * @brief Task loop scheduling statistics
+         */
+        Utils::PeriodicTask periodic;
+
         /**
          * @protected
          * @brief Trajectory planning loop task handler
@@ -37,6 +37,20 @@
 #define	NO_ERROR			0u
 #define	ERROR_GENERAL		0xFF
 
+/**
+ * @brief Interrupt hot paths run from SRAM (no flash wait state nor ART miss)
+ * RAMFUNC : function, called with a long branch (SRAM is out of BL range)
+ * RAMDATA : constant table read by a RAMFUNC
+ * Both are copied with .data at startup, see LinkerScript.ld.
+ */
+#if defined(__arm__)
+	#define RAMFUNC			__attribute__((section(".ramfunc"), long_call))
+	#define RAMDATA			__attribute__((section(".ramdata")))
+#else
+	#define RAMFUNC
+	#define RAMDATA
+#endif
+
 /*----------------------------------------------------------------------------*/
 /* Types										                              */
 /*----------------------------------------------------------------------------*/
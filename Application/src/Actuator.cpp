@@ -0,0 +1,153 @@
+/**
+ * @file    Actuator.cpp
+ * @author  Jeremy ROULLAND
+ * @date    15 oct. 2026
+ * @brief   Common actuator interface (queued commands, completion handles)
+ */
+
+#include "Actuator.hpp"
+
+#include "task.h"
+
+/*----------------------------------------------------------------------------*/
+/* Definitions                                                                */
+/*----------------------------------------------------------------------------*/
+
+// Wait() polling period
+#define ACT_WAIT_POLL_MS        (5u)
+
+/*----------------------------------------------------------------------------*/
+/* Class Implementation                                                       */
+/*----------------------------------------------------------------------------*/
+
+bool ActuatorHandle::Poll() const
+{
+    if(this->actuator == NULL)
+        return true;
+
+    return this->actuator->IsCompleted(this->channel, this->seq);
+}
+
+bool ActuatorHandle::Wait(TickType_t timeout) const
+{
+    TickType_t start = xTaskGetTickCount();
+
+    while(!this->Poll())
+    {
+        if((timeout != portMAX_DELAY) && ((xTaskGetTickCount() - start) >= timeout))
+            return false;
+
+        vTaskDelay(pdMS_TO_TICKS(ACT_WAIT_POLL_MS));
+    }
+
+    return true;
+}
+
+bool ActuatorHandle::OnComplete(ACT_CALLBACK callback, void* obj) const
+{
+    if(this->actuator == NULL)
+        return false;
+
+    return this->actuator->Subscribe(this->channel, this->seq, callback, obj);
+}
+
+Actuator::Actuator(uint8_t channels)
+{
+    assert(channels <= ACT_CHANNEL_MAX);
+
+    this->channels = channels;
+
+    for(uint32_t i = 0; i < ACT_CHANNEL_MAX; i++)
+    {
+        this->issued[i]    = 0u;
+        this->completed[i] = 0u;
+
+        for(uint32_t j = 0; j < ACT_CALLBACKS_MAX; j++)
+        {
+            this->callbacks[i][j].callback = NULL;
+            this->callbacks[i][j].obj      = NULL;
+        }
+    }
+}
+
+bool Actuator::IsIdle()
+{
+    for(uint8_t i = 0; i < this->channels; i++)
+    {
+        if(!this->IsIdle(i))
+            return false;
+    }
+
+    return true;
+}
+
+bool Actuator::Subscribe(uint8_t ch, uint32_t seq, ACT_CALLBACK callback, void* obj)
+{
+    bool registered = false;
+
+    assert(ch < this->channels);
+
+    taskENTER_CRITICAL();
+
+    if(!this->IsCompleted(ch, seq))
+    {
+        this->callbacks[ch][seq % ACT_CALLBACKS_MAX].callback = callback;
+        this->callbacks[ch][seq % ACT_CALLBACKS_MAX].obj      = obj;
+        registered = true;
+    }
+
+    taskEXIT_CRITICAL();
+
+    return registered;
+}
+
+ActuatorHandle Actuator::enqueue(uint8_t ch, QueueHandle_t queue, const void* item)
+{
+    uint32_t seq = 0u;
+    bool queued = false;
+
+    assert(ch < this->channels);
+
+    // Sequence follows the queue order, whichever task queues
+    taskENTER_CRITICAL();
+
+    if((queued = (xQueueSend(queue, item, 0) == pdTRUE)))
+    {
+        seq = ++this->issued[ch];
+        this->callbacks[ch][seq % ACT_CALLBACKS_MAX].callback = NULL;
+    }
+
+    taskEXIT_CRITICAL();
+
+    if(!queued)
+        return ActuatorHandle(ACT_ERROR_FULL);
+
+    this->OrderQueued();
+
+    return ActuatorHandle(this, ch, seq);
+}
+
+void Actuator::complete(uint8_t ch)
+{
+    ACT_CALLBACK callback = NULL;
+    void* obj = NULL;
+    uint32_t seq = 0u;
+
+    assert(ch < this->channels);
+
+    taskENTER_CRITICAL();
+
+    seq = this->completed[ch] + 1u;
+    this->completed[ch] = seq;
+
+    callback = this->callbacks[ch][seq % ACT_CALLBACKS_MAX].callback;
+    obj      = this->callbacks[ch][seq % ACT_CALLBACKS_MAX].obj;
+    this->callbacks[ch][seq % ACT_CALLBACKS_MAX].callback = NULL;
+
+    taskEXIT_CRITICAL();
+
+    if(callback != NULL)
+        callback(obj);
+
+    this->OrderDone();
+}
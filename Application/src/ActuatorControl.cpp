@@ -0,0 +1,335 @@
+/**
+ * @file    ActuatorControl.cpp
+ * @author  Jeremy ROULLAND
+ * @date    14 oct. 2017
+ * @brief   Actuators orders engine (cylinders, mandibles)
+ */
+
+#include "ActuatorControl.hpp"
+#include "TaskTable.hpp"
+#include "StaticStorage.hpp"
+
+#include <string.h>
+
+/*----------------------------------------------------------------------------*/
+/* Definitions                                                                */
+/*----------------------------------------------------------------------------*/
+
+// State machines period while active (timed orders latency, stepper orders wake up the task)
+#define AC_TASK_PERIOD_MS           (TASK_AC_PERIOD_MS)
+
+// Sequence step state
+#define AC_STEP_WAITING             (0u)
+#define AC_STEP_SENT                (1u)
+#define AC_STEP_DONE                (2u)
+
+/*----------------------------------------------------------------------------*/
+/* Private Members                                                            */
+/*----------------------------------------------------------------------------*/
+
+static ActuatorControl* _actuatorControl = NULL;
+static Utils::StaticStorage<ActuatorControl> _actuatorControlStorage;
+
+/*----------------------------------------------------------------------------*/
+/* Private Functions                                                          */
+/*----------------------------------------------------------------------------*/
+
+/**
+ * @brief Return step command
+ */
+static ACT_COMMAND _command (const AC_STEP* step)
+{
+    ACT_COMMAND cmd;
+
+    cmd.order = step->order;
+    cmd.arg   = step->index;
+
+    return cmd;
+}
+
+/**
+ * @brief Order queued event
+ */
+static void _orderQueuedEvent (void* obj)
+{
+    ActuatorControl* ac = reinterpret_cast<ActuatorControl*>(obj);
+
+    ac->INTERNAL_Wake();
+}
+
+/**
+ * @brief Motion finished event (interrupt context)
+ */
+static void _motionFinishedEvent (void* obj)
+{
+    ActuatorControl* ac = reinterpret_cast<ActuatorControl*>(obj);
+
+    ac->INTERNAL_WakeFromISR();
+}
+
+/*----------------------------------------------------------------------------*/
+/* Class Implementation                                                       */
+/*----------------------------------------------------------------------------*/
+
+ActuatorControl* ActuatorControl::GetInstance()
+{
+    // If ActuatorControl instance already exists
+    if(_actuatorControl != NULL)
+    {
+        return _actuatorControl;
+    }
+    else
+    {
+        _actuatorControl = new (_actuatorControlStorage.Get()) ActuatorControl();
+        return _actuatorControl;
+    }
+}
+
+ActuatorControl::ActuatorControl()
+{
+    this->name = "ActuatorControl";
+    this->taskHandle = NULL;
+
+    this->count = 0u;
+    this->nextCount = 0u;
+    this->pending = false;
+
+    for(uint32_t i = 0; i < AC_COROUTINES_MAX; i++)
+    {
+        this->coroutines[i].function = NULL;
+        this->coroutines[i].obj = NULL;
+    }
+
+    for(uint32_t i = 0; i < Cylinder::CYLINDER_MAX; i++)
+        this->actuator[i] = Cylinder::GetInstance(static_cast<Cylinder::ID>(i));
+    this->actuator[AC_MANDIBLE] = Mandible::GetInstance(Mandible::ID::MANDIBLE_1);
+
+    // Create task
+    this->taskHandle = TaskTable::Create(TaskTable::ACTUATOR_CONTROL, (TaskFunction_t)(&ActuatorControl::taskHandler), this->name);
+
+    // Wake up sources
+    for(uint32_t i = 0; i < AC_ACTUATOR_MAX; i++)
+        this->actuator[i]->OrderQueued.Subscribe(this, &_orderQueuedEvent);
+    for(uint32_t i = 0; i < Cylinder::CYLINDER_MAX; i++)
+        Cylinder::GetInstance(static_cast<Cylinder::ID>(i))->MotionFinished.Subscribe(this, &_motionFinishedEvent);
+}
+
+void ActuatorControl::INTERNAL_Wake()
+{
+    if(this->taskHandle != NULL)
+        xTaskNotifyGive(this->taskHandle);
+}
+
+void ActuatorControl::INTERNAL_WakeFromISR()
+{
+    BaseType_t woken = pdFALSE;
+
+    if(this->taskHandle != NULL)
+    {
+        vTaskNotifyGiveFromISR(this->taskHandle, &woken);
+        portYIELD_FROM_ISR(woken);
+    }
+}
+
+bool ActuatorControl::isActive()
+{
+    if(this->IsPlaying())
+        return true;
+
+    for(uint32_t i = 0; i < AC_COROUTINES_MAX; i++)
+    {
+        if(this->coroutines[i].function != NULL)
+            return true;
+    }
+
+    for(uint32_t i = 0; i < AC_ACTUATOR_MAX; i++)
+    {
+        if(!this->actuator[i]->IsIdle())
+            return true;
+    }
+
+    return false;
+}
+
+ActuatorHandle ActuatorControl::Start(uint8_t id, const ACT_COMMAND& cmd)
+{
+    if(id >= AC_ACTUATOR_MAX)
+        return ActuatorHandle(-1);
+
+    return this->actuator[id]->Start(cmd);
+}
+
+int8_t ActuatorControl::Spawn(Utils::Coroutine::Function function, void* obj)
+{
+    int8_t id = -1;
+
+    assert(function != NULL);
+
+    // Slot claimed by the first caller (any task)
+    taskENTER_CRITICAL();
+
+    for(uint32_t i = 0; i < AC_COROUTINES_MAX; i++)
+    {
+        if(this->coroutines[i].function == NULL)
+        {
+            this->coroutines[i].obj = obj;
+            this->coroutines[i].co.Reset();
+            this->coroutines[i].function = function;
+            id = static_cast<int8_t>(i);
+            break;
+        }
+    }
+
+    taskEXIT_CRITICAL();
+
+    if(id >= 0)
+        this->INTERNAL_Wake();
+
+    return id;
+}
+
+void ActuatorControl::resume()
+{
+    AC_COROUTINE* c = NULL;
+
+    for(uint32_t i = 0; i < AC_COROUTINES_MAX; i++)
+    {
+        c = &this->coroutines[i];
+
+        if(c->function == NULL)
+            continue;
+
+        if(c->function(&c->co, c->obj) == CO_DONE)
+            c->function = NULL;
+    }
+}
+
+int8_t ActuatorControl::Play(const AC_STEP* steps, uint32_t n)
+{
+    if(this->IsPlaying())
+        return -1;
+
+    if((n == 0u) || (n > AC_SEQUENCE_MAX))
+        return -2;
+
+    for(uint32_t i = 0; i < n; i++)
+    {
+        if(steps[i].actuator >= AC_ACTUATOR_MAX)
+            return -2;
+        if((steps[i].after >= static_cast<int32_t>(i)) || (steps[i].percent > 100u))
+            return -2;
+        if((steps[i].actuator == AC_MANDIBLE) && (steps[i].order >= Mandible::Position::Position_MAX))
+            return -2;
+        if((steps[i].actuator != AC_MANDIBLE) && (steps[i].order > Cylinder::SHIFT))
+            return -2;
+    }
+
+    // Taken by the task on its next period
+    memcpy(this->next, steps, n * sizeof(AC_STEP));
+    this->nextCount = n;
+    __DMB();
+    this->pending = true;
+
+    this->INTERNAL_Wake();
+
+    return 0;
+}
+
+void ActuatorControl::play()
+{
+    const AC_STEP* step = NULL;
+    bool finished = true;
+
+    if(this->pending && (this->count == 0u))
+    {
+        memcpy(this->sequence, this->next, this->nextCount * sizeof(AC_STEP));
+        memset(this->state, AC_STEP_WAITING, sizeof(this->state));
+        this->count = this->nextCount;
+        this->pending = false;
+    }
+
+    if(this->count == 0u)
+        return;
+
+    for(uint32_t i = 0; i < this->count; i++)
+    {
+        step = &this->sequence[i];
+
+        switch(this->state[i])
+        {
+        case AC_STEP_WAITING:
+            // Dependency progress reached and actuator channel free
+            if((step->after < 0) ||
+               (this->state[step->after] == AC_STEP_DONE) ||
+               ((this->state[step->after] == AC_STEP_SENT) && (this->progress(&this->sequence[step->after]) >= step->percent)))
+            {
+                if(this->isFree(step))
+                {
+                    this->send(step);
+                    this->state[i] = AC_STEP_SENT;
+                }
+            }
+            finished = false;
+            break;
+
+        case AC_STEP_SENT:
+            if(this->progress(step) >= 100u)
+                this->state[i] = AC_STEP_DONE;
+            else
+                finished = false;
+            break;
+
+        default:
+            break;
+        }
+    }
+
+    if(finished)
+    {
+        this->count = 0u;
+        this->SequenceDone();
+    }
+}
+
+uint8_t ActuatorControl::progress(const AC_STEP* step)
+{
+    Actuator* act = this->actuator[step->actuator];
+
+    return act->GetProgress(act->GetChannel(_command(step)));
+}
+
+bool ActuatorControl::isFree(const AC_STEP* step)
+{
+    Actuator* act = this->actuator[step->actuator];
+
+    return act->IsIdle(act->GetChannel(_command(step)));
+}
+
+void ActuatorControl::send(const AC_STEP* step)
+{
+    this->actuator[step->actuator]->Start(_command(step));
+}
+
+void ActuatorControl::Compute()
+{
+    this->play();
+
+    this->resume();
+
+    for(uint32_t i = 0; i < AC_ACTUATOR_MAX; i++)
+        this->actuator[i]->Process();
+}
+
+void ActuatorControl::taskHandler (void* obj)
+{
+    ActuatorControl* instance = _actuatorControl;
+
+    while(1)
+    {
+        // 1. Run actuators state machines
+        instance->Compute();
+
+        // 2. Wait for an order, a motion end or the period while active
+        ulTaskNotifyTake(pdTRUE, instance->isActive() ? pdMS_TO_TICKS(AC_TASK_PERIOD_MS) : portMAX_DELAY);
+    }
+}
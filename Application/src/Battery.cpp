@@ -0,0 +1,86 @@
+/**
+ * @file    Battery.cpp
+ * @author  Jeremy ROULLAND
+ * @date    15 oct. 2026
+ * @brief   Battery voltage monitor and motion limits scale
+ */
+
+#include "Battery.hpp"
+#include "StaticStorage.hpp"
+#include "Watch.hpp"
+
+#include <stddef.h>
+
+using namespace HAL;
+
+/*----------------------------------------------------------------------------*/
+/* Definitions                                                                */
+/*----------------------------------------------------------------------------*/
+
+#define BATTERY_V_BY_LSB        (BATTERY_ADC_VREF * BATTERY_DIVIDER / BATTERY_ADC_FULL_SCALE)
+
+/*----------------------------------------------------------------------------*/
+/* Private Members                                                            */
+/*----------------------------------------------------------------------------*/
+
+static Battery* _battery = NULL;
+static Utils::StaticStorage<Battery> _batteryStorage;
+
+/*----------------------------------------------------------------------------*/
+/* Class Implementation                                                       */
+/*----------------------------------------------------------------------------*/
+
+Battery* Battery::GetInstance ()
+{
+    if(_battery != NULL)
+    {
+        return _battery;
+    }
+    else
+    {
+        _battery = new (_batteryStorage.Get()) Battery();
+        return _battery;
+    }
+}
+
+Battery::Battery ()
+{
+    this->adc = ADConverter::GetInstance(BATTERY_ADC_CHANNEL);
+
+    // Start from current input, not from 0 V
+    this->filter.Reset(this->adc->GetResult());
+    this->voltage = 0.0f;
+    this->scale = 1.0f;
+
+    this->Update();
+
+    // Runtime inspection (CLI watch, peek)
+    WATCH_MEMBER("battery", voltage);
+    WATCH_MEMBER("battery", scale);
+}
+
+void Battery::Update ()
+{
+    float32_t voltage, scale;
+
+    voltage = static_cast<float32_t>(this->filter.Put(this->adc->GetResult())) * BATTERY_V_BY_LSB;
+
+    if(voltage < BATTERY_V_ABSENT)
+    {
+        scale = 1.0f;
+    }
+    else
+    {
+        // Rounded down : never above what the voltage allows, no change on noise
+        scale = voltage / BATTERY_V_WORST;
+        scale = static_cast<float32_t>(static_cast<int32_t>(scale / BATTERY_SCALE_STEP)) * BATTERY_SCALE_STEP;
+
+        if(scale < 1.0f)
+            scale = 1.0f;
+        if(scale > BATTERY_SCALE_MAX)
+            scale = BATTERY_SCALE_MAX;
+    }
+
+    this->voltage = voltage;
+    this->scale = scale;
+}
@@ -0,0 +1,254 @@
+/**
+ * @file    Bench.cpp
+ * @author  Jeremy ROULLAND
+ * @date    15 oct. 2026
+ * @brief   On-target kernels micro-benchmark
+ */
+
+#include "Bench.hpp"
+
+#include "MotionProfile.hpp"
+#include "Odometry.hpp"
+#include "Utils.hpp"
+#include "stm32f4xx.h"
+
+// FreeRTOS
+#include "FreeRTOS.h"
+#include "task.h"
+
+#include <math.h>
+
+/*----------------------------------------------------------------------------*/
+/* Definitions                                                                */
+/*----------------------------------------------------------------------------*/
+
+#define BENCH_START_DELAY_MS    (1000u)     // Console connected
+#define BENCH_PERIOD            (0.005f)    // Loops period (s)
+
+/**
+ * @brief Kernel under test, x spans [0; 1[ over the runs
+ */
+typedef void (*BENCH_KERNEL)(float32_t x);
+
+typedef struct
+{
+    const char*     NAME;
+    BENCH_KERNEL    KERNEL;
+}BENCH_DEF;
+
+/*----------------------------------------------------------------------------*/
+/* Private Members                                                            */
+/*----------------------------------------------------------------------------*/
+
+/**
+ * @brief Kernel results, keeps the compiler from dropping the work
+ */
+static volatile float32_t _sink = 0.0f;
+static volatile float64_t _sinkDouble = 0.0;
+
+/**
+ * @brief Measurement overhead (empty kernel median)
+ */
+static uint32_t _overhead = 0u;
+
+/**
+ * @brief Sorted cycles of current kernel (off the task stack)
+ */
+static uint32_t _cycles[BENCH_RUNS];
+
+/**
+ * @brief Kernels objects
+ */
+static Utils::PID _pid(1.0f, 0.5f, 0.01f, BENCH_PERIOD);
+static MotionControl::MotionProfile _poly5(1.0f, 1.0f, MotionControl::MotionProfile::POLY5);
+static MotionControl::StaticMotionProfile<MotionControl::MotionProfile::SCURVE> _scurve(1.0f, 1.0f, 10.0f);
+static Location::Odometry* _odometry = NULL;
+
+/*----------------------------------------------------------------------------*/
+/* Kernels                                                                    */
+/*----------------------------------------------------------------------------*/
+
+static void _empty (float32_t x)
+{
+    _sink = x;
+}
+
+static void _pidGet (float32_t x)
+{
+    _sink = _pid.Get(x);
+}
+
+static void _poly5Get (float32_t x)
+{
+    _sink = _poly5.Get(x * _poly5.GetDuration());
+}
+
+static void _scurveGet (float32_t x)
+{
+    _sink = _scurve.Get(x * _scurve.GetDuration());
+}
+
+static void _odometryCompute (float32_t x)
+{
+    _odometry->Compute(BENCH_PERIOD);
+}
+
+static void _sinf (float32_t x)
+{
+    _sink = sinf(x * FASTMATH_2_PI);
+}
+
+static void _sinDouble (float32_t x)
+{
+    _sinkDouble = sin(x * 6.283185307179586);
+}
+
+static void _sinCos (float32_t x)
+{
+    float32_t s, c;
+
+    Utils::SinCos(x * FASTMATH_2_PI, &s, &c);
+    _sink = s + c;
+}
+
+static void _atan2f (float32_t x)
+{
+    _sink = atan2f(x - 0.5f, 0.25f);
+}
+
+static void _atan2Double (float32_t x)
+{
+    _sinkDouble = atan2(x - 0.5, 0.25);
+}
+
+static void _atan2Fast (float32_t x)
+{
+    _sink = Utils::Atan2(x - 0.5f, 0.25f);
+}
+
+static void _tanf (float32_t x)
+{
+    _sink = tanf(x * 1.5f);
+}
+
+static void _tanFast (float32_t x)
+{
+    _sink = Utils::Tan(x * 1.5f);
+}
+
+static void _sqrtf (float32_t x)
+{
+    _sink = sqrtf(x);
+}
+
+static void _sqrtDouble (float32_t x)
+{
+    _sinkDouble = sqrt((float64_t)x);
+}
+
+static void _sqrtFast (float32_t x)
+{
+    _sink = Utils::Sqrt(x);
+}
+
+static void _divf (float32_t x)
+{
+    _sink = 1.0f / (x + 1.0f);
+}
+
+static void _divDouble (float32_t x)
+{
+    _sinkDouble = 1.0 / (x + 1.0);
+}
+
+/**
+ * @brief Benchmarked kernels
+ */
+static const BENCH_DEF _kernels[] =
+{
+    {"PID::Get",                    &_pidGet},
+    {"MotionProfile::Get POLY5",    &_poly5Get},
+    {"StaticMotionProfile SCURVE",  &_scurveGet},
+    {"Odometry::Compute",           &_odometryCompute},
+    {"sinf",                        &_sinf},
+    {"sin (double)",                &_sinDouble},
+    {"Utils::SinCos",               &_sinCos},
+    {"atan2f",                      &_atan2f},
+    {"atan2 (double)",              &_atan2Double},
+    {"Utils::Atan2",                &_atan2Fast},
+    {"tanf",                        &_tanf},
+    {"Utils::Tan",                  &_tanFast},
+    {"sqrtf",                       &_sqrtf},
+    {"sqrt (double)",               &_sqrtDouble},
+    {"Utils::Sqrt",                 &_sqrtFast},
+    {"float divide",                &_divf},
+    {"double divide",               &_divDouble},
+};
+
+/*----------------------------------------------------------------------------*/
+/* Private Functions                                                          */
+/*----------------------------------------------------------------------------*/
+
+/**
+ * @brief Run a kernel BENCH_RUNS times
+ * @param kernel : Kernel
+ * @param cycles : Sorted cycles of each run, minus overhead
+ */
+static void _measure (BENCH_KERNEL kernel, uint32_t* cycles)
+{
+    uint32_t primask, start, c, j;
+
+    // Warm up (flash cache, lazy computations)
+    kernel(0.5f);
+
+    for(uint32_t i = 0u; i < BENCH_RUNS; i++)
+    {
+        primask = __get_PRIMASK();
+        __disable_irq();
+
+        start = Utils::Profiler::GetCycles();
+        kernel(static_cast<float32_t>(i) / static_cast<float32_t>(BENCH_RUNS));
+        c = Utils::Profiler::GetCycles() - start;
+
+        __set_PRIMASK(primask);
+
+        c = (c > _overhead) ? (c - _overhead) : 0u;
+
+        // Insertion sort
+        for(j = i; (j > 0u) && (cycles[j - 1u] > c); j--)
+            cycles[j] = cycles[j - 1u];
+        cycles[j] = c;
+    }
+}
+
+/*----------------------------------------------------------------------------*/
+/* Class Implementation                                                       */
+/*----------------------------------------------------------------------------*/
+
+void Bench::Task (void* param)
+{
+    Utils::Profiler::Init();
+
+    _poly5.SetSetPoint(1.0f, 0.0f, 0.0f);
+    _scurve.SetSetPoint(1.0f, 0.0f, 0.0f);
+    _pid.SetSetpoint(0.5f);
+    _odometry = Location::Odometry::GetInstance(false);
+
+    vTaskDelay(pdMS_TO_TICKS(BENCH_START_DELAY_MS));
+
+    _overhead = 0u;
+    _measure(&_empty, _cycles);
+    _overhead = _cycles[BENCH_RUNS / 2u];
+
+    Utils::Print("\r\nBench : %u runs, %lu Hz, overhead %lu cycles\r\n", BENCH_RUNS, SystemCoreClock, _overhead);
+    Utils::Print("%-28s %8s %8s %8s\r\n", "Kernel (cycles)", "min", "median", "max");
+
+    for(uint32_t i = 0u; i < (sizeof(_kernels) / sizeof(_kernels[0])); i++)
+    {
+        _measure(_kernels[i].KERNEL, _cycles);
+
+        Utils::Print("%-28s %8lu %8lu %8lu\r\n", _kernels[i].NAME, _cycles[0], _cycles[BENCH_RUNS / 2u], _cycles[BENCH_RUNS - 1u]);
+    }
+
+    vTaskDelete(NULL);
+}
@@ -0,0 +1,171 @@
+/**
+ * @file    Boot.cpp
+ * @author  Jeremy ROULLAND
+ * @date    15 oct. 2026
+ * @brief   Staged initialization (dependency order, deferred stages, boot timing)
+ */
+
+#include "Boot.hpp"
+#include "TaskTable.hpp"
+#include "GPIO.hpp"
+#include "Utils.hpp"
+#include "Clock.hpp"
+
+// FreeRTOS
+#include "FreeRTOS.h"
+#include "task.h"
+
+#include <stddef.h>
+
+/*----------------------------------------------------------------------------*/
+/* Private Members                                                            */
+/*----------------------------------------------------------------------------*/
+
+/**
+ * @brief Stages table given by Start()
+ */
+static const BOOT_STAGE* _stages = NULL;
+static uint32_t _count = 0u;
+
+/**
+ * @brief Stages timing (us)
+ */
+static uint32_t _time[BOOT_STAGES_MAX];
+static uint32_t _end[BOOT_STAGES_MAX];
+
+/**
+ * @brief Ready and done times (us)
+ */
+static uint32_t _ready = 0u;
+static volatile uint32_t _done = 0u;
+
+/**
+ * @brief Orders accepted
+ */
+static volatile bool _isReady = false;
+
+/*----------------------------------------------------------------------------*/
+/* Class Implementation                                                       */
+/*----------------------------------------------------------------------------*/
+
+void Boot::Start (const BOOT_STAGE* stages, uint32_t count)
+{
+    uint32_t deferredMask = 0u;
+
+    // Cycle counter from now on (the OS keeps it running)
+    Utils::Profiler::Init();
+
+    assert(count <= BOOT_STAGES_MAX);
+
+    _stages = stages;
+    _count = count;
+
+    for(uint32_t i = 0u; i < count; i++)
+    {
+        _time[i] = 0u;
+        _end[i] = 0u;
+
+        // Dependencies come first, orders never wait for a deferred stage
+        assert((stages[i].AFTER >> i) == 0u);
+        assert(stages[i].DEFERRED || ((stages[i].AFTER & deferredMask) == 0u));
+
+        if(stages[i].DEFERRED)
+            deferredMask |= BOOT_AFTER(i);
+    }
+
+    for(uint32_t i = 0u; i < count; i++)
+    {
+        if(!stages[i].DEFERRED)
+            Boot::run(i);
+    }
+
+    // GPIO clocks are on : ready line driven low until SetReady()
+    HAL::GPIO::GetInstance(BOOT_READY_GPIO)->Set(HAL::GPIO::Low);
+
+    if(deferredMask != 0u)
+    {
+        TaskTable::Create(TaskTable::BOOT, &Boot::task, "Boot");
+    }
+    else
+    {
+        Boot::SetReady();
+        _done = _ready;
+    }
+}
+
+void Boot::SetReady ()
+{
+    if(_isReady)
+        return;
+
+    _ready = Utils::Clock::GetMicros();
+    _isReady = true;
+
+    HAL::GPIO::GetInstance(BOOT_READY_GPIO)->Set(HAL::GPIO::High);
+}
+
+bool Boot::IsReady ()
+{
+    return _isReady;
+}
+
+uint32_t Boot::Count ()
+{
+    return _count;
+}
+
+const BOOT_STAGE* Boot::GetStage (uint32_t i)
+{
+    return (i < _count) ? &_stages[i] : NULL;
+}
+
+uint32_t Boot::GetStageTime (uint32_t i)
+{
+    return (i < _count) ? _time[i] : 0u;
+}
+
+uint32_t Boot::GetStageEnd (uint32_t i)
+{
+    return (i < _count) ? _end[i] : 0u;
+}
+
+uint32_t Boot::GetReadyTime ()
+{
+    return _ready;
+}
+
+uint32_t Boot::GetDoneTime ()
+{
+    return _done;
+}
+
+void Boot::run (uint32_t i)
+{
+    uint32_t start = Utils::Clock::GetMicros();
+
+    // Allocations counted against the stage
+    Utils::Heap::SetTag(_stages[i].NAME);
+    _stages[i].INIT();
+    Utils::Heap::SetTag(NULL);
+
+    _end[i] = Utils::Clock::GetMicros();
+    _time[i] = _end[i] - start;
+}
+
+void Boot::task (void* param)
+{
+    for(uint32_t i = 0u; i < _count; i++)
+    {
+        if(_stages[i].DEFERRED)
+            Boot::run(i);
+    }
+
+    _done = Utils::Clock::GetMicros();
+
+    // No ready stage : ready once everything is up
+    Boot::SetReady();
+
+    Utils::Print("Boot : ready in %lu us, done in %lu us\r\n", _ready, _done);
+
+    vTaskDelete(NULL);
+}
@@ -0,0 +1,331 @@
+/**
+ * @file    Calibration.cpp
+ * @author  Jeremy ROULLAND
+ * @date    15 oct. 2026
+ * @brief   Odometry calibration runner (UMBmark squares, turns against borders)
+ */
+
+#include "Calibration.hpp"
+#include "Config.hpp"
+#include "TaskTable.hpp"
+#include "StaticStorage.hpp"
+#include "FastMath.hpp"
+#include "Format.hpp"
+#include "Units.hpp"
+
+#include <stddef.h>
+
+using namespace MotionControl;
+using namespace Location;
+
+/*----------------------------------------------------------------------------*/
+/* Definitions                                                                */
+/*----------------------------------------------------------------------------*/
+
+#define CALIB_POLL_MS               (TASK_CALIB_PERIOD_MS)
+#define CALIB_ORDER_TIMEOUT_MS      (30000u)    // Order without end : calibration aborted
+#define CALIB_TAG_FIRST             (0xE000u)   // Orders tags (below Scripts ones)
+
+#define CALIB_MARGIN_MM             (120)       // Distance to borders : turns clear them, stall reaches them (200 mm)
+#define CALIB_SIDE_MIN_MM           (300)
+#define CALIB_RUNS_MAX              (10u)
+#define CALIB_TURNS_MAX             (20u)
+
+#define CALIB_CORRECTION_MAX        (0.05f)     // Larger correction is a measurement failure (slip, missed border) : not saved
+
+/*----------------------------------------------------------------------------*/
+/* Private Members                                                            */
+/*----------------------------------------------------------------------------*/
+
+static Calibration* _calibration = NULL;
+static Utils::StaticStorage<Calibration> _calibrationStorage;
+
+/*----------------------------------------------------------------------------*/
+/* Class Implementation                                                       */
+/*----------------------------------------------------------------------------*/
+
+Calibration* Calibration::GetInstance ()
+{
+    if(_calibration != NULL)
+    {
+        return _calibration;
+    }
+    else
+    {
+        _calibration = new (_calibrationStorage.Get()) Calibration();
+        return _calibration;
+    }
+}
+
+Calibration::Calibration ()
+{
+    this->name = "Calibration";
+
+    this->side = CALIB_SIDE_MM;
+    this->runs = CALIB_RUNS;
+    this->turns = CALIB_TURNS;
+    this->running = false;
+    this->abort = false;
+    this->tag = CALIB_TAG_FIRST;
+
+    this->mc = FBMotionControl::GetInstance();
+    this->tp = TrajectoryPlanning::GetInstance(false);
+    this->odometry = Odometry::GetInstance(false);
+
+    // Create task
+    this->taskHandle = TaskTable::Create(TaskTable::CALIBRATION, (TaskFunction_t)(&Calibration::taskHandler), this->name);
+}
+
+bool Calibration::Start (int32_t side, uint32_t runs, uint32_t turns)
+{
+    if(this->running || (side < CALIB_SIDE_MIN_MM) ||
+       (runs == 0u) || (runs > CALIB_RUNS_MAX) || (turns == 0u) || (turns > CALIB_TURNS_MAX))
+        return false;
+
+    this->side = side;
+    this->runs = runs;
+    this->turns = turns;
+    this->abort = false;
+    this->running = true;
+
+    xTaskNotifyGive(this->taskHandle);
+
+    return true;
+}
+
+uint16_t Calibration::nextTag ()
+{
+    // Tags stay above the main board ones, below Scripts ones
+    this->tag = (this->tag == (0xF000u - 1u)) ? CALIB_TAG_FIRST : (this->tag + 1u);
+
+    return this->tag;
+}
+
+bool Calibration::wait (bool pushed)
+{
+    uint32_t aborted = this->mc->GetAbortedOrders();
+    TickType_t start = xTaskGetTickCount();
+
+    if(!pushed)
+        return false;
+
+    while(this->mc->GetFinishedOrder() != this->tag)
+    {
+        // Preempted, stopped or too long
+        if(this->abort || (this->mc->GetAbortedOrders() != aborted) ||
+           ((xTaskGetTickCount() - start) >= pdMS_TO_TICKS(CALIB_ORDER_TIMEOUT_MS)))
+            return false;
+
+        // Woken when an order ends, abort request checked every poll period
+        this->mc->WaitEvents(MC_EVENT_ORDER_DONE | MC_EVENT_ORDER_ABORTED, pdMS_TO_TICKS(CALIB_POLL_MS));
+    }
+
+    return true;
+}
+
+bool Calibration::stall (bool y, robot_t* contact)
+{
+    bool pushed = y ? this->mc->StallY(CMD_MODE_APPEND, this->nextTag()) :
+                      this->mc->StallX(CMD_MODE_APPEND, this->nextTag());
+
+    if(!this->wait(pushed))
+        return false;
+
+    if(!this->tp->GetStallContact(contact))
+    {
+        Utils::Print("calib : no %c border in range\r\n", y ? 'Y' : 'X');
+        return false;
+    }
+
+    return true;
+}
+
+bool Calibration::reference ()
+{
+    robot_t contact;
+
+    return this->stall(false, &contact) &&
+           this->wait(this->mc->GoLin(CALIB_MARGIN_MM, CMD_MODE_APPEND, this->nextTag())) &&
+           this->stall(true, &contact) &&
+           this->wait(this->mc->GoLin(CALIB_MARGIN_MM, CMD_MODE_APPEND, this->nextTag()));
+}
+
+bool Calibration::rotate (float32_t* error)
+{
+    robot_t r;
+
+    // Counterclockwise half turns : odometry heading is brought back by one turn
+    // between both (robot at rest, position control released), it stays in [-PI; PI]
+    for(uint32_t i = 0u; i < this->turns; i++)
+    {
+        if(!this->wait(this->mc->GoAng(1800, CMD_MODE_APPEND, this->nextTag())))
+            return false;
+
+        this->odometry->GetRobot(&r);
+        this->odometry->SetXYO(static_cast<float32_t>(r.Xmm) / 1000.0f, static_cast<float32_t>(r.Ymm) / 1000.0f, r.O - FASTMATH_2_PI);
+
+        if(!this->wait(this->mc->GoAng(0, CMD_MODE_APPEND, this->nextTag())))
+            return false;
+    }
+
+    // Heading at contact is the error (border is heading 0)
+    if(!this->stall(false, &r))
+        return false;
+
+    *error = Utils::WrapPi(r.O);
+
+    return true;
+}
+
+bool Calibration::square (bool cw, float32_t* ex, float32_t* ey)
+{
+    const Utils::Units::TickScale ticks(Config::Get()->tickByMm);
+    const int32_t a = CALIB_MARGIN_MM;
+    const int32_t b = CALIB_MARGIN_MM + this->side;
+    robot_t start, cx, cy;
+    float32_t back;
+    bool ok;
+
+    // Counterclockwise starts heading 0, clockwise heading PI/2
+    if(cw)
+        ok = this->wait(this->mc->Goto(a, b, CMD_MODE_APPEND, this->nextTag())) &&
+             this->wait(this->mc->Goto(b, b, CMD_MODE_APPEND, this->nextTag())) &&
+             this->wait(this->mc->Goto(b, a, CMD_MODE_APPEND, this->nextTag())) &&
+             this->wait(this->mc->Goto(a, a, CMD_MODE_APPEND, this->nextTag()));
+    else
+        ok = this->wait(this->mc->Goto(b, a, CMD_MODE_APPEND, this->nextTag())) &&
+             this->wait(this->mc->Goto(b, b, CMD_MODE_APPEND, this->nextTag())) &&
+             this->wait(this->mc->Goto(a, b, CMD_MODE_APPEND, this->nextTag())) &&
+             this->wait(this->mc->Goto(a, a, CMD_MODE_APPEND, this->nextTag()));
+
+    this->odometry->GetRobot(&start);
+
+    // X border : X error, heading error
+    if(!ok || !this->stall(false, &cx))
+        return false;
+
+    // Y border (X border reset heading)
+    if(!this->wait(this->mc->GoLin(CALIB_MARGIN_MM, CMD_MODE_APPEND, this->nextTag())) ||
+       !this->stall(true, &cy) ||
+       !this->wait(this->mc->GoLin(CALIB_MARGIN_MM, CMD_MODE_APPEND, this->nextTag())))
+        return false;
+
+    // Backing to the X border with the heading error moved odometry Y by -back * error
+    back = ticks.ToMillimeter(Utils::Units::Tick(start.L - cx.L)).Value();
+
+    *ex = ticks.ToMillimeter(Utils::Units::Tick(cx.X)).Value();
+    *ey = ticks.ToMillimeter(Utils::Units::Tick(cy.Y)).Value() + back * Utils::WrapPi(cx.O);
+
+    return true;
+}
+
+void Calibration::run ()
+{
+    const CONFIG_DATA* config = Config::Get();
+    const float32_t side = static_cast<float32_t>(this->side);
+    float32_t ex = 0.0f, ey = 0.0f;
+    float32_t xcw = 0.0f, ycw = 0.0f, xccw = 0.0f, yccw = 0.0f;
+    float32_t turnError = 0.0f, turnAngle = 0.0f;
+    float32_t alpha, beta, s, b;
+    float32_t eb, ebSquare, ed;
+    float64_t adwTick, wheelRatio;
+    bool ok;
+
+    Utils::Print("\r\ncalib : side %ld mm, %lu runs, %lu turns\r\n", this->side, this->runs, this->turns);
+
+    // 1. Turns between two X borders stalls
+    ok = this->reference() && this->rotate(&turnError);
+
+    if(ok)
+        Utils::Print(" turns\theading error %.3f deg\r\n", Utils::Units::ToDegree(Utils::Units::Radian(turnError)).Value());
+
+    // 2. Squares from a new reference, alternately counterclockwise and clockwise
+    ok = ok && this->reference();
+
+    for(uint32_t i = 0u; ok && (i < (2u * this->runs)); i++)
+    {
+        ok = this->square((i & 1u) != 0u, &ex, &ey);
+
+        if(!ok)
+            break;
+
+        Utils::Print(" %s\terror %.1f %.1f mm\r\n", (i & 1u) ? "cw" : "ccw", ex, ey);
+
+        if(i & 1u)
+        {
+            xcw += ex;
+            ycw += ey;
+        }
+        else
+        {
+            xccw += ex;
+            yccw += ey;
+        }
+    }
+
+    if(!ok || this->abort)
+    {
+        this->mc->Stop();
+        Utils::Print("calib : aborted, nothing saved\r\n");
+        return;
+    }
+
+    xcw /= static_cast<float32_t>(this->runs);
+    ycw /= static_cast<float32_t>(this->runs);
+    xccw /= static_cast<float32_t>(this->runs);
+    yccw /= static_cast<float32_t>(this->runs);
+
+    // UMBmark, both axes : alpha is the turn error (rad by PI/2 turn), beta the heading drift by side
+    alpha = (ycw - xcw + xccw - yccw) / (8.0f * side);
+    beta  = (ycw - xcw - xccw + yccw) / (8.0f * side);
+
+    // Diameters ratio Ed = (R + b/2) / (R - b/2) with R = (L/2) / sin(beta/2)
+    b  = static_cast<float32_t>(config->adwTick / config->tickByMm);
+    s  = Utils::Sin(0.5f * beta);
+    ed = (0.5f * side + 0.5f * b * s) / (0.5f * side - 0.5f * b * s);
+
+    // Axial distance from the turns (Eb = odometry / actual angle), squares as a check
+    turnAngle = FASTMATH_2_PI * static_cast<float32_t>(this->turns);
+    eb        = turnAngle / (turnAngle - turnError);
+    ebSquare  = FASTMATH_PI_2 / (FASTMATH_PI_2 - alpha);
+
+    adwTick    = config->adwTick * static_cast<float64_t>(eb);
+    wheelRatio = config->wheelRatio * static_cast<float64_t>(ed);
+
+    Utils::Print(" alpha %.4f deg, beta %.4f deg\r\n",
+           Utils::Units::ToDegree(Utils::Units::Radian(alpha)).Value(),
+           Utils::Units::ToDegree(Utils::Units::Radian(beta)).Value());
+    Utils::Print(" Eb %.6f (squares %.6f), Ed %.6f\r\n", eb, ebSquare, ed);
+    Utils::Print(" adwtick %.6f -> %.6f, wheelratio %.6f -> %.6f, tickbymm %.6f kept\r\n",
+           config->adwTick, adwTick, config->wheelRatio, wheelRatio, config->tickByMm);
+
+    if((Utils::Abs(eb - 1.0f) > CALIB_CORRECTION_MAX) || (Utils::Abs(ed - 1.0f) > CALIB_CORRECTION_MAX))
+    {
+        Utils::Print("calib : correction out of range, nothing saved\r\n");
+        return;
+    }
+
+    Config::Set(static_cast<uint32_t>(Config::Find("adwtick")), adwTick);
+    Config::Set(static_cast<uint32_t>(Config::Find("wheelratio")), wheelRatio);
+
+    // Flash erase stalls the CPU : robot at rest, motion control released
+    this->mc->Disable();
+
+    Utils::Print("calib : save %s\r\n", Config::Commit() ? "done, applied at next reset" : "failed");
+}
+
+void Calibration::taskHandler (void* obj)
+{
+    Calibration* instance = _calibration;
+
+    while(1)
+    {
+        // 1. Wait for Start()
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+
+        // 2. Run, report and save
+        instance->run();
+
+        instance->running = false;
+    }
+}
@@ -6,6 +6,16 @@
  */
 
 #include "Cli.hpp"
+#include "TaskTable.hpp"
+#include "StaticStorage.hpp"
+#include "Config.hpp"
+#include "ClockSync.hpp"
+#include "I2CProtocol.hpp"
+#include "Boot.hpp"
+#include "SystemState.hpp"
+#include "Power.hpp"
+#include "Battery.hpp"
+#include "Perf.hpp"
 
 #include <stdio.h>
 #include <stdlib.h>
@@ -15,12 +25,13 @@
 /* Definitions                                                                */
 /*----------------------------------------------------------------------------*/
 
-#define CLI_BUF_MAX        40
+#define CLI_ARGS_MAX                 (8u)
 
-#define CLI_TASK_STACK_SIZE          (256u)
-#define CLI_TASK_PRIORITY            (1u)
-
-#define CLI_TASK_PERIOD_MS           (10u)
+/**
+ * @brief Shortcut presets (':' and '!')
+ */
+#define CLI_PRESET_SLOW              "preset normal"
+#define CLI_PRESET_FAST              "preset fast"
 
 /*----------------------------------------------------------------------------*/
 /* Private Members                                                            */
@@ -28,6 +39,153 @@
 
 static CLI* _cli = NULL;
 
+/**
+ * @brief Code and tables copied to SRAM (see RAMFUNC, LinkerScript.ld)
+ */
+extern "C" uint32_t _sramfunc;
+extern "C" uint32_t _eramfunc;
+static Utils::StaticStorage<CLI> _cliStorage;
+
+/*----------------------------------------------------------------------------*/
+/* Commands table (sorted by strcmp() order for binary search)                */
+/*----------------------------------------------------------------------------*/
+
+const CLI::command_t CLI::commands[] =
+{
+    {"Arc",         &CLI::cmdMcArc},
+    {"GoAng",       &CLI::cmdMcGoAng},
+    {"GoLin",       &CLI::cmdMcGoLin},
+    {"Goto",        &CLI::cmdMcGoto},
+    {"Stop",        &CLI::cmdMcStop},
+    {"Test",        &CLI::cmdMcTest},
+    {"battery",     &CLI::cmdBattery},
+    {"boot",        &CLI::cmdBoot},
+    {"calib",       &CLI::cmdCalib},
+    {"checkup",     &CLI::cmdCheckup},
+    {"config",      &CLI::cmdConfig},
+    {"cpu",         &CLI::cmdCpu},
+    {"crash",       &CLI::cmdCrash},
+    {"curve",       &CLI::cmdCurve},
+    {"diag",        &CLI::cmdDiag},
+    {"disable",     &CLI::cmdDisable},
+    {"enable",      &CLI::cmdEnable},
+    {"encstat",     &CLI::cmdEncStat},
+    {"estop",       &CLI::cmdEstop},
+    {"free",        &CLI::cmdFree},
+    {"getodo",      &CLI::cmdGetOdo},
+    {"goang",       &CLI::cmdGoAng},
+    {"goarc",       &CLI::cmdGoArc},
+    {"golin",       &CLI::cmdGoLin},
+    {"goto",        &CLI::cmdGoto},
+    {"help",        &CLI::cmdHelp},
+    {"ki",          &CLI::cmdKi},
+    {"latency",     &CLI::cmdLatency},
+    {"lower",       &CLI::cmdLower},
+    {"mc",          &CLI::cmdMc},
+    {"mem",         &CLI::cmdMem},
+    {"param",       &CLI::cmdParam},
+    {"pcmode",      &CLI::cmdPcMode},
+    {"peek",        &CLI::cmdPeek},
+    {"perf",        &CLI::cmdPerf},
+    {"poke",        &CLI::cmdPoke},
+    {"power",       &CLI::cmdPower},
+    {"preset",      &CLI::cmdPreset},
+    {"ramfunc",     &CLI::cmdRamFunc},
+    {"rise",        &CLI::cmdRise},
+    {"route",       &CLI::cmdRoute},
+    {"safeguard",   &CLI::cmdSafeguard},
+    {"sched",       &CLI::cmdSched},
+    {"scope",       &CLI::cmdScope},
+    {"script",      &CLI::cmdScript},
+    {"setaccang",   &CLI::cmdSetAccAng},
+    {"setacclin",   &CLI::cmdSetAccLin},
+    {"setodo",      &CLI::cmdSetOdo},
+    {"setvelang",   &CLI::cmdSetVelAng},
+    {"setvellin",   &CLI::cmdSetVelLin},
+    {"status",      &CLI::cmdStatus},
+    {"stop",        &CLI::cmdStop},
+    {"swo",         &CLI::cmdSwo},
+    {"sync",        &CLI::cmdSync},
+    {"tpstat",      &CLI::cmdTpStat},
+    {"trace",       &CLI::cmdTrace},
+    {"tune",        &CLI::cmdTune},
+    {"watch",       &CLI::cmdWatch},
+    {"wdog",        &CLI::cmdWdog},
+};
+
+const uint32_t CLI::commandsCount = sizeof(CLI::commands) / sizeof(CLI::commands[0]);
+
+/*----------------------------------------------------------------------------*/
+/* Private Functions                                                          */
+/*----------------------------------------------------------------------------*/
+
+/**
+ * @brief Return argument i as float, def if missing
+ */
+static float32_t _argFloat (uint32_t argc, char* argv[], uint32_t i, float32_t def)
+{
+    return (i < argc) ? strtof(argv[i], NULL) : def;
+}
+
+/**
+ * @brief Write a registered parameter by name (see Utils::Param)
+ */
+static bool _setParam (const char* name, float32_t value)
+{
+    int32_t index = Utils::Param::Find(name);
+
+    return (index >= 0) && Utils::Param::Set(static_cast<uint32_t>(index), value);
+}
+
+/**
+ * @brief Return argument i as integer, def if missing
+ */
+static int32_t _argInt (uint32_t argc, char* argv[], uint32_t i, int32_t def)
+{
+    return (i < argc) ? strtol(argv[i], NULL, 10) : def;
+}
+
+/**
+ * @brief Emergency stop character received (serial RX interrupt)
+ */
+static void _breakEvent (void* obj)
+{
+    FBMotionControl* mc = reinterpret_cast<FBMotionControl*>(obj);
+
+    mc->EmergencyStop();
+}
+
+/**
+ * @brief Return argument i as order mode ("pre" or "rep"), append if missing
+ */
+static CMD_MODE _argMode (uint32_t argc, char* argv[], uint32_t i)
+{
+    if(i >= argc)
+        return CMD_MODE_APPEND;
+
+    if(strcmp(argv[i], "pre") == 0)
+        return CMD_MODE_PREEMPT;
+    if(strcmp(argv[i], "rep") == 0)
+        return CMD_MODE_REPLACE;
+
+    return CMD_MODE_APPEND;
+}
+
+/**
+ * @brief Replace running order by a debug one (SI units)
+ *
+ * Orders go through the MotionControl queues : TrajectoryPlanning is only
+ * written by the MotionControl task.
+ */
+static void _order (FBMotionControl* mc, struct cmd_t* cmd)
+{
+    cmd->mode = CMD_MODE_REPLACE;
+    cmd->tag = 0u;
+
+    if(!mc->Push(cmd))
+        Utils::Print("\r\norder refused (queue full)");
+}
+
 /*----------------------------------------------------------------------------*/
 /* Class Implementation                                                       */
 /*----------------------------------------------------------------------------*/
@@ -41,7 +199,7 @@ CLI* CLI::GetInstance()
     }
     else
     {
-        _cli = new CLI();
+        _cli = new (_cliStorage.Get()) CLI();
         return _cli;
     }
 }
@@ -51,13 +209,12 @@ CLI::CLI()
     this->name = "Cli";
     this->taskHandle = NULL;
 
+    this->line.clear();
+    this->overflow = false;
+    this->lastChar = '\0';
+
     // Create task
-    xTaskCreate((TaskFunction_t)(&CLI::taskHandler),
-                this->name.c_str(),
-                CLI_TASK_STACK_SIZE,
-                NULL,
-                CLI_TASK_PRIORITY,
-                NULL);
+    TaskTable::Create(TaskTable::CLI, (TaskFunction_t)(&CLI::taskHandler), this->name);
 
     this->odometry = Odometry::GetInstance(false);
     this->pc = PositionControl::GetInstance(false);
@@ -67,27 +224,54 @@ CLI::CLI()
     this->diag = Diag::GetInstance();
 
     this->man = Mandible::GetInstance(Mandible::ID::MANDIBLE_1);
+
+    this->serial = HAL::Serial::GetInstance(SERIAL_CONSOLE);
+    this->rpc = SerialProtocol::GetInstance();
+    this->scripts = Scripts::GetInstance();
+    this->calibration = Calibration::GetInstance();
+
+    // '&' stops from the RX interrupt, not when the task reads it
+    this->serial->BreakReceived.Subscribe(this->mc, &_breakEvent);
+    this->serial->SetBreakChar(SP_BREAK_CHAR);
 }
 
 
 void CLI::Start()
 {
+    const CRASH_RECORD* crash = Utils::Crash::GetLast();
+
+    if(crash != NULL)
+        Utils::Print("\r\nlast reset : %s in %s, pc 0x%08lx (see crash)\r\n",
+               Utils::Crash::GetCauseName(crash->CAUSE), (crash->TASK[0] != '\0') ? crash->TASK : "interrupt", crash->PC);
+
 	putchar('>');
 }
 
 void CLI::Compute(float32_t period)
 {
-    static char buf[CLI_BUF_MAX] = {0};
-    static uint16_t i = 0;
+    uint8_t c;
+
+    // Drain every received byte at once (pasted scripts are not paced)
+    while(this->serial->BytesToRead() > 0u)
+    {
+        c = this->serial->Read();
+
+        // Binary frames are 0x00 delimited, text never holds 0x00
+        if(!this->rpc->Input(c))
+            this->input(static_cast<char>(c));
+    }
+}
 
-    char c;
-    char *pch;
+void CLI::input(char c)
+{
+    char prev = this->lastChar;
 
-    c = getchar();
+    this->lastChar = c;
 
     if(c == '&')
     {
-    	printf("!!EMERGENCY STOP!! (NOT IMPLEMENTED!!!!!!!!)");
+        // Already latched by the RX interrupt
+        Utils::Print("\r\n!!EMERGENCY STOP!! (estop clear to release)\r\n");
 
     }
     else if(c == '(')
@@ -99,400 +283,1501 @@ void CLI::Compute(float32_t period)
         this->diag->Toggle(1);
     	putchar(c);
     }
-    else if(c == ')')
+    else if(c == '[')
     {
-    	putchar(c);
+        this->diag->Toggle(2);
     }
-    else if(c == '=')
+    else if(c == '{')
     {
-    	putchar(c);
+        this->diag->Toggle(3);
     }
-    else if(c == ',')
+    else if(c == '}')
     {
-    	putchar(c);
+        this->diag->Toggle(4);
     }
-    else if(c == ';')
+    else if((c == ')') || (c == '=') || (c == ','))
     {
     	putchar(c);
     }
     else if(c == ':')
     {
-        putchar(c);
-        /*pg->SetAngularVelMax(3.14);
-        pg->SetAngularAccMax(3.14);
-        pg->SetLinearVelMax(0.4);
-        pg->SetLinearAccMax(1.0);*/
-        printf("\r\nAngVel=3.14 AngAcc=3.14 LinVel=0.4 LinAcc=1.0\r\n");
+        this->preset(CLI_PRESET_SLOW);
     }
     else if(c == '!')
     {
-        putchar(c);
-        /*pg->SetAngularVelMax(12.0);
-        pg->SetAngularAccMax(18.0);
-        pg->SetLinearVelMax(1.0);
-        pg->SetLinearAccMax(2.0);*/
-        printf("\r\nAngVel=12.0 AngAcc=18.0 LinVel=1.0 LinAcc=2.0\r\n");
+        this->preset(CLI_PRESET_FAST);
+    }
+    else if(c == CLI_HISTORY_KEY)
+    {
+        // Erase echoed line, recall previous one
+        for(size_t i = 0u; i < this->line.size(); i++)
+            Utils::Print("\b \b");
+
+        this->line.clear();
+        this->line.append(this->history.c_str());
+        this->overflow = false;
+
+        Utils::Print("%s", this->line.c_str());
     }
     else if( ((c >= '0') && (c <= '9')) ||
         ((c >= 'a') && (c <= 'z')) ||
         ((c >= 'A') && (c <= 'Z')) ||
          (c == '.') || (c == ' ')  ||
-         (c == '-')  )
+         (c == '-') || (c == CLI_BATCH_SEPARATOR) )
     {
-        if(i < (CLI_BUF_MAX-2))
+        if(this->line.push_back(c))
         {
             putchar(c);
-            buf[i] = c;
-            i++;
-            buf[i] = '\0';
         }
-
+        else
+        {
+            this->overflow = true;
+        }
     }
     else if(c == '\b')
     {
         putchar('\b');
         putchar(' ');
         putchar('\b');
-        if(i>0)
-            i--;
-        buf[i] = '\0';
+        this->line.pop_back();
     }
     else if( (c == '\r') || (c == '\n') )
     {
-        pch = strtok (buf," ");
+        // "\r\n" is a single end of line
+        if((c == '\n') && (prev == '\r'))
+            return;
 
-        if(strcmp(pch,"help") == 0)
-        {
-            printf("\r\n## help (v0.1):\r\n");
-            printf(" Shortcut:\r\n");
-            printf(" - &            \tEmergency stop\r\n");
-            printf(" - (            \tToggle traces\r\n");
-            printf(" Command:\r\n");
-            printf(" - status             \tGet modules status\r\n");
-            printf(" - enable             \tEnable motion control\r\n");
-            printf(" - disable            \tDisable motion control\r\n");
-            printf(" - golin <l>          \tGo Linear\r\n");
-            printf(" - goang <a>          \tGo Angular\r\n");
-            printf(" - goto <x> <y>       \tGo to X,Y\r\n");
-            printf(" - getodo             \tGet odometry X,Y,O\r\n");
-            printf(" - setodo <x> <y> <o> \tSet odometry X,Y,O\r\n");
-            printf(" - setvellin <v>      \tSet velocity linear\r\n");
-            printf(" - setvelang <v>      \tSet velocity angular\r\n");
-            printf(" - setacclin <a>      \tSet acceleration linear\r\n");
-            printf(" - setaccang <a>      \tSet acceleration angular\r\n");
-            printf(" - free               \tFreewheel\r\n");
-            printf(" - stop <%%>          \tStop %% Brake\r\n");
-            printf(" - rise               \tRise pincer\r\n");
-            printf(" - lower              \tLower pincer\r\n");
-            printf(" = \r\n");
-            printf(" - GoLin <l>          \tGo Linear (mm)\r\n");
-            printf(" - GoAng <a>          \tGo Angular (1/10deg)\r\n");
-            printf(" - Goto <x> <y>       \tGo to X,Y (mm)\r\n");
-            printf(" - Stop               \tStop motion\r\n");
-            printf(" - Test               \tGoLin(500), GoAng(1800), GoLin(500), GoAng(0)\r\n");
-        }
-        else if(strcmp(pch,"enable") == 0)
-        {
-            mc->Enable();
-            printf("\r\nenable");
-        }
-        else if(strcmp(pch,"disable") == 0)
-        {
-            mc->Disable();
-            printf("\r\ndisable");
-        }
-        else if(strcmp(pch,"golin") == 0)
-        {
-            float l;
-            pch = strtok (NULL, " ");
-            if(pch != NULL)
-                l = strtof(pch, NULL);
-            else
-                l = 0.0;
-
-            printf("\r\ngolin %.3f", l);
-            tp->goLinear(l);
-            //pc->SetLinearPosition(l); // ATTENTION : Absolute value
-            //pc->Test();
-            //pg->StartLinearVelocity(l);
-        }
-        else if(strcmp(pch,"GoLin") == 0)
-        {
-            int16_t d;
-            pch = strtok (NULL, " ");
-            if(pch != NULL)
-                d = strtol(pch, NULL, 10);
-            else
-                d = 0;
-
-            printf("\r\nGoLin %d", d);
-            mc->GoLin(d);
-        }
-        else if(strcmp(pch,"goang") == 0)
-        {
-            float a;
-            pch = strtok (NULL, " ");
-            if(pch != NULL)
-                a = strtof(pch, NULL);
-            else
-                a = 0.0;
-
-            printf("\r\ngoang %.3f", a);
-            tp->goAngular(a);
-            //pc->SetAngularPosition(a);
-            //pc->Test();
-            //pg->StartAngularVelocity(a);
-        }
-        else if(strcmp(pch,"GoAng") == 0)
-        {
-            int16_t a;
-            pch = strtok (NULL, " ");
-            if(pch != NULL)
-                a = strtol(pch, NULL, 10);
-            else
-                a = 0;
-
-            printf("\r\nGoAng %d", a);
-            mc->GoAng(a);
-        }
-        else if(strcmp(pch,"goto") == 0)
-        {
-            float x, y;
-            pch = strtok (NULL, " ");
-            if(pch != NULL)
-                x = strtof(pch, NULL);
-            else
-                x = 0.0;
-            pch = strtok (NULL, " ");
-            if(pch != NULL)
-                y = strtof(pch, NULL);
-            else
-                y = 0.0;
-
-            printf("\r\ngoto %.3f %.3f", x, y);
-            tp->gotoXY(x,y);
-        }
-        else if(strcmp(pch,"Goto") == 0)
-        {
-            int16_t x, y;
-            pch = strtok (NULL, " ");
-            if(pch != NULL)
-                x = strtol(pch, NULL, 10);
-            else
-                x = 0;
-            pch = strtok (NULL, " ");
-            if(pch != NULL)
-                y = strtol(pch, NULL, 10);
-            else
-                y = 0;
-
-            printf("\r\nGoto %d %d", x, y);
-            mc->Goto(x,y);
-        }
-        else if(strcmp(pch,"getodo") == 0)
-        {
-            robot_t r;
-            odometry->GetRobot(&r);
-            printf("\r\ngetodo: %ld\t%ld\t%ld", r.Xmm, r.Ymm, (int32_t)(r.Odeg*10.0));
-        }
-        else if(strcmp(pch,"setodo") == 0)
-        {
-            float x, y, o;
-
-            pch = strtok (NULL, " ");
-            if(pch != NULL)
-                x = strtof(pch, NULL);
-            else
-                x = 0.0;
-            pch = strtok (NULL, " ");
-            if(pch != NULL)
-                y = strtof(pch, NULL);
-            else
-                y = 0.0;
-            pch = strtok (NULL, " ");
-            if(pch != NULL)
-                o = strtof(pch, NULL);
-            else
-                o = 0.0;
-
-            printf("\r\nsetodo %.3f %.3f %.3f", x, y, o);
-            odometry->SetXYO(x,y,o);
-        }
-        else if(strcmp(pch,"free") == 0)
-        {
-        	tp->freewheel();
-        }
-        else if(strcmp(pch,"stop") == 0)
-        {
-            float bk = 1.0;
-            pch = strtok (NULL, " ");
-            if(pch != NULL)
-                bk = strtof(pch, NULL);
-            printf("\r\nstop (%.1f Brake)", bk);
-            tp->stop();
-        }
-        else if(strcmp(pch,"Stop") == 0)
-        {
-            printf("\r\nStop");
-            mc->Stop();
-        }
-        else if(strcmp(pch,"checkup") == 0)
-        {
-            // TODO: Checkup
-            printf("\r\ncheckup");
-        }
-        else if(strcmp(pch,"safeguard") == 0)
-        {
-        	mc->ToggleSafeguard();
-            printf("\r\nsafeguard=%d", mc->GetSafeguard());
-        }
-        else if(strcmp(pch,"status") == 0)
-        {
-            printf("\r\nStatus:\r\n");
-            printf(" safeguard:%d\r\n", mc->GetSafeguard());
-            printf(" mc:0x%04x\r\n", mc->GetStatus());
-            printf(" tp:0x%04x\r\n", tp->GetStatus());
-            printf(" pc:0x%04x\r\n", pc->GetStatus());
-            printf(" od:0x%04x\r\n", odometry->GetStatus());
-        }
-        else if(strcmp(pch,"mc") == 0)
+        this->endOfLine();
+    }
+}
+
+void CLI::endOfLine()
+{
+    if(this->overflow)
+        Utils::Print("\r\nLine too long!!");
+    else
+        this->execute();
+
+    this->line.clear();
+    this->overflow = false;
+
+    putchar('\r');
+    putchar('\n');
+    putchar('>');
+}
+
+void CLI::preset(const char* batch)
+{
+    this->line.clear();
+    this->line.append(batch);
+    this->overflow = false;
+
+    Utils::Print("%s", this->line.c_str());
+
+    this->endOfLine();
+}
+
+uint32_t CLI::tokenize(char* str, char* argv[], uint32_t max)
+{
+    uint32_t argc = 0u;
+
+    while((*str != '\0') && (argc < max))
+    {
+        // Skip separators
+        while(*str == ' ')
+            *str++ = '\0';
+
+        if(*str == '\0')
+            break;
+
+        argv[argc++] = str;
+
+        while((*str != ' ') && (*str != '\0'))
+            str++;
+    }
+
+    return argc;
+}
+
+void CLI::execute()
+{
+    char* cmd = this->line.data();
+    bool batch = (strchr(cmd, CLI_BATCH_SEPARATOR) != NULL);
+
+    if(!this->line.empty())
+    {
+        this->history.clear();
+        this->history.append(cmd);
+    }
+
+    // Split in place, stop at first unknown command
+    while(cmd != NULL)
+    {
+        char* next = strchr(cmd, CLI_BATCH_SEPARATOR);
+
+        if(next != NULL)
+            *next++ = '\0';
+
+        if(!this->dispatch(cmd, batch))
+            return;
+
+        cmd = next;
+    }
+}
+
+bool CLI::dispatch(char* cmd, bool batch)
+{
+    char* argv[CLI_ARGS_MAX];
+    uint32_t argc;
+    uint32_t lo = 0u, hi = commandsCount;
+    int cmp;
+
+    argc = tokenize(cmd, argv, CLI_ARGS_MAX);
+
+    if(argc == 0u)
+        return true;
+
+    // Binary search in sorted commands table
+    while(lo < hi)
+    {
+        uint32_t mid = (lo + hi) / 2u;
+
+        cmp = strcmp(argv[0], commands[mid].name);
+
+        if(cmp == 0)
         {
-            pch = strtok (NULL, " ");
-            if(pch != NULL)
-            {
-            	if(strcmp(pch,"dis") == 0)
-            	{
-                    printf("\r\nmc disable");
-                    mc->Disable();
-            	}
-            	else
-            	{
-                    printf("\r\nmc enable");
-                    mc->Enable();
-            	}
-            }
-            else
+            if(batch)
             {
-                printf("\r\nmc enable");
-                mc->Enable();
+                Utils::Print("\r\n> ");
+                Utils::Print("%s", argv[0]);
             }
+
+            (this->*commands[mid].handler)(argc, argv);
+            return true;
         }
-        else if(strcmp(pch,"setvellin") == 0)
-        {
-            float v;
-            pch = strtok (NULL, " ");
-            if(pch != NULL)
-                v = strtof(pch, NULL);
-            else
-                v = 0.0;
-
-            printf("\r\nsetvellin %.3f", v);
-            //pg->SetLinearVelMax(v);
-        }
-        else if(strcmp(pch,"setvelang") == 0)
-        {
-            float v;
-            pch = strtok (NULL, " ");
-            if(pch != NULL)
-                v = strtof(pch, NULL);
-            else
-                v = 0.0;
-
-            printf("\r\nsetvelang %.3f", v);
-            //pg->SetAngularVelMax(v);
-        }
-        else if(strcmp(pch,"setacclin") == 0)
-        {
-            float a;
-            pch = strtok (NULL, " ");
-            if(pch != NULL)
-                a = strtof(pch, NULL);
-            else
-                a = 0.0;
-
-            printf("\r\nsetacclin %.3f", a);
-            //pg->SetLinearAccMax(a);
-        }
-        else if(strcmp(pch,"setaccang") == 0)
-        {
-            float a;
-            pch = strtok (NULL, " ");
-            if(pch != NULL)
-                a = strtof(pch, NULL);
-            else
-                a = 0.0;
-
-            printf("\r\nsetaccang %.3f", a);
-            //pg->SetAngularAccMax(a);
-        }
-        else if(strcmp(pch,"rise") == 0)
-        {
-            this->man->SetPosition(Mandible::Position::Top);
-        }
-        else if(strcmp(pch,"lower") == 0)
-        {
-            this->man->SetPosition(Mandible::Position::Bottom);
-        }
-        else if(strcmp(pch,"Test") == 0)
-        {
-            printf("\r\ntest");
-            mc->GoLin(500);
-            mc->GoAng(1800);
-            mc->GoLin(1000);
-            mc->GoAng(0);
-        }
-        else if(strcmp(pch,"ki") == 0)
+        else if(cmp < 0)
         {
-            float kp;
-            pch = strtok (NULL, " ");
-            if(pch != NULL)
-                kp = strtof(pch, NULL);
-            else
-                kp = 0.0;
-
-            printf("\r\nkp %.3f", kp);
-            //pc->SetAngularKp(kp);
+            hi = mid;
         }
         else
         {
-        	if(i > 0)
-        		printf("\r\nBad cmd!!");
+            lo = mid + 1u;
         }
+    }
+
+    Utils::Print("\r\nBad cmd!! ");
+    Utils::Print("%s", argv[0]);
 
-        i=0;
-        buf[i] = '\0';
-        putchar('\r');
-        putchar('\n');
-        putchar('>');
-    } /*else if( (c == '\r') || (c == '\n') )*/
+    return false;
+}
 
-} /* void CLI::Compute() */
+/*----------------------------------------------------------------------------*/
+/* Commands                                                                   */
+/*----------------------------------------------------------------------------*/
 
-void CLI::taskHandler (void* obj)
+void CLI::cmdHelp(uint32_t argc, char* argv[])
 {
-    TickType_t xLastWakeTime;
-    TickType_t xFrequency = pdMS_TO_TICKS(CLI_TASK_PERIOD_MS);
+    Utils::Print("\r\n## help (v0.1):\r\n");
+    Utils::Print(" Shortcut:\r\n");
+    Utils::Print(" - &            \tEmergency stop\r\n");
+    Utils::Print(" - (            \tToggle traces\r\n");
+    Utils::Print(" - [            \tToggle binary telemetry\r\n");
+    Utils::Print(" - {            \tToggle scheduling telemetry\r\n");
+    Utils::Print(" - }            \tToggle memory telemetry\r\n");
+    Utils::Print(" - :            \tNormal limits preset\r\n");
+    Utils::Print(" - !            \tFast limits preset\r\n");
+    Utils::Print(" - Ctrl-P       \tRecall previous line\r\n");
+    Utils::Print(" - a;b;c        \tRun commands a, b, c in one pass (stops at unknown command)\r\n");
+    Utils::Print(" Command:\r\n");
+    Utils::Print(" - status             \tGet modules status\r\n");
+    Utils::Print(" - enable             \tEnable motion control\r\n");
+    Utils::Print(" - disable            \tDisable motion control\r\n");
+    Utils::Print(" - estop [clear]      \tEmergency stop state, or release it (then enable)\r\n");
+    Utils::Print(" - golin <l>          \tGo Linear\r\n");
+    Utils::Print(" - goang <a>          \tGo Angular\r\n");
+    Utils::Print(" - goto <x> <y>       \tGo to X,Y\r\n");
+    Utils::Print(" - goarc <r> <l> [to] \tArc of radius r, length l (r > 0 : left), or 'to' X,Y tangent to heading\r\n");
+    Utils::Print(" - curve <x> <y> ...  \tFollow a spline through X,Y points from robot pose\r\n");
+    Utils::Print(" - route [<id>]       \tList precomputed routes, or start one (robot at its start)\r\n");
+    Utils::Print(" - script [<id>|stop] \tList order scripts, run one with timing report, or abort it\r\n");
+    Utils::Print(" - calib [<side> [<runs> [<turns>]]|stop]\tOdometry calibration from a table corner, saved in config\r\n");
+    Utils::Print(" - getodo             \tGet odometry X,Y,O\r\n");
+    Utils::Print(" - setodo <x> <y> <o> \tSet odometry X,Y,O\r\n");
+    Utils::Print(" - setvellin <v>      \tSet velocity linear\r\n");
+    Utils::Print(" - setvelang <v>      \tSet velocity angular\r\n");
+    Utils::Print(" - setacclin <a>      \tSet acceleration linear\r\n");
+    Utils::Print(" - setaccang <a>      \tSet acceleration angular\r\n");
+    Utils::Print(" - free               \tFreewheel\r\n");
+    Utils::Print(" - stop [0]           \tBrake to rest at maximum deceleration (0 : release now)\r\n");
+    Utils::Print(" - rise               \tRise pincer\r\n");
+    Utils::Print(" - lower              \tLower pincer\r\n");
+    Utils::Print(" - cpu [reset]        \tTasks CPU load & loops/IRQ execution time\r\n");
+    Utils::Print(" - cpu <n>            \tExecution time histogram of profiler n\r\n");
+    Utils::Print(" - sched [reset]      \tPeriodic loops period, jitter, latency & missed deadlines\r\n");
+    Utils::Print(" - sched <n>          \tJitter histogram of loop n\r\n");
+    Utils::Print(" - perf [reset]       \tPerformance counters since last reset (CPU, loops, losses, queues, buses), then reset\r\n");
+    Utils::Print(" - diag               \tDiag channels rate, sent, unchanged & dropped (link budget)\r\n");
+    Utils::Print(" - diag <ch> <on|off> [<ms>]\tEnable a channel, set its period\r\n");
+    Utils::Print(" - mem                \tTasks stack high water mark & heap fragmentation\r\n");
+    Utils::Print(" - ramfunc            \tCode run from SRAM, enabled interrupts handlers location\r\n");
+    Utils::Print(" - power [on|off]     \tIdle sleep time and tickless statistics\r\n");
+    Utils::Print(" - latency [reset]    \tOrder to first motor step latency histogram\r\n");
+    Utils::Print(" - tpstat [reset]     \tTrajectory planning time, cycles & settling time by motion state\r\n");
+    Utils::Print(" - encstat [reset]    \tEncoders health : rejected deltas, counter jumps, edge chatter\r\n");
+    Utils::Print(" - battery            \tBattery voltage & motion limits scale\r\n");
+    Utils::Print(" - boot               \tInitialization stages time, ready (line & status bit) and done times\r\n");
+    Utils::Print(" - crash [clear]      \tPrevious run crash record (registers, fault status, last traces)\r\n");
+    Utils::Print(" - wdog               \tWatchdog state, supervised loops deadline & last check in\r\n");
+    Utils::Print(" - trace [start|stop] \tEvent tracer state, start or stop recording\r\n");
+    Utils::Print(" - trace dump         \tStop and send trace records (binary frames)\r\n");
+    Utils::Print(" - trace odo <on|off> \tRecord odometry encoders deltas while tracing\r\n");
+    Utils::Print(" - trace replay       \tReplay recorded deltas through odometry (stopped trace)\r\n");
+    Utils::Print(" - scope              \tScope state, channels & variables\r\n");
+    Utils::Print(" - scope ch <n> <var> \tCapture variable on channel n (off : unused)\r\n");
+    Utils::Print(" - scope trig <t> [<n> <l>]\tTrigger : manual, order, rising, falling or above level l on channel n\r\n");
+    Utils::Print(" - scope arm [<pre>]  \tStart capture, pre-trigger samples (control loop rate)\r\n");
+    Utils::Print(" - scope force|stop   \tTrigger now, or stop capture\r\n");
+    Utils::Print(" - scope dump         \tStop and send samples (binary frames)\r\n");
+    Utils::Print(" - swo <port> <on|off>\tRoute log, telemetry or trace port on SWO\r\n");
+    Utils::Print(" - sync [<t>|reset]   \tMain board clock estimation, add a sample t (us) or start over\r\n");
+    Utils::Print(" - tune <ang|lin>     \tStart PID auto-tuning (relay feedback) of an axis, robot enabled and still\r\n");
+    Utils::Print(" - tune [stop]        \tAuto-tuning state, Ku, Tu & proposed gains, or abort\r\n");
+    Utils::Print(" - tune apply <rule>  \tApply proposed gains (zn, some or none overshoot)\r\n");
+    Utils::Print(" - param              \tLive parameters (value, bounds)\r\n");
+    Utils::Print(" - param <n> <v>      \tSet live parameter n\r\n");
+    Utils::Print(" - peek [<var>]       \tWatchable variables values, or one variable\r\n");
+    Utils::Print(" - poke <var> <v>     \tWrite a writable variable\r\n");
+    Utils::Print(" - watch <var> [<ms>] \tPrint a variable periodically (on change), with the other watched ones\r\n");
+    Utils::Print(" - watch [off]        \tWatched variables, or stop watching\r\n");
+    Utils::Print(" - pcmode [vel|step]  \tPosition control mode : closed loop velocity or open loop motors ramps\r\n");
+    Utils::Print(" - preset [normal|fast]\tLimits and gains preset (config), applied from next move\r\n");
+    Utils::Print(" - config             \tNon volatile configuration (edited values)\r\n");
+    Utils::Print(" - config set <n> <v> \tEdit parameter n\r\n");
+    Utils::Print(" - config default     \tRestore default values\r\n");
+    Utils::Print(" - config live        \tEdit with live parameters values\r\n");
+    Utils::Print(" - config save        \tWrite to flash (motion control disabled), applied at next reset\r\n");
+    Utils::Print(" = \r\n");
+    Utils::Print(" - GoLin <l> [pre|rep]\tGo Linear (mm), queued, preempting or replacing orders\r\n");
+    Utils::Print(" - GoAng <a> [pre|rep]\tGo Angular (1/10deg)\r\n");
+    Utils::Print(" - Goto <x> <y> [pre|rep]\tGo to X,Y (mm)\r\n");
+    Utils::Print(" - Arc <r> <l> [pre|rep]\tArc of radius r, length l (mm), both profiles together\r\n");
+    Utils::Print(" - Stop               \tStop motion\r\n");
+    Utils::Print(" - Test               \tGoLin(500), GoAng(1800), GoLin(500), GoAng(0)\r\n");
+}
 
-    CLI* instance = _cli;
-    TickType_t prevTick = 0u,  tick = 0u;
+void CLI::cmdEnable(uint32_t argc, char* argv[])
+{
+    mc->Enable();
+    Utils::Print("\r\nenable");
+}
 
-    float32_t period = 0.0f;
+void CLI::cmdDisable(uint32_t argc, char* argv[])
+{
+    mc->Disable();
+    Utils::Print("\r\ndisable");
+}
 
-    // 0. Delay
-    vTaskDelay(pdMS_TO_TICKS(1000u));
+void CLI::cmdEstop(uint32_t argc, char* argv[])
+{
+    if((argc > 1u) && (strcmp(argv[1], "clear") == 0))
+    {
+        if(!mc->ClearEmergency())
+            Utils::Print("\r\nestop : input still active");
+    }
 
-    instance->Start();
+    Utils::Print("\r\nestop %s\r\n", mc->IsEmergency() ? "latched" : "released");
+}
+
+void CLI::cmdGoLin(uint32_t argc, char* argv[])
+{
+    float l = _argFloat(argc, argv, 1, 0.0);
+
+    struct cmd_t cmd;
+
+    Utils::Print("\r\ngolin %.3f", l);
+    cmd.id = CMD_ID_GOLIN;
+    cmd.data.d = l;
+    _order(mc, &cmd);
+}
+
+void CLI::cmdMcGoLin(uint32_t argc, char* argv[])
+{
+    int16_t d = _argInt(argc, argv, 1, 0);
+
+    Utils::Print("\r\nGoLin %d", d);
+    mc->GoLin(d, _argMode(argc, argv, 2));
+}
+
+void CLI::cmdGoAng(uint32_t argc, char* argv[])
+{
+    float a = _argFloat(argc, argv, 1, 0.0);
+
+    struct cmd_t cmd;
+
+    Utils::Print("\r\ngoang %.3f", a);
+    cmd.id = CMD_ID_GOANG;
+    cmd.data.a = a;
+    _order(mc, &cmd);
+}
+
+void CLI::cmdMcGoAng(uint32_t argc, char* argv[])
+{
+    int16_t a = _argInt(argc, argv, 1, 0);
+
+    Utils::Print("\r\nGoAng %d", a);
+    mc->GoAng(a, _argMode(argc, argv, 2));
+}
+
+void CLI::cmdGoto(uint32_t argc, char* argv[])
+{
+    float x = _argFloat(argc, argv, 1, 0.0);
+    float y = _argFloat(argc, argv, 2, 0.0);
+
+    struct cmd_t cmd;
+
+    Utils::Print("\r\ngoto %.3f %.3f", x, y);
+    cmd.id = CMD_ID_GOTO;
+    cmd.data.xy.x = x;
+    cmd.data.xy.y = y;
+    _order(mc, &cmd);
+}
+
+void CLI::cmdGoArc(uint32_t argc, char* argv[])
+{
+    float a = _argFloat(argc, argv, 1, 0.0);
+    float b = _argFloat(argc, argv, 2, 0.0);
+    struct cmd_t cmd;
+
+    if((argc > 3u) && (strcmp(argv[3],"to") == 0))
+    {
+        Utils::Print("\r\ngoarc to %.3f %.3f", a, b);
+        cmd.id = CMD_ID_ARCTO;
+        cmd.data.xy.x = a;
+        cmd.data.xy.y = b;
+    }
+    else
+    {
+        Utils::Print("\r\ngoarc %.3f %.3f", a, b);
+        cmd.id = CMD_ID_ARC;
+        cmd.data.arc.radius = a;
+        cmd.data.arc.length = b;
+    }
+
+    _order(mc, &cmd);
+}
+
+void CLI::cmdMcArc(uint32_t argc, char* argv[])
+{
+    int16_t r = _argInt(argc, argv, 1, 0);
+    int16_t l = _argInt(argc, argv, 2, 0);
+
+    Utils::Print("\r\nArc %d %d", r, l);
+    mc->Arc(r, l, _argMode(argc, argv, 3));
+}
+
+void CLI::cmdMcGoto(uint32_t argc, char* argv[])
+{
+    int16_t x = _argInt(argc, argv, 1, 0);
+    int16_t y = _argInt(argc, argv, 2, 0);
+
+    Utils::Print("\r\nGoto %d %d", x, y);
+    mc->Goto(x, y, _argMode(argc, argv, 3));
+}
+
+void CLI::cmdGetOdo(uint32_t argc, char* argv[])
+{
+    SYSTEM_STATE s;
+    SystemState::Read(&s);
+    Utils::Print("\r\ngetodo: %ld\t%ld\t%ld", s.xmm, s.ymm, (int32_t)(s.odeg*10.0f));
+}
+
+void CLI::cmdSetOdo(uint32_t argc, char* argv[])
+{
+    float x = _argFloat(argc, argv, 1, 0.0);
+    float y = _argFloat(argc, argv, 2, 0.0);
+    float o = _argFloat(argc, argv, 3, 0.0);
+
+    Utils::Print("\r\nsetodo %.3f %.3f %.3f", x, y, o);
+    odometry->SetXYO(x,y,o);
+}
+
+void CLI::cmdFree(uint32_t argc, char* argv[])
+{
+	tp->freewheel();
+}
+
+void CLI::cmdStop(uint32_t argc, char* argv[])
+{
+    float bk = _argFloat(argc, argv, 1, 1.0);
+
+    Utils::Print("\r\nstop (%.1f Brake)", bk);
+
+    // Full brake profile, or release now
+    if(bk > 0.0f)
+        tp->stop();
+    else
+        tp->halt();
+}
+
+void CLI::cmdMcStop(uint32_t argc, char* argv[])
+{
+    Utils::Print("\r\nStop");
+    mc->Stop();
+}
+
+void CLI::cmdCheckup(uint32_t argc, char* argv[])
+{
+    // TODO: Checkup
+    Utils::Print("\r\ncheckup");
+}
+
+void CLI::cmdSafeguard(uint32_t argc, char* argv[])
+{
+	mc->ToggleSafeguard();
+    Utils::Print("\r\nsafeguard=%d", mc->GetSafeguard());
+}
+
+void CLI::cmdStatus(uint32_t argc, char* argv[])
+{
+    i2cp_snapshot_t snapshot;
+    I2CSlave* i2c = I2CSlave::GetInstance(I2CSlave::I2C_SLAVE0);
+
+    I2CProtocol::GetInstance()->GetSnapshot(&snapshot);
 
-    // 1. Initialise periodical task
-    xLastWakeTime = xTaskGetTickCount();
+    Utils::Print("\r\nStatus:\r\n");
+    Utils::Print(" safeguard:%d\r\n", mc->GetSafeguard());
+    Utils::Print(" mc:0x%04x\r\n", mc->GetStatus());
+    Utils::Print(" tp:0x%04x\r\n", tp->GetStatus());
+    Utils::Print(" pc:0x%04x\r\n", pc->GetStatus());
+    Utils::Print(" od:0x%04x\r\n", odometry->GetStatus());
+    Utils::Print(" tx dropped:%lu\r\n", Serial::GetInstance(SERIAL_CONSOLE)->GetDropped());
+    Utils::Print(" faults:0x%04x (snapshot %u)\r\n", snapshot.faults, snapshot.sequence);
+    Utils::Print(" stream free:%u\r\n", snapshot.stream);
+    Utils::Print(" rpc crc:%lu framing:%lu retransmit:%lu\r\n", this->rpc->GetCRCErrors(),
+                 this->rpc->GetFramingErrors(), this->rpc->GetRetransmissions());
+    Utils::Print(" i2c crc:%lu overrun:%lu recovered:%lu\r\n", i2c->GetCRCErrors(),
+                 i2c->GetOverruns(), i2c->GetRecoveries());
+}
+
+void CLI::cmdMc(uint32_t argc, char* argv[])
+{
+    if((argc > 1u) && (strcmp(argv[1],"dis") == 0))
+    {
+        Utils::Print("\r\nmc disable");
+        mc->Disable();
+    }
+    else
+    {
+        Utils::Print("\r\nmc enable");
+        mc->Enable();
+    }
+}
+
+void CLI::cmdSetVelLin(uint32_t argc, char* argv[])
+{
+    float v = _argFloat(argc, argv, 1, 0.0);
+
+    Utils::Print("\r\nsetvellin %.3f%s", v, _setParam("linvelmax", v) ? "" : " : out of bounds");
+}
+
+void CLI::cmdSetVelAng(uint32_t argc, char* argv[])
+{
+    float v = _argFloat(argc, argv, 1, 0.0);
+
+    Utils::Print("\r\nsetvelang %.3f%s", v, _setParam("angvelmax", v) ? "" : " : out of bounds");
+}
+
+void CLI::cmdSetAccLin(uint32_t argc, char* argv[])
+{
+    float a = _argFloat(argc, argv, 1, 0.0);
+
+    Utils::Print("\r\nsetacclin %.3f%s", a, _setParam("linaccmax", a) ? "" : " : out of bounds");
+}
+
+void CLI::cmdSetAccAng(uint32_t argc, char* argv[])
+{
+    float a = _argFloat(argc, argv, 1, 0.0);
+
+    Utils::Print("\r\nsetaccang %.3f%s", a, _setParam("angaccmax", a) ? "" : " : out of bounds");
+}
+
+void CLI::cmdRise(uint32_t argc, char* argv[])
+{
+    this->man->SetPosition(Mandible::Position::Top);
+}
+
+void CLI::cmdLower(uint32_t argc, char* argv[])
+{
+    this->man->SetPosition(Mandible::Position::Bottom);
+}
+
+void CLI::cmdCpu(uint32_t argc, char* argv[])
+{
+    if((argc > 1u) && (strcmp(argv[1],"reset") == 0))
+    {
+        for(uint32_t p = 0; p < Utils::Profiler::Count(); p++)
+            Utils::Profiler::Get(p)->Reset();
+        Utils::Print("\r\ncpu reset");
+    }
+    else if(argc > 1u)
+    {
+        this->CpuHistogram(strtoul(argv[1], NULL, 10));
+    }
+    else
+    {
+        this->CpuStats();
+    }
+}
+
+void CLI::cmdSched(uint32_t argc, char* argv[])
+{
+    if((argc > 1u) && (strcmp(argv[1],"reset") == 0))
+    {
+        for(uint32_t p = 0; p < Utils::PeriodicTask::Count(); p++)
+            Utils::PeriodicTask::Get(p)->Reset();
+        Utils::Print("\r\nsched reset");
+    }
+    else if(argc > 1u)
+    {
+        this->SchedHistogram(strtoul(argv[1], NULL, 10));
+    }
+    else
+    {
+        this->SchedStats();
+    }
+}
+
+void CLI::cmdPerf(uint32_t argc, char* argv[])
+{
+    PERF_SUMMARY s;
+    TaskStatus_t *tasks;
+    uint16_t *loads;
+    UBaseType_t count;
+    Utils::Profiler *p;
+    uint16_t load;
+
+    Perf::GetSummary(&s);
+
+    Utils::Print("\r\nWindow %lu ms, cpu %u.%u %%\r\n", s.window, s.cpu / 10u, s.cpu % 10u);
+
+    // Tasks load over the window
+    count = uxTaskGetNumberOfTasks();
+    tasks = (TaskStatus_t*)Utils::Heap::Alloc(count * sizeof(TaskStatus_t));
+    loads = (uint16_t*)Utils::Heap::Alloc(count * sizeof(uint16_t));
+
+    Utils::Print("Task\t\tLoad(%%)\r\n");
+
+    if((tasks != NULL) && (loads != NULL))
+    {
+        count = Perf::GetTasks(tasks, loads, count);
+
+        for(UBaseType_t t = 0; t < count; t++)
+            Utils::Print(" %-10s\t%u.%u\r\n", tasks[t].pcTaskName, loads[t] / 10u, loads[t] % 10u);
+    }
+
+    Utils::Heap::Free(loads);
+    Utils::Heap::Free(tasks);
+
+    // Loops and interrupts
+    Utils::Print("#  Loop/IRQ\t\tLoad(%%)\tMax(us)\r\n");
+
+    for(uint32_t i = 0; i < Utils::Profiler::Count(); i++)
+    {
+        p = Utils::Profiler::Get(i);
+        load = Perf::GetProfilerLoad(i);
+        Utils::Print(" %-2lu %-18s\t%u.%u\t%lu\r\n",
+               i,
+               p->GetName(),
+               load / 10u, load % 10u,
+               Utils::Profiler::CyclesToUs(p->GetMax()));
+    }
+
+    // Buses
+    Utils::Print("Bus\t\tBytes\tLoad(%%)\r\n");
+
+    for(uint32_t b = 0; b < PERF_BUS_MAX; b++)
+    {
+        load = Perf::GetBusLoad(b);
+        Utils::Print(" %-10s\t%lu\t%u.%u\r\n", Perf::GetBusName(b), Perf::GetBusBytes(b), load / 10u, load % 10u);
+    }
+
+    Utils::Print("Worst loop %lu us, latency %lu us, missed %lu\r\n", s.loopMax, s.latencyMax, s.missed);
+    Utils::Print("Lost trace %lu, log %lu, tx %lu, deferred %lu\r\n", s.traceLost, s.logLost, s.txDropped, s.deferredDropped);
+    Utils::Print("Orders peak %u/%u\r\n", s.ordersPeak, MC_ORDERS_MAX);
+
+    // Reset on read
+    if((argc > 1u) && (strcmp(argv[1],"reset") == 0))
+    {
+        Perf::Reset();
+        Utils::Print("perf reset\r\n");
+    }
+}
+
+void CLI::cmdLatency(uint32_t argc, char* argv[])
+{
+    if((argc > 1u) && (strcmp(argv[1],"reset") == 0))
+    {
+        this->mc->ResetLatency();
+        Utils::Print("\r\nlatency reset");
+        return;
+    }
+
+    // Order submission to first step (us)
+    Utils::Print("\r\nLatency\tMin\tAvg\tMax\tCount\r\n");
+    Utils::Print(" order\t%lu\t%lu\t%lu\t%lu\r\n",
+           this->mc->GetLatencyMin(),
+           this->mc->GetLatencyAverage(),
+           this->mc->GetLatencyMax(),
+           this->mc->GetLatencyCount());
+
+    Utils::Print(" <1      \t%lu\r\n", this->mc->GetLatencyHistogram(0));
+
+    for(uint32_t bin = 1; bin < (MC_LATENCY_HISTOGRAM_SIZE - 1u); bin++)
+        Utils::Print(" %lu-%lu   \t%lu\r\n", (1ul << (bin - 1u)), (1ul << bin) - 1u, this->mc->GetLatencyHistogram(bin));
+
+    Utils::Print(" >=%lu   \t%lu\r\n", (1ul << (MC_LATENCY_HISTOGRAM_SIZE - 2u)), this->mc->GetLatencyHistogram(MC_LATENCY_HISTOGRAM_SIZE - 1u));
+}
+
+void CLI::cmdTpStat(uint32_t argc, char* argv[])
+{
+    TP_STATE_STATS s;
+
+    if((argc > 1u) && (strcmp(argv[1],"reset") == 0))
+    {
+        this->tp->ResetStateStats();
+        Utils::Print("\r\ntpstat reset");
+        return;
+    }
+
+    // Averages by order, time and settling time after the profile end (ms)
+    Utils::Print("\r\nState\t\tOrders\tReplaced\tCycles\tMax\tTime\tMax\tSettled\tSettle\tMax\r\n");
+
+    for(uint32_t i = 0; i < TP_STATES; i++)
+    {
+        if(!this->tp->GetStateStats(i, &s) || (s.orders == 0u))
+            continue;
+
+        Utils::Print(" %-10s\t%lu\t%lu\t\t%lu\t%lu\t%lu\t%lu\t%lu\t%lu\t%lu\r\n",
+               TrajectoryPlanning::GetStateName(i),
+               s.orders, s.replaced,
+               s.cycles / s.orders, s.cyclesMax,
+               s.time / s.orders, s.timeMax,
+               s.settled,
+               s.settled ? (s.settle / s.settled) : 0u, s.settleMax);
+    }
+}
+
+void CLI::cmdEncStat(uint32_t argc, char* argv[])
+{
+    static const char* names[ODO_WHEELS] = {"left", "right"};
+    ODO_ENCODER_STATS s;
+
+    if((argc > 1u) && (strcmp(argv[1],"reset") == 0))
+    {
+        this->odometry->ResetEncoderStats();
+        Utils::Print("\r\nencstat reset");
+        return;
+    }
+
+    Utils::Print("\r\nWheel\tSamples\tMoving\tTicks\tPeak\tRejected\tJumps\tFlips\r\n");
+
+    for(uint32_t i = 0; i < ODO_WHEELS; i++)
+    {
+        if(!this->odometry->GetEncoderStats(i, &s))
+            continue;
+
+        Utils::Print(" %s\t%lu\t%lu\t%lu\t%lu\t%lu\t\t%lu\t%lu\r\n",
+               names[i], s.samples, s.moving, s.ticks, s.peak, s.rejected, s.jumps, s.flips);
+    }
+}
+
+void CLI::cmdBoot(uint32_t argc, char* argv[])
+{
+    const BOOT_STAGE* stage;
+
+    // Times from main() (us)
+    Utils::Print("\r\n#  Stage\t\tDeferred\tTime\tEnd\r\n");
+    for(uint32_t i = 0; i < Boot::Count(); i++)
+    {
+        stage = Boot::GetStage(i);
+        Utils::Print(" %-2lu %-10s\t%s\t\t%lu\t%lu\r\n", i, stage->NAME, stage->DEFERRED ? "yes" : "no",
+               Boot::GetStageTime(i), Boot::GetStageEnd(i));
+    }
+    Utils::Print(" ready %lu us (%s), done %lu us\r\n", Boot::GetReadyTime(), Boot::IsReady() ? "line high" : "booting",
+           Boot::GetDoneTime());
+}
+
+void CLI::cmdCrash(uint32_t argc, char* argv[])
+{
+    const CRASH_RECORD* r = Utils::Crash::GetLast();
+    uint32_t last;
+
+    if((argc > 1u) && (strcmp(argv[1],"clear") == 0))
+    {
+        Utils::Crash::Clear();
+        return;
+    }
+
+    Utils::Print("\r\ncrash : %lu since power on\r\n", Utils::Crash::GetCount());
+    if(r == NULL)
+        return;
+
+    Utils::Print(" cause %s, exception %lu, task %s, tick %lu\r\n", Utils::Crash::GetCauseName(r->CAUSE),
+           r->EXCEPTION, (r->TASK[0] != '\0') ? r->TASK : "-", r->TICK);
+    Utils::Print(" pc 0x%08lx lr 0x%08lx psr 0x%08lx sp 0x%08lx exc 0x%08lx\r\n", r->PC, r->LR, r->PSR, r->SP, r->EXC_RETURN);
+    Utils::Print(" r0 0x%08lx r1 0x%08lx r2 0x%08lx r3 0x%08lx r12 0x%08lx\r\n", r->R0, r->R1, r->R2, r->R3, r->R12);
+    Utils::Print(" cfsr 0x%08lx hfsr 0x%08lx mmfar 0x%08lx bfar 0x%08lx\r\n", r->CFSR, r->HFSR, r->MMFAR, r->BFAR);
+
+    // Cycles before the last record
+    last = (r->TRACES > 0u) ? r->TRACE[r->TRACES - 1u].CYCLES : 0u;
+    for(uint32_t i = 0u; i < r->TRACES; i++)
+        Utils::Print(" -%lu\ttype %u\tid %u\targ %u\r\n", last - r->TRACE[i].CYCLES,
+               r->TRACE[i].TYPE, r->TRACE[i].ID, r->TRACE[i].ARG);
+}
+
+void CLI::cmdWdog(uint32_t argc, char* argv[])
+{
+    Utils::Print("\r\nwatchdog %s, last reset %s\r\n", Utils::Watchdog::IsStarted() ? "running" : "stopped",
+           Utils::Watchdog::WasReset() ? "by watchdog" : "not by watchdog");
+
+    Utils::Print("#  Loop\t\t\tDeadline\tAge\r\n");
+    for(uint32_t i = 0; i < Utils::Watchdog::Count(); i++)
+        Utils::Print(" %-2lu %-16s\t%lu ms\t\t%lu ms\r\n", i, Utils::Watchdog::GetName(i),
+               Utils::Watchdog::GetDeadline(i), Utils::Watchdog::GetAge(i));
+}
+
+void CLI::cmdBattery(uint32_t argc, char* argv[])
+{
+    Battery* battery = Battery::GetInstance();
+
+    Utils::Print("\r\nbattery %.2f V (%s), limits x%.2f\r\n",
+           battery->GetVoltage(),
+           battery->IsPresent() ? "measured" : "absent",
+           this->pc->GetLimitScale());
+    Utils::Print(" linear %.3f m/s %.3f m/s2, angular %.3f rad/s %.3f rad/s2\r\n",
+           this->pc->GetLinearVelMax() * this->pc->GetLimitScale(),
+           this->pc->GetLinearAccMax() * this->pc->GetLimitScale(),
+           this->pc->GetAngularVelMax() * this->pc->GetLimitScale(),
+           this->pc->GetAngularAccMax() * this->pc->GetLimitScale());
+}
+
+void CLI::cmdMem(uint32_t argc, char* argv[])
+{
+    const Utils::Heap::STATS* heap;
+    const TASK_DEF* def;
+    TaskHandle_t task;
+    uint32_t stackFree;
+
+    // Stack never used since task creation (words)
+    Utils::Print("\r\n#  Task\t\t\tStack\tFree\tUsed\r\n");
+
+    for(uint32_t i = 0; i < TaskTable::TASK_MAX; i++)
+    {
+        task = TaskTable::GetHandle(static_cast<TaskTable::ID>(i));
+        if(task == NULL)
+            continue;
+
+        def = TaskTable::GetDef(static_cast<TaskTable::ID>(i));
+        stackFree = TaskTable::GetStackFree(static_cast<TaskTable::ID>(i));
+
+        Utils::Print(" %-2lu %-18s\t%u\t%lu\t%lu%%\r\n",
+               i,
+               pcTaskGetName(task),
+               def->STACK_SIZE,
+               stackFree,
+               ((def->STACK_SIZE - stackFree) * 100u) / def->STACK_SIZE);
+    }
+
+    // Heap (bytes), largest block : fragmentation
+    Utils::Print("\r\nHeap\t\tTotal\tFree\tMinFree\tLargest\r\n");
+    Utils::Print(" heap_4\t\t%u\t%u\t%u\t%u\r\n",
+           configTOTAL_HEAP_SIZE,
+           xPortGetFreeHeapSize(),
+           xPortGetMinimumEverFreeHeapSize(),
+           xPortGetLargestFreeBlockSize());
+
+    // Blocks through Utils::Heap by module (bytes, headers excluded)
+    Utils::Print("\r\nModule\t\tAllocs\tFrees\tUsed\tPeak\r\n");
+    for(uint32_t i = 0; (heap = Utils::Heap::Get(i)) != NULL; i++)
+        Utils::Print(" %-14s\t%lu\t%lu\t%lu\t%lu\r\n", heap->name, heap->allocs, heap->frees, heap->used, heap->peak);
+}
+
+void CLI::cmdRamFunc(uint32_t argc, char* argv[])
+{
+    const uint32_t* vectors = reinterpret_cast<const uint32_t*>(SCB->VTOR);
+    uint32_t start = reinterpret_cast<uintptr_t>(&_sramfunc);
+    uint32_t end = reinterpret_cast<uintptr_t>(&_eramfunc);
+    uint32_t handler;
+
+    Utils::Print("\r\nramfunc 0x%08lx - 0x%08lx : %lu bytes\r\n", start, end, end - start);
+
+    // Enabled interrupts only, Thumb bit cleared
+    Utils::Print("IRQ\tHandler\t\tFrom\r\n");
+    for(uint32_t irq = 0; irq <= static_cast<uint32_t>(FMPI2C1_ER_IRQn); irq++)
+    {
+        if((NVIC->ISER[irq >> 5] & (1ul << (irq & 31u))) == 0u)
+            continue;
+
+        handler = vectors[16u + irq] & ~1ul;
+        Utils::Print(" %lu\t0x%08lx\t%s\r\n", irq, handler, ((handler >= start) && (handler < end)) ? "sram" : "flash");
+    }
+}
+
+void CLI::cmdPower(uint32_t argc, char* argv[])
+{
+    uint64_t sleep;
+    uint64_t now;
+
+    if((argc > 1u) && (strcmp(argv[1],"on") == 0))
+        Power::SetEnable(true);
+    else if((argc > 1u) && (strcmp(argv[1],"off") == 0))
+        Power::SetEnable(false);
+
+    sleep = Power::GetSleepTime();
+    now = Utils::Clock::GetMicros64();
+
+    // Asleep share since boot
+    Utils::Print("\r\nsleep %s : %lu ms asleep, %lu%% of uptime\r\n",
+           Power::IsEnabled() ? "on" : "off",
+           static_cast<uint32_t>(sleep / 1000u),
+           (now > 0u) ? static_cast<uint32_t>((sleep * 100u) / now) : 0u);
+    Utils::Print(" sleeps %lu, tickless %lu, refused (moving) %lu\r\n",
+           Power::GetSleepCount(),
+           Power::GetTicklessCount(),
+           Power::GetTicklessVetoed());
+}
+
+void CLI::cmdTrace(uint32_t argc, char* argv[])
+{
+    if((argc > 1u) && (strcmp(argv[1],"start") == 0))
+    {
+        Utils::Trace::Start();
+    }
+    else if((argc > 1u) && (strcmp(argv[1],"stop") == 0))
+    {
+        Utils::Trace::Stop();
+    }
+    else if((argc > 1u) && (strcmp(argv[1],"dump") == 0))
+    {
+        this->diag->DumpTrace();
+        return;
+    }
+    else if((argc > 2u) && (strcmp(argv[1],"odo") == 0))
+    {
+        this->odometry->SetRecording(strcmp(argv[2],"on") == 0);
+    }
+    else if((argc > 1u) && (strcmp(argv[1],"replay") == 0))
+    {
+        robot_t r;
+        uint32_t count = this->odometry->ReplayTrace();
+
+        this->odometry->GetRobot(&r);
+
+        Utils::Print("\r\nreplay : %lu samples, X %ld mm, Y %ld mm, O %.3f deg", count, r.Xmm, r.Ymm, r.Odeg);
+        return;
+    }
+
+    Utils::Print("\r\ntrace %s : %lu records, %lu lost, odometry %s",
+           Utils::Trace::IsRunning() ? "running" : "stopped",
+           Utils::Trace::Count(),
+           Utils::Trace::GetLost(),
+           this->odometry->IsRecording() ? "recorded" : "not recorded");
+}
+
+void CLI::cmdDiag(uint32_t argc, char* argv[])
+{
+    const Diag::channel_t* def;
+    const Diag::channel_state_t* state;
+    int32_t c;
+
+    if(argc > 2u)
+    {
+        c = Diag::FindChannel(argv[1]);
+        if(c < 0)
+            Utils::Print("\r\ndiag : unknown channel %s", argv[1]);
+        else
+            this->diag->SetChannel(static_cast<uint32_t>(c), (strcmp(argv[2], "on") == 0),
+                                   static_cast<uint16_t>(_argInt(argc, argv, 3, 0)));
+    }
+
+    Utils::Print("\r\nChannel\tOn\tPeriod\tBeat\tPrio\tSent\tSame\tDropped\r\n");
+    for(uint32_t i = 0; (def = Diag::GetChannel(i)) != NULL; i++)
+    {
+        state = this->diag->GetChannelState(i);
+        Utils::Print(" %s\t%u\t%u\t%u\t%u\t%lu\t%lu\t%lu\r\n",
+               def->name,
+               state->enable,
+               state->period,
+               def->heartbeat,
+               def->priority,
+               state->sent,
+               state->unchanged,
+               state->dropped);
+    }
+    Utils::Print(" budget : %ld bytes", this->diag->GetBudget());
+}
+
+void CLI::cmdScope(uint32_t argc, char* argv[])
+{
+    static const char* states[] = {"idle", "armed", "triggered", "done"};
+    static const char* triggers[] = {"manual", "order", "rising", "falling", "above"};
+    static const uint32_t triggersCount = sizeof(triggers) / sizeof(triggers[0]);
+    const char* name;
+    bool ok = true;
+
+    if((argc > 3u) && (strcmp(argv[1],"ch") == 0))
+    {
+        ok = this->diag->SetScopeChannel(static_cast<uint32_t>(_argInt(argc, argv, 2, 0)), argv[3]);
+    }
+    else if((argc > 2u) && (strcmp(argv[1],"trig") == 0))
+    {
+        ok = false;
+        for(uint32_t t = 0; t < triggersCount; t++)
+        {
+            if(strcmp(argv[2], triggers[t]) == 0)
+                ok = Utils::Scope::SetTrigger(static_cast<Utils::Scope::TRIGGER>(t),
+                                              static_cast<uint32_t>(_argInt(argc, argv, 3, 0)),
+                                              _argFloat(argc, argv, 4, 0.0f));
+        }
+    }
+    else if((argc > 1u) && (strcmp(argv[1],"arm") == 0))
+    {
+        Utils::Scope::Arm(static_cast<uint32_t>(_argInt(argc, argv, 2, SCOPE_SAMPLES / 4u)));
+    }
+    else if((argc > 1u) && (strcmp(argv[1],"force") == 0))
+    {
+        Utils::Scope::Trigger(Utils::Scope::MANUAL);
+    }
+    else if((argc > 1u) && (strcmp(argv[1],"stop") == 0))
+    {
+        Utils::Scope::Stop();
+    }
+    else if((argc > 1u) && (strcmp(argv[1],"dump") == 0))
+    {
+        this->diag->DumpScope();
+        return;
+    }
+
+    if(!ok)
+        Utils::Print("\r\nscope : unknown channel, variable or trigger, or capture running");
+
+    Utils::Print("\r\nscope %s : trigger %s (ch %lu, level %.3f), %lu samples, trigger at %lu\r\n",
+           states[Utils::Scope::GetState()],
+           triggers[Utils::Scope::GetTrigger()],
+           Utils::Scope::GetTriggerChannel(),
+           Utils::Scope::GetTriggerLevel(),
+           Utils::Scope::Count(),
+           (Utils::Scope::Count() > 0u) ? Utils::Scope::GetTriggerIndex() : 0u);
+
+    for(uint32_t c = 0; c < SCOPE_CHANNELS; c++)
+        Utils::Print(" ch %lu\t%s\r\n", c, this->diag->GetScopeChannelName(c));
+
+    Utils::Print(" variables :");
+    for(uint32_t i = 0; (name = Diag::GetScopeProbeName(i)) != NULL; i++)
+        Utils::Print(" %s", name);
+}
+
+void CLI::cmdSwo(uint32_t argc, char* argv[])
+{
+    static const char* ports[SWO::PORT_MAX] = {"log", "telemetry", "trace"};
+    SWO* swo = SWO::GetInstance();
+
+    if(argc > 2u)
+    {
+        for(uint32_t p = 0; p < SWO::PORT_MAX; p++)
+        {
+            if(strcmp(argv[1], ports[p]) == 0)
+                swo->Enable(static_cast<SWO::PORT>(p), (strcmp(argv[2], "on") == 0));
+        }
+    }
+
+    // Printed on SWO if log port is routed
+    Utils::Print("\r\nswo");
+    for(uint32_t p = 0; p < SWO::PORT_MAX; p++)
+        Utils::Print(" %s:%s", ports[p], swo->IsEnabled(static_cast<SWO::PORT>(p)) ? "on" : "off");
+}
+
+void CLI::cmdSync(uint32_t argc, char* argv[])
+{
+    // Stamp first : line end to command delay is the sample error
+    uint32_t local = Utils::Clock::GetMicros();
+
+    if((argc > 1u) && (strcmp(argv[1],"reset") == 0))
+        Utils::ClockSync::Reset();
+    else if(argc > 1u)
+        Utils::ClockSync::Sample(strtoul(argv[1], NULL, 10), local);
+
+    Utils::Print("\r\nsync %s : time %lu us, offset %ld us, drift %.1f ppm, error %ld us (%lu samples, %lu rejected)",
+                 Utils::ClockSync::IsSynchronized() ? "locked" : "unlocked",
+                 Utils::ClockSync::ToMaster(local),
+                 Utils::ClockSync::GetOffset(),
+                 Utils::ClockSync::GetDrift(),
+                 Utils::ClockSync::GetError(),
+                 Utils::ClockSync::GetSamples(),
+                 Utils::ClockSync::GetRejects());
+}
+
+void CLI::cmdTune(uint32_t argc, char* argv[])
+{
+    static const char* states[] = {"idle", "running", "done", "failed"};
+    static const char* rules[Utils::RelayTuner::RULE_MAX] = {"zn", "some", "none"};
+    Utils::RelayTuner* tuner = this->pc->GetTuner();
+    PID_GAINS gains;
+
+    if((argc > 1u) && (strcmp(argv[1],"ang") == 0))
+    {
+        if(!this->pc->StartTuning(PositionControl::ANGULAR))
+            Utils::Print("\r\ntune : enable and stop the robot first");
+    }
+    else if((argc > 1u) && (strcmp(argv[1],"lin") == 0))
+    {
+        if(!this->pc->StartTuning(PositionControl::LINEAR))
+            Utils::Print("\r\ntune : enable and stop the robot first");
+    }
+    else if((argc > 1u) && (strcmp(argv[1],"stop") == 0))
+    {
+        this->pc->StopTuning();
+    }
+    else if((argc > 2u) && (strcmp(argv[1],"apply") == 0))
+    {
+        for(uint32_t r = 0; r < Utils::RelayTuner::RULE_MAX; r++)
+        {
+            if(strcmp(argv[2], rules[r]) == 0)
+            {
+                Utils::Print("\r\ntune apply %s : %s", rules[r],
+                       this->pc->ApplyTuning(static_cast<Utils::RelayTuner::RULE>(r)) ? "done (not saved, see config live)" : "failed");
+                return;
+            }
+        }
+    }
+
+    Utils::Print("\r\ntune %s %s : %lu cycles, Ku %.4f, Tu %.3f s\r\n",
+           (this->pc->GetTuningAxis() == PositionControl::ANGULAR) ? "ang" : "lin",
+           states[tuner->GetState()],
+           tuner->GetCycles(),
+           tuner->GetUltimateGain(),
+           tuner->GetUltimatePeriod());
+
+    if(tuner->GetState() == Utils::RelayTuner::DONE)
+    {
+        for(uint32_t r = 0; r < Utils::RelayTuner::RULE_MAX; r++)
+        {
+            gains = tuner->GetGains(static_cast<Utils::RelayTuner::RULE>(r));
+            Utils::Print(" %-4s\tkp %.4f\tki %.4f\tkd %.4f\r\n", rules[r], gains.kp, gains.ki, gains.kd);
+        }
+    }
+}
+
+void CLI::cmdCurve(uint32_t argc, char* argv[])
+{
+    float32_t x[TP_PATH_MAX];
+    float32_t y[TP_PATH_MAX];
+    uint32_t n = (argc - 1u) / 2u;
+
+    if(n > TP_PATH_MAX)
+        n = TP_PATH_MAX;
+
+    for(uint32_t i = 0; i < n; i++)
+    {
+        x[i] = _argFloat(argc, argv, 1u + 2u * i, 0.0);
+        y[i] = _argFloat(argc, argv, 2u + 2u * i, 0.0);
+    }
+
+    Utils::Print("\r\ncurve %lu points", n);
+    if(n > 0u)
+        tp->curveXY(x, y, n);
+}
+
+void CLI::cmdRoute(uint32_t argc, char* argv[])
+{
+    const ROUTE_DEF* route;
+
+    struct cmd_t cmd;
+
+    if(argc > 1u)
+    {
+        cmd.id = CMD_ID_ROUTE;
+        cmd.data.route = static_cast<uint32_t>(_argInt(argc, argv, 1, 0));
+        if(cmd.data.route >= Routes::Count())
+            Utils::Print("\r\nroute : unknown route");
+        else
+            _order(mc, &cmd);
+        return;
+    }
+
+    Utils::Print("\r\n#  Name\t\tStart\t\t\tLength\r\n");
+    for(uint32_t i = 0; i < Routes::Count(); i++)
+    {
+        route = Routes::Get(i);
+        Utils::Print(" %-2lu %-10s\t%.3f %.3f %.3f\t%.3f\r\n", i, route->NAME,
+               route->SAMPLES[0].x, route->SAMPLES[0].y, route->SAMPLES[0].heading,
+               route->SAMPLES[route->COUNT - 1u].s);
+    }
+}
+
+void CLI::cmdScript(uint32_t argc, char* argv[])
+{
+    const SCRIPT_DEF* script;
+
+    if((argc > 1u) && (strcmp(argv[1],"stop") == 0))
+    {
+        this->scripts->Abort();
+        return;
+    }
+
+    if(argc > 1u)
+    {
+        if(!this->scripts->Start(static_cast<uint32_t>(_argInt(argc, argv, 1, 0))))
+            Utils::Print("\r\nscript : unknown script or a script is running");
+        return;
+    }
+
+    Utils::Print("\r\n#  Name\t\tSteps\r\n");
+    for(uint32_t i = 0; i < Scripts::Count(); i++)
+    {
+        script = Scripts::Get(i);
+        Utils::Print(" %-2lu %-10s\t%lu\r\n", i, script->NAME, script->COUNT);
+    }
+    Utils::Print(" running : %s\r\n", this->scripts->IsRunning() ? "yes" : "no");
+}
+
+void CLI::cmdCalib(uint32_t argc, char* argv[])
+{
+    if((argc > 1u) && (strcmp(argv[1],"stop") == 0))
+    {
+        this->calibration->Abort();
+        return;
+    }
+
+    if(!mc->IsEnabled())
+    {
+        Utils::Print("\r\ncalib : enable motion control first");
+        return;
+    }
+
+    if(!this->calibration->Start(_argInt(argc, argv, 1, CALIB_SIDE_MM),
+                                 static_cast<uint32_t>(_argInt(argc, argv, 2, CALIB_RUNS)),
+                                 static_cast<uint32_t>(_argInt(argc, argv, 3, CALIB_TURNS))))
+        Utils::Print("\r\ncalib : invalid parameters or a calibration is running");
+}
+
+void CLI::cmdPcMode(uint32_t argc, char* argv[])
+{
+    if(argc > 1u)
+    {
+        if(!this->pc->SetStepMode(strcmp(argv[1], "step") == 0))
+            Utils::Print("\r\npcmode : stop the robot first");
+    }
+
+    Utils::Print("\r\npcmode %s\r\n", this->pc->IsStepMode() ? "step" : "vel");
+}
+
+void CLI::cmdPreset(uint32_t argc, char* argv[])
+{
+    uint32_t preset = this->pc->GetPreset();
+
+    if(argc > 1u)
+    {
+        preset = (strcmp(argv[1], "fast") == 0) ? PC_PRESET_FAST : PC_PRESET_NORMAL;
+
+        if(!this->pc->SelectPreset(preset))
+            Utils::Print("\r\npreset : command lost");
+    }
+
+    Utils::Print("\r\npreset %s\r\n", (preset == PC_PRESET_FAST) ? "fast" : "normal");
+}
+
+void CLI::cmdParam(uint32_t argc, char* argv[])
+{
+    if(argc > 2u)
+    {
+        if(!_setParam(argv[1], strtof(argv[2], NULL)))
+        {
+            Utils::Print("\r\nparam : unknown parameter or out of bounds");
+            return;
+        }
+    }
+
+    Utils::Print("\r\n#  Name\t\tValue\t\tMin\t\tMax\r\n");
+    for(uint32_t i = 0; i < Utils::Param::Count(); i++)
+    {
+        Utils::Print(" %-2lu %-10s\t%.4f\t\t%.4f\t\t%.4f\r\n",
+               i,
+               Utils::Param::GetName(i),
+               Utils::Param::GetValue(i),
+               Utils::Param::GetMin(i),
+               Utils::Param::GetMax(i));
+    }
+}
+
+void CLI::cmdPeek(uint32_t argc, char* argv[])
+{
+    char value[16];
+    int32_t index;
+
+    if(argc > 1u)
+    {
+        index = Utils::Watch::Find(argv[1]);
+        if(index < 0)
+        {
+            Utils::Print("\r\npeek : unknown variable %s", argv[1]);
+            return;
+        }
+
+        Utils::Watch::Format(static_cast<uint32_t>(index), value, sizeof(value));
+        Utils::Print("\r\n%s %s", argv[1], value);
+        return;
+    }
+
+    Utils::Print("\r\n#  Name\t\t\t\tValue\r\n");
+    for(uint32_t i = 0; i < Utils::Watch::Count(); i++)
+    {
+        Utils::Watch::Format(i, value, sizeof(value));
+        Utils::Print(" %-2lu %-28s\t%s%s\r\n",
+               i,
+               Utils::Watch::GetName(i),
+               value,
+               Utils::Watch::IsWritable(i) ? "\t(rw)" : "");
+    }
+}
+
+void CLI::cmdPoke(uint32_t argc, char* argv[])
+{
+    int32_t index;
+
+    if(argc < 3u)
+        return;
+
+    index = Utils::Watch::Find(argv[1]);
+    if((index < 0) || !Utils::Watch::Poke(static_cast<uint32_t>(index), strtof(argv[2], NULL)))
+        Utils::Print("\r\npoke : unknown or read only variable %s", argv[1]);
+}
+
+void CLI::cmdWatch(uint32_t argc, char* argv[])
+{
+    int32_t index;
+
+    if((argc > 1u) && (strcmp(argv[1],"off") == 0))
+    {
+        this->diag->SetChannel(Diag::TRACES_WATCH, false);
+        this->diag->ClearWatch();
+    }
+    else if(argc > 1u)
+    {
+        index = Utils::Watch::Find(argv[1]);
+        if((index < 0) || !this->diag->AddWatch(static_cast<uint32_t>(index)))
+        {
+            Utils::Print("\r\nwatch : unknown variable %s or %u already watched", argv[1], DIAG_WATCH_MAX);
+            return;
+        }
+
+        this->diag->SetChannel(Diag::TRACES_WATCH, true, static_cast<uint16_t>(_argInt(argc, argv, 2, 0)));
+    }
+
+    Utils::Print("\r\nwatch %s, %u ms :",
+           this->diag->GetChannelState(Diag::TRACES_WATCH)->enable ? "on" : "off",
+           this->diag->GetChannelState(Diag::TRACES_WATCH)->period);
+    for(uint32_t i = 0; i < DIAG_WATCH_MAX; i++)
+    {
+        index = this->diag->GetWatch(i);
+        if(index >= 0)
+            Utils::Print(" %s", Utils::Watch::GetName(static_cast<uint32_t>(index)));
+    }
+}
+
+void CLI::cmdConfig(uint32_t argc, char* argv[])
+{
+    int32_t index;
+
+    if((argc > 3u) && (strcmp(argv[1],"set") == 0))
+    {
+        index = Config::Find(argv[2]);
+        if(index < 0)
+        {
+            Utils::Print("\r\nconfig : unknown parameter %s", argv[2]);
+            return;
+        }
+        Config::Set(static_cast<uint32_t>(index), strtod(argv[3], NULL));
+    }
+    else if((argc > 1u) && (strcmp(argv[1],"default") == 0))
+    {
+        Config::Default();
+    }
+    else if((argc > 1u) && (strcmp(argv[1],"live") == 0))
+    {
+        Config::Capture();
+    }
+    else if((argc > 1u) && (strcmp(argv[1],"save") == 0))
+    {
+        // Flash erase stalls the CPU
+        if(mc->IsEnabled())
+        {
+            Utils::Print("\r\nconfig : disable motion control first");
+            return;
+        }
+
+        Utils::Print("\r\nconfig save %s", Config::Commit() ? "done, applied at next reset" : "failed");
+        return;
+    }
+
+    Utils::Print("\r\nconfig #%lu%s\r\n", Config::GetSequence(), Config::IsModified() ? " (modified, not saved)" : "");
+    for(uint32_t i = 0; i < Config::Count(); i++)
+        Utils::Print(" %-10s\t%.6f\r\n", Config::GetName(i), Config::GetValue(i));
+}
+
+void CLI::cmdMcTest(uint32_t argc, char* argv[])
+{
+    struct cmd_t path[4];
+
+    memset(path, 0, sizeof(path));
+
+    path[0].id = CMD_ID_GOLIN;
+    path[0].data.d = 0.5f;
+    path[1].id = CMD_ID_GOANG;
+    path[1].data.a = _PI_;
+    path[2].id = CMD_ID_GOLIN;
+    path[2].data.d = 1.0f;
+    path[3].id = CMD_ID_GOANG;
+    path[3].data.a = 0.0f;
+
+    Utils::Print("\r\ntest");
+    mc->PushPath(path, 4);
+}
+
+void CLI::cmdKi(uint32_t argc, char* argv[])
+{
+    float kp = _argFloat(argc, argv, 1, 0.0);
+
+    Utils::Print("\r\nkp %.3f", kp);
+}
+
+void CLI::CpuStats()
+{
+    TaskStatus_t *tasks;
+    UBaseType_t count = 0;
+    uint32_t totalRunTime = 0;
+    Utils::Profiler *p;
+
+    // Tasks run time (OS stats, us)
+    count = uxTaskGetNumberOfTasks();
+    tasks = (TaskStatus_t*)Utils::Heap::Alloc(count * sizeof(TaskStatus_t));
+
+    Utils::Print("\r\nTask\t\tTime(us)\tLoad(%%)\tStack\r\n");
+
+    if(tasks != NULL)
+    {
+        count = uxTaskGetSystemState(tasks, count, &totalRunTime);
+        totalRunTime /= 100u;
+
+        for(UBaseType_t t = 0; t < count; t++)
+        {
+            Utils::Print(" %-10s\t%lu\t%lu\t%u\r\n",
+                   tasks[t].pcTaskName,
+                   tasks[t].ulRunTimeCounter,
+                   (totalRunTime > 0) ? (tasks[t].ulRunTimeCounter / totalRunTime) : 0,
+                   tasks[t].usStackHighWaterMark);
+        }
+
+        Utils::Heap::Free(tasks);
+    }
+
+    // Loops execution time (us)
+    Utils::Print("#  Loop/IRQ\t\tMin\tAvg\tMax\tCount\r\n");
+
+    for(uint32_t i = 0; i < Utils::Profiler::Count(); i++)
+    {
+        p = Utils::Profiler::Get(i);
+        Utils::Print(" %-2lu %-18s\t%lu\t%lu\t%lu\t%lu\r\n",
+               i,
+               p->GetName(),
+               Utils::Profiler::CyclesToUs(p->GetMin()),
+               Utils::Profiler::CyclesToUs(p->GetAverage()),
+               Utils::Profiler::CyclesToUs(p->GetMax()),
+               p->GetCount());
+    }
+}
+
+void CLI::CpuHistogram(uint32_t index)
+{
+    Utils::Profiler *p = Utils::Profiler::Get(index);
+
+    if(p == NULL)
+    {
+        Utils::Print("\r\nBad profiler!!");
+        return;
+    }
+
+    Utils::Print("\r\n%s (us):\r\n", p->GetName());
+    Utils::Print(" <1      \t%lu\r\n", p->GetHistogram(0));
+
+    for(uint32_t bin = 1; bin < (PROFILER_HISTOGRAM_SIZE - 1u); bin++)
+        Utils::Print(" %lu-%lu   \t%lu\r\n", (1ul << (bin - 1u)), (1ul << bin) - 1u, p->GetHistogram(bin));
+
+    Utils::Print(" >=%lu   \t%lu\r\n", (1ul << (PROFILER_HISTOGRAM_SIZE - 2u)), p->GetHistogram(PROFILER_HISTOGRAM_SIZE - 1u));
+}
+
+void CLI::SchedStats()
+{
+    Utils::PeriodicTask *t;
+
+    // Actual periods, jitter and wake up latency (us)
+    Utils::Print("\r\n#  Loop\t\t\tPeriod\tMin\tMax\tJitter\tLatency\tMissed\tCount\r\n");
+
+    for(uint32_t i = 0; i < Utils::PeriodicTask::Count(); i++)
+    {
+        t = Utils::PeriodicTask::Get(i);
+        Utils::Print(" %-2lu %-18s\t%lu\t%lu\t%lu\t%lu\t%lu\t%lu\t%lu\r\n",
+               i,
+               t->GetName(),
+               t->GetPeriod() * 1000u,
+               t->GetPeriodMin(),
+               t->GetPeriodMax(),
+               t->GetJitterMax(),
+               t->GetLatencyMax(),
+               t->GetMissed(),
+               t->GetCount());
+    }
+}
+
+void CLI::SchedHistogram(uint32_t index)
+{
+    Utils::PeriodicTask *t = Utils::PeriodicTask::Get(index);
+
+    if(t == NULL)
+    {
+        Utils::Print("\r\nBad loop!!");
+        return;
+    }
+
+    Utils::Print("\r\n%s jitter (us):\r\n", t->GetName());
+    Utils::Print(" <1      \t%lu\r\n", t->GetHistogram(0));
+
+    for(uint32_t bin = 1; bin < (PERIODIC_HISTOGRAM_SIZE - 1u); bin++)
+        Utils::Print(" %lu-%lu   \t%lu\r\n", (1ul << (bin - 1u)), (1ul << bin) - 1u, t->GetHistogram(bin));
+
+    Utils::Print(" >=%lu   \t%lu\r\n", (1ul << (PERIODIC_HISTOGRAM_SIZE - 2u)), t->GetHistogram(PERIODIC_HISTOGRAM_SIZE - 1u));
+}
+
+void CLI::taskHandler (void* obj)
+{
+    CLI* instance = _cli;
+    TickType_t prevTick = 0u,  tick = 0u;
+
+    float32_t period = 0.0f;
+
+    // 0. Delay
+    vTaskDelay(pdMS_TO_TICKS(1000u));
+
+    instance->Start();
 
-    // 2. Get tick count
+    // 1. Get tick count
     prevTick = xTaskGetTickCount();
 
     while(1)
     {
-        // 2. Wait until period elapse
-        vTaskDelayUntil(&xLastWakeTime, xFrequency);
+        // 2. Sleep until bytes are received
+        if(instance->serial->WaitForData(portMAX_DELAY) == false)
+            continue;
 
         // 3. Get tick
         tick = xTaskGetTickCount();
@@ -0,0 +1,473 @@
+/**
+ * @file    Config.cpp
+ * @author  Jeremy ROULLAND
+ * @date    22 oct. 2017
+ * @brief   Non volatile configuration
+ */
+
+#include "Config.hpp"
+#include "Frame.hpp"
+#include "Flash.hpp"
+#include "Param.hpp"
+#include "Robot.hpp"
+
+// FreeRTOS
+#include "FreeRTOS.h"
+#include "task.h"
+
+#include <stddef.h>
+#include <string.h>
+
+using namespace HAL;
+
+/*----------------------------------------------------------------------------*/
+/* Definitions                                                                */
+/*----------------------------------------------------------------------------*/
+
+// PositionControl defaults
+//#define DEFAULT_ANGULAR_VEL_MAX       (0.314f)    /* Low (OK) */
+#define DEFAULT_ANGULAR_VEL_MAX         (3.28f)     /* Hight (OK) */
+//#define DEFAULT_ANGULAR_VEL_MAX       (12.0f)
+//#define DEFAULT_ANGULAR_ACC_MAX       (0.314f)    /* Low (OK) */
+#define DEFAULT_ANGULAR_ACC_MAX         (3.14f)     /* Hight (OK) */
+//#define DEFAULT_ANGULAR_ACC_MAX       (18.0f)
+
+//#define DEFAULT_LINEAR_VEL_MAX        (0.04f)     /* Low (OK) */
+//#define DEFAULT_LINEAR_VEL_MAX        (0.4f)      /* Hight (OK) */
+//#define DEFAULT_LINEAR_VEL_MAX        (0.468f)
+#define DEFAULT_LINEAR_VEL_MAX          (0.200f)
+//#define DEFAULT_LINEAR_VEL_MAX        (1.0f)
+//#define DEFAULT_LINEAR_ACC_MAX        (0.05f)     /* Low (OK) */
+//#define DEFAULT_LINEAR_ACC_MAX        (0.5f)      /* Hight (OK) */
+#define DEFAULT_LINEAR_ACC_MAX          (0.2f)
+
+#define DEFAULT_ANGULAR_KP              (0.314f)
+#define DEFAULT_ANGULAR_KI              (0.03f)
+#define DEFAULT_ANGULAR_KD              (0.0f)
+
+#define DEFAULT_LINEAR_KP               (0.5f)
+#define DEFAULT_LINEAR_KI               (0.0f)
+#define DEFAULT_LINEAR_KD               (0.0f)
+
+// PositionControl fast preset defaults (same gains)
+#define DEFAULT_FAST_ANGULAR_VEL_MAX    (12.0f)
+#define DEFAULT_FAST_ANGULAR_ACC_MAX    (18.0f)
+#define DEFAULT_FAST_LINEAR_VEL_MAX     (1.0f)
+#define DEFAULT_FAST_LINEAR_ACC_MAX     (2.0f)
+
+// Odometry defaults
+#define DEFAULT_TICK_BY_MM              (Robot::Config::TICK_BY_MM)
+#define DEFAULT_ADW_TICK                (Robot::Config::ADW_TICK)
+#define DEFAULT_WHEEL_RATIO             (Robot::Config::WHEEL_RATIO)
+
+// Cylinder defaults
+#define DEFAULT_CYL0_RATIO              ((5.89f*400.0f)/10u)    // NbStep pour 1 tour barillet (10 index)
+
+// Link defaults
+#define DEFAULT_BOARD_ADDRESS           (0.0f)
+
+// Wheel steppers defaults (no resonance band)
+#define DEFAULT_WHEEL_BAND_LOW          (0.0f)
+#define DEFAULT_WHEEL_BAND_HIGH         (0.0f)
+
+// Records
+#define CONFIG_MAGIC                    (0xC0F16DA7u)
+#define CONFIG_BLANK                    (0xFFFFFFFFu)
+#define CONFIG_RECORD_WORDS             (sizeof(CONFIG_RECORD) / sizeof(uint32_t))
+#define CONFIG_BANKS                    (2u)
+
+/**
+ * @brief Flash record (magic is programmed last)
+ */
+typedef struct
+{
+    uint32_t    magic;
+    uint16_t    version;
+    uint16_t    size;           /**< sizeof(CONFIG_DATA) */
+    uint32_t    sequence;       /**< Commit number, highest is current */
+    uint32_t    crc;            /**< CRC16 of sequence and data */
+    CONFIG_DATA data;
+}CONFIG_RECORD;
+
+static_assert((sizeof(CONFIG_RECORD) % sizeof(uint32_t)) == 0u, "CONFIG_RECORD must be programmed by words");
+
+/**
+ * @brief Parameter definition
+ */
+typedef struct
+{
+    const char* NAME;
+    uint16_t    FIELD;          /**< offsetof(CONFIG_DATA, ...) */
+    bool        DOUBLE;         /**< float64_t field, else float32_t */
+}CONFIG_PARAM;
+
+/*----------------------------------------------------------------------------*/
+/* Private Members                                                            */
+/*----------------------------------------------------------------------------*/
+
+/**
+ * @brief Default configuration
+ */
+static const CONFIG_DATA _defaults =
+{
+    DEFAULT_ANGULAR_VEL_MAX,
+    DEFAULT_ANGULAR_ACC_MAX,
+    DEFAULT_LINEAR_VEL_MAX,
+    DEFAULT_LINEAR_ACC_MAX,
+    DEFAULT_ANGULAR_KP,
+    DEFAULT_ANGULAR_KI,
+    DEFAULT_ANGULAR_KD,
+    DEFAULT_LINEAR_KP,
+    DEFAULT_LINEAR_KI,
+    DEFAULT_LINEAR_KD,
+    DEFAULT_FAST_ANGULAR_VEL_MAX,
+    DEFAULT_FAST_ANGULAR_ACC_MAX,
+    DEFAULT_FAST_LINEAR_VEL_MAX,
+    DEFAULT_FAST_LINEAR_ACC_MAX,
+    DEFAULT_ANGULAR_KP,
+    DEFAULT_ANGULAR_KI,
+    DEFAULT_ANGULAR_KD,
+    DEFAULT_LINEAR_KP,
+    DEFAULT_LINEAR_KI,
+    DEFAULT_LINEAR_KD,
+    DEFAULT_TICK_BY_MM,
+    DEFAULT_ADW_TICK,
+    DEFAULT_WHEEL_RATIO,
+    DEFAULT_CYL0_RATIO,
+    DEFAULT_BOARD_ADDRESS,
+    DEFAULT_WHEEL_BAND_LOW,
+    DEFAULT_WHEEL_BAND_HIGH,
+};
+
+/**
+ * @brief Editable parameters, in CONFIG_DATA order
+ */
+static const CONFIG_PARAM _params[] =
+{
+    {"angvelmax",   offsetof(CONFIG_DATA, angularVelMax),   false},
+    {"angaccmax",   offsetof(CONFIG_DATA, angularAccMax),   false},
+    {"linvelmax",   offsetof(CONFIG_DATA, linearVelMax),    false},
+    {"linaccmax",   offsetof(CONFIG_DATA, linearAccMax),    false},
+    {"angkp",       offsetof(CONFIG_DATA, angularKp),       false},
+    {"angki",       offsetof(CONFIG_DATA, angularKi),       false},
+    {"angkd",       offsetof(CONFIG_DATA, angularKd),       false},
+    {"linkp",       offsetof(CONFIG_DATA, linearKp),        false},
+    {"linki",       offsetof(CONFIG_DATA, linearKi),        false},
+    {"linkd",       offsetof(CONFIG_DATA, linearKd),        false},
+    {"fangvelmax",  offsetof(CONFIG_DATA, fastAngularVelMax), false},
+    {"fangaccmax",  offsetof(CONFIG_DATA, fastAngularAccMax), false},
+    {"flinvelmax",  offsetof(CONFIG_DATA, fastLinearVelMax),  false},
+    {"flinaccmax",  offsetof(CONFIG_DATA, fastLinearAccMax),  false},
+    {"fangkp",      offsetof(CONFIG_DATA, fastAngularKp),     false},
+    {"fangki",      offsetof(CONFIG_DATA, fastAngularKi),     false},
+    {"fangkd",      offsetof(CONFIG_DATA, fastAngularKd),     false},
+    {"flinkp",      offsetof(CONFIG_DATA, fastLinearKp),      false},
+    {"flinki",      offsetof(CONFIG_DATA, fastLinearKi),      false},
+    {"flinkd",      offsetof(CONFIG_DATA, fastLinearKd),      false},
+    {"tickbymm",    offsetof(CONFIG_DATA, tickByMm),        true},
+    {"adwtick",     offsetof(CONFIG_DATA, adwTick),         true},
+    {"wheelratio",  offsetof(CONFIG_DATA, wheelRatio),      true},
+    {"cyl0ratio",   offsetof(CONFIG_DATA, cylinder0Ratio),  false},
+    {"board",       offsetof(CONFIG_DATA, boardAddress),    false},
+    {"wbandlow",    offsetof(CONFIG_DATA, wheelBandLow),    false},
+    {"wbandhigh",   offsetof(CONFIG_DATA, wheelBandHigh),   false},
+};
+
+static const uint32_t _paramsCount = sizeof(_params) / sizeof(_params[0]);
+
+/**
+ * @brief Current configuration (flash record or defaults) and record
+ */
+static const CONFIG_DATA* _data = NULL;
+static const CONFIG_RECORD* _record = NULL;
+
+/**
+ * @brief Bank of the current record and first free slot of each bank
+ */
+static uint32_t _bank = 0u;
+static uint32_t _free[CONFIG_BANKS] = {0u};
+
+/**
+ * @brief Edit copy
+ */
+static CONFIG_DATA _edit;
+static bool _edited = false;
+
+/*----------------------------------------------------------------------------*/
+/* Private Functions                                                          */
+/*----------------------------------------------------------------------------*/
+
+static Flash* _getBank (uint32_t bank)
+{
+    return Flash::GetInstance((bank == 0u) ? Flash::CONFIG0 : Flash::CONFIG1);
+}
+
+static uint32_t _getSlots (uint32_t bank)
+{
+    return _getBank(bank)->GetSize() / sizeof(CONFIG_RECORD);
+}
+
+static uint16_t _computeCrc (const CONFIG_RECORD* record)
+{
+    uint16_t crc;
+
+    crc = Utils::Crc16(reinterpret_cast<const uint8_t*>(&record->sequence), sizeof(record->sequence));
+    crc = Utils::Crc16(reinterpret_cast<const uint8_t*>(&record->data), sizeof(record->data), crc);
+
+    return crc;
+}
+
+static bool _isBlank (const CONFIG_RECORD* record)
+{
+    const uint32_t* words = reinterpret_cast<const uint32_t*>(record);
+
+    for(uint32_t i = 0u; i < CONFIG_RECORD_WORDS; i++)
+    {
+        if(words[i] != CONFIG_BLANK)
+            return false;
+    }
+
+    return true;
+}
+
+static bool _isValid (const CONFIG_RECORD* record)
+{
+    return (record->magic == CONFIG_MAGIC) &&
+           (record->version == CONFIG_VERSION) &&
+           (record->size == sizeof(CONFIG_DATA)) &&
+           (record->crc == _computeCrc(record));
+}
+
+/**
+ * @brief Find last valid record and first free slot of a bank
+ * @param bank : Bank index
+ * @param free : First free slot (slots count if full)
+ * @return Record or NULL
+ */
+static const CONFIG_RECORD* _scanBank (uint32_t bank, uint32_t* free)
+{
+    const CONFIG_RECORD* slots = reinterpret_cast<const CONFIG_RECORD*>(_getBank(bank)->GetAddress());
+    const CONFIG_RECORD* last = NULL;
+    uint32_t count = _getSlots(bank);
+    uint32_t i;
+
+    // Slots are written in order, an interrupted commit leaves an invalid slot
+    for(i = 0u; (i < count) && !_isBlank(&slots[i]); i++)
+    {
+        if(_isValid(&slots[i]))
+            last = &slots[i];
+    }
+
+    *free = i;
+
+    return last;
+}
+
+static void _load ()
+{
+    const CONFIG_RECORD* record;
+
+    _record = NULL;
+    _bank = 0u;
+
+    for(uint32_t b = 0u; b < CONFIG_BANKS; b++)
+    {
+        record = _scanBank(b, &_free[b]);
+
+        if((record != NULL) && ((_record == NULL) || (record->sequence > _record->sequence)))
+        {
+            _record = record;
+            _bank = b;
+        }
+    }
+
+    _data = (_record != NULL) ? &_record->data : &_defaults;
+}
+
+static void* _getField (CONFIG_DATA* data, uint32_t index)
+{
+    return reinterpret_cast<uint8_t*>(data) + _params[index].FIELD;
+}
+
+/*----------------------------------------------------------------------------*/
+/* Class Implementation                                                       */
+/*----------------------------------------------------------------------------*/
+
+const CONFIG_DATA* Config::Get ()
+{
+    // First call from init (before scheduler start)
+    if(_data == NULL)
+        _load();
+
+    return _data;
+}
+
+uint32_t Config::Count ()
+{
+    return _paramsCount;
+}
+
+const char* Config::GetName (uint32_t index)
+{
+    return (index < _paramsCount) ? _params[index].NAME : NULL;
+}
+
+int32_t Config::Find (const char* name)
+{
+    for(uint32_t i = 0u; i < _paramsCount; i++)
+    {
+        if(strcmp(name, _params[i].NAME) == 0)
+            return static_cast<int32_t>(i);
+    }
+
+    return -1;
+}
+
+float64_t Config::GetValue (uint32_t index)
+{
+    CONFIG_DATA data;
+    float32_t f;
+    float64_t d;
+
+    if(index >= _paramsCount)
+        return 0.0;
+
+    taskENTER_CRITICAL();
+    data = _edited ? _edit : *Config::Get();
+    taskEXIT_CRITICAL();
+
+    if(_params[index].DOUBLE)
+    {
+        memcpy(&d, _getField(&data, index), sizeof(d));
+        return d;
+    }
+    else
+    {
+        memcpy(&f, _getField(&data, index), sizeof(f));
+        return static_cast<float64_t>(f);
+    }
+}
+
+bool Config::Set (uint32_t index, float64_t value)
+{
+    float32_t f = static_cast<float32_t>(value);
+
+    if(index >= _paramsCount)
+        return false;
+
+    taskENTER_CRITICAL();
+
+    if(!_edited)
+    {
+        _edit = *Config::Get();
+        _edited = true;
+    }
+
+    if(_params[index].DOUBLE)
+        memcpy(_getField(&_edit, index), &value, sizeof(value));
+    else
+        memcpy(_getField(&_edit, index), &f, sizeof(f));
+
+    taskEXIT_CRITICAL();
+
+    return true;
+}
+
+void Config::Default ()
+{
+    taskENTER_CRITICAL();
+    _edit = _defaults;
+    _edited = true;
+    taskEXIT_CRITICAL();
+}
+
+uint32_t Config::Capture ()
+{
+    uint32_t count = 0u;
+    int32_t index;
+
+    for(uint32_t i = 0u; i < _paramsCount; i++)
+    {
+        index = Utils::Param::Find(_params[i].NAME);
+        if(index >= 0)
+        {
+            Config::Set(i, Utils::Param::GetValue(static_cast<uint32_t>(index)));
+            count++;
+        }
+    }
+
+    return count;
+}
+
+bool Config::IsModified ()
+{
+    bool modified;
+
+    taskENTER_CRITICAL();
+    modified = _edited && (memcmp(&_edit, Config::Get(), sizeof(CONFIG_DATA)) != 0);
+    taskEXIT_CRITICAL();
+
+    return modified;
+}
+
+bool Config::Commit ()
+{
+    CONFIG_RECORD record;
+    const uint32_t* words = reinterpret_cast<const uint32_t*>(&record);
+    uint32_t bank, slot;
+    bool success = true;
+
+    memset(&record, 0, sizeof(record));
+
+    taskENTER_CRITICAL();
+    record.data = _edited ? _edit : *Config::Get();
+    taskEXIT_CRITICAL();
+
+    record.magic    = CONFIG_MAGIC;
+    record.version  = CONFIG_VERSION;
+    record.size     = sizeof(CONFIG_DATA);
+    record.sequence = Config::GetSequence() + 1u;
+    record.crc      = _computeCrc(&record);
+
+    // CPU stalls on flash anyway, serializes commits and keeps readers off the bank
+    vTaskSuspendAll();
+
+    bank = _bank;
+    slot = _free[bank];
+
+    // Bank full : current record stays valid until written in the other bank
+    if(slot >= _getSlots(bank))
+    {
+        bank ^= 1u;
+        slot = 0u;
+        success = _getBank(bank)->Erase();
+        _free[bank] = 0u;
+    }
+
+    if(success)
+    {
+        // Magic last : an interrupted commit is an invalid record
+        success = _getBank(bank)->Program((slot * sizeof(CONFIG_RECORD)) + sizeof(uint32_t), &words[1], CONFIG_RECORD_WORDS - 1u) &&
+                  _getBank(bank)->Program(slot * sizeof(CONFIG_RECORD), &words[0], 1u);
+        _free[bank] = slot + 1u;
+    }
+
+    if(success)
+    {
+        _record = reinterpret_cast<const CONFIG_RECORD*>(_getBank(bank)->GetAddress()) + slot;
+        _data = &_record->data;
+        _bank = bank;
+        _edited = false;
+    }
+
+    xTaskResumeAll();
+
+    return success;
+}
+
+uint32_t Config::GetSequence ()
+{
+    Config::Get();
+
+    return (_record != NULL) ? _record->sequence : 0u;
+}
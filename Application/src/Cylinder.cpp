@@ -6,9 +6,15 @@
  */
 
 #include <stddef.h>
+#include <stdlib.h>
+#include <math.h>
 #include "Cylinder.hpp"
+#include "StaticStorage.hpp"
+#include "Config.hpp"
+#include "Robot.hpp"
+#include "Battery.hpp"
+#include "Retain.hpp"
 
-#include "FreeRTOS.h"
 #include "task.h"
 
 
@@ -17,8 +23,7 @@
 /*----------------------------------------------------------------------------*/
 
 // CYLINDER BOTTOM
-#define CYL0_MOTOR      (HAL::Drv8813::ID::DRV8813_2)
-//#define CYL0_MOTOR      (HAL::Drv8813::ID::DRV8813_1)
+#define CYL0_MOTOR      (Robot::Config::CYL0_MOTOR)
 #define CYL0_MOTORRISE  (HAL::Drv8813::ID::DRV8813_5)
 #define CYL0_MOTOROPEN1 (HAL::PWM::PWM14)
 #define CYL0_MOTOROPEN2 (HAL::PWM::PWM15)
@@ -26,18 +31,27 @@
 #define CYL0_SHORTPATH  (true)
 #define CYL0_CANRISE    (true)
 #define CYL0_INDEX_MAX  (9u)
-#define CYL0_RATIO      ((5.89f*400.0f)/(CYL0_INDEX_MAX+1u))   // NbStep pour 1 tour barillet
+#define CYL0_RATIO      (Config::Get()->cylinder0Ratio)         // NbStep pour 1 tour barillet / (CYL0_INDEX_MAX+1)
 #define CYL0_SPEED      (200u)          // Step/sec
+#define CYL0_ACCEL      (800u)          // Step/sec^2
 
 // CYLINDER TOP
-#define CYL1_MOTOR      (HAL::Drv8813::ID::DRV8813_3)
-//#define CYL1_MOTOR      (HAL::Drv8813::ID::DRV8813_1)
+#define CYL1_MOTOR      (Robot::Config::CYL1_MOTOR)
 #define CYL1_TOPZ       (HAL::GPIO::ID::GPIO58)
 #define CYL1_INDEX_MAX   (5u)
 #define CYL1_SHORTPATH  (false)
 #define CYL1_CANRISE    (false)
 #define CYL1_RATIO      ((2.49f*400.0f)/(CYL1_INDEX_MAX+1u))   // NbStep pour 1 tour barillet
 #define CYL1_SPEED      (100u)      // Step/sec
+#define CYL1_ACCEL      (400u)      // Step/sec^2
+
+// Rise motor
+#define CYL_RISE_SPEED  (200u)      // Step/sec
+#define CYL_RISE_ACCEL  (800u)      // Step/sec^2
+#define CYL_RISE_STEPS  (10u*200u)
+
+// Open motor
+#define CYL_OPEN_MS     (1000u)
 
 
 /*----------------------------------------------------------------------------*/
@@ -45,11 +59,46 @@
 /*----------------------------------------------------------------------------*/
 
 Cylinder* _cylinder[Cylinder::CYLINDER_MAX] = {NULL};
+static Utils::StaticStorage<Cylinder, Cylinder::CYLINDER_MAX> _cylinderStorage;
 
 /*----------------------------------------------------------------------------*/
 /* Private Functions                                                          */
 /*----------------------------------------------------------------------------*/
 
+/**
+ * @brief Cylinders definitions (flash), indexed by Cylinder ID
+ */
+static const CYL_DEF _cylDefs[Cylinder::CYLINDER_MAX] =
+{
+	// CYLINDER0
+	{
+		CYL0_MOTOR,								// ID_motor
+		CYL0_MOTORRISE,							// ID_motorRise
+		{CYL0_MOTOROPEN1, CYL0_MOTOROPEN2},		// ID_motorOpen
+		CYL0_TOPZ,								// ID_topz
+		CYL0_INDEX_MAX,							// indexMax
+		CYL0_SHORTPATH,							// shortPath
+		CYL0_CANRISE,							// canRise
+		0.0f,									// ratio (Config, see _getCylStruct())
+		CYL0_SPEED,								// speed
+		CYL0_ACCEL,								// accel
+	},
+
+	// CYLINDER1
+	{
+		CYL1_MOTOR,			// ID_motor
+		{},					// ID_motorRise
+		{},					// ID_motorOpen
+		CYL1_TOPZ,			// ID_topz
+		CYL1_INDEX_MAX,		// indexMax
+		CYL1_SHORTPATH,		// shortPath
+		CYL1_CANRISE,		// canRise
+		CYL1_RATIO,			// ratio
+		CYL1_SPEED,			// speed
+		CYL1_ACCEL,			// accel
+	},
+};
+
 /**
  * @brief Retrieve Encoder definitions from Encoder ID
  * @param id : Encoder ID
@@ -57,40 +106,60 @@ Cylinder* _cylinder[Cylinder::CYLINDER_MAX] = {NULL};
  */
 static CYL_DEF _getCylStruct (enum Cylinder::ID id)
 {
-    CYL_DEF cyl;
+	CYL_DEF cyl;
 
 	assert(id < Cylinder::CYLINDER_MAX);
 
-    switch(id)
-    {
-    case Cylinder::ID::CYLINDER0:
-        cyl.ID_motor        = CYL0_MOTOR;
-        cyl.ID_motorRise    = CYL0_MOTORRISE;
-        cyl.ID_motorOpen[0] = CYL0_MOTOROPEN1;
-        cyl.ID_motorOpen[1] = CYL0_MOTOROPEN2;
-        cyl.ID_topz         = CYL0_TOPZ;
-        cyl.indexMax        = CYL0_INDEX_MAX;
-        cyl.shortPath       = CYL0_SHORTPATH;
-        cyl.canRise         = CYL0_CANRISE;
-        cyl.ratio           = CYL0_RATIO;
-        cyl.speed           = CYL0_SPEED;
-        break;
+	cyl = _cylDefs[id];
 
-    case Cylinder::ID::CYLINDER1:
-        cyl.ID_motor     = CYL1_MOTOR;
-        cyl.ID_topz      = CYL1_TOPZ;
-        cyl.indexMax     = CYL1_INDEX_MAX;
-        cyl.shortPath    = CYL1_SHORTPATH;
-        cyl.canRise      = CYL1_CANRISE;
-        cyl.ratio        = CYL1_RATIO;
-        cyl.speed        = CYL1_SPEED;
-        break;
+	// Barrel ratio is a parameter, read when the cylinder is created
+	if(id == Cylinder::ID::CYLINDER0)
+		cyl.ratio = CYL0_RATIO;
 
-    default:
-        break;
-    }
+	return cyl;
+}
+
+/**
+ * @brief Ramp speed or acceleration scaled by battery voltage (see Battery)
+ * @param value : Worst case value (step/s or step/s^2)
+ */
+static uint32_t _batteryScaled (uint32_t value)
+{
+    return static_cast<uint32_t>(static_cast<float32_t>(value) * Battery::GetInstance()->GetScale());
+}
+
+
+/**
+ * @brief topz state changed event (interrupt context)
+ * @param obj : Cylinder instance
+ */
+static void _topzEvent (void* obj)
+{
+    Cylinder* cyl = reinterpret_cast<Cylinder*>(obj);
+
+    cyl->INTERNAL_TopzChanged();
+}
+
+/**
+ * @brief Motor move finished event (interrupt context)
+ * @param obj : Cylinder instance
+ */
+static void _moveFinishedEvent (void* obj)
+{
+    Cylinder* cyl = reinterpret_cast<Cylinder*>(obj);
+
+    cyl->MotionFinished();
+}
+
+/**
+ * @brief Rotation motor stall event (interrupt context)
+ * @param obj : Cylinder instance
+ */
+static void _motorStalledEvent (void* obj)
+{
+    Cylinder* cyl = reinterpret_cast<Cylinder*>(obj);
 
-    return cyl;
+    cyl->INTERNAL_MotorStalled();
 }
 
 
@@ -110,12 +179,12 @@ Cylinder* Cylinder::GetInstance (Cylinder::ID id)
     else
     {
         // Create cylinder instance
-        _cylinder[id] = new Cylinder(id);
+        _cylinder[id] = new (_cylinderStorage.Get(id)) Cylinder(id);
         return _cylinder[id];
     }
 }
 
-Cylinder::Cylinder (Cylinder::ID id)
+Cylinder::Cylinder (Cylinder::ID id) : Actuator(Cylinder::CHANNEL_MAX)
 {
     this->def = _getCylStruct(id);
 
@@ -125,6 +194,43 @@ Cylinder::Cylinder (Cylinder::ID id)
     this->topz  = HAL::GPIO::GetInstance(this->def.ID_topz);
     this->index = 0;
 
+    // Cylinder constants are in full steps, motor counts micro steps
+    this->def.ratio *= static_cast<float32_t>(this->motor->GetMicrostep());
+    this->def.speed *= this->motor->GetMicrostep();
+    this->def.accel *= this->motor->GetMicrostep();
+
+    // Index 0 is assumed at boot until the first topz edge
+    this->origin = 0;
+    this->homed = false;
+    this->stepsPerTurn = static_cast<int32_t>(lroundf(this->def.ratio * (this->def.indexMax + 1u)));
+
+    // Warm restart : homed position of the previous run, no homing pass
+    static_assert(Cylinder::CYLINDER_MAX <= RETAIN_CYLINDERS_MAX, "Retain cylinders");
+    if((Retain::GetRestored() != NULL) && Retain::GetRestored()->cylinderHomed[id])
+    {
+        this->origin = this->motor->ReadSteps() - Retain::GetRestored()->cylinderSteps[id];
+        this->homed  = true;
+        this->index  = Retain::GetRestored()->cylinderIndex[id];
+    }
+
+    this->topz->StateChanged.Subscribe(this, &_topzEvent);
+    this->motor->MoveFinished.Subscribe(this, &_moveFinishedEvent);
+    this->motor->Stalled.Subscribe(this, &_motorStalledEvent);
+    this->motorRise = NULL;
+
+    for(uint32_t i = 0; i < Cylinder::CHANNEL_MAX; i++)
+    {
+        this->channel[i].orders   = xQueueCreateStatic(CYL_ORDERS_MAX, sizeof(CYL_ORDER),
+                                                       this->channel[i].ordersStorage, &this->channel[i].ordersBuffer);
+        this->channel[i].busy     = false;
+        this->channel[i].deadline = 0u;
+        this->channel[i].total    = 0u;
+    }
+
+    this->passCount = 0u;
+    this->passDone  = 0u;
+    this->passStart = 0;
+
     if(id == Cylinder::ID::CYLINDER0)
     {
         this->motorOpen[0] = HAL::PWM::GetInstance(this->def.ID_motorOpen[0]);
@@ -133,32 +239,65 @@ Cylinder::Cylinder (Cylinder::ID id)
         this->motorOpen[1]->SetState(HAL::PWM::State::ENABLED);
 
         if(this->def.canRise == true)
+        {
             this->motorRise = HAL::Drv8813::GetInstance(this->def.ID_motorRise);
+            this->motorRise->MoveFinished.Subscribe(this, &_moveFinishedEvent);
+            // Lift stall : end stop reached, order is done
+            this->motorRise->Stalled.Subscribe(this, &_moveFinishedEvent);
+        }
     }
 }
 
-int8_t Cylinder::Open()
+ActuatorHandle Cylinder::Start(const ACT_COMMAND& cmd)
 {
-    if(this->id == Cylinder::CYLINDER0)
+    switch(cmd.order)
     {
-        this->motorOpen[0]->SetDutyCycle(0);
-        this->motorOpen[1]->SetDutyCycle(0);
+    case Cylinder::OPEN:
+    case Cylinder::CLOSE:
+        return this->push(Cylinder::LIFT, static_cast<Cylinder::Order>(cmd.order));
+
+    case Cylinder::RAISE:
+    case Cylinder::LOWER:
+        if(this->def.canRise == false)
+            return ActuatorHandle(-1);
+        return this->push(Cylinder::LIFT, static_cast<Cylinder::Order>(cmd.order));
+
+    case Cylinder::GOTO:
+        if(cmd.arg > this->def.indexMax)
+            return ActuatorHandle(-1);
+        if(cmd.arg < -this->def.indexMax)
+            return ActuatorHandle(-2);
+        return this->push(Cylinder::ROTATION, Cylinder::GOTO, cmd.arg);
+
+    case Cylinder::SEARCH:
+        return this->push(Cylinder::ROTATION, Cylinder::SEARCH);
+
+    case Cylinder::SHIFT:
+        if((cmd.arg > this->def.indexMax) || (cmd.arg < -this->def.indexMax))
+            return ActuatorHandle(-1);
+        return this->push(Cylinder::ROTATION, Cylinder::SHIFT, cmd.arg);
 
-        vTaskDelay(1000);
-
-        this->motorOpen[0]->SetDutyCycle(0);
-        this->motorOpen[1]->SetDutyCycle(0);
+    default:
+        return ActuatorHandle(-1);
     }
-    return 0;
 }
 
-int8_t Cylinder::Close()
+uint8_t Cylinder::GetChannel(const ACT_COMMAND& cmd)
 {
-    if(this->id == Cylinder::CYLINDER0)
-    {
+    if((cmd.order == Cylinder::GOTO) || (cmd.order == Cylinder::SEARCH) || (cmd.order == Cylinder::SHIFT))
+        return Cylinder::ROTATION;
+    else
+        return Cylinder::LIFT;
+}
 
-    }
-    return 0;
+int8_t Cylinder::Open()
+{
+    return this->push(Cylinder::LIFT, Cylinder::OPEN).GetError();
+}
+
+int8_t Cylinder::Close()
+{
+    return this->push(Cylinder::LIFT, Cylinder::CLOSE).GetError();
 }
 
 int8_t Cylinder::Raise()
@@ -166,16 +305,7 @@ int8_t Cylinder::Raise()
     if(this->def.canRise == false)
         return -1;
 
-    this->motorRise->SetDirection(HAL::Drv8813State_t::BACKWARD);
-    this->motorRise->SetSpeedStep(200);
-    this->motorRise->PulseRotation(10*200);
-
-    while(this->motorRise->IsMoving()) vTaskDelay(200);
-
-    this->motorRise->SetDirection(HAL::Drv8813State_t::DISABLED);
-
-    return 0;
-
+    return this->push(Cylinder::LIFT, Cylinder::RAISE).GetError();
 }
 
 int8_t Cylinder::Lower()
@@ -183,77 +313,387 @@ int8_t Cylinder::Lower()
     if(this->def.canRise == false)
         return -1;
 
-    this->motorRise->SetDirection(HAL::Drv8813State_t::FORWARD);
-    this->motorRise->SetSpeedStep(200);
-    this->motorRise->PulseRotation(10*200);
-
-    while(this->motorRise->IsMoving()) vTaskDelay(200);
-
-    this->motorRise->SetDirection(HAL::Drv8813State_t::DISABLED);
-
-    return 0;
+    return this->push(Cylinder::LIFT, Cylinder::LOWER).GetError();
 }
 
 int8_t Cylinder::Goto(int8_t index)
 {
-    int8_t nbIndex = 0;
-
     // Error cases
     if(index > this->def.indexMax)
         return -1;
     if(index < -this->def.indexMax)
         return -2;
 
-    // Nominal cases
-    if(this->motor->IsMoving())
-        return 0;
+    return this->push(Cylinder::ROTATION, Cylinder::GOTO, index).GetError();
+}
+
+int8_t Cylinder::Goto(const int8_t* indexes, uint8_t count)
+{
+    int8_t rval = 0;
+
+    for(uint8_t i = 0; i < count; i++)
+    {
+        if(indexes[i] > this->def.indexMax)
+            return -1;
+        if(indexes[i] < -this->def.indexMax)
+            return -2;
+    }
+
+    // Sequence is queued whole, so it can be merged into one move
+    if(uxQueueSpacesAvailable(this->channel[Cylinder::ROTATION].orders) < count)
+        return -3;
+
+    for(uint8_t i = 0; (i < count) && (rval == 0); i++)
+        rval = this->push(Cylinder::ROTATION, Cylinder::GOTO, indexes[i]).GetError();
+
+    return rval;
+}
+
+int8_t Cylinder::SearchRefPoint()
+{
+    return this->push(Cylinder::ROTATION, Cylinder::SEARCH).GetError();
+}
+
+int8_t Cylinder::Shift(int8_t offset)
+{
+    if((offset > this->def.indexMax) || (offset < -this->def.indexMax))
+        return -1;
+
+    return this->push(Cylinder::ROTATION, Cylinder::SHIFT, offset).GetError();
+}
+
+int8_t Cylinder::shifted(int8_t index, int8_t offset)
+{
+    int32_t count = this->def.indexMax + 1;
+    int32_t target = (index + offset) % count;
+
+    if(target < 0)
+        target += count;
+
+    return static_cast<int8_t>(target);
+}
+
+ActuatorHandle Cylinder::push(Cylinder::Channel ch, Cylinder::Order order, int8_t index)
+{
+    CYL_ORDER o;
 
-    nbIndex = index - this->index;
+    o.order = order;
+    o.index = index;
+
+    return this->enqueue(ch, this->channel[ch].orders, &o);
+}
+
+void Cylinder::Process()
+{
+    CYL_CHANNEL* ch = NULL;
+
+    // Stall and driver fault
+    this->motor->Supervise();
+    if(this->motorRise != NULL)
+        this->motorRise->Supervise();
+
+    for(uint32_t i = 0; i < Cylinder::CHANNEL_MAX; i++)
+    {
+        ch = &this->channel[i];
+
+        // Running order
+        if(ch->busy)
+        {
+            if(!this->check(&ch->current, ch->deadline))
+                continue;
+
+            ch->busy = false;
+            this->complete(i);
+        }
+
+        // Next order
+        if(xQueueReceive(ch->orders, &ch->current, 0) == pdTRUE)
+        {
+            if(this->start(&ch->current, &ch->deadline, &ch->total))
+                this->complete(i);
+            else
+                ch->busy = true;
+        }
+    }
+
+    Retain::SetCylinder(this->id, this->currentSteps(), this->index, this->homed);
+}
+
+bool Cylinder::start(const CYL_ORDER* order, TickType_t* deadline, uint32_t* total)
+{
+    bool done = false;
+
+    *total = 0u;
+
+    switch(order->order)
+    {
+    case Cylinder::OPEN:
+        if(this->id == Cylinder::CYLINDER0)
+        {
+            this->motorOpen[0]->SetDutyCycle(0);
+            this->motorOpen[1]->SetDutyCycle(0);
+            *deadline = xTaskGetTickCount() + pdMS_TO_TICKS(CYL_OPEN_MS);
+        }
+        else
+            done = true;
+        break;
+
+    case Cylinder::RAISE:
+        this->motorRise->ClearStall();
+        this->motorRise->SetDirection(HAL::Drv8813State_t::BACKWARD);
+        this->motorRise->Move(CYL_RISE_STEPS * this->motorRise->GetMicrostep(),
+                              _batteryScaled(CYL_RISE_SPEED * this->motorRise->GetMicrostep()),
+                              _batteryScaled(CYL_RISE_ACCEL * this->motorRise->GetMicrostep()));
+        *total = CYL_RISE_STEPS * this->motorRise->GetMicrostep();
+        break;
+
+    case Cylinder::LOWER:
+        this->motorRise->ClearStall();
+        this->motorRise->SetDirection(HAL::Drv8813State_t::FORWARD);
+        this->motorRise->Move(CYL_RISE_STEPS * this->motorRise->GetMicrostep(),
+                              _batteryScaled(CYL_RISE_SPEED * this->motorRise->GetMicrostep()),
+                              _batteryScaled(CYL_RISE_ACCEL * this->motorRise->GetMicrostep()));
+        *total = CYL_RISE_STEPS * this->motorRise->GetMicrostep();
+        break;
+
+    case Cylinder::GOTO:
+        this->move(order->index);
+        *total = this->motor->GetRemainingSteps();
+        break;
+
+    case Cylinder::SHIFT:
+        this->move(this->shifted(this->index, order->index));
+        *total = this->motor->GetRemainingSteps();
+        break;
+
+    case Cylinder::SEARCH:
+        // Origin already latched : position is known, no sweep
+        if(this->homed)
+            done = true;
+        else
+        {
+            this->motor->ClearStall();
+            this->motor->SetDirection(HAL::Drv8813State_t::FORWARD);
+            this->motor->SetSpeedStep(this->def.speed);
+            this->motor->PulseRotation(this->stepsPerTurn);
+            *total = this->stepsPerTurn;
+        }
+        break;
+
+    case Cylinder::CLOSE:
+    default:
+        done = true;
+        break;
+    }
+
+    return done;
+}
+
+bool Cylinder::check(const CYL_ORDER* order, TickType_t deadline)
+{
+    bool done = false;
+
+    switch(order->order)
+    {
+    case Cylinder::OPEN:
+        if((done = (static_cast<int32_t>(xTaskGetTickCount() - deadline) >= 0)))
+        {
+            this->motorOpen[0]->SetDutyCycle(0);
+            this->motorOpen[1]->SetDutyCycle(0);
+        }
+        break;
+
+    case Cylinder::RAISE:
+    case Cylinder::LOWER:
+        if((done = !this->motorRise->IsMoving()))
+            this->motorRise->ClearStall();
+        this->motorRise->SetDirection(HAL::Drv8813State_t::DISABLED);
+        break;
+
+    case Cylinder::GOTO:
+    case Cylinder::SHIFT:
+        done = !this->motor->IsMoving();
+        this->pass(done);
+        break;
+
+    case Cylinder::SEARCH:
+        // Origin is latched by topz interrupt, stop latency does not matter
+        if((done = (this->homed || !this->motor->IsMoving())))
+        {
+            this->motor->SetDirection(HAL::Drv8813State_t::DISABLED);
+            if(this->homed)
+                this->index = this->GetIndex();
+        }
+        break;
+
+    default:
+        done = true;
+        break;
+    }
+
+    return done;
+}
+
+int32_t Cylinder::path(int32_t from, int32_t to)
+{
+    int32_t steps = to - from;
 
     // Calculate shorted path
     if(this->def.shortPath)
     {
-        if(nbIndex > this->def.indexMax/2)
-            nbIndex -= this->def.indexMax + 1u;
-        if(nbIndex < -this->def.indexMax/2)
-            nbIndex += this->def.indexMax + 1u;
+        steps %= this->stepsPerTurn;
+        if(steps > this->stepsPerTurn/2)
+            steps -= this->stepsPerTurn;
+        if(steps < -this->stepsPerTurn/2)
+            steps += this->stepsPerTurn;
     }
 
-    if(nbIndex > 0)
+    return steps;
+}
+
+void Cylinder::move(int8_t index)
+{
+    CYL_ORDER next;
+    int32_t target = static_cast<int32_t>(lroundf(this->def.ratio * index));
+    int32_t steps = 0;
+    int32_t hop = 0;
+
+    this->motor->ClearStall();
+
+    // Steps from measured position (corrects missed or extra steps)
+    steps = this->path(this->currentSteps(), target);
+
+    this->passStart = this->motor->ReadSteps();
+    this->passCount = 0u;
+    this->passDone  = 0u;
+    this->passSteps[this->passCount++] = abs(steps);
+
+    // Following targets the same way join the move, hops from previous target
+    while((this->passCount <= CYL_ORDERS_MAX) &&
+          (xQueuePeek(this->channel[Cylinder::ROTATION].orders, &next, 0) == pdTRUE) &&
+          ((next.order == Cylinder::GOTO) || (next.order == Cylinder::SHIFT)))
+    {
+        if(next.order == Cylinder::SHIFT)
+            next.index = this->shifted(index, next.index);
+
+        hop = this->path(target, static_cast<int32_t>(lroundf(this->def.ratio * next.index)));
+
+        if(((hop > 0) && (steps < 0)) || ((hop < 0) && (steps > 0)))
+            break;
+
+        xQueueReceive(this->channel[Cylinder::ROTATION].orders, &next, 0);
+
+        target += hop;
+        steps  += hop;
+        index   = next.index;
+        this->passSteps[this->passCount++] = abs(steps);
+    }
+
+    if(steps > 0)
         this->motor->SetDirection(HAL::Drv8813State_t::FORWARD);
-    else if(nbIndex < 0)
+    else if(steps < 0)
         this->motor->SetDirection(HAL::Drv8813State_t::BACKWARD);
 
-    this->motor->SetSpeedStep(this->def.speed);
-    this->motor->PulseRotation(this->def.ratio * abs(nbIndex));
+    if(steps != 0)
+        this->motor->Move(static_cast<uint32_t>(abs(steps)), _batteryScaled(this->def.speed), _batteryScaled(this->def.accel));
 
     this->index = index;
+}
+
+void Cylinder::pass(bool finished)
+{
+    int32_t done = abs(this->motor->ReadSteps() - this->passStart);
 
-    return nbIndex;
+    // Last target is the channel current order, completed by Process()
+    while((this->passDone + 1u < this->passCount) &&
+          (finished || (done >= this->passSteps[this->passDone])))
+    {
+        this->passDone++;
+        this->complete(Cylinder::ROTATION);
+    }
 }
 
-int8_t Cylinder::SearchRefPoint()
+bool Cylinder::IsPositioningFinished ()
 {
-    this->motor->SetDirection(HAL::Drv8813State_t::FORWARD);
-    this->motor->SetSpeedStep(this->def.speed);
-    this->motor->PulseRotation(this->def.ratio * (this->def.indexMax+1u));
+    const CYL_CHANNEL* ch = &this->channel[Cylinder::ROTATION];
 
-    while(this->motor->IsMoving())
+    return !ch->busy && (uxQueueMessagesWaiting(ch->orders) == 0u) && !this->motor->IsMoving();
+}
+
+bool Cylinder::IsIdle (uint8_t ch)
+{
+    return !this->channel[ch].busy && (uxQueueMessagesWaiting(this->channel[ch].orders) == 0u);
+}
+
+uint8_t Cylinder::GetProgress (uint8_t ch)
+{
+    const CYL_CHANNEL* c = &this->channel[ch];
+    HAL::Drv8813* motor = (ch == Cylinder::ROTATION) ? this->motor : this->motorRise;
+    uint32_t done = 0u;
+    int32_t left = 0;
+
+    if(!c->busy)
+        return this->IsIdle(ch) ? 100u : 0u;
+
+    if(c->current.order == Cylinder::OPEN)
     {
-        //if(this->topz->Get() == HAL::GPIO::State::Low)
-        if(this->topz->Get() == HAL::GPIO::State::High)
-        {
-            this->motor->SetDirection(HAL::Drv8813State_t::DISABLED);
-            this->index = 0;
-            return 1;   // Found
-        }
+        // Timed order
+        left = static_cast<int32_t>(c->deadline - xTaskGetTickCount());
+        if(left < 0)
+            left = 0;
+        done = pdMS_TO_TICKS(CYL_OPEN_MS) - static_cast<uint32_t>(left);
+        return static_cast<uint8_t>((100u * done) / pdMS_TO_TICKS(CYL_OPEN_MS));
     }
 
-    this->motor->SetDirection(HAL::Drv8813State_t::DISABLED);
-    return 0;  // Not Found
+    if(c->total == 0u)
+        return 0u;
+
+    // Stepper order
+    done = c->total - motor->GetRemainingSteps();
+    return static_cast<uint8_t>((100u * done) / c->total);
 }
 
-bool Cylinder::IsPositioningFinished ()
+int8_t Cylinder::GetIndex ()
+{
+    int32_t index = static_cast<int32_t>(lroundf(this->currentSteps() / this->def.ratio));
+
+    if(index > this->def.indexMax)
+        index -= this->def.indexMax + 1u;
+
+    return static_cast<int8_t>(index);
+}
+
+int32_t Cylinder::currentSteps ()
 {
-    return !this->motor->IsMoving();
+    int32_t steps = this->motor->ReadSteps() - this->origin;
+
+    steps %= this->stepsPerTurn;
+    if(steps < 0)
+        steps += this->stepsPerTurn;
+
+    return steps;
+}
+
+void Cylinder::INTERNAL_MotorStalled ()
+{
+    // Steps were lost : position is unknown until next topz edge
+    this->homed = false;
+
+    this->MotionFinished();
+}
+
+void Cylinder::INTERNAL_TopzChanged ()
+{
+    HAL::GPIO::State state = this->topz->GetEdgeState();
+    HAL::Drv8813State dir = this->motor->GetDirection();
+
+    // Same sensor edge in both directions : rising forward, falling backward
+    if(((dir == HAL::Drv8813State_t::FORWARD)  && (state == HAL::GPIO::State::High)) ||
+       ((dir == HAL::Drv8813State_t::BACKWARD) && (state == HAL::GPIO::State::Low)))
+    {
+        this->origin = this->motor->ReadSteps();
+        this->homed = true;
+
+        this->MotionFinished();
+    }
 }
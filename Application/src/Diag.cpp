@@ -6,23 +6,47 @@
  */
 
 #include "Diag.hpp"
+#include "TaskTable.hpp"
+#include "StaticStorage.hpp"
+#include "SystemState.hpp"
 
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <stddef.h>
 
 #include "Encoder.hpp"
+#include "Crc.hpp"
 
 /*----------------------------------------------------------------------------*/
 /* Definitions                                                                */
 /*----------------------------------------------------------------------------*/
 
-#define DIAG_TASK_STACK_SIZE          (256u)
-#define DIAG_TASK_PRIORITY            (2u)
-
-#define DIAG_TASK_PERIOD_MS           (10u)
+#define DIAG_TASK_PERIOD_MS           (TASK_DIAG_PERIOD_MS)
 
 #define DIAG_TRACES_PERIOD_MS         (10u)
+#define DIAG_TELEMETRY_PERIOD_MS      (10u)
+#define DIAG_SCHED_PERIOD_MS          (100u)
+#define DIAG_MEMORY_PERIOD_MS         (1000u)
+#define DIAG_WATCH_PERIOD_MS          (100u)
+
+// Unchanged channels are still sent at heartbeat rate
+#define DIAG_HEARTBEAT_MS             (1000u)
+#define DIAG_MEMORY_HEARTBEAT_MS      (10000u)
+
+// Console link budget : Diag share of SERIAL0 (37 kbaud, 3.7 kB/s), the rest is left to CLI replies
+#define DIAG_LINK_RATE                (2800u)       // bytes/s
+#define DIAG_LINK_BURST               (256u)        // bytes
+#define DIAG_LINK_RESERVE             (32u)         // bytes left to each higher priority level
+#define DIAG_LINK_BACKLOG             (256u)        // TX bytes pending : link saturated, highest priority only
+
+// Log and dumps (trace, scope) priorities, one frame per loop when the budget allows
+#define DIAG_PRIORITY_LOG             (1u)
+#define DIAG_PRIORITY_DUMP            (3u)
+#define DIAG_PRIORITY_MAX             (3u)
+
+// Low stack warning (words never used)
+#define DIAG_STACK_MARGIN             (32u)
 #define DIAG_LED_PERIOD_MS            (10u)
 
 /*----------------------------------------------------------------------------*/
@@ -30,6 +54,66 @@
 /*----------------------------------------------------------------------------*/
 
 static Diag* _diag = NULL;
+static Utils::StaticStorage<Diag> _diagStorage;
+
+/*----------------------------------------------------------------------------*/
+/* Scope probes                                                               */
+/*----------------------------------------------------------------------------*/
+
+static float32_t _probeLinProfiled () { return PositionControl::GetInstance(false)->GetLinearPositionProfiled(); }
+static float32_t _probeAngProfiled () { return PositionControl::GetInstance(false)->GetAngularPositionProfiled(); }
+static float32_t _probeLinError ()    { return PositionControl::GetInstance(false)->GetLinearPositionError(); }
+static float32_t _probeAngError ()    { return PositionControl::GetInstance(false)->GetAngularPositionError(); }
+static float32_t _probeLinOutput ()   { return PositionControl::GetInstance(false)->GetLinearVelocity(); }
+static float32_t _probeAngOutput ()   { return PositionControl::GetInstance(false)->GetAngularVelocity(); }
+static float32_t _probeLin ()         { return Odometry::GetInstance(false)->GetLinearPosition(); }
+static float32_t _probeAng ()         { return Odometry::GetInstance(false)->GetAngularPosition(); }
+static float32_t _probeLeft ()        { return Odometry::GetInstance(false)->GetLeftVelocity(); }
+static float32_t _probeRight ()       { return Odometry::GetInstance(false)->GetRightVelocity(); }
+static float32_t _probeStep ()        { return static_cast<float32_t>(TrajectoryPlanning::GetInstance(false)->GetStep()); }
+
+/**
+ * @brief Scope variables : profiled positions, position errors, PID outputs (velocity
+ * setpoints, i.e. steppers rate), odometry positions and wheels (encoders) velocities
+ */
+static const struct
+{
+    const char* name;
+    ScopeProbe probe;
+} _scopeProbes[] =
+{
+    {"linprof",  _probeLinProfiled},
+    {"angprof",  _probeAngProfiled},
+    {"linerr",   _probeLinError},
+    {"angerr",   _probeAngError},
+    {"linout",   _probeLinOutput},
+    {"angout",   _probeAngOutput},
+    {"lin",      _probeLin},
+    {"ang",      _probeAng},
+    {"left",     _probeLeft},
+    {"right",    _probeRight},
+    {"step",     _probeStep},
+};
+
+static const uint32_t _scopeProbesCount = sizeof(_scopeProbes) / sizeof(_scopeProbes[0]);
+
+/*----------------------------------------------------------------------------*/
+/* Channels                                                                   */
+/*----------------------------------------------------------------------------*/
+
+const Diag::channel_t Diag::channels[Diag::CHANNEL_MAX] =
+{
+    // Name     Builder                 Period                      Heartbeat                   Priority    Header                                  Binary
+    {"mc",      &Diag::TracesMC,        DIAG_TRACES_PERIOD_MS,      DIAG_HEARTBEAT_MS,          1u,         0u,                                     false},
+    {"od",      &Diag::TracesOD,        DIAG_TRACES_PERIOD_MS,      DIAG_HEARTBEAT_MS,          1u,         0u,                                     false},
+    {"tmc",     &Diag::TelemetryMC,     DIAG_TELEMETRY_PERIOD_MS,   DIAG_HEARTBEAT_MS,          0u,         offsetof(diag_telemetry_mc_t, step),    true},
+    {"sched",   &Diag::TelemetrySched,  DIAG_SCHED_PERIOD_MS,       0u,                         2u,         0u,                                     true},
+    {"mem",     &Diag::TelemetryMem,    DIAG_MEMORY_PERIOD_MS,      DIAG_MEMORY_HEARTBEAT_MS,   2u,         offsetof(diag_telemetry_mem_t, heapFree), true},
+    {"watch",   &Diag::TracesWatch,     DIAG_WATCH_PERIOD_MS,       DIAG_HEARTBEAT_MS,          1u,         0u,                                     false},
+    {"tpstat",  &Diag::TelemetryTP,     DIAG_SCHED_PERIOD_MS,       0u,                         2u,         0u,                                     true},
+    {"enc",     &Diag::TelemetryEnc,    DIAG_SCHED_PERIOD_MS,       0u,                         2u,         0u,                                     true},
+    {"perf",    &Diag::TelemetryPerf,   DIAG_MEMORY_PERIOD_MS,      0u,                         2u,         0u,                                     true},
+};
 
 /*----------------------------------------------------------------------------*/
 /* Class Implementation                                                       */
@@ -44,29 +128,48 @@ Diag* Diag::GetInstance()
     }
     else
     {
-        _diag = new Diag();
+        _diag = new (_diagStorage.Get()) Diag();
         return _diag;
     }
 }
 
-Diag::Diag()
+Diag::Diag() : profiler("Diag"), periodic("Diag", DIAG_TASK_PERIOD_MS)
 {
     this->name = "Diag";
     this->taskHandle = NULL;
 
-    this->enable[0] = false;
-    this->enable[1] = false;
-    this->enable[2] = false;
-    this->enable[3] = false;
-    this->enable[4] = false;
+    for(uint32_t c = 0; c < CHANNEL_MAX; c++)
+    {
+        this->channelState[c].enable    = false;
+        this->channelState[c].period    = channels[c].period;
+        this->channelState[c].last      = 0;
+        this->channelState[c].signature = 0;
+        this->channelState[c].sent      = 0;
+        this->channelState[c].unchanged = 0;
+        this->channelState[c].dropped   = 0;
+    }
+    this->time = 0;
+    this->budget = DIAG_LINK_BURST * 1000;
+    this->ClearWatch();
+
+    this->seq = 0;
+    this->schedIndex = 0;
+    this->tpIndex = 0;
+    this->encIndex = 0;
+
+    for(uint32_t i = 0; i < TaskTable::TASK_MAX; i++)
+        this->stackFree[i] = 0;
+    this->heapFree = 0;
+    this->heapMinFree = 0;
+    this->heapLargest = 0;
+    this->stackWarned = 0;
+    this->traceDump = false;
+    this->traceIndex = 0;
+    this->scopeDump = false;
+    this->scopeIndex = 0;
 
     // Create task
-    xTaskCreate((TaskFunction_t)(&Diag::taskHandler),
-                this->name.c_str(),
-                DIAG_TASK_STACK_SIZE,
-                NULL,
-                DIAG_TASK_PRIORITY,
-                NULL);
+    TaskTable::Create(TaskTable::DIAG, (TaskFunction_t)(&Diag::taskHandler), this->name);
 
     this->odometry = Odometry::GetInstance(false);
     this->pc = PositionControl::GetInstance(false);
@@ -78,34 +181,479 @@ Diag::Diag()
     this->led3 = GPIO::GetInstance(GPIO::GPIO2);
     this->led4 = GPIO::GetInstance(GPIO::GPIO3);
 
+    this->serial = Serial::GetInstance(SERIAL_CONSOLE);
+
+}
+
+uint32_t Diag::TracesMC(uint8_t* buffer)
+{
+    SYSTEM_STATE s;
+
+    SystemState::Read(&s);
+
+    // Other variables : watch channel (see Utils::Watch)
+    return Utils::Format((char*)buffer, DIAG_CHANNEL_SIZE, "%ld\t%.3f\t%.3f\t%.3f\t%.3f\t%.3f\t%.3f\r\n", s.step, s.linearPositionProfiled, s.angularPositionProfiled, s.linearPosition, s.linearVelocity, s.angularPosition, s.angularVelocity);
+}
+
+uint32_t Diag::TracesOD(uint8_t* buffer)
+{
+    SYSTEM_STATE s;
+
+    SystemState::Read(&s);
+
+    return Utils::Format((char*)buffer, DIAG_CHANNEL_SIZE, "%ld\t%ld\t%.1f\r\n", s.xmm, s.ymm, s.odeg);
+}
+
+uint32_t Diag::TracesWatch(uint8_t* buffer)
+{
+    char* line = (char*)buffer;
+    uint32_t length = 0;
+
+    for(uint32_t i = 0; i < DIAG_WATCH_MAX; i++)
+    {
+        if(this->watchList[i] < 0)
+            continue;
+
+        if(length > 0)
+            length += Utils::Format(&line[length], DIAG_CHANNEL_SIZE - length, "\t");
+
+        length += Utils::Format(&line[length], DIAG_CHANNEL_SIZE - length, "%s ", Utils::Watch::GetName(this->watchList[i]));
+        length += Utils::Watch::Format(this->watchList[i], &line[length], DIAG_CHANNEL_SIZE - length);
+    }
+
+    if(length == 0)
+        return 0;
+
+    return length + Utils::Format(&line[length], DIAG_CHANNEL_SIZE - length, "\r\n");
+}
+
+bool Diag::AddWatch(uint32_t index)
+{
+    if(index >= Utils::Watch::Count())
+        return false;
+
+    for(uint32_t i = 0; i < DIAG_WATCH_MAX; i++)
+    {
+        if(this->watchList[i] == static_cast<int16_t>(index))
+            return true;
+    }
+
+    for(uint32_t i = 0; i < DIAG_WATCH_MAX; i++)
+    {
+        if(this->watchList[i] < 0)
+        {
+            this->watchList[i] = static_cast<int16_t>(index);
+            return true;
+        }
+    }
+
+    return false;
+}
+
+void Diag::ClearWatch()
+{
+    for(uint32_t i = 0; i < DIAG_WATCH_MAX; i++)
+        this->watchList[i] = -1;
+}
+
+uint32_t Diag::TelemetryMC(uint8_t* buffer)
+{
+    diag_telemetry_mc_t* frame = (diag_telemetry_mc_t*)buffer;
+    SYSTEM_STATE s;
+
+    SystemState::Read(&s);
+
+    // seq is set when the frame is sent
+    frame->type                    = DIAG_TELEMETRY_MC;
+    frame->tick                    = s.tick;
+    frame->step                    = s.step;
+    frame->linearPositionProfiled  = s.linearPositionProfiled;
+    frame->angularPositionProfiled = s.angularPositionProfiled;
+    frame->linearPosition          = s.linearPosition;
+    frame->linearVelocity          = s.linearVelocity;
+    frame->angularPosition         = s.angularPosition;
+    frame->angularVelocity         = s.angularVelocity;
+
+    return sizeof(*frame);
+}
+
+uint32_t Diag::TelemetrySched(uint8_t* buffer)
+{
+    diag_telemetry_sched_t* frame = (diag_telemetry_sched_t*)buffer;
+    Utils::PeriodicTask* t;
+
+    if(this->schedIndex >= Utils::PeriodicTask::Count())
+        this->schedIndex = 0;
+
+    t = Utils::PeriodicTask::Get(this->schedIndex);
+    if(t == NULL)
+        return 0;
+
+    frame->type       = DIAG_TELEMETRY_SCHED;
+    frame->tick       = xTaskGetTickCount();
+    frame->index      = this->schedIndex++;
+    frame->period     = static_cast<uint16_t>(t->GetPeriod());
+    frame->periodMax  = t->GetPeriodMax();
+    frame->jitterMax  = t->GetJitterMax();
+    frame->latencyMax = t->GetLatencyMax();
+    frame->missed     = t->GetMissed();
+    frame->count      = t->GetCount();
+
+    return sizeof(*frame);
+}
+
+uint32_t Diag::TelemetryTP(uint8_t* buffer)
+{
+    diag_telemetry_tp_t* frame = (diag_telemetry_tp_t*)buffer;
+    TP_STATE_STATS stats;
+
+    if(this->tpIndex >= TP_STATES)
+        this->tpIndex = 0;
+
+    tp->GetStateStats(this->tpIndex, &stats);
+
+    frame->type      = DIAG_TELEMETRY_TP;
+    frame->tick      = xTaskGetTickCount();
+    frame->state     = this->tpIndex++;
+    frame->orders    = stats.orders;
+    frame->replaced  = stats.replaced;
+    frame->cycles    = stats.cycles;
+    frame->cyclesMax = stats.cyclesMax;
+    frame->time      = stats.time;
+    frame->timeMax   = stats.timeMax;
+    frame->settled   = stats.settled;
+    frame->settle    = stats.settle;
+    frame->settleMax = stats.settleMax;
+
+    return sizeof(*frame);
+}
+
+uint32_t Diag::TelemetryEnc(uint8_t* buffer)
+{
+    diag_telemetry_enc_t* frame = (diag_telemetry_enc_t*)buffer;
+    ODO_ENCODER_STATS stats;
+
+    if(this->encIndex >= ODO_WHEELS)
+        this->encIndex = 0;
+
+    odometry->GetEncoderStats(this->encIndex, &stats);
+
+    frame->type     = DIAG_TELEMETRY_ENC;
+    frame->tick     = xTaskGetTickCount();
+    frame->wheel    = this->encIndex++;
+    frame->samples  = stats.samples;
+    frame->moving   = stats.moving;
+    frame->ticks    = stats.ticks;
+    frame->peak     = stats.peak;
+    frame->rejected = stats.rejected;
+    frame->jumps    = stats.jumps;
+    frame->flips    = stats.flips;
+
+    return sizeof(*frame);
+}
+
+uint32_t Diag::TelemetryPerf(uint8_t* buffer)
+{
+    diag_telemetry_perf_t* frame = (diag_telemetry_perf_t*)buffer;
+    PERF_SUMMARY summary;
+
+    // Window is left to the CLI (perf reset)
+    Perf::GetSummary(&summary);
+
+    frame->type            = DIAG_TELEMETRY_PERF;
+    frame->tick            = xTaskGetTickCount();
+    frame->window          = summary.window;
+    frame->cpu             = summary.cpu;
+    frame->busiest         = summary.busiest;
+    frame->busiestLoad     = summary.busiestLoad;
+    frame->loopMax         = summary.loopMax;
+    frame->latencyMax      = summary.latencyMax;
+    frame->missed          = summary.missed;
+    frame->traceLost       = summary.traceLost;
+    frame->logLost         = summary.logLost;
+    frame->txDropped       = summary.txDropped;
+    frame->deferredDropped = summary.deferredDropped;
+    frame->ordersPeak      = summary.ordersPeak;
+
+    for(uint32_t b = 0; b < PERF_BUS_MAX; b++)
+        frame->bus[b] = summary.bus[b];
+
+    return sizeof(*frame);
+}
+
+uint32_t Diag::TelemetryMem(uint8_t* buffer)
+{
+    diag_telemetry_mem_t* frame = (diag_telemetry_mem_t*)buffer;
+
+    frame->type        = DIAG_TELEMETRY_MEM;
+    frame->tick        = xTaskGetTickCount();
+    frame->heapFree    = this->heapFree;
+    frame->heapMinFree = this->heapMinFree;
+    frame->heapLargest = this->heapLargest;
+
+    for(uint32_t i = 0; i < TaskTable::TASK_MAX; i++)
+        frame->stackFree[i] = this->stackFree[i];
+
+    return sizeof(*frame);
+}
+
+void Diag::TelemetryTrace()
+{
+    diag_telemetry_trace_t frame;
+    const TRACE_RECORD* r;
+    uint32_t total = Utils::Trace::Count();
+
+    frame.type  = DIAG_TELEMETRY_TRACE;
+    frame.seq   = this->seq++;
+    frame.index = this->traceIndex;
+    frame.total = static_cast<uint16_t>(total);
+    frame.lost  = Utils::Trace::GetLost();
+    frame.count = 0;
+
+    while((frame.count < DIAG_TRACE_RECORDS) && (this->traceIndex < total))
+    {
+        r = Utils::Trace::Get(this->traceIndex++);
+        frame.records[frame.count++] = *r;
+    }
+
+    // Last frame may be empty (empty buffer)
+    this->send(&frame, sizeof(frame) - ((DIAG_TRACE_RECORDS - frame.count) * sizeof(TRACE_RECORD)), SWO::TRACE);
+
+    if(this->traceIndex >= total)
+        this->traceDump = false;
+}
+
+void Diag::TelemetryScope()
+{
+    diag_telemetry_scope_t frame;
+    const float32_t* s;
+    uint32_t total = Utils::Scope::Count();
+
+    frame.type    = DIAG_TELEMETRY_SCOPE;
+    frame.seq     = this->seq++;
+    frame.index   = this->scopeIndex;
+    frame.total   = static_cast<uint16_t>(total);
+    frame.trigger = static_cast<uint16_t>(Utils::Scope::GetTriggerIndex());
+    frame.count   = 0;
+
+    while((frame.count < DIAG_SCOPE_SAMPLES) && (this->scopeIndex < total))
+    {
+        s = Utils::Scope::Get(this->scopeIndex++);
+        memcpy(frame.samples[frame.count++], s, sizeof(frame.samples[0]));
+    }
+
+    // Last frame may be empty (nothing captured)
+    this->send(&frame, sizeof(frame) - ((DIAG_SCOPE_SAMPLES - frame.count) * sizeof(frame.samples[0])), SWO::TRACE);
+
+    if(this->scopeIndex >= total)
+        this->scopeDump = false;
+}
+
+bool Diag::SetScopeChannel(uint32_t channel, const char* probe)
+{
+    if(strcmp(probe, "off") == 0)
+        return Utils::Scope::SetChannel(channel, NULL);
+
+    for(uint32_t i = 0; i < _scopeProbesCount; i++)
+    {
+        if(strcmp(probe, _scopeProbes[i].name) == 0)
+            return Utils::Scope::SetChannel(channel, _scopeProbes[i].probe);
+    }
+
+    return false;
+}
+
+const char* Diag::GetScopeChannelName(uint32_t channel)
+{
+    ScopeProbe probe = Utils::Scope::GetChannel(channel);
+
+    for(uint32_t i = 0; i < _scopeProbesCount; i++)
+    {
+        if((probe != NULL) && (probe == _scopeProbes[i].probe))
+            return _scopeProbes[i].name;
+    }
+
+    return "off";
+}
+
+const char* Diag::GetScopeProbeName(uint32_t index)
+{
+    return (index < _scopeProbesCount) ? _scopeProbes[index].name : NULL;
+}
+
+void Diag::TelemetryLog()
+{
+    diag_telemetry_log_t frame;
+    uint32_t count;
+
+    count = Utils::Log::Read(frame.words, DIAG_LOG_WORDS);
+    if(count == 0)
+        return;
+
+    frame.type = DIAG_TELEMETRY_LOG;
+    frame.seq  = this->seq++;
+    frame.lost = static_cast<uint16_t>(Utils::Log::GetLost());
+
+    this->send(&frame, sizeof(frame) - ((DIAG_LOG_WORDS - count) * sizeof(uint32_t)));
+}
+
+void Diag::Memory()
+{
+    TaskHandle_t task;
+
+    // High water marks : stack never used since task creation
+    for(uint32_t i = 0; i < TaskTable::TASK_MAX; i++)
+    {
+        task = TaskTable::GetHandle(static_cast<TaskTable::ID>(i));
+        if(task == NULL)
+            continue;
+
+        this->stackFree[i] = static_cast<uint16_t>(TaskTable::GetStackFree(static_cast<TaskTable::ID>(i)));
+
+        // Warn once per task, before the overflow hook fires
+        if((this->stackFree[i] < DIAG_STACK_MARGIN) && ((this->stackWarned & (1u << i)) == 0))
+        {
+            this->stackWarned |= (1u << i);
+            Utils::Print("WARNING | %s stack : %u words left\r\n", pcTaskGetName(task), this->stackFree[i]);
+        }
+    }
+
+    // Heap and fragmentation
+    this->heapFree    = xPortGetFreeHeapSize();
+    this->heapMinFree = xPortGetMinimumEverFreeHeapSize();
+    this->heapLargest = xPortGetLargestFreeBlockSize();
+}
+
+void Diag::send(const void* frame, uint32_t size, enum SWO::PORT port)
+{
+    uint8_t raw[DIAG_FRAME_MAX + sizeof(uint32_t)];
+    uint8_t* encoded;
+    uint32_t crc;
+    uint32_t length;
+
+    assert(size <= DIAG_FRAME_MAX);
+
+    memcpy(raw, frame, size);
+    crc = HAL::Crc::Compute(raw, size);
+    memcpy(&raw[size], &crc, sizeof(crc));
+
+    if(SWO::IsRouted(port))
+    {
+        uint8_t swo[FRAME_COBS_SIZE(sizeof(raw))];
+
+        length = Utils::CobsEncode(raw, size + sizeof(uint32_t), swo);
+        SWO::GetInstance()->Write(port, swo, length);
+    }
+    else
+    {
+        // Encoded in place in the TX buffer, or frame is dropped if TX buffer is full (seq gap on host side)
+        encoded = this->serial->Reserve(FRAME_COBS_SIZE(size + sizeof(uint32_t)));
+        if(encoded == NULL)
+            return;
+
+        length = Utils::CobsEncode(raw, size + sizeof(uint32_t), encoded);
+        this->serial->Commit(length);
+        this->budget -= static_cast<int32_t>(length * 1000u);
+    }
 }
 
-void Diag::TracesMC()
+bool Diag::admit(uint32_t size, uint8_t priority, enum SWO::PORT port)
 {
-    robot_t r;
+    // SWO and USB are not limited by the console baudrate
+    if(SWO::IsRouted(port) || (SERIAL_CONSOLE == Serial::SERIAL_USB))
+        return true;
 
-    this->odometry->GetRobot(&r);
+    // Link saturated by other outputs (CLI replies) : highest priority only
+    if((priority > 0u) && (this->serial->BytesToSend() > DIAG_LINK_BACKLOG))
+        return false;
 
-    //printf("%ld\t%ld\t%.3f\t%.3f\t%.3f\t%.3f\r\n", tp->GetStep(), pg->GetLinearPhase(), pg->GetLinearPositionProfiled(), pc->GetLinearPosition(), pg->GetLinearVelocity(), pg->GetLinearSpeed());
-    //printf("%.3f\t%.3f\t%.3f\t%.3f\r\n", pc->GetLinearPosition(), pg->GetLinearVelocityProfiled(), odometry->GetLinearVelocity(), odometry->GetLinearPosition());
-    //printf("%.3f\t%.3f\t%.3f\t%.3f\r\n", pc->GetAngularPosition(), pg->GetAngularVelocity(), odometry->GetAngularVelocity(), odometry->GetAngularPosition());
-    //printf("%ld\t%ld\t%.3f\t%.3f\t%.3f\t%.3f\r\n", tp->GetStep(), pg->GetLinearPhase(), pc->GetAngularPosition(), pg->GetAngularVelocity(), odometry->GetAngularVelocity(), odometry->GetAngularPosition());
-    //printf("%.3f\t%.3f\r\n", odometry->GetAngularPosition(), odometry->GetAngularVelocity());
-    //printf("%.3f\t%.3f\t%.3f\t%.3f\r\n", odometry->GetLinearPosition(), odometry->GetLinearVelocity(), odometry->GetAngularPosition(), odometry->GetAngularVelocity());
-    //printf("%ld\t%.3f\t%.3f\t%.3f\t%.3f\r\n", tp->GetStep(), odometry->GetLinearPosition(), odometry->GetLinearVelocity(), odometry->GetAngularPosition(), odometry->GetAngularVelocity());
-    //printf("%ld\t%.3f\t%.3f\t%.3f\t%.3f\t%ld\t%ld\r\n", tp->GetStep(), odometry->GetLinearPosition(), odometry->GetLinearVelocity(), odometry->GetAngularPosition(), odometry->GetAngularVelocity(), odometry->getLeftSum(), odometry->getRightSum());
-    //printf("%ld\t%.3f\t%.3f\t%.3f\t%.3f\t%.3f\t%.3f\r\n", tp->GetStep(), pg->GetLinearVelocityProfiled(), pg->GetAngularVelocityProfiled(), odometry->GetLinearPosition(), odometry->GetLinearVelocity(), odometry->GetAngularPosition(), odometry->GetAngularVelocity());
-    printf("%ld\t%.3f\t%.3f\t%.3f\t%.3f\t%.3f\t%.3f\r\n", tp->GetStep(), pc->GetLinearPositionProfiled(), pc->GetAngularPositionProfiled(), odometry->GetLinearPosition(), odometry->GetLinearVelocity(), odometry->GetAngularPosition(), odometry->GetAngularVelocity());
+    return this->budget >= static_cast<int32_t>((size + (priority * DIAG_LINK_RESERVE)) * 1000u);
 }
 
-void Diag::TracesOD()
+void Diag::publish()
 {
-    robot_t r;
+    uint8_t buffer[DIAG_CHANNEL_SIZE];
+    const channel_t* def;
+    channel_state_t* state;
+    uint32_t length, signature;
+    enum SWO::PORT port;
+
+    for(uint32_t p = 0; p <= DIAG_PRIORITY_MAX; p++)
+    {
+        for(uint32_t c = 0; c < CHANNEL_MAX; c++)
+        {
+            def = &channels[c];
+            state = &this->channelState[c];
+
+            if((def->priority != p) || !state->enable || ((this->time % state->period) != 0))
+                continue;
+
+            length = (this->*def->build)(buffer);
+            if(length <= def->header)
+                continue;
+
+            // On change only, or heartbeat
+            signature = HAL::Crc::Compute(&buffer[def->header], length - def->header);
+            if((def->heartbeat != 0u) && (signature == state->signature) &&
+               ((this->time - state->last) < def->heartbeat))
+            {
+                state->unchanged++;
+                continue;
+            }
+
+            // Frames are CRC-32 and COBS encoded
+            port = def->binary ? SWO::TELEMETRY : SWO::LOG;
+            if(!this->admit(def->binary ? FRAME_COBS_SIZE(length + sizeof(uint32_t)) : length, p, port))
+            {
+                state->dropped++;
+                continue;
+            }
+
+            if(def->binary)
+            {
+                memcpy(&buffer[1], &this->seq, sizeof(this->seq));
+                this->seq++;
+                this->send(buffer, length, port);
+            }
+            else
+            {
+                // Through stdout, as Utils::Print()
+                fwrite(buffer, 1u, length, stdout);
+                if(!SWO::IsRouted(port))
+                    this->budget -= static_cast<int32_t>(length * 1000u);
+            }
+
+            state->signature = signature;
+            state->last = this->time;
+            state->sent++;
+        }
+    }
+}
 
-    this->odometry->GetRobot(&r);
+int32_t Diag::FindChannel(const char* name)
+{
+    for(uint32_t c = 0; c < CHANNEL_MAX; c++)
+    {
+        if(strcmp(name, channels[c].name) == 0)
+            return static_cast<int32_t>(c);
+    }
 
-    //printf("%.3f\t%.3f\t%.3f\r\n", r.X, r.Y, r.O);
-    printf("%ld\t%ld\t%.1f\r\n", r.Xmm, r.Ymm, r.Odeg);
+    return -1;
+}
+
+void Diag::SetChannel(uint32_t c, bool enable, uint16_t period)
+{
+    if(c >= CHANNEL_MAX)
+        return;
+
+    if(period != 0u)
+    {
+        // Multiple of the task period
+        period = static_cast<uint16_t>(((period + DIAG_TASK_PERIOD_MS - 1u) / DIAG_TASK_PERIOD_MS) * DIAG_TASK_PERIOD_MS);
+        this->channelState[c].period = period;
+    }
+
+    this->channelState[c].enable = enable;
 }
 
 void Diag::Led()
@@ -184,56 +732,57 @@ void Diag::Led()
 
 void Diag::Compute(float32_t period)
 {
-	static uint32_t localTime = 0;
-
-	localTime += (uint32_t)DIAG_TASK_PERIOD_MS;
+	this->time += (uint32_t)DIAG_TASK_PERIOD_MS;
 
+	// Link budget (bytes/s are 1/1000 bytes per ms)
+	this->budget += DIAG_LINK_RATE * DIAG_TASK_PERIOD_MS;
+	if(this->budget > static_cast<int32_t>(DIAG_LINK_BURST * 1000u))
+		this->budget = DIAG_LINK_BURST * 1000u;
 
-	if((localTime % DIAG_LED_PERIOD_MS) == 0)
+	if((this->time % DIAG_LED_PERIOD_MS) == 0)
 	{
 		this->Led();
 	}
 
-	if((localTime % DIAG_TRACES_PERIOD_MS) == 0)
+	if((this->time % DIAG_MEMORY_PERIOD_MS) == 0)
 	{
-		if(this->enable[0])
-			this->TracesMC();
-		if(this->enable[1])
-			this->TracesOD();
+		this->Memory();
+	}
+
+	this->publish();
+
+	// Log, then one trace (or scope) frame, with what is left of the budget
+	if(this->admit(DIAG_FRAME_MAX, DIAG_PRIORITY_LOG, SWO::TELEMETRY))
+	{
+		this->TelemetryLog();
+	}
+
+	if(this->admit(DIAG_FRAME_MAX, DIAG_PRIORITY_DUMP, SWO::TRACE))
+	{
+		if(this->traceDump)
+			this->TelemetryTrace();
+		else if(this->scopeDump)
+			this->TelemetryScope();
 	}
 }
 
 void Diag::taskHandler (void* obj)
 {
-    TickType_t xLastWakeTime;
-    TickType_t xFrequency = pdMS_TO_TICKS(DIAG_TASK_PERIOD_MS);
-
     Diag* instance = _diag;
-    TickType_t prevTick = 0u,  tick = 0u;
 
     float32_t period = 0.0f;
 
     // 1. Initialise periodical task
-    xLastWakeTime = xTaskGetTickCount();
-
-    // 2. Get tick count
-    prevTick = xTaskGetTickCount();
+    instance->periodic.Start();
 
     while(1)
     {
-        // 2. Wait until period elapse
-        vTaskDelayUntil(&xLastWakeTime, xFrequency);
-
-        // 3. Get tick
-        tick = xTaskGetTickCount();
-
-        period = static_cast<float32_t>(tick) -
-                 static_cast<float32_t>(prevTick);
+        // 2. Wait until period elapse, get elapsed ticks
+        period = instance->periodic.Wait();
 
         //4. Compute Diag informations
+        instance->profiler.Start();
         instance->Compute(period);
-
-        // 5. Set previous tick
-        prevTick = tick;
+        instance->profiler.Stop();
     }
 }
@@ -0,0 +1,983 @@
+/**
+ * @file    I2CProtocol.cpp
+ * @author  Jeremy ROULLAND
+ * @date    14 oct. 2017
+ * @brief   Main board command channel (I2C slave register map)
+ */
+
+#include "I2CProtocol.hpp"
+#include "TaskTable.hpp"
+#include "StaticStorage.hpp"
+#include "Config.hpp"
+#include "Boot.hpp"
+#include "SystemState.hpp"
+
+#include <string.h>
+
+/*----------------------------------------------------------------------------*/
+/* Definitions                                                                */
+/*----------------------------------------------------------------------------*/
+
+// Registers refresh period (orders wake up the task immediately)
+#define I2CP_TASK_PERIOD_MS           (TASK_I2CP_PERIOD_MS)
+
+#define I2CP_I2C_ID                   (HAL::I2CSlave::I2C_SLAVE0)
+#define I2CP_CAN_LINK                 (HAL::CAN::CAN0)
+
+#define _PI_                          (3.14159265358979323846)
+
+static_assert(sizeof(i2cp_snapshot_t) < I2C_MAX_FRAME_SIZE, "i2cp_snapshot_t must fit a frame with its CRC");
+static_assert((1u << (Cylinder::CYLINDER_MAX + 1u)) < I2CP_STATUS_READY, "Actuators status bits overlap ready bit");
+static_assert(TP_STREAM_MAX <= 0xFFu, "Free streamed path slots must fit the snapshot");
+
+/*----------------------------------------------------------------------------*/
+/* Private Members                                                            */
+/*----------------------------------------------------------------------------*/
+
+static I2CProtocol* _i2cProtocol = NULL;
+static Utils::StaticStorage<I2CProtocol> _i2cProtocolStorage;
+
+/*----------------------------------------------------------------------------*/
+/* Private Functions                                                          */
+/*----------------------------------------------------------------------------*/
+
+static uint32_t _readRegister (void* obj, uint8_t reg, uint8_t* buffer, uint32_t size)
+{
+    I2CProtocol* protocol = reinterpret_cast<I2CProtocol*>(obj);
+
+    return protocol->INTERNAL_ReadRegister(reg, buffer, size);
+}
+
+static const uint8_t* _preparedResponse (void* obj, uint8_t reg)
+{
+    I2CProtocol* protocol = reinterpret_cast<I2CProtocol*>(obj);
+
+    return protocol->INTERNAL_PreparedResponse(reg);
+}
+
+/**
+ * @brief Parse optional order trailer after a motion order payload
+ * @param payload : Order payload
+ * @param length : Payload length
+ * @param base : Payload length without trailer
+ * @param mode : Submission mode (APPEND without trailer)
+ * @param tag : Order identifier (0 without trailer)
+ * @return false if length or mode is invalid
+ */
+static bool _orderTrailer (const uint8_t* payload, uint32_t length, uint32_t base, CMD_MODE* mode, uint16_t* tag)
+{
+    *mode = CMD_MODE_APPEND;
+    *tag = 0u;
+
+    if(length == base)
+        return true;
+
+    if((length != (base + I2CP_ORDER_TRAILER)) || (payload[base] >= CMD_MODE_MAX))
+        return false;
+
+    *mode = static_cast<CMD_MODE>(payload[base]);
+    memcpy(tag, &payload[base + 1u], sizeof(*tag));
+
+    return true;
+}
+
+/*----------------------------------------------------------------------------*/
+/* Class Implementation                                                       */
+/*----------------------------------------------------------------------------*/
+
+I2CProtocol* I2CProtocol::GetInstance()
+{
+    // If I2CProtocol instance already exists
+    if(_i2cProtocol != NULL)
+    {
+        return _i2cProtocol;
+    }
+    else
+    {
+        _i2cProtocol = new (_i2cProtocolStorage.Get()) I2CProtocol();
+        return _i2cProtocol;
+    }
+}
+
+I2CProtocol::I2CProtocol()
+{
+    this->name = "I2CProtocol";
+    this->taskHandle = NULL;
+
+    this->orders = 0u;
+    this->badCommands = 0u;
+    this->bank = 0u;
+    this->sending = 0u;
+    this->sequence = 0u;
+    this->linkErrors = 0u;
+    this->linkElapsed = static_cast<float32_t>(I2CP_FAULT_LINK_MS);
+    memset(this->registers, 0, sizeof(this->registers));
+    memset(this->responses, 0, sizeof(this->responses));
+    this->timedCount = 0u;
+    this->progressCount = 0u;
+    this->syncStamp = 0u;
+
+    // Out of range address falls back to board 0
+    this->board = static_cast<uint32_t>(Config::Get()->boardAddress);
+    if(this->board >= I2CP_BOARD_MAX)
+        this->board = 0u;
+    this->orderId  = I2CP_CAN_ORDER_ID  + this->board * I2CP_CAN_BOARD_STRIDE;
+    this->statusId = I2CP_CAN_STATUS_ID + this->board * I2CP_CAN_BOARD_STRIDE;
+
+    this->odometry = Odometry::GetInstance(false);
+    this->tp = TrajectoryPlanning::GetInstance(false);
+    this->pc = PositionControl::GetInstance(false);
+    this->mc = FBMotionControl::GetInstance();
+
+    this->man = Mandible::GetInstance(Mandible::ID::MANDIBLE_1);
+    for(uint32_t i = 0; i < Cylinder::CYLINDER_MAX; i++)
+        this->cylinder[i] = Cylinder::GetInstance(static_cast<Cylinder::ID>(i));
+    this->ac = ActuatorControl::GetInstance();
+
+    // Create task
+    this->taskHandle = TaskTable::Create(TaskTable::I2C_PROTOCOL, (TaskFunction_t)(&I2CProtocol::taskHandler), this->name);
+
+    this->i2c = HAL::I2CSlave::GetInstance(I2CP_I2C_ID);
+    this->i2c->SetAddress(static_cast<uint8_t>(this->i2c->GetAddress() + 2u * this->board));
+    this->i2c->SetReadCallback(this, &_readRegister);
+    this->i2c->SetResponseCallback(this, &_preparedResponse);
+
+    // Empty responses until first refresh
+    for(uint32_t b = 0u; b < I2CP_BANKS; b++)
+    {
+        for(uint32_t reg = 0u; reg < I2CP_REG_PREPARED_MAX; reg++)
+            this->i2c->BuildResponse(this->responses[b][reg], 0u, this->responses[b][reg]);
+    }
+    this->i2c->DataReceived.Subscribe<I2CProtocol, &I2CProtocol::INTERNAL_DataReceived>(this);
+
+    this->can = NULL;
+    this->canElapsed = 0.0f;
+#if I2CP_CAN
+    this->can = HAL::CAN::GetInstance(I2CP_CAN_LINK);
+    this->can->SetFilter(0u, this->orderId, I2CP_CAN_ORDER_MASK);
+    this->can->SetFilter(1u, I2CP_CAN_ESTOP_ID, 0x7FFu);
+    this->can->SetFilter(2u, I2CP_CAN_BROADCAST_ID, I2CP_CAN_ORDER_MASK);
+    this->can->MessageReceived.Subscribe<I2CProtocol, &I2CProtocol::INTERNAL_MessageReceived>(this);
+#endif
+}
+
+void I2CProtocol::GetSnapshot(i2cp_snapshot_t* snapshot)
+{
+    taskENTER_CRITICAL();
+    *snapshot = this->registers[this->bank].snapshot;
+    taskEXIT_CRITICAL();
+}
+
+bool I2CProtocol::Post(const I2C_FRAME* frame)
+{
+    if((frame->Length == 0u) || (frame->Length > I2C_MAX_FRAME_SIZE))
+        return false;
+
+    // Clock samples are stamped at reception by the I2C / CAN interrupt
+    if(frame->Data[0] == I2CP_REG_SYNC)
+        return false;
+
+    // Emergency stop without waiting for the task
+    if(frame->Data[0] == I2CP_REG_ESTOP)
+        this->mc->EmergencyStop();
+
+    if(!this->posted.Push(*frame))
+        return false;
+
+    if(this->taskHandle != NULL)
+        xTaskNotifyGive(this->taskHandle);
+
+    return true;
+}
+
+uint32_t I2CProtocol::ReadRegister(uint8_t reg, uint8_t* buffer, uint32_t size)
+{
+    const i2cp_registers_t* image = NULL;
+    const void* data = NULL;
+    uint32_t length = 0u;
+
+    if(reg == I2CP_REG_CLOCK)
+        return this->INTERNAL_ReadRegister(reg, buffer, size);
+
+    // No task switch while copying : the image cannot be written again
+    taskENTER_CRITICAL();
+
+    image = &this->registers[this->bank];
+
+    switch(reg)
+    {
+    case I2CP_REG_STATUS:
+        data = &image->status;
+        length = sizeof(image->status);
+        break;
+    case I2CP_REG_POSITION:
+        data = &image->position;
+        length = sizeof(image->position);
+        break;
+    case I2CP_REG_VELOCITY:
+        data = &image->velocity;
+        length = sizeof(image->velocity);
+        break;
+    case I2CP_REG_ERRORS:
+        data = &image->errors;
+        length = sizeof(image->errors);
+        break;
+    case I2CP_REG_SNAPSHOT:
+        data = &image->snapshot;
+        length = sizeof(image->snapshot);
+        break;
+    default:
+        break;
+    }
+
+    if(length > size)
+        length = size;
+
+    if(data != NULL)
+        memcpy(buffer, data, length);
+
+    taskEXIT_CRITICAL();
+
+    return length;
+}
+
+const uint8_t* I2CProtocol::INTERNAL_PreparedResponse(uint8_t reg)
+{
+    uint32_t bank = this->bank;
+
+    // Clock is current time, built on request
+    if((reg >= I2CP_REG_PREPARED_MAX) || (reg == I2CP_REG_CLOCK))
+        return NULL;
+
+    // The task does not write this image until another one is sent
+    this->sending = bank;
+
+    return this->responses[bank][reg];
+}
+
+uint32_t I2CProtocol::INTERNAL_ReadRegister(uint8_t reg, uint8_t* buffer, uint32_t size)
+{
+    const void* data = NULL;
+    uint32_t length = 0u;
+    i2cp_clock_t clock;
+
+    // Status registers are prepared (see INTERNAL_PreparedResponse)
+    switch(reg)
+    {
+    case I2CP_REG_CLOCK:
+        // Current time, the main board measures the round trip
+        clock.synchronized = Utils::ClockSync::IsSynchronized() ? 1u : 0u;
+        clock.time = (clock.synchronized != 0u) ? Utils::ClockSync::GetMaster() : 0u;
+        clock.error = Utils::ClockSync::GetError();
+        clock.timed = static_cast<uint8_t>(this->timedCount);
+        data = &clock;
+        length = sizeof(clock);
+        break;
+    default:
+        break;
+    }
+
+    if(length > size)
+        length = size;
+
+    if(data != NULL)
+        memcpy(buffer, data, length);
+
+    return length;
+}
+
+void I2CProtocol::INTERNAL_DataReceived()
+{
+    BaseType_t woken = pdFALSE;
+
+    // Emergency stop without waiting for the task
+    if(this->i2c->GetSelected() == I2CP_REG_ESTOP)
+        this->mc->EmergencyStop();
+
+    // Clock sample stamped at reception, not at execution
+    if(this->i2c->GetSelected() == I2CP_REG_SYNC)
+        this->syncStamp = Utils::Clock::GetMicros() - I2CP_SYNC_LATENCY_US;
+
+    if(this->taskHandle != NULL)
+    {
+        vTaskNotifyGiveFromISR(this->taskHandle, &woken);
+        portYIELD_FROM_ISR(woken);
+    }
+}
+
+void I2CProtocol::INTERNAL_MessageReceived()
+{
+    BaseType_t woken = pdFALSE;
+    uint32_t id = this->can->GetReceived()->ID;
+    uint32_t reg = id & ~I2CP_CAN_ORDER_MASK;
+
+    // Same immediate orders as I2C
+    if((id == I2CP_CAN_ESTOP_ID) || (this->isOrder(id) && (reg == I2CP_REG_ESTOP)))
+        this->mc->EmergencyStop();
+
+    if(this->isOrder(id) && (reg == I2CP_REG_SYNC))
+        this->syncStamp = Utils::Clock::GetMicros() - I2CP_SYNC_LATENCY_US;
+
+    if(this->taskHandle != NULL)
+    {
+        vTaskNotifyGiveFromISR(this->taskHandle, &woken);
+        portYIELD_FROM_ISR(woken);
+    }
+}
+
+void I2CProtocol::execute(const I2C_FRAME* frame)
+{
+    const uint8_t* payload = &frame->Data[1];
+    uint32_t length = frame->Length - 1u;
+    bool valid = true;
+
+    int32_t x = 0, y = 0;
+    int16_t o = 0;
+    float32_t v = 0.0f;
+    uint32_t u = 0u;
+    CMD_MODE mode = CMD_MODE_APPEND;
+    uint16_t tag = 0u;
+
+    switch(frame->Data[0])
+    {
+    case I2CP_REG_GOLIN:
+        if((valid = _orderTrailer(payload, length, sizeof(int32_t), &mode, &tag)))
+        {
+            memcpy(&x, payload, sizeof(x));
+            valid = this->mc->GoLin(x, mode, tag);
+        }
+        break;
+
+    case I2CP_REG_GOANG:
+        if((valid = _orderTrailer(payload, length, sizeof(int32_t), &mode, &tag)))
+        {
+            memcpy(&x, payload, sizeof(x));
+            valid = this->mc->GoAng(x, mode, tag);
+        }
+        break;
+
+    case I2CP_REG_GOTO:
+        if((valid = _orderTrailer(payload, length, 2u * sizeof(int32_t), &mode, &tag)))
+        {
+            memcpy(&x, &payload[0], sizeof(x));
+            memcpy(&y, &payload[4], sizeof(y));
+            valid = this->mc->Goto(x, y, mode, tag);
+        }
+        break;
+
+    case I2CP_REG_ARC:
+        if((valid = _orderTrailer(payload, length, 2u * sizeof(int32_t), &mode, &tag)))
+        {
+            memcpy(&x, &payload[0], sizeof(x));
+            memcpy(&y, &payload[4], sizeof(y));
+            valid = this->mc->Arc(x, y, mode, tag);
+        }
+        break;
+
+    case I2CP_REG_ARCTO:
+        if((valid = _orderTrailer(payload, length, 2u * sizeof(int32_t), &mode, &tag)))
+        {
+            memcpy(&x, &payload[0], sizeof(x));
+            memcpy(&y, &payload[4], sizeof(y));
+            valid = this->mc->ArcTo(x, y, mode, tag);
+        }
+        break;
+
+    case I2CP_REG_STOP:
+        this->mc->Stop();
+        this->progressCount = 0u;
+        break;
+
+    case I2CP_REG_ENABLE:
+        if((valid = (length == sizeof(uint8_t))))
+        {
+            if(payload[0] != 0u)
+                this->mc->Enable();
+            else
+                this->mc->Disable();
+        }
+        break;
+
+    case I2CP_REG_SETODO:
+        if((valid = (length == (2u * sizeof(int32_t) + sizeof(int16_t)))))
+        {
+            memcpy(&x, &payload[0], sizeof(x));
+            memcpy(&y, &payload[4], sizeof(y));
+            memcpy(&o, &payload[8], sizeof(o));
+            this->odometry->SetXYO(static_cast<float32_t>(x) / 1000.0f,
+                                   static_cast<float32_t>(y) / 1000.0f,
+                                   static_cast<float32_t>(o) * static_cast<float32_t>(_PI_ / 1800.0));
+        }
+        break;
+
+    case I2CP_REG_CORRECT:
+        if((valid = (length == (2u * sizeof(int32_t) + sizeof(int16_t)))))
+        {
+            memcpy(&x, &payload[0], sizeof(x));
+            memcpy(&y, &payload[4], sizeof(y));
+            memcpy(&o, &payload[8], sizeof(o));
+            this->odometry->Correct(static_cast<float32_t>(x) / 1000.0f,
+                                    static_cast<float32_t>(y) / 1000.0f,
+                                    static_cast<float32_t>(o) * static_cast<float32_t>(_PI_ / 1800.0));
+        }
+        break;
+
+    case I2CP_REG_ROUTE:
+        if((valid = (_orderTrailer(payload, length, sizeof(uint8_t), &mode, &tag) && (payload[0] < Routes::Count()))))
+        {
+            valid = this->mc->Route(payload[0], mode, tag);
+        }
+        break;
+
+    case I2CP_REG_ESTOP:
+        // Latched from interrupt (INTERNAL_DataReceived)
+        break;
+
+    case I2CP_REG_RELEASE:
+        valid = this->mc->ClearEmergency();
+        break;
+
+    case I2CP_REG_SYNC:
+        if((valid = (length == sizeof(uint32_t))))
+        {
+            memcpy(&u, payload, sizeof(u));
+            Utils::ClockSync::Sample(u, this->syncStamp);
+        }
+        break;
+
+    case I2CP_REG_AT:
+        valid = this->schedule(payload, length);
+        break;
+
+    case I2CP_REG_NEAR:
+    case I2CP_REG_WAYPOINT:
+        valid = this->follow(frame->Data[0], payload, length);
+        break;
+
+    case I2CP_REG_MANDIBLE:
+        if((valid = ((length == sizeof(uint8_t)) && (payload[0] < Mandible::Position::Position_MAX))))
+        {
+            this->man->SetPosition(static_cast<Mandible::Position>(payload[0]));
+        }
+        break;
+
+    case I2CP_REG_CYLINDER:
+        if((valid = ((length == 3u) && (payload[0] < Cylinder::CYLINDER_MAX))))
+        {
+            Cylinder* cyl = this->cylinder[payload[0]];
+
+            switch(payload[1])
+            {
+            case I2CP_CYLINDER_OPEN:
+                cyl->Open();
+                break;
+            case I2CP_CYLINDER_CLOSE:
+                cyl->Close();
+                break;
+            case I2CP_CYLINDER_RAISE:
+                cyl->Raise();
+                break;
+            case I2CP_CYLINDER_LOWER:
+                cyl->Lower();
+                break;
+            case I2CP_CYLINDER_GOTO:
+                cyl->Goto(static_cast<int8_t>(payload[2]));
+                break;
+            case I2CP_CYLINDER_SEARCH:
+                cyl->SearchRefPoint();
+                break;
+            case I2CP_CYLINDER_SHIFT:
+                cyl->Shift(static_cast<int8_t>(payload[2]));
+                break;
+            default:
+                valid = false;
+                break;
+            }
+        }
+        break;
+
+    case I2CP_REG_CYLINDERS:
+        if((valid = ((length == 3u) && (payload[0] < (1u << Cylinder::CYLINDER_MAX)) && (payload[1] <= I2CP_CYLINDER_SHIFT))))
+        {
+            ACT_COMMAND cmd;
+
+            // I2CP_CYLINDER_* are Cylinder::Order values
+            cmd.order = payload[1];
+            cmd.arg = static_cast<int8_t>(payload[2]);
+
+            // Actuators task resumes with all orders queued : they start in the same period
+            vTaskSuspendAll();
+            for(uint32_t i = 0; i < Cylinder::CYLINDER_MAX; i++)
+            {
+                if(((payload[0] & (1u << i)) != 0u) && !this->cylinder[i]->Start(cmd).IsValid())
+                    valid = false;
+            }
+            xTaskResumeAll();
+        }
+        break;
+
+    case I2CP_REG_SEQUENCE:
+        if((valid = ((length != 0u) && ((length % sizeof(AC_STEP)) == 0u))))
+        {
+            AC_STEP steps[I2C_MAX_FRAME_SIZE / sizeof(AC_STEP)];
+
+            memcpy(steps, payload, length);
+            valid = (this->ac->Play(steps, length / sizeof(AC_STEP)) == 0);
+        }
+        break;
+
+    case I2CP_REG_CONFIG:
+        if((length == sizeof(uint8_t)) && (payload[0] == I2CP_CONFIG_SAVE))
+        {
+            // Flash erase stalls the CPU
+            valid = !this->mc->IsEnabled() && Config::Commit();
+        }
+        else if((length == sizeof(uint8_t)) && (payload[0] == I2CP_CONFIG_LIVE))
+        {
+            Config::Capture();
+        }
+        else if((valid = (length == (sizeof(uint8_t) + sizeof(float32_t)))))
+        {
+            memcpy(&v, &payload[1], sizeof(v));
+            valid = Config::Set(payload[0], v);
+        }
+        break;
+
+    case I2CP_REG_PARAM:
+        if((valid = (length == (sizeof(uint8_t) + sizeof(float32_t)))))
+        {
+            memcpy(&v, &payload[1], sizeof(v));
+            valid = Utils::Param::Set(payload[0], v);
+        }
+        break;
+
+    case I2CP_REG_PRESET:
+        valid = (length == sizeof(uint8_t)) && this->pc->SelectPreset(payload[0]);
+        break;
+
+    case I2CP_REG_STREAM:
+        if((valid = ((length > sizeof(uint8_t)) && (((length - sizeof(uint8_t)) % (2u * sizeof(int16_t))) == 0u))))
+        {
+            TP_STREAM_POINT points[(I2C_MAX_FRAME_SIZE - 2u) / (2u * sizeof(int16_t))];
+            uint32_t n = (length - sizeof(uint8_t)) / (2u * sizeof(int16_t));
+
+            for(u = 0u; u < n; u++)
+            {
+                memcpy(&o, &payload[1u + 4u * u], sizeof(o));
+                points[u].x = static_cast<float32_t>(o) / 1000.0f;
+                memcpy(&o, &payload[3u + 4u * u], sizeof(o));
+                points[u].y = static_cast<float32_t>(o) / 1000.0f;
+                points[u].last = false;
+            }
+            points[n - 1u].last = ((payload[0] & I2CP_STREAM_LAST) != 0u);
+
+            valid = this->tp->StreamPush(points, n);
+        }
+        break;
+
+    case I2CP_REG_PATH:
+        if((valid = _orderTrailer(payload, length, sizeof(uint8_t), &mode, &tag)))
+        {
+            valid = this->mc->Stream(mode, tag);
+        }
+        break;
+
+    default:
+        valid = false;
+        break;
+    }
+
+    if(valid)
+        this->orders++;
+    else
+        this->badCommands++;
+}
+
+bool I2CProtocol::schedule(const uint8_t* payload, uint32_t length)
+{
+    uint32_t master, at, now, i;
+    uint8_t reg;
+
+    if(!Utils::ClockSync::IsSynchronized() || (length <= sizeof(uint32_t)))
+        return false;
+
+    // Wrapping, emergency or sync orders are immediate
+    reg = payload[sizeof(uint32_t)];
+    if((reg == I2CP_REG_AT) || (reg == I2CP_REG_ESTOP) || (reg == I2CP_REG_SYNC))
+        return false;
+
+    if(this->timedCount >= I2CP_TIMED_MAX)
+        return false;
+
+    memcpy(&master, payload, sizeof(master));
+    at = Utils::ClockSync::ToLocal(master);
+    now = Utils::Clock::GetMicros();
+
+    // Late orders are due now
+    if((static_cast<int32_t>(at - now) > 0) && ((at - now) > I2CP_TIMED_HORIZON_US))
+        return false;
+
+    // Sorted insertion, same time orders keep reception order
+    i = this->timedCount;
+    while((i > 0u) && (static_cast<int32_t>(at - this->timed[i - 1u].at) < 0))
+    {
+        this->timed[i] = this->timed[i - 1u];
+        i--;
+    }
+
+    this->timed[i].at = at;
+    this->timed[i].frame.Type = I2C_FRAME_TYPE_WRITE;
+    this->timed[i].frame.Length = length - sizeof(uint32_t);
+    memcpy(this->timed[i].frame.Data, &payload[sizeof(uint32_t)], this->timed[i].frame.Length);
+    this->timedCount++;
+
+    return true;
+}
+
+void I2CProtocol::trigger()
+{
+    uint32_t now = Utils::Clock::GetMicros();
+    uint32_t i, n = 0u;
+
+    // Executed as received frames (accepted or bad orders counted again)
+    while((n < this->timedCount) && (static_cast<int32_t>(now - this->timed[n].at) >= 0))
+    {
+        this->execute(&this->timed[n].frame);
+        n++;
+    }
+
+    if(n == 0u)
+        return;
+
+    for(i = n; i < this->timedCount; i++)
+        this->timed[i - n] = this->timed[i];
+
+    this->timedCount -= n;
+}
+
+bool I2CProtocol::follow(uint8_t reg, const uint8_t* payload, uint32_t length)
+{
+    uint32_t header = (reg == I2CP_REG_NEAR) ? (2u * sizeof(uint16_t)) : (sizeof(uint16_t) + sizeof(uint8_t));
+    i2cp_progress_t* p = NULL;
+    uint8_t wrapped;
+
+    if(length <= header)
+        return false;
+
+    // Wrapping, emergency or sync orders are immediate
+    wrapped = payload[header];
+    if((wrapped == I2CP_REG_AT) || (wrapped == I2CP_REG_NEAR) || (wrapped == I2CP_REG_WAYPOINT) ||
+       (wrapped == I2CP_REG_ESTOP) || (wrapped == I2CP_REG_SYNC))
+        return false;
+
+    if(this->progressCount >= I2CP_PROGRESS_MAX)
+        return false;
+
+    p = &this->progress[this->progressCount];
+
+    memcpy(&p->tag, &payload[0], sizeof(p->tag));
+    if(reg == I2CP_REG_NEAR)
+    {
+        memcpy(&p->distance, &payload[2], sizeof(p->distance));
+        p->waypoint = -1;
+    }
+    else
+    {
+        p->distance = 0u;
+        p->waypoint = payload[2];
+    }
+
+    // Tag 0 is not acknowledged : would never be due
+    if(p->tag == 0u)
+        return false;
+
+    p->frame.Type = I2C_FRAME_TYPE_WRITE;
+    p->frame.Length = length - header;
+    memcpy(p->frame.Data, &payload[header], p->frame.Length);
+    this->progressCount++;
+
+    return true;
+}
+
+void I2CProtocol::triggerProgress()
+{
+    SYSTEM_STATE s;
+    uint32_t i, n = 0u;
+    bool due;
+
+    if(this->progressCount == 0u)
+        return;
+
+    SystemState::Read(&s);
+
+    // Executed as received frames, in reception order, others kept
+    for(i = 0u; i < this->progressCount; i++)
+    {
+        i2cp_progress_t* p = &this->progress[i];
+
+        if(s.finishedTag == p->tag)
+            due = true;
+        else if(s.runningTag != p->tag)
+            due = false;
+        else if(p->waypoint < 0)
+            due = (s.remaining * 1000.0f) < static_cast<float32_t>(p->distance);
+        else
+            due = (s.waypoint >= static_cast<uint32_t>(p->waypoint));
+
+        if(!due)
+        {
+            this->progress[n++] = *p;
+            continue;
+        }
+
+        // A wrapped STOP drops the pending ones
+        this->execute(&p->frame);
+        if(this->progressCount == 0u)
+            return;
+    }
+
+    this->progressCount = n;
+}
+
+void I2CProtocol::receive()
+{
+    CAN_MSG msg;
+    I2C_FRAME frame;
+
+    while(this->can->Read(&msg) == NO_ERROR)
+    {
+        // Broadcast emergency stop latched from interrupt
+        if(!this->isOrder(msg.ID))
+            continue;
+
+        frame.Type = I2C_FRAME_TYPE_WRITE;
+        frame.Length = 1u + msg.Length;
+        frame.Data[0] = static_cast<uint8_t>(msg.ID & ~I2CP_CAN_ORDER_MASK);
+        memcpy(&frame.Data[1], msg.Data, msg.Length);
+
+        this->execute(&frame);
+    }
+}
+
+void I2CProtocol::publish()
+{
+    const i2cp_snapshot_t* snapshot = &this->registers[this->bank].snapshot;
+    i2cp_can_status_t status;
+    i2cp_can_position_t position;
+    i2cp_can_faults_t faults;
+    i2cp_velocity_t velocity;
+    CAN_MSG msg;
+
+    status.mc        = snapshot->mc;
+    status.actuators = snapshot->actuators;
+    status.orders    = snapshot->orders;
+    status.running   = snapshot->running;
+    status.finished  = snapshot->finished;
+
+    msg.ID = this->statusId + I2CP_CAN_STATUS;
+    msg.Length = sizeof(status);
+    memcpy(msg.Data, &status, sizeof(status));
+    this->can->Write(&msg);
+
+    position.x = static_cast<int16_t>(snapshot->x);
+    position.y = static_cast<int16_t>(snapshot->y);
+    position.o = snapshot->o;
+
+    msg.ID = this->statusId + I2CP_CAN_POSITION;
+    msg.Length = sizeof(position);
+    memcpy(msg.Data, &position, sizeof(position));
+    this->can->Write(&msg);
+
+    velocity.linear  = snapshot->linear;
+    velocity.angular = snapshot->angular;
+
+    msg.ID = this->statusId + I2CP_CAN_VELOCITY;
+    msg.Length = sizeof(velocity);
+    memcpy(msg.Data, &velocity, sizeof(velocity));
+    this->can->Write(&msg);
+
+    faults.faults   = snapshot->faults;
+    faults.sequence = snapshot->sequence;
+
+    msg.ID = this->statusId + I2CP_CAN_FAULTS;
+    msg.Length = sizeof(faults);
+    memcpy(msg.Data, &faults, sizeof(faults));
+    this->can->Write(&msg);
+}
+
+void I2CProtocol::update(float32_t period)
+{
+    // Write the image which is neither answered nor possibly still sent, then publish
+    uint32_t sending = this->sending;
+    uint32_t next = (this->bank + 1u) % I2CP_BANKS;
+    i2cp_registers_t* image = NULL;
+    i2cp_snapshot_t* snapshot = NULL;
+    uint32_t errors = 0u;
+    uint16_t faults = 0u;
+    SYSTEM_STATE s;
+
+    if(next == sending)
+        next = (next + 1u) % I2CP_BANKS;
+
+    image = &this->registers[next];
+    snapshot = &image->snapshot;
+
+    SystemState::Read(&s);
+
+    image->status.mc = s.mc;
+    image->status.tp = s.tp;
+    image->status.pc = s.pc;
+    image->status.od = s.od;
+    image->status.actuators = 0u;
+    for(uint32_t i = 0; i < Cylinder::CYLINDER_MAX; i++)
+    {
+        if(this->cylinder[i]->IsPositioningFinished())
+            image->status.actuators |= (1u << i);
+    }
+    if(this->man->IsPositioningFinished())
+        image->status.actuators |= (1u << Cylinder::CYLINDER_MAX);
+    if(!this->ac->IsPlaying())
+        image->status.actuators |= (1u << (Cylinder::CYLINDER_MAX + 1u));
+    if(Boot::IsReady())
+        image->status.actuators |= I2CP_STATUS_READY;
+    image->status.orders = this->orders;
+    image->status.running = s.runningTag;
+    image->status.finished = s.finishedTag;
+
+    image->position.x = s.xmm;
+    image->position.y = s.ymm;
+    image->position.o = static_cast<int16_t>(s.odeg * 10.0f);
+
+    image->velocity.linear  = s.linearVelocity;
+    image->velocity.angular = s.angularVelocity;
+
+    image->errors.crc     = this->i2c->GetCRCErrors();
+    image->errors.overrun = this->i2c->GetOverruns();
+    image->errors.command = this->badCommands;
+
+    // Faults
+    if(s.emergency)
+        faults |= I2CP_FAULT_EMERGENCY;
+    if(s.wheelStall)
+        faults |= I2CP_FAULT_WHEEL_STALL;
+    for(uint32_t i = 0; i < Cylinder::CYLINDER_MAX; i++)
+    {
+        if(this->cylinder[i]->IsStalled())
+            faults |= I2CP_FAULT_ACTUATOR_STALL;
+    }
+
+    errors = image->errors.crc + image->errors.overrun + image->errors.command;
+#if I2CP_CAN
+    errors += this->can->GetOverruns() + this->can->GetBusErrors();
+    if(this->can->IsBusOff())
+        faults |= I2CP_FAULT_CAN_BUS_OFF;
+#endif
+
+    if(errors != this->linkErrors)
+    {
+        this->linkErrors = errors;
+        this->linkElapsed = 0.0f;
+    }
+    else if(this->linkElapsed < static_cast<float32_t>(I2CP_FAULT_LINK_MS))
+        this->linkElapsed += period;
+
+    if(this->linkElapsed < static_cast<float32_t>(I2CP_FAULT_LINK_MS))
+        faults |= I2CP_FAULT_LINK;
+
+    // Snapshot of this refresh
+    snapshot->sequence  = ++this->sequence;
+    snapshot->faults    = faults;
+    snapshot->mc        = image->status.mc;
+    snapshot->actuators = image->status.actuators;
+    snapshot->orders    = image->status.orders;
+    snapshot->running   = image->status.running;
+    snapshot->finished  = image->status.finished;
+    snapshot->x         = image->position.x;
+    snapshot->y         = image->position.y;
+    snapshot->o         = image->position.o;
+    snapshot->linear    = image->velocity.linear;
+    snapshot->angular   = image->velocity.angular;
+    snapshot->stream    = static_cast<uint8_t>(this->tp->GetStreamFree());
+
+    // Responses sent as is by the interrupt
+    this->i2c->BuildResponse(&image->status, sizeof(image->status), this->responses[next][I2CP_REG_STATUS]);
+    this->i2c->BuildResponse(&image->position, sizeof(image->position), this->responses[next][I2CP_REG_POSITION]);
+    this->i2c->BuildResponse(&image->velocity, sizeof(image->velocity), this->responses[next][I2CP_REG_VELOCITY]);
+    this->i2c->BuildResponse(&image->errors, sizeof(image->errors), this->responses[next][I2CP_REG_ERRORS]);
+    this->i2c->BuildResponse(snapshot, sizeof(*snapshot), this->responses[next][I2CP_REG_SNAPSHOT]);
+
+    __DMB();
+    this->bank = next;
+}
+
+void I2CProtocol::Compute(float32_t period)
+{
+    I2C_FRAME frame;
+    const I2C_FRAME* posted;
+
+    // Stalled transfer recovery
+    this->i2c->Supervise();
+
+    // Orders, in reception order
+    while(this->i2c->Read(&frame) == NO_ERROR)
+    {
+        this->execute(&frame);
+    }
+
+    // Orders from other links
+    while((posted = this->posted.Front()) != NULL)
+    {
+        this->execute(posted);
+        this->posted.Release();
+    }
+
+#if I2CP_CAN
+    this->receive();
+#endif
+
+    // Time and progress triggered orders
+    this->trigger();
+    this->triggerProgress();
+
+    // Status
+    this->update(period);
+
+#if I2CP_CAN
+    // Status messages (dropped by the driver if the bus is busy)
+    this->canElapsed += period;
+    if(this->canElapsed >= static_cast<float32_t>(I2CP_CAN_PERIOD_MS))
+    {
+        this->canElapsed = 0.0f;
+        this->publish();
+    }
+#endif
+}
+
+void I2CProtocol::taskHandler (void* obj)
+{
+    I2CProtocol* instance = _i2cProtocol;
+    TickType_t prevTick = 0u,  tick = 0u;
+
+    float32_t period = 0.0f;
+
+    // 1. Get tick count
+    prevTick = xTaskGetTickCount();
+
+    while(1)
+    {
+        // 2. Wait for an order or registers refresh period
+        ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(I2CP_TASK_PERIOD_MS));
+
+        // 3. Get tick
+        tick = xTaskGetTickCount();
+
+        period = static_cast<float32_t>(tick) -
+                 static_cast<float32_t>(prevTick);
+
+        //4. Execute orders and refresh registers
+        instance->Compute(period);
+
+        // 5. Set previous tick
+        prevTick = tick;
+    }
+}
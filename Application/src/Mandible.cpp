@@ -6,8 +6,11 @@
  */
 
 #include "Mandible.hpp"
+#include "StaticStorage.hpp"
+#include "Watch.hpp"
+
+#include <math.h>
 
-#include "FreeRTOS.h"
 #include "task.h"
 
 /*----------------------------------------------------------------------------*/
@@ -18,6 +21,25 @@
 #define MANDIBLE1_HIGH_SIDE_GPIO    (HAL::GPIO::ID::GPIO38)
 #define MANDIBLE1_LOW_SIDE_GPIO     (HAL::GPIO::ID::GPIO37)
 #define MANDIBLE1_POWER_PWM         (HAL::PWM::ID::PWM15)
+#define MANDIBLE1_SENSE_ADC         (HAL::ADConverter::ADC_Channel3)
+
+// Positions (percent of travel)
+#define MANDIBLE_BOTTOM             (0.0f)
+#define MANDIBLE_TOP                (100.0f)
+
+// Drive : duty cycle ramp
+#define MANDIBLE_POWER              (0.1f)
+#define MANDIBLE_POWER_START        (0.03f)
+#define MANDIBLE_RAMP_MS            (100u)
+
+// End stop : current sense above threshold (12 bits), confirmed by consecutive checks
+#define MANDIBLE_BLANKING_MS        (40u)       // Start current ignored
+#define MANDIBLE_STALL_LSB          (1200u)
+#define MANDIBLE_STALL_CONFIRM      (2u)
+#define MANDIBLE_TIMEOUT_MS         (1000u)
+
+// Full travel time until measured
+#define MANDIBLE_TRAVEL_MS          (500u)
 
 
 /*----------------------------------------------------------------------------*/
@@ -25,6 +47,7 @@
 /*----------------------------------------------------------------------------*/
 
 static Mandible* _instance[Mandible::ID::MANDIBLE_MAX] = {NULL};
+static Utils::StaticStorage<Mandible, Mandible::ID::MANDIBLE_MAX> _instanceStorage;
 
 /*----------------------------------------------------------------------------*/
 /* Private Functions                                                          */
@@ -47,6 +70,7 @@ static MAN_DEF _getMANStruct (enum Mandible::ID id)
         def.highSideGpioId = MANDIBLE1_HIGH_SIDE_GPIO;
         def.lowSideGpioId  = MANDIBLE1_LOW_SIDE_GPIO;
         def.PowerPwmId     = MANDIBLE1_POWER_PWM;
+        def.SenseAdcId     = MANDIBLE1_SENSE_ADC;
         break;
 
      default:
@@ -75,13 +99,13 @@ Mandible* Mandible::GetInstance(Mandible::ID id)
 
     if(_instance[id] == NULL)
     {
-        _instance[id] = new Mandible(id);
+        _instance[id] = new (_instanceStorage.Get(id)) Mandible(id);
     }
 
     return _instance[id];
 }
 
-Mandible::Mandible(Mandible::ID id)
+Mandible::Mandible(Mandible::ID id) : Actuator(1u)
 {
     this->id = id;
     this->def = _getMANStruct(id);
@@ -89,49 +113,193 @@ Mandible::Mandible(Mandible::ID id)
     this->highSide = HAL::GPIO::GetInstance(this->def.highSideGpioId);
     this->lowSide  = HAL::GPIO::GetInstance(this->def.lowSideGpioId);
     this->power    = HAL::PWM::GetInstance(this->def.PowerPwmId);
+    this->sense    = HAL::ADConverter::GetInstance(this->def.SenseAdcId);
 
     this->highSide->Set(HAL::GPIO::State::Low);
     this->lowSide->Set(HAL::GPIO::State::Low);
     this->power->SetDutyCycle(0.0f);
 
-    this->pos = Bottom;
+    this->percent = MANDIBLE_BOTTOM;
+
+    this->orders   = xQueueCreateStatic(MAN_ORDERS_MAX, sizeof(float32_t), this->ordersStorage, &this->ordersBuffer);
+    this->target   = MANDIBLE_BOTTOM;
+    this->busy     = false;
+    this->started  = 0u;
+    this->duration = 0u;
+    this->endStop  = false;
+    this->sensed   = 0u;
+
+    this->travel   = pdMS_TO_TICKS(MANDIBLE_TRAVEL_MS);
+    this->timeouts = 0u;
+
+    WATCH_MEMBER("man", percent);
+    WATCH_MEMBER("man", travel);
+    WATCH_MEMBER("man", timeouts);
 
     //_hardwareInit(id);
 }
 
-void Mandible::SetPosition(Mandible::Position pos)
+ActuatorHandle Mandible::Start(const ACT_COMMAND& cmd)
 {
-    if (pos == Top)
+    float32_t percent = 0.0f;
+
+    switch(cmd.order)
     {
-        this->lowSide->Set(HAL::GPIO::State::High);
-        this->power->SetDutyCycle(0.1);
-        vTaskDelay(pdMS_TO_TICKS(500));
-        this->power->SetDutyCycle(0.0);
-        this->lowSide->Set(HAL::GPIO::State::Low);
-        this->pos = pos;
+    case Top:
+        percent = MANDIBLE_TOP;
+        break;
+    case Bottom:
+        percent = MANDIBLE_BOTTOM;
+        break;
+    case Middle:
+        percent = (MANDIBLE_TOP + MANDIBLE_BOTTOM) / 2.0f;
+        break;
+    default:
+        return ActuatorHandle(-1);
+    }
+
+    return this->enqueue(0u, this->orders, &percent);
+}
+
+int8_t Mandible::SetPosition(Mandible::Position pos)
+{
+    ACT_COMMAND cmd = {static_cast<uint8_t>(pos), 0};
+
+    return this->Start(cmd).IsValid() ? 0 : -1;
+}
+
+int8_t Mandible::SetPosition(float32_t percent)
+{
+    if(percent > MANDIBLE_TOP)
+        percent = MANDIBLE_TOP;
+    else if(percent < MANDIBLE_BOTTOM)
+        percent = MANDIBLE_BOTTOM;
+
+    return (this->enqueue(0u, this->orders, &percent).IsValid()) ? 0 : -1;
+}
+
+bool Mandible::IsPositioningFinished()
+{
+    return !this->busy && (uxQueueMessagesWaiting(this->orders) == 0u);
+}
+
+uint8_t Mandible::GetProgress()
+{
+    TickType_t elapsed = 0u;
+    TickType_t total = 0u;
+
+    if(!this->busy)
+        return this->IsPositioningFinished() ? 100u : 0u;
+
+    elapsed = xTaskGetTickCount() - this->started;
+    total   = this->expected();
+
+    if((total == 0u) || (elapsed >= total))
+        return 99u;
+
+    return static_cast<uint8_t>((100u * elapsed) / total);
+}
+
+void Mandible::Process()
+{
+    // Running order
+    if(this->busy)
+    {
+        if(!this->check())
+            return;
+
+        this->stop();
+        this->busy = false;
+        this->complete(0u);
     }
-    else if (pos == Bottom)
+
+    // Next order
+    if(xQueueReceive(this->orders, &this->target, 0) == pdTRUE)
     {
+        if(this->start(this->target))
+            this->complete(0u);
+        else
+            this->busy = true;
+    }
+}
+
+TickType_t Mandible::expected()
+{
+    return static_cast<TickType_t>(fabsf(this->target - this->percent) * static_cast<float32_t>(this->travel) /
+                                   (MANDIBLE_TOP - MANDIBLE_BOTTOM));
+}
+
+bool Mandible::start(float32_t goal)
+{
+    this->endStop = (goal == MANDIBLE_TOP) || (goal == MANDIBLE_BOTTOM);
+    this->duration = this->expected();
+    this->sensed = 0u;
+
+    // Already there (end stops are always driven : position may be lost)
+    if(!this->endStop && (this->duration == 0u))
+    {
+        this->percent = goal;
+        return true;
+    }
+
+    if((goal > this->percent) || (goal == MANDIBLE_TOP))
+        this->lowSide->Set(HAL::GPIO::State::High);
+    else
         this->highSide->Set(HAL::GPIO::State::High);
-        this->power->SetDutyCycle(0.1);
-        vTaskDelay(pdMS_TO_TICKS(500));
-        this->power->SetDutyCycle(0.0);
-        this->highSide->Set(HAL::GPIO::State::Low);
-        this->pos = pos;
+
+    this->power->SetDutyCycle(MANDIBLE_POWER_START);
+    this->started = xTaskGetTickCount();
+
+    return false;
+}
+
+bool Mandible::check()
+{
+    TickType_t elapsed = xTaskGetTickCount() - this->started;
+    bool done = false;
+
+    // Duty cycle ramp : no inrush current peak, no jaw bounce
+    if(elapsed < pdMS_TO_TICKS(MANDIBLE_RAMP_MS))
+        this->power->SetDutyCycle(MANDIBLE_POWER_START + (MANDIBLE_POWER - MANDIBLE_POWER_START) *
+                                  static_cast<float32_t>(elapsed) / static_cast<float32_t>(pdMS_TO_TICKS(MANDIBLE_RAMP_MS)));
+    else
+        this->power->SetDutyCycle(MANDIBLE_POWER);
+
+    if(this->endStop)
+    {
+        // Jaw arrived : motor stalls, current rises (start current is ignored)
+        if((elapsed >= pdMS_TO_TICKS(MANDIBLE_BLANKING_MS)) && (this->sense->GetResult() >= MANDIBLE_STALL_LSB))
+            this->sensed++;
+        else
+            this->sensed = 0u;
+
+        if(this->sensed >= MANDIBLE_STALL_CONFIRM)
+        {
+            // End to end move : full travel time
+            if(fabsf(this->target - this->percent) >= (MANDIBLE_TOP - MANDIBLE_BOTTOM))
+                this->travel = elapsed;
+            done = true;
+        }
+        else if(elapsed >= pdMS_TO_TICKS(MANDIBLE_TIMEOUT_MS))
+        {
+            this->timeouts++;
+            done = true;
+        }
+    }
+    else
+    {
+        done = (elapsed >= this->duration);
     }
+
+    if(done)
+        this->percent = this->target;
+
+    return done;
 }
 
-void Mandible::SetPosition(float32_t percent)
+void Mandible::stop()
 {
-    if (percent < 0.0)
-        percent = 0.0;
-    else if (percent > 1.0)
-        percent = 1.0;
-
-    this->highSide->Set(HAL::GPIO::State::High);
-    this->power->SetDutyCycle(0.1);
-    vTaskDelay(pdMS_TO_TICKS(1000));
     this->power->SetDutyCycle(0.0);
     this->highSide->Set(HAL::GPIO::State::Low);
-
+    this->lowSide->Set(HAL::GPIO::State::Low);
 }
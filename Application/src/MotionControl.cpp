@@ -6,30 +6,49 @@
  */
 
 #include "MotionControl.hpp"
+#include "TaskTable.hpp"
+#include "StaticStorage.hpp"
+#include "Clock.hpp"
+#include "Retain.hpp"
+#include "SystemState.hpp"
 
 /*----------------------------------------------------------------------------*/
 /* Definitions                                                                */
 /*----------------------------------------------------------------------------*/
 
-#define MC_TASK_STACK_SIZE          (256u)
-#define MC_TASK_PRIORITY            (configMAX_PRIORITIES-3)
+#define MC_TASK_PERIOD_MS           (TASK_MC_PERIOD_MS)
+#define TP_TASK_PERIOD_MS           (PC_TASK_PERIOD_MS)
+#define VC_TASK_PERIOD_MS           (PC_VC_PERIOD_MS)
 
-#define MC_TASK_PERIOD_MS           (5u)
-#define SENS_TASK_PERIOD_MS           (200u)
-#define TP_TASK_PERIOD_MS           (200u)
-#define PG_TASK_PERIOD_MS           (10u)
-#define PC_TASK_PERIOD_MS           (100u)
-#define VC_TASK_PERIOD_MS           (5u)
+// Run on each new odometry sample instead of a free running period
+// (MC_TASK_PERIOD_MS must then be the odometry loop period)
+#define MC_EVENT_DRIVEN             (1u)
+#define MC_EVENT_TIMEOUT_MS         (2u * MC_TASK_PERIOD_MS)
+
+// Obstacle : velocity override from front telemeter instead of a stop and flush
+// (override 1 below START ratio of detection threshold, MIN at threshold, 0 above)
+#define MC_OBSTACLE_SLOWDOWN        (1u)
+#define MC_SLOWDOWN_START           (0.5f)
+#define MC_SLOWDOWN_MIN             (0.2f)
+
+// Obstacle sensing follows commanded linear velocity sign (front forward, rear backward)
+#define MC_SENSE_VEL_MIN            (0.005f)
+
+// Obstacle interrupt triggers the emergency stop (instead of a hold or a stop)
+#define MC_OBSTACLE_ESTOP           (0u)
+
+// Emergency stop input (active low, EXTI above configMAX_SYSCALL)
+#define MC_ESTOP_GPIO               (HAL::GPIO::GPIO57)
+
+// Cyclic executive frame (software timer ticks)
+#define MC_FRAME_TICKS              ((MC_TASK_PERIOD_MS * 1000u) / SOFTTIMER_TICK_US)
 
 /*----------------------------------------------------------------------------*/
 /* Private Members                                                            */
 /*----------------------------------------------------------------------------*/
 
 static MotionControl::FBMotionControl* _motionControl = NULL;
-
-/*----------------------------------------------------------------------------*/
-/* Private Functions                                                          */
-/*----------------------------------------------------------------------------*/
+static Utils::StaticStorage<MotionControl::FBMotionControl> _motionControlStorage;
 
 namespace MotionControl
 {
@@ -43,15 +62,17 @@ namespace MotionControl
         }
         else
         {
-            _motionControl = new FBMotionControl();
+            _motionControl = new (_motionControlStorage.Get()) FBMotionControl();
             return _motionControl;
         }
     }
 
-    FBMotionControl::FBMotionControl()
+    FBMotionControl::FBMotionControl() : profiler("MotionControl"), periodic("MotionControl", MC_TASK_PERIOD_MS),
+        obstacleWork(Utils::Deferred::Work::Bind<FBMotionControl, &FBMotionControl::obstacleHalt>(this, Utils::Deferred::HIGH))
     {
         this->name = "MotionControl";
         this->taskHandle = NULL;
+        this->health = Utils::Watchdog::Register(this->name, TASK_WATCHDOG_PERIODS * MC_TASK_PERIOD_MS);
 
         // Set 16 Flags Status
         this->status = 0x0000;
@@ -62,32 +83,392 @@ namespace MotionControl
         // MotionControl Safeguard is enabled by default
         this->safeguard = true;
 
-        // Odometry instance created in standalone mode
-        this->odometry = Odometry::GetInstance(true);
+        // Odometry instance created in standalone mode (or run by the executive)
+        this->odometry = Odometry::GetInstance(!TASK_CYCLIC_EXECUTIVE);
 
-        // VC, PC instances creations
+        // PC, TP instances creations (PositionControl is the only profile stage)
         this->pc = PositionControl::GetInstance(false);
-        this->pg = ProfileGenerator::GetInstance(false);
         this->tp = TrajectoryPlanning::GetInstance(false);
 
         this->telAv = HAL::Telemeter::GetInstance(HAL::Telemeter::TELEMETER_2);
         this->telAr = HAL::Telemeter::GetInstance(HAL::Telemeter::TELEMETER_1);
 
+        // Velocity and acceleration limits follow battery voltage
+        this->battery = Battery::GetInstance();
+
+        // Obstacle : ADC analog watchdog interrupt on the sensed telemeter only
+        this->obstacle = false;
+        this->sensed = NULL;
+        this->telAv->Detected.Subscribe<FBMotionControl, &FBMotionControl::INTERNAL_Obstacle>(this);
+        this->telAr->Detected.Subscribe<FBMotionControl, &FBMotionControl::INTERNAL_Obstacle>(this);
+
+        // Emergency stop input
+        this->emergency = false;
+        this->estop = HAL::GPIO::GetInstance(MC_ESTOP_GPIO);
+        this->estop->StateChanged.Subscribe<FBMotionControl, &FBMotionControl::EmergencyStop>(this);
+
+        this->frames = 0u;
+        this->overruns = 0u;
+        this->missed = 0u;
+        this->ordersPeak = 0u;
+
+        // Arrival computed by TrajectoryPlanning without waiting for its period
+        this->settled = false;
+        this->pc->PositioningSettled.Subscribe<FBMotionControl, &FBMotionControl::INTERNAL_Settled>(this);
+
         // Create task
-        xTaskCreate((TaskFunction_t)(&FBMotionControl::taskHandler),
-                    this->name.c_str(),
-                    MC_TASK_STACK_SIZE,
-                    NULL,
-                    MC_TASK_PRIORITY,
-                    NULL);
+#if TASK_CYCLIC_EXECUTIVE
+        this->taskHandle = TaskTable::Create(TaskTable::MOTION_CONTROL, (TaskFunction_t)(&FBMotionControl::executiveHandler), this->name);
+#else
+        this->taskHandle = TaskTable::Create(TaskTable::MOTION_CONTROL, (TaskFunction_t)(&FBMotionControl::taskHandler), this->name);
+#endif
+
+        this->Qorders = xQueueCreateStatic(MC_ORDERS_MAX, sizeof(cmd_t), this->QordersStorage, &this->QordersBuffer);
+        Utils::Trace::Queue(this->Qorders, MC_ORDERS_TRACE_ID);
+        this->prefetched = false;
+        this->Qurgent = xQueueCreateStatic(MC_URGENT_MAX, sizeof(cmd_t), this->QurgentStorage, &this->QurgentBuffer);
+
+        this->runningTag = 0u;
+        this->finishedTag = 0u;
+        this->aborted = 0u;
+        this->running = false;
+
+        // Warm restart : last finished tag kept, running order reported aborted
+        if(Retain::GetRestored() != NULL)
+        {
+            this->finishedTag = Retain::GetRestored()->finishedTag;
+            if(Retain::GetRestored()->runningTag != 0u)
+                this->aborted = 1u;
+        }
+
+        this->events = xEventGroupCreateStatic(&this->eventsBuffer);
+        this->abortedPublished = 0u;
+
+        this->latencyPending = false;
+        this->ResetLatency();
+
+        // Runtime inspection (CLI watch, peek)
+        WATCH_MEMBER("mc", status);
+        WATCH_MEMBER("mc", running);
+        WATCH_MEMBER("mc", runningTag);
+        WATCH_MEMBER("mc", finishedTag);
+        WATCH_MEMBER("mc", aborted);
+        WATCH_MEMBER("mc", obstacle);
+        WATCH_MEMBER("mc", frames);
+        WATCH_MEMBER("mc", overruns);
+        WATCH_MEMBER("mc", missed);
+
+#if TASK_CYCLIC_EXECUTIVE
+        // Frames paced by hardware timer (software timer wheel)
+        this->frameTimer.Elapsed.Subscribe<FBMotionControl, &FBMotionControl::INTERNAL_Frame>(this);
+        this->frameTimer.Start(MC_FRAME_TICKS, MC_FRAME_TICKS);
+#elif MC_EVENT_DRIVEN
+        // Measurement to actuation chain : Odometry -> PositionControl
+        this->odometry->SampleAvailable.Subscribe<FBMotionControl, &FBMotionControl::INTERNAL_OdometrySample>(this);
+#endif
+    }
+
+    void FBMotionControl::INTERNAL_OdometrySample()
+    {
+        if(this->taskHandle != NULL)
+            xTaskNotifyGive(this->taskHandle);
+    }
+
+    void FBMotionControl::INTERNAL_Frame()
+    {
+        BaseType_t woken = pdFALSE;
+
+        this->frames = this->frames + 1u;
+
+        if(this->taskHandle != NULL)
+        {
+            vTaskNotifyGiveFromISR(this->taskHandle, &woken);
+            portYIELD_FROM_ISR(woken);
+        }
+    }
+
+    void FBMotionControl::INTERNAL_Settled()
+    {
+        // Raised by PositionControl::Compute(), in this task
+        this->settled = true;
+    }
+
+    void FBMotionControl::INTERNAL_Obstacle()
+    {
+        if(this->enable == false)
+            return;
+
+#if MC_OBSTACLE_ESTOP
+        this->EmergencyStop();
+#else
+        // Profiles are changed by the deferred worker, out of ADC interrupt
+        this->obstacleWork.Post();
+#endif
+
+        this->obstacle = true;
+    }
+
+    void FBMotionControl::obstacleHalt()
+    {
+#if MC_OBSTACLE_SLOWDOWN
+        // Hold profiles now, resumed by the task once the path is clear
+        this->pc->SetVelocityOverride(0.0f);
+#elif !MC_OBSTACLE_ESTOP
+        // Stop trajectory now, position control releases the wheels on its next period
+        this->tp->halt();
+        this->pc->Disable();
+#endif
+    }
+
+    void FBMotionControl::sense()
+    {
+        float32_t v = this->pc->GetLinearVelocityProfiled();
+        HAL::Telemeter* tel = this->sensed;
+
+        // Moving : telemeter facing velocity. Still and not held : none (rotation in place).
+        // Held by an obstacle, velocity is 0 : keep sensing until released.
+        if(v > MC_SENSE_VEL_MIN)
+            tel = this->telAv;
+        else if(v < -MC_SENSE_VEL_MIN)
+            tel = this->telAr;
+        else if(this->pc->GetVelocityOverride() >= 1.0f)
+            tel = NULL;
+
+        if(tel == this->sensed)
+            return;
+
+        if(this->sensed != NULL)
+            this->sensed->DisableDetection();
+        if(tel != NULL)
+            tel->EnableDetection();
+
+        this->sensed = tel;
+    }
+
+    float32_t FBMotionControl::obstacleOverride(HAL::Telemeter* tel)
+    {
+        float32_t hard, start, value;
+        float32_t ratio = 1.0f;
+
+        if(tel == NULL)
+            return 1.0f;
+
+        hard  = static_cast<float32_t>(tel->GetDetectThreshold());
+        start = MC_SLOWDOWN_START * hard;
+        value = static_cast<float32_t>(tel->GetFiltered());
+
+        // Inside threshold : stop (hysteresis), up to the filters window after an interrupt
+        if(tel->Detect() || this->obstacle)
+            return 0.0f;
+
+        // Telemeter value rises as the obstacle gets closer
+        if(value > start)
+        {
+            ratio = 1.0f - (1.0f - MC_SLOWDOWN_MIN) * (value - start) / (hard - start);
+            if(ratio < MC_SLOWDOWN_MIN)
+                ratio = MC_SLOWDOWN_MIN;
+        }
+
+        return ratio;
+    }
+
+    uint32_t FBMotionControl::PushPath(const struct cmd_t cmds[], uint32_t n)
+    {
+        uint32_t i = 0;
+
+        struct cmd_t cmd;
+        uint32_t now = Utils::Clock::GetMicros();
+
+        if(uxQueueSpacesAvailable(this->Qorders) < n)
+            return 0;
+
+        for(i = 0; i < n; i++)
+        {
+            cmd = cmds[i];
+            cmd.stamp = now;
+
+            if(!CmdIsOrder(cmd.id))
+                break;
+            if(xQueueSend(this->Qorders, (void*) &cmd, 0) != pdTRUE)
+                break;
+        }
+
+        this->notePending();
+
+        return i;
+    }
+
+    bool FBMotionControl::Push(const struct cmd_t* cmd)
+    {
+        QueueHandle_t queue = (cmd->mode == CMD_MODE_APPEND) ? this->Qorders : this->Qurgent;
+        struct cmd_t stamped = *cmd;
+
+        // Type tag is the only check : payload layout is fixed by the schema
+        if(!CmdIsOrder(cmd->id))
+            return false;
+
+        stamped.stamp = Utils::Clock::GetMicros();
+
+        if(xQueueSend(queue, (void*) &stamped, 0) != pdTRUE)
+            return false;
+
+        if(queue == this->Qorders)
+            this->notePending();
+
+        return true;
+    }
+
+    void FBMotionControl::notePending()
+    {
+        uint32_t pending = uxQueueMessagesWaiting(this->Qorders);
+
+        // Submitting tasks may race : statistics only, no lock
+        if(pending > this->ordersPeak)
+            this->ordersPeak = pending;
+    }
+
+    void FBMotionControl::start(const struct cmd_t* cmd)
+    {
+        // Latency runs until the first step played from now
+        this->latencyStart = cmd->stamp;
+        this->latencyPending = true;
+        HAL::Drv8813::ArmStepProbe();
+
+        this->dispatch(cmd);
+
+        this->running = true;
+        this->runningTag = cmd->tag;
+
+        Utils::Scope::Trigger(Utils::Scope::ORDER);
+    }
+
+    void FBMotionControl::dispatch(const struct cmd_t* cmd)
+    {
+        switch (cmd->id)
+        {
+        case CMD_ID_GOLIN:
+            this->tp->goLinear(cmd->data.d);
+            break;
+        case CMD_ID_GOANG:
+            this->tp->goAngular(cmd->data.a);
+            break;
+        case CMD_ID_GOTO:
+            this->tp->gotoXY(cmd->data.xy.x, cmd->data.xy.y);
+            break;
+        case CMD_ID_ROUTE:
+            this->tp->route(cmd->data.route);
+            break;
+        case CMD_ID_ARC:
+            this->tp->goArc(cmd->data.arc.radius, cmd->data.arc.length);
+            break;
+        case CMD_ID_ARCTO:
+            this->tp->arcXY(cmd->data.xy.x, cmd->data.xy.y);
+            break;
+        case CMD_ID_STALLX:
+            this->tp->stallX(0);
+            break;
+        case CMD_ID_STALLY:
+            this->tp->stallY(0);
+            break;
+        case CMD_ID_STREAM:
+            this->tp->streamXY();
+            break;
+        default:
+            break;
+        }
+    }
+
+    void FBMotionControl::acknowledge()
+    {
+        // TrajectoryPlanning computed the running order at least once
+        if(this->running && this->tp->isFinished())
+        {
+            this->finishedTag = this->runningTag;
+            this->running = false;
+            this->runningTag = 0u;
+            xEventGroupSetBits(this->events, MC_EVENT_ORDER_DONE);
+        }
+    }
+
+    void FBMotionControl::plan(float32_t period)
+    {
+        this->tp->GetProfiler()->Start();
+        this->tp->Compute((period * TP_TASK_PERIOD_MS) / MC_TASK_PERIOD_MS);
+        this->tp->GetProfiler()->Stop();
+    }
 
-        this->mutex = xSemaphoreCreateMutex();
+    void FBMotionControl::publishEvents()
+    {
+        EventBits_t bits = xEventGroupGetBits(this->events) & MC_EVENT_STATUS;
+        EventBits_t levels = this->status & MC_EVENT_STATUS;
+        uint32_t aborted = this->aborted;
+
+        // Changes only : waiters are woken once
+        if((levels & ~bits) != 0u)
+            xEventGroupSetBits(this->events, levels & ~bits);
+        if((bits & ~levels) != 0u)
+            xEventGroupClearBits(this->events, bits & ~levels);
+
+        // Counted by abort() in any task
+        if(aborted != this->abortedPublished)
+        {
+            this->abortedPublished = aborted;
+            xEventGroupSetBits(this->events, MC_EVENT_ORDER_ABORTED);
+        }
+    }
+
+    void FBMotionControl::measureLatency()
+    {
+        uint32_t step = 0u;
+        uint32_t latency = 0u;
+        uint32_t bin = 0u;
+
+        if(!this->latencyPending)
+            return;
+
+        if(!HAL::Drv8813::ReadStepProbe(&step))
+        {
+            // Order without motion
+            if((Utils::Clock::GetMicros() - this->latencyStart) > MC_LATENCY_TIMEOUT_US)
+                this->latencyPending = false;
+            return;
+        }
+
+        this->latencyPending = false;
 
-        this->Qorders = xQueueCreate(10, sizeof(cmd_t));
+        latency = step - this->latencyStart;
+        bin = 32u - __CLZ(latency);
+
+        if(latency < this->latencyMin)
+            this->latencyMin = latency;
+        if(latency > this->latencyMax)
+            this->latencyMax = latency;
+
+        this->latencySum += latency;
+        this->latencyCount++;
+
+        if(bin >= MC_LATENCY_HISTOGRAM_SIZE)
+            bin = MC_LATENCY_HISTOGRAM_SIZE - 1u;
+        this->latencyHistogram[bin]++;
+    }
+
+    void FBMotionControl::ResetLatency()
+    {
+        this->latencyMin = 0xFFFFFFFFu;
+        this->latencyMax = 0u;
+        this->latencySum = 0u;
+        this->latencyCount = 0u;
+
+        for(uint32_t i = 0; i < MC_LATENCY_HISTOGRAM_SIZE; i++)
+            this->latencyHistogram[i] = 0u;
     }
 
     void FBMotionControl::Enable()
     {
+        // Emergency stop must be released first
+        if(this->emergency)
+            return;
+
     	this->enable = true;
     	this->pc->Enable();
     }
@@ -98,6 +479,26 @@ namespace MotionControl
     	this->pc->Disable();
     }
 
+    void FBMotionControl::EmergencyStop()
+    {
+        // Outputs first, the task handles orders on its next period
+        HAL::Drv8813::EmergencyStop();
+
+        this->emergency = true;
+    }
+
+    bool FBMotionControl::ClearEmergency()
+    {
+        // Input still active
+        if(this->estop->Get() == HAL::GPIO::Low)
+            return false;
+
+        HAL::Drv8813::ClearEmergency();
+        this->emergency = false;
+
+        return true;
+    }
+
     void FBMotionControl::Test()
     {
         static uint32_t localTime = 0;
@@ -109,19 +510,18 @@ namespace MotionControl
         if((localTime % TP_TASK_PERIOD_MS) == 0)
             this->tp->Compute(TP_TASK_PERIOD_MS);
 
-        // #2 Schedule PositionControl
+        // #3 Schedule PositionControl
         if((localTime % PC_TASK_PERIOD_MS) == 0)
             this->pc->Compute(PC_TASK_PERIOD_MS);
-
-        // #3 Schedule ProfileGenerator
-        /*if((localTime % PG_TASK_PERIOD_MS) == 0)
-            this->pg->Compute(PG_TASK_PERIOD_MS);*/
     }
 
     void FBMotionControl::Compute(float32_t period)
     {
         static uint32_t localTime = 0;
-        cmd_t cmd;
+        bool started = false;
+        struct cmd_t urgent;
+
+        Utils::Watchdog::CheckIn(this->health);
 
         // Update configuration & state status
         if(this->enable)
@@ -134,97 +534,271 @@ namespace MotionControl
         else
         	this->status &= ~(1<<1);
 
+        // Emergency stop latched : orders flushed, motion control disabled until released
+        if(this->emergency)
+        {
+            this->status |= (1<<2);
+
+            if(this->enable)
+            {
+                this->Stop();
+                this->tp->halt();
+                this->Disable();
+            }
+        }
+        else
+            this->status &= ~(1<<2);
+
         if(this->tp->isFinished())
             this->status |= (1<<8);
         else
             this->status &= ~(1<<8);
 
+        this->publishEvents();
+
+        // Checkpoint for a warm restart (pose and cylinders saved by their owners)
+        Retain::SetOrders(this->runningTag, this->finishedTag);
+        Retain::Commit();
+
         // Schedule MotionControl
         localTime += MC_TASK_PERIOD_MS;
 
+        // Started order has played its first step
+        this->measureLatency();
+
+        // Battery voltage, limits of next setpoints
+        this->battery->Update();
+        this->pc->SetLimitScale(this->battery->GetScale());
+
         // If MotionControl is disabled then don't schedule submodules
         if(this->enable == false)
             return;
 
-        if((localTime % SENS_TASK_PERIOD_MS) == 0)
+        // Telemeters filters
+        this->telAv->Update();
+        this->telAr->Update();
+
+        // Telemeter facing the commanded motion
+        this->sense();
+
+#if MC_OBSTACLE_SLOWDOWN
+        // Velocity override from obstacle distance, held on an interrupt detection
+        this->pc->SetVelocityOverride(this->obstacleOverride(this->sensed));
+        if(this->obstacle)
+            xEventGroupSetBits(this->events, MC_EVENT_OBSTACLE);
+        this->obstacle = false;
+#else
+        // Obstacle latched by interrupt : flush orders, then watch again
+        if(this->obstacle)
         {
-            if(this->telAv->Detect())
-            {
-                this->Stop();
-            }
+            this->obstacle = false;
+            this->Stop();
+            xEventGroupSetBits(this->events, MC_EVENT_OBSTACLE);
         }
+#endif
+        if(this->sensed != NULL)
+            this->sensed->ArmDetection();
 
-        // #1 Schedule TrajectoryPlanning
-        if((localTime % TP_TASK_PERIOD_MS) == 0)
+        // #0 Acknowledge running order
+        this->acknowledge();
+
+        // #1 Urgent order aborts current one now
+        if(xQueueReceive(this->Qurgent, &urgent, 0) == pdTRUE)
         {
-            // 1- Pull orders one by one
-            if(this->tp->isFinished())
-            {
-                if(xQueueReceive(this->Qorders, &cmd, 0) == pdTRUE)
-                {
-                    switch (cmd.id)
-                    {
-                    case CMD_ID_GOLIN:
-                        this->tp->goLinear(cmd.data.d);
-                        break;
-                    case CMD_ID_GOANG:
-                        this->tp->goAngular(cmd.data.a);
-                        break;
-                    case CMD_ID_GOTO:
-                        this->tp->gotoXY(cmd.data.xy.x, cmd.data.xy.y);
-                        break;
-                    default:
-                        break;
-                    }
-                }
-            }
-            // 2- Compute TrajectoryPlanning
-            this->tp->Compute((period * TP_TASK_PERIOD_MS) / MC_TASK_PERIOD_MS);
+            if(urgent.mode == CMD_MODE_REPLACE)
+                xQueueReset(this->Qorders);
+            else if(this->prefetched)
+                xQueueSendToFront(this->Qorders, &this->next, 0);   // Slot freed by the prefetch
+
+            this->prefetched = false;
+            this->abort();
+            this->start(&urgent);
+            started = true;
+        }
+
+        // #1 Pull next order as soon as current one decelerates
+        if(!started && !this->prefetched && (this->tp->isFinished() || this->tp->isDecelerating()))
+            this->prefetched = (xQueueReceive(this->Qorders, &this->next, 0) == pdTRUE);
+
+        // Start it as soon as current one is finished
+        if(this->prefetched && this->tp->isFinished())
+        {
+            this->start(&this->next);
+            this->prefetched = false;
+            started = true;
+        }
+
+        // #2 Schedule TrajectoryPlanning (new order and arrival are computed immediately)
+        if(started || this->settled || ((localTime % TP_TASK_PERIOD_MS) == 0))
+        {
+            this->settled = false;
+            this->plan(period);
         }
 
         // #2 Schedule PositionControl
         if((localTime % PC_TASK_PERIOD_MS) == 0)
+        {
+            this->pc->GetProfiler()->Start();
             this->pc->Compute((period * PC_TASK_PERIOD_MS) / MC_TASK_PERIOD_MS);
+            this->pc->GetProfiler()->Stop();
+        }
 
-        // #3 Schedule ProfileGenerator
-        /*if((localTime % PG_TASK_PERIOD_MS) == 0)
-            this->pg->Compute((period * PG_TASK_PERIOD_MS) / MC_TASK_PERIOD_MS);*/
+        // #2 Order settled by this PositionControl computation : finish it and
+        // start the next one in this period (was up to two periods later)
+        if(this->settled)
+        {
+            this->settled = false;
+            this->plan(period);
+            this->acknowledge();
+
+            if(!this->prefetched && this->tp->isFinished())
+                this->prefetched = (xQueueReceive(this->Qorders, &this->next, 0) == pdTRUE);
+
+            if(this->prefetched && this->tp->isFinished())
+            {
+                this->start(&this->next);
+                this->prefetched = false;
+                this->plan(period);
+            }
+        }
+
+        // #3 Schedule velocity loop (PositionControl cascade), after a new velocity setpoint
+        if((localTime % VC_TASK_PERIOD_MS) == 0)
+            this->pc->ComputeVelocity((period * VC_TASK_PERIOD_MS) / MC_TASK_PERIOD_MS);
     }
 
 
     void FBMotionControl::taskHandler(void* obj)
     {
-        TickType_t xLastWakeTime;
-        TickType_t xFrequency = pdMS_TO_TICKS(MC_TASK_PERIOD_MS);
-
         FBMotionControl* instance = _motionControl;
-        TickType_t prevTick = 0u,  tick = 0u;
 
         float32_t period = 0.0f;
 
         // 1. Initialise periodical task
-        xLastWakeTime = xTaskGetTickCount();
-
-        // 2. Get tick count
-        prevTick = xTaskGetTickCount();
+        instance->periodic.Start();
 
         while(1)
         {
-            // 2. Wait until period elapse
-            vTaskDelayUntil(&xLastWakeTime, xFrequency);
-
-            // 3. Get tick
-            tick = xTaskGetTickCount();
-
-            period = static_cast<float32_t>(tick) -
-                     static_cast<float32_t>(prevTick);
+#if MC_EVENT_DRIVEN
+            // 2. Wait for a new odometry sample (period is kept if odometry stalls)
+            ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(MC_EVENT_TIMEOUT_MS));
+            period = instance->periodic.Mark();
+#else
+            // 2. Wait until period elapse, get elapsed ticks
+            period = instance->periodic.Wait();
+#endif
 
             //4. Compute velocity (MotionControl)
+            instance->profiler.Start();
             instance->Compute(period);
+            instance->stateSlot(period);
+            instance->profiler.Stop();
+
+            // Scope capture at control loop rate
+            Utils::Scope::Sample();
             //instance->Test();
+        }
+    }
+
+    void FBMotionControl::odometrySlot(float32_t period)
+    {
+        this->odometry->GetProfiler()->Start();
+        this->odometry->Compute(period);
+        this->odometry->GetProfiler()->Stop();
+
+        this->odometry->SampleAvailable();
+    }
+
+    void FBMotionControl::stateSlot(float32_t period)
+    {
+        SYSTEM_STATE s;
+        robot_t r;
+
+        (void)period;
+
+        this->odometry->GetRobot(&r);
+
+        s.tick                    = xTaskGetTickCount();
+        s.xmm                     = r.Xmm;
+        s.ymm                     = r.Ymm;
+        s.odeg                    = r.Odeg;
+        s.linearPosition          = this->odometry->GetLinearPosition();
+        s.angularPosition         = r.O;
+        s.linearVelocity          = this->odometry->GetLinearVelocity();
+        s.angularVelocity         = this->odometry->GetAngularVelocity();
+        s.linearPositionProfiled  = this->pc->GetLinearPositionProfiled();
+        s.angularPositionProfiled = this->pc->GetAngularPositionProfiled();
+        s.step                    = this->tp->GetStep();
+        s.remaining               = this->tp->GetRemaining();
+        s.waypoint                = this->tp->GetWaypoint();
+        s.mc                      = this->status;
+        s.tp                      = this->tp->GetStatus();
+        s.pc                      = this->pc->GetStatus();
+        s.od                      = this->odometry->GetStatus();
+        s.runningTag              = this->runningTag;
+        s.finishedTag             = this->finishedTag;
+        s.emergency               = this->emergency;
+        s.wheelStall              = this->pc->isStalled();
+
+        SystemState::Publish(&s);
+    }
+
+    void FBMotionControl::executiveHandler(void* obj)
+    {
+        /**
+         * Slot table, run in order on frames where (frame % period) == offset
+         * Measurement to actuation : Odometry -> MotionControl (TrajectoryPlanning,
+         * PositionControl and steppers outputs are scheduled by Compute())
+         */
+        static const struct
+        {
+            void (FBMotionControl::*run)(float32_t period);
+            uint32_t period;
+            uint32_t offset;
+        } slots[] =
+        {
+            {&FBMotionControl::odometrySlot,    1u, 0u},
+            {&FBMotionControl::Compute,         1u, 0u},
+            {&FBMotionControl::stateSlot,       1u, 0u},
+        };
+        static const uint32_t count = sizeof(slots) / sizeof(slots[0]);
+
+        FBMotionControl* instance = _motionControl;
+        uint32_t frame = 0u, last[count], pending = 0u, started = 0u;
+
+        for(uint32_t i = 0u; i < count; i++)
+            last[i] = 0u;
+
+        instance->periodic.Start();
+
+        while(1)
+        {
+            // 1. Wait for next frame, more than one pending : frames were skipped
+            pending = ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+            if(pending > 1u)
+                instance->missed += pending - 1u;
+            (void)instance->periodic.Mark();
+
+            frame += pending;
+            started = instance->frames;
+
+            // 2. Run due slots with the time elapsed since their last run
+            instance->profiler.Start();
+            for(uint32_t i = 0u; i < count; i++)
+            {
+                if((frame % slots[i].period) != slots[i].offset)
+                    continue;
+
+                (instance->*slots[i].run)(static_cast<float32_t>((frame - last[i]) * MC_TASK_PERIOD_MS));
+                last[i] = frame;
+            }
+            instance->profiler.Stop();
+
+            Utils::Scope::Sample();
 
-            // 5. Set previous tick
-            prevTick = tick;
+            // 3. Overrun : next frame started before the end of this one
+            if(instance->frames != started)
+                instance->overruns++;
         }
     }
 }
@@ -7,6 +7,7 @@
 
 #include "MotionProfile.hpp"
 #include "common.h"
+#include "FastMath.hpp"
 
 #include <stdio.h>
 #include <stdlib.h>
@@ -14,10 +15,56 @@
 
 using namespace MotionControl;
 
+/*----------------------------------------------------------------------------*/
+/* Private Members                                                            */
+/*----------------------------------------------------------------------------*/
+
+/**
+ * @brief Normalized polynomial coefficients (s = c0 + c1.t + ... + c5.t^5)
+ */
+static constexpr float32_t _poly3[MPROFILE_POLY_DEGREE + 1u]  = {0.0f, 0.0f,   3.0f, -2.0f,   0.0f,   0.0f};
+static constexpr float32_t _poly5[MPROFILE_POLY_DEGREE + 1u]  = {0.0f, 0.0f,   0.0f, 10.0f, -15.0f,   6.0f};
+static constexpr float32_t _poly5P1[MPROFILE_POLY_DEGREE + 1u] = {0.0f, 0.0f,  0.0f,  2.5f, -1.875f, 0.375f};
+static constexpr float32_t _poly5P2[MPROFILE_POLY_DEGREE + 1u] = {0.0f, 1.875f, 0.0f, -1.25f, 0.0f,  0.375f};
+
+#if MPROFILE_LUT
+/**
+ * @brief Compile time polynomial evaluation : sum(i >= n) k(i).c[i].t^(i-n), k = 1, i, i.(i-1)
+ */
+static constexpr float32_t _polyEval(const float32_t * c, float32_t t, uint32_t i, uint32_t n)
+{
+    return (i > MPROFILE_POLY_DEGREE) ? 0.0f :
+           static_cast<float32_t>((n == 0u) ? 1u : ((n == 1u) ? i : i * (i - 1u))) * c[i] + t * _polyEval(c, t, i + 1u, n);
+}
+
+/**
+ * @brief Compile time index list
+ */
+template<uint32_t... I> struct _lutIndexes {};
+template<uint32_t N, uint32_t... I> struct _lutMakeIndexes : _lutMakeIndexes<N - 1u, N - 1u, I...> {};
+template<uint32_t... I> struct _lutMakeIndexes<0u, I...> { typedef _lutIndexes<I...> type; };
+
+template<uint32_t... I>
+static constexpr mprofile_lut_t _lutBuild(const float32_t * c, _lutIndexes<I...>)
+{
+    return {{_polyEval(c, static_cast<float32_t>(I) / MPROFILE_LUT_SIZE, 0u, 0u)...},
+            {_polyEval(c, static_cast<float32_t>(I) / MPROFILE_LUT_SIZE, 1u, 1u)...},
+            {_polyEval(c, static_cast<float32_t>(I) / MPROFILE_LUT_SIZE, 2u, 2u)...}};
+}
+
+/**
+ * @brief Normalized shape tables (generated at compile time, stored in flash)
+ */
+static constexpr mprofile_lut_t _lut3   = _lutBuild(_poly3,   _lutMakeIndexes<MPROFILE_LUT_SIZE + 1u>::type());
+static constexpr mprofile_lut_t _lut5   = _lutBuild(_poly5,   _lutMakeIndexes<MPROFILE_LUT_SIZE + 1u>::type());
+static constexpr mprofile_lut_t _lut5P1 = _lutBuild(_poly5P1, _lutMakeIndexes<MPROFILE_LUT_SIZE + 1u>::type());
+static constexpr mprofile_lut_t _lut5P2 = _lutBuild(_poly5P2, _lutMakeIndexes<MPROFILE_LUT_SIZE + 1u>::type());
+#endif
+
 namespace MotionControl
 {
 
-    MotionProfile::MotionProfile(float32_t maxVel, float32_t maxAcc, enum PROFILE profile)
+    MotionProfile::MotionProfile(float32_t maxVel, float32_t maxAcc, enum PROFILE profile, float32_t maxJerk)
     {
         assert(profile < PROFILE::MPROFILE_MAX);
 
@@ -25,17 +72,29 @@ namespace MotionControl
 
         this->mode = MODE_AUTO;
 
-        this->startTime = 0.0;
+        this->startTime = 0.0f;
 
-        this->setPoint   = 0.0;
-        this->startPoint = 0.0;
+        this->setPoint   = 0.0f;
+        this->startPoint = 0.0f;
 
         this->maxVel = maxVel;
         this->maxAcc = maxAcc;
+        this->maxJerk = maxJerk;
 
-        this->tf = 1.0;
+        this->tf = 1.0f;
 
         this->finished = false;
+        this->progress = 0.0f;
+
+        this->minTime = 0.0f;
+        this->lut = NULL;
+        this->startVelocity = 0.0f;
+        this->lastPoint = 0.0f;
+        this->scurveParts = 0;
+        for(uint32_t i = 0; i <= MPROFILE_POLY_DEGREE; i++)
+            this->coef[i] = 0.0f;
+
+        this->dirty = true;
     }
 
     MotionProfile::~MotionProfile()
@@ -47,9 +106,48 @@ namespace MotionControl
         return this->finished;
     }
 
+    bool MotionProfile::isDecelerating()
+    {
+        bool decelerating = this->finished;
+
+        switch (this->profile)
+        {
+            case SCURVE:
+                // Last part deceleration phase
+                if(this->scurveParts > 0u)
+                    decelerating |= ((this->progress * this->minTime) >= (this->minTime - this->scurve[this->scurveParts - 1u].td));
+                break;
+
+            case TRIANGLE:
+            case POLY3:
+            case POLY5:
+            case POLY5_P2:
+                // Symmetric profiles
+                decelerating |= (this->progress >= 0.5f);
+                break;
+
+            case TRAPEZ:
+                if(this->minTime > 0.0f)
+                    decelerating |= (this->progress >= (1.0f - (this->maxVel / this->maxAcc) / this->minTime));
+                break;
+
+            default:
+                // No deceleration phase (step, constant velocity or acceleration only)
+                break;
+        }
+
+        return decelerating;
+    }
+
     void MotionProfile::SetPoint(float32_t point)
     {
-    	this->setPoint = point - this->startPoint;
+        float32_t setPoint = point - this->startPoint;
+
+        if(setPoint != this->setPoint)
+        {
+            this->setPoint = setPoint;
+            this->dirty = true;
+        }
     }
 
     void MotionProfile::SetSetPoint(float32_t point, float32_t currentPoint, float32_t currentTime)
@@ -57,33 +155,336 @@ namespace MotionControl
         this->startTime = currentTime;
         this->startPoint = currentPoint;
 
+        this->startVelocity = 0.0f;
+        this->lastPoint = currentPoint;
+
+        this->mode = MODE_AUTO;
+
         this->setPoint = point - this->startPoint;
 
         this->finished = false;
+        this->progress = 0.0f;
+
+        this->dirty = true;
     }
 
-    float32_t MotionProfile::Get(float32_t time)
+    void MotionProfile::Replan(float32_t point, float32_t currentTime)
+    {
+        const float32_t dt = 0.001f;
+        float32_t t = currentTime - this->startTime;
+        float32_t p = this->lastPoint, v = 0.0f;
+
+        if((this->profile == SCURVE) && !this->finished)
+        {
+            this->update();
+
+            // Current state on running profile
+            p = this->startPoint + this->calculateSCurvePosition(t);
+            v = (this->calculateSCurvePosition(t) - this->calculateSCurvePosition(t - dt)) / dt;
+        }
+
+        this->startTime = currentTime;
+        this->startPoint = p;
+        this->startVelocity = v;
+        this->lastPoint = p;
+
+        this->mode = MODE_AUTO;
+
+        this->setPoint = point - this->startPoint;
+
+        this->finished = false;
+        this->progress = 0.0f;
+
+        this->dirty = true;
+    }
+
+    void MotionProfile::Brake(float32_t currentTime)
+    {
+        const float32_t dt = 0.001f;
+        float32_t t = currentTime - this->startTime;
+        float32_t p = this->lastPoint, v = 0.0f;
+
+        if((this->profile == SCURVE) && !this->finished)
+        {
+            this->update();
+
+            // Current state on running profile (same as Replan())
+            p = this->startPoint + this->calculateSCurvePosition(t);
+            v = (this->calculateSCurvePosition(t) - this->calculateSCurvePosition(t - dt)) / dt;
+        }
+
+        this->Brake(p, v, currentTime);
+    }
+
+    void MotionProfile::Brake(float32_t currentPoint, float32_t velocity, float32_t currentTime)
+    {
+        float32_t tj = 0.0f, td = 0.0f;
+        float32_t distance = 0.0f;
+
+        if(this->profile != SCURVE)
+            velocity = 0.0f;
+
+        // Stop phase only : setpoint on the stop point (see calculateSCurvePlan())
+        if(velocity != 0.0f)
+        {
+            this->calculateSCurveStop(abs(velocity), &tj, &td);
+            distance = velocity * td / 2.0f;
+        }
+
+        this->startTime = currentTime;
+        this->startPoint = currentPoint;
+        this->startVelocity = velocity;
+        this->lastPoint = currentPoint;
+
+        this->mode = MODE_AUTO;
+
+        this->setPoint = distance;
+
+        this->finished = false;
+        this->progress = 0.0f;
+
+        this->dirty = true;
+    }
+
+    void MotionProfile::update()
+    {
+        const float32_t * poly = NULL;
+        const mprofile_lut_t * lut = NULL;
+
+        if(this->dirty == false)
+            return;
+
+        this->minTime = this->calculateMinTime();
+
+        if(this->profile == SCURVE)
+            this->calculateSCurvePlan(this->setPoint, this->startVelocity, this->scurve, &this->scurveParts);
+
+        switch (this->profile)
+        {
+            case POLY3:
+                poly = _poly3;
+#if MPROFILE_LUT
+                lut = &_lut3;
+#endif
+                break;
+            case POLY5:
+                poly = _poly5;
+#if MPROFILE_LUT
+                lut = &_lut5;
+#endif
+                break;
+            case POLY5_P1:
+            case AUTO:
+                poly = _poly5P1;
+#if MPROFILE_LUT
+                lut = &_lut5P1;
+#endif
+                break;
+            case POLY5_P2:
+                poly = _poly5P2;
+#if MPROFILE_LUT
+                lut = &_lut5P2;
+#endif
+                break;
+            default:
+                break;
+        }
+
+        this->lut = lut;
+
+        for(uint32_t i = 0; i <= MPROFILE_POLY_DEGREE; i++)
+            this->coef[i] = (poly != NULL) ? (poly[i] * this->setPoint) : 0.0f;
+
+        this->dirty = false;
+    }
+
+    float32_t MotionProfile::interpolate(const float32_t * table, float32_t t)
+    {
+        float32_t x = t * static_cast<float32_t>(MPROFILE_LUT_SIZE);
+        uint32_t i = 0;
+
+        if(x <= 0.0f)
+            return table[0];
+        if(x >= static_cast<float32_t>(MPROFILE_LUT_SIZE))
+            return table[MPROFILE_LUT_SIZE];
+
+        i = static_cast<uint32_t>(x);
+        x -= static_cast<float32_t>(i);
+
+        return table[i] + x * (table[i + 1u] - table[i]);
+    }
+
+    float32_t MotionProfile::horner(float32_t t)
+    {
+        float32_t s = this->coef[MPROFILE_POLY_DEGREE];
+
+        if(this->lut != NULL)
+            return this->interpolate(this->lut->s, t) * this->setPoint;
+
+        for(int32_t i = MPROFILE_POLY_DEGREE - 1; i >= 0; i--)
+            s = s * t + this->coef[i];
+
+        return s;
+    }
+
+    float32_t MotionProfile::GetDuration()
+    {
+        this->update();
+
+        if((this->mode == MODE_MANUAL) && (this->tf > this->minTime))
+            return this->tf;
+
+        return this->minTime;
+    }
+
+    void MotionProfile::hornerDerivatives(float32_t t, float32_t* d1, float32_t* d2)
+    {
+        float32_t v = 0.0f, a = 0.0f;
+
+        if(this->lut != NULL)
+        {
+            *d1 = this->interpolate(this->lut->v, t) * this->setPoint;
+            *d2 = this->interpolate(this->lut->a, t) * this->setPoint;
+            return;
+        }
+
+        for(int32_t i = MPROFILE_POLY_DEGREE; i >= 2; i--)
+            a = a * t + static_cast<float32_t>(i * (i - 1)) * this->coef[i];
+
+        for(int32_t i = MPROFILE_POLY_DEGREE; i >= 1; i--)
+            v = v * t + static_cast<float32_t>(i) * this->coef[i];
+
+        *d1 = v;
+        *d2 = a;
+    }
+
+    float32_t MotionProfile::GetVelocity(float32_t time)
+    {
+        float32_t v = 0.0f, a = 0.0f;
+
+        this->calculateDerivatives(time, &v, &a);
+
+        return v;
+    }
+
+    float32_t MotionProfile::GetAcceleration(float32_t time)
+    {
+        float32_t v = 0.0f, a = 0.0f;
+
+        this->calculateDerivatives(time, &v, &a);
+
+        return a;
+    }
+
+    void MotionProfile::calculateDerivatives(float32_t time, float32_t* v, float32_t* a)
     {
-        float32_t r = 0.0;
-        float32_t tf = 0.0;
+        float32_t tf = this->GetDuration();
+        float32_t t = time - this->startTime;
+        float32_t k = 0.0f;
+
+        *v = 0.0f;
+        *a = 0.0f;
+
+        if((tf <= 0.0f) || (t < 0.0f))
+            return;
+
+        // Normalized time
+        t /= tf;
+
+        switch (this->profile)
+        {
+            case LINEAR:
+                if(t < 1.0f)
+                    *v = this->setPoint / tf;
+                break;
+
+            case TRIANGLE:
+                if(t <= 0.5f)
+                {
+                    *v = 4.0f * t * this->setPoint / tf;
+                    *a = 4.0f * this->setPoint / (tf * tf);
+                }
+                else if(t < 1.0f)
+                {
+                    *v = (4.0f - 4.0f * t) * this->setPoint / tf;
+                    *a = -4.0f * this->setPoint / (tf * tf);
+                }
+                break;
+
+            case SCURVE:
+                if((t < 1.0f) && (this->minTime > 0.0f))
+                {
+                    // Stretched time scale
+                    k = this->minTime / tf;
+
+                    t *= this->minTime;
+                    for(uint32_t i = 0; i < this->scurveParts; i++)
+                    {
+                        if((t <= this->scurve[i].T) || ((i + 1u) == this->scurveParts))
+                        {
+                            this->calculateSCurvePart(&this->scurve[i], t, v, a);
+                            break;
+                        }
+                        t -= this->scurve[i].T;
+                    }
+
+                    *v *= k;
+                    *a *= k * k;
+                }
+                break;
+
+            case POLY3:
+            case POLY5:
+            case POLY5_P1:
+            case POLY5_P2:
+                if(t < 1.0f)
+                {
+                    this->hornerDerivatives(t, v, a);
+                    *v /= tf;
+                    *a /= tf * tf;
+                }
+                break;
+
+            case AUTO:
+                if(t <= 1.0f)
+                {
+                    this->hornerDerivatives(t, v, a);
+                    *v /= tf;
+                    *a /= tf * tf;
+                }
+                else if(t < 2.0f)
+                {
+                    *v = 1.875f * this->setPoint / tf;
+                }
+                break;
 
-		tf = calculateMinTime();
+            default:
+                break;
+        }
+    }
 
-        r = this->Get(time, tf);
+    float32_t MotionProfile::Get(float32_t time)
+    {
+        float32_t r = 0.0f;
+
+        r = this->Get(time, this->GetDuration());
 
         return r;
     }
 
     float32_t MotionProfile::Get(float32_t time, float32_t tf)
     {
-        float32_t r = 0.0;
-        float32_t t = 0.0;
+        float32_t r = 0.0f;
+        float32_t t = 0.0f;
 
         t = time - this->startTime;
-        assert(t >= 0.0);
+        assert(t >= 0.0f);
+
+        this->update();
 
         this->tf = tf;
         t /= tf;
+        this->progress = t;
 
         r = this->calculateProfile(t);
 
@@ -92,7 +493,7 @@ namespace MotionControl
 
     float32_t MotionProfile::calculateProfile(float32_t t)
     {
-        float32_t r = 0.0;
+        float32_t r = 0.0f;
 
         switch (this->profile)
         {
@@ -137,18 +538,20 @@ namespace MotionControl
                 break;
 
             default:
-                r = 1.0;
+                r = 1.0f;
                 break;
         }
 
         r += this->startPoint;
 
+        this->lastPoint = r;
+
         return r;
     }
 
     float32_t MotionProfile::calculateMinTime(enum MotionProfile::PROFILE profile)
     {
-        float32_t tf = 0.0, tfVel = 0.0, tfAcc = 0.0;
+        float32_t tf = 0.0f, tfVel = 0.0f, tfAcc = 0.0f;
 
         if(profile == AUTO)
         	profile = this->profile;
@@ -157,12 +560,12 @@ namespace MotionControl
         {
             case LINEAR:
                 tfVel = abs(this->setPoint) / this->maxVel;
-                tfAcc = 0.0;
+                tfAcc = 0.0f;
                 break;
 
             case TRIANGLE:
-                tfVel = 2.0 * abs(this->setPoint) / this->maxVel;
-                tfAcc = 2.0 * sqrt( abs(this->setPoint) / this->maxAcc );
+                tfVel = 2.0f * abs(this->setPoint) / this->maxVel;
+                tfAcc = 2.0f * Utils::Sqrt( abs(this->setPoint) / this->maxAcc );
                 break;
 
             case TRAPEZ:
@@ -171,34 +574,39 @@ namespace MotionControl
                 break;
 
             case SCURVE:
-                tfVel = 1.0;
-                tfAcc = 1.0;
+            {
+                struct scurve_t part[MPROFILE_SCURVE_PARTS];
+                uint32_t n = 0;
+
+                tfVel = this->calculateSCurvePlan(this->setPoint, this->startVelocity, part, &n);
+                tfAcc = tfVel;
                 break;
+            }
 
             case POLY3:
-                tfVel = (3.0 * abs(this->setPoint)) / (2.0 * this->maxVel);
-                tfAcc = sqrt( (6.0 * abs(this->setPoint)) / this->maxAcc );
+                tfVel = (3.0f * abs(this->setPoint)) / (2.0f * this->maxVel);
+                tfAcc = Utils::Sqrt( (6.0f * abs(this->setPoint)) / this->maxAcc );
                 break;
 
             case POLY5:
-                tfVel = (15.0 * abs(this->setPoint)) / (8.0 * this->maxVel);
-                tfAcc = sqrt( (10.0 * abs(this->setPoint)) / (sqrt(3) * this->maxAcc) );
+                tfVel = (15.0f * abs(this->setPoint)) / (8.0f * this->maxVel);
+                tfAcc = Utils::Sqrt( (10.0f * abs(this->setPoint)) / (FASTMATH_SQRT3 * this->maxAcc) );
                 break;
 
             case POLY5_P1:
             case POLY5_P2:
-                tfVel = (15.0 * abs(this->setPoint)) / (8.0 * this->maxVel);
-                tfAcc = sqrt( (10.0 * abs(this->setPoint)) / (2.0 * sqrt(3) * this->maxAcc) );
+                tfVel = (15.0f * abs(this->setPoint)) / (8.0f * this->maxVel);
+                tfAcc = Utils::Sqrt( (10.0f * abs(this->setPoint)) / (2.0f * FASTMATH_SQRT3 * this->maxAcc) );
                 break;
 
             case AUTO:
-                tfVel = (15.0 * abs(this->setPoint)) / (8.0 * this->maxVel);
-                tfAcc = sqrt( (10.0 * abs(this->setPoint)) / (2.0 * sqrt(3) * this->maxAcc) );
+                tfVel = (15.0f * abs(this->setPoint)) / (8.0f * this->maxVel);
+                tfAcc = Utils::Sqrt( (10.0f * abs(this->setPoint)) / (2.0f * FASTMATH_SQRT3 * this->maxAcc) );
                 break;
 
             default:
-                tfVel = 0.0;
-                tfAcc = 0.0;
+                tfVel = 0.0f;
+                tfAcc = 0.0f;
                 break;
         }
 
@@ -209,7 +617,7 @@ namespace MotionControl
 
     float32_t MotionProfile::calculateMinDist(enum MotionProfile::PROFILE profile)
     {
-    	float32_t d = 0.0;
+    	float32_t d = 0.0f;
 
         if(profile == AUTO)
             profile = this->profile;
@@ -218,7 +626,7 @@ namespace MotionControl
         {
             case POLY5_P1:
             case POLY5_P2:
-                d = (64.0*sqrt(3.0)/135.0)*(pow(this->maxVel,2)/this->maxAcc);
+                d = (64.0f * FASTMATH_SQRT3 / 135.0f) * (this->maxVel * this->maxVel / this->maxAcc);
                 break;
             default:
                 break;
@@ -228,9 +636,9 @@ namespace MotionControl
 
     float32_t MotionProfile::calculateNoneProfile(float32_t t)
     {
-        float32_t s = 0.0;
+        float32_t s = 0.0f;
 
-        s = 1.0;
+        s = 1.0f;
 
         this->finished = true;
 
@@ -241,14 +649,14 @@ namespace MotionControl
 
     float32_t MotionProfile::calculateLinearProfile(float32_t t)
     {
-        float32_t s = 0.0;
+        float32_t s = 0.0f;
 
-        if(t <= 1.0)
+        if(t <= 1.0f)
             s = t;
         else
-            s = 1.0;
+            s = 1.0f;
 
-        if(t >= 1.0)
+        if(t >= 1.0f)
             this->finished = true;
         else
             this->finished = false;
@@ -260,16 +668,16 @@ namespace MotionControl
 
     float32_t MotionProfile::calculateTriangleProfile(float32_t t)
     {
-        float32_t s = 0.0;
+        float32_t s = 0.0f;
 
-        if(t <= 0.5)                                    // [0.0 to 0.5]
-            s = 2.0*pow(t,2);
-        else if(t <= 1.0)                               // ]0.5 to 1.0]
-            s = -1.0 + 4.0*t - 2.0*pow(t,2);
+        if(t <= 0.5f)                                    // [0.0 to 0.5]
+            s = 2.0f*t*t;
+        else if(t <= 1.0f)                               // ]0.5 to 1.0]
+            s = -1.0f + 4.0f*t - 2.0f*t*t;
         else                                            // ]1.0 to Inf[
-            s = 1.0;
+            s = 1.0f;
 
-        if(t >= 1.0)
+        if(t >= 1.0f)
             this->finished = true;
         else
             this->finished = false;
@@ -281,9 +689,9 @@ namespace MotionControl
 
     float32_t MotionProfile::calculateTrapezoidalProfile(float32_t t)
     {
-        float32_t s = 0.0;
+        float32_t s = 0.0f;
 
-        if(!(abs(this->setPoint) > (pow(this->maxVel, 2) / this->maxAcc)))
+        if(!(abs(this->setPoint) > (this->maxVel * this->maxVel / this->maxAcc)))
         {
             // Force Triangle profile because we cant do trapez
             this->profile = TRIANGLE;
@@ -300,26 +708,26 @@ namespace MotionControl
 
     float32_t MotionProfile::calculateCustomTrapezoidalProfile(float32_t t)
     {
-        float32_t s = 0.0;
-        float32_t tf = 0.0;
-        float32_t t1 = 0.0, t2 = 0.0;
+        float32_t s = 0.0f;
+        float32_t tf = 0.0f;
+        float32_t t1 = 0.0f, t2 = 0.0f;
 
-        float32_t S1 = 0.0, S2 = 0.0, S3 = 0.0;
-        float32_t T1 = 0.0, T2 = 0.0, T3 = 0.0;
+        float32_t S1 = 0.0f, S2 = 0.0f, S3 = 0.0f;
+        float32_t T1 = 0.0f, T2 = 0.0f, T3 = 0.0f;
 
-        static float32_t st1 = 0.0, st2 = 0.0;
+        static float32_t st1 = 0.0f, st2 = 0.0f;
 
         /* Reverse tf calcul */
-        tf = calculateMinTime();
+        tf = this->minTime;
         t *= tf;
 
         T1 = this->maxVel / this->maxAcc;
-        S1 = pow(this->maxVel,2) / (2.0 * this->maxAcc);
+        S1 = this->maxVel * this->maxVel / (2.0f * this->maxAcc);
 
         T3 = this->maxVel / this->maxAcc;
-        S3 = pow(this->maxVel,2) / (2.0 * this->maxAcc);
+        S3 = this->maxVel * this->maxVel / (2.0f * this->maxAcc);
 
-        S2 = this->setPoint - pow(this->maxVel,2) / this->maxAcc;
+        S2 = this->setPoint - this->maxVel * this->maxVel / this->maxAcc;
         T2 = this->setPoint / this->maxVel - this->maxVel / this->maxAcc;
 
         tf = this->setPoint / this->maxVel + this->maxVel / this->maxAcc;
@@ -327,11 +735,11 @@ namespace MotionControl
         t2 = T1 + T2;
 
         if(t <= t1)
-            s = 0.5 * this->maxAcc * pow(t,2);
+            s = 0.5f * this->maxAcc * t * t;
         else if(t <= t2)
             s = this->maxVel * (t-t1) + st1;
         else if(t <= tf)
-            s = -0.5 * this->maxAcc * pow(t-t2,2) + this->maxVel * (t-t2) + st2;
+            s = -0.5f * this->maxAcc * (t-t2) * (t-t2) + this->maxVel * (t-t2) + st2;
         else
             s = this->setPoint;
 
@@ -348,129 +756,366 @@ namespace MotionControl
         return s;
     }
 
+    void MotionProfile::calculateSCurveStop(float32_t v, float32_t* tj, float32_t* td)
+    {
+        if((v * this->maxJerk) < (this->maxAcc * this->maxAcc))
+        {
+            // maxAcc is never reached
+            *tj = Utils::Sqrt(v / this->maxJerk);
+            *td = 2.0f * (*tj);
+        }
+        else
+        {
+            *tj = this->maxAcc / this->maxJerk;
+            *td = (*tj) + v / this->maxAcc;
+        }
+    }
+
+    void MotionProfile::calculateSCurvePart(struct scurve_t* p, float32_t h, float32_t v0)
+    {
+        float32_t a = this->maxAcc, j = this->maxJerk, vmax = this->maxVel;
+        float32_t tj = 0.0f, delta = 0.0f;
+        bool reduced = false;
+
+        if(v0 > vmax)
+            v0 = vmax;
+
+        p->v0 = v0;
+        p->h = h;
+
+        // Acceleration from v0 to maxVel, deceleration from maxVel to rest
+        if(((vmax - v0) * j) < (a * a))
+        {
+            p->tj1 = Utils::Sqrt((vmax - v0) / j);
+            p->ta = 2.0f * p->tj1;
+        }
+        else
+        {
+            p->tj1 = a / j;
+            p->ta = p->tj1 + (vmax - v0) / a;
+        }
+        this->calculateSCurveStop(vmax, &p->tj2, &p->td);
+
+        p->tv = h / vmax - (p->ta / 2.0f) * (1.0f + v0 / vmax) - p->td / 2.0f;
+
+        if(p->tv > 0.0f)
+        {
+            p->vlim = vmax;
+        }
+        else
+        {
+            // maxVel is never reached : reduce acceleration until both phases reach it
+            p->tv = 0.0f;
+
+            for(uint32_t i = 0; i < 32u; i++)
+            {
+                tj = a / j;
+                p->tj1 = tj;
+                p->tj2 = tj;
+
+                delta = (a * a * a * a) / (j * j) + 2.0f * v0 * v0 + a * (4.0f * h - 2.0f * (a / j) * v0);
+                p->ta = ((a * a) / j - 2.0f * v0 + Utils::Sqrt(delta)) / (2.0f * a);
+                p->td = ((a * a) / j + Utils::Sqrt(delta)) / (2.0f * a);
+
+                if(p->ta < 0.0f)
+                    break;
+
+                if((p->ta >= (2.0f * tj)) && (p->td >= (2.0f * tj)))
+                {
+                    reduced = true;
+                    break;
+                }
+
+                a *= 0.9f;
+            }
+
+            if(reduced)
+            {
+                p->vlim = v0 + (p->ta - p->tj1) * j * p->tj1;
+            }
+            else if(v0 <= 0.0f)
+            {
+                // Rest to rest, maxAcc is never reached : h = 2.j.Tj^3
+                p->tj1 = cbrtf(h / (2.0f * j));
+                p->tj2 = p->tj1;
+                p->ta = 2.0f * p->tj1;
+                p->td = p->ta;
+                p->vlim = j * p->tj1 * p->tj1;
+            }
+            else
+            {
+                // Too fast to accelerate : keep v0, then stop
+                p->tj1 = 0.0f;
+                p->ta = 0.0f;
+                this->calculateSCurveStop(v0, &p->tj2, &p->td);
+                p->tv = (h - v0 * p->td / 2.0f) / v0;
+                p->vlim = v0;
+            }
+        }
+
+        p->T = p->ta + p->tv + p->td;
+    }
+
+    float32_t MotionProfile::calculateSCurvePlan(float32_t distance, float32_t velocity, struct scurve_t part[], uint32_t* n)
+    {
+        float32_t sign = (distance >= 0.0f) ? 1.0f : -1.0f;
+        float32_t v = sign * velocity;
+        float32_t tj = 0.0f, td = 0.0f;
+        float32_t T = 0.0f;
+
+        *n = 0;
+
+        if(v > 0.0f)
+            this->calculateSCurveStop(v, &tj, &td);
+
+        // Moving away, or setpoint too close to stop on : brake to rest first
+        if((v < 0.0f) || ((v * td / 2.0f) > (abs(distance) - MPROFILE_STOP_EPSILON)))
+        {
+            struct scurve_t* brake = &part[(*n)++];
+
+            brake->sign = (velocity >= 0.0f) ? 1.0f : -1.0f;
+            brake->v0 = abs(velocity);
+            this->calculateSCurveStop(brake->v0, &brake->tj2, &brake->td);
+            brake->h = brake->v0 * brake->td / 2.0f;
+            brake->tj1 = 0.0f;
+            brake->ta = 0.0f;
+            brake->tv = 0.0f;
+            brake->vlim = brake->v0;
+            brake->T = brake->td;
+
+            distance -= brake->sign * brake->h;
+            sign = (distance >= 0.0f) ? 1.0f : -1.0f;
+            v = 0.0f;
+            T += brake->T;
+
+            // Setpoint is the stop point (Brake())
+            if(abs(distance) <= MPROFILE_STOP_EPSILON)
+                return T;
+        }
+
+        part[*n].sign = sign;
+        this->calculateSCurvePart(&part[*n], abs(distance), v);
+        T += part[*n].T;
+        (*n)++;
+
+        return T;
+    }
+
+    float32_t MotionProfile::calculateSCurvePart(const struct scurve_t* p, float32_t t)
+    {
+        float32_t j = this->maxJerk;
+        float32_t tau = t - p->T + p->td;
+        float32_t s = 0.0f;
+
+        if(t <= 0.0f)                                               // Not started
+            s = 0.0f;
+        else if(t < p->tj1)                                         // Jerk +
+            s = p->v0 * t + j * t * t * t / 6.0f;
+        else if(t < (p->ta - p->tj1))                               // Constant acceleration
+            s = p->v0 * t + j * p->tj1 * (3.0f * t * t - 3.0f * p->tj1 * t + p->tj1 * p->tj1) / 6.0f;
+        else if(t < p->ta)                                          // Jerk -
+            s = (p->vlim + p->v0) * p->ta / 2.0f - p->vlim * (p->ta - t) + j * (p->ta - t) * (p->ta - t) * (p->ta - t) / 6.0f;
+        else if(t < (p->ta + p->tv))                                // Constant velocity
+            s = (p->vlim + p->v0) * p->ta / 2.0f + p->vlim * (t - p->ta);
+        else if(t < (p->T - p->td + p->tj2))                        // Jerk -
+            s = p->h - p->vlim * p->td / 2.0f + p->vlim * tau - j * tau * tau * tau / 6.0f;
+        else if(t < (p->T - p->tj2))                                // Constant deceleration
+            s = p->h - p->vlim * p->td / 2.0f + p->vlim * tau - j * p->tj2 * (3.0f * tau * tau - 3.0f * p->tj2 * tau + p->tj2 * p->tj2) / 6.0f;
+        else if(t < p->T)                                           // Jerk +
+            s = p->h - j * (p->T - t) * (p->T - t) * (p->T - t) / 6.0f;
+        else                                                        // Finished
+            s = p->h;
+
+        return p->sign * s;
+    }
+
+    void MotionProfile::calculateSCurvePart(const struct scurve_t* p, float32_t t, float32_t* v, float32_t* a)
+    {
+        float32_t j = this->maxJerk;
+        float32_t tau = t - p->T + p->td;
+
+        if(t <= 0.0f)                                               // Not started
+        {
+            *v = p->v0;
+            *a = 0.0f;
+        }
+        else if(t < p->tj1)                                         // Jerk +
+        {
+            *v = p->v0 + j * t * t / 2.0f;
+            *a = j * t;
+        }
+        else if(t < (p->ta - p->tj1))                               // Constant acceleration
+        {
+            *v = p->v0 + j * p->tj1 * (t - p->tj1 / 2.0f);
+            *a = j * p->tj1;
+        }
+        else if(t < p->ta)                                          // Jerk -
+        {
+            *v = p->vlim - j * (p->ta - t) * (p->ta - t) / 2.0f;
+            *a = j * (p->ta - t);
+        }
+        else if(t < (p->ta + p->tv))                                // Constant velocity
+        {
+            *v = p->vlim;
+            *a = 0.0f;
+        }
+        else if(t < (p->T - p->td + p->tj2))                        // Jerk -
+        {
+            *v = p->vlim - j * tau * tau / 2.0f;
+            *a = -j * tau;
+        }
+        else if(t < (p->T - p->tj2))                                // Constant deceleration
+        {
+            *v = p->vlim - j * p->tj2 * (tau - p->tj2 / 2.0f);
+            *a = -j * p->tj2;
+        }
+        else if(t < p->T)                                           // Jerk +
+        {
+            *v = j * (p->T - t) * (p->T - t) / 2.0f;
+            *a = -j * (p->T - t);
+        }
+        else                                                        // Finished
+        {
+            *v = 0.0f;
+            *a = 0.0f;
+        }
+
+        *v *= p->sign;
+        *a *= p->sign;
+    }
+
+    float32_t MotionProfile::calculateSCurvePosition(float32_t t)
+    {
+        float32_t s = 0.0f;
+        uint32_t i;
+
+        for(i = 0; i < this->scurveParts; i++)
+        {
+            if((t <= this->scurve[i].T) || ((i + 1u) == this->scurveParts))
+                return s + this->calculateSCurvePart(&this->scurve[i], t);
+
+            s += this->scurve[i].sign * this->scurve[i].h;
+            t -= this->scurve[i].T;
+        }
+
+        return s;
+    }
+
     float32_t MotionProfile::calculateSCurveProfile(float32_t t)
     {
-        float32_t s = 0.0;
+        float32_t s = 0.0f;
+        float32_t T = this->minTime;
+
+        /* Reverse tf calcul */
+        t *= T;
 
-        /*@todo: S-Curve Algorihm */
-        s = 1.0;
+        if(!(t < T))
+            s = this->setPoint;
+        else
+            s = this->calculateSCurvePosition(t);
 
-        if(t >= 1.0)
+        if(!(t < T))
             this->finished = true;
         else
             this->finished = false;
 
-        s *= this->setPoint;
-
         return s;
     }
 
     float32_t MotionProfile::calculatePolynomial3Profile(float32_t t)
     {
-        float32_t s = 0.0;
+        float32_t s = 0.0f;
 
-        if(t <= 1.0)
-            s = 3.0*pow(t,2)-2.0*pow(t,3);
+        if(t <= 1.0f)
+            s = this->horner(t);
         else
-            s = 1.0;
+            s = this->setPoint;
 
-        if(t >= 1.0)
+        if(t >= 1.0f)
             this->finished = true;
         else
             this->finished = false;
 
-        s *= this->setPoint;
-
         return s;
     }
 
     float32_t MotionProfile::calculatePolynomial5Profile(float32_t t)
     {
-        float32_t s = 0.0;
+        float32_t s = 0.0f;
 
-        if(t <= 1.0)
-            s = 10.0*pow(t,3)-15.0*pow(t,4)+6.0*pow(t,5);
+        if(t <= 1.0f)
+            s = this->horner(t);
         else
-            s = 1.0;
+            s = this->setPoint;
 
-        if(t >= 1.0)
+        if(t >= 1.0f)
             this->finished = true;
         else
             this->finished = false;
 
-        s *= this->setPoint;
-
         return s;
     }
 
     float32_t MotionProfile::calculatePolynomial5Phase1Profile(float32_t t)
     {
-        float32_t s = 0.0;
+        float32_t s = 0.0f;
 
-        if(t <= 1.0)
-            s = 5.0/2.0*pow(t,3)-15.0/8.0*pow(t,4)+3.0/8.0*pow(t,5);
+        if(t <= 1.0f)
+            s = this->horner(t);
         else
         {
-            s = 1.0;
+            s = this->setPoint;
         }
 
-        if(t >= 1.0)
+        if(t >= 1.0f)
             this->finished = true;
         else
             this->finished = false;
 
-        s *= this->setPoint;
-
         return s;
     }
 
     float32_t MotionProfile::calculatePolynomial5Phase2Profile(float32_t t)
     {
-        float32_t s = 0.0;
+        float32_t s = 0.0f;
 
-        if(t <= 1.0)
-            s = 15.0/8.0*t-5.0/4.0*pow(t,3)+3.0/8.0*pow(t,5);
+        if(t <= 1.0f)
+            s = this->horner(t);
         else
         {
-            s = 1.0;
+            s = this->setPoint;
         }
 
-        if(t >= 1.0)
+        if(t >= 1.0f)
             this->finished = true;
         else
             this->finished = false;
 
-        s *= this->setPoint;
-
         return s;
     }
 
     float32_t MotionProfile::calculateAutoProfile(float32_t t)
     {
-        float32_t s = 0.0;
+        float32_t s = 0.0f;
 
-        if(t <= 1.0)
-            s = 10.0/4.0*pow(t,3)-15.0/8.0*pow(t,4)+6.0/16.0*pow(t,5);
+        if(t <= 1.0f)
+            s = this->horner(t);
         else
         {
-            s = 1.875 * t - 0.875;
+            s = (1.875f * t - 0.875f) * this->setPoint;
         }
 
-        if(t >= 2.0)
+        if(t >= 2.0f)
             this->finished = true;
         else
             this->finished = false;
 
-        s *= this->setPoint;
-
         return s;
     }
 
     float32_t MotionProfile::abs(float32_t val)
     {
-        if(val < 0.0)
-            val = -val;
-        return val;
+        return Utils::Abs(val);
     }
 
 }
@@ -6,10 +6,17 @@
  */
 
 #include "Odometry.hpp"
+#include "TaskTable.hpp"
+#include "StaticStorage.hpp"
+#include "Config.hpp"
+#include "Retain.hpp"
 #include "common.h"
 
+#include <string.h>
+
 
 using namespace HAL;
+namespace Units = Utils::Units;
 
 /*----------------------------------------------------------------------------*/
 /* Definitions                                                                */
@@ -20,23 +27,72 @@ using namespace HAL;
 
 // Encoder wheel characteristic
 #define WD          41.1            // Wheel diameter
-#define WC          1.0             // Wheel correction (Difference between the (referent) right and left wheel)
+//#define WC        1.0             // Wheel correction : non volatile configuration (wheelRatio), see loadGeometry()
 #define ER          4096            // Encoder resolution
 #define ADW         79.30           // Axial distance between wheels
 
 #define _PI_        3.14159265358979323846
 #define _2_PI_      6.28318530717958647692  // 2*PI
 
-#define TICK_BY_MM  31.722561893    // (ER/(_PI_*WD))
-#define ADW_TICK    2515.599158127  // (ADW * TICK_BY_MM)
-//#define ADW_TICK    2515.099158127  // (ADW * TICK_BY_MM)
+// TICK_BY_MM (ER/(_PI_*WD)) and ADW_TICK (ADW * TICK_BY_MM) : non volatile configuration, see loadGeometry()
+#define TICK_BY_MM  (this->tickByMm)
+#define ADW_TICK    (this->adwTick)
+
+
+
+#define ODO_LOOP_PERIOD_MS      (TASK_ODOMETRY_PERIOD_MS) // 5ms Odometry loop
+
+// Encoders sampling in timer interrupt (task consumes timestamped deltas)
+#define ODO_SAMPLING_ISR        (0u)
+#define ODO_SAMPLING_TIMER      (Timer::TIMER7)
+#define ODO_SAMPLING_PERIOD_US  (1000u)
+
+// Encoder glitch filter : delta above 10 m/s is discarded
+#define ODO_DELTA_MAX(period_us)    ((int32_t)(10.0*(TICK_BY_MM+1.0)*(period_us)/1000.0))
+#define ODO_DELTA_INVALID(d, max)   (((d) > (max)) || ((d) < -(max)))
+
+// Encoder health : rejected delta above JUMP times the bound is a counter jump,
+// reversal between deltas up to FLIP ticks is edge chatter
+#define ODO_JUMP_FACTOR         (16)
+#define ODO_FLIP_TICKS          (2)
+
+// Low speed velocity from encoders edges timestamps (1/T method)
+#define ODO_VELOCITY_1T         (1u)
+#define ODO_1T_MAX_TICKS        (16)    // Below this delta by loop, velocity is taken from edges period
+#define ODO_1T_EDGE_TICKS       (4.0f)  // Ticks between two captured edges
+#define ODO_1T_TIMEOUT_MS       (100u)  // No edge within this time means standstill
+
+// Alpha-beta-gamma observer on linear and angular positions (critically
+// damped gains from the fading memory factor THETA, closer to 1 is smoother)
+#define ODO_OBSERVER            (1u)
+#define ODO_OBSERVER_THETA      (0.8f)
+#define ODO_OBSERVER_ALPHA      (1.0f - ODO_OBSERVER_THETA*ODO_OBSERVER_THETA*ODO_OBSERVER_THETA)
+#define ODO_OBSERVER_BETA       (1.5f * (1.0f - ODO_OBSERVER_THETA)*(1.0f - ODO_OBSERVER_THETA) * (1.0f + ODO_OBSERVER_THETA))
+#define ODO_OBSERVER_GAMMA      (0.5f * (1.0f - ODO_OBSERVER_THETA)*(1.0f - ODO_OBSERVER_THETA)*(1.0f - ODO_OBSERVER_THETA))
 
+// Fixed-point integration (integer ticks, binary angle heading, trigo table)
+#define ODO_FIXED_POINT         (1u)
 
+#define ODO_HEADING_TURN        (1LL << 48)                                 // Heading unit is 2^-48 turn
+#define ODO_HEADING_BY_RAD      ((float32_t)((1LL << 48) / _2_PI_))
+#define ODO_RAD_BY_HEADING18    ((float32_t)(_2_PI_ / (1LL << 30)))        // Radian by (heading >> 18)
 
-#define ODO_TASK_STACK_SIZE     (256u)
-#define ODO_TASK_PRIORITY       (configMAX_PRIORITIES-2)
+// Wheels diameter correction (UMBmark) : Q16 scale by wheel, mean scale is 1
+#define ODO_WHEEL_ONE           (65536)
 
-#define ODO_LOOP_PERIOD_MS      (5u) // 5ms Odometry loop
+// Heading fusion : encoder wheels heading delta blended by loop with the drive
+// steps one (unless they disagree : slip) then with the optional gyro one
+#define ODO_HEADING_FUSION      (1u)
+#define ODO_HEADING_GYRO        (1u)
+#define ODO_GYRO_ID             (Gyro::GYRO0)
+#define ODO_FUSION_STEP_WEIGHT  (0.25f)     // Drive steps share
+#define ODO_FUSION_GYRO_WEIGHT  (0.5f)      // Gyro share
+#define ODO_FUSION_SLIP_RAD     (0.002f)    // Steps and encoders disagreement by loop beyond which steps are ignored
+#define ODO_GYRO_BIAS_GAIN      (0.01f)     // Gyro bias low pass gain, robot still
+
+// External pose correction blending rates
+#define ODO_CORRECT_MM_BY_S     (50.0f)
+#define ODO_CORRECT_RAD_BY_S    (0.2f)
 
 
 /*----------------------------------------------------------------------------*/
@@ -44,10 +100,15 @@ using namespace HAL;
 /*----------------------------------------------------------------------------*/
 
 static Location::Odometry* _odometry = NULL;
+static Utils::StaticStorage<Location::Odometry> _odometryStorage;
 
-/*----------------------------------------------------------------------------*/
-/* Private Functions                                                          */
-/*----------------------------------------------------------------------------*/
+/**
+ * @brief Bound value in [-max; max]
+ */
+static inline float32_t _bound (float32_t value, float32_t max)
+{
+    return (value > max) ? max : ((value < -max) ? -max : value);
+}
 
 /*----------------------------------------------------------------------------*/
 /* Class Implementation                                                       */
@@ -63,51 +124,144 @@ namespace Location
         }
         else
         {
-            _odometry = new Odometry(standalone);
+            _odometry = new (_odometryStorage.Get()) Odometry(standalone);
             return _odometry;
         }
     }
 
-    Odometry::Odometry(bool standalone)
+    Odometry::Odometry(bool standalone) : profiler("Odometry"), periodic("Odometry", ODO_LOOP_PERIOD_MS)
     {
         this->name = "ODOMETRY";
         this->taskHandle = NULL;
+        this->health = Utils::Watchdog::Register("Odometry", TASK_WATCHDOG_PERIODS * ODO_LOOP_PERIOD_MS);
 
         this->status = 0x0000;
 
         // Init members
-        this->robot.X = 0.0;
-        this->robot.Y = 0.0;
-        this->robot.O = 0.0;
-        this->robot.L = 0.0;
+        this->robot.X = 0.0f;
+        this->robot.Y = 0.0f;
+        this->robot.O = 0.0f;
+        this->robot.L = 0.0f;
 
         this->robot.Xmm  = 0;
         this->robot.Ymm  = 0;
-        this->robot.Odeg = 0.0;
+        this->robot.Odeg = 0.0f;
         this->robot.Lmm  = 0;
 
-        this->robot.AngularVelocity = 0.0;
-        this->robot.LinearVelocity  = 0.0;
+        this->robot.AngularVelocity = 0.0f;
+        this->robot.LinearVelocity  = 0.0f;
+
+        this->robot.LeftVelocity  = 0.0f;
+        this->robot.RightVelocity = 0.0f;
 
-        this->robot.LeftVelocity  = 0.0;
-        this->robot.RightVelocity = 0.0;
+        this->robot.LinearVelocityFiltered  = 0.0f;
+        this->robot.AngularVelocityFiltered = 0.0f;
+        this->robot.LinearAcceleration      = 0.0f;
+        this->robot.AngularAcceleration     = 0.0f;
+
+        this->linearObserver.e = 0.0f;
+        this->linearObserver.v = 0.0f;
+        this->linearObserver.a = 0.0f;
+        this->angularObserver  = this->linearObserver;
 
         this->leftSum  = 0;
         this->rightSum = 0;
 
+        this->ResetEncoderStats();
+
+        this->samplesLost = 0;
+        this->lastSampleTime = 0;
+
+        this->recording = false;
+        this->replay = NULL;
+
+        this->leftEdge.seq        = 0;
+        this->leftEdge.count      = 0;
+        this->leftEdge.timestamp  = 0;
+        this->leftEdge.valid      = false;
+        this->leftEdge.velocity   = 0.0f;
+        this->rightEdge = this->leftEdge;
+
+        this->leftDrive  = NULL;
+        this->rightDrive = NULL;
+        this->leftDriveSteps  = 0;
+        this->rightDriveSteps = 0;
+        this->leftDriveRadByTurn  = 0.0f;
+        this->rightDriveRadByTurn = 0.0f;
+
+        this->gyroRate  = 0.0f;
+        this->gyroBias  = 0.0f;
+        this->gyroValid = false;
+
+        this->fusion = (ODO_HEADING_FUSION != 0u);
+        this->fusionCorrection = 0.0f;
+
+        this->correctX = 0.0f;
+        this->correctY = 0.0f;
+        this->correctO = 0.0f;
+
+        this->loadGeometry();
+
+        // Warm restart : pose of the previous run, reported until set again
+        if(Retain::GetRestored() != NULL)
+        {
+            this->robot.X = Retain::GetRestored()->x;
+            this->robot.Y = Retain::GetRestored()->y;
+            this->robot.O = Retain::GetRestored()->o;
+
+            this->robot.Xmm  = static_cast<int32_t>(this->ticks.ToMillimeter(Units::Tick(this->robot.X)).Value());
+            this->robot.Ymm  = static_cast<int32_t>(this->ticks.ToMillimeter(Units::Tick(this->robot.Y)).Value());
+            this->robot.Odeg = Units::ToDegree(Units::Radian(this->robot.O)).Value();
+
+            this->status |= ODO_STATUS_RESTORED;
+        }
+
+        this->loadFixedPoint();
+
+        this->seq = 0;
+        this->snapshot = this->robot;
+
+        // Runtime inspection (CLI watch, peek)
+        WATCH_MEMBER("od", robot.X);
+        WATCH_MEMBER("od", robot.Y);
+        WATCH_MEMBER("od", robot.O);
+        WATCH_MEMBER("od", robot.LinearVelocity);
+        WATCH_MEMBER("od", robot.AngularVelocity);
+        WATCH_MEMBER("od", robot.LeftVelocity);
+        WATCH_MEMBER("od", robot.RightVelocity);
+        WATCH_MEMBER("od", leftSum);
+        WATCH_MEMBER("od", rightSum);
+        WATCH_MEMBER("od", samplesLost);
+        WATCH_MEMBER("od", status);
+        WATCH_MEMBER("od", fusion);
+        WATCH_MEMBER("od", fusionCorrection);
+        WATCH_MEMBER("od", gyroBias);
+
         // Init encoders
         this->leftEncoder  = Encoder::GetInstance(L_ENCODER_ID);
         this->rightEncoder = Encoder::GetInstance(R_ENCODER_ID);
 
+#if ODO_SAMPLING_ISR
+        // Latch encoders at a fixed rate (same priority as encoders overflow)
+        this->samplingTimer = Timer::GetInstance(ODO_SAMPLING_TIMER);
+        this->samplingTimer->TimerElapsed.Subscribe<Odometry, &Odometry::INTERNAL_SampleEncoders>(this);
+        this->samplingTimer->SetPeriod(ODO_SAMPLING_PERIOD_US);
+        this->samplingTimer->Restart();
+#else
+        this->samplingTimer = NULL;
+#endif
+
+#if ODO_HEADING_GYRO
+        // Probed by the first Compute(), absent gyro is ignored
+        this->gyro = Gyro::GetInstance(ODO_GYRO_ID);
+#else
+        this->gyro = NULL;
+#endif
+
         if(standalone == true)
         {
             // Create task
-            xTaskCreate((TaskFunction_t)(&Odometry::taskHandler),
-            this->name.c_str(),
-            ODO_TASK_STACK_SIZE,
-            NULL,
-            ODO_TASK_PRIORITY,
-            NULL);
+            TaskTable::Create(TaskTable::ODOMETRY, (TaskFunction_t)(&Odometry::taskHandler), this->name);
         }
     }
 
@@ -125,34 +279,85 @@ namespace Location
 
     void Odometry::Init(float32_t X, float32_t Y, float32_t O, float32_t L)
     {
+        taskENTER_CRITICAL();
+
         this->robot.X = X;  // tick
         this->robot.Y = Y;  // tick
         this->robot.O = O;  // radian
         this->robot.L = L;  // tick
 
-        this->robot.Xmm  = static_cast<int32_t>(X / TICK_BY_MM);
-        this->robot.Ymm  = static_cast<int32_t>(Y / TICK_BY_MM);
-        this->robot.Odeg = static_cast<float32_t>((180.0 * O) / _PI_);
-        this->robot.Lmm  = static_cast<int32_t>(L / TICK_BY_MM);
+        this->robot.Xmm  = static_cast<int32_t>(this->ticks.ToMillimeter(Units::Tick(X)).Value());
+        this->robot.Ymm  = static_cast<int32_t>(this->ticks.ToMillimeter(Units::Tick(Y)).Value());
+        this->robot.Odeg = Units::ToDegree(Units::Radian(O)).Value();
+        this->robot.Lmm  = static_cast<int32_t>(this->ticks.ToMillimeter(Units::Tick(L)).Value());
+
+        this->loadFixedPoint();
+        this->publish();
+
+        taskEXIT_CRITICAL();
+    }
+
+    void Odometry::loadGeometry()
+    {
+        const CONFIG_DATA* config = Config::Get();
+
+        this->tickByMm = config->tickByMm;
+        this->adwTick  = config->adwTick;
+
+        this->ticks     = Units::TickScale(TICK_BY_MM);
+        this->radByTick = static_cast<float32_t>(1.0 / ADW_TICK);
+
+        this->headingByTick  = static_cast<int64_t>(ODO_HEADING_TURN / (_2_PI_ * ADW_TICK));
+
+        // Ed = right / left diameter : El = 2 / (Ed + 1), Er = 2 / (1/Ed + 1)
+        this->wheelScaleL = static_cast<int32_t>(ODO_WHEEL_ONE * 2.0 / (config->wheelRatio + 1.0) + 0.5);
+        this->wheelScaleR = static_cast<int32_t>(ODO_WHEEL_ONE * 2.0 / (1.0 / config->wheelRatio + 1.0) + 0.5);
+        this->wheelRemL   = 0;
+        this->wheelRemR   = 0;
+
+        this->loopDeltaMax   = ODO_DELTA_MAX(ODO_LOOP_PERIOD_MS * 1000u);
+        this->sampleDeltaMax = ODO_DELTA_MAX(ODO_SAMPLING_PERIOD_US);
+    }
+
+    void Odometry::loadFixedPoint()
+    {
+        this->heading = static_cast<int64_t>(this->robot.O * ODO_HEADING_BY_RAD);
+        this->xQ16    = static_cast<int64_t>(this->robot.X * 65536.0f);
+        this->yQ16    = static_cast<int64_t>(this->robot.Y * 65536.0f);
+        this->lHalf   = static_cast<int64_t>(this->robot.L * 2.0f);
+    }
+
+    void Odometry::publish()
+    {
+        this->seq++;
+        __DMB();
+
+        this->snapshot = this->robot;
+
+        __DMB();
+        this->seq++;
+
+        Retain::SetPose(this->robot.X, this->robot.Y, this->robot.O);
     }
 
     void Odometry::GetRobot(robot_t *r)
     {
-        r->X = this->robot.X;
-        r->Y = this->robot.Y;
-        r->O = this->robot.O;
-        r->L = this->robot.L;
+        uint32_t seq;
+
+        do
+        {
+            // Wait for the end of a publication
+            do
+            {
+                seq = this->seq;
+            }while(seq & 1u);
 
-        r->AngularVelocity = this->robot.AngularVelocity;
-        r->LinearVelocity  = this->robot.LinearVelocity;
+            __DMB();
 
-        r->LeftVelocity  = this->robot.LeftVelocity;
-        r->RightVelocity = this->robot.RightVelocity;
+            *r = this->snapshot;
 
-        r->Xmm  = this->robot.Xmm;
-        r->Ymm  = this->robot.Ymm;
-        r->Odeg = this->robot.Odeg;
-        r->Lmm  = this->robot.Lmm;
+            __DMB();
+        }while(seq != this->seq);
     }
 
      /**
@@ -161,7 +366,11 @@ namespace Location
      */
      float32_t Odometry::GetAngularPosition()
      {
-         return this->robot.O;
+         robot_t r;
+
+         this->GetRobot(&r);
+
+         return r.O;
      }
 
      /**
@@ -170,7 +379,11 @@ namespace Location
      */
      float32_t Odometry::GetLinearPosition()
      {
-         return this->robot.L / (TICK_BY_MM * 1000.0);
+         robot_t r;
+
+         this->GetRobot(&r);
+
+         return this->ticks.ToMeter(Units::Tick(r.L)).Value();
      }
 
      /**
@@ -181,8 +394,11 @@ namespace Location
      float32_t Odometry::GetAngularVelocity(float32_t period)
      {
          float32_t odo_period = ODO_LOOP_PERIOD_MS;
+         robot_t r;
+
+         this->GetRobot(&r);
 
-         return (this->robot.AngularVelocity / odo_period) * period;
+         return (r.AngularVelocity / odo_period) * period;
      }
 
     /**
@@ -193,8 +409,11 @@ namespace Location
      float32_t Odometry::GetLinearVelocity(float32_t period)
      {
          float32_t odo_period = ODO_LOOP_PERIOD_MS;
+         robot_t r;
 
-         return ((this->robot.LinearVelocity / odo_period) * period) / (TICK_BY_MM * 1000.0);
+         this->GetRobot(&r);
+
+         return this->ticks.ToMeter(Units::Tick((r.LinearVelocity / odo_period) * period)).Value();
      }
 
     /**
@@ -205,8 +424,11 @@ namespace Location
      float32_t Odometry::GetLeftVelocity(float32_t period)
      {
          float32_t odo_period = ODO_LOOP_PERIOD_MS;
+         robot_t r;
+
+         this->GetRobot(&r);
 
-         return ((this->robot.LeftVelocity / odo_period) * period) / (TICK_BY_MM * 1000.0);
+         return this->ticks.ToMeter(Units::Tick((r.LeftVelocity / odo_period) * period)).Value();
      }
 
     /**
@@ -217,150 +439,750 @@ namespace Location
      float32_t Odometry::GetRightVelocity(float32_t period)
      {
          float32_t odo_period = ODO_LOOP_PERIOD_MS;
+         robot_t r;
+
+         this->GetRobot(&r);
+
+         return this->ticks.ToMeter(Units::Tick((r.RightVelocity / odo_period) * period)).Value();
+     }
+
+    /**
+     * @brief Get observer filtered Angular Velocity
+     * @param period : Velocity period required
+     * @return : Angular Velocity in rad/s (S.I Units)
+     */
+     float32_t Odometry::GetAngularVelocityFiltered(float32_t period)
+     {
+         float32_t odo_period = ODO_LOOP_PERIOD_MS;
+         robot_t r;
+
+         this->GetRobot(&r);
+
+         return (r.AngularVelocityFiltered / odo_period) * period;
+     }
+
+    /**
+     * @brief Get observer filtered Linear Velocity
+     * @param period : Velocity period required
+     * @return : Linear Velocity in m/s (S.I Units)
+     */
+     float32_t Odometry::GetLinearVelocityFiltered(float32_t period)
+     {
+         float32_t odo_period = ODO_LOOP_PERIOD_MS;
+         robot_t r;
+
+         this->GetRobot(&r);
+
+         return this->ticks.ToMeter(Units::Tick((r.LinearVelocityFiltered / odo_period) * period)).Value();
+     }
+
+    /**
+     * @brief Get observer Angular Acceleration
+     * @param period : Acceleration period required
+     * @return : Angular Acceleration in rad/s^2 (S.I Units)
+     */
+     float32_t Odometry::GetAngularAcceleration(float32_t period)
+     {
+         float32_t ratio = period / static_cast<float32_t>(ODO_LOOP_PERIOD_MS);
+         robot_t r;
+
+         this->GetRobot(&r);
+
+         return r.AngularAcceleration * ratio * ratio;
+     }
+
+    /**
+     * @brief Get observer Linear Acceleration
+     * @param period : Acceleration period required
+     * @return : Linear Acceleration in m/s^2 (S.I Units)
+     */
+     float32_t Odometry::GetLinearAcceleration(float32_t period)
+     {
+         float32_t ratio = period / static_cast<float32_t>(ODO_LOOP_PERIOD_MS);
+         robot_t r;
+
+         this->GetRobot(&r);
 
-         return ((this->robot.RightVelocity / odo_period) * period) / (TICK_BY_MM * 1000.0);
+         return this->ticks.ToMeter(Units::Tick(r.LinearAcceleration * ratio * ratio)).Value();
      }
 
      void Odometry::SetXYO(float32_t X, float32_t Y, float32_t O)
      {
-         //TODO: Secure by mutex
-         this->robot.X = X * 1000.0 * TICK_BY_MM;
-         this->robot.Y = Y * 1000.0 * TICK_BY_MM;
+         taskENTER_CRITICAL();
+
+         this->robot.X = this->ticks.ToTick(Units::Meter(X)).Value();
+         this->robot.Y = this->ticks.ToTick(Units::Meter(Y)).Value();
          this->robot.O = O;
          //this->robot.L = ???;
 
-         this->robot.Xmm = X * 1000.0;
-         this->robot.Ymm = Y * 1000.0;
-         this->robot.Odeg = (180.0 * O) / _PI_;
+         this->robot.Xmm = static_cast<int32_t>(Units::ToMillimeter(Units::Meter(X)).Value());
+         this->robot.Ymm = static_cast<int32_t>(Units::ToMillimeter(Units::Meter(Y)).Value());
+         this->robot.Odeg = Units::ToDegree(Units::Radian(O)).Value();
+
+         this->correctX = 0.0f;
+         this->correctY = 0.0f;
+         this->correctO = 0.0f;
+         this->status &= ~ODO_STATUS_RESTORED;
+
+         this->loadFixedPoint();
+         this->publish();
+
+         taskEXIT_CRITICAL();
      }
 
     void Odometry::SetXO(float32_t X, float32_t O)
     {
-        //TODO: Secure by mutex
-        this->robot.X = X * 1000.0 * TICK_BY_MM;
+        taskENTER_CRITICAL();
+
+        this->robot.X = this->ticks.ToTick(Units::Meter(X)).Value();
         this->robot.O = O;
         //this->robot.L = ???;
 
-        this->robot.Xmm = X * 1000.0;
-        this->robot.Odeg = (180.0 * O) / _PI_;
+        this->robot.Xmm = static_cast<int32_t>(Units::ToMillimeter(Units::Meter(X)).Value());
+        this->robot.Odeg = Units::ToDegree(Units::Radian(O)).Value();
+
+        this->correctX = 0.0f;
+        this->correctY = 0.0f;
+        this->correctO = 0.0f;
+
+        this->loadFixedPoint();
+        this->publish();
+
+        taskEXIT_CRITICAL();
     }
 
 
     void Odometry::SetYO(float32_t Y, float32_t O)
     {
-        //TODO: Secure by mutex
-        this->robot.Y = Y * 1000.0 * TICK_BY_MM;
+        taskENTER_CRITICAL();
+
+        this->robot.Y = this->ticks.ToTick(Units::Meter(Y)).Value();
         this->robot.O = O;
         //this->robot.L = ???;
 
-        this->robot.Ymm = Y * 1000.0;
-        this->robot.Odeg = (180.0 * O) / _PI_;
+        this->robot.Ymm = static_cast<int32_t>(Units::ToMillimeter(Units::Meter(Y)).Value());
+        this->robot.Odeg = Units::ToDegree(Units::Radian(O)).Value();
+
+        this->correctX = 0.0f;
+        this->correctY = 0.0f;
+        this->correctO = 0.0f;
+
+        this->loadFixedPoint();
+        this->publish();
+
+        taskEXIT_CRITICAL();
     }
 
 
+    void Odometry::Correct(float32_t X, float32_t Y, float32_t O)
+    {
+        taskENTER_CRITICAL();
+
+        this->correctX = this->ticks.ToTick(Units::Meter(X)).Value() - this->robot.X;
+        this->correctY = this->ticks.ToTick(Units::Meter(Y)).Value() - this->robot.Y;
+        this->correctO = Utils::WrapPi(O - this->robot.O);
+
+        taskEXIT_CRITICAL();
+    }
+
     void Odometry::Reset()
     {
-        //TODO: Secure by mutex
-        this->robot.X = 0.0;
-        this->robot.Y = 0.0;
-        this->robot.O = 0.0;
-        this->robot.L = 0.0;
+        taskENTER_CRITICAL();
+
+        this->robot.X = 0.0f;
+        this->robot.Y = 0.0f;
+        this->robot.O = 0.0f;
+        this->robot.L = 0.0f;
+
+        this->correctX = 0.0f;
+        this->correctY = 0.0f;
+        this->correctO = 0.0f;
+        this->status &= ~ODO_STATUS_RESTORED;
+
+        this->loadFixedPoint();
+        this->publish();
+
+        taskEXIT_CRITICAL();
     }
 
-    void Odometry::Compute(float32_t period)
+    int32_t Odometry::wheelScale(int32_t d, int32_t scale, int32_t* rem)
     {
-        int32_t dl = 0;
-        int32_t dr = 0;
+        int64_t t;
 
-        float32_t dX = 0.0;
-        float32_t dY = 0.0;
+        if(scale == ODO_WHEEL_ONE)
+            return d;
 
-        float32_t dO = 0.0;
-        float32_t dL = 0.0;
+        // Fraction of tick carried to the next delta : no drift from rounding
+        t = static_cast<int64_t>(d) * scale + *rem;
+        d = static_cast<int32_t>(t >> 16);
+        *rem = static_cast<int32_t>(t - (static_cast<int64_t>(d) << 16));
 
-        float32_t dlf = 0.0;
-        float32_t drf = 0.0;
+        return d;
+    }
 
-        this->status |= (1<<0);
+    int32_t Odometry::screen(uint32_t wheel, int32_t d, int32_t max)
+    {
+        ODO_ENCODER_STATS* stats = &this->encoderStats[wheel];
+        int32_t last = this->encoderLast[wheel];
+        uint32_t magnitude = static_cast<uint32_t>((d >= 0) ? d : -d);
 
-        dl = +  leftEncoder->GetRelativeValue();
-        dr = - rightEncoder->GetRelativeValue();
+        stats->samples++;
 
-        if( dl > (int32_t)(10.0*(TICK_BY_MM+1.0)*ODO_LOOP_PERIOD_MS) || dl < (int32_t)(-10.0*(TICK_BY_MM+1.0)*ODO_LOOP_PERIOD_MS) ) {
-            dl = 0;
-        }
-        if( dr > (int32_t)(10.0*(TICK_BY_MM+1.0)*ODO_LOOP_PERIOD_MS) || dr < (int32_t)(-10.0*(TICK_BY_MM+1.0)*ODO_LOOP_PERIOD_MS) ) {
-            dr = 0;
+        if(ODO_DELTA_INVALID(d, max))
+        {
+            stats->rejected++;
+            if(magnitude > static_cast<uint32_t>(ODO_JUMP_FACTOR * max))
+                stats->jumps++;
+
+            this->status |= ODO_STATUS_ENCODER;
+            return 0;
         }
 
-        this->leftSum  += dl;
-        this->rightSum += dr;
+        if(d == 0)
+            return 0;
+
+        stats->moving++;
+        stats->ticks += magnitude;
+        if(magnitude > stats->peak)
+            stats->peak = magnitude;
+
+        if((magnitude <= ODO_FLIP_TICKS) && (last >= -ODO_FLIP_TICKS) && (last <= ODO_FLIP_TICKS) && ((d ^ last) < 0))
+            stats->flips++;
+
+        this->encoderLast[wheel] = d;
+
+        return d;
+    }
+
+    bool Odometry::GetEncoderStats(uint32_t wheel, ODO_ENCODER_STATS* stats)
+    {
+        if(wheel >= ODO_WHEELS)
+            return false;
+
+        taskENTER_CRITICAL();
+        *stats = this->encoderStats[wheel];
+        taskEXIT_CRITICAL();
+
+        return true;
+    }
+
+    void Odometry::ResetEncoderStats()
+    {
+        taskENTER_CRITICAL();
+        memset(this->encoderStats, 0, sizeof(this->encoderStats));
+        this->encoderLast[ODO_LEFT]  = 0;
+        this->encoderLast[ODO_RIGHT] = 0;
+        this->status &= ~ODO_STATUS_ENCODER;
+        taskEXIT_CRITICAL();
+    }
+
+    void Odometry::integrate(int32_t dl, int32_t dr)
+    {
+        dl = this->wheelScale(dl, this->wheelScaleL, &this->wheelRemL);
+        dr = this->wheelScale(dr, this->wheelScaleR, &this->wheelRemR);
+
+#if ODO_FIXED_POINT
+        int32_t s = 0;
+        int32_t c = 0;
+
+        // Heading (wraps like the float path, within ]-2PI; 2PI])
+        this->heading += static_cast<int64_t>(dr - dl) * this->headingByTick;
+
+        if(this->heading > ODO_HEADING_TURN)
+            this->heading -= ODO_HEADING_TURN;
+        else if(this->heading < -ODO_HEADING_TURN)
+            this->heading += ODO_HEADING_TURN;
+
+        // Position (Q16 ticks), binary angle is the heading modulo one turn
+        Utils::SinCosQ30(static_cast<uint32_t>(this->heading >> 16), &s, &c);
+
+        this->xQ16  += (static_cast<int64_t>(dl + dr) * c) >> 15;
+        this->yQ16  += (static_cast<int64_t>(dl + dr) * s) >> 15;
+        this->lHalf += dl + dr;
+
+        // Publish in float (no double promotion)
+        this->robot.O = static_cast<float32_t>(static_cast<int32_t>(this->heading >> 18)) * ODO_RAD_BY_HEADING18;
+        this->robot.X = static_cast<float32_t>(static_cast<int32_t>(this->xQ16 >> 8)) * (1.0f / 256.0f);
+        this->robot.Y = static_cast<float32_t>(static_cast<int32_t>(this->yQ16 >> 8)) * (1.0f / 256.0f);
+        this->robot.L = static_cast<float32_t>(static_cast<int32_t>(this->lHalf)) * 0.5f;
+#else
+        float32_t dX = 0.0f;
+        float32_t dY = 0.0f;
+
+        float32_t dO = 0.0f;
+        float32_t dL = 0.0f;
+
+        float32_t dlf = 0.0f;
+        float32_t drf = 0.0f;
 
-        //dlf = static_cast<float32_t>(dl) * WC;
         dlf = static_cast<float32_t>(dl);
         drf = static_cast<float32_t>(dr);
 
         dO =  drf - dlf;
-        dL = (drf + dlf) / 2.0;
+        dL = (drf + dlf) * 0.5f;
 
-        this->robot.O += (dO / ADW_TICK);
+        this->robot.O += dO * this->radByTick;
         this->robot.L += dL;
 
-        this->robot.AngularVelocity = (dO / ADW_TICK);
-        this->robot.LinearVelocity  = dL;
+        while(this->robot.O > FASTMATH_2_PI)
+            this->robot.O -= FASTMATH_2_PI;
+        while(this->robot.O < -FASTMATH_2_PI)
+            this->robot.O += FASTMATH_2_PI;
+
+        Utils::SinCos(this->robot.O, &dY, &dX);
+        dX *= dL;
+        dY *= dL;
+
+        this->robot.X += dX;
+        this->robot.Y += dY;
+
+        this->loadFixedPoint();
+#endif
+    }
 
-        while(this->robot.O > _2_PI_)
-            this->robot.O -= _2_PI_;
-        while(this->robot.O < -_2_PI_)
-            this->robot.O += _2_PI_;
+    float32_t Odometry::edgeVelocity(HAL::Encoder* encoder, odo_edge_t* edge, int32_t sign, uint32_t now)
+    {
+        const float32_t cyclesByLoop = static_cast<float32_t>(ODO_LOOP_PERIOD_MS * (SystemCoreClock / 1000u));
+        const uint32_t timeout = ODO_1T_TIMEOUT_MS * (SystemCoreClock / 1000u);
 
-        dX = cos(this->robot.O) * dL;
-        dY = sin(this->robot.O) * dL;
+        uint32_t count = 0;
+        uint32_t timestamp = 0;
+        uint32_t seq = encoder->GetLastEdge(&count, &timestamp);
+        uint32_t elapsed = 0;
+        float32_t bound = 0.0f;
 
+        if(seq != edge->seq)
+        {
+            elapsed = timestamp - edge->timestamp;
+
+            // Mean velocity over the edges captured since the last call
+            if(edge->valid && (elapsed > 0u) && (elapsed < timeout))
+            {
+                edge->velocity = static_cast<float32_t>(sign * static_cast<int32_t>(count - edge->count)) *
+                                 cyclesByLoop / static_cast<float32_t>(elapsed);
+            }
+            else
+            {
+                edge->velocity = 0.0f;
+            }
+
+            edge->seq       = seq;
+            edge->count     = count;
+            edge->timestamp = timestamp;
+            edge->valid     = true;
+        }
+        else if(edge->valid)
+        {
+            elapsed = now - edge->timestamp;
+
+            if(elapsed >= timeout)
+            {
+                edge->velocity = 0.0f;
+                edge->valid    = false;
+            }
+            else if(elapsed > 0u)
+            {
+                // No new edge : wheel is slower than one edge by elapsed time
+                bound = ODO_1T_EDGE_TICKS * cyclesByLoop / static_cast<float32_t>(elapsed);
+
+                if(edge->velocity > bound)
+                    edge->velocity = bound;
+                else if(edge->velocity < -bound)
+                    edge->velocity = -bound;
+            }
+        }
+
+        return edge->velocity;
+    }
+
+    void Odometry::observe(odo_observer_t* obs, float32_t d, float32_t dt)
+    {
+        float32_t r = 0.0f;
+
+        // Tracking the estimate relatively to the measurement keeps the
+        // state bounded (no float precision loss on long distances)
+        obs->e += (obs->v + obs->a * dt * 0.5f) * dt - d;
+
+        r = -obs->e;
+
+        obs->e += ODO_OBSERVER_ALPHA * r;
+        obs->v += obs->a * dt + (ODO_OBSERVER_BETA / dt) * r;
+        obs->a += (2.0f * ODO_OBSERVER_GAMMA / (dt * dt)) * r;
+    }
+
+    void Odometry::SetDriveMotors(HAL::Drv8813* left, HAL::Drv8813* right, float32_t leftRadByTurn, float32_t rightRadByTurn)
+    {
+        taskENTER_CRITICAL();
+
+        this->leftDrive  = left;
+        this->rightDrive = right;
+        this->leftDriveRadByTurn  = leftRadByTurn;
+        this->rightDriveRadByTurn = rightRadByTurn;
+
+        this->leftDriveSteps  = left->ReadSteps();
+        this->rightDriveSteps = right->ReadSteps();
+
+        taskEXIT_CRITICAL();
+    }
+
+    void Odometry::fuse(int64_t start, float32_t dt, bool still)
+    {
+        int64_t dh = this->heading - start;
+        int32_t leftSteps = 0;
+        int32_t rightSteps = 0;
+        float32_t de = 0.0f;
+        float32_t ds = 0.0f;
+        float32_t d = 0.0f;
+        float32_t correction = 0.0f;
+
+        // Encoder wheels heading delta (as integrated, wheels scale applied)
+        if(dh > ODO_HEADING_TURN / 2)
+            dh -= ODO_HEADING_TURN;
+        else if(dh < -ODO_HEADING_TURN / 2)
+            dh += ODO_HEADING_TURN;
+
+        de = static_cast<float32_t>(static_cast<int32_t>(dh >> 18)) * ODO_RAD_BY_HEADING18;
+        d  = de;
+
+        // Drive steps heading delta, ignored while a wheel slips or misses steps
+        if(this->leftDrive != NULL)
+        {
+            leftSteps  = this->leftDrive->ReadSteps();
+            rightSteps = this->rightDrive->ReadSteps();
+
+            ds = static_cast<float32_t>(leftSteps  - this->leftDriveSteps)  * this->leftDriveRadByTurn  / static_cast<float32_t>(this->leftDrive->GetStepsPerTurn()) +
+                 static_cast<float32_t>(rightSteps - this->rightDriveSteps) * this->rightDriveRadByTurn / static_cast<float32_t>(this->rightDrive->GetStepsPerTurn());
+
+            this->leftDriveSteps  = leftSteps;
+            this->rightDriveSteps = rightSteps;
+
+            if(Utils::Abs(ds - de) < ODO_FUSION_SLIP_RAD)
+                d += ODO_FUSION_STEP_WEIGHT * (ds - d);
+        }
+
+        // Gyro heading delta, bias tracked while the robot is still
+        if(this->gyroValid)
+        {
+            if(still)
+                this->gyroBias += ODO_GYRO_BIAS_GAIN * (this->gyroRate - this->gyroBias);
+            else
+                d += ODO_FUSION_GYRO_WEIGHT * ((this->gyroRate - this->gyroBias) * dt * (ODO_LOOP_PERIOD_MS / 1000.0f) - d);
+        }
+
+        if(!this->fusion)
+            return;
+
+        correction = d - de;
+        this->fusionCorrection += correction;
+
+        this->heading += static_cast<int64_t>(correction * ODO_HEADING_BY_RAD);
+
+#if ODO_FIXED_POINT
+        this->robot.O = static_cast<float32_t>(static_cast<int32_t>(this->heading >> 18)) * ODO_RAD_BY_HEADING18;
+#else
+        this->robot.O += correction;
+#endif
+    }
+
+    void Odometry::blend(float32_t dt)
+    {
+        float32_t s = dt * (ODO_LOOP_PERIOD_MS / 1000.0f);
+        float32_t xyMax = this->ticks.ToTick(Units::Millimeter(ODO_CORRECT_MM_BY_S * s)).Value();
+        float32_t dX = _bound(this->correctX, xyMax);
+        float32_t dY = _bound(this->correctY, xyMax);
+        float32_t dO = _bound(this->correctO, ODO_CORRECT_RAD_BY_S * s);
+
+        if((dX == 0.0f) && (dY == 0.0f) && (dO == 0.0f))
+            return;
+
+        this->correctX -= dX;
+        this->correctY -= dY;
+        this->correctO -= dO;
+
+#if ODO_FIXED_POINT
+        this->heading += static_cast<int64_t>(dO * ODO_HEADING_BY_RAD);
+        this->xQ16    += static_cast<int64_t>(dX * 65536.0f);
+        this->yQ16    += static_cast<int64_t>(dY * 65536.0f);
+
+        this->robot.O = static_cast<float32_t>(static_cast<int32_t>(this->heading >> 18)) * ODO_RAD_BY_HEADING18;
+        this->robot.X = static_cast<float32_t>(static_cast<int32_t>(this->xQ16 >> 8)) * (1.0f / 256.0f);
+        this->robot.Y = static_cast<float32_t>(static_cast<int32_t>(this->yQ16 >> 8)) * (1.0f / 256.0f);
+#else
+        this->robot.O += dO;
         this->robot.X += dX;
         this->robot.Y += dY;
 
-        this->robot.LeftVelocity  = dl;
-        this->robot.RightVelocity = dr;
+        this->loadFixedPoint();
+#endif
+    }
+
+    void Odometry::Compute(float32_t period)
+    {
+        int32_t dl = 0;
+        int32_t dr = 0;
+        int64_t heading = 0;
+
+        // Velocities are given by ODO_LOOP_PERIOD_MS
+        float32_t scale = 1.0f;
+
+        Utils::Watchdog::CheckIn(this->health);
+
+        float32_t vl = 0.0f;
+        float32_t vr = 0.0f;
+
+#if ODO_VELOCITY_1T
+        uint32_t now = Utils::Profiler::GetCycles();
+        float32_t vlEdge = 0.0f;
+        float32_t vrEdge = 0.0f;
+
+        if(this->replay == NULL)
+        {
+            vlEdge = this->edgeVelocity(this->leftEncoder,  &this->leftEdge,  +1, now);
+            vrEdge = this->edgeVelocity(this->rightEncoder, &this->rightEdge, -1, now);
+        }
+#endif
+
+#if ODO_SAMPLING_ISR
+        odo_sample_t sample;
+        uint32_t count = 0u;
+#endif
+
+        // Gyro rate read by the previous loop transaction (never blocks)
+        this->gyroValid = false;
+        if((this->gyro != NULL) && (this->replay == NULL) && (this->gyro->Sample() == NO_ERROR))
+        {
+            this->gyroValid = this->gyro->GetRate(&this->gyroRate);
+        }
+
+        this->status |= ODO_STATUS_RUNNING;
 
-        this->robot.Xmm  = static_cast<int32_t>(this->robot.X / TICK_BY_MM);
-        this->robot.Ymm  = static_cast<int32_t>(this->robot.Y / TICK_BY_MM);
-        this->robot.Odeg = static_cast<float32_t>((180.0 * this->robot.O) / _PI_);
-        this->robot.Lmm  = static_cast<int32_t>(this->robot.L / TICK_BY_MM);
+#if ODO_SAMPLING_ISR
+        if(this->replay == NULL)
+        {
+            // Writers are serialized (Set* may be called from other tasks)
+            taskENTER_CRITICAL();
+
+            heading = this->heading;
+
+            // Consume samples latched by the timer interrupt
+            while(this->samples.Pop(sample))
+            {
+
+                sample.dl = this->screen(ODO_LEFT,  sample.dl, this->sampleDeltaMax);
+                sample.dr = this->screen(ODO_RIGHT, sample.dr, this->sampleDeltaMax);
+
+                this->integrate(sample.dl, sample.dr);
+
+                dl += sample.dl;
+                dr += sample.dr;
+
+                count++;
+            }
+
+            // Velocity is computed on the exact sampling time span
+            if(count != 0u)
+            {
+                if(this->lastSampleTime != 0)
+                {
+                    scale = static_cast<float32_t>(ODO_LOOP_PERIOD_MS * (SystemCoreClock / 1000u)) /
+                            static_cast<float32_t>(sample.timestamp - this->lastSampleTime);
+                }
+                else
+                {
+                    scale = static_cast<float32_t>(ODO_LOOP_PERIOD_MS * 1000u) /
+                            static_cast<float32_t>(count * ODO_SAMPLING_PERIOD_US);
+                }
+
+                this->lastSampleTime = sample.timestamp;
+            }
+        }
+        else
+#endif
+        {
+            if(this->replay != NULL)
+            {
+                dl = this->replay->dl;
+                dr = this->replay->dr;
+            }
+            else
+            {
+                // Both counters latched at the same instant (no heading skew)
+                Encoder::GetRelativeValues(leftEncoder, rightEncoder, &dl, &dr);
+                dr = -dr;
+
+                this->record(dl, dr);
+            }
+
+            dl = this->screen(ODO_LEFT,  dl, this->loopDeltaMax);
+            dr = this->screen(ODO_RIGHT, dr, this->loopDeltaMax);
+
+            // Writers are serialized (Set* may be called from other tasks)
+            taskENTER_CRITICAL();
+
+            heading = this->heading;
+
+            this->integrate(dl, dr);
+        }
+
+        this->leftSum  += dl;
+        this->rightSum += dr;
+
+#if ODO_HEADING_FUSION
+        // Replayed runs stay bit exact : no steps or gyro recorded
+        if(this->replay == NULL)
+            this->fuse(heading, 1.0f / scale, (dl == 0) && (dr == 0));
+#endif
+
+        // Not recorded either : replayed runs keep the recorded pose
+        if(this->replay == NULL)
+            this->blend(1.0f / scale);
+
+        // Velocities (by ODO_LOOP_PERIOD_MS)
+        vl = static_cast<float32_t>(dl) * scale;
+        vr = static_cast<float32_t>(dr) * scale;
+
+#if ODO_VELOCITY_1T
+        // Few ticks by loop : edges period is more accurate than ticks count
+        if((this->replay == NULL) && (dl < ODO_1T_MAX_TICKS) && (dl > -ODO_1T_MAX_TICKS))
+            vl = vlEdge;
+        if((this->replay == NULL) && (dr < ODO_1T_MAX_TICKS) && (dr > -ODO_1T_MAX_TICKS))
+            vr = vrEdge;
+#endif
+
+        this->robot.AngularVelocity = (vr - vl) * this->radByTick;
+        this->robot.LinearVelocity  = (vl + vr) * 0.5f;
+
+        this->robot.LeftVelocity  = vl;
+        this->robot.RightVelocity = vr;
+
+#if ODO_OBSERVER
+        // Observers step on the elapsed time (1 / scale loop periods)
+        this->observe(&this->linearObserver,  static_cast<float32_t>(dl + dr) * 0.5f, 1.0f / scale);
+        this->observe(&this->angularObserver, static_cast<float32_t>(dr - dl) * this->radByTick, 1.0f / scale);
+
+        this->robot.LinearVelocityFiltered  = this->linearObserver.v;
+        this->robot.AngularVelocityFiltered = this->angularObserver.v;
+        this->robot.LinearAcceleration      = this->linearObserver.a;
+        this->robot.AngularAcceleration     = this->angularObserver.a;
+#endif
+
+        this->robot.Xmm  = static_cast<int32_t>(this->ticks.ToMillimeter(Units::Tick(this->robot.X)).Value());
+        this->robot.Ymm  = static_cast<int32_t>(this->ticks.ToMillimeter(Units::Tick(this->robot.Y)).Value());
+        this->robot.Odeg = Units::ToDegree(Units::Radian(this->robot.O)).Value();
+        this->robot.Lmm  = static_cast<int32_t>(this->ticks.ToMillimeter(Units::Tick(this->robot.L)).Value());
+
+        this->publish();
+
+        taskEXIT_CRITICAL();
     }
 
-    void Odometry::taskHandler(void* obj)
+    void Odometry::INTERNAL_SampleEncoders()
     {
-        TickType_t xLastWakeTime;
-        TickType_t xFrequency = pdMS_TO_TICKS(ODO_LOOP_PERIOD_MS);
+        odo_sample_t* sample = this->samples.Claim();
 
+        // Oldest sample is kept, newest is dropped if the task is late
+        if(sample == NULL)
+        {
+            this->samplesLost++;
+            return;
+        }
+
+        sample->timestamp = Utils::Profiler::GetCycles();
+        Encoder::GetRelativeValues(leftEncoder, rightEncoder, &sample->dl, &sample->dr);
+        sample->dr = -sample->dr;
+
+        this->record(sample->dl, sample->dr);
+
+        this->samples.Publish();
+    }
+
+    void Odometry::record(int32_t dl, int32_t dr)
+    {
+        if(!this->recording || !Utils::Trace::IsRunning())
+            return;
+
+        // Saturated deltas are glitches either way (above 16 bits)
+        dl = (dl > INT16_MAX) ? INT16_MAX : ((dl < INT16_MIN) ? INT16_MIN : dl);
+        dr = (dr > INT16_MAX) ? INT16_MAX : ((dr < INT16_MIN) ? INT16_MIN : dr);
+
+        Utils::Trace::Marker(ODO_TRACE_LEFT_ID,  static_cast<uint16_t>(static_cast<int16_t>(dl)));
+        Utils::Trace::Marker(ODO_TRACE_RIGHT_ID, static_cast<uint16_t>(static_cast<int16_t>(dr)));
+    }
+
+    void Odometry::Replay(int32_t dl, int32_t dr)
+    {
+        odo_sample_t sample;
+
+        sample.timestamp = 0u;
+        sample.dl = dl;
+        sample.dr = dr;
+
+        // Odometry task does not compute meanwhile
+        vTaskSuspendAll();
+
+        this->replay = &sample;
+        this->Compute(static_cast<float32_t>(ODO_LOOP_PERIOD_MS));
+        this->replay = NULL;
+
+        xTaskResumeAll();
+    }
+
+    uint32_t Odometry::ReplayTrace()
+    {
+        const TRACE_RECORD* r = NULL;
+        int32_t dl = 0;
+        bool left = false;
+        uint32_t count = 0u;
+
+        // Buffer must be frozen
+        if(Utils::Trace::IsRunning())
+            return 0u;
+
+        for(uint32_t i = 0u; i < Utils::Trace::Count(); i++)
+        {
+            r = Utils::Trace::Get(i);
+
+            if((r == NULL) || (r->TYPE != Utils::Trace::MARKER))
+                continue;
+
+            // Right delta follows its left delta (oldest may be overwritten)
+            if(r->ID == ODO_TRACE_LEFT_ID)
+            {
+                dl = static_cast<int16_t>(r->ARG);
+                left = true;
+            }
+            else if((r->ID == ODO_TRACE_RIGHT_ID) && left)
+            {
+                this->Replay(dl, static_cast<int16_t>(r->ARG));
+                left = false;
+                count++;
+            }
+        }
+
+        return count;
+    }
+
+    void Odometry::taskHandler(void* obj)
+    {
         Odometry* instance = _odometry;
-        TickType_t prevTick = 0u,  tick = 0u;
 
         float32_t period = 0.0f;
 
         // 1. Initialise periodical task
-        xLastWakeTime = xTaskGetTickCount();
-
-        // 2. Get tick count
-        prevTick = xTaskGetTickCount();
+        instance->periodic.Start();
 
         while(1)
         {
-            // 2. Wait until period elapse
-            vTaskDelayUntil(&xLastWakeTime, xFrequency);
-
-            // 3. Get tick
-            tick = xTaskGetTickCount();
-
-            period = static_cast<float32_t>(tick) -
-                     static_cast<float32_t>(prevTick);
+            // 2. Wait until period elapse, get elapsed ticks
+            period = instance->periodic.Wait();
 
             //4. Compute location (Odometry)
+            instance->profiler.Start();
             instance->Compute(period);
+            instance->profiler.Stop();
 
-            // 5. Set previous tick
-            prevTick = tick;
+            //5. Notify subscribers (MotionControl chain)
+            instance->SampleAvailable();
         }
     }
 
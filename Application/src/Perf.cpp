@@ -0,0 +1,287 @@
+/**
+ * @file    Perf.cpp
+ * @author  Jeremy ROULLAND
+ * @date    15 oct. 2026
+ * @brief   Performance counters over a measurement window (CPU, loops, buses, losses)
+ */
+
+#include "Perf.hpp"
+#include "MotionControl.hpp"
+#include "Utils.hpp"
+#include "Clock.hpp"
+#include "Serial.hpp"
+#include "I2CSlave.hpp"
+#include "SPIMaster.hpp"
+
+/*----------------------------------------------------------------------------*/
+/* Private Members                                                            */
+/*----------------------------------------------------------------------------*/
+
+/**
+ * @brief Buses name and line bits by byte (start and stop bits, ACK bit)
+ */
+typedef struct
+{
+    const char* name;
+    uint32_t    bits;
+}PERF_BUS;
+
+static const PERF_BUS _buses[PERF_BUS_MAX] =
+{
+    {"console", 10u},
+    {"i2c",     9u},
+    {"spi",     8u},
+};
+
+/**
+ * @brief Window start (us) and baselines of the counters that never reset
+ */
+static uint64_t _start = 0u;
+static uint32_t _taskBase[PERF_TASKS_MAX];
+static uint32_t _busBase[PERF_BUS_MAX];
+static uint32_t _traceBase = 0u;
+static uint32_t _logBase = 0u;
+static uint32_t _txBase = 0u;
+static uint32_t _deferredBase = 0u;
+
+/*----------------------------------------------------------------------------*/
+/* Private Functions                                                          */
+/*----------------------------------------------------------------------------*/
+
+/**
+ * @brief Bus bytes since boot
+ */
+static uint32_t _busBytes(uint32_t bus)
+{
+    switch(bus)
+    {
+    case PERF_BUS_CONSOLE:
+        return HAL::Serial::GetInstance(SERIAL_CONSOLE)->GetSent();
+    case PERF_BUS_I2C:
+        return HAL::I2CSlave::GetInstance(HAL::I2CSlave::I2C_SLAVE0)->GetBytes();
+    case PERF_BUS_SPI:
+        return HAL::SPIMaster::GetInstance(HAL::SPIMaster::SPI_MASTER0)->GetBytes();
+    default:
+        return 0u;
+    }
+}
+
+/**
+ * @brief Bus line rate (bit/s), 0 if none
+ */
+static uint32_t _busRate(uint32_t bus)
+{
+    switch(bus)
+    {
+    case PERF_BUS_CONSOLE:
+        return HAL::Serial::GetInstance(SERIAL_CONSOLE)->GetBitRate();
+    case PERF_BUS_I2C:
+        return HAL::I2CSlave::GetInstance(HAL::I2CSlave::I2C_SLAVE0)->GetBitRate();
+    case PERF_BUS_SPI:
+        return HAL::SPIMaster::GetInstance(HAL::SPIMaster::SPI_MASTER0)->GetBitRate();
+    default:
+        return 0u;
+    }
+}
+
+/**
+ * @brief Counter increase since its baseline, 0 if it went below (restarted)
+ */
+static uint32_t _delta(uint32_t value, uint32_t base)
+{
+    return (value >= base) ? (value - base) : 0u;
+}
+
+/**
+ * @brief Part of whole (1/1000, saturated)
+ */
+static uint16_t _load(uint64_t part, uint64_t whole)
+{
+    if(whole == 0u)
+        return 0u;
+
+    part = (part * 1000u) / whole;
+
+    return (part > 1000u) ? 1000u : (uint16_t)part;
+}
+
+/**
+ * @brief Window length (us)
+ */
+static uint64_t _window()
+{
+    return Utils::Clock::GetMicros64() - _start;
+}
+
+/**
+ * @brief Task run time baseline
+ */
+static uint32_t _taskBaseline(const TaskStatus_t* task)
+{
+    return (task->xTaskNumber < PERF_TASKS_MAX) ? _taskBase[task->xTaskNumber] : 0u;
+}
+
+/*----------------------------------------------------------------------------*/
+/* Class Implementation                                                       */
+/*----------------------------------------------------------------------------*/
+
+void Perf::Reset()
+{
+    TaskStatus_t *tasks;
+    UBaseType_t count;
+
+    _start = Utils::Clock::GetMicros64();
+
+    // Tasks run time (us, wraps) : tasks created later start at 0
+    for(uint32_t t = 0; t < PERF_TASKS_MAX; t++)
+        _taskBase[t] = 0u;
+
+    count = uxTaskGetNumberOfTasks();
+    tasks = (TaskStatus_t*)Utils::Heap::Alloc(count * sizeof(TaskStatus_t));
+
+    if(tasks != NULL)
+    {
+        count = uxTaskGetSystemState(tasks, count, NULL);
+
+        for(UBaseType_t t = 0; t < count; t++)
+        {
+            if(tasks[t].xTaskNumber < PERF_TASKS_MAX)
+                _taskBase[tasks[t].xTaskNumber] = tasks[t].ulRunTimeCounter;
+        }
+
+        Utils::Heap::Free(tasks);
+    }
+
+    for(uint32_t b = 0; b < PERF_BUS_MAX; b++)
+        _busBase[b] = _busBytes(b);
+
+    _traceBase = Utils::Trace::GetLost();
+    _logBase = Utils::Log::GetLost();
+    _txBase = HAL::Serial::GetInstance(SERIAL_CONSOLE)->GetDropped();
+    _deferredBase = Utils::Deferred::GetDropped();
+
+    // Statistics with their own reset
+    for(uint32_t p = 0; p < Utils::Profiler::Count(); p++)
+        Utils::Profiler::Get(p)->Reset();
+
+    for(uint32_t p = 0; p < Utils::PeriodicTask::Count(); p++)
+        Utils::PeriodicTask::Get(p)->Reset();
+
+    MotionControl::FBMotionControl::GetInstance()->ResetOrdersPeak();
+}
+
+uint32_t Perf::GetWindow()
+{
+    return (uint32_t)(_window() / 1000u);
+}
+
+uint32_t Perf::GetTasks(TaskStatus_t* tasks, uint16_t* loads, uint32_t max)
+{
+    uint64_t window = _window();
+    UBaseType_t count;
+
+    count = uxTaskGetSystemState(tasks, max, NULL);
+
+    for(UBaseType_t t = 0; t < count; t++)
+        loads[t] = _load((uint32_t)(tasks[t].ulRunTimeCounter - _taskBaseline(&tasks[t])), window);
+
+    return count;
+}
+
+uint16_t Perf::GetProfilerLoad(uint32_t index)
+{
+    Utils::Profiler *p = Utils::Profiler::Get(index);
+
+    if(p == NULL)
+        return 0u;
+
+    return _load(p->GetTotal(), _window() * (SystemCoreClock / 1000000u));
+}
+
+uint32_t Perf::GetBusBytes(uint32_t bus)
+{
+    if(bus >= PERF_BUS_MAX)
+        return 0u;
+
+    return _delta(_busBytes(bus), _busBase[bus]);
+}
+
+uint16_t Perf::GetBusLoad(uint32_t bus)
+{
+    uint32_t rate;
+
+    if(bus >= PERF_BUS_MAX)
+        return 0u;
+
+    rate = _busRate(bus);
+    if(rate == 0u)
+        return 0u;
+
+    // Line time (us) over window (us)
+    return _load(((uint64_t)GetBusBytes(bus) * _buses[bus].bits * 1000000u) / rate, _window());
+}
+
+const char* Perf::GetBusName(uint32_t bus)
+{
+    return (bus < PERF_BUS_MAX) ? _buses[bus].name : "?";
+}
+
+void Perf::GetSummary(PERF_SUMMARY* summary)
+{
+    TaskStatus_t idle;
+    Utils::Profiler *p;
+    Utils::PeriodicTask *loop;
+    uint64_t window = _window();
+    uint16_t load;
+    uint32_t max;
+
+    summary->window = (uint32_t)(window / 1000u);
+
+    // CPU : all but the idle task
+    vTaskGetInfo(xTaskGetIdleTaskHandle(), &idle, pdFALSE, eReady);
+    summary->cpu = 1000u - _load((uint32_t)(idle.ulRunTimeCounter - _taskBaseline(&idle)), window);
+
+    // Loops and interrupts
+    summary->busiest = 0u;
+    summary->busiestLoad = 0u;
+    summary->loopMax = 0u;
+
+    for(uint32_t i = 0; i < Utils::Profiler::Count(); i++)
+    {
+        p = Utils::Profiler::Get(i);
+
+        load = GetProfilerLoad(i);
+        if(load > summary->busiestLoad)
+        {
+            summary->busiest = (uint8_t)i;
+            summary->busiestLoad = load;
+        }
+
+        max = Utils::Profiler::CyclesToUs(p->GetMax());
+        if(max > summary->loopMax)
+            summary->loopMax = max;
+    }
+
+    summary->latencyMax = 0u;
+    summary->missed = 0u;
+
+    for(uint32_t i = 0; i < Utils::PeriodicTask::Count(); i++)
+    {
+        loop = Utils::PeriodicTask::Get(i);
+
+        if(loop->GetLatencyMax() > summary->latencyMax)
+            summary->latencyMax = loop->GetLatencyMax();
+        summary->missed += loop->GetMissed();
+    }
+
+    // Losses
+    summary->traceLost = _delta(Utils::Trace::GetLost(), _traceBase);
+    summary->logLost = _delta(Utils::Log::GetLost(), _logBase);
+    summary->txDropped = _delta(HAL::Serial::GetInstance(SERIAL_CONSOLE)->GetDropped(), _txBase);
+    summary->deferredDropped = _delta(Utils::Deferred::GetDropped(), _deferredBase);
+
+    summary->ordersPeak = (uint16_t)MotionControl::FBMotionControl::GetInstance()->GetOrdersPeak();
+
+    for(uint32_t b = 0; b < PERF_BUS_MAX; b++)
+        summary->bus[b] = GetBusLoad(b);
+}
@@ -8,9 +8,15 @@
  */
 
 #include "PositionControlStepper.hpp"
+#include "TaskTable.hpp"
+#include "StaticStorage.hpp"
+#include "Clock.hpp"
+#include "Config.hpp"
+#include "Robot.hpp"
 #include "common.h"
 
 #include <stdio.h>
+#include <string.h>
 
 using namespace HAL;
 using namespace Utils;
@@ -30,54 +36,160 @@ using namespace Location;
 #define _2_PI_      6.28318530717958647692  // 2*PI
 
 
-#define PC_MOTOR_LEFT               (Drv8813::ID::DRV8813_4)
-#define PC_MOTOR_RIGHT              (Drv8813::ID::DRV8813_1)
-#define PC_USTEP                    (1.0*200.0)
+#define PC_MOTOR_LEFT               (Robot::Config::WHEEL_LEFT)
+#define PC_MOTOR_RIGHT              (Robot::Config::WHEEL_RIGHT)
 
+// Loop constants (single precision, computed at compile time)
+#define PC_HALF_ADW_M               (static_cast<float32_t>(ADW_MM / 1000.0 / 2.0))
+#define PC_ROT_BY_M                 (static_cast<float32_t>(1000.0 / (RATIO * WD_MM * _PI_)))
+#define PC_VEL_BY_ERROR             (static_cast<float32_t>(1000.0 / PC_TASK_PERIOD_MS))
+#define PC_PERIOD_S                 (static_cast<float32_t>(PC_TASK_PERIOD_MS / 1000.0))
+#define PC_M_BY_ROT                 (static_cast<float32_t>(RATIO * WD_MM * _PI_ / 1000.0))
 
-//#define ANGULAR_VEL_MAX               (0.314f)     /* Low (OK) */
-#define ANGULAR_VEL_MAX             (3.28f)     /* Hight (OK) */
-//#define ANGULAR_VEL_MAX             (12.0f)
-//#define ANGULAR_ACC_MAX             (0.314f)     /* Low (OK) */
-#define ANGULAR_ACC_MAX             (3.14f)     /* Hight (OK) */
-//#define ANGULAR_ACC_MAX             (18.0f)
-#define ANGULAR_PROFILE             (MotionProfile::PROFILE::POLY5)
+// Add profile velocity and acceleration to PID output (profile advance during next period)
+#define PC_FEED_FORWARD             (1u)
 
-//#define LINEAR_VEL_MAX              (0.04f)     /* Low (OK) */
-//#define LINEAR_VEL_MAX              (0.4f)     /* Hight (OK) */
-//#define LINEAR_VEL_MAX              (0.468f)
-#define LINEAR_VEL_MAX              (0.200f)
-//#define LINEAR_VEL_MAX              (1.0f)
-//#define LINEAR_ACC_MAX              (0.05f)     /* Low (OK) */
-//#define LINEAR_ACC_MAX              (0.5f)     /* Hight (OK) */
-#define LINEAR_ACC_MAX              (0.2f)
-#define LINEAR_PROFILE              (MotionProfile::PROFILE::POLY5)
+// Wheel slip / missed steps : commanded steps against encoders travel
+#define PC_SLIP_DETECTION           (1u)
+#define PC_SLIP_THRESHOLD_M         (0.010f)    // Accumulated slip raising detection
+#define PC_SLIP_DECAY               (0.98f)     // Forgetting factor by period (calibration drift, latency)
 
+// Velocity override slew rate (ratio by second) : 0.2 m/s brakes at 0.8 m/s^2
+#define PC_OVERRIDE_RATE            (4.0f)
 
-#define ANGULAR_POSITION_PID_KP     (0.314f)
-#define ANGULAR_POSITION_PID_KI     (0.03f)
-#define ANGULAR_POSITION_PID_KD     (0.0f)
+// Profiles started in the same period are synchronized
+#define PC_SYNC_WINDOW_S            (0.5f * PC_PERIOD_S)
 
-#define LINEAR_POSITION_PID_KP      (0.5f)
-#define LINEAR_POSITION_PID_KI      (0.0f)
-#define LINEAR_POSITION_PID_KD      (0.0f)
+// Positioning completion window defaults (live parameters win*)
+#define PC_SETTLE_LINEAR            (0.001f)    // m
+#define PC_SETTLE_ANGULAR           (0.005f)    // rad
+#define PC_SETTLE_LINEAR_VEL        (0.005f)    // m/s
+#define PC_SETTLE_ANGULAR_VEL       (0.02f)     // rad/s
+#define PC_SETTLE_SAMPLES           (3u)
+#define PC_SETTLE_TIMEOUT_S         (0.5f)
 
 
-#define PC_TASK_STACK_SIZE          (512u)
-#define PC_TASK_PRIORITY            (configMAX_PRIORITIES-4)
+// Limits and gains from non volatile configuration (defaults in Config.cpp)
+#define ANGULAR_VEL_MAX             (Config::Get()->angularVelMax)
+#define ANGULAR_ACC_MAX             (Config::Get()->angularAccMax)
+//#define ANGULAR_JERK_MAX            (3.14f)     /* Low (OK) */
+#define ANGULAR_JERK_MAX            (31.4f)
+#define ANGULAR_PROFILE             (MotionProfile::PROFILE::SCURVE)
+
+#define LINEAR_VEL_MAX              (Config::Get()->linearVelMax)
+#define LINEAR_ACC_MAX              (Config::Get()->linearAccMax)
+#define LINEAR_JERK_MAX             (2.0f)
+
+
+#define ANGULAR_POSITION_PID_KP     (Config::Get()->angularKp)
+#define ANGULAR_POSITION_PID_KI     (Config::Get()->angularKi)
+#define ANGULAR_POSITION_PID_KD     (Config::Get()->angularKd)
+
+#define LINEAR_POSITION_PID_KP      (Config::Get()->linearKp)
+#define LINEAR_POSITION_PID_KI      (Config::Get()->linearKi)
+#define LINEAR_POSITION_PID_KD      (Config::Get()->linearKd)
+
+// PID correction saturated to max velocity advance during one period (anti-windup)
+#define ANGULAR_POSITION_PID_MAX    (ANGULAR_VEL_MAX * PC_PERIOD_S)
+#define LINEAR_POSITION_PID_MAX     (LINEAR_VEL_MAX  * PC_PERIOD_S)
+
+// Velocity loop PI (cascade), correction saturated to a fraction of max velocity
+#define ANGULAR_VELOCITY_PID_KP     (0.5f)
+#define ANGULAR_VELOCITY_PID_KI     (2.0f)
+#define LINEAR_VELOCITY_PID_KP      (0.5f)
+#define LINEAR_VELOCITY_PID_KI      (2.0f)
+#define PC_VELOCITY_PID_RATIO       (0.5f)
+#define PC_VC_PERIOD_S              (static_cast<float32_t>(PC_VC_PERIOD_MS / 1000.0))
+
+// PID derivative filter time constant (s)
+#define PC_PID_DERIVATIVE_TF        (4.0f * PC_PERIOD_S)
+
+// Live tuning bounds (see Utils::Param)
+#define PC_PARAM_GAIN_MAX           (10.0f)
+#define PC_PARAM_ANGULAR_MAX        (20.0f)     // rad/s, rad/s^2, rad/s^3
+#define PC_PARAM_LINEAR_MAX         (2.0f)      // m/s, m/s^2 (jerk : 10 times)
+
+// PID auto-tuning relay : amplitude (velocity advance by period), hysteresis above encoders noise
+#define PC_TUNE_ANGULAR_VEL         (0.5f)      // rad/s
+#define PC_TUNE_ANGULAR_HYSTERESIS  (0.002f)    // rad
+#define PC_TUNE_LINEAR_VEL          (0.05f)     // m/s
+#define PC_TUNE_LINEAR_HYSTERESIS   (0.0005f)   // m
+#define PC_TUNE_CYCLES              (5u)
+#define PC_TUNE_TIMEOUT_S           (20.0f)
+
+// Step position mode : residual error corrected once motors are idle, motors ramps limits
+#define PC_STEP_ANGULAR_DEADBAND    (0.005f)    // rad
+#define PC_STEP_LINEAR_DEADBAND     (0.0005f)   // m
+#define PC_STEP_CORRECTIONS         (2u)
+#define PC_STEP_SPEED_MAX           (20000.0f)  // step/s
+#define PC_STEP_ACCEL_MAX           (200000.0f) // step/s^2
+
+// Schedule PID gains with profiled velocity (see tables below)
+#define PC_GAIN_SCHEDULING          (0u)
+
+// Log profiled/measured positions and motors commands while positioning (deferred log, see Utils::Log)
+#define PC_LOG_TRACES               (0u)
 
-#define PC_TASK_PERIOD_MS           (100u)
 
 /*----------------------------------------------------------------------------*/
 /* Private Members                                                            */
 /*----------------------------------------------------------------------------*/
 
 static MotionControl::PositionControl* _positionControl = NULL;
+static Utils::StaticStorage<MotionControl::PositionControl> _positionControlStorage;
+
+#if PC_GAIN_SCHEDULING
+/**
+ * @brief Gain schedules (sorted by velocity, interpolated, filled from configuration at init)
+ */
+static PID_GAINS _angularSchedule[2];
+static PID_GAINS _linearSchedule[2];
+#endif
 
 /*----------------------------------------------------------------------------*/
 /* Private Functions                                                          */
 /*----------------------------------------------------------------------------*/
 
+/**
+ * @brief Tuning parameter changed (Utils::Param, caller context)
+ * @param obj : PositionControl instance
+ */
+static void _tuningChangedEvent (void* obj)
+{
+    PositionControl* pc = reinterpret_cast<PositionControl*>(obj);
+
+    pc->INTERNAL_TuningChanged();
+}
+
+/**
+ * @brief Start a motor ramp (step mode)
+ * @param motor : Motor
+ * @param steps : Signed steps
+ * @param rate : Normalized move velocity (1/s)
+ * @param accel : Normalized move acceleration (1/s^2)
+ */
+static void _moveMotor (Drv8813* motor, float32_t steps, float32_t rate, float32_t accel)
+{
+    float32_t count = fabsf(steps);
+    float32_t speed = count * rate;
+    float32_t acc   = count * accel;
+
+    if(count < 0.5f)
+        return;
+
+    if(speed > PC_STEP_SPEED_MAX)
+        speed = PC_STEP_SPEED_MAX;
+    if(speed < 1.0f)
+        speed = 1.0f;
+    if(acc > PC_STEP_ACCEL_MAX)
+        acc = PC_STEP_ACCEL_MAX;
+    if(acc < 1.0f)
+        acc = 1.0f;
+
+    motor->SetDirection((steps > 0.0f) ? Drv8813State::FORWARD : Drv8813State::BACKWARD);
+    motor->Move(static_cast<uint32_t>(count + 0.5f), static_cast<uint32_t>(speed), static_cast<uint32_t>(acc));
+}
+
 static PC_DEF _getDefStructure (enum PositionControl::ID id)
 {
     PC_DEF def;
@@ -92,6 +204,12 @@ static PC_DEF _getDefStructure (enum PositionControl::ID id)
             def.PID_Angular.kp           =    ANGULAR_POSITION_PID_KP;
             def.PID_Angular.ki           =    ANGULAR_POSITION_PID_KI;
             def.PID_Angular.kd           =    ANGULAR_POSITION_PID_KD;
+            def.PID_AngularVelocity.kp   =    ANGULAR_VELOCITY_PID_KP;
+            def.PID_AngularVelocity.ki   =    ANGULAR_VELOCITY_PID_KI;
+            def.PID_AngularVelocity.kd   =    0.0f;
+            def.Limits_Angular.velMax    =    ANGULAR_VEL_MAX;
+            def.Limits_Angular.accMax    =    ANGULAR_ACC_MAX;
+            def.Limits_Angular.jerkMax   =    ANGULAR_JERK_MAX;
             break;
 
         case PositionControl::LINEAR:
@@ -100,6 +218,12 @@ static PC_DEF _getDefStructure (enum PositionControl::ID id)
             def.PID_Linear.kp            =    LINEAR_POSITION_PID_KP;
             def.PID_Linear.ki            =    LINEAR_POSITION_PID_KI;
             def.PID_Linear.kd            =    LINEAR_POSITION_PID_KD;
+            def.PID_LinearVelocity.kp    =    LINEAR_VELOCITY_PID_KP;
+            def.PID_LinearVelocity.ki    =    LINEAR_VELOCITY_PID_KI;
+            def.PID_LinearVelocity.kd    =    0.0f;
+            def.Limits_Linear.velMax     =    LINEAR_VEL_MAX;
+            def.Limits_Linear.accMax     =    LINEAR_ACC_MAX;
+            def.Limits_Linear.jerkMax    =    LINEAR_JERK_MAX;
             break;
 
         default:
@@ -109,6 +233,35 @@ static PC_DEF _getDefStructure (enum PositionControl::ID id)
     return def;
 }
 
+static PC_PRESET _getPreset (uint32_t preset)
+{
+    const CONFIG_DATA* config = Config::Get();
+    PC_PRESET p;
+
+    if(preset == PC_PRESET_FAST)
+    {
+        p.PID_Angular    = {config->fastAngularKp, config->fastAngularKi, config->fastAngularKd};
+        p.PID_Linear     = {config->fastLinearKp,  config->fastLinearKi,  config->fastLinearKd};
+        p.Limits_Angular = {config->fastAngularVelMax, config->fastAngularAccMax, ANGULAR_JERK_MAX};
+        p.Limits_Linear  = {config->fastLinearVelMax,  config->fastLinearAccMax,  LINEAR_JERK_MAX};
+
+        // Same jerk / acceleration ratio : same S-curve shape
+        if(ANGULAR_ACC_MAX > 0.0f)
+            p.Limits_Angular.jerkMax *= p.Limits_Angular.accMax / ANGULAR_ACC_MAX;
+        if(LINEAR_ACC_MAX > 0.0f)
+            p.Limits_Linear.jerkMax *= p.Limits_Linear.accMax / LINEAR_ACC_MAX;
+    }
+    else
+    {
+        p.PID_Angular    = {ANGULAR_POSITION_PID_KP, ANGULAR_POSITION_PID_KI, ANGULAR_POSITION_PID_KD};
+        p.PID_Linear     = {LINEAR_POSITION_PID_KP,  LINEAR_POSITION_PID_KI,  LINEAR_POSITION_PID_KD};
+        p.Limits_Angular = {ANGULAR_VEL_MAX, ANGULAR_ACC_MAX, ANGULAR_JERK_MAX};
+        p.Limits_Linear  = {LINEAR_VEL_MAX,  LINEAR_ACC_MAX,  LINEAR_JERK_MAX};
+    }
+
+    return p;
+}
+
 /*----------------------------------------------------------------------------*/
 /* Class Implementation                                                       */
 /*----------------------------------------------------------------------------*/
@@ -125,7 +278,7 @@ namespace MotionControl
         }
         else
         {
-            _positionControl = new PositionControl(standalone);
+            _positionControl = new (_positionControlStorage.Get()) PositionControl(standalone);
             return _positionControl;
         }
     }
@@ -133,42 +286,145 @@ namespace MotionControl
     /**
      * @brief  PositionControl constructor
      */
-    PositionControl::PositionControl(bool standalone)
+    PositionControl::PositionControl(bool standalone) : profiler("PositionControl"), periodic("PositionControl", PC_TASK_PERIOD_MS)
     {
-        float32_t currentAngularPosition = 0.0;
-        float32_t currentLinearPosition  = 0.0;
+        float32_t currentAngularPosition = 0.0f;
+        float32_t currentLinearPosition  = 0.0f;
+        PC_DEF linear;
 
         this->name = "PositionControl";
         this->taskHandle = NULL;
+        this->health = -1;
 
         this->status = 0x0000;
 
+        // Profiles clock at full velocity
+        this->override = 1.0f;
+        this->overrideTarget = 1.0f;
+        this->limitScale = 1.0f;
+        this->accDerate = 1.0f;
+        this->clockLast = Utils::Clock::GetSeconds();
+        this->profileTime = this->clockLast;
+
         // Init Angular velocity control
         this->def = _getDefStructure(PositionControl::ANGULAR);
         this->pid_angular = PID(this->def.PID_Angular.kp,
                                 this->def.PID_Angular.ki,
                                 this->def.PID_Angular.kd,
-                                PC_TASK_PERIOD_MS/1000.0);
-
-        // Init Linear velocity control
-        this->def = _getDefStructure(PositionControl::LINEAR);
+                                PC_TASK_PERIOD_MS/1000.0f);
+        this->pid_angular.SetOutputLimits(-ANGULAR_POSITION_PID_MAX, ANGULAR_POSITION_PID_MAX);
+        this->pid_angular.SetDerivativeFilter(PC_PID_DERIVATIVE_TF);
+
+        // Init Linear velocity control (angular definitions are kept)
+        linear = _getDefStructure(PositionControl::LINEAR);
+        this->def.PID_Linear    = linear.PID_Linear;
+        this->def.PID_LinearVelocity = linear.PID_LinearVelocity;
+        this->def.Limits_Linear = linear.Limits_Linear;
         this->pid_linear  = PID(this->def.PID_Linear.kp,
                                 this->def.PID_Linear.ki,
                                 this->def.PID_Linear.kd,
-                                PC_TASK_PERIOD_MS/1000.0);
+                                PC_TASK_PERIOD_MS/1000.0f);
+        this->pid_linear.SetOutputLimits(-LINEAR_POSITION_PID_MAX, LINEAR_POSITION_PID_MAX);
+        this->pid_linear.SetDerivativeFilter(PC_PID_DERIVATIVE_TF);
+
+        // Init velocity loops (cascade)
+        this->pid_angularVelocity = PID(this->def.PID_AngularVelocity.kp,
+                                        this->def.PID_AngularVelocity.ki,
+                                        this->def.PID_AngularVelocity.kd,
+                                        PC_VC_PERIOD_S);
+        this->pid_angularVelocity.SetOutputLimits(-PC_VELOCITY_PID_RATIO * ANGULAR_VEL_MAX, PC_VELOCITY_PID_RATIO * ANGULAR_VEL_MAX);
+        this->pid_linearVelocity  = PID(this->def.PID_LinearVelocity.kp,
+                                        this->def.PID_LinearVelocity.ki,
+                                        this->def.PID_LinearVelocity.kd,
+                                        PC_VC_PERIOD_S);
+        this->pid_linearVelocity.SetOutputLimits(-PC_VELOCITY_PID_RATIO * LINEAR_VEL_MAX, PC_VELOCITY_PID_RATIO * LINEAR_VEL_MAX);
+
+#if PC_GAIN_SCHEDULING
+        _angularSchedule[0] = {0.0f,            ANGULAR_POSITION_PID_KP, ANGULAR_POSITION_PID_KI, ANGULAR_POSITION_PID_KD};
+        _angularSchedule[1] = {ANGULAR_VEL_MAX, ANGULAR_POSITION_PID_KP, ANGULAR_POSITION_PID_KI, ANGULAR_POSITION_PID_KD};
+        _linearSchedule[0]  = {0.0f,            LINEAR_POSITION_PID_KP,  LINEAR_POSITION_PID_KI,  LINEAR_POSITION_PID_KD};
+        _linearSchedule[1]  = {LINEAR_VEL_MAX,  LINEAR_POSITION_PID_KP,  LINEAR_POSITION_PID_KI,  LINEAR_POSITION_PID_KD};
+
+        this->pid_angular.SetSchedule(_angularSchedule, sizeof(_angularSchedule) / sizeof(_angularSchedule[0]));
+        this->pid_linear.SetSchedule(_linearSchedule, sizeof(_linearSchedule) / sizeof(_linearSchedule[0]));
+#endif
 
         this->leftMotor  = Drv8813::GetInstance(this->def.Motors.ID_left);
         this->rightMotor = Drv8813::GetInstance(this->def.Motors.ID_right);
 
+        // Wheels resonance : never held, crossed in one step
+        this->leftMotor->SetResonanceBand(0u, Config::Get()->wheelBandLow, Config::Get()->wheelBandHigh);
+        this->rightMotor->SetResonanceBand(0u, Config::Get()->wheelBandLow, Config::Get()->wheelBandHigh);
+
         this->odometry = Odometry::GetInstance();
 
+        // Drive steps refine odometry heading (left motor is mounted reversed : forward steps turn left)
+        this->odometry->SetDriveMotors(this->leftMotor, this->rightMotor,
+                                       + PC_M_BY_ROT / (2.0f * PC_HALF_ADW_M),
+                                       + PC_M_BY_ROT / (2.0f * PC_HALF_ADW_M));
+
         this->angularProfile = MotionProfile(ANGULAR_VEL_MAX,
                                              ANGULAR_ACC_MAX,
-                                             ANGULAR_PROFILE);
-
-        this->linearProfile = MotionProfile(LINEAR_VEL_MAX,
-                                            LINEAR_ACC_MAX,
-                                            LINEAR_PROFILE);
+                                             ANGULAR_PROFILE,
+                                             ANGULAR_JERK_MAX);
+
+        this->linearProfile = StaticMotionProfile<LINEAR_PROFILE>(LINEAR_VEL_MAX,
+                                                                  LINEAR_ACC_MAX,
+                                                                  LINEAR_JERK_MAX);
+
+        // Presets from Config, normal one is the definition above
+        for(uint32_t i = 0u; i < PC_PRESETS; i++)
+            this->presets[i] = _getPreset(i);
+        this->preset = PC_PRESET_NORMAL;
+
+        // Live tuning (same names as Config parameters), applied by Compute()
+        this->tuningChanged = false;
+        this->tuningAxis = PositionControl::ANGULAR;
+        Param::Register("angvelmax",  &this->def.Limits_Angular.velMax,  0.0f, PC_PARAM_ANGULAR_MAX,        &_tuningChangedEvent, this);
+        Param::Register("angaccmax",  &this->def.Limits_Angular.accMax,  0.0f, PC_PARAM_ANGULAR_MAX,        &_tuningChangedEvent, this);
+        Param::Register("angjerkmax", &this->def.Limits_Angular.jerkMax, 0.0f, 10.0f * PC_PARAM_ANGULAR_MAX, &_tuningChangedEvent, this);
+        Param::Register("linvelmax",  &this->def.Limits_Linear.velMax,   0.0f, PC_PARAM_LINEAR_MAX,         &_tuningChangedEvent, this);
+        Param::Register("linaccmax",  &this->def.Limits_Linear.accMax,   0.0f, PC_PARAM_LINEAR_MAX,         &_tuningChangedEvent, this);
+        Param::Register("linjerkmax", &this->def.Limits_Linear.jerkMax,  0.0f, 10.0f * PC_PARAM_LINEAR_MAX,  &_tuningChangedEvent, this);
+        Param::Register("angkp",      &this->def.PID_Angular.kp,         0.0f, PC_PARAM_GAIN_MAX,           &_tuningChangedEvent, this);
+        Param::Register("angki",      &this->def.PID_Angular.ki,         0.0f, PC_PARAM_GAIN_MAX,           &_tuningChangedEvent, this);
+        Param::Register("angkd",      &this->def.PID_Angular.kd,         0.0f, PC_PARAM_GAIN_MAX,           &_tuningChangedEvent, this);
+        Param::Register("linkp",      &this->def.PID_Linear.kp,          0.0f, PC_PARAM_GAIN_MAX,           &_tuningChangedEvent, this);
+        Param::Register("linki",      &this->def.PID_Linear.ki,          0.0f, PC_PARAM_GAIN_MAX,           &_tuningChangedEvent, this);
+        Param::Register("linkd",      &this->def.PID_Linear.kd,          0.0f, PC_PARAM_GAIN_MAX,           &_tuningChangedEvent, this);
+        Param::Register("angvkp",     &this->def.PID_AngularVelocity.kp, 0.0f, PC_PARAM_GAIN_MAX,           &_tuningChangedEvent, this);
+        Param::Register("angvki",     &this->def.PID_AngularVelocity.ki, 0.0f, PC_PARAM_GAIN_MAX,           &_tuningChangedEvent, this);
+        Param::Register("linvkp",     &this->def.PID_LinearVelocity.kp,  0.0f, PC_PARAM_GAIN_MAX,           &_tuningChangedEvent, this);
+        Param::Register("linvki",     &this->def.PID_LinearVelocity.ki,  0.0f, PC_PARAM_GAIN_MAX,           &_tuningChangedEvent, this);
+
+        // Completion window (read each period)
+        this->settle.linear     = PC_SETTLE_LINEAR;
+        this->settle.angular    = PC_SETTLE_ANGULAR;
+        this->settle.linearVel  = PC_SETTLE_LINEAR_VEL;
+        this->settle.angularVel = PC_SETTLE_ANGULAR_VEL;
+        this->settle.samples    = PC_SETTLE_SAMPLES;
+        this->settle.timeout    = PC_SETTLE_TIMEOUT_S;
+        Param::Register("winlin",     &this->settle.linear,              0.0f, 0.1f);
+        Param::Register("winang",     &this->settle.angular,             0.0f, 1.0f);
+        Param::Register("winlinvel",  &this->settle.linearVel,           0.0f, PC_PARAM_LINEAR_MAX);
+        Param::Register("winangvel",  &this->settle.angularVel,          0.0f, PC_PARAM_ANGULAR_MAX);
+        Param::Register("winn",       &this->settle.samples,             1u,   100u);
+        Param::Register("wintimeout", &this->settle.timeout,             0.0f, 10.0f);
+
+        // Runtime inspection (CLI watch, peek)
+        WATCH_MEMBER("pc", linearPositionProfiled);
+        WATCH_MEMBER("pc", angularPositionProfiled);
+        WATCH_MEMBER("pc", linearPositionError);
+        WATCH_MEMBER("pc", angularPositionError);
+        WATCH_MEMBER("pc", linearVelocity);
+        WATCH_MEMBER("pc", angularVelocity);
+        WATCH_MEMBER("pc", linearVelocitySetpoint);
+        WATCH_MEMBER("pc", angularVelocitySetpoint);
+        WATCH_MEMBER("pc", leftSlip);
+        WATCH_MEMBER("pc", rightSlip);
+        WATCH_MEMBER("pc", override);
+        WATCH_MEMBER("pc", status);
+        WATCH_MEMBER_RW("pc", synchronized);
 
 
         // Get current positions
@@ -181,15 +437,23 @@ namespace MotionControl
         this->angularPositionProfiled = currentAngularPosition;
         this->linearPositionProfiled  = currentLinearPosition;
 
-        this->angularPositionLast = 0.0;
-        this->linearPositionLast  = 0.0;
+        this->angularPositionLast = 0.0f;
+        this->linearPositionLast  = 0.0f;
 
-        this->angularPositionError = 0.0;
-        this->linearPositionError  = 0.0;
+        this->angularPositionError = 0.0f;
+        this->linearPositionError  = 0.0f;
 
         this->angularVelocity = 0.0f;
         this->linearVelocity  = 0.0f;
 
+        this->angularVelocitySetpoint = 0.0f;
+        this->linearVelocitySetpoint  = 0.0f;
+
+        this->angularVelocityProfiled = 0.0f;
+        this->linearVelocityProfiled  = 0.0f;
+        this->angularAccelerationProfiled = 0.0f;
+        this->linearAccelerationProfiled  = 0.0f;
+
         this->angularProfile.SetSetPoint(currentAngularPosition,
                                          currentAngularPosition,
                                          this->getTime());
@@ -198,16 +462,45 @@ namespace MotionControl
                                         this->getTime());
 
         this->enable = true;
+        this->angularTracking = false;
+        this->linearTracking = false;
+        this->linearTrackedVelocity = 0.0f;
+        this->linearTrackedAcceleration = 0.0f;
+        this->synchronized = true;
+
+        memset(this->setpoints, 0, sizeof(this->setpoints));
+        this->published = 0u;
+        this->pending = false;
+
+        this->commands = xQueueCreateStatic(PC_COMMANDS_MAX, sizeof(PC_COMMAND), this->commandsStorage, &this->commandsBuffer);
+        this->commandsLost = 0u;
+
+        this->stepMode = false;
+        this->stepAngularTarget = currentAngularPosition;
+        this->stepLinearTarget  = currentLinearPosition;
+        this->stepCorrections = 0u;
+
+        this->leftSlip  = 0.0f;
+        this->rightSlip = 0.0f;
+        this->slipping  = false;
+
+        this->settleCount = 0u;
+        this->settleStart = 0.0f;
+        this->settled = true;
+        this->settleTimedOut = false;
+
+        this->slipLeftSteps  = this->leftMotor->ReadSteps();
+        this->slipRightSteps = this->rightMotor->ReadSteps();
+        this->slipLinear     = currentLinearPosition;
+        this->slipAngular    = currentAngularPosition;
 
         if(standalone)
         {
             // Create task
-            xTaskCreate((TaskFunction_t)(&PositionControl::taskHandler),
-                        this->name.c_str(),
-                        PC_TASK_STACK_SIZE,
-                        NULL,
-                        PC_TASK_PRIORITY,
-                        NULL);
+            TaskTable::Create(TaskTable::POSITION_CONTROL, (TaskFunction_t)(&PositionControl::taskHandler), this->name);
+
+            // Own loop supervised (else computed by MotionControl, only while enabled)
+            this->health = Utils::Watchdog::Register(this->name, TASK_WATCHDOG_PERIODS * PC_TASK_PERIOD_MS);
         }
 
     }
@@ -215,15 +508,153 @@ namespace MotionControl
     /**
      * @brief  PositionControl compute
      */
+    void PositionControl::applyTuning()
+    {
+        this->pid_angular.SetKp(this->def.PID_Angular.kp);
+        this->pid_angular.SetKi(this->def.PID_Angular.ki);
+        this->pid_angular.SetKd(this->def.PID_Angular.kd);
+        this->pid_angular.SetOutputLimits(-this->def.Limits_Angular.velMax * PC_PERIOD_S, this->def.Limits_Angular.velMax * PC_PERIOD_S);
+
+        this->pid_linear.SetKp(this->def.PID_Linear.kp);
+        this->pid_linear.SetKi(this->def.PID_Linear.ki);
+        this->pid_linear.SetKd(this->def.PID_Linear.kd);
+        this->pid_linear.SetOutputLimits(-this->def.Limits_Linear.velMax * PC_PERIOD_S, this->def.Limits_Linear.velMax * PC_PERIOD_S);
+
+        this->pid_angularVelocity.SetKp(this->def.PID_AngularVelocity.kp);
+        this->pid_angularVelocity.SetKi(this->def.PID_AngularVelocity.ki);
+        this->pid_angularVelocity.SetOutputLimits(-PC_VELOCITY_PID_RATIO * this->def.Limits_Angular.velMax, PC_VELOCITY_PID_RATIO * this->def.Limits_Angular.velMax);
+
+        this->pid_linearVelocity.SetKp(this->def.PID_LinearVelocity.kp);
+        this->pid_linearVelocity.SetKi(this->def.PID_LinearVelocity.ki);
+        this->pid_linearVelocity.SetOutputLimits(-PC_VELOCITY_PID_RATIO * this->def.Limits_Linear.velMax, PC_VELOCITY_PID_RATIO * this->def.Limits_Linear.velMax);
+
+#if PC_GAIN_SCHEDULING
+        _angularSchedule[0] = {0.0f,                             this->def.PID_Angular.kp, this->def.PID_Angular.ki, this->def.PID_Angular.kd};
+        _angularSchedule[1] = {this->def.Limits_Angular.velMax,  this->def.PID_Angular.kp, this->def.PID_Angular.ki, this->def.PID_Angular.kd};
+        _linearSchedule[0]  = {0.0f,                             this->def.PID_Linear.kp,  this->def.PID_Linear.ki,  this->def.PID_Linear.kd};
+        _linearSchedule[1]  = {this->def.Limits_Linear.velMax,   this->def.PID_Linear.kp,  this->def.PID_Linear.ki,  this->def.PID_Linear.kd};
+#endif
+
+        // Applied from next setpoint
+        this->applyLimits();
+        this->angularProfile.SetJerkMax(this->def.Limits_Angular.jerkMax);
+        this->linearProfile.SetJerkMax(this->def.Limits_Linear.jerkMax);
+    }
+
+    void PositionControl::applyLimits()
+    {
+        const float32_t acc = this->limitScale * this->accDerate;
+
+        this->angularProfile.SetVelMax(this->def.Limits_Angular.velMax * this->limitScale);
+        this->angularProfile.SetAccMax(this->def.Limits_Angular.accMax * acc);
+        this->linearProfile.SetVelMax(this->def.Limits_Linear.velMax * this->limitScale);
+        this->linearProfile.SetAccMax(this->def.Limits_Linear.accMax * acc);
+    }
+
+    void PositionControl::superviseThermal()
+    {
+        float32_t derate = this->leftMotor->GetDerate();
+
+        if(this->rightMotor->GetDerate() < derate)
+            derate = this->rightMotor->GetDerate();
+
+        // Hottest wheel sets both axes accelerations (step mode moves are derated by the drivers)
+        if(derate != this->accDerate)
+        {
+            this->accDerate = derate;
+            this->applyLimits();
+        }
+    }
+
+    bool PositionControl::StartTuning(enum PositionControl::ID axis)
+    {
+        assert(axis < PositionControl::POSITION_MAX);
+
+        // Checked again when applied
+        if(!this->enable || !this->isPositioningFinished())
+            return false;
+
+        return this->postCommand(PC_COMMAND_TUNE_START, static_cast<uint8_t>(axis));
+    }
+
+    void PositionControl::applyStartTuning(enum PositionControl::ID axis)
+    {
+        if(!this->enable || !this->isPositioningFinished())
+            return;
+
+        this->tuningAxis = axis;
+
+        // Oscillate around the profiled (held) position, PID restarts from scratch
+        if(axis == PositionControl::ANGULAR)
+        {
+            this->pid_angular.Reset();
+            this->tuner.Start(this->angularPositionProfiled, PC_TUNE_ANGULAR_VEL * PC_PERIOD_S,
+                              PC_TUNE_ANGULAR_HYSTERESIS, PC_TUNE_CYCLES, PC_TUNE_TIMEOUT_S);
+        }
+        else
+        {
+            this->pid_linear.Reset();
+            this->tuner.Start(this->linearPositionProfiled, PC_TUNE_LINEAR_VEL * PC_PERIOD_S,
+                              PC_TUNE_LINEAR_HYSTERESIS, PC_TUNE_CYCLES, PC_TUNE_TIMEOUT_S);
+        }
+    }
+
+    bool PositionControl::ApplyTuning(enum RelayTuner::RULE rule)
+    {
+        static const char* names[PositionControl::POSITION_MAX][3] =
+        {
+            {"angkp", "angki", "angkd"},
+            {"linkp", "linki", "linkd"},
+        };
+        PID_GAINS gains = this->tuner.GetGains(rule);
+        const float32_t values[3] = {gains.kp, gains.ki, gains.kd};
+        int32_t index[3];
+
+        if(this->tuner.GetState() != RelayTuner::DONE)
+            return false;
+
+        // All or nothing : check bounds first
+        for(uint32_t i = 0u; i < 3u; i++)
+        {
+            index[i] = Param::Find(names[this->tuningAxis][i]);
+            if((index[i] < 0) || (values[i] < Param::GetMin(index[i])) || (values[i] > Param::GetMax(index[i])))
+                return false;
+        }
+
+        for(uint32_t i = 0u; i < 3u; i++)
+            Param::Set(index[i], values[i]);
+
+        return true;
+    }
+
     void PositionControl::Compute(float32_t period)
     {
-        float32_t currentAngularPosition = 0.0;
-        float32_t currentLinearPosition  = 0.0;
+        float32_t currentAngularPosition = 0.0f;
+        float32_t currentLinearPosition  = 0.0f;
 
-        float32_t angularVelocity = 0.0;
-        float32_t linearVelocity  = 0.0;
+        float32_t angularVelocity = 0.0f;
+        float32_t linearVelocity  = 0.0f;
 
-        float32_t time = getTime();
+        float32_t time = 0.0f;
+
+        Utils::Watchdog::CheckIn(this->health);
+
+        this->updateTime();
+
+        // Tuning parameters written by another task
+        if(this->tuningChanged)
+        {
+            this->tuningChanged = false;
+            this->applyTuning();
+        }
+
+        // Commands posted by other tasks, before the setpoint posted after them
+        this->receive();
+
+        // Setpoint published by TrajectoryPlanning
+        this->swap();
+
+        time = getTime();
 
         // Get current positions
         currentAngularPosition = odometry->GetAngularPosition();
@@ -245,10 +676,45 @@ namespace MotionControl
         this->linearVelocity  = linearVelocity;*/
 
         this->angularProfile.SetPoint(this->angularPosition);
-        this->linearProfile.SetPoint(this->linearPosition);
-
         this->angularPositionProfiled = this->angularProfile.Get(time);
-        this->linearPositionProfiled  = this->linearProfile.Get(time);
+
+        // Tracked linear setpoint is already planned
+        if(this->linearTracking)
+        {
+            this->linearPositionProfiled = this->linearPosition;
+        }
+        else
+        {
+            this->linearProfile.SetPoint(this->linearPosition);
+            this->linearPositionProfiled = this->linearProfile.Get(time);
+        }
+
+#if PC_FEED_FORWARD
+        // Profiles derivatives on the override clock
+        this->angularVelocityProfiled = this->angularProfile.GetVelocity(time) * this->override;
+        this->angularAccelerationProfiled = this->angularProfile.GetAcceleration(time) * this->override * this->override;
+
+        if(this->linearTracking)
+        {
+            this->linearVelocityProfiled = this->linearTrackedVelocity;
+            this->linearAccelerationProfiled = this->linearTrackedAcceleration;
+        }
+        else
+        {
+            this->linearVelocityProfiled = this->linearProfile.GetVelocity(time) * this->override;
+            this->linearAccelerationProfiled = this->linearProfile.GetAcceleration(time) * this->override * this->override;
+        }
+#endif
+
+        // Completion on real arrival
+        this->superviseSettle(currentAngularPosition, currentLinearPosition);
+
+        // Open loop step position, profiles only give positioning state
+        if(this->stepMode)
+        {
+            this->computeSteps(currentAngularPosition, currentLinearPosition);
+            return;
+        }
 
         // OpenLoop
         //this->angularPositionError = this->angularPositionProfiled - this->angularPositionLast;
@@ -267,16 +733,33 @@ namespace MotionControl
         //this->linearPositionError = 0.0;
 
         // Compute PID
+#if PC_GAIN_SCHEDULING
+        this->pid_angular.Schedule(fabsf(this->angularVelocityProfiled));
+        this->pid_linear.Schedule(fabsf(this->linearVelocityProfiled));
+#endif
         this->pid_angular.SetSetpoint(this->angularPositionProfiled);
         this->pid_linear.SetSetpoint(this->linearPositionProfiled);
         this->angularPositionError = this->pid_angular.Get(currentAngularPosition);
         this->linearPositionError  = this->pid_linear.Get(currentLinearPosition);
 
+        // Auto-tuning : relay replaces the tuned axis PID output (profile finished, no feed forward)
+        if(this->tuner.GetState() == RelayTuner::RUNNING)
+        {
+            if(!this->isPositioningFinished())
+                this->tuner.Stop();
+            else if(this->tuningAxis == PositionControl::ANGULAR)
+                this->angularPositionError = this->tuner.Update(currentAngularPosition, PC_PERIOD_S);
+            else
+                this->linearPositionError  = this->tuner.Update(currentLinearPosition, PC_PERIOD_S);
+        }
+
+#if PC_LOG_TRACES
         if(!this->isPositioningFinished())
         {
-            //printf("%.7f\t%.7f\t", this->linearPositionProfiled, this->angularPositionProfiled);
-            //printf("%.7f\t%.7f\t", currentLinearPosition, currentAngularPosition);
+            LOG("PC pos %.7f\t%.7f\t%.7f\t%.7f\r\n", this->linearPositionProfiled, this->angularPositionProfiled,
+                                                    currentLinearPosition, currentAngularPosition);
         }
+#endif
 
         this->angularPositionLast = this->angularPositionProfiled;
         this->linearPositionLast  = this->linearPositionProfiled;
@@ -286,39 +769,245 @@ namespace MotionControl
 
     void PositionControl::ToMotors()
     {
-        float32_t LeftPosition  = 0.0;
-        float32_t RightPosition = 0.0;
+        float32_t angularStep = 0.0f;
+        float32_t linearStep  = 0.0f;
+
+        // Wheel stall : latched motor ignores steps until ClearStall()
+        this->leftMotor->Supervise();
+        this->rightMotor->Supervise();
+        this->superviseThermal();
 
-        float32_t LeftVelocity  = 0.0;
-        float32_t RightVelocity = 0.0;
+#if PC_SLIP_DETECTION
+        this->superviseSlip();
+#endif
 
         if(this->enable == true)
         {
             this->status |= (1<<0);
 
-            this->angularVelocity = this->angularPositionError * 1000.0 / PC_TASK_PERIOD_MS;
-            this->linearVelocity  = this->linearPositionError * 1000.0 / PC_TASK_PERIOD_MS;
+            // PID output plus feed forward : profile advance during next period
+            angularStep = this->angularPositionError +
+                          (this->angularVelocityProfiled + 0.5f * this->angularAccelerationProfiled * PC_PERIOD_S) * PC_PERIOD_S;
+            linearStep  = this->linearPositionError +
+                          (this->linearVelocityProfiled + 0.5f * this->linearAccelerationProfiled * PC_PERIOD_S) * PC_PERIOD_S;
 
+            this->angularVelocity = angularStep * PC_VEL_BY_ERROR;
+            this->linearVelocity  = linearStep * PC_VEL_BY_ERROR;
+
+#if PC_LOG_TRACES
             if(!this->isPositioningFinished())
             {
-                //printf("%.7f\t%.7f\t", this->linearVelocity, this->angularVelocity);
-                //printf("\r\n");
+                LOG("PC vel %.7f\t%.7f\r\n", this->linearVelocity, this->angularVelocity);
             }
+#endif
+
+#if PC_VELOCITY_CASCADE
+            // Velocity setpoints of the inner loop (ComputeVelocity())
+            this->angularVelocitySetpoint = this->angularVelocity;
+            this->linearVelocitySetpoint  = this->linearVelocity;
+#else
+            this->driveMotors(angularStep, linearStep, this->angularVelocity, this->linearVelocity);
+#endif
+        }
+        else
+        {
+            this->status &= ~(1<<0);
+            this->leftMotor->SetDirection(Drv8813State::DISABLED);
+            this->rightMotor->SetDirection(Drv8813State::DISABLED);
+        }
+
+    }
+
+    void PositionControl::ComputeVelocity(float32_t period)
+    {
+#if PC_VELOCITY_CASCADE
+        float32_t angularVelocity = 0.0f;
+        float32_t linearVelocity  = 0.0f;
+
+        if((this->enable == false) || this->stepMode)
+            return;
+
+        // Encoders velocity (observer) against position loop output, setpoint kept as feed forward
+        this->pid_angularVelocity.SetSetpoint(this->angularVelocitySetpoint);
+        this->pid_linearVelocity.SetSetpoint(this->linearVelocitySetpoint);
+
+        angularVelocity = this->angularVelocitySetpoint + this->pid_angularVelocity.Get(this->odometry->GetAngularVelocityFiltered());
+        linearVelocity  = this->linearVelocitySetpoint  + this->pid_linearVelocity.Get(this->odometry->GetLinearVelocityFiltered());
+
+#if PC_VELOCITY_STREAM
+        (void)period;
+        this->streamMotors(angularVelocity, linearVelocity);
+#else
+        // Advance during one velocity period
+        period = period / 1000.0f;
+        this->driveMotors(angularVelocity * period, linearVelocity * period, angularVelocity, linearVelocity);
+#endif
+#else
+        (void)period;
+#endif
+    }
+
+    bool PositionControl::SetStepMode(bool stepMode)
+    {
+        // Checked again when applied
+        if(!this->isPositioningFinished() || this->angularTracking)
+            return false;
+
+        return this->postCommand(PC_COMMAND_STEP_MODE, stepMode ? 1u : 0u);
+    }
+
+    bool PositionControl::SelectPreset(uint32_t preset)
+    {
+        if(preset >= PC_PRESETS)
+            return false;
+
+        return this->postCommand(PC_COMMAND_PRESET, static_cast<uint8_t>(preset));
+    }
+
+    void PositionControl::applyPreset(uint32_t preset)
+    {
+        const PC_PRESET* p = &this->presets[preset];
+
+        // Whole set in one period (live parameters point to the definition)
+        this->def.PID_Angular    = p->PID_Angular;
+        this->def.PID_Linear     = p->PID_Linear;
+        this->def.Limits_Angular = p->Limits_Angular;
+        this->def.Limits_Linear  = p->Limits_Linear;
+        this->preset = preset;
+
+        this->applyTuning();
+    }
+
+    void PositionControl::applyStepMode(bool stepMode)
+    {
+        if(!this->isPositioningFinished() || this->angularTracking)
+            return;
+
+        if(stepMode != this->stepMode)
+        {
+            // Current setpoints are reached, nothing to move
+            this->stepAngularTarget = this->angularPosition;
+            this->stepLinearTarget  = this->linearPosition;
+            this->stepCorrections = PC_STEP_CORRECTIONS;
+
+            this->pid_angular.Reset();
+            this->pid_linear.Reset();
+            this->pid_angularVelocity.Reset();
+            this->pid_linearVelocity.Reset();
+
+            this->stepMode = stepMode;
+        }
+    }
+
+    void PositionControl::computeSteps(float32_t currentAngularPosition, float32_t currentLinearPosition)
+    {
+        float32_t angularError = 0.0f;
+        float32_t linearError  = 0.0f;
+
+        this->leftMotor->Supervise();
+        this->rightMotor->Supervise();
+        this->superviseThermal();
+
+#if PC_SLIP_DETECTION
+        this->superviseSlip();
+#endif
+
+        if(this->enable == false)
+        {
+            this->status &= ~(1<<0);
+            this->leftMotor->SetDirection(Drv8813State::DISABLED);
+            this->rightMotor->SetDirection(Drv8813State::DISABLED);
+            return;
+        }
+
+        this->status |= (1<<0);
+
+        // Current move is played by motors
+        if((this->leftMotor->GetRemainingSteps() != 0u) || (this->rightMotor->GetRemainingSteps() != 0u))
+            return;
+
+        // New setpoint : move from measured position (encoder correction of previous moves)
+        if((this->angularPosition != this->stepAngularTarget) || (this->linearPosition != this->stepLinearTarget))
+        {
+            this->stepAngularTarget = this->angularPosition;
+            this->stepLinearTarget  = this->linearPosition;
+            this->stepCorrections = 0u;
+        }
+        else if(this->stepCorrections >= PC_STEP_CORRECTIONS)
+        {
+            return;
+        }
+        else
+        {
+            this->stepCorrections++;
+        }
+
+        angularError = this->stepAngularTarget - currentAngularPosition;
+        linearError  = this->stepLinearTarget  - currentLinearPosition;
+
+        if((this->abs(angularError) > PC_STEP_ANGULAR_DEADBAND) || (this->abs(linearError) > PC_STEP_LINEAR_DEADBAND))
+            this->stepMove(angularError, linearError);
+        else
+            this->stepCorrections = PC_STEP_CORRECTIONS;
+    }
+
+    void PositionControl::stepMove(float32_t angular, float32_t linear)
+    {
+        float32_t rate  = FLT_MAX;
+        float32_t accel = FLT_MAX;
+        float32_t left  = 0.0f;
+        float32_t right = 0.0f;
+        const float32_t scale = this->limitScale;
+
+        // Move normalized from 0 to 1, limited by the slower axis : both wheels end together on the path
+        if(this->abs(angular) > 0.0f)
+        {
+            rate  = this->def.Limits_Angular.velMax * scale / this->abs(angular);
+            accel = this->def.Limits_Angular.accMax * scale / this->abs(angular);
+        }
+        if(this->abs(linear) > 0.0f)
+        {
+            if((this->def.Limits_Linear.velMax * scale / this->abs(linear)) < rate)
+                rate = this->def.Limits_Linear.velMax * scale / this->abs(linear);
+            if((this->def.Limits_Linear.accMax * scale / this->abs(linear)) < accel)
+                accel = this->def.Limits_Linear.accMax * scale / this->abs(linear);
+        }
+
+        // Angular&Linear (radian&meter) to motors steps (left motor is mounted reversed)
+        left  = - (linear - angular * PC_HALF_ADW_M) * PC_ROT_BY_M * static_cast<float32_t>(this->leftMotor->GetStepsPerTurn());
+        right = + (linear + angular * PC_HALF_ADW_M) * PC_ROT_BY_M * static_cast<float32_t>(this->rightMotor->GetStepsPerTurn());
+
+        _moveMotor(this->leftMotor,  left,  rate, accel);
+        _moveMotor(this->rightMotor, right, rate, accel);
+    }
+
+    void PositionControl::driveMotors(float32_t angularStep, float32_t linearStep, float32_t angularVelocity, float32_t linearVelocity)
+    {
+        float32_t LeftPosition  = 0.0f;
+        float32_t RightPosition = 0.0f;
 
+        float32_t LeftVelocity  = 0.0f;
+        float32_t RightVelocity = 0.0f;
+
+        // Motor steps per revolution (micro stepping included)
+        const float32_t leftSteps  = static_cast<float32_t>(this->leftMotor->GetStepsPerTurn());
+        const float32_t rightSteps = static_cast<float32_t>(this->rightMotor->GetStepsPerTurn());
+
+        {
             // Angular&Linear (radian&meter) to Left&Right (meter&meter)
-            LeftPosition  = this->linearPositionError - this->angularPositionError * ADW_MM/1000.0 / 2.0;
-            RightPosition = this->linearPositionError + this->angularPositionError * ADW_MM/1000.0 / 2.0;
+            LeftPosition  = linearStep - angularStep * PC_HALF_ADW_M;
+            RightPosition = linearStep + angularStep * PC_HALF_ADW_M;
 
 
-            LeftVelocity  = this->linearVelocity - this->angularVelocity * ADW_MM/1000.0 / 2.0;
-            RightVelocity = this->linearVelocity + this->angularVelocity * ADW_MM/1000.0 / 2.0;
+            LeftVelocity  = linearVelocity - angularVelocity * PC_HALF_ADW_M;
+            RightVelocity = linearVelocity + angularVelocity * PC_HALF_ADW_M;
 
             // Robot (meter) to Motor (rotation)
-            LeftPosition  = LeftPosition  * 1000.0 / (RATIO * WD_MM * _PI_);
-            RightPosition = RightPosition * 1000.0 / (RATIO * WD_MM * _PI_);
+            LeftPosition  = LeftPosition  * PC_ROT_BY_M;
+            RightPosition = RightPosition * PC_ROT_BY_M;
 
-            LeftVelocity  = LeftVelocity  * 1000.0 / (RATIO * WD_MM * _PI_);
-            RightVelocity = RightVelocity * 1000.0 / (RATIO * WD_MM * _PI_);
+            LeftVelocity  = LeftVelocity  * PC_ROT_BY_M;
+            RightVelocity = RightVelocity * PC_ROT_BY_M;
 
             LeftPosition  = - LeftPosition;
             RightPosition = + RightPosition;
@@ -327,49 +1016,50 @@ namespace MotionControl
             RightVelocity = this->abs(RightVelocity);
 
             // Check maximum
-            if(LeftVelocity > 400)  // RPS
-                LeftVelocity = 400;
-            if(RightVelocity > 400)  // RPS
-                RightVelocity = 400;
+            if(LeftVelocity > 400.0f)  // RPS
+                LeftVelocity = 400.0f;
+            if(RightVelocity > 400.0f)  // RPS
+                RightVelocity = 400.0f;
 
+#if PC_LOG_TRACES
             if(!this->isPositioningFinished())
             {
-                //printf("%.7f\t%.7f\t", -LeftPosition, RightPosition);
-                //printf("%.3f\t%.3f\t", LeftVelocity, RightVelocity);
+                LOG("PC motors %.7f\t%.7f\t%.3f\t%.3f\r\n", -LeftPosition, RightPosition, LeftVelocity, RightVelocity);
             }
+#endif
 
-            if(LeftPosition < 0.0)
+            if(LeftPosition < 0.0f)
             {
                 LeftPosition = -LeftPosition;
                 this->leftMotor->SetDirection(Drv8813State::BACKWARD);
-                this->leftMotor->PulseRotation(LeftPosition*PC_USTEP);
-                this->leftMotor->SetSpeedStep((uint32_t)(LeftVelocity*PC_USTEP));
+                this->leftMotor->PulseRotation(LeftPosition*leftSteps);
+                this->leftMotor->SetSpeedStep((uint32_t)(LeftVelocity*leftSteps));
             }
-            else if (LeftPosition > 0.0)
+            else if (LeftPosition > 0.0f)
             {
                 LeftPosition = +LeftPosition;
                 this->leftMotor->SetDirection(Drv8813State::FORWARD);
-                this->leftMotor->PulseRotation(LeftPosition*PC_USTEP);
-                this->leftMotor->SetSpeedStep((uint32_t)(LeftVelocity*PC_USTEP));
+                this->leftMotor->PulseRotation(LeftPosition*leftSteps);
+                this->leftMotor->SetSpeedStep((uint32_t)(LeftVelocity*leftSteps));
             }
             else
             {
                 this->leftMotor->SetDirection(Drv8813State::DISABLED);
             }
 
-            if(RightPosition < 0.0)
+            if(RightPosition < 0.0f)
             {
                 RightPosition = -RightPosition;
                 this->rightMotor->SetDirection(Drv8813State::BACKWARD);
-                this->rightMotor->PulseRotation(RightPosition*PC_USTEP);
-                this->rightMotor->SetSpeedStep((uint32_t)(RightVelocity*PC_USTEP));
+                this->rightMotor->PulseRotation(RightPosition*rightSteps);
+                this->rightMotor->SetSpeedStep((uint32_t)(RightVelocity*rightSteps));
             }
-            else if (RightPosition > 0.0)
+            else if (RightPosition > 0.0f)
             {
                 RightPosition = +RightPosition;
                 this->rightMotor->SetDirection(Drv8813State::FORWARD);
-                this->rightMotor->PulseRotation(RightPosition*PC_USTEP);
-                this->rightMotor->SetSpeedStep((uint32_t)(RightVelocity*PC_USTEP));
+                this->rightMotor->PulseRotation(RightPosition*rightSteps);
+                this->rightMotor->SetSpeedStep((uint32_t)(RightVelocity*rightSteps));
             }
             else
             {
@@ -379,64 +1069,445 @@ namespace MotionControl
             /*if(this->leftMotor->IsMoving() || this->rightMotor->IsMoving())
                 printf("%d\t%d\r\n", this->leftMotor->IsMoving(), this->rightMotor->IsMoving());*/
         }
+    }
+
+
+    void PositionControl::streamMotors(float32_t angularVelocity, float32_t linearVelocity)
+    {
+        // Angular&Linear (radian&meter) to motors rotation (left motor is mounted reversed)
+        float32_t left  = - (linearVelocity - angularVelocity * PC_HALF_ADW_M) * PC_ROT_BY_M;
+        float32_t right = + (linearVelocity + angularVelocity * PC_HALF_ADW_M) * PC_ROT_BY_M;
+
+        // Check maximum (RPS)
+        if(left > 400.0f)
+            left = 400.0f;
+        else if(left < -400.0f)
+            left = -400.0f;
+        if(right > 400.0f)
+            right = 400.0f;
+        else if(right < -400.0f)
+            right = -400.0f;
+
+        this->leftMotor->SetVelocityRPS(left);
+        this->rightMotor->SetVelocityRPS(right);
+    }
+
+    void PositionControl::superviseSlip()
+    {
+        int32_t leftSteps  = this->leftMotor->ReadSteps();
+        int32_t rightSteps = this->rightMotor->ReadSteps();
+
+        float32_t linear  = this->odometry->GetLinearPosition();
+        float32_t angular = this->odometry->GetAngularPosition();
+
+        float32_t dLinear  = linear  - this->slipLinear;
+        float32_t dAngular = angular - this->slipAngular;
+
+        float32_t commandedLeft  = 0.0f;
+        float32_t commandedRight = 0.0f;
+        float32_t measuredLeft   = 0.0f;
+        float32_t measuredRight  = 0.0f;
+
+        bool slip = false;
+
+        // Steps delivered during last period (left motor is mounted reversed)
+        commandedLeft  = - static_cast<float32_t>(leftSteps  - this->slipLeftSteps)  /
+                           static_cast<float32_t>(this->leftMotor->GetStepsPerTurn()) * PC_M_BY_ROT;
+        commandedRight = + static_cast<float32_t>(rightSteps - this->slipRightSteps) /
+                           static_cast<float32_t>(this->rightMotor->GetStepsPerTurn()) * PC_M_BY_ROT;
+
+        // Heading wraps by one turn
+        if(dAngular > FASTMATH_PI)
+            dAngular -= FASTMATH_2_PI;
+        else if(dAngular < -FASTMATH_PI)
+            dAngular += FASTMATH_2_PI;
+
+        // Encoder wheels travel brought back to motor wheels
+        measuredLeft  = dLinear - dAngular * PC_HALF_ADW_M;
+        measuredRight = dLinear + dAngular * PC_HALF_ADW_M;
+
+        this->slipLeftSteps  = leftSteps;
+        this->slipRightSteps = rightSteps;
+        this->slipLinear     = linear;
+        this->slipAngular    = angular;
+
+        this->leftSlip  = this->leftSlip  * PC_SLIP_DECAY + (commandedLeft  - measuredLeft);
+        this->rightSlip = this->rightSlip * PC_SLIP_DECAY + (commandedRight - measuredRight);
+
+        slip = (this->abs(this->leftSlip) > PC_SLIP_THRESHOLD_M) ||
+               (this->abs(this->rightSlip) > PC_SLIP_THRESHOLD_M);
+
+        if(slip)
+        {
+            this->status |= (1<<1);
+
+            if(!this->slipping)
+            {
+                this->slipping = true;
+                this->SlipDetected();
+            }
+        }
         else
         {
-            this->status &= ~(1<<0);
-            this->leftMotor->SetDirection(Drv8813State::DISABLED);
-            this->rightMotor->SetDirection(Drv8813State::DISABLED);
+            this->status &= ~(1<<1);
+            this->slipping = false;
         }
-
     }
 
-
     void PositionControl::taskHandler(void* obj)
     {
-        TickType_t xLastWakeTime;
-        TickType_t xFrequency = pdMS_TO_TICKS(PC_TASK_PERIOD_MS);
-
         PositionControl* instance = _positionControl;
-        TickType_t prevTick = 0u,  tick = 0u;
 
         float32_t period = 0.0f;
 
         // 1. Initialise periodical task
-        xLastWakeTime = xTaskGetTickCount();
-
-        // 2. Get tick count
-        prevTick = xTaskGetTickCount();
+        instance->periodic.Start();
 
         while(1)
         {
-            // 2. Wait until period elapse
-            vTaskDelayUntil(&xLastWakeTime, xFrequency);
-
-            // 3. Get tick
-            tick = xTaskGetTickCount();
-
-            period = static_cast<float32_t>(tick) -
-                     static_cast<float32_t>(prevTick);
+            // 2. Wait until period elapse, get elapsed ticks
+            period = instance->periodic.Wait();
 
             //4. Compute velocity (VelocityControl)
+            instance->profiler.Start();
             instance->Compute(period);
+            instance->ComputeVelocity(period);
+            instance->profiler.Stop();
+        }
+    }
+
+    void PositionControl::synchronize()
+    {
+        float32_t duration = 0.0f;
+
+        if(!this->synchronized || this->angularTracking || this->linearTracking)
+            return;
+
+        // Only profiles started together, a running one is never stretched
+        if(abs(this->linearProfile.GetStartTime() - this->angularProfile.GetStartTime()) > PC_SYNC_WINDOW_S)
+            return;
+
+        duration = this->linearProfile.GetDuration();
+        if(this->angularProfile.GetDuration() > duration)
+            duration = this->angularProfile.GetDuration();
+
+        this->linearProfile.SetDuration(duration);
+        this->angularProfile.SetDuration(duration);
+    }
+
+    void PositionControl::applyAngularPosition(float32_t position)
+    {
+        float32_t currentAngularPosition  = 0.0f;
+        float32_t time = 0.0f;
+
+        // Get current and time
+        currentAngularPosition = odometry->GetAngularPosition();
+        time = getTime();
+
+        // Leave path tracking
+        this->setAngularTracking(false);
+
+        // Set angular position order
+        this->angularPosition = position;
+
+        if(!this->angularProfile.isFinished())
+        {
+            // Replan from current profiled state, without stopping
+            this->angularProfile.Replan(this->angularPosition, time);
+        }
+        else
+        {
+            // Start profile from rest (PID are kept, see PC_SETPOINT resetPid)
+            this->angularProfile.SetSetPoint(this->angularPosition, currentAngularPosition, time);
+        }
+    }
+
+
+    void PositionControl::applyLinearPosition(float32_t position)
+    {
+        float32_t currentLinearPosition  = 0.0f;
+        float32_t time = 0.0f;
+
+        // Get current and time
+        currentLinearPosition = odometry->GetLinearPosition();
+        time = getTime();
+
+        // Set linear position order
+        this->linearPosition = position;
+
+        if(this->linearTracking)
+        {
+            // Leave tracking : profile from tracked position (PID are kept)
+            this->linearTracking = false;
+            this->linearProfile.SetSetPoint(this->linearPosition, this->linearPositionProfiled, time);
+        }
+        else if(!this->linearProfile.isFinished())
+        {
+            // Replan from current profiled state, without stopping
+            this->linearProfile.Replan(this->linearPosition, time);
+        }
+        else
+        {
+            // Start profile from rest (PID are kept, see PC_SETPOINT resetPid)
+            this->linearProfile.SetSetPoint(this->linearPosition, currentLinearPosition, time);
+        }
+    }
+
+
+    void PositionControl::Post(const PC_SETPOINT& setpoint)
+    {
+        PC_SETPOINT* back = &this->setpoints[this->published ^ 1u];
+        const PC_SETPOINT* front = &this->setpoints[this->published];
+
+        // Back buffer is never read by the position loop : filled without lock
+        *back = setpoint;
+
+        taskENTER_CRITICAL();
+
+        // Previous setpoint not taken yet : merge axes not overwritten
+        if(this->pending)
+        {
+            if(((back->axes & PC_SETPOINT_ANGULAR) == 0u) && ((front->axes & PC_SETPOINT_ANGULAR) != 0u))
+                back->angular = front->angular;
+            if(((back->axes & PC_SETPOINT_LINEAR) == 0u) && ((front->axes & PC_SETPOINT_LINEAR) != 0u))
+                back->linear = front->linear;
+
+            back->axes |= front->axes;
+            back->resetPid = back->resetPid || front->resetPid;
+        }
+
+        this->published ^= 1u;
+        this->pending = true;
+
+        taskEXIT_CRITICAL();
+    }
+
+    void PositionControl::swap()
+    {
+        PC_SETPOINT setpoint;
+        bool pending = false;
+
+        taskENTER_CRITICAL();
+        if((pending = this->pending))
+        {
+            setpoint = this->setpoints[this->published];
+            this->pending = false;
+        }
+        taskEXIT_CRITICAL();
+
+        if(!pending)
+            return;
+
+        if(setpoint.resetPid)
+        {
+            this->pid_angular.Reset();
+            this->pid_linear.Reset();
+        }
+
+        if((setpoint.axes & PC_SETPOINT_ANGULAR) != 0u)
+            this->applyAngularPosition(setpoint.angular);
+
+        if((setpoint.axes & PC_SETPOINT_LINEAR) != 0u)
+            this->applyLinearPosition(setpoint.linear);
+
+        // New setpoint settles again, even on a null move
+        this->settled = false;
+        this->settleCount = 0u;
+        this->settleStart = this->clockLast;
+
+        this->synchronize();
+    }
+
+    void PositionControl::superviseSettle(float32_t angular, float32_t linear)
+    {
+        bool inside;
+
+        // Running profiles : timeout counts from their end
+        if(!this->isPositioningFinished())
+        {
+            this->settled = false;
+            this->settleCount = 0u;
+            this->settleStart = this->clockLast;
+            return;
+        }
+
+        if(this->settled)
+            return;
+
+        inside = !this->enable ||
+                 ((this->abs(this->linearPosition - linear) <= this->settle.linear) &&
+                  (this->abs(this->angularPosition - angular) <= this->settle.angular) &&
+                  (this->abs(this->odometry->GetLinearVelocity()) <= this->settle.linearVel) &&
+                  (this->abs(this->odometry->GetAngularVelocity()) <= this->settle.angularVel));
+
+        this->settleCount = inside ? (this->settleCount + 1u) : 0u;
+
+        if(!this->enable || (this->settleCount >= this->settle.samples))
+            this->settleTimedOut = false;
+        else if((this->clockLast - this->settleStart) > this->settle.timeout)
+            this->settleTimedOut = true;
+        else
+            return;
+
+        this->settled = true;
+        this->PositioningSettled();
+    }
+
+    bool PositionControl::postCommand(PC_COMMAND_ID id, uint8_t arg)
+    {
+        PC_COMMAND command = {static_cast<uint8_t>(id), arg};
+
+        if(xQueueSend(this->commands, &command, 0) != pdPASS)
+        {
+            this->commandsLost++;
+            return false;
+        }
+
+        return true;
+    }
+
+    void PositionControl::receive()
+    {
+        PC_COMMAND command;
+
+        while(xQueueReceive(this->commands, &command, 0) == pdPASS)
+        {
+            switch(command.id)
+            {
+                case PC_COMMAND_ENABLE:
+                    this->applyEnable(true);
+                    break;
+
+                case PC_COMMAND_DISABLE:
+                    this->applyEnable(false);
+                    break;
+
+                case PC_COMMAND_TUNE_START:
+                    this->applyStartTuning(static_cast<enum PositionControl::ID>(command.arg));
+                    break;
+
+                case PC_COMMAND_TUNE_STOP:
+                    this->tuner.Stop();
+                    break;
+
+                case PC_COMMAND_STEP_MODE:
+                    this->applyStepMode(command.arg != 0u);
+                    break;
 
-            // 5. Set previous tick
-            prevTick = tick;
+                case PC_COMMAND_SYNCHRONIZED:
+                    this->synchronized = (command.arg != 0u);
+                    break;
+
+                case PC_COMMAND_PRESET:
+                    this->applyPreset(command.arg);
+                    break;
+
+                default:
+                    break;
+            }
+        }
+    }
+
+    void PositionControl::applyEnable(bool enable)
+    {
+        if(enable == this->enable)
+            return;
+
+        if(enable)
+        {
+            this->pid_angular.Reset();
+            this->pid_linear.Reset();
+            this->pid_angularVelocity.Reset();
+            this->pid_linearVelocity.Reset();
+        }
+        else
+        {
+            this->tuner.Stop();
+        }
+
+        this->enable = enable;
+    }
+
+    void PositionControl::Brake()
+    {
+        float32_t time = getTime();
+        float32_t k = this->override;
+        float32_t v = 0.0f;
+
+        taskENTER_CRITICAL();
+        this->pending = false;
+        taskEXIT_CRITICAL();
+
+        // Tracked axes have no running profile : brake from commanded state (profile time)
+        if(this->angularTracking)
+        {
+            v = (k > 0.0f) ? this->angularVelocity / k : 0.0f;
+            this->setAngularTracking(false);
+            this->angularProfile.Brake(this->angularPosition, v, time);
+        }
+        else
+        {
+            this->angularProfile.Brake(time);
+        }
+
+        if(this->linearTracking)
+        {
+            v = (k > 0.0f) ? this->linearTrackedVelocity / k : 0.0f;
+            this->linearTracking = false;
+            this->linearProfile.Brake(this->linearPositionProfiled, v, time);
+        }
+        else
+        {
+            this->linearProfile.Brake(time);
+        }
+
+        // Setpoints on stop points, axes stop independently
+        this->angularPosition = this->angularProfile.GetTarget();
+        this->linearPosition = this->linearProfile.GetTarget();
+    }
+
+    void PositionControl::setAngularTracking(bool tracking)
+    {
+        if(tracking != this->angularTracking)
+        {
+            this->angularTracking = tracking;
+            this->angularProfile.SetProfile(tracking ? MotionProfile::PROFILE::NONE : ANGULAR_PROFILE);
         }
     }
 
     float32_t PositionControl::getTime()
     {
-        float32_t time = 0.0;
+        return this->profileTime;
+    }
+
+    void PositionControl::updateTime()
+    {
+        float32_t now = Utils::Clock::GetSeconds();
+        float32_t dt = now - this->clockLast;
+        float32_t target = this->overrideTarget;
 
-        time = static_cast<float32_t>(xTaskGetTickCount());
-        time /= 1000.0;
+        this->clockLast = now;
+
+        // Slew override : no velocity step on profiles
+        if(this->override < target)
+        {
+            this->override += PC_OVERRIDE_RATE * dt;
+            if(this->override > target)
+                this->override = target;
+        }
+        else if(this->override > target)
+        {
+            this->override -= PC_OVERRIDE_RATE * dt;
+            if(this->override < target)
+                this->override = target;
+        }
 
-        return  time;
+        this->profileTime += dt * this->override;
     }
 
     float32_t PositionControl::abs(float32_t val)
     {
-        if(val < 0.0)
+        if(val < 0.0f)
             val = -val;
         return val;
     }
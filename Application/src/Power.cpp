@@ -0,0 +1,161 @@
+/**
+ * @file    Power.cpp
+ * @author  Jeremy ROULLAND
+ * @date    15 oct. 2026
+ * @brief   Low power idle (sleep on idle, tickless while motion is idle)
+ */
+
+#include "Power.hpp"
+#include "DRV8813.hpp"
+#include "Utils.hpp"
+
+#include "stm32f4xx.h"
+
+/*----------------------------------------------------------------------------*/
+/* Private Members                                                            */
+/*----------------------------------------------------------------------------*/
+
+/**
+ * @brief Sleep allowed
+ */
+static volatile bool _enabled = true;
+
+/**
+ * @brief Statistics
+ */
+static volatile uint64_t _sleepCycles = 0u;
+static volatile uint32_t _sleepCount = 0u;
+static volatile uint32_t _ticklessCount = 0u;
+static volatile uint32_t _ticklessVetoed = 0u;
+
+/**
+ * @brief Cycle counter when tickless sleep started
+ */
+static uint32_t _ticklessStart = 0u;
+
+/*----------------------------------------------------------------------------*/
+/* Class Implementation                                                       */
+/*----------------------------------------------------------------------------*/
+
+void Power::Init ()
+{
+    // HCLK keeps running in sleep mode : cycle counter (Clock, Profiler, run time stats) stays valid
+    DBGMCU->CR |= DBGMCU_CR_DBG_SLEEP;
+
+    // CRC unit is only used by the core : no clock while asleep
+    RCC->AHB1LPENR &= ~RCC_AHB1LPENR_CRCLPEN;
+
+    // Sleep mode (not deep sleep), back to thread mode on wakeup
+    SCB->SCR &= ~(SCB_SCR_SLEEPDEEP_Msk | SCB_SCR_SLEEPONEXIT_Msk);
+}
+
+void Power::Idle ()
+{
+    uint32_t start;
+
+    if(!_enabled)
+        return;
+
+    start = DWT->CYCCNT;
+
+    __DSB();
+    __WFI();
+    __ISB();
+
+    // Wakeup interrupt already ran : time includes it (idle task is the only sleeper)
+    Power::account(DWT->CYCCNT - start);
+}
+
+void Power::SetEnable (bool enable)
+{
+    _enabled = enable;
+}
+
+bool Power::IsEnabled ()
+{
+    return _enabled;
+}
+
+uint32_t Power::PreSleep (uint32_t ticks)
+{
+    // Moves are timed by the tick (profiles, timeouts) : no tick drift while a driver is moving,
+    // steps wake the core every few hundred microseconds anyway
+    if(!_enabled || HAL::Drv8813::IsAnyMoving())
+    {
+        _ticklessVetoed = _ticklessVetoed + 1u;
+        return 0u;
+    }
+
+    _ticklessCount = _ticklessCount + 1u;
+    _ticklessStart = DWT->CYCCNT;
+
+    return ticks;
+}
+
+void Power::PostSleep ()
+{
+    if(_ticklessStart != 0u)
+    {
+        Power::account(DWT->CYCCNT - _ticklessStart);
+        _ticklessStart = 0u;
+    }
+}
+
+uint64_t Power::GetSleepTime ()
+{
+    uint64_t cycles;
+    uint32_t primask;
+
+    primask = __get_PRIMASK();
+    __disable_irq();
+    cycles = _sleepCycles;
+    __set_PRIMASK(primask);
+
+    return cycles / static_cast<uint64_t>(SystemCoreClock / 1000000u);
+}
+
+uint32_t Power::GetSleepCount ()
+{
+    return _sleepCount;
+}
+
+uint32_t Power::GetTicklessCount ()
+{
+    return _ticklessCount;
+}
+
+uint32_t Power::GetTicklessVetoed ()
+{
+    return _ticklessVetoed;
+}
+
+void Power::account (uint32_t cycles)
+{
+    uint32_t primask;
+
+    primask = __get_PRIMASK();
+    __disable_irq();
+
+    _sleepCycles = _sleepCycles + cycles;
+    _sleepCount = _sleepCount + 1u;
+
+    __set_PRIMASK(primask);
+}
+
+/*----------------------------------------------------------------------------*/
+/* FreeRTOS tickless hooks                                                    */
+/*----------------------------------------------------------------------------*/
+
+extern "C"
+{
+    void vPowerPreSleep (uint32_t* ticks)
+    {
+        *ticks = Power::PreSleep(*ticks);
+    }
+
+    void vPowerPostSleep (uint32_t ticks)
+    {
+        (void)ticks;
+        Power::PostSleep();
+    }
+}
@@ -0,0 +1,171 @@
+/**
+ * @file    Retain.cpp
+ * @author  Jeremy ROULLAND
+ * @date    15 oct. 2026
+ * @brief   Warm restart state (pose, orders, actuators) kept in no-init RAM
+ */
+
+#include "Retain.hpp"
+#include "stm32f4xx.h"
+
+// FreeRTOS
+#include "FreeRTOS.h"
+#include "task.h"
+
+#include <stddef.h>
+#include <string.h>
+
+/*----------------------------------------------------------------------------*/
+/* Definitions                                                                */
+/*----------------------------------------------------------------------------*/
+
+#define RETAIN_MAGIC            (0x5E7A1A3Du)
+
+/**
+ * @brief Checkpoint slot
+ */
+typedef struct
+{
+    uint32_t        magic;
+    uint32_t        seq;
+    RETAIN_STATE    state;
+    uint32_t        check;
+}RETAIN_SLOT;
+
+/*----------------------------------------------------------------------------*/
+/* Private Members                                                            */
+/*----------------------------------------------------------------------------*/
+
+/**
+ * @brief Checkpoint slots (not cleared by the startup code)
+ */
+static RETAIN_SLOT _slots[2] __attribute__((section(".noinit")));
+
+/**
+ * @brief State written by owners, previous run state
+ */
+static RETAIN_STATE _state;
+static RETAIN_STATE _restored;
+static bool _restoredValid = false;
+
+/**
+ * @brief Next sequence number, checkpoints sealed since boot
+ */
+static uint32_t _seq = 0u;
+static uint32_t _commits = 0u;
+
+/*----------------------------------------------------------------------------*/
+/* Private Functions                                                          */
+/*----------------------------------------------------------------------------*/
+
+/**
+ * @brief Slot checksum (words sum, magic and check excluded)
+ */
+static uint32_t _checksum (const RETAIN_SLOT* s)
+{
+    const uint32_t* w = reinterpret_cast<const uint32_t*>(s);
+    uint32_t sum = 0xA5A5A5A5u;
+
+    for(uint32_t i = (offsetof(RETAIN_SLOT, seq) / sizeof(uint32_t)); i < (offsetof(RETAIN_SLOT, check) / sizeof(uint32_t)); i++)
+        sum = (sum << 1u | sum >> 31u) + w[i];
+
+    return sum;
+}
+
+/**
+ * @brief Return true if slot is sealed
+ */
+static bool _valid (const RETAIN_SLOT* s)
+{
+    return (s->magic == RETAIN_MAGIC) && (s->check == _checksum(s));
+}
+
+/*----------------------------------------------------------------------------*/
+/* Class Implementation                                                       */
+/*----------------------------------------------------------------------------*/
+
+void Retain::Init ()
+{
+    const RETAIN_SLOT* last = NULL;
+    bool powerOn;
+
+    // Power on or brown out : RAM content is random (flags cleared by Utils::Watchdog)
+    powerOn = (RCC_GetFlagStatus(RCC_FLAG_PORRST) == SET) || (RCC_GetFlagStatus(RCC_FLAG_BORRST) == SET);
+
+    if(!powerOn)
+    {
+        for(uint32_t i = 0u; i < 2u; i++)
+        {
+            if(_valid(&_slots[i]) && ((last == NULL) || (static_cast<int32_t>(_slots[i].seq - last->seq) > 0)))
+                last = &_slots[i];
+        }
+    }
+
+    memset(&_state, 0, sizeof(_state));
+
+    if(last != NULL)
+    {
+        _restored = last->state;
+        _restoredValid = true;
+        _seq = last->seq + 1u;
+
+        // Owners not constructed yet keep their restored part
+        _state = _restored;
+    }
+
+    _commits = 0u;
+}
+
+const RETAIN_STATE* Retain::GetRestored ()
+{
+    return _restoredValid ? &_restored : NULL;
+}
+
+void Retain::SetPose (float32_t x, float32_t y, float32_t o)
+{
+    _state.x = x;
+    _state.y = y;
+    _state.o = o;
+}
+
+void Retain::SetOrders (uint16_t runningTag, uint16_t finishedTag)
+{
+    _state.runningTag = runningTag;
+    _state.finishedTag = finishedTag;
+}
+
+void Retain::SetCylinder (uint32_t id, int32_t steps, int8_t index, bool homed)
+{
+    if(id >= RETAIN_CYLINDERS_MAX)
+        return;
+
+    _state.cylinderSteps[id] = steps;
+    _state.cylinderIndex[id] = index;
+    _state.cylinderHomed[id] = homed;
+}
+
+void Retain::Commit ()
+{
+    RETAIN_SLOT* slot = &_slots[_seq & 1u];
+
+    // Invalid while written, sealed last
+    slot->magic = 0u;
+    __DMB();
+
+    taskENTER_CRITICAL();
+    slot->state = _state;
+    taskEXIT_CRITICAL();
+
+    slot->seq = _seq;
+    slot->check = _checksum(slot);
+    __DMB();
+    slot->magic = RETAIN_MAGIC;
+
+    _seq++;
+    _commits++;
+}
+
+uint32_t Retain::GetCommits ()
+{
+    return _commits;
+}
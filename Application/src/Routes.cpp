@@ -0,0 +1,94 @@
+/**
+ * @file    Routes.cpp
+ * @author  Jeremy ROULLAND
+ * @date    24 oct. 2017
+ * @brief   Precomputed routes library
+ */
+
+#include "Routes.hpp"
+
+#include <stddef.h>
+
+/*----------------------------------------------------------------------------*/
+/* Private Members                                                            */
+/*----------------------------------------------------------------------------*/
+
+/**
+ * @brief Demo route : (250, 250) 0 deg, (800, 400) 45 deg, (1100, 900) 90 deg
+ *
+ * Sampled every 25 mm, 0.2 m/s, 0.2 m/s^2, 1.0 m/s^2 lateral, 3.28 rad/s
+ */
+static const ROUTE_SAMPLE _demo[] =
+{
+    {0.0000f, 0.2500f, 0.2500f, 0.0000f, 0.0000f},
+    {0.0247f, 0.2747f, 0.2501f, 0.0082f, 0.0993f},
+    {0.0493f, 0.2993f, 0.2504f, 0.0178f, 0.1404f},
+    {0.0740f, 0.3239f, 0.2510f, 0.0289f, 0.1720f},
+    {0.0986f, 0.3486f, 0.2518f, 0.0416f, 0.1986f},
+    {0.1233f, 0.3732f, 0.2530f, 0.0559f, 0.2000f},
+    {0.1479f, 0.3978f, 0.2546f, 0.0719f, 0.2000f},
+    {0.1726f, 0.4224f, 0.2566f, 0.0896f, 0.2000f},
+    {0.1972f, 0.4469f, 0.2590f, 0.1092f, 0.2000f},
+    {0.2219f, 0.4714f, 0.2619f, 0.1308f, 0.2000f},
+    {0.2465f, 0.4958f, 0.2654f, 0.1545f, 0.2000f},
+    {0.2712f, 0.5201f, 0.2695f, 0.1804f, 0.2000f},
+    {0.2958f, 0.5443f, 0.2743f, 0.2089f, 0.2000f},
+    {0.3205f, 0.5683f, 0.2797f, 0.2400f, 0.2000f},
+    {0.3451f, 0.5922f, 0.2860f, 0.2740f, 0.2000f},
+    {0.3698f, 0.6158f, 0.2931f, 0.3112f, 0.2000f},
+    {0.3944f, 0.6391f, 0.3011f, 0.3518f, 0.2000f},
+    {0.4191f, 0.6620f, 0.3101f, 0.3959f, 0.2000f},
+    {0.4437f, 0.6845f, 0.3201f, 0.4437f, 0.2000f},
+    {0.4684f, 0.7065f, 0.3312f, 0.4954f, 0.2000f},
+    {0.4930f, 0.7279f, 0.3435f, 0.5508f, 0.2000f},
+    {0.5177f, 0.7485f, 0.3570f, 0.6099f, 0.2000f},
+    {0.5423f, 0.7683f, 0.3717f, 0.6722f, 0.2000f},
+    {0.5670f, 0.7871f, 0.3877f, 0.7360f, 0.2000f},
+    {0.5916f, 0.8048f, 0.4048f, 0.7777f, 0.2000f},
+    {0.6163f, 0.8222f, 0.4223f, 0.7898f, 0.2000f},
+    {0.6409f, 0.8395f, 0.4398f, 0.7953f, 0.2000f},
+    {0.6656f, 0.8567f, 0.4575f, 0.8027f, 0.2000f},
+    {0.6902f, 0.8738f, 0.4753f, 0.8122f, 0.2000f},
+    {0.7149f, 0.8906f, 0.4933f, 0.8235f, 0.2000f},
+    {0.7395f, 0.9073f, 0.5114f, 0.8368f, 0.2000f},
+    {0.7642f, 0.9237f, 0.5299f, 0.8521f, 0.2000f},
+    {0.7888f, 0.9397f, 0.5486f, 0.8695f, 0.2000f},
+    {0.8135f, 0.9555f, 0.5675f, 0.8891f, 0.2000f},
+    {0.8381f, 0.9708f, 0.5868f, 0.9110f, 0.2000f},
+    {0.8628f, 0.9857f, 0.6065f, 0.9355f, 0.2000f},
+    {0.8874f, 1.0001f, 0.6265f, 0.9627f, 0.2000f},
+    {0.9121f, 1.0138f, 0.6469f, 0.9929f, 0.2000f},
+    {0.9367f, 1.0270f, 0.6678f, 1.0263f, 0.2000f},
+    {0.9614f, 1.0394f, 0.6891f, 1.0632f, 0.2000f},
+    {0.9860f, 1.0509f, 0.7109f, 1.1038f, 0.2000f},
+    {1.0107f, 1.0616f, 0.7331f, 1.1484f, 0.2000f},
+    {1.0353f, 1.0711f, 0.7558f, 1.1971f, 0.2000f},
+    {1.0600f, 1.0796f, 0.7790f, 1.2501f, 0.2000f},
+    {1.0846f, 1.0867f, 0.8026f, 1.3073f, 0.1986f},
+    {1.1093f, 1.0924f, 0.8266f, 1.3685f, 0.1720f},
+    {1.1339f, 1.0966f, 0.8509f, 1.4334f, 0.1404f},
+    {1.1586f, 1.0991f, 0.8754f, 1.5011f, 0.0993f},
+    {1.1832f, 1.1000f, 0.9000f, 1.5708f, 0.0000f},
+};
+
+/**
+ * @brief Routes table (identifier is the index)
+ */
+static const ROUTE_DEF _routes[] =
+{
+    {"demo",    _demo,  sizeof(_demo) / sizeof(_demo[0])},
+};
+
+/*----------------------------------------------------------------------------*/
+/* Class Implementation                                                       */
+/*----------------------------------------------------------------------------*/
+
+uint32_t Routes::Count ()
+{
+    return sizeof(_routes) / sizeof(_routes[0]);
+}
+
+const ROUTE_DEF* Routes::Get (uint32_t id)
+{
+    return (id < Routes::Count()) ? &_routes[id] : NULL;
+}
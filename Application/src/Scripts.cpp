@@ -0,0 +1,311 @@
+/**
+ * @file    Scripts.cpp
+ * @author  Jeremy ROULLAND
+ * @date    15 oct. 2026
+ * @brief   Stored orders scripts and timing runner (motion regression)
+ */
+
+#include "Scripts.hpp"
+#include "Routes.hpp"
+#include "TaskTable.hpp"
+#include "StaticStorage.hpp"
+#include "Clock.hpp"
+#include "FastMath.hpp"
+#include "Format.hpp"
+#include "Units.hpp"
+
+#include <stddef.h>
+
+using namespace MotionControl;
+using namespace Location;
+
+/*----------------------------------------------------------------------------*/
+/* Definitions                                                                */
+/*----------------------------------------------------------------------------*/
+
+#define SCRIPT_POLL_MS              (TASK_SCRIPT_PERIOD_MS)
+#define SCRIPT_STEP_TIMEOUT_MS      (20000u)    // Step without end : script aborted
+#define SCRIPT_TAG_FIRST            (0xF000u)   // Orders tags (main board uses lower ones)
+
+#define SCRIPT_RAD_BY_DECIDEG       (FASTMATH_PI / 1800.0f)
+
+/*----------------------------------------------------------------------------*/
+/* Private Members                                                            */
+/*----------------------------------------------------------------------------*/
+
+static Scripts* _scripts = NULL;
+static Utils::StaticStorage<Scripts> _scriptsStorage;
+
+/**
+ * @brief Square : 550 mm sides from (250, 250), back to start heading
+ */
+static const SCRIPT_STEP _square[] =
+{
+    {SCRIPT_SETODO,     250,    250,    0},
+    {SCRIPT_GOTO,       800,    250,    0},
+    {SCRIPT_GOANG,      900,    0,      0},
+    {SCRIPT_GOLIN,      550,    0,      0},
+    {SCRIPT_GOTO,       250,    800,    0},
+    {SCRIPT_GOTO,       250,    250,    0},
+    {SCRIPT_GOANG,      0,      0,      0},
+};
+
+/**
+ * @brief Demo route from its start, then back in line
+ */
+static const SCRIPT_STEP _demo[] =
+{
+    {SCRIPT_SETODO,     250,    250,    0},
+    {SCRIPT_ROUTE,      0,      0,      0},
+    {SCRIPT_GOTO,       250,    250,    0},
+    {SCRIPT_GOANG,      0,      0,      0},
+};
+
+/**
+ * @brief Scripts table (identifier is the index)
+ */
+static const SCRIPT_DEF _table[] =
+{
+    {"square",  _square,    sizeof(_square) / sizeof(_square[0])},
+    {"demo",    _demo,      sizeof(_demo) / sizeof(_demo[0])},
+};
+
+/**
+ * @brief Step operation names (SCRIPT_OP order)
+ */
+static const char* const _opNames[] = {"setodo", "goto", "golin", "goang", "route", "act", "wait"};
+
+/*----------------------------------------------------------------------------*/
+/* Class Implementation                                                       */
+/*----------------------------------------------------------------------------*/
+
+Scripts* Scripts::GetInstance ()
+{
+    if(_scripts != NULL)
+    {
+        return _scripts;
+    }
+    else
+    {
+        _scripts = new (_scriptsStorage.Get()) Scripts();
+        return _scripts;
+    }
+}
+
+uint32_t Scripts::Count ()
+{
+    return sizeof(_table) / sizeof(_table[0]);
+}
+
+const SCRIPT_DEF* Scripts::Get (uint32_t id)
+{
+    return (id < Scripts::Count()) ? &_table[id] : NULL;
+}
+
+Scripts::Scripts ()
+{
+    this->name = "Scripts";
+
+    this->script = NULL;
+    this->running = false;
+    this->abort = false;
+    this->tag = SCRIPT_TAG_FIRST;
+
+    this->x = 0.0f;
+    this->y = 0.0f;
+    this->o = 0.0f;
+
+    this->mc = FBMotionControl::GetInstance();
+    this->tp = TrajectoryPlanning::GetInstance(false);
+    this->pc = PositionControl::GetInstance(false);
+    this->ac = ActuatorControl::GetInstance();
+    this->odometry = Odometry::GetInstance(false);
+
+    // Create task
+    this->taskHandle = TaskTable::Create(TaskTable::SCRIPT, (TaskFunction_t)(&Scripts::taskHandler), this->name);
+}
+
+bool Scripts::Start (uint32_t id)
+{
+    const SCRIPT_DEF* def = Scripts::Get(id);
+
+    if((def == NULL) || this->running)
+        return false;
+
+    this->script = def;
+    this->abort = false;
+    this->running = true;
+
+    xTaskNotifyGive(this->taskHandle);
+
+    return true;
+}
+
+bool Scripts::waitOrder ()
+{
+    uint32_t aborted = this->mc->GetAbortedOrders();
+    TickType_t start = xTaskGetTickCount();
+
+    while(this->mc->GetFinishedOrder() != this->tag)
+    {
+        // Preempted, stopped or too long
+        if(this->abort || (this->mc->GetAbortedOrders() != aborted) ||
+           ((xTaskGetTickCount() - start) >= pdMS_TO_TICKS(SCRIPT_STEP_TIMEOUT_MS)))
+            return false;
+
+        // Woken when an order ends, abort request checked every poll period
+        this->mc->WaitEvents(MC_EVENT_ORDER_DONE | MC_EVENT_ORDER_ABORTED, pdMS_TO_TICKS(SCRIPT_POLL_MS));
+    }
+
+    return true;
+}
+
+bool Scripts::step (const SCRIPT_STEP* step)
+{
+    const ROUTE_DEF* route = NULL;
+    AC_STEP act;
+    uint32_t elapsed = 0u;
+    bool pushed = false;
+
+    // Tags stay above the main board ones
+    this->tag = (this->tag == 0xFFFFu) ? SCRIPT_TAG_FIRST : (this->tag + 1u);
+
+    switch(step->OP)
+    {
+    case SCRIPT_SETODO:
+        this->x = static_cast<float32_t>(step->A);
+        this->y = static_cast<float32_t>(step->B);
+        this->o = static_cast<float32_t>(step->C) * SCRIPT_RAD_BY_DECIDEG;
+        this->odometry->SetXYO(this->x / 1000.0f, this->y / 1000.0f, this->o);
+        return true;
+
+    case SCRIPT_GOTO:
+        if((static_cast<float32_t>(step->A) != this->x) || (static_cast<float32_t>(step->B) != this->y))
+            this->o = Utils::Atan2(static_cast<float32_t>(step->B) - this->y, static_cast<float32_t>(step->A) - this->x);
+        this->x = static_cast<float32_t>(step->A);
+        this->y = static_cast<float32_t>(step->B);
+        pushed = this->mc->Goto(step->A, step->B, CMD_MODE_APPEND, this->tag);
+        break;
+
+    case SCRIPT_GOLIN:
+        this->x += static_cast<float32_t>(step->A) * Utils::Cos(this->o);
+        this->y += static_cast<float32_t>(step->A) * Utils::Sin(this->o);
+        pushed = this->mc->GoLin(step->A, CMD_MODE_APPEND, this->tag);
+        break;
+
+    case SCRIPT_GOANG:
+        this->o = static_cast<float32_t>(step->A) * SCRIPT_RAD_BY_DECIDEG;
+        pushed = this->mc->GoAng(step->A, CMD_MODE_APPEND, this->tag);
+        break;
+
+    case SCRIPT_ROUTE:
+        route = Routes::Get(static_cast<uint32_t>(step->A));
+        if(route == NULL)
+            return false;
+        this->x = route->SAMPLES[route->COUNT - 1u].x * 1000.0f;
+        this->y = route->SAMPLES[route->COUNT - 1u].y * 1000.0f;
+        this->o = route->SAMPLES[route->COUNT - 1u].heading;
+        pushed = this->mc->Route(static_cast<uint32_t>(step->A), CMD_MODE_APPEND, this->tag);
+        break;
+
+    case SCRIPT_ACTUATOR:
+        act.actuator = static_cast<uint8_t>(step->A);
+        act.order    = static_cast<uint8_t>(step->B);
+        act.index    = static_cast<int8_t>(step->C);
+        act.after    = -1;
+        act.percent  = 100u;
+
+        if(this->ac->Play(&act, 1u) < 0)
+            return false;
+
+        // Taken by the actuators task on its next period
+        vTaskDelay(pdMS_TO_TICKS(SCRIPT_POLL_MS));
+
+        while(this->ac->IsPlaying())
+        {
+            if(this->abort || (elapsed >= SCRIPT_STEP_TIMEOUT_MS))
+                return false;
+
+            vTaskDelay(pdMS_TO_TICKS(SCRIPT_POLL_MS));
+            elapsed += SCRIPT_POLL_MS;
+        }
+        return true;
+
+    case SCRIPT_WAIT:
+        vTaskDelay(pdMS_TO_TICKS(static_cast<uint32_t>(step->A)));
+        return true;
+
+    default:
+        return false;
+    }
+
+    return pushed && this->waitOrder();
+}
+
+void Scripts::run ()
+{
+    const SCRIPT_STEP* s = NULL;
+    robot_t r;
+    uint32_t start = 0u, stepStart = 0u;
+    float32_t dx = 0.0f, dy = 0.0f;
+    bool ok = true;
+
+    Utils::Print("\r\nscript %s : %lu steps\r\n", this->script->NAME, this->script->COUNT);
+    Utils::Print("#  Step\tTime(ms)\tErr(mm)\tErr(deg)\r\n");
+
+    // Loops peak over the run only
+    this->mc->GetProfiler()->Reset();
+    this->tp->GetProfiler()->Reset();
+    this->pc->GetProfiler()->Reset();
+    this->odometry->GetProfiler()->Reset();
+
+    start = Utils::Clock::GetMicros();
+
+    for(uint32_t i = 0u; (i < this->script->COUNT) && ok && !this->abort; i++)
+    {
+        s = &this->script->STEPS[i];
+        stepStart = Utils::Clock::GetMicros();
+
+        ok = this->step(s);
+
+        // Pose error against the scripted pose
+        this->odometry->GetRobot(&r);
+        dx = this->x - static_cast<float32_t>(r.Xmm);
+        dy = this->y - static_cast<float32_t>(r.Ymm);
+
+        Utils::Print(" %-2lu %s\t%lu\t\t%.1f\t%.2f%s\r\n", i, _opNames[s->OP],
+               (Utils::Clock::GetMicros() - stepStart) / 1000u,
+               Utils::Sqrt(dx*dx + dy*dy),
+               Utils::Units::ToDegree(Utils::Units::Radian(Utils::WrapPi(this->o - r.O))).Value(),
+               ok ? "" : "\tFAILED");
+    }
+
+    if(!ok || this->abort)
+        this->mc->Stop();
+
+    Utils::Print("script %s : %s in %lu ms\r\n", this->script->NAME,
+           (ok && !this->abort) ? "done" : "aborted",
+           (Utils::Clock::GetMicros() - start) / 1000u);
+
+    Utils::Print("loops peak (us) : od %lu, mc %lu, tp %lu, pc %lu\r\n",
+           Utils::Profiler::CyclesToUs(this->odometry->GetProfiler()->GetMax()),
+           Utils::Profiler::CyclesToUs(this->mc->GetProfiler()->GetMax()),
+           Utils::Profiler::CyclesToUs(this->tp->GetProfiler()->GetMax()),
+           Utils::Profiler::CyclesToUs(this->pc->GetProfiler()->GetMax()));
+}
+
+void Scripts::taskHandler (void* obj)
+{
+    Scripts* instance = _scripts;
+
+    while(1)
+    {
+        // 1. Wait for Start()
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+
+        // 2. Run and report
+        instance->run();
+
+        instance->running = false;
+    }
+}
@@ -0,0 +1,258 @@
+/**
+ * @file    SerialProtocol.cpp
+ * @author  Jeremy ROULLAND
+ * @date    24 oct. 2017
+ * @brief   Binary command channel on the console serial link
+ */
+
+#include "SerialProtocol.hpp"
+#include "I2CProtocol.hpp"
+#include "StaticStorage.hpp"
+#include "Frame.hpp"
+#include "Crc.hpp"
+
+#include <string.h>
+
+/*----------------------------------------------------------------------------*/
+/* Definitions                                                                */
+/*----------------------------------------------------------------------------*/
+
+#define SP_SERIAL_ID                  (SERIAL_CONSOLE)
+
+/*----------------------------------------------------------------------------*/
+/* Private Members                                                            */
+/*----------------------------------------------------------------------------*/
+
+static SerialProtocol* _serialProtocol = NULL;
+static Utils::StaticStorage<SerialProtocol> _serialProtocolStorage;
+
+/*----------------------------------------------------------------------------*/
+/* Class Implementation                                                       */
+/*----------------------------------------------------------------------------*/
+
+SerialProtocol* SerialProtocol::GetInstance()
+{
+    // If SerialProtocol instance already exists
+    if(_serialProtocol != NULL)
+    {
+        return _serialProtocol;
+    }
+    else
+    {
+        _serialProtocol = new (_serialProtocolStorage.Get()) SerialProtocol();
+        return _serialProtocol;
+    }
+}
+
+SerialProtocol::SerialProtocol()
+{
+    this->name = "SerialProtocol";
+
+    this->length = 0u;
+    this->receiving = false;
+    this->escaped = false;
+    this->overflow = false;
+
+    this->open = false;
+    this->expected = 0u;
+    this->nakSent = false;
+    memset(this->responses, 0, sizeof(this->responses));
+
+    this->crcErrors = 0u;
+    this->framingErrors = 0u;
+    this->retransmissions = 0u;
+
+    this->serial = HAL::Serial::GetInstance(SP_SERIAL_ID);
+}
+
+bool SerialProtocol::Input(uint8_t c)
+{
+    if(c == SP_DELIMITER)
+    {
+        // Start delimiter (or end delimiter lost : restart)
+        if(!this->receiving || (this->length == 0u) || this->overflow)
+        {
+            this->receiving = !this->overflow;
+            this->overflow = false;
+            this->escaped = false;
+            this->length = 0u;
+            return true;
+        }
+
+        this->receive();
+        this->receiving = false;
+        return true;
+    }
+
+    if(!this->receiving)
+        return false;
+
+    // Never stuffed : the host aborts the frame to stop the robot
+    if(c == static_cast<uint8_t>(SP_BREAK_CHAR))
+    {
+        this->framingErrors++;
+        this->receiving = false;
+        return false;
+    }
+
+    if(this->overflow)
+        return true;
+
+    if(this->escaped)
+    {
+        c ^= SP_ESCAPE_XOR;
+        this->escaped = false;
+    }
+    else if(c == SP_ESCAPE)
+    {
+        this->escaped = true;
+        return true;
+    }
+
+    // Dropped up to the end delimiter
+    if(this->length >= SP_FRAME_MAX)
+    {
+        this->framingErrors++;
+        this->overflow = true;
+        return true;
+    }
+
+    this->rx[this->length++] = c;
+
+    return true;
+}
+
+void SerialProtocol::receive()
+{
+    sp_frame_t request;
+    sp_frame_t* response = NULL;
+    uint32_t size = this->length - SP_CRC_SIZE;
+    uint32_t crc = 0u;
+
+    if((this->length < (SP_HEADER_SIZE + SP_CRC_SIZE)) || (this->rx[2] != (size - SP_HEADER_SIZE)))
+    {
+        this->framingErrors++;
+        return;
+    }
+
+    memcpy(&crc, &this->rx[size], sizeof(crc));
+
+    if(crc != HAL::Crc::Compute(this->rx, size))
+    {
+        this->crcErrors++;
+
+        // Seq is not trusted, resume from the expected one
+        if(this->open)
+            this->nak();
+        return;
+    }
+
+    memcpy(&request, this->rx, size);
+
+    // Reset (or first request) opens the window at its seq
+    if((request.type == SP_TYPE_RESET) || !this->open)
+    {
+        this->open = true;
+        this->expected = request.seq;
+        this->nakSent = false;
+        memset(this->responses, 0, sizeof(this->responses));
+    }
+
+    response = &this->responses[request.seq % SP_WINDOW];
+
+    if(request.seq == this->expected)
+    {
+        this->execute(&request, response);
+        this->expected++;
+        this->nakSent = false;
+        this->send(response);
+    }
+    else if(static_cast<uint8_t>(this->expected - request.seq) <= SP_WINDOW)
+    {
+        // Response lost : answer again, never execute twice
+        this->retransmissions++;
+
+        if((response->type != 0u) && (response->seq == request.seq))
+            this->send(response);
+    }
+    else if(!this->nakSent)
+    {
+        // Gap : following requests are dropped until the expected one is resent
+        this->nak();
+    }
+}
+
+void SerialProtocol::execute(const sp_frame_t* request, sp_frame_t* response)
+{
+    I2CProtocol* protocol = I2CProtocol::GetInstance();
+    I2C_FRAME frame;
+    int8_t status = NO_ERROR;
+
+    response->type = SP_TYPE_ACK;
+    response->seq = request->seq;
+
+    switch(request->type)
+    {
+    case SP_TYPE_RESET:
+    case SP_TYPE_PING:
+        break;
+
+    case SP_TYPE_WRITE:
+        frame.Type = I2C_FRAME_TYPE_WRITE;
+        frame.Length = request->length;
+        frame.CRCval = 0u;
+        memcpy(frame.Data, request->payload, request->length);
+
+        if((request->length == 0u) || !protocol->Post(&frame))
+            status = SP_ERROR_REFUSED;
+        break;
+
+    case SP_TYPE_READ:
+        if(request->length != sizeof(uint8_t))
+        {
+            status = SP_ERROR_REFUSED;
+            break;
+        }
+
+        response->type = SP_TYPE_DATA;
+        response->length = static_cast<uint8_t>(protocol->ReadRegister(request->payload[0], response->payload, SP_PAYLOAD_MAX));
+        return;
+
+    default:
+        status = SP_ERROR_TYPE;
+        break;
+    }
+
+    response->length = sizeof(status);
+    response->payload[0] = static_cast<uint8_t>(status);
+}
+
+void SerialProtocol::send(const sp_frame_t* response)
+{
+    uint8_t raw[SP_FRAME_MAX];
+    uint8_t* encoded;
+    uint32_t size = SP_HEADER_SIZE + response->length;
+    uint32_t crc;
+
+    memcpy(raw, response, size);
+    crc = HAL::Crc::Compute(raw, size);
+    memcpy(&raw[size], &crc, sizeof(crc));
+
+    // Whole frame or nothing (encoded in place in the TX buffer), the host resends on timeout
+    encoded = this->serial->Reserve(FRAME_COBS_SIZE(size + SP_CRC_SIZE));
+    if(encoded != NULL)
+        this->serial->Commit(Utils::CobsEncode(raw, size + SP_CRC_SIZE, encoded));
+}
+
+void SerialProtocol::nak()
+{
+    sp_frame_t response;
+
+    response.type = SP_TYPE_NAK;
+    response.seq = this->expected;
+    response.length = sizeof(uint8_t);
+    response.payload[0] = this->expected;
+
+    this->nakSent = true;
+    this->send(&response);
+}
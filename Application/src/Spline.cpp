@@ -0,0 +1,208 @@
+/**
+ * @file    Spline.cpp
+ * @author  Jeremy ROULLAND
+ * @date    25 oct. 2017
+ * @brief   Arc length parameterized cubic spline
+ */
+
+#include "Spline.hpp"
+#include "FastMath.hpp"
+
+#include <math.h>
+
+/*----------------------------------------------------------------------------*/
+/* Definitions                                                                */
+/*----------------------------------------------------------------------------*/
+
+#define SPLINE_PI               (3.14159265f)
+
+/*----------------------------------------------------------------------------*/
+/* Private Functions                                                          */
+/*----------------------------------------------------------------------------*/
+
+/**
+ * @brief Bring angle within pi of reference
+ */
+static float32_t _unwrap (float32_t angle, float32_t reference)
+{
+    while((angle - reference) > SPLINE_PI)
+        angle -= 2.0f * SPLINE_PI;
+    while((angle - reference) < -SPLINE_PI)
+        angle += 2.0f * SPLINE_PI;
+
+    return angle;
+}
+
+/**
+ * @brief Hermite segment to polynomial coefficients
+ */
+static void _coefficients (float32_t c[4], float32_t p0, float32_t p1, float32_t m0, float32_t m1)
+{
+    c[0] = p0;
+    c[1] = m0;
+    c[2] = 3.0f * (p1 - p0) - 2.0f * m0 - m1;
+    c[3] = 2.0f * (p0 - p1) + m0 + m1;
+}
+
+/*----------------------------------------------------------------------------*/
+/* Class Implementation                                                       */
+/*----------------------------------------------------------------------------*/
+
+namespace MotionControl
+{
+    Spline::Spline()
+    {
+        this->segments = 0;
+        this->lut[0] = 0.0f;
+        this->lutHeading[0] = 0.0f;
+    }
+
+    bool Spline::Load(const float32_t X[], const float32_t Y[], uint32_t n, float32_t heading)
+    {
+        float32_t mx0, my0, mx1, my1, chord;
+        float32_t p[2], d1[2], d2[2], last[2], v, k;
+        uint32_t i, j, node;
+
+        this->segments = 0;
+        this->lut[0] = 0.0f;
+
+        if((n < 2u) || (n > (SPLINE_SEGMENTS_MAX + 1u)))
+            return false;
+
+        // First tangent along heading, scaled by first chord
+        chord = Utils::Sqrt((X[1] - X[0]) * (X[1] - X[0]) + (Y[1] - Y[0]) * (Y[1] - Y[0]));
+        Utils::SinCos(heading, &my0, &mx0);
+        mx0 *= chord;
+        my0 *= chord;
+
+        for(i = 0; i < (n - 1u); i++)
+        {
+            if(((X[i+1] - X[i]) * (X[i+1] - X[i]) + (Y[i+1] - Y[i]) * (Y[i+1] - Y[i])) < 1e-6f)
+                return false;
+
+            // Catmull-Rom tangents, last one along last chord
+            if((i + 2u) < n)
+            {
+                mx1 = 0.5f * (X[i+2] - X[i]);
+                my1 = 0.5f * (Y[i+2] - Y[i]);
+            }
+            else
+            {
+                mx1 = X[i+1] - X[i];
+                my1 = Y[i+1] - Y[i];
+            }
+
+            _coefficients(this->cx[i], X[i], X[i+1], mx0, mx1);
+            _coefficients(this->cy[i], Y[i], Y[i+1], my0, my1);
+
+            mx0 = mx1;
+            my0 = my1;
+        }
+
+        this->segments = n - 1u;
+
+        // Arc length table, unwrapped headings and curvature at nodes
+        last[0] = X[0];
+        last[1] = Y[0];
+        this->lutHeading[0] = heading;
+
+        for(i = 0; i < this->segments; i++)
+        {
+            this->curvature[i] = 0.0f;
+
+            for(j = (i == 0u) ? 0u : 1u; j <= SPLINE_LUT_STEPS; j++)
+            {
+                node = i * SPLINE_LUT_STEPS + j;
+
+                this->evaluate(i, static_cast<float32_t>(j) / static_cast<float32_t>(SPLINE_LUT_STEPS), p, d1, d2);
+
+                if(node > 0u)
+                {
+                    this->lut[node] = this->lut[node - 1u] + Utils::Sqrt((p[0] - last[0]) * (p[0] - last[0]) + (p[1] - last[1]) * (p[1] - last[1]));
+                    this->lutHeading[node] = _unwrap(Utils::Atan2(d1[1], d1[0]), this->lutHeading[node - 1u]);
+                }
+
+                v = Utils::Sqrt(d1[0] * d1[0] + d1[1] * d1[1]);
+                if(v > 1e-6f)
+                {
+                    k = fabsf(d1[0] * d2[1] - d1[1] * d2[0]) / (v * v * v);
+                    if(k > this->curvature[i])
+                        this->curvature[i] = k;
+                }
+
+                last[0] = p[0];
+                last[1] = p[1];
+            }
+        }
+
+        // Curvature at segments junctions belongs to both segments
+        for(i = 1; i < this->segments; i++)
+        {
+            this->evaluate(i, 0.0f, p, d1, d2);
+            v = Utils::Sqrt(d1[0] * d1[0] + d1[1] * d1[1]);
+            if(v > 1e-6f)
+            {
+                k = fabsf(d1[0] * d2[1] - d1[1] * d2[0]) / (v * v * v);
+                if(k > this->curvature[i])
+                    this->curvature[i] = k;
+            }
+        }
+
+        return true;
+    }
+
+    void Spline::Evaluate(float32_t s, float32_t* x, float32_t* y, float32_t* heading)
+    {
+        float32_t p[2], d1[2], d2[2], f, u;
+        uint32_t lo = 0, hi = this->segments * SPLINE_LUT_STEPS, k;
+
+        if(this->segments == 0u)
+        {
+            *x = 0.0f;
+            *y = 0.0f;
+            *heading = this->lutHeading[0];
+            return;
+        }
+
+        if(s < 0.0f)
+            s = 0.0f;
+        if(s > this->lut[hi])
+            s = this->lut[hi];
+
+        // Table interval holding s
+        while((hi - lo) > 1u)
+        {
+            k = (lo + hi) / 2u;
+            if(this->lut[k] <= s)
+                lo = k;
+            else
+                hi = k;
+        }
+
+        f = (this->lut[hi] > this->lut[lo]) ? ((s - this->lut[lo]) / (this->lut[hi] - this->lut[lo])) : 0.0f;
+
+        // Segment parameter, linear between nodes
+        k = lo / SPLINE_LUT_STEPS;
+        if(k >= this->segments)
+            k = this->segments - 1u;
+        u = (static_cast<float32_t>(lo - k * SPLINE_LUT_STEPS) + f) / static_cast<float32_t>(SPLINE_LUT_STEPS);
+
+        this->evaluate(k, u, p, d1, d2);
+
+        *x = p[0];
+        *y = p[1];
+        *heading = _unwrap(Utils::Atan2(d1[1], d1[0]), this->lutHeading[lo]);
+    }
+
+    void Spline::evaluate(uint32_t i, float32_t u, float32_t p[2], float32_t d1[2], float32_t d2[2])
+    {
+        const float32_t* c[2] = {this->cx[i], this->cy[i]};
+
+        for(uint32_t a = 0; a < 2u; a++)
+        {
+            p[a]  = c[a][0] + u * (c[a][1] + u * (c[a][2] + u * c[a][3]));
+            d1[a] = c[a][1] + u * (2.0f * c[a][2] + u * 3.0f * c[a][3]);
+            d2[a] = 2.0f * c[a][2] + 6.0f * u * c[a][3];
+        }
+    }
+}
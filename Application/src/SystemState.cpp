@@ -0,0 +1,63 @@
+/**
+ * @file    SystemState.cpp
+ * @author  Jeremy ROULLAND
+ * @date    15 oct. 2026
+ * @brief   System state published once per control period for status readers
+ */
+
+#include "SystemState.hpp"
+#include "stm32f4xx.h"
+
+/*----------------------------------------------------------------------------*/
+/* Private Members                                                            */
+/*----------------------------------------------------------------------------*/
+
+/**
+ * @brief Published state, sequence (odd while publishing)
+ */
+static SYSTEM_STATE _state;
+static volatile uint32_t _seq = 0u;
+static uint32_t _cycle = 0u;
+
+/*----------------------------------------------------------------------------*/
+/* Class Implementation                                                       */
+/*----------------------------------------------------------------------------*/
+
+void SystemState::Publish(const SYSTEM_STATE* state)
+{
+    _seq = _seq + 1u;
+    __DMB();
+
+    _state = *state;
+    _state.cycle = ++_cycle;
+
+    __DMB();
+    _seq = _seq + 1u;
+}
+
+bool SystemState::Read(SYSTEM_STATE* state)
+{
+    uint32_t seq;
+
+    do
+    {
+        // Wait for the end of a publication
+        do
+        {
+            seq = _seq;
+        }while(seq & 1u);
+
+        __DMB();
+
+        *state = _state;
+
+        __DMB();
+    }while(seq != _seq);
+
+    return (state->cycle != 0u);
+}
+
+uint32_t SystemState::GetCycle()
+{
+    return _cycle;
+}
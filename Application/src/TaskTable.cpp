@@ -0,0 +1,120 @@
+/**
+ * @file    TaskTable.cpp
+ * @author  Jeremy ROULLAND
+ * @date    22 oct. 2017
+ * @brief   Static task table
+ */
+
+#include "TaskTable.hpp"
+
+#include <stddef.h>
+
+/*----------------------------------------------------------------------------*/
+/* Private Members                                                            */
+/*----------------------------------------------------------------------------*/
+
+/**
+ * @brief Task definitions, in TaskTable::ID order
+ */
+static const TASK_DEF _taskDef[TaskTable::TASK_MAX] =
+{
+    {TASK_ODOMETRY_STACK_SIZE,  TASK_ODOMETRY_PRIORITY, TASK_ODOMETRY_PERIOD_MS},
+    {TASK_MC_STACK_SIZE,        TASK_MC_PRIORITY,       TASK_MC_PERIOD_MS},
+    {TASK_PC_STACK_SIZE,        TASK_PC_PRIORITY,       TASK_PC_PERIOD_MS},
+    {TASK_TP_STACK_SIZE,        TASK_TP_PRIORITY,       TASK_TP_PERIOD_MS},
+    {TASK_AC_STACK_SIZE,        TASK_AC_PRIORITY,       TASK_AC_PERIOD_MS},
+    {TASK_I2CP_STACK_SIZE,      TASK_I2CP_PRIORITY,     TASK_I2CP_PERIOD_MS},
+    {TASK_DIAG_STACK_SIZE,      TASK_DIAG_PRIORITY,     TASK_DIAG_PERIOD_MS},
+    {TASK_CLI_STACK_SIZE,       TASK_CLI_PRIORITY,      TASK_CLI_PERIOD_MS},
+    {TASK_TEST_STACK_SIZE,      TASK_TEST_PRIORITY,     TASK_TEST_PERIOD_MS},
+    {TASK_DEFERRED_STACK_SIZE,  TASK_DEFERRED_PRIORITY, TASK_DEFERRED_PERIOD_MS},
+    {TASK_SCRIPT_STACK_SIZE,    TASK_SCRIPT_PRIORITY,   TASK_SCRIPT_PERIOD_MS},
+    {TASK_CALIB_STACK_SIZE,     TASK_CALIB_PRIORITY,    TASK_CALIB_PERIOD_MS},
+    {TASK_BOOT_STACK_SIZE,      TASK_BOOT_PRIORITY,     TASK_BOOT_PERIOD_MS},
+};
+
+/**
+ * @brief Task stacks (one pool, split in TaskTable::ID order) and control blocks
+ */
+static StackType_t _taskStack[TASK_STACK_TOTAL];
+static StaticTask_t _taskTcb[TaskTable::TASK_MAX];
+static TaskHandle_t _taskHandle[TaskTable::TASK_MAX] = {NULL};
+
+/**
+ * @brief Kernel tasks (idle and timer service) memory
+ */
+static StackType_t _idleStack[configMINIMAL_STACK_SIZE];
+static StaticTask_t _idleTcb;
+static StackType_t _timerStack[configTIMER_TASK_STACK_DEPTH];
+static StaticTask_t _timerTcb;
+
+/*----------------------------------------------------------------------------*/
+/* Class Implementation                                                       */
+/*----------------------------------------------------------------------------*/
+
+TaskHandle_t TaskTable::Create (enum TaskTable::ID id, TaskFunction_t handler, const char* name, void* param)
+{
+    uint32_t offset = 0u;
+
+    assert(id < TaskTable::TASK_MAX);
+    assert(_taskHandle[id] == NULL);
+    assert(_taskDef[id].STACK_SIZE > 0u);
+
+    for(uint32_t i = 0u; i < static_cast<uint32_t>(id); i++)
+        offset += _taskDef[i].STACK_SIZE;
+
+    _taskHandle[id] = xTaskCreateStatic(handler,
+                                        name,
+                                        _taskDef[id].STACK_SIZE,
+                                        param,
+                                        _taskDef[id].PRIORITY,
+                                        &_taskStack[offset],
+                                        &_taskTcb[id]);
+
+    // Trace task number, 0 for kernel tasks
+    vTaskSetTaskNumber(_taskHandle[id], id + 1u);
+
+    return _taskHandle[id];
+}
+
+const TASK_DEF* TaskTable::GetDef (enum TaskTable::ID id)
+{
+    assert(id < TaskTable::TASK_MAX);
+
+    return &_taskDef[id];
+}
+
+TaskHandle_t TaskTable::GetHandle (enum TaskTable::ID id)
+{
+    assert(id < TaskTable::TASK_MAX);
+
+    return _taskHandle[id];
+}
+
+uint32_t TaskTable::GetStackFree (enum TaskTable::ID id)
+{
+    assert(id < TaskTable::TASK_MAX);
+
+    if(_taskHandle[id] == NULL)
+        return 0u;
+
+    return uxTaskGetStackHighWaterMark(_taskHandle[id]);
+}
+
+/*----------------------------------------------------------------------------*/
+/* FreeRTOS static allocation callbacks                                       */
+/*----------------------------------------------------------------------------*/
+
+extern "C" void vApplicationGetIdleTaskMemory (StaticTask_t** tcb, StackType_t** stack, uint32_t* size)
+{
+    *tcb = &_idleTcb;
+    *stack = _idleStack;
+    *size = configMINIMAL_STACK_SIZE;
+}
+
+extern "C" void vApplicationGetTimerTaskMemory (StaticTask_t** tcb, StackType_t** stack, uint32_t* size)
+{
+    *tcb = &_timerTcb;
+    *stack = _timerStack;
+    *size = configTIMER_TASK_STACK_DEPTH;
+}
@@ -6,6 +6,9 @@
  */
 
 #include "TrajectoryPlanning.hpp"
+#include "TaskTable.hpp"
+#include "StaticStorage.hpp"
+#include "Clock.hpp"
 
 #include <math.h>
 
@@ -15,16 +18,49 @@ using namespace MotionControl;
 /* Definitions                                                                */
 /*----------------------------------------------------------------------------*/
 
-#define TP_TASK_STACK_SIZE          (512u)
-#define TP_TASK_PRIORITY            (configMAX_PRIORITIES-6)
+#define TP_TASK_PERIOD_MS           (TASK_TP_PERIOD_MS)
+#define TP_PERIOD_S                 (static_cast<float32_t>(TP_TASK_PERIOD_MS / 1000.0))
 
-#define TP_TASK_PERIOD_MS           (100u)
+// Arc toward a point closer than this to the heading line is a straight move (m)
+#define TP_ARC_STRAIGHT             (1e-4f)
+
+// Planned run is finished below this distance to its end (m)
+#define TP_PLAN_END                 (1e-4f)
+
+// Border calibration : backward travel limit and no border timeout
+#define TP_STALL_DISTANCE           (0.20f)
+#define TP_STALL_TIMEOUT_S          (5.0f)
+
+// Border contact : rear bumpers (active low, EXTI), encoders velocity collapse, steps / encoders mismatch
+#define TP_STALL_BUMPER_L           (HAL::GPIO::GPIO59)
+#define TP_STALL_BUMPER_R           (HAL::GPIO::GPIO64)
+#define TP_STALL_ARM_M              (0.005f)    // Backward travel before velocity and mismatch apply (start of move)
+#define TP_STALL_VEL_MIN            (0.010f)    // m/s, encoders velocity below this is a collapse
+#define TP_STALL_SLIP_M             (0.003f)    // Commanded minus measured travel, on both wheels
+#define TP_STALL_CONFIRM            (2u)        // Periods velocity or mismatch must hold
+
+// Motion state statistics : settling bands around the last position setpoint, given up after timeout
+#define TP_SETTLE_LINEAR            (0.002f)    // m
+#define TP_SETTLE_ANGULAR           (0.01f)     // rad
+#define TP_SETTLE_TIMEOUT_US        (2000000u)
+
+#define TP_STALL_BUMPER             (1u<<0)
+#define TP_STALL_VELOCITY           (1u<<1)
+#define TP_STALL_MISMATCH           (1u<<2)
+#define TP_STALL_DRIVER             (1u<<3)
 
 /*----------------------------------------------------------------------------*/
 /* Private Members                                                            */
 /*----------------------------------------------------------------------------*/
 
 static MotionControl::TrajectoryPlanning* _trajectoryPlanning = NULL;
+static Utils::StaticStorage<MotionControl::TrajectoryPlanning> _trajectoryPlanningStorage;
+
+// state_t order
+static const char* _stateNames[TP_STATES] =
+{
+    "free", "linear", "angular", "stop", "keep", "linearplan", "curveplan", "stallx", "stally", "drawplan", "route", "brake", "arc"
+};
 
 /*----------------------------------------------------------------------------*/
 /* Private Functions                                                          */
@@ -41,12 +77,12 @@ namespace MotionControl
         }
         else
         {
-            _trajectoryPlanning = new TrajectoryPlanning(standalone);
+            _trajectoryPlanning = new (_trajectoryPlanningStorage.Get()) TrajectoryPlanning(standalone);
             return _trajectoryPlanning;
         }
     }
 
-    TrajectoryPlanning::TrajectoryPlanning(bool standalone)
+    TrajectoryPlanning::TrajectoryPlanning(bool standalone) : profiler("TrajectoryPlanning"), periodic("TrajectoryPlanning", TP_TASK_PERIOD_MS)
     {
         this->name = "TrajectoryPlanning";
         this->taskHandle = NULL;
@@ -60,40 +96,81 @@ namespace MotionControl
         this->status = 0x0000;
 
         this->stallMode = 0;
+        this->stallContacted = false;
+        this->stallConfirm = 0u;
+        this->stallSource = 0u;
+        this->bumped = false;
 
-        this->X[0] = 0.0;
-        this->Y[0] = 0.0;
+        this->X[0] = 0.0f;
+        this->Y[0] = 0.0f;
         this->XYn  = 0;
 
-        this->linearSetPoint = 0.0;
-        this->linearNextSetPoint = 0.0;
-        this->angularSetPoint = 0.0;
-
-        this->startTime = 0.0;
-        this->startLinearPosition  = 0.0;
-        this->startAngularPosition = 0.0;
-
-        this->endLinearPosition = 0.0;
-        this->endAngularPosition = 0.0;
-
+        this->streaming = false;
+        this->streamEnded = false;
+        this->streamPassed = 0;
+
+        this->runStart  = 0;
+        this->runEnd    = 0;
+        this->runOrigin = 0.0f;
+
+        this->planN = 0;
+        this->planAcc = 1.0f;
+        this->planPosition = 0.0f;
+        this->planSpeed = 0.0f;
+
+        this->routeDef = NULL;
+        this->routeOffset = 0.0f;
+
+        this->linearSetPoint = 0.0f;
+        this->angularSetPoint = 0.0f;
+
+        this->startTime = 0.0f;
+        this->startLinearPosition  = 0.0f;
+        this->startAngularPosition = 0.0f;
+
+        this->endLinearPosition = 0.0f;
+        this->endAngularPosition = 0.0f;
+
+        this->ResetStateStats();
+        this->statsState = FREE;
+        this->statsStep = 0;
+        this->statsStart = 0u;
+        this->statsCycles = 0u;
+        this->settleState = -1;
+        this->settleStart = 0u;
+
+        // Runtime inspection (CLI watch, peek)
+        WATCH_MEMBER("tp", step);
+        WATCH_MEMBER("tp", state);
+        WATCH_MEMBER("tp", finished);
+        WATCH_MEMBER("tp", linearSetPoint);
+        WATCH_MEMBER("tp", angularSetPoint);
+        WATCH_MEMBER("tp", endLinearPosition);
+        WATCH_MEMBER("tp", endAngularPosition);
+        WATCH_MEMBER("tp", status);
+        WATCH_MEMBER("tp", stallSource);
 
         this->odometry = Odometry::GetInstance();
         this->position = PositionControl::GetInstance();
 
+        // Rear bumpers : both edges latched by interrupt, read by detectContact()
+        this->bumperL = HAL::GPIO::GetInstance(TP_STALL_BUMPER_L);
+        this->bumperR = HAL::GPIO::GetInstance(TP_STALL_BUMPER_R);
+        this->bumperL->StateChanged.Subscribe<TrajectoryPlanning, &TrajectoryPlanning::INTERNAL_Bumper>(this);
+        this->bumperR->StateChanged.Subscribe<TrajectoryPlanning, &TrajectoryPlanning::INTERNAL_Bumper>(this);
+
         if(standalone)
         {
             // Create task
-            xTaskCreate((TaskFunction_t)(&TrajectoryPlanning::taskHandler),
-                        this->name.c_str(),
-                        TP_TASK_STACK_SIZE,
-                        NULL,
-                        TP_TASK_PRIORITY,
-                        NULL);
+            TaskTable::Create(TaskTable::TRAJECTORY_PLANNING, (TaskFunction_t)(&TrajectoryPlanning::taskHandler), this->name);
         }
 
     }
     void TrajectoryPlanning::goLinear(float32_t linear) // linear in meters
     {
+        // New order : wheels may move again after a stall
+        this->position->ClearStall();
+
         float32_t Lm = this->odometry->GetLinearPosition();
 
     	this->linearSetPoint = Lm + linear;
@@ -104,6 +181,8 @@ namespace MotionControl
 
     void TrajectoryPlanning::goAngular(float32_t angular) // angular in radian
     {
+        this->position->ClearStall();
+
         this->angularSetPoint = angular;
 
         this->state = ANGULAR;
@@ -118,36 +197,56 @@ namespace MotionControl
 
     void TrajectoryPlanning::stop()
     {
-        //TODO: Deceleration
+        // Profiles are replanned by the task (may be called from interrupt)
+        this->state = BRAKE;
+        this->step  = 1;
+    }
 
+    void TrajectoryPlanning::halt()
+    {
         this->state = STOP;
         this->step  = 1;
     }
 
     void TrajectoryPlanning::gotoXY(float32_t X, float32_t Y)
     {
+        this->position->ClearStall();
+
         robot_t r;
 
         this->odometry->GetRobot(&r);
 
-        float32_t Xm = static_cast<float32_t>(r.Xmm) / 1000.0;
-        float32_t Ym = static_cast<float32_t>(r.Ymm) / 1000.0;
-        float32_t Lm = static_cast<float32_t>(r.Lmm) / 1000.0;
-
-        float32_t XX = pow((X - Xm), 2);
-        float32_t YY = pow((Y - Ym), 2);
+        float32_t Xm = static_cast<float32_t>(r.Xmm) / 1000.0f;
+        float32_t Ym = static_cast<float32_t>(r.Ymm) / 1000.0f;
+        float32_t Lm = static_cast<float32_t>(r.Lmm) / 1000.0f;
 
         float32_t dX = X - Xm;   // meters
         float32_t dY = Y - Ym;   // meters
 
-        this->linearSetPoint  = Lm + sqrtl(XX + YY); // meters
-        this->angularSetPoint = atan2f(dY,dX);  // radians
+        this->linearSetPoint  = Lm + Utils::Sqrt(dX*dX + dY*dY); // meters
+        this->angularSetPoint = Utils::Atan2(dY,dX);  // radians
 
         /* Faster path */
-        while( (this->angularSetPoint - r.O) > _PI_)
-            this->angularSetPoint -= _2_PI_;
-        while( (this->angularSetPoint - r.O) < -_PI_)
-            this->angularSetPoint += _2_PI_;
+        this->angularSetPoint = r.O + Utils::WrapPi(this->angularSetPoint - r.O);
+
+        // One segment path, followed by pursuit during translation
+        this->X[0] = Xm;
+        this->Y[0] = Ym;
+        this->X[1] = X;
+        this->Y[1] = Y;
+        this->XYn  = 1;
+        this->heading[0] = this->angularSetPoint;
+        this->length[0]  = this->linearSetPoint - Lm;
+        this->dirX[0]    = (this->length[0] > 0.0f) ? (dX / this->length[0]) : 1.0f;
+        this->dirY[0]    = (this->length[0] > 0.0f) ? (dY / this->length[0]) : 0.0f;
+        this->tangent[0] = 0.0f;
+        this->tangent[1] = 0.0f;
+        this->radius[0]  = 0.0f;
+        this->radius[1]  = 0.0f;
+        this->arc[0]     = 0.0f;
+        this->arc[1]     = 0.0f;
+        this->runStart = 0;
+        this->runEnd   = 1;
 
         this->state = LINEARPLAN;
         this->step  = 1;
@@ -155,22 +254,158 @@ namespace MotionControl
 
     void TrajectoryPlanning::pushXY(float32_t X[], float32_t Y[], uint32_t n)
     {
+        this->position->ClearStall();
+
         uint32_t i;
 
-        assert(n<10);
+        assert(n <= TP_PATH_MAX);
 
+        // Point 0 is set to robot location when path starts
         for(i=0 ; i<n ; i++)
         {
-            this->X[i] = X[i];
-            this->Y[i] = Y[i];
+            this->X[i+1] = X[i];
+            this->Y[i+1] = Y[i];
         }
 
         this->XYn = n;
 
+        this->streaming = false;
+        this->streamPassed = 0;
+
+        this->state = DRAWPLAN;
+        this->step  = 1;
+    }
+
+    void TrajectoryPlanning::streamXY()
+    {
+        this->position->ClearStall();
+
+        // Points are loaded by the task, point 0 is set to robot location when path starts
+        this->XYn = 0;
+
+        this->streaming = true;
+        this->streamEnded = false;
+        this->streamPassed = 0;
+
         this->state = DRAWPLAN;
         this->step  = 1;
     }
 
+    bool TrajectoryPlanning::StreamPush(const TP_STREAM_POINT points[], uint32_t n)
+    {
+        uint32_t i;
+
+        // Single producer : free slots can only grow meanwhile
+        if(n > this->GetStreamFree())
+            return false;
+
+        for(i = 0; i < n; i++)
+            this->stream.Push(points[i]);
+
+        return true;
+    }
+
+    bool TrajectoryPlanning::route(uint32_t id)
+    {
+        const ROUTE_DEF* def = Routes::Get(id);
+        float32_t dX, dY;
+        robot_t r;
+
+        this->position->ClearStall();
+
+        if((def == NULL) || (def->COUNT < 2u))
+            return false;
+
+        this->odometry->GetRobot(&r);
+
+        // Routes are planned from their start point
+        dX = def->SAMPLES[0].x - static_cast<float32_t>(r.Xmm) / 1000.0f;
+        dY = def->SAMPLES[0].y - static_cast<float32_t>(r.Ymm) / 1000.0f;
+        if((dX*dX + dY*dY) > (TP_ROUTE_START_MAX * TP_ROUTE_START_MAX))
+            return false;
+
+        // Route headings brought by whole turns close to robot heading
+        this->routeOffset = Utils::WrapPi(def->SAMPLES[0].heading - r.O) - (def->SAMPLES[0].heading - r.O);
+
+        this->routeDef = def;
+
+        this->state = ROUTE;
+        this->step  = 1;
+
+        return true;
+    }
+
+    void TrajectoryPlanning::curveXY(float32_t X[], float32_t Y[], uint32_t n)
+    {
+        this->position->ClearStall();
+
+        uint32_t i;
+
+        assert(n <= TP_PATH_MAX);
+
+        // Point 0 is set to robot location when curve starts
+        for(i=0 ; i<n ; i++)
+        {
+            this->X[i+1] = X[i];
+            this->Y[i+1] = Y[i];
+        }
+
+        this->XYn = n;
+
+        this->state = CURVEPLAN;
+        this->step  = 1;
+    }
+
+    void TrajectoryPlanning::goArc(float32_t radius, float32_t length)
+    {
+        robot_t r;
+
+        this->position->ClearStall();
+
+        this->odometry->GetRobot(&r);
+
+        // Both axes end together (coordinated profiles) : heading turns by length / radius
+        this->linearSetPoint  = r.L + length;
+        this->angularSetPoint = r.O + ((radius != 0.0f) ? (length / radius) : 0.0f);
+
+        this->state = ARC;
+        this->step  = 1;
+    }
+
+    void TrajectoryPlanning::arcXY(float32_t X, float32_t Y)
+    {
+        float32_t dX, dY, sin, cos, a, b, turn;
+        robot_t r;
+
+        this->position->ClearStall();
+
+        this->odometry->GetRobot(&r);
+
+        dX = X - static_cast<float32_t>(r.Xmm) / 1000.0f;
+        dY = Y - static_cast<float32_t>(r.Ymm) / 1000.0f;
+
+        // Target in robot frame : a forward, b to the left
+        Utils::SinCos(r.O, &sin, &cos);
+        a =  dX * cos + dY * sin;
+        b = -dX * sin + dY * cos;
+
+        // Circle tangent to robot heading through the target : heading turns twice the target bearing
+        if(abs(b) < TP_ARC_STRAIGHT)
+        {
+            this->linearSetPoint  = r.L + a;
+            this->angularSetPoint = r.O;
+        }
+        else
+        {
+            turn = 2.0f * Utils::Atan2(b, a);
+            this->linearSetPoint  = r.L + turn * (a * a + b * b) / (2.0f * b);
+            this->angularSetPoint = r.O + turn;
+        }
+
+        this->state = ARC;
+        this->step  = 1;
+    }
+
     int32_t TrajectoryPlanning::stallX(int32_t stallMode)
     {
         // TODO:Check the stallMode coherence (Ex1: if ur on the left side of the table don't exe rightTable side to side Mode)
@@ -182,8 +417,10 @@ namespace MotionControl
         startLinearPosition = r.L;
         startAngularPosition = r.O;
 
-        endLinearPosition = startLinearPosition - 0.0;
-        endAngularPosition = 0.0;
+        endLinearPosition = startLinearPosition - 0.0f;
+        endAngularPosition = 0.0f;
+
+        stallContacted = false;
 
         state = STALLX;
         step = 1;
@@ -202,8 +439,10 @@ namespace MotionControl
         startLinearPosition = r.L;
         startAngularPosition = r.O;
 
-        endLinearPosition = startLinearPosition - 0.0;
-        endAngularPosition = _PI_/2.0;
+        endLinearPosition = startLinearPosition - 0.0f;
+        endAngularPosition = _PI_/2.0f;
+
+        stallContacted = false;
 
         state = STALLY;
         step = 1;
@@ -212,8 +451,116 @@ namespace MotionControl
     }
 
 
+    bool TrajectoryPlanning::isDecelerating()
+    {
+        bool decelerating = false;
+
+        switch(this->state)
+        {
+            case LINEAR:
+            case ANGULAR:
+            case ARC:
+                decelerating = (this->step == 2) && this->position->isPositioningDecelerating();
+                break;
+
+            case LINEARPLAN:
+                decelerating = (this->step == 5) && this->position->isPositioningDecelerating();
+                break;
+
+            case CURVEPLAN:
+                decelerating = (((this->step == 2) && ((this->planS[this->planN] - this->planPosition) <=
+                                                       (this->planSpeed * this->planSpeed) / (2.0f * this->planAcc) + TP_PLAN_END)) ||
+                                ((this->step == 3) && this->position->isPositioningDecelerating()));
+                break;
+
+            case ROUTE:
+                decelerating = (((this->step == 3) && ((this->routeDef->SAMPLES[this->routeDef->COUNT - 1u].s - this->planPosition) <=
+                                                       (this->planSpeed * this->planSpeed) / (2.0f * this->planAcc) + TP_PLAN_END)) ||
+                                ((this->step == 4) && this->position->isPositioningDecelerating()));
+                break;
+
+            case DRAWPLAN:
+                // Planned run brakes to its end
+                decelerating = (this->runEnd == this->XYn) && (!this->streaming || this->streamEnded) &&
+                               (((this->step == 4) && ((this->planS[this->planN] - this->planPosition) <=
+                                                       (this->planSpeed * this->planSpeed) / (2.0f * this->planAcc) + TP_PLAN_END)) ||
+                                ((this->step == 5) && this->position->isPositioningDecelerating()));
+                break;
+
+            default:
+                break;
+        }
+
+        return decelerating;
+    }
+
+    float32_t TrajectoryPlanning::GetRemaining()
+    {
+        float32_t remaining = 0.0f;
+        uint32_t i;
+
+        switch(this->state)
+        {
+            case LINEAR:
+            case LINEARPLAN:
+            case ARC:
+                remaining = Utils::Abs(this->linearSetPoint - odometry->GetLinearPosition());
+                break;
+
+            case CURVEPLAN:
+                remaining = this->planS[this->planN] - this->planPosition;
+                break;
+
+            case ROUTE:
+                remaining = this->routeDef->SAMPLES[this->routeDef->COUNT - 1u].s - this->planPosition;
+                break;
+
+            case DRAWPLAN:
+                // Planned run, then segments of the next runs
+                i = this->runStart;
+                if((this->step == 4) || (this->step == 5))
+                {
+                    remaining = this->runLength() - (odometry->GetLinearPosition() - this->runOrigin);
+                    i = this->runEnd;
+                }
+                for(; i < this->XYn; i++)
+                    remaining += this->length[i];
+                break;
+
+            default:
+                break;
+        }
+
+        return (remaining > 0.0f) ? remaining : 0.0f;
+    }
+
+    uint32_t TrajectoryPlanning::GetWaypoint()
+    {
+        float32_t s, l = 0.0f;
+        uint32_t i;
+
+        if(this->state != DRAWPLAN)
+            return 0u;
+
+        if((this->step != 4) && (this->step != 5))
+            return this->streamPassed + this->runStart;
+
+        // Segments of the run travelled (straight lengths)
+        s = odometry->GetLinearPosition() - this->runOrigin;
+        for(i = this->runStart; i < this->runEnd; i++)
+        {
+            l += this->length[i];
+            if(s < l)
+                break;
+        }
+
+        return this->streamPassed + i;
+    }
+
     float32_t TrajectoryPlanning::update()
     {
+        this->statsBegin();
+
         if( (this->state != FREE) && (this->state != STOP) )
         {
         	this->status |= (1<<8);
@@ -237,6 +584,10 @@ namespace MotionControl
                 calculateGoAngular();
                 break;
 
+            case ARC:
+                calculateArc();
+                break;
+
             case FREE:
             	calculateFree();
             	break;
@@ -249,6 +600,10 @@ namespace MotionControl
                 calculateKeepPosition();
                 break;
 
+            case BRAKE:
+                calculateBrake();
+                break;
+
             // semi-complex mouvements
             case LINEARPLAN:
                 calculateLinearPlan();
@@ -258,6 +613,10 @@ namespace MotionControl
                 calculateDrawPlan();
                 break;
 
+            case ROUTE:
+                calculateRoute();
+                break;
+
             // complex mouvements
             case CURVEPLAN:
                 calculateCurvePlan();
@@ -276,9 +635,133 @@ namespace MotionControl
                 break;
         }
 
+        // Order finished this cycle : reported now (next order may start)
+        if((this->state == FREE) || (this->state == STOP))
+        {
+            this->status &= ~(1<<8);
+            this->finished = true;
+        }
+
+        this->statsEnd();
+
 		return 0;
     }
 
+    bool TrajectoryPlanning::GetStateStats(uint32_t state, TP_STATE_STATS* stats)
+    {
+        if(state >= TP_STATES)
+            return false;
+
+        taskENTER_CRITICAL();
+        *stats = this->stateStats[state];
+        taskEXIT_CRITICAL();
+
+        return true;
+    }
+
+    void TrajectoryPlanning::ResetStateStats()
+    {
+        taskENTER_CRITICAL();
+        for(uint32_t i = 0; i < TP_STATES; i++)
+        {
+            this->stateStats[i].orders    = 0u;
+            this->stateStats[i].replaced  = 0u;
+            this->stateStats[i].cycles    = 0u;
+            this->stateStats[i].cyclesMax = 0u;
+            this->stateStats[i].time      = 0u;
+            this->stateStats[i].timeMax   = 0u;
+            this->stateStats[i].settled   = 0u;
+            this->stateStats[i].settle    = 0u;
+            this->stateStats[i].settleMax = 0u;
+        }
+        taskEXIT_CRITICAL();
+    }
+
+    const char* TrajectoryPlanning::GetStateName(uint32_t state)
+    {
+        return (state < TP_STATES) ? _stateNames[state] : "?";
+    }
+
+    void TrajectoryPlanning::statsBegin()
+    {
+        // New order : state changed, or step set back to 1 (same order again) since last cycle
+        if((this->state == this->statsState) && ((this->step != 1) || (this->statsStep == 1)))
+            return;
+
+        // FREE, STOP and KEEP hold until the next order : not replaced, idle time
+        this->statsRecord(Utils::Clock::GetMicros(),
+                          (this->statsState != FREE) && (this->statsState != STOP) && (this->statsState != KEEP));
+
+        // Previous order settling is given up
+        this->settleState = -1;
+    }
+
+    void TrajectoryPlanning::statsEnd()
+    {
+        uint32_t now = Utils::Clock::GetMicros();
+        int32_t finished = this->statsState;
+
+        this->statsCycles++;
+        this->statsStep = this->step;
+
+        if(this->state != this->statsState)
+        {
+            // Order finished : profile ended, robot settles from now
+            this->statsRecord(now, false);
+            this->settleState = finished;
+            this->settleStart = now;
+        }
+        else if(this->settleState >= 0)
+        {
+            float32_t linear  = abs(this->position->GetLinearPosition() - this->odometry->GetLinearPosition());
+            float32_t angular = abs(Utils::WrapPi(this->position->GetAngularPosition() - this->odometry->GetAngularPosition()));
+            uint32_t settle = now - this->settleStart;
+
+            if((linear <= TP_SETTLE_LINEAR) && (angular <= TP_SETTLE_ANGULAR))
+            {
+                TP_STATE_STATS* s = &this->stateStats[this->settleState];
+
+                settle /= 1000u;
+
+                taskENTER_CRITICAL();
+                s->settled++;
+                s->settle += settle;
+                if(settle > s->settleMax)
+                    s->settleMax = settle;
+                taskEXIT_CRITICAL();
+
+                this->settleState = -1;
+            }
+            else if(settle > TP_SETTLE_TIMEOUT_US)
+            {
+                this->settleState = -1;
+            }
+        }
+    }
+
+    void TrajectoryPlanning::statsRecord(uint32_t now, bool replaced)
+    {
+        TP_STATE_STATS* s = &this->stateStats[this->statsState];
+        uint32_t time = (now - this->statsStart) / 1000u;
+
+        taskENTER_CRITICAL();
+        s->orders++;
+        if(replaced)
+            s->replaced++;
+        s->cycles += this->statsCycles;
+        if(this->statsCycles > s->cyclesMax)
+            s->cyclesMax = this->statsCycles;
+        s->time += time;
+        if(time > s->timeMax)
+            s->timeMax = time;
+        taskEXIT_CRITICAL();
+
+        // Next order
+        this->statsState  = this->state;
+        this->statsStart  = now;
+        this->statsCycles = 0u;
+    }
+
     void TrajectoryPlanning::calculateGoLinear()
     {
         switch (step)
@@ -286,15 +769,14 @@ namespace MotionControl
             case 1:    // Set order
                 //this->profile->StartLinearPosition(this->linearSetPoint);
                 //this->profile->StartAngularPosition(odometry->GetAngularPosition());
-                this->position->SetLinearPosition(this->linearSetPoint);
-                this->position->SetAngularPosition(odometry->GetAngularPosition());
+                this->position->SetPosition(odometry->GetAngularPosition(), this->linearSetPoint);
                 //this->profile->StartLinearVelocity(this->linearSetPoint);
                 this->step = 2;
                 break;
 
             case 2:    // Check is arrived
                 //if(this->profile->isPositioningFinished())
-                if(this->position->isPositioningFinished())
+                if(this->position->isPositioningSettled())
                 {
                     this->step = 3;
                     this->state = FREE;
@@ -313,15 +795,36 @@ namespace MotionControl
             case 1:    // Set order
                 //this->profile->StartLinearPosition(odometry->GetLinearPosition());
                 //this->profile->StartAngularPosition(this->angularSetPoint);
-                this->position->SetLinearPosition(odometry->GetLinearPosition());
-                this->position->SetAngularPosition(this->angularSetPoint);
+                this->position->SetPosition(this->angularSetPoint, odometry->GetLinearPosition());
                 //this->profile->StartAngularVelocity(this->angularSetPoint);
                 this->step = 2;
                 break;
 
             case 2:    // Check is arrived
                 //if(this->profile->isPositioningFinished())
-                if(this->position->isPositioningFinished())
+                if(this->position->isPositioningSettled())
+                {
+                    this->step = 3;
+                    this->state = FREE;
+                }
+                break;
+
+            default:
+                break;
+        }
+    }
+
+    void TrajectoryPlanning::calculateArc()
+    {
+        switch (step)
+        {
+            case 1:    // Set both axes at once : profiles start together and are stretched to the same duration
+                this->position->SetPosition(this->angularSetPoint, this->linearSetPoint);
+                this->step = 2;
+                break;
+
+            case 2:    // Check is arrived
+                if(this->position->isPositioningSettled())
                 {
                     this->step = 3;
                     this->state = FREE;
@@ -353,18 +856,39 @@ namespace MotionControl
         //Do nothing else => Keeping position calculation on preview order
     }
 
+    void TrajectoryPlanning::calculateBrake()
+    {
+        switch (step)
+        {
+            case 1:    // Replan both axes to their stop points
+                this->position->Brake();
+                this->step = 2;
+                break;
+
+            case 2:    // Check is stopped
+                if(this->position->isPositioningFinished())
+                {
+                    this->step = 3;
+                    this->state = FREE;
+                }
+                break;
+
+            default:
+                break;
+        }
+    }
+
     void TrajectoryPlanning::calculateLinearPlan()
     {
         switch (step)
         {
             case 1:    // Start Angular Position
-                this->position->SetLinearPosition(odometry->GetLinearPosition());
-                this->position->SetAngularPosition(this->angularSetPoint);
+                this->position->SetPosition(this->angularSetPoint, odometry->GetLinearPosition());
                 step = 2;
                 break;
 
             case 2:
-                if(this->position->isPositioningFinished())
+                if(this->position->isPositioningSettled())
                 {
                     step = 3;
                 }
@@ -375,13 +899,15 @@ namespace MotionControl
                 break;
 
             case 4:    // Start Linear Position
-                this->position->SetLinearPosition(this->linearSetPoint);
-                this->position->SetAngularPosition(odometry->GetAngularPosition());
+                this->runOrigin = odometry->GetLinearPosition();
+                this->position->SetPosition(odometry->GetAngularPosition(), this->linearSetPoint);
                 step = 5;
                 break;
 
-            case 5:
-                if(this->position->isPositioningFinished())
+            case 5:    // Heading corrected toward the segment during translation
+                this->position->TrackAngularPosition(this->pursuitHeading(odometry->GetLinearPosition() - this->runOrigin));
+
+                if(this->position->isPositioningSettled())
                 {
                     step = 6;
                     this->state = FREE;
@@ -394,300 +920,907 @@ namespace MotionControl
 
     }
 
-    void TrajectoryPlanning::updateXYtoLA(uint32_t n)
+    void TrajectoryPlanning::preparePath()
     {
-        float32_t Xm, Ym, Lm;
-        float32_t XX, YY;
-        float32_t dX, dY;
         robot_t r;
-        uint32_t i;
 
         this->odometry->GetRobot(&r);
 
-        Xm = static_cast<float32_t>(r.Xmm) / 1000.0;
-        Ym = static_cast<float32_t>(r.Ymm) / 1000.0;
-        Lm = static_cast<float32_t>(r.Lmm) / 1000.0;
+        this->X[0] = static_cast<float32_t>(r.Xmm) / 1000.0f;
+        this->Y[0] = static_cast<float32_t>(r.Ymm) / 1000.0f;
+
+        this->prepareSegments(0, r.O);
+    }
+
+    void TrajectoryPlanning::prepareSegments(uint32_t first, float32_t previous)
+    {
+        float32_t dX, dY, h, turn, t;
+        uint32_t i, n = first;
 
-        XX = pow((this->X[n] - Xm), 2);
-        YY = pow((this->Y[n] - Ym), 2);
+        // Drop null segments (no heading)
+        for(i = first + 1; i <= this->XYn; i++)
+        {
+            dX = this->X[i] - this->X[n];
+            dY = this->Y[i] - this->Y[n];
+
+            if((dX*dX + dY*dY) > 1e-6f)
+            {
+                n++;
+                this->X[n] = this->X[i];
+                this->Y[n] = this->Y[i];
+            }
+        }
+        this->XYn = n;
 
-        dX = this->X[n] - Xm;   // meters
-        dY = this->Y[n] - Ym;   // meters
+        // Segments
+        for(i = first; i < n; i++)
+        {
+            dX = this->X[i+1] - this->X[i];
+            dY = this->Y[i+1] - this->Y[i];
 
-        this->linearSetPoint  = Lm + sqrtl(XX + YY); // meters
-        this->angularSetPoint = atan2f(dY,dX);  // radians
+            this->length[i] = Utils::Sqrt(dX*dX + dY*dY);
+            this->dirX[i] = dX / this->length[i];
+            this->dirY[i] = dY / this->length[i];
 
-        /* Faster path */
-        while( (this->angularSetPoint - r.O) > _PI_)
-            this->angularSetPoint -= _2_PI_;
-        while( (this->angularSetPoint - r.O) < -_PI_)
-            this->angularSetPoint += _2_PI_;
+            // Unwrapped heading : shortest rotation from previous one
+            h = Utils::Atan2(dY, dX);
+            turn = Utils::WrapPi(h - ((i == first) ? previous : this->heading[i-1]));
 
-        this->linearNextSetPoint  = this->linearSetPoint;
+            this->heading[i] = ((i == first) ? previous : this->heading[i-1]) + turn;
+        }
 
-        if(this->XYn >= 2)
+        // Corners : tangent distance of the blending arc, bounded by half segments,
+        // arc computed once here (run length, path point and velocity plan use it each period)
+        if(first == 0)
         {
-    for(i=n ; i < (this->XYn-1) ; i++)
-    {
-    XX = pow((this->X[i] - this->X[i-1]), 2);
-    YY = pow((this->Y[i] - this->Y[i-1]), 2);
-
-    this->linearSetPoint  += sqrtl(XX + YY);
-    }
+            this->tangent[0] = 0.0f;
+            this->radius[0] = 0.0f;
+            this->arc[0] = 0.0f;
+        }
+        this->tangent[n] = 0.0f;
+        this->radius[n] = 0.0f;
+        this->arc[n] = 0.0f;
+        for(i = ((first > 0) ? first : 1); i < n; i++)
+        {
+            turn = abs(this->heading[i] - this->heading[i-1]);
+
+            this->tangent[i] = 0.0f;
+            this->radius[i] = 0.0f;
+            this->arc[i] = 0.0f;
+
+            if((turn >= 1e-3f) && (turn <= TP_BLEND_ANGLE_MAX))
+            {
+                t = Utils::Tan(turn / 2.0f);
+
+                this->tangent[i] = TP_BLEND_RADIUS * t;
+                if(this->tangent[i] > (this->length[i-1] / 2.0f))
+                    this->tangent[i] = this->length[i-1] / 2.0f;
+                if(this->tangent[i] > (this->length[i] / 2.0f))
+                    this->tangent[i] = this->length[i] / 2.0f;
+
+                // Radius is tangent / tan(turn/2)
+                this->radius[i] = this->tangent[i] / t;
+                this->arc[i] = turn * this->radius[i];
+            }
         }
     }
 
-    void TrajectoryPlanning::calculateDrawPlan()
+    uint32_t TrajectoryPlanning::streamLoad()
     {
-        static uint32_t n = 0;
+        TP_STREAM_POINT p;
+        uint32_t n = 0;
 
-        float32_t currentLinearPosition = 0.0;
-
-        switch (step)
+        while(!this->streamEnded && (this->XYn < TP_PATH_MAX) && this->stream.Pop(p))
         {
-            case 1:    // Start Angular Position
-                n = 0;
-                step = 2;
-                this->updateXYtoLA(n);
-            //JRO    this->profile->StartLinearPosition(this->linearSetPoint);
-            //JRO    this->profile->StartAngularPosition(this->angularSetPoint);
-                /* no break */
-                //break;
+            this->XYn++;
+            this->X[this->XYn] = p.x;
+            this->Y[this->XYn] = p.y;
+            this->streamEnded = p.last;
+            n++;
+        }
 
-            case 2:
-                this->updateXYtoLA(n);
-                currentLinearPosition = odometry->GetLinearPosition();
-                if(abs(this->linearNextSetPoint - currentLinearPosition) <= 0.1)
+        return n;
+    }
+
+    void TrajectoryPlanning::streamShift()
+    {
+        float32_t s, part, travelled = 0.0f;
+        float32_t position = this->planPosition;
+        float32_t speed = this->planSpeed;
+        bool extend = (this->runEnd == this->XYn);
+        uint32_t i, k, first;
+
+        if(this->streamEnded || this->stream.IsEmpty())
+            return;
+
+        // Too close to the run end to blend its corner : points loaded once stopped
+        if(extend && ((this->planS[this->planN] - this->planPosition) < TP_BLEND_RADIUS))
+            return;
+
+        // Run segments (straight part and next arc) travelled by both the plan and the robot
+        s = odometry->GetLinearPosition() - this->runOrigin;
+        if(this->planPosition < s)
+            s = this->planPosition;
+        for(k = this->runStart; (k + 1) < this->runEnd; k++)
+        {
+            part = this->length[k] - this->tangent[k] - this->tangent[k+1] + this->arcLength(k + 1);
+            if(s < (travelled + part))
+                break;
+            travelled += part;
+        }
+
+        if((k == 0) && (this->XYn == TP_PATH_MAX))
+            return;
+
+        // Segments before k dropped, run origin moved to the start of segment k straight part
+        if(k > 0)
+        {
+            for(i = k; i <= this->XYn; i++)
+            {
+                this->X[i-k] = this->X[i];
+                this->Y[i-k] = this->Y[i];
+                this->tangent[i-k] = this->tangent[i];
+                this->radius[i-k] = this->radius[i];
+                this->arc[i-k] = this->arc[i];
+            }
+            for(i = k; i < this->XYn; i++)
+            {
+                this->heading[i-k] = this->heading[i];
+                this->length[i-k] = this->length[i];
+                this->dirX[i-k] = this->dirX[i];
+                this->dirY[i-k] = this->dirY[i];
+            }
+
+            this->XYn -= k;
+            this->runEnd -= k;
+            this->runStart = 0;
+            this->runOrigin += travelled;
+            position -= travelled;
+            this->streamPassed += k;
+        }
+
+        // New segments, former last point becomes a corner
+        first = this->XYn;
+        if(this->streamLoad() > 0)
+        {
+            this->prepareSegments(first, this->heading[first-1]);
+            if(extend)
+                this->runEnd = this->findRunEnd(this->runStart);
+        }
+
+        // Run replanned at current velocity, planned position kept
+        this->planRun(speed);
+        this->planPosition = position;
+        this->planSpeed = speed;
+    }
+
+    uint32_t TrajectoryPlanning::findRunEnd(uint32_t start)
+    {
+        uint32_t k;
+
+        for(k = start + 1; k < this->XYn; k++)
+        {
+            if(abs(this->heading[k] - this->heading[k-1]) > TP_BLEND_ANGLE_MAX)
+                return k;
+        }
+
+        return this->XYn;
+    }
+
+    float32_t TrajectoryPlanning::arcLength(uint32_t k)
+    {
+        return this->arc[k];
+    }
+
+    float32_t TrajectoryPlanning::runLength()
+    {
+        float32_t l = 0.0f;
+        uint32_t i;
+
+        for(i = this->runStart; i < this->runEnd; i++)
+        {
+            l += this->length[i] - this->tangent[i] - this->tangent[i+1];
+
+            if((i + 1) < this->runEnd)
+                l += this->arcLength(i + 1);
+        }
+
+        return l;
+    }
+
+    float32_t TrajectoryPlanning::pathHeading(float32_t s)
+    {
+        float32_t line, arc;
+        uint32_t i;
+
+        for(i = this->runStart; i < this->runEnd; i++)
+        {
+            // Straight part of segment i
+            line = this->length[i] - this->tangent[i] - this->tangent[i+1];
+            if(s <= line)
+                return this->heading[i];
+            s -= line;
+
+            // Arc on corner i+1 : heading blended at constant curvature
+            if((i + 1) < this->runEnd)
+            {
+                arc = this->arcLength(i + 1);
+                if((arc > 0.0f) && (s <= arc))
+                    return this->heading[i] + (this->heading[i+1] - this->heading[i]) * (s / arc);
+                s -= arc;
+            }
+        }
+
+        return this->heading[this->runEnd - 1];
+    }
+
+    void TrajectoryPlanning::pathPoint(float32_t s, float32_t* x, float32_t* y)
+    {
+        float32_t line, arc, radius, h;
+        float32_t sinH, cosH, sinI, cosI;
+        uint32_t i;
+
+        for(i = this->runStart; i < this->runEnd; i++)
+        {
+            // Straight part of segment i, from tangent point of corner i
+            line = this->length[i] - this->tangent[i] - this->tangent[i+1];
+            if((s <= line) || ((i + 1) == this->runEnd))
+            {
+                if(s > line)
+                    s = line;
+                *x = this->X[i] + (this->tangent[i] + s) * this->dirX[i];
+                *y = this->Y[i] + (this->tangent[i] + s) * this->dirY[i];
+                return;
+            }
+            s -= line;
+
+            // Arc on corner i+1 : constant curvature from tangent point (signed radius)
+            arc = this->arcLength(i + 1);
+            if((arc > 0.0f) && (s <= arc))
+            {
+                radius = arc / (this->heading[i+1] - this->heading[i]);
+                h = this->heading[i] + (this->heading[i+1] - this->heading[i]) * (s / arc);
+
+                Utils::SinCos(h, &sinH, &cosH);
+                sinI = this->dirY[i];
+                cosI = this->dirX[i];
+                *x = this->X[i+1] - this->tangent[i+1] * cosI + radius * (sinH - sinI);
+                *y = this->Y[i+1] - this->tangent[i+1] * sinI - radius * (cosH - cosI);
+                return;
+            }
+            s -= arc;
+        }
+
+        *x = this->X[this->runEnd];
+        *y = this->Y[this->runEnd];
+    }
+
+    float32_t TrajectoryPlanning::pursuitHeading(float32_t s)
+    {
+        float32_t h = this->pathHeading(s);
+        float32_t l = this->runLength();
+        float32_t x, y;
+
+        // Too close to the end : the goal point direction is not significant
+        if((l - s) < TP_PURSUIT_END)
+            return h;
+
+        s += TP_PURSUIT_LOOKAHEAD;
+        if(s > l)
+            s = l;
+
+        this->pathPoint(s, &x, &y);
+
+        return this->pursuit(h, x, y);
+    }
+
+    float32_t TrajectoryPlanning::curveHeading(float32_t s)
+    {
+        float32_t l = this->spline.GetLength();
+        float32_t x, y, h, gx, gy, gh;
+
+        this->spline.Evaluate(s, &x, &y, &h);
+
+        if((l - s) < TP_PURSUIT_END)
+            return h;
+
+        this->spline.Evaluate(s + TP_PURSUIT_LOOKAHEAD, &gx, &gy, &gh);
+
+        return this->pursuit(h, gx, gy);
+    }
+
+    float32_t TrajectoryPlanning::pursuit(float32_t h, float32_t x, float32_t y)
+    {
+        float32_t turn;
+        robot_t r;
+
+        this->odometry->GetRobot(&r);
+
+        // Goal point direction, unwrapped around path heading
+        turn = Utils::WrapPi(Utils::Atan2(y - static_cast<float32_t>(r.Ymm) / 1000.0f, x - static_cast<float32_t>(r.Xmm) / 1000.0f) - h);
+
+        return h + turn;
+    }
+
+    void TrajectoryPlanning::planRun(float32_t start)
+    {
+        float32_t line, arc;
+        float32_t vMax = this->position->GetLinearVelMax();
+        uint32_t i, n = 0;
+
+        this->planAcc = this->position->GetLinearAccMax();
+        this->planS[0] = 0.0f;
+
+        // Intervals : straight part at max velocity, arc bounded by its curvature
+        for(i = this->runStart; i < this->runEnd; i++)
+        {
+            line = this->length[i] - this->tangent[i] - this->tangent[i+1];
+            this->planVmax[n] = vMax;
+            this->planS[n+1] = this->planS[n] + line;
+            n++;
+
+            if((i + 1) < this->runEnd)
+            {
+                arc = this->arcLength(i + 1);
+                if(arc > 0.0f)
                 {
+                    this->planVmax[n] = this->curvatureVelocity(1.0f / this->radius[i+1]);
+                    this->planS[n+1] = this->planS[n] + arc;
                     n++;
-                    step = 2;
-                    if(n >= this->XYn-1)
-                    {
-                        step = 3;
-                    }
-                    this->updateXYtoLA(n);
-             //JRO       this->profile->StartAngularPosition(this->angularSetPoint);
                 }
+            }
+        }
+        this->planN = n;
+
+        this->planPasses(start);
+    }
+
+    void TrajectoryPlanning::planCurve()
+    {
+        uint32_t i;
+
+        this->planAcc = this->position->GetLinearAccMax();
+        this->planS[0] = 0.0f;
+
+        // One interval by spline segment, bounded by its maximum curvature
+        for(i = 0; i < this->spline.GetSegments(); i++)
+        {
+            this->planVmax[i] = this->curvatureVelocity(this->spline.GetCurvatureMax(i));
+            this->planS[i+1] = this->spline.GetSegmentEnd(i);
+        }
+        this->planN = this->spline.GetSegments();
+
+        this->planPasses(0.0f);
+    }
+
+    float32_t TrajectoryPlanning::curvatureVelocity(float32_t curvature)
+    {
+        float32_t v = this->position->GetLinearVelMax();
+
+        if(curvature > 1e-6f)
+        {
+            if((this->position->GetAngularVelMax() / curvature) < v)
+                v = this->position->GetAngularVelMax() / curvature;
+            if(Utils::Sqrt(TP_LATERAL_ACC_MAX / curvature) < v)
+                v = Utils::Sqrt(TP_LATERAL_ACC_MAX / curvature);
+        }
+
+        return v;
+    }
+
+    void TrajectoryPlanning::planPasses(float32_t start)
+    {
+        float32_t v, limit;
+        uint32_t k, n = this->planN;
+
+        // Forward pass : reachable velocity at each bound (run starts at start velocity, ends at rest)
+        this->planV[0] = (start < this->planVmax[0]) ? start : this->planVmax[0];
+        for(k = 1; k <= n; k++)
+        {
+            limit = (k < n) ? this->planVmax[k] : 0.0f;
+            if(this->planVmax[k-1] < limit)
+                limit = this->planVmax[k-1];
+
+            v = Utils::Sqrt(this->planV[k-1] * this->planV[k-1] + 2.0f * this->planAcc * (this->planS[k] - this->planS[k-1]));
+            this->planV[k] = (v < limit) ? v : limit;
+        }
+
+        // Backward pass : velocity from which next bounds can still be reached
+        for(k = n; k > 0; k--)
+        {
+            v = Utils::Sqrt(this->planV[k] * this->planV[k] + 2.0f * this->planAcc * (this->planS[k] - this->planS[k-1]));
+            if(v < this->planV[k-1])
+                this->planV[k-1] = v;
+        }
+
+        this->planPosition = 0.0f;
+        this->planSpeed = this->planV[0];
+    }
+
+    float32_t TrajectoryPlanning::plannedVelocity(float32_t s)
+    {
+        float32_t v, accel, decel;
+        uint32_t k;
+
+        for(k = 0; k < this->planN; k++)
+        {
+            if((s < this->planS[k+1]) || ((k + 1) == this->planN))
                 break;
+        }
+
+        if(k >= this->planN)
+            return 0.0f;
+
+        // Interval limit, acceleration from its start, deceleration to its end
+        v = this->planVmax[k];
+
+        accel = this->planV[k] * this->planV[k] + 2.0f * this->planAcc * (s - this->planS[k]);
+        decel = this->planV[k+1] * this->planV[k+1] + 2.0f * this->planAcc * (this->planS[k+1] - s);
+
+        if((accel >= 0.0f) && (Utils::Sqrt(accel) < v))
+            v = Utils::Sqrt(accel);
+        if(decel <= 0.0f)
+            v = 0.0f;
+        else if(Utils::Sqrt(decel) < v)
+            v = Utils::Sqrt(decel);
+
+        return v;
+    }
+
+    void TrajectoryPlanning::routeSample(float32_t s, ROUTE_SAMPLE* sample)
+    {
+        const ROUTE_SAMPLE* samples = this->routeDef->SAMPLES;
+        uint32_t lo = 0, hi = this->routeDef->COUNT - 1u, k;
+        float32_t f;
+
+        // Samples interval holding s (bisection, clamped to route ends)
+        while((hi - lo) > 1u)
+        {
+            k = (lo + hi) / 2u;
+            if(samples[k].s <= s)
+                lo = k;
+            else
+                hi = k;
+        }
+
+        f = (s - samples[lo].s) / (samples[hi].s - samples[lo].s);
+        if(f < 0.0f)
+            f = 0.0f;
+        if(f > 1.0f)
+            f = 1.0f;
+
+        sample->s        = s;
+        sample->x        = samples[lo].x + (samples[hi].x - samples[lo].x) * f;
+        sample->y        = samples[lo].y + (samples[hi].y - samples[lo].y) * f;
+        sample->heading  = samples[lo].heading + (samples[hi].heading - samples[lo].heading) * f + this->routeOffset;
+        sample->velocity = samples[lo].velocity + (samples[hi].velocity - samples[lo].velocity) * f;
+    }
+
+    float32_t TrajectoryPlanning::routeHeading(float32_t s)
+    {
+        float32_t l = this->routeDef->SAMPLES[this->routeDef->COUNT - 1u].s;
+        ROUTE_SAMPLE here, goal;
+
+        this->routeSample(s, &here);
+
+        if((l - s) < TP_PURSUIT_END)
+            return here.heading;
+
+        this->routeSample((s + TP_PURSUIT_LOOKAHEAD < l) ? (s + TP_PURSUIT_LOOKAHEAD) : l, &goal);
+
+        return this->pursuit(here.heading, goal.x, goal.y);
+    }
+
+    bool TrajectoryPlanning::advancePlan(float32_t velocity, float32_t end)
+    {
+        // Plan clock follows position control velocity override
+        float32_t k = this->position->GetVelocityOverride();
+        float32_t dt = TP_PERIOD_S * k;
+        float32_t v = this->planSpeed + this->planAcc * dt;
+        float32_t acc = 0.0f;
+
+        if(velocity < v)
+            v = velocity;
+        if(v < TP_PLAN_VEL_MIN)
+            v = TP_PLAN_VEL_MIN;
+
+        if(dt > 0.0f)
+            acc = (v - this->planSpeed) / dt;
+        this->planPosition += 0.5f * (this->planSpeed + v) * dt;
+        this->planSpeed = v;
+
+        if(this->planPosition >= (end - TP_PLAN_END))
+        {
+            this->planPosition = end;
+            this->planSpeed = 0.0f;
+            acc = 0.0f;
+        }
 
-            case 3:    /* Last coordinate */
-                this->updateXYtoLA(n);
-                currentLinearPosition = odometry->GetLinearPosition();
+        this->position->TrackLinearPosition(this->runOrigin + this->planPosition, this->planSpeed * k, acc * k * k);
 
-                if(abs(this->linearSetPoint - currentLinearPosition) <= 0.1)
+        return (this->planPosition >= end);
+    }
+
+    void TrajectoryPlanning::calculateDrawPlan()
+    {
+        float32_t s = 0.0f;
+
+        switch (step)
+        {
+            case 1:    // Compute path from current location
+                if(this->streaming)
+                    this->streamLoad();
+
+                this->preparePath();
+                this->runStart = 0;
+
+                if(this->XYn == 0)
+                {
+                    // Streamed path : wait for the next points, until the last one
+                    if(this->streaming && !this->streamEnded)
+                        break;
+
+                    this->streaming = false;
+                    this->state = FREE;
+                    break;
+                }
+                step = 2;
+                /* no break */
+
+            case 2:    // Rotate in place to run heading
+                this->runEnd = this->findRunEnd(this->runStart);
+                this->position->SetPosition(this->heading[this->runStart], odometry->GetLinearPosition());
+                step = 3;
+                break;
+
+            case 3:    // Start run : velocity planned on the whole blended run
+                if(this->position->isPositioningSettled())
                 {
+                    this->runOrigin = odometry->GetLinearPosition();
+                    this->planRun(0.0f);
                     step = 4;
                 }
                 break;
 
-            case 4:    /* Finishing last coordinate */
-                this->updateXYtoLA(n);
-                currentLinearPosition = odometry->GetLinearPosition();
-                //JRO if(this->profile->isPositioningFinished() || (abs(this->linearSetPoint - currentLinearPosition) <= 0.01))
+            case 4:    // Follow planned velocity, heading corrects lateral drift
+                if(this->streaming)
+                    this->streamShift();
+
+                s = odometry->GetLinearPosition() - this->runOrigin;
+                this->position->TrackAngularPosition(this->pursuitHeading(s));
+
+                if(this->advancePlan(this->plannedVelocity(this->planPosition), this->planS[this->planN]))
                 {
+                    // Run end at rest : linear profile holds it
+                    this->position->SetLinearPosition(this->runOrigin + this->planPosition);
                     step = 5;
-                    this->state = FREE;
+                }
+                break;
+
+            case 5:    // Settle on run end
+                s = odometry->GetLinearPosition() - this->runOrigin;
+                this->position->TrackAngularPosition(this->pursuitHeading(s));
+
+                if(this->position->isPositioningSettled())
+                {
+                    if((this->runEnd >= this->XYn) && this->streaming && !this->streamEnded)
+                    {
+                        // Stream starved : path restarts from here with the next points
+                        this->streamPassed += this->XYn;
+                        this->XYn = 0;
+                        step = 1;
+                    }
+                    else if(this->runEnd >= this->XYn)
+                    {
+                        step = 6;
+                        this->streaming = false;
+                        this->state = FREE;
+                    }
+                    else
+                    {
+                        // Sharp corner
+                        this->runStart = this->runEnd;
+                        step = 2;
+                    }
                 }
                 break;
 
             default:
                 break;
         }
+    }
+
+    void TrajectoryPlanning::calculateRoute()
+    {
+        const ROUTE_SAMPLE* last = &this->routeDef->SAMPLES[this->routeDef->COUNT - 1u];
+        ROUTE_SAMPLE sample;
+        float32_t s = 0.0f;
 
         switch (step)
         {
-            case 1:
+            case 1:    // Rotate in place to route start heading
+                this->position->SetPosition(this->routeDef->SAMPLES[0].heading + this->routeOffset, odometry->GetLinearPosition());
+                step = 2;
                 break;
 
-            case 2:
-            //JRO    this->profile->SetLinearPosition(this->linearSetPoint);
-            //JRO    this->profile->SetAngularPosition(this->angularSetPoint);
+            case 2:    // Start route : velocity profile is read from samples
+                if(this->position->isPositioningSettled())
+                {
+                    this->runOrigin = odometry->GetLinearPosition();
+                    this->planAcc = this->position->GetLinearAccMax();
+                    this->planPosition = 0.0f;
+                    this->planSpeed = 0.0f;
+                    step = 3;
+                }
                 break;
 
-            case 3:
-            //JRO    this->profile->SetLinearPosition(this->linearSetPoint);
-            //JRO    this->profile->SetAngularPosition(this->angularSetPoint);
+            case 3:    // Follow route velocity, heading corrects lateral drift
+                s = odometry->GetLinearPosition() - this->runOrigin;
+                this->position->TrackAngularPosition(this->routeHeading(s));
+
+                this->routeSample(this->planPosition, &sample);
+                if(this->advancePlan(sample.velocity, last->s))
+                {
+                    this->position->SetLinearPosition(this->runOrigin + this->planPosition);
+                    step = 4;
+                }
                 break;
 
-            case 4:
-            //JRO    this->profile->SetLinearPosition(this->linearSetPoint);
-            //JRO    this->profile->SetAngularPosition(this->angularSetPoint);
+            case 4:    // Settle on route end
+                s = odometry->GetLinearPosition() - this->runOrigin;
+                this->position->TrackAngularPosition(this->routeHeading(s));
+
+                if(this->position->isPositioningSettled())
+                {
+                    step = 5;
+                    this->state = FREE;
+                }
                 break;
 
             default:
                 break;
         }
-
     }
 
     void TrajectoryPlanning::calculateCurvePlan()
     {
-        //TODO: Curve Plan : Need both MotionProfile synchronized
-    }
-
-
-    void TrajectoryPlanning::calculateStallX(int32_t mode)
-    {
-        float32_t time = getTime();
-        time -= startTime;
-
-        float32_t profile = 0.0;
-
-        //TODO:Add stallMode gestion
-        bool jackBackLeft  = true;
-        bool jackBackRight = true;
+        float32_t s = 0.0f;
+        robot_t r;
 
         switch (step)
         {
-            case 1:
-                //JRO if(this->profile->isPositioningFinished())
-                    step = 2;
-                break;
+            case 1:    // Spline from robot pose, tangent to robot heading
+                this->odometry->GetRobot(&r);
+                this->X[0] = static_cast<float32_t>(r.Xmm) / 1000.0f;
+                this->Y[0] = static_cast<float32_t>(r.Ymm) / 1000.0f;
 
-            case 2:
-                if(jackBackLeft && jackBackRight)
-                    step = 3;
-                break;
+                if(!this->spline.Load(this->X, this->Y, this->XYn + 1u, r.O))
+                {
+                    this->state = FREE;
+                    break;
+                }
 
-            case 3:
-                // X axis and Angular are calibrated
+                this->planCurve();
+                this->runOrigin = odometry->GetLinearPosition();
+                this->position->SetPosition(r.O, this->runOrigin);
+                step = 2;
                 break;
 
-            default:
-                break;
-        }
+            case 2:    // Follow planned velocity, heading corrects lateral drift
+                s = odometry->GetLinearPosition() - this->runOrigin;
+                this->position->TrackAngularPosition(this->curveHeading(s));
 
-        switch (step)
-        {
-            case 1: // Rotate to 0 rad
-                this->position->SetAngularPosition(0.0);
+                if(this->advancePlan(this->plannedVelocity(this->planPosition), this->planS[this->planN]))
+                {
+                    this->position->SetLinearPosition(this->runOrigin + this->planPosition);
+                    step = 3;
+                }
                 break;
 
-            case 2:
-                //TODO:Disable Angular asserv.
-                //TODO:Back and wait both jacks
-                break;
+            case 3:    // Settle on curve end
+                s = odometry->GetLinearPosition() - this->runOrigin;
+                this->position->TrackAngularPosition(this->curveHeading(s));
 
-            case 3:
-                //TODO:Modify X et O value in function of the mechanic
-                odometry->SetXO(0.0, 0.0);
+                if(this->position->isPositioningSettled())
+                {
+                    step = 4;
+                    this->state = FREE;
+                }
                 break;
 
             default:
                 break;
         }
+    }
 
+
+    void TrajectoryPlanning::INTERNAL_Bumper()
+    {
+        // Both pressed : robot square against the border
+        if((this->bumperL->Get() == HAL::GPIO::Low) && (this->bumperR->Get() == HAL::GPIO::Low))
+            this->bumped = true;
     }
 
-    void TrajectoryPlanning::calculateStallY(int32_t mode)
+    uint32_t TrajectoryPlanning::detectContact()
     {
-        float32_t time = getTime();
-        time -= startTime;
+        uint32_t source = 0u;
+        uint32_t pending = 0u;
+
+        // Immediate : bumpers, drivers stall
+        if(this->bumped)
+            source |= TP_STALL_BUMPER;
 
-        float32_t profile = 0.0;
+        if(this->position->isStalled())
+            source |= TP_STALL_DRIVER;
 
+        // Confirmed over periods, once backing has started
+        if((this->startLinearPosition - odometry->GetLinearPosition()) > TP_STALL_ARM_M)
+        {
+            if((fabsf(odometry->GetLinearVelocityFiltered()) < TP_STALL_VEL_MIN) && !this->position->isPositioningDecelerating())
+                pending |= TP_STALL_VELOCITY;
+
+            if((fabsf(this->position->GetLeftSlip()) > TP_STALL_SLIP_M) && (fabsf(this->position->GetRightSlip()) > TP_STALL_SLIP_M))
+                pending |= TP_STALL_MISMATCH;
+        }
+
+        this->stallConfirm = (pending != 0u) ? (this->stallConfirm + 1u) : 0u;
+
+        if(this->stallConfirm >= TP_STALL_CONFIRM)
+            source |= pending;
+
+        this->stallSource = source;
+
+        return source;
+    }
+
+    void TrajectoryPlanning::calculateStallX(int32_t mode)
+    {
         //TODO:Add stallMode gestion
-        bool jackBackLeft  = true;
-        bool jackBackRight = true;
 
         switch (step)
         {
-            case 1:
-                //JRO if(this->profile->isPositioningFinished())
-                    step = 2;
+            case 1: // Rotate to 0 rad
+                this->position->SetAngularPosition(0.0f);
+                this->step = 2;
                 break;
 
-            case 2:
-                if(jackBackLeft && jackBackRight)
-                    step = 3;
+            case 2: // Back until both wheels are against the border
+                if(this->position->isPositioningSettled())
+                {
+                    this->position->ClearStall();
+                    this->position->ClearSlip();
+                    this->startLinearPosition = odometry->GetLinearPosition();
+                    this->position->SetLinearPosition(this->startLinearPosition - TP_STALL_DISTANCE);
+                    this->startTime = getTime();
+                    this->bumped = false;
+                    this->stallConfirm = 0u;
+                    this->stallSource = 0u;
+                    this->step = 3;
+                }
                 break;
 
-            case 3:
-                // Y axis and Angular are calibrated
+            case 3: // Contact : reset as soon as it is confirmed (see detectContact())
+                if(this->detectContact() != 0u)
+                {
+                    //TODO:Modify X et O value in function of the mechanic
+                    odometry->GetRobot(&this->stallContact);
+                    this->stallContacted = true;
+                    odometry->SetXO(0.0f, 0.0f);
+                    this->position->ClearStall();
+                    // Odometry reset : integrators hold the previous pose, restart them
+                    this->position->SetLinearPosition(odometry->GetLinearPosition(), true);
+                    this->step = 4;
+                    this->state = FREE;
+                }
+                else if(this->position->isPositioningFinished() || ((getTime() - this->startTime) > TP_STALL_TIMEOUT_S))
+                {
+                    // No border in range : not calibrated
+                    this->position->ClearStall();
+                    this->step = 4;
+                    this->state = FREE;
+                }
                 break;
 
             default:
                 break;
         }
+    }
+
+    void TrajectoryPlanning::calculateStallY(int32_t mode)
+    {
+        //TODO:Add stallMode gestion
 
         switch (step)
         {
             case 1: // Rotate to pi/2 rad
-                this->position->SetAngularPosition(_PI_/2.0);
+                this->position->SetAngularPosition(_PI_/2.0f);
+                this->step = 2;
                 break;
 
-            case 2:
-                //TODO:Disable Angular asserv.
-                //TODO:Back and wait both jacks
+            case 2: // Back until both wheels are against the border
+                if(this->position->isPositioningSettled())
+                {
+                    this->position->ClearStall();
+                    this->position->ClearSlip();
+                    this->startLinearPosition = odometry->GetLinearPosition();
+                    this->position->SetLinearPosition(this->startLinearPosition - TP_STALL_DISTANCE);
+                    this->startTime = getTime();
+                    this->bumped = false;
+                    this->stallConfirm = 0u;
+                    this->stallSource = 0u;
+                    this->step = 3;
+                }
                 break;
 
-            case 3:
-                //TODO:Modify Y value in function of the mechanic
-                odometry->SetYO(0.0, _PI_/2.0);
+            case 3: // Contact : reset as soon as it is confirmed (see detectContact())
+                if(this->detectContact() != 0u)
+                {
+                    //TODO:Modify Y value in function of the mechanic
+                    odometry->GetRobot(&this->stallContact);
+                    this->stallContacted = true;
+                    odometry->SetYO(0.0f, _PI_/2.0f);
+                    this->position->ClearStall();
+                    // Odometry reset : integrators hold the previous pose, restart them
+                    this->position->SetLinearPosition(odometry->GetLinearPosition(), true);
+                    this->step = 4;
+                    this->state = FREE;
+                }
+                else if(this->position->isPositioningFinished() || ((getTime() - this->startTime) > TP_STALL_TIMEOUT_S))
+                {
+                    // No border in range : not calibrated
+                    this->position->ClearStall();
+                    this->step = 4;
+                    this->state = FREE;
+                }
                 break;
 
             default:
                 break;
         }
-
     }
 
     void TrajectoryPlanning::Compute(float32_t period)
     {
         this->status |= (1<<0);
 
+        // Stream order replaced : its points left are dropped (consumer side)
+        if(this->streaming && (this->state != DRAWPLAN))
+        {
+            this->stream.Clear();
+            this->streaming = false;
+        }
+
         this->update();
     }
 
     void TrajectoryPlanning::taskHandler(void* obj)
     {
-        TickType_t xLastWakeTime;
-        TickType_t xFrequency = pdMS_TO_TICKS(TP_TASK_PERIOD_MS);
-
         TrajectoryPlanning* instance = _trajectoryPlanning;
-        TickType_t prevTick = 0u,  tick = 0u;
 
         float32_t period = 0.0f;
 
-        // 1. Initialize periodical task
-        xLastWakeTime = xTaskGetTickCount();
-
-        // 2. Get tick count
-        prevTick = xTaskGetTickCount();
+        // 1. Initialise periodical task
+        instance->periodic.Start();
 
         while(1)
         {
-            // 2. Wait until period elapse
-            vTaskDelayUntil(&xLastWakeTime, xFrequency);
-
-            // 3. Get tick
-            tick = xTaskGetTickCount();
+            // 2. Wait until period elapse, get elapsed ticks
+            period = instance->periodic.Wait();
 
-            period = static_cast<float32_t>(tick) -
-                     static_cast<float32_t>(prevTick);
-
-            //4. Compute profile (ProfileGenerator)
+            //4. Compute trajectory planning
+            instance->profiler.Start();
             instance->Compute(period);
-
-            // 5. Set previous tick
-            prevTick = tick;
+            instance->profiler.Stop();
         }
     }
 
     float32_t TrajectoryPlanning::getTime()
     {
-        float32_t time = 0.0;
-
-        time = static_cast<float32_t>(xTaskGetTickCount());
-        time /= 1000.0;
-
-        return  time;
+        return Utils::Clock::GetSeconds();
     }
 
     float32_t TrajectoryPlanning::abs(float32_t val)
     {
-        if(val < 0.0)
-            val = -val;
-        return val;
+        return Utils::Abs(val);
     }
 }
@@ -9,14 +9,18 @@
 #include <stdlib.h>
 
 #include "../../STM32_Driver/inc/stm32f4xx.h"
-#include "common.h"
+#include "common.h"
 #include "FreeRTOS.h"
 #include "task.h"
 
 #include "HAL.hpp"
 
+#include "Clock.hpp"
 #include "Diag.hpp"
 #include "Cli.hpp"
+#include "I2CProtocol.hpp"
+#include "ActuatorControl.hpp"
+#include "TaskTable.hpp"
 
 #include "../../STM32_Driver/inc/stm32f4xx_it.h"
 
@@ -32,75 +36,50 @@
 
 #include "Telemeter.hpp"
 
+#include "Bench.hpp"
+#include "Boot.hpp"
+#include "Power.hpp"
+#include "Retain.hpp"
+#include "Robot.hpp"
+
 using namespace HAL;
 using namespace Utils;
 
 
-extern "C" void hard_fault_handler_c(unsigned int * hardfault_args)
-{
-      unsigned int stacked_r0;
-      unsigned int stacked_r1;
-      unsigned int stacked_r2;
-      unsigned int stacked_r3;
-      unsigned int stacked_r12;
-      unsigned int stacked_lr;
-      unsigned int stacked_pc;
-      unsigned int stacked_psr;
-
-      stacked_r0 = ((unsigned long) hardfault_args[0]);
-      stacked_r1 = ((unsigned long) hardfault_args[1]);
-      stacked_r2 = ((unsigned long) hardfault_args[2]);
-      stacked_r3 = ((unsigned long) hardfault_args[3]);
-
-      stacked_r12 = ((unsigned long) hardfault_args[4]);
-      stacked_lr = ((unsigned long) hardfault_args[5]);
-      stacked_pc = ((unsigned long) hardfault_args[6]);
-      stacked_psr = ((unsigned long) hardfault_args[7]);
-
-      /*printf ("\r\n\r\n[Hard fault handler - all numbers in hex]\r\n");
-      printf ("R0 = %x\r\n", stacked_r0);
-      printf ("R1 = %x\r\n", stacked_r1);
-      printf ("R2 = %x\r\n", stacked_r2);
-      printf ("R3 = %x\r\n", stacked_r3);
-      printf ("R12 = %x\r\n", stacked_r12);
-      printf ("LR [R14] = %x  subroutine call return address\r\n", stacked_lr);
-      printf ("PC [R15] = %x  program counter\r\n", stacked_pc);
-      printf ("PSR = %x\r\n", stacked_psr);
-      printf ("BFAR = %x\r\n", (*((volatile unsigned long *)(0xE000ED38))));
-      printf ("CFSR = %x\r\n", (*((volatile unsigned long *)(0xE000ED28))));
-      printf ("HFSR = %x\r\n", (*((volatile unsigned long *)(0xE000ED2C))));
-      printf ("DFSR = %x\r\n", (*((volatile unsigned long *)(0xE000ED30))));
-      printf ("AFSR = %x\r\n", (*((volatile unsigned long *)(0xE000ED3C))));
-      printf ("SCB_SHCSR = %x\r\n", SCB->SHCSR);*/
-
-      while (1);
-}
-void HardFault_Handler(void)
-{
-__ASM(".extern hard_fault_handler_c");
-__ASM("TST LR, #4");
-__ASM("ITE EQ");
-__ASM("MRSEQ R0, MSP");
-__ASM("MRSNE R0, PSP");
-__ASM("B hard_fault_handler_c");
-}
-
-void BusFault_Handler(void)
+/**
+ * @brief Fault handlers common part : record the crash, reset (see Utils::Crash)
+ * @param frame : Stacked exception frame
+ * @param excReturn : Handler LR (EXC_RETURN)
+ */
+extern "C" void hard_fault_handler_c(unsigned int * frame, unsigned int excReturn)
 {
-    while(1);
-}
-void MemManage_Handler(void)
-{
-    while(1);
+    Utils::Crash::Fault(reinterpret_cast<const uint32_t*>(frame), excReturn);
 }
+
+/**
+ * @brief Fault handler : stacked frame from the crashed context stack (MSP or PSP)
+ */
+#define FAULT_HANDLER(name)                     \
+    __attribute__((naked)) void name(void)      \
+    {                                           \
+        __ASM volatile (                        \
+            "TST LR, #4                 \n"     \
+            "ITE EQ                     \n"     \
+            "MRSEQ R0, MSP              \n"     \
+            "MRSNE R0, PSP              \n"     \
+            "MOV R1, LR                 \n"     \
+            "B hard_fault_handler_c     \n");   \
+    }
+
+FAULT_HANDLER(HardFault_Handler)
+FAULT_HANDLER(BusFault_Handler)
+FAULT_HANDLER(MemManage_Handler)
+FAULT_HANDLER(UsageFault_Handler)
+
 void WWDG_IRQHandler(void)
 {
     while(1);
 }
-void UsageFault_Handler(void)
-{
-    while(1);
-}
 
 
 TaskHandle_t xHandleTraces;
@@ -116,37 +95,48 @@ static void HardwareInit (void)
     // Enable all GPIO clock
     RCC_AHB1PeriphClockCmd((RCC_AHB1Periph_GPIOA | RCC_AHB1Periph_GPIOB | RCC_AHB1Periph_GPIOC |
                             RCC_AHB1Periph_GPIOD | RCC_AHB1Periph_GPIOE | RCC_AHB1Periph_GPIOF |
-                            RCC_AHB1Periph_GPIOG | RCC_AHB1Periph_GPIOH | RCC_AHB1Periph_GPIOI),
+                            RCC_AHB1Periph_GPIOG | RCC_AHB1Periph_GPIOH | RCC_AHB1Periph_GPIOI |
+                            RCC_AHB1Periph_DMA1  | RCC_AHB1Periph_DMA2  | RCC_AHB1Periph_CRC),
                             ENABLE);
 
     // Enable Timer clock
-    RCC_APB1PeriphClockCmd(RCC_APB1Periph_TIM2 | RCC_APB1Periph_TIM3 | RCC_APB1Periph_TIM4 | RCC_APB1Periph_TIM5 | RCC_APB1Periph_TIM7 | RCC_APB1Periph_TIM12,
+    RCC_APB1PeriphClockCmd(RCC_APB1Periph_TIM2 | RCC_APB1Periph_TIM3 | RCC_APB1Periph_TIM4 | RCC_APB1Periph_TIM5 | RCC_APB1Periph_TIM6 | RCC_APB1Periph_TIM7 | RCC_APB1Periph_TIM12 | RCC_APB1Periph_TIM14,
                            ENABLE);
     RCC_APB2PeriphClockCmd(RCC_APB2Periph_TIM1 | RCC_APB2Periph_TIM8 | RCC_APB2Periph_TIM9 | RCC_APB2Periph_SPI1,
                            ENABLE);
 
+    // Enable EXTI line mapping clock
+    RCC_APB2PeriphClockCmd(RCC_APB2Periph_SYSCFG, ENABLE);
+
     // Enable USART Clock
 	RCC_APB1PeriphClockCmd(RCC_APB1Periph_USART3, ENABLE);
     RCC_APB2PeriphClockCmd(RCC_APB2Periph_USART1, ENABLE);
 
+    // Enable CAN Clock (CAN1 owns the filter banks)
+    RCC_APB1PeriphClockCmd(RCC_APB1Periph_CAN1, ENABLE);
+
+    // Enable I2C master Clock
+    RCC_APB1PeriphClockCmd(RCC_APB1Periph_I2C1, ENABLE);
+
+    // Enable USB OTG FS Clock (48 MHz from PLLSAI, see UsbCdc)
+    RCC_AHB2PeriphClockCmd(RCC_AHB2Periph_OTG_FS, ENABLE);
+
     // A/D Converter Clock
     RCC_APB2PeriphClockCmd(RCC_APB2Periph_ADC | RCC_APB2Periph_ADC1 | RCC_APB2Periph_ADC2 | RCC_APB2Periph_ADC3,
                            ENABLE);
+
+    // Sleep mode from idle task
+    Power::Init();
 }
 
 float32_t getTime()
 {
-    float32_t time = 0.0;
-
-    time = static_cast<float32_t>(xTaskGetTickCount());
-    time /= 1000.0;
-
-    return  time;
+    return Utils::Clock::GetSeconds();
 }
 
 float32_t abso(float32_t val)
 {
-    if(val < 0.0)
+    if(val < 0.0f)
         val = -val;
     return val;
 }
@@ -162,10 +152,10 @@ void TestEvent (void * obj)
 /**
  * @brief Main task handler
  */
-void TASKHANDLER_Test (void * obj)
+static void TASKHANDLER_Test (void * obj)
 {
     TickType_t xLastWakeTime;
-    const TickType_t xFrequency = pdMS_TO_TICKS(100u);
+    const TickType_t xFrequency = pdMS_TO_TICKS(TASK_TEST_PERIOD_MS);
 
     // Get instances
 //    HAL::GPIO *led1 = HAL::GPIO::GetInstance(HAL::GPIO::GPIO0);
@@ -173,10 +163,10 @@ void TASKHANDLER_Test (void * obj)
 //    HAL::GPIO *led3 = HAL::GPIO::GetInstance(HAL::GPIO::GPIO2);
 //    HAL::GPIO *led4 = HAL::GPIO::GetInstance(HAL::GPIO::GPIO3);
 
-    HAL::GPIO *topz = HAL::GPIO::GetInstance(HAL::GPIO::GPIO72);
+    HAL::DigitalInput *topz = HAL::DigitalInput::GetInstance(HAL::DigitalInput::INPUT16);
 
-	Drv8813* drv1 = Drv8813::GetInstance(Drv8813::DRV8813_1);
-	Drv8813* drv2 = Drv8813::GetInstance(Drv8813::DRV8813_4);
+	Drv8813* drv1 = Drv8813::GetInstance(Robot::Config::WHEEL_RIGHT);
+	Drv8813* drv2 = Drv8813::GetInstance(Robot::Config::WHEEL_LEFT);
 
     ExtDAC* dac = ExtDAC::GetInstance(ExtDAC::EXTDAC0);
 
@@ -189,16 +179,6 @@ void TASKHANDLER_Test (void * obj)
     Mandible* man = Mandible::GetInstance(Mandible::ID::MANDIBLE_1);
     ADConverter* adc = ADConverter::GetInstance(ADConverter::ADC_Channel2);
 
-	// TODO PHASE INIT
-    drv1->SetSpeedStep(0);
-    drv2->SetSpeedStep(0);
-    drv1->SetDirection(Drv8813State::DISABLED);
-    drv2->SetDirection(Drv8813State::DISABLED);
-
-    vTaskDelay(2000);
-
-    odo->Reset();
-
     // Oneshot cmd
 //    bari->SearchRefPoint();
 //    bari->Goto(1);
@@ -257,62 +237,223 @@ void TASKHANDLER_Test (void * obj)
 }
 
 
+/*----------------------------------------------------------------------------*/
+/* Boot stages                                                                */
+/*----------------------------------------------------------------------------*/
+
 /**
- * @brief Main
+ * @brief Interrupt work worker, early : modules may post from their interrupts
  */
-int main(void)
+static void BootDeferred (void)
 {
-    HardwareInit();
+    TaskTable::Create(TaskTable::DEFERRED, &Deferred::Task, "Deferred");
+}
 
-    // Start (Led init and set up led1)
-    HAL::GPIO *led1 = HAL::GPIO::GetInstance(HAL::GPIO::GPIO0);
-    HAL::GPIO *led2 = HAL::GPIO::GetInstance(HAL::GPIO::GPIO1);
-    HAL::GPIO *led3 = HAL::GPIO::GetInstance(HAL::GPIO::GPIO2);
-    HAL::GPIO *led4 = HAL::GPIO::GetInstance(HAL::GPIO::GPIO3);
-    led1->Set(GPIO::State::Low);
+/**
+ * @brief Console serial
+ */
+static void BootConsole (void)
+{
+    Serial::GetInstance(SERIAL_CONSOLE);
 
-    //Set External DAC
-    ExtDAC* dac = ExtDAC::GetInstance(ExtDAC::EXTDAC0);
-    dac->SetOutputValue(ExtDAC::ExtDAC_Channel0,20u);
+#if !BENCH
+    // Welcome
+    Utils::Print("\r\n\r\n%s Firmware Actionneurs V1.0 (" __DATE__ " - " __TIME__ ")\r\n", Robot::Config::NAME);
+#endif
+}
+
+#if BENCH
+/**
+ * @brief Benchmark firmware : console and kernels only
+ */
+static void BootBench (void)
+{
+    TaskTable::Create(TaskTable::TEST, &Bench::Task, "Bench");
+}
 
-    Drv8813* drv1 = Drv8813::GetInstance(Drv8813::DRV8813_1);
-	Drv8813* drv2 = Drv8813::GetInstance(Drv8813::DRV8813_4);
+enum
+{
+    STAGE_HARDWARE,
+    STAGE_DEFERRED,
+    STAGE_CONSOLE,
+    STAGE_BENCH,
+};
 
-	Encoder* e1 = Encoder::GetInstance(Encoder::ENCODER0);
-	Encoder* e2 = Encoder::GetInstance(Encoder::ENCODER1);
+static const BOOT_STAGE _stages[] =
+{
+    {"hardware",    &HardwareInit,  0u,                                                 false},
+    {"deferred",    &BootDeferred,  BOOT_AFTER(STAGE_HARDWARE),                         false},
+    {"console",     &BootConsole,   BOOT_AFTER(STAGE_HARDWARE),                         false},
+    {"bench",       &BootBench,     BOOT_AFTER(STAGE_CONSOLE),                          false},
+};
+#else
+/**
+ * @brief Leds, led1 on
+ */
+static void BootLeds (void)
+{
+    HAL::GPIO::GetInstance(HAL::GPIO::GPIO0)->Set(GPIO::State::Low);
+    HAL::GPIO::GetInstance(HAL::GPIO::GPIO1);
+    HAL::GPIO::GetInstance(HAL::GPIO::GPIO2);
+    HAL::GPIO::GetInstance(HAL::GPIO::GPIO3);
+}
 
-	MotionControl::FBMotionControl * mc = MotionControl::FBMotionControl::GetInstance();
+/**
+ * @brief Stepper drivers, current reference (external DAC), outputs disabled
+ */
+static void BootDrivers (void)
+{
+    ExtDAC::GetInstance(ExtDAC::EXTDAC0)->SetOutputValue(ExtDAC::ExtDAC_Channel0,20u);
 
-    Cylinder* barilletBas  = Cylinder::GetInstance(Cylinder::ID::CYLINDER0);
+    Drv8813* drv1 = Drv8813::GetInstance(Robot::Config::WHEEL_RIGHT);
+    Drv8813* drv2 = Drv8813::GetInstance(Robot::Config::WHEEL_LEFT);
 
-    //Q7050* q1 = Q7050::GetInstance(Q7050::Q7050_1_2);
-    Mandible* man = Mandible::GetInstance(Mandible::ID::MANDIBLE_1);
+    drv1->SetSpeedStep(0);
+    drv2->SetSpeedStep(0);
+    drv1->SetDirection(Drv8813State::DISABLED);
+    drv2->SetDirection(Drv8813State::DISABLED);
+}
 
-    ADConverter* adc = ADConverter::GetInstance(ADConverter::ADC_Channel2);
+/**
+ * @brief Encoders and motion stack (odometry, planning, position control, telemeters)
+ */
+static void BootMotion (void)
+{
+    Encoder::GetInstance(Encoder::ENCODER0);
+    Encoder::GetInstance(Encoder::ENCODER1);
 
-    Telemeter* tel1 = Telemeter::GetInstance(Telemeter::TELEMETER_1);
-    Telemeter* tel2 = Telemeter::GetInstance(Telemeter::TELEMETER_2);
+    MotionControl::FBMotionControl::GetInstance();
+}
 
-	// Serial init
-    Serial *serial0 = Serial::GetInstance(Serial::SERIAL0);
+/**
+ * @brief Actuators and their orders engine
+ */
+static void BootActuators (void)
+{
+    Cylinder::GetInstance(Cylinder::ID::CYLINDER0);
+    Mandible::GetInstance(Mandible::ID::MANDIBLE_1);
 
-    Diag *diag = Diag::GetInstance();
-    CLI  *cli  = CLI::GetInstance();
+    ActuatorControl::GetInstance();
+}
 
-    // Welcome
-    printf("\r\n\r\nSirius[B] Firmware Actionneurs V1.0 (" __DATE__ " - " __TIME__ ")\r\n");
+/**
+ * @brief Main board link
+ */
+static void BootLink (void)
+{
+    I2CProtocol::GetInstance();
+}
 
-    /*printf("mc->Disable()\r\n");
-    mc->Disable();*/
+/**
+ * @brief First odometry sample : control loops are running
+ */
+static void BootOdometry (void)
+{
+    Utils::Profiler* profiler = Location::Odometry::GetInstance(false)->GetProfiler();
 
-    // Create Test task
-    xTaskCreate(&TASKHANDLER_Test,
-                "Test Task",
-                256,
-                NULL,
-                3,
-                NULL);
+    while(profiler->GetCount() == 0u)
+        vTaskDelay(1);
+}
 
+/**
+ * @brief Telemetry and command line
+ */
+static void BootDiag (void)
+{
+    Diag::GetInstance();
+    CLI::GetInstance();
+}
+
+/**
+ * @brief Optional modules : the robot without one boots an empty stage, its
+ * module is never referenced (see Robot::Config)
+ */
+template<bool PRESENT> static void BootAdc (void);
+template<bool PRESENT> static void BootTest (void);
+
+/**
+ * @brief Spare analog input
+ */
+template<> void BootAdc<true> (void)
+{
+    ADConverter::GetInstance(ADConverter::ADC_Channel2);
+}
+
+template<> void BootAdc<false> (void)
+{
+}
+
+/**
+ * @brief Test task
+ */
+template<> void BootTest<true> (void)
+{
+    TaskTable::Create(TaskTable::TEST, &TASKHANDLER_Test, "Test Task");
+}
+
+template<> void BootTest<false> (void)
+{
+}
+
+/**
+ * @brief Independent watchdog, once control loops run and check in
+ */
+static void BootWatchdog (void)
+{
+    Watchdog::Start();
+}
+
+enum
+{
+    STAGE_HARDWARE,
+    STAGE_DEFERRED,
+    STAGE_LEDS,
+    STAGE_DRIVERS,
+    STAGE_MOTION,
+    STAGE_ACTUATORS,
+    STAGE_LINK,
+    STAGE_ODOMETRY,
+    STAGE_READY,
+    STAGE_CONSOLE,
+    STAGE_DIAG,
+    STAGE_ADC,
+    STAGE_TEST,
+    STAGE_WATCHDOG,
+};
+
+/**
+ * @brief Stages needed to accept main board orders first, then deferred ones
+ * (ready line set as soon as odometry runs)
+ */
+static const BOOT_STAGE _stages[] =
+{
+    {"hardware",    &HardwareInit,  0u,                                                 false},
+    {"deferred",    &BootDeferred,  BOOT_AFTER(STAGE_HARDWARE),                         false},
+    {"leds",        &BootLeds,      BOOT_AFTER(STAGE_HARDWARE),                         false},
+    {"drivers",     &BootDrivers,   BOOT_AFTER(STAGE_HARDWARE),                         false},
+    {"motion",      &BootMotion,    BOOT_AFTER(STAGE_DRIVERS),                          false},
+    {"actuators",   &BootActuators, BOOT_AFTER(STAGE_DRIVERS),                         false},
+    {"link",        &BootLink,      BOOT_AFTER(STAGE_MOTION) | BOOT_AFTER(STAGE_ACTUATORS), false},
+    {"odometry",    &BootOdometry,  BOOT_AFTER(STAGE_MOTION),                           true},
+    {"ready",       &Boot::SetReady, BOOT_AFTER(STAGE_LINK) | BOOT_AFTER(STAGE_ODOMETRY), true},
+    {"console",     &BootConsole,   BOOT_AFTER(STAGE_HARDWARE),                         true},
+    {"diag",        &BootDiag,      BOOT_AFTER(STAGE_CONSOLE) | BOOT_AFTER(STAGE_LEDS) | BOOT_AFTER(STAGE_LINK), true},
+    {"adc",         &BootAdc<Robot::Config::SPARE_ADC>, BOOT_AFTER(STAGE_HARDWARE),     true},
+    {"test",        &BootTest<Robot::Config::TEST_TASK>, BOOT_AFTER(STAGE_DRIVERS),     true},
+    {"watchdog",    &BootWatchdog,  BOOT_AFTER(STAGE_READY),                            true},
+};
+#endif
+
+/**
+ * @brief Main
+ */
+int main(void)
+{
+    // Previous run crash record, before anything may fault
+    Crash::Init();
+    Retain::Init();
+
+    Boot::Start(_stages, sizeof(_stages) / sizeof(_stages[0]));
 
     vTaskStartScheduler();
 
@@ -329,11 +470,9 @@ int main(void)
 void assert_failed(uint8_t* file, uint32_t line)
 {
     //printf(ASSERT_FAILED_MESSSAGE, file, line);
+    (void)file;
 
-    while(1)
-    {
-
-    }
+    Crash::Abort(Crash::ASSERT, NULL, line);
 }
 
 /**
@@ -341,7 +480,11 @@ void assert_failed(uint8_t* file, uint32_t line)
  */
 void vApplicationTickHook(void)
 {
-    // Do something
+    // Microsecond clock is extended at least once per cycle counter wrap
+    (void)Utils::Clock::GetMicros64();
+
+    // Loops health, IWDG kicked while they check in
+    Utils::Watchdog::Supervise();
 }
 
 /**
@@ -358,6 +501,9 @@ void vApplicationIdleHook(void)
     important that vApplicationIdleHook() is permitted to return to its calling
     function, because it is the responsibility of the idle task to clean up
     memory allocated by the kernel to any task that has since been deleted. */
+
+    // Sleep until next interrupt
+    Power::Idle();
 }
 
 /**
@@ -377,7 +523,7 @@ void vApplicationMallocFailedHook(void)
     provide information on how the remaining heap might be fragmented). */
 
     taskDISABLE_INTERRUPTS();
-    printf("ERROR | Safe malloc failed !\n");
+    Utils::Print("ERROR | Safe malloc failed !\n");
     for( ;; );
 }
 
@@ -393,6 +539,5 @@ void vApplicationStackOverflowHook(TaskHandle_t pxTask, char *pcTaskName)
     configCHECK_FOR_STACK_OVERFLOW is defined to 1 or 2.  This hook
     function is called if a stack overflow is detected. */
     taskDISABLE_INTERRUPTS();
-    printf("ERROR | %s Task Stack Overflowed !\n", pcTaskName);
-    for( ;; );
+    Crash::Abort(Crash::STACK_OVERFLOW, pcTaskName, 0u);
 }
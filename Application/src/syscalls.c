@@ -111,27 +111,11 @@ return len;
 	return len;
 }*/
 
+/* newlib heap is not used : malloc family is routed to the OS heap (Utils::Heap) */
 caddr_t _sbrk(int incr)
 {
-	extern char end asm("end");
-	static char *heap_end;
-	char *prev_heap_end;
-
-	if (heap_end == 0)
-		heap_end = &end;
-
-	prev_heap_end = heap_end;
-	if (heap_end + incr > stack_ptr)
-	{
-		write(1, "Heap and stack collision\n", 25);
-		abort();
-		errno = ENOMEM;
-		return (caddr_t) -1;
-	}
-
-	heap_end += incr;
-
-	return (caddr_t) prev_heap_end;
+	errno = ENOMEM;
+	return (caddr_t) -1;
 }
 
 int _close(int file)
@@ -89,12 +89,13 @@ extern uint32_t SystemCoreClock;
 
 #define configUSE_PREEMPTION			1
 #define configUSE_IDLE_HOOK				1
+#define configUSE_TICKLESS_IDLE			1
 #define configUSE_TICK_HOOK				1
 #define configCPU_CLOCK_HZ				( SystemCoreClock )
 #define configTICK_RATE_HZ				( ( TickType_t ) 1000 )
 #define configMAX_PRIORITIES			( 10 )
 #define configMINIMAL_STACK_SIZE		( ( unsigned short ) 130 )
-#define configTOTAL_HEAP_SIZE			( ( size_t ) ( 10 * 1024 ) )
+#define configTOTAL_HEAP_SIZE			( ( size_t ) ( 4 * 1024 ) )	/* Tasks and queues are static (TaskTable) */
 #define configMAX_TASK_NAME_LEN			( 10 )
 #define configUSE_TRACE_FACILITY		1
 #define configUSE_16_BIT_TICKS			0
@@ -106,7 +107,9 @@ extern uint32_t SystemCoreClock;
 #define configUSE_MALLOC_FAILED_HOOK	1
 #define configUSE_APPLICATION_TASK_TAG	0
 #define configUSE_COUNTING_SEMAPHORES	1
-#define configGENERATE_RUN_TIME_STATS	0
+#define configGENERATE_RUN_TIME_STATS	1
+#define configSUPPORT_STATIC_ALLOCATION	1
+#define configSUPPORT_DYNAMIC_ALLOCATION	1
 
 /* Co-routine definitions. */
 #define configUSE_CO_ROUTINES 		0
@@ -127,6 +130,8 @@ to exclude the API function. */
 #define INCLUDE_vTaskSuspend			1
 #define INCLUDE_vTaskDelayUntil			1
 #define INCLUDE_vTaskDelay				1
+#define INCLUDE_uxTaskGetStackHighWaterMark	1
+#define INCLUDE_xTaskGetIdleTaskHandle	1
 
 /* Cortex-M specific definitions. */
 #ifdef __NVIC_PRIO_BITS
@@ -169,6 +174,28 @@ extern void vApplicationIdleHook(void);
 extern void vApplicationMallocFailedHook(void);
 extern void vApplicationStackOverflowHook(void * pxTask, char *pcTaskName);
 
+/* Run time stats (DWT cycle counter based, microsecond unit) */
+extern void vConfigureTimerForRunTimeStats(void);
+extern uint32_t ulGetRunTimeCounterValue(void);
+#define portCONFIGURE_TIMER_FOR_RUN_TIME_STATS()	vConfigureTimerForRunTimeStats()
+#define portGET_RUN_TIME_COUNTER_VALUE()			ulGetRunTimeCounterValue()
+
+/* Tickless idle (see Power), tick is not suppressed while a stepper driver is moving */
+extern void vPowerPreSleep(uint32_t *ticks);
+extern void vPowerPostSleep(uint32_t ticks);
+#define configPRE_SLEEP_PROCESSING( x )				vPowerPreSleep( &( x ) )
+#define configPOST_SLEEP_PROCESSING( x )			vPowerPostSleep( x )
+
+/* Event tracer (see Utils::Trace), queues with a zero number are not traced */
+extern void vTraceTaskSwitchedIn(unsigned long uxNumber);
+extern void vTraceQueueSend(unsigned long uxNumber);
+extern void vTraceQueueReceive(unsigned long uxNumber);
+#define traceTASK_SWITCHED_IN()						vTraceTaskSwitchedIn( pxCurrentTCB->uxTaskNumber )
+#define traceQUEUE_SEND( pxQueue )					if( ( pxQueue )->uxQueueNumber != 0 ) { vTraceQueueSend( ( pxQueue )->uxQueueNumber ); }
+#define traceQUEUE_SEND_FROM_ISR( pxQueue )			traceQUEUE_SEND( pxQueue )
+#define traceQUEUE_RECEIVE( pxQueue )				if( ( pxQueue )->uxQueueNumber != 0 ) { vTraceQueueReceive( ( pxQueue )->uxQueueNumber ); }
+#define traceQUEUE_RECEIVE_FROM_ISR( pxQueue )		traceQUEUE_RECEIVE( pxQueue )
+
 
 
 #endif /* FREERTOS_CONFIG_H */
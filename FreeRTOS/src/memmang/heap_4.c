@@ -362,6 +362,32 @@ size_t xPortGetMinimumEverFreeHeapSize( void )
 }
 /*-----------------------------------------------------------*/
 
+size_t xPortGetLargestFreeBlockSize( void )
+{
+BlockLink_t *pxBlock;
+size_t xLargest = 0;
+
+	/* Largest allocation that can succeed : walk the free list (fragmentation
+	report), the heap is not initialised before the first allocation. */
+	vTaskSuspendAll();
+	{
+		if( pxEnd != NULL )
+		{
+			for( pxBlock = xStart.pxNextFreeBlock; pxBlock != pxEnd; pxBlock = pxBlock->pxNextFreeBlock )
+			{
+				if( pxBlock->xBlockSize > xLargest )
+				{
+					xLargest = pxBlock->xBlockSize;
+				}
+			}
+		}
+	}
+	( void ) xTaskResumeAll();
+
+	return ( xLargest > xHeapStructSize ) ? ( xLargest - xHeapStructSize ) : 0;
+}
+/*-----------------------------------------------------------*/
+
 void vPortInitialiseBlocks( void )
 {
 	/* This just exists to keep the linker quiet. */
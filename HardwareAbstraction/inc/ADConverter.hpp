@@ -18,6 +18,11 @@
 
 #define ADC_ERROR_BUSY      (-1)
 
+/**
+ * @brief Scans kept per channel in DMA buffer (filter window)
+ */
+#define ADC_SCAN_DEPTH      (16u)
+
 
 typedef struct
 {
@@ -31,6 +36,7 @@ typedef struct
     {
         ADC_TypeDef *   ADConverter;
         uint8_t         Channel;
+        uint8_t         Rank;           // Scan rank (1 to ADC_ChannelMAX)
     }ADConverter;
 }ADC_DEF;
 
@@ -40,6 +46,20 @@ typedef struct
 
 namespace HAL
 {
+    /**
+     * @class ADConverter
+     * @brief A/D Converter class
+     *
+     * All channels are scanned on ADC1, triggered by TIM3 update (synchronous
+     * with motor PWM), and written by DMA in a circular buffer of
+     * ADC_SCAN_DEPTH scans. Readers never wait for a conversion.
+     *
+     * HOWTO :
+     * - Get an ADConverter instance with GetInstance()
+     * - Read filtered value with GetResult() or a recent sample with GetSample()
+     * - Optionally watch a threshold with SetWatchdog(), WatchdogTriggered is
+     *   raised on the first conversion above it, then ArmWatchdog() again
+     */
     class ADConverter
     {
     public:
@@ -49,18 +69,58 @@ namespace HAL
             ADC_Channel0    =   0,
             ADC_Channel1,
             ADC_Channel2,
+            ADC_Channel3,
             ADC_ChannelMAX
 
         };
 
         static ADConverter* GetInstance (ADConverter::Channel channel);
 
+        /**
+         * @brief Kept for compatibility, conversions run continuously
+         * @return NO_ERROR
+         */
         int32_t StartConv ();
 
+        /**
+         * @brief Kept for compatibility, doesn't wait
+         */
         void WaitWhileBusy();
 
+        /**
+         * @brief Return mean of the last ADC_SCAN_DEPTH samples
+         */
         uint16_t GetResult();
 
+        /**
+         * @brief Return a raw sample
+         * @param age : 0 for the latest complete scan, up to ADC_SCAN_DEPTH-2
+         */
+        uint16_t GetSample(uint32_t age = 0u);
+
+        /**
+         * @brief Watch channel with ADC analog watchdog
+         * @param high : threshold (12 bits), 0 to stop watching
+         */
+        void SetWatchdog(uint16_t high);
+
+        /**
+         * @brief Enable watchdog interrupt again (disabled on each trigger)
+         */
+        void ArmWatchdog();
+
+        /**
+         * @brief Conversion above watchdog threshold
+         * Raised from interrupt, below configMAX_SYSCALL (FromISR API allowed)
+         */
+        Utils::Event<> WatchdogTriggered;
+
+        /**
+         * @private
+         * @brief Watchdog threshold, 0 if not watched
+         */
+        uint16_t watchdogHigh;
+
     private:
 
         ADConverter(ADConverter::Channel channel);
@@ -68,6 +128,8 @@ namespace HAL
         uint16_t result;
 
         ADC_DEF def;
+
+        ADConverter::Channel channel;
     };
 }
 
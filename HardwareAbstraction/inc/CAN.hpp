@@ -0,0 +1,291 @@
+/**
+ * @file	CAN.hpp
+ * @author	Jeremy ROULLAND
+ * @date	23 oct. 2017
+ * @brief	CAN bus abstraction class
+ */
+
+#ifndef INC_CAN_HPP_
+#define INC_CAN_HPP_
+
+#include "stm32f4xx.h"
+#include "common.h"
+#include "Event.hpp"
+#include "Ring.hpp"
+
+/*----------------------------------------------------------------------------*/
+/* Definitions                                                                */
+/*----------------------------------------------------------------------------*/
+
+#define CAN_MAX_LENGTH			(8u)	/**< Data bytes by message */
+#define CAN_RX_BUFFER_SIZE		(16u)	/**< Received messages ring size (power of 2) */
+#define CAN_TX_BUFFER_SIZE		(16u)	/**< Messages waiting for a mailbox ring size (power of 2) */
+#define CAN_FILTER_MAX			(14u)	/**< Filter banks (CAN1 owns all of them) */
+
+#define CAN_ERROR_NO_MESSAGE	(-1)	/**< No incoming message buffered */
+#define CAN_ERROR_BUFFER_FULL	(-2)	/**< Message dropped, ring is full */
+#define CAN_ERROR_BUS_OFF		(-3)	/**< Too many errors, node is off the bus (recovers automatically) */
+#define CAN_ERROR_PASSIVE		(-4)	/**< Error passive state */
+#define CAN_ERROR_INIT			(-5)	/**< Peripheral did not leave initialization mode */
+
+/**
+ * @brief CAN message (standard 11 bits identifier, data frame)
+ */
+typedef struct
+{
+	uint32_t	ID;							/**< Identifier (0 to 0x7FF, lower is higher priority) */
+	uint8_t		Length;						/**< Data length (0 to CAN_MAX_LENGTH) */
+	uint8_t		Data[CAN_MAX_LENGTH];		/**< Data */
+}CAN_MSG;
+
+/**
+ * @brief CAN Definition structure
+ * Used to define peripheral definition in order to initialize them
+ */
+typedef struct
+{
+	// IO definitions
+	struct Pin
+	{
+		GPIO_TypeDef *	PORT;
+		uint16_t		PIN;
+		uint8_t			PINSOURCE;
+		uint8_t			AF;
+	}RX;
+
+	struct Pin TX;
+
+	// CAN definitions (bit rate = APB1 / (PRESCALER * (1 + BS1 + BS2)))
+	struct Can
+	{
+		CAN_TypeDef *	BUS;
+		uint16_t		PRESCALER;
+		uint8_t			SJW;
+		uint8_t			BS1;
+		uint8_t			BS2;
+	}CAN;
+
+	// Interrupt vector controller definitions
+	struct Int
+	{
+		uint8_t	PRIORITY;		/**< Interrupt priority, 0 to 15, 0 is the highest priority */
+		uint8_t	TX_CHANNEL;		/**< Transmit mailbox empty IRQ Channel */
+		uint8_t	RX_CHANNEL;		/**< FIFO 0 IRQ Channel */
+		uint8_t	SCE_CHANNEL;	/**< Status change and error IRQ Channel */
+	}INT;
+}CAN_DEF;
+
+/*----------------------------------------------------------------------------*/
+/* Class declaration	                                                      */
+/*----------------------------------------------------------------------------*/
+
+namespace HAL
+{
+	/**
+	 * @brief CAN abstraction class
+	 *
+	 * HOWTO :
+	 * - Get instance with GetInstance(), 1 Mbit/s
+	 * - Open hardware filters with SetFilter(), nothing is received before
+	 * - Write() a message : loaded in a free mailbox, else queued and loaded
+	 *   from the mailbox empty interrupt (sent in write order)
+	 * - Read() received messages, MessageReceived is raised on each of them
+	 *   (interrupt context, GetReceived() is the message being raised)
+	 *
+	 * Messages matching a filter are moved from FIFO 0 to a ring by interrupt,
+	 * the ring is lock free (interrupt writes, one task reads).
+	 * Bus-off recovery and retransmission are done by the peripheral.
+	 */
+	class CAN
+	{
+	public:
+
+		/**
+		 * @brief CAN Identifier list
+		 */
+		enum ID
+		{
+			CAN0 = 0,	//!< CAN1 (PD0 RX, PD1 TX)
+			CAN_MAX		//!< CAN_MAX
+		};
+
+		/**
+		 * @brief Get instance method
+		 * @param id : CAN ID
+		 * @return CAN instance
+		 */
+		static CAN* GetInstance (enum ID id);
+
+		/**
+		 * @brief Return instance ID
+		 */
+		enum ID GetID ()
+		{
+			return this->id;
+		}
+
+		/**
+		 * @brief Return current error (= 0 if no error, < 0 else)
+		 */
+		int32_t GetError ()
+		{
+			int32_t error = this->error;
+
+			this->error = 0;
+
+			return error;
+		}
+
+		/**
+		 * @brief Accept messages in a filter bank (identifier / mask)
+		 * @param bank : Filter bank (< CAN_FILTER_MAX)
+		 * @param id : Standard identifier
+		 * @param mask : Identifier bits to compare (0x7FF : exact identifier)
+		 * @return false if bank is invalid
+		 */
+		bool SetFilter (uint32_t bank, uint32_t id, uint32_t mask);
+
+		/**
+		 * @brief Close a filter bank
+		 * @param bank : Filter bank (< CAN_FILTER_MAX)
+		 */
+		void ClearFilter (uint32_t bank);
+
+		/**
+		 * @brief Send a message (any task)
+		 * @param msg : Message
+		 * @return Error code (if < 0)
+		 */
+		int32_t Write (const CAN_MSG * msg);
+
+		/**
+		 * @brief Read incoming message
+		 * @param msg : Buffered message
+		 * @return Error code (if < 0)
+		 */
+		int32_t Read (CAN_MSG * msg);
+
+		/**
+		 * @brief Return message being raised by MessageReceived (interrupt context)
+		 */
+		const CAN_MSG * GetReceived ()
+		{
+			return this->received;
+		}
+
+		/**
+		 * @brief Return true if the node is off the bus
+		 */
+		bool IsBusOff ();
+
+		/**
+		 * @brief Return number of received messages dropped (ring or FIFO full)
+		 */
+		uint32_t GetOverruns ()
+		{
+			return this->overruns;
+		}
+
+		/**
+		 * @brief Return number of messages not sent (ring full)
+		 */
+		uint32_t GetTxDropped ()
+		{
+			return this->txDropped;
+		}
+
+		/**
+		 * @brief Return number of bus errors (error passive or bus-off entries)
+		 */
+		uint32_t GetBusErrors ()
+		{
+			return this->busErrors;
+		}
+
+		/**
+		 * @private
+		 * @brief Internal interrupt callback. DO NOT CALL !!
+		 */
+		void INTERNAL_InterruptCallback (uint32_t flag);
+
+		/**
+		 * @brief Event raised when a message is received
+		 */
+		Utils::Event<> MessageReceived;
+
+		/**
+		 * @brief Event raised when an error occurred (overrun, error passive, bus-off)
+		 */
+		Utils::Event<> ErrorOccurred;
+
+	private:
+
+		/**
+		 * @private
+		 * @brief CAN private constructor
+		 * @param id : CAN identifier
+		 */
+		CAN (enum ID id);
+
+		/**
+		 * @private
+		 * @brief Instance ID
+		 */
+		enum ID id;
+
+		int32_t error;
+
+		/**
+		 * @private
+		 * @brief Peripheral definition
+		 */
+		CAN_DEF def;
+
+		/**
+		 * @private
+		 * @brief Received messages ring
+		 */
+		Utils::SpscRing<CAN_MSG, CAN_RX_BUFFER_SIZE> rxBuffer;
+
+		/**
+		 * @private
+		 * @brief Messages waiting for a mailbox (writers serialized by Write())
+		 */
+		Utils::SpscRing<CAN_MSG, CAN_TX_BUFFER_SIZE> txBuffer;
+
+		/**
+		 * @private
+		 * @brief Message being raised by MessageReceived
+		 */
+		const CAN_MSG * received;
+
+		/**
+		 * @private
+		 * @brief Error counters
+		 */
+		uint32_t overruns;
+		uint32_t txDropped;
+		uint32_t busErrors;
+
+		/**
+		 * @private
+		 * @brief Load a message in a mailbox
+		 * @return false if no mailbox is free
+		 */
+		bool load (const CAN_MSG * msg);
+
+		/**
+		 * @private
+		 * @brief Move FIFO 0 messages to the ring
+		 */
+		void receive ();
+
+		/**
+		 * @private
+		 * @brief Load queued messages in free mailboxes
+		 */
+		void transmit ();
+	};
+}
+
+#endif /* INC_CAN_HPP_ */
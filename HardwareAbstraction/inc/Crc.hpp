@@ -0,0 +1,48 @@
+/**
+ * @file	Crc.hpp
+ * @author	Jeremy ROULLAND
+ * @date	24 oct. 2017
+ * @brief	Hardware CRC unit
+ */
+
+#ifndef INC_CRC_HPP_
+#define INC_CRC_HPP_
+
+#include "stm32f4xx.h"
+#include "common.h"
+
+/*----------------------------------------------------------------------------*/
+/* Class declaration	                                                      */
+/*----------------------------------------------------------------------------*/
+
+/**
+ * @namespace HAL
+ */
+namespace HAL
+{
+	/**
+	 * @class Crc
+	 * @brief Hardware CRC-32 unit (one word per AHB cycle)
+	 *
+	 * CRC-32 MPEG-2 : poly 0x04C11DB7, init 0xFFFFFFFF, no reflection, no final xor.
+	 * The unit eats 32 bits words : data is read as little endian words, the
+	 * last word is zero padded. The host computes the same with any MPEG-2
+	 * implementation over the padded, byte swapped words.
+	 *
+	 * Any context, the unit is held with interrupts masked (short blocks only).
+	 */
+	class Crc
+	{
+	public:
+
+		/**
+		 * @brief Compute CRC of a buffer
+		 * @param buffer : Data (any alignment)
+		 * @param length : Data length (bytes)
+		 * @return CRC-32
+		 */
+		static uint32_t Compute (const uint8_t * buffer, uint32_t length);
+	};
+}
+
+#endif /* INC_CRC_HPP_ */
@@ -17,6 +17,10 @@
 #include "GPIO.hpp"
 #include "PWM.hpp"
 #include "Timer.hpp"
+#include "ADConverter.hpp"
+#include "ExtDAC.hpp"
+#include "Encoder.hpp"
+#include "PID.hpp"
 
 /**
  * @namespace HAL
@@ -26,6 +30,22 @@ namespace HAL {
 /*----------------------------------------------------------------------------*/
 /* Definitions                                                                */
 /*----------------------------------------------------------------------------*/
+
+/**
+ * @brief Micro step table size (one electrical period = 4 full steps, 1/32 step resolution)
+ */
+#define DRV8813_STEP_TABLE_SIZE	(128u)
+
+/**
+ * @brief Waveform half buffer size (max PWM periods per quarter of electrical period)
+ */
+#define DRV8813_WAVE_LENGTH		(128u)
+
+/**
+ * @brief Forbidden speed bands per driver (resonances)
+ */
+#define DRV8813_BANDS_MAX		(2u)
+
 enum Drv8813Mode
 {
 	STEPPER_MODE,
@@ -41,6 +61,15 @@ enum Drv8813State
 };
 typedef enum Drv8813State Drv8813State_t;
 
+enum Drv8813RampState
+{
+	RAMP_NONE,		//constant speed
+	RAMP_ACCEL,
+	RAMP_RUN,
+	RAMP_DECEL
+};
+typedef enum Drv8813RampState Drv8813RampState_t;
+
 /**
  * @brief Steps PWM structure
  * Used to define PWM duty cycle for each step in the mode
@@ -49,8 +78,8 @@ typedef struct
 {
 		bool 			PositivA;		//true= positive current, false = negative current
 		bool			PositivB;		//true= positive current, false = negative current
-		uint32_t		PWM_A;			//in %
-		uint32_t		PWM_B;			//in %
+		uint16_t		PWM_A;			//in 1/1000
+		uint16_t		PWM_B;			//in 1/1000
 }PWM_STEP_DEF;
 
 /**
@@ -61,7 +90,7 @@ typedef struct
 {
 	// Drv8813 definitions
 		Drv8813Mode_t			MODE;
-		uint32_t				USTEP_MODE;
+		uint32_t				USTEP_MODE;		//step table stride (USTEP_1 full step to USTEP_32)
 		uint32_t				PWM_FREQ;
 		uint32_t				NB_MOTOR_STEP;
 		enum HAL::GPIO::ID		GPIO_DECAY;
@@ -72,7 +101,24 @@ typedef struct
 		enum HAL::GPIO::ID		GPIO_PHB;
 		enum HAL::PWM::ID		GPIO_ENA;
 		enum HAL::PWM::ID		GPIO_ENB;
-		uint32_t				CURRENT_COEF;	//current coef for pwm (0 to 100%)
+		enum HAL::Timer::ID		STEP_TIMER;		//step generation timer
+		enum HAL::Timer::Channel	STEP_CHANNEL;	//step generation compare channel
+		uint32_t				CURRENT_COEF;	//run current coef for pwm (0 to 100%)
+		uint32_t				ACCEL_COEF;		//acceleration/deceleration current coef (0 to 100%)
+		uint32_t				HOLD_COEF;		//standstill current coef after HOLD_DELAY (0 to 100%)
+		uint32_t				HOLD_DELAY;		//standstill time before hold current (ms, 0 = never)
+		enum HAL::ADConverter::Channel	ADC_SENSE;	//coil current sense (ADC_ChannelMAX : none)
+		enum HAL::ExtDAC::Channel	DAC_CHANNEL;	//chopping current reference (ExtDAC_Channel_MAX : none)
+		uint8_t					DAC_RUN;		//reference at constant speed
+		uint8_t					DAC_ACCEL;		//reference during ramps (boost)
+		uint8_t					DAC_HOLD;		//reference at standstill
+		DMA_Stream_TypeDef*		WAVE_STREAM;	//coil timer update DMA (NULL : no waveform mode)
+		uint32_t				WAVE_CHANNEL;
+		uint32_t				WAVE_CLOCK;		//RCC_AHB1Periph_DMAx
+		IRQn_Type				WAVE_IRQ;
+		uint32_t				WAVE_IT_HT;		//DMA_IT_HTIFx
+		uint32_t				WAVE_IT_TC;		//DMA_IT_TCIFx
+		enum HAL::Encoder::ID	ENCODER;		//DC mode speed feedback (ENCODER_MAX : open loop)
 }DRV8813_DEF;
 
 /**
@@ -90,8 +136,118 @@ typedef struct
 	GPIO*				PHB;
 	PWM*				ENA;
 	PWM*				ENB;
+	ADConverter*		SENSE;			//NULL if no current sense
 }DRV8813_GPIO_INST;
 
+/**
+ * @brief DRV8813 Ramp structure
+ * Trapezoidal ramp state (AVR446: step interval computed incrementally)
+ */
+typedef struct
+{
+	Drv8813RampState_t	state;
+	uint32_t			minInterval;		//cruise step interval (timer tick)
+	uint32_t			lastAccelInterval;	//last interval of acceleration, first of deceleration
+	uint32_t			decelStart;			//step number where deceleration starts
+	uint32_t			stepCount;			//step done since ramp start
+	int32_t				accelCount;			//ramp index (negative during deceleration)
+	int32_t				decelCount;			//deceleration length (negative)
+	int32_t				rest;				//division remainder, keeps precision
+}DRV8813_RAMP;
+
+/**
+ * @brief DRV8813 Waveform quarter
+ * Steps between two phase changes (quarter of electrical period)
+ */
+typedef struct
+{
+	uint32_t			from;				//step index before first step
+	uint32_t			steps;				//steps in quarter
+	bool				PositivA;
+	bool				PositivB;
+}DRV8813_WAVE_QUARTER;
+
+/**
+ * @brief DRV8813 Waveform structure
+ * ENA / ENB compare values written by timer DMA burst on each PWM period,
+ * each half buffer holds one quarter (the quarter starts 2 periods before its end,
+ * compare values are preloaded)
+ */
+typedef struct
+{
+	uint16_t				buffer[2u * DRV8813_WAVE_LENGTH][2];
+	uint32_t				length;			//PWM periods per quarter (half buffer)
+	uint32_t				scale;			//current scale (1/65536), 0 : full current
+	uint32_t				t;				//generator : PWM period in quarter
+	DRV8813_WAVE_QUARTER	gen;			//generator : quarter being written
+	DRV8813_WAVE_QUARTER	quarter[2];		//quarter starting in each half
+	DRV8813_WAVE_QUARTER	active;			//quarter being played
+	volatile bool			enabled;
+}DRV8813_WAVE;
+
+/**
+ * @brief DRV8813 velocity stream
+ * Signed speed taken by the step interrupt at each step boundary
+ */
+typedef struct
+{
+	volatile uint32_t		interval;		//step interval (timer tick), 0 : standstill
+	volatile Drv8813State_t	direction;		//direction of next steps (FORWARD or BACKWARD)
+	volatile bool			enabled;		//stream drives the step engine
+}DRV8813_VELOCITY;
+
+/**
+ * @brief DRV8813 synchronized move (MoveSync())
+ * Slaves step from the master step interrupt (Bresenham on the master steps)
+ */
+typedef struct
+{
+	int32_t				master;				//slave : master driver ID (-1 : own timeline)
+	uint32_t			slaves;				//master : drivers set stepping on this timeline
+	uint32_t			total;				//master : steps of the timeline
+	uint32_t			steps;				//slave : steps of this axis
+	int32_t				error;				//slave : Bresenham error
+}DRV8813_SYNC;
+
+/**
+ * @brief DRV8813 forbidden speed band
+ * Speeds strictly between the edges are never held : ramps cross the band
+ * in one step, set speeds go to the nearest edge
+ */
+typedef struct
+{
+	float32_t			low;				//lower edge (RPS), low >= high : no band
+	float32_t			high;				//upper edge (RPS)
+	uint32_t			slow;				//lower edge step interval (timer tick, see updateScale())
+	uint32_t			fast;				//upper edge step interval (timer tick), 0 : no band
+}DRV8813_BAND;
+
+/**
+ * @brief DRV8813 DC motor structure
+ * Brushed motor on bridge A : PHA is the direction, ENA the duty cycle
+ */
+typedef struct
+{
+	HAL::Encoder*		encoder;			//speed feedback (NULL : open loop)
+	Utils::PID			pid;				//speed (tick/s) to duty cycle (-1 to 1)
+	float32_t			setpoint;			//tick/s (open loop : duty cycle -1 to 1)
+	float32_t			speed;				//measured speed (tick/s)
+	float32_t			duty;				//applied duty cycle (-1 to 1)
+	uint32_t			time;				//last control (us)
+}DRV8813_DC;
+
+/**
+ * @brief DRV8813 thermal estimate
+ * First order I2t model : heat follows the square of the commanded current
+ * (run current at 100% and run reference is 1) with the winding time constant
+ */
+typedef struct
+{
+	float32_t			heat;				//1 : continuous rating reached
+	float32_t			derate;				//hold current and acceleration factor (1 : none)
+	uint32_t			time;				//last update (us)
+}DRV8813_THERMAL;
+
 /*----------------------------------------------------------------------------*/
 /* Class declaration	                                                      */
 /*----------------------------------------------------------------------------*/
@@ -102,7 +258,25 @@ typedef struct
 	 *
 	 * HOWTO:
 	 *  - Get a Drv8813 instance with GetInstance() method
-	 *  -
+	 *  - Set speed with SetSpeedStep(), SetSpeedRPS() or SetSpeedRPM()
+	 *  - Start a number of steps with PulseRotation() or a continuous rotation with Start()
+	 *  - Or start a number of steps with acceleration and deceleration ramps with Move()
+	 *  - Or start a constant speed rotation played by DMA with StartWaveform()
+	 *  - Or move several drivers together with MoveSync() : all start and finish
+	 *    together, in the time of the longest axis
+	 *  - Wait for MoveFinished instead of polling IsMoving()
+	 *  - Call Supervise() periodically, a stalled driver raises Stalled and
+	 *    ignores moves until ClearStall()
+	 *  - Supervise() also follows the motion state with the ExtDAC current
+	 *    reference (asynchronous SPI), drivers sharing a reference channel
+	 *    get the highest level requested
+	 *
+	 * Each driver owns a timer compare channel: the next step edge is scheduled
+	 * from the step interval, a stopped driver doesn't generate any interrupt.
+	 *
+	 * In DC_MODE a brushed motor is wired on bridge A : set its speed with
+	 * SetSpeedDC(), the speed loop (PID on ENCODER ticks) runs in Supervise().
+	 * Step methods are ignored.
 	 */
 	class Drv8813
 	{
@@ -128,6 +302,58 @@ typedef struct
 		 */
 		static Drv8813* GetInstance (enum ID id);
 
+		/**
+		 * @brief Emergency stop (any context, any interrupt priority)
+		 *
+		 * Drives the shared SLEEP pin low (every driver output disabled on
+		 * the next bus cycle), drops moves and waveforms of every instance,
+		 * and latches : moves are ignored until ClearEmergency().
+		 */
+		static void EmergencyStop (void);
+
+		/**
+		 * @brief Release emergency stop, drivers are awake again (task context, 1 ms)
+		 */
+		static void ClearEmergency (void);
+
+		/**
+		 * @brief Arm the step probe : next step played by any driver is timestamped
+		 */
+		static void ArmStepProbe (void);
+
+		/**
+		 * @brief Read the step probe
+		 * @param us : Time of the first step since ArmStepProbe() (Utils::Clock microseconds)
+		 * @return true if a step was played since ArmStepProbe()
+		 */
+		static bool ReadStepProbe (uint32_t* us);
+
+		/**
+		 * @brief Return true if an emergency stop is latched
+		 */
+		static bool IsEmergency (void);
+
+		/**
+		 * @brief Return true if any driver is moving (or playing a waveform)
+		 */
+		static bool IsAnyMoving (void);
+
+		/**
+		 * @brief Coordinated move of several drivers (linear interpolation)
+		 * @param drivers : Drivers (step mode)
+		 * @param steps : Signed steps by driver (< 0 backward)
+		 * @param count : Drivers count
+		 * @param speed : Cruise speed of the longest axis in step/s
+		 * @param accel : Acceleration and deceleration of the longest axis in step/s^2
+		 * @return 0 if OK, else speed or acceleration is out of range or a driver plays a waveform
+		 *
+		 * The longest axis runs its ramp (Move()), the others step from its step
+		 * interrupt in proportion (Bresenham). Each driver raises MoveFinished,
+		 * a stopped or stalled master stops the others. Until then slaves take
+		 * no other order.
+		 */
+		static uint32_t MoveSync (Drv8813* const drivers[], const int32_t steps[], uint32_t count, uint32_t speed, uint32_t accel);
+
 		 /**
 		 * @brief Set speed
 		 * @param speed: in step/s
@@ -139,6 +365,9 @@ typedef struct
 		 * @brief Set speed
 		 * @param speed: in RPS
 		 * @return 0 if OK, else speed is out of range
+		 *
+		 * Running in the same direction, only the step interval is stored
+		 * (taken on next step) : can be called at control loop rate.
 		 */
 		uint32_t SetSpeedRPS (float32_t speed);
 
@@ -149,6 +378,31 @@ typedef struct
 		 */
 		uint32_t SetSpeedRPM (float32_t speed);
 
+		/**
+		 * @brief Stream a signed speed (velocity mode)
+		 * @param speed : in step/s (< 0 backward, 0 holds position)
+		 * @return 0 if OK, else speed is out of range or waveform is playing
+		 *
+		 * Rate and direction change at next step boundary, step index is kept :
+		 * no phase glitch at high update rates. Any other order (SetDirection(),
+		 * SetSpeedStep(), SetSpeedRPS(), PulseRotation(), Move(), Stop())
+		 * leaves velocity mode.
+		 */
+		uint32_t SetVelocity (float32_t speed);
+
+		/**
+		 * @brief Stream a signed speed in RPS (see SetVelocity())
+		 */
+		uint32_t SetVelocityRPS (float32_t speed);
+
+		/**
+		 * @brief Return true while in velocity mode
+		 */
+		bool IsVelocity (void)
+		{
+			return this->velocity.enabled;
+		}
+
 		/**
 		 * @brief Set direction
 		 * @param dir: motor's direction DISABLE, FORWARD, BACKWARD
@@ -171,6 +425,15 @@ typedef struct
 		 */
 		void PulseRotation (uint32_t pulse);
 
+		/**
+		 * @brief rotation of step number with acceleration and deceleration ramps
+		 * @param steps: number of step
+		 * @param speed: cruise speed in step/s
+		 * @param accel: acceleration and deceleration in step/s^2
+		 * @return 0 if OK, else speed or acceleration is out of range
+		 */
+		uint32_t Move (uint32_t steps, uint32_t speed, uint32_t accel);
+
 		/**
 		 * @brief read position in step
 		 * @return position in step
@@ -184,12 +447,361 @@ typedef struct
 		*/
 		uint32_t SetPosition (uint32_t pos);
 
+		/**
+		 * @brief read signed step count delivered since boot (low 32 bits)
+		 * @return steps, forward positive (differences stay exact across wrap)
+		 */
+		int32_t ReadSteps (void)
+		{
+			return (int32_t)this->ReadSteps64();
+		}
+
+		/**
+		 * @brief read signed step count delivered since boot (read atomically)
+		 * @return steps, forward positive
+		 */
+		int64_t ReadSteps64 (void);
+
+		/**
+		 * @brief read signed step count at the end of current PulseRotation() or Move()
+		 * @return steps, forward positive (ReadSteps64() when no move is pending)
+		 *
+		 * Step count and steps left are read together : position targets are
+		 * computed from the driver instead of being tracked by the caller.
+		 */
+		int64_t ReadTargetSteps (void);
+
 		/**
 		 * @brief read position in step
 		 * @return position in step
 		 */
 		bool IsMoving (void);
 
+		/**
+		 * @brief Return steps left of current PulseRotation() or Move()
+		 */
+		uint32_t GetRemainingSteps()
+		{
+			return this->nb_pulse;
+		}
+
+		/**
+		 * @brief Return current direction
+		 */
+		Drv8813State GetDirection()
+		{
+			return this->direction;
+		}
+
+		/**
+		 * @brief Set micro stepping (steps, positions and speeds are then in micro steps)
+		 * @param ustep : 1, 2, 4, 8, 16 or 32 micro steps per full step
+		 * @return 0 if OK, else micro stepping is not supported
+		 */
+		uint32_t SetMicrostep (uint32_t ustep);
+
+		/**
+		 * @brief Set a forbidden speed band (motor resonance)
+		 * @param index : band (< DRV8813_BANDS_MAX)
+		 * @param low, high : band edges in RPS, low >= high removes the band
+		 * @return 0 if OK, else index is out of range
+		 *
+		 * Move() ramps cross the band in one step and never cruise inside it
+		 * (cruise is lowered to the lower edge). SetSpeed*() and SetVelocity*()
+		 * speeds inside the band go to the nearest edge.
+		 */
+		uint32_t SetResonanceBand (uint32_t index, float32_t low, float32_t high);
+
+		/**
+		 * @brief Return micro steps per full step
+		 */
+		uint32_t GetMicrostep (void);
+
+		/**
+		 * @brief Return micro steps per motor revolution
+		 */
+		uint32_t GetStepsPerTurn (void)
+		{
+			return this->stepsPerTurn;
+		}
+
+		/**
+		 * @brief Set run phase current coefficient
+		 * @param coef : 0 to 100%
+		 */
+		void SetCurrent (uint32_t coef);
+
+		/**
+		 * @brief Set phase current coefficients
+		 * @param run : constant speed current, 0 to 100%
+		 * @param accel : acceleration and deceleration current, 0 to 100%
+		 * @param hold : standstill current after hold delay, 0 to 100%
+		 */
+		void SetCurrent (uint32_t run, uint32_t accel, uint32_t hold);
+
+		/**
+		 * @brief Return estimated motor heat (1 : continuous rating, see Supervise())
+		 */
+		float32_t GetHeat (void)
+		{
+			return this->thermal.heat;
+		}
+
+		/**
+		 * @brief Return thermal derating of hold current, ramps current and accelerations (1 : none)
+		 */
+		float32_t GetDerate (void)
+		{
+			return this->thermal.derate;
+		}
+
+		/**
+		 * @brief Set standstill time before hold current
+		 * @param ms : delay in ms, 0 to keep run current
+		 */
+		void SetHoldDelay (uint32_t ms);
+
+		/**
+		 * @brief Set the step rate above which the bridges use fast decay
+		 * @param speed : in step/s, 0 : fast decay always (boot behaviour before policy)
+		 *
+		 * Slow decay at standstill and low rates keeps holding torque and
+		 * ripple low, fast decay at high rates lets the coil current follow
+		 * the steps. Switched by Supervise() with 25% hysteresis. The DECAY
+		 * pin may be shared : fast decay wins if any driver on it asks.
+		 */
+		void SetDecaySpeed (uint32_t speed);
+
+		/**
+		 * @brief Set chopping current references (ExtDAC output values)
+		 * @param run : constant speed reference
+		 * @param accel : acceleration and deceleration reference
+		 * @param hold : standstill reference
+		 */
+		void SetReference (uint8_t run, uint8_t accel, uint8_t hold)
+		{
+			this->def.DAC_RUN = run;
+			this->def.DAC_ACCEL = accel;
+			this->def.DAC_HOLD = hold;
+		}
+
+		/**
+		 * @brief Start a constant speed rotation played by timer DMA
+		 * Compare values are written by DMA burst on each PWM period, the DMA
+		 * interrupt only switches phases and refills a half buffer once per
+		 * quarter of electrical period. Stop() ends it on the next quarter.
+		 * @param speed : step/s, rounded to a number of PWM periods per quarter
+		 * @return 0, ERROR_GENERAL if no DMA for coil timer, speed out of range or driver stepping
+		 */
+		uint32_t StartWaveform (uint32_t speed);
+
+		/**
+		 * @brief Set DC motor speed (DC_MODE)
+		 * @param speed : encoder tick/s, or duty cycle (-1 to 1) without encoder
+		 * @return 0 if OK, ERROR_GENERAL if not in DC mode
+		 */
+		uint32_t SetSpeedDC (float32_t speed);
+
+		/**
+		 * @brief Return measured DC motor speed (tick/s, updated by Supervise())
+		 */
+		float32_t GetSpeedDC (void)
+		{
+			return this->dc.speed;
+		}
+
+		/**
+		 * @brief Return DC motor speed controller (gains, limits)
+		 */
+		Utils::PID* GetSpeedPID (void)
+		{
+			return &this->dc.pid;
+		}
+
+		/**
+		 * @private
+		 * @brief DC motor state
+		 */
+		DRV8813_DC dc;
+
+		/**
+		 * @private
+		 * @brief Thermal estimate (updated by Supervise())
+		 */
+		DRV8813_THERMAL thermal;
+
+		/**
+		 * @private
+		 * @brief Decay policy : step interval below which fast decay is used (0 : always), current mode
+		 */
+		uint32_t decayInterval;
+		bool decayFast;
+
+		/**
+		 * @brief Return true if rotation is played by DMA
+		 */
+		bool IsWaveform (void)
+		{
+			return this->wave.enabled;
+		}
+
+		/**
+		 * @private
+		 * @brief Waveform playback state
+		 */
+		DRV8813_WAVE wave;
+
+		/**
+		 * @private
+		 * @brief Internal waveform DMA callback. DO NOT CALL !!
+		 */
+		void INTERNAL_WaveCallback (void);
+
+		/**
+		 * @brief Return true if hold current is applied
+		 */
+		bool IsHolding (void)
+		{
+			return this->holding;
+		}
+
+		/**
+		 * @private
+		 * @brief Phase compare values per micro step at full current (from STEP_DEF)
+		 */
+		uint16_t ccrA[DRV8813_STEP_TABLE_SIZE];
+		uint16_t ccrB[DRV8813_STEP_TABLE_SIZE];
+
+		/**
+		 * @private
+		 * @brief Current scales applied to compare tables (1/65536)
+		 */
+		uint32_t scaleRun;
+		uint32_t scaleAccel;
+		uint32_t scaleHold;
+
+		/**
+		 * @private
+		 * @brief Standstill timer ticks before hold current (0 = never)
+		 */
+		uint32_t holdInterval;
+
+		/**
+		 * @private
+		 * @brief Step channel waits for hold delay / hold current is applied
+		 */
+		volatile bool holdPending;
+		volatile bool holding;
+
+		/**
+		 * @private
+		 * @brief Full current compare value and step interval below which it is used
+		 */
+		uint16_t ccrFull;
+		uint32_t fullInterval;
+
+		/**
+		 * @private
+		 * @brief Speed conversion : timer ticks by revolution, maximum RPS (see updateScale())
+		 */
+		float32_t ticksByTurn;
+		float32_t rpsMax;
+
+		/**
+		 * @private
+		 * @brief Velocity mode input (SetVelocity())
+		 */
+		DRV8813_VELOCITY velocity;
+
+		/**
+		 * @private
+		 * @brief Synchronized move state (MoveSync())
+		 */
+		DRV8813_SYNC sync;
+
+		/**
+		 * @private
+		 * @brief Forbidden speed bands (SetResonanceBand())
+		 */
+		DRV8813_BAND bands[DRV8813_BANDS_MAX];
+
+		/**
+		 * @private
+		 * @brief ENA / ENB compare values committed on the same PWM period
+		 */
+		PWMGroup coils;
+
+		/**
+		 * @private
+		 * @brief PHA / PHB written with one BSRR store per port
+		 */
+		GPIOBatch phases;
+
+		/**
+		 * @brief Poll fault pin and coil current sense (task context)
+		 * FAULT interrupt, when available, latches the stall immediately
+		 *
+		 * Also updates the motor heat estimate from the commanded current
+		 * (standstill, ramps, constant speed) : above THERMAL_DERATE_START,
+		 * hold current, ramps current boost and Move() accelerations are
+		 * derated down to THERMAL_DERATE_MIN at THERMAL_LIMIT. A cool motor
+		 * runs at full boost.
+		 */
+		void Supervise (void);
+
+		/**
+		 * @private
+		 * @brief External DAC providing the current reference (NULL if none)
+		 */
+		ExtDAC* dac;
+
+		/**
+		 * @brief Return true if a stall or driver fault is latched
+		 */
+		bool IsStalled (void)
+		{
+			return this->stalled;
+		}
+
+		/**
+		 * @brief Clear latched stall, moves are accepted again
+		 */
+		void ClearStall (void)
+		{
+			this->stalled = false;
+		}
+
+		/**
+		 * @brief Stall event (FAULT pin or coil current over threshold)
+		 * Raised from interrupt, below configMAX_SYSCALL (FromISR API allowed)
+		 */
+		Utils::Event<> Stalled;
+
+		/**
+		 * @private
+		 * @brief Stall latched / Stalled to raise
+		 */
+		volatile bool stalled;
+		volatile bool stallPending;
+
+		/**
+		 * @private
+		 * @brief Stop motor and latch stall (any context)
+		 */
+		void INTERNAL_Stall (void);
+
+		/**
+		 * @brief Move finished event (PulseRotation() or Move() last step)
+		 * Raised from interrupt, below configMAX_SYSCALL (FromISR API allowed)
+		 */
+		Utils::Event<> MoveFinished;
+
+		/**
+		 * @private
+		 * @brief Last step done, MoveFinished to raise
+		 */
+		volatile bool finished;
+
 		/**
 		 * @brief Return Drv8813 identifier
 		 */
@@ -200,7 +812,7 @@ typedef struct
 
 		/**
 		 * @private
-		 * @brief timer source for tick stepper
+		 * @brief timer source for step generation
 		 */
 		Timer* tim;
 
@@ -230,9 +842,27 @@ typedef struct
 
 		/**
 		 * @private
-		 * @brief speed of movment (nb tick between two step)
+		 * @brief speed of movment (nb timer tick between two step, 0 if stopped)
+		 */
+		uint32_t stepInterval;
+
+		/**
+		 * @private
+		 * @brief timer ticks remaining before next step (interval longer than compare range)
+		 */
+		uint32_t stepWait;
+
+		/**
+		 * @private
+		 * @brief step compare channel is running
+		 */
+		volatile bool stepping;
+
+		/**
+		 * @private
+		 * @brief acceleration ramp
 		 */
-		uint32_t period_tick;
+		DRV8813_RAMP ramp;
 
 		/**
 		 * @private
@@ -256,7 +886,7 @@ typedef struct
 		 * @private
 		 * @brief pulse number to execute
 		 */
-		uint32_t nb_pulse;
+		volatile uint32_t nb_pulse;
 
 		/**
 		 * @private
@@ -264,12 +894,30 @@ typedef struct
 		 */
 		uint32_t position;
 
+		/**
+		 * @private
+		 * @brief micro steps per revolution (position wrap)
+		 */
+		uint32_t stepsPerTurn;
+
+		/**
+		 * @private
+		 * @brief signed step count since boot (written by step interrupt, see ReadSteps64())
+		 */
+		volatile int64_t steps;
+
 		/**
 		 * @private
 		 * @brief run rotation motor
 		 */
 		bool run;
 
+		/**
+		 * @private
+		 * @brief Internal step callback. DO NOT CALL !!
+		 */
+		RAMFUNC void INTERNAL_StepCallback (void);
+
 private:
 
 		/**
@@ -279,6 +927,127 @@ private:
 		 */
 		Drv8813 (enum ID id);
 
+		/**
+		 * @private
+		 * @brief Start step generation if motor has to move
+		 */
+		void startStepping (void);
+
+		/**
+		 * @private
+		 * @brief Update speed conversion factors (timer or micro stepping changed)
+		 */
+		void updateScale (void);
+
+		/**
+		 * @private
+		 * @brief Move a step interval out of the forbidden bands
+		 * @param interval : step interval (timer tick, 0 : standstill)
+		 * @param slower : always to the lower edge, else to the nearest one
+		 */
+		uint32_t avoidBands (uint32_t interval, bool slower);
+
+		/**
+		 * @private
+		 * @brief Ramp crosses a forbidden band : jump to its other edge
+		 * @param interval : next ramp interval
+		 * @return crossed band edge interval, or interval
+		 */
+		RAMFUNC int32_t rampCross (int32_t interval);
+
+		/**
+		 * @private
+		 * @brief Stream a step interval and direction (velocity mode)
+		 * @param interval : step interval (timer tick), 0 : standstill
+		 * @param dir : FORWARD or BACKWARD
+		 */
+		uint32_t streamVelocity (uint32_t interval, Drv8813State dir);
+
+		/**
+		 * @private
+		 * @brief Compute the next ramp step interval (called on each step)
+		 */
+		RAMFUNC void rampCompute (void);
+
+		/**
+		 * @private
+		 * @brief Play one step in current direction (step interrupt, master timeline)
+		 */
+		RAMFUNC void stepOnce (void);
+
+		/**
+		 * @private
+		 * @brief Step synchronized slaves after a master step
+		 */
+		RAMFUNC void syncStep (void);
+
+		/**
+		 * @private
+		 * @brief Release slaves of the master timeline (steps left are dropped)
+		 */
+		void syncRelease (void);
+
+		/**
+		 * @private
+		 * @brief Start a waveform quarter from a step index
+		 */
+		void waveQuarter (uint32_t from, uint32_t steps);
+
+		/**
+		 * @private
+		 * @brief Write a half buffer (one quarter, next one starts 2 periods before end)
+		 */
+		void waveFill (uint32_t half);
+
+		/**
+		 * @private
+		 * @brief Stop DMA and go back to compare values of step index (interrupts disabled)
+		 */
+		void waveStop (void);
+
+		/**
+		 * @private
+		 * @brief Apply DC motor duty cycle (any context)
+		 * @param duty : -1 (backward) to 1 (forward), 0 releases the bridge
+		 */
+		void dcOutput (float32_t duty);
+
+		/**
+		 * @private
+		 * @brief DC motor speed loop (called from Supervise())
+		 */
+		void dcControl (void);
+
+		/**
+		 * @private
+		 * @brief Update heat estimate and derating (called from Supervise())
+		 */
+		void thermalUpdate (void);
+
+		/**
+		 * @private
+		 * @brief Current scales from coefficients and derating
+		 */
+		void currentApply (void);
+
+		/**
+		 * @private
+		 * @brief Current reference of the motion state, derated
+		 */
+		uint8_t referenceLevel (void);
+
+		/**
+		 * @private
+		 * @brief Decay mode of the motion state (hysteresis on step interval)
+		 */
+		bool decayMode (void);
+
+		/**
+		 * @private
+		 * @brief Write the DECAY pin from the requests of the drivers sharing it
+		 */
+		void decayApply (void);
+
 	};
 }
 
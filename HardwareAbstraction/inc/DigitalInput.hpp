@@ -0,0 +1,190 @@
+/**
+ * @file	DigitalInput.hpp
+ * @author	Kevin WYSOCKI
+ * @date	21 oct. 2017
+ * @brief	Debounced digital inputs sampled from one software timer
+ */
+
+#ifndef INC_DIGITALINPUT_HPP_
+#define INC_DIGITALINPUT_HPP_
+
+#include "stm32f4xx.h"
+#include "common.h"
+
+#include "Event.hpp"
+#include "GPIO.hpp"
+#include "SoftTimer.hpp"
+
+/*----------------------------------------------------------------------------*/
+/* Definitions                                                                */
+/*----------------------------------------------------------------------------*/
+
+/**
+ * @brief Digital input definition structure
+ */
+typedef struct
+{
+	enum HAL::GPIO::ID	GPIO;			/**< Input pin */
+	uint8_t				FILTER;			/**< Samples to confirm a new state (integrator, 1 to 255) */
+	bool				INVERTED;		/**< Active low input */
+}DIN_DEF;
+
+/*----------------------------------------------------------------------------*/
+/* Class declaration	                                                      */
+/*----------------------------------------------------------------------------*/
+
+/**
+ * @namespace HAL
+ */
+namespace HAL
+{
+	/**
+	 * @class DigitalInput
+	 * @brief Debounced digital input
+	 *
+	 * HOWTO :
+	 * - Get input instance with DigitalInput::GetInstance()
+	 * - Get() returns debounced state, GetEdgeTimestamp() the time of last edge
+	 * - Subscribe to Changed to be notified of debounced edges
+	 *
+	 * All instances are sampled by the same periodic software timer (1 kHz).
+	 * Each input integrates raw samples : the counter goes up on active samples
+	 * and down on inactive ones, state changes when it reaches FILTER or 0, so
+	 * latency is FILTER sampling periods and bounces shorter than that are
+	 * ignored.
+	 */
+	class DigitalInput
+	{
+	public:
+
+		/**
+		 * @brief Digital input identifier list
+		 */
+		enum ID
+		{
+			INPUT1,		//!< GPIO57, emergency stop
+			INPUT2,		//!< GPIO58, cylinder 1 topz
+			INPUT3,		//!< GPIO59
+			INPUT4,		//!< GPIO60
+			INPUT5,		//!< GPIO61
+			INPUT6,		//!< GPIO62
+			INPUT7,		//!< GPIO63
+			INPUT8,		//!< GPIO64
+			INPUT9,		//!< GPIO65
+			INPUT10,	//!< GPIO66
+			INPUT11,	//!< GPIO67
+			INPUT12,	//!< GPIO68
+			INPUT13,	//!< GPIO69
+			INPUT14,	//!< GPIO70
+			INPUT15,	//!< GPIO71
+			INPUT16,	//!< GPIO72, cylinder 0 topz
+			INPUT_MAX
+		};
+
+		/**
+		 * @brief Get instance method, sampling starts with the first instance
+		 * @param id : Input identifier
+		 * @return Digital input instance
+		 */
+		static DigitalInput* GetInstance (enum ID id);
+
+		/**
+		 * @brief Return instance ID
+		 */
+		enum ID GetID ()
+		{
+			return this->id;
+		}
+
+		/**
+		 * @brief Return debounced state (active = High)
+		 */
+		enum GPIO::State Get ()
+		{
+			return this->state;
+		}
+
+		/**
+		 * @brief Return timestamp of last debounced edge (DWT cycles)
+		 */
+		uint32_t GetEdgeTimestamp ()
+		{
+			return this->edgeTimestamp;
+		}
+
+		/**
+		 * @brief Return debounced edges count since boot
+		 */
+		uint32_t GetEdgeCount ()
+		{
+			return this->edges;
+		}
+
+		/**
+		 * @brief Set samples needed to confirm a new state
+		 * @param samples : 1 to 255
+		 */
+		void SetFilter (uint8_t samples);
+
+		/**
+		 * @brief Debounced state changed event
+		 * Raised from sampling interrupt, below configMAX_SYSCALL (FromISR API allowed)
+		 */
+		Utils::Event<> Changed;
+
+		/**
+		 * @private
+		 * @brief Internal sampling callback. DO NOT CALL !!
+		 * @param timestamp : DWT cycles of sampling
+		 */
+		void INTERNAL_Sample (uint32_t timestamp);
+
+	private:
+
+		/**
+		 * @private
+		 * @brief Digital input private constructor
+		 * @param id : Input identifier
+		 */
+		DigitalInput (enum ID id);
+
+		/**
+		 * @private
+		 * @brief Instance ID
+		 */
+		enum ID id;
+
+		/**
+		 * @private
+		 * @brief Input definition
+		 */
+		DIN_DEF def;
+
+		/**
+		 * @private
+		 * @brief Input pin
+		 */
+		GPIO* gpio;
+
+		/**
+		 * @private
+		 * @brief Integrator (0 to FILTER)
+		 */
+		uint8_t count;
+
+		/**
+		 * @private
+		 * @brief Debounced state
+		 */
+		volatile enum GPIO::State state;
+
+		/**
+		 * @private
+		 * @brief Last edge timestamp (DWT cycles) and edge count
+		 */
+		volatile uint32_t edgeTimestamp;
+		volatile uint32_t edges;
+	};
+}
+
+#endif /* INC_DIGITALINPUT_HPP_ */
@@ -9,6 +9,7 @@
 #define INC_ENCODER_HPP_
 
 #include "stm32f4xx.h"
+#include "common.h"
 
 
 /*----------------------------------------------------------------------------*/
@@ -36,7 +37,8 @@ typedef struct
 	struct Timer
 	{
 		TIM_TypeDef *	TIMER;
-		uint16_t		RELOAD_VAL;
+		uint32_t		RELOAD_VAL;
+		uint16_t		TRIGGER;		/**< Snapshot internal trigger (TIM_TS_ITRx) */
 	}TIMER;
 
 	// Interrupt definitions
@@ -65,6 +67,18 @@ namespace HAL
 	 * - Get Encoder instance with Encoder::GetInstance()
 	 * - Use GetAbsoluteValue() and GetRelativeValue() methods to know
 	 *   absolute or relative (since last call) position
+	 *
+	 * The 32-bit timer counter is free running : the delta since the last
+	 * read is computed with modular arithmetic, so no overflow interrupt is
+	 * needed as long as it is read before 2^31 counts have elapsed.
+	 *
+	 * Channel A rising edges are input captured : the capture interrupt
+	 * stamps the latched counter value with the CPU cycle counter, see
+	 * GetLastEdge(), for low speed velocity estimation (1/T method).
+	 *
+	 * Channel 3 captures the counter on an internal trigger shared by all
+	 * encoders (snapshot) : GetRelativeValues() reads two encoders deltas
+	 * latched at the same instant, without skew between the two reads.
 	 */
 	class Encoder
 	{
@@ -89,14 +103,13 @@ namespace HAL
 		static Encoder* GetInstance (Encoder::ID id);
 
 		/**
-		 * @brief Reset position and turn counter
+		 * @brief Reset absolute and relative position
 		 */
 		void Reset()
 		{
-			this->turnCounter 	= 	0;
+			this->prevCounter 	= 	this->def.TIMER.TIMER->CNT;
 			this->absolutePos 	= 	0;
 			this->relativePos 	= 	0;
-			this->prevAbsValue 	= 	0;
 		}
 
 		/**
@@ -109,11 +122,29 @@ namespace HAL
 		 */
 		int32_t GetRelativeValue ();
 
+		/**
+		 * @brief Return two encoders values since last retrieval, latched at the same instant
+		 * @param a, b : Encoders
+		 * @param da, db : Relative values
+		 *
+		 * Counters are read directly if no snapshot was latched since the
+		 * last call (trigger timer stopped).
+		 */
+		static void GetRelativeValues (Encoder* a, Encoder* b, int32_t* da, int32_t* db);
+
+		/**
+		 * @brief Get last captured edge
+		 * @param count : Counter value latched on the edge
+		 * @param timestamp : CPU cycles at the edge
+		 * @return Edge sequence number (0 if no edge captured yet)
+		 */
+		uint32_t GetLastEdge (uint32_t* count, uint32_t* timestamp);
+
 		/**
 		 * @private
-		 * @brief Internal interrupt callback. DO NOT CALL !!
+		 * @brief Internal capture interrupt callback. DO NOT CALL !!
 		 */
-		void INTERNAL_InterruptCallback (uint8_t flag);
+		RAMFUNC void INTERNAL_CaptureCallback ();
 
 	private:
 
@@ -126,15 +157,30 @@ namespace HAL
 
 		/**
 		 * @private
-		 * @brief Encoder turn counter
+		 * @brief Read timer counter and accumulate delta since last read
+		 */
+		void update ();
+
+		/**
+		 * @private
+		 * @brief Accumulate delta since last read
+		 * @param counter : Timer counter (current or latched)
+		 */
+		void accumulate (uint32_t counter);
+
+		/**
+		 * @private
+		 * @brief Timer counter at last read
 		 */
-		int32_t turnCounter;
+		uint32_t prevCounter;
 
 		/**
 		 * @private
-		 * @brief Timer previous absolute value
+		 * @brief Last captured edge (written by interrupt)
 		 */
-		int64_t prevAbsValue;
+		volatile uint32_t edgeSeq;
+		volatile uint32_t edgeCount;
+		volatile uint32_t edgeTime;
 
 		/**
 		 * @private
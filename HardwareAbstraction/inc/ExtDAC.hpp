@@ -14,6 +14,8 @@
 /* Definitions                                                                */
 /*----------------------------------------------------------------------------*/
 
+#define EXTDAC_ERROR_BUSY		(-3)
+
 
 /**
  * @brief ExtDAC Definition structure
@@ -32,6 +34,10 @@ namespace HAL
 {
 	/**
 	 * @brief DAC088S085 Digital-To-Analog Converter class
+	 *
+	 * The DAC is used in write register mode : channel registers are
+	 * written first then outputs are updated together (update select),
+	 * each 16-bit command being a separate nCS frame.
 	 */
 	class ExtDAC
 	{
@@ -85,6 +91,28 @@ namespace HAL
 		 */
 		int32_t SetOutputValue (enum Channel ch, uint8_t output);
 
+		/**
+		 * @brief Set output values of several channels, updated simultaneously
+		 *
+		 * Non blocking : a single SPI transaction is queued, outputs
+		 * are copied so the array may be reused on return.
+		 *
+		 * @param mask : Channels to write (bit n for channel n)
+		 * @param outputs : Output values, indexed by channel
+		 * @param callback : Called from interrupt once outputs are updated, may be NULL
+		 * @param obj : Callback parameter
+		 * @return = 0 if no error, EXTDAC_ERROR_BUSY if previous batch is pending, < 0 else
+		 */
+		int32_t SetOutputValues (uint8_t mask, const uint8_t * outputs, SPI_CALLBACK callback = NULL, void * obj = NULL);
+
+		/**
+		 * @brief Is a batch update pending
+		 */
+		bool IsBusy ()
+		{
+			return (this->batch.status == SPI_PENDING);
+		}
+
 	private:
 
 		/**
@@ -117,6 +145,13 @@ namespace HAL
 		 * @brief SPI bus used to communicate with DAC
 		 */
 		SPIMaster * bus;
+
+		/**
+		 * @private
+		 * @brief Batch update transaction and frames (channel writes plus update)
+		 */
+		SPITransaction batch;
+		uint8_t batchBuffer[2u * (ExtDAC_Channel_MAX + 1u)];
 	};
 }
 
@@ -0,0 +1,134 @@
+/**
+ * @file	Flash.hpp
+ * @author	Kevin WYSOCKI
+ * @date	22 oct. 2017
+ * @brief	Internal flash sectors driver
+ */
+
+#ifndef INC_FLASH_HPP_
+#define INC_FLASH_HPP_
+
+#include "stm32f4xx.h"
+#include "common.h"
+
+/*----------------------------------------------------------------------------*/
+/* Definitions                                                                */
+/*----------------------------------------------------------------------------*/
+
+/**
+ * @brief Flash definition structure
+ */
+typedef struct
+{
+	uint16_t	SECTOR;			/**< FLASH_Sector_x */
+	uint32_t	ADDRESS;		/**< Sector start address */
+	uint32_t	SIZE;			/**< Sector size (bytes) */
+}FLASH_DEF;
+
+/*----------------------------------------------------------------------------*/
+/* Class declaration	                                                      */
+/*----------------------------------------------------------------------------*/
+
+/**
+ * @namespace HAL
+ */
+namespace HAL
+{
+	/**
+	 * @class Flash
+	 * @brief Internal flash sector, reserved for data (out of ROM, see LinkerScript.ld)
+	 *
+	 * HOWTO :
+	 * - Get sector instance with Flash::GetInstance()
+	 * - Read in place at GetAddress() (memory mapped)
+	 * - Erase() the whole sector, Program() words in erased (0xFFFFFFFF) locations
+	 *
+	 * The device has one flash bank : code fetches stall while a sector is
+	 * erased (up to 2 s for 128 KB) or a word is programmed, interrupts
+	 * included. Erase only when nothing is time critical.
+	 * Program() and Erase() must be called by one context at a time.
+	 */
+	class Flash
+	{
+	public:
+
+		/**
+		 * @brief Flash sector identifier list
+		 */
+		enum ID
+		{
+			CONFIG0,		//!< Sector 6, configuration bank 0
+			CONFIG1,		//!< Sector 7, configuration bank 1
+			FLASH_MAX
+		};
+
+		/**
+		 * @brief Get instance method
+		 * @param id : Flash sector identifier
+		 * @return Flash instance
+		 */
+		static Flash* GetInstance (enum ID id);
+
+		/**
+		 * @brief Return instance ID
+		 */
+		enum ID GetID ()
+		{
+			return this->id;
+		}
+
+		/**
+		 * @brief Return sector start address
+		 */
+		uint32_t GetAddress ()
+		{
+			return this->def.ADDRESS;
+		}
+
+		/**
+		 * @brief Return sector size (bytes)
+		 */
+		uint32_t GetSize ()
+		{
+			return this->def.SIZE;
+		}
+
+		/**
+		 * @brief Erase sector (all bytes to 0xFF)
+		 * @return true on success
+		 */
+		bool Erase ();
+
+		/**
+		 * @brief Program words
+		 * @param offset : Byte offset in sector (word aligned)
+		 * @param words : Data
+		 * @param count : Number of words
+		 * @return true if programmed and read back
+		 */
+		bool Program (uint32_t offset, const uint32_t* words, uint32_t count);
+
+	private:
+
+		/**
+		 * @private
+		 * @brief Flash private constructor
+		 * @param id : Flash sector identifier
+		 */
+		Flash (enum ID id);
+
+		/**
+		 * @private
+		 * @brief Instance ID
+		 */
+		enum ID id;
+
+		/**
+		 * @private
+		 * @brief Flash definition
+		 */
+		FLASH_DEF def;
+	};
+}
+
+#endif /* INC_FLASH_HPP_ */
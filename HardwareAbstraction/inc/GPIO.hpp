@@ -42,6 +42,14 @@ typedef struct
 	}INT;
 }GPIO_DEF;
 
+#define GPIO_BATCH_SIZE		(12u)	// pins per batch
+#define GPIO_BATCH_PORTS	(4u)	// distinct ports per batch
+
+/**
+ * @brief Port BSRR as a single 32 bits register (set : bits 0-15, reset : bits 16-31)
+ */
+#define GPIO_BSRR(port)		(*(volatile uint32_t*)&(port)->BSRRL)
+
 /*----------------------------------------------------------------------------*/
 /* Class										                              */
 /*----------------------------------------------------------------------------*/
@@ -58,6 +66,7 @@ namespace HAL
 	 *	- Get GPIO instance with GPIO::GetInstance()
 	 *	- Get() and Set() can be use to retrieve or set GPIO state
 	 *	- InterruptCallback can be used to set a function called when interrupt is raised
+	 *	- SetFast(), GPIOPin, GPIOPort and GPIOBatch write BSRR directly (interrupts)
 	 */
 	class GPIO
 	{
@@ -125,14 +134,14 @@ namespace HAL
 			GPIO54,		//!< SERVO14
 			GPIO55,		//!< SERVO15
 			GPIO56,		//!< SERVO16
-			GPIO57,		//!< INPUT1
+			GPIO57,		//!< INPUT1, emergency stop
 			GPIO58,		//!< INPUT2
-			GPIO59,		//!< INPUT3
+			GPIO59,		//!< INPUT3, rear left bumper
 			GPIO60,		//!< INPUT4
 			GPIO61,		//!< INPUT5
 			GPIO62,		//!< INPUT6
 			GPIO63,		//!< INPUT7
-			GPIO64,		//!< INPUT8
+			GPIO64,		//!< INPUT8, rear right bumper
 			GPIO65,		//!< INPUT9
 			GPIO66,		//!< INPUT10
 			GPIO67,		//!< INPUT11
@@ -190,22 +199,79 @@ namespace HAL
 		 */
 		void Set(enum State state);
 
+		/**
+		 * @brief Set GPIO state with a single BSRR write (output only, not checked)
+		 * @param state : Low if GPIO must be '0' logic, High else
+		 */
+		void SetFast(enum State state)
+		{
+			if(state == GPIO::High)
+				this->def.IO.PORT->BSRRL = this->def.IO.PIN;
+			else
+				this->def.IO.PORT->BSRRH = this->def.IO.PIN;
+		}
+
 		/**
 		 * @brief Toggle GPIO (if GPIO is an output)
 		 */
 		void Toggle();
 
+		/**
+		 * @brief Return GPIO port
+		 */
+		GPIO_TypeDef* GetPort()
+		{
+			return this->def.IO.PORT;
+		}
+
+		/**
+		 * @brief Return GPIO pin mask (GPIO_Pin_x)
+		 */
+		uint16_t GetPin()
+		{
+			return this->def.IO.PIN;
+		}
+
+		/**
+		 * @brief Enable or disable GPIO interrupt (GPIO with an interrupt line only)
+		 * @param enable : true to raise StateChanged on edges
+		 */
+		void SetInterruptState (bool enable);
+
+		/**
+		 * @brief Set interrupt edges (GPIO with an interrupt line only)
+		 * @param trigger : EXTI_Trigger_Rising, EXTI_Trigger_Falling or EXTI_Trigger_Rising_Falling
+		 */
+		void SetInterruptTrigger (EXTITrigger_TypeDef trigger);
+
+		/**
+		 * @brief Return timestamp of last edge (DWT cycles, taken on interrupt entry)
+		 */
+		uint32_t GetEdgeTimestamp ()
+		{
+			return this->edgeTimestamp;
+		}
+
+		/**
+		 * @brief Return input state read in last edge interrupt
+		 */
+		enum State GetEdgeState ()
+		{
+			return this->edgeState;
+		}
+
 		/**
 		 * @brief State changed event
-		 * INPUT ONLY !
+		 * INPUT ONLY ! GetEdgeTimestamp() and GetEdgeState() are valid in callbacks
 		 */
-		Utils::Event StateChanged;
+		Utils::Event<> StateChanged;
 
 		/**
 		 * @private
 		 * @brief Internal interrupt callback. DO NOT CALL !!
+		 * @param timestamp : DWT cycles on interrupt entry
 		 */
-		void INTERNAL_InterruptCallback ();
+		void INTERNAL_InterruptCallback (uint32_t timestamp);
 
 	private:
 		/**
@@ -227,11 +293,156 @@ namespace HAL
 		 */
 		bool intState;
 
+		/**
+		 * @private
+		 * @brief Last edge timestamp (DWT cycles) and input state
+		 */
+		volatile uint32_t edgeTimestamp;
+		volatile enum State edgeState;
+
 		/**
 		 * @private
 		 * @brief GPIO definition
 		 */
 		GPIO_DEF def;
 	};
+
+	/**
+	 * @class GPIOPin
+	 * @brief Compile time pin descriptor, each access is a single register access
+	 *
+	 * Pin is configured by GPIO::GetInstance(), ex :
+	 * typedef GPIOPin<GPIOG_BASE, 2u> Led;  Led::High();
+	 */
+	template<uint32_t PORT_BASE, uint32_t PIN>
+	struct GPIOPin
+	{
+		static const uint16_t MASK = (uint16_t)(1u << PIN);
+
+		static GPIO_TypeDef* Port ()
+		{
+			return (GPIO_TypeDef*)PORT_BASE;
+		}
+
+		static void High ()
+		{
+			Port()->BSRRL = MASK;
+		}
+
+		static void Low ()
+		{
+			Port()->BSRRH = MASK;
+		}
+
+		static void Set (enum GPIO::State state)
+		{
+			if(state == GPIO::High)
+				High();
+			else
+				Low();
+		}
+
+		static enum GPIO::State Get ()
+		{
+			return (Port()->IDR & MASK) ? GPIO::High : GPIO::Low;
+		}
+	};
+
+	/**
+	 * @class GPIOPort
+	 * @brief Compile time port, several pins changed with one BSRR store
+	 */
+	template<uint32_t PORT_BASE>
+	struct GPIOPort
+	{
+		/**
+		 * @brief Set and reset pins at once (set wins if a pin is in both)
+		 * @param set : pins set to High (GPIO_Pin_x mask)
+		 * @param reset : pins set to Low (GPIO_Pin_x mask)
+		 */
+		static void Write (uint16_t set, uint16_t reset)
+		{
+			GPIO_BSRR((GPIO_TypeDef*)PORT_BASE) = (uint32_t)set | ((uint32_t)reset << 16u);
+		}
+	};
+
+	/**
+	 * @class GPIOBatch
+	 * @brief Outputs of several GPIO instances written with one BSRR store per port
+	 *
+	 * HOWTO :
+	 * - Add() outputs once (GPIO_BATCH_SIZE pins, GPIO_BATCH_PORTS ports)
+	 * - Stage() new states
+	 * - Commit() writes staged states, one store per port
+	 */
+	class GPIOBatch
+	{
+	public:
+
+		/**
+		 * @brief Empty batch constructor
+		 */
+		GPIOBatch ();
+
+		/**
+		 * @brief Add an output to batch
+		 * @param gpio : GPIO instance
+		 * @return Pin index in batch, -1 if batch is full
+		 */
+		int32_t Add (GPIO* gpio);
+
+		/**
+		 * @brief Stage a pin state, written on next Commit()
+		 * @param index : Pin index returned by Add()
+		 * @param state : Pin state
+		 */
+		void Stage (uint32_t index, enum GPIO::State state)
+		{
+			uint32_t bits = this->pin[index];
+
+			if(state == GPIO::Low)
+				bits <<= 16u;
+
+			this->bsrr[this->slot[index]] |= bits;
+		}
+
+		/**
+		 * @brief Write staged states
+		 */
+		void Commit (void)
+		{
+			for(uint32_t i = 0u; i < this->portCount; i++)
+			{
+				if(this->bsrr[i] != 0u)
+				{
+					GPIO_BSRR(this->port[i]) = this->bsrr[i];
+					this->bsrr[i] = 0u;
+				}
+			}
+		}
+
+	private:
+
+		/**
+		 * @private
+		 * @brief Pin masks and port slot of pins
+		 */
+		uint16_t pin[GPIO_BATCH_SIZE];
+		uint8_t slot[GPIO_BATCH_SIZE];
+
+		/**
+		 * @private
+		 * @brief Ports of batch pins (distinct) and staged BSRR values
+		 */
+		GPIO_TypeDef* port[GPIO_BATCH_PORTS];
+		uint32_t bsrr[GPIO_BATCH_PORTS];
+
+		/**
+		 * @private
+		 * @brief Pin and port count
+		 */
+		uint8_t count;
+		uint8_t portCount;
+	};
 }
 #endif /* INC_GPIO_HPP_ */
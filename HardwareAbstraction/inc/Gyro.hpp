@@ -0,0 +1,183 @@
+/**
+ * @file	Gyro.hpp
+ * @author	Jeremy ROULLAND
+ * @date	15 oct. 2026
+ * @brief	MPU-6050 family yaw rate gyroscope class (I2C)
+ */
+
+#ifndef INC_GYRO_HPP_
+#define INC_GYRO_HPP_
+
+#include "I2C.hpp"
+
+/*----------------------------------------------------------------------------*/
+/* Definitions                                                                */
+/*----------------------------------------------------------------------------*/
+
+#define GYRO_ERROR_ABSENT		(-3)
+#define GYRO_ERROR_NOT_READY	(-4)
+
+#define GYRO_ERROR_MAX			(8u)		// Consecutive bus errors before the gyro is declared absent
+
+/**
+ * @brief Gyro Definition structure
+ * Used to define peripheral definition in order to initialize them
+ */
+typedef struct
+{
+	HAL::I2C::ID		BusID;
+	uint8_t				SlaveAddr;
+}GYRO_DEF;
+
+/*----------------------------------------------------------------------------*/
+/* Class declaration	                                                      */
+/*----------------------------------------------------------------------------*/
+
+namespace HAL
+{
+	/**
+	 * @brief MPU-6050 family yaw rate gyroscope class
+	 *
+	 * HOWTO :
+	 * - Get Gyro instance with Gyro::GetInstance()
+	 * - Call Sample() periodically from a single task : each call polls the
+	 *   last I2C transaction and queues the next one, it never blocks
+	 * - Read the last yaw rate with GetRate()
+	 *
+	 * The gyro is optional : it is probed (WHO_AM_I) at first Sample(),
+	 * configured (PLL clock, 44 Hz low pass, +/-500 deg/s) then Z rate is
+	 * read once by call. A missing or failing device is declared absent and
+	 * never retried.
+	 */
+	class Gyro
+	{
+	public:
+
+		/**
+		 * @brief Gyro Identifier list
+		 */
+		enum ID
+		{
+			GYRO0 = 0,//!< GYRO0
+			GYRO_MAX  //!< GYRO_MAX
+		};
+
+		/**
+		 * @brief Get instance method
+		 * @param id : Gyro ID
+		 * @return Gyro instance
+		 */
+		static Gyro* GetInstance (enum ID id);
+
+		/**
+		 * @brief Return instance ID
+		 */
+		enum ID GetID()
+		{
+			return this->id;
+		}
+
+		/**
+		 * @brief Poll last transaction, queue the next one (non blocking)
+		 * @return = 0 if no error, GYRO_ERROR_ABSENT if no gyro, < 0 else
+		 */
+		int32_t Sample ();
+
+		/**
+		 * @brief Get last yaw rate
+		 * @param rate : Yaw rate (rad/s, counterclockwise positive)
+		 * @return true if a new sample was read since last call
+		 */
+		bool GetRate (float32_t * rate);
+
+		/**
+		 * @brief Is gyro probed and running
+		 */
+		bool IsPresent ()
+		{
+			return (this->state == GYRO_STATE_RUN);
+		}
+
+		/**
+		 * @brief Get bus errors count
+		 */
+		uint32_t GetErrors ()
+		{
+			return this->errors;
+		}
+
+	private:
+
+		/**
+		 * @private
+		 * @brief Driver state
+		 */
+		enum State
+		{
+			GYRO_STATE_IDLE = 0,
+			GYRO_STATE_PROBE,
+			GYRO_STATE_CONFIG,
+			GYRO_STATE_RUN,
+			GYRO_STATE_ABSENT
+		};
+
+		/**
+		 * @private
+		 * @brief Gyro private constructor
+		 * @param id : Gyro ID
+		 */
+		Gyro(enum ID id);
+
+		/**
+		 * @private
+		 * @brief Queue a transaction
+		 * @param txLength : Bytes to write from txBuffer
+		 * @param rxLength : Bytes to read in rxBuffer
+		 */
+		int32_t queue (uint32_t txLength, uint32_t rxLength);
+
+		/**
+		 * @private
+		 * @brief Instance ID
+		 */
+		enum ID id;
+
+		/**
+		 * @private
+		 * @brief Peripheral definition
+		 */
+		GYRO_DEF def;
+
+		/**
+		 * @private
+		 * @brief I2C bus used to communicate with gyro
+		 */
+		I2C * bus;
+
+		/**
+		 * @private
+		 * @brief Current transaction and buffers
+		 */
+		I2CTransaction transaction;
+		uint8_t txBuffer[2];
+		uint8_t rxBuffer[2];
+
+		/**
+		 * @private
+		 * @brief Driver state, configuration step, errors, transaction queued
+		 */
+		enum State state;
+		uint32_t step;
+		uint32_t errors;
+		bool queued;
+
+		/**
+		 * @private
+		 * @brief Last yaw rate (rad/s), updated flag
+		 */
+		float32_t rate;
+		bool updated;
+	};
+}
+
+#endif /* INC_GYRO_HPP_ */
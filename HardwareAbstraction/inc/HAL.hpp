@@ -21,9 +21,18 @@
 #include "Serial.hpp"
 #include "Encoder.hpp"
 #include "Timer.hpp"
+#include "SoftTimer.hpp"
 #include "SPIMaster.hpp"
 #include "ExtDAC.hpp"
+#include "Gyro.hpp"
 #include "DRV8813.hpp"
+#include "DigitalInput.hpp"
+#include "Servo.hpp"
+#include "SWO.hpp"
+#include "Flash.hpp"
+#include "CAN.hpp"
+#include "Crc.hpp"
+#include "UsbCdc.hpp"
 
 // Other hardware objects
 
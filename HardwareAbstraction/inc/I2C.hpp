@@ -8,38 +8,48 @@
 #ifndef INC_I2C_HPP_
 #define INC_I2C_HPP_
 
-#include "stm32f4xx.h"
-#include "common.h"
+#include "I2CCommon.h"
+#include "SoftTimer.hpp"
+
+// FreeRTOS
+#include "FreeRTOS.h"
+#include "task.h"
 
 /*----------------------------------------------------------------------------*/
 /* Definitions                                                                */
 /*----------------------------------------------------------------------------*/
 
 /**
- * @brief I2C Definition structure
- * Used to define peripheral definition in order to initialize them
+ * @brief Transactions queue size (transactions queued by bus)
  */
-typedef struct
-{
-	// IO definitions
-	struct Pin
-	{
-		GPIO_TypeDef *	PORT;
-		uint16_t		PIN;
-		uint8_t			PINSOURCE;
-		uint8_t			AF;
-	}SDA;
+#define I2C_QUEUE_SIZE			(8u)
 
-	struct Pin SCL;
+/**
+ * @brief Transaction timeout : base (ms) and bytes by additional ms (400 kHz)
+ */
+#define I2C_TIMEOUT_MS			(5u)
+#define I2C_TIMEOUT_BYTES_MS	(32u)
 
-	// Timer definitions
-	struct Timer
-	{
-		I2C_TypeDef *	I2C;
-		uint32_t		CLOCKFREQ;
-		uint8_t			SLAVE_ADDR;
-	}I2C;
-}I2C_DEF;
+/**
+ * @brief Transaction completion callback (called from interrupt)
+ */
+typedef void (*I2C_CALLBACK)(void* obj);
+
+/**
+ * @brief I2C asynchronous transaction
+ * Owned by the caller, must stay valid until completion
+ */
+typedef struct
+{
+	uint8_t				slaveAddr;	/**< 8-bit slave address (R/W bit masked) */
+	uint8_t *			txBuffer;	/**< Data to write first */
+	uint32_t			txLength;	/**< Write length, 0 for a read only */
+	uint8_t *			rxBuffer;	/**< Data read after a repeated start */
+	uint32_t			rxLength;	/**< Read length, 0 for a write only */
+	I2C_CALLBACK		callback;	/**< Completion callback, may be NULL */
+	void *				obj;		/**< Callback parameter */
+	volatile int32_t	status;		/**< I2C_PENDING until completion, then error code */
+}I2CTransaction;
 
 /*----------------------------------------------------------------------------*/
 /* Class declaration	                                                      */
@@ -48,7 +58,20 @@ typedef struct
 namespace HAL
 {
 	/**
-	 * @brief I2C abstraction class
+	 * @brief I2C master abstraction class
+	 *
+	 * HOWTO :
+	 * - Get I2C instance with I2C::GetInstance()
+	 * - Queue a transaction with TransferAsync() (any task) : write then
+	 *   repeated start and read, data are moved by DMA and the callback is
+	 *   called from interrupt (transactions are served in order)
+	 * - Or use the blocking Transfer(), Write() and Read() (calling task
+	 *   sleeps meanwhile, scheduler must be started)
+	 *
+	 * Each transaction is guarded by a software timer : on timeout, bus or
+	 * arbitration error, the bus is released (SCL pulsed until slaves free
+	 * SDA, then stop) and the peripheral reset, next transaction goes on.
+	 * A single byte read is done by interrupt (DMA needs 2 bytes to NAK).
 	 */
 	class I2C
 	{
@@ -79,31 +102,47 @@ namespace HAL
 		}
 
 		/**
-		 * @brief Return interrupt state
+		 * @brief Is bus idle (no transaction queued)
 		 */
-		bool GetInterruptState ()
+		bool IsIdle ()
 		{
-			return this->intState;
+			return (this->queueRd == this->queueWr);
+		}
+
+		/**
+		 * @brief Return number of bus recoveries (timeout, bus or arbitration error)
+		 */
+		uint32_t GetRecoveries ()
+		{
+			return this->recoveries;
 		}
 
 		/**
 		 * @brief Send data
+		 * @param slaveAddr : 8-bit slave address (R/W bit masked)
 		 * @param buffer : Data buffer
 		 * @param nbBytes : Number of bytes to send
-		 * @return Number of bytes sent
+		 * @return Error code
 		 */
-		int32_t Write (uint8_t * buffer, uint32_t nbBytes);
+		int32_t Write (uint8_t slaveAddr, uint8_t * buffer, uint32_t nbBytes)
+		{
+			return this->Transfer(slaveAddr, buffer, nbBytes, NULL, 0u);
+		}
 
 		/**
 		 * @brief Read Data
+		 * @param slaveAddr : 8-bit slave address (R/W bit masked)
 		 * @param buffer : Data buffer
 		 * @param nbBytes : Number of bytes to read
-		 * @return Number of bytes read
+		 * @return Error code
 		 */
-		int32_t Read (uint8_t * buffer, uint32_t nbBytes);
+		int32_t Read (uint8_t slaveAddr, uint8_t * buffer, uint32_t nbBytes)
+		{
+			return this->Transfer(slaveAddr, NULL, 0u, buffer, nbBytes);
+		}
 
 		/**
-		 * @brief Manage whole I2C transfer
+		 * @brief Manage whole I2C transfer (blocking)
 		 * @param slaveAddr : 8-bit slave address (R/W bit masked)
 		 * @param txBuffer : Transmit buffer address
 		 * @param txNbBytes : Number of bytes to transmit
@@ -112,17 +151,31 @@ namespace HAL
 		 * @return Error code
 		 *
 		 * First, sends start bit then slave address + R/W bit = '0'. If slave ack, send all
-		 * data bytes. If the slave nak, function returns. Write sequence ends with stop bit.
-		 * Then, sends start bit plus slave address with R/W bit = '1'. If slave ack, read all
-		 * data bytes. Ends with NAK bit and returns.1
+		 * data bytes. If the slave nak, function returns. Write sequence ends with a repeated
+		 * start plus slave address with R/W bit = '1' (stop bit if nothing to read). If slave
+		 * ack, read all data bytes. Ends with NAK bit, stop bit and returns.
 		 */
 		int32_t Transfer (uint8_t slaveAddr, uint8_t * txBuffer, uint32_t txNbBytes, uint8_t * rxBuffer, uint32_t rxNbBytes);
 
+		/**
+		 * @brief Queue an asynchronous transaction (do not call from callback)
+		 * @param transaction : Transaction, valid until completion
+		 * @return = 0 if queued, I2C_ERROR_QUEUE_FULL else
+		 */
+		int32_t TransferAsync (I2CTransaction * transaction);
+
 		/**
 		 * @private
 		 * @brief Internal interrupt callback. DO NOT CALL !!
+		 * @param flag : I2C_FLAG_* event or error, 0 for DMA RX completion
+		 */
+		void INTERNAL_InterruptCallback (uint32_t flag);
+
+		/**
+		 * @private
+		 * @brief Transaction timeout (timer interrupt). DO NOT CALL !!
 		 */
-		void INTERNAL_InterruptCallback ();
+		void INTERNAL_Timeout ();
 
 	private:
 
@@ -141,15 +194,54 @@ namespace HAL
 
 		/**
 		 * @private
-		 * @brief Interrupt state
+		 * @brief Peripheral definition
 		 */
-		bool intState;
+		I2C_DEF def;
 
 		/**
 		 * @private
-		 * @brief Peripheral definition
+		 * @brief Transactions queue (head is in progress)
 		 */
-		I2C_DEF def;
+		I2CTransaction * queue[I2C_QUEUE_SIZE];
+		volatile uint32_t queueWr;
+		volatile uint32_t queueRd;
+
+		/**
+		 * @private
+		 * @brief Queue head is reading (write phase done or skipped)
+		 */
+		bool reading;
+
+		/**
+		 * @private
+		 * @brief Transaction watchdog
+		 */
+		SoftTimer timer;
+
+		/**
+		 * @private
+		 * @brief Bus recoveries counter
+		 */
+		uint32_t recoveries;
+
+		/**
+		 * @private
+		 * @brief Start queue head (start condition)
+		 */
+		void start ();
+
+		/**
+		 * @private
+		 * @brief End queue head, start next one and notify
+		 * @param status : Transaction error code
+		 */
+		void complete (int32_t status);
+
+		/**
+		 * @private
+		 * @brief Release a stuck bus and reset the peripheral
+		 */
+		void recover ();
 	};
 }
 
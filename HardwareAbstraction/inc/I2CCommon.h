@@ -15,7 +15,7 @@
 /* Definitions                                                                */
 /*----------------------------------------------------------------------------*/
 
-#define I2C_MAX_BUFFER_SIZE		(8u)
+#define I2C_MAX_BUFFER_SIZE		(8u)	/**< Frames ring size (power of 2) */
 #define I2C_MAX_FRAME_SIZE		(32u)
 
 #define I2C_ERROR_NO_FRAME_BUFFERED			(-1)	/**< No incoming frame buffered */
@@ -25,6 +25,10 @@
 #define I2C_ERROR_PACKET_ERROR				(-5)
 #define I2C_ERROR_TIMEOUT					(-6)
 #define I2C_ERROR_SLAVE_SEND_DATA_FAILED	(-7)
+#define I2C_ERROR_BUFFER_FULL				(-8)	/**< Frame dropped, ring is full */
+#define I2C_ERROR_QUEUE_FULL				(-9)	/**< Master transaction not queued */
+#define I2C_ERROR_ARBITRATION_LOST			(-10)
+#define I2C_PENDING							(1)		/**< Master transaction not completed */
 
 /**
  * @brief I2C Definition structure
@@ -58,6 +62,17 @@ typedef struct
 		uint8_t	EV_CHANNEL;		/**< Interrupt IRQ Channel */
 		uint8_t	ER_CHANNEL;		/**< Interrupt IRQ Channel */
 	}INT;
+
+	// DMA stream definitions
+	struct Dma
+	{
+		DMA_Stream_TypeDef *	STREAM;
+		uint32_t				CHANNEL;
+		uint32_t				FLAGS;			/**< All stream flags (used to clear stream) */
+		uint8_t					INT_CHANNEL;	/**< Stream IRQ Channel (master RX only) */
+	}DMA_TX;
+
+	struct Dma DMA_RX;
 }I2C_DEF;
 
 /**
@@ -81,14 +96,4 @@ typedef struct
 	uint8_t			CRCval;						/**< CRC-8 value */
 }I2C_FRAME;
 
-/**
- * brief Frame Buffer
- */
-typedef struct
-{
-	uint32_t 	rdIndex;						/**< Frame write index */
-	uint32_t 	wrIndex;						/**< Frame read index */
-	I2C_FRAME 	frame[I2C_MAX_BUFFER_SIZE];		/**< Frame buffer */
-}I2C_FRAMEBUFFERR;
-
 #endif /* INC_I2CCOMMON_H_ */
@@ -10,11 +10,30 @@
 
 #include "I2CCommon.h"
 #include "Event.hpp"
+#include "Ring.hpp"
 
 /*----------------------------------------------------------------------------*/
 /* Definitions                                                                */
 /*----------------------------------------------------------------------------*/
 
+/**
+ * @brief Read request callback (called in interrupt context)
+ * @param obj : Instance given on registration
+ * @param reg : Selected register (first byte of the last written frame)
+ * @param buffer : Response bytes
+ * @param size : Response buffer size
+ * @return Response length
+ */
+typedef uint32_t (*I2C_READ_CALLBACK) (void * obj, uint8_t reg, uint8_t * buffer, uint32_t size);
+
+/**
+ * @brief Prepared response callback (called in interrupt context)
+ * @param obj : Instance given on registration
+ * @param reg : Selected register
+ * @return Response built by BuildResponse() (I2C_MAX_FRAME_SIZE bytes, sent as is),
+ *         NULL to build it with the read callback
+ */
+typedef const uint8_t * (*I2C_RESPONSE_CALLBACK) (void * obj, uint8_t reg);
 
 /*----------------------------------------------------------------------------*/
 /* Class declaration	                                                      */
@@ -24,6 +43,20 @@ namespace HAL
 {
 	/**
 	 * @brief I2CSlave abstraction class
+	 *
+	 * Register based slave, every transfer is followed by a CRC-8 (SMBus, address byte included) :
+	 *  - Write : [reg][data...][crc], data received by DMA and CRC checked in interrupt.
+	 *    Valid frames are pushed in a ring and read with Read(). A frame without data
+	 *    only selects the register for following reads.
+	 *  - Read : [data...][crc], data built by the read callback and sent by DMA.
+	 *    Responses prepared in advance with BuildResponse() (response callback) are
+	 *    sent without copy nor CRC computation : constant turnaround on address match.
+	 *  - General call : write frames to address 0 reach every board on the bus, their
+	 *    CRC covers address byte 0. Each board keeps its own address (SetAddress()).
+	 *  - Pre-armed reads : a frame selecting a prepared register arms the TX stream at
+	 *    once (after its stop), the read address match then only starts the stream.
+	 *  - Recovery : a bus error, an overrun or a transfer stalled across I2C_STUCK_CHECKS
+	 *    calls to Supervise() resets the peripheral (address kept, GetRecoveries()).
 	 */
 	class I2CSlave
 	{
@@ -66,11 +99,40 @@ namespace HAL
 		}
 
 		/**
-		 * @brief Send frame
-		 * @param frame : I2C Frame
-		 * @return Number of bytes sent or error code (if return value < 0)
+		 * @brief Change own address (before the master talks to this slave)
+		 * @param address : Slave address (same format as I2C_DEF SLAVE_ADDR)
 		 */
-		int32_t Write (I2C_FRAME * frame);
+		void SetAddress (uint8_t address);
+
+		/**
+		 * @brief Return own address
+		 */
+		uint8_t GetAddress ()
+		{
+			return this->def.I2C.SLAVE_ADDR;
+		}
+
+		/**
+		 * @brief Register read request callback
+		 * @param obj : Instance passed to the callback
+		 * @param cb : Callback building the response of a register (interrupt context)
+		 */
+		void SetReadCallback (void * obj, I2C_READ_CALLBACK cb);
+
+		/**
+		 * @brief Register prepared response callback (tried before the read callback)
+		 * @param obj : Instance passed to the callback
+		 * @param cb : Callback returning the prepared response of a register (interrupt context)
+		 */
+		void SetResponseCallback (void * obj, I2C_RESPONSE_CALLBACK cb);
+
+		/**
+		 * @brief Build a read response : data, CRC and padding (any context)
+		 * @param data : Register data (may be response itself)
+		 * @param length : Data length (< I2C_MAX_FRAME_SIZE)
+		 * @param response : I2C_MAX_FRAME_SIZE bytes response, must stay valid while sent
+		 */
+		void BuildResponse (const void * data, uint32_t length, uint8_t * response);
 
 		/**
 		 * @brief Read incoming frame
@@ -79,6 +141,59 @@ namespace HAL
 		 */
 		int32_t Read (I2C_FRAME * frame);
 
+		/**
+		 * @brief Return register of the last valid written frame (interrupt context : frame being raised)
+		 */
+		uint8_t GetSelected ()
+		{
+			return this->selected;
+		}
+
+		/**
+		 * @brief Return number of frames dropped on CRC error
+		 */
+		uint32_t GetCRCErrors ()
+		{
+			return this->crcErrors;
+		}
+
+		/**
+		 * @brief Return number of frames dropped on full ring
+		 */
+		uint32_t GetOverruns ()
+		{
+			return this->overruns;
+		}
+
+		/**
+		 * @brief Return number of peripheral resets (bus errors, stalled transfers)
+		 */
+		uint32_t GetRecoveries ()
+		{
+			return this->recoveries;
+		}
+
+		/**
+		 * @brief Return number of bytes transferred (both directions, address bytes included, free running)
+		 */
+		uint32_t GetBytes ()
+		{
+			return this->bytes;
+		}
+
+		/**
+		 * @brief Return bus clock (Hz)
+		 */
+		uint32_t GetBitRate ()
+		{
+			return this->def.I2C.CLOCKFREQ;
+		}
+
+		/**
+		 * @brief Reset the peripheral if a transfer is stalled (task context, call periodically)
+		 */
+		void Supervise ();
+
 		/**
 		 * @private
 		 * @brief Internal interrupt callback. DO NOT CALL !!
@@ -88,17 +203,17 @@ namespace HAL
 		/**
 		 * @brief Event raised when slave address matched and master transmitted data (write operation)
 		 */
-		Utils::Event DataReceived;
+		Utils::Event<> DataReceived;
 
 		/**
 		 * @brief Event raised when slave address matched and master is requesting data (read operation)
 		 */
-		Utils::Event DataRequest;
+		Utils::Event<> DataRequest;
 
 		/**
 		 * @brief Event raised when an error occurred during a transaction
 		 */
-		Utils::Event ErrorOccurred;
+		Utils::Event<> ErrorOccurred;
 
 	private:
 
@@ -125,21 +240,143 @@ namespace HAL
 
 		/**
 		 * @private
-		 * @brief Received frame buffer
+		 * @brief Received frame ring
+		 */
+		Utils::SpscRing<I2C_FRAME, I2C_MAX_BUFFER_SIZE> buffer;
+
+		/**
+		 * @private
+		 * @brief Frame received when the ring is full (dropped)
+		 */
+		I2C_FRAME scratch;
+
+		/**
+		 * @private
+		 * @brief Frame being received by DMA, NULL if none
+		 */
+		I2C_FRAME * rxFrame;
+
+		/**
+		 * @private
+		 * @brief Response being sent by DMA (CRC included)
+		 */
+		uint8_t txData[I2C_MAX_FRAME_SIZE];
+
+		/**
+		 * @private
+		 * @brief Response transmission in progress
+		 */
+		bool txActive;
+
+		/**
+		 * @private
+		 * @brief TX stream armed with the selected register response (before address match)
+		 */
+		bool txArmed;
+
+		/**
+		 * @private
+		 * @brief Frame being received was addressed by general call
+		 */
+		bool generalCall;
+
+		/**
+		 * @private
+		 * @brief Register selected by the last written frame
+		 */
+		uint8_t selected;
+
+		/**
+		 * @private
+		 * @brief Read request callback
+		 */
+		I2C_READ_CALLBACK readCallback;
+
+		/**
+		 * @private
+		 * @brief Read request callback instance
+		 */
+		void * readObj;
+
+		/**
+		 * @private
+		 * @brief Prepared response callback and instance
+		 */
+		I2C_RESPONSE_CALLBACK responseCallback;
+		void * responseObj;
+
+		/**
+		 * @private
+		 * @brief Frames dropped on CRC error
+		 */
+		uint32_t crcErrors;
+
+		/**
+		 * @private
+		 * @brief Frames dropped on full ring
+		 */
+		uint32_t overruns;
+
+		/**
+		 * @private
+		 * @brief Peripheral resets
+		 */
+		uint32_t recoveries;
+
+		/**
+		 * @private
+		 * @brief Bytes transferred (interrupt)
+		 */
+		volatile uint32_t bytes;
+
+		/**
+		 * @private
+		 * @brief Interrupt events (written in interrupt), value seen by last Supervise() call
+		 */
+		volatile uint32_t events;
+		uint32_t supervisedEvents;
+
+		/**
+		 * @private
+		 * @brief Consecutive Supervise() calls with a busy bus and no event
+		 */
+		uint32_t stuck;
+
+		/**
+		 * @private
+		 * @brief Start DMA reception of a written frame
+		 */
+		void startReception ();
+
+		/**
+		 * @private
+		 * @brief Stop DMA reception, check CRC and push frame
+		 */
+		void endOfReception ();
+
+		/**
+		 * @private
+		 * @brief Arm TX stream with the selected register prepared response (if any)
+		 */
+		void armTransmission ();
+
+		/**
+		 * @private
+		 * @brief Build selected register response (unless armed) and start DMA transmission
 		 */
-		I2C_FRAMEBUFFERR buffer;
+		void startTransmission ();
 
 		/**
 		 * @private
-		 * @brief Previous CRC value
+		 * @brief Stop DMA transmission (master NAK or stop)
 		 */
-		uint8_t prevCRC;
+		void endOfTransmission ();
 
 		/**
 		 * @private
-		 * @brief Current CRC value
+		 * @brief Stop transfers and reset the peripheral (interrupts masked)
 		 */
-		uint8_t curCRC;
+		void recover ();
 	};
 }
 
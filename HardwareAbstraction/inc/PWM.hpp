@@ -15,6 +15,9 @@
 /* Definitions                                                                */
 /*----------------------------------------------------------------------------*/
 
+#define PWM_GROUP_SIZE		(10u)	// channels per group
+#define PWM_GROUP_TIMERS	(4u)	// distinct timers per group
+
 /**
  * @brief PWM Definition structure
  * Used to define peripheral definition in order to initialize them
@@ -61,11 +64,15 @@ namespace HAL
 	 * HOWTO :
 	 * - Get PWM instance with PWM::GetInstance()
 	 * - Use SetDutyCycle() methods to update PWM duty cycle
+	 * - Use SetCompare() or SetDutyCyclePermille() in interrupts (integer,
+	 *   compare register only, preloaded : applied on next period)
 	 * - Use SetFrequency() method to update PWM frequency
 	 * - Use SetState() method to enable or disable PWM
 	 */
 	class PWM
 	{
+		friend class PWMGroup;
+
 	public:
 
 		/**
@@ -134,6 +141,37 @@ namespace HAL
 		 */
 		void SetDutyCycle (float32_t percent);
 
+		/**
+		 * @brief Write compare register (0 to GetCompareMax()), no conversion
+		 * GetDutyCycle() is not updated, for interrupt use
+		 * @param ccr : Compare value
+		 */
+		void SetCompare (uint32_t ccr)
+		{
+			*this->ccr = ccr;
+		}
+
+		/**
+		 * @brief Set PWM duty cycle in 1/1000, integer only
+		 * GetDutyCycle() is not updated, for interrupt use
+		 * @param permille : Duty cycle, 0 to 1000
+		 */
+		void SetDutyCyclePermille (uint16_t permille)
+		{
+			if(permille > 1000u)
+				permille = 1000u;
+
+			*this->ccr = (this->arr * permille) / 1000u;
+		}
+
+		/**
+		 * @brief Return compare value of a 100% duty cycle (auto reload value)
+		 */
+		uint32_t GetCompareMax ()
+		{
+			return this->arr;
+		}
+
 		/**
 		 * @brief Return current PWM duty cycle
 		 */
@@ -162,6 +200,22 @@ namespace HAL
 		 */
 		void SetState (PWM::State state);
 
+		/**
+		 * @brief Return PWM timer (DMA burst, synchronization)
+		 */
+		TIM_TypeDef* GetTimer ()
+		{
+			return this->def.TIMER.TIMER;
+		}
+
+		/**
+		 * @brief Return PWM timer channel (TIM_Channel_x)
+		 */
+		uint16_t GetChannel ()
+		{
+			return this->def.TIMER.CHANNEL;
+		}
+
 		/**
 		 * @brief Return current PWM state
 		 */
@@ -203,11 +257,116 @@ namespace HAL
 		 */
 		uint32_t frequency;
 
+		/**
+		 * @private
+		 * @brief Auto reload value of frequency (cached, ARR written on frequency change only)
+		 */
+		uint32_t arr;
+
 		/**
 		 * @private
 		 * @brief State
 		 */
 		PWM::State state;
+
+		/**
+		 * @private
+		 * @brief Channel compare register
+		 */
+		volatile uint32_t* ccr;
+	};
+
+	/**
+	 * @class PWMGroup
+	 * @brief Synchronized update of several PWM channels
+	 *
+	 * Compare values are staged then written together while timer update
+	 * events are held (UDIS), so every channel of the group switches on
+	 * the same PWM period.
+	 *
+	 * HOWTO :
+	 * - Add() channels once (PWM_GROUP_SIZE channels, PWM_GROUP_TIMERS timers)
+	 * - Stage() new compare values, only changed values are flagged
+	 * - Commit() writes flagged compare registers, optionally with resync
+	 *   (update event generated on every timer, counters restart together)
+	 */
+	class PWMGroup
+	{
+	public:
+
+		/**
+		 * @brief Empty group constructor
+		 */
+		PWMGroup ();
+
+		/**
+		 * @brief Add a channel to group
+		 * @param pwm : PWM instance
+		 * @return Channel index in group, -1 if group is full
+		 */
+		int32_t Add (PWM* pwm);
+
+		/**
+		 * @brief Stage a compare value, written on next Commit()
+		 * @param index : Channel index returned by Add()
+		 * @param ccr : Compare value (0 to GetCompareMax())
+		 */
+		void Stage (uint32_t index, uint32_t ccr)
+		{
+			if(this->value[index] != ccr)
+			{
+				this->value[index] = ccr;
+				this->dirty |= (1u << index);
+			}
+		}
+
+		/**
+		 * @brief Write staged compare values together
+		 * @param resync : Generate update event on all timers (restart counters)
+		 */
+		void Commit (bool resync = false);
+
+		/**
+		 * @brief Read back compare registers (written by another path, i.e. DMA)
+		 */
+		void Reload (void)
+		{
+			for(uint32_t i = 0u; i < this->count; i++)
+				this->value[i] = *this->ccr[i];
+		}
+
+	private:
+
+		/**
+		 * @private
+		 * @brief Channel compare registers
+		 */
+		volatile uint32_t* ccr[PWM_GROUP_SIZE];
+
+		/**
+		 * @private
+		 * @brief Staged compare values
+		 */
+		uint32_t value[PWM_GROUP_SIZE];
+
+		/**
+		 * @private
+		 * @brief Timers of group channels (distinct)
+		 */
+		TIM_TypeDef* timer[PWM_GROUP_TIMERS];
+
+		/**
+		 * @private
+		 * @brief Channel and timer count
+		 */
+		uint8_t count;
+		uint8_t timerCount;
+
+		/**
+		 * @private
+		 * @brief Changed values, bit per channel
+		 */
+		uint32_t dirty;
 	};
 }
 
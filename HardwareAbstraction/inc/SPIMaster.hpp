@@ -11,11 +11,44 @@
 #include "stm32f4xx.h"
 #include "common.h"
 
+// FreeRTOS
+#include "FreeRTOS.h"
+#include "task.h"
+
 /*----------------------------------------------------------------------------*/
 /* Definitions                                                                */
 /*----------------------------------------------------------------------------*/
 
 #define SPI_ERROR_TIMEOUT		(-1)
+#define SPI_ERROR_QUEUE_FULL	(-2)
+#define SPI_PENDING				(1)
+
+/**
+ * @brief Transfer queue size (transactions queued by bus)
+ */
+#define SPI_QUEUE_SIZE			(8u)
+
+/**
+ * @brief Transaction completion callback (called from DMA interrupt)
+ */
+typedef void (*SPI_CALLBACK)(void* obj);
+
+/**
+ * @brief SPI asynchronous transaction
+ * Owned by the caller, must stay valid until completion
+ */
+typedef struct
+{
+	uint8_t *			txBuffer;	/**< Data to transmit */
+	uint8_t *			rxBuffer;	/**< Received data, NULL to discard them */
+	uint32_t			length;		/**< Transfer length */
+	uint32_t			frameLength;/**< nCS is pulsed high every frameLength bytes, 0 for none */
+	GPIO_TypeDef *		csPort;		/**< Device nCS port, NULL for bus nCS */
+	uint16_t			csPin;		/**< Device nCS pin */
+	SPI_CALLBACK		callback;	/**< Completion callback, may be NULL */
+	void *				obj;		/**< Callback parameter */
+	volatile int32_t	status;		/**< SPI_PENDING until completion, then = 0 */
+}SPITransaction;
 
 /**
  * @brief SPIMaster Definition structure
@@ -44,6 +77,22 @@ typedef struct
 		uint16_t		CLOCKPOLARITY;
 		uint16_t		CLOCKPHASE;
 	}SPI;
+
+	struct Int
+	{
+		uint8_t	PRIORITY;		/**< Interrupt priority, 0 to 15, 0 is the highest priority */
+	}INT;
+
+	// DMA stream definitions
+	struct Dma
+	{
+		DMA_Stream_TypeDef *	STREAM;
+		uint32_t				CHANNEL;
+		uint32_t				FLAGS;			/**< All stream flags (used to clear stream) */
+		uint8_t					INT_CHANNEL;	/**< Stream IRQ Channel */
+	}DMA_TX;
+
+	struct Dma DMA_RX;
 }SPIMaster_DEF;
 
 /*----------------------------------------------------------------------------*/
@@ -54,6 +103,14 @@ namespace HAL
 {
 	/**
 	 * @brief SPIMaster abstraction class
+	 *
+	 * HOWTO :
+	 * - Get SPIMaster instance with SPIMaster::GetInstance()
+	 * - Queue a transaction with TransferAsync(), nCS is driven and
+	 *   data are transfered by DMA, then callback is called from the
+	 *   DMA interrupt (transactions are served in order)
+	 * - Or use the blocking Transfer() (calling task sleeps meanwhile,
+	 *   polled while the scheduler is not started)
 	 */
 	class SPIMaster
 	{
@@ -88,9 +145,44 @@ namespace HAL
 		 * @param txBuffer : Data to transmit buffer
 		 * @param rxBuffer : Received data buffer
 		 * @param length : Transfer length
+		 * @param frameLength : nCS is pulsed high every frameLength bytes, 0 for none
 		 * @return = 0 if no error, < 0 else
 		 */
-		int32_t Transfer (uint8_t * txBuffer, uint8_t * rxBuffer, uint32_t length);
+		int32_t Transfer (uint8_t * txBuffer, uint8_t * rxBuffer, uint32_t length, uint32_t frameLength = 0u);
+
+		/**
+		 * @brief Queue an asynchronous transaction (do not call from callback)
+		 * @param transaction : Transaction, valid until completion
+		 * @return = 0 if queued, SPI_ERROR_QUEUE_FULL else
+		 */
+		int32_t TransferAsync (SPITransaction * transaction);
+
+		/**
+		 * @brief Is bus idle (no transaction queued)
+		 */
+		bool IsIdle ()
+		{
+			return (this->queueRd == this->queueWr);
+		}
+
+		/**
+		 * @brief Return number of bytes transferred (free running)
+		 */
+		uint32_t GetBytes ()
+		{
+			return this->bytes;
+		}
+
+		/**
+		 * @brief Return bus clock (Hz)
+		 */
+		uint32_t GetBitRate ();
+
+		/**
+		 * @private
+		 * @brief DMA RX complete interrupt callback. DO NOT CALL !!
+		 */
+		void INTERNAL_InterruptCallback ();
 
 	private:
 
@@ -112,6 +204,66 @@ namespace HAL
 		 * @brief Peripheral definition
 		 */
 		SPIMaster_DEF def;
+
+		/**
+		 * @private
+		 * @brief Transactions queue (head is in progress)
+		 */
+		SPITransaction * queue[SPI_QUEUE_SIZE];
+		volatile uint32_t queueWr;
+		volatile uint32_t queueRd;
+
+		/**
+		 * @private
+		 * @brief Queue head progress (bytes already transfered)
+		 */
+		uint32_t offset;
+
+		/**
+		 * @private
+		 * @brief Bytes transferred (DMA interrupt and polled transfers)
+		 */
+		volatile uint32_t bytes;
+
+		/**
+		 * @private
+		 * @brief Dummy bytes (received data discarded)
+		 */
+		uint8_t dummy;
+
+		/**
+		 * @private
+		 * @brief Start DMA transfer of the queue head
+		 */
+		void start ();
+
+		/**
+		 * @private
+		 * @brief Return length of the next frame of a transaction
+		 */
+		static uint32_t frameSize (SPITransaction * transaction, uint32_t offset)
+		{
+			uint32_t size = transaction->length - offset;
+
+			if((transaction->frameLength != 0u) && (transaction->frameLength < size))
+			{
+				size = transaction->frameLength;
+			}
+
+			return size;
+		}
+
+		/**
+		 * @private
+		 * @brief Drive transaction nCS
+		 */
+		void select (SPITransaction * transaction, bool selected);
+
+		/**
+		 * @private
+		 * @brief Polled transfer (scheduler not started)
+		 */
+		int32_t transferPolled (SPITransaction * transaction);
 	};
 }
 
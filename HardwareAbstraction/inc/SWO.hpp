@@ -0,0 +1,118 @@
+/**
+ * @file	SWO.hpp
+ * @author	Kevin WYSOCKI
+ * @date	22 oct. 2017
+ * @brief	ITM stimulus ports output on the SWO pin
+ */
+
+#ifndef INC_SWO_HPP_
+#define INC_SWO_HPP_
+
+#include "stm32f4xx.h"
+#include "common.h"
+
+/*----------------------------------------------------------------------------*/
+/* Definitions                                                                */
+/*----------------------------------------------------------------------------*/
+
+#define SWO_BAUDRATE			(2250000u)	/**< Asynchronous (NRZ) bit rate, HCLK divider */
+
+/*----------------------------------------------------------------------------*/
+/* Class declaration	                                                      */
+/*----------------------------------------------------------------------------*/
+
+/**
+ * @namespace HAL
+ */
+namespace HAL
+{
+	/**
+	 * @class SWO
+	 * @brief ITM / SWO debug output
+	 *
+	 * HOWTO :
+	 * - Get instance with SWO::GetInstance(), ITM and TPIU are configured,
+	 *   all ports are disabled
+	 * - Enable() the ports to route, Write() data on a port
+	 * - Read with a probe decoding SWO at SWO_BAUDRATE (ITM stimulus ports)
+	 *
+	 * Each port is a separate channel on the host side :
+	 * - LOG : stdout (printf), instead of SERIAL0, see _write()
+	 * - TELEMETRY : Diag binary frames
+	 * - TRACE : Diag trace dump (Utils::Trace)
+	 *
+	 * The SWO pin (PB3) is also SPI1 SCK of the current reference DAC : it is
+	 * switched to TRACESWO while a port is enabled and given back to SPI1 when
+	 * all ports are disabled. DAC updates are lost in between : enable SWO on a
+	 * bench or with steppers disabled.
+	 *
+	 * Write() waits for the stimulus port FIFO (a few cycles per byte at
+	 * SWO_BAUDRATE), a port must be written by one context only.
+	 */
+	class SWO
+	{
+	public:
+
+		/**
+		 * @brief Stimulus port list
+		 */
+		enum PORT
+		{
+			LOG = 0,		//!< Stimulus port 0, stdout
+			TELEMETRY,		//!< Stimulus port 1, telemetry frames
+			TRACE,			//!< Stimulus port 2, trace dump
+			PORT_MAX
+		};
+
+		/**
+		 * @brief Get instance method
+		 * @return SWO instance
+		 */
+		static SWO* GetInstance ();
+
+		/**
+		 * @brief Return true if a port is routed to SWO (false if no instance)
+		 * @param port : Stimulus port
+		 */
+		static bool IsRouted (enum PORT port);
+
+		/**
+		 * @brief Enable or disable a port
+		 * @param port : Stimulus port
+		 * @param enable : true to route port data on SWO
+		 */
+		void Enable (enum PORT port, bool enable);
+
+		/**
+		 * @brief Return true if a port is enabled
+		 * @param port : Stimulus port
+		 */
+		bool IsEnabled (enum PORT port);
+
+		/**
+		 * @brief Write data on a port
+		 * @param port : Stimulus port
+		 * @param data : Data buffer
+		 * @param length : Data length
+		 * @return Bytes written, 0 if port is disabled
+		 */
+		uint32_t Write (enum PORT port, const uint8_t* data, uint32_t length);
+
+	private:
+
+		/**
+		 * @private
+		 * @brief SWO private constructor
+		 */
+		SWO ();
+
+		/**
+		 * @private
+		 * @brief Switch the SWO pin between TRACESWO and SPI1 SCK
+		 * @param swo : true for TRACESWO
+		 */
+		void claimPin (bool swo);
+	};
+}
+
+#endif /* INC_SWO_HPP_ */
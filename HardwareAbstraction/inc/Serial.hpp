@@ -10,13 +10,22 @@
 
 #include "stm32f4xx.h"
 #include <stdint.h>
-#include <string>
 #include "Event.hpp"
+#include "UsbCdc.hpp"
+
+#include "FreeRTOS.h"
+#include "task.h"
 
 /*----------------------------------------------------------------------------*/
 /* Definitions                                                                */
 /*----------------------------------------------------------------------------*/
 
+/**
+ * @brief Console link : stdout, CLI, binary protocol and Diag frames
+ * SERIAL_USB for telemetry and trace dumps at USB full speed
+ */
+#define SERIAL_CONSOLE			(HAL::Serial::SERIAL0)
+
 /**
  * @brief USART Definition structure
  * Used to define peripheral definition in order to initialize them
@@ -48,6 +57,17 @@ typedef struct
 		uint8_t	CHANNEL;		/**< Interrupt IRQ Channel */
 	}INT;
 
+	// DMA stream definitions
+	struct Dma
+	{
+		DMA_Stream_TypeDef *	STREAM;
+		uint32_t				CHANNEL;
+		uint32_t				FLAGS;			/**< All stream flags (used to clear stream) */
+		uint8_t					INT_CHANNEL;	/**< Stream IRQ Channel */
+	}DMA_TX;
+
+	struct Dma DMA_RX;
+
 
 }SERIAL_DEF;
 
@@ -69,8 +89,19 @@ namespace HAL
 	 * - Use Send() methods to send data
 	 * - Use Read() to peek one or more data
 	 * - OnDataReceivedCallback or OnEndOfTransmissionCallback have to be used to
-	 * be notified of data received or end of transmission event. No data can be send if
-	 * there is already data being sent.
+	 * be notified of data received or end of transmission event.
+	 *
+	 * TX and RX are circular buffers served by DMA: Send() only copies data
+	 * into TX buffer, RX buffer is filled continuously (idle line is notified).
+	 *
+	 * Frame producers can serialize in place : Reserve() returns a contiguous
+	 * TX block (the buffer end is skipped if too short), Commit() queues the
+	 * bytes actually written. Other writers queue their bytes after the block,
+	 * they are sent once it is committed.
+	 *
+	 * SERIAL_USB serves the same buffers from USB CDC bulk transfers (see
+	 * UsbCdc) : TX data waits in buffer until a host configures the device,
+	 * the host is held when RX buffer is full instead of losing bytes.
 	 */
 	class Serial
 	{
@@ -83,6 +114,7 @@ namespace HAL
 		{
 			SERIAL0,  //!< UART1
 			SERIAL1,  //!< UART3
+			SERIAL_USB,	//!< USB CDC virtual COM port
 			SERIAL_MAX
 		};
 
@@ -105,18 +137,21 @@ namespace HAL
 		/**
 		 * @brief Return the number of buffered bytes read to be read
 		 */
-		uint32_t BytesToRead()
-		{
-			return (this->rxBuffer.wrIndex - this->rxBuffer.wrIndex);
-		}
+		uint32_t BytesToRead();
+
+		/**
+		 * @brief Block the calling task until received bytes are buffered
+		 * @param timeout : Maximum waiting time (ticks)
+		 * @return true if bytes are ready to be read, false on timeout
+		 *
+		 * Only one task at a time can wait on a Serial instance.
+		 */
+		bool WaitForData (TickType_t timeout);
 
 		/**
 		 * @brief Return the number of buffered bytes left to be transmitted
 		 */
-		uint32_t BytesToSend()
-		{
-			return (this->txBuffer.wrIndex - this->rxBuffer.rdIndex);
-		}
+		uint32_t BytesToSend();
 
 		/**
 		 * @brief Send a single byte
@@ -125,13 +160,6 @@ namespace HAL
 		 */
 		bool Send (uint8_t byte);
 
-		/**
-		 * @brief Send a string
-		 * @param str : string to send
-		 * @return true if string has been buffered to be sent, false else
-		 */
-		bool Send (std::string& str);
-
 		/**
 		 * @brief Send a C-type string (NULL terminated)
 		 * @param c_str : C-type string
@@ -147,9 +175,66 @@ namespace HAL
 		 */
 		bool Send (const uint8_t * buffer, uint32_t length);
 
+		/**
+		 * @brief Buffer as many bytes as possible
+		 * @param buffer : Bytes to send buffer
+		 * @param length : Number of bytes to send
+		 * @return Number of bytes buffered
+		 */
+		uint32_t Write (const uint8_t * buffer, uint32_t length);
+
+		/**
+		 * @brief Buffer as many bytes as possible, never blocks
+		 * Bytes not buffered are dropped and counted (see GetDropped())
+		 * @param buffer : Bytes to send buffer
+		 * @param length : Number of bytes to send
+		 * @return Number of bytes buffered
+		 */
+		uint32_t Post (const uint8_t * buffer, uint32_t length);
+
+		/**
+		 * @brief Reserve a contiguous TX block, written in place by the caller
+		 * @param length : Block length (largest output)
+		 * @return Block or NULL if TX buffer is full or a block is already reserved (length is dropped)
+		 */
+		uint8_t * Reserve (uint32_t length);
+
+		/**
+		 * @brief Queue the reserved block for transmission
+		 * @param length : Number of bytes written (<= reserved length)
+		 *
+		 * Unused bytes are given back, or sent as 0x00 (COBS delimiters) if
+		 * another writer queued bytes after the block meanwhile.
+		 */
+		void Commit (uint32_t length);
+
+		/**
+		 * @brief Return number of bytes dropped by Send(), Post() and Reserve() (TX buffer full)
+		 */
+		uint32_t GetDropped ()
+		{
+			return this->txDropped;
+		}
+
+		/**
+		 * @brief Return number of bytes sent (free running)
+		 */
+		uint32_t GetSent ()
+		{
+			return this->txSent;
+		}
+
+		/**
+		 * @brief Return line rate (bit/s), 0 for SERIAL_USB
+		 */
+		uint32_t GetBitRate ()
+		{
+			return (this->usb != NULL) ? 0u : this->def.USART.BAUDRATE;
+		}
+
 		/**
 		 * @brief Read one buffered bytes
-		 * @return Next byte to read if more than one byte buffered, last received byte else
+		 * @return Next byte to read if more than one byte buffered, 0 else
 		 */
 		uint8_t Read ();
 
@@ -164,19 +249,35 @@ namespace HAL
 
 		/**
 		 * @brief Read a '\n' terminated string
-		 * @return string instance if a character '\n' is found, NULL else
+		 * @param buffer : Buffer where the NULL terminated line is stored ('\n' included)
+		 * @param size : Buffer size (a longer line is consumed and truncated)
+		 * @return Line length if a character '\n' is found, 0 else
 		 */
-		std::string ReadLine ();
+		uint32_t ReadLine (char * buffer, uint32_t size);
+
+		/**
+		 * @brief Watch received bytes for a break character
+		 * @param c : Break character, '\0' to stop watching
+		 *
+		 * The byte stays in RX buffer, BreakReceived is raised from the RX
+		 * interrupt (idle line or DMA), before any task reads it.
+		 */
+		void SetBreakChar (char c);
 
 		/**
 		 * @brief Data received event
 		 */
-		Utils::Event DataReceived;
+		Utils::Event<> DataReceived;
+
+		/**
+		 * @brief Break character received event (interrupt context, see SetBreakChar())
+		 */
+		Utils::Event<> BreakReceived;
 
 		/**
 		 * @brief End of transmission event
 		 */
-		Utils::Event EndOfTransmission;
+		Utils::Event<> EndOfTransmission;
 
 		/**
 		 * @private
@@ -193,9 +294,10 @@ namespace HAL
 		 */
 		typedef struct
 		{
-			uint8_t * data;		/**< FIFO pointer) */
-			uint32_t wrIndex;	/**< FIFO write index */
-			uint32_t rdIndex;	/**< FIFO read index */
+			uint8_t * data;				/**< FIFO pointer */
+			uint32_t size;				/**< FIFO size */
+			volatile uint32_t wrIndex;	/**< FIFO write index */
+			volatile uint32_t rdIndex;	/**< FIFO read index */
 		}SERIAL_BUFFER;
 
 		/**
@@ -217,6 +319,12 @@ namespace HAL
 		 */
 		SERIAL_DEF def;
 
+		/**
+		 * @private
+		 * @brief USB device, NULL for UART links
+		 */
+		UsbCdc * usb;
+
 		/**
 		 * @private
 		 * @brief RX FIFO
@@ -228,6 +336,84 @@ namespace HAL
 		 * @brief TX FIFOs
 		 */
 		SERIAL_BUFFER txBuffer;
+
+		/**
+		 * @private
+		 * @brief TX allocation : end of queued bytes (txBuffer.wrIndex is the end
+		 * of bytes DMA may send), and wrap point (bytes from txEnd to the buffer
+		 * end are skipped, a reserved block did not fit)
+		 */
+		volatile uint32_t txHead;
+		volatile uint32_t txEnd;
+
+		/**
+		 * @private
+		 * @brief Reserved TX block, not committed yet
+		 */
+		volatile bool txReserved;
+		uint32_t txReserveIndex;
+		uint32_t txReserveLength;
+
+		/**
+		 * @private
+		 * @brief Number of bytes of the current DMA transmission, 0 if DMA is idle
+		 */
+		volatile uint32_t txLength;
+
+		/**
+		 * @private
+		 * @brief Number of bytes dropped, TX buffer full
+		 */
+		volatile uint32_t txDropped;
+
+		/**
+		 * @private
+		 * @brief Number of bytes sent (DMA transmissions completed)
+		 */
+		volatile uint32_t txSent;
+
+		/**
+		 * @private
+		 * @brief Task waiting for received bytes, NULL if none
+		 */
+		TaskHandle_t volatile rxTask;
+
+		/**
+		 * @private
+		 * @brief Break character ('\0' if none) and next RX byte to scan for it
+		 */
+		char breakChar;
+		uint32_t breakIndex;
+
+		/**
+		 * @private
+		 * @brief Start DMA transmission of the next contiguous TX buffer block
+		 */
+		void startTransmission ();
+
+		/**
+		 * @private
+		 * @brief Return number of free TX bytes (interrupts masked)
+		 */
+		uint32_t txFree ();
+
+		/**
+		 * @private
+		 * @brief Let DMA send queued bytes, unless a block is reserved (interrupts masked)
+		 */
+		void txPublish ();
+
+		/**
+		 * @private
+		 * @brief Update RX write index from DMA counter
+		 */
+		uint32_t rxWriteIndex ();
+
+		/**
+		 * @private
+		 * @brief Move received USB bytes to RX buffer, as many as fit
+		 */
+		void usbReceive ();
 	};
 }
 
@@ -0,0 +1,210 @@
+/**
+ * @file	Servo.hpp
+ * @author	Kevin WYSOCKI
+ * @date	22 oct. 2017
+ * @brief	Hobby servo driver with speed-limited motion
+ */
+
+#ifndef INC_SERVO_HPP_
+#define INC_SERVO_HPP_
+
+#include "stm32f4xx.h"
+#include "common.h"
+
+#include "Event.hpp"
+#include "PWM.hpp"
+#include "SoftTimer.hpp"
+
+/*----------------------------------------------------------------------------*/
+/* Definitions                                                                */
+/*----------------------------------------------------------------------------*/
+
+#define SERVO_MIN_FREQ			(50u)		/**< Slowest frame rate (Hz) */
+#define SERVO_MAX_FREQ			(333u)		/**< Fastest frame rate (Hz, digital servos) */
+#define SERVO_UPDATE_PERIOD		(5u)		/**< Motion update period (software timer ticks) */
+
+/**
+ * @brief Servo definition structure
+ */
+typedef struct
+{
+	enum HAL::PWM::ID	PWM;			/**< Output channel, 32-bit timer */
+	uint32_t			FREQ;			/**< Frame rate (Hz), shared by channels of the same timer */
+	uint16_t			MIN_PULSE;		/**< Pulse width at position 0 (us) */
+	uint16_t			MAX_PULSE;		/**< Pulse width at position 1 (us) */
+}SERVO_DEF;
+
+/*----------------------------------------------------------------------------*/
+/* Class declaration	                                                      */
+/*----------------------------------------------------------------------------*/
+
+/**
+ * @namespace HAL
+ */
+namespace HAL
+{
+	/**
+	 * @class Servo
+	 * @brief Hobby servo driver
+	 *
+	 * HOWTO :
+	 * - Get servo instance with Servo::GetInstance(), output stays low (servo
+	 *   released) until the first SetPosition()
+	 * - SetSpeed() limits motion speed, 0 for unlimited
+	 * - SetPosition() starts a move, Reached event is raised at the end
+	 * - Release() stops the pulses
+	 *
+	 * Servos are mapped on TIM2 and TIM5 channels : 32-bit counters keep the
+	 * full timer clock resolution at 50 Hz. All servos are moved by the same
+	 * software timer (SERVO_UPDATE_PERIOD), in integer compare counts, the
+	 * preloaded compare value is applied on the next frame.
+	 */
+	class Servo
+	{
+	public:
+
+		/**
+		 * @brief Servo identifier list
+		 */
+		enum ID
+		{
+			SERVO1,		//!< PWM4, TIM2_CH1
+			SERVO2,		//!< PWM5, TIM2_CH2
+			SERVO3,		//!< PWM6, TIM2_CH3
+			SERVO4,		//!< PWM7, TIM2_CH4
+			SERVO5,		//!< PWM16, TIM5_CH1
+			SERVO6,		//!< PWM17, TIM5_CH2
+			SERVO7,		//!< PWM18, TIM5_CH3
+			SERVO8,		//!< PWM19, TIM5_CH4
+			SERVO_MAX
+		};
+
+		/**
+		 * @brief Get instance method
+		 * @param id : Servo identifier
+		 * @return Servo instance
+		 */
+		static Servo* GetInstance (enum ID id);
+
+		/**
+		 * @brief Return instance ID
+		 */
+		enum ID GetID ()
+		{
+			return this->id;
+		}
+
+		/**
+		 * @brief Move to a position
+		 * First move after Release() is immediate (servo position unknown)
+		 * @param position : 0 (MIN_PULSE) to 1 (MAX_PULSE)
+		 */
+		void SetPosition (float32_t position);
+
+		/**
+		 * @brief Return commanded position (0 to 1), follows the speed limit
+		 */
+		float32_t GetPosition ();
+
+		/**
+		 * @brief Set speed limit
+		 * @param speed : Position units per second, 0 for unlimited
+		 */
+		void SetSpeed (float32_t speed);
+
+		/**
+		 * @brief Set pulse range
+		 * @param min : Pulse width at position 0 (us)
+		 * @param max : Pulse width at position 1 (us)
+		 */
+		void SetRange (uint16_t min, uint16_t max);
+
+		/**
+		 * @brief Stop pulses, servo holds no torque
+		 */
+		void Release ();
+
+		/**
+		 * @brief Return true while moving to target
+		 */
+		bool IsMoving ()
+		{
+			return (this->current != this->target);
+		}
+
+		/**
+		 * @brief Target reached event
+		 * Raised from software timer interrupt, below configMAX_SYSCALL (FromISR API allowed)
+		 */
+		Utils::Event<> Reached;
+
+		/**
+		 * @private
+		 * @brief Internal motion update. DO NOT CALL !!
+		 */
+		void INTERNAL_Update ();
+
+	private:
+
+		/**
+		 * @private
+		 * @brief Servo private constructor
+		 * @param id : Servo identifier
+		 */
+		Servo (enum ID id);
+
+		/**
+		 * @private
+		 * @brief Convert pulse width to compare counts
+		 * @param us : Pulse width (us)
+		 */
+		uint32_t toCounts (uint32_t us);
+
+		/**
+		 * @private
+		 * @brief Instance ID
+		 */
+		enum ID id;
+
+		/**
+		 * @private
+		 * @brief Servo definition
+		 */
+		SERVO_DEF def;
+
+		/**
+		 * @private
+		 * @brief Output channel
+		 */
+		PWM* pwm;
+
+		/**
+		 * @private
+		 * @brief Speed limit (position units per second)
+		 */
+		float32_t speed;
+
+		/**
+		 * @private
+		 * @brief Pulse range, current and target pulses (compare counts)
+		 */
+		uint32_t min;
+		uint32_t max;
+		volatile uint32_t current;
+		volatile uint32_t target;
+
+		/**
+		 * @private
+		 * @brief Compare counts per update, 0 for unlimited
+		 */
+		uint32_t step;
+
+		/**
+		 * @private
+		 * @brief Output released
+		 */
+		bool released;
+	};
+}
+
+#endif /* INC_SERVO_HPP_ */
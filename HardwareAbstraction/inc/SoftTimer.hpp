@@ -0,0 +1,146 @@
+/**
+ * @file	SoftTimer.hpp
+ * @author	Kevin WYSOCKI
+ * @date	22 oct. 2017
+ * @brief	Software timers multiplexed on one hardware timer
+ */
+
+#ifndef INC_SOFTTIMER_HPP_
+#define INC_SOFTTIMER_HPP_
+
+#include "stm32f4xx.h"
+#include "common.h"
+
+#include "Event.hpp"
+#include "Timer.hpp"
+
+/*----------------------------------------------------------------------------*/
+/* Definitions                                                                */
+/*----------------------------------------------------------------------------*/
+
+#define SOFTTIMER_TICK_US		(1000u)		/**< Wheel tick period (us) */
+
+#define SOFTTIMER_ROOT_BITS		(8u)		/**< First level : 256 slots of 1 tick */
+#define SOFTTIMER_LEVEL_BITS	(6u)		/**< Upper levels : 64 slots each */
+#define SOFTTIMER_LEVELS		(3u)		/**< Upper levels count */
+
+#define SOFTTIMER_ROOT_SIZE		(1u << SOFTTIMER_ROOT_BITS)
+#define SOFTTIMER_LEVEL_SIZE	(1u << SOFTTIMER_LEVEL_BITS)
+
+/** Longest delay in ticks (2^26 - 1, about 18 h at 1 kHz) */
+#define SOFTTIMER_MAX_DELAY		((1u << (SOFTTIMER_ROOT_BITS + SOFTTIMER_LEVELS * SOFTTIMER_LEVEL_BITS)) - 1u)
+
+/*----------------------------------------------------------------------------*/
+/* Class declaration	                                                      */
+/*----------------------------------------------------------------------------*/
+
+/**
+ * @namespace HAL
+ */
+namespace HAL
+{
+	/**
+	 * @class SoftTimer
+	 * @brief Software timer entry of the timer wheel
+	 *
+	 * HOWTO :
+	 * - Declare a SoftTimer (member or static object, never on a task stack while running)
+	 * - Subscribe to Elapsed event
+	 * - Start() as one-shot (period = 0) or periodic, Stop() to cancel
+	 *
+	 * All software timers run on a hierarchical timing wheel ticked by TIMER14
+	 * (SOFTTIMER_TICK_US). The first level holds the next 256 ticks, each upper
+	 * level covers 64 times the previous range and its slots are cascaded down
+	 * when the lower level wraps, so Start() and Stop() are O(1) and a tick only
+	 * walks the expired slot.
+	 *
+	 * Elapsed is raised from the tick interrupt, below configMAX_SYSCALL (FromISR
+	 * API allowed). Start() and Stop() may be called from task or interrupt
+	 * context, including from an Elapsed callback. The hardware timer is started
+	 * by the first Start(), call it from task context.
+	 */
+	class SoftTimer
+	{
+	public:
+
+		/**
+		 * @brief Software timer constructor (stopped)
+		 */
+		SoftTimer ();
+
+		/**
+		 * @brief Schedule the timer, restart it if already running
+		 * @param delay : Ticks before first Elapsed event (1 to SOFTTIMER_MAX_DELAY)
+		 * @param period : Ticks between next events, 0 for one-shot
+		 */
+		void Start (uint32_t delay, uint32_t period = 0u);
+
+		/**
+		 * @brief Cancel the timer, no Elapsed event after return
+		 */
+		void Stop ();
+
+		/**
+		 * @brief Return true while the timer is scheduled
+		 */
+		bool IsRunning ()
+		{
+			return (this->slot != NULL);
+		}
+
+		/**
+		 * @brief Return wheel time in ticks since first Start()
+		 */
+		static uint32_t GetTicks ();
+
+		/**
+		 * @brief Timer expired event
+		 */
+		Utils::Event<> Elapsed;
+
+		/**
+		 * @private
+		 * @brief Internal wheel tick. DO NOT CALL !!
+		 */
+		static void INTERNAL_Tick ();
+
+	private:
+
+		/**
+		 * @private
+		 * @brief Link the timer in the slot matching its deadline (interrupts masked)
+		 */
+		void link ();
+
+		/**
+		 * @private
+		 * @brief Remove the timer from its slot (interrupts masked)
+		 */
+		void unlink ();
+
+		/**
+		 * @private
+		 * @brief Move all timers of an upper level slot to lower levels
+		 * @param level : Upper level (0 to SOFTTIMER_LEVELS - 1)
+		 * @return Slot index cascaded
+		 */
+		static uint32_t cascade (uint32_t level);
+
+		/**
+		 * @private
+		 * @brief Deadline (wheel ticks) and reload period
+		 */
+		uint32_t expires;
+		uint32_t period;
+
+		/**
+		 * @private
+		 * @brief Slot list links, slot is NULL when stopped
+		 */
+		SoftTimer* next;
+		SoftTimer* prev;
+		SoftTimer** slot;
+	};
+}
+
+#endif /* INC_SOFTTIMER_HPP_ */
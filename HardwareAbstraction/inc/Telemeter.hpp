@@ -18,14 +18,24 @@
  #include "common.h"
 
 #include "ADConverter.hpp"
+#include "Event.hpp"
+#include "Filter.hpp"
 
  /*----------------------------------------------------------------------------*/
  /* Definitions                                                                */
  /*----------------------------------------------------------------------------*/
 
+/**
+ * @brief Filter windows (samples pushed by Update())
+ */
+#define TEL_MEDIAN_SIZE         (5u)
+#define TEL_AVERAGE_SIZE        (4u)
+
 typedef struct
 {
     HAL::ADConverter::Channel ch;
+    uint16_t detectHigh;            // Obstacle above (ADC 12 bits), also ADC watchdog threshold
+    uint16_t detectLow;             // Obstacle cleared below
 }TEL_DEF;
 
 
@@ -55,9 +65,67 @@ public:
 
     static Telemeter* GetInstance (enum ID id);
 
+    /**
+     * @brief Return raw value (mean of ADC scan buffer)
+     */
     uint16_t GetValue();
 
-    bool Detect();
+    /**
+     * @brief Push a new sample in filters : median, moving average, hysteresis
+     * Call periodically (filter windows are in Update() calls)
+     */
+    void Update();
+
+    /**
+     * @brief Return filtered value of last Update()
+     */
+    uint16_t GetFiltered()
+    {
+        return this->average.Get();
+    }
+
+    /**
+     * @brief Return obstacle state of last Update()
+     */
+    bool Detect()
+    {
+        return this->detect.Get();
+    }
+
+    /**
+     * @brief Return detection threshold (ADC 12 bits, obstacle above)
+     */
+    uint16_t GetDetectThreshold()
+    {
+        return this->def.detectHigh;
+    }
+
+    /**
+     * @brief Raise Detected as soon as a conversion is above detection threshold
+     */
+    void EnableDetection();
+
+    /**
+     * @brief Stop raising Detected (channel no longer watched)
+     */
+    void DisableDetection();
+
+    /**
+     * @brief Enable detection interrupt again (disabled on each detection)
+     */
+    void ArmDetection();
+
+    /**
+     * @brief Obstacle detected event
+     * Raised from ADC interrupt, below configMAX_SYSCALL (FromISR API allowed)
+     */
+    Utils::Event<> Detected;
+
+    /**
+     * @private
+     * @brief Internal ADC watchdog callback. DO NOT CALL !!
+     */
+    void INTERNAL_Detected();
 
 private:
     Telemeter (enum ID id);
@@ -67,6 +135,10 @@ private:
     HAL::ADConverter* adc;
 
     TEL_DEF def;
+
+    Utils::MedianFilter<TEL_MEDIAN_SIZE> median;
+    Utils::MovingAverage<TEL_AVERAGE_SIZE> average;
+    Utils::Hysteresis detect;
 };
 
 }
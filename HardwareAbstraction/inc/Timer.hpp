@@ -18,6 +18,8 @@
 /* Definitions                                                                */
 /*----------------------------------------------------------------------------*/
 
+#define TIMER_COMPARE_MAX_DELAY	(65535u)	/**< Maximum compare delay in counter ticks */
+
 /**
  * @brief Timer Definition structure
  * Used to define peripheral definition in order to initialize them
@@ -31,6 +33,8 @@ typedef struct
 		uint32_t 		PERIOD;
 		uint32_t		FREQ;
 		uint32_t		CLOCKFREQ;
+		uint32_t		TICKFREQ;		/**< Counter frequency in compare mode, 0 for periodic timer */
+		uint8_t			CHANNELS;		/**< Number of compare channels, 0 if compare is done on update */
 	}TIMER;
 
 	// Interrupt definitions
@@ -59,6 +63,13 @@ namespace HAL
 	 *  - Set timer period with SetPeriod()
 	 *  - Start, stop or restart timer with Start(), Stop(), Restart() methods
 	 *  - Register to Timer Elapsed event by add your callback to TimerElapsed Event
+	 *
+	 * Compare timers (TICKFREQ != 0) run a free counter and provide one-shot
+	 * compare events on each channel :
+	 *  - Start a channel with StartCompare(), delay is given in counter ticks
+	 *  - From CompareMatch callback, schedule next event with ScheduleCompare()
+	 *    (relative to the previous compare event, no drift)
+	 *  - Stop a channel with StopCompare()
 	 */
 	class Timer //: protected Utils::Observable
 	{
@@ -69,10 +80,25 @@ namespace HAL
 		 */
 		enum ID
 		{
-			TIMER7,  //!< TIMER0
+			TIMER6,  //!< TIMER6 (compare on update)
+			TIMER7,  //!< TIMER7
+			TIMER8,  //!< TIMER8 (4 compare channels)
+			TIMER14, //!< TIMER14 (software timers tick)
 			TIMER_MAX//!< TIMER_MAX
 		};
 
+		/**
+		 * @brief Timer compare channel list
+		 */
+		enum Channel
+		{
+			CHANNEL1,  //!< CHANNEL1
+			CHANNEL2,  //!< CHANNEL2
+			CHANNEL3,  //!< CHANNEL3
+			CHANNEL4,  //!< CHANNEL4
+			CHANNEL_MAX//!< CHANNEL_MAX
+		};
+
 		/**
 		 * @brief Return a timer instance
 		 * @param id : Timer identifier
@@ -109,18 +135,52 @@ namespace HAL
 		 */
 		void Stop ();
 
+		/**
+		 * @brief Start a compare channel
+		 * @param ch : Compare channel
+		 * @param delay : Delay before compare event in counter ticks (1 to TIMER_COMPARE_MAX_DELAY)
+		 */
+		void StartCompare (enum Channel ch, uint16_t delay);
+
+		/**
+		 * @brief Schedule next compare event, should be called from CompareMatch callback
+		 * @param ch : Compare channel
+		 * @param delay : Delay from the previous compare event in counter ticks (1 to TIMER_COMPARE_MAX_DELAY)
+		 */
+		void ScheduleCompare (enum Channel ch, uint16_t delay);
+
+		/**
+		 * @brief Stop a compare channel
+		 * @param ch : Compare channel
+		 */
+		void StopCompare (enum Channel ch);
+
+		/**
+		 * @brief Return counter frequency in compare mode
+		 */
+		uint32_t GetTickFrequency()
+		{
+			return this->def.TIMER.TICKFREQ;
+		}
+
 		/**
 		 * @brief Timer elapsed event;
 		 * Add your callback to this event to be notified when Timer elapses
 		 */
-		Utils::Event TimerElapsed;
+		Utils::Event<> TimerElapsed;
+
+		/**
+		 * @brief Compare match events;
+		 * Add your callback to the channel event to be notified on compare match
+		 */
+		Utils::Event<> CompareMatch[CHANNEL_MAX];
 
 		/**
 		 * @private
 		 * @brief Internal interrupt callback. DO NOT CALL !!
 		 * @param flag : interrupt flag
 		 */
-		void INTERNAL_InterruptCallback (uint16_t flag);
+		RAMFUNC void INTERNAL_InterruptCallback (uint16_t flag);
 
 	private:
 
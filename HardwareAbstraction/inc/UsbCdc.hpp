@@ -0,0 +1,305 @@
+/**
+ * @file	UsbCdc.hpp
+ * @author	Jeremy ROULLAND
+ * @date	26 oct. 2017
+ * @brief	USB OTG FS device, CDC ACM virtual COM port
+ */
+
+#ifndef INC_USBCDC_HPP_
+#define INC_USBCDC_HPP_
+
+#include "stm32f4xx.h"
+#include "common.h"
+#include "Event.hpp"
+
+/*----------------------------------------------------------------------------*/
+/* Definitions                                                                */
+/*----------------------------------------------------------------------------*/
+
+#define USBCDC_PACKET_SIZE		(64u)		/**< Bulk and control endpoints max packet size (full speed) */
+#define USBCDC_TX_MAX			(1023u * USBCDC_PACKET_SIZE)	/**< Longest IN transfer (packet counter) */
+
+#define USBCDC_VID				(0x0483u)	/**< STMicroelectronics */
+#define USBCDC_PID				(0x5740u)	/**< Virtual COM port */
+
+/**
+ * @brief CDC line coding (set by the host, has no effect on throughput)
+ */
+typedef struct __attribute__((packed))
+{
+	uint32_t	BAUDRATE;		/**< Bit rate requested by the terminal */
+	uint8_t		STOPBITS;		/**< 0 : 1 stop bit, 1 : 1.5, 2 : 2 */
+	uint8_t		PARITY;			/**< 0 : none, 1 : odd, 2 : even, 3 : mark, 4 : space */
+	uint8_t		DATABITS;		/**< 5, 6, 7, 8 or 16 */
+}USBCDC_LINE_CODING;
+
+/*----------------------------------------------------------------------------*/
+/* Class declaration	                                                      */
+/*----------------------------------------------------------------------------*/
+
+/**
+ * @namespace HAL
+ */
+namespace HAL
+{
+	/**
+	 * @class UsbCdc
+	 * @brief USB CDC ACM device on OTG FS (PA11 DM, PA12 DP)
+	 *
+	 * HOWTO :
+	 * - Use it through Serial::GetInstance(Serial::SERIAL_USB), the Serial
+	 *   buffers and events are shared with the UART links
+	 * - Or get instance with UsbCdc::GetInstance() : the device is connected
+	 *   (pull-up on DP) and enumerates as a virtual COM port
+	 * - Transmit() starts a bulk IN transfer from a buffer which must stay
+	 *   valid until TransmitComplete is raised
+	 * - Receive() copies the last OUT packet, the host is held (NAK) until the
+	 *   packet is fully read
+	 *
+	 * Events are raised from the OTG FS interrupt. Line coding is ignored : the
+	 * link runs at full speed bulk rate (about 1 MB/s).
+	 *
+	 * The core runs in slave mode (FIFO written by the CPU on TX FIFO empty).
+	 * VBUS is not sensed (PA9 is USART1 TX) : the B session is forced valid.
+	 *
+	 * DM (PA11) is also MOT4_APH (DRV8813_4 phase A) : the stepper driver
+	 * must not be used while the USB device is running (bench use).
+	 */
+	class UsbCdc
+	{
+	public:
+
+		/**
+		 * @brief Get instance method
+		 * @return UsbCdc instance
+		 */
+		static UsbCdc* GetInstance ();
+
+		/**
+		 * @brief Return true if the host selected the configuration
+		 */
+		bool IsConfigured ()
+		{
+			return this->configured;
+		}
+
+		/**
+		 * @brief Return true if a terminal opened the port (DTR set)
+		 */
+		bool IsOpen ()
+		{
+			return this->configured && this->dtr;
+		}
+
+		/**
+		 * @brief Return line coding set by the host
+		 */
+		USBCDC_LINE_CODING GetLineCoding ()
+		{
+			return this->lineCoding;
+		}
+
+		/**
+		 * @brief Start a bulk IN transfer
+		 * @param buffer : Bytes to send, valid until TransmitComplete
+		 * @param length : Number of bytes (USBCDC_TX_MAX at most)
+		 * @return Number of bytes transferred, 0 if a transfer is running or the device is not configured
+		 */
+		uint32_t Transmit (const uint8_t * buffer, uint32_t length);
+
+		/**
+		 * @brief Return true while an IN transfer is running
+		 */
+		bool IsTransmitting ()
+		{
+			return this->tx.busy;
+		}
+
+		/**
+		 * @brief Return number of received bytes not read yet
+		 */
+		uint32_t BytesToRead ()
+		{
+			return this->rx.length - this->rx.index;
+		}
+
+		/**
+		 * @brief Read received bytes
+		 * @param buffer : Buffer where bytes are stored
+		 * @param size : Buffer size
+		 * @return Number of bytes read
+		 *
+		 * Next OUT packet is accepted once the current one is fully read.
+		 */
+		uint32_t Receive (uint8_t * buffer, uint32_t size);
+
+		/**
+		 * @brief OUT packet received event (interrupt context)
+		 */
+		Utils::Event<> DataReceived;
+
+		/**
+		 * @brief IN transfer complete event, also raised when a transfer is aborted by a bus reset (interrupt context)
+		 */
+		Utils::Event<> TransmitComplete;
+
+		/**
+		 * @brief Configuration selected by the host event (interrupt context)
+		 */
+		Utils::Event<> Configured;
+
+		/**
+		 * @private
+		 * @brief Internal interrupt callback. DO NOT CALL !!
+		 */
+		void INTERNAL_InterruptCallback ();
+
+	private:
+
+		/**
+		 * @private
+		 * @brief IN endpoint transfer
+		 */
+		typedef struct
+		{
+			const uint8_t * data;			/**< Next bytes to write in TX FIFO */
+			volatile uint32_t remaining;	/**< Bytes not written in TX FIFO yet */
+			volatile bool busy;				/**< Transfer running */
+			bool zlp;						/**< Zero length packet ends the transfer */
+		}USBCDC_IN;
+
+		/**
+		 * @private
+		 * @brief OUT packet
+		 */
+		typedef struct
+		{
+			uint8_t data[USBCDC_PACKET_SIZE];	/**< Packet data */
+			volatile uint32_t length;			/**< Packet length */
+			volatile uint32_t index;			/**< Next byte to read */
+			uint32_t count;						/**< Bytes popped from RX FIFO, published on transfer complete */
+		}USBCDC_OUT;
+
+		/**
+		 * @private
+		 * @brief UsbCdc private constructor
+		 */
+		UsbCdc ();
+
+		/**
+		 * @private
+		 * @brief Host selected configuration and terminal DTR
+		 */
+		volatile bool configured;
+		volatile bool dtr;
+
+		/**
+		 * @private
+		 * @brief Line coding
+		 */
+		USBCDC_LINE_CODING lineCoding;
+
+		/**
+		 * @private
+		 * @brief SET_LINE_CODING waiting for its data stage
+		 */
+		bool lineCodingPending;
+
+		/**
+		 * @private
+		 * @brief Last SETUP packet and control transfer buffer
+		 */
+		uint8_t setup[8];
+		uint8_t ep0Buffer[USBCDC_PACKET_SIZE];
+
+		/**
+		 * @private
+		 * @brief Control IN (EP0) and bulk IN (EP1) transfers
+		 */
+		USBCDC_IN ep0;
+		USBCDC_IN tx;
+
+		/**
+		 * @private
+		 * @brief Bulk OUT (EP1) packet
+		 */
+		USBCDC_OUT rx;
+
+		/**
+		 * @private
+		 * @brief Bus reset, endpoints are deactivated
+		 */
+		void reset ();
+
+		/**
+		 * @private
+		 * @brief Pop a received packet status from RX FIFO
+		 */
+		void readRxFifo ();
+
+		/**
+		 * @private
+		 * @brief Decode the last SETUP packet
+		 */
+		void processSetup ();
+
+		/**
+		 * @private
+		 * @brief Class request data stage received (EP0 OUT)
+		 */
+		void processControlOut ();
+
+		/**
+		 * @private
+		 * @brief Host selected configuration, activate CDC endpoints
+		 * @param config : Configuration value, 0 to deconfigure
+		 */
+		void setConfiguration (uint8_t config);
+
+		/**
+		 * @private
+		 * @brief Start an IN transfer
+		 * @param ep : Endpoint number
+		 * @param in : Transfer state
+		 * @param buffer : Data
+		 * @param length : Data length
+		 */
+		void startIn (uint32_t ep, USBCDC_IN * in, const uint8_t * buffer, uint32_t length);
+
+		/**
+		 * @private
+		 * @brief Write pending packets in TX FIFO (TX FIFO empty interrupt)
+		 * @param ep : Endpoint number
+		 * @param in : Transfer state
+		 */
+		void writeTxFifo (uint32_t ep, USBCDC_IN * in);
+
+		/**
+		 * @private
+		 * @brief Answer a control request (data stage if length > 0, then status)
+		 * @param buffer : Data
+		 * @param length : Data length, truncated to wLength
+		 */
+		void controlIn (const uint8_t * buffer, uint32_t length);
+
+		/**
+		 * @private
+		 * @brief Arm EP0 OUT (SETUP packets, data stage or status stage)
+		 */
+		void ep0OutStart ();
+
+		/**
+		 * @private
+		 * @brief Accept next bulk OUT packet
+		 */
+		void rxStart ();
+
+		/**
+		 * @private
+		 * @brief Reject control request
+		 */
+		void stall ();
+	};
+}
+
+#endif /* INC_USBCDC_HPP_ */
@@ -6,6 +6,7 @@
  */
 
 #include "ADConverter.hpp"
+#include "StaticStorage.hpp"
 
 
 
@@ -16,34 +17,94 @@ using namespace HAL;
 /* Definitions                                                                */
 /*----------------------------------------------------------------------------*/
 
+// Scan : ADC1, all channels, DMA circular
+#define ADC_SCAN_ADC            (ADC1)
+#define ADC_SCAN_SAMPLETIME     (ADC_SampleTime_28Cycles)   // 4 channels in 7.1us, below trigger period
+#define ADC_SCAN_TRIGGER        (ADC_ExternalTrigConv_T3_TRGO)
+#define ADC_SCAN_TRIGGER_TIMER  (TIM3)                      // Update at motor PWM frequency (100kHz)
+#define ADC_SCAN_DMA_STREAM     (DMA2_Stream4)   // Stream0 is used by SPI1 RX
+#define ADC_SCAN_DMA_CHANNEL    (DMA_Channel_0)
+#define ADC_SCAN_SIZE           (ADC_SCAN_DEPTH * ADConverter::ADC_ChannelMAX)
+
+// Analog watchdog
+#define ADC_WATCHDOG_INT_CHANNEL    (ADC_IRQn)
+#define ADC_WATCHDOG_INT_PRIORITY   (11u)   // Below configMAX_SYSCALL (WatchdogTriggered may notify a task)
+
 // PC3 - ADC123_IN13
 #define ADC_CH0_INPUT_PORT      (GPIOC)
 #define ADC_CH0_INPUT_PIN       (GPIO_Pin_3)
-#define ADC_CH0_ADC             (ADC3)
+#define ADC_CH0_ADC             (ADC_SCAN_ADC)
 #define ADC_CH0_ADC_CHANNEL     (ADC_Channel_13)
 
 // PC4 - ADC123_IN14
 #define ADC_CH1_INPUT_PORT      (GPIOC)
 #define ADC_CH1_INPUT_PIN       (GPIO_Pin_4)
-#define ADC_CH1_ADC             (ADC2)
+#define ADC_CH1_ADC             (ADC_SCAN_ADC)
 #define ADC_CH1_ADC_CHANNEL     (ADC_Channel_14)
 
 // PC5 - ADC123_IN15
 #define ADC_CH2_INPUT_PORT      (GPIOC)
 #define ADC_CH2_INPUT_PIN       (GPIO_Pin_5)
-#define ADC_CH2_ADC             (ADC1)
+#define ADC_CH2_ADC             (ADC_SCAN_ADC)
 #define ADC_CH2_ADC_CHANNEL     (ADC_Channel_15)
 
+// PC2 - ADC123_IN12 (OUT_SENS : outputs H-bridge current sense)
+#define ADC_CH3_INPUT_PORT      (GPIOC)
+#define ADC_CH3_INPUT_PIN       (GPIO_Pin_2)
+#define ADC_CH3_ADC             (ADC_SCAN_ADC)
+#define ADC_CH3_ADC_CHANNEL     (ADC_Channel_12)
+
 /*----------------------------------------------------------------------------*/
 /* Private Members                                                            */
 /*----------------------------------------------------------------------------*/
 
 static ADConverter* _instance[ADConverter::Channel::ADC_ChannelMAX] = {NULL};
+static Utils::StaticStorage<ADConverter, ADConverter::Channel::ADC_ChannelMAX> _instanceStorage;
+
+/**
+ * @brief DMA scan buffer : ADC_SCAN_DEPTH scans of ADC_ChannelMAX samples
+ */
+static volatile uint16_t _scan[ADC_SCAN_SIZE] = {0u};
+
+/**
+ * @brief Scan is running
+ */
+static bool _scanStarted = false;
 
 /*----------------------------------------------------------------------------*/
 /* Private Functions                                                          */
 /*----------------------------------------------------------------------------*/
 
+/**
+ * @brief Analog inputs definitions (flash), indexed by channel
+ */
+static const ADC_DEF _adcDefs[ADConverter::ADC_ChannelMAX] =
+{
+    // ADC_Channel0
+    {
+        {ADC_CH0_INPUT_PORT, ADC_CH0_INPUT_PIN},    // Input
+        {ADC_CH0_ADC, ADC_CH0_ADC_CHANNEL, 1u},     // ADConverter
+    },
+
+    // ADC_Channel1
+    {
+        {ADC_CH1_INPUT_PORT, ADC_CH1_INPUT_PIN},    // Input
+        {ADC_CH1_ADC, ADC_CH1_ADC_CHANNEL, 2u},     // ADConverter
+    },
+
+    // ADC_Channel2
+    {
+        {ADC_CH2_INPUT_PORT, ADC_CH2_INPUT_PIN},    // Input
+        {ADC_CH2_ADC, ADC_CH2_ADC_CHANNEL, 3u},     // ADConverter
+    },
+
+    // ADC_Channel3
+    {
+        {ADC_CH3_INPUT_PORT, ADC_CH3_INPUT_PIN},    // Input
+        {ADC_CH3_ADC, ADC_CH3_ADC_CHANNEL, 4u},     // ADConverter
+    },
+};
+
 /**
  * @brief Retrieve Encoder definitions from Encoder ID
  * @param id : Encoder ID
@@ -51,47 +112,18 @@ static ADConverter* _instance[ADConverter::Channel::ADC_ChannelMAX] = {NULL};
  */
 static ADC_DEF _getADCStruct (enum ADConverter::Channel channel)
 {
-    ADC_DEF adc;
-
     assert(channel < ADConverter::ADC_ChannelMAX);
 
-    switch(channel)
-    {
-    case HAL::ADConverter::ADC_Channel0:
-        adc.Input.PORT                  =   ADC_CH0_INPUT_PORT;
-        adc.Input.PIN                   =   ADC_CH0_INPUT_PIN;
-        adc.ADConverter.ADConverter     =   ADC_CH0_ADC;
-        adc.ADConverter.Channel         =   ADC_CH0_ADC_CHANNEL;
-        break;
-    case HAL::ADConverter::ADC_Channel1:
-        adc.Input.PORT                  =   ADC_CH1_INPUT_PORT;
-        adc.Input.PIN                   =   ADC_CH1_INPUT_PIN;
-        adc.ADConverter.ADConverter     =   ADC_CH1_ADC;
-        adc.ADConverter.Channel         =   ADC_CH1_ADC_CHANNEL;
-        break;
-    case HAL::ADConverter::ADC_Channel2:
-        adc.Input.PORT                  =   ADC_CH2_INPUT_PORT;
-        adc.Input.PIN                   =   ADC_CH2_INPUT_PIN;
-        adc.ADConverter.ADConverter     =   ADC_CH2_ADC;
-        adc.ADConverter.Channel         =   ADC_CH2_ADC_CHANNEL;
-        break;
-
-    default:
-        break;
-    }
-
-    return adc;
+    return _adcDefs[channel];
 }
 
 /**
- * @brief Initialize peripheral for a specific Encoder
- * @param id : Encoder ID
+ * @brief Initialize analog input of a channel
+ * @param channel : ADC channel
  */
 static void _hardwareInit (enum ADConverter::Channel channel)
 {
     GPIO_InitTypeDef GPIOStruct;
-    ADC_InitTypeDef ADCStruct;
-    ADC_CommonInitTypeDef ADCCommonStruct;
 
     ADC_DEF def;
 
@@ -107,6 +139,104 @@ static void _hardwareInit (enum ADConverter::Channel channel)
     GPIOStruct.GPIO_Pin     =   def.Input.PIN;
 
     GPIO_Init(def.Input.PORT, &GPIOStruct);
+}
+
+/**
+ * @brief Return last sample written by DMA for a channel
+ * @param channel : ADC channel
+ */
+static uint16_t _latest (enum ADConverter::Channel channel)
+{
+    uint32_t last = (2u * ADC_SCAN_SIZE - 1u - DMA_GetCurrDataCounter(ADC_SCAN_DMA_STREAM)) % ADC_SCAN_SIZE;
+    uint32_t back = (last + ADConverter::ADC_ChannelMAX - channel) % ADConverter::ADC_ChannelMAX;
+
+    return _scan[(last + ADC_SCAN_SIZE - back) % ADC_SCAN_SIZE];
+}
+
+/**
+ * @brief Configure analog watchdog from watched channels
+ * One channel is watched alone, several share the lowest threshold
+ */
+static void _watchdogConfig ()
+{
+    NVIC_InitTypeDef NVICStruct;
+    uint32_t watched = 0u;
+    uint16_t high = 0xFFFu;
+    uint8_t  channel = 0u;
+
+    for(uint32_t i = 0u; i < ADConverter::ADC_ChannelMAX; i++)
+    {
+        if((_instance[i] != NULL) && (_instance[i]->watchdogHigh != 0u))
+        {
+            watched++;
+            channel = _getADCStruct(static_cast<ADConverter::Channel>(i)).ADConverter.Channel;
+            if(_instance[i]->watchdogHigh < high)
+                high = _instance[i]->watchdogHigh;
+        }
+    }
+
+    ADC_ITConfig(ADC_SCAN_ADC, ADC_IT_AWD, DISABLE);
+
+    if(watched == 0u)
+    {
+        ADC_AnalogWatchdogCmd(ADC_SCAN_ADC, ADC_AnalogWatchdog_None);
+        return;
+    }
+
+    ADC_AnalogWatchdogThresholdsConfig(ADC_SCAN_ADC, high, 0u);
+
+    if(watched == 1u)
+    {
+        ADC_AnalogWatchdogSingleChannelConfig(ADC_SCAN_ADC, channel);
+        ADC_AnalogWatchdogCmd(ADC_SCAN_ADC, ADC_AnalogWatchdog_SingleRegEnable);
+    }
+    else
+    {
+        ADC_AnalogWatchdogCmd(ADC_SCAN_ADC, ADC_AnalogWatchdog_AllRegEnable);
+    }
+
+    NVICStruct.NVIC_IRQChannel                      =   ADC_WATCHDOG_INT_CHANNEL;
+    NVICStruct.NVIC_IRQChannelPreemptionPriority    =   ADC_WATCHDOG_INT_PRIORITY;
+    NVICStruct.NVIC_IRQChannelSubPriority           =   0u;
+    NVICStruct.NVIC_IRQChannelCmd                   =   ENABLE;
+
+    NVIC_Init(&NVICStruct);
+
+    ADC_ClearITPendingBit(ADC_SCAN_ADC, ADC_IT_AWD);
+    ADC_ITConfig(ADC_SCAN_ADC, ADC_IT_AWD, ENABLE);
+}
+
+/**
+ * @brief Start timer triggered scan of all channels with DMA
+ */
+static void _scanInit ()
+{
+    ADC_InitTypeDef ADCStruct;
+    ADC_CommonInitTypeDef ADCCommonStruct;
+    DMA_InitTypeDef DMAStruct;
+    ADC_DEF def;
+
+    // DMA : circular, one half-word per conversion
+    DMA_DeInit(ADC_SCAN_DMA_STREAM);
+
+    DMAStruct.DMA_Channel               =   ADC_SCAN_DMA_CHANNEL;
+    DMAStruct.DMA_PeripheralBaseAddr    =   (uint32_t)&ADC_SCAN_ADC->DR;
+    DMAStruct.DMA_Memory0BaseAddr       =   (uint32_t)_scan;
+    DMAStruct.DMA_DIR                   =   DMA_DIR_PeripheralToMemory;
+    DMAStruct.DMA_BufferSize            =   ADC_SCAN_SIZE;
+    DMAStruct.DMA_PeripheralInc         =   DMA_PeripheralInc_Disable;
+    DMAStruct.DMA_MemoryInc             =   DMA_MemoryInc_Enable;
+    DMAStruct.DMA_PeripheralDataSize    =   DMA_PeripheralDataSize_HalfWord;
+    DMAStruct.DMA_MemoryDataSize        =   DMA_MemoryDataSize_HalfWord;
+    DMAStruct.DMA_Mode                  =   DMA_Mode_Circular;
+    DMAStruct.DMA_Priority              =   DMA_Priority_Medium;
+    DMAStruct.DMA_FIFOMode              =   DMA_FIFOMode_Disable;
+    DMAStruct.DMA_FIFOThreshold         =   DMA_FIFOThreshold_HalfFull;
+    DMAStruct.DMA_MemoryBurst           =   DMA_MemoryBurst_Single;
+    DMAStruct.DMA_PeripheralBurst       =   DMA_PeripheralBurst_Single;
+
+    DMA_Init(ADC_SCAN_DMA_STREAM, &DMAStruct);
+    DMA_Cmd(ADC_SCAN_DMA_STREAM, ENABLE);
 
     // ADC Init
     ADCCommonStruct.ADC_Mode                =   ADC_Mode_Independent;
@@ -114,26 +244,38 @@ static void _hardwareInit (enum ADConverter::Channel channel)
     ADCCommonStruct.ADC_DMAAccessMode       =   ADC_DMAAccessMode_Disabled;
     ADCCommonStruct.ADC_TwoSamplingDelay    =   0u;
 
-    ADC_Cmd(def.ADConverter.ADConverter, DISABLE);
+    ADC_Cmd(ADC_SCAN_ADC, DISABLE);
 
     ADC_CommonInit(&ADCCommonStruct);
 
     ADCStruct.ADC_ContinuousConvMode        =   DISABLE;
     ADCStruct.ADC_Resolution                =   ADC_Resolution_12b;
-    ADCStruct.ADC_ExternalTrigConv          =   ADC_ExternalTrigConv_T1_CC1;    // Not used
-    ADCStruct.ADC_ExternalTrigConvEdge      =   ADC_ExternalTrigConvEdge_None;
+    ADCStruct.ADC_ExternalTrigConv          =   ADC_SCAN_TRIGGER;
+    ADCStruct.ADC_ExternalTrigConvEdge      =   ADC_ExternalTrigConvEdge_Rising;
     ADCStruct.ADC_DataAlign                 =   ADC_DataAlign_Right;
-    ADCStruct.ADC_ScanConvMode              =   DISABLE;
-    ADCStruct.ADC_NbrOfConversion           =   1u;
+    ADCStruct.ADC_ScanConvMode              =   ENABLE;
+    ADCStruct.ADC_NbrOfConversion           =   ADConverter::ADC_ChannelMAX;
 
-    ADC_Init(def.ADConverter.ADConverter, &ADCStruct);
+    ADC_Init(ADC_SCAN_ADC, &ADCStruct);
 
-    ADC_RegularChannelConfig(def.ADConverter.ADConverter,
-                             def.ADConverter.Channel,
-                             1u,
-                             ADC_SampleTime_15Cycles);
+    for(uint32_t i = 0u; i < ADConverter::ADC_ChannelMAX; i++)
+    {
+        def = _getADCStruct(static_cast<ADConverter::Channel>(i));
+
+        ADC_RegularChannelConfig(ADC_SCAN_ADC,
+                                 def.ADConverter.Channel,
+                                 def.ADConverter.Rank,
+                                 ADC_SCAN_SAMPLETIME);
+    }
 
-    ADC_Cmd(def.ADConverter.ADConverter, ENABLE);
+    // Keep requesting DMA after each scan (circular buffer)
+    ADC_DMARequestAfterLastTransferCmd(ADC_SCAN_ADC, ENABLE);
+    ADC_DMACmd(ADC_SCAN_ADC, ENABLE);
+
+    ADC_Cmd(ADC_SCAN_ADC, ENABLE);
+
+    // Trigger on timer update, doesn't change PWM outputs
+    TIM_SelectOutputTrigger(ADC_SCAN_TRIGGER_TIMER, TIM_TRGOSource_Update);
 }
 
 /*----------------------------------------------------------------------------*/
@@ -146,7 +288,13 @@ ADConverter* ADConverter::GetInstance(ADConverter::Channel channel)
 
     if(_instance[channel] == NULL)
     {
-        _instance[channel] = new ADConverter(channel);
+        _instance[channel] = new (_instanceStorage.Get(channel)) ADConverter(channel);
+    }
+
+    if(!_scanStarted)
+    {
+        _scanStarted = true;
+        _scanInit();
     }
 
     return _instance[channel];
@@ -155,6 +303,8 @@ ADConverter* ADConverter::GetInstance(ADConverter::Channel channel)
 ADConverter::ADConverter(ADConverter::Channel channel)
 {
     this->result    =   0u;
+    this->watchdogHigh = 0u;
+    this->channel   =   channel;
     this->def       =   _getADCStruct(channel);
 
     _hardwareInit(channel);
@@ -162,30 +312,101 @@ ADConverter::ADConverter(ADConverter::Channel channel)
 
 int32_t ADConverter::StartConv()
 {
-    int32_t error = NO_ERROR;
-
-    if(ADC_GetSoftwareStartConvStatus(this->def.ADConverter.ADConverter) == SET)
-    {
-        error = ADC_ERROR_BUSY;
-    }
-    else
-    {
-        ADC_SoftwareStartConv(this->def.ADConverter.ADConverter);
-    }
-
-    return error;
+    return NO_ERROR;
 }
 
 void ADConverter::WaitWhileBusy()
 {
-    while(ADC_GetSoftwareStartConvStatus(this->def.ADConverter.ADConverter) == SET);
 }
 
 uint16_t ADConverter::GetResult()
 {
-    this->result = ADC_GetConversionValue(this->def.ADConverter.ADConverter);
+    uint32_t sum = 0u;
+
+    for(uint32_t i = 0u; i < ADC_SCAN_DEPTH; i++)
+        sum += _scan[i * ADConverter::ADC_ChannelMAX + this->channel];
+
+    this->result = static_cast<uint16_t>(sum / ADC_SCAN_DEPTH);
 
     return this->result;
 }
 
+uint16_t ADConverter::GetSample(uint32_t age)
+{
+    uint32_t written = ADC_SCAN_SIZE - DMA_GetCurrDataCounter(ADC_SCAN_DMA_STREAM);
+    uint32_t scan = written / ADConverter::ADC_ChannelMAX;
+
+    assert(age < (ADC_SCAN_DEPTH - 1u));
 
+    // Latest complete scan is the one before the scan being written
+    scan = (scan + 2u * ADC_SCAN_DEPTH - 1u - age) % ADC_SCAN_DEPTH;
+
+    return _scan[scan * ADConverter::ADC_ChannelMAX + this->channel];
+}
+
+void ADConverter::SetWatchdog(uint16_t high)
+{
+    this->watchdogHigh = high;
+
+    _watchdogConfig();
+}
+
+void ADConverter::ArmWatchdog()
+{
+    if(this->watchdogHigh == 0u)
+        return;
+
+    ADC_ClearITPendingBit(ADC_SCAN_ADC, ADC_IT_AWD);
+    ADC_ITConfig(ADC_SCAN_ADC, ADC_IT_AWD, ENABLE);
+}
+
+/*----------------------------------------------------------------------------*/
+/* Interrupt Handler                                                          */
+/*----------------------------------------------------------------------------*/
+
+extern "C"
+{
+    /**
+     * @brief ADC Interrupt Handler (analog watchdog)
+     */
+    void ADC_IRQHandler(void)
+    {
+        ADConverter* adc = NULL;
+        uint32_t watched = 0u;
+
+        if(ADC_GetITStatus(ADC_SCAN_ADC, ADC_IT_AWD) != SET)
+            return;
+
+        // Disarmed until ArmWatchdog() : no interrupt on each scan while above threshold
+        ADC_ITConfig(ADC_SCAN_ADC, ADC_IT_AWD, DISABLE);
+        ADC_ClearITPendingBit(ADC_SCAN_ADC, ADC_IT_AWD);
+
+        for(uint32_t i = 0u; i < ADConverter::ADC_ChannelMAX; i++)
+        {
+            if((_instance[i] != NULL) && (_instance[i]->watchdogHigh != 0u))
+            {
+                watched++;
+                adc = _instance[i];
+            }
+        }
+
+        // Single channel mode : the watched channel triggered
+        if(watched == 1u)
+        {
+            adc->WatchdogTriggered();
+            return;
+        }
+
+        // Shared threshold : check each channel last sample
+        for(uint32_t i = 0u; i < ADConverter::ADC_ChannelMAX; i++)
+        {
+            adc = _instance[i];
+
+            if((adc != NULL) && (adc->watchdogHigh != 0u) &&
+               (_latest(static_cast<ADConverter::Channel>(i)) > adc->watchdogHigh))
+            {
+                adc->WatchdogTriggered();
+            }
+        }
+    }
+}
@@ -0,0 +1,443 @@
+/**
+ * @file	CAN.cpp
+ * @author	Jeremy ROULLAND
+ * @date	23 oct. 2017
+ * @brief	CAN bus abstraction class
+ */
+
+#include "CAN.hpp"
+#include "StaticStorage.hpp"
+#include <stddef.h>
+#include <string.h>
+
+using namespace HAL;
+
+/*----------------------------------------------------------------------------*/
+/* Definitions                                                                */
+/*----------------------------------------------------------------------------*/
+
+// CAN0 (SERVO1 / SERVO2 outputs, GPIO41 / GPIO42 must not be used)
+#define CAN0_RX_PORT			(GPIOD)
+#define CAN0_RX_PIN				(GPIO_Pin_0)
+#define CAN0_RX_PINSOURCE		(GPIO_PinSource0)
+#define CAN0_TX_PORT			(GPIOD)
+#define CAN0_TX_PIN				(GPIO_Pin_1)
+#define CAN0_TX_PINSOURCE		(GPIO_PinSource1)
+#define CAN0_IO_AF				(GPIO_AF_CAN1)
+#define CAN0_BUS				(CAN1)
+#define CAN0_PRESCALER			(3u)			// 45 MHz / (3 * 15 tq) = 1 Mbit/s
+#define CAN0_SJW				(CAN_SJW_1tq)
+#define CAN0_BS1				(CAN_BS1_12tq)	// Sample point 86.7 %
+#define CAN0_BS2				(CAN_BS2_2tq)
+#define CAN0_INT_TX_CHANNEL		(CAN1_TX_IRQn)
+#define CAN0_INT_RX_CHANNEL		(CAN1_RX0_IRQn)
+#define CAN0_INT_SCE_CHANNEL	(CAN1_SCE_IRQn)
+#define CAN0_INT_PRIORITY		(11u)	// Below configMAX_SYSCALL (MessageReceived may notify a task)
+
+/*----------------------------------------------------------------------------*/
+/* Private Members                                                            */
+/*----------------------------------------------------------------------------*/
+
+/**
+ * @brief CAN instances
+ */
+static CAN* _can[CAN::CAN_MAX] = {NULL};
+
+/**
+ * @brief CAN instances storage
+ */
+static Utils::StaticStorage<CAN, CAN::CAN_MAX> _canStorage;
+
+/*----------------------------------------------------------------------------*/
+/* Private Functions                                                          */
+/*----------------------------------------------------------------------------*/
+
+static CAN_DEF _getCANStruct (enum CAN::ID id)
+{
+	CAN_DEF can;
+
+	assert(id < CAN::CAN_MAX);
+
+	switch(id)
+	{
+	case CAN::CAN0:
+		// RX Pin
+		can.RX.PORT				=	CAN0_RX_PORT;
+		can.RX.PIN				=	CAN0_RX_PIN;
+		can.RX.PINSOURCE		=	CAN0_RX_PINSOURCE;
+		can.RX.AF				=	CAN0_IO_AF;
+		// TX Pin
+		can.TX.PORT				=	CAN0_TX_PORT;
+		can.TX.PIN				=	CAN0_TX_PIN;
+		can.TX.PINSOURCE		=	CAN0_TX_PINSOURCE;
+		can.TX.AF				=	CAN0_IO_AF;
+		// CAN Peripheral
+		can.CAN.BUS				=	CAN0_BUS;
+		can.CAN.PRESCALER		=	CAN0_PRESCALER;
+		can.CAN.SJW				=	CAN0_SJW;
+		can.CAN.BS1				=	CAN0_BS1;
+		can.CAN.BS2				=	CAN0_BS2;
+		// NVIC Peripheral
+		can.INT.PRIORITY		=	CAN0_INT_PRIORITY;
+		can.INT.TX_CHANNEL		=	CAN0_INT_TX_CHANNEL;
+		can.INT.RX_CHANNEL		=	CAN0_INT_RX_CHANNEL;
+		can.INT.SCE_CHANNEL		=	CAN0_INT_SCE_CHANNEL;
+		break;
+
+	default:
+		break;
+	}
+
+	return can;
+}
+
+static int32_t _hardwareInit (enum CAN::ID id)
+{
+	GPIO_InitTypeDef GPIOStruct;
+	CAN_InitTypeDef CANStruct;
+	NVIC_InitTypeDef NVICStruct;
+
+	CAN_DEF can;
+
+	assert(id < CAN::CAN_MAX);
+
+	can = _getCANStruct(id);
+
+	// Init RX and TX pins
+	GPIOStruct.GPIO_Mode	=	GPIO_Mode_AF;
+	GPIOStruct.GPIO_OType	=	GPIO_OType_PP;
+	GPIOStruct.GPIO_PuPd	=	GPIO_PuPd_UP;
+	GPIOStruct.GPIO_Speed	=	GPIO_Speed_50MHz;
+	GPIOStruct.GPIO_Pin		=	can.RX.PIN;
+
+	GPIO_PinAFConfig(can.RX.PORT, can.RX.PINSOURCE, can.RX.AF);
+	GPIO_Init(can.RX.PORT, &GPIOStruct);
+
+	GPIOStruct.GPIO_Pin		=	can.TX.PIN;
+
+	GPIO_PinAFConfig(can.TX.PORT, can.TX.PINSOURCE, can.TX.AF);
+	GPIO_Init(can.TX.PORT, &GPIOStruct);
+
+	// CAN Init : automatic bus-off recovery and retransmission, mailboxes sent in request order
+	CAN_DeInit(can.CAN.BUS);
+	CAN_StructInit(&CANStruct);
+
+	CANStruct.CAN_TTCM		=	DISABLE;
+	CANStruct.CAN_ABOM		=	ENABLE;
+	CANStruct.CAN_AWUM		=	DISABLE;
+	CANStruct.CAN_NART		=	DISABLE;
+	CANStruct.CAN_RFLM		=	DISABLE;
+	CANStruct.CAN_TXFP		=	ENABLE;
+	CANStruct.CAN_Mode		=	CAN_Mode_Normal;
+	CANStruct.CAN_SJW		=	can.CAN.SJW;
+	CANStruct.CAN_BS1		=	can.CAN.BS1;
+	CANStruct.CAN_BS2		=	can.CAN.BS2;
+	CANStruct.CAN_Prescaler	=	can.CAN.PRESCALER;
+
+	if(CAN_Init(can.CAN.BUS, &CANStruct) != CAN_InitStatus_Success)
+		return CAN_ERROR_INIT;
+
+	// All filter banks to CAN1, closed until SetFilter()
+	CAN_SlaveStartBank(CAN_FILTER_MAX);
+
+	CAN_ITConfig(can.CAN.BUS, CAN_IT_FMP0 | CAN_IT_FOV0 | CAN_IT_TME |
+				 CAN_IT_EPV | CAN_IT_BOF | CAN_IT_ERR, ENABLE);
+
+	// NVIC Init - FIFO 0
+	NVICStruct.NVIC_IRQChannel						=	can.INT.RX_CHANNEL;
+	NVICStruct.NVIC_IRQChannelPreemptionPriority 	= 	can.INT.PRIORITY;
+	NVICStruct.NVIC_IRQChannelSubPriority 			= 	0;
+	NVICStruct.NVIC_IRQChannelCmd					=	ENABLE;
+
+	NVIC_Init(&NVICStruct);
+
+	// NVIC Init - Mailbox empty
+	NVICStruct.NVIC_IRQChannel						=	can.INT.TX_CHANNEL;
+
+	NVIC_Init(&NVICStruct);
+
+	// NVIC Init - Errors
+	NVICStruct.NVIC_IRQChannel						=	can.INT.SCE_CHANNEL;
+
+	NVIC_Init(&NVICStruct);
+
+	return NO_ERROR;
+}
+
+static void _setFilter (uint32_t bank, uint32_t id, uint32_t mask, FunctionalState state)
+{
+	CAN_FilterInitTypeDef FilterStruct;
+
+	// 32 bits scale : STID[10:0] on bits 31:21, IDE compared (standard only)
+	FilterStruct.CAN_FilterNumber			=	(uint8_t)bank;
+	FilterStruct.CAN_FilterMode				=	CAN_FilterMode_IdMask;
+	FilterStruct.CAN_FilterScale			=	CAN_FilterScale_32bit;
+	FilterStruct.CAN_FilterIdHigh			=	(uint16_t)((id & 0x7FFu) << 5);
+	FilterStruct.CAN_FilterIdLow			=	0u;
+	FilterStruct.CAN_FilterMaskIdHigh		=	(uint16_t)((mask & 0x7FFu) << 5);
+	FilterStruct.CAN_FilterMaskIdLow		=	CAN_Id_Extended;
+	FilterStruct.CAN_FilterFIFOAssignment	=	CAN_Filter_FIFO0;
+	FilterStruct.CAN_FilterActivation		=	state;
+
+	CAN_FilterInit(&FilterStruct);
+}
+
+/*----------------------------------------------------------------------------*/
+/* Class Implementation	                                                      */
+/*----------------------------------------------------------------------------*/
+
+namespace HAL
+{
+	CAN* CAN::GetInstance(enum CAN::ID id)
+	{
+		assert(id < CAN::CAN_MAX);
+
+		// if CAN instance already exists
+		if(_can[id] != NULL)
+		{
+			return _can[id];
+		}
+		else
+		{
+			_can[id] = new (_canStorage.Get(id)) CAN(id);
+
+			return _can[id];
+		}
+	}
+
+	CAN::CAN(enum CAN::ID id)
+	{
+		this->id = id;
+		this->error = 0;
+		this->def = _getCANStruct(id);
+
+		this->received = NULL;
+		this->overruns = 0u;
+		this->txDropped = 0u;
+		this->busErrors = 0u;
+
+		this->error = _hardwareInit(id);
+	}
+
+	bool CAN::SetFilter(uint32_t bank, uint32_t id, uint32_t mask)
+	{
+		if(bank >= CAN_FILTER_MAX)
+			return false;
+
+		_setFilter(bank, id, mask, ENABLE);
+
+		return true;
+	}
+
+	void CAN::ClearFilter(uint32_t bank)
+	{
+		assert(bank < CAN_FILTER_MAX);
+
+		_setFilter(bank, 0u, 0u, DISABLE);
+	}
+
+	bool CAN::load(const CAN_MSG * msg)
+	{
+		CanTxMsg tx;
+
+		tx.StdId	=	msg->ID;
+		tx.ExtId	=	0u;
+		tx.IDE		=	CAN_Id_Standard;
+		tx.RTR		=	CAN_RTR_Data;
+		tx.DLC		=	msg->Length;
+		memcpy(tx.Data, msg->Data, CAN_MAX_LENGTH);
+
+		return (CAN_Transmit(this->def.CAN.BUS, &tx) != CAN_TxStatus_NoMailBox);
+	}
+
+	int32_t CAN::Write(const CAN_MSG * msg)
+	{
+		int32_t rval = NO_ERROR;
+		uint32_t primask;
+
+		assert(msg != NULL);
+		assert(msg->Length <= CAN_MAX_LENGTH);
+
+		primask = __get_PRIMASK();
+		__disable_irq();
+
+		// Queued messages first : mailboxes are sent in load order. Masked
+		// because the ring may be drained by the interrupt between both tests
+		if(!this->txBuffer.IsEmpty() || !this->load(msg))
+		{
+			if(!this->txBuffer.Push(*msg))
+			{
+				this->txDropped++;
+				rval = CAN_ERROR_BUFFER_FULL;
+			}
+		}
+
+		__set_PRIMASK(primask);
+
+		if((rval == NO_ERROR) && this->IsBusOff())
+			rval = CAN_ERROR_BUS_OFF;
+
+		return rval;
+	}
+
+	int32_t	CAN::Read(CAN_MSG * msg)
+	{
+		assert(msg != NULL);
+
+		if(!this->rxBuffer.Pop(*msg))
+		{
+			return CAN_ERROR_NO_MESSAGE;
+		}
+
+		return NO_ERROR;
+	}
+
+	bool CAN::IsBusOff()
+	{
+		return (CAN_GetFlagStatus(this->def.CAN.BUS, CAN_FLAG_BOF) == SET);
+	}
+
+	void CAN::receive()
+	{
+		CAN_MSG * msg;
+		CanRxMsg rx;
+
+		while(CAN_MessagePending(this->def.CAN.BUS, CAN_FIFO0) != 0u)
+		{
+			// Releases the FIFO slot
+			CAN_Receive(this->def.CAN.BUS, CAN_FIFO0, &rx);
+
+			if((rx.IDE != CAN_Id_Standard) || (rx.RTR != CAN_RTR_Data))
+				continue;
+
+			msg = this->rxBuffer.Claim();
+
+			if(msg == NULL)
+			{
+				this->overruns++;
+				this->error = CAN_ERROR_BUFFER_FULL;
+				this->ErrorOccurred();
+				continue;
+			}
+
+			msg->ID = rx.StdId;
+			msg->Length = (rx.DLC > CAN_MAX_LENGTH) ? CAN_MAX_LENGTH : rx.DLC;
+			memcpy(msg->Data, rx.Data, CAN_MAX_LENGTH);
+
+			this->rxBuffer.Publish();
+
+			this->received = msg;
+			this->MessageReceived();
+			this->received = NULL;
+		}
+	}
+
+	void CAN::transmit()
+	{
+		const CAN_MSG * msg;
+
+		while((msg = this->txBuffer.Front()) != NULL)
+		{
+			if(!this->load(msg))
+				break;
+
+			this->txBuffer.Release();
+		}
+	}
+
+	void CAN::INTERNAL_InterruptCallback(uint32_t flag)
+	{
+		switch(flag)
+		{
+		// Message(s) pending in FIFO 0
+		case CAN_IT_FMP0:
+			this->receive();
+			break;
+
+		// FIFO 0 full, a message was lost
+		case CAN_IT_FOV0:
+			this->overruns++;
+			this->error = CAN_ERROR_BUFFER_FULL;
+			this->ErrorOccurred();
+			break;
+
+		// A mailbox is free
+		case CAN_IT_TME:
+			this->transmit();
+			break;
+
+		// Error management (bus-off leaves itself after 128 * 11 recessive bits)
+		case CAN_IT_EPV:
+			this->busErrors++;
+			this->error = CAN_ERROR_PASSIVE;
+			this->ErrorOccurred();
+			break;
+
+		case CAN_IT_BOF:
+			this->busErrors++;
+			this->error = CAN_ERROR_BUS_OFF;
+			this->ErrorOccurred();
+			break;
+		}
+	}
+}
+
+/*----------------------------------------------------------------------------*/
+/* Interrupt Handler                                                          */
+/*----------------------------------------------------------------------------*/
+
+extern "C"
+{
+	void CAN1_RX0_IRQHandler (void)
+	{
+		CAN* instance = _can[CAN::CAN0];
+
+		if(CAN_GetITStatus(CAN1, CAN_IT_FOV0) == SET)
+		{
+			CAN_ClearITPendingBit(CAN1, CAN_IT_FOV0);
+
+			instance->INTERNAL_InterruptCallback(CAN_IT_FOV0);
+		}
+
+		// Pending flag is cleared by releasing FIFO slots
+		if(CAN_GetITStatus(CAN1, CAN_IT_FMP0) == SET)
+		{
+			instance->INTERNAL_InterruptCallback(CAN_IT_FMP0);
+		}
+	}
+
+	void CAN1_TX_IRQHandler (void)
+	{
+		CAN* instance = _can[CAN::CAN0];
+
+		if(CAN_GetITStatus(CAN1, CAN_IT_TME) == SET)
+		{
+			CAN_ClearITPendingBit(CAN1, CAN_IT_TME);
+
+			instance->INTERNAL_InterruptCallback(CAN_IT_TME);
+		}
+	}
+
+	void CAN1_SCE_IRQHandler (void)
+	{
+		CAN* instance = _can[CAN::CAN0];
+
+		if(CAN_GetITStatus(CAN1, CAN_IT_BOF) == SET)
+		{
+			CAN_ClearITPendingBit(CAN1, CAN_IT_BOF);
+
+			instance->INTERNAL_InterruptCallback(CAN_IT_BOF);
+		}
+
+		if(CAN_GetITStatus(CAN1, CAN_IT_EPV) == SET)
+		{
+			CAN_ClearITPendingBit(CAN1, CAN_IT_EPV);
+
+			instance->INTERNAL_InterruptCallback(CAN_IT_EPV);
+		}
+
+		// Last error code and error flag
+		CAN_ClearITPendingBit(CAN1, CAN_IT_LEC);
+		CAN_ClearITPendingBit(CAN1, CAN_IT_ERR);
+	}
+}
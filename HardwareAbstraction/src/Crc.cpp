@@ -0,0 +1,49 @@
+/**
+ * @file	Crc.cpp
+ * @author	Jeremy ROULLAND
+ * @date	24 oct. 2017
+ * @brief	Hardware CRC unit
+ */
+
+#include "Crc.hpp"
+#include <string.h>
+
+/*----------------------------------------------------------------------------*/
+/* Class Implementation	                                                      */
+/*----------------------------------------------------------------------------*/
+
+namespace HAL
+{
+	uint32_t Crc::Compute(const uint8_t * buffer, uint32_t length)
+	{
+		uint32_t primask;
+		uint32_t word;
+		uint32_t crc;
+		uint32_t i;
+
+		primask = __get_PRIMASK();
+		__disable_irq();
+
+		CRC_ResetDR();
+
+		for(i = 0u; (i + sizeof(word)) <= length; i += sizeof(word))
+		{
+			memcpy(&word, &buffer[i], sizeof(word));
+			CRC->DR = word;
+		}
+
+		// Zero padded last word
+		if(i < length)
+		{
+			word = 0u;
+			memcpy(&word, &buffer[i], length - i);
+			CRC->DR = word;
+		}
+
+		crc = CRC->DR;
+
+		__set_PRIMASK(primask);
+
+		return crc;
+	}
+}
@@ -7,8 +7,13 @@
 
 #include <stddef.h>
 #include "DRV8813.hpp"
+#include "StaticStorage.hpp"
+#include "Clock.hpp"
+#include "FastMath.hpp"
 #include "common.h"
 
+#include <math.h>
+
 using namespace HAL;
 
 /*----------------------------------------------------------------------------*/
@@ -16,26 +21,110 @@ using namespace HAL;
 /*----------------------------------------------------------------------------*/
 #define STEPPER_FREQ_PWM	(10000u)			//10kHz
 #define DC_FREQ_PWM			(10000u)			//10kHz
-#define FREQ_TICK_REF		(4000u)				//4kHz
-#define TIMER_TICK_REF		Timer::TIMER7		//Warning: common to Servo Driver
-
-#define USTEP_1		16
-#define USTEP_2		8
-#define USTEP_4		4
-#define USTEP_8		2
-#define USTEP_16	1
-#define MAX_USTEP	64
+#define STEP_SPEED_MAX		(20000u)			//20k step/s
+#define STEP_SPEED_FULL		(500u)				//Full current above 500 step/s
+#define STEP_ACCEL_MAX		(200000u)			//200k step/s^2
+#define RAMP_C0_CORRECTION	(0.676f)			//First interval correction (AVR446)
+
+// Current policy (0 to 100%)
+#define CURRENT_RUN			(100u)				//constant speed
+#define CURRENT_ACCEL		(100u)				//acceleration and deceleration ramps
+#define CURRENT_HOLD		(50u)				//standstill, after hold delay
+#define CURRENT_HOLD_DELAY	(500u)				//ms
+#define CURRENT_SCALE(c)	(((c) << 16u) / 100u)
+
+// Chopping current reference (ExtDAC output, boot value is REFERENCE_RUN)
+#define REFERENCE_RUN		(20u)				//constant speed
+#define REFERENCE_ACCEL		(28u)				//acceleration and deceleration ramps
+#define REFERENCE_HOLD		(12u)				//standstill
+#define REFERENCE_DAC		ExtDAC::EXTDAC0
+
+// DC mode speed loop (tick/s to duty cycle, run from Supervise())
+#define DC_KP				(0.0005f)
+#define DC_KI				(0.005f)
+#define DC_KD				(0.0f)
+#define DC_PERIOD			(0.01f)				//nominal loop period (s)
+#define DC_PERIOD_MAX		(0.1f)				//longer : loop restarts from measured speed
+
+// Stall detection
+#define STALL_CURRENT_MAX	(3500u)				//coil current sense threshold (ADC 12 bits)
+
+// Thermal model (I2t, heat 1 : run current at 100% and run reference held continuously)
+#define THERMAL_TAU			(120.0f)			//winding time constant (s)
+#define THERMAL_DERATE_START	(1.0f)			//heat above : derating starts
+#define THERMAL_LIMIT		(1.3f)				//heat at which derating is full
+#define THERMAL_DERATE_MIN	(0.5f)				//hold current, ramps boost and accelerations factor at limit
+#define THERMAL_PERIOD_MAX	(1.0f)				//longer gap between updates is clamped (s)
+
+// Decay policy (DECAY pin high : fast decay, low : slow decay)
+#define DECAY_FAST_SPEED	(2000u)				//fast decay above 2000 step/s, slow below 1600 step/s
+
+// Move completion is raised from an unused vector, below configMAX_SYSCALL
+// (step timers are above it and can not call FreeRTOS)
+#define DRV_DONE_IRQ			(CEC_IRQn)
+#define DRV_DONE_IRQ_PRIORITY	(11u)
+
+// Waveform playback (coil timer update DMA burst, no FreeRTOS call in interrupt)
+#define WAVE_IRQ_PRIORITY		(1u)				//just below step timers
+#define WAVE_QUARTER			(MAX_USTEP / 4u)	//table indexes between phase changes
+
+// Step table stride (index increment per step)
+#define USTEP_1		32
+#define USTEP_2		16
+#define USTEP_4		8
+#define USTEP_8		4
+#define USTEP_16	2
+#define USTEP_32	1
+#define MAX_USTEP	DRV8813_STEP_TABLE_SIZE
+#define COIL_A		0u					//coils group and phases batch index
+#define COIL_B		1u
 
 #define	DRV_GPIO_DECAY	GPIO::GPIO6
 #define	DRV_GPIO_RESET	GPIO::GPIO7
 #define	DRV_GPIO_SLEEP	GPIO::GPIO8
 
+// Coil current sense (ADC_ChannelMAX : not wired)
+#define DRV1_ADC_SENSE	ADConverter::ADC_ChannelMAX
+#define DRV2_ADC_SENSE	ADConverter::ADC_ChannelMAX
+#define DRV3_ADC_SENSE	ADConverter::ADC_ChannelMAX
+#define DRV4_ADC_SENSE	ADConverter::ADC_ChannelMAX
+#define DRV5_ADC_SENSE	ADConverter::ADC_ChannelMAX
+
+// DC mode speed feedback (ENCODER_MAX : open loop)
+#define DRV1_ENCODER	Encoder::ENCODER_MAX
+#define DRV2_ENCODER	Encoder::ENCODER_MAX
+#define DRV3_ENCODER	Encoder::ENCODER_MAX
+#define DRV4_ENCODER	Encoder::ENCODER_MAX
+#define DRV5_ENCODER	Encoder::ENCODER_MAX
+
+// Current reference channel (ExtDAC_Channel_MAX : fixed reference)
+#define DRV1_DAC_CHANNEL	ExtDAC::ExtDAC_Channel0
+#define DRV2_DAC_CHANNEL	ExtDAC::ExtDAC_Channel0
+#define DRV3_DAC_CHANNEL	ExtDAC::ExtDAC_Channel0
+#define DRV4_DAC_CHANNEL	ExtDAC::ExtDAC_Channel0
+#define DRV5_DAC_CHANNEL	ExtDAC::ExtDAC_Channel0
+
+// Micro stepping (USTEP_1 full step to USTEP_32)
+#define DRV1_USTEP		USTEP_1
+#define DRV2_USTEP		USTEP_1
+#define DRV3_USTEP		USTEP_1
+#define DRV4_USTEP		USTEP_1
+#define DRV5_USTEP		USTEP_1
+
 //Drv88113 1
 #define	DRV1_GPIO_FAULT	GPIO::GPIO9
 #define	DRV1_GPIO_PHA	GPIO::GPIO10
 #define	DRV1_GPIO_PHB	GPIO::GPIO11
 #define	DRV1_GPIO_ENA	PWM::PWM0
 #define	DRV1_GPIO_ENB	PWM::PWM1
+#define	DRV1_STEP_TIMER	Timer::TIMER8
+#define	DRV1_STEP_CH	Timer::CHANNEL1
+#define	DRV1_WAVE_STREAM	(DMA2_Stream5)		//TIM1_UP
+#define	DRV1_WAVE_CHANNEL	(DMA_Channel_6)
+#define	DRV1_WAVE_CLOCK		(RCC_AHB1Periph_DMA2)
+#define	DRV1_WAVE_IRQ		(DMA2_Stream5_IRQn)
+#define	DRV1_WAVE_IT_HT		(DMA_IT_HTIF5)
+#define	DRV1_WAVE_IT_TC		(DMA_IT_TCIF5)
 
 //Drv88113 2
 #define	DRV2_GPIO_FAULT	GPIO::GPIO12
@@ -43,6 +132,14 @@ using namespace HAL;
 #define	DRV2_GPIO_PHB	GPIO::GPIO14
 #define	DRV2_GPIO_ENA	PWM::PWM2
 #define	DRV2_GPIO_ENB	PWM::PWM3
+#define	DRV2_STEP_TIMER	Timer::TIMER8
+#define	DRV2_STEP_CH	Timer::CHANNEL2
+#define	DRV2_WAVE_STREAM	(NULL)				//TIM1_UP DMA used by Drv8813 1
+#define	DRV2_WAVE_CHANNEL	(0u)
+#define	DRV2_WAVE_CLOCK		(0u)
+#define	DRV2_WAVE_IRQ		(DMA2_Stream5_IRQn)	//unused
+#define	DRV2_WAVE_IT_HT		(0u)
+#define	DRV2_WAVE_IT_TC		(0u)
 
 //Drv88113 3
 #define	DRV3_GPIO_FAULT	GPIO::GPIO15
@@ -50,6 +147,14 @@ using namespace HAL;
 #define	DRV3_GPIO_PHB	GPIO::GPIO17
 #define	DRV3_GPIO_ENA	PWM::PWM8
 #define	DRV3_GPIO_ENB	PWM::PWM9
+#define	DRV3_STEP_TIMER	Timer::TIMER8
+#define	DRV3_STEP_CH	Timer::CHANNEL3
+#define	DRV3_WAVE_STREAM	(NULL)				//TIM3_UP stream used by I2C RX
+#define	DRV3_WAVE_CHANNEL	(0u)
+#define	DRV3_WAVE_CLOCK		(0u)
+#define	DRV3_WAVE_IRQ		(DMA2_Stream5_IRQn)	//unused
+#define	DRV3_WAVE_IT_HT		(0u)
+#define	DRV3_WAVE_IT_TC		(0u)
 
 //Drv88113 4
 #define	DRV4_GPIO_FAULT	GPIO::GPIO18
@@ -57,6 +162,14 @@ using namespace HAL;
 #define	DRV4_GPIO_PHB	GPIO::GPIO20
 #define	DRV4_GPIO_ENA	PWM::PWM10
 #define	DRV4_GPIO_ENB	PWM::PWM11
+#define	DRV4_STEP_TIMER	Timer::TIMER8
+#define	DRV4_STEP_CH	Timer::CHANNEL4
+#define	DRV4_WAVE_STREAM	(NULL)				//TIM3_UP stream used by I2C RX
+#define	DRV4_WAVE_CHANNEL	(0u)
+#define	DRV4_WAVE_CLOCK		(0u)
+#define	DRV4_WAVE_IRQ		(DMA2_Stream5_IRQn)	//unused
+#define	DRV4_WAVE_IT_HT		(0u)
+#define	DRV4_WAVE_IT_TC		(0u)
 
 //Drv88113 5
 #define	DRV5_GPIO_FAULT	GPIO::GPIO21
@@ -64,18 +177,75 @@ using namespace HAL;
 #define	DRV5_GPIO_PHB	GPIO::GPIO23
 #define	DRV5_GPIO_ENA	PWM::PWM12
 #define	DRV5_GPIO_ENB	PWM::PWM13
+#define	DRV5_STEP_TIMER	Timer::TIMER6
+#define	DRV5_STEP_CH	Timer::CHANNEL1
+#define	DRV5_WAVE_STREAM	(DMA1_Stream6)		//TIM4_UP
+#define	DRV5_WAVE_CHANNEL	(DMA_Channel_2)
+#define	DRV5_WAVE_CLOCK		(RCC_AHB1Periph_DMA1)
+#define	DRV5_WAVE_IRQ		(DMA1_Stream6_IRQn)
+#define	DRV5_WAVE_IT_HT		(DMA_IT_HTIF6)
+#define	DRV5_WAVE_IT_TC		(DMA_IT_TCIF6)
 
 /*----------------------------------------------------------------------------*/
 /* Const				                                                       */
 /*----------------------------------------------------------------------------*/
-const PWM_STEP_DEF		STEP_DEF_16[64] = {	{true,true,71,71},{true,true,63,77},{true,true,56,83},{true,true,47,88},{true,true,38,92},{true,true,29,96},{true,true,20,98},{true,true,10,100},
-											{true,true,0,100},{false,true,10,100},{false,true,20,98},{false,true,29,96},{false,true,38,92},{false,true,47,88},{false,true,56,83},{false,true,63,77},
-											{false,true,71,71},{false,true,77,63},{false,true,83,56},{false,true,88,47},{false,true,92,38},{false,true,96,29},{false,true,98,20},{false,true,100,10},
-											{false,true,100,0},{false,false,100,10},{false,false,98,20},{false,false,96,29},{false,false,92,38},{false,false,88,47},{false,false,83,56},{false,false,77,63},
-											{false,false,71,71},{false,false,63,77},{false,false,56,83},{false,false,47,88},{false,false,38,92},{false,false,29,96},{false,false,20,98},{false,false,10,100},
-											{true,false,0,100},{true,false,10,100},{true,false,20,98},{true,false,29,96},{true,false,38,92},{true,false,47,88},{true,false,56,83},{true,false,63,77},
-											{true,false,71,71},{true,false,77,63},{true,false,83,56},{true,false,88,47},{true,false,92,38},{true,false,96,29},{true,false,98,20},{true,false,100,10},
-											{true,true,100,0},{true,true,100,10},{true,true,98,20},{true,true,96,29},{true,true,92,38},{true,true,88,47},{true,true,83,56},{true,true,77,63}};
+/**
+ * @brief Compile time sine (Taylor series, |x| <= PI)
+ */
+static constexpr double _sinSeries (double x2, double term, uint32_t n)
+{
+	return (n >= 12u) ? 0.0 : term + _sinSeries(x2, -term * x2 / (double)((2u * n + 2u) * (2u * n + 3u)), n + 1u);
+}
+
+static constexpr double _wrap (double x)
+{
+	return (x > 3.14159265358979323846) ? _wrap(x - 2.0 * 3.14159265358979323846) : x;
+}
+
+static constexpr double _sin (double x)
+{
+	return _sinSeries(_wrap(x) * _wrap(x), _wrap(x), 0u);
+}
+
+static constexpr double _abs (double x)
+{
+	return (x < 0.0) ? -x : x;
+}
+
+/**
+ * @brief Phase angle of table index : full steps (two phases on) at multiples of MAX_USTEP / 4
+ */
+static constexpr double _stepAngle (uint32_t i)
+{
+	return 3.14159265358979323846 * (0.25 + 2.0 * (double)i / (double)MAX_USTEP);
+}
+
+static constexpr PWM_STEP_DEF _stepDef (double a, double b)
+{
+	return { a >= 0.0, b >= 0.0, (uint16_t)(_abs(a) * 1000.0 + 0.5), (uint16_t)(_abs(b) * 1000.0 + 0.5) };
+}
+
+/**
+ * @brief Step table : A = cos, B = sin
+ */
+typedef struct
+{
+	PWM_STEP_DEF step[MAX_USTEP];
+}DRV8813_STEP_TABLE;
+
+template<uint32_t... I> struct _stepIndexes {};
+template<uint32_t N, uint32_t... I> struct _stepMakeIndexes : _stepMakeIndexes<N - 1u, N - 1u, I...> {};
+template<uint32_t... I> struct _stepMakeIndexes<0u, I...> { typedef _stepIndexes<I...> type; };
+
+template<uint32_t... I>
+static constexpr DRV8813_STEP_TABLE _stepTableBuild (_stepIndexes<I...>)
+{
+	return { { _stepDef(_sin(_stepAngle(I) + 3.14159265358979323846 / 2.0), _sin(_stepAngle(I)))... } };
+}
+
+static constexpr DRV8813_STEP_TABLE _stepTable RAMDATA = _stepTableBuild(_stepMakeIndexes<MAX_USTEP>::type());
+
+#define STEP_DEF	(_stepTable.step)
 
 /*----------------------------------------------------------------------------*/
 /* Private Members                                                            */
@@ -87,15 +257,223 @@ const PWM_STEP_DEF		STEP_DEF_16[64] = {	{true,true,71,71},{true,true,63,77},{tru
 Drv8813* _drv8813[Drv8813::DRV8813_MAX] = {NULL};
 
 /**
- * @brief Initialisation Timer Tick Flag
+ * @brief Drv8813 instances storage
+ */
+static Utils::StaticStorage<Drv8813, Drv8813::DRV8813_MAX> _drv8813Storage;
+
+/**
+ * @brief Drivers sets (bit n : Drv8813 ID n)
+ * Created : instances to visit (emergency, shared DAC channel)
+ * Posted : instances with a pending move completion or stall event
+ */
+static_assert(Drv8813::DRV8813_MAX <= 32u, "Drv8813 sets are 32 bits masks");
+static volatile uint32_t _drv8813Created = 0u;
+static volatile uint32_t _drv8813Posted = 0u;
+
+/**
+ * @brief Current reference requested by each driver and last value sent by channel
+ */
+static uint8_t _dacRequest[Drv8813::DRV8813_MAX] = {0u};
+static uint8_t _dacOutput[ExtDAC::ExtDAC_Channel_MAX] = {0u};
+
+/**
+ * @brief Fast decay requested by each driver (DECAY pin may be shared)
+ */
+static bool _decayRequest[Drv8813::DRV8813_MAX] = {false};
+
+/**
+ * @brief Emergency stop latched (shared SLEEP pin held low)
+ */
+static volatile bool _emergency = false;
+
+/**
+ * @brief Step probe : armed, then time of the first step played (latency measurement)
  */
-static bool TimerInitialized = false;
+static volatile bool _probeArmed = false;
+static volatile bool _probeDone = false;
+static volatile uint32_t _probeTime = 0u;
 
 
 /*----------------------------------------------------------------------------*/
 /* Private Functions                                                          */
 /*----------------------------------------------------------------------------*/
 
+/**
+ * @brief Drivers definitions (flash), indexed by Drv8813 ID
+ */
+static const DRV8813_DEF _drv8813Defs[HAL::Drv8813::DRV8813_MAX] =
+{
+	// DRV8813_1
+	{
+		Drv8813Mode::STEPPER_MODE,		// MODE
+		DRV1_USTEP,						// USTEP_MODE
+		STEPPER_FREQ_PWM,				// PWM_FREQ
+		200u,							// NB_MOTOR_STEP
+		DRV_GPIO_DECAY,					// GPIO_DECAY
+		DRV_GPIO_RESET,					// GPIO_RESET
+		DRV_GPIO_SLEEP,					// GPIO_SLEEP
+		DRV1_GPIO_FAULT,				// GPIO_FAULT
+		DRV1_GPIO_PHA,					// GPIO_PHA
+		DRV1_GPIO_PHB,					// GPIO_PHB
+		DRV1_GPIO_ENA,					// GPIO_ENA
+		DRV1_GPIO_ENB,					// GPIO_ENB
+		DRV1_STEP_TIMER,				// STEP_TIMER
+		DRV1_STEP_CH,					// STEP_CHANNEL
+		CURRENT_RUN,					// CURRENT_COEF
+		CURRENT_ACCEL,					// ACCEL_COEF
+		CURRENT_HOLD,					// HOLD_COEF
+		CURRENT_HOLD_DELAY,				// HOLD_DELAY
+		DRV1_ADC_SENSE,					// ADC_SENSE
+		DRV1_DAC_CHANNEL,				// DAC_CHANNEL
+		REFERENCE_RUN,					// DAC_RUN
+		REFERENCE_ACCEL,				// DAC_ACCEL
+		REFERENCE_HOLD,					// DAC_HOLD
+		DRV1_WAVE_STREAM,				// WAVE_STREAM
+		DRV1_WAVE_CHANNEL,				// WAVE_CHANNEL
+		DRV1_WAVE_CLOCK,				// WAVE_CLOCK
+		DRV1_WAVE_IRQ,					// WAVE_IRQ
+		DRV1_WAVE_IT_HT,				// WAVE_IT_HT
+		DRV1_WAVE_IT_TC,				// WAVE_IT_TC
+		DRV1_ENCODER,					// ENCODER
+	},
+
+	// DRV8813_2
+	{
+		Drv8813Mode::STEPPER_MODE,		// MODE
+		DRV2_USTEP,						// USTEP_MODE
+		STEPPER_FREQ_PWM,				// PWM_FREQ
+		200u,							// NB_MOTOR_STEP
+		DRV_GPIO_DECAY,					// GPIO_DECAY
+		DRV_GPIO_RESET,					// GPIO_RESET
+		DRV_GPIO_SLEEP,					// GPIO_SLEEP
+		DRV2_GPIO_FAULT,				// GPIO_FAULT
+		DRV2_GPIO_PHA,					// GPIO_PHA
+		DRV2_GPIO_PHB,					// GPIO_PHB
+		DRV2_GPIO_ENA,					// GPIO_ENA
+		DRV2_GPIO_ENB,					// GPIO_ENB
+		DRV2_STEP_TIMER,				// STEP_TIMER
+		DRV2_STEP_CH,					// STEP_CHANNEL
+		CURRENT_RUN,					// CURRENT_COEF
+		CURRENT_ACCEL,					// ACCEL_COEF
+		CURRENT_HOLD,					// HOLD_COEF
+		CURRENT_HOLD_DELAY,				// HOLD_DELAY
+		DRV2_ADC_SENSE,					// ADC_SENSE
+		DRV2_DAC_CHANNEL,				// DAC_CHANNEL
+		REFERENCE_RUN,					// DAC_RUN
+		REFERENCE_ACCEL,				// DAC_ACCEL
+		REFERENCE_HOLD,					// DAC_HOLD
+		DRV2_WAVE_STREAM,				// WAVE_STREAM
+		DRV2_WAVE_CHANNEL,				// WAVE_CHANNEL
+		DRV2_WAVE_CLOCK,				// WAVE_CLOCK
+		DRV2_WAVE_IRQ,					// WAVE_IRQ
+		DRV2_WAVE_IT_HT,				// WAVE_IT_HT
+		DRV2_WAVE_IT_TC,				// WAVE_IT_TC
+		DRV2_ENCODER,					// ENCODER
+	},
+
+	// DRV8813_3
+	{
+		Drv8813Mode::STEPPER_MODE,		// MODE
+		DRV3_USTEP,						// USTEP_MODE
+		STEPPER_FREQ_PWM,				// PWM_FREQ
+		200u,							// NB_MOTOR_STEP
+		DRV_GPIO_DECAY,					// GPIO_DECAY
+		DRV_GPIO_RESET,					// GPIO_RESET
+		DRV_GPIO_SLEEP,					// GPIO_SLEEP
+		DRV3_GPIO_FAULT,				// GPIO_FAULT
+		DRV3_GPIO_PHA,					// GPIO_PHA
+		DRV3_GPIO_PHB,					// GPIO_PHB
+		DRV3_GPIO_ENA,					// GPIO_ENA
+		DRV3_GPIO_ENB,					// GPIO_ENB
+		DRV3_STEP_TIMER,				// STEP_TIMER
+		DRV3_STEP_CH,					// STEP_CHANNEL
+		CURRENT_RUN,					// CURRENT_COEF
+		CURRENT_ACCEL,					// ACCEL_COEF
+		CURRENT_HOLD,					// HOLD_COEF
+		CURRENT_HOLD_DELAY,				// HOLD_DELAY
+		DRV3_ADC_SENSE,					// ADC_SENSE
+		DRV3_DAC_CHANNEL,				// DAC_CHANNEL
+		REFERENCE_RUN,					// DAC_RUN
+		REFERENCE_ACCEL,				// DAC_ACCEL
+		REFERENCE_HOLD,					// DAC_HOLD
+		DRV3_WAVE_STREAM,				// WAVE_STREAM
+		DRV3_WAVE_CHANNEL,				// WAVE_CHANNEL
+		DRV3_WAVE_CLOCK,				// WAVE_CLOCK
+		DRV3_WAVE_IRQ,					// WAVE_IRQ
+		DRV3_WAVE_IT_HT,				// WAVE_IT_HT
+		DRV3_WAVE_IT_TC,				// WAVE_IT_TC
+		DRV3_ENCODER,					// ENCODER
+	},
+
+	// DRV8813_4
+	{
+		Drv8813Mode::STEPPER_MODE,		// MODE
+		DRV4_USTEP,						// USTEP_MODE
+		STEPPER_FREQ_PWM,				// PWM_FREQ
+		200u,							// NB_MOTOR_STEP
+		DRV_GPIO_DECAY,					// GPIO_DECAY
+		DRV_GPIO_RESET,					// GPIO_RESET
+		DRV_GPIO_SLEEP,					// GPIO_SLEEP
+		DRV4_GPIO_FAULT,				// GPIO_FAULT
+		DRV4_GPIO_PHA,					// GPIO_PHA
+		DRV4_GPIO_PHB,					// GPIO_PHB
+		DRV4_GPIO_ENA,					// GPIO_ENA
+		DRV4_GPIO_ENB,					// GPIO_ENB
+		DRV4_STEP_TIMER,				// STEP_TIMER
+		DRV4_STEP_CH,					// STEP_CHANNEL
+		CURRENT_RUN,					// CURRENT_COEF
+		CURRENT_ACCEL,					// ACCEL_COEF
+		CURRENT_HOLD,					// HOLD_COEF
+		CURRENT_HOLD_DELAY,				// HOLD_DELAY
+		DRV4_ADC_SENSE,					// ADC_SENSE
+		DRV4_DAC_CHANNEL,				// DAC_CHANNEL
+		REFERENCE_RUN,					// DAC_RUN
+		REFERENCE_ACCEL,				// DAC_ACCEL
+		REFERENCE_HOLD,					// DAC_HOLD
+		DRV4_WAVE_STREAM,				// WAVE_STREAM
+		DRV4_WAVE_CHANNEL,				// WAVE_CHANNEL
+		DRV4_WAVE_CLOCK,				// WAVE_CLOCK
+		DRV4_WAVE_IRQ,					// WAVE_IRQ
+		DRV4_WAVE_IT_HT,				// WAVE_IT_HT
+		DRV4_WAVE_IT_TC,				// WAVE_IT_TC
+		DRV4_ENCODER,					// ENCODER
+	},
+
+	// DRV8813_5
+	{
+		Drv8813Mode::STEPPER_MODE,		// MODE
+		DRV5_USTEP,						// USTEP_MODE
+		STEPPER_FREQ_PWM,				// PWM_FREQ
+		200u,							// NB_MOTOR_STEP
+		DRV_GPIO_DECAY,					// GPIO_DECAY
+		DRV_GPIO_RESET,					// GPIO_RESET
+		DRV_GPIO_SLEEP,					// GPIO_SLEEP
+		DRV5_GPIO_FAULT,				// GPIO_FAULT
+		DRV5_GPIO_PHA,					// GPIO_PHA
+		DRV5_GPIO_PHB,					// GPIO_PHB
+		DRV5_GPIO_ENA,					// GPIO_ENA
+		DRV5_GPIO_ENB,					// GPIO_ENB
+		DRV5_STEP_TIMER,				// STEP_TIMER
+		DRV5_STEP_CH,					// STEP_CHANNEL
+		CURRENT_RUN,					// CURRENT_COEF
+		CURRENT_ACCEL,					// ACCEL_COEF
+		CURRENT_HOLD,					// HOLD_COEF
+		CURRENT_HOLD_DELAY,				// HOLD_DELAY
+		DRV5_ADC_SENSE,					// ADC_SENSE
+		DRV5_DAC_CHANNEL,				// DAC_CHANNEL
+		REFERENCE_RUN,					// DAC_RUN
+		REFERENCE_ACCEL,				// DAC_ACCEL
+		REFERENCE_HOLD,					// DAC_HOLD
+		DRV5_WAVE_STREAM,				// WAVE_STREAM
+		DRV5_WAVE_CHANNEL,				// WAVE_CHANNEL
+		DRV5_WAVE_CLOCK,				// WAVE_CLOCK
+		DRV5_WAVE_IRQ,					// WAVE_IRQ
+		DRV5_WAVE_IT_HT,				// WAVE_IT_HT
+		DRV5_WAVE_IT_TC,				// WAVE_IT_TC
+		DRV5_ENCODER,					// ENCODER
+	},
+};
+
 /**
  * @brief Retrieve Drv8813 definitions from Timer ID
  * @param id : Drv8813 ID
@@ -103,198 +481,165 @@ static bool TimerInitialized = false;
  */
 static DRV8813_DEF _getDrv8813Struct (enum Drv8813::ID id)
 {
-	DRV8813_DEF drv;
-
 	assert(id < HAL::Drv8813::DRV8813_MAX);
 
-	switch(id)
-	{
-	case HAL::Drv8813::DRV8813_1:
-		drv.MODE				=	Drv8813Mode::STEPPER_MODE;
-		drv.USTEP_MODE			= 	USTEP_1;
-		drv.CURRENT_COEF		=	100u;
-		drv.PWM_FREQ			=	STEPPER_FREQ_PWM;
-		drv.NB_MOTOR_STEP		=	200u;
-		drv.GPIO_DECAY			=	DRV_GPIO_DECAY;
-		drv.GPIO_RESET			=	DRV_GPIO_RESET;
-		drv.GPIO_SLEEP			=	DRV_GPIO_SLEEP;
-		drv.GPIO_FAULT			=	DRV1_GPIO_FAULT;
-		drv.GPIO_PHA			=	DRV1_GPIO_PHA;
-		drv.GPIO_PHB			=	DRV1_GPIO_PHB;
-		drv.GPIO_ENA			=	DRV1_GPIO_ENA;
-		drv.GPIO_ENB			=	DRV1_GPIO_ENB;
-		break;
-	case HAL::Drv8813::DRV8813_2:
-		drv.MODE				=	Drv8813Mode::STEPPER_MODE;
-		drv.USTEP_MODE			= 	USTEP_1;
-		drv.CURRENT_COEF		=	100u;
-		drv.PWM_FREQ			=	STEPPER_FREQ_PWM;
-		drv.NB_MOTOR_STEP		=	200u;
-		drv.GPIO_DECAY			=	DRV_GPIO_DECAY;
-		drv.GPIO_RESET			=	DRV_GPIO_RESET;
-		drv.GPIO_SLEEP			=	DRV_GPIO_SLEEP;
-		drv.GPIO_FAULT			=	DRV2_GPIO_FAULT;
-		drv.GPIO_PHA			=	DRV2_GPIO_PHA;
-		drv.GPIO_PHB			=	DRV2_GPIO_PHB;
-		drv.GPIO_ENA			=	DRV2_GPIO_ENA;
-		drv.GPIO_ENB			=	DRV2_GPIO_ENB;
-		break;
-	case HAL::Drv8813::DRV8813_3:
-		drv.MODE				=	Drv8813Mode::STEPPER_MODE;
-		drv.USTEP_MODE			= 	USTEP_1;
-		drv.CURRENT_COEF		=	100u;
-		drv.PWM_FREQ			=	STEPPER_FREQ_PWM;
-		drv.NB_MOTOR_STEP		=	200u;
-		drv.GPIO_DECAY			=	DRV_GPIO_DECAY;
-		drv.GPIO_RESET			=	DRV_GPIO_RESET;
-		drv.GPIO_SLEEP			=	DRV_GPIO_SLEEP;
-		drv.GPIO_FAULT			=	DRV3_GPIO_FAULT;
-		drv.GPIO_PHA			=	DRV3_GPIO_PHA;
-		drv.GPIO_PHB			=	DRV3_GPIO_PHB;
-		drv.GPIO_ENA			=	DRV3_GPIO_ENA;
-		drv.GPIO_ENB			=	DRV3_GPIO_ENB;
-		break;
-	case HAL::Drv8813::DRV8813_4:
-		drv.MODE				=	Drv8813Mode::STEPPER_MODE;
-		drv.USTEP_MODE			= 	USTEP_1;
-		drv.CURRENT_COEF		=	100u;
-		drv.PWM_FREQ			=	STEPPER_FREQ_PWM;
-		drv.NB_MOTOR_STEP		=	200u;
-		drv.GPIO_DECAY			=	DRV_GPIO_DECAY;
-		drv.GPIO_RESET			=	DRV_GPIO_RESET;
-		drv.GPIO_SLEEP			=	DRV_GPIO_SLEEP;
-		drv.GPIO_FAULT			=	DRV4_GPIO_FAULT;
-		drv.GPIO_PHA			=	DRV4_GPIO_PHA;
-		drv.GPIO_PHB			=	DRV4_GPIO_PHB;
-		drv.GPIO_ENA			=	DRV4_GPIO_ENA;
-		drv.GPIO_ENB			=	DRV4_GPIO_ENB;
-		break;
-	case HAL::Drv8813::DRV8813_5:
-		drv.MODE				=	Drv8813Mode::STEPPER_MODE;
-		drv.USTEP_MODE			= 	USTEP_1;
-		drv.CURRENT_COEF		=	100u;
-		drv.PWM_FREQ			=	STEPPER_FREQ_PWM;
-		drv.NB_MOTOR_STEP		=	200u;
-		drv.GPIO_DECAY			=	DRV_GPIO_DECAY;
-		drv.GPIO_RESET			=	DRV_GPIO_RESET;
-		drv.GPIO_SLEEP			=	DRV_GPIO_SLEEP;
-		drv.GPIO_FAULT			=	DRV5_GPIO_FAULT;
-		drv.GPIO_PHA			=	DRV5_GPIO_PHA;
-		drv.GPIO_PHB			=	DRV5_GPIO_PHB;
-		drv.GPIO_ENA			=	DRV5_GPIO_ENA;
-		drv.GPIO_ENB			=	DRV5_GPIO_ENB;
-		break;
-	default:
-		break;
-	}
-
-	return drv;
+	return _drv8813Defs[id];
+}
+
+/**
+ * @brief Lowest Drv8813 ID of a drivers set
+ * @param set : drivers set (not empty)
+ */
+static inline uint32_t _drv8813First (uint32_t set)
+{
+	return __CLZ(__RBIT(set));
+}
+
+/**
+ * @brief Post a driver event to the software interrupt (any context)
+ * @param id : Drv8813 ID
+ */
+static void _drv8813Post (uint32_t id)
+{
+	uint32_t set;
+
+	do
+	{
+		set = __LDREXW(&_drv8813Posted);
+	}
+	while(__STREXW(set | (1u << id), &_drv8813Posted) != 0u);
+
+	NVIC_SetPendingIRQ(DRV_DONE_IRQ);
+}
+
+/**
+ * @brief Timestamp a step if the probe is armed (step interrupt or waveform start)
+ */
+static inline void _drv8813Probe (void)
+{
+	if(_probeArmed)
+	{
+		_probeTime = Utils::Clock::GetMicros();
+		_probeArmed = false;
+
+		__DMB();
+		_probeDone = true;
+	}
 }
 
 /**
  * @brief manage IO pin and PWM function of step index
+ * Compare values are precomputed at full current and scaled by current level,
+ * phases are written to BSRR
  */
-static void ManageStepper (Drv8813* drv)
+static RAMFUNC void ManageStepper (Drv8813* drv)
 {
-	static uint32_t pwmA;
-	static uint32_t pwmB;
+	const PWM_STEP_DEF* step = NULL;
+	uint32_t ccrA, ccrB;
+	uint32_t scale;
 
 	if(drv->direction==DISABLED)
 	{
-		drv->GpioInst.ENA->SetDutyCycle(0);
-		drv->GpioInst.ENB->SetDutyCycle(0);
+		drv->coils.Stage(COIL_A, 0);
+		drv->coils.Stage(COIL_B, 0);
 	}
 	else
 	{
-		pwmA = STEP_DEF_16[drv->stepIndex].PWM_A;	//current index PWM
-		pwmA *= drv->def.CURRENT_COEF;
-		pwmA /= 100u;
+		step = &STEP_DEF[drv->stepIndex];
 
-		pwmB = STEP_DEF_16[drv->stepIndex].PWM_B;	//current index PWM
-		pwmB *= drv->def.CURRENT_COEF;
-		pwmB /= 100u;
+		// Current level : standstill, ramps or constant speed
+		if(drv->holding)
+			scale = drv->scaleHold;
+		else if((drv->ramp.state == RAMP_ACCEL) || (drv->ramp.state == RAMP_DECEL))
+			scale = drv->scaleAccel;
+		else
+			scale = drv->scaleRun;
 
-		//////// TO DELETE, RESOLVE TORQUE PB ONLY ///////
-		/*if(drv->period_tick>(FREQ_TICK_REF/100u))
-		{
-			if(pwmA>0) pwmA=45;
-			if(pwmB>0) pwmB=45;
-		}*/
-		if(drv->period_tick<(FREQ_TICK_REF/500u))
+		ccrA = (drv->ccrA[drv->stepIndex] * scale) >> 16u;
+		ccrB = (drv->ccrB[drv->stepIndex] * scale) >> 16u;
+
+		// Full current at high speed (torque)
+		if((drv->stepInterval < drv->fullInterval) && !drv->holding)
 		{
-			if(pwmA>0) pwmA=100;
-			if(pwmB>0) pwmB=100;
+			if(ccrA>0) ccrA=drv->ccrFull;
+			if(ccrB>0) ccrB=drv->ccrFull;
 		}
 
 		//Set phase and PWM
-		if(STEP_DEF_16[drv->stepIndex].PositivA)
-			drv->GpioInst.PHA->Set(GPIO::State::High);
-		else
-			drv->GpioInst.PHA->Set(GPIO::State::Low);
-		drv->GpioInst.ENA->SetDutyCycle(pwmA/100.0f);
+		drv->phases.Stage(COIL_A, step->PositivA ? GPIO::State::High : GPIO::State::Low);
+		drv->coils.Stage(COIL_A, ccrA);
 
-		if(STEP_DEF_16[drv->stepIndex].PositivB)
-			drv->GpioInst.PHB->Set(GPIO::State::High);
-		else
-			drv->GpioInst.PHB->Set(GPIO::State::Low);
-		drv->GpioInst.ENB->SetDutyCycle(pwmB/100.0f);
+		drv->phases.Stage(COIL_B, step->PositivB ? GPIO::State::High : GPIO::State::Low);
+		drv->coils.Stage(COIL_B, ccrB);
+
+		// Single store when phases share a port
+		drv->phases.Commit();
 	}
+
+	// Both coils switch on the same PWM period
+	drv->coils.Commit();
 }
 
 /**
- * @brief Tick event for step generation
+ * @brief Step table index after a number of steps in current direction
+ * @param drv : Drv8813 instance
+ * @param from : start index
+ * @param count : steps (less than one electrical period)
  */
-static void TickDrv8813Event (void * obj)
+static uint32_t WaveIndex (Drv8813* drv, uint32_t from, uint32_t count)
 {
-	static uint32_t CptStep=0;
-	static uint32_t i=0;
+	count *= drv->def.USTEP_MODE;
 
-	for (i =0; i<Drv8813::ID::DRV8813_MAX; i++)
-	{
-		Drv8813* drv = _drv8813[i];
-		if(drv != NULL && drv->def.MODE==Drv8813Mode_t::STEPPER_MODE)	//if activ module and stepper mode
-		{
-			if((drv->nb_pulse!=0 or drv->run) && drv->direction!=DISABLED)
-			{
-				if(drv->period_tick != 0 && (CptStep % drv->period_tick) == 0)
-				{
-					if(drv->direction == Drv8813State_t::FORWARD)				//forward 1 step
-					{
-						drv->stepIndex += drv->def.USTEP_MODE;
-						if(drv->stepIndex >= MAX_USTEP)
-							drv->stepIndex=0;
-
-						drv->position += 1;
-						if(drv->position >= drv->def.NB_MOTOR_STEP)
-							drv->position=0;
-					}
-					else if(drv->direction == Drv8813State_t::BACKWARD)		//backward 1 step
-					{
-						if(drv->stepIndex == 0)
-							drv->stepIndex = MAX_USTEP;
-						drv->stepIndex -= drv->def.USTEP_MODE;
-
-						if(drv->position == 0)
-							drv->position=drv->def.NB_MOTOR_STEP;
-						drv->position -= 1;
-					}
-
-					if(drv->nb_pulse > 0)
-						drv->nb_pulse--;
-
-					ManageStepper(drv);		//manage IO pin and PWM function of step index
-				}
-			}
-			else if(drv->direction==DISABLED)
-			{
-			    ManageStepper(drv);
-			}
-		}
-	}
+	if(drv->direction == BACKWARD)
+		return (from + MAX_USTEP - count) % MAX_USTEP;
+	else
+		return (from + count) % MAX_USTEP;
+}
+
+/**
+ * @brief Waveform compare value of full current compare value
+ * @param drv : Drv8813 instance
+ * @param ccr : compare value at full current
+ */
+static uint16_t WaveCompare (Drv8813* drv, uint32_t ccr)
+{
+	// Full current at high speed (torque)
+	if(drv->wave.scale == 0u)
+		return (ccr > 0u) ? drv->ccrFull : 0u;
+
+	return (uint16_t)((ccr * drv->wave.scale) >> 16u);
+}
+
+/**
+ * @brief FAULT pin changed (interrupt context)
+ * @param obj : Drv8813 instance
+ */
+static void FaultDrv8813Event (void * obj)
+{
+	Drv8813* drv = static_cast<Drv8813*>(obj);
+
+	if(drv->GpioInst.FAULT->Get() == GPIO::State::Low)
+		drv->INTERNAL_Stall();
+}
+
+/**
+ * @brief Schedule the next step edge from step interval
+ * @param drv : Drv8813 instance
+ * @param start : true to start compare channel, false to schedule from last edge
+ */
+static RAMFUNC void ScheduleStep (Drv8813* drv, bool start)
+{
+	uint32_t delay = drv->stepWait;
+
+	if(delay > TIMER_COMPARE_MAX_DELAY)
+		delay = TIMER_COMPARE_MAX_DELAY;
 
-	CptStep++;
-	//if(CptStep>=FREQ_TICK_REF)
-	//	CptStep=0;
+	drv->stepWait -= delay;
+
+	if(start)
+		drv->tim->StartCompare(drv->def.STEP_CHANNEL, (uint16_t)delay);
+	else
+		drv->tim->ScheduleCompare(drv->def.STEP_CHANNEL, (uint16_t)delay);
 }
 
 /**
@@ -303,8 +648,6 @@ static void TickDrv8813Event (void * obj)
  */
 static void _hardwareInit (enum Drv8813::ID id)
 {
-	static bool TimerInitialized = false;
-
 	assert(id < HAL::Drv8813::DRV8813_MAX);
 
 	DRV8813_DEF drv = _getDrv8813Struct(id);
@@ -327,7 +670,8 @@ namespace HAL
 		else
 		{
 			// Create Driver instance
-			_drv8813[id] = new Drv8813(id);
+			_drv8813[id] = new (_drv8813Storage.Get(id)) Drv8813(id);
+			_drv8813Created = _drv8813Created | (1u << id);
 
 			return _drv8813[id];
 		}
@@ -338,12 +682,34 @@ namespace HAL
 		this->id = id;
 		this->def = _getDrv8813Struct(id);
 
-		this->period_tick = FREQ_TICK_REF;
+		this->stepInterval = 0;
+		this->stepWait = 0;
+		this->stepping = false;
+		this->ramp.state = RAMP_NONE;
 		this->direction = Drv8813State_t::FORWARD;
+		this->velocity.enabled = false;
+		this->velocity.interval = 0;
+		this->velocity.direction = Drv8813State_t::FORWARD;
+		this->sync.master = -1;
+		this->sync.slaves = 0u;
+		for(uint32_t i = 0; i < DRV8813_BANDS_MAX; i++)
+		{
+			this->bands[i].low = 0.0f;
+			this->bands[i].high = 0.0f;
+			this->bands[i].slow = 0u;
+			this->bands[i].fast = 0u;
+		}
 		this->position = 0;
+		this->steps = 0;
+		this->stepsPerTurn = this->def.NB_MOTOR_STEP * this->GetMicrostep();
 		this->run = false;
 		this->stepIndex = 0;
 		this->nb_pulse = 0;
+		this->finished = false;
+		this->holdPending = false;
+		this->holding = false;
+		this->stalled = false;
+		this->stallPending = false;
 
 		this->pwm1 = 0;
 		this->pwm2 = 0;
@@ -357,21 +723,89 @@ namespace HAL
 		this->GpioInst.PHB	 			= GPIO::GetInstance(def.GPIO_PHB);
 		this->GpioInst.ENA	 			= PWM::GetInstance(def.GPIO_ENA);
 		this->GpioInst.ENB	 			= PWM::GetInstance(def.GPIO_ENB);
+		this->GpioInst.SENSE				= NULL;
+
+		if(def.ADC_SENSE != ADConverter::ADC_ChannelMAX)
+			this->GpioInst.SENSE = ADConverter::GetInstance(def.ADC_SENSE);
+
+		//Current reference, updated from Supervise()
+		this->dac = NULL;
+		if(def.DAC_CHANNEL != ExtDAC::ExtDAC_Channel_MAX)
+			this->dac = ExtDAC::GetInstance(REFERENCE_DAC);
 
 		this->GpioInst.RESET->Set(GPIO::State::High);
 		this->GpioInst.SLEEP->Set(GPIO::State::High);
 		this->GpioInst.DECAY->Set(GPIO::State::High);
+		this->decayFast = true;
+		_decayRequest[id] = true;
 		this->GpioInst.ENA->SetState(PWM::State::ENABLED);
 		this->GpioInst.ENB->SetState(PWM::State::ENABLED);
+		this->coils.Add(this->GpioInst.ENA);		// COIL_A
+		this->coils.Add(this->GpioInst.ENB);		// COIL_B
+		this->phases.Add(this->GpioInst.PHA);		// COIL_A
+		this->phases.Add(this->GpioInst.PHB);		// COIL_B
+
+		//DC motor on bridge A, speed loop on encoder ticks
+		this->dc.encoder = NULL;
+		this->dc.pid = Utils::PID(DC_KP, DC_KI, DC_KD, DC_PERIOD);
+		this->dc.pid.SetOutputLimits(-1.0f, 1.0f);
+		this->dc.setpoint = 0.0f;
+		this->dc.speed = 0.0f;
+		this->dc.duty = 0.0f;
+		this->dc.time = 0u;
+
+		//Thermal estimate : cool motor
+		this->thermal.heat = 0.0f;
+		this->thermal.derate = 1.0f;
+		this->thermal.time = Utils::Clock::GetMicros();
+
+		if(def.MODE == DC_MODE)
+		{
+			this->direction = Drv8813State_t::DISABLED;
+			this->GpioInst.ENA->SetFrequency(def.PWM_FREQ);
+
+			if(def.ENCODER != Encoder::ENCODER_MAX)
+				this->dc.encoder = Encoder::GetInstance(def.ENCODER);
+		}
 
-		if(TimerInitialized==false)
+		//Step generation on its own compare channel
+		this->tim = Timer::GetInstance(def.STEP_TIMER);
+		this->tim->CompareMatch[def.STEP_CHANNEL].Subscribe<Drv8813, &Drv8813::INTERNAL_StepCallback>(this);
+		this->fullInterval = this->tim->GetTickFrequency() / STEP_SPEED_FULL;
+		this->SetDecaySpeed(DECAY_FAST_SPEED);
+		this->updateScale();
+
+		//Phase compare tables at full current
+		this->ccrFull = (uint16_t)this->GpioInst.ENA->GetCompareMax();
+		for(uint32_t i = 0; i < MAX_USTEP; i++)
+		{
+			this->ccrA[i] = (uint16_t)((this->ccrFull * STEP_DEF[i].PWM_A) / 1000u);
+			this->ccrB[i] = (uint16_t)((this->ccrFull * STEP_DEF[i].PWM_B) / 1000u);
+		}
+
+		//Current policy
+		this->SetCurrent(this->def.CURRENT_COEF, this->def.ACCEL_COEF, this->def.HOLD_COEF);
+		this->SetHoldDelay(this->def.HOLD_DELAY);
+
+		//Driver fault (nFAULT, when pin has an interrupt line)
+		this->GpioInst.FAULT->StateChanged.Subscribe(this, FaultDrv8813Event);
+
+		//Move completion software interrupt
+		NVIC_SetPriority(DRV_DONE_IRQ, DRV_DONE_IRQ_PRIORITY);
+		NVIC_EnableIRQ(DRV_DONE_IRQ);
+
+		//Waveform playback : ENA then ENB compare written by coil timer update DMA burst
+		this->wave.enabled = false;
+		if(def.WAVE_STREAM != NULL)
 		{
-			this->tim = Timer::GetInstance (TIMER_TICK_REF);
-			this->tim->SetPeriod(1000000u/FREQ_TICK_REF);
-			this->tim->TimerElapsed += TickDrv8813Event;
-			this->tim->Start();
+			assert(this->GpioInst.ENA->GetTimer() == this->GpioInst.ENB->GetTimer());
+			assert(this->GpioInst.ENB->GetChannel() == (this->GpioInst.ENA->GetChannel() + TIM_Channel_2));
+
+			RCC_AHB1PeriphClockCmd(def.WAVE_CLOCK, ENABLE);
+			TIM_DMAConfig(this->GpioInst.ENA->GetTimer(), TIM_DMABase_CCR1 + (this->GpioInst.ENA->GetChannel() / TIM_Channel_2), TIM_DMABurstLength_2Transfers);
 
-			TimerInitialized = true;
+			NVIC_SetPriority(def.WAVE_IRQ, WAVE_IRQ_PRIORITY);
+			NVIC_EnableIRQ(def.WAVE_IRQ);
 		}
 
 		//_hardwareInit(id);
@@ -379,101 +813,1492 @@ namespace HAL
 
 	uint32_t Drv8813::SetSpeedStep (uint32_t speed)
 	{
-		if(speed>FREQ_TICK_REF)		// Speed out of range
+		if(speed>STEP_SPEED_MAX)		// Speed out of range
 			return ERROR_GENERAL;
 
+		this->velocity.enabled = false;
+		this->sync.master = -1;
+		this->ramp.state = RAMP_NONE;
+
 		if(speed==0)
-			this->period_tick = 0;
+			this->stepInterval = 0;
 		else
-			this->period_tick = FREQ_TICK_REF/speed + 1u;
+			this->stepInterval = this->avoidBands(this->tim->GetTickFrequency()/speed, false);
+
+		this->startStepping();
 		return 0;
 	}
 
 	uint32_t Drv8813::SetSpeedRPM (float32_t speed)
 	{
-		return this->SetSpeedRPS(speed/60.0);
+		return this->SetSpeedRPS(speed * (1.0f / 60.0f));
 	}
 
 	uint32_t Drv8813::SetSpeedRPS (float32_t speed)
 	{
-		speed = speed * (float32_t)this->def.NB_MOTOR_STEP;
+		Drv8813State dir = (speed > 0.0f) ? Drv8813State_t::FORWARD : Drv8813State_t::BACKWARD;
+		float32_t rps = Utils::Abs(speed);
+
+		if(rps>this->rpsMax)		// Speed out of range
+			return ERROR_GENERAL;
+
+		this->velocity.enabled = false;
+		this->sync.master = -1;
+		this->ramp.state = RAMP_NONE;
+
+		if(rps == 0.0f)
+		{
+			this->Stop();
+			return 0;
+		}
+
+		this->stepInterval = this->avoidBands((uint32_t)(this->ticksByTurn / rps), false);
+
+		// Already stepping this way : next step takes the new interval
+		if(this->run && this->stepping && (this->direction == dir) && !this->wave.enabled)
+			return 0;
+
+		SetDirection(dir);
+		this->Start();
+
+		return 0;
+	}
+
+	uint32_t Drv8813::SetVelocity (float32_t speed)
+	{
+		Drv8813State dir = (speed < 0.0f) ? Drv8813State_t::BACKWARD : Drv8813State_t::FORWARD;
+		float32_t rate = Utils::Abs(speed);
+
+		if(rate > (float32_t)STEP_SPEED_MAX)		// Speed out of range
+			return ERROR_GENERAL;
+
+		// Below one step per second : standstill
+		return this->streamVelocity((rate < 1.0f) ? 0u : (uint32_t)(this->ticksByTurn * (float32_t)this->stepsPerTurn / rate), dir);
+	}
+
+	uint32_t Drv8813::SetVelocityRPS (float32_t speed)
+	{
+		Drv8813State dir = (speed < 0.0f) ? Drv8813State_t::BACKWARD : Drv8813State_t::FORWARD;
+		float32_t rps = Utils::Abs(speed);
+
+		if(rps > this->rpsMax)		// Speed out of range
+			return ERROR_GENERAL;
+
+		// Below one step per second : standstill
+		return this->streamVelocity((rps * (float32_t)this->stepsPerTurn < 1.0f) ? 0u : (uint32_t)(this->ticksByTurn / rps), dir);
+	}
 
-		if(this->def.USTEP_MODE == USTEP_2)
-			speed = speed * 2u;
-		if(this->def.USTEP_MODE == USTEP_4)
-					speed = speed * 4u;
-		if(this->def.USTEP_MODE == USTEP_8)
-					speed = speed * 8u;
-		if(this->def.USTEP_MODE == USTEP_16)
-					speed = speed * 16u;
+	uint32_t Drv8813::streamVelocity (uint32_t interval, Drv8813State dir)
+	{
+		uint32_t primask;
 
-		if(abs(speed)>FREQ_TICK_REF)		// Speed out of range
+		if(this->wave.enabled || (this->def.MODE == DC_MODE))
 			return ERROR_GENERAL;
 
+		interval = this->avoidBands(interval, false);
 
-		if(speed>0)
+		primask = __get_PRIMASK();
+		__disable_irq();
+
+		// Enter velocity mode : pending move, ramp and timeline are dropped
+		if(this->velocity.enabled == false)
 		{
-			this->period_tick = FREQ_TICK_REF/abs(speed) + 1u;
-			SetDirection(Drv8813State_t::FORWARD);
-			this->Start();
+			this->sync.master = -1;
+			this->nb_pulse = 0;
+			this->ramp.state = RAMP_NONE;
+			this->velocity.enabled = true;
 		}
-		else if(speed<0)
+
+		this->velocity.interval = interval;
+		if(interval != 0u)
+			this->velocity.direction = dir;
+		this->run = true;
+
+		// Not stepping (or waiting hold delay) : no step boundary to wait for
+		if((this->stepping == false) || this->holdPending)
 		{
-			this->period_tick = FREQ_TICK_REF/abs(speed) + 1u;
-			SetDirection(Drv8813State_t::BACKWARD);
-			this->Start();
+			this->stepInterval = interval;
+			if(interval != 0u)
+				this->direction = dir;
 		}
-		else
-			this->Stop();
 
+		__set_PRIMASK(primask);
+
+		this->startStepping();
+
+		return 0;
+	}
+
+	uint32_t Drv8813::SetMicrostep (uint32_t ustep)
+	{
+		uint32_t primask;
+
+		if((ustep == 0u) || (ustep > USTEP_1) || ((USTEP_1 % ustep) != 0u))
+			return ERROR_GENERAL;
+		if(this->wave.enabled)
+			return ERROR_GENERAL;
+
+		primask = __get_PRIMASK();
+		__disable_irq();
+
+		this->def.USTEP_MODE = USTEP_1 / ustep;
+
+		// Stay on the new step grid, position restarts in new units
+		this->stepIndex -= this->stepIndex % this->def.USTEP_MODE;
+		this->stepsPerTurn = this->def.NB_MOTOR_STEP * ustep;
+		this->position = 0;
+		this->updateScale();
+
+		__set_PRIMASK(primask);
 
 		return 0;
 	}
 
+	uint32_t Drv8813::GetMicrostep (void)
+	{
+		return USTEP_1 / this->def.USTEP_MODE;
+	}
+
+	void Drv8813::SetCurrent (uint32_t coef)
+	{
+		this->SetCurrent(coef, this->def.ACCEL_COEF, this->def.HOLD_COEF);
+	}
+
+	void Drv8813::SetCurrent (uint32_t run, uint32_t accel, uint32_t hold)
+	{
+		uint32_t primask;
+
+		if(run > 100u)
+			run = 100u;
+		if(accel > 100u)
+			accel = 100u;
+		if(hold > 100u)
+			hold = 100u;
+
+		// Scales are read by the step interrupt
+		primask = __get_PRIMASK();
+		__disable_irq();
+
+		this->def.CURRENT_COEF = run;
+		this->def.ACCEL_COEF = accel;
+		this->def.HOLD_COEF = hold;
+
+		__set_PRIMASK(primask);
+
+		this->currentApply();
+	}
+
+	void Drv8813::currentApply (void)
+	{
+		uint32_t derate = (uint32_t)(this->thermal.derate * 65536.0f);
+		uint32_t primask;
+
+		// Scales are read by the step interrupt
+		primask = __get_PRIMASK();
+		__disable_irq();
+
+		this->scaleRun = CURRENT_SCALE(this->def.CURRENT_COEF);
+		this->scaleAccel = (CURRENT_SCALE(this->def.ACCEL_COEF) * derate) >> 16u;
+		this->scaleHold = (CURRENT_SCALE(this->def.HOLD_COEF) * derate) >> 16u;
+
+		__set_PRIMASK(primask);
+
+		// Apply new level to a holding motor
+		if(this->holding)
+			ManageStepper(this);
+	}
+
+	void Drv8813::SetHoldDelay (uint32_t ms)
+	{
+		this->def.HOLD_DELAY = ms;
+		this->holdInterval = (this->tim->GetTickFrequency() / 1000u) * ms;
+	}
+
+	void Drv8813::SetDecaySpeed (uint32_t speed)
+	{
+		this->decayInterval = (speed == 0u) ? 0u : (this->tim->GetTickFrequency() / speed);
+	}
+
 	void Drv8813::SetDirection (Drv8813State dir)
 	{
+		uint32_t primask;
+
+		this->velocity.enabled = false;
+		this->sync.master = -1;
+
+		// Waveform is played in one direction, release or reverse from step index
+		if(this->wave.enabled)
+		{
+			primask = __get_PRIMASK();
+			__disable_irq();
+			if(this->wave.enabled)
+				this->waveStop();
+			__set_PRIMASK(primask);
+		}
+
 		this->direction=dir;
+
+		if(dir==DISABLED)
+			ManageStepper(this);		//release current immediately
+		else
+			this->startStepping();
 	}
 
 	void Drv8813::Start (void)
 	{
 		this->run = true;
+		this->startStepping();
 	}
 
 	void Drv8813::Stop (void)
 	{
+		this->velocity.enabled = false;
+		this->sync.master = -1;
 		this->run = false;
 	}
 
 	void Drv8813::PulseRotation (uint32_t pulse)
 	{
+		if(this->wave.enabled)
+			return;
+
+		this->velocity.enabled = false;
+		this->sync.master = -1;
+		this->ramp.state = RAMP_NONE;
 		this->nb_pulse=pulse;
+		this->startStepping();
 	}
 
-	uint32_t Drv8813::ReadPosition (void)
+	uint32_t Drv8813::Move (uint32_t steps, uint32_t speed, uint32_t accel)
 	{
-		return this->position;
-	}
+		uint32_t freq = this->tim->GetTickFrequency();
+		uint32_t accelLimit = 0;
+		uint32_t speedLimit = 0;
+		uint32_t c0 = 0;
 
-	uint32_t Drv8813::SetPosition (uint32_t pos)
-	{
-		if(pos >= this->def.NB_MOTOR_STEP)
+		if(speed == 0 || speed > STEP_SPEED_MAX)		// Speed out of range
 			return ERROR_GENERAL;
-
-		if(this->def.NB_MOTOR_STEP == 0)
+		if(accel == 0 || accel > STEP_ACCEL_MAX)		// Acceleration out of range
+			return ERROR_GENERAL;
+		if(this->wave.enabled)							// Waveform playing until Stop()
 			return ERROR_GENERAL;
 
-		this->position = pos;
+		// Hot motor : softer ramps
+		accel = (uint32_t)((float32_t)accel * this->thermal.derate);
+		if(accel == 0)
+			accel = 1;
+
+		// Wait for the previous move to be stopped
+		this->velocity.enabled = false;
+		this->sync.master = -1;
+		this->nb_pulse = 0;
+		this->ramp.state = RAMP_NONE;
+
+		if(steps == 0)
+			return 0;
+
+		// Steps needed to reach cruise speed
+		speedLimit = (uint32_t)(((float32_t)speed * (float32_t)speed) / (2.0f * (float32_t)accel));
+		if(speedLimit == 0)
+			speedLimit = 1;
+
+		// Steps before deceleration if cruise speed isn't reached
+		accelLimit = steps / 2u;
+		if(accelLimit == 0)
+			accelLimit = 1;
+
+		if(speedLimit < accelLimit)
+			this->ramp.decelCount = -(int32_t)speedLimit;
+		else
+			this->ramp.decelCount = -(int32_t)(steps - accelLimit);
+
+		if(this->ramp.decelCount == 0)
+			this->ramp.decelCount = -1;
+
+		// First interval (only sqrt of the move)
+		c0 = (uint32_t)(RAMP_C0_CORRECTION * (float32_t)freq * Utils::Sqrt(2.0f / (float32_t)accel));
+
+		this->ramp.minInterval			= this->avoidBands(freq / speed, true);
+		this->ramp.lastAccelInterval	= c0;
+		this->ramp.decelStart			= steps + this->ramp.decelCount;
+		this->ramp.stepCount			= 0;
+		this->ramp.accelCount			= 0;
+		this->ramp.rest					= 0;
+
+		if(c0 <= this->ramp.minInterval)
+		{
+			c0 = this->ramp.minInterval;
+			this->ramp.lastAccelInterval = c0;
+			this->ramp.state = RAMP_RUN;
+		}
+		else
+		{
+			this->ramp.state = RAMP_ACCEL;
+		}
+
+		this->stepInterval = c0;
+		this->nb_pulse = steps;
+		this->startStepping();
 
 		return 0;
 	}
 
-	bool Drv8813::IsMoving()
-    {
-        if((this->nb_pulse!=0 or this->run) && this->direction!=DISABLED)
-            return true;
-        else
-            return false;
-    }
+	uint32_t Drv8813::MoveSync (Drv8813* const drivers[], const int32_t steps[], uint32_t count, uint32_t speed, uint32_t accel)
+	{
+		Drv8813* master = NULL;
+		Drv8813* drv = NULL;
+		Drv8813State dir = Drv8813State_t::FORWARD;
+		uint32_t total = 0u, n = 0u, slaves = 0u;
+		uint32_t primask, i, rval;
 
+		for(i = 0u; i < count; i++)
+		{
+			if(drivers[i]->wave.enabled || (drivers[i]->def.MODE == DC_MODE))
+				return ERROR_GENERAL;
+
+			// Longest axis gives the timeline
+			n = (uint32_t)abs(steps[i]);
+			if(n > total)
+			{
+				total = n;
+				master = drivers[i];
+				dir = (steps[i] < 0) ? Drv8813State_t::BACKWARD : Drv8813State_t::FORWARD;
+			}
+		}
+
+		if(master == NULL)
+			return 0;
+
+		primask = __get_PRIMASK();
+		__disable_irq();
+
+		// Previous timelines are left
+		for(i = 0u; i < count; i++)
+		{
+			if(drivers[i]->sync.slaves != 0u)
+				drivers[i]->syncRelease();
+		}
+
+		for(i = 0u; i < count; i++)
+		{
+			drv = drivers[i];
+			n = (uint32_t)abs(steps[i]);
+			if((drv == master) || (n == 0u))
+				continue;
+
+			// Own step channel stays idle, run current while slaved
+			drv->velocity.enabled = false;
+			drv->ramp.state = RAMP_NONE;
+			drv->run = false;
+			drv->holdPending = false;
+			drv->holding = false;
+			drv->direction = (steps[i] < 0) ? Drv8813State_t::BACKWARD : Drv8813State_t::FORWARD;
+			ManageStepper(drv);
+
+			drv->sync.master = (int32_t)master->id;
+			drv->sync.steps = n;
+			drv->sync.error = (int32_t)(total / 2u);
+			drv->nb_pulse = n;
+
+			slaves |= 1u << drv->id;
+		}
+
+		master->SetDirection(dir);
+		master->sync.slaves = slaves;
+		master->sync.total = total;
+
+		if((rval = master->Move(total, speed, accel)) != 0u)
+			master->syncRelease();
+		else
+		{
+			// Slaves cruise interval : full current decision in ManageStepper()
+			for(uint32_t set = slaves; set != 0u; set &= set - 1u)
+			{
+				drv = _drv8813[_drv8813First(set)];
+				drv->stepInterval = (uint32_t)(((uint64_t)master->ramp.minInterval * total) / drv->sync.steps);
+			}
+		}
+
+		__set_PRIMASK(primask);
+
+		return rval;
+	}
+
+	void Drv8813::syncStep (void)
+	{
+		Drv8813* drv = NULL;
+
+		for(uint32_t set = this->sync.slaves; set != 0u; set &= set - 1u)
+		{
+			drv = _drv8813[_drv8813First(set)];
+
+			// Slave left the timeline (other order, stall)
+			if((drv->sync.master != (int32_t)this->id) || (drv->nb_pulse == 0u))
+				continue;
+
+			drv->sync.error -= (int32_t)drv->sync.steps;
+			if(drv->sync.error < 0)
+			{
+				drv->sync.error += (int32_t)this->sync.total;
+				drv->stepOnce();
+			}
+		}
+
+		if(this->nb_pulse == 0u)
+			this->syncRelease();
+	}
+
+	void Drv8813::syncRelease (void)
+	{
+		Drv8813* drv = NULL;
+
+		for(uint32_t set = this->sync.slaves; set != 0u; set &= set - 1u)
+		{
+			drv = _drv8813[_drv8813First(set)];
+
+			if(drv->sync.master == (int32_t)this->id)
+			{
+				drv->nb_pulse = 0;
+				drv->sync.master = -1;
+			}
+		}
+
+		this->sync.slaves = 0u;
+	}
+
+	void Drv8813::rampCompute (void)
+	{
+		int32_t interval = (int32_t)this->stepInterval;
+		int32_t den = 0;
+
+		this->ramp.stepCount++;
+
+		switch(this->ramp.state)
+		{
+		case RAMP_ACCEL:
+			this->ramp.accelCount++;
+			den = 4 * this->ramp.accelCount + 1;
+			interval = interval - (2 * interval + this->ramp.rest) / den;
+			this->ramp.rest = (2 * (int32_t)this->stepInterval + this->ramp.rest) % den;
+
+			if(this->ramp.stepCount >= this->ramp.decelStart)
+			{
+				this->ramp.accelCount = this->ramp.decelCount;
+				this->ramp.state = RAMP_DECEL;
+			}
+			else if(interval <= (int32_t)this->ramp.minInterval)
+			{
+				this->ramp.lastAccelInterval = interval;
+				interval = this->ramp.minInterval;
+				this->ramp.rest = 0;
+				this->ramp.state = RAMP_RUN;
+			}
+			else
+			{
+				interval = this->rampCross(interval);
+			}
+			break;
+
+		case RAMP_RUN:
+			interval = this->ramp.minInterval;
+
+			if(this->ramp.stepCount >= this->ramp.decelStart)
+			{
+				this->ramp.accelCount = this->ramp.decelCount;
+				interval = this->ramp.lastAccelInterval;
+				this->ramp.state = RAMP_DECEL;
+			}
+			break;
+
+		case RAMP_DECEL:
+			this->ramp.accelCount++;
+			if(this->ramp.accelCount < 0)
+			{
+				den = 4 * this->ramp.accelCount + 1;
+				interval = interval - (2 * interval + this->ramp.rest) / den;
+				this->ramp.rest = (2 * (int32_t)this->stepInterval + this->ramp.rest) % den;
+				interval = this->rampCross(interval);
+			}
+			else
+			{
+				this->ramp.state = RAMP_NONE;
+			}
+			break;
+
+		default:
+			break;
+		}
+
+		if(interval < 1)
+			interval = 1;
+
+		this->stepInterval = (uint32_t)interval;
+	}
+
+	void Drv8813::updateScale (void)
+	{
+		this->ticksByTurn = (float32_t)this->tim->GetTickFrequency() / (float32_t)this->stepsPerTurn;
+		this->rpsMax      = (float32_t)STEP_SPEED_MAX / (float32_t)this->stepsPerTurn;
+
+		// Band edges follow the step unit
+		for(uint32_t i = 0; i < DRV8813_BANDS_MAX; i++)
+		{
+			if((this->bands[i].low > 0.0f) && (this->bands[i].high > this->bands[i].low))
+			{
+				this->bands[i].slow = (uint32_t)(this->ticksByTurn / this->bands[i].low);
+				this->bands[i].fast = (uint32_t)(this->ticksByTurn / this->bands[i].high);
+			}
+			else
+			{
+				this->bands[i].slow = 0u;
+				this->bands[i].fast = 0u;
+			}
+		}
+	}
+
+	uint32_t Drv8813::SetResonanceBand (uint32_t index, float32_t low, float32_t high)
+	{
+		uint32_t primask;
+
+		if(index >= DRV8813_BANDS_MAX)
+			return ERROR_GENERAL;
+
+		primask = __get_PRIMASK();
+		__disable_irq();
+
+		this->bands[index].low = low;
+		this->bands[index].high = high;
+		this->updateScale();
+
+		__set_PRIMASK(primask);
+
+		return 0;
+	}
+
+	uint32_t Drv8813::avoidBands (uint32_t interval, bool slower)
+	{
+		if(interval == 0u)
+			return 0u;
+
+		for(uint32_t i = 0; i < DRV8813_BANDS_MAX; i++)
+		{
+			const DRV8813_BAND* b = &this->bands[i];
+
+			if((interval <= b->fast) || (interval >= b->slow))
+				continue;
+
+			// Nearest edge in speed : interval above the harmonic mean is slower
+			if(slower || (((uint64_t)interval * (b->slow + b->fast)) >= (2ull * b->slow * b->fast)))
+				return b->slow;
+			else
+				return b->fast;
+		}
+
+		return interval;
+	}
+
+	int32_t Drv8813::rampCross (int32_t interval)
+	{
+		float32_t k;
+
+		for(uint32_t i = 0; i < DRV8813_BANDS_MAX; i++)
+		{
+			const DRV8813_BAND* b = &this->bands[i];
+			int32_t edge;
+
+			if((interval <= (int32_t)b->fast) || (interval >= (int32_t)b->slow))
+				continue;
+
+			// Accelerating : upper edge, decelerating : lower edge
+			edge = (this->ramp.state == RAMP_DECEL) ? (int32_t)b->slow : (int32_t)b->fast;
+
+			// Ramp index follows the speed (interval ~ 1 / sqrt(index))
+			k = (float32_t)interval / (float32_t)edge;
+			this->ramp.accelCount = (int32_t)((float32_t)this->ramp.accelCount * k * k);
+			if((this->ramp.state == RAMP_DECEL) && (this->ramp.accelCount > -1))
+				this->ramp.accelCount = -1;
+			this->ramp.rest = 0;
+
+			return edge;
+		}
+
+		return interval;
+	}
+
+	void Drv8813::startStepping (void)
+	{
+		uint32_t primask;
+
+		if((this->stepInterval == 0) || (this->IsMoving() == false))
+			return;
+
+		// Slave : stepped by the master timeline
+		if(this->sync.master >= 0)
+			return;
+
+		// DC motor : bridge driven by SetSpeedDC()
+		if(this->def.MODE == DC_MODE)
+			return;
+
+		// Steps are played by DMA
+		if(this->wave.enabled)
+			return;
+
+		// Stalled : moves are dropped until ClearStall() (or ClearEmergency())
+		if(this->stalled || _emergency)
+		{
+			this->nb_pulse = 0;
+			this->run = false;
+			this->ramp.state = RAMP_NONE;
+			return;
+		}
+
+		// Compare channel is shared with step interrupt
+		primask = __get_PRIMASK();
+		__disable_irq();
+
+		if((this->stepping == false) || this->holdPending)
+		{
+			// Leave standstill : cancel hold delay, restore current before first step
+			this->holdPending = false;
+			if(this->holding)
+			{
+				this->holding = false;
+				ManageStepper(this);
+			}
+
+			this->stepping = true;
+			this->stepWait = this->stepInterval;
+			ScheduleStep(this, true);
+		}
+
+		__set_PRIMASK(primask);
+	}
+
+	void Drv8813::ArmStepProbe (void)
+	{
+		_probeDone = false;
+		__DMB();
+		_probeArmed = true;
+	}
+
+	bool Drv8813::ReadStepProbe (uint32_t* us)
+	{
+		if(!_probeDone)
+			return false;
+
+		__DMB();
+		*us = _probeTime;
+
+		return true;
+	}
+
+	void Drv8813::INTERNAL_StepCallback (void)
+	{
+		// Slave : stepped by the master timeline
+		if(this->sync.master >= 0)
+		{
+			this->tim->StopCompare(this->def.STEP_CHANNEL);
+			this->stepping = false;
+			return;
+		}
+
+		// Long interval : wait remaining ticks (a faster stream rate cuts it)
+		if(this->stepWait > 0)
+		{
+			if(this->velocity.enabled && (this->velocity.interval != 0u) && (this->stepWait > this->velocity.interval))
+				this->stepWait = this->velocity.interval;
+
+			ScheduleStep(this, false);
+			return;
+		}
+
+		// Velocity mode : rate and direction change on step boundary, step index kept
+		if(this->velocity.enabled)
+		{
+			this->stepInterval = this->velocity.interval;
+			if(this->stepInterval != 0u)
+				this->direction = this->velocity.direction;
+		}
+
+		if(this->IsMoving() == false || this->stepInterval == 0)
+		{
+			// Standstill : wait hold delay on step channel, then reduce current
+			if((this->holdInterval > 0) && (this->holding == false) && (this->direction != DISABLED))
+			{
+				if(this->holdPending == false)
+				{
+					this->holdPending = true;
+					this->stepWait = this->holdInterval;
+					ScheduleStep(this, false);
+					return;
+				}
+
+				this->holdPending = false;
+				this->holding = true;
+				ManageStepper(this);
+			}
+
+			// Stopped or stalled master : slaves stop too
+			if(this->sync.slaves != 0u)
+				this->syncRelease();
+
+			this->tim->StopCompare(this->def.STEP_CHANNEL);
+			this->stepping = false;
+			return;
+		}
+
+		_drv8813Probe();
+
+		this->stepOnce();
+
+		if(this->sync.slaves != 0u)
+			this->syncStep();
+
+		// Acceleration ramp
+		if(this->ramp.state != RAMP_NONE)
+			this->rampCompute();
+
+		// Next step edge
+		this->stepWait = this->stepInterval;
+		ScheduleStep(this, false);
+	}
+
+	void Drv8813::stepOnce (void)
+	{
+		if(this->direction == Drv8813State_t::FORWARD)				//forward 1 step
+		{
+			this->stepIndex += this->def.USTEP_MODE;
+			if(this->stepIndex >= MAX_USTEP)
+				this->stepIndex=0;
+
+			this->position += 1;
+			if(this->position >= this->stepsPerTurn)
+				this->position=0;
+			this->steps++;
+		}
+		else if(this->direction == Drv8813State_t::BACKWARD)		//backward 1 step
+		{
+			if(this->stepIndex == 0)
+				this->stepIndex = MAX_USTEP;
+			this->stepIndex -= this->def.USTEP_MODE;
+
+			if(this->position == 0)
+				this->position=this->stepsPerTurn;
+			this->position -= 1;
+			this->steps--;
+		}
+
+		if(this->nb_pulse > 0)
+		{
+			this->nb_pulse--;
+
+			// Last step : MoveFinished is raised by the software interrupt
+			if(this->nb_pulse == 0)
+			{
+				this->finished = true;
+				_drv8813Post(this->id);
+			}
+		}
+
+		ManageStepper(this);		//manage IO pin and PWM function of step index
+	}
+
+	void Drv8813::Supervise (void)
+	{
+		uint8_t level = 0u;
+		uint8_t output[ExtDAC::ExtDAC_Channel_MAX];
+		uint32_t ch = this->def.DAC_CHANNEL;
+		uint32_t i = 0u;
+
+		if(this->def.MODE != DC_MODE)
+			this->thermalUpdate();
+
+		// Current reference : standstill, ramps or constant speed
+		if(this->dac != NULL)
+		{
+			level = this->referenceLevel();
+
+			// Drivers sharing the channel may be supervised from other tasks
+			taskENTER_CRITICAL();
+
+			_dacRequest[this->id] = level;
+
+			for(uint32_t set = _drv8813Created; set != 0u; set &= set - 1u)
+			{
+				i = _drv8813First(set);
+
+				if((_drv8813[i]->def.DAC_CHANNEL == ch) && (_dacRequest[i] > level))
+					level = _dacRequest[i];
+			}
+
+			// Retried on next call if the previous update is still pending
+			if(level != _dacOutput[ch])
+			{
+				output[ch] = level;
+
+				if(this->dac->SetOutputValues(1u << ch, output) == NO_ERROR)
+					_dacOutput[ch] = level;
+			}
+
+			taskEXIT_CRITICAL();
+		}
+
+		// Bridges decay : slow at standstill, fast at high step rates
+		this->decayApply();
+
+		if(this->stalled || (this->direction == DISABLED))
+			return;
+
+		// Fault pin without interrupt line
+		if(this->GpioInst.FAULT->Get() == GPIO::State::Low)
+		{
+			this->INTERNAL_Stall();
+			return;
+		}
+
+		if(this->def.MODE == DC_MODE)
+		{
+			this->dcControl();
+			return;
+		}
+
+		// Coil current : no back-EMF on a blocked rotor
+		if((this->GpioInst.SENSE != NULL) && this->IsMoving() && (this->holding == false))
+		{
+			if(this->GpioInst.SENSE->StartConv() == ADC_ERROR_BUSY)
+				return;
+
+			this->GpioInst.SENSE->WaitWhileBusy();
+
+			if(this->GpioInst.SENSE->GetResult() > STALL_CURRENT_MAX)
+				this->INTERNAL_Stall();
+		}
+	}
+
+	void Drv8813::INTERNAL_Stall (void)
+	{
+		uint32_t primask;
+
+		// Step interrupt stops on its next edge
+		primask = __get_PRIMASK();
+		__disable_irq();
+
+		this->nb_pulse = 0;
+		this->run = false;
+		this->ramp.state = RAMP_NONE;
+		this->stalled = true;
+		this->stallPending = true;
+
+		if(this->wave.enabled)
+			this->waveStop();
+
+		if(this->def.MODE == DC_MODE)
+		{
+			this->direction = DISABLED;
+			this->dcOutput(0.0f);
+		}
+
+		__set_PRIMASK(primask);
+
+		// Stalled is raised by the software interrupt
+		_drv8813Post(this->id);
+	}
+
+	void Drv8813::EmergencyStop (void)
+	{
+		Drv8813* drv = NULL;
+		uint32_t primask;
+
+		primask = __get_PRIMASK();
+		__disable_irq();
+
+		_emergency = true;
+
+		// Outputs off first : one BSRR store (SLEEP is shared, no driver created : outputs never enabled)
+		if(_drv8813Created != 0u)
+			_drv8813[_drv8813First(_drv8813Created)]->GpioInst.SLEEP->SetFast(GPIO::State::Low);
+
+		// Step interrupts stop on their next edge
+		for(uint32_t set = _drv8813Created; set != 0u; set &= set - 1u)
+		{
+			drv = _drv8813[_drv8813First(set)];
+
+			drv->nb_pulse = 0;
+			drv->run = false;
+			drv->ramp.state = RAMP_NONE;
+
+			if(drv->wave.enabled)
+				drv->waveStop();
+
+			if(drv->def.MODE == DC_MODE)
+			{
+				drv->direction = DISABLED;
+				drv->dcOutput(0.0f);
+			}
+		}
+
+		__set_PRIMASK(primask);
+	}
+
+	void Drv8813::ClearEmergency (void)
+	{
+		if(!_emergency)
+			return;
+
+		// Charge pump and regulators wake up in 1 ms (datasheet tWAKE)
+		if(_drv8813Created != 0u)
+			_drv8813[_drv8813First(_drv8813Created)]->GpioInst.SLEEP->Set(GPIO::State::High);
+		vTaskDelay(pdMS_TO_TICKS(1u) + 1u);
+
+		_emergency = false;
+	}
+
+	bool Drv8813::IsEmergency (void)
+	{
+		return _emergency;
+	}
+
+	bool Drv8813::IsAnyMoving (void)
+	{
+		Drv8813* drv = NULL;
+
+		for(uint32_t set = _drv8813Created; set != 0u; set &= set - 1u)
+		{
+			drv = _drv8813[_drv8813First(set)];
+
+			if(drv->IsMoving() || drv->wave.enabled)
+				return true;
+		}
+
+		return false;
+	}
+
+	uint32_t Drv8813::ReadPosition (void)
+	{
+		return this->position;
+	}
+
+	uint32_t Drv8813::SetPosition (uint32_t pos)
+	{
+		if(pos >= this->stepsPerTurn)
+			return ERROR_GENERAL;
+
+		if(this->stepsPerTurn == 0)
+			return ERROR_GENERAL;
+
+		this->position = pos;
+
+		return 0;
+	}
+
+	uint32_t Drv8813::SetSpeedDC (float32_t speed)
+	{
+		if(this->def.MODE != DC_MODE)
+			return ERROR_GENERAL;
+
+		// Stalled : motor stays released until ClearStall() (or ClearEmergency())
+		if(this->stalled || _emergency)
+			speed = 0.0f;
+
+		// Open loop : speed is the duty cycle
+		if(this->dc.encoder == NULL)
+			speed = fmaxf(-1.0f, fminf(speed, 1.0f));
+
+		// Leave standstill : speed loop restarts
+		if(this->direction == DISABLED)
+		{
+			this->dc.pid.Reset();
+			this->dc.time = Utils::Clock::GetMicros();
+			if(this->dc.encoder != NULL)
+				this->dc.encoder->GetRelativeValue();
+		}
+
+		this->dc.setpoint = speed;
+		this->dc.pid.SetSetpoint(speed);
+
+		if(speed == 0.0f)
+		{
+			this->direction = DISABLED;
+			this->dcOutput(0.0f);
+		}
+		else
+		{
+			this->direction = (speed > 0.0f) ? FORWARD : BACKWARD;
+			if(this->dc.encoder == NULL)
+				this->dcOutput(speed);
+		}
+
+		return 0;
+	}
+
+	void Drv8813::dcOutput (float32_t duty)
+	{
+		this->dc.duty = duty;
+
+		// Direction on PHA, speed on ENA, bridge B released
+		this->phases.Stage(COIL_A, (duty >= 0.0f) ? GPIO::State::High : GPIO::State::Low);
+		this->phases.Commit();
+
+		this->coils.Stage(COIL_A, (uint32_t)(fabsf(duty) * (float32_t)this->ccrFull));
+		this->coils.Stage(COIL_B, 0u);
+		this->coils.Commit();
+	}
+
+	void Drv8813::dcControl (void)
+	{
+		uint32_t now = Utils::Clock::GetMicros();
+		float32_t period = (float32_t)(now - this->dc.time) * 1e-6f;
+		int32_t ticks;
+
+		if((this->dc.encoder == NULL) || (now == this->dc.time))
+			return;
+
+		ticks = this->dc.encoder->GetRelativeValue();
+		this->dc.time = now;
+		this->dc.speed = (float32_t)ticks / period;
+
+		// Late call : integral and derivative restart from measured speed
+		if(period > DC_PERIOD_MAX)
+		{
+			this->dc.pid.Reset();
+			return;
+		}
+
+		this->dcOutput(this->dc.pid.Get(this->dc.speed, period));
+	}
+
+	uint8_t Drv8813::referenceLevel (void)
+	{
+		float32_t derate = this->thermal.derate;
+
+		// Hold and ramps boost derated, never below run reference during ramps
+		if(this->holding || this->stalled || (this->direction == DISABLED))
+			return (uint8_t)((float32_t)this->def.DAC_HOLD * derate);
+		else if(((this->ramp.state == RAMP_ACCEL) || (this->ramp.state == RAMP_DECEL)) && (this->def.DAC_ACCEL > this->def.DAC_RUN))
+			return (uint8_t)((float32_t)this->def.DAC_RUN + (float32_t)(this->def.DAC_ACCEL - this->def.DAC_RUN) * derate);
+		else if((this->ramp.state == RAMP_ACCEL) || (this->ramp.state == RAMP_DECEL))
+			return this->def.DAC_ACCEL;
+		else
+			return this->def.DAC_RUN;
+	}
+
+	bool Drv8813::decayMode (void)
+	{
+		uint32_t interval = this->stepInterval;
+
+		// DC bridge and policy off : fast decay as at boot
+		if((this->def.MODE == DC_MODE) || (this->decayInterval == 0u))
+			return true;
+
+		if(this->holding || this->stalled || (this->direction == DISABLED) || !this->stepping || (interval == 0u))
+			return false;
+
+		if(interval <= this->decayInterval)
+			return true;
+		if(interval >= (this->decayInterval + this->decayInterval / 4u))
+			return false;
+
+		return this->decayFast;
+	}
+
+	void Drv8813::decayApply (void)
+	{
+		bool fast = false;
+		uint32_t i = 0u;
+
+		this->decayFast = this->decayMode();
+
+		// Drivers sharing the pin may be supervised from other tasks
+		taskENTER_CRITICAL();
+
+		_decayRequest[this->id] = this->decayFast;
+
+		for(uint32_t set = _drv8813Created; set != 0u; set &= set - 1u)
+		{
+			i = _drv8813First(set);
+
+			if((_drv8813[i]->def.GPIO_DECAY == this->def.GPIO_DECAY) && _decayRequest[i])
+				fast = true;
+		}
+
+		this->GpioInst.DECAY->Set(fast ? GPIO::State::High : GPIO::State::Low);
+
+		taskEXIT_CRITICAL();
+	}
+
+	void Drv8813::thermalUpdate (void)
+	{
+		uint32_t now = Utils::Clock::GetMicros();
+		float32_t period = (float32_t)(now - this->thermal.time) * 1e-6f;
+		float32_t current = 0.0f;
+		float32_t derate = 1.0f;
+		uint32_t scale = 0u;
+
+		this->thermal.time = now;
+
+		if(period > THERMAL_PERIOD_MAX)
+			period = THERMAL_PERIOD_MAX;
+
+		// Commanded current, relative to run current at 100% (same choice as ManageStepper())
+		if(!this->stalled && (this->direction != DISABLED))
+		{
+			if(this->holding)
+				scale = this->scaleHold;
+			else if((this->ramp.state == RAMP_ACCEL) || (this->ramp.state == RAMP_DECEL))
+				scale = this->scaleAccel;
+			else if((this->IsMoving() && (this->stepInterval < this->fullInterval)) || this->wave.enabled)
+				scale = CURRENT_SCALE(100u);
+			else
+				scale = this->scaleRun;
+
+			current = (float32_t)scale / 65536.0f;
+
+			// Chopping reference sets the current the PWM scale applies to
+			if((this->dac != NULL) && (this->def.DAC_RUN != 0u))
+				current *= (float32_t)this->referenceLevel() / (float32_t)this->def.DAC_RUN;
+		}
+
+		// First order : heat tends to current^2
+		this->thermal.heat += (current * current - this->thermal.heat) * (period / THERMAL_TAU);
+
+		if(this->thermal.heat > THERMAL_DERATE_START)
+		{
+			derate = 1.0f - (1.0f - THERMAL_DERATE_MIN) * (this->thermal.heat - THERMAL_DERATE_START) / (THERMAL_LIMIT - THERMAL_DERATE_START);
+			if(derate < THERMAL_DERATE_MIN)
+				derate = THERMAL_DERATE_MIN;
+		}
+
+		// Scales follow in 1% steps, back to full once cooled
+		if((fabsf(derate - this->thermal.derate) >= 0.01f) || ((derate == 1.0f) && (this->thermal.derate != 1.0f)))
+		{
+			this->thermal.derate = derate;
+			this->currentApply();
+		}
+	}
+
+	uint32_t Drv8813::StartWaveform (uint32_t speed)
+	{
+		DMA_InitTypeDef DMAStruct;
+		TIM_TypeDef* timer = this->GpioInst.ENA->GetTimer();
+		uint32_t stride = this->def.USTEP_MODE;
+		uint32_t length = 0u;
+		uint32_t offset = 0u, rest = 0u;
+		uint32_t primask;
+
+		if(this->def.WAVE_STREAM == NULL)
+			return ERROR_GENERAL;
+		if((speed == 0u) || (speed > STEP_SPEED_MAX))				// Speed out of range
+			return ERROR_GENERAL;
+		if(this->stalled || this->wave.enabled || this->IsMoving() || (this->direction == DISABLED))
+			return ERROR_GENERAL;
+
+		// PWM periods per quarter, 2 periods are needed before the phase change
+		length = ((WAVE_QUARTER / stride) * this->GpioInst.ENA->GetFrequency() + (speed / 2u)) / speed;
+		if((length < 3u) || (length > DRV8813_WAVE_LENGTH))
+			return ERROR_GENERAL;
+
+		// First quarter : steps left before next phase change
+		if(this->direction == FORWARD)
+		{
+			offset = (this->stepIndex + MAX_USTEP - (WAVE_QUARTER / 2u) - 1u) % WAVE_QUARTER;
+			rest = (WAVE_QUARTER - 1u - offset) / stride;
+		}
+		else
+		{
+			offset = (this->stepIndex + MAX_USTEP - (WAVE_QUARTER / 2u)) % WAVE_QUARTER;
+			rest = offset / stride;
+		}
+
+		if(rest == 0u)
+			rest = WAVE_QUARTER / stride;
+
+		// Step channel may wait for hold delay
+		primask = __get_PRIMASK();
+		__disable_irq();
+
+		this->tim->StopCompare(this->def.STEP_CHANNEL);
+		this->stepping = false;
+		this->holdPending = false;
+		this->holding = false;
+		this->ramp.state = RAMP_NONE;
+		this->run = true;
+
+		this->wave.length = length;
+		this->wave.scale = (speed > STEP_SPEED_FULL) ? 0u : this->scaleRun;
+
+		// Current is restored on first update event, phases are already set from step index
+		this->waveQuarter(this->stepIndex, rest);
+		this->wave.active = this->wave.gen;
+		this->wave.t = 2u;
+		this->waveFill(0u);
+		this->waveFill(1u);
+
+		DMA_DeInit(this->def.WAVE_STREAM);
+
+		DMAStruct.DMA_Channel				=	this->def.WAVE_CHANNEL;
+		DMAStruct.DMA_PeripheralBaseAddr	=	(uint32_t)&timer->DMAR;
+		DMAStruct.DMA_Memory0BaseAddr		=	(uint32_t)this->wave.buffer;
+		DMAStruct.DMA_DIR					=	DMA_DIR_MemoryToPeripheral;
+		DMAStruct.DMA_BufferSize			=	4u * length;
+		DMAStruct.DMA_PeripheralInc			=	DMA_PeripheralInc_Disable;
+		DMAStruct.DMA_MemoryInc				=	DMA_MemoryInc_Enable;
+		DMAStruct.DMA_PeripheralDataSize	=	DMA_PeripheralDataSize_HalfWord;
+		DMAStruct.DMA_MemoryDataSize		=	DMA_MemoryDataSize_HalfWord;
+		DMAStruct.DMA_Mode					=	DMA_Mode_Circular;
+		DMAStruct.DMA_Priority				=	DMA_Priority_High;
+		DMAStruct.DMA_FIFOMode				=	DMA_FIFOMode_Disable;
+		DMAStruct.DMA_FIFOThreshold			=	DMA_FIFOThreshold_HalfFull;
+		DMAStruct.DMA_MemoryBurst			=	DMA_MemoryBurst_Single;
+		DMAStruct.DMA_PeripheralBurst		=	DMA_PeripheralBurst_Single;
+
+		DMA_Init(this->def.WAVE_STREAM, &DMAStruct);
+		DMA_ITConfig(this->def.WAVE_STREAM, DMA_IT_HT | DMA_IT_TC, ENABLE);
+		DMA_Cmd(this->def.WAVE_STREAM, ENABLE);
+
+		this->wave.enabled = true;
+		TIM_DMACmd(timer, TIM_DMA_Update, ENABLE);
+
+		// First quarter is played from the next update
+		_drv8813Probe();
+
+		__set_PRIMASK(primask);
+
+		return 0;
+	}
+
+	void Drv8813::waveQuarter (uint32_t from, uint32_t steps)
+	{
+		uint32_t first = WaveIndex(this, from, 1u);
+		uint32_t middle = 0u;
+
+		// Phases of the quarter holding the first step : sign at the middle of the quarter
+		if(this->direction == BACKWARD)
+			middle = (first + MAX_USTEP - (WAVE_QUARTER / 2u)) % MAX_USTEP;
+		else
+			middle = (first + MAX_USTEP - (WAVE_QUARTER / 2u) - 1u) % MAX_USTEP;
+
+		middle = ((middle / WAVE_QUARTER) + 1u) * WAVE_QUARTER % MAX_USTEP;
+
+		this->wave.gen.from = from;
+		this->wave.gen.steps = steps;
+		this->wave.gen.PositivA = STEP_DEF[middle].PositivA;
+		this->wave.gen.PositivB = STEP_DEF[middle].PositivB;
+		this->wave.t = 0u;
+	}
+
+	void Drv8813::waveFill (uint32_t half)
+	{
+		uint16_t (*entry)[2] = &this->wave.buffer[half * this->wave.length];
+		uint32_t length = this->wave.length;
+		uint32_t count = 0u, index = 0u;
+
+		for(uint32_t i = 0u; i < length; i++)
+		{
+			// Next quarter starts 2 periods before end of half, it is active when the half is played
+			if(this->wave.t >= length)
+			{
+				this->waveQuarter(WaveIndex(this, this->wave.gen.from, this->wave.gen.steps), WAVE_QUARTER / this->def.USTEP_MODE);
+				this->wave.quarter[half] = this->wave.gen;
+			}
+
+			// Steps evenly spread over the quarter, first one on its first period
+			count = ((this->wave.t + 1u) * this->wave.gen.steps + length - 1u) / length;
+			if(count > this->wave.gen.steps)
+				count = this->wave.gen.steps;
+
+			index = WaveIndex(this, this->wave.gen.from, count);
+			entry[i][0] = WaveCompare(this, this->ccrA[index]);
+			entry[i][1] = WaveCompare(this, this->ccrB[index]);
+
+			this->wave.t++;
+		}
+	}
+
+	void Drv8813::waveStop (void)
+	{
+		const DRV8813_WAVE_QUARTER* q = &this->wave.active;
+		uint32_t count = (q->steps + this->wave.length - 1u) / this->wave.length;
+
+		TIM_DMACmd(this->GpioInst.ENA->GetTimer(), TIM_DMA_Update, DISABLE);
+		DMA_ITConfig(this->def.WAVE_STREAM, DMA_IT_HT | DMA_IT_TC, DISABLE);
+		DMA_Cmd(this->def.WAVE_STREAM, DISABLE);
+		DMA_ClearITPendingBit(this->def.WAVE_STREAM, this->def.WAVE_IT_HT | this->def.WAVE_IT_TC);
+
+		this->wave.enabled = false;
+		this->run = false;
+
+		// Steps of active quarter played so far (it has just started)
+		if(count > q->steps)
+			count = q->steps;
+
+		this->stepIndex = WaveIndex(this, q->from, count);
+		if(this->direction == BACKWARD)
+		{
+			this->steps -= (int64_t)count;
+			this->position = (this->position + this->stepsPerTurn - count) % this->stepsPerTurn;
+		}
+		else
+		{
+			this->steps += (int64_t)count;
+			this->position = (this->position + count) % this->stepsPerTurn;
+		}
+
+		// Back to compare values of step index
+		this->coils.Reload();
+		ManageStepper(this);
+	}
+
+	void Drv8813::INTERNAL_WaveCallback (void)
+	{
+		const DRV8813_WAVE_QUARTER* q = NULL;
+		uint32_t half = 0u;
+
+		if(DMA_GetITStatus(this->def.WAVE_STREAM, this->def.WAVE_IT_HT) == SET)
+		{
+			DMA_ClearITPendingBit(this->def.WAVE_STREAM, this->def.WAVE_IT_HT);
+			half = 0u;
+		}
+		else if(DMA_GetITStatus(this->def.WAVE_STREAM, this->def.WAVE_IT_TC) == SET)
+		{
+			DMA_ClearITPendingBit(this->def.WAVE_STREAM, this->def.WAVE_IT_TC);
+			half = 1u;
+		}
+		else
+			return;
+
+		if(this->wave.enabled == false)
+			return;
+
+		// Quarter played : step counters
+		q = &this->wave.active;
+		this->stepIndex = WaveIndex(this, q->from, q->steps);
+		if(this->direction == BACKWARD)
+		{
+			this->steps -= (int32_t)q->steps;
+			this->position = (this->position + this->stepsPerTurn - q->steps) % this->stepsPerTurn;
+		}
+		else
+		{
+			this->steps += (int32_t)q->steps;
+			this->position = (this->position + q->steps) % this->stepsPerTurn;
+		}
+
+		// Next quarter is now played
+		this->wave.active = this->wave.quarter[half];
+		q = &this->wave.active;
+
+		if(this->run == false)
+		{
+			this->waveStop();
+			return;
+		}
+
+		this->phases.Stage(COIL_A, q->PositivA ? GPIO::State::High : GPIO::State::Low);
+		this->phases.Stage(COIL_B, q->PositivB ? GPIO::State::High : GPIO::State::Low);
+		this->phases.Commit();
+
+		// Played half is refilled with the quarter after next
+		this->waveFill(half);
+	}
+
+	int64_t Drv8813::ReadSteps64 (void)
+	{
+		uint32_t primask;
+		int64_t steps;
+
+		// Two words written by the step interrupt
+		primask = __get_PRIMASK();
+		__disable_irq();
+		steps = this->steps;
+		__set_PRIMASK(primask);
+
+		return steps;
+	}
+
+	int64_t Drv8813::ReadTargetSteps (void)
+	{
+		uint32_t primask;
+		int64_t steps;
+
+		primask = __get_PRIMASK();
+		__disable_irq();
+
+		steps = this->steps;
+		if(this->direction == Drv8813State_t::BACKWARD)
+			steps -= (int64_t)this->nb_pulse;
+		else if(this->direction == Drv8813State_t::FORWARD)
+			steps += (int64_t)this->nb_pulse;
+
+		__set_PRIMASK(primask);
+
+		return steps;
+	}
+
+	bool Drv8813::IsMoving()
+    {
+        if((this->nb_pulse!=0 or this->run) && this->direction!=DISABLED)
+            return true;
+        else
+            return false;
+    }
+
+}
+
+/*----------------------------------------------------------------------------*/
+/* Interrupt Handler                                                          */
+/*----------------------------------------------------------------------------*/
+
+extern "C"
+{
+	/**
+	 * @brief Move completion and stall software interrupt
+	 */
+	void CEC_IRQHandler (void)
+	{
+		Drv8813* drv;
+		uint32_t set;
+
+		// Only posted drivers are visited
+		do
+		{
+			set = __LDREXW(&_drv8813Posted);
+		}
+		while(__STREXW(0u, &_drv8813Posted) != 0u);
+
+		for(; set != 0u; set &= set - 1u)
+		{
+			drv = _drv8813[_drv8813First(set)];
+
+			if(drv->stallPending)
+			{
+				drv->stallPending = false;
+				drv->Stalled();
+			}
+
+			if(drv->finished)
+			{
+				drv->finished = false;
+				drv->MoveFinished();
+			}
+		}
+	}
+
+	/**
+	 * @brief Waveform DMA, Drv8813 1 (TIM1_UP)
+	 */
+	void DMA2_Stream5_IRQHandler (void)
+	{
+		if(_drv8813[Drv8813::DRV8813_1] != NULL)
+			_drv8813[Drv8813::DRV8813_1]->INTERNAL_WaveCallback();
+	}
+
+	/**
+	 * @brief Waveform DMA, Drv8813 5 (TIM4_UP)
+	 */
+	void DMA1_Stream6_IRQHandler (void)
+	{
+		if(_drv8813[Drv8813::DRV8813_5] != NULL)
+			_drv8813[Drv8813::DRV8813_5]->INTERNAL_WaveCallback();
+	}
 }
@@ -0,0 +1,170 @@
+/**
+ * @file	DigitalInput.cpp
+ * @author	Kevin WYSOCKI
+ * @date	21 oct. 2017
+ * @brief	Debounced digital inputs sampled from one software timer
+ */
+
+#include <stddef.h>
+#include "DigitalInput.hpp"
+#include "StaticStorage.hpp"
+#include "Profiler.hpp"
+
+using namespace HAL;
+
+/*----------------------------------------------------------------------------*/
+/* Definitions                                                                */
+/*----------------------------------------------------------------------------*/
+
+#define DIN_SAMPLING_PERIOD		(1u)		// 1 kHz (software timer ticks)
+#define DIN_FILTER				(5u)		// 5 ms
+#define DIN_TOPZ_FILTER			(3u)		// 3 ms, reference switches
+
+#define DIN_FIRST_GPIO			(GPIO::GPIO57)
+
+/*----------------------------------------------------------------------------*/
+/* Private Members                                                            */
+/*----------------------------------------------------------------------------*/
+
+/**
+ * @brief Digital input instances
+ */
+static DigitalInput* _din[DigitalInput::INPUT_MAX] = {NULL};
+
+/**
+ * @brief Digital input instances storage
+ */
+static Utils::StaticStorage<DigitalInput, DigitalInput::INPUT_MAX> _dinStorage;
+
+/**
+ * @brief Sampling timer (started with the first instance)
+ */
+static SoftTimer _dinTimer;
+
+/*----------------------------------------------------------------------------*/
+/* Private Functions                                                          */
+/*----------------------------------------------------------------------------*/
+
+/**
+ * @brief Retrieve digital input definitions from ID
+ * @param id : Input ID
+ * @return DIN_DEF structure
+ */
+static DIN_DEF _getDinStruct (enum DigitalInput::ID id)
+{
+	DIN_DEF din;
+
+	assert(id < DigitalInput::INPUT_MAX);
+
+	// Board inputs are contiguous GPIO identifiers
+	din.GPIO		=	(enum GPIO::ID)(DIN_FIRST_GPIO + id);
+	din.FILTER		=	DIN_FILTER;
+	din.INVERTED	=	false;
+
+	switch(id)
+	{
+	case DigitalInput::INPUT2:
+	case DigitalInput::INPUT16:
+		din.FILTER	=	DIN_TOPZ_FILTER;
+		break;
+	default:
+		break;
+	}
+
+	return din;
+}
+
+/**
+ * @brief Sample all inputs (software timer tick interrupt)
+ * @param obj : unused
+ */
+static void _sampleEvent (void* obj)
+{
+	uint32_t timestamp = Utils::Profiler::GetCycles();
+
+	for(uint32_t i = 0u; i < DigitalInput::INPUT_MAX; i++)
+	{
+		if(_din[i] != NULL)
+			_din[i]->INTERNAL_Sample(timestamp);
+	}
+}
+
+/*----------------------------------------------------------------------------*/
+/* Class Implementation	                                                      */
+/*----------------------------------------------------------------------------*/
+namespace HAL
+{
+	DigitalInput* DigitalInput::GetInstance (enum DigitalInput::ID id)
+	{
+		assert(id < DigitalInput::INPUT_MAX);
+
+		// if instance already exists
+		if(_din[id] != NULL)
+		{
+			return _din[id];
+		}
+		else
+		{
+			// Create instance, sampling interrupt reads it once registered
+			_din[id] = new (_dinStorage.Get(id)) DigitalInput(id);
+
+			if(!_dinTimer.IsRunning())
+			{
+				_dinTimer.Elapsed += _sampleEvent;
+				_dinTimer.Start(DIN_SAMPLING_PERIOD, DIN_SAMPLING_PERIOD);
+			}
+
+			return _din[id];
+		}
+	}
+
+	DigitalInput::DigitalInput (enum DigitalInput::ID id)
+	{
+		bool active = false;
+
+		this->id = id;
+		this->def = _getDinStruct(id);
+		this->gpio = GPIO::GetInstance(this->def.GPIO);
+
+		// Start from current level, no edge at boot
+		active = (this->gpio->Get() == GPIO::High) != this->def.INVERTED;
+		this->count = active ? this->def.FILTER : 0u;
+		this->state = active ? GPIO::High : GPIO::Low;
+		this->edgeTimestamp = 0u;
+		this->edges = 0u;
+	}
+
+	void DigitalInput::SetFilter (uint8_t samples)
+	{
+		assert(samples > 0u);
+
+		this->def.FILTER = samples;
+		this->count = (this->state == GPIO::High) ? samples : 0u;
+	}
+
+	void DigitalInput::INTERNAL_Sample (uint32_t timestamp)
+	{
+		bool active = (this->gpio->Get() == GPIO::High) != this->def.INVERTED;
+
+		if(active)
+		{
+			if(this->count < this->def.FILTER)
+				this->count++;
+		}
+		else if(this->count > 0u)
+			this->count--;
+
+		// Edge once integrator reaches a limit
+		if((this->count == this->def.FILTER) && (this->state == GPIO::Low))
+			this->state = GPIO::High;
+		else if((this->count == 0u) && (this->state == GPIO::High))
+			this->state = GPIO::Low;
+		else
+			return;
+
+		this->edgeTimestamp = timestamp;
+		this->edges++;
+
+		this->Changed();
+	}
+}
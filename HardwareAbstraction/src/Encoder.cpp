@@ -7,7 +7,9 @@
 
 #include <stddef.h>
 #include "Encoder.hpp"
+#include "StaticStorage.hpp"
 #include "common.h"
+#include "Profiler.hpp"
 
 using namespace HAL;
 
@@ -23,10 +25,10 @@ using namespace HAL;
 #define ENC0_CH_B_PIN			(GPIO_Pin_1)
 #define ENC0_CH_B_PINSOURCE		(GPIO_PinSource1)
 #define ENC0_IO_AF				(GPIO_AF_TIM5)
-#define ENC0_RELOAD_VALUE		(4095)			// Number of steps per encoder turn minus one
+#define ENC0_RELOAD_VALUE		(0xFFFFFFFFu)	// Free running 32-bit counter
 #define ENC0_TIMER				(TIM5)
 #define ENC0_INT_CHANNEL		(TIM5_IRQn)
-#define ENC0_INT_PRIORITY		(0u)
+#define ENC0_INT_PRIORITY		(0u)			// Edge timestamp latency
 
 // TIM2_CH1/CH2
 #define ENC1_CH_A_PORT			(GPIOA)
@@ -36,24 +38,50 @@ using namespace HAL;
 #define ENC1_CH_B_PIN			(GPIO_Pin_9)
 #define ENC1_CH_B_PINSOURCE		(GPIO_PinSource9)
 #define ENC1_IO_AF				(GPIO_AF_TIM2)
-#define ENC1_RELOAD_VALUE		(4095)			// Number of steps per encoder turn minus one
+#define ENC1_RELOAD_VALUE		(0xFFFFFFFFu)	// Free running 32-bit counter
 #define ENC1_TIMER				(TIM2)
 #define ENC1_INT_CHANNEL		(TIM2_IRQn)
-#define ENC1_INT_PRIORITY		(0u)
+#define ENC1_INT_PRIORITY		(0u)			// Edge timestamp latency
 
-#define TIM_FLAG_OVERFLOW		(1u << 0u)
-#define TIM_FLAG_UNDERFLOW		(1u << 1u)
+// Snapshot : channel 3 latches both counters on TIM3 TRGO (update at motor PWM
+// frequency, see ADConverter), internal trigger ITR1 of TIM5, ITR2 of TIM2
+#define ENC_SNAPSHOT			(1u)
+#define ENC0_SNAPSHOT_TRIGGER	(TIM_TS_ITR1)
+#define ENC1_SNAPSHOT_TRIGGER	(TIM_TS_ITR2)
 
 /*----------------------------------------------------------------------------*/
 /* Private Members                                                            */
 /*----------------------------------------------------------------------------*/
 
 Encoder* _enc[Encoder::ENCODER_MAX] = {NULL};
+static Utils::StaticStorage<Encoder, Encoder::ENCODER_MAX> _encStorage;
 
 /*----------------------------------------------------------------------------*/
 /* Private Functions                                                          */
 /*----------------------------------------------------------------------------*/
 
+/**
+ * @brief Encoders definitions (flash), indexed by Encoder ID
+ */
+static const ENC_DEF _encDefs[Encoder::ENCODER_MAX] =
+{
+	// ENCODER0
+	{
+		{ENC0_CH_A_PORT, ENC0_CH_A_PIN, ENC0_CH_A_PINSOURCE, ENC0_IO_AF},		// CH_A
+		{ENC0_CH_B_PORT, ENC0_CH_B_PIN, ENC0_CH_B_PINSOURCE, ENC0_IO_AF},		// CH_B
+		{ENC0_TIMER, ENC0_RELOAD_VALUE, ENC0_SNAPSHOT_TRIGGER},					// TIMER
+		{ENC0_INT_PRIORITY, ENC0_INT_CHANNEL},									// INT
+	},
+
+	// ENCODER1
+	{
+		{ENC1_CH_A_PORT, ENC1_CH_A_PIN, ENC1_CH_A_PINSOURCE, ENC1_IO_AF},		// CH_A
+		{ENC1_CH_B_PORT, ENC1_CH_B_PIN, ENC1_CH_B_PINSOURCE, ENC1_IO_AF},		// CH_B
+		{ENC1_TIMER, ENC1_RELOAD_VALUE, ENC1_SNAPSHOT_TRIGGER},					// TIMER
+		{ENC1_INT_PRIORITY, ENC1_INT_CHANNEL},									// INT
+	},
+};
+
 /**
  * @brief Retrieve Encoder definitions from Encoder ID
  * @param id : Encoder ID
@@ -61,50 +89,9 @@ Encoder* _enc[Encoder::ENCODER_MAX] = {NULL};
  */
 static ENC_DEF _getENCStruct (enum Encoder::ID id)
 {
-	ENC_DEF enc;
-
 	assert(id < HAL::Encoder::ENCODER_MAX);
 
-	switch(id)
-	{
-	case Encoder::ENCODER0:
-		enc.CH_A.PORT			=	ENC0_CH_A_PORT;
-		enc.CH_A.PIN			=	ENC0_CH_A_PIN;
-		enc.CH_A.PINSOURCE		=	ENC0_CH_A_PINSOURCE;
-		enc.CH_A.AF				=	ENC0_IO_AF;
-		enc.CH_B.PORT			=	ENC0_CH_B_PORT;
-		enc.CH_B.PIN			=	ENC0_CH_B_PIN;
-		enc.CH_B.PINSOURCE		=	ENC0_CH_B_PINSOURCE;
-		enc.CH_B.AF				=	ENC0_IO_AF;
-
-		enc.TIMER.TIMER			=	ENC0_TIMER;
-		enc.TIMER.RELOAD_VAL	=	ENC0_RELOAD_VALUE;
-
-		enc.INT.PRIORITY		=	ENC0_INT_PRIORITY;
-		enc.INT.CHANNEL			=	ENC0_INT_CHANNEL;
-		break;
-
-	case Encoder::ENCODER1:
-		enc.CH_A.PORT			=	ENC1_CH_A_PORT;
-		enc.CH_A.PIN			=	ENC1_CH_A_PIN;
-		enc.CH_A.PINSOURCE		=	ENC1_CH_A_PINSOURCE;
-		enc.CH_A.AF				=	ENC1_IO_AF;
-		enc.CH_B.PORT			=	ENC1_CH_B_PORT;
-		enc.CH_B.PIN			=	ENC1_CH_B_PIN;
-		enc.CH_B.PINSOURCE		=	ENC1_CH_B_PINSOURCE;
-		enc.CH_B.AF				=	ENC1_IO_AF;
-
-		enc.TIMER.TIMER			=	ENC1_TIMER;
-		enc.TIMER.RELOAD_VAL	=	ENC1_RELOAD_VALUE;
-
-		enc.INT.PRIORITY		=	ENC1_INT_PRIORITY;
-		enc.INT.CHANNEL			=	ENC1_INT_CHANNEL;
-		break;
-	default:
-		break;
-	}
-
-	return enc;
+	return _encDefs[id];
 }
 
 /**
@@ -115,6 +102,7 @@ static void _hardwareInit (enum Encoder::ID id)
 {
 	GPIO_InitTypeDef GPIOStruct;
 	TIM_TimeBaseInitTypeDef TIMBaseStruct;
+	TIM_ICInitTypeDef ICStruct;
 	NVIC_InitTypeDef NVICStruct;
 
 	ENC_DEF enc;
@@ -154,8 +142,24 @@ static void _hardwareInit (enum Encoder::ID id)
 							   TIM_ICPolarity_Rising,
 							   TIM_ICPolarity_Rising);
 
-	TIM_ITConfig(enc.TIMER.TIMER, TIM_IT_Update, ENABLE);
-	TIM_ClearFlag(enc.TIMER.TIMER, TIM_FLAG_Update);
+	// Capture counter on channel A rising edges (one every 4 counts)
+	TIM_CCxCmd(enc.TIMER.TIMER, TIM_Channel_1, TIM_CCx_Enable);
+	TIM_ClearITPendingBit(enc.TIMER.TIMER, TIM_IT_CC1);
+	TIM_ITConfig(enc.TIMER.TIMER, TIM_IT_CC1, ENABLE);
+
+#if ENC_SNAPSHOT
+	// Capture counter on the internal trigger (encoder mode ignores it otherwise)
+	ICStruct.TIM_Channel		=	TIM_Channel_3;
+	ICStruct.TIM_ICPolarity		=	TIM_ICPolarity_Rising;
+	ICStruct.TIM_ICSelection	=	TIM_ICSelection_TRC;
+	ICStruct.TIM_ICPrescaler	=	TIM_ICPSC_DIV1;
+	ICStruct.TIM_ICFilter		=	0u;
+
+	TIM_SelectInputTrigger(enc.TIMER.TIMER, enc.TIMER.TRIGGER);
+	TIM_ICInit(enc.TIMER.TIMER, &ICStruct);
+#else
+	(void)ICStruct;
+#endif
 
 	// NVIC Init
 	NVICStruct.NVIC_IRQChannel						=	enc.INT.CHANNEL;
@@ -186,7 +190,7 @@ namespace HAL
 		else
 		{
 			// Create encoder instance
-			_enc[id] = new Encoder(id);
+			_enc[id] = new (_encStorage.Get(id)) Encoder(id);
 
 			return _enc[id];
 		}
@@ -194,44 +198,106 @@ namespace HAL
 
 	Encoder::Encoder (Encoder::ID id)
 	{
-		this->turnCounter	=	0;
-		this->prevAbsValue	=	0;
+		this->prevCounter	=	0;
 		this->absolutePos	=	0;
 		this->relativePos	=	0;
+		this->edgeSeq		=	0;
+		this->edgeCount		=	0;
+		this->edgeTime		=	0;
 
 		_hardwareInit(id);
 
 		this->def = _getENCStruct(id);
 	}
 
+	void Encoder::update()
+	{
+		this->accumulate(TIM_GetCounter(this->def.TIMER.TIMER));
+	}
+
+	void Encoder::accumulate(uint32_t counter)
+	{
+		// Two's complement difference handles counter wrap in both directions
+		this->relativePos	=	(int32_t)(counter - this->prevCounter);
+		this->prevCounter	=	counter;
+		this->absolutePos	+=	this->relativePos;
+	}
+
 	int64_t Encoder::GetAbsoluteValue()
 	{
-		this->prevAbsValue	= 	this->absolutePos;
-		this->absolutePos 	= 	(this->def.TIMER.RELOAD_VAL * this->turnCounter) + TIM_GetCounter(this->def.TIMER.TIMER);
-		this->relativePos 	= 	this->absolutePos - this->prevAbsValue;
+		this->update();
 
 		return this->absolutePos;
 	}
 
 	int32_t Encoder::GetRelativeValue()
 	{
-		this->prevAbsValue	= 	this->absolutePos;
-		this->absolutePos 	= 	(this->def.TIMER.RELOAD_VAL * this->turnCounter) + TIM_GetCounter(this->def.TIMER.TIMER);
-		this->relativePos 	= 	this->absolutePos - this->prevAbsValue;
+		this->update();
 
 		return this->relativePos;
 	}
 
-	void Encoder::INTERNAL_InterruptCallback(uint8_t flag)
+	void Encoder::GetRelativeValues(Encoder* a, Encoder* b, int32_t* da, int32_t* db)
 	{
-		if(flag == TIM_Direction_CounterDowncounting)
+		TIM_TypeDef * ta = a->def.TIMER.TIMER;
+		TIM_TypeDef * tb = b->def.TIMER.TIMER;
+		uint32_t ca, cb, check;
+
+#if ENC_SNAPSHOT
+		if((ta->SR & TIM_SR_CC3IF) != 0u)
 		{
-			this->turnCounter--;
+			// A snapshot between the reads changes a value, unless a did not
+			// move : then its value is the same at both instants
+			do
+			{
+				ca		=	ta->CCR3;
+				cb		=	tb->CCR3;
+				check	=	ta->CCR3;
+			}while(ca != check);
 		}
 		else
+#endif
 		{
-			this->turnCounter++;
+			ca = TIM_GetCounter(ta);
+			cb = TIM_GetCounter(tb);
 		}
+
+		a->accumulate(ca);
+		b->accumulate(cb);
+
+		*da = a->relativePos;
+		*db = b->relativePos;
+	}
+
+	uint32_t Encoder::GetLastEdge(uint32_t* count, uint32_t* timestamp)
+	{
+		uint32_t seq;
+
+		// Retry if an edge was captured meanwhile
+		do
+		{
+			seq = this->edgeSeq;
+			__DMB();
+
+			*count		=	this->edgeCount;
+			*timestamp	=	this->edgeTime;
+
+			__DMB();
+		}while(seq != this->edgeSeq);
+
+		return seq;
+	}
+
+	void Encoder::INTERNAL_CaptureCallback()
+	{
+		uint32_t timestamp = Utils::Profiler::GetCycles();
+
+		// Reading CCR1 clears the capture flag
+		this->edgeCount	=	TIM_GetCapture1(this->def.TIMER.TIMER);
+		this->edgeTime	=	timestamp;
+
+		__DMB();
+		this->edgeSeq++;
 	}
 }
 
@@ -241,41 +307,37 @@ namespace HAL
 extern "C"
 {
 	/**
-	 * @brief Encoder 0 interrupt handler
+	 * @brief Encoder 0 capture interrupt handler
 	 */
-	void TIM5_IRQHandler (void)
+	RAMFUNC void TIM5_IRQHandler (void)
 	{
-		uint16_t flag = 0u;
-
-		if(TIM_GetFlagStatus(TIM5, TIM_FLAG_Update) == SET)
+		if(TIM_GetITStatus(TIM5, TIM_IT_CC1) == SET)
 		{
-			flag = TIM_GetCounterDirection(TIM5);
-
-			TIM_ClearFlag(TIM5, TIM_FLAG_Update);
-
 			if(_enc[Encoder::ENCODER0] != NULL)
 			{
-				_enc[Encoder::ENCODER0]->INTERNAL_InterruptCallback(flag);
+				_enc[Encoder::ENCODER0]->INTERNAL_CaptureCallback();
+			}
+			else
+			{
+				TIM_ClearITPendingBit(TIM5, TIM_IT_CC1);
 			}
 		}
 	}
 
 	/**
-	 * @brief Encoder 1 interrupt handler
+	 * @brief Encoder 1 capture interrupt handler
 	 */
-	void TIM2_IRQHandler (void)
+	RAMFUNC void TIM2_IRQHandler (void)
 	{
-		uint16_t flag = 0u;
-
-		if(TIM_GetFlagStatus(TIM2, TIM_FLAG_Update) == SET)
+		if(TIM_GetITStatus(TIM2, TIM_IT_CC1) == SET)
 		{
-			flag = TIM_GetCounterDirection(TIM2);
-
-			TIM_ClearFlag(TIM2, TIM_FLAG_Update);
-
 			if(_enc[Encoder::ENCODER1] != NULL)
 			{
-				_enc[Encoder::ENCODER1]->INTERNAL_InterruptCallback(flag);
+				_enc[Encoder::ENCODER1]->INTERNAL_CaptureCallback();
+			}
+			else
+			{
+				TIM_ClearITPendingBit(TIM2, TIM_IT_CC1);
 			}
 		}
 	}
@@ -6,6 +6,7 @@
  */
 
 #include "ExtDAC.hpp"
+#include "StaticStorage.hpp"
 #include <stddef.h>
 
 /*----------------------------------------------------------------------------*/
@@ -14,15 +15,22 @@
 
 #define EXT_DAC_CMD_SET_MODE_WRM			(0x8000u)
 #define EXT_DAC_CMD_SET_MODE_WTM			(0x9000u)
+#define EXT_DAC_CMD_UPDATE_SELECT			(0xA000u)
 #define EXT_DAC_CMD_SET_OUTPUT_HIZ			(0xD000u)
 #define EXT_DAC_CMD_SET_OUTPUT_100K			(0xE000u)
 #define EXT_DAC_CMD_SET_OUTPUT_2K5			(0xF000u)
 
+#define EXT_DAC_FRAME_LENGTH				(2u)		// One 16-bit command by nCS frame
+
+#define EXT_DAC_WRITE(ch, output)			( ((uint16_t)(ch) << 12u) | ((uint16_t)(output) << 4u) )
+#define EXT_DAC_UPDATE(mask)				( EXT_DAC_CMD_UPDATE_SELECT | ((uint16_t)(mask) << 4u) )
+
 /*----------------------------------------------------------------------------*/
 /* Private Members                                                            */
 /*----------------------------------------------------------------------------*/
 
 static HAL::ExtDAC* _instance[HAL::ExtDAC::EXTDAC_MAX] = {NULL};
+static Utils::StaticStorage<HAL::ExtDAC, HAL::ExtDAC::EXTDAC_MAX> _instanceStorage;
 
 /*----------------------------------------------------------------------------*/
 /* Private Functions                                                          */
@@ -58,7 +66,7 @@ namespace HAL
 
 		if(_instance[id] == NULL)
 		{
-			_instance[id] = new ExtDAC(id);
+			_instance[id] = new (_instanceStorage.Get(id)) ExtDAC(id);
 		}
 		else
 		{
@@ -75,6 +83,16 @@ namespace HAL
 
 		this->bus = SPIMaster::GetInstance(this->def.BusID);
 
+		this->batch.txBuffer	=	this->batchBuffer;
+		this->batch.rxBuffer	=	NULL;
+		this->batch.length		=	0u;
+		this->batch.frameLength	=	EXT_DAC_FRAME_LENGTH;
+		this->batch.csPort		=	NULL;
+		this->batch.csPin		=	0u;
+		this->batch.callback	=	NULL;
+		this->batch.obj			=	NULL;
+		this->batch.status		=	NO_ERROR;
+
 		this->Init();
 	}
 
@@ -102,16 +120,16 @@ namespace HAL
 			rval = this->bus->Transfer(txBuffer, rxBuffer, length);
 		}
 
-		// 1. Prepare txBuffer - WTM Mode
+		// 1. Prepare txBuffer - WRM Mode (outputs updated by update select)
 		if(rval == NO_ERROR)
 		{
 			length = 0u;
-			txWord = (EXT_DAC_CMD_SET_MODE_WTM);
+			txWord = (EXT_DAC_CMD_SET_MODE_WRM);
 			txBuffer[length++] = (uint8_t)((txWord >> 8u) & 0x00FFu);
 			txBuffer[length++] = (uint8_t)((txWord) & 0x00FFu);
 		}
 
-		// 2. Send txBuffer - WTM Mode
+		// 2. Send txBuffer - WRM Mode
 		if(rval == NO_ERROR)
 		{
             rval = this->bus->Transfer(txBuffer, rxBuffer, length);
@@ -122,23 +140,68 @@ namespace HAL
 	{
 		int32_t rval = 0u;
 		uint16_t txWord = 0u;
-		uint8_t txBuffer[2];
-		uint8_t rxBuffer[2];
+		uint8_t txBuffer[4];
 		uint32_t length = 0u;
 
-		// 1. Prepare txBuffer
+		// 1. Prepare txBuffer - Write register then update channel
 		if(rval == NO_ERROR)
 		{
 			length = 0u;
-			txWord = ( ((uint16_t)ch << 12u) | ((uint16_t)output << 4u) );
+			txWord = EXT_DAC_WRITE(ch, output);
+			txBuffer[length++] = (uint8_t)((txWord >> 8u) & 0x00FFu);
+			txBuffer[length++] = (uint8_t)((txWord) & 0x00FFu);
+			txWord = EXT_DAC_UPDATE(1u << ch);
 			txBuffer[length++] = (uint8_t)((txWord >> 8u) & 0x00FFu);
 			txBuffer[length++] = (uint8_t)((txWord) & 0x00FFu);
 		}
 
-		// 2. Send txBuffer - WTM Mode
+		// 2. Send txBuffer - WRM Mode
 		if(rval == NO_ERROR)
 		{
-			rval = this->bus->Transfer(txBuffer, rxBuffer, length);
+			rval = this->bus->Transfer(txBuffer, NULL, length, EXT_DAC_FRAME_LENGTH);
+		}
+
+		return rval;
+	}
+
+	int32_t ExtDAC::SetOutputValues (uint8_t mask, const uint8_t * outputs, SPI_CALLBACK callback, void * obj)
+	{
+		int32_t rval = NO_ERROR;
+		uint16_t txWord = 0u;
+		uint32_t length = 0u;
+		uint32_t ch = 0u;
+
+		assert(outputs != NULL);
+
+		// 1. Previous batch frames are still in use
+		if(this->IsBusy())
+		{
+			rval = EXTDAC_ERROR_BUSY;
+		}
+
+		// 2. Prepare frames - Write registers then update all of them
+		if((rval == NO_ERROR) && (mask != 0u))
+		{
+			for(ch=0u; ch<ExtDAC_Channel_MAX; ch++)
+			{
+				if((mask & (1u << ch)) != 0u)
+				{
+					txWord = EXT_DAC_WRITE(ch, outputs[ch]);
+					this->batchBuffer[length++] = (uint8_t)((txWord >> 8u) & 0x00FFu);
+					this->batchBuffer[length++] = (uint8_t)((txWord) & 0x00FFu);
+				}
+			}
+
+			txWord = EXT_DAC_UPDATE(mask);
+			this->batchBuffer[length++] = (uint8_t)((txWord >> 8u) & 0x00FFu);
+			this->batchBuffer[length++] = (uint8_t)((txWord) & 0x00FFu);
+
+			this->batch.length		=	length;
+			this->batch.callback	=	callback;
+			this->batch.obj			=	obj;
+
+			// 3. Queue transaction
+			rval = this->bus->TransferAsync(&this->batch);
 		}
 
 		return rval;
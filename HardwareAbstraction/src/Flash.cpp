@@ -0,0 +1,152 @@
+/**
+ * @file	Flash.cpp
+ * @author	Kevin WYSOCKI
+ * @date	22 oct. 2017
+ * @brief	Internal flash sectors driver
+ */
+
+#include <stddef.h>
+#include "Flash.hpp"
+#include "StaticStorage.hpp"
+#include "Watchdog.hpp"
+
+using namespace HAL;
+
+/*----------------------------------------------------------------------------*/
+/* Definitions                                                                */
+/*----------------------------------------------------------------------------*/
+
+// CONFIG0
+#define FLASH0_SECTOR			(FLASH_Sector_6)
+#define FLASH0_ADDRESS			(0x08040000u)
+#define FLASH0_SIZE				(128u * 1024u)
+
+// CONFIG1
+#define FLASH1_SECTOR			(FLASH_Sector_7)
+#define FLASH1_ADDRESS			(0x08060000u)
+#define FLASH1_SIZE				(128u * 1024u)
+
+#define FLASH_VOLTAGE_RANGE		(VoltageRange_3)	// 2.7 V to 3.6 V, word parallelism
+#define FLASH_ERASE_HOLD_MS		(4000u)			// 128K sector erase : 2 s maximum
+#define FLASH_ERROR_FLAGS		(FLASH_FLAG_OPERR | FLASH_FLAG_WRPERR | FLASH_FLAG_PGAERR | FLASH_FLAG_PGPERR | FLASH_FLAG_PGSERR)
+
+/*----------------------------------------------------------------------------*/
+/* Private Members                                                            */
+/*----------------------------------------------------------------------------*/
+
+/**
+ * @brief Flash instances
+ */
+static Flash* _flash[Flash::FLASH_MAX] = {NULL};
+
+/**
+ * @brief Flash instances storage
+ */
+static Utils::StaticStorage<Flash, Flash::FLASH_MAX> _flashStorage;
+
+/*----------------------------------------------------------------------------*/
+/* Private Functions                                                          */
+/*----------------------------------------------------------------------------*/
+
+/**
+ * @brief Retrieve flash definitions from ID
+ * @param id : Flash sector ID
+ * @return FLASH_DEF structure
+ */
+static FLASH_DEF _getFlashStruct (enum Flash::ID id)
+{
+	FLASH_DEF flash;
+
+	assert(id < Flash::FLASH_MAX);
+
+	switch(id)
+	{
+	case Flash::CONFIG0:
+		flash.SECTOR	=	FLASH0_SECTOR;
+		flash.ADDRESS	=	FLASH0_ADDRESS;
+		flash.SIZE		=	FLASH0_SIZE;
+		break;
+
+	case Flash::CONFIG1:
+		flash.SECTOR	=	FLASH1_SECTOR;
+		flash.ADDRESS	=	FLASH1_ADDRESS;
+		flash.SIZE		=	FLASH1_SIZE;
+		break;
+
+	default:
+		break;
+	}
+
+	return flash;
+}
+
+/*----------------------------------------------------------------------------*/
+/* Class Implementation	                                                      */
+/*----------------------------------------------------------------------------*/
+namespace HAL
+{
+	Flash* Flash::GetInstance (enum Flash::ID id)
+	{
+		assert(id < Flash::FLASH_MAX);
+
+		// if instance already exists
+		if(_flash[id] != NULL)
+		{
+			return _flash[id];
+		}
+		else
+		{
+			// Create instance
+			_flash[id] = new (_flashStorage.Get(id)) Flash(id);
+
+			return _flash[id];
+		}
+	}
+
+	Flash::Flash (enum Flash::ID id)
+	{
+		this->id = id;
+		this->def = _getFlashStruct(id);
+	}
+
+	bool Flash::Erase ()
+	{
+		FLASH_Status status;
+
+		// CPU stalls on flash fetches during the erase (seconds for a 128K sector)
+		Utils::Watchdog::Hold(FLASH_ERASE_HOLD_MS);
+
+		FLASH_Unlock();
+		FLASH_ClearFlag(FLASH_FLAG_EOP | FLASH_ERROR_FLAGS);
+
+		status = FLASH_EraseSector(this->def.SECTOR, FLASH_VOLTAGE_RANGE);
+
+		FLASH_Lock();
+
+		Utils::Watchdog::Release();
+
+		return (status == FLASH_COMPLETE);
+	}
+
+	bool Flash::Program (uint32_t offset, const uint32_t* words, uint32_t count)
+	{
+		volatile const uint32_t* dst = reinterpret_cast<volatile const uint32_t*>(this->def.ADDRESS + offset);
+		bool success = true;
+
+		assert((offset % sizeof(uint32_t)) == 0u);
+		assert((offset + count * sizeof(uint32_t)) <= this->def.SIZE);
+
+		FLASH_Unlock();
+		FLASH_ClearFlag(FLASH_FLAG_EOP | FLASH_ERROR_FLAGS);
+
+		for(uint32_t i = 0u; (i < count) && success; i++)
+		{
+			success = (FLASH_ProgramWord(this->def.ADDRESS + offset + i * sizeof(uint32_t), words[i]) == FLASH_COMPLETE) &&
+					  (dst[i] == words[i]);
+		}
+
+		FLASH_Lock();
+
+		return success;
+	}
+}
@@ -7,6 +7,8 @@
 
 #include <stdio.h>
 #include "GPIO.hpp"
+#include "StaticStorage.hpp"
+#include "Profiler.hpp"
 #include "common.h"
 
 using namespace HAL;
@@ -86,6 +88,12 @@ using namespace HAL;
 #define GPIO9_PORT				(GPIOG)
 #define GPIO9_PIN				(GPIO_Pin_0)
 #define GPIO9_MODE				(GPIO_Mode_IN)
+#define GPIO9_INT_PORTSOURCE	(EXTI_PortSourceGPIOG)
+#define GPIO9_INT_PINSOURCE	(EXTI_PinSource0)
+#define GPIO9_INT_LINE			(EXTI_Line0)
+#define GPIO9_INT_TRIGGER		(EXTI_Trigger_Falling)	// nFAULT active low
+#define GPIO9_INT_PRIORITY		(11u)	// Below configMAX_SYSCALL (Stalled raised from driver)
+#define GPIO9_INT_CHANNEL		(EXTI0_IRQn)
 
 // MOT1_APH
 #define GPIO10_PORT				(GPIOG)
@@ -101,6 +109,7 @@ using namespace HAL;
 #define GPIO12_PORT				(GPIOE)
 #define GPIO12_PIN				(GPIO_Pin_10)
 #define GPIO12_MODE				(GPIO_Mode_IN)
+// No interrupt : EXTI line 10 is used by MOT4_FAULT (PC10), fault is polled
 
 // MOT2_APH
 #define GPIO13_PORT				(GPIOB)
@@ -116,6 +125,12 @@ using namespace HAL;
 #define GPIO15_PORT				(GPIOG)
 #define GPIO15_PIN				(GPIO_Pin_7)
 #define GPIO15_MODE				(GPIO_Mode_IN)
+#define GPIO15_INT_PORTSOURCE	(EXTI_PortSourceGPIOG)
+#define GPIO15_INT_PINSOURCE	(EXTI_PinSource7)
+#define GPIO15_INT_LINE			(EXTI_Line7)
+#define GPIO15_INT_TRIGGER		(EXTI_Trigger_Falling)	// nFAULT active low
+#define GPIO15_INT_PRIORITY		(11u)	// Below configMAX_SYSCALL (Stalled raised from driver)
+#define GPIO15_INT_CHANNEL		(EXTI9_5_IRQn)
 
 // MOT3_APH
 #define GPIO16_PORT				(GPIOG)
@@ -131,6 +146,12 @@ using namespace HAL;
 #define GPIO18_PORT				(GPIOC)
 #define GPIO18_PIN				(GPIO_Pin_10)
 #define GPIO18_MODE				(GPIO_Mode_IN)
+#define GPIO18_INT_PORTSOURCE	(EXTI_PortSourceGPIOC)
+#define GPIO18_INT_PINSOURCE	(EXTI_PinSource10)
+#define GPIO18_INT_LINE			(EXTI_Line10)
+#define GPIO18_INT_TRIGGER		(EXTI_Trigger_Falling)	// nFAULT active low
+#define GPIO18_INT_PRIORITY		(11u)	// Below configMAX_SYSCALL (Stalled raised from driver)
+#define GPIO18_INT_CHANNEL		(EXTI15_10_IRQn)
 
 // MOT4_APH
 #define GPIO19_PORT				(GPIOA)
@@ -146,6 +167,12 @@ using namespace HAL;
 #define GPIO21_PORT				(GPIOG)
 #define GPIO21_PIN				(GPIO_Pin_2)
 #define GPIO21_MODE				(GPIO_Mode_IN)
+#define GPIO21_INT_PORTSOURCE	(EXTI_PortSourceGPIOG)
+#define GPIO21_INT_PINSOURCE	(EXTI_PinSource2)
+#define GPIO21_INT_LINE			(EXTI_Line2)
+#define GPIO21_INT_TRIGGER		(EXTI_Trigger_Falling)	// nFAULT active low
+#define GPIO21_INT_PRIORITY		(11u)	// Below configMAX_SYSCALL (Stalled raised from driver)
+#define GPIO21_INT_CHANNEL		(EXTI2_IRQn)
 
 // MOT5_APH
 #define GPIO22_PORT				(GPIOD)
@@ -322,20 +349,38 @@ using namespace HAL;
 #define GPIO56_PIN				(GPIO_Pin_2)
 #define GPIO56_MODE				(GPIO_Mode_OUT)
 
-//INPUT1
+//INPUT1 (emergency stop, active low)
 #define GPIO57_PORT				(GPIOA)
 #define GPIO57_PIN				(GPIO_Pin_4)
 #define GPIO57_MODE				(GPIO_Mode_IN)
+#define GPIO57_INT_PORTSOURCE	(EXTI_PortSourceGPIOA)
+#define GPIO57_INT_PINSOURCE	(EXTI_PinSource4)
+#define GPIO57_INT_LINE			(EXTI_Line4)
+#define GPIO57_INT_TRIGGER		(EXTI_Trigger_Falling)
+#define GPIO57_INT_PRIORITY		(1u)	// Above configMAX_SYSCALL : emergency stop only, no FreeRTOS API
+#define GPIO57_INT_CHANNEL		(EXTI4_IRQn)
 
 //INPUT2
 #define GPIO58_PORT				(GPIOA)
 #define GPIO58_PIN				(GPIO_Pin_5)
 #define GPIO58_MODE				(GPIO_Mode_IN)
-
-//INPUT3
+#define GPIO58_INT_PORTSOURCE	(EXTI_PortSourceGPIOA)
+#define GPIO58_INT_PINSOURCE	(EXTI_PinSource5)
+#define GPIO58_INT_LINE			(EXTI_Line5)
+#define GPIO58_INT_TRIGGER		(EXTI_Trigger_Rising_Falling)
+#define GPIO58_INT_PRIORITY		(11u)	// Below configMAX_SYSCALL (StateChanged may notify a task)
+#define GPIO58_INT_CHANNEL		(EXTI9_5_IRQn)
+
+//INPUT3 (rear left bumper, active low)
 #define GPIO59_PORT				(GPIOA)
 #define GPIO59_PIN				(GPIO_Pin_6)
 #define GPIO59_MODE				(GPIO_Mode_IN)
+#define GPIO59_INT_PORTSOURCE	(EXTI_PortSourceGPIOA)
+#define GPIO59_INT_PINSOURCE	(EXTI_PinSource6)
+#define GPIO59_INT_LINE			(EXTI_Line6)
+#define GPIO59_INT_TRIGGER		(EXTI_Trigger_Rising_Falling)
+#define GPIO59_INT_PRIORITY		(11u)	// Below configMAX_SYSCALL (StateChanged may notify a task)
+#define GPIO59_INT_CHANNEL		(EXTI9_5_IRQn)
 
 //INPUT4
 #define GPIO60_PORT				(GPIOA)
@@ -357,10 +402,16 @@ using namespace HAL;
 #define GPIO63_PIN				(GPIO_Pin_0)
 #define GPIO63_MODE				(GPIO_Mode_IN)
 
-//INPUT8
+//INPUT8 (rear right bumper, active low)
 #define GPIO64_PORT				(GPIOB)
 #define GPIO64_PIN				(GPIO_Pin_1)
 #define GPIO64_MODE				(GPIO_Mode_IN)
+#define GPIO64_INT_PORTSOURCE	(EXTI_PortSourceGPIOB)
+#define GPIO64_INT_PINSOURCE	(EXTI_PinSource1)
+#define GPIO64_INT_LINE			(EXTI_Line1)
+#define GPIO64_INT_TRIGGER		(EXTI_Trigger_Rising_Falling)
+#define GPIO64_INT_PRIORITY		(11u)	// Below configMAX_SYSCALL (StateChanged may notify a task)
+#define GPIO64_INT_CHANNEL		(EXTI1_IRQn)
 
 //INPUT9
 #define GPIO65_PORT				(GPIOC)
@@ -401,6 +452,12 @@ using namespace HAL;
 #define GPIO72_PORT				(GPIOF)
 #define GPIO72_PIN				(GPIO_Pin_11)
 #define GPIO72_MODE				(GPIO_Mode_IN)
+#define GPIO72_INT_PORTSOURCE	(EXTI_PortSourceGPIOF)
+#define GPIO72_INT_PINSOURCE	(EXTI_PinSource11)
+#define GPIO72_INT_LINE			(EXTI_Line11)
+#define GPIO72_INT_TRIGGER		(EXTI_Trigger_Rising_Falling)
+#define GPIO72_INT_PRIORITY		(11u)	// Below configMAX_SYSCALL (StateChanged may notify a task)
+#define GPIO72_INT_CHANNEL		(EXTI15_10_IRQn)
 
 /*----------------------------------------------------------------------------*/
 /* Private Members                                                            */
@@ -411,10 +468,95 @@ using namespace HAL;
  */
 GPIO* _gpio[GPIO::GPIO_MAX] = {NULL};
 
+/**
+ * @brief GPIO instances storage
+ */
+static Utils::StaticStorage<GPIO, GPIO::GPIO_MAX> _gpioStorage;
+
 /*----------------------------------------------------------------------------*/
 /* Private Functions                                                          */
 /*----------------------------------------------------------------------------*/
 
+/**
+ * @brief GPIO definitions (flash), indexed by GPIO ID
+ */
+static const GPIO_DEF _gpioDefs[HAL::GPIO::GPIO_MAX] =
+{
+	{{GPIO0_PORT, GPIO0_PIN, GPIO0_MODE}, {}},																																	// GPIO0
+	{{GPIO1_PORT, GPIO1_PIN, GPIO1_MODE}, {}},																																	// GPIO1
+	{{GPIO2_PORT, GPIO2_PIN, GPIO2_MODE}, {}},																																	// GPIO2
+	{{GPIO3_PORT, GPIO3_PIN, GPIO3_MODE}, {}},																																	// GPIO3
+	{{GPIO4_PORT, GPIO4_PIN, GPIO4_MODE}, {}},																																	// GPIO4
+	{{GPIO5_PORT, GPIO5_PIN, GPIO5_MODE}, {}},																																	// GPIO5
+	{{GPIO6_PORT, GPIO6_PIN, GPIO6_MODE}, {}},																																	// GPIO6
+	{{GPIO7_PORT, GPIO7_PIN, GPIO7_MODE}, {}},																																	// GPIO7
+	{{GPIO8_PORT, GPIO8_PIN, GPIO8_MODE}, {}},																																	// GPIO8
+	{{GPIO9_PORT, GPIO9_PIN, GPIO9_MODE}, {GPIO9_INT_PORTSOURCE, GPIO9_INT_PINSOURCE, GPIO9_INT_LINE, GPIO9_INT_TRIGGER, GPIO9_INT_PRIORITY, GPIO9_INT_CHANNEL}},				// GPIO9
+	{{GPIO10_PORT, GPIO10_PIN, GPIO10_MODE}, {}},																																// GPIO10
+	{{GPIO11_PORT, GPIO11_PIN, GPIO11_MODE}, {}},																																// GPIO11
+	{{GPIO12_PORT, GPIO12_PIN, GPIO12_MODE}, {}},																																// GPIO12
+	{{GPIO13_PORT, GPIO13_PIN, GPIO13_MODE}, {}},																																// GPIO13
+	{{GPIO14_PORT, GPIO14_PIN, GPIO14_MODE}, {}},																																// GPIO14
+	{{GPIO15_PORT, GPIO15_PIN, GPIO15_MODE}, {GPIO15_INT_PORTSOURCE, GPIO15_INT_PINSOURCE, GPIO15_INT_LINE, GPIO15_INT_TRIGGER, GPIO15_INT_PRIORITY, GPIO15_INT_CHANNEL}},		// GPIO15
+	{{GPIO16_PORT, GPIO16_PIN, GPIO16_MODE}, {}},																																// GPIO16
+	{{GPIO17_PORT, GPIO17_PIN, GPIO17_MODE}, {}},																																// GPIO17
+	{{GPIO18_PORT, GPIO18_PIN, GPIO18_MODE}, {GPIO18_INT_PORTSOURCE, GPIO18_INT_PINSOURCE, GPIO18_INT_LINE, GPIO18_INT_TRIGGER, GPIO18_INT_PRIORITY, GPIO18_INT_CHANNEL}},		// GPIO18
+	{{GPIO19_PORT, GPIO19_PIN, GPIO19_MODE}, {}},																																// GPIO19
+	{{GPIO20_PORT, GPIO20_PIN, GPIO20_MODE}, {}},																																// GPIO20
+	{{GPIO21_PORT, GPIO21_PIN, GPIO21_MODE}, {GPIO21_INT_PORTSOURCE, GPIO21_INT_PINSOURCE, GPIO21_INT_LINE, GPIO21_INT_TRIGGER, GPIO21_INT_PRIORITY, GPIO21_INT_CHANNEL}},		// GPIO21
+	{{GPIO22_PORT, GPIO22_PIN, GPIO22_MODE}, {}},																																// GPIO22
+	{{GPIO23_PORT, GPIO23_PIN, GPIO23_MODE}, {}},																																// GPIO23
+	{{GPIO24_PORT, GPIO24_PIN, GPIO24_MODE}, {}},																																// GPIO24
+	{{GPIO25_PORT, GPIO25_PIN, GPIO25_MODE}, {}},																																// GPIO25
+	{{GPIO26_PORT, GPIO26_PIN, GPIO26_MODE}, {}},																																// GPIO26
+	{{GPIO27_PORT, GPIO27_PIN, GPIO27_MODE}, {}},																																// GPIO27
+	{{GPIO28_PORT, GPIO28_PIN, GPIO28_MODE}, {}},																																// GPIO28
+	{{GPIO29_PORT, GPIO29_PIN, GPIO29_MODE}, {}},																																// GPIO29
+	{{GPIO30_PORT, GPIO30_PIN, GPIO30_MODE}, {}},																																// GPIO30
+	{{GPIO31_PORT, GPIO31_PIN, GPIO31_MODE}, {}},																																// GPIO31
+	{{GPIO32_PORT, GPIO32_PIN, GPIO32_MODE}, {}},																																// GPIO32
+	{{GPIO33_PORT, GPIO33_PIN, GPIO33_MODE}, {}},																																// GPIO33
+	{{GPIO34_PORT, GPIO34_PIN, GPIO34_MODE}, {}},																																// GPIO34
+	{{GPIO35_PORT, GPIO35_PIN, GPIO35_MODE}, {}},																																// GPIO35
+	{{GPIO36_PORT, GPIO36_PIN, GPIO36_MODE}, {}},																																// GPIO36
+	{{GPIO37_PORT, GPIO37_PIN, GPIO37_MODE}, {}},																																// GPIO37
+	{{GPIO38_PORT, GPIO38_PIN, GPIO38_MODE}, {}},																																// GPIO38
+	{{GPIO39_PORT, GPIO39_PIN, GPIO39_MODE}, {}},																																// GPIO39
+	{{GPIO40_PORT, GPIO40_PIN, GPIO40_MODE}, {}},																																// GPIO40
+	{{GPIO41_PORT, GPIO41_PIN, GPIO41_MODE}, {}},																																// GPIO41
+	{{GPIO42_PORT, GPIO42_PIN, GPIO42_MODE}, {}},																																// GPIO42
+	{{GPIO43_PORT, GPIO43_PIN, GPIO43_MODE}, {}},																																// GPIO43
+	{{GPIO44_PORT, GPIO44_PIN, GPIO44_MODE}, {}},																																// GPIO44
+	{{GPIO45_PORT, GPIO45_PIN, GPIO45_MODE}, {}},																																// GPIO45
+	{{GPIO46_PORT, GPIO46_PIN, GPIO46_MODE}, {}},																																// GPIO46
+	{{GPIO47_PORT, GPIO47_PIN, GPIO47_MODE}, {}},																																// GPIO47
+	{{GPIO48_PORT, GPIO48_PIN, GPIO48_MODE}, {}},																																// GPIO48
+	{{GPIO49_PORT, GPIO49_PIN, GPIO49_MODE}, {}},																																// GPIO49
+	{{GPIO50_PORT, GPIO50_PIN, GPIO50_MODE}, {}},																																// GPIO50
+	{{GPIO51_PORT, GPIO51_PIN, GPIO51_MODE}, {}},																																// GPIO51
+	{{GPIO52_PORT, GPIO52_PIN, GPIO52_MODE}, {}},																																// GPIO52
+	{{GPIO53_PORT, GPIO53_PIN, GPIO53_MODE}, {}},																																// GPIO53
+	{{GPIO54_PORT, GPIO54_PIN, GPIO54_MODE}, {}},																																// GPIO54
+	{{GPIO55_PORT, GPIO55_PIN, GPIO55_MODE}, {}},																																// GPIO55
+	{{GPIO56_PORT, GPIO56_PIN, GPIO56_MODE}, {}},																																// GPIO56
+	{{GPIO57_PORT, GPIO57_PIN, GPIO57_MODE}, {GPIO57_INT_PORTSOURCE, GPIO57_INT_PINSOURCE, GPIO57_INT_LINE, GPIO57_INT_TRIGGER, GPIO57_INT_PRIORITY, GPIO57_INT_CHANNEL}},		// GPIO57
+	{{GPIO58_PORT, GPIO58_PIN, GPIO58_MODE}, {GPIO58_INT_PORTSOURCE, GPIO58_INT_PINSOURCE, GPIO58_INT_LINE, GPIO58_INT_TRIGGER, GPIO58_INT_PRIORITY, GPIO58_INT_CHANNEL}},		// GPIO58
+	{{GPIO59_PORT, GPIO59_PIN, GPIO59_MODE}, {GPIO59_INT_PORTSOURCE, GPIO59_INT_PINSOURCE, GPIO59_INT_LINE, GPIO59_INT_TRIGGER, GPIO59_INT_PRIORITY, GPIO59_INT_CHANNEL}},		// GPIO59
+	{{GPIO60_PORT, GPIO60_PIN, GPIO60_MODE}, {}},																																// GPIO60
+	{{GPIO61_PORT, GPIO61_PIN, GPIO61_MODE}, {}},																																// GPIO61
+	{{GPIO62_PORT, GPIO62_PIN, GPIO62_MODE}, {}},																																// GPIO62
+	{{GPIO63_PORT, GPIO63_PIN, GPIO63_MODE}, {}},																																// GPIO63
+	{{GPIO64_PORT, GPIO64_PIN, GPIO64_MODE}, {GPIO64_INT_PORTSOURCE, GPIO64_INT_PINSOURCE, GPIO64_INT_LINE, GPIO64_INT_TRIGGER, GPIO64_INT_PRIORITY, GPIO64_INT_CHANNEL}},		// GPIO64
+	{{GPIO65_PORT, GPIO65_PIN, GPIO65_MODE}, {}},																																// GPIO65
+	{{GPIO66_PORT, GPIO66_PIN, GPIO66_MODE}, {}},																																// GPIO66
+	{{GPIO67_PORT, GPIO67_PIN, GPIO67_MODE}, {}},																																// GPIO67
+	{{GPIO68_PORT, GPIO68_PIN, GPIO68_MODE}, {}},																																// GPIO68
+	{{GPIO69_PORT, GPIO69_PIN, GPIO69_MODE}, {}},																																// GPIO69
+	{{GPIO70_PORT, GPIO70_PIN, GPIO70_MODE}, {}},																																// GPIO70
+	{{GPIO71_PORT, GPIO71_PIN, GPIO71_MODE}, {}},																																// GPIO71
+	{{GPIO72_PORT, GPIO72_PIN, GPIO72_MODE}, {GPIO72_INT_PORTSOURCE, GPIO72_INT_PINSOURCE, GPIO72_INT_LINE, GPIO72_INT_TRIGGER, GPIO72_INT_PRIORITY, GPIO72_INT_CHANNEL}},		// GPIO72
+};
+
 /**
  * @brief Retrieve GPIO definitions from GPIO ID
  * @param id : GPIO ID
@@ -422,382 +564,9 @@ GPIO* _gpio[GPIO::GPIO_MAX] = {NULL};
  */
 static GPIO_DEF _getGPIOStruct (enum GPIO::ID id)
 {
-	GPIO_DEF gpio;
-
 	assert(id < HAL::GPIO::GPIO_MAX);
 
-	switch(id)
-	{
-	case HAL::GPIO::GPIO0:
-		gpio.IO.PORT	=	GPIO0_PORT;
-		gpio.IO.PIN		=	GPIO0_PIN;
-		gpio.IO.MODE	=	GPIO0_MODE;
-		break;
-	case HAL::GPIO::GPIO1:
-		gpio.IO.PORT	=	GPIO1_PORT;
-		gpio.IO.PIN		=	GPIO1_PIN;
-		gpio.IO.MODE	=	GPIO1_MODE;
-		break;
-	case HAL::GPIO::GPIO2:
-		gpio.IO.PORT	=	GPIO2_PORT;
-		gpio.IO.PIN		=	GPIO2_PIN;
-		gpio.IO.MODE	=	GPIO2_MODE;
-		break;
-	case HAL::GPIO::GPIO3:
-		gpio.IO.PORT	=	GPIO3_PORT;
-		gpio.IO.PIN		=	GPIO3_PIN;
-		gpio.IO.MODE	=	GPIO3_MODE;
-		break;
-	case HAL::GPIO::GPIO4:
-		gpio.IO.PORT	=	GPIO4_PORT;
-		gpio.IO.PIN		=	GPIO4_PIN;
-		gpio.IO.MODE	=	GPIO4_MODE;
-		break;
-	case HAL::GPIO::GPIO5:
-		gpio.IO.PORT	=	GPIO5_PORT;
-		gpio.IO.PIN		=	GPIO5_PIN;
-		gpio.IO.MODE	=	GPIO5_MODE;
-		break;
-	case HAL::GPIO::GPIO6:
-		gpio.IO.PORT	=	GPIO6_PORT;
-		gpio.IO.PIN		=	GPIO6_PIN;
-		gpio.IO.MODE	=	GPIO6_MODE;
-		break;
-	case HAL::GPIO::GPIO7:
-		gpio.IO.PORT	=	GPIO7_PORT;
-		gpio.IO.PIN		=	GPIO7_PIN;
-		gpio.IO.MODE	=	GPIO7_MODE;
-		break;
-	case HAL::GPIO::GPIO8:
-		gpio.IO.PORT	=	GPIO8_PORT;
-		gpio.IO.PIN		=	GPIO8_PIN;
-		gpio.IO.MODE	=	GPIO8_MODE;
-		break;
-	case HAL::GPIO::GPIO9:
-		gpio.IO.PORT	=	GPIO9_PORT;
-		gpio.IO.PIN		=	GPIO9_PIN;
-		gpio.IO.MODE	=	GPIO9_MODE;
-		break;
-	case HAL::GPIO::GPIO10:
-		gpio.IO.PORT	=	GPIO10_PORT;
-		gpio.IO.PIN		=	GPIO10_PIN;
-		gpio.IO.MODE	=	GPIO10_MODE;
-		break;
-	case HAL::GPIO::GPIO11:
-		gpio.IO.PORT	=	GPIO11_PORT;
-		gpio.IO.PIN		=	GPIO11_PIN;
-		gpio.IO.MODE	=	GPIO11_MODE;
-		break;
-	case HAL::GPIO::GPIO12:
-		gpio.IO.PORT	=	GPIO12_PORT;
-		gpio.IO.PIN		=	GPIO12_PIN;
-		gpio.IO.MODE	=	GPIO12_MODE;
-		break;
-	case HAL::GPIO::GPIO13:
-		gpio.IO.PORT	=	GPIO13_PORT;
-		gpio.IO.PIN		=	GPIO13_PIN;
-		gpio.IO.MODE	=	GPIO13_MODE;
-		break;
-	case HAL::GPIO::GPIO14:
-		gpio.IO.PORT	=	GPIO14_PORT;
-		gpio.IO.PIN		=	GPIO14_PIN;
-		gpio.IO.MODE	=	GPIO14_MODE;
-		break;
-	case HAL::GPIO::GPIO15:
-		gpio.IO.PORT	=	GPIO15_PORT;
-		gpio.IO.PIN		=	GPIO15_PIN;
-		gpio.IO.MODE	=	GPIO15_MODE;
-		break;
-	case HAL::GPIO::GPIO16:
-		gpio.IO.PORT	=	GPIO16_PORT;
-		gpio.IO.PIN		=	GPIO16_PIN;
-		gpio.IO.MODE	=	GPIO16_MODE;
-		break;
-	case HAL::GPIO::GPIO17:
-		gpio.IO.PORT	=	GPIO17_PORT;
-		gpio.IO.PIN		=	GPIO17_PIN;
-		gpio.IO.MODE	=	GPIO17_MODE;
-		break;
-	case HAL::GPIO::GPIO18:
-		gpio.IO.PORT	=	GPIO18_PORT;
-		gpio.IO.PIN		=	GPIO18_PIN;
-		gpio.IO.MODE	=	GPIO18_MODE;
-		break;
-	case HAL::GPIO::GPIO19:
-		gpio.IO.PORT	=	GPIO19_PORT;
-		gpio.IO.PIN		=	GPIO19_PIN;
-		gpio.IO.MODE	=	GPIO19_MODE;
-		break;
-	case HAL::GPIO::GPIO20:
-		gpio.IO.PORT	=	GPIO20_PORT;
-		gpio.IO.PIN		=	GPIO20_PIN;
-		gpio.IO.MODE	=	GPIO20_MODE;
-		break;
-	case HAL::GPIO::GPIO21:
-		gpio.IO.PORT	=	GPIO21_PORT;
-		gpio.IO.PIN		=	GPIO21_PIN;
-		gpio.IO.MODE	=	GPIO21_MODE;
-		break;
-	case HAL::GPIO::GPIO22:
-		gpio.IO.PORT	=	GPIO22_PORT;
-		gpio.IO.PIN		=	GPIO22_PIN;
-		gpio.IO.MODE	=	GPIO22_MODE;
-		break;
-	case HAL::GPIO::GPIO23:
-		gpio.IO.PORT	=	GPIO23_PORT;
-		gpio.IO.PIN		=	GPIO23_PIN;
-		gpio.IO.MODE	=	GPIO23_MODE;
-		break;
-	case HAL::GPIO::GPIO24:
-		gpio.IO.PORT	=	GPIO24_PORT;
-		gpio.IO.PIN		=	GPIO24_PIN;
-		gpio.IO.MODE	=	GPIO24_MODE;
-		break;
-	case HAL::GPIO::GPIO25:
-		gpio.IO.PORT	=	GPIO25_PORT;
-		gpio.IO.PIN		=	GPIO25_PIN;
-		gpio.IO.MODE	=	GPIO25_MODE;
-		break;
-	case HAL::GPIO::GPIO26:
-		gpio.IO.PORT	=	GPIO26_PORT;
-		gpio.IO.PIN		=	GPIO26_PIN;
-		gpio.IO.MODE	=	GPIO26_MODE;
-		break;
-	case HAL::GPIO::GPIO27:
-		gpio.IO.PORT	=	GPIO27_PORT;
-		gpio.IO.PIN		=	GPIO27_PIN;
-		gpio.IO.MODE	=	GPIO27_MODE;
-		break;
-	case HAL::GPIO::GPIO28:
-		gpio.IO.PORT	=	GPIO28_PORT;
-		gpio.IO.PIN		=	GPIO28_PIN;
-		gpio.IO.MODE	=	GPIO28_MODE;
-		break;
-	case HAL::GPIO::GPIO29:
-		gpio.IO.PORT	=	GPIO29_PORT;
-		gpio.IO.PIN		=	GPIO29_PIN;
-		gpio.IO.MODE	=	GPIO29_MODE;
-		break;
-	case HAL::GPIO::GPIO30:
-		gpio.IO.PORT	=	GPIO30_PORT;
-		gpio.IO.PIN		=	GPIO30_PIN;
-		gpio.IO.MODE	=	GPIO30_MODE;
-		break;
-	case HAL::GPIO::GPIO31:
-		gpio.IO.PORT	=	GPIO31_PORT;
-		gpio.IO.PIN		=	GPIO31_PIN;
-		gpio.IO.MODE	=	GPIO31_MODE;
-		break;
-	case HAL::GPIO::GPIO32:
-		gpio.IO.PORT	=	GPIO32_PORT;
-		gpio.IO.PIN		=	GPIO32_PIN;
-		gpio.IO.MODE	=	GPIO32_MODE;
-		break;
-	case HAL::GPIO::GPIO33:
-		gpio.IO.PORT	=	GPIO33_PORT;
-		gpio.IO.PIN		=	GPIO33_PIN;
-		gpio.IO.MODE	=	GPIO33_MODE;
-		break;
-	case HAL::GPIO::GPIO34:
-		gpio.IO.PORT	=	GPIO34_PORT;
-		gpio.IO.PIN		=	GPIO34_PIN;
-		gpio.IO.MODE	=	GPIO34_MODE;
-		break;
-	case HAL::GPIO::GPIO35:
-		gpio.IO.PORT	=	GPIO35_PORT;
-		gpio.IO.PIN		=	GPIO35_PIN;
-		gpio.IO.MODE	=	GPIO35_MODE;
-		break;
-	case HAL::GPIO::GPIO36:
-		gpio.IO.PORT	=	GPIO36_PORT;
-		gpio.IO.PIN		=	GPIO36_PIN;
-		gpio.IO.MODE	=	GPIO36_MODE;
-		break;
-	case HAL::GPIO::GPIO37:
-		gpio.IO.PORT	=	GPIO37_PORT;
-		gpio.IO.PIN		=	GPIO37_PIN;
-		gpio.IO.MODE	=	GPIO37_MODE;
-		break;
-	case HAL::GPIO::GPIO38:
-		gpio.IO.PORT	=	GPIO38_PORT;
-		gpio.IO.PIN		=	GPIO38_PIN;
-		gpio.IO.MODE	=	GPIO38_MODE;
-		break;
-	case HAL::GPIO::GPIO39:
-		gpio.IO.PORT	=	GPIO39_PORT;
-		gpio.IO.PIN		=	GPIO39_PIN;
-		gpio.IO.MODE	=	GPIO39_MODE;
-		break;
-	case HAL::GPIO::GPIO40:
-		gpio.IO.PORT	=	GPIO40_PORT;
-		gpio.IO.PIN		=	GPIO40_PIN;
-		gpio.IO.MODE	=	GPIO40_MODE;
-		break;
-	case HAL::GPIO::GPIO41:
-		gpio.IO.PORT	=	GPIO41_PORT;
-		gpio.IO.PIN		=	GPIO41_PIN;
-		gpio.IO.MODE	=	GPIO41_MODE;
-		break;
-	case HAL::GPIO::GPIO42:
-		gpio.IO.PORT	=	GPIO42_PORT;
-		gpio.IO.PIN		=	GPIO42_PIN;
-		gpio.IO.MODE	=	GPIO42_MODE;
-		break;
-	case HAL::GPIO::GPIO43:
-		gpio.IO.PORT	=	GPIO43_PORT;
-		gpio.IO.PIN		=	GPIO43_PIN;
-		gpio.IO.MODE	=	GPIO43_MODE;
-		break;
-	case HAL::GPIO::GPIO44:
-		gpio.IO.PORT	=	GPIO44_PORT;
-		gpio.IO.PIN		=	GPIO44_PIN;
-		gpio.IO.MODE	=	GPIO44_MODE;
-		break;
-	case HAL::GPIO::GPIO45:
-		gpio.IO.PORT	=	GPIO45_PORT;
-		gpio.IO.PIN		=	GPIO45_PIN;
-		gpio.IO.MODE	=	GPIO45_MODE;
-		break;
-	case HAL::GPIO::GPIO46:
-		gpio.IO.PORT	=	GPIO46_PORT;
-		gpio.IO.PIN		=	GPIO46_PIN;
-		gpio.IO.MODE	=	GPIO46_MODE;
-		break;
-	case HAL::GPIO::GPIO47:
-		gpio.IO.PORT	=	GPIO47_PORT;
-		gpio.IO.PIN		=	GPIO47_PIN;
-		gpio.IO.MODE	=	GPIO47_MODE;
-		break;
-	case HAL::GPIO::GPIO48:
-		gpio.IO.PORT	=	GPIO48_PORT;
-		gpio.IO.PIN		=	GPIO48_PIN;
-		gpio.IO.MODE	=	GPIO48_MODE;
-		break;
-	case HAL::GPIO::GPIO49:
-		gpio.IO.PORT	=	GPIO49_PORT;
-		gpio.IO.PIN		=	GPIO49_PIN;
-		gpio.IO.MODE	=	GPIO49_MODE;
-		break;
-	case HAL::GPIO::GPIO50:
-		gpio.IO.PORT	=	GPIO50_PORT;
-		gpio.IO.PIN		=	GPIO50_PIN;
-		gpio.IO.MODE	=	GPIO50_MODE;
-		break;
-	case HAL::GPIO::GPIO51:
-		gpio.IO.PORT	=	GPIO51_PORT;
-		gpio.IO.PIN		=	GPIO51_PIN;
-		gpio.IO.MODE	=	GPIO51_MODE;
-		break;
-	case HAL::GPIO::GPIO52:
-		gpio.IO.PORT	=	GPIO52_PORT;
-		gpio.IO.PIN		=	GPIO52_PIN;
-		gpio.IO.MODE	=	GPIO52_MODE;
-		break;
-	case HAL::GPIO::GPIO53:
-		gpio.IO.PORT	=	GPIO53_PORT;
-		gpio.IO.PIN		=	GPIO53_PIN;
-		gpio.IO.MODE	=	GPIO53_MODE;
-		break;
-	case HAL::GPIO::GPIO54:
-		gpio.IO.PORT	=	GPIO54_PORT;
-		gpio.IO.PIN		=	GPIO54_PIN;
-		gpio.IO.MODE	=	GPIO54_MODE;
-		break;
-	case HAL::GPIO::GPIO55:
-		gpio.IO.PORT	=	GPIO55_PORT;
-		gpio.IO.PIN		=	GPIO55_PIN;
-		gpio.IO.MODE	=	GPIO55_MODE;
-		break;
-	case HAL::GPIO::GPIO56:
-		gpio.IO.PORT	=	GPIO56_PORT;
-		gpio.IO.PIN		=	GPIO56_PIN;
-		gpio.IO.MODE	=	GPIO56_MODE;
-		break;
-	case HAL::GPIO::GPIO57:
-		gpio.IO.PORT	=	GPIO57_PORT;
-		gpio.IO.PIN		=	GPIO57_PIN;
-		gpio.IO.MODE	=	GPIO57_MODE;
-		break;
-	case HAL::GPIO::GPIO58:
-		gpio.IO.PORT	=	GPIO58_PORT;
-		gpio.IO.PIN		=	GPIO58_PIN;
-		gpio.IO.MODE	=	GPIO58_MODE;
-		break;
-	case HAL::GPIO::GPIO59:
-		gpio.IO.PORT	=	GPIO59_PORT;
-		gpio.IO.PIN		=	GPIO59_PIN;
-		gpio.IO.MODE	=	GPIO59_MODE;
-		break;
-	case HAL::GPIO::GPIO60:
-		gpio.IO.PORT	=	GPIO60_PORT;
-		gpio.IO.PIN		=	GPIO60_PIN;
-		gpio.IO.MODE	=	GPIO60_MODE;
-		break;
-	case HAL::GPIO::GPIO61:
-		gpio.IO.PORT	=	GPIO61_PORT;
-		gpio.IO.PIN		=	GPIO61_PIN;
-		gpio.IO.MODE	=	GPIO61_MODE;
-		break;
-	case HAL::GPIO::GPIO62:
-		gpio.IO.PORT	=	GPIO62_PORT;
-		gpio.IO.PIN		=	GPIO62_PIN;
-		gpio.IO.MODE	=	GPIO62_MODE;
-		break;
-	case HAL::GPIO::GPIO63:
-		gpio.IO.PORT	=	GPIO63_PORT;
-		gpio.IO.PIN		=	GPIO63_PIN;
-		gpio.IO.MODE	=	GPIO63_MODE;
-		break;
-	case HAL::GPIO::GPIO64:
-		gpio.IO.PORT	=	GPIO64_PORT;
-		gpio.IO.PIN		=	GPIO64_PIN;
-		gpio.IO.MODE	=	GPIO64_MODE;
-		break;
-	case HAL::GPIO::GPIO65:
-		gpio.IO.PORT	=	GPIO65_PORT;
-		gpio.IO.PIN		=	GPIO65_PIN;
-		gpio.IO.MODE	=	GPIO65_MODE;
-		break;
-	case HAL::GPIO::GPIO66:
-		gpio.IO.PORT	=	GPIO66_PORT;
-		gpio.IO.PIN		=	GPIO66_PIN;
-		gpio.IO.MODE	=	GPIO66_MODE;
-		break;
-	case HAL::GPIO::GPIO67:
-		gpio.IO.PORT	=	GPIO67_PORT;
-		gpio.IO.PIN		=	GPIO67_PIN;
-		gpio.IO.MODE	=	GPIO67_MODE;
-		break;
-	case HAL::GPIO::GPIO68:
-		gpio.IO.PORT	=	GPIO68_PORT;
-		gpio.IO.PIN		=	GPIO68_PIN;
-		gpio.IO.MODE	=	GPIO68_MODE;
-		break;
-	case HAL::GPIO::GPIO69:
-		gpio.IO.PORT	=	GPIO69_PORT;
-		gpio.IO.PIN		=	GPIO69_PIN;
-		gpio.IO.MODE	=	GPIO69_MODE;
-		break;
-	case HAL::GPIO::GPIO70:
-		gpio.IO.PORT	=	GPIO70_PORT;
-		gpio.IO.PIN		=	GPIO70_PIN;
-		gpio.IO.MODE	=	GPIO70_MODE;
-		break;
-	case HAL::GPIO::GPIO71:
-		gpio.IO.PORT	=	GPIO71_PORT;
-		gpio.IO.PIN		=	GPIO71_PIN;
-		gpio.IO.MODE	=	GPIO71_MODE;
-		break;
-	case HAL::GPIO::GPIO72:
-		gpio.IO.PORT	=	GPIO72_PORT;
-		gpio.IO.PIN		=	GPIO72_PIN;
-		gpio.IO.MODE	=	GPIO72_MODE;
-		break;
-	default:
-		break;
-	}
-
-	return gpio;
+	return _gpioDefs[id];
 }
 
 /**
@@ -825,11 +594,11 @@ static void _hardwareInit (enum GPIO::ID id)
 
 	GPIO_Init(gpio.IO.PORT, &GPIOStruct);
 
-	// INT Init
-	if(gpio.IO.MODE == GPIO_Mode_IN)
+	// INT Init (inputs with an interrupt line only)
+	if((gpio.IO.MODE == GPIO_Mode_IN) && (gpio.INT.LINE != 0u))
 	{
 		// Connect INT Line to GPIO pin
-		//SYSCFG_EXTILineConfig(gpio.INT.PORTSOURCE, gpio.INT.PINSOURCE);
+		SYSCFG_EXTILineConfig(gpio.INT.PORTSOURCE, gpio.INT.PINSOURCE);
 
 		// Init INT
 		EXTIStruct.EXTI_Line		= 	gpio.INT.LINE;
@@ -837,9 +606,9 @@ static void _hardwareInit (enum GPIO::ID id)
 		EXTIStruct.EXTI_Mode		=	EXTI_Mode_Interrupt;
 		EXTIStruct.EXTI_LineCmd		=	ENABLE;
 
-		//EXTI_ClearITPendingBit(gpio.INT.LINE);
+		EXTI_ClearITPendingBit(gpio.INT.LINE);
 
-		//EXTI_Init(&EXTIStruct);
+		EXTI_Init(&EXTIStruct);
 
 		// Init NVIC
 		NVICStruct.NVIC_IRQChannel						=	gpio.INT.CHANNEL;
@@ -847,7 +616,7 @@ static void _hardwareInit (enum GPIO::ID id)
 		NVICStruct.NVIC_IRQChannelSubPriority 			= 	0;
 		NVICStruct.NVIC_IRQChannelCmd					=	ENABLE;
 
-		//NVIC_Init(&NVICStruct);
+		NVIC_Init(&NVICStruct);
 	}
 }
 
@@ -868,7 +637,7 @@ namespace HAL
 		else
 		{
 			// Create GPIO instance
-			_gpio[id] = new GPIO(id);
+			_gpio[id] = new (_gpioStorage.Get(id)) GPIO(id);
 
 			return _gpio[id];
 		}
@@ -877,8 +646,10 @@ namespace HAL
 	GPIO::GPIO (enum GPIO::ID id)
 	{
 		this->id = id;
-		this->intState = false;
 		this->def = _getGPIOStruct(id);
+		this->intState = (this->def.IO.MODE == GPIO_Mode_IN) && (this->def.INT.LINE != 0u);
+		this->edgeTimestamp = 0u;
+		this->edgeState = GPIO::Low;
 
 		_hardwareInit(id);
 	}
@@ -921,42 +692,164 @@ namespace HAL
 		}
 	}
 
-	void GPIO::INTERNAL_InterruptCallback()
+	void GPIO::SetInterruptState (bool enable)
+	{
+		if((this->def.IO.MODE != GPIO_Mode_IN) || (this->def.INT.LINE == 0u))
+			return;
+
+		// Pending edge of a disabled line is dropped
+		if(enable)
+		{
+			EXTI_ClearITPendingBit(this->def.INT.LINE);
+			EXTI->IMR |= this->def.INT.LINE;
+		}
+		else
+			EXTI->IMR &= ~this->def.INT.LINE;
+
+		this->intState = enable;
+	}
+
+	void GPIO::SetInterruptTrigger (EXTITrigger_TypeDef trigger)
+	{
+		if((this->def.IO.MODE != GPIO_Mode_IN) || (this->def.INT.LINE == 0u))
+			return;
+
+		if((trigger == EXTI_Trigger_Rising) || (trigger == EXTI_Trigger_Rising_Falling))
+			EXTI->RTSR |= this->def.INT.LINE;
+		else
+			EXTI->RTSR &= ~this->def.INT.LINE;
+
+		if((trigger == EXTI_Trigger_Falling) || (trigger == EXTI_Trigger_Rising_Falling))
+			EXTI->FTSR |= this->def.INT.LINE;
+		else
+			EXTI->FTSR &= ~this->def.INT.LINE;
+
+		this->def.INT.TRIGGER = trigger;
+	}
+
+	void GPIO::INTERNAL_InterruptCallback (uint32_t timestamp)
 	{
 		if(this->def.IO.MODE == GPIO_Mode_IN)
 		{
+			this->edgeTimestamp = timestamp;
+			this->edgeState = (this->def.IO.PORT->IDR & this->def.IO.PIN) ? GPIO::High : GPIO::Low;
+
 			this->StateChanged();
 		}
 	}
+
+	GPIOBatch::GPIOBatch ()
+	{
+		this->count = 0u;
+		this->portCount = 0u;
+	}
+
+	int32_t GPIOBatch::Add (GPIO* gpio)
+	{
+		uint32_t i;
+
+		assert(gpio != NULL);
+
+		if(this->count >= GPIO_BATCH_SIZE)
+			return -1;
+
+		// Register port once
+		for(i = 0u; i < this->portCount; i++)
+		{
+			if(this->port[i] == gpio->GetPort())
+				break;
+		}
+
+		if(i == this->portCount)
+		{
+			if(this->portCount >= GPIO_BATCH_PORTS)
+				return -1;
+
+			this->port[this->portCount] = gpio->GetPort();
+			this->bsrr[this->portCount] = 0u;
+			this->portCount++;
+		}
+
+		this->pin[this->count] = gpio->GetPin();
+		this->slot[this->count] = (uint8_t)i;
+
+		return (int32_t)this->count++;
+	}
 }
 
 /*----------------------------------------------------------------------------*/
 /* Interrupt Handler                                                          */
 /*----------------------------------------------------------------------------*/
 
+/**
+ * @brief Raise GPIO interrupt callback if line is pending, edge timestamp is taken first
+ * @param id : GPIO ID
+ * @param line : EXTI line of GPIO
+ */
+static void _lineHandler (enum GPIO::ID id, uint32_t line)
+{
+	uint32_t timestamp = Utils::Profiler::GetCycles();
+
+	if(EXTI_GetITStatus(line) == SET)
+	{
+		EXTI_ClearITPendingBit(line);
+
+		// Interrupt is only enabled once GPIO instance exists
+		if(_gpio[id] != NULL)
+			_gpio[id]->INTERNAL_InterruptCallback(timestamp);
+	}
+}
+
 extern "C"
 {
 	/**
-	 * @brief INT Line 9 to 5 Interrupt Handler
+	 * @brief INT Line 0 Interrupt Handler
 	 */
-	void INT9_5_IRQHandler(void)
+	void EXTI0_IRQHandler(void)
 	{
-/*		if(EXTI_GetFlagStatus(GPIO0_INT_LINE) == SET)
-		{
-			EXTI_ClearFlag(GPIO0_INT_LINE);
+		_lineHandler(GPIO::GPIO9, GPIO9_INT_LINE);
+	}
+
+	/**
+	 * @brief INT Line 1 Interrupt Handler
+	 */
+	void EXTI1_IRQHandler(void)
+	{
+		_lineHandler(GPIO::GPIO64, GPIO64_INT_LINE);
+	}
 
-			GPIO* gpio = GPIO::GetInstance(GPIO::GPIO0);
+	/**
+	 * @brief INT Line 2 Interrupt Handler
+	 */
+	void EXTI2_IRQHandler(void)
+	{
+		_lineHandler(GPIO::GPIO21, GPIO21_INT_LINE);
+	}
 
-			gpio->INTERNAL_InterruptCallback();
-		}
-		else if(EXTI_GetFlagStatus(GPIO3_INT_LINE) == SET)
-		{
-			EXTI_ClearFlag(GPIO3_INT_LINE);
+	/**
+	 * @brief INT Line 4 Interrupt Handler
+	 */
+	void EXTI4_IRQHandler(void)
+	{
+		_lineHandler(GPIO::GPIO57, GPIO57_INT_LINE);
+	}
 
-			GPIO* gpio = GPIO::GetInstance(GPIO::GPIO3);
+	/**
+	 * @brief INT Line 9 to 5 Interrupt Handler
+	 */
+	void EXTI9_5_IRQHandler(void)
+	{
+		_lineHandler(GPIO::GPIO58, GPIO58_INT_LINE);
+		_lineHandler(GPIO::GPIO59, GPIO59_INT_LINE);
+		_lineHandler(GPIO::GPIO15, GPIO15_INT_LINE);
+	}
 
-			gpio->INTERNAL_InterruptCallback();
-		}
-*/
+	/**
+	 * @brief INT Line 15 to 10 Interrupt Handler
+	 */
+	void EXTI15_10_IRQHandler(void)
+	{
+		_lineHandler(GPIO::GPIO18, GPIO18_INT_LINE);
+		_lineHandler(GPIO::GPIO72, GPIO72_INT_LINE);
 	}
 }
@@ -0,0 +1,231 @@
+/**
+ * @file	Gyro.cpp
+ * @author	Jeremy ROULLAND
+ * @date	15 oct. 2026
+ * @brief	MPU-6050 family yaw rate gyroscope class (I2C)
+ */
+
+#include "Gyro.hpp"
+#include "StaticStorage.hpp"
+#include <stddef.h>
+
+/*----------------------------------------------------------------------------*/
+/* Definitions                                                                */
+/*----------------------------------------------------------------------------*/
+
+#define GYRO_SLAVE_ADDR					(0xD0u)		// 0x68, AD0 low
+
+#define GYRO_REG_CONFIG					(0x1Au)
+#define GYRO_REG_GYRO_CONFIG			(0x1Bu)
+#define GYRO_REG_GYRO_ZOUT_H			(0x47u)
+#define GYRO_REG_PWR_MGMT_1				(0x6Bu)
+#define GYRO_REG_WHO_AM_I				(0x75u)
+
+#define GYRO_WHO_AM_I					(0x68u)
+
+#define GYRO_RAD_BY_LSB					(3.14159265358979f / 180.0f / 65.5f)	// +/-500 deg/s
+
+/*----------------------------------------------------------------------------*/
+/* Private Members                                                            */
+/*----------------------------------------------------------------------------*/
+
+static HAL::Gyro* _instance[HAL::Gyro::GYRO_MAX] = {NULL};
+static Utils::StaticStorage<HAL::Gyro, HAL::Gyro::GYRO_MAX> _instanceStorage;
+
+/**
+ * @brief Configuration writes (register, value)
+ */
+static const uint8_t _config[][2] =
+{
+	{GYRO_REG_PWR_MGMT_1,	0x01u},		// Wake up, PLL on X gyro
+	{GYRO_REG_CONFIG,		0x03u},		// 44 Hz low pass, 1 kHz rate
+	{GYRO_REG_GYRO_CONFIG,	0x08u},		// +/-500 deg/s
+};
+
+#define GYRO_CONFIG_STEPS				(sizeof(_config) / sizeof(_config[0]))
+
+/*----------------------------------------------------------------------------*/
+/* Private Functions                                                          */
+/*----------------------------------------------------------------------------*/
+
+static GYRO_DEF _getGYROStruct (enum HAL::Gyro::ID id)
+{
+	GYRO_DEF def;
+
+	assert(id < HAL::Gyro::GYRO_MAX);
+
+	switch(id)
+	{
+	case HAL::Gyro::GYRO0:
+		def.BusID		= HAL::I2C::I2C0;
+		def.SlaveAddr	= GYRO_SLAVE_ADDR;
+		break;
+	default:
+		break;
+	}
+
+	return def;
+}
+
+/*----------------------------------------------------------------------------*/
+/* Class Implementation	                                                      */
+/*----------------------------------------------------------------------------*/
+
+namespace HAL
+{
+	Gyro* Gyro::GetInstance(enum Gyro::ID id)
+	{
+		assert(id < Gyro::GYRO_MAX);
+
+		if(_instance[id] == NULL)
+		{
+			_instance[id] = new (_instanceStorage.Get(id)) Gyro(id);
+		}
+		else
+		{
+
+		}
+
+		return _instance[id];
+	}
+
+	Gyro::Gyro(enum Gyro::ID id)
+	{
+		this->id = id;
+		this->def = _getGYROStruct(id);
+
+		this->bus = I2C::GetInstance(this->def.BusID);
+
+		this->transaction.slaveAddr	=	this->def.SlaveAddr;
+		this->transaction.txBuffer	=	this->txBuffer;
+		this->transaction.txLength	=	0u;
+		this->transaction.rxBuffer	=	this->rxBuffer;
+		this->transaction.rxLength	=	0u;
+		this->transaction.callback	=	NULL;
+		this->transaction.obj		=	NULL;
+		this->transaction.status	=	NO_ERROR;
+
+		this->state = GYRO_STATE_IDLE;
+		this->step = 0u;
+		this->errors = 0u;
+		this->queued = false;
+
+		this->rate = 0.0f;
+		this->updated = false;
+	}
+
+	int32_t Gyro::queue (uint32_t txLength, uint32_t rxLength)
+	{
+		this->transaction.txLength = txLength;
+		this->transaction.rxLength = rxLength;
+
+		return this->bus->TransferAsync(&this->transaction);
+	}
+
+	int32_t Gyro::Sample ()
+	{
+		int32_t rval = NO_ERROR;
+		int16_t raw = 0;
+
+		// 1. Last transaction still running
+		if(this->transaction.status == I2C_PENDING)
+		{
+			return (this->state == GYRO_STATE_RUN) ? NO_ERROR : GYRO_ERROR_NOT_READY;
+		}
+
+		// 2. Last transaction result (none at first call or after a queue failure)
+		if(!this->queued)
+		{
+			if(this->state == GYRO_STATE_IDLE)
+			{
+				this->state = GYRO_STATE_PROBE;
+			}
+		}
+		else if(this->transaction.status != NO_ERROR)
+		{
+			this->errors++;
+
+			// Nothing answers the probe, or the bus keeps failing
+			if((this->state == GYRO_STATE_PROBE) || (this->errors >= GYRO_ERROR_MAX))
+			{
+				this->state = GYRO_STATE_ABSENT;
+			}
+		}
+		else
+		{
+			switch(this->state)
+			{
+			case GYRO_STATE_PROBE:
+				if(this->rxBuffer[0] == GYRO_WHO_AM_I)
+				{
+					this->state = GYRO_STATE_CONFIG;
+					this->step = 0u;
+				}
+				else
+				{
+					this->state = GYRO_STATE_ABSENT;
+				}
+				break;
+
+			case GYRO_STATE_CONFIG:
+				this->step++;
+				if(this->step >= GYRO_CONFIG_STEPS)
+				{
+					this->state = GYRO_STATE_RUN;
+				}
+				break;
+
+			case GYRO_STATE_RUN:
+				raw = static_cast<int16_t>((static_cast<uint16_t>(this->rxBuffer[0]) << 8u) | this->rxBuffer[1]);
+				this->rate = static_cast<float32_t>(raw) * GYRO_RAD_BY_LSB;
+				this->updated = true;
+				this->errors = 0u;
+				break;
+
+			default:
+				break;
+			}
+		}
+
+		// 3. Queue next transaction
+		switch(this->state)
+		{
+		case GYRO_STATE_PROBE:
+			this->txBuffer[0] = GYRO_REG_WHO_AM_I;
+			rval = this->queue(1u, 1u);
+			break;
+
+		case GYRO_STATE_CONFIG:
+			this->txBuffer[0] = _config[this->step][0];
+			this->txBuffer[1] = _config[this->step][1];
+			rval = this->queue(2u, 0u);
+			break;
+
+		case GYRO_STATE_RUN:
+			this->txBuffer[0] = GYRO_REG_GYRO_ZOUT_H;
+			rval = this->queue(1u, 2u);
+			break;
+
+		default:
+			rval = GYRO_ERROR_ABSENT;
+			break;
+		}
+
+		// Queue full : same transaction retried at next call
+		this->queued = (rval == NO_ERROR);
+
+		return rval;
+	}
+
+	bool Gyro::GetRate (float32_t * rate)
+	{
+		bool updated = this->updated;
+
+		assert(rate != NULL);
+
+		*rate = this->rate;
+		this->updated = false;
+
+		return updated;
+	}
+}
@@ -0,0 +1,629 @@
+/**
+ * @file	I2C.cpp
+ * @author	Kevin WYSOCKI
+ * @date	6 mars 2017
+ * @brief	I2C master abstraction class
+ */
+
+#include "I2C.hpp"
+#include "StaticStorage.hpp"
+#include "Clock.hpp"
+#include <stddef.h>
+
+using namespace HAL;
+
+/*----------------------------------------------------------------------------*/
+/* Definitions                                                                */
+/*----------------------------------------------------------------------------*/
+
+// I2C0 (PB7 is LED2 on TARGET_NUCLEO)
+#define I2C0_SCL_PORT			(GPIOB)
+#define I2C0_SCL_PIN			(GPIO_Pin_6)
+#define I2C0_SCL_PINSOURCE		(GPIO_PinSource6)
+#define I2C0_SDA_PORT			(GPIOB)
+#define I2C0_SDA_PIN			(GPIO_Pin_7)
+#define I2C0_SDA_PINSOURCE		(GPIO_PinSource7)
+#define I2C0_IO_AF				(GPIO_AF_I2C1)
+#define I2C0_CLOCKFREQ			(400000u)
+#define I2C0_BUS				(I2C1)
+#define I2C0_INT_EVENT_CHANNEL	(I2C1_EV_IRQn)
+#define I2C0_INT_ERROR_CHANNEL	(I2C1_ER_IRQn)
+#define I2C0_INT_PRIORITY		(11u)	// Below configMAX_SYSCALL (completion notification)
+
+#define I2C0_DMA_TX_STREAM		(DMA1_Stream7)
+#define I2C0_DMA_TX_CHANNEL		(DMA_Channel_1)
+#define I2C0_DMA_TX_FLAGS		(DMA_FLAG_TCIF7 | DMA_FLAG_HTIF7 | DMA_FLAG_TEIF7 | DMA_FLAG_DMEIF7 | DMA_FLAG_FEIF7)
+#define I2C0_DMA_RX_STREAM		(DMA1_Stream0)
+#define I2C0_DMA_RX_CHANNEL		(DMA_Channel_1)
+#define I2C0_DMA_RX_FLAGS		(DMA_FLAG_TCIF0 | DMA_FLAG_HTIF0 | DMA_FLAG_TEIF0 | DMA_FLAG_DMEIF0 | DMA_FLAG_FEIF0)
+#define I2C0_DMA_RX_INT			(DMA1_Stream0_IRQn)
+
+#define I2C_RECOVERY_PULSES		(9u)	// Clock pulses releasing a slave stuck in a byte
+#define I2C_RECOVERY_HALF_US	(5u)	// 100 kHz
+
+#define I2C_FLAG_DMA_RX			(0u)
+
+/*----------------------------------------------------------------------------*/
+/* Private Members                                                            */
+/*----------------------------------------------------------------------------*/
+
+/**
+ * @brief I2C instances
+ */
+static I2C* _i2c[I2C::I2C_MAX] = {NULL};
+
+/**
+ * @brief I2C instances storage
+ */
+static Utils::StaticStorage<I2C, I2C::I2C_MAX> _i2cStorage;
+
+/*----------------------------------------------------------------------------*/
+/* Private Functions                                                          */
+/*----------------------------------------------------------------------------*/
+
+static I2C_DEF _getI2CStruct (enum I2C::ID id)
+{
+	I2C_DEF i2c;
+
+	assert(id < I2C::I2C_MAX);
+
+	switch(id)
+	{
+	case I2C::I2C0:
+		// SCL Pin
+		i2c.SCL.PORT			=	I2C0_SCL_PORT;
+		i2c.SCL.PIN				=	I2C0_SCL_PIN;
+		i2c.SCL.PINSOURCE		=	I2C0_SCL_PINSOURCE;
+		i2c.SCL.AF				=	I2C0_IO_AF;
+		// SDA Pin
+		i2c.SDA.PORT			=	I2C0_SDA_PORT;
+		i2c.SDA.PIN				=	I2C0_SDA_PIN;
+		i2c.SDA.PINSOURCE		=	I2C0_SDA_PINSOURCE;
+		i2c.SDA.AF				=	I2C0_IO_AF;
+		// I2C Peripheral
+		i2c.I2C.BUS				=	I2C0_BUS;
+		i2c.I2C.SLAVE_ADDR		=	0u;
+		i2c.I2C.CLOCKFREQ		=	I2C0_CLOCKFREQ;
+		// NVIC Peripheral
+		i2c.INT.PRIORITY		=	I2C0_INT_PRIORITY;
+		i2c.INT.EV_CHANNEL		=	I2C0_INT_EVENT_CHANNEL;
+		i2c.INT.ER_CHANNEL		=	I2C0_INT_ERROR_CHANNEL;
+		// DMA
+		i2c.DMA_TX.STREAM		=	I2C0_DMA_TX_STREAM;
+		i2c.DMA_TX.CHANNEL		=	I2C0_DMA_TX_CHANNEL;
+		i2c.DMA_TX.FLAGS		=	I2C0_DMA_TX_FLAGS;
+		i2c.DMA_TX.INT_CHANNEL	=	0u;
+		i2c.DMA_RX.STREAM		=	I2C0_DMA_RX_STREAM;
+		i2c.DMA_RX.CHANNEL		=	I2C0_DMA_RX_CHANNEL;
+		i2c.DMA_RX.FLAGS		=	I2C0_DMA_RX_FLAGS;
+		i2c.DMA_RX.INT_CHANNEL	=	I2C0_DMA_RX_INT;
+		break;
+
+	default:
+		break;
+	}
+
+	return i2c;
+}
+
+static void _pinsInit (const I2C_DEF * i2c, GPIOMode_TypeDef mode)
+{
+	GPIO_InitTypeDef GPIOStruct;
+
+	GPIOStruct.GPIO_Mode	=	mode;
+	GPIOStruct.GPIO_OType	=	GPIO_OType_OD;
+	GPIOStruct.GPIO_PuPd	=	GPIO_PuPd_NOPULL;
+	GPIOStruct.GPIO_Speed	=	GPIO_Speed_50MHz;
+	GPIOStruct.GPIO_Pin		=	i2c->SCL.PIN;
+
+	GPIO_PinAFConfig(i2c->SCL.PORT, i2c->SCL.PINSOURCE, i2c->SCL.AF);
+	GPIO_Init(i2c->SCL.PORT, &GPIOStruct);
+
+	GPIOStruct.GPIO_Pin		=	i2c->SDA.PIN;
+
+	GPIO_PinAFConfig(i2c->SDA.PORT, i2c->SDA.PINSOURCE, i2c->SDA.AF);
+	GPIO_Init(i2c->SDA.PORT, &GPIOStruct);
+}
+
+static void _busInit (const I2C_DEF * i2c)
+{
+	I2C_InitTypeDef I2CStruct;
+
+	// I2C Init (master, own address unused)
+	I2CStruct.I2C_Mode					=	I2C_Mode_I2C;
+	I2CStruct.I2C_DutyCycle				=	I2C_DutyCycle_2;
+	I2CStruct.I2C_Ack					=	I2C_Ack_Enable;
+	I2CStruct.I2C_AcknowledgedAddress	=	I2C_AcknowledgedAddress_7bit;
+	I2CStruct.I2C_OwnAddress1			=	i2c->I2C.SLAVE_ADDR;
+	I2CStruct.I2C_ClockSpeed			=	i2c->I2C.CLOCKFREQ;
+
+	I2C_Init(i2c->I2C.BUS, &I2CStruct);
+
+	// Data bytes are moved by DMA, only events and errors interrupt
+	I2C_ITConfig(i2c->I2C.BUS, I2C_IT_EVT | I2C_IT_ERR, ENABLE);
+	I2C_Cmd(i2c->I2C.BUS, ENABLE);
+}
+
+static void _hardwareInit (enum I2C::ID id)
+{
+	NVIC_InitTypeDef NVICStruct;
+	DMA_InitTypeDef DMAStruct;
+
+	I2C_DEF i2c;
+
+	assert(id < I2C::I2C_MAX);
+
+	i2c = _getI2CStruct(id);
+
+	// Init SCL and SDA pins
+	_pinsInit(&i2c, GPIO_Mode_AF);
+
+	_busInit(&i2c);
+
+	// DMA Init (common), streams are started on each transaction
+	DMAStruct.DMA_PeripheralBaseAddr	=	(uint32_t)&i2c.I2C.BUS->DR;
+	DMAStruct.DMA_PeripheralInc			=	DMA_PeripheralInc_Disable;
+	DMAStruct.DMA_MemoryInc				=	DMA_MemoryInc_Enable;
+	DMAStruct.DMA_PeripheralDataSize	=	DMA_PeripheralDataSize_Byte;
+	DMAStruct.DMA_MemoryDataSize		=	DMA_MemoryDataSize_Byte;
+	DMAStruct.DMA_Mode					=	DMA_Mode_Normal;
+	DMAStruct.DMA_Priority				=	DMA_Priority_Medium;
+	DMAStruct.DMA_FIFOMode				=	DMA_FIFOMode_Disable;
+	DMAStruct.DMA_FIFOThreshold			=	DMA_FIFOThreshold_Full;
+	DMAStruct.DMA_MemoryBurst			=	DMA_MemoryBurst_Single;
+	DMAStruct.DMA_PeripheralBurst		=	DMA_PeripheralBurst_Single;
+	DMAStruct.DMA_BufferSize			=	1u;
+
+	// Write end is detected on BTF (last byte shifted out), no stream interrupt
+	DMA_DeInit(i2c.DMA_TX.STREAM);
+	DMAStruct.DMA_Channel				=	i2c.DMA_TX.CHANNEL;
+	DMAStruct.DMA_Memory0BaseAddr		=	0u;
+	DMAStruct.DMA_DIR					=	DMA_DIR_MemoryToPeripheral;
+	DMA_Init(i2c.DMA_TX.STREAM, &DMAStruct);
+
+	DMA_DeInit(i2c.DMA_RX.STREAM);
+	DMAStruct.DMA_Channel				=	i2c.DMA_RX.CHANNEL;
+	DMAStruct.DMA_DIR					=	DMA_DIR_PeripheralToMemory;
+	DMA_Init(i2c.DMA_RX.STREAM, &DMAStruct);
+	DMA_ITConfig(i2c.DMA_RX.STREAM, DMA_IT_TC, ENABLE);
+
+	// NVIC Init - Event interrupt
+	NVICStruct.NVIC_IRQChannel						=	i2c.INT.EV_CHANNEL;
+	NVICStruct.NVIC_IRQChannelPreemptionPriority	=	i2c.INT.PRIORITY;
+	NVICStruct.NVIC_IRQChannelSubPriority			=	0;
+	NVICStruct.NVIC_IRQChannelCmd					=	ENABLE;
+
+	NVIC_Init(&NVICStruct);
+
+	// NVIC Init - Error interrupt
+	NVICStruct.NVIC_IRQChannel						=	i2c.INT.ER_CHANNEL;
+
+	NVIC_Init(&NVICStruct);
+
+	// NVIC Init - DMA RX complete
+	NVICStruct.NVIC_IRQChannel						=	i2c.DMA_RX.INT_CHANNEL;
+
+	NVIC_Init(&NVICStruct);
+}
+
+static void _stopStream (DMA_Stream_TypeDef * stream)
+{
+	DMA_Cmd(stream, DISABLE);
+
+	while((stream->CR & DMA_SxCR_EN) != 0u)
+	{}
+}
+
+static void _startStream (DMA_Stream_TypeDef * stream, uint32_t flags, uint8_t * buffer, uint32_t length)
+{
+	DMA_ClearFlag(stream, flags);
+	stream->M0AR = (uint32_t)buffer;
+	DMA_SetCurrDataCounter(stream, length);
+	DMA_Cmd(stream, ENABLE);
+}
+
+static void _delayUs (uint32_t us)
+{
+	uint32_t start = Utils::Clock::GetMicros();
+
+	while((Utils::Clock::GetMicros() - start) < us)
+	{}
+}
+
+static int32_t _getErrorFromFlag (uint32_t flag)
+{
+	int32_t rval = 0;
+
+	switch(flag)
+	{
+	case I2C_FLAG_BERR :
+		rval = I2C_ERROR_MISPLACED_START_STOP;
+		break;
+	case I2C_FLAG_AF :
+		rval = I2C_ERROR_ACKNOWLEDGE_FAILURE;
+		break;
+	case I2C_FLAG_OVR :
+		rval = I2C_ERROR_OVER_UNDERRUN;
+		break;
+	case I2C_FLAG_ARLO :
+		rval = I2C_ERROR_ARBITRATION_LOST;
+		break;
+	}
+
+	return rval;
+}
+
+/**
+ * @brief Blocking transfer completion : wake up waiting task
+ * @param obj : Waiting task handle
+ */
+static void _transferDone (void* obj)
+{
+	BaseType_t woken = pdFALSE;
+
+	vTaskNotifyGiveFromISR(reinterpret_cast<TaskHandle_t>(obj), &woken);
+	portYIELD_FROM_ISR(woken);
+}
+
+static void _timeoutEvent (void* obj)
+{
+	I2C* i2c = reinterpret_cast<I2C*>(obj);
+
+	i2c->INTERNAL_Timeout();
+}
+
+/*----------------------------------------------------------------------------*/
+/* Class Implementation	                                                      */
+/*----------------------------------------------------------------------------*/
+
+namespace HAL
+{
+	I2C* I2C::GetInstance(enum I2C::ID id)
+	{
+		assert(id < I2C::I2C_MAX);
+
+		// if I2C instance already exists
+		if(_i2c[id] != NULL)
+		{
+			return _i2c[id];
+		}
+		else
+		{
+			_i2c[id] = new (_i2cStorage.Get(id)) I2C(id);
+
+			return _i2c[id];
+		}
+	}
+
+	I2C::I2C(enum I2C::ID id)
+	{
+		this->id = id;
+		this->def = _getI2CStruct(id);
+		this->queueWr = 0u;
+		this->queueRd = 0u;
+		this->reading = false;
+		this->recoveries = 0u;
+
+		this->timer.Elapsed.Subscribe(this, &_timeoutEvent);
+
+		_hardwareInit(id);
+	}
+
+	int32_t I2C::Transfer(uint8_t slaveAddr, uint8_t * txBuffer, uint32_t txNbBytes, uint8_t * rxBuffer, uint32_t rxNbBytes)
+	{
+		int32_t rval = NO_ERROR;
+		I2CTransaction transaction;
+
+		// Completion is notified from interrupt
+		assert(xTaskGetSchedulerState() != taskSCHEDULER_NOT_STARTED);
+
+		transaction.slaveAddr	=	slaveAddr;
+		transaction.txBuffer	=	txBuffer;
+		transaction.txLength	=	txNbBytes;
+		transaction.rxBuffer	=	rxBuffer;
+		transaction.rxLength	=	rxNbBytes;
+		transaction.callback	=	&_transferDone;
+		transaction.obj			=	xTaskGetCurrentTaskHandle();
+
+		rval = this->TransferAsync(&transaction);
+
+		// Sleep until completion (the watchdog ends it anyway)
+		while((rval == NO_ERROR) && (transaction.status == I2C_PENDING))
+		{
+			ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+		}
+
+		if(rval == NO_ERROR)
+		{
+			rval = transaction.status;
+		}
+
+		return rval;
+	}
+
+	int32_t I2C::TransferAsync(I2CTransaction * transaction)
+	{
+		int32_t rval = NO_ERROR;
+		bool idle = false;
+
+		assert(transaction != NULL);
+		assert((transaction->txLength + transaction->rxLength) > 0u);
+
+		transaction->status = I2C_PENDING;
+
+		taskENTER_CRITICAL();
+
+		if((this->queueWr - this->queueRd) >= I2C_QUEUE_SIZE)
+		{
+			rval = I2C_ERROR_QUEUE_FULL;
+		}
+		else
+		{
+			idle = (this->queueWr == this->queueRd);
+
+			this->queue[this->queueWr % I2C_QUEUE_SIZE] = transaction;
+			this->queueWr++;
+
+			if(idle)
+			{
+				this->start();
+			}
+		}
+
+		taskEXIT_CRITICAL();
+
+		return rval;
+	}
+
+	void I2C::start()
+	{
+		I2CTransaction * t = this->queue[this->queueRd % I2C_QUEUE_SIZE];
+		uint32_t bytes = t->txLength + t->rxLength;
+
+		this->reading = (t->txLength == 0u);
+
+		this->timer.Start(I2C_TIMEOUT_MS + bytes / I2C_TIMEOUT_BYTES_MS);
+
+		I2C_AcknowledgeConfig(this->def.I2C.BUS, ENABLE);
+		I2C_GenerateSTART(this->def.I2C.BUS, ENABLE);
+	}
+
+	void I2C::complete(int32_t status)
+	{
+		I2CTransaction * t = this->queue[this->queueRd % I2C_QUEUE_SIZE];
+		I2C_TypeDef * bus = this->def.I2C.BUS;
+
+		this->timer.Stop();
+
+		I2C_DMACmd(bus, DISABLE);
+		I2C_DMALastTransferCmd(bus, DISABLE);
+		I2C_ITConfig(bus, I2C_IT_BUF, DISABLE);
+		_stopStream(this->def.DMA_TX.STREAM);
+		_stopStream(this->def.DMA_RX.STREAM);
+
+		// Pop and start next transaction before notifying
+		this->queueRd++;
+
+		if(this->queueRd != this->queueWr)
+		{
+			this->start();
+		}
+
+		t->status = status;
+
+		if(t->callback != NULL)
+		{
+			t->callback(t->obj);
+		}
+	}
+
+	void I2C::recover()
+	{
+		I2C_TypeDef * bus = this->def.I2C.BUS;
+
+		this->recoveries++;
+
+		I2C_Cmd(bus, DISABLE);
+
+		// Clock pulses until the slave releases SDA, then a stop condition
+		GPIO_SetBits(this->def.SCL.PORT, this->def.SCL.PIN);
+		GPIO_SetBits(this->def.SDA.PORT, this->def.SDA.PIN);
+		_pinsInit(&this->def, GPIO_Mode_OUT);
+
+		for(uint32_t i = 0u; i < I2C_RECOVERY_PULSES; i++)
+		{
+			if(GPIO_ReadInputDataBit(this->def.SDA.PORT, this->def.SDA.PIN) == Bit_SET)
+				break;
+
+			GPIO_ResetBits(this->def.SCL.PORT, this->def.SCL.PIN);
+			_delayUs(I2C_RECOVERY_HALF_US);
+			GPIO_SetBits(this->def.SCL.PORT, this->def.SCL.PIN);
+			_delayUs(I2C_RECOVERY_HALF_US);
+		}
+
+		GPIO_ResetBits(this->def.SDA.PORT, this->def.SDA.PIN);
+		_delayUs(I2C_RECOVERY_HALF_US);
+		GPIO_SetBits(this->def.SDA.PORT, this->def.SDA.PIN);
+		_delayUs(I2C_RECOVERY_HALF_US);
+
+		// Peripheral may still believe the bus is busy
+		_pinsInit(&this->def, GPIO_Mode_AF);
+		I2C_SoftwareResetCmd(bus, ENABLE);
+		I2C_SoftwareResetCmd(bus, DISABLE);
+		_busInit(&this->def);
+	}
+
+	void I2C::INTERNAL_Timeout()
+	{
+		if(this->IsIdle())
+			return;
+
+		this->recover();
+		this->complete(I2C_ERROR_TIMEOUT);
+	}
+
+	void I2C::INTERNAL_InterruptCallback(uint32_t flag)
+	{
+		I2CTransaction * t = this->queue[this->queueRd % I2C_QUEUE_SIZE];
+		I2C_TypeDef * bus = this->def.I2C.BUS;
+
+		if(this->IsIdle())
+			return;
+
+		switch(flag)
+		{
+		// Start (or repeated start) sent
+		case I2C_FLAG_SB:
+			I2C_Send7bitAddress(bus, t->slaveAddr, this->reading ? I2C_Direction_Receiver : I2C_Direction_Transmitter);
+			break;
+
+		// Slave acknowledged its address, SR1 already read : reading SR2 clears ADDR
+		case I2C_FLAG_ADDR:
+			if(!this->reading)
+			{
+				_startStream(this->def.DMA_TX.STREAM, this->def.DMA_TX.FLAGS, t->txBuffer, t->txLength);
+				I2C_DMACmd(bus, ENABLE);
+				I2C_ReadRegister(bus, I2C_Register_SR2);
+			}
+			else if(t->rxLength == 1u)
+			{
+				// NAK and stop must be set before ADDR is cleared
+				I2C_AcknowledgeConfig(bus, DISABLE);
+				I2C_ReadRegister(bus, I2C_Register_SR2);
+				I2C_GenerateSTOP(bus, ENABLE);
+				I2C_ITConfig(bus, I2C_IT_BUF, ENABLE);
+			}
+			else
+			{
+				_startStream(this->def.DMA_RX.STREAM, this->def.DMA_RX.FLAGS, t->rxBuffer, t->rxLength);
+				I2C_DMALastTransferCmd(bus, ENABLE);
+				I2C_DMACmd(bus, ENABLE);
+				I2C_ReadRegister(bus, I2C_Register_SR2);
+			}
+			break;
+
+		// Last written byte shifted out (all bytes given by DMA)
+		case I2C_FLAG_BTF:
+			if(this->reading || (DMA_GetCurrDataCounter(this->def.DMA_TX.STREAM) != 0u))
+				break;
+
+			I2C_DMACmd(bus, DISABLE);
+
+			if(t->rxLength != 0u)
+			{
+				this->reading = true;
+				I2C_GenerateSTART(bus, ENABLE);
+			}
+			else
+			{
+				I2C_GenerateSTOP(bus, ENABLE);
+				this->complete(NO_ERROR);
+			}
+			break;
+
+		// Single byte read
+		case I2C_FLAG_RXNE:
+			t->rxBuffer[0] = I2C_ReceiveData(bus);
+			this->complete(NO_ERROR);
+			break;
+
+		// All bytes read, last one NAKed
+		case I2C_FLAG_DMA_RX:
+			I2C_GenerateSTOP(bus, ENABLE);
+			this->complete(NO_ERROR);
+			break;
+
+		// Slave NAK (absent or refused byte) : the bus is fine
+		case I2C_FLAG_AF:
+			I2C_GenerateSTOP(bus, ENABLE);
+			this->complete(_getErrorFromFlag(flag));
+			break;
+
+		// Error management
+		case I2C_FLAG_BERR:
+		case I2C_FLAG_ARLO:
+		case I2C_FLAG_OVR:
+			this->recover();
+			this->complete(_getErrorFromFlag(flag));
+			break;
+		}
+	}
+}
+
+/*----------------------------------------------------------------------------*/
+/* Interrupt Handler                                                          */
+/*----------------------------------------------------------------------------*/
+
+extern "C"
+{
+	void I2C1_EV_IRQHandler (void)
+	{
+		I2C* instance = _i2c[I2C::I2C0];
+		uint16_t sr1 = I2C1->SR1;
+
+		if((sr1 & I2C_SR1_SB) != 0u)
+		{
+			// Cleared by writing the address
+			instance->INTERNAL_InterruptCallback(I2C_FLAG_SB);
+		}
+		else if((sr1 & I2C_SR1_ADDR) != 0u)
+		{
+			instance->INTERNAL_InterruptCallback(I2C_FLAG_ADDR);
+		}
+		else if(((sr1 & I2C_SR1_RXNE) != 0u) && ((I2C1->CR2 & I2C_CR2_ITBUFEN) != 0u))
+		{
+			instance->INTERNAL_InterruptCallback(I2C_FLAG_RXNE);
+		}
+		else if((sr1 & I2C_SR1_BTF) != 0u)
+		{
+			// Cleared by the following start or stop
+			instance->INTERNAL_InterruptCallback(I2C_FLAG_BTF);
+		}
+	}
+
+	void I2C1_ER_IRQHandler (void)
+	{
+		I2C* instance = _i2c[I2C::I2C0];
+
+		if(I2C_GetFlagStatus(I2C1, I2C_FLAG_AF) == SET)
+		{
+			I2C_ClearFlag(I2C1, I2C_FLAG_AF);
+
+			instance->INTERNAL_InterruptCallback(I2C_FLAG_AF);
+		}
+
+		if(I2C_GetFlagStatus(I2C1, I2C_FLAG_BERR) == SET)
+		{
+			I2C_ClearFlag(I2C1, I2C_FLAG_BERR);
+
+			instance->INTERNAL_InterruptCallback(I2C_FLAG_BERR);
+		}
+
+		if(I2C_GetFlagStatus(I2C1, I2C_FLAG_ARLO) == SET)
+		{
+			I2C_ClearFlag(I2C1, I2C_FLAG_ARLO);
+
+			instance->INTERNAL_InterruptCallback(I2C_FLAG_ARLO);
+		}
+
+		if(I2C_GetFlagStatus(I2C1, I2C_FLAG_OVR) == SET)
+		{
+			I2C_ClearFlag(I2C1, I2C_FLAG_OVR);
+
+			instance->INTERNAL_InterruptCallback(I2C_FLAG_OVR);
+		}
+	}
+
+	/**
+	 * @brief I2C1 DMA RX IRQ Handler
+	 */
+	void DMA1_Stream0_IRQHandler (void)
+	{
+		if(DMA_GetITStatus(DMA1_Stream0, DMA_IT_TCIF0) == SET)
+		{
+			DMA_ClearITPendingBit(DMA1_Stream0, DMA_IT_TCIF0);
+
+			_i2c[I2C::I2C0]->INTERNAL_InterruptCallback(I2C_FLAG_DMA_RX);
+		}
+	}
+}
@@ -6,12 +6,12 @@
  */
 
 #include <I2CSlave.hpp>
+#include "StaticStorage.hpp"
 #include <stddef.h>
 #include <string.h>
 
-#include "FreeRTOS.h"
+#include "Frame.hpp"
 
-using namespace std;
 using namespace HAL;
 
 /*----------------------------------------------------------------------------*/
@@ -26,18 +26,25 @@ using namespace HAL;
 #define I2C0_SDA_PIN			(GPIO_Pin_9)
 #define I2C0_SDA_PINSOURCE		(GPIO_PinSource9)
 #define I2C0_IO_AF				(GPIO_AF_I2C3)
-#define I2C0_CLOCKFREQ			(100000u)
+#define I2C0_CLOCKFREQ			(400000u)
 #define I2C0_SLAVEADDR			(0x10)
 #define I2C0_BUS				(I2C3)
 #define I2C0_INT_EVENT_CHANNEL	(I2C3_EV_IRQn)
 #define I2C0_INT_ERROR_CHANNEL	(I2C3_ER_IRQn)
-#define I2C0_INT_PRIORITY		(8u)
+#define I2C0_INT_PRIORITY		(11u)	// Below configMAX_SYSCALL (DataReceived may notify a task)
 
-#define I2C_TIMEOUT				(0xFFFFu)
+#define I2C0_DMA_TX_STREAM		(DMA1_Stream4)
+#define I2C0_DMA_TX_CHANNEL		(DMA_Channel_3)
+#define I2C0_DMA_TX_FLAGS		(DMA_FLAG_TCIF4 | DMA_FLAG_HTIF4 | DMA_FLAG_TEIF4 | DMA_FLAG_DMEIF4 | DMA_FLAG_FEIF4)
+#define I2C0_DMA_RX_STREAM		(DMA1_Stream2)
+#define I2C0_DMA_RX_CHANNEL		(DMA_Channel_3)
+#define I2C0_DMA_RX_FLAGS		(DMA_FLAG_TCIF2 | DMA_FLAG_HTIF2 | DMA_FLAG_TEIF2 | DMA_FLAG_DMEIF2 | DMA_FLAG_FEIF2)
 
-#define I2C_EVENT_START_OK							(I2C_EVENT_MASTER_MODE_SELECT)
-#define I2C_EVENT_SLAVE_ACK_ADDR_READY_TO_TRANSMIT	(I2C_EVENT_MASTER_TRANSMITTER_MODE_SELECTED)
-#define I2C_EVENT_SLAVE_ACK_ADDR_READY_TO_RECEIVE	(I2C_EVENT_MASTER_RECEIVER_MODE_SELECTED)
+#define I2C_PADDING_BYTE		(0xFFu)	// Sent if master reads past the response
+
+#define I2C_HARDWARE_PEC		(1u)	// Check written frames with the PEC unit (software if it fails)
+
+#define I2C_STUCK_CHECKS		(3u)	// Supervise() calls with a busy bus and no event before a reset
 
 /*----------------------------------------------------------------------------*/
 /* Private Members                                                            */
@@ -48,6 +55,11 @@ using namespace HAL;
  */
 static I2CSlave* _i2cSlave[I2CSlave::I2C_SLAVE_MAX] = {NULL};
 
+/**
+ * @brief I2C instances storage
+ */
+static Utils::StaticStorage<I2CSlave, I2CSlave::I2C_SLAVE_MAX> _i2cSlaveStorage;
+
 /*----------------------------------------------------------------------------*/
 /* Private Functions                                                          */
 /*----------------------------------------------------------------------------*/
@@ -79,6 +91,13 @@ static I2C_DEF _getI2CStruct (enum I2CSlave::ID id)
 		i2c.INT.PRIORITY		=	I2C0_INT_PRIORITY;
 		i2c.INT.EV_CHANNEL		=	I2C0_INT_EVENT_CHANNEL;
 		i2c.INT.ER_CHANNEL		=	I2C0_INT_ERROR_CHANNEL;
+		// DMA
+		i2c.DMA_TX.STREAM		=	I2C0_DMA_TX_STREAM;
+		i2c.DMA_TX.CHANNEL		=	I2C0_DMA_TX_CHANNEL;
+		i2c.DMA_TX.FLAGS		=	I2C0_DMA_TX_FLAGS;
+		i2c.DMA_RX.STREAM		=	I2C0_DMA_RX_STREAM;
+		i2c.DMA_RX.CHANNEL		=	I2C0_DMA_RX_CHANNEL;
+		i2c.DMA_RX.FLAGS		=	I2C0_DMA_RX_FLAGS;
 		break;
 
 	default:
@@ -88,11 +107,38 @@ static I2C_DEF _getI2CStruct (enum I2CSlave::ID id)
 	return i2c;
 }
 
+/**
+ * @brief Configure and enable the peripheral (at init and after a software reset)
+ */
+static void _busInit (const I2C_DEF & i2c)
+{
+	I2C_InitTypeDef I2CStruct;
+
+	I2CStruct.I2C_Mode					=	I2C_Mode_I2C;
+	I2CStruct.I2C_DutyCycle				=	I2C_DutyCycle_2;
+	I2CStruct.I2C_Ack					=	I2C_Ack_Enable;
+	I2CStruct.I2C_AcknowledgedAddress	=	I2C_AcknowledgedAddress_7bit;
+	I2CStruct.I2C_OwnAddress1			=	i2c.I2C.SLAVE_ADDR;
+	I2CStruct.I2C_ClockSpeed			=	i2c.I2C.CLOCKFREQ;
+
+	I2C_Init(i2c.I2C.BUS, &I2CStruct);
+
+	// Data bytes are moved by DMA, only events and errors interrupt
+	I2C_DMACmd(i2c.I2C.BUS, ENABLE);
+	I2C_ITConfig(i2c.I2C.BUS, I2C_IT_EVT | I2C_IT_ERR, ENABLE);
+	I2C_GeneralCallCmd(i2c.I2C.BUS, ENABLE);
+#if I2C_HARDWARE_PEC
+	// PEC is computed on the fly (address included), never sent nor compared by hardware
+	I2C_CalculatePEC(i2c.I2C.BUS, ENABLE);
+#endif
+	I2C_Cmd(i2c.I2C.BUS, ENABLE);
+}
+
 static void _hardwareInit (enum I2CSlave::ID id)
 {
 	GPIO_InitTypeDef GPIOStruct;
-	I2C_InitTypeDef I2CStruct;
 	NVIC_InitTypeDef NVICStruct;
+	DMA_InitTypeDef DMAStruct;
 
 	I2C_DEF i2c;
 
@@ -115,20 +161,33 @@ static void _hardwareInit (enum I2CSlave::ID id)
 	GPIO_PinAFConfig(i2c.SDA.PORT, i2c.SDA.PINSOURCE, i2c.SDA.AF);
 	GPIO_Init(i2c.SDA.PORT, &GPIOStruct);
 
-	// I2C Init
-	I2CStruct.I2C_Mode					=	I2C_Mode_I2C;
-	I2CStruct.I2C_DutyCycle				=	I2C_DutyCycle_2;
-	I2CStruct.I2C_Ack					=	I2C_Ack_Enable;
-	I2CStruct.I2C_AcknowledgedAddress	=	I2C_AcknowledgedAddress_7bit;
-	I2CStruct.I2C_OwnAddress1			=	i2c.I2C.SLAVE_ADDR;
-	I2CStruct.I2C_ClockSpeed			=	i2c.I2C.CLOCKFREQ;
+	// DMA Init (common), streams are started on each transfer
+	DMAStruct.DMA_PeripheralBaseAddr	=	(uint32_t)&i2c.I2C.BUS->DR;
+	DMAStruct.DMA_PeripheralInc			=	DMA_PeripheralInc_Disable;
+	DMAStruct.DMA_MemoryInc				=	DMA_MemoryInc_Enable;
+	DMAStruct.DMA_PeripheralDataSize	=	DMA_PeripheralDataSize_Byte;
+	DMAStruct.DMA_MemoryDataSize		=	DMA_MemoryDataSize_Byte;
+	DMAStruct.DMA_Mode					=	DMA_Mode_Normal;
+	DMAStruct.DMA_Priority				=	DMA_Priority_High;
+	DMAStruct.DMA_FIFOMode				=	DMA_FIFOMode_Disable;
+	DMAStruct.DMA_FIFOThreshold			=	DMA_FIFOThreshold_Full;
+	DMAStruct.DMA_MemoryBurst			=	DMA_MemoryBurst_Single;
+	DMAStruct.DMA_PeripheralBurst		=	DMA_PeripheralBurst_Single;
+	DMAStruct.DMA_BufferSize			=	1u;
+
+	DMA_DeInit(i2c.DMA_TX.STREAM);
+	DMAStruct.DMA_Channel				=	i2c.DMA_TX.CHANNEL;
+	DMAStruct.DMA_Memory0BaseAddr		=	0u;
+	DMAStruct.DMA_DIR					=	DMA_DIR_MemoryToPeripheral;
+	DMA_Init(i2c.DMA_TX.STREAM, &DMAStruct);
+
+	DMA_DeInit(i2c.DMA_RX.STREAM);
+	DMAStruct.DMA_Channel				=	i2c.DMA_RX.CHANNEL;
+	DMAStruct.DMA_DIR					=	DMA_DIR_PeripheralToMemory;
+	DMA_Init(i2c.DMA_RX.STREAM, &DMAStruct);
 
-	I2C_Init(i2c.I2C.BUS, &I2CStruct);
-
-	I2C_ITConfig(i2c.I2C.BUS, I2C_IT_EVT | I2C_IT_BUF | I2C_IT_ERR, ENABLE);
-	I2C_GeneralCallCmd(i2c.I2C.BUS, ENABLE);
-	I2C_CalculatePEC(i2c.I2C.BUS, ENABLE);
-	I2C_Cmd(i2c.I2C.BUS, ENABLE);
+	// I2C Init
+	_busInit(i2c);
 
 	// NVIC Init - Event interrupt
 	NVICStruct.NVIC_IRQChannel						=	i2c.INT.EV_CHANNEL;
@@ -138,30 +197,18 @@ static void _hardwareInit (enum I2CSlave::ID id)
 
 	NVIC_Init(&NVICStruct);
 
-	// NVIC Init - Error interrupt
+	// NVIC Init - Error interrupt (master NAK ends read transfers)
 	NVICStruct.NVIC_IRQChannel						=	i2c.INT.ER_CHANNEL;
 
-	//NVIC_Init(&NVICStruct);
+	NVIC_Init(&NVICStruct);
 }
 
-static ErrorStatus _waitEvent (I2C_TypeDef* i2c, uint32_t event)
+static void _stopStream (DMA_Stream_TypeDef * stream)
 {
-	int32_t timeout = I2C_TIMEOUT;
-	ErrorStatus status = ERROR;
+	DMA_Cmd(stream, DISABLE);
 
-	while(timeout > 0)
-	{
-		status = I2C_CheckEvent(i2c, event);
-
-		if(status == SUCCESS)
-		{
-			break;
-		}
-
-		timeout--;
-	}
-
-	return status;
+	while((stream->CR & DMA_SxCR_EN) != 0u)
+	{}
 }
 
 static int32_t _getErrorFromFlag (uint32_t flag)
@@ -207,7 +254,7 @@ namespace HAL
 		}
 		else
 		{
-			_i2cSlave[id] = new I2CSlave(id);
+			_i2cSlave[id] = new (_i2cSlaveStorage.Get(id)) I2CSlave(id);
 
 			return _i2cSlave[id];
 		}
@@ -219,179 +266,339 @@ namespace HAL
 		this->error = 0;
 		this->def = _getI2CStruct(id);
 
-		this->buffer.rdIndex = 0u;
-		this->buffer.wrIndex = 0u;
-		memset(this->buffer.frame, 0, sizeof(this->buffer.frame));
+		this->rxFrame = NULL;
+		this->txActive = false;
+		this->txArmed = false;
+		this->generalCall = false;
+		this->selected = 0u;
+		this->readCallback = NULL;
+		this->readObj = NULL;
+		this->responseCallback = NULL;
+		this->responseObj = NULL;
+		this->crcErrors = 0u;
+		this->overruns = 0u;
+		this->recoveries = 0u;
+		this->bytes = 0u;
+		this->events = 0u;
+		this->supervisedEvents = 0u;
+		this->stuck = 0u;
 
 		_hardwareInit(id);
 	}
 
-	int32_t I2CSlave::Write(I2C_FRAME * frame)
+	void I2CSlave::SetAddress(uint8_t address)
 	{
-		uint32_t i = 0u;
-		int32_t rval = 0;
+		this->def.I2C.SLAVE_ADDR = address;
+
+		// Same layout as I2C_Init() (7-bit acknowledged address)
+		this->def.I2C.BUS->OAR1 = I2C_AcknowledgedAddress_7bit | address;
+	}
+
+	void I2CSlave::SetReadCallback(void * obj, I2C_READ_CALLBACK cb)
+	{
+		this->readObj = obj;
+		this->readCallback = cb;
+	}
+
+	void I2CSlave::SetResponseCallback(void * obj, I2C_RESPONSE_CALLBACK cb)
+	{
+		this->responseObj = obj;
+		this->responseCallback = cb;
+	}
+
+	void I2CSlave::BuildResponse(const void * data, uint32_t length, uint8_t * response)
+	{
+		uint8_t crc = 0u;
+
+		assert(length < I2C_MAX_FRAME_SIZE);
+
+		if(data != response)
+			memcpy(response, data, length);
+
+		// CRC covers address byte (read) and data
+		crc = (uint8_t)((this->def.I2C.SLAVE_ADDR << 1) | 1u);
+		crc = Utils::Crc8(&crc, 1u);
+		crc = Utils::Crc8(response, length, crc);
+
+		response[length++] = crc;
+
+		// Master reading past the response gets padding instead of a stretched bus
+		memset(&response[length], I2C_PADDING_BYTE, I2C_MAX_FRAME_SIZE - length);
+	}
 
+	int32_t	I2CSlave::Read(I2C_FRAME * frame)
+	{
 		assert(frame != NULL);
 
-		portENTER_CRITICAL();
+		if(!this->buffer.Pop(*frame))
+		{
+			return I2C_ERROR_NO_FRAME_BUFFERED;
+		}
+
+		return NO_ERROR;
+	}
+
+	void I2CSlave::startReception()
+	{
+		DMA_Stream_TypeDef * stream = this->def.DMA_RX.STREAM;
+
+		// Frame is received in place, published at end of reception
+		this->rxFrame = this->buffer.Claim();
+
+		// Ring full : frame is received then dropped
+		if(this->rxFrame == NULL)
+			this->rxFrame = &this->scratch;
+
+		this->rxFrame->Type = I2C_FRAME_TYPE_WRITE;
+		this->rxFrame->Length = 0u;
+
+		DMA_ClearFlag(stream, this->def.DMA_RX.FLAGS);
+		stream->M0AR = (uint32_t)this->rxFrame->Data;
+		DMA_SetCurrDataCounter(stream, I2C_MAX_FRAME_SIZE);
+		DMA_Cmd(stream, ENABLE);
+	}
+
+	void I2CSlave::endOfReception()
+	{
+		I2C_FRAME * frame = this->rxFrame;
+		uint32_t length = 0u;
+		bool valid = false;
+		uint8_t crc = 0u;
+
+		if(frame == NULL)
+			return;
+
+		this->rxFrame = NULL;
+
+		_stopStream(this->def.DMA_RX.STREAM);
+
+		length = I2C_MAX_FRAME_SIZE - DMA_GetCurrDataCounter(this->def.DMA_RX.STREAM);
+		this->bytes += length + 1u;
+
+		// At least register and CRC
+		if(length < 2u)
+			return;
 
-		// Disable I2C interrupt to avoid ACK failure interrupt when master will NAK at the end of the transaction
-		I2C_ITConfig(this->def.I2C.BUS, I2C_IT_EVT | I2C_IT_BUF | I2C_IT_ERR, DISABLE);
+#if I2C_HARDWARE_PEC
+		// PEC over address, data and CRC is 0 if valid. A repeated start has already
+		// shifted the next address in (or a general call) : checked in software then
+		valid = (I2C_GetPEC(this->def.I2C.BUS) == 0u);
+#endif
 
-		// Wait read event
-		if(_waitEvent(this->def.I2C.BUS, I2C_EVENT_SLAVE_TRANSMITTER_ADDRESS_MATCHED)!= SUCCESS)
+		if(!valid)
 		{
-			rval = I2C_ERROR_TIMEOUT;
+			// CRC covers address byte (write, 0 on general call) and data
+			crc = this->generalCall ? 0u : (uint8_t)(this->def.I2C.SLAVE_ADDR << 1);
+			crc = Utils::Crc8(&crc, 1u);
+			crc = Utils::Crc8(frame->Data, length - 1u, crc);
+
+			valid = (crc == frame->Data[length - 1u]);
 		}
 
-		if(rval == NO_ERROR)
+		if(!valid)
 		{
-			for(i=0u; i < frame->Length; )
-			{
-				// Send a byte
-				I2C_SendData(this->def.I2C.BUS, frame->Data[i]);
-
-				// Wait byte transmitted event
-				if(_waitEvent(this->def.I2C.BUS, I2C_EVENT_SLAVE_BYTE_TRANSMITTED) != SUCCESS)
-				{
-					rval = I2C_ERROR_SLAVE_SEND_DATA_FAILED;
-					break;
-				}
-				else
-				{
-					i++;	// Byte has been transmitted
-
-					// If last byte, transmit CRC
-					if(i == frame->Length)
-					{
-						I2C_TransmitPEC(this->def.I2C.BUS, ENABLE);
-
-						// Wait NAK
-						_waitEvent(this->def.I2C.BUS, I2C_EVENT_SLAVE_ACK_FAILURE);
-					}
-				}
-
-				rval = i;
-			}
+			this->crcErrors++;
+			this->error = I2C_ERROR_PACKET_ERROR;
+			this->ErrorOccurred();
+			return;
 		}
 
-		// Clear AF bit and re-enable error interrupt
-		I2C_ClearFlag(this->def.I2C.BUS, I2C_FLAG_AF);
-		I2C_ITConfig(this->def.I2C.BUS, I2C_IT_EVT | I2C_IT_BUF | I2C_IT_ERR, ENABLE);
+		frame->Length = length - 1u;
+		frame->CRCval = frame->Data[length - 1u];
 
-		portEXIT_CRITICAL();
+		this->selected = frame->Data[0];
 
-		return rval;
+		// Armed response is the previous register one
+		if(this->txArmed)
+		{
+			this->txArmed = false;
+			_stopStream(this->def.DMA_TX.STREAM);
+		}
+
+		// Register selection only : a read follows, prepare it now
+		if(frame->Length == 1u)
+		{
+			this->armTransmission();
+			return;
+		}
+
+		if(frame == &this->scratch)
+		{
+			this->overruns++;
+			this->error = I2C_ERROR_BUFFER_FULL;
+			this->ErrorOccurred();
+			return;
+		}
+
+		this->buffer.Publish();
+
+		this->error = NO_ERROR;
+		this->DataReceived();
 	}
 
-	int32_t	I2CSlave::Read(I2C_FRAME * frame)
+	void I2CSlave::armTransmission()
 	{
-		int32_t error = 0;
+		DMA_Stream_TypeDef * stream = this->def.DMA_TX.STREAM;
+		const uint8_t * response = NULL;
 
-		assert(frame != NULL);
+		if(this->responseCallback != NULL)
+			response = this->responseCallback(this->responseObj, this->selected);
 
-		if(this->buffer.wrIndex >= this->buffer.rdIndex)
-		{
-			memcpy(frame, &this->buffer.frame[this->buffer.rdIndex], sizeof(this->buffer.frame[this->buffer.rdIndex]));
+		// Built on request (current data)
+		if(response == NULL)
+			return;
 
-			this->buffer.rdIndex++;
+		// Stream waits for the first TXE request (read address match)
+		DMA_ClearFlag(stream, this->def.DMA_TX.FLAGS);
+		stream->M0AR = (uint32_t)response;
+		DMA_SetCurrDataCounter(stream, I2C_MAX_FRAME_SIZE);
+		DMA_Cmd(stream, ENABLE);
 
-			// If all buffered frame read, clear indexes
-			if(this->buffer.rdIndex >= this->buffer.wrIndex)
-			{
-				this->buffer.rdIndex = 0u;
-				this->buffer.wrIndex = 0u;
-			}
+		this->txArmed = true;
+	}
 
-			this->error = NO_ERROR;
+	void I2CSlave::startTransmission()
+	{
+		DMA_Stream_TypeDef * stream = this->def.DMA_TX.STREAM;
+		const uint8_t * response = NULL;
+		uint32_t length = 0u;
+
+		this->txActive = true;
+
+		if(this->txArmed)
+		{
+			this->txArmed = false;
+			this->DataRequest();
+			return;
 		}
-		else
+
+		if(this->responseCallback != NULL)
+			response = this->responseCallback(this->responseObj, this->selected);
+
+		if(response == NULL)
 		{
-			error = I2C_ERROR_NO_FRAME_BUFFERED;
+			if(this->readCallback != NULL)
+				length = this->readCallback(this->readObj, this->selected, this->txData, I2C_MAX_FRAME_SIZE - 1u);
+
+			this->BuildResponse(this->txData, length, this->txData);
+			response = this->txData;
 		}
 
-		return error;
+		DMA_ClearFlag(stream, this->def.DMA_TX.FLAGS);
+		stream->M0AR = (uint32_t)response;
+		DMA_SetCurrDataCounter(stream, I2C_MAX_FRAME_SIZE);
+		DMA_Cmd(stream, ENABLE);
+
+		this->DataRequest();
 	}
 
-	void I2CSlave::INTERNAL_InterruptCallback(uint32_t flag)
+	void I2CSlave::endOfTransmission()
 	{
-		uint8_t data = 0u;
+		if(this->txActive == false)
+			return;
 
-		switch(flag)
-		{
-		// Address matched, store a new frame
-		case I2C_FLAG_ADDR:
-			if(this->buffer.wrIndex < (I2C_MAX_BUFFER_SIZE - 1u))
-			{
-				this->buffer.frame[this->buffer.wrIndex].Type 	=	(I2C_GetFlagStatus(this->def.I2C.BUS, I2C_FLAG_TRA) == SET ? I2C_FRAME_TYPE_READ : I2C_FRAME_TYPE_WRITE);
-				this->buffer.frame[this->buffer.wrIndex].Length = 	0u;
+		this->txActive = false;
 
-				this->prevCRC = 0u;
-				this->curCRC = I2C_GetPEC(this->def.I2C.BUS);
+		// Last loaded byte may not have been clocked out (master NACK)
+		this->bytes += I2C_MAX_FRAME_SIZE - DMA_GetCurrDataCounter(this->def.DMA_TX.STREAM) + 1u;
 
-				if(this->buffer.frame[this->buffer.wrIndex].Type == I2C_FRAME_TYPE_READ)
-				{
-					I2C_ITConfig(this->def.I2C.BUS, I2C_IT_BUF, DISABLE);
+		_stopStream(this->def.DMA_TX.STREAM);
+	}
 
-					this->DataRequest();
-				}
-				else
-				{
-					I2C_ITConfig(this->def.I2C.BUS, I2C_IT_BUF, ENABLE);
-				}
+	void I2CSlave::recover()
+	{
+		// Frame being received is dropped (claimed slot is claimed again)
+		this->rxFrame = NULL;
+		this->txActive = false;
+		this->txArmed = false;
+		this->stuck = 0u;
 
-			}
-			else
-			{
-				// drop frame
-			}
-			break;
+		_stopStream(this->def.DMA_RX.STREAM);
+		_stopStream(this->def.DMA_TX.STREAM);
 
-		// Data received, store it
-		case I2C_FLAG_RXNE:
-			data = I2C_ReceiveData(this->def.I2C.BUS);
+		// Lines released, registers cleared : configure again (current address)
+		I2C_SoftwareResetCmd(this->def.I2C.BUS, ENABLE);
+		I2C_SoftwareResetCmd(this->def.I2C.BUS, DISABLE);
+		_busInit(this->def);
 
-			if(this->buffer.wrIndex < (I2C_MAX_BUFFER_SIZE - 1u))
-			{
-				this->buffer.frame[this->buffer.wrIndex].Data[this->buffer.frame[this->buffer.wrIndex].Length] = data;
+		this->recoveries++;
+	}
 
-				this->buffer.frame[this->buffer.wrIndex].Length++;
+	void I2CSlave::Supervise()
+	{
+		uint32_t events = this->events;
+		bool busy = (I2C_GetFlagStatus(this->def.I2C.BUS, I2C_FLAG_BUSY) == SET);
 
-				this->prevCRC = this->curCRC;
-				this->curCRC = I2C_GetPEC(this->def.I2C.BUS);
-			}
+		// Master gone in the middle of a transfer : SDA may be held low
+		if(busy && (events == this->supervisedEvents))
+			this->stuck++;
+		else
+			this->stuck = 0u;
+
+		this->supervisedEvents = events;
+
+		if(this->stuck < I2C_STUCK_CHECKS)
+			return;
+
+		NVIC_DisableIRQ(this->def.INT.EV_CHANNEL);
+		NVIC_DisableIRQ(this->def.INT.ER_CHANNEL);
+
+		this->recover();
+
+		NVIC_EnableIRQ(this->def.INT.EV_CHANNEL);
+		NVIC_EnableIRQ(this->def.INT.ER_CHANNEL);
+	}
+
+	void I2CSlave::INTERNAL_InterruptCallback(uint32_t flag)
+	{
+		this->events++;
+
+		switch(flag)
+		{
+		// Address matched (a repeated start ends the previous write)
+		case I2C_FLAG_ADDR:
+		case I2C_FLAG_GENCALL:
+			this->endOfReception();
+			this->endOfTransmission();
+
+			this->generalCall = (flag == I2C_FLAG_GENCALL);
+
+			if(I2C_GetFlagStatus(this->def.I2C.BUS, I2C_FLAG_TRA) == SET)
+				this->startTransmission();
 			else
-			{
-				// drop frame
-			}
+				this->startReception();
 			break;
 
-		// Frame ended, raise event
+		// Frame ended
 		case I2C_FLAG_STOPF:
-			if(this->buffer.wrIndex < (I2C_MAX_BUFFER_SIZE - 1u))
-			{
-				this->buffer.frame[this->buffer.wrIndex].CRCval = this->prevCRC;
-				this->buffer.wrIndex++;
-
-				this->error = NO_ERROR;
+			this->endOfReception();
+			this->endOfTransmission();
+			break;
 
-				if(this->buffer.frame[this->buffer.wrIndex - 1u].Type == I2C_FRAME_TYPE_WRITE)
-				{
-					this->DataReceived();
-				}
-			}
-			else
+		// Master NAK is the normal end of a read transfer
+		case I2C_FLAG_AF:
+			if(this->txActive)
 			{
-				// drop frame
+				this->endOfTransmission();
+				break;
 			}
+			this->error = _getErrorFromFlag(flag);
+			this->ErrorOccurred();
 			break;
 
-		// Error management
+		// Misplaced start/stop or overrun : state machine is lost, reset it
 		case I2C_FLAG_BERR:
-		case I2C_FLAG_AF:
 		case I2C_FLAG_OVR :
+			this->recover();
+			this->error = _getErrorFromFlag(flag);
+			this->ErrorOccurred();
+			break;
+
+		// Error management
 		case I2C_FLAG_PECERR :
 		case I2C_FLAG_TIMEOUT:
+			this->endOfReception();
+			this->endOfTransmission();
 			this->error = _getErrorFromFlag(flag);
 			this->ErrorOccurred();
 			break;
@@ -413,15 +620,9 @@ extern "C"
 		if(I2C_GetFlagStatus(I2C3, I2C_FLAG_ADDR) == SET)
 		{
 			// SR2 must be read to clear ADDR flag in SR1
-			I2C_ReadRegister(I2C3, I2C_Register_SR2);
+			uint16_t sr2 = I2C_ReadRegister(I2C3, I2C_Register_SR2);
 
-			instance->INTERNAL_InterruptCallback(I2C_FLAG_ADDR);
-		}
-
-		// Byte transfer finished
-		if(I2C_GetFlagStatus(I2C3, I2C_FLAG_RXNE) == SET)
-		{
-			instance->INTERNAL_InterruptCallback(I2C_FLAG_RXNE);
+			instance->INTERNAL_InterruptCallback(((sr2 & I2C_SR2_GENCALL) != 0u) ? I2C_FLAG_GENCALL : I2C_FLAG_ADDR);
 		}
 
 		// Stop bit received
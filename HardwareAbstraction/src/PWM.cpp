@@ -7,6 +7,7 @@
 
 #include <stddef.h>
 #include "PWM.hpp"
+#include "StaticStorage.hpp"
 #include "common.h"
 
 using namespace HAL;
@@ -15,6 +16,9 @@ using namespace HAL;
 /* Definitions                                                                */
 /*----------------------------------------------------------------------------*/
 
+// Core clock (SystemCoreClock at reset), a constant keeps PWM definitions in flash
+#define PWM_CORE_FREQ		(180000000u)
+
 // TIM1_CH1
 #define PWM0_IO_PORT		(GPIOE)
 #define PWM0_IO_PIN			(GPIO_Pin_9)
@@ -24,7 +28,7 @@ using namespace HAL;
 #define PWM0_DUTYCYCLE		(0.5f)
 #define PWM0_TIMER			(TIM1)
 #define PWM0_TIMER_CHANNEL	(TIM_Channel_1)
-#define PWM0_TIMER_FREQ		(SystemCoreClock)	// TIM2 clock is derivated from APB2 clock
+#define PWM0_TIMER_FREQ		(PWM_CORE_FREQ)	// TIM2 clock is derivated from APB2 clock
 
 // TIM1_CH2
 #define PWM1_IO_PORT		(GPIOE)
@@ -35,7 +39,7 @@ using namespace HAL;
 #define PWM1_DUTYCYCLE		(0.5f)
 #define PWM1_TIMER			(TIM1)
 #define PWM1_TIMER_CHANNEL	(TIM_Channel_2)
-#define PWM1_TIMER_FREQ		(SystemCoreClock)	// TIM2 clock is derivated from APB2 clock
+#define PWM1_TIMER_FREQ		(PWM_CORE_FREQ)	// TIM2 clock is derivated from APB2 clock
 
 // TIM1_CH3
 #define PWM2_IO_PORT		(GPIOE)
@@ -46,7 +50,7 @@ using namespace HAL;
 #define PWM2_DUTYCYCLE		(0.5f)
 #define PWM2_TIMER			(TIM1)
 #define PWM2_TIMER_CHANNEL	(TIM_Channel_3)
-#define PWM2_TIMER_FREQ		(SystemCoreClock)	// TIM2 clock is derivated from APB2 clock
+#define PWM2_TIMER_FREQ		(PWM_CORE_FREQ)	// TIM2 clock is derivated from APB2 clock
 
 // TIM1_CH4
 #define PWM3_IO_PORT		(GPIOE)
@@ -57,7 +61,7 @@ using namespace HAL;
 #define PWM3_DUTYCYCLE		(0.5f)
 #define PWM3_TIMER			(TIM1)
 #define PWM3_TIMER_CHANNEL	(TIM_Channel_4)
-#define PWM3_TIMER_FREQ		(SystemCoreClock)	// TIM2 clock is derivated from APB2 clock
+#define PWM3_TIMER_FREQ		(PWM_CORE_FREQ)	// TIM2 clock is derivated from APB2 clock
 
 // TIM2_CH1
 #define PWM4_IO_PORT		(GPIOA)
@@ -68,7 +72,7 @@ using namespace HAL;
 #define PWM4_DUTYCYCLE		(0.5f)
 #define PWM4_TIMER			(TIM2)
 #define PWM4_TIMER_CHANNEL	(TIM_Channel_1)
-#define PWM4_TIMER_FREQ		(SystemCoreClock / 2)	// TIM2 clock is derivated from APB1 clock
+#define PWM4_TIMER_FREQ		(PWM_CORE_FREQ / 2)	// TIM2 clock is derivated from APB1 clock
 
 // TIM2_CH2
 #define PWM5_IO_PORT		(GPIOB)
@@ -79,7 +83,7 @@ using namespace HAL;
 #define PWM5_DUTYCYCLE		(0.5f)
 #define PWM5_TIMER			(TIM2)
 #define PWM5_TIMER_CHANNEL	(TIM_Channel_2)
-#define PWM5_TIMER_FREQ		(SystemCoreClock / 2)	// TIM2 clock is derivated from APB1 clock
+#define PWM5_TIMER_FREQ		(PWM_CORE_FREQ / 2)	// TIM2 clock is derivated from APB1 clock
 
 // TIM2_CH3
 #define PWM6_IO_PORT		(GPIOB)
@@ -90,7 +94,7 @@ using namespace HAL;
 #define PWM6_DUTYCYCLE		(0.5f)
 #define PWM6_TIMER			(TIM2)
 #define PWM6_TIMER_CHANNEL	(TIM_Channel_3)
-#define PWM6_TIMER_FREQ		(SystemCoreClock / 2)	// TIM2 clock is derivated from APB1 clock
+#define PWM6_TIMER_FREQ		(PWM_CORE_FREQ / 2)	// TIM2 clock is derivated from APB1 clock
 
 // TIM2_CH4
 #define PWM7_IO_PORT		(GPIOB)
@@ -101,7 +105,7 @@ using namespace HAL;
 #define PWM7_DUTYCYCLE		(0.5f)
 #define PWM7_TIMER			(TIM2)
 #define PWM7_TIMER_CHANNEL	(TIM_Channel_4)
-#define PWM7_TIMER_FREQ		(SystemCoreClock / 2)	// TIM2 clock is derivated from APB1 clock
+#define PWM7_TIMER_FREQ		(PWM_CORE_FREQ / 2)	// TIM2 clock is derivated from APB1 clock
 
 // TIM3_CH1
 #define PWM8_IO_PORT		(GPIOC)
@@ -112,7 +116,7 @@ using namespace HAL;
 #define PWM8_DUTYCYCLE		(0.5f)
 #define PWM8_TIMER			(TIM3)
 #define PWM8_TIMER_CHANNEL	(TIM_Channel_1)
-#define PWM8_TIMER_FREQ		(SystemCoreClock / 2)	// TIM2 clock is derivated from APB1 clock
+#define PWM8_TIMER_FREQ		(PWM_CORE_FREQ / 2)	// TIM2 clock is derivated from APB1 clock
 
 // TIM3_CH2
 #define PWM9_IO_PORT		(GPIOC)
@@ -123,7 +127,7 @@ using namespace HAL;
 #define PWM9_DUTYCYCLE		(0.5f)
 #define PWM9_TIMER			(TIM3)
 #define PWM9_TIMER_CHANNEL	(TIM_Channel_2)
-#define PWM9_TIMER_FREQ		(SystemCoreClock / 2)	// TIM2 clock is derivated from APB1 clock
+#define PWM9_TIMER_FREQ		(PWM_CORE_FREQ / 2)	// TIM2 clock is derivated from APB1 clock
 
 // TIM3_CH3
 #define PWM10_IO_PORT		(GPIOC)
@@ -134,7 +138,7 @@ using namespace HAL;
 #define PWM10_DUTYCYCLE		(0.5f)
 #define PWM10_TIMER			(TIM3)
 #define PWM10_TIMER_CHANNEL	(TIM_Channel_3)
-#define PWM10_TIMER_FREQ	(SystemCoreClock / 2)	// TIM2 clock is derivated from APB1 clock
+#define PWM10_TIMER_FREQ	(PWM_CORE_FREQ / 2)	// TIM2 clock is derivated from APB1 clock
 
 // TIM3_CH4
 #define PWM11_IO_PORT		(GPIOC)
@@ -145,7 +149,7 @@ using namespace HAL;
 #define PWM11_DUTYCYCLE		(0.5f)
 #define PWM11_TIMER			(TIM3)
 #define PWM11_TIMER_CHANNEL	(TIM_Channel_4)
-#define PWM11_TIMER_FREQ	(SystemCoreClock / 2)	// TIM2 clock is derivated from APB1 clock
+#define PWM11_TIMER_FREQ	(PWM_CORE_FREQ / 2)	// TIM2 clock is derivated from APB1 clock
 
 // TIM4_CH1
 #define PWM12_IO_PORT		(GPIOD)
@@ -156,7 +160,7 @@ using namespace HAL;
 #define PWM12_DUTYCYCLE		(0.5f)
 #define PWM12_TIMER			(TIM4)
 #define PWM12_TIMER_CHANNEL	(TIM_Channel_1)
-#define PWM12_TIMER_FREQ	(SystemCoreClock / 2)	// TIM2 clock is derivated from APB1 clock
+#define PWM12_TIMER_FREQ	(PWM_CORE_FREQ / 2)	// TIM2 clock is derivated from APB1 clock
 
 // TIM4_CH2
 #define PWM13_IO_PORT		(GPIOD)
@@ -167,7 +171,7 @@ using namespace HAL;
 #define PWM13_DUTYCYCLE		(0.5f)
 #define PWM13_TIMER			(TIM4)
 #define PWM13_TIMER_CHANNEL	(TIM_Channel_2)
-#define PWM13_TIMER_FREQ	(SystemCoreClock / 2)	// TIM2 clock is derivated from APB1 clock
+#define PWM13_TIMER_FREQ	(PWM_CORE_FREQ / 2)	// TIM2 clock is derivated from APB1 clock
 
 // TIM4_CH3
 #define PWM14_IO_PORT		(GPIOD)
@@ -178,7 +182,7 @@ using namespace HAL;
 #define PWM14_DUTYCYCLE		(0.5f)
 #define PWM14_TIMER			(TIM4)
 #define PWM14_TIMER_CHANNEL	(TIM_Channel_3)
-#define PWM14_TIMER_FREQ	(SystemCoreClock / 2)	// TIM2 clock is derivated from APB1 clock
+#define PWM14_TIMER_FREQ	(PWM_CORE_FREQ / 2)	// TIM2 clock is derivated from APB1 clock
 
 // TIM4_CH4
 #define PWM15_IO_PORT		(GPIOD)
@@ -189,7 +193,7 @@ using namespace HAL;
 #define PWM15_DUTYCYCLE		(0.5f)
 #define PWM15_TIMER			(TIM4)
 #define PWM15_TIMER_CHANNEL	(TIM_Channel_4)
-#define PWM15_TIMER_FREQ	(SystemCoreClock / 2)	// TIM2 clock is derivated from APB1 clock
+#define PWM15_TIMER_FREQ	(PWM_CORE_FREQ / 2)	// TIM2 clock is derivated from APB1 clock
 
 // TIM5_CH1
 #define PWM16_IO_PORT		(GPIOA)
@@ -200,7 +204,7 @@ using namespace HAL;
 #define PWM16_DUTYCYCLE		(0.5f)
 #define PWM16_TIMER			(TIM5)
 #define PWM16_TIMER_CHANNEL	(TIM_Channel_1)
-#define PWM16_TIMER_FREQ	(SystemCoreClock / 2)	// TIM2 clock is derivated from APB1 clock
+#define PWM16_TIMER_FREQ	(PWM_CORE_FREQ / 2)	// TIM2 clock is derivated from APB1 clock
 
 // TIM5_CH2
 #define PWM17_IO_PORT		(GPIOA)
@@ -211,7 +215,7 @@ using namespace HAL;
 #define PWM17_DUTYCYCLE		(0.5f)
 #define PWM17_TIMER			(TIM5)
 #define PWM17_TIMER_CHANNEL	(TIM_Channel_2)
-#define PWM17_TIMER_FREQ	(SystemCoreClock / 2)	// TIM2 clock is derivated from APB1 clock
+#define PWM17_TIMER_FREQ	(PWM_CORE_FREQ / 2)	// TIM2 clock is derivated from APB1 clock
 
 // TIM5_CH3
 #define PWM18_IO_PORT		(GPIOA)
@@ -222,7 +226,7 @@ using namespace HAL;
 #define PWM18_DUTYCYCLE		(0.5f)
 #define PWM18_TIMER			(TIM5)
 #define PWM18_TIMER_CHANNEL	(TIM_Channel_3)
-#define PWM18_TIMER_FREQ	(SystemCoreClock / 2)	// TIM2 clock is derivated from APB1 clock
+#define PWM18_TIMER_FREQ	(PWM_CORE_FREQ / 2)	// TIM2 clock is derivated from APB1 clock
 
 // TIM5_CH4
 #define PWM19_IO_PORT		(GPIOA)
@@ -233,7 +237,7 @@ using namespace HAL;
 #define PWM19_DUTYCYCLE		(0.5f)
 #define PWM19_TIMER			(TIM5)
 #define PWM19_TIMER_CHANNEL	(TIM_Channel_4)
-#define PWM19_TIMER_FREQ	(SystemCoreClock / 2)	// TIM2 clock is derivated from APB1 clock
+#define PWM19_TIMER_FREQ	(PWM_CORE_FREQ / 2)	// TIM2 clock is derivated from APB1 clock
 
 // TIM9_CH1
 #define PWM20_IO_PORT		(GPIOE)
@@ -244,7 +248,7 @@ using namespace HAL;
 #define PWM20_DUTYCYCLE		(0.5f)
 #define PWM20_TIMER			(TIM9)
 #define PWM20_TIMER_CHANNEL	(TIM_Channel_1)
-#define PWM20_TIMER_FREQ	(SystemCoreClock)	// TIM2 clock is derivated from APB2 clock
+#define PWM20_TIMER_FREQ	(PWM_CORE_FREQ)	// TIM2 clock is derivated from APB2 clock
 
 // TIM9_CH2
 #define PWM21_IO_PORT		(GPIOE)
@@ -255,7 +259,7 @@ using namespace HAL;
 #define PWM21_DUTYCYCLE		(0.5f)
 #define PWM21_TIMER			(TIM9)
 #define PWM21_TIMER_CHANNEL	(TIM_Channel_2)
-#define PWM21_TIMER_FREQ	(SystemCoreClock)	// TIM2 clock is derivated from APB2 clock
+#define PWM21_TIMER_FREQ	(PWM_CORE_FREQ)	// TIM2 clock is derivated from APB2 clock
 
 // TIM10_CH1
 #define PWM22_IO_PORT		(GPIOF)
@@ -266,7 +270,7 @@ using namespace HAL;
 #define PWM22_DUTYCYCLE		(0.5f)
 #define PWM22_TIMER			(TIM10)
 #define PWM22_TIMER_CHANNEL	(TIM_Channel_1)
-#define PWM22_TIMER_FREQ	(SystemCoreClock)	// TIM2 clock is derivated from APB2 clock
+#define PWM22_TIMER_FREQ	(PWM_CORE_FREQ)	// TIM2 clock is derivated from APB2 clock
 
 // TIM11_CH1
 #define PWM23_IO_PORT		(GPIOF)
@@ -277,7 +281,7 @@ using namespace HAL;
 #define PWM23_DUTYCYCLE		(0.5f)
 #define PWM23_TIMER			(TIM11)
 #define PWM23_TIMER_CHANNEL	(TIM_Channel_1)
-#define PWM23_TIMER_FREQ	(SystemCoreClock)	// TIM2 clock is derivated from APB2 clock
+#define PWM23_TIMER_FREQ	(PWM_CORE_FREQ)	// TIM2 clock is derivated from APB2 clock
 
 // TIM12_CH1
 #define PWM24_IO_PORT		(GPIOB)
@@ -288,7 +292,7 @@ using namespace HAL;
 #define PWM24_DUTYCYCLE		(0.5f)
 #define PWM24_TIMER			(TIM12)
 #define PWM24_TIMER_CHANNEL	(TIM_Channel_2)
-#define PWM24_TIMER_FREQ	(SystemCoreClock / 2)	// TIM2 clock is derivated from APB1 clock
+#define PWM24_TIMER_FREQ	(PWM_CORE_FREQ / 2)	// TIM2 clock is derivated from APB1 clock
 
 // TIM12_CH2
 #define PWM25_IO_PORT		(GPIOB)
@@ -299,7 +303,7 @@ using namespace HAL;
 #define PWM25_DUTYCYCLE		(0.5f)
 #define PWM25_TIMER			(TIM12)
 #define PWM25_TIMER_CHANNEL	(TIM_Channel_1)
-#define PWM25_TIMER_FREQ	(SystemCoreClock / 2)	// TIM2 clock is derivated from APB1 clock
+#define PWM25_TIMER_FREQ	(PWM_CORE_FREQ / 2)	// TIM2 clock is derivated from APB1 clock
 
 
 // TIM13_CH1
@@ -311,7 +315,7 @@ using namespace HAL;
 #define PWM26_DUTYCYCLE		(0.5f)
 #define PWM26_TIMER			(TIM13)
 #define PWM26_TIMER_CHANNEL	(TIM_Channel_1)
-#define PWM26_TIMER_FREQ	(SystemCoreClock / 2)	// TIM2 clock is derivated from APB1 clock
+#define PWM26_TIMER_FREQ	(PWM_CORE_FREQ / 2)	// TIM2 clock is derivated from APB1 clock
 
 // TIM14_CH1
 #define PWM27_IO_PORT		(GPIOF)
@@ -322,7 +326,7 @@ using namespace HAL;
 #define PWM27_DUTYCYCLE		(0.5f)
 #define PWM27_TIMER			(TIM14)
 #define PWM27_TIMER_CHANNEL	(TIM_Channel_1)
-#define PWM27_TIMER_FREQ	(SystemCoreClock / 2)	// TIM2 clock is derivated from APB1 clock
+#define PWM27_TIMER_FREQ	(PWM_CORE_FREQ / 2)	// TIM2 clock is derivated from APB1 clock
 
 
 
@@ -335,10 +339,217 @@ using namespace HAL;
  */
 static PWM* _pwm[PWM::PWM_MAX] = {NULL};
 
+/**
+ * @brief PWM instances storage
+ */
+static Utils::StaticStorage<PWM, PWM::PWM_MAX> _pwmStorage;
+
 /*----------------------------------------------------------------------------*/
 /* Private Functions                                                          */
 /*----------------------------------------------------------------------------*/
 
+/**
+ * @brief PWM definitions (flash), indexed by PWM ID
+ */
+static const PWM_DEF _pwmDefs[HAL::PWM::PWM_MAX] =
+{
+	// PWM0
+	{
+		{PWM0_IO_PORT, PWM0_IO_PIN, PWM0_IO_PINSOURCE, PWM0_IO_AF},		// IO
+		{PWM0_TIMER, PWM0_TIMER_CHANNEL, PWM0_TIMER_FREQ},				// TIMER
+		{PWM0_FREQ, PWM0_DUTYCYCLE},									// PWM
+	},
+
+	// PWM1
+	{
+		{PWM1_IO_PORT, PWM1_IO_PIN, PWM1_IO_PINSOURCE, PWM1_IO_AF},		// IO
+		{PWM1_TIMER, PWM1_TIMER_CHANNEL, PWM1_TIMER_FREQ},				// TIMER
+		{PWM1_FREQ, PWM1_DUTYCYCLE},									// PWM
+	},
+
+	// PWM2
+	{
+		{PWM2_IO_PORT, PWM2_IO_PIN, PWM2_IO_PINSOURCE, PWM2_IO_AF},		// IO
+		{PWM2_TIMER, PWM2_TIMER_CHANNEL, PWM2_TIMER_FREQ},				// TIMER
+		{PWM2_FREQ, PWM2_DUTYCYCLE},									// PWM
+	},
+
+	// PWM3
+	{
+		{PWM3_IO_PORT, PWM3_IO_PIN, PWM3_IO_PINSOURCE, PWM3_IO_AF},		// IO
+		{PWM3_TIMER, PWM3_TIMER_CHANNEL, PWM3_TIMER_FREQ},				// TIMER
+		{PWM3_FREQ, PWM3_DUTYCYCLE},									// PWM
+	},
+
+	// PWM4
+	{
+		{PWM4_IO_PORT, PWM4_IO_PIN, PWM4_IO_PINSOURCE, PWM4_IO_AF},		// IO
+		{PWM4_TIMER, PWM4_TIMER_CHANNEL, PWM4_TIMER_FREQ},				// TIMER
+		{PWM4_FREQ, PWM4_DUTYCYCLE},									// PWM
+	},
+
+	// PWM5
+	{
+		{PWM5_IO_PORT, PWM5_IO_PIN, PWM5_IO_PINSOURCE, PWM5_IO_AF},		// IO
+		{PWM5_TIMER, PWM5_TIMER_CHANNEL, PWM5_TIMER_FREQ},				// TIMER
+		{PWM5_FREQ, PWM5_DUTYCYCLE},									// PWM
+	},
+
+	// PWM6
+	{
+		{PWM6_IO_PORT, PWM6_IO_PIN, PWM6_IO_PINSOURCE, PWM6_IO_AF},		// IO
+		{PWM6_TIMER, PWM6_TIMER_CHANNEL, PWM6_TIMER_FREQ},				// TIMER
+		{PWM6_FREQ, PWM6_DUTYCYCLE},									// PWM
+	},
+
+	// PWM7
+	{
+		{PWM7_IO_PORT, PWM7_IO_PIN, PWM7_IO_PINSOURCE, PWM7_IO_AF},		// IO
+		{PWM7_TIMER, PWM7_TIMER_CHANNEL, PWM7_TIMER_FREQ},				// TIMER
+		{PWM7_FREQ, PWM7_DUTYCYCLE},									// PWM
+	},
+
+	// PWM8
+	{
+		{PWM8_IO_PORT, PWM8_IO_PIN, PWM8_IO_PINSOURCE, PWM8_IO_AF},		// IO
+		{PWM8_TIMER, PWM8_TIMER_CHANNEL, PWM8_TIMER_FREQ},				// TIMER
+		{PWM8_FREQ, PWM8_DUTYCYCLE},									// PWM
+	},
+
+	// PWM9
+	{
+		{PWM9_IO_PORT, PWM9_IO_PIN, PWM9_IO_PINSOURCE, PWM9_IO_AF},		// IO
+		{PWM9_TIMER, PWM9_TIMER_CHANNEL, PWM9_TIMER_FREQ},				// TIMER
+		{PWM9_FREQ, PWM9_DUTYCYCLE},									// PWM
+	},
+
+	// PWM10
+	{
+		{PWM10_IO_PORT, PWM10_IO_PIN, PWM10_IO_PINSOURCE, PWM10_IO_AF},		// IO
+		{PWM10_TIMER, PWM10_TIMER_CHANNEL, PWM10_TIMER_FREQ},				// TIMER
+		{PWM10_FREQ, PWM10_DUTYCYCLE},										// PWM
+	},
+
+	// PWM11
+	{
+		{PWM11_IO_PORT, PWM11_IO_PIN, PWM11_IO_PINSOURCE, PWM11_IO_AF},		// IO
+		{PWM11_TIMER, PWM11_TIMER_CHANNEL, PWM11_TIMER_FREQ},				// TIMER
+		{PWM11_FREQ, PWM11_DUTYCYCLE},										// PWM
+	},
+
+	// PWM12
+	{
+		{PWM12_IO_PORT, PWM12_IO_PIN, PWM12_IO_PINSOURCE, PWM12_IO_AF},		// IO
+		{PWM12_TIMER, PWM12_TIMER_CHANNEL, PWM12_TIMER_FREQ},				// TIMER
+		{PWM12_FREQ, PWM12_DUTYCYCLE},										// PWM
+	},
+
+	// PWM13
+	{
+		{PWM13_IO_PORT, PWM13_IO_PIN, PWM13_IO_PINSOURCE, PWM13_IO_AF},		// IO
+		{PWM13_TIMER, PWM13_TIMER_CHANNEL, PWM13_TIMER_FREQ},				// TIMER
+		{PWM13_FREQ, PWM13_DUTYCYCLE},										// PWM
+	},
+
+	// PWM14
+	{
+		{PWM14_IO_PORT, PWM14_IO_PIN, PWM14_IO_PINSOURCE, PWM14_IO_AF},		// IO
+		{PWM14_TIMER, PWM14_TIMER_CHANNEL, PWM14_TIMER_FREQ},				// TIMER
+		{PWM14_FREQ, PWM14_DUTYCYCLE},										// PWM
+	},
+
+	// PWM15
+	{
+		{PWM15_IO_PORT, PWM15_IO_PIN, PWM15_IO_PINSOURCE, PWM15_IO_AF},		// IO
+		{PWM15_TIMER, PWM15_TIMER_CHANNEL, PWM15_TIMER_FREQ},				// TIMER
+		{PWM15_FREQ, PWM15_DUTYCYCLE},										// PWM
+	},
+
+	// PWM16
+	{
+		{PWM16_IO_PORT, PWM16_IO_PIN, PWM16_IO_PINSOURCE, PWM16_IO_AF},		// IO
+		{PWM16_TIMER, PWM16_TIMER_CHANNEL, PWM16_TIMER_FREQ},				// TIMER
+		{PWM16_FREQ, PWM16_DUTYCYCLE},										// PWM
+	},
+
+	// PWM17
+	{
+		{PWM17_IO_PORT, PWM17_IO_PIN, PWM17_IO_PINSOURCE, PWM17_IO_AF},		// IO
+		{PWM17_TIMER, PWM17_TIMER_CHANNEL, PWM17_TIMER_FREQ},				// TIMER
+		{PWM17_FREQ, PWM17_DUTYCYCLE},										// PWM
+	},
+
+	// PWM18
+	{
+		{PWM18_IO_PORT, PWM18_IO_PIN, PWM18_IO_PINSOURCE, PWM18_IO_AF},		// IO
+		{PWM18_TIMER, PWM18_TIMER_CHANNEL, PWM18_TIMER_FREQ},				// TIMER
+		{PWM18_FREQ, PWM18_DUTYCYCLE},										// PWM
+	},
+
+	// PWM19
+	{
+		{PWM19_IO_PORT, PWM19_IO_PIN, PWM19_IO_PINSOURCE, PWM19_IO_AF},		// IO
+		{PWM19_TIMER, PWM19_TIMER_CHANNEL, PWM19_TIMER_FREQ},				// TIMER
+		{PWM19_FREQ, PWM19_DUTYCYCLE},										// PWM
+	},
+
+	// PWM20
+	{
+		{PWM20_IO_PORT, PWM20_IO_PIN, PWM20_IO_PINSOURCE, PWM20_IO_AF},		// IO
+		{PWM20_TIMER, PWM20_TIMER_CHANNEL, PWM20_TIMER_FREQ},				// TIMER
+		{PWM20_FREQ, PWM20_DUTYCYCLE},										// PWM
+	},
+
+	// PWM21
+	{
+		{PWM21_IO_PORT, PWM21_IO_PIN, PWM21_IO_PINSOURCE, PWM21_IO_AF},		// IO
+		{PWM21_TIMER, PWM21_TIMER_CHANNEL, PWM21_TIMER_FREQ},				// TIMER
+		{PWM21_FREQ, PWM21_DUTYCYCLE},										// PWM
+	},
+
+	// PWM22
+	{
+		{PWM22_IO_PORT, PWM22_IO_PIN, PWM22_IO_PINSOURCE, PWM22_IO_AF},		// IO
+		{PWM22_TIMER, PWM22_TIMER_CHANNEL, PWM22_TIMER_FREQ},				// TIMER
+		{PWM22_FREQ, PWM22_DUTYCYCLE},										// PWM
+	},
+
+	// PWM23
+	{
+		{PWM23_IO_PORT, PWM23_IO_PIN, PWM23_IO_PINSOURCE, PWM23_IO_AF},		// IO
+		{PWM23_TIMER, PWM23_TIMER_CHANNEL, PWM23_TIMER_FREQ},				// TIMER
+		{PWM23_FREQ, PWM23_DUTYCYCLE},										// PWM
+	},
+
+	// PWM24
+	{
+		{PWM24_IO_PORT, PWM24_IO_PIN, PWM24_IO_PINSOURCE, PWM24_IO_AF},		// IO
+		{PWM24_TIMER, PWM24_TIMER_CHANNEL, PWM24_TIMER_FREQ},				// TIMER
+		{PWM24_FREQ, PWM24_DUTYCYCLE},										// PWM
+	},
+
+	// PWM25
+	{
+		{PWM25_IO_PORT, PWM25_IO_PIN, PWM25_IO_PINSOURCE, PWM25_IO_AF},		// IO
+		{PWM25_TIMER, PWM25_TIMER_CHANNEL, PWM25_TIMER_FREQ},				// TIMER
+		{PWM25_FREQ, PWM25_DUTYCYCLE},										// PWM
+	},
+
+	// PWM26
+	{
+		{PWM26_IO_PORT, PWM26_IO_PIN, PWM26_IO_PINSOURCE, PWM26_IO_AF},		// IO
+		{PWM26_TIMER, PWM26_TIMER_CHANNEL, PWM26_TIMER_FREQ},				// TIMER
+		{PWM26_FREQ, PWM26_DUTYCYCLE},										// PWM
+	},
+
+	// PWM27
+	{
+		{PWM27_IO_PORT, PWM27_IO_PIN, PWM27_IO_PINSOURCE, PWM27_IO_AF},		// IO
+		{PWM27_TIMER, PWM27_TIMER_CHANNEL, PWM27_TIMER_FREQ},				// TIMER
+		{PWM27_FREQ, PWM27_DUTYCYCLE},										// PWM
+	},
+};
+
 /**
  * @brief Retrieve PWM definitions from PWM ID
  * @param id : PWM ID
@@ -346,325 +557,10 @@ static PWM* _pwm[PWM::PWM_MAX] = {NULL};
  */
 static PWM_DEF _getPWMStruct (enum PWM::ID id)
 {
-	PWM_DEF pwm;
-
 	assert(id < HAL::PWM::PWM_MAX);
+	assert(SystemCoreClock == PWM_CORE_FREQ);
 
-	switch(id)
-	{
-	case PWM::PWM0:
-		pwm.IO.PORT					=	PWM0_IO_PORT;
-		pwm.IO.PIN					=	PWM0_IO_PIN;
-		pwm.IO.PINSOURCE			=	PWM0_IO_PINSOURCE;
-		pwm.IO.AF					=	PWM0_IO_AF;
-		pwm.TIMER.TIMER				=	PWM0_TIMER;
-		pwm.TIMER.CHANNEL			=	PWM0_TIMER_CHANNEL;
-		pwm.TIMER.CLOCKFREQ			=	PWM0_TIMER_FREQ;
-		pwm.PWM.DEFAULT_FREQ		=	PWM0_FREQ;
-		pwm.PWM.DEFAULT_DUTYCYCLE	=	PWM0_DUTYCYCLE;
-		break;
-	case PWM::PWM1:
-		pwm.IO.PORT					=	PWM1_IO_PORT;
-		pwm.IO.PIN					=	PWM1_IO_PIN;
-		pwm.IO.PINSOURCE			=	PWM1_IO_PINSOURCE;
-		pwm.IO.AF					=	PWM1_IO_AF;
-		pwm.TIMER.TIMER				=	PWM1_TIMER;
-		pwm.TIMER.CHANNEL			=	PWM1_TIMER_CHANNEL;
-		pwm.TIMER.CLOCKFREQ			=	PWM1_TIMER_FREQ;
-		pwm.PWM.DEFAULT_FREQ		=	PWM1_FREQ;
-		pwm.PWM.DEFAULT_DUTYCYCLE	=	PWM1_DUTYCYCLE;
-		break;
-	case PWM::PWM2:
-		pwm.IO.PORT					=	PWM2_IO_PORT;
-		pwm.IO.PIN					=	PWM2_IO_PIN;
-		pwm.IO.PINSOURCE			=	PWM2_IO_PINSOURCE;
-		pwm.IO.AF					=	PWM2_IO_AF;
-		pwm.TIMER.TIMER				=	PWM2_TIMER;
-		pwm.TIMER.CHANNEL			=	PWM2_TIMER_CHANNEL;
-		pwm.TIMER.CLOCKFREQ			=	PWM2_TIMER_FREQ;
-		pwm.PWM.DEFAULT_FREQ		=	PWM2_FREQ;
-		pwm.PWM.DEFAULT_DUTYCYCLE	=	PWM2_DUTYCYCLE;
-		break;
-	case PWM::PWM3:
-		pwm.IO.PORT					=	PWM3_IO_PORT;
-		pwm.IO.PIN					=	PWM3_IO_PIN;
-		pwm.IO.PINSOURCE			=	PWM3_IO_PINSOURCE;
-		pwm.IO.AF					=	PWM3_IO_AF;
-		pwm.TIMER.TIMER				=	PWM3_TIMER;
-		pwm.TIMER.CHANNEL			=	PWM3_TIMER_CHANNEL;
-		pwm.TIMER.CLOCKFREQ			=	PWM3_TIMER_FREQ;
-		pwm.PWM.DEFAULT_FREQ		=	PWM3_FREQ;
-		pwm.PWM.DEFAULT_DUTYCYCLE	=	PWM3_DUTYCYCLE;
-		break;
-	case PWM::PWM4:
-		pwm.IO.PORT					=	PWM4_IO_PORT;
-		pwm.IO.PIN					=	PWM4_IO_PIN;
-		pwm.IO.PINSOURCE			=	PWM4_IO_PINSOURCE;
-		pwm.IO.AF					=	PWM4_IO_AF;
-		pwm.TIMER.TIMER				=	PWM4_TIMER;
-		pwm.TIMER.CHANNEL			=	PWM4_TIMER_CHANNEL;
-		pwm.TIMER.CLOCKFREQ			=	PWM4_TIMER_FREQ;
-		pwm.PWM.DEFAULT_FREQ		=	PWM4_FREQ;
-		pwm.PWM.DEFAULT_DUTYCYCLE	=	PWM4_DUTYCYCLE;
-		break;
-	case PWM::PWM5:
-		pwm.IO.PORT					=	PWM5_IO_PORT;
-		pwm.IO.PIN					=	PWM5_IO_PIN;
-		pwm.IO.PINSOURCE			=	PWM5_IO_PINSOURCE;
-		pwm.IO.AF					=	PWM5_IO_AF;
-		pwm.TIMER.TIMER				=	PWM5_TIMER;
-		pwm.TIMER.CHANNEL			=	PWM5_TIMER_CHANNEL;
-		pwm.TIMER.CLOCKFREQ			=	PWM5_TIMER_FREQ;
-		pwm.PWM.DEFAULT_FREQ		=	PWM5_FREQ;
-		pwm.PWM.DEFAULT_DUTYCYCLE	=	PWM5_DUTYCYCLE;
-		break;
-	case PWM::PWM6:
-		pwm.IO.PORT					=	PWM6_IO_PORT;
-		pwm.IO.PIN					=	PWM6_IO_PIN;
-		pwm.IO.PINSOURCE			=	PWM6_IO_PINSOURCE;
-		pwm.IO.AF					=	PWM6_IO_AF;
-		pwm.TIMER.TIMER				=	PWM6_TIMER;
-		pwm.TIMER.CHANNEL			=	PWM6_TIMER_CHANNEL;
-		pwm.TIMER.CLOCKFREQ			=	PWM6_TIMER_FREQ;
-		pwm.PWM.DEFAULT_FREQ		=	PWM6_FREQ;
-		pwm.PWM.DEFAULT_DUTYCYCLE	=	PWM6_DUTYCYCLE;
-		break;
-	case PWM::PWM7:
-		pwm.IO.PORT					=	PWM7_IO_PORT;
-		pwm.IO.PIN					=	PWM7_IO_PIN;
-		pwm.IO.PINSOURCE			=	PWM7_IO_PINSOURCE;
-		pwm.IO.AF					=	PWM7_IO_AF;
-		pwm.TIMER.TIMER				=	PWM7_TIMER;
-		pwm.TIMER.CHANNEL			=	PWM7_TIMER_CHANNEL;
-		pwm.TIMER.CLOCKFREQ			=	PWM7_TIMER_FREQ;
-		pwm.PWM.DEFAULT_FREQ		=	PWM7_FREQ;
-		pwm.PWM.DEFAULT_DUTYCYCLE	=	PWM7_DUTYCYCLE;
-		break;
-	case PWM::PWM8:
-		pwm.IO.PORT					=	PWM8_IO_PORT;
-		pwm.IO.PIN					=	PWM8_IO_PIN;
-		pwm.IO.PINSOURCE			=	PWM8_IO_PINSOURCE;
-		pwm.IO.AF					=	PWM8_IO_AF;
-		pwm.TIMER.TIMER				=	PWM8_TIMER;
-		pwm.TIMER.CHANNEL			=	PWM8_TIMER_CHANNEL;
-		pwm.TIMER.CLOCKFREQ			=	PWM8_TIMER_FREQ;
-		pwm.PWM.DEFAULT_FREQ		=	PWM8_FREQ;
-		pwm.PWM.DEFAULT_DUTYCYCLE	=	PWM8_DUTYCYCLE;
-		break;
-	case PWM::PWM9:
-		pwm.IO.PORT					=	PWM9_IO_PORT;
-		pwm.IO.PIN					=	PWM9_IO_PIN;
-		pwm.IO.PINSOURCE			=	PWM9_IO_PINSOURCE;
-		pwm.IO.AF					=	PWM9_IO_AF;
-		pwm.TIMER.TIMER				=	PWM9_TIMER;
-		pwm.TIMER.CHANNEL			=	PWM9_TIMER_CHANNEL;
-		pwm.TIMER.CLOCKFREQ			=	PWM9_TIMER_FREQ;
-		pwm.PWM.DEFAULT_FREQ		=	PWM9_FREQ;
-		pwm.PWM.DEFAULT_DUTYCYCLE	=	PWM9_DUTYCYCLE;
-		break;
-	case PWM::PWM10:
-		pwm.IO.PORT					=	PWM10_IO_PORT;
-		pwm.IO.PIN					=	PWM10_IO_PIN;
-		pwm.IO.PINSOURCE			=	PWM10_IO_PINSOURCE;
-		pwm.IO.AF					=	PWM10_IO_AF;
-		pwm.TIMER.TIMER				=	PWM10_TIMER;
-		pwm.TIMER.CHANNEL			=	PWM10_TIMER_CHANNEL;
-		pwm.TIMER.CLOCKFREQ			=	PWM10_TIMER_FREQ;
-		pwm.PWM.DEFAULT_FREQ		=	PWM10_FREQ;
-		pwm.PWM.DEFAULT_DUTYCYCLE	=	PWM10_DUTYCYCLE;
-		break;
-	case PWM::PWM11:
-		pwm.IO.PORT					=	PWM11_IO_PORT;
-		pwm.IO.PIN					=	PWM11_IO_PIN;
-		pwm.IO.PINSOURCE			=	PWM11_IO_PINSOURCE;
-		pwm.IO.AF					=	PWM11_IO_AF;
-		pwm.TIMER.TIMER				=	PWM11_TIMER;
-		pwm.TIMER.CHANNEL			=	PWM11_TIMER_CHANNEL;
-		pwm.TIMER.CLOCKFREQ			=	PWM11_TIMER_FREQ;
-		pwm.PWM.DEFAULT_FREQ		=	PWM11_FREQ;
-		pwm.PWM.DEFAULT_DUTYCYCLE	=	PWM11_DUTYCYCLE;
-		break;
-	case PWM::PWM12:
-		pwm.IO.PORT					=	PWM12_IO_PORT;
-		pwm.IO.PIN					=	PWM12_IO_PIN;
-		pwm.IO.PINSOURCE			=	PWM12_IO_PINSOURCE;
-		pwm.IO.AF					=	PWM12_IO_AF;
-		pwm.TIMER.TIMER				=	PWM12_TIMER;
-		pwm.TIMER.CHANNEL			=	PWM12_TIMER_CHANNEL;
-		pwm.TIMER.CLOCKFREQ			=	PWM12_TIMER_FREQ;
-		pwm.PWM.DEFAULT_FREQ		=	PWM12_FREQ;
-		pwm.PWM.DEFAULT_DUTYCYCLE	=	PWM12_DUTYCYCLE;
-		break;
-	case PWM::PWM13:
-		pwm.IO.PORT					=	PWM13_IO_PORT;
-		pwm.IO.PIN					=	PWM13_IO_PIN;
-		pwm.IO.PINSOURCE			=	PWM13_IO_PINSOURCE;
-		pwm.IO.AF					=	PWM13_IO_AF;
-		pwm.TIMER.TIMER				=	PWM13_TIMER;
-		pwm.TIMER.CHANNEL			=	PWM13_TIMER_CHANNEL;
-		pwm.TIMER.CLOCKFREQ			=	PWM13_TIMER_FREQ;
-		pwm.PWM.DEFAULT_FREQ		=	PWM13_FREQ;
-		pwm.PWM.DEFAULT_DUTYCYCLE	=	PWM13_DUTYCYCLE;
-		break;
-	case PWM::PWM14:
-		pwm.IO.PORT					=	PWM14_IO_PORT;
-		pwm.IO.PIN					=	PWM14_IO_PIN;
-		pwm.IO.PINSOURCE			=	PWM14_IO_PINSOURCE;
-		pwm.IO.AF					=	PWM14_IO_AF;
-		pwm.TIMER.TIMER				=	PWM14_TIMER;
-		pwm.TIMER.CHANNEL			=	PWM14_TIMER_CHANNEL;
-		pwm.TIMER.CLOCKFREQ			=	PWM14_TIMER_FREQ;
-		pwm.PWM.DEFAULT_FREQ		=	PWM14_FREQ;
-		pwm.PWM.DEFAULT_DUTYCYCLE	=	PWM14_DUTYCYCLE;
-		break;
-	case PWM::PWM15:
-		pwm.IO.PORT					=	PWM15_IO_PORT;
-		pwm.IO.PIN					=	PWM15_IO_PIN;
-		pwm.IO.PINSOURCE			=	PWM15_IO_PINSOURCE;
-		pwm.IO.AF					=	PWM15_IO_AF;
-		pwm.TIMER.TIMER				=	PWM15_TIMER;
-		pwm.TIMER.CHANNEL			=	PWM15_TIMER_CHANNEL;
-		pwm.TIMER.CLOCKFREQ			=	PWM15_TIMER_FREQ;
-		pwm.PWM.DEFAULT_FREQ		=	PWM15_FREQ;
-		pwm.PWM.DEFAULT_DUTYCYCLE	=	PWM15_DUTYCYCLE;
-		break;
-	case PWM::PWM16:
-		pwm.IO.PORT					=	PWM16_IO_PORT;
-		pwm.IO.PIN					=	PWM16_IO_PIN;
-		pwm.IO.PINSOURCE			=	PWM16_IO_PINSOURCE;
-		pwm.IO.AF					=	PWM16_IO_AF;
-		pwm.TIMER.TIMER				=	PWM16_TIMER;
-		pwm.TIMER.CHANNEL			=	PWM16_TIMER_CHANNEL;
-		pwm.TIMER.CLOCKFREQ			=	PWM16_TIMER_FREQ;
-		pwm.PWM.DEFAULT_FREQ		=	PWM16_FREQ;
-		pwm.PWM.DEFAULT_DUTYCYCLE	=	PWM16_DUTYCYCLE;
-		break;
-	case PWM::PWM17:
-		pwm.IO.PORT					=	PWM17_IO_PORT;
-		pwm.IO.PIN					=	PWM17_IO_PIN;
-		pwm.IO.PINSOURCE			=	PWM17_IO_PINSOURCE;
-		pwm.IO.AF					=	PWM17_IO_AF;
-		pwm.TIMER.TIMER				=	PWM17_TIMER;
-		pwm.TIMER.CHANNEL			=	PWM17_TIMER_CHANNEL;
-		pwm.TIMER.CLOCKFREQ			=	PWM17_TIMER_FREQ;
-		pwm.PWM.DEFAULT_FREQ		=	PWM17_FREQ;
-		pwm.PWM.DEFAULT_DUTYCYCLE	=	PWM17_DUTYCYCLE;
-		break;
-	case PWM::PWM18:
-		pwm.IO.PORT					=	PWM18_IO_PORT;
-		pwm.IO.PIN					=	PWM18_IO_PIN;
-		pwm.IO.PINSOURCE			=	PWM18_IO_PINSOURCE;
-		pwm.IO.AF					=	PWM18_IO_AF;
-		pwm.TIMER.TIMER				=	PWM18_TIMER;
-		pwm.TIMER.CHANNEL			=	PWM18_TIMER_CHANNEL;
-		pwm.TIMER.CLOCKFREQ			=	PWM18_TIMER_FREQ;
-		pwm.PWM.DEFAULT_FREQ		=	PWM18_FREQ;
-		pwm.PWM.DEFAULT_DUTYCYCLE	=	PWM18_DUTYCYCLE;
-		break;
-	case PWM::PWM19:
-		pwm.IO.PORT					=	PWM19_IO_PORT;
-		pwm.IO.PIN					=	PWM19_IO_PIN;
-		pwm.IO.PINSOURCE			=	PWM19_IO_PINSOURCE;
-		pwm.IO.AF					=	PWM19_IO_AF;
-		pwm.TIMER.TIMER				=	PWM19_TIMER;
-		pwm.TIMER.CHANNEL			=	PWM19_TIMER_CHANNEL;
-		pwm.TIMER.CLOCKFREQ			=	PWM19_TIMER_FREQ;
-		pwm.PWM.DEFAULT_FREQ		=	PWM19_FREQ;
-		pwm.PWM.DEFAULT_DUTYCYCLE	=	PWM19_DUTYCYCLE;
-		break;
-	case PWM::PWM20:
-		pwm.IO.PORT					=	PWM20_IO_PORT;
-		pwm.IO.PIN					=	PWM20_IO_PIN;
-		pwm.IO.PINSOURCE			=	PWM20_IO_PINSOURCE;
-		pwm.IO.AF					=	PWM20_IO_AF;
-		pwm.TIMER.TIMER				=	PWM20_TIMER;
-		pwm.TIMER.CHANNEL			=	PWM20_TIMER_CHANNEL;
-		pwm.TIMER.CLOCKFREQ			=	PWM20_TIMER_FREQ;
-		pwm.PWM.DEFAULT_FREQ		=	PWM20_FREQ;
-		pwm.PWM.DEFAULT_DUTYCYCLE	=	PWM20_DUTYCYCLE;
-		break;
-	case PWM::PWM21:
-		pwm.IO.PORT					=	PWM21_IO_PORT;
-		pwm.IO.PIN					=	PWM21_IO_PIN;
-		pwm.IO.PINSOURCE			=	PWM21_IO_PINSOURCE;
-		pwm.IO.AF					=	PWM21_IO_AF;
-		pwm.TIMER.TIMER				=	PWM21_TIMER;
-		pwm.TIMER.CHANNEL			=	PWM21_TIMER_CHANNEL;
-		pwm.TIMER.CLOCKFREQ			=	PWM21_TIMER_FREQ;
-		pwm.PWM.DEFAULT_FREQ		=	PWM21_FREQ;
-		pwm.PWM.DEFAULT_DUTYCYCLE	=	PWM21_DUTYCYCLE;
-		break;
-	case PWM::PWM22:
-		pwm.IO.PORT					=	PWM22_IO_PORT;
-		pwm.IO.PIN					=	PWM22_IO_PIN;
-		pwm.IO.PINSOURCE			=	PWM22_IO_PINSOURCE;
-		pwm.IO.AF					=	PWM22_IO_AF;
-		pwm.TIMER.TIMER				=	PWM22_TIMER;
-		pwm.TIMER.CHANNEL			=	PWM22_TIMER_CHANNEL;
-		pwm.TIMER.CLOCKFREQ			=	PWM22_TIMER_FREQ;
-		pwm.PWM.DEFAULT_FREQ		=	PWM22_FREQ;
-		pwm.PWM.DEFAULT_DUTYCYCLE	=	PWM22_DUTYCYCLE;
-		break;
-	case PWM::PWM23:
-		pwm.IO.PORT					=	PWM23_IO_PORT;
-		pwm.IO.PIN					=	PWM23_IO_PIN;
-		pwm.IO.PINSOURCE			=	PWM23_IO_PINSOURCE;
-		pwm.IO.AF					=	PWM23_IO_AF;
-		pwm.TIMER.TIMER				=	PWM23_TIMER;
-		pwm.TIMER.CHANNEL			=	PWM23_TIMER_CHANNEL;
-		pwm.TIMER.CLOCKFREQ			=	PWM23_TIMER_FREQ;
-		pwm.PWM.DEFAULT_FREQ		=	PWM23_FREQ;
-		pwm.PWM.DEFAULT_DUTYCYCLE	=	PWM23_DUTYCYCLE;
-		break;
-	case PWM::PWM24:
-		pwm.IO.PORT					=	PWM24_IO_PORT;
-		pwm.IO.PIN					=	PWM24_IO_PIN;
-		pwm.IO.PINSOURCE			=	PWM24_IO_PINSOURCE;
-		pwm.IO.AF					=	PWM24_IO_AF;
-		pwm.TIMER.TIMER				=	PWM24_TIMER;
-		pwm.TIMER.CHANNEL			=	PWM24_TIMER_CHANNEL;
-		pwm.TIMER.CLOCKFREQ			=	PWM24_TIMER_FREQ;
-		pwm.PWM.DEFAULT_FREQ		=	PWM24_FREQ;
-		pwm.PWM.DEFAULT_DUTYCYCLE	=	PWM24_DUTYCYCLE;
-		break;
-	case PWM::PWM25:
-		pwm.IO.PORT					=	PWM25_IO_PORT;
-		pwm.IO.PIN					=	PWM25_IO_PIN;
-		pwm.IO.PINSOURCE			=	PWM25_IO_PINSOURCE;
-		pwm.IO.AF					=	PWM25_IO_AF;
-		pwm.TIMER.TIMER				=	PWM25_TIMER;
-		pwm.TIMER.CHANNEL			=	PWM25_TIMER_CHANNEL;
-		pwm.TIMER.CLOCKFREQ			=	PWM25_TIMER_FREQ;
-		pwm.PWM.DEFAULT_FREQ		=	PWM25_FREQ;
-		pwm.PWM.DEFAULT_DUTYCYCLE	=	PWM25_DUTYCYCLE;
-		break;
-	case PWM::PWM26:
-		pwm.IO.PORT					=	PWM26_IO_PORT;
-		pwm.IO.PIN					=	PWM26_IO_PIN;
-		pwm.IO.PINSOURCE			=	PWM26_IO_PINSOURCE;
-		pwm.IO.AF					=	PWM26_IO_AF;
-		pwm.TIMER.TIMER				=	PWM26_TIMER;
-		pwm.TIMER.CHANNEL			=	PWM26_TIMER_CHANNEL;
-		pwm.TIMER.CLOCKFREQ			=	PWM26_TIMER_FREQ;
-		pwm.PWM.DEFAULT_FREQ		=	PWM26_FREQ;
-		pwm.PWM.DEFAULT_DUTYCYCLE	=	PWM26_DUTYCYCLE;
-		break;
-	case PWM::PWM27:
-		pwm.IO.PORT					=	PWM27_IO_PORT;
-		pwm.IO.PIN					=	PWM27_IO_PIN;
-		pwm.IO.PINSOURCE			=	PWM27_IO_PINSOURCE;
-		pwm.IO.AF					=	PWM27_IO_AF;
-		pwm.TIMER.TIMER				=	PWM27_TIMER;
-		pwm.TIMER.CHANNEL			=	PWM27_TIMER_CHANNEL;
-		pwm.TIMER.CLOCKFREQ			=	PWM27_TIMER_FREQ;
-		pwm.PWM.DEFAULT_FREQ		=	PWM27_FREQ;
-		pwm.PWM.DEFAULT_DUTYCYCLE	=	PWM27_DUTYCYCLE;
-		break;
-	default:
-		break;
-	}
-
-	return pwm;
+	return _pwmDefs[id];
 }
 
 /**
@@ -716,6 +612,9 @@ static void _hardwareInit (enum PWM::ID id)
 	TIMOCStruct.TIM_Pulse			=	(uint32_t)((float32_t)TIMBaseStruct.TIM_Period * pwm.PWM.DEFAULT_DUTYCYCLE);
 
 	TIM_OCxInit(pwm.TIMER.TIMER, &TIMOCStruct, pwm.TIMER.CHANNEL);
+
+	// Compare value is loaded on update event (no glitch on change)
+	TIM_OCxPreloadConfig(pwm.TIMER.TIMER, TIM_OCPreload_Enable, pwm.TIMER.CHANNEL);
 }
 
 /*----------------------------------------------------------------------------*/
@@ -736,7 +635,7 @@ namespace HAL
 		else
 		{
 			// Create PWM instance
-			_pwm[id] = new PWM(id);
+			_pwm[id] = new (_pwmStorage.Get(id)) PWM(id);
 
 			return _pwm[id];
 		}
@@ -749,13 +648,17 @@ namespace HAL
 		this->def = _getPWMStruct(id);
 		this->dutyCycle = this->def.PWM.DEFAULT_DUTYCYCLE;
 		this->frequency = this->def.PWM.DEFAULT_FREQ;
+		this->arr = (this->def.TIMER.CLOCKFREQ / this->frequency) - 1u;
+
+		// CCR1 to CCR4 are contiguous, TIM_Channel_x = 4 * (x - 1)
+		this->ccr = &this->def.TIMER.TIMER->CCR1 + (this->def.TIMER.CHANNEL / TIM_Channel_2);
 
 		_hardwareInit(id);
 	}
 
 	void PWM::SetDutyCycle (float32_t percent)
 	{
-		uint32_t ARR = 0u, CCR = 0u;
+		uint32_t CCR = 0u;
 
 		if(percent > 1.0f)
 		{
@@ -766,17 +669,13 @@ namespace HAL
 			percent = 0.0f;
 		}
 
-		// 1. Get ARRx and CCRx value
-		ARR = (def.TIMER.CLOCKFREQ / this->frequency) - 1u;
-		CCR = (uint32_t)((float32_t)ARR * percent);
+		// 1. Get CCRx value from cached ARRx
+		CCR = (uint32_t)((float32_t)this->arr * percent);
 
-		// 2. Update ARRx register
-		TIM_SetAutoreload(this->def.TIMER.TIMER, ARR);
+		// 2. Update CCRx
+		*this->ccr = CCR;
 
-		// 3. Update CCRx
-		TIM_SetCompareX(this->def.TIMER.TIMER, CCR, this->def.TIMER.CHANNEL);
-
-		// 4. Update instance duty cycle
+		// 3. Update instance duty cycle
 		this->dutyCycle = percent;
 	}
 
@@ -798,6 +697,7 @@ namespace HAL
 
 		// 4. Update instance frequency
 		this->frequency = freq;
+		this->arr = ARR;
 	}
 
 	void PWM::SetState (PWM::State state)
@@ -822,4 +722,73 @@ namespace HAL
 		// 3. Update instance state
 		this->state = state;
 	}
+
+	PWMGroup::PWMGroup ()
+	{
+		this->count = 0u;
+		this->timerCount = 0u;
+		this->dirty = 0u;
+	}
+
+	int32_t PWMGroup::Add (PWM* pwm)
+	{
+		uint32_t i;
+
+		assert(pwm != NULL);
+
+		if(this->count >= PWM_GROUP_SIZE)
+			return -1;
+
+		// Register timer once
+		for(i = 0u; i < this->timerCount; i++)
+		{
+			if(this->timer[i] == pwm->def.TIMER.TIMER)
+				break;
+		}
+
+		if(i == this->timerCount)
+		{
+			if(this->timerCount >= PWM_GROUP_TIMERS)
+				return -1;
+
+			this->timer[this->timerCount++] = pwm->def.TIMER.TIMER;
+		}
+
+		this->ccr[this->count] = pwm->ccr;
+		this->value[this->count] = *pwm->ccr;
+
+		return (int32_t)this->count++;
+	}
+
+	void PWMGroup::Commit (bool resync)
+	{
+		uint32_t dirty = this->dirty;
+		uint32_t i;
+
+		if((dirty == 0u) && !resync)
+			return;
+
+		// 1. Hold update events : preloaded values are not transferred
+		for(i = 0u; i < this->timerCount; i++)
+			this->timer[i]->CR1 |= TIM_CR1_UDIS;
+
+		// 2. Write changed compare registers only
+		for(i = 0u; dirty != 0u; i++, dirty >>= 1u)
+		{
+			if(dirty & 1u)
+				*this->ccr[i] = this->value[i];
+		}
+		this->dirty = 0u;
+
+		// 3. Release update events, all values apply on next period
+		for(i = 0u; i < this->timerCount; i++)
+			this->timer[i]->CR1 &= (uint16_t)~TIM_CR1_UDIS;
+
+		// 4. Optional resync : restart all counters now
+		if(resync)
+		{
+			for(i = 0u; i < this->timerCount; i++)
+				this->timer[i]->EGR = TIM_EGR_UG;
+		}
+	}
 }
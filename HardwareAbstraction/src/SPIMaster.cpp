@@ -8,6 +8,8 @@
 
 #include <stddef.h>
 #include <SPIMaster.hpp>
+#include "StaticStorage.hpp"
+#include "Profiler.hpp"
 
 /*----------------------------------------------------------------------------*/
 /* Definitions                                                                */
@@ -30,6 +32,15 @@
 #define SPI0_CLOCK_PRESCALER	(SPI_BaudRatePrescaler_8)
 #define SPI0_CLOCK_POLARITY		(SPI_CPOL_High)
 #define SPI0_CLOCK_PHASE		(SPI_CPHA_2Edge)
+#define SPI0_INT_PRIORITY		(11u)	// Below configMAX_SYSCALL (completion notification)
+#define SPI0_DMA_TX_STREAM		(DMA2_Stream3)
+#define SPI0_DMA_TX_CHANNEL		(DMA_Channel_3)
+#define SPI0_DMA_TX_FLAGS		(DMA_FLAG_TCIF3 | DMA_FLAG_HTIF3 | DMA_FLAG_TEIF3 | DMA_FLAG_DMEIF3 | DMA_FLAG_FEIF3)
+#define SPI0_DMA_TX_INT			(DMA2_Stream3_IRQn)
+#define SPI0_DMA_RX_STREAM		(DMA2_Stream0)
+#define SPI0_DMA_RX_CHANNEL		(DMA_Channel_3)
+#define SPI0_DMA_RX_FLAGS		(DMA_FLAG_TCIF0 | DMA_FLAG_HTIF0 | DMA_FLAG_TEIF0 | DMA_FLAG_DMEIF0 | DMA_FLAG_FEIF0)
+#define SPI0_DMA_RX_INT			(DMA2_Stream0_IRQn)
 
 #define SPI_TIMEOUT				(0x10000u)
 
@@ -43,6 +54,16 @@
  */
 static HAL::SPIMaster* _instance[HAL::SPIMaster::SPI_MASTER_MAX] = {NULL};
 
+/**
+ * @brief SPIMaster instances storage
+ */
+static Utils::StaticStorage<HAL::SPIMaster, HAL::SPIMaster::SPI_MASTER_MAX> _instanceStorage;
+
+/**
+ * @brief IRQ handlers execution time
+ */
+static Utils::Profiler _spi1DmaProfiler("SPI1 DMA");
+
 /*----------------------------------------------------------------------------*/
 /* Private Functions                                                          */
 /*----------------------------------------------------------------------------*/
@@ -82,6 +103,17 @@ static SPIMaster_DEF _getSPIStruct (enum HAL::SPIMaster::ID id)
 		spi.SPI.CLOCKPRESCALER	=	SPI0_CLOCK_PRESCALER;
 		spi.SPI.CLOCKPOLARITY	=	SPI0_CLOCK_POLARITY;
 		spi.SPI.CLOCKPHASE		=	SPI0_CLOCK_PHASE;
+
+		// Interrupt and DMA
+		spi.INT.PRIORITY		=	SPI0_INT_PRIORITY;
+		spi.DMA_TX.STREAM		=	SPI0_DMA_TX_STREAM;
+		spi.DMA_TX.CHANNEL		=	SPI0_DMA_TX_CHANNEL;
+		spi.DMA_TX.FLAGS		=	SPI0_DMA_TX_FLAGS;
+		spi.DMA_TX.INT_CHANNEL	=	SPI0_DMA_TX_INT;
+		spi.DMA_RX.STREAM		=	SPI0_DMA_RX_STREAM;
+		spi.DMA_RX.CHANNEL		=	SPI0_DMA_RX_CHANNEL;
+		spi.DMA_RX.FLAGS		=	SPI0_DMA_RX_FLAGS;
+		spi.DMA_RX.INT_CHANNEL	=	SPI0_DMA_RX_INT;
 		break;
 
 	default:
@@ -95,6 +127,8 @@ static void _hardwareInit (enum HAL::SPIMaster::ID id)
 {
 	GPIO_InitTypeDef GPIOStruct;
 	SPI_InitTypeDef SPIStruct;
+	DMA_InitTypeDef DMAStruct;
+	NVIC_InitTypeDef NVICStruct;
 
 	SPIMaster_DEF spi;
 
@@ -109,6 +143,7 @@ static void _hardwareInit (enum HAL::SPIMaster::ID id)
 	GPIOStruct.GPIO_Speed	=	GPIO_Speed_100MHz;
 	GPIOStruct.GPIO_Pin		=	spi.CS.PIN;
 
+	GPIO_SetBits(spi.CS.PORT, spi.CS.PIN);
 	GPIO_Init(spi.CS.PORT, &GPIOStruct);
 
 	GPIOStruct.GPIO_Mode	=	GPIO_Mode_AF;
@@ -139,7 +174,56 @@ static void _hardwareInit (enum HAL::SPIMaster::ID id)
 	SPIStruct.SPI_CRCPolynomial		=	0x0001u;
 
 	SPI_Init(spi.SPI.BUS, &SPIStruct);
+
+	// DMA Init (common), streams are started on each transaction
+	DMAStruct.DMA_PeripheralBaseAddr	=	(uint32_t)&spi.SPI.BUS->DR;
+	DMAStruct.DMA_PeripheralInc			=	DMA_PeripheralInc_Disable;
+	DMAStruct.DMA_MemoryInc				=	DMA_MemoryInc_Enable;
+	DMAStruct.DMA_PeripheralDataSize	=	DMA_PeripheralDataSize_Byte;
+	DMAStruct.DMA_MemoryDataSize		=	DMA_MemoryDataSize_Byte;
+	DMAStruct.DMA_Mode					=	DMA_Mode_Normal;
+	DMAStruct.DMA_Priority				=	DMA_Priority_Medium;
+	DMAStruct.DMA_FIFOMode				=	DMA_FIFOMode_Disable;
+	DMAStruct.DMA_FIFOThreshold			=	DMA_FIFOThreshold_Full;
+	DMAStruct.DMA_MemoryBurst			=	DMA_MemoryBurst_Single;
+	DMAStruct.DMA_PeripheralBurst		=	DMA_PeripheralBurst_Single;
+	DMAStruct.DMA_BufferSize			=	1u;
+
+	DMA_DeInit(spi.DMA_TX.STREAM);
+	DMAStruct.DMA_Channel				=	spi.DMA_TX.CHANNEL;
+	DMAStruct.DMA_Memory0BaseAddr		=	0u;
+	DMAStruct.DMA_DIR					=	DMA_DIR_MemoryToPeripheral;
+	DMA_Init(spi.DMA_TX.STREAM, &DMAStruct);
+
+	// RX completes last : end of transaction
+	DMA_DeInit(spi.DMA_RX.STREAM);
+	DMAStruct.DMA_Channel				=	spi.DMA_RX.CHANNEL;
+	DMAStruct.DMA_DIR					=	DMA_DIR_PeripheralToMemory;
+	DMA_Init(spi.DMA_RX.STREAM, &DMAStruct);
+	DMA_ITConfig(spi.DMA_RX.STREAM, DMA_IT_TC, ENABLE);
+
+	SPI_I2S_DMACmd(spi.SPI.BUS, SPI_I2S_DMAReq_Tx | SPI_I2S_DMAReq_Rx, ENABLE);
 	SPI_Cmd(spi.SPI.BUS, ENABLE);
+
+	// NVIC Init
+	NVICStruct.NVIC_IRQChannel						=	spi.DMA_RX.INT_CHANNEL;
+	NVICStruct.NVIC_IRQChannelPreemptionPriority	=	spi.INT.PRIORITY;
+	NVICStruct.NVIC_IRQChannelSubPriority			=	0;
+	NVICStruct.NVIC_IRQChannelCmd					=	ENABLE;
+
+	NVIC_Init(&NVICStruct);
+}
+
+/**
+ * @brief Blocking transfer completion : wake up waiting task
+ * @param obj : Waiting task handle
+ */
+static void _transferDone (void* obj)
+{
+	BaseType_t woken = pdFALSE;
+
+	vTaskNotifyGiveFromISR(reinterpret_cast<TaskHandle_t>(obj), &woken);
+	portYIELD_FROM_ISR(woken);
 }
 
 /*----------------------------------------------------------------------------*/
@@ -154,7 +238,7 @@ namespace HAL
 
 		if(_instance[id] == NULL)
 		{
-			_instance[id] = new SPIMaster(id);
+			_instance[id] = new (_instanceStorage.Get(id)) SPIMaster(id);
 
 			return _instance[id];
 		}
@@ -168,40 +252,257 @@ namespace HAL
 	{
 		this->id = id;
 		this->def = _getSPIStruct(id);
+		this->queueWr = 0u;
+		this->queueRd = 0u;
+		this->offset = 0u;
+		this->bytes = 0u;
+		this->dummy = 0u;
 
 		_hardwareInit(id);
 	}
 
-	int32_t SPIMaster::Transfer(uint8_t * txBuffer, uint8_t * rxBuffer, uint32_t length)
+	uint32_t SPIMaster::GetBitRate()
+	{
+		RCC_ClocksTypeDef clocks;
+		uint32_t pclk;
+
+		RCC_GetClocksFreq(&clocks);
+
+		// SPI1 and SPI4 on APB2, prescaler field is log2(divider) - 1
+		pclk = ((this->def.SPI.BUS == SPI1) || (this->def.SPI.BUS == SPI4)) ? clocks.PCLK2_Frequency : clocks.PCLK1_Frequency;
+
+		return pclk >> (((this->def.SPI.CLOCKPRESCALER >> 3) & 0x7u) + 1u);
+	}
+
+	int32_t SPIMaster::Transfer(uint8_t * txBuffer, uint8_t * rxBuffer, uint32_t length, uint32_t frameLength)
 	{
 		int32_t rval = NO_ERROR;
-		uint32_t i = 0u;
+		SPITransaction transaction;
+
+		transaction.txBuffer	=	txBuffer;
+		transaction.rxBuffer	=	rxBuffer;
+		transaction.length		=	length;
+		transaction.frameLength	=	frameLength;
+		transaction.csPort		=	NULL;
+		transaction.csPin		=	0u;
+		transaction.callback	=	NULL;
+		transaction.obj			=	NULL;
+
+		// Interrupts are masked until the scheduler starts
+		if(xTaskGetSchedulerState() == taskSCHEDULER_NOT_STARTED)
+		{
+			return this->transferPolled(&transaction);
+		}
+
+		transaction.callback	=	&_transferDone;
+		transaction.obj			=	xTaskGetCurrentTaskHandle();
+
+		rval = this->TransferAsync(&transaction);
+
+		// Sleep until DMA completion
+		while((rval == NO_ERROR) && (transaction.status == SPI_PENDING))
+		{
+			ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+		}
 
-		// 1. Drive nCS low
 		if(rval == NO_ERROR)
 		{
-			GPIO_ResetBits(this->def.CS.PORT, this->def.CS.PIN);
+			rval = transaction.status;
 		}
 
-		// 2. Transfer data
-		for(i=0u; i<length; i++)
+		return rval;
+	}
+
+	int32_t SPIMaster::TransferAsync(SPITransaction * transaction)
+	{
+		int32_t rval = NO_ERROR;
+		bool idle = false;
+
+		assert(transaction != NULL);
+
+		transaction->status = SPI_PENDING;
+
+		taskENTER_CRITICAL();
+
+		if((this->queueWr - this->queueRd) >= SPI_QUEUE_SIZE)
+		{
+			rval = SPI_ERROR_QUEUE_FULL;
+		}
+		else
 		{
-			// 2.1 Send data
-			SPI_SendData(this->def.SPI.BUS, (uint16_t)txBuffer[i]);
+			idle = (this->queueWr == this->queueRd);
 
-			// 2.2 Wait while RX buffer is empty
-			while(SPI_I2S_GetFlagStatus(this->def.SPI.BUS, SPI_I2S_FLAG_RXNE) == RESET);
+			this->queue[this->queueWr % SPI_QUEUE_SIZE] = transaction;
+			this->queueWr++;
 
-			// 2.3 Read data
-			rxBuffer[i] = (uint8_t)SPI_ReceiveData(this->def.SPI.BUS);
+			if(idle)
+			{
+				this->start();
+			}
 		}
 
-		// 3. Drive nCS high
-		if(rval == NO_ERROR)
+		taskEXIT_CRITICAL();
+
+		return rval;
+	}
+
+	void SPIMaster::select(SPITransaction * transaction, bool selected)
+	{
+		GPIO_TypeDef * port = this->def.CS.PORT;
+		uint16_t pin = this->def.CS.PIN;
+
+		if(transaction->csPort != NULL)
+		{
+			port = transaction->csPort;
+			pin  = transaction->csPin;
+		}
+
+		if(selected)
+		{
+			GPIO_ResetBits(port, pin);
+		}
+		else
+		{
+			GPIO_SetBits(port, pin);
+		}
+	}
+
+	void SPIMaster::start()
+	{
+		SPITransaction * t = this->queue[this->queueRd % SPI_QUEUE_SIZE];
+		DMA_Stream_TypeDef * tx = this->def.DMA_TX.STREAM;
+		DMA_Stream_TypeDef * rx = this->def.DMA_RX.STREAM;
+		uint32_t size = SPIMaster::frameSize(t, this->offset);
+
+		// 1. Drive nCS low
+		this->select(t, true);
+
+		// 2. Load streams with next frame (both are disabled after previous completion)
+		DMA_ClearFlag(tx, this->def.DMA_TX.FLAGS);
+		DMA_ClearFlag(rx, this->def.DMA_RX.FLAGS);
+
+		tx->M0AR = (uint32_t)&t->txBuffer[this->offset];
+		tx->NDTR = size;
+
+		if(t->rxBuffer != NULL)
+		{
+			rx->M0AR = (uint32_t)&t->rxBuffer[this->offset];
+			rx->CR |= DMA_SxCR_MINC;
+		}
+		else
 		{
-			GPIO_SetBits(this->def.CS.PORT, this->def.CS.PIN);
+			rx->M0AR = (uint32_t)&this->dummy;
+			rx->CR &= ~DMA_SxCR_MINC;
 		}
+		rx->NDTR = size;
+
+		// 3. Start RX first, TX request starts the transfer
+		DMA_Cmd(rx, ENABLE);
+		DMA_Cmd(tx, ENABLE);
+	}
+
+	int32_t SPIMaster::transferPolled(SPITransaction * transaction)
+	{
+		int32_t rval = NO_ERROR;
+		uint32_t i = 0u;
+		uint32_t end = 0u;
+		uint8_t data = 0u;
+
+		while(i < transaction->length)
+		{
+			end = i + SPIMaster::frameSize(transaction, i);
+
+			// 1. Drive nCS low
+			this->select(transaction, true);
+
+			// 2. Transfer frame
+			for(; i<end; i++)
+			{
+				// 2.1 Send data
+				SPI_SendData(this->def.SPI.BUS, (uint16_t)transaction->txBuffer[i]);
+
+				// 2.2 Wait while RX buffer is empty
+				while(SPI_I2S_GetFlagStatus(this->def.SPI.BUS, SPI_I2S_FLAG_RXNE) == RESET);
+
+				// 2.3 Read data
+				data = (uint8_t)SPI_ReceiveData(this->def.SPI.BUS);
+
+				if(transaction->rxBuffer != NULL)
+				{
+					transaction->rxBuffer[i] = data;
+				}
+			}
+
+			// 3. Drive nCS high
+			this->select(transaction, false);
+		}
+
+		this->bytes += transaction->length;
 
 		return rval;
 	}
+
+	void SPIMaster::INTERNAL_InterruptCallback()
+	{
+		SPITransaction * t = this->queue[this->queueRd % SPI_QUEUE_SIZE];
+
+		// 1. Streams are disabled by hardware on completion
+		DMA_Cmd(this->def.DMA_TX.STREAM, DISABLE);
+		DMA_Cmd(this->def.DMA_RX.STREAM, DISABLE);
+
+		// 2. Drive nCS high (last byte received, bus is idle)
+		this->select(t, false);
+
+		// 3. Next frame of the same transaction
+		this->bytes += SPIMaster::frameSize(t, this->offset);
+		this->offset += SPIMaster::frameSize(t, this->offset);
+
+		if(this->offset < t->length)
+		{
+			this->start();
+			return;
+		}
+
+		// 4. Pop and start next transaction before notifying
+		this->offset = 0u;
+		this->queueRd++;
+
+		if(this->queueRd != this->queueWr)
+		{
+			this->start();
+		}
+
+		t->status = NO_ERROR;
+
+		if(t->callback != NULL)
+		{
+			t->callback(t->obj);
+		}
+	}
+}
+
+/*----------------------------------------------------------------------------*/
+/* Interrupt Handler                                                          */
+/*----------------------------------------------------------------------------*/
+extern "C"
+{
+	/**
+	 * @brief SPI1 DMA RX IRQ Handler
+	 */
+	void DMA2_Stream0_IRQHandler (void)
+	{
+		_spi1DmaProfiler.Start();
+
+		if(DMA_GetITStatus(DMA2_Stream0, DMA_IT_TCIF0) == SET)
+		{
+			DMA_ClearITPendingBit(DMA2_Stream0, DMA_IT_TCIF0);
+
+			if(_instance[HAL::SPIMaster::SPI_MASTER0] != NULL)
+			{
+				_instance[HAL::SPIMaster::SPI_MASTER0]->INTERNAL_InterruptCallback();
+			}
+		}
+
+		_spi1DmaProfiler.Stop();
+	}
 }
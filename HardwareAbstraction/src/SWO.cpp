@@ -0,0 +1,143 @@
+/**
+ * @file	SWO.cpp
+ * @author	Kevin WYSOCKI
+ * @date	22 oct. 2017
+ * @brief	ITM stimulus ports output on the SWO pin
+ */
+
+#include <stddef.h>
+#include "SWO.hpp"
+#include "StaticStorage.hpp"
+
+using namespace HAL;
+
+/*----------------------------------------------------------------------------*/
+/* Definitions                                                                */
+/*----------------------------------------------------------------------------*/
+
+#define SWO_PORT				(GPIOB)
+#define SWO_PIN					(GPIO_Pin_3)
+#define SWO_PINSOURCE			(GPIO_PinSource3)
+#define SWO_AF					(GPIO_AF_TRACE)
+#define SWO_SHARED_AF			(GPIO_AF_SPI1)		// SPI0_SCK_PIN, see SPIMaster.cpp
+
+#define SWO_ITM_UNLOCK			(0xC5ACCE55u)
+#define SWO_TPI_PROTOCOL_NRZ	(2u)
+#define SWO_TPI_FFCR_TRIGIN		(0x100u)			// Formatter bypassed
+
+#define SWO_PORTS_MASK			((1u << SWO::PORT_MAX) - 1u)
+
+/*----------------------------------------------------------------------------*/
+/* Private Members                                                            */
+/*----------------------------------------------------------------------------*/
+
+/**
+ * @brief SWO instance
+ */
+static SWO* _swo = NULL;
+
+/**
+ * @brief SWO instance storage
+ */
+static Utils::StaticStorage<SWO> _swoStorage;
+
+/*----------------------------------------------------------------------------*/
+/* Class Implementation	                                                      */
+/*----------------------------------------------------------------------------*/
+namespace HAL
+{
+	SWO* SWO::GetInstance ()
+	{
+		// if instance already exists
+		if(_swo != NULL)
+		{
+			return _swo;
+		}
+		else
+		{
+			// Create instance
+			_swo = new (_swoStorage.Get()) SWO();
+
+			return _swo;
+		}
+	}
+
+	bool SWO::IsRouted (enum SWO::PORT port)
+	{
+		return (_swo != NULL) && _swo->IsEnabled(port);
+	}
+
+	SWO::SWO ()
+	{
+		// Trace clock and asynchronous trace pin
+		CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+		DBGMCU->CR = (DBGMCU->CR & ~DBGMCU_CR_TRACE_MODE) | DBGMCU_CR_TRACE_IOEN;
+
+		// TPIU : NRZ at SWO_BAUDRATE (TRACECLKIN is HCLK)
+		TPI->SPPR = SWO_TPI_PROTOCOL_NRZ;
+		TPI->ACPR = (SystemCoreClock / SWO_BAUDRATE) - 1u;
+		TPI->FFCR = SWO_TPI_FFCR_TRIGIN;
+
+		// ITM : stimulus ports only, unprivileged access, all ports disabled
+		ITM->LAR = SWO_ITM_UNLOCK;
+		ITM->TCR = (1u << ITM_TCR_TraceBusID_Pos) | ITM_TCR_SWOENA_Msk | ITM_TCR_SYNCENA_Msk | ITM_TCR_ITMENA_Msk;
+		ITM->TPR = 0u;
+		ITM->TER = 0u;
+	}
+
+	void SWO::Enable (enum SWO::PORT port, bool enable)
+	{
+		uint32_t ter;
+
+		assert(port < SWO::PORT_MAX);
+
+		ter = ITM->TER;
+
+		if(enable)
+			ter |= (1u << port);
+		else
+			ter &= ~(1u << port);
+
+		// First enabled port takes the pin, last disabled port gives it back
+		if(((ITM->TER & SWO_PORTS_MASK) == 0u) && ((ter & SWO_PORTS_MASK) != 0u))
+			this->claimPin(true);
+
+		ITM->TER = ter;
+
+		if(((ter & SWO_PORTS_MASK) == 0u))
+			this->claimPin(false);
+	}
+
+	bool SWO::IsEnabled (enum SWO::PORT port)
+	{
+		assert(port < SWO::PORT_MAX);
+
+		return ((ITM->TCR & ITM_TCR_ITMENA_Msk) != 0u) && ((ITM->TER & (1u << port)) != 0u);
+	}
+
+	uint32_t SWO::Write (enum SWO::PORT port, const uint8_t* data, uint32_t length)
+	{
+		uint32_t i;
+
+		assert(data != NULL);
+
+		if(!this->IsEnabled(port))
+			return 0u;
+
+		for(i = 0u; i < length; i++)
+		{
+			// Wait for stimulus port FIFO
+			while(ITM->PORT[port].u32 == 0u)
+			{}
+
+			ITM->PORT[port].u8 = data[i];
+		}
+
+		return length;
+	}
+
+	void SWO::claimPin (bool swo)
+	{
+		GPIO_PinAFConfig(SWO_PORT, SWO_PINSOURCE, swo ? SWO_AF : SWO_SHARED_AF);
+	}
+}
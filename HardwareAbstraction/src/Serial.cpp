@@ -14,9 +14,11 @@
 
 #include <string.h>
 #include "Serial.hpp"
+#include "SWO.hpp"
 #include "common.h"
+#include "Profiler.hpp"
+#include "StaticStorage.hpp"
 
-using namespace std;
 using namespace HAL;
 
 /*----------------------------------------------------------------------------*/
@@ -26,7 +28,21 @@ using namespace HAL;
 /**
  * @brief Serial FIFO size
  */
-#define SERIAL_BUFFER_SIZE		(128u)
+#define SERIAL_RX_BUFFER_SIZE	(256u)
+#define SERIAL_TX_BUFFER_SIZE	(512u)
+
+/**
+ * @brief DMA pseudo interrupt flags
+ */
+#define SERIAL_FLAG_DMA_TX		(0x8000u)
+#define SERIAL_FLAG_DMA_RX		(0x4000u)
+
+/**
+ * @brief USB pseudo interrupt flags
+ */
+#define SERIAL_FLAG_USB_TX		(0x2000u)
+#define SERIAL_FLAG_USB_RX		(0x1000u)
+#define SERIAL_FLAG_USB_CONNECT	(0x0800u)
 
 // UART1
 #define SERIAL0_RX_PORT			(GPIOA)
@@ -39,7 +55,15 @@ using namespace HAL;
 #define SERIAL0_BAUDRATE		(37000u)
 #define SERIAL0_PORT			(USART1)
 #define SERIAL0_INT_CHANNEL		(USART1_IRQn)
-#define SERIAL0_INT_PRIORTY		(1u)
+#define SERIAL0_INT_PRIORTY		(11u)	// Below configMAX_SYSCALL (RX task notification)
+#define SERIAL0_DMA_TX_STREAM	(DMA2_Stream7)
+#define SERIAL0_DMA_TX_CHANNEL	(DMA_Channel_4)
+#define SERIAL0_DMA_TX_FLAGS	(DMA_FLAG_TCIF7 | DMA_FLAG_HTIF7 | DMA_FLAG_TEIF7 | DMA_FLAG_DMEIF7 | DMA_FLAG_FEIF7)
+#define SERIAL0_DMA_TX_INT		(DMA2_Stream7_IRQn)
+#define SERIAL0_DMA_RX_STREAM	(DMA2_Stream2)
+#define SERIAL0_DMA_RX_CHANNEL	(DMA_Channel_4)
+#define SERIAL0_DMA_RX_FLAGS	(DMA_FLAG_TCIF2 | DMA_FLAG_HTIF2 | DMA_FLAG_TEIF2 | DMA_FLAG_DMEIF2 | DMA_FLAG_FEIF2)
+#define SERIAL0_DMA_RX_INT		(DMA2_Stream2_IRQn)
 
 // UART3
 #define SERIAL1_RX_PORT			(GPIOB)
@@ -52,7 +76,15 @@ using namespace HAL;
 #define SERIAL1_BAUDRATE		(115200u)
 #define SERIAL1_PORT			(USART3)
 #define SERIAL1_INT_CHANNEL		(USART3_IRQn)
-#define SERIAL1_INT_PRIORTY		(1u)
+#define SERIAL1_INT_PRIORTY		(11u)	// Below configMAX_SYSCALL (RX task notification)
+#define SERIAL1_DMA_TX_STREAM	(DMA1_Stream3)
+#define SERIAL1_DMA_TX_CHANNEL	(DMA_Channel_4)
+#define SERIAL1_DMA_TX_FLAGS	(DMA_FLAG_TCIF3 | DMA_FLAG_HTIF3 | DMA_FLAG_TEIF3 | DMA_FLAG_DMEIF3 | DMA_FLAG_FEIF3)
+#define SERIAL1_DMA_TX_INT		(DMA1_Stream3_IRQn)
+#define SERIAL1_DMA_RX_STREAM	(DMA1_Stream1)
+#define SERIAL1_DMA_RX_CHANNEL	(DMA_Channel_4)
+#define SERIAL1_DMA_RX_FLAGS	(DMA_FLAG_TCIF1 | DMA_FLAG_HTIF1 | DMA_FLAG_TEIF1 | DMA_FLAG_DMEIF1 | DMA_FLAG_FEIF1)
+#define SERIAL1_DMA_RX_INT		(DMA1_Stream1_IRQn)
 
 /*----------------------------------------------------------------------------*/
 /* Private Members                                                            */
@@ -63,15 +95,28 @@ using namespace HAL;
  */
 static Serial* _serial[Serial::SERIAL_MAX] = {NULL};
 
+/**
+ * @brief Serial instances storage
+ */
+static Utils::StaticStorage<Serial, Serial::SERIAL_MAX> _serialStorage;
+
 /**
  * @brief Serial receive buffer
  */
-static uint8_t _rxBuffer[Serial::SERIAL_MAX][SERIAL_BUFFER_SIZE];
+static uint8_t _rxBuffer[Serial::SERIAL_MAX][SERIAL_RX_BUFFER_SIZE];
 
 /**
  * @brief Serial transmit buffer
  */
-static uint8_t _txBuffer[Serial::SERIAL_MAX][SERIAL_BUFFER_SIZE];
+static uint8_t _txBuffer[Serial::SERIAL_MAX][SERIAL_TX_BUFFER_SIZE];
+
+/**
+ * @brief IRQ handlers execution time (TX and RX DMA share the same priority)
+ */
+static Utils::Profiler _usart1Profiler("USART1 IRQ");
+static Utils::Profiler _usart1DmaProfiler("USART1 DMA");
+static Utils::Profiler _usart3Profiler("USART3 IRQ");
+static Utils::Profiler _usart3DmaProfiler("USART3 DMA");
 
 
 /*----------------------------------------------------------------------------*/
@@ -104,6 +149,14 @@ static SERIAL_DEF _getSerialStruct (enum Serial::ID id)
 		serial.USART.PORT		=	SERIAL0_PORT;
 		serial.INT.CHANNEL		=	SERIAL0_INT_CHANNEL;
 		serial.INT.PRIORITY		=	SERIAL0_INT_PRIORTY;
+		serial.DMA_TX.STREAM	=	SERIAL0_DMA_TX_STREAM;
+		serial.DMA_TX.CHANNEL	=	SERIAL0_DMA_TX_CHANNEL;
+		serial.DMA_TX.FLAGS		=	SERIAL0_DMA_TX_FLAGS;
+		serial.DMA_TX.INT_CHANNEL	=	SERIAL0_DMA_TX_INT;
+		serial.DMA_RX.STREAM	=	SERIAL0_DMA_RX_STREAM;
+		serial.DMA_RX.CHANNEL	=	SERIAL0_DMA_RX_CHANNEL;
+		serial.DMA_RX.FLAGS		=	SERIAL0_DMA_RX_FLAGS;
+		serial.DMA_RX.INT_CHANNEL	=	SERIAL0_DMA_RX_INT;
 		break;
 	case Serial::SERIAL1:
 		serial.RX.PORT			=	SERIAL1_RX_PORT;
@@ -118,8 +171,19 @@ static SERIAL_DEF _getSerialStruct (enum Serial::ID id)
 		serial.USART.PORT		=	SERIAL1_PORT;
 		serial.INT.CHANNEL		=	SERIAL1_INT_CHANNEL;
 		serial.INT.PRIORITY		=	SERIAL1_INT_PRIORTY;
+		serial.DMA_TX.STREAM	=	SERIAL1_DMA_TX_STREAM;
+		serial.DMA_TX.CHANNEL	=	SERIAL1_DMA_TX_CHANNEL;
+		serial.DMA_TX.FLAGS		=	SERIAL1_DMA_TX_FLAGS;
+		serial.DMA_TX.INT_CHANNEL	=	SERIAL1_DMA_TX_INT;
+		serial.DMA_RX.STREAM	=	SERIAL1_DMA_RX_STREAM;
+		serial.DMA_RX.CHANNEL	=	SERIAL1_DMA_RX_CHANNEL;
+		serial.DMA_RX.FLAGS		=	SERIAL1_DMA_RX_FLAGS;
+		serial.DMA_RX.INT_CHANNEL	=	SERIAL1_DMA_RX_INT;
 		break;
+	// USB CDC, no USART nor DMA
+	case Serial::SERIAL_USB:
 	default:
+		memset(&serial, 0, sizeof(serial));
 		break;
 	}
 
@@ -135,6 +199,7 @@ static void _hardwareInit (enum Serial::ID id)
 	GPIO_InitTypeDef GPIOStruct;
 	USART_InitTypeDef UARTStruct;
 	NVIC_InitTypeDef NVICStruct;
+	DMA_InitTypeDef DMAStruct;
 
 	SERIAL_DEF serial;
 
@@ -169,8 +234,43 @@ static void _hardwareInit (enum Serial::ID id)
 
 	USART_Init(serial.USART.PORT, &UARTStruct);
 
-//	USART_ITConfig(serial.USART.PORT, USART_IT_RXNE, ENABLE);
-	//USART_ITConfig(serial.USART.PORT, USART_IT_TXE, ENABLE);
+	// DMA Init (common)
+	DMAStruct.DMA_PeripheralBaseAddr	=	(uint32_t)&serial.USART.PORT->DR;
+	DMAStruct.DMA_PeripheralInc			=	DMA_PeripheralInc_Disable;
+	DMAStruct.DMA_MemoryInc				=	DMA_MemoryInc_Enable;
+	DMAStruct.DMA_PeripheralDataSize	=	DMA_PeripheralDataSize_Byte;
+	DMAStruct.DMA_MemoryDataSize		=	DMA_MemoryDataSize_Byte;
+	DMAStruct.DMA_Priority				=	DMA_Priority_Low;
+	DMAStruct.DMA_FIFOMode				=	DMA_FIFOMode_Disable;
+	DMAStruct.DMA_FIFOThreshold			=	DMA_FIFOThreshold_Full;
+	DMAStruct.DMA_MemoryBurst			=	DMA_MemoryBurst_Single;
+	DMAStruct.DMA_PeripheralBurst		=	DMA_PeripheralBurst_Single;
+
+	// DMA TX : normal mode, started on each contiguous block
+	DMA_DeInit(serial.DMA_TX.STREAM);
+	DMAStruct.DMA_Channel				=	serial.DMA_TX.CHANNEL;
+	DMAStruct.DMA_Memory0BaseAddr		=	(uint32_t)_txBuffer[id];
+	DMAStruct.DMA_DIR					=	DMA_DIR_MemoryToPeripheral;
+	DMAStruct.DMA_BufferSize			=	1u;
+	DMAStruct.DMA_Mode					=	DMA_Mode_Normal;
+	DMA_Init(serial.DMA_TX.STREAM, &DMAStruct);
+	DMA_ITConfig(serial.DMA_TX.STREAM, DMA_IT_TC, ENABLE);
+
+	// DMA RX : circular mode on the whole RX buffer
+	DMA_DeInit(serial.DMA_RX.STREAM);
+	DMAStruct.DMA_Channel				=	serial.DMA_RX.CHANNEL;
+	DMAStruct.DMA_Memory0BaseAddr		=	(uint32_t)_rxBuffer[id];
+	DMAStruct.DMA_DIR					=	DMA_DIR_PeripheralToMemory;
+	DMAStruct.DMA_BufferSize			=	SERIAL_RX_BUFFER_SIZE;
+	DMAStruct.DMA_Mode					=	DMA_Mode_Circular;
+	DMA_Init(serial.DMA_RX.STREAM, &DMAStruct);
+	DMA_ITConfig(serial.DMA_RX.STREAM, DMA_IT_HT | DMA_IT_TC, ENABLE);
+	DMA_Cmd(serial.DMA_RX.STREAM, ENABLE);
+
+	USART_DMACmd(serial.USART.PORT, USART_DMAReq_Tx | USART_DMAReq_Rx, ENABLE);
+
+	// Idle line is used to notify received data
+	USART_ITConfig(serial.USART.PORT, USART_IT_IDLE, ENABLE);
 
 	//NVIC Init
 	NVICStruct.NVIC_IRQChannelCmd					=	ENABLE;
@@ -178,7 +278,32 @@ static void _hardwareInit (enum Serial::ID id)
 	NVICStruct.NVIC_IRQChannelPreemptionPriority	=	serial.INT.PRIORITY;
 	NVICStruct.NVIC_IRQChannel						=	serial.INT.CHANNEL;
 
-//	NVIC_Init(&NVICStruct);
+	NVIC_Init(&NVICStruct);
+
+	NVICStruct.NVIC_IRQChannel						=	serial.DMA_TX.INT_CHANNEL;
+	NVIC_Init(&NVICStruct);
+
+	NVICStruct.NVIC_IRQChannel						=	serial.DMA_RX.INT_CHANNEL;
+	NVIC_Init(&NVICStruct);
+}
+
+/**
+ * @brief USB events, forwarded as pseudo interrupt flags
+ * @param obj : Serial instance
+ */
+static void _usbReceivedEvent (void* obj)
+{
+	reinterpret_cast<Serial*>(obj)->INTERNAL_InterruptCallback(SERIAL_FLAG_USB_RX);
+}
+
+static void _usbTransmittedEvent (void* obj)
+{
+	reinterpret_cast<Serial*>(obj)->INTERNAL_InterruptCallback(SERIAL_FLAG_USB_TX);
+}
+
+static void _usbConfiguredEvent (void* obj)
+{
+	reinterpret_cast<Serial*>(obj)->INTERNAL_InterruptCallback(SERIAL_FLAG_USB_CONNECT);
 }
 
 /*----------------------------------------------------------------------------*/
@@ -199,7 +324,7 @@ namespace HAL
 		else
 		{
 			// Create Serial instance
-			_serial[id] = new Serial(id);
+			_serial[id] = new (_serialStorage.Get(id)) Serial(id);
 
 			return _serial[id];
 		}
@@ -211,192 +336,487 @@ namespace HAL
 		this->def = _getSerialStruct(id);
 		this->rxBuffer.rdIndex = 0;
 		this->rxBuffer.wrIndex = 0;
+		this->rxBuffer.size = SERIAL_RX_BUFFER_SIZE;
 		this->rxBuffer.data = _rxBuffer[id];
 		this->txBuffer.rdIndex = 0;
 		this->txBuffer.wrIndex = 0;
+		this->txBuffer.size = SERIAL_TX_BUFFER_SIZE;
 		this->txBuffer.data = _txBuffer[id];
+		this->txHead = 0;
+		this->txEnd = SERIAL_TX_BUFFER_SIZE;
+		this->txReserved = false;
+		this->txReserveIndex = 0;
+		this->txReserveLength = 0;
+		this->txLength = 0;
+		this->txDropped = 0;
+		this->txSent = 0;
+		this->rxTask = NULL;
+		this->breakChar = '\0';
+		this->breakIndex = 0;
+		this->usb = NULL;
+
+		if(id == Serial::SERIAL_USB)
+		{
+			this->usb = UsbCdc::GetInstance();
+
+			this->usb->DataReceived.Subscribe(this, &_usbReceivedEvent);
+			this->usb->TransmitComplete.Subscribe(this, &_usbTransmittedEvent);
+			this->usb->Configured.Subscribe(this, &_usbConfiguredEvent);
+		}
+		else
+		{
+			_hardwareInit(id);
+		}
+	}
+
+	uint32_t Serial::BytesToRead ()
+	{
+		uint32_t wrIndex = this->rxWriteIndex();
 
-		_hardwareInit(id);
+		return (wrIndex + this->rxBuffer.size - this->rxBuffer.rdIndex) % this->rxBuffer.size;
 	}
 
-	bool Serial::Send (uint8_t byte)
+	bool Serial::WaitForData (TickType_t timeout)
 	{
-		bool sent = false;
+		// Register before checking, a byte received in between leaves the notification pending
+		this->rxTask = xTaskGetCurrentTaskHandle();
 
-		if((this->txBuffer.wrIndex + 1) < SERIAL_BUFFER_SIZE)
+		if(this->BytesToRead() == 0)
 		{
-			this->txBuffer.data[this->txBuffer.wrIndex++] = byte;
+			ulTaskNotifyTake(pdTRUE, timeout);
+		}
 
-			USART_SendData(this->def.USART.PORT, this->txBuffer.data[this->txBuffer.rdIndex++]);
+		this->rxTask = NULL;
 
-			sent = true;
-		}
+		return (this->BytesToRead() > 0);
+	}
 
-		return sent;
+	uint32_t Serial::BytesToSend ()
+	{
+		uint32_t head = this->txHead;
+		uint32_t rdIndex = this->txBuffer.rdIndex;
+
+		return (head >= rdIndex) ? (head - rdIndex) : (this->txEnd - rdIndex + head);
 	}
 
-	bool Serial::Send (string& str)
+	bool Serial::Send (uint8_t byte)
 	{
-		bool sent = false;
-		size_t length = str.length();
+		return this->Send(&byte, 1u);
+	}
 
-		if(((this->txBuffer.wrIndex + length) < SERIAL_BUFFER_SIZE) &&
-			(length > 0))
-		{
-			memcpy(this->txBuffer.data, str.c_str(), length);
+	bool Serial::Send (const char * c_str)
+	{
+		return this->Send((const uint8_t*)c_str, strlen(c_str));
+	}
 
-			this->txBuffer.wrIndex += length;
+	bool Serial::Send (const uint8_t * buffer, uint32_t length)
+	{
+		bool sent = false;
+		uint32_t primask;
 
-			USART_ITConfig(this->def.USART.PORT, USART_IT_TXE, ENABLE);
-			//USART_SendData(this->def.USART.PORT, this->txBuffer.data[this->txBuffer.rdIndex++]);
+		if(length == 0)
+			return false;
 
+		// Shared with DMA interrupt and other tasks
+		primask = __get_PRIMASK();
+		__disable_irq();
+
+		if(length <= this->txFree())
+		{
+			this->Write(buffer, length);
 			sent = true;
 		}
+		else
+		{
+			this->txDropped += length;
+		}
+
+		__set_PRIMASK(primask);
 
 		return sent;
 	}
 
-	bool Serial::Send (const char * c_str)
+	uint32_t Serial::Write (const uint8_t * buffer, uint32_t length)
 	{
-		bool sent = false;
+		uint32_t primask;
+		uint32_t space = 0, block = 0, wrIndex = 0;
 
-		size_t length = strlen(c_str);
+		primask = __get_PRIMASK();
+		__disable_irq();
 
-		if(((this->txBuffer.wrIndex + length) < SERIAL_BUFFER_SIZE) &&
-		   (length > 0))
-		{
-			memcpy(this->txBuffer.data, c_str, length);
+		space = this->txFree();
 
-			this->txBuffer.wrIndex += length;
+		if(length > space)
+			length = space;
 
-			USART_ITConfig(this->def.USART.PORT, USART_IT_TXE, ENABLE);
-			//USART_SendData(this->def.USART.PORT, this->txBuffer.data[this->txBuffer.rdIndex++]);
-		}
+		// Copy in two blocks at most (buffer wrap)
+		wrIndex = this->txHead;
+		block = this->txBuffer.size - wrIndex;
+		if(block > length)
+			block = length;
 
-		return sent;
+		memcpy(&this->txBuffer.data[wrIndex], buffer, block);
+		memcpy(this->txBuffer.data, &buffer[block], length - block);
+
+		this->txHead = (wrIndex + length) % this->txBuffer.size;
+
+		this->txPublish();
+
+		__set_PRIMASK(primask);
+
+		return length;
 	}
 
-	bool Serial::Send (const uint8_t * buffer, uint32_t length)
+	uint32_t Serial::Post (const uint8_t * buffer, uint32_t length)
 	{
-		bool sent = false;
+		uint32_t primask;
+		uint32_t written;
 
-		if(((this->txBuffer.wrIndex + length) < SERIAL_BUFFER_SIZE) &&
-		   (length > 0))
-		{
-			memcpy(this->txBuffer.data, buffer, length);
+		primask = __get_PRIMASK();
+		__disable_irq();
 
-			this->txBuffer.wrIndex += length;
+		written = this->Write(buffer, length);
+		this->txDropped += length - written;
 
-			USART_ITConfig(this->def.USART.PORT, USART_IT_TXE, ENABLE);
-			//USART_SendData(this->def.USART.PORT, this->txBuffer.data[this->txBuffer.rdIndex++]);
-		}
+		__set_PRIMASK(primask);
 
-		return sent;
+		return written;
 	}
 
-	uint8_t Serial::Read ()
+	uint8_t * Serial::Reserve (uint32_t length)
 	{
-		uint8_t byte = 0;
+		uint8_t * block = NULL;
+		uint32_t primask;
+		uint32_t head, rdIndex, index = 0;
 
-		if(this->rxBuffer.rdIndex < this->rxBuffer.wrIndex)
+		primask = __get_PRIMASK();
+		__disable_irq();
+
+		head = this->txHead;
+		rdIndex = this->txBuffer.rdIndex;
+
+		// Empty (DMA idle) : restart at buffer start, whole buffer is contiguous
+		if((head == rdIndex) && !this->txReserved)
 		{
-			byte = this->rxBuffer.data[this->rxBuffer.rdIndex++];
+			head = 0;
+			rdIndex = 0;
+			this->txHead = 0;
+			this->txBuffer.wrIndex = 0;
+			this->txBuffer.rdIndex = 0;
 		}
-		else
+
+		if(!this->txReserved && (length > 0u))
 		{
-			byte = this->rxBuffer.data[this->rxBuffer.rdIndex];
+			// One byte is kept free to distinguish full and empty buffer
+			if(head >= rdIndex)
+			{
+				if(length <= (this->txBuffer.size - head - ((rdIndex == 0u) ? 1u : 0u)))
+				{
+					index = head;
+					block = &this->txBuffer.data[index];
+				}
+				else if(length < rdIndex)
+				{
+					// Buffer end too short : skipped by DMA
+					this->txEnd = head;
+					index = 0;
+					block = this->txBuffer.data;
+				}
+			}
+			else if(length < (rdIndex - head))
+			{
+				index = head;
+				block = &this->txBuffer.data[index];
+			}
+		}
 
-			this->rxBuffer.wrIndex = 0;
-			this->rxBuffer.rdIndex = 0;
+		if(block != NULL)
+		{
+			this->txReserved = true;
+			this->txReserveIndex = index;
+			this->txReserveLength = length;
+			this->txHead = (index + length) % this->txBuffer.size;
+		}
+		else
+		{
+			this->txDropped += length;
 		}
 
-		return byte;
+		__set_PRIMASK(primask);
+
+		return block;
 	}
 
-	void Serial::Read (uint8_t * buffer, uint32_t& length)
+	void Serial::Commit (uint32_t length)
 	{
-		if((this->rxBuffer.rdIndex + length) < this->rxBuffer.wrIndex)
+		uint32_t primask;
+
+		primask = __get_PRIMASK();
+		__disable_irq();
+
+		if(this->txReserved)
 		{
-			memcpy(buffer, &this->rxBuffer.data[this->rxBuffer.rdIndex], length);
+			if(length > this->txReserveLength)
+				length = this->txReserveLength;
 
-			this->rxBuffer.rdIndex += length;
+			// Last queued block : give unused bytes back, else send them as delimiters
+			if(this->txHead == ((this->txReserveIndex + this->txReserveLength) % this->txBuffer.size))
+				this->txHead = (this->txReserveIndex + length) % this->txBuffer.size;
+			else
+				memset(&this->txBuffer.data[this->txReserveIndex + length], 0, this->txReserveLength - length);
+
+			this->txReserved = false;
+			this->txPublish();
 		}
+
+		__set_PRIMASK(primask);
+	}
+
+	uint32_t Serial::txFree ()
+	{
+		uint32_t head = this->txHead;
+		uint32_t rdIndex = this->txBuffer.rdIndex;
+
+		// One byte is kept free to distinguish full and empty buffer
+		if(head >= rdIndex)
+			return this->txBuffer.size - (head - rdIndex) - 1u;
 		else
+			return rdIndex - head - 1u;
+	}
+
+	void Serial::txPublish ()
+	{
+		if(this->txReserved)
+			return;
+
+		this->txBuffer.wrIndex = this->txHead;
+
+		if(this->txLength == 0)
+			this->startTransmission();
+	}
+
+	void Serial::startTransmission ()
+	{
+		DMA_Stream_TypeDef * stream = this->def.DMA_TX.STREAM;
+		uint32_t rdIndex = this->txBuffer.rdIndex;
+		uint32_t wrIndex = this->txBuffer.wrIndex;
+		uint32_t length = 0;
+
+		if(rdIndex == wrIndex)
 		{
-			length = this->rxBuffer.wrIndex - this->rxBuffer.rdIndex;
+			this->txLength = 0;
+			return;
+		}
+
+		// Contiguous block only, next block is started on transfer complete
+		if(wrIndex > rdIndex)
+			length = wrIndex - rdIndex;
+		else
+			length = this->txEnd - rdIndex;
 
-			memcpy(buffer, &this->rxBuffer.data[this->rxBuffer.rdIndex], length);
+		// Bulk IN transfer, nothing is sent until the host configured the device
+		if(this->usb != NULL)
+		{
+			this->txLength = this->usb->Transmit(&this->txBuffer.data[rdIndex], length);
+			return;
 		}
 
-		this->rxBuffer.rdIndex += length;
+		this->txLength = length;
+
+		DMA_ClearFlag(stream, this->def.DMA_TX.FLAGS);
+		stream->M0AR = (uint32_t)&this->txBuffer.data[rdIndex];
+		DMA_SetCurrDataCounter(stream, length);
+		DMA_Cmd(stream, ENABLE);
+	}
 
-		if(this->rxBuffer.rdIndex == this->rxBuffer.wrIndex)
+	void Serial::SetBreakChar (char c)
+	{
+		this->breakIndex = this->rxWriteIndex();
+		this->breakChar = c;
+	}
+
+	uint32_t Serial::rxWriteIndex ()
+	{
+		uint32_t remaining;
+
+		// Written by usbReceive()
+		if(this->usb != NULL)
+			return this->rxBuffer.wrIndex;
+
+		remaining = DMA_GetCurrDataCounter(this->def.DMA_RX.STREAM);
+
+		this->rxBuffer.wrIndex = (this->rxBuffer.size - remaining) % this->rxBuffer.size;
+
+		return this->rxBuffer.wrIndex;
+	}
+
+	uint8_t Serial::Read ()
+	{
+		uint8_t byte = 0;
+
+		if(this->BytesToRead() > 0)
 		{
-			this->rxBuffer.rdIndex = 0;
-			this->rxBuffer.wrIndex = 0;
+			byte = this->rxBuffer.data[this->rxBuffer.rdIndex];
+			this->rxBuffer.rdIndex = (this->rxBuffer.rdIndex + 1u) % this->rxBuffer.size;
 		}
+
+		this->usbReceive();
+
+		return byte;
 	}
 
-	string Serial::ReadLine ()
+	void Serial::Read (uint8_t * buffer, uint32_t& length)
 	{
-		string str = NULL;
+		uint32_t available = this->BytesToRead();
+		uint32_t i = 0;
 
-		if(this->rxBuffer.rdIndex < this->rxBuffer.wrIndex)
+		if(length > available)
+			length = available;
+
+		for(i = 0; i < length; i++)
 		{
-			uint32_t length = 0;
-			char * pCh = strchr((const char*)&this->rxBuffer.data[this->rxBuffer.rdIndex], '\n');
+			buffer[i] = this->rxBuffer.data[this->rxBuffer.rdIndex];
+			this->rxBuffer.rdIndex = (this->rxBuffer.rdIndex + 1u) % this->rxBuffer.size;
+		}
 
-			if(pCh != NULL)
-			{
-				length = (uint32_t)((char*)pCh - (char*)&this->rxBuffer.data[this->rxBuffer.rdIndex]) + 1u;
+		this->usbReceive();
+	}
 
-				if((this->rxBuffer.rdIndex + length)  < SERIAL_BUFFER_SIZE)
-				{
-					str = string((const char*)&this->rxBuffer.data[this->rxBuffer.rdIndex], length);
+	uint32_t Serial::ReadLine (char * buffer, uint32_t size)
+	{
+		uint32_t available = this->BytesToRead();
+		uint32_t index = this->rxBuffer.rdIndex;
+		uint32_t length = 0;
+		uint32_t copied = 0;
 
-					this->rxBuffer.rdIndex += length;
+		if((buffer == NULL) || (size == 0u))
+			return 0;
 
-					if(this->rxBuffer.rdIndex == this->rxBuffer.wrIndex)
+		// Search for '\n' without consuming
+		for(length = 1; length <= available; length++)
+		{
+			if(this->rxBuffer.data[index] == '\n')
+			{
+				while(length-- > 0)
+				{
+					if(copied < (size - 1u))
 					{
-						this->rxBuffer.rdIndex = 0;
-						this->rxBuffer.wrIndex = 0;
+						buffer[copied++] = (char)this->rxBuffer.data[this->rxBuffer.rdIndex];
 					}
+					this->rxBuffer.rdIndex = (this->rxBuffer.rdIndex + 1u) % this->rxBuffer.size;
 				}
+				break;
 			}
+
+			index = (index + 1u) % this->rxBuffer.size;
 		}
 
-		return str;
+		buffer[copied] = '\0';
+
+		this->usbReceive();
+
+		return copied;
+	}
+
+	void Serial::usbReceive ()
+	{
+		uint32_t primask;
+		uint32_t space = 0, block = 0, wrIndex = 0, length = 0;
+
+		if(this->usb == NULL)
+			return;
+
+		// Shared with OTG interrupt and reading task
+		primask = __get_PRIMASK();
+		__disable_irq();
+
+		// One byte is kept free to distinguish full and empty buffer
+		space = this->rxBuffer.size - this->BytesToRead() - 1u;
+
+		// Copy in two blocks at most (buffer wrap), bytes left are held in USB packet
+		wrIndex = this->rxBuffer.wrIndex;
+		block = this->rxBuffer.size - wrIndex;
+		if(block > space)
+			block = space;
+
+		length = this->usb->Receive(&this->rxBuffer.data[wrIndex], block);
+		if(length == block)
+			length += this->usb->Receive(this->rxBuffer.data, space - block);
+
+		this->rxBuffer.wrIndex = (wrIndex + length) % this->rxBuffer.size;
+
+		__set_PRIMASK(primask);
 	}
 
 	void Serial::INTERNAL_InterruptCallback(uint16_t flag)
 	{
-		// Manage transmission
-		if(flag == USART_FLAG_TXE)
+		// Manage DMA transmission
+		if((flag == SERIAL_FLAG_DMA_TX) || (flag == SERIAL_FLAG_USB_TX))
 		{
-			if(this->txBuffer.rdIndex < this->txBuffer.wrIndex)
-			{
-				USART_SendData(this->def.USART.PORT, this->txBuffer.data[this->txBuffer.rdIndex++]);
-			}
-			else
+			this->txSent += this->txLength;
+			this->txBuffer.rdIndex = (this->txBuffer.rdIndex + this->txLength) % this->txBuffer.size;
+
+			// Skipped buffer end
+			if(this->txBuffer.rdIndex == this->txEnd)
 			{
 				this->txBuffer.rdIndex = 0;
-				this->txBuffer.wrIndex = 0;
+				this->txEnd = this->txBuffer.size;
 			}
+
+			this->startTransmission();
+
+			// Wait for the last byte to be sent (USB : last packet acknowledged by the host)
+			if((this->txLength == 0) && (this->usb != NULL))
+				this->EndOfTransmission();
+			else if(this->txLength == 0)
+				USART_ITConfig(this->def.USART.PORT, USART_IT_TC, ENABLE);
+		}
+		// Host configured the device, send what was buffered meanwhile
+		else if(flag == SERIAL_FLAG_USB_CONNECT)
+		{
+			if(this->txLength == 0)
+				this->startTransmission();
 		}
 		// Manage end of transmission
 		else if(flag == USART_FLAG_TC)
 		{
-			USART_ITConfig(this->def.USART.PORT, USART_IT_TXE, DISABLE);
+			USART_ITConfig(this->def.USART.PORT, USART_IT_TC, DISABLE);
 
 			this->EndOfTransmission();
 		}
-		else if(flag == USART_FLAG_RXNE)
+		// Manage reception (idle line or DMA half/full buffer)
+		else if((flag == USART_FLAG_IDLE) || (flag == SERIAL_FLAG_DMA_RX) || (flag == SERIAL_FLAG_USB_RX))
 		{
-			if(this->rxBuffer.wrIndex < (SERIAL_BUFFER_SIZE - 1))
+			this->usbReceive();
+
+			// Scan new bytes for break character, raised before waking up readers
+			if(this->breakChar != '\0')
 			{
-				this->rxBuffer.data[this->rxBuffer.wrIndex++] = (uint8_t)USART_ReceiveData(this->def.USART.PORT);
+				uint32_t wrIndex = this->rxWriteIndex();
+				bool found = false;
 
+				while(this->breakIndex != wrIndex)
+				{
+					if(this->rxBuffer.data[this->breakIndex] == (uint8_t)this->breakChar)
+						found = true;
+					this->breakIndex = (this->breakIndex + 1u) % this->rxBuffer.size;
+				}
+
+				if(found)
+					this->BreakReceived();
+			}
+
+			if(this->BytesToRead() > 0)
+			{
 				this->DataReceived();
+
+				if(this->rxTask != NULL)
+				{
+					BaseType_t woken = pdFALSE;
+
+					vTaskNotifyGiveFromISR(this->rxTask, &woken);
+					portYIELD_FROM_ISR(woken);
+				}
 			}
 		}
 	}
@@ -413,24 +833,63 @@ extern "C"
 	 */
 	void USART1_IRQHandler (void)
 	{
-		Serial* serial = Serial::GetInstance(Serial::SERIAL0);
+		_usart1Profiler.Start();
+
+		Serial* serial = _serial[Serial::SERIAL0];
 
-		if(USART_GetFlagStatus(USART1, USART_FLAG_TXE) == SET)
+		if(USART_GetITStatus(USART1, USART_IT_TC) == SET)
 		{
-			serial->INTERNAL_InterruptCallback(USART_FLAG_TXE);
+			USART_ClearITPendingBit(USART1, USART_IT_TC);
+
+			serial->INTERNAL_InterruptCallback(USART_FLAG_TC);
 		}
-		else if(USART_GetFlagStatus(USART1, USART_FLAG_TC) == SET)
+		if(USART_GetITStatus(USART1, USART_IT_IDLE) == SET)
 		{
-			USART_ClearFlag(USART1, USART_FLAG_TC);
+			// Idle flag is cleared by reading SR then DR
+			(void)USART_ReceiveData(USART1);
 
-			serial->INTERNAL_InterruptCallback(USART_FLAG_TC);
+			serial->INTERNAL_InterruptCallback(USART_FLAG_IDLE);
 		}
-		else if(USART_GetFlagStatus(USART1, USART_FLAG_RXNE) == SET)
+
+		_usart1Profiler.Stop();
+	}
+
+	/**
+	 * @brief USART1 DMA TX IRQ Handler
+	 */
+	void DMA2_Stream7_IRQHandler (void)
+	{
+		_usart1DmaProfiler.Start();
+
+		if(DMA_GetITStatus(DMA2_Stream7, DMA_IT_TCIF7) == SET)
 		{
-			USART_ClearFlag(USART1, USART_FLAG_RXNE);
+			DMA_ClearITPendingBit(DMA2_Stream7, DMA_IT_TCIF7);
+
+			_serial[Serial::SERIAL0]->INTERNAL_InterruptCallback(SERIAL_FLAG_DMA_TX);
+		}
+
+		_usart1DmaProfiler.Stop();
+	}
+
+	/**
+	 * @brief USART1 DMA RX IRQ Handler
+	 */
+	void DMA2_Stream2_IRQHandler (void)
+	{
+		_usart1DmaProfiler.Start();
 
-			serial->INTERNAL_InterruptCallback(USART_FLAG_RXNE);
+		if(DMA_GetITStatus(DMA2_Stream2, DMA_IT_HTIF2) == SET)
+		{
+			DMA_ClearITPendingBit(DMA2_Stream2, DMA_IT_HTIF2);
+		}
+		if(DMA_GetITStatus(DMA2_Stream2, DMA_IT_TCIF2) == SET)
+		{
+			DMA_ClearITPendingBit(DMA2_Stream2, DMA_IT_TCIF2);
 		}
+
+		_serial[Serial::SERIAL0]->INTERNAL_InterruptCallback(SERIAL_FLAG_DMA_RX);
+
+		_usart1DmaProfiler.Stop();
 	}
 
 	/**
@@ -438,24 +897,63 @@ extern "C"
 	 */
 	void USART3_IRQHandler (void)
 	{
-		Serial* serial = Serial::GetInstance(Serial::SERIAL1);
+		_usart3Profiler.Start();
 
-		if(USART_GetFlagStatus(USART3, USART_FLAG_TXE) == SET)
+		Serial* serial = _serial[Serial::SERIAL1];
+
+		if(USART_GetITStatus(USART3, USART_IT_TC) == SET)
 		{
-			serial->INTERNAL_InterruptCallback(USART_FLAG_TXE);
+			USART_ClearITPendingBit(USART3, USART_IT_TC);
+
+			serial->INTERNAL_InterruptCallback(USART_FLAG_TC);
 		}
-		else if(USART_GetFlagStatus(USART3, USART_FLAG_TC) == SET)
+		if(USART_GetITStatus(USART3, USART_IT_IDLE) == SET)
 		{
-			serial->INTERNAL_InterruptCallback(USART_FLAG_TC);
+			// Idle flag is cleared by reading SR then DR
+			(void)USART_ReceiveData(USART3);
 
-			USART_ClearFlag(USART3, USART_FLAG_TC);
+			serial->INTERNAL_InterruptCallback(USART_FLAG_IDLE);
 		}
-		else if(USART_GetFlagStatus(USART3, USART_FLAG_RXNE) == SET)
+
+		_usart3Profiler.Stop();
+	}
+
+	/**
+	 * @brief USART3 DMA TX IRQ Handler
+	 */
+	void DMA1_Stream3_IRQHandler (void)
+	{
+		_usart3DmaProfiler.Start();
+
+		if(DMA_GetITStatus(DMA1_Stream3, DMA_IT_TCIF3) == SET)
 		{
-			serial->INTERNAL_InterruptCallback(USART_FLAG_RXNE);
+			DMA_ClearITPendingBit(DMA1_Stream3, DMA_IT_TCIF3);
 
-			USART_ClearFlag(USART3, USART_FLAG_RXNE);
+			_serial[Serial::SERIAL1]->INTERNAL_InterruptCallback(SERIAL_FLAG_DMA_TX);
 		}
+
+		_usart3DmaProfiler.Stop();
+	}
+
+	/**
+	 * @brief USART3 DMA RX IRQ Handler
+	 */
+	void DMA1_Stream1_IRQHandler (void)
+	{
+		_usart3DmaProfiler.Start();
+
+		if(DMA_GetITStatus(DMA1_Stream1, DMA_IT_HTIF1) == SET)
+		{
+			DMA_ClearITPendingBit(DMA1_Stream1, DMA_IT_HTIF1);
+		}
+		if(DMA_GetITStatus(DMA1_Stream1, DMA_IT_TCIF1) == SET)
+		{
+			DMA_ClearITPendingBit(DMA1_Stream1, DMA_IT_TCIF1);
+		}
+
+		_serial[Serial::SERIAL1]->INTERNAL_InterruptCallback(SERIAL_FLAG_DMA_RX);
+
+		_usart3DmaProfiler.Stop();
 	}
 }
 
@@ -467,6 +965,7 @@ extern "C"
 {
 	int _read (int file, char *ptr, int len)
 	{
+		Serial* serial = _serial[SERIAL_CONSOLE];
 		int DataIdx;
 
 		if (len == 0)
@@ -477,10 +976,20 @@ extern "C"
 
 		for (DataIdx = 0; DataIdx < len; DataIdx++)
 		{
-			/* Loop until received data register is empty */
-			while ((USART1->SR & USART_SR_RXNE) == 0)
-			{}
-			*ptr++ = USART_ReceiveData(USART1);
+			if(serial != NULL)
+			{
+				/* Loop until RX buffer is empty */
+				while (serial->BytesToRead() == 0)
+				{}
+				*ptr++ = serial->Read();
+			}
+			else
+			{
+				/* Loop until received data register is empty */
+				while ((USART1->SR & USART_SR_RXNE) == 0)
+				{}
+				*ptr++ = USART_ReceiveData(USART1);
+			}
 		}
 
 		return len;
@@ -488,8 +997,20 @@ extern "C"
 
 	int _write(int file, char *ptr, int len)
 	{
+		Serial* serial = _serial[SERIAL_CONSOLE];
 		int DataIdx;
 
+		/* SWO log port selected : keep console serial for the command link */
+		if(SWO::IsRouted(SWO::LOG))
+			return SWO::GetInstance()->Write(SWO::LOG, (const uint8_t*)ptr, len);
+
+		if(serial != NULL)
+		{
+			/* Never blocks the caller : what does not fit in TX buffer is dropped (DMA transmission) */
+			serial->Post((const uint8_t*)ptr, len);
+			return len;
+		}
+
 		for (DataIdx = 0; DataIdx < len; DataIdx++)
 		{
 			/* Loop until transmit data register is empty */
@@ -0,0 +1,248 @@
+/**
+ * @file	Servo.cpp
+ * @author	Kevin WYSOCKI
+ * @date	22 oct. 2017
+ * @brief	Hobby servo driver with speed-limited motion
+ */
+
+#include <stddef.h>
+#include "Servo.hpp"
+#include "StaticStorage.hpp"
+
+using namespace HAL;
+
+/*----------------------------------------------------------------------------*/
+/* Definitions                                                                */
+/*----------------------------------------------------------------------------*/
+
+#define SERVO_FREQ				(50u)		// Standard analog servo frame
+#define SERVO_MIN_PULSE			(1000u)		// us
+#define SERVO_MAX_PULSE			(2000u)		// us
+
+#define SERVO_FIRST_TIM2_PWM	(PWM::PWM4)
+#define SERVO_FIRST_TIM5_PWM	(PWM::PWM16)
+
+/*----------------------------------------------------------------------------*/
+/* Private Members                                                            */
+/*----------------------------------------------------------------------------*/
+
+/**
+ * @brief Servo instances
+ */
+static Servo* _servo[Servo::SERVO_MAX] = {NULL};
+
+/**
+ * @brief Servo instances storage
+ */
+static Utils::StaticStorage<Servo, Servo::SERVO_MAX> _servoStorage;
+
+/**
+ * @brief Motion update timer (started with the first instance)
+ */
+static SoftTimer _servoTimer;
+
+/*----------------------------------------------------------------------------*/
+/* Private Functions                                                          */
+/*----------------------------------------------------------------------------*/
+
+/**
+ * @brief Retrieve servo definitions from ID
+ * @param id : Servo ID
+ * @return SERVO_DEF structure
+ */
+static SERVO_DEF _getServoStruct (enum Servo::ID id)
+{
+	SERVO_DEF servo;
+
+	assert(id < Servo::SERVO_MAX);
+
+	// Four contiguous channels per timer
+	if(id < Servo::SERVO5)
+		servo.PWM	=	(enum PWM::ID)(SERVO_FIRST_TIM2_PWM + id);
+	else
+		servo.PWM	=	(enum PWM::ID)(SERVO_FIRST_TIM5_PWM + (id - Servo::SERVO5));
+
+	servo.FREQ		=	SERVO_FREQ;
+	servo.MIN_PULSE	=	SERVO_MIN_PULSE;
+	servo.MAX_PULSE	=	SERVO_MAX_PULSE;
+
+	return servo;
+}
+
+/**
+ * @brief Update all servos (software timer interrupt)
+ * @param obj : unused
+ */
+static void _updateEvent (void* obj)
+{
+	for(uint32_t i = 0u; i < Servo::SERVO_MAX; i++)
+	{
+		if(_servo[i] != NULL)
+			_servo[i]->INTERNAL_Update();
+	}
+}
+
+/*----------------------------------------------------------------------------*/
+/* Class Implementation	                                                      */
+/*----------------------------------------------------------------------------*/
+namespace HAL
+{
+	Servo* Servo::GetInstance (enum Servo::ID id)
+	{
+		assert(id < Servo::SERVO_MAX);
+
+		// if instance already exists
+		if(_servo[id] != NULL)
+		{
+			return _servo[id];
+		}
+		else
+		{
+			// Create instance, update callback reads it once registered
+			_servo[id] = new (_servoStorage.Get(id)) Servo(id);
+
+			if(!_servoTimer.IsRunning())
+			{
+				_servoTimer.Elapsed += _updateEvent;
+				_servoTimer.Start(SERVO_UPDATE_PERIOD, SERVO_UPDATE_PERIOD);
+			}
+
+			return _servo[id];
+		}
+	}
+
+	Servo::Servo (enum Servo::ID id)
+	{
+		this->id = id;
+		this->def = _getServoStruct(id);
+		this->pwm = PWM::GetInstance(this->def.PWM);
+
+		assert((this->def.FREQ >= SERVO_MIN_FREQ) && (this->def.FREQ <= SERVO_MAX_FREQ));
+
+		// Timer frame is shared by the four channels, no pulse until first position
+		this->pwm->SetFrequency(this->def.FREQ);
+		this->pwm->SetCompare(0u);
+		if(this->pwm->GetState() == PWM::DISABLED)
+			this->pwm->SetState(PWM::ENABLED);
+
+		this->speed = 0.0f;
+		this->step = 0u;
+		this->current = 0u;
+		this->target = 0u;
+		this->released = true;
+
+		this->SetRange(this->def.MIN_PULSE, this->def.MAX_PULSE);
+	}
+
+	void Servo::SetPosition (float32_t position)
+	{
+		uint32_t counts, primask;
+
+		if(position > 1.0f)
+			position = 1.0f;
+		else if(position < 0.0f)
+			position = 0.0f;
+
+		counts = this->min + (uint32_t)((float32_t)(this->max - this->min) * position);
+
+		primask = __get_PRIMASK();
+		__disable_irq();
+
+		this->target = counts;
+
+		// Unknown servo position : no profile
+		if(this->released)
+		{
+			this->current = counts;
+			this->pwm->SetCompare(counts);
+			this->released = false;
+		}
+
+		__set_PRIMASK(primask);
+	}
+
+	float32_t Servo::GetPosition ()
+	{
+		if(this->released)
+			return 0.0f;
+
+		return (float32_t)(this->current - this->min) / (float32_t)(this->max - this->min);
+	}
+
+	void Servo::SetSpeed (float32_t speed)
+	{
+		float32_t counts;
+
+		assert(speed >= 0.0f);
+
+		this->speed = speed;
+
+		// Position units per second to compare counts per update
+		counts = speed * (float32_t)(this->max - this->min) * (float32_t)(SERVO_UPDATE_PERIOD * SOFTTIMER_TICK_US) / 1000000.0f;
+
+		if(speed == 0.0f)
+			this->step = 0u;
+		else if(counts < 1.0f)
+			this->step = 1u;
+		else
+			this->step = (uint32_t)counts;
+	}
+
+	void Servo::SetRange (uint16_t min, uint16_t max)
+	{
+		assert(min < max);
+		assert(max < (1000000u / this->def.FREQ));
+
+		this->def.MIN_PULSE = min;
+		this->def.MAX_PULSE = max;
+
+		this->min = this->toCounts(min);
+		this->max = this->toCounts(max);
+
+		this->SetSpeed(this->speed);
+	}
+
+	void Servo::Release ()
+	{
+		uint32_t primask;
+
+		primask = __get_PRIMASK();
+		__disable_irq();
+
+		this->released = true;
+		this->target = this->current;
+		this->pwm->SetCompare(0u);
+
+		__set_PRIMASK(primask);
+	}
+
+	uint32_t Servo::toCounts (uint32_t us)
+	{
+		uint64_t counts;
+
+		// Frame is (ARR + 1) counts long
+		counts = (uint64_t)us * (uint64_t)(this->pwm->GetCompareMax() + 1u) * (uint64_t)this->pwm->GetFrequency();
+
+		return (uint32_t)(counts / 1000000u);
+	}
+
+	void Servo::INTERNAL_Update ()
+	{
+		uint32_t current = this->current;
+		uint32_t target = this->target;
+
+		if(current == target)
+			return;
+
+		if(current < target)
+			current = ((this->step == 0u) || ((target - current) <= this->step)) ? target : (current + this->step);
+		else
+			current = ((this->step == 0u) || ((current - target) <= this->step)) ? target : (current - this->step);
+
+		this->current = current;
+		this->pwm->SetCompare(current);
+
+		if(current == target)
+			this->Reached();
+	}
+}
@@ -0,0 +1,220 @@
+/**
+ * @file	SoftTimer.cpp
+ * @author	Kevin WYSOCKI
+ * @date	22 oct. 2017
+ * @brief	Software timers multiplexed on one hardware timer
+ */
+
+#include <stddef.h>
+#include "SoftTimer.hpp"
+
+using namespace HAL;
+
+/*----------------------------------------------------------------------------*/
+/* Definitions                                                                */
+/*----------------------------------------------------------------------------*/
+
+#define SOFTTIMER_TIMER			(Timer::TIMER14)
+
+#define SOFTTIMER_ROOT_MASK		(SOFTTIMER_ROOT_SIZE - 1u)
+#define SOFTTIMER_LEVEL_MASK	(SOFTTIMER_LEVEL_SIZE - 1u)
+
+/** First tick bit of an upper level */
+#define SOFTTIMER_SHIFT(level)	(SOFTTIMER_ROOT_BITS + (level) * SOFTTIMER_LEVEL_BITS)
+
+/*----------------------------------------------------------------------------*/
+/* Private Members                                                            */
+/*----------------------------------------------------------------------------*/
+
+/**
+ * @brief Wheel slots : first level and upper levels
+ */
+static SoftTimer* _root[SOFTTIMER_ROOT_SIZE] = {NULL};
+static SoftTimer* _level[SOFTTIMER_LEVELS][SOFTTIMER_LEVEL_SIZE] = {{NULL}};
+
+/**
+ * @brief Wheel time (ticks processed)
+ */
+static volatile uint32_t _now = 0u;
+
+/**
+ * @brief Tick timer (started with the first software timer)
+ */
+static Timer* _wheelTimer = NULL;
+
+/*----------------------------------------------------------------------------*/
+/* Private Functions                                                          */
+/*----------------------------------------------------------------------------*/
+
+/**
+ * @brief Wheel tick (tick timer interrupt)
+ * @param obj : unused
+ */
+static void _tickEvent (void* obj)
+{
+	SoftTimer::INTERNAL_Tick();
+}
+
+/*----------------------------------------------------------------------------*/
+/* Class Implementation	                                                      */
+/*----------------------------------------------------------------------------*/
+namespace HAL
+{
+	SoftTimer::SoftTimer ()
+	{
+		this->expires = 0u;
+		this->period = 0u;
+		this->next = NULL;
+		this->prev = NULL;
+		this->slot = NULL;
+	}
+
+	void SoftTimer::Start (uint32_t delay, uint32_t period)
+	{
+		uint32_t primask;
+
+		assert((delay > 0u) && (delay <= SOFTTIMER_MAX_DELAY));
+		assert(period <= SOFTTIMER_MAX_DELAY);
+
+		if(_wheelTimer == NULL)
+		{
+			_wheelTimer = Timer::GetInstance(SOFTTIMER_TIMER);
+			_wheelTimer->TimerElapsed += _tickEvent;
+			_wheelTimer->SetPeriod(SOFTTIMER_TICK_US);
+			_wheelTimer->Restart();
+		}
+
+		primask = __get_PRIMASK();
+		__disable_irq();
+
+		if(this->slot != NULL)
+			this->unlink();
+
+		this->expires = _now + delay;
+		this->period = period;
+		this->link();
+
+		__set_PRIMASK(primask);
+	}
+
+	void SoftTimer::Stop ()
+	{
+		uint32_t primask;
+
+		primask = __get_PRIMASK();
+		__disable_irq();
+
+		if(this->slot != NULL)
+			this->unlink();
+
+		__set_PRIMASK(primask);
+	}
+
+	uint32_t SoftTimer::GetTicks ()
+	{
+		return _now;
+	}
+
+	void SoftTimer::link ()
+	{
+		uint32_t delta = this->expires - _now;
+		uint32_t level;
+
+		if(delta > SOFTTIMER_MAX_DELAY)
+		{
+			this->expires = _now + SOFTTIMER_MAX_DELAY;
+			delta = SOFTTIMER_MAX_DELAY;
+		}
+
+		if(delta < SOFTTIMER_ROOT_SIZE)
+			this->slot = &_root[this->expires & SOFTTIMER_ROOT_MASK];
+		else
+		{
+			// Smallest upper level covering the delay
+			for(level = 0u; level < (SOFTTIMER_LEVELS - 1u); level++)
+			{
+				if(delta < (1u << SOFTTIMER_SHIFT(level + 1u)))
+					break;
+			}
+
+			this->slot = &_level[level][(this->expires >> SOFTTIMER_SHIFT(level)) & SOFTTIMER_LEVEL_MASK];
+		}
+
+		// Push front
+		this->prev = NULL;
+		this->next = *this->slot;
+		if(this->next != NULL)
+			this->next->prev = this;
+		*this->slot = this;
+	}
+
+	void SoftTimer::unlink ()
+	{
+		if(this->prev != NULL)
+			this->prev->next = this->next;
+		else
+			*this->slot = this->next;
+
+		if(this->next != NULL)
+			this->next->prev = this->prev;
+
+		this->next = NULL;
+		this->prev = NULL;
+		this->slot = NULL;
+	}
+
+	uint32_t SoftTimer::cascade (uint32_t level)
+	{
+		uint32_t index = (_now >> SOFTTIMER_SHIFT(level)) & SOFTTIMER_LEVEL_MASK;
+		SoftTimer* timer;
+
+		// Deadlines are now in range of lower levels
+		while((timer = _level[level][index]) != NULL)
+		{
+			timer->unlink();
+			timer->link();
+		}
+
+		return index;
+	}
+
+	void SoftTimer::INTERNAL_Tick ()
+	{
+		uint32_t index, level, primask;
+		SoftTimer* timer;
+
+		primask = __get_PRIMASK();
+		__disable_irq();
+
+		_now = _now + 1u;
+		index = _now & SOFTTIMER_ROOT_MASK;
+
+		// First level wrapped : refill it from upper levels, which cascade on their own wrap
+		if(index == 0u)
+		{
+			for(level = 0u; level < SOFTTIMER_LEVELS; level++)
+			{
+				if(SoftTimer::cascade(level) != 0u)
+					break;
+			}
+		}
+
+		// Pop expired timers one by one, callbacks may start or stop any timer
+		while((timer = _root[index]) != NULL)
+		{
+			timer->unlink();
+
+			if(timer->period != 0u)
+			{
+				timer->expires = timer->expires + timer->period;
+				timer->link();
+			}
+
+			__set_PRIMASK(primask);
+			timer->Elapsed();
+			__disable_irq();
+		}
+
+		__set_PRIMASK(primask);
+	}
+}
@@ -6,53 +6,74 @@
  */
 
 #include "Telemeter.hpp"
+#include "StaticStorage.hpp"
 
 /*----------------------------------------------------------------------------*/
 /* Definitions                                                                */
 /*----------------------------------------------------------------------------*/
 
 // TELEMETER_1
-#define TEL1_CHANNEL    (HAL::ADConverter::ADC_Channel1)
+#define TEL1_CHANNEL        (HAL::ADConverter::ADC_Channel1)
+#define TEL1_DETECT_HIGH    (2000u)
+#define TEL1_DETECT_LOW     (1800u)
 
 // TELEMETER_2
-#define TEL2_CHANNEL    (HAL::ADConverter::ADC_Channel2)
+#define TEL2_CHANNEL        (HAL::ADConverter::ADC_Channel2)
+#define TEL2_DETECT_HIGH    (2000u)
+#define TEL2_DETECT_LOW     (1800u)
 
 /*----------------------------------------------------------------------------*/
 /* Private Members                                                            */
 /*----------------------------------------------------------------------------*/
 
 static HAL::Telemeter* _instance[HAL::Telemeter::ID::TELEMETER_MAX] = {NULL};
+static Utils::StaticStorage<HAL::Telemeter, HAL::Telemeter::ID::TELEMETER_MAX> _instanceStorage;
 
 /*----------------------------------------------------------------------------*/
 /* Private Functions                                                          */
 /*----------------------------------------------------------------------------*/
 
 /**
- * @brief
- * @param id :  ID
- * @return MAN_DEF structure
+ * @brief ADC watchdog event (interrupt context)
+ * @param obj : Telemeter instance
  */
-static TEL_DEF _getTELStruct (enum HAL::Telemeter::ID id)
+static void _watchdogEvent (void* obj)
 {
-     TEL_DEF def;
+    HAL::Telemeter* tel = reinterpret_cast<HAL::Telemeter*>(obj);
 
-     assert(id < HAL::Telemeter::TELEMETER_MAX);
+    tel->INTERNAL_Detected();
+}
 
-     switch(id)
-     {
-     case HAL::Telemeter::TELEMETER_1:
-        def.ch = TEL1_CHANNEL;
-        break;
+/**
+ * @brief Telemeters definitions (flash), indexed by Telemeter ID
+ */
+static const TEL_DEF _telDefs[HAL::Telemeter::TELEMETER_MAX] =
+{
+    // TELEMETER_1
+    {
+        TEL1_CHANNEL,           // ch
+        TEL1_DETECT_HIGH,       // detectHigh
+        TEL1_DETECT_LOW,        // detectLow
+    },
 
-     case HAL::Telemeter::TELEMETER_2:
-        def.ch = TEL2_CHANNEL;
-        break;
+    // TELEMETER_2
+    {
+        TEL2_CHANNEL,           // ch
+        TEL2_DETECT_HIGH,       // detectHigh
+        TEL2_DETECT_LOW,        // detectLow
+    },
+};
 
-     default:
-         break;
-     }
+/**
+ * @brief
+ * @param id :  ID
+ * @return MAN_DEF structure
+ */
+static TEL_DEF _getTELStruct (enum HAL::Telemeter::ID id)
+{
+    assert(id < HAL::Telemeter::TELEMETER_MAX);
 
-     return def;
+    return _telDefs[id];
 }
 
 /**
@@ -76,7 +97,7 @@ namespace HAL {
 
         if(_instance[id] == NULL)
         {
-            _instance[id] = new Telemeter(id);
+            _instance[id] = new (_instanceStorage.Get(id)) Telemeter(id);
         }
 
         return _instance[id];
@@ -89,40 +110,46 @@ namespace HAL {
 
         this->adc = ADConverter::GetInstance(this->def.ch);
 
+        this->detect.SetThresholds(this->def.detectLow, this->def.detectHigh);
+
         //_hardwareInit(id);
     }
 
     uint16_t Telemeter::GetValue()
     {
-        uint16_t val;
+        // Mean of DMA scan buffer, no conversion wait
+        return this->adc->GetResult();
+    }
 
-        this->adc->StartConv();
-        this->adc->WaitWhileBusy();
+    void Telemeter::Update()
+    {
+        uint16_t val = this->adc->GetSample();
 
-        val = this->adc->GetResult();
+        // Median rejects spikes, average smooths noise
+        val = this->median.Put(val);
+        val = this->average.Put(val);
 
-        return val;
+        this->detect.Put(val);
     }
 
-    bool Telemeter::Detect()
+    void Telemeter::EnableDetection()
     {
-        bool ret;
-        uint16_t cpt = 0;
-        uint16_t val = 0;
-
-        for(uint16_t i=0; i < 5; i++)
-        {
-            val = this->GetValue();
+        this->adc->WatchdogTriggered.Subscribe(this, &_watchdogEvent);
+        this->adc->SetWatchdog(this->def.detectHigh);
+    }
 
-            if(val > 2000)
-                cpt++;
-        }
+    void Telemeter::DisableDetection()
+    {
+        this->adc->SetWatchdog(0u);
+    }
 
-        if(cpt >= 3)
-            ret = true;
-        else
-            ret = false;
+    void Telemeter::ArmDetection()
+    {
+        this->adc->ArmWatchdog();
+    }
 
-        return ret;
+    void Telemeter::INTERNAL_Detected()
+    {
+        this->Detected();
     }
 }
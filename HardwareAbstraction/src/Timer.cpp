@@ -8,6 +8,8 @@
 #include <stddef.h>
 #include "Timer.hpp"
 #include "common.h"
+#include "Profiler.hpp"
+#include "StaticStorage.hpp"
 
 using namespace HAL;
 using namespace Utils;
@@ -18,14 +20,46 @@ using namespace Utils;
 
 #define TIMER_COUNTER_MAX_VALUE (65535)	/**< 16-bit timer max value */
 
-// TIM6
+// TIM6 (Compare on update : one compare channel)
+#define TIMER6_TIMER			(TIM6)
+#define TIMER6_PERIOD_US		(0u)
+#define TIMER6_FREQUENCY		(0u)
+#define TIMER6_TIMER_FREQ		(SystemCoreClock / 2)	// TIM6 clock is derivated from APB1 clock
+#define TIMER6_TICK_FREQ		(1000000u)				// 1us resolution
+#define TIMER6_CHANNELS			(0u)
+#define TIMER6_INT_CHANNEL		(TIM6_DAC_IRQn)
+#define TIMER6_INT_PRIORITY		(0u)
+
+// TIM7
 #define TIMER7_TIMER			(TIM7)
 #define TIMER7_PERIOD_US		(250000u)
 #define TIMER7_FREQUENCY		(1000000/TIMER7_PERIOD_US)
 #define TIMER7_TIMER_FREQ		(SystemCoreClock / 2)	// TIM7 clock is derivated from APB1 clock
+#define TIMER7_TICK_FREQ		(0u)
+#define TIMER7_CHANNELS			(0u)
 #define TIMER7_INT_CHANNEL		(TIM7_IRQn)
 #define TIMER7_INT_PRIORITY		(0u)
 
+// TIM8 (Compare : four compare channels)
+#define TIMER8_TIMER			(TIM8)
+#define TIMER8_PERIOD_US		(0u)
+#define TIMER8_FREQUENCY		(0u)
+#define TIMER8_TIMER_FREQ		(SystemCoreClock)		// TIM8 clock is derivated from APB2 clock
+#define TIMER8_TICK_FREQ		(1000000u)				// 1us resolution
+#define TIMER8_CHANNELS			(4u)
+#define TIMER8_INT_CHANNEL		((IRQn_Type)46)			// TIM8_CC_IRQn, missing from STM32F446xx IRQn list
+#define TIMER8_INT_PRIORITY		(0u)
+
+// TIM14 (PWM27 is not available when used)
+#define TIMER14_TIMER			(TIM14)
+#define TIMER14_PERIOD_US		(1000u)
+#define TIMER14_FREQUENCY		(1000000/TIMER14_PERIOD_US)
+#define TIMER14_TIMER_FREQ		(SystemCoreClock / 2)	// TIM14 clock is derivated from APB1 clock
+#define TIMER14_TICK_FREQ		(0u)
+#define TIMER14_CHANNELS		(0u)
+#define TIMER14_INT_CHANNEL		(TIM8_TRG_COM_TIM14_IRQn)
+#define TIMER14_INT_PRIORITY	(11u)					// Below configMAX_SYSCALL (events may notify a task)
+
 /*----------------------------------------------------------------------------*/
 /* Private Members                                                            */
 /*----------------------------------------------------------------------------*/
@@ -35,6 +69,19 @@ using namespace Utils;
  */
 Timer* _timer[Timer::TIMER_MAX] = {NULL};
 
+/**
+ * @brief Timer instances storage
+ */
+static Utils::StaticStorage<Timer, Timer::TIMER_MAX> _timerStorage;
+
+/**
+ * @brief IRQ handlers execution time
+ */
+static Utils::Profiler _tim6Profiler("TIM6 IRQ");
+static Utils::Profiler _tim7Profiler("TIM7 IRQ");
+static Utils::Profiler _tim8Profiler("TIM8CC IRQ");
+static Utils::Profiler _tim14Profiler("TIM14 IRQ");
+
 /*----------------------------------------------------------------------------*/
 /* Private Functions                                                          */
 /*----------------------------------------------------------------------------*/
@@ -52,14 +99,46 @@ static TIM_DEF _getTimerStruct (enum Timer::ID id)
 
 	switch(id)
 	{
+	case HAL::Timer::TIMER6:
+		tim.TIMER.TIMER		=	TIMER6_TIMER;
+		tim.TIMER.PERIOD	=	TIMER6_PERIOD_US;
+		tim.TIMER.FREQ		=	TIMER6_FREQUENCY;
+		tim.TIMER.CLOCKFREQ	=	TIMER6_TIMER_FREQ;
+		tim.TIMER.TICKFREQ	=	TIMER6_TICK_FREQ;
+		tim.TIMER.CHANNELS	=	TIMER6_CHANNELS;
+		tim.INT.CHANNEL		=	TIMER6_INT_CHANNEL;
+		tim.INT.PRIORITY	=	TIMER6_INT_PRIORITY;
+		break;
 	case HAL::Timer::TIMER7:
 		tim.TIMER.TIMER		=	TIMER7_TIMER;
 		tim.TIMER.PERIOD	=	TIMER7_PERIOD_US;
 		tim.TIMER.FREQ		=	TIMER7_FREQUENCY;
 		tim.TIMER.CLOCKFREQ	=	TIMER7_TIMER_FREQ;
+		tim.TIMER.TICKFREQ	=	TIMER7_TICK_FREQ;
+		tim.TIMER.CHANNELS	=	TIMER7_CHANNELS;
 		tim.INT.CHANNEL		=	TIMER7_INT_CHANNEL;
 		tim.INT.PRIORITY	=	TIMER7_INT_PRIORITY;
 		break;
+	case HAL::Timer::TIMER8:
+		tim.TIMER.TIMER		=	TIMER8_TIMER;
+		tim.TIMER.PERIOD	=	TIMER8_PERIOD_US;
+		tim.TIMER.FREQ		=	TIMER8_FREQUENCY;
+		tim.TIMER.CLOCKFREQ	=	TIMER8_TIMER_FREQ;
+		tim.TIMER.TICKFREQ	=	TIMER8_TICK_FREQ;
+		tim.TIMER.CHANNELS	=	TIMER8_CHANNELS;
+		tim.INT.CHANNEL		=	TIMER8_INT_CHANNEL;
+		tim.INT.PRIORITY	=	TIMER8_INT_PRIORITY;
+		break;
+	case HAL::Timer::TIMER14:
+		tim.TIMER.TIMER		=	TIMER14_TIMER;
+		tim.TIMER.PERIOD	=	TIMER14_PERIOD_US;
+		tim.TIMER.FREQ		=	TIMER14_FREQUENCY;
+		tim.TIMER.CLOCKFREQ	=	TIMER14_TIMER_FREQ;
+		tim.TIMER.TICKFREQ	=	TIMER14_TICK_FREQ;
+		tim.TIMER.CHANNELS	=	TIMER14_CHANNELS;
+		tim.INT.CHANNEL		=	TIMER14_INT_CHANNEL;
+		tim.INT.PRIORITY	=	TIMER14_INT_PRIORITY;
+		break;
 	default:
 		break;
 	}
@@ -90,7 +169,13 @@ static void _hardwareInit (enum Timer::ID id)
 
 	minFrequency = tim.TIMER.CLOCKFREQ / (TIMER_COUNTER_MAX_VALUE + 1u);
 
-	if(tim.TIMER.FREQ > minFrequency)
+	if(tim.TIMER.TICKFREQ != 0u)
+	{
+		// Compare mode : free running counter at TICKFREQ
+		TIMBaseStruct.TIM_Prescaler	= 	(tim.TIMER.CLOCKFREQ / tim.TIMER.TICKFREQ) - 1u;
+		TIMBaseStruct.TIM_Period	=	TIMER_COUNTER_MAX_VALUE;
+	}
+	else if(tim.TIMER.FREQ > minFrequency)
 	{
 		TIMBaseStruct.TIM_Prescaler	= 	0u;
 		TIMBaseStruct.TIM_Period	=	(tim.TIMER.CLOCKFREQ / tim.TIMER.FREQ) - 1u;
@@ -105,10 +190,24 @@ static void _hardwareInit (enum Timer::ID id)
 	TIM_Cmd(tim.TIMER.TIMER, DISABLE);
 	TIM_TimeBaseInit(tim.TIMER.TIMER, &TIMBaseStruct);
 	TIM_SetCounter(tim.TIMER.TIMER, 0u);
-	TIM_ARRPreloadConfig(tim.TIMER.TIMER, ENABLE);
 
-	TIM_ClearFlag(tim.TIMER.TIMER, TIM_FLAG_Update);
-	TIM_ITConfig(tim.TIMER.TIMER, TIM_IT_Update, ENABLE);
+	if(tim.TIMER.TICKFREQ != 0u)
+	{
+		// Compare channels are enabled on demand, autoreload is written on the fly
+		TIM_ARRPreloadConfig(tim.TIMER.TIMER, DISABLE);
+		TIM_ClearFlag(tim.TIMER.TIMER, TIM_FLAG_Update | TIM_FLAG_CC1 | TIM_FLAG_CC2 | TIM_FLAG_CC3 | TIM_FLAG_CC4);
+
+		// Counter runs continuously when channels are compared
+		if(tim.TIMER.CHANNELS != 0u)
+			TIM_Cmd(tim.TIMER.TIMER, ENABLE);
+	}
+	else
+	{
+		TIM_ARRPreloadConfig(tim.TIMER.TIMER, ENABLE);
+
+		TIM_ClearFlag(tim.TIMER.TIMER, TIM_FLAG_Update);
+		TIM_ITConfig(tim.TIMER.TIMER, TIM_IT_Update, ENABLE);
+	}
 
 	// Init NVIC
 	NVICStruct.NVIC_IRQChannel						=	tim.INT.CHANNEL;
@@ -136,7 +235,7 @@ namespace HAL
 		else
 		{
 			// Create Timer instance
-			_timer[id] = new Timer(id);
+			_timer[id] = new (_timerStorage.Get(id)) Timer(id);
 
 			return _timer[id];
 		}
@@ -157,7 +256,7 @@ namespace HAL
 		uint32_t prescaler = 0u;
 		float32_t frequency = 0.0f, minFrequency = 0.0f;
 
-		frequency = 1000000.0 / (float32_t)period_us;
+		frequency = 1000000.0f / (float32_t)period_us;
 
 		TIMBaseStruct.TIM_ClockDivision		=	TIM_CKD_DIV1;
 		TIMBaseStruct.TIM_CounterMode		=	TIM_CounterMode_Up;
@@ -197,11 +296,148 @@ namespace HAL
 		TIM_Cmd(this->def.TIMER.TIMER, DISABLE);
 	}
 
+	void Timer::StartCompare(enum Channel ch, uint16_t delay)
+	{
+		TIM_TypeDef* TIMx = this->def.TIMER.TIMER;
+
+		assert(this->def.TIMER.TICKFREQ != 0u);
+		assert(delay > 0u);
+
+		if(this->def.TIMER.CHANNELS == 0u)
+		{
+			assert(ch == CHANNEL1);
+
+			// Compare on update : restart counter with delay as autoreload
+			TIM_Cmd(TIMx, DISABLE);
+			TIM_SetAutoreload(TIMx, delay - 1u);
+			TIM_SetCounter(TIMx, 0u);
+			TIM_ClearFlag(TIMx, TIM_FLAG_Update);
+			TIM_ITConfig(TIMx, TIM_IT_Update, ENABLE);
+			TIM_Cmd(TIMx, ENABLE);
+		}
+		else
+		{
+			assert(ch < this->def.TIMER.CHANNELS);
+
+			delay += (uint16_t)TIM_GetCounter(TIMx);
+
+			switch(ch)
+			{
+			case CHANNEL1:
+				TIM_SetCompare1(TIMx, delay);
+				TIM_ClearFlag(TIMx, TIM_FLAG_CC1);
+				TIM_ITConfig(TIMx, TIM_IT_CC1, ENABLE);
+				break;
+			case CHANNEL2:
+				TIM_SetCompare2(TIMx, delay);
+				TIM_ClearFlag(TIMx, TIM_FLAG_CC2);
+				TIM_ITConfig(TIMx, TIM_IT_CC2, ENABLE);
+				break;
+			case CHANNEL3:
+				TIM_SetCompare3(TIMx, delay);
+				TIM_ClearFlag(TIMx, TIM_FLAG_CC3);
+				TIM_ITConfig(TIMx, TIM_IT_CC3, ENABLE);
+				break;
+			case CHANNEL4:
+				TIM_SetCompare4(TIMx, delay);
+				TIM_ClearFlag(TIMx, TIM_FLAG_CC4);
+				TIM_ITConfig(TIMx, TIM_IT_CC4, ENABLE);
+				break;
+			default:
+				break;
+			}
+		}
+	}
+
+	void Timer::ScheduleCompare(enum Channel ch, uint16_t delay)
+	{
+		TIM_TypeDef* TIMx = this->def.TIMER.TIMER;
+
+		assert(delay > 0u);
+
+		if(this->def.TIMER.CHANNELS == 0u)
+		{
+			// Counter has just been reloaded, new autoreload applies immediately
+			TIM_SetAutoreload(TIMx, delay - 1u);
+		}
+		else
+		{
+			// 16-bit wrap gives the right compare value
+			switch(ch)
+			{
+			case CHANNEL1:
+				TIM_SetCompare1(TIMx, (uint16_t)(TIM_GetCapture1(TIMx) + delay));
+				break;
+			case CHANNEL2:
+				TIM_SetCompare2(TIMx, (uint16_t)(TIM_GetCapture2(TIMx) + delay));
+				break;
+			case CHANNEL3:
+				TIM_SetCompare3(TIMx, (uint16_t)(TIM_GetCapture3(TIMx) + delay));
+				break;
+			case CHANNEL4:
+				TIM_SetCompare4(TIMx, (uint16_t)(TIM_GetCapture4(TIMx) + delay));
+				break;
+			default:
+				break;
+			}
+		}
+	}
+
+	void Timer::StopCompare(enum Channel ch)
+	{
+		TIM_TypeDef* TIMx = this->def.TIMER.TIMER;
+
+		if(this->def.TIMER.CHANNELS == 0u)
+		{
+			TIM_ITConfig(TIMx, TIM_IT_Update, DISABLE);
+			TIM_Cmd(TIMx, DISABLE);
+		}
+		else
+		{
+			switch(ch)
+			{
+			case CHANNEL1:
+				TIM_ITConfig(TIMx, TIM_IT_CC1, DISABLE);
+				break;
+			case CHANNEL2:
+				TIM_ITConfig(TIMx, TIM_IT_CC2, DISABLE);
+				break;
+			case CHANNEL3:
+				TIM_ITConfig(TIMx, TIM_IT_CC3, DISABLE);
+				break;
+			case CHANNEL4:
+				TIM_ITConfig(TIMx, TIM_IT_CC4, DISABLE);
+				break;
+			default:
+				break;
+			}
+		}
+	}
+
 	void Timer::INTERNAL_InterruptCallback(uint16_t flag)
 	{
-		if(flag == TIM_FLAG_Update)
+		switch(flag)
 		{
-			this->TimerElapsed();
+		case TIM_FLAG_Update:
+			if(this->def.TIMER.TICKFREQ != 0u)
+				this->CompareMatch[CHANNEL1]();
+			else
+				this->TimerElapsed();
+			break;
+		case TIM_FLAG_CC1:
+			this->CompareMatch[CHANNEL1]();
+			break;
+		case TIM_FLAG_CC2:
+			this->CompareMatch[CHANNEL2]();
+			break;
+		case TIM_FLAG_CC3:
+			this->CompareMatch[CHANNEL3]();
+			break;
+		case TIM_FLAG_CC4:
+			this->CompareMatch[CHANNEL4]();
+			break;
+		default:
+			break;
 		}
 	}
 }
@@ -212,11 +448,63 @@ namespace HAL
 
 extern "C"
 {
+	/**
+	 * @brief TIM6 Interrupt Handler
+	 */
+	RAMFUNC void TIM6_DAC_IRQHandler(void)
+	{
+		_tim6Profiler.Start();
+
+		if(TIM_GetITStatus(TIM6, TIM_IT_Update) == SET)
+		{
+			TIM_ClearITPendingBit(TIM6, TIM_IT_Update);
+
+			_timer[Timer::TIMER6]->INTERNAL_InterruptCallback(TIM_FLAG_Update);
+		}
+
+		_tim6Profiler.Stop();
+	}
+
+	/**
+	 * @brief TIM8 Capture Compare Interrupt Handler
+	 */
+	RAMFUNC void TIM8_CC_IRQHandler(void)
+	{
+		_tim8Profiler.Start();
+
+		Timer* tim = _timer[Timer::TIMER8];
+
+		if(TIM_GetITStatus(TIM8, TIM_IT_CC1) == SET)
+		{
+			TIM_ClearITPendingBit(TIM8, TIM_IT_CC1);
+			tim->INTERNAL_InterruptCallback(TIM_FLAG_CC1);
+		}
+		if(TIM_GetITStatus(TIM8, TIM_IT_CC2) == SET)
+		{
+			TIM_ClearITPendingBit(TIM8, TIM_IT_CC2);
+			tim->INTERNAL_InterruptCallback(TIM_FLAG_CC2);
+		}
+		if(TIM_GetITStatus(TIM8, TIM_IT_CC3) == SET)
+		{
+			TIM_ClearITPendingBit(TIM8, TIM_IT_CC3);
+			tim->INTERNAL_InterruptCallback(TIM_FLAG_CC3);
+		}
+		if(TIM_GetITStatus(TIM8, TIM_IT_CC4) == SET)
+		{
+			TIM_ClearITPendingBit(TIM8, TIM_IT_CC4);
+			tim->INTERNAL_InterruptCallback(TIM_FLAG_CC4);
+		}
+
+		_tim8Profiler.Stop();
+	}
+
 	/**
 	 * @brief TIM7 Interrupt Handler
 	 */
-	void TIM7_IRQHandler(void)
+	RAMFUNC void TIM7_IRQHandler(void)
 	{
+		_tim7Profiler.Start();
+
 		if(TIM_GetFlagStatus(TIM7, TIM_FLAG_Update) == SET)
 		{
 			TIM_ClearFlag(TIM7, TIM_FLAG_Update);
@@ -228,5 +516,25 @@ extern "C"
 			//GPIO *led2 = GPIO::GetInstance(GPIO::GPIO1);
 			//led2->Toggle();
 		}
+
+		_tim7Profiler.Stop();
+	}
+
+	/**
+	 * @brief TIM14 Interrupt Handler (TIM8 trigger and commutation are not used)
+	 */
+	RAMFUNC void TIM8_TRG_COM_TIM14_IRQHandler(void)
+	{
+		_tim14Profiler.Start();
+
+		if(TIM_GetITStatus(TIM14, TIM_IT_Update) == SET)
+		{
+			TIM_ClearITPendingBit(TIM14, TIM_IT_Update);
+
+			if(_timer[Timer::TIMER14] != NULL)
+				_timer[Timer::TIMER14]->INTERNAL_InterruptCallback(TIM_FLAG_Update);
+		}
+
+		_tim14Profiler.Stop();
 	}
 }
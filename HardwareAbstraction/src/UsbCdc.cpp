@@ -0,0 +1,1030 @@
+/**
+ * @file	UsbCdc.cpp
+ * @author	Jeremy ROULLAND
+ * @date	26 oct. 2017
+ * @brief	USB OTG FS device, CDC ACM virtual COM port
+ */
+
+#include "UsbCdc.hpp"
+#include "StaticStorage.hpp"
+#include "Profiler.hpp"
+#include <stddef.h>
+#include <string.h>
+
+using namespace HAL;
+
+/*----------------------------------------------------------------------------*/
+/* Definitions                                                                */
+/*----------------------------------------------------------------------------*/
+
+// OTG FS pins (DM is also MOT4_APH, GPIO19 must not be used)
+#define USBCDC_DM_PORT			(GPIOA)
+#define USBCDC_DM_PIN			(GPIO_Pin_11)
+#define USBCDC_DM_PINSOURCE		(GPIO_PinSource11)
+#define USBCDC_DP_PORT			(GPIOA)
+#define USBCDC_DP_PIN			(GPIO_Pin_12)
+#define USBCDC_DP_PINSOURCE		(GPIO_PinSource12)
+#define USBCDC_IO_AF			(GPIO_AF_OTG_FS)
+#define USBCDC_INT_CHANNEL		(OTG_FS_IRQn)
+#define USBCDC_INT_PRIORITY		(11u)	// Below configMAX_SYSCALL (Serial RX task notification)
+
+// 48 MHz clock : HSE / M * N / P (1 MHz VCO input, 192 MHz VCO)
+#define USBCDC_PLLSAI_M			(HSE_VALUE / 1000000u)
+#define USBCDC_PLLSAI_N			(192u)
+#define USBCDC_PLLSAI_P			(4u)
+#define USBCDC_PLLSAI_Q			(2u)	// Unused output, lowest divider allowed
+
+// Endpoints
+#define USBCDC_EP_MAX			(4u)	// Endpoints reset at init
+#define USBCDC_EP_DATA			(1u)	// Bulk IN / OUT
+#define USBCDC_EP_NOTIFY		(2u)	// Interrupt IN, never written (no serial state notification)
+#define USBCDC_NOTIFY_SIZE		(8u)
+
+// FIFO RAM, 320 words : RX, EP0 TX, EP1 TX (8 packets), EP2 TX
+#define USBCDC_RX_FIFO_WORDS	(128u)
+#define USBCDC_TX0_FIFO_WORDS	(16u)
+#define USBCDC_TX1_FIFO_WORDS	(128u)
+#define USBCDC_TX2_FIFO_WORDS	(16u)
+
+// Turnaround time, AHB clock above 32 MHz
+#define USBCDC_TRDT				(6u)
+
+/**
+ * @brief OTG FS registers (not defined by stm32f4xx.h)
+ */
+#define OTGFS_BASE				(0x50000000u)
+
+typedef struct
+{
+	__IO uint32_t GOTGCTL;			/**< 0x000 Control and status */
+	__IO uint32_t GOTGINT;			/**< 0x004 Interrupt */
+	__IO uint32_t GAHBCFG;			/**< 0x008 AHB configuration */
+	__IO uint32_t GUSBCFG;			/**< 0x00C USB configuration */
+	__IO uint32_t GRSTCTL;			/**< 0x010 Reset */
+	__IO uint32_t GINTSTS;			/**< 0x014 Core interrupt */
+	__IO uint32_t GINTMSK;			/**< 0x018 Interrupt mask */
+	__IO uint32_t GRXSTSR;			/**< 0x01C Receive status debug read */
+	__IO uint32_t GRXSTSP;			/**< 0x020 Receive status read and pop */
+	__IO uint32_t GRXFSIZ;			/**< 0x024 Receive FIFO size */
+	__IO uint32_t DIEPTXF0;			/**< 0x028 Endpoint 0 transmit FIFO size */
+	__IO uint32_t HNPTXSTS;			/**< 0x02C Non-periodic transmit FIFO status */
+	uint32_t RESERVED0[2];
+	__IO uint32_t GCCFG;			/**< 0x038 General core configuration */
+	__IO uint32_t CID;				/**< 0x03C Core ID */
+	uint32_t RESERVED1[48];
+	__IO uint32_t HPTXFSIZ;			/**< 0x100 Host periodic transmit FIFO size */
+	__IO uint32_t DIEPTXF[15];		/**< 0x104 Endpoint 1 to 15 transmit FIFO size */
+}OTGFS_GLOBAL_TypeDef;
+
+typedef struct
+{
+	__IO uint32_t DCFG;				/**< 0x800 Device configuration */
+	__IO uint32_t DCTL;				/**< 0x804 Device control */
+	__IO uint32_t DSTS;				/**< 0x808 Device status */
+	uint32_t RESERVED0;
+	__IO uint32_t DIEPMSK;			/**< 0x810 IN endpoint common interrupt mask */
+	__IO uint32_t DOEPMSK;			/**< 0x814 OUT endpoint common interrupt mask */
+	__IO uint32_t DAINT;			/**< 0x818 All endpoints interrupt */
+	__IO uint32_t DAINTMSK;			/**< 0x81C All endpoints interrupt mask */
+	uint32_t RESERVED1[2];
+	__IO uint32_t DVBUSDIS;			/**< 0x828 VBUS discharge time */
+	__IO uint32_t DVBUSPULSE;		/**< 0x82C VBUS pulsing time */
+	uint32_t RESERVED2;
+	__IO uint32_t DIEPEMPMSK;		/**< 0x834 IN endpoint FIFO empty interrupt mask */
+}OTGFS_DEVICE_TypeDef;
+
+typedef struct
+{
+	__IO uint32_t CTL;				/**< 0x00 Endpoint control */
+	uint32_t RESERVED0;
+	__IO uint32_t INT;				/**< 0x08 Endpoint interrupt */
+	uint32_t RESERVED1;
+	__IO uint32_t TSIZ;				/**< 0x10 Endpoint transfer size */
+	uint32_t RESERVED2;
+	__IO uint32_t TXFSTS;			/**< 0x18 Transmit FIFO status (IN only) */
+	uint32_t RESERVED3;
+}OTGFS_EP_TypeDef;
+
+#define OTGFS					((OTGFS_GLOBAL_TypeDef *)OTGFS_BASE)
+#define OTGFS_DEVICE			((OTGFS_DEVICE_TypeDef *)(OTGFS_BASE + 0x800u))
+#define OTGFS_IN(ep)			((OTGFS_EP_TypeDef *)(OTGFS_BASE + 0x900u + ((ep) * 0x20u)))
+#define OTGFS_OUT(ep)			((OTGFS_EP_TypeDef *)(OTGFS_BASE + 0xB00u + ((ep) * 0x20u)))
+#define OTGFS_PCGCCTL			(*(__IO uint32_t *)(OTGFS_BASE + 0xE00u))
+#define OTGFS_FIFO(ep)			(*(__IO uint32_t *)(OTGFS_BASE + 0x1000u + ((ep) * 0x1000u)))
+
+// GOTGCTL
+#define OTGFS_GOTGCTL_BVALOEN	(1u << 6)
+#define OTGFS_GOTGCTL_BVALOVAL	(1u << 7)
+// GAHBCFG
+#define OTGFS_GAHBCFG_GINTMSK	(1u << 0)
+// GUSBCFG
+#define OTGFS_GUSBCFG_PHYSEL	(1u << 6)
+#define OTGFS_GUSBCFG_TRDT_POS	(10u)
+#define OTGFS_GUSBCFG_TRDT		(0xFu << OTGFS_GUSBCFG_TRDT_POS)
+#define OTGFS_GUSBCFG_FHMOD		(1u << 29)
+#define OTGFS_GUSBCFG_FDMOD		(1u << 30)
+// GRSTCTL
+#define OTGFS_GRSTCTL_CSRST		(1u << 0)
+#define OTGFS_GRSTCTL_RXFFLSH	(1u << 4)
+#define OTGFS_GRSTCTL_TXFFLSH	(1u << 5)
+#define OTGFS_GRSTCTL_TXFNUM_ALL	(0x10u << 6)
+#define OTGFS_GRSTCTL_AHBIDL	(1u << 31)
+// GINTSTS / GINTMSK
+#define OTGFS_GINT_CMOD			(1u << 0)
+#define OTGFS_GINT_RXFLVL		(1u << 4)
+#define OTGFS_GINT_USBSUSP		(1u << 11)
+#define OTGFS_GINT_USBRST		(1u << 12)
+#define OTGFS_GINT_ENUMDNE		(1u << 13)
+#define OTGFS_GINT_IEPINT		(1u << 18)
+#define OTGFS_GINT_OEPINT		(1u << 19)
+#define OTGFS_GINT_WKUINT		(1u << 31)
+// GRXSTSP
+#define OTGFS_GRXSTS_EPNUM(s)	((s) & 0xFu)
+#define OTGFS_GRXSTS_BCNT(s)	(((s) >> 4) & 0x7FFu)
+#define OTGFS_GRXSTS_PKTSTS(s)	(((s) >> 17) & 0xFu)
+#define OTGFS_PKTSTS_OUT_DATA	(2u)
+#define OTGFS_PKTSTS_SETUP_DATA	(6u)
+// GCCFG
+#define OTGFS_GCCFG_PWRDWN		(1u << 16)
+// DCFG
+#define OTGFS_DCFG_DSPD_FS		(3u)
+#define OTGFS_DCFG_DAD_POS		(4u)
+#define OTGFS_DCFG_DAD			(0x7Fu << OTGFS_DCFG_DAD_POS)
+// DCTL
+#define OTGFS_DCTL_RWUSIG		(1u << 0)
+#define OTGFS_DCTL_SDIS			(1u << 1)
+#define OTGFS_DCTL_CGINAK		(1u << 8)
+// DIEPCTL / DOEPCTL
+#define OTGFS_EPCTL_MPSIZ		(0x7FFu)
+#define OTGFS_EPCTL_USBAEP		(1u << 15)
+#define OTGFS_EPCTL_EPTYP_BULK	(2u << 18)
+#define OTGFS_EPCTL_EPTYP_INT	(3u << 18)
+#define OTGFS_EPCTL_STALL		(1u << 21)
+#define OTGFS_EPCTL_TXFNUM_POS	(22u)
+#define OTGFS_EPCTL_CNAK		(1u << 26)
+#define OTGFS_EPCTL_SNAK		(1u << 27)
+#define OTGFS_EPCTL_SD0PID		(1u << 28)
+#define OTGFS_EPCTL_EPDIS		(1u << 30)
+#define OTGFS_EPCTL_EPENA		(1u << 31)
+// DIEPINT / DOEPINT
+#define OTGFS_EPINT_XFRC		(1u << 0)
+#define OTGFS_EPINT_TOC			(1u << 3)
+#define OTGFS_EPINT_STUP		(1u << 3)
+#define OTGFS_EPINT_TXFE		(1u << 7)
+#define OTGFS_EPINT_ALL			(0xFFu)
+// DIEPTSIZ / DOEPTSIZ
+#define OTGFS_TSIZ_PKTCNT_POS	(19u)
+#define OTGFS_TSIZ_STUPCNT_3	(3u << 29)
+
+/**
+ * @brief Standard and CDC requests
+ */
+#define USB_REQ_TYPE			(0x60u)
+#define USB_REQ_TYPE_STANDARD	(0x00u)
+#define USB_REQ_TYPE_CLASS		(0x20u)
+
+#define USB_REQ_GET_STATUS		(0x00u)
+#define USB_REQ_CLEAR_FEATURE	(0x01u)
+#define USB_REQ_SET_FEATURE		(0x03u)
+#define USB_REQ_SET_ADDRESS		(0x05u)
+#define USB_REQ_GET_DESCRIPTOR	(0x06u)
+#define USB_REQ_GET_CONFIG		(0x08u)
+#define USB_REQ_SET_CONFIG		(0x09u)
+#define USB_REQ_GET_INTERFACE	(0x0Au)
+#define USB_REQ_SET_INTERFACE	(0x0Bu)
+
+#define CDC_SET_LINE_CODING		(0x20u)
+#define CDC_GET_LINE_CODING		(0x21u)
+#define CDC_SET_CONTROL_LINE	(0x22u)
+#define CDC_SEND_BREAK			(0x23u)
+
+#define USB_DESC_DEVICE			(0x01u)
+#define USB_DESC_CONFIG			(0x02u)
+#define USB_DESC_STRING			(0x03u)
+
+/**
+ * @brief Device unique ID (serial number string)
+ */
+#define USBCDC_UID				((const uint32_t *)0x1FFF7A10u)
+
+/*----------------------------------------------------------------------------*/
+/* Private Members                                                            */
+/*----------------------------------------------------------------------------*/
+
+/**
+ * @brief UsbCdc instance
+ */
+static UsbCdc* _usbCdc = NULL;
+
+/**
+ * @brief UsbCdc instance storage
+ */
+static Utils::StaticStorage<UsbCdc> _usbCdcStorage;
+
+/**
+ * @brief IRQ handler execution time
+ */
+static Utils::Profiler _otgProfiler("OTG FS IRQ");
+
+/**
+ * @brief Device descriptor
+ */
+static const uint8_t _deviceDescriptor[] =
+{
+	18u, USB_DESC_DEVICE,
+	0x00u, 0x02u,								// USB 2.0
+	0x02u, 0x00u, 0x00u,						// CDC class
+	USBCDC_PACKET_SIZE,							// EP0 max packet size
+	(uint8_t)USBCDC_VID, (uint8_t)(USBCDC_VID >> 8),
+	(uint8_t)USBCDC_PID, (uint8_t)(USBCDC_PID >> 8),
+	0x00u, 0x02u,								// Device release 2.00
+	1u, 2u, 3u,									// Manufacturer, product, serial number strings
+	1u											// Configurations
+};
+
+/**
+ * @brief Configuration descriptor (communication and data interfaces)
+ */
+static const uint8_t _configDescriptor[] =
+{
+	9u, USB_DESC_CONFIG, 67u, 0u, 2u, 1u, 0u,
+	0xC0u,										// Self powered
+	50u,										// 100 mA
+	// Interface 0 : communication, ACM
+	9u, 0x04u, 0u, 0u, 1u, 0x02u, 0x02u, 0x01u, 0u,
+	5u, 0x24u, 0x00u, 0x10u, 0x01u,				// Header, CDC 1.10
+	5u, 0x24u, 0x01u, 0x00u, 1u,				// Call management, data interface 1
+	4u, 0x24u, 0x02u, 0x02u,					// ACM, line coding and control line state
+	5u, 0x24u, 0x06u, 0u, 1u,					// Union, master 0, slave 1
+	7u, 0x05u, 0x80u | USBCDC_EP_NOTIFY, 0x03u, USBCDC_NOTIFY_SIZE, 0u, 16u,
+	// Interface 1 : data
+	9u, 0x04u, 1u, 0u, 2u, 0x0Au, 0x00u, 0x00u, 0u,
+	7u, 0x05u, USBCDC_EP_DATA, 0x02u, USBCDC_PACKET_SIZE, 0u, 0u,
+	7u, 0x05u, 0x80u | USBCDC_EP_DATA, 0x02u, USBCDC_PACKET_SIZE, 0u, 0u
+};
+
+/**
+ * @brief Language ID string descriptor (English US)
+ */
+static const uint8_t _langDescriptor[] = {4u, USB_DESC_STRING, 0x09u, 0x04u};
+
+/**
+ * @brief Manufacturer and product strings
+ */
+static const char* _manufacturer = "CBOT";
+static const char* _product = "Sirius Actionneurs VCP";
+
+/*----------------------------------------------------------------------------*/
+/* Private Functions                                                          */
+/*----------------------------------------------------------------------------*/
+
+/**
+ * @brief Initialize OTG FS core in device mode, soft disconnected
+ */
+static void _hardwareInit ()
+{
+	GPIO_InitTypeDef GPIOStruct;
+	NVIC_InitTypeDef NVICStruct;
+	uint32_t ep;
+
+	// Init DM and DP pins
+	GPIOStruct.GPIO_Mode	=	GPIO_Mode_AF;
+	GPIOStruct.GPIO_OType	=	GPIO_OType_PP;
+	GPIOStruct.GPIO_PuPd	=	GPIO_PuPd_NOPULL;
+	GPIOStruct.GPIO_Speed	=	GPIO_High_Speed;
+	GPIOStruct.GPIO_Pin		=	USBCDC_DM_PIN;
+
+	GPIO_PinAFConfig(USBCDC_DM_PORT, USBCDC_DM_PINSOURCE, USBCDC_IO_AF);
+	GPIO_Init(USBCDC_DM_PORT, &GPIOStruct);
+
+	GPIOStruct.GPIO_Pin		=	USBCDC_DP_PIN;
+
+	GPIO_PinAFConfig(USBCDC_DP_PORT, USBCDC_DP_PINSOURCE, USBCDC_IO_AF);
+	GPIO_Init(USBCDC_DP_PORT, &GPIOStruct);
+
+	// 48 MHz from PLLSAI, main PLL Q output is not 48 MHz at 180 MHz SYSCLK
+	RCC_PLLSAICmd(DISABLE);
+	RCC_PLLSAIConfig(USBCDC_PLLSAI_M, USBCDC_PLLSAI_N, USBCDC_PLLSAI_P, USBCDC_PLLSAI_Q);
+	RCC_PLLSAICmd(ENABLE);
+	while(RCC_GetFlagStatus(RCC_FLAG_PLLSAIRDY) == RESET)
+	{}
+	RCC_48MHzClockSourceConfig(RCC_48MHZCLKSource_PLLSAI);
+
+	// Core soft reset, embedded full speed PHY
+	OTGFS->GUSBCFG |= OTGFS_GUSBCFG_PHYSEL;
+	while((OTGFS->GRSTCTL & OTGFS_GRSTCTL_AHBIDL) == 0u)
+	{}
+	OTGFS->GRSTCTL |= OTGFS_GRSTCTL_CSRST;
+	while((OTGFS->GRSTCTL & OTGFS_GRSTCTL_CSRST) != 0u)
+	{}
+
+	// Transceiver on, VBUS is not sensed : B session forced valid
+	OTGFS->GCCFG = OTGFS_GCCFG_PWRDWN;
+	OTGFS->GOTGCTL |= OTGFS_GOTGCTL_BVALOEN | OTGFS_GOTGCTL_BVALOVAL;
+
+	// Forced device mode (effective after 25 ms at most)
+	OTGFS->GUSBCFG = (OTGFS->GUSBCFG & ~(OTGFS_GUSBCFG_FHMOD | OTGFS_GUSBCFG_FDMOD | OTGFS_GUSBCFG_TRDT)) |
+					 OTGFS_GUSBCFG_FDMOD | (USBCDC_TRDT << OTGFS_GUSBCFG_TRDT_POS);
+	while((OTGFS->GINTSTS & OTGFS_GINT_CMOD) != 0u)
+	{}
+
+	// PHY clock running, full speed, disconnected until endpoints are set up
+	OTGFS_PCGCCTL = 0u;
+	OTGFS_DEVICE->DCTL |= OTGFS_DCTL_SDIS;
+	OTGFS_DEVICE->DCFG = (OTGFS_DEVICE->DCFG & ~0x3u) | OTGFS_DCFG_DSPD_FS;
+
+	// FIFO RAM
+	OTGFS->GRXFSIZ = USBCDC_RX_FIFO_WORDS;
+	OTGFS->DIEPTXF0 = (USBCDC_TX0_FIFO_WORDS << 16) | USBCDC_RX_FIFO_WORDS;
+	OTGFS->DIEPTXF[0] = (USBCDC_TX1_FIFO_WORDS << 16) | (USBCDC_RX_FIFO_WORDS + USBCDC_TX0_FIFO_WORDS);
+	OTGFS->DIEPTXF[1] = (USBCDC_TX2_FIFO_WORDS << 16) | (USBCDC_RX_FIFO_WORDS + USBCDC_TX0_FIFO_WORDS + USBCDC_TX1_FIFO_WORDS);
+
+	OTGFS->GRSTCTL = OTGFS_GRSTCTL_TXFFLSH | OTGFS_GRSTCTL_TXFNUM_ALL;
+	while((OTGFS->GRSTCTL & OTGFS_GRSTCTL_TXFFLSH) != 0u)
+	{}
+	OTGFS->GRSTCTL = OTGFS_GRSTCTL_RXFFLSH;
+	while((OTGFS->GRSTCTL & OTGFS_GRSTCTL_RXFFLSH) != 0u)
+	{}
+
+	// Endpoints disabled, interrupts masked until bus reset
+	OTGFS_DEVICE->DIEPMSK = 0u;
+	OTGFS_DEVICE->DOEPMSK = 0u;
+	OTGFS_DEVICE->DAINTMSK = 0u;
+	OTGFS_DEVICE->DIEPEMPMSK = 0u;
+
+	for(ep = 0u; ep < USBCDC_EP_MAX; ep++)
+	{
+		OTGFS_IN(ep)->CTL = ((OTGFS_IN(ep)->CTL & OTGFS_EPCTL_EPENA) != 0u) ? (OTGFS_EPCTL_EPDIS | OTGFS_EPCTL_SNAK) : 0u;
+		OTGFS_IN(ep)->TSIZ = 0u;
+		OTGFS_IN(ep)->INT = OTGFS_EPINT_ALL;
+		OTGFS_OUT(ep)->CTL = ((OTGFS_OUT(ep)->CTL & OTGFS_EPCTL_EPENA) != 0u) ? (OTGFS_EPCTL_EPDIS | OTGFS_EPCTL_SNAK) : 0u;
+		OTGFS_OUT(ep)->TSIZ = 0u;
+		OTGFS_OUT(ep)->INT = OTGFS_EPINT_ALL;
+	}
+
+	// Core interrupts
+	OTGFS->GINTMSK = 0u;
+	OTGFS->GINTSTS = 0xBFFFFFFFu;
+	OTGFS->GINTMSK = OTGFS_GINT_RXFLVL | OTGFS_GINT_USBSUSP | OTGFS_GINT_USBRST | OTGFS_GINT_ENUMDNE |
+					 OTGFS_GINT_IEPINT | OTGFS_GINT_OEPINT | OTGFS_GINT_WKUINT;
+	OTGFS->GAHBCFG |= OTGFS_GAHBCFG_GINTMSK;
+
+	// NVIC Init
+	NVICStruct.NVIC_IRQChannel						=	USBCDC_INT_CHANNEL;
+	NVICStruct.NVIC_IRQChannelPreemptionPriority	=	USBCDC_INT_PRIORITY;
+	NVICStruct.NVIC_IRQChannelSubPriority			=	0;
+	NVICStruct.NVIC_IRQChannelCmd					=	ENABLE;
+
+	NVIC_Init(&NVICStruct);
+}
+
+/**
+ * @brief Read a packet from RX FIFO
+ * @param buffer : Destination
+ * @param length : Packet length (whole packet is popped)
+ * @param size : Destination size (extra bytes are dropped)
+ */
+static void _readFifo (uint8_t * buffer, uint32_t length, uint32_t size)
+{
+	uint32_t word;
+	uint32_t i, n;
+
+	for(i = 0u; i < length; i += sizeof(word))
+	{
+		word = OTGFS_FIFO(0u);
+
+		n = length - i;
+		if(n > sizeof(word))
+			n = sizeof(word);
+
+		if((i + n) <= size)
+			memcpy(&buffer[i], &word, n);
+	}
+}
+
+/**
+ * @brief Build a string descriptor (ASCII to UTF-16LE)
+ * @param buffer : Descriptor buffer (USBCDC_PACKET_SIZE)
+ * @param str : ASCII string (31 characters at most)
+ * @return Descriptor length
+ */
+static uint32_t _stringDescriptor (uint8_t * buffer, const char * str)
+{
+	uint32_t length = 2u;
+
+	while((*str != '\0') && (length < USBCDC_PACKET_SIZE))
+	{
+		buffer[length++] = (uint8_t)*str++;
+		buffer[length++] = 0u;
+	}
+
+	buffer[0] = (uint8_t)length;
+	buffer[1] = USB_DESC_STRING;
+
+	return length;
+}
+
+/**
+ * @brief Build serial number string from the device unique ID
+ * @param str : String buffer (25 bytes)
+ */
+static void _serialNumber (char * str)
+{
+	static const char hex[] = "0123456789ABCDEF";
+	uint32_t i, word;
+
+	for(i = 0u; i < 24u; i++)
+	{
+		word = USBCDC_UID[2u - (i / 8u)];
+		str[i] = hex[(word >> (28u - (4u * (i % 8u)))) & 0xFu];
+	}
+
+	str[24] = '\0';
+}
+
+/*----------------------------------------------------------------------------*/
+/* Class Implementation	                                                      */
+/*----------------------------------------------------------------------------*/
+
+namespace HAL
+{
+	UsbCdc* UsbCdc::GetInstance ()
+	{
+		// if UsbCdc instance already exists
+		if(_usbCdc != NULL)
+		{
+			return _usbCdc;
+		}
+		else
+		{
+			// Create UsbCdc instance
+			_usbCdc = new (_usbCdcStorage.Get()) UsbCdc();
+
+			return _usbCdc;
+		}
+	}
+
+	UsbCdc::UsbCdc ()
+	{
+		this->configured = false;
+		this->dtr = false;
+		this->lineCodingPending = false;
+
+		this->lineCoding.BAUDRATE = 115200u;
+		this->lineCoding.STOPBITS = 0u;
+		this->lineCoding.PARITY = 0u;
+		this->lineCoding.DATABITS = 8u;
+
+		memset(this->setup, 0, sizeof(this->setup));
+		memset(&this->ep0, 0, sizeof(this->ep0));
+		memset(&this->tx, 0, sizeof(this->tx));
+		this->rx.length = 0u;
+		this->rx.index = 0u;
+		this->rx.count = 0u;
+
+		_hardwareInit();
+
+		// Connect, enumeration starts with the host bus reset
+		OTGFS_DEVICE->DCTL &= ~OTGFS_DCTL_SDIS;
+	}
+
+	uint32_t UsbCdc::Transmit (const uint8_t * buffer, uint32_t length)
+	{
+		uint32_t primask;
+
+		if(length > USBCDC_TX_MAX)
+			length = USBCDC_TX_MAX;
+
+		// Shared with OTG interrupt
+		primask = __get_PRIMASK();
+		__disable_irq();
+
+		if(!this->configured || this->tx.busy || (length == 0u))
+		{
+			length = 0u;
+		}
+		else
+		{
+			// A full last packet does not end the transfer on the host side
+			this->tx.zlp = ((length % USBCDC_PACKET_SIZE) == 0u);
+			this->startIn(USBCDC_EP_DATA, &this->tx, buffer, length);
+		}
+
+		__set_PRIMASK(primask);
+
+		return length;
+	}
+
+	uint32_t UsbCdc::Receive (uint8_t * buffer, uint32_t size)
+	{
+		uint32_t primask;
+		uint32_t length;
+
+		// Shared with OTG interrupt
+		primask = __get_PRIMASK();
+		__disable_irq();
+
+		length = this->rx.length - this->rx.index;
+		if(length > size)
+			length = size;
+
+		memcpy(buffer, &this->rx.data[this->rx.index], length);
+		this->rx.index += length;
+
+		// Packet fully read, next one is accepted
+		if((length > 0u) && (this->rx.index == this->rx.length))
+			this->rxStart();
+
+		__set_PRIMASK(primask);
+
+		return length;
+	}
+
+	void UsbCdc::reset ()
+	{
+		uint32_t ep;
+
+		OTGFS_DEVICE->DCTL &= ~OTGFS_DCTL_RWUSIG;
+
+		OTGFS->GRSTCTL = OTGFS_GRSTCTL_TXFFLSH | OTGFS_GRSTCTL_TXFNUM_ALL;
+		while((OTGFS->GRSTCTL & OTGFS_GRSTCTL_TXFFLSH) != 0u)
+		{}
+
+		for(ep = 0u; ep < USBCDC_EP_MAX; ep++)
+		{
+			OTGFS_IN(ep)->INT = OTGFS_EPINT_ALL;
+			OTGFS_OUT(ep)->INT = OTGFS_EPINT_ALL;
+			OTGFS_OUT(ep)->CTL |= OTGFS_EPCTL_SNAK;
+
+			if(ep != 0u)
+			{
+				OTGFS_IN(ep)->CTL &= ~OTGFS_EPCTL_USBAEP;
+				OTGFS_OUT(ep)->CTL &= ~OTGFS_EPCTL_USBAEP;
+			}
+		}
+
+		// Control endpoint only, address 0
+		OTGFS_DEVICE->DAINTMSK = (1u << 0) | (1u << 16);
+		OTGFS_DEVICE->DOEPMSK = OTGFS_EPINT_STUP | OTGFS_EPINT_XFRC;
+		OTGFS_DEVICE->DIEPMSK = OTGFS_EPINT_TOC | OTGFS_EPINT_XFRC;
+		OTGFS_DEVICE->DIEPEMPMSK = 0u;
+		OTGFS_DEVICE->DCFG &= ~OTGFS_DCFG_DAD;
+
+		this->configured = false;
+		this->dtr = false;
+		this->lineCodingPending = false;
+		this->ep0.busy = false;
+		this->ep0.remaining = 0u;
+		this->ep0.zlp = false;
+		this->rx.length = 0u;
+		this->rx.index = 0u;
+
+		this->ep0OutStart();
+
+		// Running transfer is lost
+		if(this->tx.busy)
+		{
+			this->tx.busy = false;
+			this->tx.remaining = 0u;
+			this->tx.zlp = false;
+
+			this->TransmitComplete();
+		}
+	}
+
+	void UsbCdc::readRxFifo ()
+	{
+		uint32_t status = OTGFS->GRXSTSP;
+		uint32_t ep = OTGFS_GRXSTS_EPNUM(status);
+		uint32_t length = OTGFS_GRXSTS_BCNT(status);
+
+		switch(OTGFS_GRXSTS_PKTSTS(status))
+		{
+		case OTGFS_PKTSTS_SETUP_DATA:
+			_readFifo(this->setup, length, sizeof(this->setup));
+			break;
+
+		case OTGFS_PKTSTS_OUT_DATA:
+			if(ep == 0u)
+			{
+				_readFifo(this->ep0Buffer, length, sizeof(this->ep0Buffer));
+			}
+			else
+			{
+				// Published on transfer complete
+				_readFifo(this->rx.data, length, sizeof(this->rx.data));
+				this->rx.count = (length < sizeof(this->rx.data)) ? length : sizeof(this->rx.data);
+			}
+			break;
+
+		// OUT transfer and SETUP stage completion are handled from endpoint interrupts
+		default:
+			break;
+		}
+	}
+
+	void UsbCdc::processSetup ()
+	{
+		uint8_t type = this->setup[0] & USB_REQ_TYPE;
+		uint8_t request = this->setup[1];
+		uint16_t value = (uint16_t)(this->setup[2] | (this->setup[3] << 8));
+		char serial[25];
+
+		if(type == USB_REQ_TYPE_STANDARD)
+		{
+			switch(request)
+			{
+			case USB_REQ_GET_STATUS:
+				this->ep0Buffer[0] = 0u;
+				this->ep0Buffer[1] = 0u;
+				this->controlIn(this->ep0Buffer, 2u);
+				break;
+
+			case USB_REQ_CLEAR_FEATURE:
+			case USB_REQ_SET_FEATURE:
+			case USB_REQ_SET_INTERFACE:
+				this->controlIn(NULL, 0u);
+				break;
+
+			// Address is set before the status stage (sent with address 0)
+			case USB_REQ_SET_ADDRESS:
+				OTGFS_DEVICE->DCFG = (OTGFS_DEVICE->DCFG & ~OTGFS_DCFG_DAD) | ((value & 0x7Fu) << OTGFS_DCFG_DAD_POS);
+				this->controlIn(NULL, 0u);
+				break;
+
+			case USB_REQ_GET_DESCRIPTOR:
+				switch(value >> 8)
+				{
+				case USB_DESC_DEVICE:
+					this->controlIn(_deviceDescriptor, sizeof(_deviceDescriptor));
+					break;
+				case USB_DESC_CONFIG:
+					this->controlIn(_configDescriptor, sizeof(_configDescriptor));
+					break;
+				case USB_DESC_STRING:
+					switch(value & 0xFFu)
+					{
+					case 0u:
+						this->controlIn(_langDescriptor, sizeof(_langDescriptor));
+						break;
+					case 1u:
+						this->controlIn(this->ep0Buffer, _stringDescriptor(this->ep0Buffer, _manufacturer));
+						break;
+					case 2u:
+						this->controlIn(this->ep0Buffer, _stringDescriptor(this->ep0Buffer, _product));
+						break;
+					case 3u:
+						_serialNumber(serial);
+						this->controlIn(this->ep0Buffer, _stringDescriptor(this->ep0Buffer, serial));
+						break;
+					default:
+						this->stall();
+						break;
+					}
+					break;
+				// Device qualifier included : full speed only device
+				default:
+					this->stall();
+					break;
+				}
+				break;
+
+			case USB_REQ_GET_CONFIG:
+				this->ep0Buffer[0] = this->configured ? 1u : 0u;
+				this->controlIn(this->ep0Buffer, 1u);
+				break;
+
+			case USB_REQ_SET_CONFIG:
+				this->setConfiguration((uint8_t)value);
+				break;
+
+			case USB_REQ_GET_INTERFACE:
+				this->ep0Buffer[0] = 0u;
+				this->controlIn(this->ep0Buffer, 1u);
+				break;
+
+			default:
+				this->stall();
+				break;
+			}
+		}
+		else if(type == USB_REQ_TYPE_CLASS)
+		{
+			switch(request)
+			{
+			// Data stage first, see processControlOut()
+			case CDC_SET_LINE_CODING:
+				this->lineCodingPending = true;
+				this->ep0OutStart();
+				break;
+
+			case CDC_GET_LINE_CODING:
+				memcpy(this->ep0Buffer, &this->lineCoding, sizeof(this->lineCoding));
+				this->controlIn(this->ep0Buffer, sizeof(this->lineCoding));
+				break;
+
+			case CDC_SET_CONTROL_LINE:
+				this->dtr = ((value & 0x1u) != 0u);
+				this->controlIn(NULL, 0u);
+				break;
+
+			case CDC_SEND_BREAK:
+				this->controlIn(NULL, 0u);
+				break;
+
+			default:
+				this->stall();
+				break;
+			}
+		}
+		else
+		{
+			this->stall();
+		}
+	}
+
+	void UsbCdc::processControlOut ()
+	{
+		if(this->lineCodingPending)
+		{
+			this->lineCodingPending = false;
+
+			memcpy(&this->lineCoding, this->ep0Buffer, sizeof(this->lineCoding));
+			this->controlIn(NULL, 0u);
+		}
+	}
+
+	void UsbCdc::setConfiguration (uint8_t config)
+	{
+		if(config == 1u)
+		{
+			OTGFS_IN(USBCDC_EP_DATA)->CTL = OTGFS_EPCTL_USBAEP | OTGFS_EPCTL_EPTYP_BULK | OTGFS_EPCTL_SD0PID |
+											(USBCDC_EP_DATA << OTGFS_EPCTL_TXFNUM_POS) | USBCDC_PACKET_SIZE;
+			OTGFS_IN(USBCDC_EP_NOTIFY)->CTL = OTGFS_EPCTL_USBAEP | OTGFS_EPCTL_EPTYP_INT | OTGFS_EPCTL_SD0PID |
+											(USBCDC_EP_NOTIFY << OTGFS_EPCTL_TXFNUM_POS) | USBCDC_NOTIFY_SIZE;
+			OTGFS_OUT(USBCDC_EP_DATA)->CTL = OTGFS_EPCTL_USBAEP | OTGFS_EPCTL_EPTYP_BULK | OTGFS_EPCTL_SD0PID |
+											USBCDC_PACKET_SIZE;
+
+			OTGFS_DEVICE->DAINTMSK |= (1u << USBCDC_EP_DATA) | (1u << (16u + USBCDC_EP_DATA));
+
+			this->configured = true;
+			this->rxStart();
+			this->controlIn(NULL, 0u);
+
+			this->Configured();
+		}
+		else if(config == 0u)
+		{
+			OTGFS_IN(USBCDC_EP_DATA)->CTL &= ~OTGFS_EPCTL_USBAEP;
+			OTGFS_IN(USBCDC_EP_NOTIFY)->CTL &= ~OTGFS_EPCTL_USBAEP;
+			OTGFS_OUT(USBCDC_EP_DATA)->CTL &= ~OTGFS_EPCTL_USBAEP;
+
+			this->configured = false;
+			this->controlIn(NULL, 0u);
+		}
+		else
+		{
+			this->stall();
+		}
+	}
+
+	void UsbCdc::startIn (uint32_t ep, USBCDC_IN * in, const uint8_t * buffer, uint32_t length)
+	{
+		uint32_t packets = (length + USBCDC_PACKET_SIZE - 1u) / USBCDC_PACKET_SIZE;
+
+		// Zero length packet still counts as one
+		if(packets == 0u)
+			packets = 1u;
+
+		in->data = buffer;
+		in->remaining = length;
+		in->busy = true;
+
+		OTGFS_IN(ep)->TSIZ = (packets << OTGFS_TSIZ_PKTCNT_POS) | length;
+		OTGFS_IN(ep)->CTL |= OTGFS_EPCTL_CNAK | OTGFS_EPCTL_EPENA;
+
+		// FIFO is filled from TX FIFO empty interrupt
+		if(length > 0u)
+			OTGFS_DEVICE->DIEPEMPMSK |= (1u << ep);
+	}
+
+	void UsbCdc::writeTxFifo (uint32_t ep, USBCDC_IN * in)
+	{
+		uint32_t length, words, word, i, n;
+
+		while(in->remaining > 0u)
+		{
+			length = (in->remaining < USBCDC_PACKET_SIZE) ? in->remaining : USBCDC_PACKET_SIZE;
+			words = (length + 3u) / 4u;
+
+			// Whole packets only
+			if((OTGFS_IN(ep)->TXFSTS & 0xFFFFu) < words)
+				break;
+
+			for(i = 0u; i < length; i += sizeof(word))
+			{
+				n = length - i;
+				if(n > sizeof(word))
+					n = sizeof(word);
+
+				word = 0u;
+				memcpy(&word, &in->data[i], n);
+				OTGFS_FIFO(ep) = word;
+			}
+
+			in->data += length;
+			in->remaining -= length;
+		}
+
+		if(in->remaining == 0u)
+			OTGFS_DEVICE->DIEPEMPMSK &= ~(1u << ep);
+	}
+
+	void UsbCdc::controlIn (const uint8_t * buffer, uint32_t length)
+	{
+		uint32_t requested = (uint32_t)(this->setup[6] | (this->setup[7] << 8));
+
+		if(length > requested)
+			length = requested;
+
+		// Shorter answer than requested ends with a short packet
+		this->ep0.zlp = (length > 0u) && (length < requested) && ((length % USBCDC_PACKET_SIZE) == 0u);
+		this->startIn(0u, &this->ep0, buffer, length);
+
+		// Status stage (OUT) or next SETUP packet
+		this->ep0OutStart();
+	}
+
+	void UsbCdc::ep0OutStart ()
+	{
+		OTGFS_OUT(0u)->TSIZ = OTGFS_TSIZ_STUPCNT_3 | (1u << OTGFS_TSIZ_PKTCNT_POS) | USBCDC_PACKET_SIZE;
+		OTGFS_OUT(0u)->CTL |= OTGFS_EPCTL_CNAK | OTGFS_EPCTL_EPENA;
+	}
+
+	void UsbCdc::rxStart ()
+	{
+		this->rx.length = 0u;
+		this->rx.index = 0u;
+
+		OTGFS_OUT(USBCDC_EP_DATA)->TSIZ = (1u << OTGFS_TSIZ_PKTCNT_POS) | USBCDC_PACKET_SIZE;
+		OTGFS_OUT(USBCDC_EP_DATA)->CTL |= OTGFS_EPCTL_CNAK | OTGFS_EPCTL_EPENA;
+	}
+
+	void UsbCdc::stall ()
+	{
+		// Cleared by the core on next SETUP packet
+		OTGFS_IN(0u)->CTL |= OTGFS_EPCTL_STALL;
+		OTGFS_OUT(0u)->CTL |= OTGFS_EPCTL_STALL;
+
+		this->ep0OutStart();
+	}
+
+	void UsbCdc::INTERNAL_InterruptCallback ()
+	{
+		uint32_t status = OTGFS->GINTSTS & OTGFS->GINTMSK;
+		uint32_t daint, flags;
+
+		// Received packets (masked while FIFO is read)
+		if((status & OTGFS_GINT_RXFLVL) != 0u)
+		{
+			OTGFS->GINTMSK &= ~OTGFS_GINT_RXFLVL;
+
+			while((OTGFS->GINTSTS & OTGFS_GINT_RXFLVL) != 0u)
+				this->readRxFifo();
+
+			OTGFS->GINTMSK |= OTGFS_GINT_RXFLVL;
+		}
+
+		if((status & OTGFS_GINT_USBRST) != 0u)
+		{
+			OTGFS->GINTSTS = OTGFS_GINT_USBRST;
+
+			this->reset();
+		}
+
+		// Speed enumeration done, EP0 max packet size 64 bytes
+		if((status & OTGFS_GINT_ENUMDNE) != 0u)
+		{
+			OTGFS->GINTSTS = OTGFS_GINT_ENUMDNE;
+
+			OTGFS_IN(0u)->CTL &= ~OTGFS_EPCTL_MPSIZ;
+			OTGFS_DEVICE->DCTL |= OTGFS_DCTL_CGINAK;
+		}
+
+		if((status & OTGFS_GINT_OEPINT) != 0u)
+		{
+			daint = (OTGFS_DEVICE->DAINT & OTGFS_DEVICE->DAINTMSK) >> 16;
+
+			if((daint & (1u << 0)) != 0u)
+			{
+				flags = OTGFS_OUT(0u)->INT & OTGFS_DEVICE->DOEPMSK;
+				OTGFS_OUT(0u)->INT = flags;
+
+				// Data or status stage received, before a new SETUP stage
+				if((flags & OTGFS_EPINT_XFRC) != 0u)
+				{
+					this->processControlOut();
+					this->ep0OutStart();
+				}
+
+				if((flags & OTGFS_EPINT_STUP) != 0u)
+					this->processSetup();
+			}
+
+			if((daint & (1u << USBCDC_EP_DATA)) != 0u)
+			{
+				flags = OTGFS_OUT(USBCDC_EP_DATA)->INT & OTGFS_DEVICE->DOEPMSK;
+				OTGFS_OUT(USBCDC_EP_DATA)->INT = flags;
+
+				if((flags & OTGFS_EPINT_XFRC) != 0u)
+				{
+					this->rx.index = 0u;
+					this->rx.length = this->rx.count;
+
+					// Host is held (NAK) until the packet is read
+					if(this->rx.length > 0u)
+						this->DataReceived();
+					else
+						this->rxStart();
+				}
+			}
+		}
+
+		if((status & OTGFS_GINT_IEPINT) != 0u)
+		{
+			daint = OTGFS_DEVICE->DAINT & OTGFS_DEVICE->DAINTMSK & 0xFFFFu;
+
+			if((daint & (1u << 0)) != 0u)
+			{
+				flags = OTGFS_IN(0u)->INT;
+				OTGFS_IN(0u)->INT = flags & OTGFS_DEVICE->DIEPMSK;
+
+				if(((flags & OTGFS_EPINT_TXFE) != 0u) && ((OTGFS_DEVICE->DIEPEMPMSK & (1u << 0)) != 0u))
+					this->writeTxFifo(0u, &this->ep0);
+
+				if((flags & OTGFS_EPINT_XFRC) != 0u)
+				{
+					if(this->ep0.zlp)
+					{
+						this->ep0.zlp = false;
+						this->startIn(0u, &this->ep0, NULL, 0u);
+					}
+					else
+					{
+						this->ep0.busy = false;
+					}
+				}
+			}
+
+			if((daint & (1u << USBCDC_EP_DATA)) != 0u)
+			{
+				flags = OTGFS_IN(USBCDC_EP_DATA)->INT;
+				OTGFS_IN(USBCDC_EP_DATA)->INT = flags & OTGFS_DEVICE->DIEPMSK;
+
+				if(((flags & OTGFS_EPINT_TXFE) != 0u) && ((OTGFS_DEVICE->DIEPEMPMSK & (1u << USBCDC_EP_DATA)) != 0u))
+					this->writeTxFifo(USBCDC_EP_DATA, &this->tx);
+
+				if((flags & OTGFS_EPINT_XFRC) != 0u)
+				{
+					if(this->tx.zlp)
+					{
+						this->tx.zlp = false;
+						this->startIn(USBCDC_EP_DATA, &this->tx, NULL, 0u);
+					}
+					else
+					{
+						this->tx.busy = false;
+
+						this->TransmitComplete();
+					}
+				}
+			}
+		}
+
+		// Nothing is powered down on suspend
+		if((status & OTGFS_GINT_USBSUSP) != 0u)
+			OTGFS->GINTSTS = OTGFS_GINT_USBSUSP;
+
+		if((status & OTGFS_GINT_WKUINT) != 0u)
+			OTGFS->GINTSTS = OTGFS_GINT_WKUINT;
+	}
+}
+
+/*----------------------------------------------------------------------------*/
+/* Interrupt Handler                                                          */
+/*----------------------------------------------------------------------------*/
+
+extern "C"
+{
+	/**
+	 * @brief USB OTG FS IRQ Handler
+	 */
+	void OTG_FS_IRQHandler (void)
+	{
+		_otgProfiler.Start();
+
+		_usbCdc->INTERNAL_InterruptCallback();
+
+		_otgProfiler.Stop();
+	}
+}
@@ -0,0 +1,152 @@
+/**
+ * @file	Plant.hpp
+ * @author	Jeremy ROULLAND
+ * @date	15 oct. 2026
+ * @brief	Differential drive robot model (host simulation)
+ */
+
+#ifndef INC_PLANT_HPP_
+#define INC_PLANT_HPP_
+
+#include "common.h"
+
+/*----------------------------------------------------------------------------*/
+/* Definitions                                                                */
+/*----------------------------------------------------------------------------*/
+
+/**
+ * @brief Differential drive definition
+ */
+typedef struct
+{
+	float32_t	WHEELBASE;		/**< Distance between encoder wheels (m) */
+	float32_t	TICK_BY_M;		/**< Encoder counts by meter (x4 quadrature) */
+	float32_t	TAU;			/**< Wheel speed time constant (s) */
+	float32_t	ACC_MAX;		/**< Traction limit (m/s^2), 0 is none */
+	float32_t	SPEED_MAX;		/**< Motor speed limit (m/s) */
+}PLANT_DEF;
+
+/*----------------------------------------------------------------------------*/
+/* Class declaration	                                                      */
+/*----------------------------------------------------------------------------*/
+
+/**
+ * @namespace Simulation
+ * @brief Host simulation of the robot (plant model and simulated HAL)
+ */
+namespace Simulation
+{
+	/**
+	 * @class DiffDrive
+	 * @brief Two wheels robot : first order wheel speed, saturated by traction
+	 *
+	 * HOWTO :
+	 * - Command each wheel with SetSpeed() (what the motor drivers would do)
+	 * - Advance the model with Step()
+	 * - Read pose (ground truth) and free running encoder counters
+	 */
+	class DiffDrive
+	{
+	public:
+
+		/**
+		 * @brief Wheels
+		 */
+		enum SIDE
+		{
+			LEFT,
+			RIGHT,
+			SIDE_MAX
+		};
+
+		/**
+		 * @brief Constructor
+		 * @param def : Robot definition
+		 */
+		DiffDrive (const PLANT_DEF& def);
+
+		/**
+		 * @brief Robot at rest on origin
+		 */
+		void Reset ();
+
+		/**
+		 * @brief Set wheel speed command
+		 * @param side : Wheel
+		 * @param speed : Speed (m/s)
+		 */
+		void SetSpeed (DiffDrive::SIDE side, float32_t speed);
+
+		/**
+		 * @brief Advance model
+		 * @param dt : Step (s)
+		 */
+		void Step (float32_t dt);
+
+		/**
+		 * @brief Return wheel encoder counter (timer CNT, wraps)
+		 */
+		uint32_t GetCounter (DiffDrive::SIDE side) const;
+
+		/**
+		 * @brief Return wheel travelled distance (m)
+		 */
+		float32_t GetDistance (DiffDrive::SIDE side) const
+		{
+			return static_cast<float32_t>(this->wheel[side].position);
+		}
+
+		/**
+		 * @brief Return wheel speed (m/s)
+		 */
+		float32_t GetSpeed (DiffDrive::SIDE side) const
+		{
+			return this->wheel[side].speed;
+		}
+
+		float32_t GetX () const		{ return static_cast<float32_t>(this->x); }
+		float32_t GetY () const		{ return static_cast<float32_t>(this->y); }
+		float32_t GetTheta () const	{ return static_cast<float32_t>(this->theta); }
+
+		/**
+		 * @brief Return simulated time (s)
+		 */
+		float64_t GetTime () const
+		{
+			return this->time;
+		}
+
+		const PLANT_DEF& GetDef () const
+		{
+			return this->def;
+		}
+
+	private:
+
+		/**
+		 * @private
+		 * @brief Wheel state
+		 */
+		struct Wheel
+		{
+			float32_t	command;
+			float32_t	speed;
+			float64_t	position;
+		};
+
+		PLANT_DEF def;
+
+		struct Wheel wheel[SIDE_MAX];
+
+		/**
+		 * @private
+		 * @brief Pose (double : long runs do not drift from rounding)
+		 */
+		float64_t x;
+		float64_t y;
+		float64_t theta;
+		float64_t time;
+	};
+}
+
+#endif /* INC_PLANT_HPP_ */
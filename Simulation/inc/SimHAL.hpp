@@ -0,0 +1,79 @@
+/**
+ * @file	SimHAL.hpp
+ * @author	Jeremy ROULLAND
+ * @date	15 oct. 2026
+ * @brief	Simulated hardware (host simulation)
+ */
+
+#ifndef INC_SIMHAL_HPP_
+#define INC_SIMHAL_HPP_
+
+#include "common.h"
+#include "Plant.hpp"
+#include "Encoder.hpp"
+
+/*----------------------------------------------------------------------------*/
+/* Definitions                                                                */
+/*----------------------------------------------------------------------------*/
+
+/**
+ * @brief Simulated CPU clock (cycles counter)
+ */
+#define SIMHAL_CORE_FREQ		(180000000.0)
+
+/*----------------------------------------------------------------------------*/
+/* Class declaration	                                                      */
+/*----------------------------------------------------------------------------*/
+
+/**
+ * @namespace Simulation
+ */
+namespace Simulation
+{
+	/**
+	 * @class SimHAL
+	 * @brief Peripherals backed by the plant model
+	 *
+	 * HOWTO :
+	 * - Attach() the plant before getting any HAL instance
+	 * - Call Step() instead of waiting : the plant advances and the encoders
+	 *   timers counters follow it
+	 *
+	 * The HAL classes keep their headers : Simulation/src replaces
+	 * HardwareAbstraction/src, each timer register block is a host variable
+	 * written by Step(). Drivers outputs are the plant SetSpeed(), console
+	 * output is stdout (Utils::Print()).
+	 */
+	class SimHAL
+	{
+	public:
+
+		/**
+		 * @brief Attach plant model
+		 */
+		static void Attach (DiffDrive* plant);
+
+		/**
+		 * @brief Return attached plant model
+		 */
+		static DiffDrive* GetPlant ();
+
+		/**
+		 * @brief Advance plant and peripherals
+		 * @param dt : Step (s)
+		 */
+		static void Step (float32_t dt);
+
+		/**
+		 * @brief Return simulated CPU cycles counter (DWT CYCCNT)
+		 */
+		static uint32_t GetCycles ();
+
+		/**
+		 * @brief Return encoder timer registers
+		 */
+		static TIM_TypeDef* GetTimer (HAL::Encoder::ID id);
+	};
+}
+
+#endif /* INC_SIMHAL_HPP_ */
@@ -0,0 +1,101 @@
+/**
+ * @file	Encoder.cpp
+ * @author	Jeremy ROULLAND
+ * @date	15 oct. 2026
+ * @brief	Encoder abstraction class (host simulation)
+ */
+
+#include <stddef.h>
+#include "Encoder.hpp"
+#include "StaticStorage.hpp"
+#include "SimHAL.hpp"
+#include "common.h"
+
+using namespace HAL;
+
+/*----------------------------------------------------------------------------*/
+/* Private Members                                                            */
+/*----------------------------------------------------------------------------*/
+
+// Static storage for encoder instances (no heap)
+static Utils::StaticStorage<Encoder, Encoder::ENCODER_MAX> _encStorage;
+
+// Encoder instances
+static Encoder* _enc[Encoder::ENCODER_MAX] = {NULL};
+
+/*----------------------------------------------------------------------------*/
+/* Class Implementation	                                                      */
+/*----------------------------------------------------------------------------*/
+
+namespace HAL
+{
+	Encoder* Encoder::GetInstance (Encoder::ID id)
+	{
+		assert(id < Encoder::ENCODER_MAX);
+
+		// if encoder instance already exists
+		if(_enc[id] != NULL)
+		{
+			return _enc[id];
+		}
+		else
+		{
+			// Create encoder instance
+			_enc[id] = new (_encStorage.Get(id)) Encoder(id);
+
+			return _enc[id];
+		}
+	}
+
+	Encoder::Encoder (Encoder::ID id)
+	{
+		this->def.TIMER.TIMER		=	Simulation::SimHAL::GetTimer(id);
+		this->def.TIMER.RELOAD_VAL	=	0xFFFFFFFFu;
+
+		this->prevCounter	=	this->def.TIMER.TIMER->CNT;
+		this->absolutePos	=	0;
+		this->relativePos	=	0;
+		this->edgeSeq		=	0;
+		this->edgeCount		=	0;
+		this->edgeTime		=	0;
+	}
+
+	void Encoder::update()
+	{
+		uint32_t counter = this->def.TIMER.TIMER->CNT;
+
+		// Two's complement difference handles counter wrap in both directions
+		this->relativePos	=	(int32_t)(counter - this->prevCounter);
+		this->prevCounter	=	counter;
+		this->absolutePos	+=	this->relativePos;
+	}
+
+	int64_t Encoder::GetAbsoluteValue()
+	{
+		this->update();
+
+		return this->absolutePos;
+	}
+
+	int32_t Encoder::GetRelativeValue()
+	{
+		this->update();
+
+		return this->relativePos;
+	}
+
+	uint32_t Encoder::GetLastEdge(uint32_t* count, uint32_t* timestamp)
+	{
+		*count		=	this->edgeCount;
+		*timestamp	=	this->edgeTime;
+
+		return this->edgeSeq;
+	}
+
+	void Encoder::INTERNAL_CaptureCallback()
+	{
+		this->edgeCount	=	this->def.TIMER.TIMER->CCR1;
+		this->edgeTime	=	Simulation::SimHAL::GetCycles();
+		this->edgeSeq++;
+	}
+}
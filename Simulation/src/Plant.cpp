@@ -0,0 +1,90 @@
+/**
+ * @file	Plant.cpp
+ * @author	Jeremy ROULLAND
+ * @date	15 oct. 2026
+ * @brief	Differential drive robot model (host simulation)
+ */
+
+#include "Plant.hpp"
+
+#include <math.h>
+
+/*----------------------------------------------------------------------------*/
+/* Class Implementation	                                                      */
+/*----------------------------------------------------------------------------*/
+
+namespace Simulation
+{
+	DiffDrive::DiffDrive (const PLANT_DEF& def)
+	{
+		this->def = def;
+
+		this->Reset();
+	}
+
+	void DiffDrive::Reset ()
+	{
+		for(uint32_t i = 0u; i < DiffDrive::SIDE_MAX; i++)
+		{
+			this->wheel[i].command	= 0.0f;
+			this->wheel[i].speed	= 0.0f;
+			this->wheel[i].position	= 0.0;
+		}
+
+		this->x		= 0.0;
+		this->y		= 0.0;
+		this->theta	= 0.0;
+		this->time	= 0.0;
+	}
+
+	void DiffDrive::SetSpeed (DiffDrive::SIDE side, float32_t speed)
+	{
+		if(speed > this->def.SPEED_MAX)
+			speed = this->def.SPEED_MAX;
+		else if(speed < -this->def.SPEED_MAX)
+			speed = -this->def.SPEED_MAX;
+
+		this->wheel[side].command = speed;
+	}
+
+	void DiffDrive::Step (float32_t dt)
+	{
+		float64_t d[DiffDrive::SIDE_MAX];
+		float64_t ds, dtheta;
+
+		for(uint32_t i = 0u; i < DiffDrive::SIDE_MAX; i++)
+		{
+			struct Wheel* w = &this->wheel[i];
+			float32_t acc = (w->command - w->speed) / this->def.TAU;
+
+			// Wheels slip past traction limit
+			if(this->def.ACC_MAX > 0.0f)
+			{
+				if(acc > this->def.ACC_MAX)
+					acc = this->def.ACC_MAX;
+				else if(acc < -this->def.ACC_MAX)
+					acc = -this->def.ACC_MAX;
+			}
+
+			d[i] = (w->speed + 0.5f * acc * dt) * dt;
+
+			w->speed	+= acc * dt;
+			w->position	+= d[i];
+		}
+
+		// Arc between both wheels displacements
+		ds		= (d[DiffDrive::LEFT] + d[DiffDrive::RIGHT]) / 2.0;
+		dtheta	= (d[DiffDrive::RIGHT] - d[DiffDrive::LEFT]) / this->def.WHEELBASE;
+
+		this->x		+= ds * cos(this->theta + dtheta / 2.0);
+		this->y		+= ds * sin(this->theta + dtheta / 2.0);
+		this->theta	+= dtheta;
+		this->time	+= dt;
+	}
+
+	uint32_t DiffDrive::GetCounter (DiffDrive::SIDE side) const
+	{
+		// Quadrature counts are whole, two's complement wrap like the timer
+		return static_cast<uint32_t>(static_cast<int64_t>(floor(this->wheel[side].position * this->def.TICK_BY_M)));
+	}
+}
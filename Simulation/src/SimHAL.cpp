@@ -0,0 +1,85 @@
+/**
+ * @file	SimHAL.cpp
+ * @author	Jeremy ROULLAND
+ * @date	15 oct. 2026
+ * @brief	Simulated hardware (host simulation)
+ */
+
+#include "SimHAL.hpp"
+
+#include <stddef.h>
+#include <math.h>
+
+using namespace HAL;
+
+/*----------------------------------------------------------------------------*/
+/* Private Members                                                            */
+/*----------------------------------------------------------------------------*/
+
+/**
+ * @brief Plant model
+ */
+static Simulation::DiffDrive* _plant = NULL;
+
+/**
+ * @brief Encoders timers registers (ENCODER0 left, ENCODER1 right like Odometry)
+ */
+static TIM_TypeDef _encTimers[Encoder::ENCODER_MAX];
+
+/*----------------------------------------------------------------------------*/
+/* Class Implementation	                                                      */
+/*----------------------------------------------------------------------------*/
+
+namespace Simulation
+{
+	void SimHAL::Attach (DiffDrive* plant)
+	{
+		_plant = plant;
+
+		for(uint32_t i = 0u; i < Encoder::ENCODER_MAX; i++)
+		{
+			_encTimers[i].CNT	= plant->GetCounter(static_cast<DiffDrive::SIDE>(i));
+			_encTimers[i].CCR1	= _encTimers[i].CNT;
+		}
+	}
+
+	DiffDrive* SimHAL::GetPlant ()
+	{
+		return _plant;
+	}
+
+	void SimHAL::Step (float32_t dt)
+	{
+		assert(_plant != NULL);
+
+		_plant->Step(dt);
+
+		for(uint32_t i = 0u; i < Encoder::ENCODER_MAX; i++)
+		{
+			uint32_t counter = _plant->GetCounter(static_cast<DiffDrive::SIDE>(i));
+
+			// Channel A rising edge every 4 counts
+			if((counter >> 2u) != (_encTimers[i].CNT >> 2u))
+			{
+				_encTimers[i].CCR1 = counter;
+				Encoder::GetInstance(static_cast<Encoder::ID>(i))->INTERNAL_CaptureCallback();
+			}
+
+			_encTimers[i].CNT = counter;
+		}
+	}
+
+	uint32_t SimHAL::GetCycles ()
+	{
+		float64_t time = (_plant != NULL) ? _plant->GetTime() : 0.0;
+
+		return static_cast<uint32_t>(static_cast<uint64_t>(time * SIMHAL_CORE_FREQ));
+	}
+
+	TIM_TypeDef* SimHAL::GetTimer (Encoder::ID id)
+	{
+		assert(id < Encoder::ENCODER_MAX);
+
+		return &_encTimers[id];
+	}
+}
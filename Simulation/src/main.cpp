@@ -0,0 +1,178 @@
+/**
+ * @file	main.cpp
+ * @author	Jeremy ROULLAND
+ * @date	15 oct. 2026
+ * @brief	Host simulation : profile limits and gains sweep on a straight move
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <time.h>
+
+#include "common.h"
+#include "Plant.hpp"
+#include "SimHAL.hpp"
+#include "Encoder.hpp"
+#include "MotionProfile.hpp"
+#include "PID.hpp"
+#include "Format.hpp"
+
+using namespace Simulation;
+
+/*----------------------------------------------------------------------------*/
+/* Definitions                                                                */
+/*----------------------------------------------------------------------------*/
+
+#define SIM_PERIOD				(0.005f)	// Control loop period (s), like PositionControl
+#define SIM_SUBSTEPS			(10u)		// Plant steps by control period
+#define SIM_DISTANCE			(1.0f)		// Move length (m)
+#define SIM_SETTLE				(0.5f)		// Time after profile end (s)
+
+#define SIM_TICK_BY_M			(31722.561893f)	// Config DEFAULT_TICK_BY_MM
+#define SIM_WHEELBASE			(0.0793f)		// Config DEFAULT_ADW_TICK / DEFAULT_TICK_BY_MM
+
+/**
+ * @brief Robot model
+ */
+static const PLANT_DEF _plantDef =
+{
+	SIM_WHEELBASE,		// WHEELBASE
+	SIM_TICK_BY_M,		// TICK_BY_M
+	0.02f,				// TAU
+	6.0f,				// ACC_MAX
+	2.0f,				// SPEED_MAX
+};
+
+/**
+ * @brief Swept values
+ */
+static const MotionControl::MotionProfile::PROFILE _profiles[] = {MotionControl::MotionProfile::POLY5, MotionControl::MotionProfile::SCURVE};
+static const float32_t _velMax[] = {0.5f, 1.0f, 1.5f};
+static const float32_t _accMax[] = {1.0f, 2.0f, 4.0f};
+static const float32_t _kp[] = {5.0f, 20.0f, 50.0f};
+
+/**
+ * @brief Run result
+ */
+typedef struct
+{
+	float32_t	duration;	// Profile duration (s)
+	float32_t	errMax;		// Maximum distance tracking error (m)
+	float32_t	errRms;		// RMS distance tracking error (m)
+	float32_t	errEnd;		// Final distance error (m)
+	float32_t	heading;	// Final heading (rad)
+}SIM_RESULT;
+
+/*----------------------------------------------------------------------------*/
+/* Private Functions                                                          */
+/*----------------------------------------------------------------------------*/
+
+/**
+ * @brief Run one straight move : profile feed forward, distance and angle PID
+ */
+static SIM_RESULT _run (DiffDrive* plant, MotionControl::MotionProfile::PROFILE profile, float32_t velMax, float32_t accMax, float32_t kp)
+{
+	HAL::Encoder* left  = HAL::Encoder::GetInstance(HAL::Encoder::ENCODER0);
+	HAL::Encoder* right = HAL::Encoder::GetInstance(HAL::Encoder::ENCODER1);
+
+	MotionControl::MotionProfile mp(velMax, accMax, profile, 10.0f * accMax);
+	Utils::PID pidDist(kp, 0.0f, 0.0f, SIM_PERIOD);
+	Utils::PID pidAngle(kp, 0.0f, 0.0f, SIM_PERIOD);
+
+	SIM_RESULT r = {0.0f, 0.0f, 0.0f, 0.0f, 0.0f};
+	float32_t distance = 0.0f, angle = 0.0f;
+	float32_t t, tf, ref, v, w, err, sum = 0.0f;
+	uint32_t n = 0u;
+
+	plant->Reset();
+	SimHAL::Attach(plant);
+	left->Reset();
+	right->Reset();
+
+	mp.SetSetPoint(SIM_DISTANCE, 0.0f, 0.0f);
+	tf = mp.GetDuration();
+	r.duration = tf;
+
+	pidAngle.SetSetpoint(0.0f);
+
+	for(t = 0.0f; t < (tf + SIM_SETTLE); t += SIM_PERIOD)
+	{
+		// Odometry (encoders since last period)
+		float32_t dl = static_cast<float32_t>(left->GetRelativeValue())  / SIM_TICK_BY_M;
+		float32_t dr = static_cast<float32_t>(right->GetRelativeValue()) / SIM_TICK_BY_M;
+
+		distance	+= (dl + dr) / 2.0f;
+		angle		+= (dr - dl) / SIM_WHEELBASE;
+
+		ref = mp.Get(t);
+		err = ref - distance;
+
+		r.errMax = (fabsf(err) > r.errMax) ? fabsf(err) : r.errMax;
+		sum += err * err;
+		n++;
+
+		// Velocity feed forward plus position correction
+		pidDist.SetSetpoint(ref);
+		v = mp.GetVelocity(t) + pidDist.Get(distance);
+		w = pidAngle.Get(angle);
+
+		plant->SetSpeed(DiffDrive::LEFT,  v - w * SIM_WHEELBASE / 2.0f);
+		plant->SetSpeed(DiffDrive::RIGHT, v + w * SIM_WHEELBASE / 2.0f);
+
+		for(uint32_t i = 0u; i < SIM_SUBSTEPS; i++)
+			SimHAL::Step(SIM_PERIOD / SIM_SUBSTEPS);
+	}
+
+	r.errRms	= sqrtf(sum / static_cast<float32_t>(n));
+	r.errEnd	= SIM_DISTANCE - plant->GetX();
+	r.heading	= plant->GetTheta();
+
+	return r;
+}
+
+/*----------------------------------------------------------------------------*/
+/* Main                                                                       */
+/*----------------------------------------------------------------------------*/
+
+int main (void)
+{
+	DiffDrive plant(_plantDef);
+	clock_t start = clock();
+	float64_t simulated = 0.0, elapsed;
+
+	SimHAL::Attach(&plant);
+
+	Utils::Print("%-7s %5s %5s %5s %7s %9s %9s %9s\r\n", "profile", "vmax", "amax", "kp", "tf(s)", "max(mm)", "rms(mm)", "end(mm)");
+
+	for(uint32_t p = 0u; p < (sizeof(_profiles) / sizeof(_profiles[0])); p++)
+		for(uint32_t i = 0u; i < (sizeof(_velMax) / sizeof(_velMax[0])); i++)
+			for(uint32_t j = 0u; j < (sizeof(_accMax) / sizeof(_accMax[0])); j++)
+				for(uint32_t k = 0u; k < (sizeof(_kp) / sizeof(_kp[0])); k++)
+				{
+					SIM_RESULT r = _run(&plant, _profiles[p], _velMax[i], _accMax[j], _kp[k]);
+
+					simulated += plant.GetTime();
+
+					Utils::Print("%-7s %5.2f %5.2f %5.1f %7.3f %9.3f %9.3f %9.3f\r\n",
+								 (_profiles[p] == MotionControl::MotionProfile::SCURVE) ? "SCURVE" : "POLY5",
+								 _velMax[i], _accMax[j], _kp[k], r.duration,
+								 r.errMax * 1000.0f, r.errRms * 1000.0f, r.errEnd * 1000.0f);
+				}
+
+	elapsed = static_cast<float64_t>(clock() - start) / CLOCKS_PER_SEC;
+
+	Utils::Print("\r\nSimulated %.1f s in %.3f s\r\n", simulated, elapsed);
+
+	return EXIT_SUCCESS;
+}
+
+/**
+ * @brief Assertion failed callback
+ */
+void assert_failed(uint8_t* file, uint32_t line)
+{
+	fprintf(stderr, ASSERT_FAILED_MESSSAGE, file, line);
+
+	abort();
+}
@@ -0,0 +1,63 @@
+/**
+ * @file	Clock.hpp
+ * @author	Jeremy ROULLAND
+ * @date	21 oct. 2017
+ * @brief	Monotonic microsecond clock
+ */
+
+#ifndef INC_CLOCK_HPP_
+#define INC_CLOCK_HPP_
+
+#include "common.h"
+#include "stm32f4xx.h"
+
+/*----------------------------------------------------------------------------*/
+/* Class declaration	                                                      */
+/*----------------------------------------------------------------------------*/
+
+/**
+ * @namespace Utils
+ */
+namespace Utils
+{
+	/**
+	 * @class Clock
+	 * @brief Monotonic 64 bits microsecond clock from the DWT cycle counter
+	 *
+	 * HOWTO :
+	 * - Profiler::Init() enables the cycle counter (done by the OS run time stats)
+	 * - GetMicros64() never wraps, GetMicros() wraps every ~71 min (use differences)
+	 * - GetSeconds() for float time bases (motion profiles), microsecond resolution
+	 *
+	 * CYCCNT wraps every ~24s at 180MHz : the clock must be read at least once
+	 * per wrap, the OS tick hook and run time stats do it.
+	 * Any context, interrupts are disabled for a few cycles.
+	 */
+	class Clock
+	{
+	public:
+
+		/**
+		 * @brief Get microseconds since boot (64 bits)
+		 */
+		static uint64_t GetMicros64 ();
+
+		/**
+		 * @brief Get microseconds since boot (32 bits, wraps)
+		 */
+		static uint32_t GetMicros ()
+		{
+			return (uint32_t)GetMicros64();
+		}
+
+		/**
+		 * @brief Get seconds since boot
+		 */
+		static float32_t GetSeconds ()
+		{
+			return (float32_t)((double)GetMicros64() * 1.0e-6);
+		}
+	};
+}
+
+#endif /* INC_CLOCK_HPP_ */
@@ -0,0 +1,133 @@
+/**
+ * @file	ClockSync.hpp
+ * @author	Jeremy ROULLAND
+ * @date	23 oct. 2017
+ * @brief	Main board clock synchronization
+ */
+
+#ifndef INC_CLOCKSYNC_HPP_
+#define INC_CLOCKSYNC_HPP_
+
+#include "common.h"
+#include "Clock.hpp"
+
+/*----------------------------------------------------------------------------*/
+/* Definitions                                                                */
+/*----------------------------------------------------------------------------*/
+
+/**
+ * @brief Samples error below which the clock is locked (us), lock samples
+ */
+#define CLOCKSYNC_LOCK_US		(200)
+#define CLOCKSYNC_LOCK_SAMPLES	(4u)
+
+/**
+ * @brief Locked sample error rejected as outlier (us), rejects before resync
+ */
+#define CLOCKSYNC_OUTLIER_US	(2000)
+#define CLOCKSYNC_REJECT_MAX	(3u)
+
+/**
+ * @brief Drift estimate bound (crystals tolerance, 1000 ppm)
+ */
+#define CLOCKSYNC_DRIFT_MAX		(1.0e-3f)
+
+/*----------------------------------------------------------------------------*/
+/* Class declaration	                                                      */
+/*----------------------------------------------------------------------------*/
+
+/**
+ * @namespace Utils
+ */
+namespace Utils
+{
+	/**
+	 * @class ClockSync
+	 * @brief Main board time base estimation (offset and drift)
+	 *
+	 * HOWTO :
+	 * - On each sync message, Sample() the main board time with the local
+	 *   Clock::GetMicros() taken the closest to the reception (interrupt)
+	 * - Once IsSynchronized(), convert main board times with ToLocal() to
+	 *   schedule actions, ToMaster() to report local times
+	 *
+	 * Main board time is master = local + offset + drift * (local - ref), ref
+	 * being the last sample. Each sample error corrects offset (half) and
+	 * drift (error slope, quarter) : a second order loop that follows a
+	 * constant drift without static error, and averages the transport jitter.
+	 * A locked sample far from the estimate is rejected, several in a row mean
+	 * the main board clock restarted : estimation starts over.
+	 *
+	 * Times are 32 bits microseconds (wrap every ~71 min, differences only).
+	 * Any context, interrupts are disabled for a few cycles.
+	 */
+	class ClockSync
+	{
+	public:
+
+		/**
+		 * @brief Add a synchronization sample
+		 * @param master : Main board time (us)
+		 * @param local : Local time at reception (us)
+		 */
+		static void Sample (uint32_t master, uint32_t local);
+
+		/**
+		 * @brief Add a synchronization sample received now
+		 * @param master : Main board time (us)
+		 */
+		static void Sample (uint32_t master)
+		{
+			Sample(master, Clock::GetMicros());
+		}
+
+		/**
+		 * @brief Drop estimation (not synchronized until next samples)
+		 */
+		static void Reset ();
+
+		/**
+		 * @brief Return true once the estimation is locked
+		 */
+		static bool IsSynchronized ();
+
+		/**
+		 * @brief Convert a local time to main board time
+		 * @param local : Local time (us)
+		 */
+		static uint32_t ToMaster (uint32_t local);
+
+		/**
+		 * @brief Convert a main board time to local time
+		 * @param master : Main board time (us)
+		 */
+		static uint32_t ToLocal (uint32_t master);
+
+		/**
+		 * @brief Get current main board time (us)
+		 */
+		static uint32_t GetMaster ()
+		{
+			return ToMaster(Clock::GetMicros());
+		}
+
+		/**
+		 * @brief Get offset at last sample (master - local, us)
+		 */
+		static int32_t GetOffset ();
+
+		/**
+		 * @brief Get drift estimate (master clock faster if > 0, ppm)
+		 */
+		static float32_t GetDrift ();
+
+		/**
+		 * @brief Get last sample error (us), samples count and rejects count
+		 */
+		static int32_t GetError ();
+		static uint32_t GetSamples ();
+		static uint32_t GetRejects ();
+	};
+}
+
+#endif /* INC_CLOCKSYNC_HPP_ */
@@ -0,0 +1,116 @@
+/**
+ * @file	Coroutine.hpp
+ * @author	Jeremy ROULLAND
+ * @date	15 oct. 2026
+ * @brief	Stackless coroutines (protothreads style)
+ */
+
+#ifndef INC_COROUTINE_HPP_
+#define INC_COROUTINE_HPP_
+
+#include "common.h"
+
+// FreeRTOS
+#include "FreeRTOS.h"
+#include "task.h"
+
+/*----------------------------------------------------------------------------*/
+/* Definitions                                                                */
+/*----------------------------------------------------------------------------*/
+
+/**
+ * @brief Coroutine step result
+ */
+#define CO_RUNNING			(0)		/**< Suspended, call again */
+#define CO_DONE				(1)		/**< Finished (state is reset) */
+
+/**
+ * @brief Coroutine body macros (one CO_BEGIN / CO_END pair by function)
+ *
+ * Locals do not survive a suspension : keep the coroutine data in the
+ * object passed to the function. Do not use switch statements around a
+ * suspension point.
+ */
+#define CO_BEGIN(co)					switch((co)->line) { case 0u:
+
+#define CO_END(co)						} (co)->line = 0u; return CO_DONE
+
+#define CO_WAIT_UNTIL(co, cond)			do { (co)->line = __LINE__; case __LINE__: if(!(cond)) return CO_RUNNING; } while(0)
+
+#define CO_YIELD(co)					do { (co)->line = __LINE__; return CO_RUNNING; case __LINE__: ; } while(0)
+
+#define CO_DELAY(co, ms)				do { (co)->wake = xTaskGetTickCount() + pdMS_TO_TICKS(ms); \
+											 CO_WAIT_UNTIL(co, static_cast<int32_t>(xTaskGetTickCount() - (co)->wake) >= 0); } while(0)
+
+#define CO_AWAIT(co, handle)			CO_WAIT_UNTIL(co, (handle).Poll())
+
+#define CO_EXIT(co)						do { (co)->line = 0u; return CO_DONE; } while(0)
+
+/*----------------------------------------------------------------------------*/
+/* Class declaration	                                                      */
+/*----------------------------------------------------------------------------*/
+
+/**
+ * @namespace Utils
+ */
+namespace Utils
+{
+	/**
+	 * @class Coroutine
+	 * @brief Stackless coroutine state (resume point, wake up time : 8 bytes)
+	 *
+	 * HOWTO :
+	 * - Write the coroutine as a function returning CO_RUNNING or CO_DONE,
+	 *   its body between CO_BEGIN(co) and CO_END(co)
+	 * - Suspend with CO_YIELD, CO_WAIT_UNTIL, CO_DELAY or CO_AWAIT (an
+	 *   ActuatorHandle), the next call resumes after the suspension point
+	 * - Call it periodically from a single task until it returns CO_DONE
+	 *
+	 * Every coroutine runs on the caller stack : dozens of them cost a few
+	 * bytes each, where a task costs its stack.
+	 */
+	class Coroutine
+	{
+	public:
+
+		/**
+		 * @brief Coroutine function
+		 * @param co : Coroutine state
+		 * @param obj : Coroutine data
+		 * @return CO_RUNNING or CO_DONE
+		 */
+		typedef int8_t (*Function)(Coroutine* co, void* obj);
+
+		Coroutine() : line(0u), wake(0u)
+		{
+		}
+
+		/**
+		 * @brief Restart from the beginning at next call
+		 */
+		void Reset()
+		{
+			this->line = 0u;
+		}
+
+		/**
+		 * @brief Return true if suspended within its body
+		 */
+		bool IsStarted() const
+		{
+			return (this->line != 0u);
+		}
+
+		/**
+		 * @brief Resume point (source line), 0 : beginning
+		 */
+		uint32_t line;
+
+		/**
+		 * @brief CO_DELAY() wake up time (tick)
+		 */
+		TickType_t wake;
+	};
+}
+
+#endif /* INC_COROUTINE_HPP_ */
@@ -0,0 +1,157 @@
+/**
+ * @file	Crash.hpp
+ * @author	Jeremy ROULLAND
+ * @date	15 oct. 2026
+ * @brief	Crash recorder (fault state kept in no-init RAM across reset)
+ */
+
+#ifndef INC_CRASH_HPP_
+#define INC_CRASH_HPP_
+
+#include "common.h"
+#include "Trace.hpp"
+
+// FreeRTOS
+#include "FreeRTOS.h"
+
+/*----------------------------------------------------------------------------*/
+/* Definitions                                                                */
+/*----------------------------------------------------------------------------*/
+
+/**
+ * @brief Last trace records kept in a crash record
+ */
+#define CRASH_TRACES			(16u)
+
+/**
+ * @brief Crash record (no-init RAM, checked by a checksum)
+ */
+typedef struct
+{
+	uint32_t	MAGIC;
+	uint32_t	COUNT;						/**< Crashes since power on */
+	uint32_t	CAUSE;						/**< Utils::Crash::CAUSE */
+	uint32_t	EXCEPTION;					/**< Active exception of the crashed context (0 : task) */
+	uint32_t	TICK;						/**< OS tick count */
+	char		TASK[configMAX_TASK_NAME_LEN];	/**< Running task name ("" : interrupt or before scheduler) */
+
+	// Stacked frame (software causes : PC is the caller, ARG in R0)
+	uint32_t	R0;
+	uint32_t	R1;
+	uint32_t	R2;
+	uint32_t	R3;
+	uint32_t	R12;
+	uint32_t	LR;
+	uint32_t	PC;
+	uint32_t	PSR;
+	uint32_t	SP;							/**< Stacked frame address */
+	uint32_t	EXC_RETURN;
+
+	// System control block fault status
+	uint32_t	CFSR;
+	uint32_t	HFSR;
+	uint32_t	MMFAR;
+	uint32_t	BFAR;
+
+	uint32_t	TRACES;						/**< Trace records kept (<= CRASH_TRACES) */
+	TRACE_RECORD TRACE[CRASH_TRACES];		/**< Last trace records, oldest first */
+
+	uint32_t	CHECK;
+}CRASH_RECORD;
+
+/*----------------------------------------------------------------------------*/
+/* Class declaration	                                                      */
+/*----------------------------------------------------------------------------*/
+
+/**
+ * @namespace Utils
+ */
+namespace Utils
+{
+	/**
+	 * @class Crash
+	 * @brief Record the crash state, reset at once, report it on next boot
+	 *
+	 * HOWTO :
+	 * - Call Crash::Init() first thing in main() : takes the record left by
+	 *   the previous run (if any)
+	 * - Fault handlers call Crash::Fault() with the stacked frame, hooks
+	 *   (stack overflow, assertion) call Crash::Abort() : both never return
+	 * - Read the previous run record with Crash::GetLast() (CLI "crash")
+	 *
+	 * The record lives in the .noinit section : not cleared by the startup
+	 * code, lost on power off. Recording only reads registers and RAM (no OS
+	 * call, no lock), the reset follows : a fault costs a reboot, not the match.
+	 */
+	class Crash
+	{
+	public:
+
+		/**
+		 * @brief Crash cause list
+		 */
+		enum CAUSE
+		{
+			NONE = 0,
+			HARD_FAULT,
+			MEM_MANAGE,
+			BUS_FAULT,
+			USAGE_FAULT,
+			STACK_OVERFLOW,
+			ASSERT,
+			WATCHDOG,
+			CAUSE_MAX,
+		};
+
+		/**
+		 * @brief Take the previous run record, arm the recorder (before any fault)
+		 */
+		static void Init ();
+
+		/**
+		 * @brief Record a fault and reset (fault handlers)
+		 * @param frame : Stacked exception frame (MSP or PSP)
+		 * @param excReturn : Handler LR (EXC_RETURN)
+		 */
+		static void Fault (const uint32_t* frame, uint32_t excReturn) __attribute__((noreturn));
+
+		/**
+		 * @brief Record a software crash and reset
+		 * @param cause : STACK_OVERFLOW, ASSERT or WATCHDOG
+		 * @param task : Task name (NULL : running task)
+		 * @param arg : Cause argument (assertion line, late task age), kept in R0
+		 */
+		static void Abort (enum CAUSE cause, const char* task, uint32_t arg) __attribute__((noreturn));
+
+		/**
+		 * @brief Get previous run record
+		 * @return Record or NULL if the previous run did not crash
+		 */
+		static const CRASH_RECORD* GetLast ();
+
+		/**
+		 * @brief Forget previous run record
+		 */
+		static void Clear ();
+
+		/**
+		 * @brief Get number of crashes since power on
+		 */
+		static uint32_t GetCount ();
+
+		/**
+		 * @brief Get cause name
+		 */
+		static const char* GetCauseName (uint32_t cause);
+
+	protected:
+
+		/**
+		 * @protected
+		 * @brief Fill the record common part, seal it and reset
+		 */
+		static void record (enum CAUSE cause, const char* task) __attribute__((noreturn));
+	};
+}
+
+#endif /* INC_CRASH_HPP_ */
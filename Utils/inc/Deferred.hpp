@@ -0,0 +1,156 @@
+/**
+ * @file	Deferred.hpp
+ * @author	Jeremy ROULLAND
+ * @date	15 oct. 2026
+ * @brief	Deferred interrupt work (interrupt to worker task)
+ */
+
+#ifndef INC_DEFERRED_HPP_
+#define INC_DEFERRED_HPP_
+
+#include "common.h"
+#include "Observable.hpp"
+#include "Ring.hpp"
+
+// FreeRTOS
+#include "FreeRTOS.h"
+#include "task.h"
+
+/*----------------------------------------------------------------------------*/
+/* Definitions                                                                */
+/*----------------------------------------------------------------------------*/
+
+/**
+ * @brief Work items queued by priority (pending items, coalesced)
+ */
+#define DEFERRED_QUEUE_SIZE		(16u)
+
+/*----------------------------------------------------------------------------*/
+/* Class declaration	                                                      */
+/*----------------------------------------------------------------------------*/
+
+/**
+ * @namespace Utils
+ */
+namespace Utils
+{
+	/**
+	 * @class Deferred
+	 * @brief Work posted from interrupts, run by the worker task
+	 *
+	 * HOWTO :
+	 * - Create the worker task with Deferred::Task() as handler (highest priority)
+	 * - Declare a Deferred::Work per job (callback, instance, priority),
+	 *   Deferred::Work::Bind<Class, &Class::Method>() for a method
+	 * - Call Post() from any context : the interrupt only queues a pointer,
+	 *   the job runs in the worker task
+	 *
+	 * A job posted again before it runs is coalesced (runs once). HIGH jobs
+	 * run before LOW ones, a HIGH job posted while LOW jobs are pending runs
+	 * next. The worker is woken through a software interrupt below
+	 * configMAX_SYSCALL : interrupts above it may post too.
+	 */
+	class Deferred
+	{
+	public:
+
+		/**
+		 * @brief Job priority
+		 */
+		enum Priority
+		{
+			HIGH,
+			LOW,
+			PRIORITY_MAX
+		};
+
+		/**
+		 * @class Work
+		 * @brief Job (static object, posted by pointer)
+		 */
+		class Work
+		{
+		public:
+
+			/**
+			 * @brief Job constructor
+			 * @param cb : Job callback, called with obj in worker task
+			 * @param obj : Instance passed to the callback
+			 * @param priority : Job priority
+			 */
+			Work (Observer::ObserverCallback cb, void * obj, enum Priority priority = LOW);
+
+			/**
+			 * @brief Bind a member function : Work::Bind<Class, &Class::Method>(this, priority)
+			 */
+			template<typename T, void (T::*M)()>
+			static Work Bind (T * obj, enum Priority priority = LOW)
+			{
+				return Work(&Delegate<T, M>::Thunk, obj, priority);
+			}
+
+			/**
+			 * @brief Queue job (any context)
+			 * @return false if coalesced with a pending post or queue is full
+			 */
+			bool Post ();
+
+			/**
+			 * @brief Return true if job is queued and did not run yet
+			 */
+			bool IsPending () const
+			{
+				return (this->pending != 0u);
+			}
+
+			/**
+			 * @brief Return number of posts coalesced with a pending one
+			 */
+			uint32_t GetCoalesced () const
+			{
+				return this->coalesced;
+			}
+
+		private:
+
+			friend class Deferred;
+
+			Observer::ObserverCallback cb;
+			void * obj;
+			enum Priority priority;
+			volatile uint32_t pending;
+			volatile uint32_t coalesced;
+		};
+
+		/**
+		 * @brief Worker task handler (TaskFunction_t)
+		 */
+		static void Task (void * param);
+
+		/**
+		 * @brief Return number of jobs run
+		 */
+		static uint32_t GetExecuted ();
+
+		/**
+		 * @brief Return number of posts dropped (queue full)
+		 */
+		static uint32_t GetDropped ();
+
+		/**
+		 * @private
+		 * @brief Wake worker task up (software interrupt). DO NOT CALL !!
+		 */
+		static void INTERNAL_Wake ();
+
+	private:
+
+		/**
+		 * @private
+		 * @brief Run pending jobs, highest priority first
+		 */
+		static void run ();
+	};
+}
+
+#endif /* INC_DEFERRED_HPP_ */
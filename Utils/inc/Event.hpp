@@ -10,9 +10,6 @@
 
 #include "Observable.hpp"
 
-#include <vector>
-#include <algorithm>
-
 /*----------------------------------------------------------------------------*/
 /* Types		   		                                                      */
 /*----------------------------------------------------------------------------*/
@@ -39,15 +36,17 @@ namespace Utils
 	 * 	An object can subscribe to an event raised by another object using "+=" operator
 	 * 	and unsubscribe to it using '-=' operator.
 	 *
+	 * 	N is the maximum number of subscribers (no dynamic allocation).
 	 */
-	class Event : public Utils::Observable
+	template<size_t N = OBSERVABLE_DEFAULT_CAPACITY>
+	class Event : public Utils::Observable<N>
 	{
 	public:
 
 		/**
 		 * @brief Event constructor
 		 */
-		Event() : Observable()
+		Event() : Observable<N>()
 		{
 		}
 
@@ -60,14 +59,24 @@ namespace Utils
 		 * @param cb : Event callback
 		 * @return Event object reference
 		 */
-		Event& operator += (EventCallback cb);
+		Event& operator += (EventCallback cb)
+		{
+			this->Subscribe(NULL, cb);
+
+			return *this;
+		}
 
 		/**
 		 * @brief Remove a callback from the callback list
 		 * @param cb : Event callback
 		 * @return Event object reference
 		 */
-		Event& operator -= (EventCallback cb);
+		Event& operator -= (EventCallback cb)
+		{
+			this->Unsubscribe(NULL, cb);
+
+			return *this;
+		}
 
 		/**
 		 * @brief Raise an event
@@ -75,7 +84,6 @@ namespace Utils
 		 */
 		Event& operator () ()
 		{
-			//this->notify(*this);
 			this->notify();
 
 			return *this;
@@ -0,0 +1,110 @@
+/**
+ * @file	FastMath.hpp
+ * @author	Jeremy ROULLAND
+ * @date	15 oct. 2026
+ * @brief	Single precision math (FPU instructions, polynomials)
+ */
+
+#ifndef INC_FASTMATH_HPP_
+#define INC_FASTMATH_HPP_
+
+#include "common.h"
+#include "stm32f4xx.h"
+
+#include <math.h>
+
+/*----------------------------------------------------------------------------*/
+/* Definitions                                                                */
+/*----------------------------------------------------------------------------*/
+
+#define FASTMATH_PI			(3.14159265358979323846f)
+#define FASTMATH_2_PI		(6.28318530717958647692f)
+#define FASTMATH_PI_2		(1.57079632679489661923f)
+#define FASTMATH_SQRT3		(1.73205080756887729353f)
+
+/*----------------------------------------------------------------------------*/
+/* Functions declaration                                                      */
+/*----------------------------------------------------------------------------*/
+
+/**
+ * @namespace Utils
+ */
+namespace Utils
+{
+	/**
+	 * @brief Square root, single VSQRT instruction (no errno path)
+	 * @param x : Value (>= 0, negative returns NaN)
+	 */
+	static inline float32_t Sqrt (float32_t x)
+	{
+#if defined(__FPU_USED) && (__FPU_USED == 1U)
+		float32_t r;
+		__ASM volatile ("vsqrt.f32 %0, %1" : "=t" (r) : "t" (x));
+		return r;
+#else
+		return sqrtf(x);
+#endif
+	}
+
+	/**
+	 * @brief Absolute value, single VABS instruction
+	 */
+	static inline float32_t Abs (float32_t x)
+	{
+		return fabsf(x);
+	}
+
+	/**
+	 * @brief Wrap an angle in [-PI; PI] without loop
+	 * @param angle : Angle in radians (|angle| < 1e9)
+	 */
+	static inline float32_t WrapPi (float32_t angle)
+	{
+		float32_t turns = angle * (1.0f / FASTMATH_2_PI);
+
+		// Round to nearest turn, float to integer is a single VCVT
+		turns = static_cast<float32_t>(static_cast<int32_t>(turns + ((turns >= 0.0f) ? 0.5f : -0.5f)));
+
+		return angle - turns * FASTMATH_2_PI;
+	}
+
+	/**
+	 * @brief Sine and cosine of an angle
+	 * @param angle : Angle in radians (|angle| < 1e5 for full precision)
+	 * @param sin : Sine
+	 * @param cos : Cosine
+	 *
+	 * Reduced to [-PI/4; PI/4], degree 7 (sine) and 8 (cosine) polynomials,
+	 * maximum error is about 1e-7.
+	 */
+	void SinCos (float32_t angle, float32_t * sin, float32_t * cos);
+
+	/**
+	 * @brief Sine of an angle (see SinCos())
+	 */
+	float32_t Sin (float32_t angle);
+
+	/**
+	 * @brief Cosine of an angle (see SinCos())
+	 */
+	float32_t Cos (float32_t angle);
+
+	/**
+	 * @brief Tangent of an angle (see SinCos(), one divide)
+	 * @param angle : Angle in radians, away from PI/2 + k.PI
+	 *
+	 * Relative error is about 2e-7 on [-PI/2 + 1e-3; PI/2 - 1e-3].
+	 */
+	float32_t Tan (float32_t angle);
+
+	/**
+	 * @brief Angle of vector (x, y)
+	 * @return Angle in [-PI; PI], 0 if x and y are 0
+	 *
+	 * Reduced to [0; tan(PI/8)], degree 9 polynomial, maximum error is
+	 * about 3e-7.
+	 */
+	float32_t Atan2 (float32_t y, float32_t x);
+}
+
+#endif /* INC_FASTMATH_HPP_ */
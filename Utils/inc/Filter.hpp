@@ -0,0 +1,226 @@
+/**
+ * @file	Filter.hpp
+ * @author	Jeremy ROULLAND
+ * @date	14 oct. 2026
+ * @brief	Streaming filters (moving average, median, hysteresis)
+ */
+
+#ifndef INC_FILTER_HPP_
+#define INC_FILTER_HPP_
+
+#include "common.h"
+
+#include <stddef.h>
+
+/*----------------------------------------------------------------------------*/
+/* Class declaration	                                                      */
+/*----------------------------------------------------------------------------*/
+
+/**
+ * @namespace Utils
+ */
+namespace Utils
+{
+	/**
+	 * @class MovingAverage
+	 * @brief Mean of the N last samples, running sum (O(1) per sample)
+	 *
+	 * HOWTO :
+	 * - Push each new sample with Put(), it returns the filtered value
+	 * - Read last filtered value with Get()
+	 */
+	template<size_t N>
+	class MovingAverage
+	{
+	public:
+
+		MovingAverage ()
+		{
+			this->Reset(0u);
+		}
+
+		/**
+		 * @brief Fill window with a value
+		 */
+		void Reset (uint16_t value)
+		{
+			for(size_t i = 0u; i < N; i++)
+				this->samples[i] = value;
+
+			this->sum = static_cast<uint32_t>(value) * N;
+			this->index = 0u;
+		}
+
+		/**
+		 * @brief Push a sample
+		 * @return mean of the window
+		 */
+		uint16_t Put (uint16_t sample)
+		{
+			this->sum -= this->samples[this->index];
+			this->sum += sample;
+			this->samples[this->index] = sample;
+
+			this->index++;
+			if(this->index >= N)
+				this->index = 0u;
+
+			return this->Get();
+		}
+
+		/**
+		 * @brief Return mean of the window
+		 */
+		uint16_t Get ()
+		{
+			return static_cast<uint16_t>(this->sum / N);
+		}
+
+	private:
+
+		uint16_t samples[N];
+		uint32_t sum;
+		size_t   index;
+	};
+
+	/**
+	 * @class MedianFilter
+	 * @brief Median of the N last samples (N odd)
+	 *
+	 * A sorted copy of the window is kept : each sample removes the oldest
+	 * value and inserts the new one in place (O(N), no sort).
+	 *
+	 * HOWTO :
+	 * - Push each new sample with Put(), it returns the filtered value
+	 * - Read last filtered value with Get()
+	 */
+	template<size_t N>
+	class MedianFilter
+	{
+		static_assert((N % 2u) == 1u, "MedianFilter size must be odd");
+
+	public:
+
+		MedianFilter ()
+		{
+			this->Reset(0u);
+		}
+
+		/**
+		 * @brief Fill window with a value
+		 */
+		void Reset (uint16_t value)
+		{
+			for(size_t i = 0u; i < N; i++)
+			{
+				this->samples[i] = value;
+				this->sorted[i] = value;
+			}
+
+			this->index = 0u;
+		}
+
+		/**
+		 * @brief Push a sample
+		 * @return median of the window
+		 */
+		uint16_t Put (uint16_t sample)
+		{
+			uint16_t oldest = this->samples[this->index];
+			size_t i = 0u;
+
+			this->samples[this->index] = sample;
+
+			this->index++;
+			if(this->index >= N)
+				this->index = 0u;
+
+			// Remove oldest value from sorted window
+			while(this->sorted[i] != oldest)
+				i++;
+			for(; i < (N - 1u); i++)
+				this->sorted[i] = this->sorted[i + 1u];
+
+			// Insert new sample
+			i = N - 1u;
+			while((i > 0u) && (this->sorted[i - 1u] > sample))
+			{
+				this->sorted[i] = this->sorted[i - 1u];
+				i--;
+			}
+			this->sorted[i] = sample;
+
+			return this->Get();
+		}
+
+		/**
+		 * @brief Return median of the window
+		 */
+		uint16_t Get ()
+		{
+			return this->sorted[N / 2u];
+		}
+
+	private:
+
+		uint16_t samples[N];
+		uint16_t sorted[N];
+		size_t   index;
+	};
+
+	/**
+	 * @class Hysteresis
+	 * @brief Two thresholds comparator
+	 *
+	 * State is set above high threshold and cleared below low threshold.
+	 */
+	class Hysteresis
+	{
+	public:
+
+		Hysteresis (uint16_t low = 0u, uint16_t high = 0u)
+		{
+			this->SetThresholds(low, high);
+			this->state = false;
+		}
+
+		/**
+		 * @brief Set thresholds (low <= high)
+		 */
+		void SetThresholds (uint16_t low, uint16_t high)
+		{
+			this->low = low;
+			this->high = high;
+		}
+
+		/**
+		 * @brief Push a sample
+		 * @return state
+		 */
+		bool Put (uint16_t sample)
+		{
+			if(sample > this->high)
+				this->state = true;
+			else if(sample < this->low)
+				this->state = false;
+
+			return this->state;
+		}
+
+		/**
+		 * @brief Return state
+		 */
+		bool Get ()
+		{
+			return this->state;
+		}
+
+	private:
+
+		uint16_t low;
+		uint16_t high;
+		bool     state;
+	};
+}
+
+#endif /* INC_FILTER_HPP_ */
@@ -0,0 +1,43 @@
+/**
+ * @file	FixedTrigo.hpp
+ * @author	Jeremy ROULLAND
+ * @date	14 oct. 2017
+ * @brief	Fixed-point trigonometry (lookup table)
+ */
+
+#ifndef INC_FIXEDTRIGO_HPP_
+#define INC_FIXEDTRIGO_HPP_
+
+#include "common.h"
+
+/*----------------------------------------------------------------------------*/
+/* Definitions                                                                */
+/*----------------------------------------------------------------------------*/
+
+/**
+ * @brief Q30 fixed-point one
+ */
+#define FIXED_Q30_ONE		(1073741824)
+
+/*----------------------------------------------------------------------------*/
+/* Functions declaration                                                      */
+/*----------------------------------------------------------------------------*/
+
+/**
+ * @namespace Utils
+ */
+namespace Utils
+{
+	/**
+	 * @brief Compute sine and cosine of a binary angle
+	 * @param angle : Binary angle (2^32 is a full turn)
+	 * @param sin : Sine in Q30
+	 * @param cos : Cosine in Q30
+	 *
+	 * Quarter wave table (256 intervals) with linear interpolation,
+	 * maximum error is about 5e-6.
+	 */
+	void SinCosQ30 (uint32_t angle, int32_t * sin, int32_t * cos);
+}
+
+#endif /* INC_FIXEDTRIGO_HPP_ */
@@ -0,0 +1,64 @@
+/**
+ * @file	Format.hpp
+ * @author	Jeremy ROULLAND
+ * @date	22 oct. 2017
+ * @brief	Minimal printf-like formatter (no float library)
+ */
+
+#ifndef INC_FORMAT_HPP_
+#define INC_FORMAT_HPP_
+
+#include "common.h"
+
+#include <stdarg.h>
+
+/*----------------------------------------------------------------------------*/
+/* Definitions                                                                */
+/*----------------------------------------------------------------------------*/
+
+/**
+ * @brief Print() line buffer (on caller stack), longer output is truncated
+ */
+#define FORMAT_PRINT_SIZE		(128u)
+
+/**
+ * @brief Largest %f precision
+ */
+#define FORMAT_MAX_DECIMALS		(6u)
+
+/*----------------------------------------------------------------------------*/
+/* Functions declaration                                                      */
+/*----------------------------------------------------------------------------*/
+
+/**
+ * @namespace Utils
+ */
+namespace Utils
+{
+	/**
+	 * @brief Format a string
+	 *
+	 * Conversions : d i u x X c s p %, flags '-' and '0', width, 'l' length
+	 * (ignored). %.Nf prints fixed point decimals from the float value with
+	 * integer arithmetic (N <= FORMAT_MAX_DECIMALS, default 6, |value| < 2^32).
+	 *
+	 * @param buffer : Destination, always NULL terminated
+	 * @param size : Destination size
+	 * @param fmt : Format string
+	 * @param args : Arguments
+	 * @return Formatted length (truncated to size - 1)
+	 */
+	uint32_t FormatV (char * buffer, uint32_t size, const char * fmt, va_list args);
+
+	/**
+	 * @brief Format a string, see FormatV()
+	 */
+	uint32_t Format (char * buffer, uint32_t size, const char * fmt, ...) __attribute__((format(printf, 3, 4)));
+
+	/**
+	 * @brief Format and write to stdout, see FormatV()
+	 */
+	void Print (const char * fmt, ...) __attribute__((format(printf, 1, 2)));
+}
+
+#endif /* INC_FORMAT_HPP_ */
@@ -0,0 +1,74 @@
+/**
+ * @file	Frame.hpp
+ * @author	Jeremy ROULLAND
+ * @date	14 oct. 2017
+ * @brief	Binary frame helpers (CRC, COBS)
+ */
+
+#ifndef INC_FRAME_HPP_
+#define INC_FRAME_HPP_
+
+#include "common.h"
+
+/*----------------------------------------------------------------------------*/
+/* Definitions                                                                */
+/*----------------------------------------------------------------------------*/
+
+/**
+ * @brief CRC16 CCITT initial value
+ */
+#define FRAME_CRC16_INIT		(0xFFFFu)
+
+/**
+ * @brief CRC8 SMBus initial value
+ */
+#define FRAME_CRC8_INIT			(0x00u)
+
+/**
+ * @brief COBS frame delimiter
+ */
+#define FRAME_DELIMITER			(0x00u)
+
+/**
+ * @brief Worst case COBS encoded size (delimiter included)
+ */
+#define FRAME_COBS_SIZE(len)	((len) + ((len) / 254u) + 2u)
+
+/*----------------------------------------------------------------------------*/
+/* Functions declaration                                                      */
+/*----------------------------------------------------------------------------*/
+
+/**
+ * @namespace Utils
+ */
+namespace Utils
+{
+	/**
+	 * @brief Compute CRC16 CCITT (poly 0x1021)
+	 * @param buffer : Data
+	 * @param length : Data length
+	 * @param crc : Initial value (or previous CRC to chain blocks)
+	 * @return CRC16
+	 */
+	uint16_t Crc16 (const uint8_t * buffer, uint32_t length, uint16_t crc = FRAME_CRC16_INIT);
+
+	/**
+	 * @brief Compute CRC8 SMBus PEC (poly 0x07)
+	 * @param buffer : Data
+	 * @param length : Data length
+	 * @param crc : Initial value (or previous CRC to chain blocks)
+	 * @return CRC8
+	 */
+	uint8_t Crc8 (const uint8_t * buffer, uint32_t length, uint8_t crc = FRAME_CRC8_INIT);
+
+	/**
+	 * @brief Encode a buffer with COBS and append the frame delimiter
+	 * @param in : Raw data
+	 * @param length : Raw data length
+	 * @param out : Encoded data, at least FRAME_COBS_SIZE(length) bytes
+	 * @return Encoded length (delimiter included)
+	 */
+	uint32_t CobsEncode (const uint8_t * in, uint32_t length, uint8_t * out);
+}
+
+#endif /* INC_FRAME_HPP_ */
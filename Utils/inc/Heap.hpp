@@ -0,0 +1,100 @@
+/**
+ * @file	Heap.hpp
+ * @author	Jeremy ROULLAND
+ * @date	15 oct. 2026
+ * @brief	Single allocator route (new, malloc, kernel) with per-module statistics
+ */
+
+#ifndef INC_HEAP_HPP_
+#define INC_HEAP_HPP_
+
+#include "common.h"
+
+#include <stddef.h>
+
+/*----------------------------------------------------------------------------*/
+/* Definitions                                                                */
+/*----------------------------------------------------------------------------*/
+
+/**
+ * @brief Modules with their own statistics (others are counted as "other")
+ */
+#define HEAP_TAGS_MAX			(16u)
+
+/*----------------------------------------------------------------------------*/
+/* Class declaration	                                                      */
+/*----------------------------------------------------------------------------*/
+
+/**
+ * @namespace Utils
+ */
+namespace Utils
+{
+	/**
+	 * @class Heap
+	 * @brief Every dynamic allocation goes to the OS heap (heap_4)
+	 *
+	 * HOWTO :
+	 * - Nothing to call : operator new / delete and newlib malloc family are
+	 *   routed here, newlib own heap (_sbrk) is never grown
+	 * - SetTag() names the allocating module (boot stage), otherwise the
+	 *   running task name is the tag
+	 * - Count() / Get() list statistics (console "mem")
+	 *
+	 * Each block has an 8 bytes header (size and tag) : frees are counted
+	 * against the allocating module and realloc() knows the old size.
+	 * Not callable from interrupts (as pvPortMalloc()).
+	 */
+	class Heap
+	{
+	public:
+
+		/**
+		 * @brief Module statistics
+		 */
+		typedef struct
+		{
+			const char*	name;
+			uint32_t	allocs;		/**< Allocations */
+			uint32_t	frees;		/**< Frees */
+			uint32_t	used;		/**< Bytes in use (headers excluded) */
+			uint32_t	peak;		/**< Highest bytes in use */
+		}STATS;
+
+		/**
+		 * @brief Allocate a block
+		 * @param size : Bytes
+		 * @return Block or NULL (malloc failed hook called by the OS)
+		 */
+		static void* Alloc (size_t size);
+
+		/**
+		 * @brief Free a block from Alloc(), NULL is ignored
+		 */
+		static void Free (void* block);
+
+		/**
+		 * @brief Resize a block (content kept up to the smallest size)
+		 */
+		static void* Realloc (void* block, size_t size);
+
+		/**
+		 * @brief Name following allocations (static string), NULL : running task
+		 */
+		static void SetTag (const char* name);
+
+		/**
+		 * @brief Return number of modules seen
+		 */
+		static uint32_t Count ();
+
+		/**
+		 * @brief Return module statistics
+		 * @param index : Module index (< Count())
+		 * @return Statistics or NULL
+		 */
+		static const STATS* Get (uint32_t index);
+	};
+}
+
+#endif /* INC_HEAP_HPP_ */
@@ -0,0 +1,148 @@
+/**
+ * @file	Log.hpp
+ * @author	Jeremy ROULLAND
+ * @date	22 oct. 2017
+ * @brief	Deferred formatting logger (tokenized format strings)
+ */
+
+#ifndef INC_LOG_HPP_
+#define INC_LOG_HPP_
+
+#include "common.h"
+#include "stm32f4xx.h"
+
+/*----------------------------------------------------------------------------*/
+/* Definitions                                                                */
+/*----------------------------------------------------------------------------*/
+
+/**
+ * @brief Ring buffer size (32-bit words, power of 2)
+ */
+#define LOG_BUFFER_WORDS		(256u)
+
+/**
+ * @brief Maximum number of arguments of one record
+ */
+#define LOG_MAX_ARGS			(8u)
+
+/**
+ * @brief Record header : token (format string offset in .logstr) and arguments count
+ */
+#define LOG_HEADER(token, n)	(((uint32_t)(token) & 0xFFFFu) | ((uint32_t)(n) << 16))
+#define LOG_HEADER_TOKEN(h)		((h) & 0xFFFFu)
+#define LOG_HEADER_ARGS(h)		(((h) >> 16) & 0xFFu)
+
+/**
+ * @brief Record length (words) : header, timestamp and arguments
+ */
+#define LOG_RECORD_WORDS(n)		(2u + (n))
+
+/**
+ * @brief Log a message, formatted on the host
+ *
+ * The format string goes to the .logstr section (not loaded, see
+ * LinkerScript.ld) : its address is the token. Only the token, the DWT cycle
+ * counter and the raw arguments (32 bits each, float as IEEE754 single,
+ * strings not supported) are written in the ring buffer.
+ */
+#define LOG(fmt, ...)																	\
+	do																					\
+	{																					\
+		static const char _logFmt[] __attribute__((section(".logstr"), used)) = fmt;	\
+		Utils::Log::Write(_logFmt, ##__VA_ARGS__);										\
+	} while(0)
+
+/*----------------------------------------------------------------------------*/
+/* Class declaration	                                                      */
+/*----------------------------------------------------------------------------*/
+
+/**
+ * @namespace Utils
+ */
+namespace Utils
+{
+	/**
+	 * @class Log
+	 * @brief Deferred formatting logger
+	 *
+	 * HOWTO :
+	 * - Log with LOG("x=%f n=%d\r\n", x, n) from any task or interrupt
+	 * - Diag drains the buffer with Log::Read() and sends the records
+	 * - The host decoder reads the format strings from the .logstr section of
+	 *   the ELF file and formats the arguments
+	 *
+	 * Records are written whole or dropped (GetLost()) when the buffer is full.
+	 */
+	class Log
+	{
+	public:
+
+		/**
+		 * @brief Write a record (use LOG())
+		 * @param fmt : Format string in .logstr
+		 * @param args : Arguments (integers, pointers or floats)
+		 */
+		template<typename... Args>
+		static inline void Write (const char* fmt, Args... args)
+		{
+			const uint32_t words[sizeof...(Args) + 1u] = {toWord(args)..., 0u};
+
+			static_assert(sizeof...(Args) <= LOG_MAX_ARGS, "Too many log arguments");
+
+			write(LOG_HEADER((uint32_t)fmt, sizeof...(Args)), words, sizeof...(Args));
+		}
+
+		/**
+		 * @brief Read whole records, oldest first (one reader)
+		 * @param words : Destination buffer
+		 * @param max : Destination size (words)
+		 * @return Words read
+		 */
+		static uint32_t Read (uint32_t* words, uint32_t max);
+
+		/**
+		 * @brief Return number of records dropped (buffer full)
+		 */
+		static uint32_t GetLost ();
+
+	protected:
+
+		/**
+		 * @protected
+		 * @brief Convert an argument to a raw word
+		 */
+		static inline uint32_t toWord (float32_t value)
+		{
+			union
+			{
+				float32_t f;
+				uint32_t u;
+			}w;
+
+			w.f = value;
+			return w.u;
+		}
+
+		static inline uint32_t toWord (double value)
+		{
+			return toWord((float32_t)value);
+		}
+
+		template<typename T>
+		static inline uint32_t toWord (T value)
+		{
+			return (uint32_t)value;
+		}
+
+		/**
+		 * @protected
+		 * @brief Write a record in the ring buffer
+		 * @param header : Record header
+		 * @param args : Arguments words
+		 * @param n : Arguments count
+		 */
+		static void write (uint32_t header, const uint32_t* args, uint32_t n);
+	};
+}
+
+#endif /* INC_LOG_HPP_ */
@@ -8,13 +8,19 @@
 #ifndef INC_OBSERVABLE_HPP_
 #define INC_OBSERVABLE_HPP_
 
-#include <vector>
-#include <algorithm>
+#include "StaticVector.hpp"
+
+#include <stddef.h>
 
 /*----------------------------------------------------------------------------*/
 /* Definitions                                                                */
 /*----------------------------------------------------------------------------*/
 
+/**
+ * @brief Default observers capacity of an observable
+ */
+#define OBSERVABLE_DEFAULT_CAPACITY		(2u)
+
 typedef struct
 {
 	/**
@@ -27,6 +33,11 @@ typedef struct
 	 * @brief Observer instance
 	 */
 	void * obj;
+
+	/**
+	 * @brief Observer callback
+	 */
+	ObserverCallback cb;
 }Observer;
 
 /*----------------------------------------------------------------------------*/
@@ -38,6 +49,23 @@ typedef struct
  */
 namespace Utils
 {
+	/**
+	 * @class Delegate
+	 * @brief Member function M of T as an observer callback
+	 *
+	 * Thunk() is generated for each (T, M) pair and calls M directly on the
+	 * instance given on subscription : no file-static trampoline, no storage
+	 * beyond the observer entry (instance, callback).
+	 */
+	template<typename T, void (T::*M)()>
+	struct Delegate
+	{
+		static void Thunk (void * obj)
+		{
+			(static_cast<T*>(obj)->*M)();
+		}
+	};
+
 	/**
 	 * @class Observable
 	 * @brief Abstract Observable class can be used to notify objects called "obervers"
@@ -46,7 +74,12 @@ namespace Utils
 	 * To be notified, an "observer" has to register itself by calling Subscribe() method
 	 * passing as argument a callback which will be called when the observable notify its obersvers.
 	 * Unsubscription can be achieved by calling Unsubscribe() method.
+	 * A method is subscribed with Subscribe<Class, &Class::Method>(instance).
+	 *
+	 * Observers are stored in a fixed table of N entries : subscription never
+	 * allocates and notification is a flat loop (interrupt context safe).
 	 */
+	template<size_t N>
 	class Observable
 	{
 	public:
@@ -54,48 +87,110 @@ namespace Utils
 		/**
 		 * @brief Default constructor;
 		 */
-		Observable();
+		Observable()
+		{
+		}
 
 		/**
 		 * @brief Subscribe to observable notifications
+		 * @param observer : Instance passed to the callback
 		 * @param cb : Callback to call on observable notifications
+		 * @return false if the observers table is full
 		 */
-		void Subscribe (void * observer, Observer::ObserverCallback cb);
+		bool Subscribe (void * observer, Observer::ObserverCallback cb)
+		{
+			Observer entry;
+
+			entry.obj = observer;
+			entry.cb  = cb;
+
+			// Entry is complete before being visible to notify()
+			return this->observers.push_back(entry);
+		}
 
 		/**
 		 * @brief Unsubscribe to observable notifications
+		 * @param observer : Instance given on subscription
 		 * @param cb : Callback which where called on observable notifications
 		 */
-		void Unsubscribe (void * observer, Observer::ObserverCallback cb);
+		void Unsubscribe (void * observer, Observer::ObserverCallback cb)
+		{
+			for(Observer* it = this->observers.begin(); it != this->observers.end(); it++)
+			{
+				if((it->obj == observer) && (it->cb == cb))
+				{
+					this->observers.erase(it);
+					break;
+				}
+			}
+		}
 
-	protected:
+		/**
+		 * @brief Subscribe a member function to observable notifications
+		 * @param observer : Instance the method is called on
+		 * @return false if the observers table is full
+		 */
+		template<typename T, void (T::*M)()>
+		bool Subscribe (T * observer)
+		{
+			return this->Subscribe(observer, &Delegate<T, M>::Thunk);
+		}
 
 		/**
-		 * @pure
-		 * @brief Virtual pure destructor
+		 * @brief Unsubscribe a member function from observable notifications
+		 * @param observer : Instance given on subscription
 		 */
-		virtual ~Observable() = 0;
+		template<typename T, void (T::*M)()>
+		void Unsubscribe (T * observer)
+		{
+			this->Unsubscribe(observer, &Delegate<T, M>::Thunk);
+		}
 
 		/**
-		 * @brief Notification method - Used by child class
-		 * @param observable
-		 * @param obj
+		 * @brief Return number of subscribed observers
 		 */
-		//void notify (Observable& observable);
-		void notify ();
-	private:
+		size_t Count () const
+		{
+			return this->observers.size();
+		}
 
 		/**
-		 * @private
-		 * @brief Observer callback list used by notifications
+		 * @brief Return observers capacity
 		 */
-		std::vector<Observer::ObserverCallback> observerCallbackList;
+		static constexpr size_t Capacity ()
+		{
+			return N;
+		}
+
+	protected:
+
+		/**
+		 * @brief Protected destructor (abstract class)
+		 */
+		~Observable()
+		{
+		}
+
+		/**
+		 * @brief Notification method - Used by child class
+		 */
+		void notify ()
+		{
+			size_t n = this->observers.size();
+
+			for(size_t i=0; i<n; i++)
+			{
+				this->observers[i].cb(this->observers[i].obj);
+			}
+		}
+
+	private:
 
 		/**
 		 * @private
-		 * @brief Observer instance lsit used by notifications
+		 * @brief Observers table used by notifications
 		 */
-		std::vector<void*> observerInstanceList;
+		StaticVector<Observer, N> observers;
 	};
 }
 
@@ -10,10 +10,24 @@
 
 #include "common.h"
 
+#include <float.h>
+#include <stddef.h>
+
 /*----------------------------------------------------------------------------*/
 /* Definitions                                                                */
 /*----------------------------------------------------------------------------*/
 
+/**
+ * @brief Gain schedule entry (gains used at velocity, interpolated between entries)
+ */
+typedef struct
+{
+	float32_t	velocity;
+	float32_t	kp;
+	float32_t	ki;
+	float32_t	kd;
+}PID_GAINS;
+
 /*----------------------------------------------------------------------------*/
 /* Class declaration	                                                      */
 /*----------------------------------------------------------------------------*/
@@ -32,6 +46,8 @@ namespace Utils
 	 * - Call Reset() to reset errors
 	 * - Call SetSetpoint() to set controller setpoint
 	 * - Call Get() to get the new output from a feedback value
+	 * - Optionally call SetOutputLimits() (output saturation and integral anti-windup),
+	 *   SetDerivativeFilter() and SetSchedule() / Schedule() (velocity gain scheduling)
 	 */
 	class PID
 	{
@@ -70,6 +86,7 @@ namespace Utils
 		void SetKi(float32_t ki)
 		{
 			this->ki = ki;
+			this->kiDt = ki * this->dt;
 		}
 
 		/**
@@ -78,8 +95,41 @@ namespace Utils
 		void SetKd(float32_t kd)
 		{
 			this->kd = kd;
+			this->kdDt = kd / this->dt;
+		}
+
+		/**
+		 * @brief Set output saturation (integral term is clamped to it too)
+		 */
+		void SetOutputLimits(float32_t min, float32_t max)
+		{
+			this->outMin = min;
+			this->outMax = max;
+		}
+
+		/**
+		 * @brief Set derivative first order filter time constant in seconds (0 : no filter)
+		 */
+		void SetDerivativeFilter(float32_t tf)
+		{
+			this->alpha = this->dt / (tf + this->dt);
+			this->tf = tf;
 		}
 
+		/**
+		 * @brief Set gain schedule table (sorted by increasing velocity, kept by reference)
+		 */
+		void SetSchedule(const PID_GAINS * table, uint32_t n)
+		{
+			this->schedule = table;
+			this->scheduleSize = n;
+		}
+
+		/**
+		 * @brief Update gains from schedule table at velocity
+		 */
+		void Schedule(float32_t velocity);
+
 		/**
 		 * @brief Get kp term
 		 */
@@ -167,6 +217,40 @@ namespace Utils
 		 */
 		float32_t dt;
 
+		/**
+		 * @private
+		 * @brief Precomputed ki * dt and kd / dt
+		 */
+		float32_t kiDt;
+		float32_t kdDt;
+
+		/**
+		 * @private
+		 * @brief Output saturation
+		 */
+		float32_t outMin;
+		float32_t outMax;
+
+		/**
+		 * @private
+		 * @brief Derivative filter time constant and coefficient
+		 */
+		float32_t tf;
+		float32_t alpha;
+
+		/**
+		 * @private
+		 * @brief Gain schedule table
+		 */
+		const PID_GAINS * schedule;
+		uint32_t scheduleSize;
+
+		/**
+		 * @private
+		 * @brief Set loop period (precomputed terms)
+		 */
+		void setPeriod(float32_t dt);
+
 		/**
 		 * @private
 		 * @brief Current error
@@ -175,13 +259,13 @@ namespace Utils
 
 		/**
 		 * @private
-		 * @brief Integral error
+		 * @brief Integral term (ki * dt * error sum)
 		 */
 		float32_t intErr;
 
 		/**
 		 * @private
-		 * @brief Differential error
+		 * @brief Differential error (filtered)
 		 */
 		float32_t diffErr;
 
@@ -0,0 +1,202 @@
+/**
+ * @file	PIDBank.hpp
+ * @author	Jeremy ROULLAND
+ * @date	14 oct. 2026
+ * @brief	Bank of N PID controllers updated in one call
+ */
+
+#ifndef INC_PIDBANK_HPP_
+#define INC_PIDBANK_HPP_
+
+#include "common.h"
+
+#include <float.h>
+#include <stddef.h>
+
+/*----------------------------------------------------------------------------*/
+/* Class declaration	                                                      */
+/*----------------------------------------------------------------------------*/
+
+/**
+ * @namespace Utils
+ */
+namespace Utils
+{
+	/**
+	 * @class PIDBank
+	 * @brief N channels PID controller, struct of arrays
+	 *
+	 * Same law as PID (output saturation, integral anti-windup, filtered
+	 * derivative) with every channel state stored in contiguous arrays, so
+	 * Update() is a single branch free loop over the channels.
+	 *
+	 * HOWTO :
+	 * - Create a new bank with PIDBank<N>(dt), all channels are zero gain
+	 * - Configure channels with SetGains(), SetOutputLimits(), SetDerivativeFilter()
+	 * - Set setpoints with SetSetpoint() or SetSetpoints()
+	 * - Call Update() with N feedback values to get the N outputs
+	 */
+	template<size_t N>
+	class PIDBank
+	{
+	public:
+
+		/**
+		 * @brief Build bank with loop period in seconds
+		 */
+		PIDBank (float32_t dt = 1.0f)
+		{
+			this->dt = dt;
+
+			for(size_t i = 0u; i < N; i++)
+			{
+				this->kp[i]			=	0.0f;
+				this->kiDt[i]		=	0.0f;
+				this->kdDt[i]		=	0.0f;
+				this->alpha[i]		=	1.0f;
+				this->outMin[i]		=	-FLT_MAX;
+				this->outMax[i]		=	FLT_MAX;
+				this->setpoint[i]	=	0.0f;
+				this->output[i]		=	0.0f;
+			}
+
+			this->Reset();
+		}
+
+		/**
+		 * @brief Set channel gains
+		 */
+		void SetGains (size_t i, float32_t kp, float32_t ki, float32_t kd)
+		{
+			this->kp[i]		=	kp;
+			this->kiDt[i]	=	ki * this->dt;
+			this->kdDt[i]	=	kd / this->dt;
+		}
+
+		/**
+		 * @brief Set channel output saturation (integral term is clamped to it too)
+		 */
+		void SetOutputLimits (size_t i, float32_t min, float32_t max)
+		{
+			this->outMin[i] = min;
+			this->outMax[i] = max;
+		}
+
+		/**
+		 * @brief Set channel derivative filter time constant in seconds (0 : no filter)
+		 */
+		void SetDerivativeFilter (size_t i, float32_t tf)
+		{
+			this->alpha[i] = this->dt / (tf + this->dt);
+		}
+
+		/**
+		 * @brief Set channel setpoint
+		 */
+		void SetSetpoint (size_t i, float32_t setpoint)
+		{
+			this->setpoint[i] = setpoint;
+		}
+
+		/**
+		 * @brief Set all setpoints
+		 */
+		void SetSetpoints (const float32_t setpoint[N])
+		{
+			for(size_t i = 0u; i < N; i++)
+				this->setpoint[i] = setpoint[i];
+		}
+
+		/**
+		 * @brief Clear all channels state
+		 */
+		void Reset ()
+		{
+			for(size_t i = 0u; i < N; i++)
+			{
+				this->err[i]		=	0.0f;
+				this->intErr[i]		=	0.0f;
+				this->diffErr[i]	=	0.0f;
+			}
+		}
+
+		/**
+		 * @brief Update all channels
+		 * @param feedback : N feedback values
+		 * @return N outputs (valid until next Update)
+		 */
+		const float32_t* Update (const float32_t feedback[N])
+		{
+			for(size_t i = 0u; i < N; i++)
+			{
+				float32_t err = this->setpoint[i] - feedback[i];
+				float32_t intErr = 0.0f;
+				float32_t u = 0.0f;
+				float32_t y = 0.0f;
+
+				this->diffErr[i] += this->alpha[i] * ((err - this->err[i]) - this->diffErr[i]);
+				this->err[i] = err;
+
+				intErr = this->intErr[i] + this->kiDt[i] * err;
+				intErr = (intErr > this->outMax[i]) ? this->outMax[i] : intErr;
+				intErr = (intErr < this->outMin[i]) ? this->outMin[i] : intErr;
+
+				u = (this->kp[i] * err) + intErr + (this->kdDt[i] * this->diffErr[i]);
+				y = (u > this->outMax[i]) ? this->outMax[i] : u;
+				y = (y < this->outMin[i]) ? this->outMin[i] : y;
+
+				// Anti-windup : keep integral unless saturated on the error side
+				this->intErr[i] = (((u <= this->outMax[i]) || (err < 0.0f)) &&
+				                   ((u >= this->outMin[i]) || (err > 0.0f))) ? intErr : this->intErr[i];
+
+				this->output[i] = y;
+			}
+
+			return this->output;
+		}
+
+		/**
+		 * @brief Get channel last output
+		 */
+		float32_t GetOutput (size_t i) const
+		{
+			return this->output[i];
+		}
+
+	private:
+
+		/**
+		 * @private
+		 * @brief Loop period in seconds
+		 */
+		float32_t dt;
+
+		/**
+		 * @private
+		 * @brief Channels gains (kp, ki * dt, kd / dt) and derivative filter coefficient
+		 */
+		float32_t kp[N];
+		float32_t kiDt[N];
+		float32_t kdDt[N];
+		float32_t alpha[N];
+
+		/**
+		 * @private
+		 * @brief Channels output saturation
+		 */
+		float32_t outMin[N];
+		float32_t outMax[N];
+
+		/**
+		 * @private
+		 * @brief Channels state
+		 */
+		float32_t setpoint[N];
+		float32_t err[N];
+		float32_t intErr[N];
+		float32_t diffErr[N];
+		float32_t output[N];
+	};
+}
+
+#endif /* INC_PIDBANK_HPP_ */
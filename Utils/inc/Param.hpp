@@ -0,0 +1,120 @@
+/**
+ * @file	Param.hpp
+ * @author	Jeremy ROULLAND
+ * @date	22 oct. 2017
+ * @brief	Runtime parameters registry
+ */
+
+#ifndef INC_PARAM_HPP_
+#define INC_PARAM_HPP_
+
+#include "common.h"
+#include "Observable.hpp"
+
+/*----------------------------------------------------------------------------*/
+/* Definitions                                                                */
+/*----------------------------------------------------------------------------*/
+
+/**
+ * @brief Maximum number of registered parameters
+ */
+#define PARAM_MAX				(32u)
+
+/*----------------------------------------------------------------------------*/
+/* Class declaration	                                                      */
+/*----------------------------------------------------------------------------*/
+
+/**
+ * @namespace Utils
+ */
+namespace Utils
+{
+	/**
+	 * @class Param
+	 * @brief Registry of live tunable variables
+	 *
+	 * HOWTO :
+	 * - Owner module registers its variables with Param::Register() at init :
+	 *   name (static string), address, bounds and an optional change callback
+	 * - Users (CLI, I2C, Config) look them up with Find() or Count() / Get index
+	 *   and write them through Set()
+	 *
+	 * Set() checks bounds, writes the variable with interrupts masked, then
+	 * calls the change callback in the caller context. The callback should only
+	 * flag the change : the owner recomputes its derived values in its own loop.
+	 */
+	class Param
+	{
+	public:
+
+		/**
+		 * @brief Variable type list
+		 */
+		enum TYPE
+		{
+			FLOAT32,		//!< float32_t
+			INT32,			//!< int32_t
+			UINT32,			//!< uint32_t
+		};
+
+		/**
+		 * @brief Register a variable
+		 * @param name : Parameter name (static string)
+		 * @param address : Variable
+		 * @param min : Lowest value
+		 * @param max : Highest value
+		 * @param cb : Change callback (NULL if none)
+		 * @param obj : Change callback instance
+		 * @return false if the registry is full
+		 */
+		static bool Register (const char * name, float32_t * address, float32_t min, float32_t max,
+							  Observer::ObserverCallback cb = NULL, void * obj = NULL);
+		static bool Register (const char * name, int32_t * address, int32_t min, int32_t max,
+							  Observer::ObserverCallback cb = NULL, void * obj = NULL);
+		static bool Register (const char * name, uint32_t * address, uint32_t min, uint32_t max,
+							  Observer::ObserverCallback cb = NULL, void * obj = NULL);
+
+		/**
+		 * @brief Get number of registered parameters
+		 */
+		static uint32_t Count ();
+
+		/**
+		 * @brief Find a parameter by name
+		 * @param name : Parameter name
+		 * @return Index or -1 if not found
+		 */
+		static int32_t Find (const char * name);
+
+		/**
+		 * @brief Get parameter name
+		 * @param index : Parameter index (< Count())
+		 * @return Name or NULL
+		 */
+		static const char * GetName (uint32_t index);
+
+		/**
+		 * @brief Get parameter type
+		 * @param index : Parameter index (< Count())
+		 */
+		static enum TYPE GetType (uint32_t index);
+
+		/**
+		 * @brief Get parameter value and bounds
+		 * @param index : Parameter index (< Count())
+		 */
+		static float32_t GetValue (uint32_t index);
+		static float32_t GetMin (uint32_t index);
+		static float32_t GetMax (uint32_t index);
+
+		/**
+		 * @brief Write a parameter and notify its owner
+		 * @param index : Parameter index (< Count())
+		 * @param value : New value (rounded toward zero for integers)
+		 * @return false if index is invalid or value out of bounds
+		 */
+		static bool Set (uint32_t index, float32_t value);
+	};
+}
+
+#endif /* INC_PARAM_HPP_ */
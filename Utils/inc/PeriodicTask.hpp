@@ -0,0 +1,223 @@
+/**
+ * @file	PeriodicTask.hpp
+ * @author	Jeremy ROULLAND
+ * @date	22 oct. 2017
+ * @brief	Periodic task loop with scheduling statistics
+ */
+
+#ifndef INC_PERIODICTASK_HPP_
+#define INC_PERIODICTASK_HPP_
+
+#include "common.h"
+
+// FreeRTOS
+#include "FreeRTOS.h"
+#include "task.h"
+
+/*----------------------------------------------------------------------------*/
+/* Definitions                                                                */
+/*----------------------------------------------------------------------------*/
+
+/**
+ * @brief Maximum number of registered periodic tasks
+ */
+#define PERIODIC_MAX			(12u)
+
+/**
+ * @brief Number of jitter histogram bins (power of 2 microseconds, see PROFILER_HISTOGRAM_SIZE)
+ */
+#define PERIODIC_HISTOGRAM_SIZE	(12u)
+
+/*----------------------------------------------------------------------------*/
+/* Class declaration	                                                      */
+/*----------------------------------------------------------------------------*/
+
+/**
+ * @namespace Utils
+ */
+namespace Utils
+{
+	/**
+	 * @class PeriodicTask
+	 * @brief Periodic loop wrapper measuring actual scheduling
+	 *
+	 * HOWTO :
+	 * - Declare a PeriodicTask with a name and a period, it registers itself
+	 * - In the task, call Start() once then Wait() at the top of each iteration
+	 *   instead of vTaskDelayUntil() (Mark() for loops woken by an event)
+	 * - Use PeriodicTask::Count() / PeriodicTask::Get() to list all loops
+	 *
+	 * On each wake up (Utils::Clock, us) :
+	 * - period : time since previous wake up, jitter : distance to nominal period
+	 * - latency : wake up time after its release tick, relative to the best
+	 *   wake up seen (tick and clock phases are unknown)
+	 * - missed deadline : previous iteration ended after the next release
+	 *   (vTaskDelayUntil() returns at once, Mark() : period of 2 nominal or more)
+	 */
+	class PeriodicTask
+	{
+	public:
+
+		/**
+		 * @brief Periodic task constructor
+		 * @param name : Loop name (static string)
+		 * @param period : Nominal period (ms)
+		 */
+		PeriodicTask (const char * name, uint32_t period);
+
+		/**
+		 * @brief Get number of registered periodic tasks
+		 */
+		static uint32_t Count ();
+
+		/**
+		 * @brief Get a registered periodic task
+		 * @param index : Index (< Count())
+		 * @return Periodic task or NULL
+		 */
+		static PeriodicTask* Get (uint32_t index);
+
+		/**
+		 * @brief Set release time origin, call once from the task before the loop
+		 */
+		void Start ();
+
+		/**
+		 * @brief Wait for next release (vTaskDelayUntil) and update statistics
+		 * @return Elapsed ticks since previous wake up
+		 */
+		float32_t Wait ();
+
+		/**
+		 * @brief Update statistics of an event driven loop, call on each wake up
+		 * @return Elapsed ticks since previous wake up
+		 */
+		float32_t Mark ();
+
+		/**
+		 * @brief Reset statistics
+		 */
+		void Reset ();
+
+		/**
+		 * @brief Get loop name
+		 */
+		const char * GetName ()
+		{
+			return this->name;
+		}
+
+		/**
+		 * @brief Get nominal period (ms)
+		 */
+		uint32_t GetPeriod ()
+		{
+			return this->period;
+		}
+
+		/**
+		 * @brief Get number of wake ups
+		 */
+		uint32_t GetCount ()
+		{
+			return this->count;
+		}
+
+		/**
+		 * @brief Get number of missed deadlines
+		 */
+		uint32_t GetMissed ()
+		{
+			return this->missed;
+		}
+
+		/**
+		 * @brief Get minimum / maximum actual period (us)
+		 */
+		uint32_t GetPeriodMin ()
+		{
+			return (this->count > 1u) ? this->periodMin : 0u;
+		}
+		uint32_t GetPeriodMax ()
+		{
+			return this->periodMax;
+		}
+
+		/**
+		 * @brief Get worst jitter (us)
+		 */
+		uint32_t GetJitterMax ()
+		{
+			return this->jitterMax;
+		}
+
+		/**
+		 * @brief Get worst wake up latency (us)
+		 */
+		uint32_t GetLatencyMax ()
+		{
+			return (this->count > 0u) ? (uint32_t)(this->latencyMax - this->latencyMin) : 0u;
+		}
+
+		/**
+		 * @brief Get jitter histogram bin count
+		 * @param bin : Bin index (< PERIODIC_HISTOGRAM_SIZE)
+		 */
+		uint32_t GetHistogram (uint32_t bin)
+		{
+			return (bin < PERIODIC_HISTOGRAM_SIZE) ? this->histogram[bin] : 0u;
+		}
+
+	protected:
+
+		/**
+		 * @protected
+		 * @brief Update period and jitter statistics
+		 * @param now : Wake up time (us)
+		 * @return Elapsed ticks since previous wake up
+		 */
+		float32_t update (uint32_t now);
+
+		/**
+		 * @protected
+		 * @brief Loop name and nominal period (ms)
+		 */
+		const char * name;
+		uint32_t period;
+
+		/**
+		 * @protected
+		 * @brief Release tick and origin (tick and us)
+		 */
+		TickType_t lastWake;
+		TickType_t startTick;
+		uint32_t startUs;
+
+		/**
+		 * @protected
+		 * @brief Previous wake up (tick and us)
+		 */
+		TickType_t prevTick;
+		uint32_t prevUs;
+
+		/**
+		 * @protected
+		 * @brief Statistics (us)
+		 */
+		uint32_t count;
+		uint32_t missed;
+		uint32_t periodMin;
+		uint32_t periodMax;
+		uint32_t jitterMax;
+		int32_t latencyMin;
+		int32_t latencyMax;
+
+		/**
+		 * @protected
+		 * @brief Jitter histogram (power of 2 microseconds bins)
+		 */
+		uint32_t histogram[PERIODIC_HISTOGRAM_SIZE];
+	};
+}
+
+#endif /* INC_PERIODICTASK_HPP_ */
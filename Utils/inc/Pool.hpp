@@ -0,0 +1,142 @@
+/**
+ * @file	Pool.hpp
+ * @author	Jeremy ROULLAND
+ * @date	15 oct. 2026
+ * @brief	Fixed-block memory pool
+ */
+
+#ifndef INC_POOL_HPP_
+#define INC_POOL_HPP_
+
+#include "common.h"
+#include "stm32f4xx.h"
+
+#include <stddef.h>
+
+/*----------------------------------------------------------------------------*/
+/* Class declaration	                                                      */
+/*----------------------------------------------------------------------------*/
+
+/**
+ * @namespace Utils
+ */
+namespace Utils
+{
+	/**
+	 * @class Pool
+	 * @brief N blocks of type T, allocated and freed in O(1) from any task or interrupt
+	 *
+	 * HOWTO :
+	 * - Alloc() a block, fill it, pass its pointer (queue, ring, event)
+	 * - Receiver Free() it once done
+	 *
+	 * Free blocks are a stack of indexes, its head is swapped with
+	 * LDREX / STREX : an interrupt between both makes STREX fail and the swap
+	 * is retried with the new head, so no critical section and no ABA.
+	 * Blocks are not constructed : T is plain data.
+	 */
+	template<typename T, uint32_t N>
+	class Pool
+	{
+		static_assert((N != 0u) && (N < 0xFFFFu), "Pool size out of range");
+
+	public:
+
+		Pool ()
+		{
+			for(uint32_t i = 0u; i < N; i++)
+				this->next[i] = static_cast<uint16_t>(i + 1u);
+
+			this->head = 0u;
+			this->used = 0u;
+		}
+
+		/**
+		 * @brief Get a free block
+		 * @return Block or NULL if pool is empty
+		 */
+		T* Alloc ()
+		{
+			uint32_t index;
+
+			do
+			{
+				index = __LDREXW(&this->head);
+
+				if(index >= N)
+				{
+					__CLREX();
+					return NULL;
+				}
+			}
+			while(__STREXW(this->next[index], &this->head) != 0u);
+
+			this->count(+1);
+
+			return &this->blocks[index];
+		}
+
+		/**
+		 * @brief Give a block back
+		 * @param block : Block from Alloc(), NULL is ignored
+		 */
+		void Free (T* block)
+		{
+			uint32_t index;
+
+			if(block == NULL)
+				return;
+
+			index = static_cast<uint32_t>(block - this->blocks);
+			assert(index < N);
+
+			do
+			{
+				this->next[index] = static_cast<uint16_t>(__LDREXW(&this->head));
+			}
+			while(__STREXW(index, &this->head) != 0u);
+
+			this->count(-1);
+		}
+
+		/**
+		 * @brief Return number of allocated blocks
+		 */
+		uint32_t Used () const
+		{
+			return this->used;
+		}
+
+		/**
+		 * @brief Return number of blocks
+		 */
+		static uint32_t Size ()
+		{
+			return N;
+		}
+
+	private:
+
+		/**
+		 * @private
+		 * @brief Update allocated blocks count
+		 */
+		void count (int32_t delta)
+		{
+			uint32_t used;
+
+			do
+			{
+				used = __LDREXW(&this->used);
+			}
+			while(__STREXW(used + static_cast<uint32_t>(delta), &this->used) != 0u);
+		}
+
+		T blocks[N];
+		uint16_t next[N];
+		volatile uint32_t head;
+		volatile uint32_t used;
+	};
+}
+
+#endif /* INC_POOL_HPP_ */
@@ -0,0 +1,216 @@
+/**
+ * @file	Profiler.hpp
+ * @author	Jeremy ROULLAND
+ * @date	14 oct. 2017
+ * @brief	Execution time profiler class
+ */
+
+#ifndef INC_PROFILER_HPP_
+#define INC_PROFILER_HPP_
+
+#include "common.h"
+#include "stm32f4xx.h"
+#include "Trace.hpp"
+
+/*----------------------------------------------------------------------------*/
+/* Definitions                                                                */
+/*----------------------------------------------------------------------------*/
+
+/**
+ * @brief Maximum number of registered profilers
+ */
+#define PROFILER_MAX		(24u)
+
+/**
+ * @brief Number of histogram bins (power of 2 microseconds)
+ *
+ * Bin 0 : < 1us, bin n : [2^(n-1), 2^n[ us, last bin : everything above
+ */
+#define PROFILER_HISTOGRAM_SIZE	(12u)
+
+/*----------------------------------------------------------------------------*/
+/* Class declaration	                                                      */
+/*----------------------------------------------------------------------------*/
+
+/**
+ * @namespace Utils
+ */
+namespace Utils
+{
+	/**
+	 * @class Profiler
+	 * @brief Execution time measurement based on the DWT cycle counter
+	 *
+	 * HOWTO :
+	 * - Call Profiler::Init() once at startup (done by the OS run time stats)
+	 * - Declare a Profiler with a name, it registers itself
+	 * - Call Start() / Stop() around the code to measure
+	 * - Use Profiler::Count() / Profiler::Get() to list all profilers
+	 *
+	 * Start() / Stop() are interrupt safe as long as a profiler is used by
+	 * one context only (one task or one IRQ handler). They are recorded by
+	 * Utils::Trace while it runs (BEGIN / END, profiler index).
+	 */
+	class Profiler
+	{
+	public:
+
+		/**
+		 * @brief Profiler constructor
+		 * @param name : Profiler name (static string)
+		 */
+		Profiler (const char * name);
+
+		/**
+		 * @brief Enable the DWT cycle counter
+		 *
+		 * Counter is reset on first call only : called again by the OS, it
+		 * keeps the boot time and the Clock running.
+		 */
+		static void Init ();
+
+		/**
+		 * @brief Get the CPU cycle counter
+		 */
+		static inline uint32_t GetCycles ()
+		{
+			return DWT->CYCCNT;
+		}
+
+		/**
+		 * @brief Convert CPU cycles to microseconds
+		 */
+		static uint32_t CyclesToUs (uint32_t cycles);
+
+		/**
+		 * @brief Get number of registered profilers
+		 */
+		static uint32_t Count ();
+
+		/**
+		 * @brief Get a registered profiler
+		 * @param index : Profiler index (< Count())
+		 * @return Profiler or NULL
+		 */
+		static Profiler* Get (uint32_t index);
+
+		/**
+		 * @brief Start a measure
+		 */
+		inline void Start ()
+		{
+			Trace::Record(Trace::BEGIN, this->index);
+			this->start = DWT->CYCCNT;
+		}
+
+		/**
+		 * @brief Stop a measure and update statistics
+		 */
+		void Stop ();
+
+		/**
+		 * @brief Reset statistics
+		 */
+		void Reset ();
+
+		/**
+		 * @brief Get profiler name
+		 */
+		const char * GetName ()
+		{
+			return this->name;
+		}
+
+		/**
+		 * @brief Get number of measures
+		 */
+		uint32_t GetCount ()
+		{
+			return this->count;
+		}
+
+		/**
+		 * @brief Get minimum duration (cycles)
+		 */
+		uint32_t GetMin ()
+		{
+			return (this->count > 0) ? this->min : 0;
+		}
+
+		/**
+		 * @brief Get maximum duration (cycles)
+		 */
+		uint32_t GetMax ()
+		{
+			return this->max;
+		}
+
+		/**
+		 * @brief Get total duration of the measures (cycles)
+		 */
+		uint64_t GetTotal ()
+		{
+			return this->sum;
+		}
+
+		/**
+		 * @brief Get average duration (cycles)
+		 */
+		uint32_t GetAverage ();
+
+		/**
+		 * @brief Get histogram bin count
+		 * @param bin : Bin index (< PROFILER_HISTOGRAM_SIZE)
+		 */
+		uint32_t GetHistogram (uint32_t bin)
+		{
+			return (bin < PROFILER_HISTOGRAM_SIZE) ? this->histogram[bin] : 0;
+		}
+
+		/**
+		 * @brief Get last duration (cycles)
+		 */
+		uint32_t GetLast ()
+		{
+			return this->last;
+		}
+
+	protected:
+
+		/**
+		 * @protected
+		 * @brief Profiler name
+		 */
+		const char * name;
+
+		/**
+		 * @protected
+		 * @brief Registration index (trace ID)
+		 */
+		uint8_t index;
+
+		/**
+		 * @protected
+		 * @brief Start cycle counter value
+		 */
+		uint32_t start;
+
+		/**
+		 * @protected
+		 * @brief Statistics (cycles)
+		 */
+		uint32_t min;
+		uint32_t max;
+		uint32_t last;
+		uint64_t sum;
+		uint32_t count;
+
+		/**
+		 * @protected
+		 * @brief Duration histogram (power of 2 microseconds bins)
+		 */
+		uint32_t histogram[PROFILER_HISTOGRAM_SIZE];
+	};
+}
+
+#endif /* INC_PROFILER_HPP_ */
@@ -0,0 +1,177 @@
+/**
+ * @file	RelayTuner.hpp
+ * @author	Jeremy ROULLAND
+ * @date	22 oct. 2017
+ * @brief	Relay feedback PID auto-tuner
+ */
+
+#ifndef INC_RELAYTUNER_HPP_
+#define INC_RELAYTUNER_HPP_
+
+#include "common.h"
+#include "PID.hpp"
+
+/*----------------------------------------------------------------------------*/
+/* Class declaration	                                                      */
+/*----------------------------------------------------------------------------*/
+
+/**
+ * @namespace Utils
+ */
+namespace Utils
+{
+	/**
+	 * @class RelayTuner
+	 * @brief Astrom-Hagglund relay feedback experiment
+	 *
+	 * HOWTO :
+	 * - Call Start() with the setpoint to hold and the relay amplitude
+	 * - Each period, drive the plant with Update() output instead of the PID
+	 * - Once DONE, read ultimate gain and period, GetGains() proposes PID gains
+	 *
+	 * The relay (+/- amplitude, hysteresis on the error) makes the loop
+	 * oscillate at its ultimate period Tu. Output amplitude a of the feedback
+	 * gives the ultimate gain Ku = 4 d / (pi sqrt(a^2 - h^2)). The first cycle
+	 * is discarded (transient), next ones are averaged.
+	 */
+	class RelayTuner
+	{
+	public:
+
+		/**
+		 * @brief Experiment state list
+		 */
+		enum STATE
+		{
+			IDLE,			//!< Not started or stopped
+			RUNNING,		//!< Oscillating
+			DONE,			//!< Ku and Tu measured
+			FAILED,			//!< Timeout or no oscillation above hysteresis
+		};
+
+		/**
+		 * @brief Gains rule list (parallel form : ki = kp / Ti, kd = kp * Td)
+		 */
+		enum RULE
+		{
+			ZIEGLER_NICHOLS,	//!< kp = 0.6 Ku, Ti = Tu / 2, Td = Tu / 8
+			SOME_OVERSHOOT,		//!< kp = 0.33 Ku, Ti = Tu / 2, Td = Tu / 3
+			NO_OVERSHOOT,		//!< kp = 0.2 Ku, Ti = Tu / 2, Td = Tu / 3
+			RULE_MAX
+		};
+
+		/**
+		 * @brief RelayTuner constructor
+		 */
+		RelayTuner ();
+
+		/**
+		 * @brief Start experiment
+		 * @param setpoint : Feedback value to oscillate around
+		 * @param amplitude : Relay output amplitude d
+		 * @param hysteresis : Error hysteresis h (above feedback noise)
+		 * @param cycles : Number of averaged cycles
+		 * @param timeout : Experiment timeout (s)
+		 */
+		void Start (float32_t setpoint, float32_t amplitude, float32_t hysteresis, uint32_t cycles, float32_t timeout);
+
+		/**
+		 * @brief Abort experiment (back to IDLE)
+		 */
+		void Stop ();
+
+		/**
+		 * @brief Update experiment
+		 * @param feedback : Plant output
+		 * @param dt : Time since last update (s)
+		 * @return Plant command, 0 if not RUNNING
+		 */
+		float32_t Update (float32_t feedback, float32_t dt);
+
+		/**
+		 * @brief Get experiment state
+		 */
+		enum STATE GetState ()
+		{
+			return this->state;
+		}
+
+		/**
+		 * @brief Get number of measured cycles
+		 */
+		uint32_t GetCycles ()
+		{
+			return this->measured;
+		}
+
+		/**
+		 * @brief Get ultimate gain Ku and period Tu (s), 0 until DONE
+		 */
+		float32_t GetUltimateGain ()
+		{
+			return this->ku;
+		}
+		float32_t GetUltimatePeriod ()
+		{
+			return this->tu;
+		}
+
+		/**
+		 * @brief Get proposed gains (0 until DONE)
+		 * @param rule : Tuning rule
+		 * @return Gains (velocity field unused)
+		 */
+		PID_GAINS GetGains (enum RULE rule);
+
+	private:
+
+		/**
+		 * @private
+		 * @brief Experiment state
+		 */
+		enum STATE state;
+
+		/**
+		 * @private
+		 * @brief Experiment settings
+		 */
+		float32_t setpoint;
+		float32_t amplitude;
+		float32_t hysteresis;
+		uint32_t cycles;
+		float32_t timeout;
+
+		/**
+		 * @private
+		 * @brief Relay output and time since start (s)
+		 */
+		float32_t output;
+		float32_t time;
+
+		/**
+		 * @private
+		 * @brief Current cycle : start time, feedback extrema
+		 */
+		float32_t cycleStart;
+		float32_t cycleMax;
+		float32_t cycleMin;
+		uint32_t started;
+
+		/**
+		 * @private
+		 * @brief Measured cycles sums
+		 */
+		uint32_t measured;
+		float32_t periodSum;
+		float32_t amplitudeSum;
+
+		/**
+		 * @private
+		 * @brief Results
+		 */
+		float32_t ku;
+		float32_t tu;
+	};
+}
+
+#endif /* INC_RELAYTUNER_HPP_ */
@@ -0,0 +1,296 @@
+/**
+ * @file	Ring.hpp
+ * @author	Jeremy ROULLAND
+ * @date	15 oct. 2026
+ * @brief	Lock-free rings for interrupt / task handoffs
+ */
+
+#ifndef INC_RING_HPP_
+#define INC_RING_HPP_
+
+#include "common.h"
+#include "stm32f4xx.h"
+
+/*----------------------------------------------------------------------------*/
+/* Class declaration	                                                      */
+/*----------------------------------------------------------------------------*/
+
+/**
+ * @namespace Utils
+ */
+namespace Utils
+{
+	/**
+	 * @class SpscRing
+	 * @brief Ring of N items, one producer and one consumer (N power of 2)
+	 *
+	 * HOWTO :
+	 * - Producer copies an item with Push(), or fills it in place : Claim() a
+	 *   slot, write it (DMA included), then Publish() it
+	 * - Consumer copies the oldest item with Pop(), or reads it in place :
+	 *   Front(), then Release() the slot
+	 *
+	 * Indexes are free running, each one written by its side only : no
+	 * critical section. __DMB() orders the item writes before the index update
+	 * and the index read before the item reads. Several producers (or
+	 * consumers) must be serialized by their caller.
+	 */
+	template<typename T, uint32_t N>
+	class SpscRing
+	{
+		static_assert((N != 0u) && ((N & (N - 1u)) == 0u), "SpscRing size must be a power of 2");
+
+	public:
+
+		SpscRing ()
+		{
+			this->wr = 0u;
+			this->rd = 0u;
+		}
+
+		/**
+		 * @brief Drop every item (both sides idle)
+		 */
+		void Clear ()
+		{
+			this->rd = this->wr;
+		}
+
+		/**
+		 * @brief Return number of items (consistent from either side)
+		 */
+		uint32_t Count () const
+		{
+			return this->wr - this->rd;
+		}
+
+		bool IsEmpty () const
+		{
+			return (this->wr == this->rd);
+		}
+
+		/**
+		 * @brief Producer : get next free slot
+		 * @return Slot or NULL if ring is full
+		 */
+		T* Claim ()
+		{
+			uint32_t wr = this->wr;
+
+			if((wr - this->rd) >= N)
+				return NULL;
+
+			return &this->items[wr & (N - 1u)];
+		}
+
+		/**
+		 * @brief Producer : make claimed slot visible to the consumer
+		 */
+		void Publish ()
+		{
+			__DMB();
+			this->wr = this->wr + 1u;
+		}
+
+		/**
+		 * @brief Producer : copy an item
+		 * @return false if ring is full (item dropped)
+		 */
+		bool Push (const T& item)
+		{
+			T* slot = this->Claim();
+
+			if(slot == NULL)
+				return false;
+
+			*slot = item;
+			this->Publish();
+
+			return true;
+		}
+
+		/**
+		 * @brief Consumer : get oldest item
+		 * @return Item or NULL if ring is empty
+		 */
+		T* Front ()
+		{
+			uint32_t rd = this->rd;
+
+			if(rd == this->wr)
+				return NULL;
+
+			__DMB();
+			return &this->items[rd & (N - 1u)];
+		}
+
+		/**
+		 * @brief Consumer : give oldest slot back to the producer
+		 */
+		void Release ()
+		{
+			__DMB();
+			this->rd = this->rd + 1u;
+		}
+
+		/**
+		 * @brief Consumer : copy and remove oldest item
+		 * @return false if ring is empty
+		 */
+		bool Pop (T& item)
+		{
+			T* slot = this->Front();
+
+			if(slot == NULL)
+				return false;
+
+			item = *slot;
+			this->Release();
+
+			return true;
+		}
+
+	private:
+
+		volatile uint32_t wr;
+		volatile uint32_t rd;
+		T items[N];
+	};
+
+	/**
+	 * @class MpscRing
+	 * @brief Ring of N items, any number of producers and one consumer (N power of 2)
+	 *
+	 * HOWTO :
+	 * - Producers (tasks or interrupts) copy an item with Push()
+	 * - Consumer reads the oldest item in place with Front() / Release(), or
+	 *   copies it with Pop()
+	 *
+	 * Producers claim a position with LDREX / STREX on the write index (an
+	 * interrupt between both makes STREX fail, the claim is retried), then
+	 * publish the slot through its sequence number. A producer preempted
+	 * between claim and publish holds back the items behind it, never more
+	 * than its own copy.
+	 */
+	template<typename T, uint32_t N>
+	class MpscRing
+	{
+		static_assert((N != 0u) && ((N & (N - 1u)) == 0u), "MpscRing size must be a power of 2");
+
+	public:
+
+		MpscRing ()
+		{
+			this->Clear();
+		}
+
+		/**
+		 * @brief Drop every item (producers and consumer idle)
+		 */
+		void Clear ()
+		{
+			for(uint32_t i = 0u; i < N; i++)
+				this->slots[i].seq = i;
+
+			this->wr = 0u;
+			this->rd = 0u;
+		}
+
+		/**
+		 * @brief Return number of claimed items (published or being written)
+		 */
+		uint32_t Count () const
+		{
+			return this->wr - this->rd;
+		}
+
+		/**
+		 * @brief Producer : copy an item
+		 * @return false if ring is full (item dropped)
+		 */
+		bool Push (const T& item)
+		{
+			SLOT* slot;
+			uint32_t wr;
+
+			do
+			{
+				wr = __LDREXW(&this->wr);
+				slot = &this->slots[wr & (N - 1u)];
+
+				// Slot still holds the item written N positions ago
+				if(static_cast<int32_t>(slot->seq - wr) < 0)
+				{
+					__CLREX();
+					return false;
+				}
+			}
+			while(__STREXW(wr + 1u, &this->wr) != 0u);
+
+			slot->item = item;
+
+			__DMB();
+			slot->seq = wr + 1u;
+
+			return true;
+		}
+
+		/**
+		 * @brief Consumer : get oldest item
+		 * @return Item or NULL if ring is empty (or oldest item not published yet)
+		 */
+		T* Front ()
+		{
+			SLOT* slot = &this->slots[this->rd & (N - 1u)];
+
+			if(slot->seq != (this->rd + 1u))
+				return NULL;
+
+			__DMB();
+			return &slot->item;
+		}
+
+		/**
+		 * @brief Consumer : give oldest slot back to the producers
+		 */
+		void Release ()
+		{
+			SLOT* slot = &this->slots[this->rd & (N - 1u)];
+
+			__DMB();
+			slot->seq = this->rd + N;
+			this->rd = this->rd + 1u;
+		}
+
+		/**
+		 * @brief Consumer : copy and remove oldest item
+		 * @return false if ring is empty
+		 */
+		bool Pop (T& item)
+		{
+			T* slot = this->Front();
+
+			if(slot == NULL)
+				return false;
+
+			item = *slot;
+			this->Release();
+
+			return true;
+		}
+
+	private:
+
+		typedef struct
+		{
+			volatile uint32_t	seq;		/**< Position + 1 once published, position + N once released */
+			T					item;
+		}SLOT;
+
+		volatile uint32_t wr;
+		volatile uint32_t rd;
+		SLOT slots[N];
+	};
+}
+
+#endif /* INC_RING_HPP_ */
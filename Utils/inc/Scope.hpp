@@ -0,0 +1,184 @@
+/**
+ * @file	Scope.hpp
+ * @author	Jeremy ROULLAND
+ * @date	27 oct. 2017
+ * @brief	Triggered RAM capture of control loop variables
+ */
+
+#ifndef INC_SCOPE_HPP_
+#define INC_SCOPE_HPP_
+
+#include "common.h"
+#include "stm32f4xx.h"
+
+/*----------------------------------------------------------------------------*/
+/* Definitions                                                                */
+/*----------------------------------------------------------------------------*/
+
+/**
+ * @brief Number of captured variables
+ */
+#define SCOPE_CHANNELS			(4u)
+
+/**
+ * @brief Number of samples in the ring buffer (power of 2, SCOPE_CHANNELS floats each)
+ */
+#define SCOPE_SAMPLES			(512u)
+
+/**
+ * @brief Channel probe, returns the variable to capture
+ */
+typedef float32_t (*ScopeProbe)(void);
+
+/*----------------------------------------------------------------------------*/
+/* Class declaration	                                                      */
+/*----------------------------------------------------------------------------*/
+
+/**
+ * @namespace Utils
+ */
+namespace Utils
+{
+	/**
+	 * @class Scope
+	 * @brief Triggered capture, pre and post trigger samples
+	 *
+	 * HOWTO :
+	 * - Select variables with Scope::SetChannel() and the trigger with Scope::SetTrigger()
+	 * - Call Scope::Arm() with the number of pre-trigger samples
+	 * - Call Scope::Sample() from the control loop, each call captures every channel
+	 * - Call Scope::Trigger() on ORDER events (order start), MANUAL forces the trigger
+	 * - Once Scope::GetState() is DONE, read samples oldest first with
+	 *   Scope::Count() / Scope::Get(), Scope::GetTriggerIndex() is the trigger sample
+	 *
+	 * Level triggers (RISING, FALLING, ABOVE) compare a channel to a threshold
+	 * at sampling time. Capture stops SCOPE_SAMPLES - pre samples after the
+	 * trigger : the buffer is not written while it is read.
+	 */
+	class Scope
+	{
+	public:
+
+		/**
+		 * @brief Trigger source list
+		 */
+		enum TRIGGER
+		{
+			MANUAL,		//!< Scope::Trigger(MANUAL) only
+			ORDER,		//!< Scope::Trigger(ORDER) (motion order started)
+			RISING,		//!< Channel crosses level upward
+			FALLING,	//!< Channel crosses level downward
+			ABOVE,		//!< Channel magnitude above level (error threshold)
+		};
+
+		/**
+		 * @brief Capture state list
+		 */
+		enum STATE
+		{
+			IDLE,		//!< Not armed
+			ARMED,		//!< Pre-trigger samples, waiting for trigger
+			TRIGGERED,	//!< Post-trigger samples
+			DONE,		//!< Capture complete, buffer can be read
+		};
+
+		/**
+		 * @brief Select a channel variable (capture stopped)
+		 * @param channel : Channel index (< SCOPE_CHANNELS)
+		 * @param probe : Variable probe, NULL captures 0
+		 * @return true if set
+		 */
+		static bool SetChannel (uint32_t channel, ScopeProbe probe);
+
+		/**
+		 * @brief Return a channel probe, NULL if unused
+		 */
+		static ScopeProbe GetChannel (uint32_t channel);
+
+		/**
+		 * @brief Select trigger (capture stopped)
+		 * @param source : Trigger source
+		 * @param channel : Level trigger channel
+		 * @param level : Level trigger threshold
+		 * @return true if set
+		 */
+		static bool SetTrigger (enum TRIGGER source, uint32_t channel = 0u, float32_t level = 0.0f);
+
+		/**
+		 * @brief Get trigger source
+		 */
+		static inline enum TRIGGER GetTrigger ()
+		{
+			return source;
+		}
+
+		/**
+		 * @brief Get level trigger channel and threshold
+		 */
+		static uint32_t GetTriggerChannel ();
+		static float32_t GetTriggerLevel ();
+
+		/**
+		 * @brief Clear the buffer and wait for trigger
+		 * @param pre : Pre-trigger samples (< SCOPE_SAMPLES)
+		 */
+		static void Arm (uint32_t pre);
+
+		/**
+		 * @brief Stop capture, buffer is kept
+		 */
+		static void Stop ();
+
+		/**
+		 * @brief External trigger
+		 * @param source : ORDER (ignored unless selected) or MANUAL (always triggers)
+		 */
+		static void Trigger (enum TRIGGER source);
+
+		/**
+		 * @brief Capture a sample of every channel (control loop)
+		 */
+		static void Sample ();
+
+		/**
+		 * @brief Get capture state
+		 */
+		static inline enum STATE GetState ()
+		{
+			return state;
+		}
+
+		/**
+		 * @brief Get number of samples available (at most SCOPE_SAMPLES)
+		 */
+		static uint32_t Count ();
+
+		/**
+		 * @brief Get index of the trigger sample (Get() order)
+		 */
+		static uint32_t GetTriggerIndex ();
+
+		/**
+		 * @brief Get a sample, oldest first
+		 * @param index : Sample index (< Count())
+		 * @return SCOPE_CHANNELS values or NULL
+		 */
+		static const float32_t* Get (uint32_t index);
+
+	protected:
+
+		/**
+		 * @protected
+		 * @brief Capture state
+		 */
+		static volatile enum STATE state;
+
+		/**
+		 * @protected
+		 * @brief Trigger source
+		 */
+		static enum TRIGGER source;
+	};
+}
+
+#endif /* INC_SCOPE_HPP_ */
@@ -0,0 +1,59 @@
+/**
+ * @file	StaticStorage.hpp
+ * @author	Jeremy ROULLAND
+ * @date	14 oct. 2017
+ * @brief	Static storage for singleton instances
+ */
+
+#ifndef INC_STATICSTORAGE_HPP_
+#define INC_STATICSTORAGE_HPP_
+
+#include <stddef.h>
+#include <new>
+#include <type_traits>
+
+/*----------------------------------------------------------------------------*/
+/* Class declaration	                                                      */
+/*----------------------------------------------------------------------------*/
+
+/**
+ * @namespace Utils
+ */
+namespace Utils
+{
+	/**
+	 * @class StaticStorage
+	 * @brief Raw storage reserved at link time for N instances of T
+	 *
+	 * HOWTO :
+	 * 	- Declare a static StaticStorage<T, N> next to the instance table
+	 * 	- Build the instance in place : _instance[id] = new (_storage.Get(id)) T(id);
+	 *
+	 * Instances are never destroyed. Memory is accounted in .bss so the
+	 * FreeRTOS heap is not used by GetInstance() methods.
+	 */
+	template<typename T, size_t N = 1u>
+	class StaticStorage
+	{
+	public:
+
+		/**
+		 * @brief Return storage of instance i
+		 * @param i : Instance index (< N)
+		 */
+		void* Get (size_t i = 0u)
+		{
+			return &this->storage[i];
+		}
+
+	private:
+
+		/**
+		 * @private
+		 * @brief Aligned raw storage
+		 */
+		typename std::aligned_storage<sizeof(T), alignof(T)>::type storage[N];
+	};
+}
+
+#endif /* INC_STATICSTORAGE_HPP_ */
@@ -0,0 +1,208 @@
+/**
+ * @file	StaticVector.hpp
+ * @author	Jeremy ROULLAND
+ * @date	15 oct. 2026
+ * @brief	Fixed capacity containers (vector, string)
+ */
+
+#ifndef INC_STATICVECTOR_HPP_
+#define INC_STATICVECTOR_HPP_
+
+#include "common.h"
+
+#include <stddef.h>
+#include <string.h>
+
+/*----------------------------------------------------------------------------*/
+/* Class declaration	                                                      */
+/*----------------------------------------------------------------------------*/
+
+/**
+ * @namespace Utils
+ */
+namespace Utils
+{
+	/**
+	 * @class StaticVector
+	 * @brief Vector of at most N elements, storage inside the object
+	 *
+	 * HOWTO :
+	 * - Same names as std::vector (size(), push_back(), erase(), range for)
+	 * - Operations that would grow past N return false instead of allocating
+	 *
+	 * An appended element is complete before size() counts it : an interrupt
+	 * may iterate the vector while a task appends to it.
+	 */
+	template<typename T, size_t N>
+	class StaticVector
+	{
+	public:
+
+		typedef T			value_type;
+		typedef T*			iterator;
+		typedef const T*	const_iterator;
+
+		StaticVector () : count(0u)
+		{
+		}
+
+		size_t size () const			{ return this->count; }
+		static constexpr size_t capacity ()	{ return N; }
+		bool empty () const				{ return (this->count == 0u); }
+		bool full () const				{ return (this->count >= N); }
+
+		T& operator[] (size_t i)				{ return this->items[i]; }
+		const T& operator[] (size_t i) const	{ return this->items[i]; }
+		T& front ()						{ return this->items[0]; }
+		T& back ()						{ return this->items[this->count - 1u]; }
+		T* data ()						{ return this->items; }
+
+		iterator begin ()				{ return this->items; }
+		iterator end ()					{ return this->items + this->count; }
+		const_iterator begin () const	{ return this->items; }
+		const_iterator end () const		{ return this->items + this->count; }
+
+		/**
+		 * @brief Remove every element
+		 */
+		void clear ()
+		{
+			this->count = 0u;
+		}
+
+		/**
+		 * @brief Append an element
+		 * @return false if vector is full
+		 */
+		bool push_back (const T& item)
+		{
+			size_t n = this->count;
+
+			if(n >= N)
+				return false;
+
+			this->items[n] = item;
+			this->count = n + 1u;
+
+			return true;
+		}
+
+		/**
+		 * @brief Remove last element (if any)
+		 */
+		void pop_back ()
+		{
+			if(this->count > 0u)
+				this->count = this->count - 1u;
+		}
+
+		/**
+		 * @brief Remove an element, following ones are shifted (order kept)
+		 * @return Iterator on the element following the removed one
+		 */
+		iterator erase (iterator it)
+		{
+			size_t n = this->count;
+
+			for(iterator next = it + 1; next < (this->items + n); next++)
+				*(next - 1) = *next;
+
+			this->count = n - 1u;
+
+			return it;
+		}
+
+	private:
+
+		T items[N];
+		volatile size_t count;
+	};
+
+	/**
+	 * @class StaticString
+	 * @brief String of at most N characters, always NULL terminated
+	 *
+	 * HOWTO :
+	 * - Same names as std::string (size(), push_back(), append(), c_str())
+	 * - Characters past N are dropped and the call returns false
+	 */
+	template<size_t N>
+	class StaticString
+	{
+	public:
+
+		StaticString () : length(0u)
+		{
+			this->text[0] = '\0';
+		}
+
+		size_t size () const			{ return this->length; }
+		static constexpr size_t capacity ()	{ return N; }
+		bool empty () const				{ return (this->length == 0u); }
+		bool full () const				{ return (this->length >= N); }
+
+		char operator[] (size_t i) const	{ return this->text[i]; }
+		const char* c_str () const		{ return this->text; }
+
+		/**
+		 * @brief Characters, may be modified in place (tokenized)
+		 */
+		char* data ()					{ return this->text; }
+
+		void clear ()
+		{
+			this->length = 0u;
+			this->text[0] = '\0';
+		}
+
+		/**
+		 * @brief Append a character
+		 * @return false if string is full
+		 */
+		bool push_back (char c)
+		{
+			if(this->length >= N)
+				return false;
+
+			this->text[this->length++] = c;
+			this->text[this->length] = '\0';
+
+			return true;
+		}
+
+		/**
+		 * @brief Remove last character (if any)
+		 */
+		void pop_back ()
+		{
+			if(this->length > 0u)
+				this->text[--this->length] = '\0';
+		}
+
+		/**
+		 * @brief Append a string
+		 * @return false if truncated
+		 */
+		bool append (const char* str)
+		{
+			size_t n = strlen(str);
+			bool fits = (n <= (N - this->length));
+
+			if(!fits)
+				n = N - this->length;
+
+			memcpy(&this->text[this->length], str, n);
+			this->length += n;
+			this->text[this->length] = '\0';
+
+			return fits;
+		}
+
+	private:
+
+		char text[N + 1u];
+		size_t length;
+	};
+}
+
+#endif /* INC_STATICVECTOR_HPP_ */
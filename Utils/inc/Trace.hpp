@@ -0,0 +1,164 @@
+/**
+ * @file	Trace.hpp
+ * @author	Jeremy ROULLAND
+ * @date	22 oct. 2017
+ * @brief	RAM ring buffer event tracer
+ */
+
+#ifndef INC_TRACE_HPP_
+#define INC_TRACE_HPP_
+
+#include "common.h"
+#include "stm32f4xx.h"
+
+// FreeRTOS
+#include "FreeRTOS.h"
+#include "queue.h"
+
+/*----------------------------------------------------------------------------*/
+/* Definitions                                                                */
+/*----------------------------------------------------------------------------*/
+
+/**
+ * @brief Number of records in the ring buffer (power of 2, 8 bytes each)
+ */
+#define TRACE_BUFFER_SIZE		(512u)
+
+/**
+ * @brief Trace record
+ */
+typedef struct
+{
+	uint32_t	CYCLES;		/**< DWT cycle counter */
+	uint8_t		TYPE;		/**< Utils::Trace::TYPE */
+	uint8_t		ID;			/**< Task number, queue number, profiler index or marker ID */
+	uint16_t	ARG;		/**< Marker argument */
+}TRACE_RECORD;
+
+/*----------------------------------------------------------------------------*/
+/* Class declaration	                                                      */
+/*----------------------------------------------------------------------------*/
+
+/**
+ * @namespace Utils
+ */
+namespace Utils
+{
+	/**
+	 * @class Trace
+	 * @brief Event tracer, cycle accurate timestamps
+	 *
+	 * HOWTO :
+	 * - Call Trace::Start(), run, then Trace::Stop() to freeze the buffer
+	 * - Read records oldest first with Trace::Count() / Trace::Get()
+	 * - Number the queues to trace with Trace::Queue() (others are ignored)
+	 * - Add user markers with Trace::Marker()
+	 *
+	 * Recorded events :
+	 * - TASK_IN : task switched in, ID is the task number (see TaskTable)
+	 * - QUEUE_SEND / QUEUE_RECEIVE : ID is the queue number, FromISR included
+	 * - BEGIN / END : Profiler Start() / Stop(), ID is the profiler index,
+	 *   covers loops computation and IRQ handlers entry / exit
+	 * - MARKER : user marker
+	 *
+	 * The buffer is overwritten while running : it holds the last
+	 * TRACE_BUFFER_SIZE events before Stop(). Recording is interrupt safe.
+	 */
+	class Trace
+	{
+	public:
+
+		/**
+		 * @brief Record type list
+		 */
+		enum TYPE
+		{
+			TASK_IN,			//!< Task switched in
+			QUEUE_SEND,			//!< Item sent to a queue
+			QUEUE_RECEIVE,		//!< Item received from a queue
+			BEGIN,				//!< Profiler start
+			END,				//!< Profiler stop
+			MARKER,				//!< User marker
+		};
+
+		/**
+		 * @brief Clear the buffer and start recording
+		 */
+		static void Start ();
+
+		/**
+		 * @brief Stop recording, buffer is kept
+		 */
+		static void Stop ();
+
+		/**
+		 * @brief Return true while recording
+		 */
+		static inline bool IsRunning ()
+		{
+			return running;
+		}
+
+		/**
+		 * @brief Number a queue to trace its send / receive events
+		 * @param queue : Queue handle
+		 * @param id : Queue number (1 to 255, 0 stops tracing the queue)
+		 */
+		static void Queue (QueueHandle_t queue, uint8_t id);
+
+		/**
+		 * @brief Add a user marker
+		 * @param id : Marker ID
+		 * @param arg : Marker argument
+		 */
+		static inline void Marker (uint8_t id, uint16_t arg = 0u)
+		{
+			if(running)
+				write(MARKER, id, arg);
+		}
+
+		/**
+		 * @brief Add a record
+		 * @param type : Record type
+		 * @param id : Record ID
+		 */
+		static inline void Record (enum TYPE type, uint8_t id)
+		{
+			if(running)
+				write(type, id, 0u);
+		}
+
+		/**
+		 * @brief Get number of records available (at most TRACE_BUFFER_SIZE)
+		 */
+		static uint32_t Count ();
+
+		/**
+		 * @brief Get number of records overwritten since Start()
+		 */
+		static uint32_t GetLost ();
+
+		/**
+		 * @brief Get a record, oldest first
+		 * @param index : Record index (< Count())
+		 * @return Record or NULL
+		 */
+		static const TRACE_RECORD* Get (uint32_t index);
+
+	protected:
+
+		/**
+		 * @protected
+		 * @brief Write a record in the ring buffer
+		 */
+		static void write (enum TYPE type, uint8_t id, uint16_t arg);
+
+		/**
+		 * @protected
+		 * @brief Recording state
+		 */
+		static volatile bool running;
+	};
+}
+
+#endif /* INC_TRACE_HPP_ */
@@ -0,0 +1,121 @@
+/**
+ * @file	Units.hpp
+ * @author	Jeremy ROULLAND
+ * @date	15 oct. 2026
+ * @brief	Typed physical units (meter, millimeter, radian, degree, encoder tick)
+ */
+
+#ifndef INC_UNITS_HPP_
+#define INC_UNITS_HPP_
+
+#include "common.h"
+
+/*----------------------------------------------------------------------------*/
+/* Class declaration	                                                      */
+/*----------------------------------------------------------------------------*/
+
+/**
+ * @namespace Utils
+ */
+namespace Utils
+{
+	/**
+	 * @namespace Units
+	 * @brief Single precision values tagged with their unit
+	 *
+	 * HOWTO :
+	 * - Wrap a raw value at the boundary : Units::Meter(x)
+	 * - Convert with To<Unit>() : fixed factors are constexpr and fold into a
+	 *   single multiply, encoder ticks go through a TickScale built once from
+	 *   the geometry (reciprocal stored, no divide)
+	 * - Unwrap with Value()
+	 *
+	 * Mixing units (adding meters to ticks) does not compile.
+	 */
+	namespace Units
+	{
+		/**
+		 * @class Quantity
+		 * @brief Value of unit TAG
+		 */
+		template<typename TAG>
+		class Quantity
+		{
+		public:
+
+			constexpr explicit Quantity (float32_t value = 0.0f) : value(value)
+			{
+			}
+
+			constexpr float32_t Value () const
+			{
+				return this->value;
+			}
+
+			constexpr Quantity operator+ (Quantity q) const	{ return Quantity(this->value + q.value); }
+			constexpr Quantity operator- (Quantity q) const	{ return Quantity(this->value - q.value); }
+			constexpr Quantity operator- () const				{ return Quantity(-this->value); }
+			constexpr Quantity operator* (float32_t k) const	{ return Quantity(this->value * k); }
+
+			constexpr bool operator< (Quantity q) const		{ return this->value < q.value; }
+			constexpr bool operator> (Quantity q) const		{ return this->value > q.value; }
+
+		private:
+
+			float32_t value;
+		};
+
+		typedef Quantity<struct MeterTag>		Meter;
+		typedef Quantity<struct MillimeterTag>	Millimeter;
+		typedef Quantity<struct RadianTag>		Radian;
+		typedef Quantity<struct DegreeTag>		Degree;
+		typedef Quantity<struct TickTag>		Tick;
+
+		/**
+		 * @brief Conversion factors (computed in double, stored in single precision)
+		 */
+		constexpr float32_t MM_BY_M		= 1000.0f;
+		constexpr float32_t M_BY_MM		= static_cast<float32_t>(1.0 / 1000.0);
+		constexpr float32_t DEG_BY_RAD	= static_cast<float32_t>(180.0 / 3.14159265358979323846);
+		constexpr float32_t RAD_BY_DEG	= static_cast<float32_t>(3.14159265358979323846 / 180.0);
+
+		constexpr Millimeter ToMillimeter (Meter m)		{ return Millimeter(m.Value() * MM_BY_M); }
+		constexpr Meter ToMeter (Millimeter mm)			{ return Meter(mm.Value() * M_BY_MM); }
+		constexpr Degree ToDegree (Radian rad)			{ return Degree(rad.Value() * DEG_BY_RAD); }
+		constexpr Radian ToRadian (Degree deg)			{ return Radian(deg.Value() * RAD_BY_DEG); }
+
+		/**
+		 * @class TickScale
+		 * @brief Encoder ticks / length conversion (geometry known at runtime)
+		 */
+		class TickScale
+		{
+		public:
+
+			/**
+			 * @param tickByMm : Encoder ticks by millimeter
+			 */
+			constexpr explicit TickScale (float64_t tickByMm = 1.0) :
+				tickByMm(static_cast<float32_t>(tickByMm)),
+				tickByM(static_cast<float32_t>(tickByMm * 1000.0)),
+				mmByTick(static_cast<float32_t>(1.0 / tickByMm)),
+				mByTick(static_cast<float32_t>(1.0 / (tickByMm * 1000.0)))
+			{
+			}
+
+			constexpr Tick ToTick (Millimeter mm) const		{ return Tick(mm.Value() * this->tickByMm); }
+			constexpr Tick ToTick (Meter m) const			{ return Tick(m.Value() * this->tickByM); }
+			constexpr Millimeter ToMillimeter (Tick t) const	{ return Millimeter(t.Value() * this->mmByTick); }
+			constexpr Meter ToMeter (Tick t) const			{ return Meter(t.Value() * this->mByTick); }
+
+		private:
+
+			float32_t tickByMm;
+			float32_t tickByM;
+			float32_t mmByTick;
+			float32_t mByTick;
+		};
+	}
+}
+
+#endif /* INC_UNITS_HPP_ */
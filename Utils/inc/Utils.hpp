@@ -16,7 +16,29 @@
  */
 
 #include "PID.hpp"
+#include "RelayTuner.hpp"
 #include "Observable.hpp"
 #include "Event.hpp"
+#include "Frame.hpp"
+#include "Profiler.hpp"
+#include "Trace.hpp"
+#include "Crash.hpp"
+#include "Watchdog.hpp"
+#include "Scope.hpp"
+#include "Log.hpp"
+#include "Format.hpp"
+#include "PeriodicTask.hpp"
+#include "Param.hpp"
+#include "Watch.hpp"
+#include "Ring.hpp"
+#include "Pool.hpp"
+#include "Heap.hpp"
+#include "Deferred.hpp"
+#include "Coroutine.hpp"
+#include "FixedTrigo.hpp"
+#include "FastMath.hpp"
+#include "Units.hpp"
+#include "StaticStorage.hpp"
+#include "StaticVector.hpp"
 
 #endif /* INC_UTILS_HPP_ */
@@ -0,0 +1,136 @@
+/**
+ * @file	Watch.hpp
+ * @author	Jeremy ROULLAND
+ * @date	28 oct. 2017
+ * @brief	Watchable variables registry
+ */
+
+#ifndef INC_WATCH_HPP_
+#define INC_WATCH_HPP_
+
+#include "common.h"
+
+/*----------------------------------------------------------------------------*/
+/* Definitions                                                                */
+/*----------------------------------------------------------------------------*/
+
+/**
+ * @brief Maximum number of registered variables
+ */
+#define WATCH_MAX				(48u)
+
+/**
+ * @brief Register a member variable as "<module>.<member>", read only
+ * e.g. WATCH_MEMBER("pc", linearPositionError) or WATCH_MEMBER("od", robot.X)
+ */
+#define WATCH_MEMBER(module, member)		Utils::Watch::Register(module "." #member, &this->member)
+
+/**
+ * @brief Register a member variable as "<module>.<member>", writable with Watch::Poke()
+ */
+#define WATCH_MEMBER_RW(module, member)		Utils::Watch::Register(module "." #member, &this->member, true)
+
+/*----------------------------------------------------------------------------*/
+/* Class declaration	                                                      */
+/*----------------------------------------------------------------------------*/
+
+/**
+ * @namespace Utils
+ */
+namespace Utils
+{
+	/**
+	 * @class Watch
+	 * @brief Registry of variables readable (and writable) at runtime
+	 *
+	 * HOWTO :
+	 * - Owner module registers its variables at init with WATCH_MEMBER() (or
+	 *   Watch::Register() for non member variables)
+	 * - Users (CLI, Diag) look them up with Find() or Count() / index, read them
+	 *   with GetValue() / Format() and write writable ones with Poke()
+	 *
+	 * Reads are lock-free : each variable is a single aligned load, never torn,
+	 * consistent with itself but not with the other variables of its owner.
+	 * Poke() writes with interrupts masked and does not notify the owner, live
+	 * tunable variables belong to Param.
+	 */
+	class Watch
+	{
+	public:
+
+		/**
+		 * @brief Variable type list
+		 */
+		enum TYPE
+		{
+			FLOAT32,		//!< float32_t
+			INT32,			//!< int32_t
+			UINT32,			//!< uint32_t
+			UINT16,			//!< uint16_t (status flags)
+			BOOL,			//!< bool
+		};
+
+		/**
+		 * @brief Register a variable
+		 * @param name : Variable name (static string)
+		 * @param address : Variable
+		 * @param writable : Variable can be written with Poke()
+		 * @return false if the registry is full
+		 */
+		static bool Register (const char * name, volatile float32_t * address, bool writable = false);
+		static bool Register (const char * name, volatile int32_t * address, bool writable = false);
+		static bool Register (const char * name, volatile uint32_t * address, bool writable = false);
+		static bool Register (const char * name, volatile uint16_t * address, bool writable = false);
+		static bool Register (const char * name, volatile bool * address, bool writable = false);
+
+		/**
+		 * @brief Get number of registered variables
+		 */
+		static uint32_t Count ();
+
+		/**
+		 * @brief Find a variable by name
+		 * @param name : Variable name
+		 * @return Index or -1 if not found
+		 */
+		static int32_t Find (const char * name);
+
+		/**
+		 * @brief Get variable name
+		 * @param index : Variable index (< Count())
+		 * @return Name or NULL
+		 */
+		static const char * GetName (uint32_t index);
+
+		/**
+		 * @brief Return true if the variable can be written with Poke()
+		 */
+		static bool IsWritable (uint32_t index);
+
+		/**
+		 * @brief Read a variable
+		 * @param index : Variable index (< Count())
+		 * @return Value, 0 if index is invalid
+		 */
+		static float32_t GetValue (uint32_t index);
+
+		/**
+		 * @brief Format a variable value (integers are exact, status flags in hexadecimal)
+		 * @param index : Variable index (< Count())
+		 * @param buffer : Destination, always NULL terminated
+		 * @param size : Destination size
+		 * @return Formatted length
+		 */
+		static uint32_t Format (uint32_t index, char * buffer, uint32_t size);
+
+		/**
+		 * @brief Write a variable
+		 * @param index : Variable index (< Count())
+		 * @param value : New value (rounded toward zero for integers)
+		 * @return false if index is invalid or variable is read only
+		 */
+		static bool Poke (uint32_t index, float32_t value);
+	};
+}
+
+#endif /* INC_WATCH_HPP_ */
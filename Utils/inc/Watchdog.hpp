@@ -0,0 +1,133 @@
+/**
+ * @file	Watchdog.hpp
+ * @author	Jeremy ROULLAND
+ * @date	15 oct. 2026
+ * @brief	Task health supervisor feeding the independent watchdog (IWDG)
+ */
+
+#ifndef INC_WATCHDOG_HPP_
+#define INC_WATCHDOG_HPP_
+
+#include "common.h"
+
+// FreeRTOS
+#include "FreeRTOS.h"
+#include "task.h"
+
+/*----------------------------------------------------------------------------*/
+/* Definitions                                                                */
+/*----------------------------------------------------------------------------*/
+
+/**
+ * @brief Maximum number of supervised tasks
+ */
+#define WATCHDOG_CLIENTS_MAX	(8u)
+
+/**
+ * @brief IWDG timeout (ms) : reset if the supervisor (tick hook) stops
+ */
+#define WATCHDOG_TIMEOUT_MS		(100u)
+
+/**
+ * @brief Longest hold (ms, IWDG reload maximum)
+ */
+#define WATCHDOG_HOLD_MAX_MS	(4095u)
+
+/*----------------------------------------------------------------------------*/
+/* Class declaration	                                                      */
+/*----------------------------------------------------------------------------*/
+
+/**
+ * @namespace Utils
+ */
+namespace Utils
+{
+	/**
+	 * @class Watchdog
+	 * @brief Kick the IWDG only while every supervised task checks in on time
+	 *
+	 * HOWTO :
+	 * - Critical periodic tasks Register() once with a deadline, then
+	 *   CheckIn() on each period (supervised from their first check in)
+	 * - Start() the IWDG once loops run, call Supervise() from the tick hook
+	 * - Hold() / Release() around operations stalling the CPU (flash erase)
+	 *
+	 * A task late on its deadline is recorded as a crash (Utils::Crash, task
+	 * name, age in R0) and the board resets at once. If the tick hook itself
+	 * stops (interrupts masked, interrupt storm), the IWDG resets it after
+	 * WATCHDOG_TIMEOUT_MS. Both recover in a boot time, not a power cycle.
+	 */
+	class Watchdog
+	{
+	public:
+
+		/**
+		 * @brief Start the IWDG (cannot be stopped, frozen while debugging)
+		 * @param timeout : IWDG timeout (ms, <= WATCHDOG_HOLD_MAX_MS)
+		 */
+		static void Start (uint32_t timeout = WATCHDOG_TIMEOUT_MS);
+
+		/**
+		 * @brief Return true once started
+		 */
+		static bool IsStarted ();
+
+		/**
+		 * @brief Register a supervised task
+		 * @param name : Task name (static string)
+		 * @param deadline : Longest time between two check ins (ms)
+		 * @return Client index, -1 if full
+		 */
+		static int32_t Register (const char * name, uint32_t deadline);
+
+		/**
+		 * @brief Task alive (task context)
+		 * @param index : Client index (Register(), negative ignored)
+		 */
+		static void CheckIn (int32_t index);
+
+		/**
+		 * @brief Check deadlines, kick the IWDG (tick hook)
+		 */
+		static void Supervise ();
+
+		/**
+		 * @brief Suspend supervision, IWDG timeout extended (CPU stalling operation)
+		 * @param duration : Longest duration (ms, <= WATCHDOG_HOLD_MAX_MS)
+		 */
+		static void Hold (uint32_t duration);
+
+		/**
+		 * @brief Resume supervision, deadlines restart from now
+		 */
+		static void Release ();
+
+		/**
+		 * @brief Return true if the last reset was an IWDG timeout
+		 */
+		static bool WasReset ();
+
+		/**
+		 * @brief Get number of registered clients
+		 */
+		static uint32_t Count ();
+
+		/**
+		 * @brief Get client name, deadline (ms) and time since its last check in (ms, 0 if never)
+		 */
+		static const char * GetName (uint32_t index);
+		static uint32_t GetDeadline (uint32_t index);
+		static uint32_t GetAge (uint32_t index);
+
+	protected:
+
+		/**
+		 * @protected
+		 * @brief Write IWDG reload value and reload the counter
+		 * @param timeout : Timeout (ms)
+		 */
+		static void reload (uint32_t timeout);
+	};
+}
+
+#endif /* INC_WATCHDOG_HPP_ */
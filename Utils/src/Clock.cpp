@@ -0,0 +1,49 @@
+/**
+ * @file	Clock.cpp
+ * @author	Jeremy ROULLAND
+ * @date	21 oct. 2017
+ * @brief	Monotonic microsecond clock
+ */
+
+#include "Clock.hpp"
+
+/*----------------------------------------------------------------------------*/
+/* Private Members                                                            */
+/*----------------------------------------------------------------------------*/
+
+/**
+ * @brief Last cycle counter read, cycles not converted yet and microseconds
+ */
+static uint32_t _lastCycles = 0u;
+static uint32_t _remainder = 0u;
+static uint64_t _us = 0u;
+
+/*----------------------------------------------------------------------------*/
+/* Class Implementation	                                                      */
+/*----------------------------------------------------------------------------*/
+
+namespace Utils
+{
+	uint64_t Clock::GetMicros64 ()
+	{
+		uint32_t cycles, elapsed, primask;
+		uint32_t cyclesPerUs = SystemCoreClock / 1000000u;
+		uint64_t us;
+
+		primask = __get_PRIMASK();
+		__disable_irq();
+
+		// Elapsed cycles since last read (less than one CYCCNT wrap), remainder kept
+		cycles = DWT->CYCCNT;
+		elapsed = (cycles - _lastCycles) + _remainder;
+		_lastCycles = cycles;
+
+		_us += elapsed / cyclesPerUs;
+		_remainder = elapsed % cyclesPerUs;
+		us = _us;
+
+		__set_PRIMASK(primask);
+
+		return us;
+	}
+}
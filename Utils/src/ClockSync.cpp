@@ -0,0 +1,207 @@
+/**
+ * @file	ClockSync.cpp
+ * @author	Jeremy ROULLAND
+ * @date	23 oct. 2017
+ * @brief	Main board clock synchronization
+ */
+
+#include "ClockSync.hpp"
+
+/*----------------------------------------------------------------------------*/
+/* Definitions                                                                */
+/*----------------------------------------------------------------------------*/
+
+/**
+ * @brief Loop gains : offset and drift correction by sample error
+ */
+#define CLOCKSYNC_OFFSET_GAIN	(0.5f)
+#define CLOCKSYNC_DRIFT_GAIN	(0.25f)
+
+/*----------------------------------------------------------------------------*/
+/* Private Members                                                            */
+/*----------------------------------------------------------------------------*/
+
+/**
+ * @brief Last sample local time, offset (master - local) at this time, drift
+ */
+static uint32_t _ref = 0u;
+static int32_t _offset = 0;
+static float32_t _drift = 0.0f;
+
+/**
+ * @brief Last sample error, samples since start, consecutive locked samples and rejects
+ */
+static int32_t _error = 0;
+static uint32_t _samples = 0u;
+static uint32_t _locked = 0u;
+static uint32_t _rejected = 0u;
+static uint32_t _rejects = 0u;
+
+/*----------------------------------------------------------------------------*/
+/* Private Functions                                                          */
+/*----------------------------------------------------------------------------*/
+
+/**
+ * @brief Estimated offset at a local time (interrupts disabled)
+ */
+static int32_t _offsetAt (uint32_t local)
+{
+	int32_t elapsed = (int32_t)(local - _ref);
+
+	return _offset + (int32_t)(_drift * (float32_t)elapsed);
+}
+
+static int32_t _abs (int32_t v)
+{
+	return (v < 0) ? -v : v;
+}
+
+/*----------------------------------------------------------------------------*/
+/* Class Implementation	                                                      */
+/*----------------------------------------------------------------------------*/
+
+namespace Utils
+{
+	void ClockSync::Sample (uint32_t master, uint32_t local)
+	{
+		int32_t error, elapsed;
+		uint32_t primask;
+
+		primask = __get_PRIMASK();
+		__disable_irq();
+
+		if(_samples == 0u)
+		{
+			// First sample : offset only
+			_offset = (int32_t)(master - local);
+			_drift = 0.0f;
+			_error = 0;
+			_ref = local;
+			_samples = 1u;
+		}
+		else
+		{
+			elapsed = (int32_t)(local - _ref);
+			error = (int32_t)(master - (local + (uint32_t)_offsetAt(local)));
+
+			if((_locked >= CLOCKSYNC_LOCK_SAMPLES) && (_abs(error) > CLOCKSYNC_OUTLIER_US))
+			{
+				// Outlier, or main board clock restarted
+				_rejects++;
+				if(++_rejected >= CLOCKSYNC_REJECT_MAX)
+				{
+					_offset = (int32_t)(master - local);
+					_drift = 0.0f;
+					_ref = local;
+					_locked = 0u;
+					_rejected = 0u;
+				}
+			}
+			else if(elapsed > 0)
+			{
+				_rejected = 0u;
+				_error = error;
+
+				_offset = _offsetAt(local) + (int32_t)(CLOCKSYNC_OFFSET_GAIN * (float32_t)error);
+				_drift += CLOCKSYNC_DRIFT_GAIN * (float32_t)error / (float32_t)elapsed;
+				_ref = local;
+
+				if(_drift > CLOCKSYNC_DRIFT_MAX)
+					_drift = CLOCKSYNC_DRIFT_MAX;
+				else if(_drift < -CLOCKSYNC_DRIFT_MAX)
+					_drift = -CLOCKSYNC_DRIFT_MAX;
+
+				if(_abs(error) <= CLOCKSYNC_LOCK_US)
+				{
+					if(_locked < CLOCKSYNC_LOCK_SAMPLES)
+						_locked++;
+				}
+				else if(_locked < CLOCKSYNC_LOCK_SAMPLES)
+				{
+					_locked = 0u;
+				}
+
+				_samples++;
+			}
+		}
+
+		__set_PRIMASK(primask);
+	}
+
+	void ClockSync::Reset ()
+	{
+		uint32_t primask;
+
+		primask = __get_PRIMASK();
+		__disable_irq();
+
+		_offset = 0;
+		_drift = 0.0f;
+		_error = 0;
+		_samples = 0u;
+		_locked = 0u;
+		_rejected = 0u;
+
+		__set_PRIMASK(primask);
+	}
+
+	bool ClockSync::IsSynchronized ()
+	{
+		return (_locked >= CLOCKSYNC_LOCK_SAMPLES);
+	}
+
+	uint32_t ClockSync::ToMaster (uint32_t local)
+	{
+		uint32_t master, primask;
+
+		primask = __get_PRIMASK();
+		__disable_irq();
+
+		master = local + (uint32_t)_offsetAt(local);
+
+		__set_PRIMASK(primask);
+
+		return master;
+	}
+
+	uint32_t ClockSync::ToLocal (uint32_t master)
+	{
+		uint32_t local, primask;
+
+		primask = __get_PRIMASK();
+		__disable_irq();
+
+		// Offset at the first guess, drift is small enough for one iteration
+		local = master - (uint32_t)_offset;
+		local = master - (uint32_t)_offsetAt(local);
+
+		__set_PRIMASK(primask);
+
+		return local;
+	}
+
+	int32_t ClockSync::GetOffset ()
+	{
+		return _offset;
+	}
+
+	float32_t ClockSync::GetDrift ()
+	{
+		return _drift * 1.0e6f;
+	}
+
+	int32_t ClockSync::GetError ()
+	{
+		return _error;
+	}
+
+	uint32_t ClockSync::GetSamples ()
+	{
+		return _samples;
+	}
+
+	uint32_t ClockSync::GetRejects ()
+	{
+		return _rejects;
+	}
+}
@@ -0,0 +1,198 @@
+/**
+ * @file	Crash.cpp
+ * @author	Jeremy ROULLAND
+ * @date	15 oct. 2026
+ * @brief	Crash recorder (fault state kept in no-init RAM across reset)
+ */
+
+#include "Crash.hpp"
+#include "stm32f4xx.h"
+
+#include "task.h"
+
+#include <stddef.h>
+#include <string.h>
+
+/*----------------------------------------------------------------------------*/
+/* Definitions                                                                */
+/*----------------------------------------------------------------------------*/
+
+/**
+ * @brief Record states : crash recorded, or only count valid (armed)
+ */
+#define CRASH_MAGIC_RECORD		(0xC4A5B00Cu)
+#define CRASH_MAGIC_ARMED		(0xC4A5A4EDu)
+
+/*----------------------------------------------------------------------------*/
+/* Private Members                                                            */
+/*----------------------------------------------------------------------------*/
+
+/**
+ * @brief Record written by the crashed run (not cleared by the startup code)
+ */
+static CRASH_RECORD _crash __attribute__((section(".noinit")));
+
+/**
+ * @brief Previous run record, valid if _lastValid
+ */
+static CRASH_RECORD _last;
+static bool _lastValid = false;
+
+static const char* _causeNames[Utils::Crash::CAUSE_MAX] =
+{
+	"none",
+	"hard fault",
+	"memory fault",
+	"bus fault",
+	"usage fault",
+	"stack overflow",
+	"assert",
+	"watchdog",
+};
+
+/*----------------------------------------------------------------------------*/
+/* Private Functions                                                          */
+/*----------------------------------------------------------------------------*/
+
+/**
+ * @brief Record checksum (words sum, CHECK excluded)
+ */
+static uint32_t _checksum (const CRASH_RECORD* r)
+{
+	const uint32_t* w = reinterpret_cast<const uint32_t*>(r);
+	uint32_t sum = 0x5A5A5A5Au;
+
+	for(uint32_t i = 0u; i < (offsetof(CRASH_RECORD, CHECK) / sizeof(uint32_t)); i++)
+		sum = (sum << 1u | sum >> 31u) + w[i];
+
+	return sum;
+}
+
+/*----------------------------------------------------------------------------*/
+/* Class Implementation	                                                      */
+/*----------------------------------------------------------------------------*/
+
+namespace Utils
+{
+	void Crash::Init ()
+	{
+		uint32_t count = 0u;
+
+		if((_crash.MAGIC == CRASH_MAGIC_RECORD) && (_crash.CHECK == _checksum(&_crash)))
+		{
+			_last = _crash;
+			_lastValid = true;
+			count = _crash.COUNT;
+		}
+		else if(_crash.MAGIC == CRASH_MAGIC_ARMED)
+		{
+			// Reset without crash (button, watchdog, software)
+			count = _crash.COUNT;
+		}
+
+		memset(&_crash, 0, sizeof(_crash));
+		_crash.COUNT = count;
+		_crash.MAGIC = CRASH_MAGIC_ARMED;
+
+		// Precise causes instead of escalated hard faults
+		SCB->SHCSR |= SCB_SHCSR_USGFAULTENA_Msk | SCB_SHCSR_BUSFAULTENA_Msk | SCB_SHCSR_MEMFAULTENA_Msk;
+	}
+
+	void Crash::Fault (const uint32_t* frame, uint32_t excReturn)
+	{
+		enum CAUSE cause;
+
+		switch(__get_IPSR() & 0x1FFu)
+		{
+			case 4u:	cause = MEM_MANAGE;		break;
+			case 5u:	cause = BUS_FAULT;		break;
+			case 6u:	cause = USAGE_FAULT;	break;
+			default:	cause = HARD_FAULT;		break;
+		}
+
+		_crash.R0  = frame[0];
+		_crash.R1  = frame[1];
+		_crash.R2  = frame[2];
+		_crash.R3  = frame[3];
+		_crash.R12 = frame[4];
+		_crash.LR  = frame[5];
+		_crash.PC  = frame[6];
+		_crash.PSR = frame[7];
+		_crash.SP  = reinterpret_cast<uint32_t>(frame);
+		_crash.EXC_RETURN = excReturn;
+
+		// Crashed context : interrupt if the frame was stacked in handler mode
+		_crash.EXCEPTION = _crash.PSR & 0x1FFu;
+
+		record(cause, NULL);
+	}
+
+	void Crash::Abort (enum CAUSE cause, const char* task, uint32_t arg)
+	{
+		__disable_irq();
+
+		memset(&_crash.R0, 0, (offsetof(CRASH_RECORD, EXC_RETURN) + sizeof(uint32_t)) - offsetof(CRASH_RECORD, R0));
+		_crash.R0 = arg;
+		_crash.PC = reinterpret_cast<uint32_t>(__builtin_return_address(0));
+		_crash.EXCEPTION = __get_IPSR() & 0x1FFu;
+
+		record(cause, task);
+	}
+
+	void Crash::record (enum CAUSE cause, const char* task)
+	{
+		uint32_t count;
+
+		__disable_irq();
+
+		_crash.CAUSE = cause;
+		_crash.COUNT = ((_crash.MAGIC == CRASH_MAGIC_ARMED) ? _crash.COUNT : 0u) + 1u;
+		_crash.TICK = xTaskGetTickCount();
+
+		_crash.CFSR  = SCB->CFSR;
+		_crash.HFSR  = SCB->HFSR;
+		_crash.MMFAR = SCB->MMFAR;
+		_crash.BFAR  = SCB->BFAR;
+
+		// Task running when the crashed context was entered
+		memset(_crash.TASK, 0, sizeof(_crash.TASK));
+		if((task == NULL) && (_crash.EXCEPTION == 0u) && (xTaskGetSchedulerState() != taskSCHEDULER_NOT_STARTED))
+			task = pcTaskGetName(NULL);
+		if(task != NULL)
+			strncpy(_crash.TASK, task, sizeof(_crash.TASK) - 1u);
+
+		// Last events before the crash
+		count = Trace::Count();
+		_crash.TRACES = (count < CRASH_TRACES) ? count : CRASH_TRACES;
+		for(uint32_t i = 0u; i < _crash.TRACES; i++)
+			_crash.TRACE[i] = *Trace::Get(count - _crash.TRACES + i);
+
+		_crash.MAGIC = CRASH_MAGIC_RECORD;
+		_crash.CHECK = _checksum(&_crash);
+
+		__DSB();
+		NVIC_SystemReset();
+
+		for(;;);
+	}
+
+	const CRASH_RECORD* Crash::GetLast ()
+	{
+		return _lastValid ? &_last : NULL;
+	}
+
+	void Crash::Clear ()
+	{
+		_lastValid = false;
+	}
+
+	uint32_t Crash::GetCount ()
+	{
+		return _crash.COUNT;
+	}
+
+	const char* Crash::GetCauseName (uint32_t cause)
+	{
+		return (cause < CAUSE_MAX) ? _causeNames[cause] : "unknown";
+	}
+}
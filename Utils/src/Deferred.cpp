@@ -0,0 +1,158 @@
+/**
+ * @file	Deferred.cpp
+ * @author	Jeremy ROULLAND
+ * @date	15 oct. 2026
+ * @brief	Deferred interrupt work (interrupt to worker task)
+ */
+
+#include "Deferred.hpp"
+#include "stm32f4xx.h"
+
+#include <stddef.h>
+
+/*----------------------------------------------------------------------------*/
+/* Definitions                                                                */
+/*----------------------------------------------------------------------------*/
+
+// Worker is woken from an unused vector, below configMAX_SYSCALL
+#define DEFERRED_IRQ			(SPDIF_RX_IRQn)
+#define DEFERRED_IRQ_PRIORITY	(11u)
+
+/*----------------------------------------------------------------------------*/
+/* Private Members                                                            */
+/*----------------------------------------------------------------------------*/
+
+/**
+ * @brief Pending jobs by priority
+ */
+static Utils::MpscRing<Utils::Deferred::Work*, DEFERRED_QUEUE_SIZE> _queue[Utils::Deferred::PRIORITY_MAX];
+
+/**
+ * @brief Worker task (NULL until started)
+ */
+static volatile TaskHandle_t _worker = NULL;
+
+/**
+ * @brief Statistics
+ */
+static volatile uint32_t _executed = 0u;
+static volatile uint32_t _dropped = 0u;
+
+/*----------------------------------------------------------------------------*/
+/* Class Implementation	                                                      */
+/*----------------------------------------------------------------------------*/
+
+namespace Utils
+{
+	Deferred::Work::Work (Observer::ObserverCallback cb, void * obj, enum Priority priority)
+	{
+		assert(priority < PRIORITY_MAX);
+
+		this->cb = cb;
+		this->obj = obj;
+		this->priority = priority;
+		this->pending = 0u;
+		this->coalesced = 0u;
+	}
+
+	bool Deferred::Work::Post ()
+	{
+		// Already queued : runs once
+		do
+		{
+			if(__LDREXW(&this->pending) != 0u)
+			{
+				__CLREX();
+				this->coalesced = this->coalesced + 1u;
+				return false;
+			}
+		}
+		while(__STREXW(1u, &this->pending) != 0u);
+
+		if(!_queue[this->priority].Push(this))
+		{
+			this->pending = 0u;
+			_dropped = _dropped + 1u;
+			return false;
+		}
+
+		NVIC_SetPendingIRQ(DEFERRED_IRQ);
+
+		return true;
+	}
+
+	void Deferred::Task (void * param)
+	{
+		_worker = xTaskGetCurrentTaskHandle();
+
+		NVIC_SetPriority(DEFERRED_IRQ, DEFERRED_IRQ_PRIORITY);
+		NVIC_EnableIRQ(DEFERRED_IRQ);
+
+		// Jobs posted before start run first
+		for(;;)
+		{
+			run();
+			ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+		}
+	}
+
+	uint32_t Deferred::GetExecuted ()
+	{
+		return _executed;
+	}
+
+	uint32_t Deferred::GetDropped ()
+	{
+		return _dropped;
+	}
+
+	void Deferred::INTERNAL_Wake ()
+	{
+		BaseType_t woken = pdFALSE;
+
+		if(_worker != NULL)
+			vTaskNotifyGiveFromISR(_worker, &woken);
+
+		portYIELD_FROM_ISR(woken);
+	}
+
+	void Deferred::run ()
+	{
+		Work* work = NULL;
+		uint32_t p;
+
+		for(;;)
+		{
+			// Highest priority first, checked again after each job
+			for(p = 0u; p < PRIORITY_MAX; p++)
+			{
+				if(_queue[p].Pop(work))
+					break;
+			}
+
+			if(p == PRIORITY_MAX)
+				return;
+
+			// Cleared first : a post during the job queues it again
+			work->pending = 0u;
+			work->cb(work->obj);
+
+			_executed = _executed + 1u;
+		}
+	}
+}
+
+/*----------------------------------------------------------------------------*/
+/* Interrupt Handler                                                          */
+/*----------------------------------------------------------------------------*/
+
+extern "C"
+{
+	/**
+	 * @brief Deferred work software interrupt
+	 */
+	void SPDIF_RX_IRQHandler (void)
+	{
+		Utils::Deferred::INTERNAL_Wake();
+	}
+}
@@ -1,41 +0,0 @@
-/**
- * @file	Event.cpp
- * @author	Kevin WYSOCKI
- * @date	24 nov. 2016
- * @brief	Event class
- */
-
-#include "Event.hpp"
-
-/*----------------------------------------------------------------------------*/
-/* Definitions                                                                */
-/*----------------------------------------------------------------------------*/
-
-/*----------------------------------------------------------------------------*/
-/* Private Members                                                            */
-/*----------------------------------------------------------------------------*/
-
-/*----------------------------------------------------------------------------*/
-/* Private Functions                                                          */
-/*----------------------------------------------------------------------------*/
-
-/*----------------------------------------------------------------------------*/
-/* Class Implementation	                                                      */
-/*----------------------------------------------------------------------------*/
-
-namespace Utils
-{
-Event& Event::operator +=(EventCallback cb)
-	{
-		this->Subscribe(NULL, cb);
-
-		return *this;
-	}
-
-	Event& Event::operator -= (EventCallback cb)
-	{
-		this->Unsubscribe(NULL, cb);
-
-		return *this;
-	}
-}
@@ -0,0 +1,150 @@
+/**
+ * @file	FastMath.cpp
+ * @author	Jeremy ROULLAND
+ * @date	15 oct. 2026
+ * @brief	Single precision math (FPU instructions, polynomials)
+ */
+
+#include "FastMath.hpp"
+
+/*----------------------------------------------------------------------------*/
+/* Definitions                                                                */
+/*----------------------------------------------------------------------------*/
+
+/**
+ * @brief PI/2 split in three parts : quadrant reduction keeps full precision
+ */
+#define PI_2_HI				(1.5703125f)
+#define PI_2_MID			(4.83751296997070312500e-4f)
+#define PI_2_LO				(7.54978995489188216e-8f)
+
+#define TAN_PI_8			(0.414213562373095f)
+#define PI_4				(0.785398163397448f)
+
+/*----------------------------------------------------------------------------*/
+/* Private Functions                                                          */
+/*----------------------------------------------------------------------------*/
+
+/**
+ * @brief Sine on [-PI/4; PI/4]
+ */
+static inline float32_t _sin (float32_t x)
+{
+	float32_t z = x * x;
+
+	return x + x * z * ((-1.9515295891e-4f * z + 8.3321608736e-3f) * z - 1.6666654611e-1f);
+}
+
+/**
+ * @brief Cosine on [-PI/4; PI/4]
+ */
+static inline float32_t _cos (float32_t x)
+{
+	float32_t z = x * x;
+
+	return 1.0f - 0.5f * z + z * z * ((2.443315711809948e-5f * z - 1.388731625493765e-3f) * z + 4.166664568298827e-2f);
+}
+
+/**
+ * @brief Arc tangent on [0; tan(PI/8)]
+ */
+static inline float32_t _atan (float32_t x)
+{
+	float32_t z = x * x;
+
+	return x + x * z * (((8.05374449538e-2f * z - 1.38776856032e-1f) * z + 1.99777106478e-1f) * z - 3.33329491539e-1f);
+}
+
+/*----------------------------------------------------------------------------*/
+/* Functions Implementation                                                   */
+/*----------------------------------------------------------------------------*/
+
+namespace Utils
+{
+	void SinCos (float32_t angle, float32_t * sin, float32_t * cos)
+	{
+		float32_t q = angle * (1.0f / FASTMATH_PI_2);
+		int32_t quadrant = static_cast<int32_t>(q + ((q >= 0.0f) ? 0.5f : -0.5f));
+		float32_t j = static_cast<float32_t>(quadrant);
+		float32_t x, s, c;
+
+		x = ((angle - j * PI_2_HI) - j * PI_2_MID) - j * PI_2_LO;
+
+		s = _sin(x);
+		c = _cos(x);
+
+		switch(quadrant & 3)
+		{
+		case 0:
+			*sin = s;
+			*cos = c;
+			break;
+		case 1:
+			*sin = c;
+			*cos = -s;
+			break;
+		case 2:
+			*sin = -s;
+			*cos = -c;
+			break;
+		default:
+			*sin = -c;
+			*cos = s;
+			break;
+		}
+	}
+
+	float32_t Sin (float32_t angle)
+	{
+		float32_t s, c;
+
+		SinCos(angle, &s, &c);
+
+		return s;
+	}
+
+	float32_t Cos (float32_t angle)
+	{
+		float32_t s, c;
+
+		SinCos(angle, &s, &c);
+
+		return c;
+	}
+
+	float32_t Tan (float32_t angle)
+	{
+		float32_t s, c;
+
+		SinCos(angle, &s, &c);
+
+		return s / c;
+	}
+
+	float32_t Atan2 (float32_t y, float32_t x)
+	{
+		float32_t ax = fabsf(x);
+		float32_t ay = fabsf(y);
+		float32_t t, a;
+		bool swap;
+
+		if((ax == 0.0f) && (ay == 0.0f))
+			return 0.0f;
+
+		// Ratio in [0; 1]
+		swap = (ay > ax);
+		t = swap ? (ax / ay) : (ay / ax);
+
+		if(t > TAN_PI_8)
+			a = PI_4 + _atan((t - 1.0f) / (t + 1.0f));
+		else
+			a = _atan(t);
+
+		if(swap)
+			a = FASTMATH_PI_2 - a;
+		if(x < 0.0f)
+			a = FASTMATH_PI - a;
+
+		return (y < 0.0f) ? -a : a;
+	}
+}
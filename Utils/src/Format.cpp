@@ -0,0 +1,301 @@
+/**
+ * @file	Format.cpp
+ * @author	Jeremy ROULLAND
+ * @date	22 oct. 2017
+ * @brief	Minimal printf-like formatter (no float library)
+ */
+
+#include "Format.hpp"
+
+#include <stdio.h>
+#include <stddef.h>
+#include <string.h>
+
+/*----------------------------------------------------------------------------*/
+/* Private Types                                                              */
+/*----------------------------------------------------------------------------*/
+
+/**
+ * @brief Output buffer state
+ */
+typedef struct
+{
+	char * data;
+	uint32_t size;
+	uint32_t length;
+}FORMAT_OUTPUT;
+
+/**
+ * @brief Conversion specification
+ */
+typedef struct
+{
+	bool left;			/**< '-' flag */
+	char pad;			/**< ' ' or '0' */
+	uint32_t width;
+}FORMAT_SPEC;
+
+/*----------------------------------------------------------------------------*/
+/* Private Members                                                            */
+/*----------------------------------------------------------------------------*/
+
+static const uint32_t _pow10[FORMAT_MAX_DECIMALS + 1u] = {1u, 10u, 100u, 1000u, 10000u, 100000u, 1000000u};
+
+/*----------------------------------------------------------------------------*/
+/* Private Functions                                                          */
+/*----------------------------------------------------------------------------*/
+
+/**
+ * @brief Append one character (dropped if buffer is full)
+ */
+static inline void _put (FORMAT_OUTPUT* out, char c)
+{
+	if((out->length + 1u) < out->size)
+		out->data[out->length] = c;
+	out->length++;
+}
+
+/**
+ * @brief Append a field with padding
+ * @param text : Field characters
+ * @param length : Field length
+ * @param sign : Sign character or 0 (kept before zero padding)
+ */
+static void _field (FORMAT_OUTPUT* out, const FORMAT_SPEC* spec, const char* text, uint32_t length, char sign)
+{
+	uint32_t total = length + ((sign != 0) ? 1u : 0u);
+	uint32_t padding = (spec->width > total) ? (spec->width - total) : 0u;
+
+	if(!spec->left && (spec->pad == ' '))
+		while(padding > 0u) { _put(out, ' '); padding--; }
+
+	if(sign != 0)
+		_put(out, sign);
+
+	if(!spec->left)
+		while(padding > 0u) { _put(out, '0'); padding--; }
+
+	for(uint32_t i = 0; i < length; i++)
+		_put(out, text[i]);
+
+	while(padding > 0u) { _put(out, ' '); padding--; }
+}
+
+/**
+ * @brief Convert an unsigned value to digits (reversed in tmp)
+ * @return Digits count
+ */
+static uint32_t _digits (char* tmp, uint32_t value, uint32_t base, bool upper, uint32_t min)
+{
+	const char* digits = upper ? "0123456789ABCDEF" : "0123456789abcdef";
+	uint32_t n = 0;
+
+	do
+	{
+		tmp[n++] = digits[value % base];
+		value /= base;
+	}while((value != 0u) || (n < min));
+
+	return n;
+}
+
+/**
+ * @brief Append an unsigned value
+ */
+static void _unsigned (FORMAT_OUTPUT* out, const FORMAT_SPEC* spec, uint32_t value, uint32_t base, bool upper, char sign)
+{
+	char tmp[12], text[12];
+	uint32_t n = _digits(tmp, value, base, upper, 1u);
+
+	for(uint32_t i = 0; i < n; i++)
+		text[i] = tmp[n - 1u - i];
+
+	_field(out, spec, text, n, sign);
+}
+
+/**
+ * @brief Append a fixed point decimal
+ */
+static void _fixed (FORMAT_OUTPUT* out, const FORMAT_SPEC* spec, float32_t value, uint32_t decimals)
+{
+	char tmp[24], text[24];
+	char sign = 0;
+	uint64_t scaled;
+	uint32_t integer, fraction, n = 0, length = 0;
+
+	if(value < 0.0f)
+	{
+		sign = '-';
+		value = -value;
+	}
+
+	// Rounded, integer and fraction parts split without float formatting
+	scaled = (uint64_t)(value * (float32_t)_pow10[decimals] + 0.5f);
+	integer = (uint32_t)(scaled / _pow10[decimals]);
+	fraction = (uint32_t)(scaled % _pow10[decimals]);
+
+	if(decimals > 0u)
+	{
+		n = _digits(tmp, fraction, 10u, false, decimals);
+		tmp[n++] = '.';
+	}
+	n += _digits(&tmp[n], integer, 10u, false, 1u);
+
+	for(uint32_t i = 0; i < n; i++)
+		text[length++] = tmp[n - 1u - i];
+
+	_field(out, spec, text, length, sign);
+}
+
+/*----------------------------------------------------------------------------*/
+/* Functions Implementation                                                   */
+/*----------------------------------------------------------------------------*/
+
+namespace Utils
+{
+	uint32_t FormatV (char * buffer, uint32_t size, const char * fmt, va_list args)
+	{
+		FORMAT_OUTPUT out;
+		FORMAT_SPEC spec;
+		uint32_t precision;
+		int32_t value;
+		const char* s;
+		char c;
+
+		assert((buffer != NULL) && (size > 0u));
+
+		out.data = buffer;
+		out.size = size;
+		out.length = 0;
+
+		while(*fmt != '\0')
+		{
+			if(*fmt != '%')
+			{
+				_put(&out, *fmt++);
+				continue;
+			}
+			fmt++;
+
+			// Flags, width, precision, length
+			spec.left = false;
+			spec.pad = ' ';
+			spec.width = 0;
+			precision = FORMAT_MAX_DECIMALS;
+
+			for(;; fmt++)
+			{
+				if(*fmt == '-')
+					spec.left = true;
+				else if(*fmt == '0')
+					spec.pad = '0';
+				else
+					break;
+			}
+
+			while((*fmt >= '0') && (*fmt <= '9'))
+				spec.width = spec.width * 10u + (uint32_t)(*fmt++ - '0');
+
+			if(*fmt == '.')
+			{
+				fmt++;
+				precision = 0;
+				while((*fmt >= '0') && (*fmt <= '9'))
+					precision = precision * 10u + (uint32_t)(*fmt++ - '0');
+				if(precision > FORMAT_MAX_DECIMALS)
+					precision = FORMAT_MAX_DECIMALS;
+			}
+
+			while((*fmt == 'l') || (*fmt == 'h'))
+				fmt++;
+
+			switch(*fmt)
+			{
+			case 'd':
+			case 'i':
+				value = va_arg(args, int32_t);
+				if(value < 0)
+					_unsigned(&out, &spec, (uint32_t)(-(value + 1)) + 1u, 10u, false, '-');
+				else
+					_unsigned(&out, &spec, (uint32_t)value, 10u, false, 0);
+				break;
+
+			case 'u':
+				_unsigned(&out, &spec, va_arg(args, uint32_t), 10u, false, 0);
+				break;
+
+			case 'x':
+			case 'X':
+				_unsigned(&out, &spec, va_arg(args, uint32_t), 16u, (*fmt == 'X'), 0);
+				break;
+
+			case 'p':
+				_put(&out, '0');
+				_put(&out, 'x');
+				_unsigned(&out, &spec, (uint32_t)(uintptr_t)va_arg(args, void*), 16u, false, 0);
+				break;
+
+			case 'f':
+				// float arguments are promoted to double
+				_fixed(&out, &spec, (float32_t)va_arg(args, double), precision);
+				break;
+
+			case 'c':
+				c = (char)va_arg(args, int);
+				_field(&out, &spec, &c, 1u, 0);
+				break;
+
+			case 's':
+				s = va_arg(args, const char*);
+				if(s == NULL)
+					s = "(null)";
+				_field(&out, &spec, s, strlen(s), 0);
+				break;
+
+			case '%':
+				_put(&out, '%');
+				break;
+
+			default:
+				// Unsupported conversion : printed as is
+				_put(&out, '%');
+				if(*fmt != '\0')
+					_put(&out, *fmt);
+				break;
+			}
+
+			if(*fmt != '\0')
+				fmt++;
+		}
+
+		buffer[(out.length < size) ? out.length : (size - 1u)] = '\0';
+
+		return (out.length < size) ? out.length : (size - 1u);
+	}
+
+	uint32_t Format (char * buffer, uint32_t size, const char * fmt, ...)
+	{
+		va_list args;
+		uint32_t length;
+
+		va_start(args, fmt);
+		length = FormatV(buffer, size, fmt, args);
+		va_end(args);
+
+		return length;
+	}
+
+	void Print (const char * fmt, ...)
+	{
+		char line[FORMAT_PRINT_SIZE];
+		va_list args;
+		uint32_t length;
+
+		va_start(args, fmt);
+		length = FormatV(line, sizeof(line), fmt, args);
+		va_end(args);
+
+		// Through stdout buffer : keeps order with putchar() output
+		fwrite(line, 1u, length, stdout);
+	}
+}
@@ -0,0 +1,91 @@
+/**
+ * @file	Frame.cpp
+ * @author	Jeremy ROULLAND
+ * @date	14 oct. 2017
+ * @brief	Binary frame helpers (CRC, COBS)
+ */
+
+#include "Frame.hpp"
+
+/*----------------------------------------------------------------------------*/
+/* Functions Implementation                                                   */
+/*----------------------------------------------------------------------------*/
+
+namespace Utils
+{
+	uint16_t Crc16 (const uint8_t * buffer, uint32_t length, uint16_t crc)
+	{
+		uint32_t i = 0;
+		uint8_t bit = 0;
+
+		for(i = 0; i < length; i++)
+		{
+			crc ^= (uint16_t)buffer[i] << 8;
+
+			for(bit = 0; bit < 8; bit++)
+			{
+				if(crc & 0x8000u)
+					crc = (crc << 1) ^ 0x1021u;
+				else
+					crc = crc << 1;
+			}
+		}
+
+		return crc;
+	}
+
+	uint8_t Crc8 (const uint8_t * buffer, uint32_t length, uint8_t crc)
+	{
+		uint32_t i = 0;
+		uint8_t bit = 0;
+
+		for(i = 0; i < length; i++)
+		{
+			crc ^= buffer[i];
+
+			for(bit = 0; bit < 8; bit++)
+			{
+				if(crc & 0x80u)
+					crc = (crc << 1) ^ 0x07u;
+				else
+					crc = crc << 1;
+			}
+		}
+
+		return crc;
+	}
+
+	uint32_t CobsEncode (const uint8_t * in, uint32_t length, uint8_t * out)
+	{
+		uint32_t rd = 0, wr = 1, codeIndex = 0;
+		uint8_t code = 1;
+
+		for(rd = 0; rd < length; rd++)
+		{
+			if(in[rd] == FRAME_DELIMITER)
+			{
+				out[codeIndex] = code;
+				codeIndex = wr++;
+				code = 1;
+			}
+			else
+			{
+				out[wr++] = in[rd];
+				code++;
+
+				// Block full, start a new one
+				if(code == 0xFFu)
+				{
+					out[codeIndex] = code;
+					codeIndex = wr++;
+					code = 1;
+				}
+			}
+		}
+
+		out[codeIndex] = code;
+		out[wr++] = FRAME_DELIMITER;
+
+		return wr;
+	}
+}
@@ -0,0 +1,264 @@
+/**
+ * @file	Heap.cpp
+ * @author	Jeremy ROULLAND
+ * @date	15 oct. 2026
+ * @brief	Single allocator route (new, malloc, kernel) with per-module statistics
+ */
+
+#include "Heap.hpp"
+
+#include "FreeRTOS.h"
+#include "task.h"
+
+#include <new>
+#include <string.h>
+
+struct _reent;
+
+/*----------------------------------------------------------------------------*/
+/* Definitions                                                                */
+/*----------------------------------------------------------------------------*/
+
+/**
+ * @brief Block header (keeps 8 bytes alignment of the block)
+ */
+typedef struct
+{
+	uint32_t	size;
+	uint32_t	tag;
+}HEAP_HEADER;
+
+static_assert(sizeof(HEAP_HEADER) == 8u, "Heap header breaks 8 bytes alignment");
+
+#define HEAP_TAG_OTHER			(HEAP_TAGS_MAX)
+
+/*----------------------------------------------------------------------------*/
+/* Private Members                                                            */
+/*----------------------------------------------------------------------------*/
+
+/**
+ * @brief Statistics by module, last one gathers modules past HEAP_TAGS_MAX
+ */
+static Utils::Heap::STATS _stats[HEAP_TAGS_MAX + 1u];
+static uint32_t _count = 0u;
+
+/**
+ * @brief Name set by SetTag()
+ */
+static const char* _tag = NULL;
+
+/*----------------------------------------------------------------------------*/
+/* Private Functions                                                          */
+/*----------------------------------------------------------------------------*/
+
+/**
+ * @brief Return statistics index of the allocating module (in critical section)
+ */
+static uint32_t _heapTag (void)
+{
+	const char* name = _tag;
+
+	if(name == NULL)
+		name = (xTaskGetSchedulerState() == taskSCHEDULER_NOT_STARTED) ? "main" : pcTaskGetName(NULL);
+
+	for(uint32_t i = 0u; i < _count; i++)
+	{
+		if((_stats[i].name == name) || (strcmp(_stats[i].name, name) == 0))
+			return i;
+	}
+
+	if(_count >= HEAP_TAGS_MAX)
+	{
+		_stats[HEAP_TAG_OTHER].name = "other";
+		return HEAP_TAG_OTHER;
+	}
+
+	_stats[_count].name = name;
+
+	return _count++;
+}
+
+/*----------------------------------------------------------------------------*/
+/* Class Implementation	                                                      */
+/*----------------------------------------------------------------------------*/
+
+namespace Utils
+{
+	void* Heap::Alloc (size_t size)
+	{
+		HEAP_HEADER* header = (HEAP_HEADER*)pvPortMalloc(sizeof(HEAP_HEADER) + size);
+		STATS* stats;
+
+		if(header == NULL)
+			return NULL;
+
+		taskENTER_CRITICAL();
+
+		header->size = size;
+		header->tag = _heapTag();
+
+		stats = &_stats[header->tag];
+		stats->allocs++;
+		stats->used += size;
+		if(stats->used > stats->peak)
+			stats->peak = stats->used;
+
+		taskEXIT_CRITICAL();
+
+		return header + 1;
+	}
+
+	void Heap::Free (void* block)
+	{
+		HEAP_HEADER* header;
+		STATS* stats;
+
+		if(block == NULL)
+			return;
+
+		header = (HEAP_HEADER*)block - 1;
+		assert(header->tag <= HEAP_TAG_OTHER);
+
+		taskENTER_CRITICAL();
+
+		stats = &_stats[header->tag];
+		stats->frees++;
+		stats->used -= header->size;
+
+		taskEXIT_CRITICAL();
+
+		vPortFree(header);
+	}
+
+	void* Heap::Realloc (void* block, size_t size)
+	{
+		void* resized;
+		size_t old;
+
+		if(block == NULL)
+			return Heap::Alloc(size);
+
+		if(size == 0u)
+		{
+			Heap::Free(block);
+			return NULL;
+		}
+
+		old = ((HEAP_HEADER*)block - 1)->size;
+
+		resized = Heap::Alloc(size);
+		if(resized != NULL)
+		{
+			memcpy(resized, block, (old < size) ? old : size);
+			Heap::Free(block);
+		}
+
+		return resized;
+	}
+
+	void Heap::SetTag (const char* name)
+	{
+		_tag = name;
+	}
+
+	uint32_t Heap::Count ()
+	{
+		return (_stats[HEAP_TAG_OTHER].name != NULL) ? (_count + 1u) : _count;
+	}
+
+	const Heap::STATS* Heap::Get (uint32_t index)
+	{
+		if(index < _count)
+			return &_stats[index];
+		else if((index == _count) && (_stats[HEAP_TAG_OTHER].name != NULL))
+			return &_stats[HEAP_TAG_OTHER];
+		else
+			return NULL;
+	}
+}
+
+/*----------------------------------------------------------------------------*/
+/* C++ allocation                                                             */
+/*----------------------------------------------------------------------------*/
+
+void* operator new (size_t size)
+{
+	return Utils::Heap::Alloc(size);
+}
+
+void* operator new[] (size_t size)
+{
+	return Utils::Heap::Alloc(size);
+}
+
+void operator delete (void* block) noexcept
+{
+	Utils::Heap::Free(block);
+}
+
+void operator delete[] (void* block) noexcept
+{
+	Utils::Heap::Free(block);
+}
+
+void operator delete (void* block, size_t size) noexcept
+{
+	Utils::Heap::Free(block);
+}
+
+void operator delete[] (void* block, size_t size) noexcept
+{
+	Utils::Heap::Free(block);
+}
+
+/*----------------------------------------------------------------------------*/
+/* newlib allocation (stdio buffers, ...)                                     */
+/*----------------------------------------------------------------------------*/
+
+extern "C"
+{
+	void* malloc (size_t size)
+	{
+		return Utils::Heap::Alloc(size);
+	}
+
+	void free (void* block)
+	{
+		Utils::Heap::Free(block);
+	}
+
+	void* calloc (size_t n, size_t size)
+	{
+		void* block = Utils::Heap::Alloc(n * size);
+
+		if(block != NULL)
+			memset(block, 0, n * size);
+
+		return block;
+	}
+
+	void* realloc (void* block, size_t size)
+	{
+		return Utils::Heap::Realloc(block, size);
+	}
+
+	void* _malloc_r (struct _reent* r, size_t size)
+	{
+		return malloc(size);
+	}
+
+	void _free_r (struct _reent* r, void* block)
+	{
+		free(block);
+	}
+
+	void* _calloc_r (struct _reent* r, size_t n, size_t size)
+	{
+		return calloc(n, size);
+	}
+
+	void* _realloc_r (struct _reent* r, void* block, size_t size)
+	{
+		return realloc(block, size);
+	}
+}
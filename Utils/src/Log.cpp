@@ -0,0 +1,100 @@
+/**
+ * @file	Log.cpp
+ * @author	Jeremy ROULLAND
+ * @date	22 oct. 2017
+ * @brief	Deferred formatting logger (tokenized format strings)
+ */
+
+#include "Log.hpp"
+
+#include <stddef.h>
+
+/*----------------------------------------------------------------------------*/
+/* Definitions                                                                */
+/*----------------------------------------------------------------------------*/
+
+#define LOG_BUFFER_MASK			(LOG_BUFFER_WORDS - 1u)
+
+/*----------------------------------------------------------------------------*/
+/* Private Members                                                            */
+/*----------------------------------------------------------------------------*/
+
+/**
+ * @brief Ring buffer
+ */
+static uint32_t _logBuffer[LOG_BUFFER_WORDS];
+
+/**
+ * @brief Write (producers) and read (Read()) word counters
+ */
+static volatile uint32_t _logHead = 0;
+static volatile uint32_t _logTail = 0;
+
+/**
+ * @brief Records dropped
+ */
+static uint32_t _logLost = 0;
+
+/*----------------------------------------------------------------------------*/
+/* Class Implementation	                                                      */
+/*----------------------------------------------------------------------------*/
+
+namespace Utils
+{
+	void Log::write (uint32_t header, const uint32_t* args, uint32_t n)
+	{
+		uint32_t primask, head;
+
+		// Also called from interrupts : mask all
+		primask = __get_PRIMASK();
+		__disable_irq();
+
+		head = _logHead;
+
+		if((LOG_BUFFER_WORDS - (head - _logTail)) < LOG_RECORD_WORDS(n))
+		{
+			_logLost++;
+		}
+		else
+		{
+			_logBuffer[head++ & LOG_BUFFER_MASK] = header;
+			_logBuffer[head++ & LOG_BUFFER_MASK] = DWT->CYCCNT;
+
+			for(uint32_t i = 0; i < n; i++)
+				_logBuffer[head++ & LOG_BUFFER_MASK] = args[i];
+
+			_logHead = head;
+		}
+
+		__set_PRIMASK(primask);
+	}
+
+	uint32_t Log::Read (uint32_t* words, uint32_t max)
+	{
+		uint32_t tail = _logTail;
+		uint32_t head = _logHead;
+		uint32_t length, count = 0;
+
+		assert(words != NULL);
+
+		while(tail != head)
+		{
+			length = LOG_RECORD_WORDS(LOG_HEADER_ARGS(_logBuffer[tail & LOG_BUFFER_MASK]));
+
+			if((count + length) > max)
+				break;
+
+			for(uint32_t i = 0; i < length; i++)
+				words[count++] = _logBuffer[tail++ & LOG_BUFFER_MASK];
+		}
+
+		_logTail = tail;
+
+		return count;
+	}
+
+	uint32_t Log::GetLost ()
+	{
+		return _logLost;
+	}
+}
@@ -19,6 +19,14 @@ namespace Utils
 		this->ki		=	0.0f;
 		this->kd		=	0.0f;
 		this->dt		=	1.0f;
+		this->kiDt		=	0.0f;
+		this->kdDt		=	0.0f;
+		this->outMin	=	-FLT_MAX;
+		this->outMax	=	FLT_MAX;
+		this->tf		=	0.0f;
+		this->alpha		=	1.0f;
+		this->schedule	=	NULL;
+		this->scheduleSize	=	0u;
 		this->err		=	0.0f;
 		this->intErr	=	0.0f;
 		this->diffErr	=	0.0f;
@@ -31,8 +39,52 @@ namespace Utils
 		this->kp	=	kp;
 		this->ki	=	ki;
 		this->kd	=	kd;
+
+		this->setPeriod(dt);
+	}
+
+	void PID::setPeriod (float32_t dt)
+	{
 		this->dt	=	dt;
+		this->kiDt	=	this->ki * dt;
+		this->kdDt	=	this->kd / dt;
+		this->alpha	=	dt / (this->tf + dt);
+	}
+
+	void PID::Schedule (float32_t velocity)
+	{
+		const PID_GAINS * lo = NULL;
+		const PID_GAINS * hi = NULL;
+		float32_t x = 0.0f;
+		uint32_t i = 0;
 
+		if((this->schedule == NULL) || (this->scheduleSize == 0u))
+			return;
+
+		// Find entries around velocity (saturated on table ends)
+		for(i = 1u; i < this->scheduleSize; i++)
+		{
+			if(velocity < this->schedule[i].velocity)
+				break;
+		}
+
+		if(i >= this->scheduleSize)
+		{
+			lo = &this->schedule[this->scheduleSize - 1u];
+			hi = lo;
+		}
+		else
+		{
+			lo = &this->schedule[i - 1u];
+			hi = &this->schedule[i];
+		}
+
+		if((hi != lo) && (velocity > lo->velocity))
+			x = (velocity - lo->velocity) / (hi->velocity - lo->velocity);
+
+		this->kp	=	lo->kp + x * (hi->kp - lo->kp);
+		this->SetKi(lo->ki + x * (hi->ki - lo->ki));
+		this->SetKd(lo->kd + x * (hi->kd - lo->kd));
 	}
 
 	void PID::Reset ()
@@ -45,23 +97,51 @@ namespace Utils
 	float32_t PID::Get (float32_t feedback)
 	{
 		float32_t err = 0.0;
+		float32_t output = 0.0;
+		float32_t intErr = 0.0;
+
+		err = (this->setpoint - feedback);
+
+		// Derivative : first order filtered differential error
+		this->diffErr	+=	this->alpha * ((err - this->err) - this->diffErr);
+		this->err		=	err;
 
-		err = (this->setpoint - feedback) / 1.0;	// Filter output removed
+		// Integral : clamped to output limits, frozen while output is saturated on the same side (anti-windup)
+		intErr = this->intErr + this->kiDt * err;
+		if(intErr > this->outMax)
+			intErr = this->outMax;
+		else if(intErr < this->outMin)
+			intErr = this->outMin;
 
+		// Output    =  kp * current error    + Ki * integration time * error sum    + kd / derivation time * differential error
+		output = (this->kp * err) + intErr + (this->kdDt * this->diffErr);
 
-		this->intErr	=	err + this->intErr;
-		this->diffErr	=	err - this->err;
-		this->err 		= 	err;
+		if(output > this->outMax)
+		{
+			if(err < 0.0f)
+				this->intErr = intErr;
+			output = this->outMax;
+		}
+		else if(output < this->outMin)
+		{
+			if(err > 0.0f)
+				this->intErr = intErr;
+			output = this->outMin;
+		}
+		else
+		{
+			this->intErr = intErr;
+		}
 
-		// Output    =  kp * current error    + Ki * error sum * integration time    + kd * differential error / derivation time
-		this->output = (this->kp * this->err) + (this->ki * this->intErr * this->dt) + (this->kd * this->diffErr / this->dt);
+		this->output = output;
 
 		return this->output;
 	}
 
 	float32_t PID::Get(float32_t feedback, float32_t period)
 	{
-		this->dt = period;
+		if(period != this->dt)
+			this->setPeriod(period);
 
 		return this->Get(feedback);
 	}
@@ -0,0 +1,191 @@
+/**
+ * @file	Param.cpp
+ * @author	Jeremy ROULLAND
+ * @date	22 oct. 2017
+ * @brief	Runtime parameters registry
+ */
+
+#include "Param.hpp"
+#include "stm32f4xx.h"
+
+#include <stddef.h>
+#include <string.h>
+
+using namespace Utils;
+
+/*----------------------------------------------------------------------------*/
+/* Definitions                                                                */
+/*----------------------------------------------------------------------------*/
+
+/**
+ * @brief Registered parameter
+ */
+typedef struct
+{
+	const char *		NAME;
+	void *				ADDRESS;
+	enum Param::TYPE	TYPE;
+	float32_t			MIN;
+	float32_t			MAX;
+	Observer			CHANGED;
+}PARAM_DEF;
+
+/*----------------------------------------------------------------------------*/
+/* Private Members                                                            */
+/*----------------------------------------------------------------------------*/
+
+/**
+ * @brief Registered parameters
+ */
+static PARAM_DEF _params[PARAM_MAX];
+
+/**
+ * @brief Number of registered parameters
+ */
+static uint32_t _paramsCount = 0;
+
+/*----------------------------------------------------------------------------*/
+/* Private Functions                                                          */
+/*----------------------------------------------------------------------------*/
+
+static bool _register (const char * name, void * address, enum Param::TYPE type, float32_t min, float32_t max,
+					   Observer::ObserverCallback cb, void * obj)
+{
+	PARAM_DEF* param;
+
+	assert(min <= max);
+
+	if(_paramsCount >= PARAM_MAX)
+		return false;
+
+	param = &_params[_paramsCount];
+
+	param->NAME			= name;
+	param->ADDRESS		= address;
+	param->TYPE			= type;
+	param->MIN			= min;
+	param->MAX			= max;
+	param->CHANGED.obj	= obj;
+	param->CHANGED.cb	= cb;
+
+	_paramsCount++;
+
+	return true;
+}
+
+/*----------------------------------------------------------------------------*/
+/* Class Implementation	                                                      */
+/*----------------------------------------------------------------------------*/
+
+namespace Utils
+{
+	bool Param::Register (const char * name, float32_t * address, float32_t min, float32_t max,
+						  Observer::ObserverCallback cb, void * obj)
+	{
+		return _register(name, address, Param::FLOAT32, min, max, cb, obj);
+	}
+
+	bool Param::Register (const char * name, int32_t * address, int32_t min, int32_t max,
+						  Observer::ObserverCallback cb, void * obj)
+	{
+		return _register(name, address, Param::INT32, (float32_t)min, (float32_t)max, cb, obj);
+	}
+
+	bool Param::Register (const char * name, uint32_t * address, uint32_t min, uint32_t max,
+						  Observer::ObserverCallback cb, void * obj)
+	{
+		return _register(name, address, Param::UINT32, (float32_t)min, (float32_t)max, cb, obj);
+	}
+
+	uint32_t Param::Count ()
+	{
+		return _paramsCount;
+	}
+
+	int32_t Param::Find (const char * name)
+	{
+		for(uint32_t i = 0u; i < _paramsCount; i++)
+		{
+			if(strcmp(name, _params[i].NAME) == 0)
+				return (int32_t)i;
+		}
+
+		return -1;
+	}
+
+	const char * Param::GetName (uint32_t index)
+	{
+		return (index < _paramsCount) ? _params[index].NAME : NULL;
+	}
+
+	enum Param::TYPE Param::GetType (uint32_t index)
+	{
+		assert(index < _paramsCount);
+
+		return _params[index].TYPE;
+	}
+
+	float32_t Param::GetValue (uint32_t index)
+	{
+		if(index >= _paramsCount)
+			return 0.0f;
+
+		switch(_params[index].TYPE)
+		{
+		case Param::INT32:
+			return (float32_t)(*(volatile int32_t*)_params[index].ADDRESS);
+		case Param::UINT32:
+			return (float32_t)(*(volatile uint32_t*)_params[index].ADDRESS);
+		default:
+			return *(volatile float32_t*)_params[index].ADDRESS;
+		}
+	}
+
+	float32_t Param::GetMin (uint32_t index)
+	{
+		return (index < _paramsCount) ? _params[index].MIN : 0.0f;
+	}
+
+	float32_t Param::GetMax (uint32_t index)
+	{
+		return (index < _paramsCount) ? _params[index].MAX : 0.0f;
+	}
+
+	bool Param::Set (uint32_t index, float32_t value)
+	{
+		PARAM_DEF* param;
+		uint32_t primask;
+
+		if(index >= _paramsCount)
+			return false;
+
+		param = &_params[index];
+
+		// Also rejects NaN
+		if(!((value >= param->MIN) && (value <= param->MAX)))
+			return false;
+
+		primask = __get_PRIMASK();
+		__disable_irq();
+
+		switch(param->TYPE)
+		{
+		case Param::INT32:
+			*(volatile int32_t*)param->ADDRESS = (int32_t)value;
+			break;
+		case Param::UINT32:
+			*(volatile uint32_t*)param->ADDRESS = (uint32_t)value;
+			break;
+		default:
+			*(volatile float32_t*)param->ADDRESS = value;
+			break;
+		}
+
+		__set_PRIMASK(primask);
+
+		if(param->CHANGED.cb != NULL)
+			param->CHANGED.cb(param->CHANGED.obj);
+
+		return true;
+	}
+}
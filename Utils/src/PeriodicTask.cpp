@@ -0,0 +1,164 @@
+/**
+ * @file	PeriodicTask.cpp
+ * @author	Jeremy ROULLAND
+ * @date	22 oct. 2017
+ * @brief	Periodic task loop with scheduling statistics
+ */
+
+#include "PeriodicTask.hpp"
+#include "Clock.hpp"
+#include "stm32f4xx.h"
+
+#include <stddef.h>
+
+/*----------------------------------------------------------------------------*/
+/* Definitions                                                                */
+/*----------------------------------------------------------------------------*/
+
+#define PERIODIC_US_BY_TICK		(1000000u / configTICK_RATE_HZ)
+
+/*----------------------------------------------------------------------------*/
+/* Private Members                                                            */
+/*----------------------------------------------------------------------------*/
+
+/**
+ * @brief Registered periodic tasks
+ */
+static Utils::PeriodicTask* _periodics[PERIODIC_MAX] = {NULL};
+
+/**
+ * @brief Number of registered periodic tasks
+ */
+static uint32_t _periodicsCount = 0;
+
+/*----------------------------------------------------------------------------*/
+/* Class Implementation	                                                      */
+/*----------------------------------------------------------------------------*/
+
+namespace Utils
+{
+	PeriodicTask::PeriodicTask (const char * name, uint32_t period)
+	{
+		this->name = name;
+		this->period = period;
+		this->lastWake = 0;
+		this->startTick = 0;
+		this->startUs = 0;
+		this->prevTick = 0;
+		this->prevUs = 0;
+		this->Reset();
+
+		if(_periodicsCount < PERIODIC_MAX)
+		{
+			_periodics[_periodicsCount] = this;
+			_periodicsCount++;
+		}
+	}
+
+	uint32_t PeriodicTask::Count ()
+	{
+		return _periodicsCount;
+	}
+
+	PeriodicTask* PeriodicTask::Get (uint32_t index)
+	{
+		if(index < _periodicsCount)
+			return _periodics[index];
+		else
+			return NULL;
+	}
+
+	void PeriodicTask::Start ()
+	{
+		this->lastWake = xTaskGetTickCount();
+		this->startTick = this->lastWake;
+		this->prevTick = this->lastWake;
+		this->startUs = Clock::GetMicros();
+		this->prevUs = this->startUs;
+	}
+
+	float32_t PeriodicTask::Wait ()
+	{
+		TickType_t ticks = pdMS_TO_TICKS(this->period);
+		uint32_t now, release;
+		int32_t latency;
+
+		// Iteration ended after next release : vTaskDelayUntil() returns at once
+		if((xTaskGetTickCount() - this->lastWake) >= ticks)
+			this->missed++;
+
+		vTaskDelayUntil(&this->lastWake, ticks);
+
+		now = Clock::GetMicros();
+
+		// Wake up time after release tick (unknown constant offset removed by min)
+		release = this->startUs + (uint32_t)(this->lastWake - this->startTick) * PERIODIC_US_BY_TICK;
+		latency = (int32_t)(now - release);
+
+		if((this->count == 0u) || (latency < this->latencyMin))
+			this->latencyMin = latency;
+		if((this->count == 0u) || (latency > this->latencyMax))
+			this->latencyMax = latency;
+
+		return this->update(now);
+	}
+
+	float32_t PeriodicTask::Mark ()
+	{
+		uint32_t now = Clock::GetMicros();
+
+		// No release time : a period of twice the nominal one or more is a missed frame
+		if((this->count > 0u) && ((now - this->prevUs) >= (2u * this->period * 1000u)))
+			this->missed++;
+
+		return this->update(now);
+	}
+
+	void PeriodicTask::Reset ()
+	{
+		this->count = 0;
+		this->missed = 0;
+		this->periodMin = 0xFFFFFFFFu;
+		this->periodMax = 0;
+		this->jitterMax = 0;
+		this->latencyMin = 0;
+		this->latencyMax = 0;
+
+		for(uint32_t i = 0; i < PERIODIC_HISTOGRAM_SIZE; i++)
+			this->histogram[i] = 0;
+	}
+
+	float32_t PeriodicTask::update (uint32_t now)
+	{
+		TickType_t tick = xTaskGetTickCount();
+		uint32_t nominal = this->period * 1000u;
+		uint32_t actual, jitter, bin;
+		float32_t elapsed;
+
+		elapsed = static_cast<float32_t>(tick) - static_cast<float32_t>(this->prevTick);
+		this->prevTick = tick;
+
+		if(this->count > 0u)
+		{
+			actual = now - this->prevUs;
+			jitter = (actual > nominal) ? (actual - nominal) : (nominal - actual);
+
+			if(actual < this->periodMin)
+				this->periodMin = actual;
+			if(actual > this->periodMax)
+				this->periodMax = actual;
+			if(jitter > this->jitterMax)
+				this->jitterMax = jitter;
+
+			bin = 32u - __CLZ(jitter);
+			if(bin >= PERIODIC_HISTOGRAM_SIZE)
+				bin = PERIODIC_HISTOGRAM_SIZE - 1u;
+			this->histogram[bin]++;
+		}
+
+		this->prevUs = now;
+		this->count++;
+
+		return elapsed;
+	}
+}
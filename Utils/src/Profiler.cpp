@@ -0,0 +1,142 @@
+/**
+ * @file	Profiler.cpp
+ * @author	Jeremy ROULLAND
+ * @date	14 oct. 2017
+ * @brief	Execution time profiler class
+ */
+
+#include "Profiler.hpp"
+#include "Clock.hpp"
+
+#include <stddef.h>
+
+/*----------------------------------------------------------------------------*/
+/* Private Members                                                            */
+/*----------------------------------------------------------------------------*/
+
+/**
+ * @brief Registered profilers
+ */
+static Utils::Profiler* _profilers[PROFILER_MAX] = {NULL};
+
+/**
+ * @brief Number of registered profilers
+ */
+static uint32_t _profilersCount = 0;
+
+/*----------------------------------------------------------------------------*/
+/* Class Implementation	                                                      */
+/*----------------------------------------------------------------------------*/
+
+namespace Utils
+{
+	Profiler::Profiler (const char * name)
+	{
+		this->name = name;
+		this->start = 0;
+		this->index = 0xFFu;
+		this->Reset();
+
+		if(_profilersCount < PROFILER_MAX)
+		{
+			this->index = (uint8_t)_profilersCount;
+			_profilers[_profilersCount] = this;
+			_profilersCount++;
+		}
+	}
+
+	void Profiler::Init ()
+	{
+		if((DWT->CTRL & DWT_CTRL_CYCCNTENA_Msk) != 0u)
+			return;
+
+		CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+		DWT->CYCCNT = 0;
+		DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+	}
+
+	uint32_t Profiler::CyclesToUs (uint32_t cycles)
+	{
+		return cycles / (SystemCoreClock / 1000000u);
+	}
+
+	uint32_t Profiler::Count ()
+	{
+		return _profilersCount;
+	}
+
+	Profiler* Profiler::Get (uint32_t index)
+	{
+		if(index < _profilersCount)
+			return _profilers[index];
+		else
+			return NULL;
+	}
+
+	void Profiler::Stop ()
+	{
+		uint32_t duration = DWT->CYCCNT - this->start;
+		uint32_t bin = 32u - __CLZ(CyclesToUs(duration));
+
+		Trace::Record(Trace::END, this->index);
+
+		this->last = duration;
+
+		if(duration < this->min)
+			this->min = duration;
+		if(duration > this->max)
+			this->max = duration;
+
+		this->sum += duration;
+		this->count++;
+
+		if(bin >= PROFILER_HISTOGRAM_SIZE)
+			bin = PROFILER_HISTOGRAM_SIZE - 1u;
+		this->histogram[bin]++;
+	}
+
+	void Profiler::Reset ()
+	{
+		this->min = 0xFFFFFFFFu;
+		this->max = 0;
+		this->last = 0;
+		this->sum = 0;
+		this->count = 0;
+
+		for(uint32_t i = 0; i < PROFILER_HISTOGRAM_SIZE; i++)
+			this->histogram[i] = 0;
+	}
+
+	uint32_t Profiler::GetAverage ()
+	{
+		if(this->count == 0)
+			return 0;
+
+		return (uint32_t)(this->sum / this->count);
+	}
+}
+
+/*----------------------------------------------------------------------------*/
+/* OS run time stats                                                          */
+/*----------------------------------------------------------------------------*/
+
+extern "C"
+{
+	/**
+	 * @brief Configure run time stats counter (called by the OS)
+	 */
+	void vConfigureTimerForRunTimeStats (void)
+	{
+		Utils::Profiler::Init();
+	}
+
+	/**
+	 * @brief Get run time stats counter in microseconds (called by the OS)
+	 *
+	 * The OS calls it on every context switch, see Utils::Clock.
+	 */
+	uint32_t ulGetRunTimeCounterValue (void)
+	{
+		return Utils::Clock::GetMicros();
+	}
+}
@@ -0,0 +1,169 @@
+/**
+ * @file	RelayTuner.cpp
+ * @author	Jeremy ROULLAND
+ * @date	22 oct. 2017
+ * @brief	Relay feedback PID auto-tuner
+ */
+
+#include "RelayTuner.hpp"
+#include "FastMath.hpp"
+
+#include <math.h>
+
+/*----------------------------------------------------------------------------*/
+/* Definitions                                                                */
+/*----------------------------------------------------------------------------*/
+
+#define RELAY_PI				(3.14159265f)
+
+/*----------------------------------------------------------------------------*/
+/* Private Members                                                            */
+/*----------------------------------------------------------------------------*/
+
+/**
+ * @brief Rules coefficients : kp / Ku, Ti / Tu, Td / Tu
+ */
+static const float32_t _rules[Utils::RelayTuner::RULE_MAX][3] =
+{
+	{0.6f,	0.5f,	0.125f},
+	{0.33f,	0.5f,	0.333f},
+	{0.2f,	0.5f,	0.333f},
+};
+
+/*----------------------------------------------------------------------------*/
+/* Class Implementation	                                                      */
+/*----------------------------------------------------------------------------*/
+
+namespace Utils
+{
+	RelayTuner::RelayTuner ()
+	{
+		this->state = RelayTuner::IDLE;
+		this->setpoint = 0.0f;
+		this->amplitude = 0.0f;
+		this->hysteresis = 0.0f;
+		this->cycles = 0u;
+		this->timeout = 0.0f;
+		this->Stop();
+	}
+
+	void RelayTuner::Start (float32_t setpoint, float32_t amplitude, float32_t hysteresis, uint32_t cycles, float32_t timeout)
+	{
+		assert(amplitude > 0.0f);
+		assert(cycles > 0u);
+
+		this->Stop();
+
+		this->setpoint = setpoint;
+		this->amplitude = amplitude;
+		this->hysteresis = hysteresis;
+		this->cycles = cycles;
+		this->timeout = timeout;
+
+		// Push the plant away from the setpoint
+		this->output = amplitude;
+		this->state = RelayTuner::RUNNING;
+	}
+
+	void RelayTuner::Stop ()
+	{
+		this->state = RelayTuner::IDLE;
+		this->output = 0.0f;
+		this->time = 0.0f;
+		this->cycleStart = 0.0f;
+		this->cycleMax = -FLT_MAX;
+		this->cycleMin = FLT_MAX;
+		this->started = 0u;
+		this->measured = 0u;
+		this->periodSum = 0.0f;
+		this->amplitudeSum = 0.0f;
+		this->ku = 0.0f;
+		this->tu = 0.0f;
+	}
+
+	float32_t RelayTuner::Update (float32_t feedback, float32_t dt)
+	{
+		float32_t err, a;
+
+		if(this->state != RelayTuner::RUNNING)
+			return 0.0f;
+
+		this->time += dt;
+
+		if(this->time > this->timeout)
+		{
+			this->state = RelayTuner::FAILED;
+			this->output = 0.0f;
+			return 0.0f;
+		}
+
+		if(feedback > this->cycleMax)
+			this->cycleMax = feedback;
+		if(feedback < this->cycleMin)
+			this->cycleMin = feedback;
+
+		err = this->setpoint - feedback;
+
+		// Relay with hysteresis, a cycle starts on each switch to +amplitude
+		if((err > this->hysteresis) && (this->output < 0.0f))
+		{
+			this->output = this->amplitude;
+
+			// First switch starts the first cycle, first cycle is transient
+			if(this->started >= 2u)
+			{
+				this->periodSum += this->time - this->cycleStart;
+				this->amplitudeSum += 0.5f * (this->cycleMax - this->cycleMin);
+				this->measured++;
+			}
+
+			this->started++;
+			this->cycleStart = this->time;
+			this->cycleMax = feedback;
+			this->cycleMin = feedback;
+
+			if(this->measured >= this->cycles)
+			{
+				this->output = 0.0f;
+				this->tu = this->periodSum / (float32_t)this->measured;
+				a = this->amplitudeSum / (float32_t)this->measured;
+
+				if(a > this->hysteresis)
+				{
+					this->ku = (4.0f * this->amplitude) / (RELAY_PI * Utils::Sqrt(a * a - this->hysteresis * this->hysteresis));
+					this->state = RelayTuner::DONE;
+				}
+				else
+				{
+					this->state = RelayTuner::FAILED;
+				}
+			}
+		}
+		else if((err < -this->hysteresis) && (this->output > 0.0f))
+		{
+			this->output = -this->amplitude;
+		}
+
+		return this->output;
+	}
+
+	PID_GAINS RelayTuner::GetGains (enum RelayTuner::RULE rule)
+	{
+		PID_GAINS gains = {0.0f, 0.0f, 0.0f, 0.0f};
+		float32_t ti, td;
+
+		assert(rule < RelayTuner::RULE_MAX);
+
+		if(this->state != RelayTuner::DONE)
+			return gains;
+
+		gains.kp = _rules[rule][0] * this->ku;
+		ti = _rules[rule][1] * this->tu;
+		td = _rules[rule][2] * this->tu;
+
+		gains.ki = gains.kp / ti;
+		gains.kd = gains.kp * td;
+
+		return gains;
+	}
+}
@@ -0,0 +1,221 @@
+/**
+ * @file	Scope.cpp
+ * @author	Jeremy ROULLAND
+ * @date	27 oct. 2017
+ * @brief	Triggered RAM capture of control loop variables
+ */
+
+#include "Scope.hpp"
+
+#include <stddef.h>
+#include <math.h>
+
+/*----------------------------------------------------------------------------*/
+/* Definitions                                                                */
+/*----------------------------------------------------------------------------*/
+
+#define SCOPE_SAMPLES_MASK		(SCOPE_SAMPLES - 1u)
+
+/*----------------------------------------------------------------------------*/
+/* Private Members                                                            */
+/*----------------------------------------------------------------------------*/
+
+/**
+ * @brief Ring buffer
+ */
+static float32_t _scopeBuffer[SCOPE_SAMPLES][SCOPE_CHANNELS];
+
+/**
+ * @brief Channels probes
+ */
+static ScopeProbe _scopeProbes[SCOPE_CHANNELS] = {NULL};
+
+/**
+ * @brief Level trigger channel, threshold and previous value (edges)
+ */
+static uint32_t _scopeChannel = 0;
+static float32_t _scopeLevel = 0.0f;
+static float32_t _scopePrevious = 0.0f;
+
+/**
+ * @brief Number of samples written since Arm(), trigger sample and last sample
+ */
+static uint32_t _scopeHead = 0;
+static uint32_t _scopeTrigger = 0;
+static uint32_t _scopeEnd = 0;
+
+/**
+ * @brief Post-trigger samples
+ */
+static uint32_t _scopePost = SCOPE_SAMPLES;
+
+/*----------------------------------------------------------------------------*/
+/* Class Implementation	                                                      */
+/*----------------------------------------------------------------------------*/
+
+namespace Utils
+{
+	volatile enum Scope::STATE Scope::state = Scope::IDLE;
+	enum Scope::TRIGGER Scope::source = Scope::MANUAL;
+
+	bool Scope::SetChannel (uint32_t channel, ScopeProbe probe)
+	{
+		if((channel >= SCOPE_CHANNELS) || (state == ARMED) || (state == TRIGGERED))
+			return false;
+
+		_scopeProbes[channel] = probe;
+
+		return true;
+	}
+
+	ScopeProbe Scope::GetChannel (uint32_t channel)
+	{
+		return (channel < SCOPE_CHANNELS) ? _scopeProbes[channel] : NULL;
+	}
+
+	bool Scope::SetTrigger (enum Scope::TRIGGER source, uint32_t channel, float32_t level)
+	{
+		if((channel >= SCOPE_CHANNELS) || (state == ARMED) || (state == TRIGGERED))
+			return false;
+
+		Scope::source = source;
+		_scopeChannel = channel;
+		_scopeLevel = level;
+
+		return true;
+	}
+
+	uint32_t Scope::GetTriggerChannel ()
+	{
+		return _scopeChannel;
+	}
+
+	float32_t Scope::GetTriggerLevel ()
+	{
+		return _scopeLevel;
+	}
+
+	void Scope::Arm (uint32_t pre)
+	{
+		state = IDLE;
+
+		if(pre >= SCOPE_SAMPLES)
+			pre = SCOPE_SAMPLES - 1u;
+
+		_scopePost = SCOPE_SAMPLES - pre;
+		_scopeHead = 0;
+		_scopeTrigger = 0;
+		_scopeEnd = 0;
+
+		state = ARMED;
+	}
+
+	void Scope::Stop ()
+	{
+		uint32_t primask;
+
+		primask = __get_PRIMASK();
+		__disable_irq();
+
+		if(state != IDLE)
+		{
+			if(state == ARMED)
+				_scopeTrigger = _scopeHead;
+			_scopeEnd = _scopeHead;
+			state = DONE;
+		}
+
+		__set_PRIMASK(primask);
+	}
+
+	void Scope::Trigger (enum Scope::TRIGGER source)
+	{
+		uint32_t primask;
+
+		if((source != MANUAL) && (source != Scope::source))
+			return;
+
+		// Called from CLI and motion control tasks
+		primask = __get_PRIMASK();
+		__disable_irq();
+
+		if(state == ARMED)
+		{
+			// Next sample is the trigger sample
+			_scopeTrigger = _scopeHead;
+			state = TRIGGERED;
+		}
+
+		__set_PRIMASK(primask);
+	}
+
+	void Scope::Sample ()
+	{
+		float32_t* s;
+		float32_t value;
+		bool triggered = false;
+
+		if((state != ARMED) && (state != TRIGGERED))
+			return;
+
+		s = _scopeBuffer[_scopeHead & SCOPE_SAMPLES_MASK];
+		for(uint32_t i = 0; i < SCOPE_CHANNELS; i++)
+			s[i] = (_scopeProbes[i] != NULL) ? _scopeProbes[i]() : 0.0f;
+
+		// Level trigger, edges need a previous sample
+		value = s[_scopeChannel];
+		switch(source)
+		{
+		case RISING:
+			triggered = (_scopeHead > 0u) && (_scopePrevious < _scopeLevel) && (value >= _scopeLevel);
+			break;
+		case FALLING:
+			triggered = (_scopeHead > 0u) && (_scopePrevious > _scopeLevel) && (value <= _scopeLevel);
+			break;
+		case ABOVE:
+			triggered = (fabsf(value) > _scopeLevel);
+			break;
+		default:
+			break;
+		}
+		_scopePrevious = value;
+
+		if(state == ARMED)
+		{
+			if(triggered)
+			{
+				_scopeTrigger = _scopeHead;
+				state = TRIGGERED;
+			}
+		}
+
+		_scopeHead++;
+
+		if((state == TRIGGERED) && ((_scopeHead - _scopeTrigger) >= _scopePost))
+		{
+			_scopeEnd = _scopeHead;
+			state = DONE;
+		}
+	}
+
+	uint32_t Scope::Count ()
+	{
+		if(state != DONE)
+			return 0;
+
+		return (_scopeEnd < SCOPE_SAMPLES) ? _scopeEnd : SCOPE_SAMPLES;
+	}
+
+	uint32_t Scope::GetTriggerIndex ()
+	{
+		return _scopeTrigger - (_scopeEnd - Scope::Count());
+	}
+
+	const float32_t* Scope::Get (uint32_t index)
+	{
+		if(index >= Scope::Count())
+			return NULL;
+
+		return _scopeBuffer[(_scopeEnd - Scope::Count() + index) & SCOPE_SAMPLES_MASK];
+	}
+}
@@ -0,0 +1,129 @@
+/**
+ * @file	Trace.cpp
+ * @author	Jeremy ROULLAND
+ * @date	22 oct. 2017
+ * @brief	RAM ring buffer event tracer
+ */
+
+#include "Trace.hpp"
+
+#include <stddef.h>
+
+/*----------------------------------------------------------------------------*/
+/* Definitions                                                                */
+/*----------------------------------------------------------------------------*/
+
+#define TRACE_BUFFER_MASK		(TRACE_BUFFER_SIZE - 1u)
+
+/*----------------------------------------------------------------------------*/
+/* Private Members                                                            */
+/*----------------------------------------------------------------------------*/
+
+/**
+ * @brief Ring buffer
+ */
+static TRACE_RECORD _traceBuffer[TRACE_BUFFER_SIZE];
+
+/**
+ * @brief Number of records written since Start()
+ */
+static uint32_t _traceHead = 0;
+
+/*----------------------------------------------------------------------------*/
+/* Class Implementation	                                                      */
+/*----------------------------------------------------------------------------*/
+
+namespace Utils
+{
+	volatile bool Trace::running = false;
+
+	void Trace::Start ()
+	{
+		running = false;
+		_traceHead = 0;
+		running = true;
+	}
+
+	void Trace::Stop ()
+	{
+		running = false;
+	}
+
+	void Trace::Queue (QueueHandle_t queue, uint8_t id)
+	{
+		assert(queue != NULL);
+
+		vQueueSetQueueNumber(queue, id);
+	}
+
+	uint32_t Trace::Count ()
+	{
+		return (_traceHead < TRACE_BUFFER_SIZE) ? _traceHead : TRACE_BUFFER_SIZE;
+	}
+
+	uint32_t Trace::GetLost ()
+	{
+		return _traceHead - Trace::Count();
+	}
+
+	const TRACE_RECORD* Trace::Get (uint32_t index)
+	{
+		if(index >= Trace::Count())
+			return NULL;
+
+		return &_traceBuffer[(_traceHead - Trace::Count() + index) & TRACE_BUFFER_MASK];
+	}
+
+	void Trace::write (enum Trace::TYPE type, uint8_t id, uint16_t arg)
+	{
+		TRACE_RECORD* r;
+		uint32_t primask;
+
+		// Also called above configMAX_SYSCALL (profiled IRQs) : mask all
+		primask = __get_PRIMASK();
+		__disable_irq();
+
+		r = &_traceBuffer[_traceHead & TRACE_BUFFER_MASK];
+		r->CYCLES = DWT->CYCCNT;
+		r->TYPE = (uint8_t)type;
+		r->ID = id;
+		r->ARG = arg;
+		_traceHead++;
+
+		__set_PRIMASK(primask);
+	}
+}
+
+/*----------------------------------------------------------------------------*/
+/* OS trace hooks                                                             */
+/*----------------------------------------------------------------------------*/
+
+extern "C"
+{
+	/**
+	 * @brief Task switched in (called by the OS, see FreeRTOSConfig.h)
+	 * @param number : Task number
+	 */
+	void vTraceTaskSwitchedIn (UBaseType_t number)
+	{
+		Utils::Trace::Record(Utils::Trace::TASK_IN, (uint8_t)number);
+	}
+
+	/**
+	 * @brief Item sent to a numbered queue (called by the OS)
+	 * @param number : Queue number
+	 */
+	void vTraceQueueSend (UBaseType_t number)
+	{
+		Utils::Trace::Record(Utils::Trace::QUEUE_SEND, (uint8_t)number);
+	}
+
+	/**
+	 * @brief Item received from a numbered queue (called by the OS)
+	 * @param number : Queue number
+	 */
+	void vTraceQueueReceive (UBaseType_t number)
+	{
+		Utils::Trace::Record(Utils::Trace::QUEUE_RECEIVE, (uint8_t)number);
+	}
+}
@@ -0,0 +1,205 @@
+/**
+ * @file	Watch.cpp
+ * @author	Jeremy ROULLAND
+ * @date	28 oct. 2017
+ * @brief	Watchable variables registry
+ */
+
+#include "Watch.hpp"
+#include "Format.hpp"
+#include "stm32f4xx.h"
+
+#include <stddef.h>
+#include <string.h>
+
+using namespace Utils;
+
+/*----------------------------------------------------------------------------*/
+/* Definitions                                                                */
+/*----------------------------------------------------------------------------*/
+
+/**
+ * @brief Registered variable
+ */
+typedef struct
+{
+	const char *		NAME;
+	volatile void *		ADDRESS;
+	enum Watch::TYPE	TYPE;
+	bool				WRITABLE;
+}WATCH_DEF;
+
+/*----------------------------------------------------------------------------*/
+/* Private Members                                                            */
+/*----------------------------------------------------------------------------*/
+
+/**
+ * @brief Registered variables
+ */
+static WATCH_DEF _watches[WATCH_MAX];
+
+/**
+ * @brief Number of registered variables
+ */
+static uint32_t _watchesCount = 0;
+
+/*----------------------------------------------------------------------------*/
+/* Private Functions                                                          */
+/*----------------------------------------------------------------------------*/
+
+static bool _register (const char * name, volatile void * address, enum Watch::TYPE type, bool writable)
+{
+	WATCH_DEF* watch;
+
+	assert(address != NULL);
+
+	if(_watchesCount >= WATCH_MAX)
+		return false;
+
+	watch = &_watches[_watchesCount];
+
+	watch->NAME		= name;
+	watch->ADDRESS	= address;
+	watch->TYPE		= type;
+	watch->WRITABLE	= writable;
+
+	_watchesCount++;
+
+	return true;
+}
+
+/*----------------------------------------------------------------------------*/
+/* Class Implementation	                                                      */
+/*----------------------------------------------------------------------------*/
+
+namespace Utils
+{
+	bool Watch::Register (const char * name, volatile float32_t * address, bool writable)
+	{
+		return _register(name, address, Watch::FLOAT32, writable);
+	}
+
+	bool Watch::Register (const char * name, volatile int32_t * address, bool writable)
+	{
+		return _register(name, address, Watch::INT32, writable);
+	}
+
+	bool Watch::Register (const char * name, volatile uint32_t * address, bool writable)
+	{
+		return _register(name, address, Watch::UINT32, writable);
+	}
+
+	bool Watch::Register (const char * name, volatile uint16_t * address, bool writable)
+	{
+		return _register(name, address, Watch::UINT16, writable);
+	}
+
+	bool Watch::Register (const char * name, volatile bool * address, bool writable)
+	{
+		return _register(name, address, Watch::BOOL, writable);
+	}
+
+	uint32_t Watch::Count ()
+	{
+		return _watchesCount;
+	}
+
+	int32_t Watch::Find (const char * name)
+	{
+		for(uint32_t i = 0u; i < _watchesCount; i++)
+		{
+			if(strcmp(name, _watches[i].NAME) == 0)
+				return (int32_t)i;
+		}
+
+		return -1;
+	}
+
+	const char * Watch::GetName (uint32_t index)
+	{
+		return (index < _watchesCount) ? _watches[index].NAME : NULL;
+	}
+
+	bool Watch::IsWritable (uint32_t index)
+	{
+		return (index < _watchesCount) && _watches[index].WRITABLE;
+	}
+
+	float32_t Watch::GetValue (uint32_t index)
+	{
+		if(index >= _watchesCount)
+			return 0.0f;
+
+		// Single load, no lock
+		switch(_watches[index].TYPE)
+		{
+		case Watch::INT32:
+			return (float32_t)(*(volatile int32_t*)_watches[index].ADDRESS);
+		case Watch::UINT32:
+			return (float32_t)(*(volatile uint32_t*)_watches[index].ADDRESS);
+		case Watch::UINT16:
+			return (float32_t)(*(volatile uint16_t*)_watches[index].ADDRESS);
+		case Watch::BOOL:
+			return (*(volatile bool*)_watches[index].ADDRESS) ? 1.0f : 0.0f;
+		default:
+			return *(volatile float32_t*)_watches[index].ADDRESS;
+		}
+	}
+
+	uint32_t Watch::Format (uint32_t index, char * buffer, uint32_t size)
+	{
+		if(index >= _watchesCount)
+			return Utils::Format(buffer, size, "?");
+
+		switch(_watches[index].TYPE)
+		{
+		case Watch::INT32:
+			return Utils::Format(buffer, size, "%ld", *(volatile int32_t*)_watches[index].ADDRESS);
+		case Watch::UINT32:
+			return Utils::Format(buffer, size, "%lu", *(volatile uint32_t*)_watches[index].ADDRESS);
+		case Watch::UINT16:
+			return Utils::Format(buffer, size, "0x%04x", *(volatile uint16_t*)_watches[index].ADDRESS);
+		case Watch::BOOL:
+			return Utils::Format(buffer, size, "%u", (*(volatile bool*)_watches[index].ADDRESS) ? 1u : 0u);
+		default:
+			return Utils::Format(buffer, size, "%.4f", *(volatile float32_t*)_watches[index].ADDRESS);
+		}
+	}
+
+	bool Watch::Poke (uint32_t index, float32_t value)
+	{
+		WATCH_DEF* watch;
+		uint32_t primask;
+
+		if((index >= _watchesCount) || !_watches[index].WRITABLE)
+			return false;
+
+		watch = &_watches[index];
+
+		primask = __get_PRIMASK();
+		__disable_irq();
+
+		switch(watch->TYPE)
+		{
+		case Watch::INT32:
+			*(volatile int32_t*)watch->ADDRESS = (int32_t)value;
+			break;
+		case Watch::UINT32:
+			*(volatile uint32_t*)watch->ADDRESS = (uint32_t)value;
+			break;
+		case Watch::UINT16:
+			*(volatile uint16_t*)watch->ADDRESS = (uint16_t)value;
+			break;
+		case Watch::BOOL:
+			*(volatile bool*)watch->ADDRESS = (value != 0.0f);
+			break;
+		default:
+			*(volatile float32_t*)watch->ADDRESS = value;
+			break;
+		}
+
+		__set_PRIMASK(primask);
+
+		return true;
+	}
+}
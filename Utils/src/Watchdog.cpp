@@ -0,0 +1,198 @@
+/**
+ * @file	Watchdog.cpp
+ * @author	Jeremy ROULLAND
+ * @date	15 oct. 2026
+ * @brief	Task health supervisor feeding the independent watchdog (IWDG)
+ */
+
+#include "Watchdog.hpp"
+#include "Crash.hpp"
+#include "stm32f4xx.h"
+
+#include <stddef.h>
+
+/*----------------------------------------------------------------------------*/
+/* Definitions                                                                */
+/*----------------------------------------------------------------------------*/
+
+/**
+ * @brief IWDG counter clock : LSI (32 kHz nominal) / 32, about 1 ms
+ */
+#define WATCHDOG_PRESCALER		(IWDG_Prescaler_32)
+
+/*----------------------------------------------------------------------------*/
+/* Private Members                                                            */
+/*----------------------------------------------------------------------------*/
+
+/**
+ * @brief Supervised task
+ */
+typedef struct
+{
+	const char *		name;
+	TickType_t			deadline;
+	volatile TickType_t	last;
+	volatile bool		armed;		/**< Checked in at least once */
+}WATCHDOG_CLIENT;
+
+static WATCHDOG_CLIENT _clients[WATCHDOG_CLIENTS_MAX];
+static uint32_t _count = 0u;
+
+static volatile bool _started = false;
+static volatile bool _held = false;
+static uint32_t _timeout = WATCHDOG_TIMEOUT_MS;
+static bool _reset = false;
+
+/*----------------------------------------------------------------------------*/
+/* Class Implementation	                                                      */
+/*----------------------------------------------------------------------------*/
+
+namespace Utils
+{
+	void Watchdog::Start (uint32_t timeout)
+	{
+		assert((timeout > 0u) && (timeout <= WATCHDOG_HOLD_MAX_MS));
+
+		if(_started)
+			return;
+
+		// Reset cause, flags are sticky until cleared
+		_reset = (RCC_GetFlagStatus(RCC_FLAG_IWDGRST) == SET);
+		RCC_ClearFlag();
+
+		// Breakpoints do not reset the board
+		DBGMCU_APB1PeriphConfig(DBGMCU_IWDG_STOP, ENABLE);
+
+		_timeout = timeout;
+
+		IWDG_WriteAccessCmd(IWDG_WriteAccess_Enable);
+		IWDG_SetPrescaler(WATCHDOG_PRESCALER);
+		IWDG_SetReload(timeout);
+		IWDG_ReloadCounter();
+		IWDG_Enable();
+
+		_started = true;
+	}
+
+	bool Watchdog::IsStarted ()
+	{
+		return _started;
+	}
+
+	int32_t Watchdog::Register (const char * name, uint32_t deadline)
+	{
+		WATCHDOG_CLIENT* c;
+
+		if(_count >= WATCHDOG_CLIENTS_MAX)
+			return -1;
+
+		c = &_clients[_count];
+		c->name = name;
+		c->deadline = pdMS_TO_TICKS(deadline);
+		c->last = 0u;
+		c->armed = false;
+
+		return static_cast<int32_t>(_count++);
+	}
+
+	void Watchdog::CheckIn (int32_t index)
+	{
+		if((index < 0) || (static_cast<uint32_t>(index) >= _count))
+			return;
+
+		_clients[index].last = xTaskGetTickCount();
+		_clients[index].armed = true;
+	}
+
+	void Watchdog::Supervise ()
+	{
+		TickType_t now;
+		TickType_t age;
+
+		if(!_started || _held)
+			return;
+
+		now = xTaskGetTickCountFromISR();
+
+		for(uint32_t i = 0u; i < _count; i++)
+		{
+			if(!_clients[i].armed)
+				continue;
+
+			// Late task : reset now with its name, do not wait for the IWDG
+			age = now - _clients[i].last;
+			if(age > _clients[i].deadline)
+				Crash::Abort(Crash::WATCHDOG, _clients[i].name, age * portTICK_PERIOD_MS);
+		}
+
+		IWDG_ReloadCounter();
+	}
+
+	void Watchdog::Hold (uint32_t duration)
+	{
+		if(duration > WATCHDOG_HOLD_MAX_MS)
+			duration = WATCHDOG_HOLD_MAX_MS;
+
+		_held = true;
+
+		if(_started)
+			reload(duration);
+	}
+
+	void Watchdog::Release ()
+	{
+		TickType_t now = xTaskGetTickCount();
+
+		if(!_held)
+			return;
+
+		for(uint32_t i = 0u; i < _count; i++)
+			_clients[i].last = now;
+
+		if(_started)
+			reload(_timeout);
+
+		_held = false;
+	}
+
+	bool Watchdog::WasReset ()
+	{
+		return _reset;
+	}
+
+	uint32_t Watchdog::Count ()
+	{
+		return _count;
+	}
+
+	const char * Watchdog::GetName (uint32_t index)
+	{
+		return (index < _count) ? _clients[index].name : NULL;
+	}
+
+	uint32_t Watchdog::GetDeadline (uint32_t index)
+	{
+		return (index < _count) ? (_clients[index].deadline * portTICK_PERIOD_MS) : 0u;
+	}
+
+	uint32_t Watchdog::GetAge (uint32_t index)
+	{
+		if((index >= _count) || !_clients[index].armed)
+			return 0u;
+
+		return (xTaskGetTickCount() - _clients[index].last) * portTICK_PERIOD_MS;
+	}
+
+	void Watchdog::reload (uint32_t timeout)
+	{
+		// Previous reload value update must be done
+		while(IWDG_GetFlagStatus(IWDG_FLAG_RVU) == SET);
+
+		IWDG_WriteAccessCmd(IWDG_WriteAccess_Enable);
+		IWDG_SetReload(timeout);
+
+		while(IWDG_GetFlagStatus(IWDG_FLAG_RVU) == SET);
+
+		IWDG_ReloadCounter();
+	}
+}